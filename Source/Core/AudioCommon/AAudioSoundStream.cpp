@@ -0,0 +1,128 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#if defined(HAVE_AAUDIO) && HAVE_AAUDIO
+#include "AudioCommon/AAudioSoundStream.h"
+#include "Common/Logging/Log.h"
+
+bool AAudioSound::Start()
+{
+	m_stopping = false;
+	std::lock_guard<std::mutex> lk(m_stream_lock);
+	return OpenStream();
+}
+
+void AAudioSound::Stop()
+{
+	m_stopping = true;
+	if (m_restart_thread.joinable())
+		m_restart_thread.join();
+
+	std::lock_guard<std::mutex> lk(m_stream_lock);
+	CloseStream();
+}
+
+bool AAudioSound::OpenStream()
+{
+	AAudioStreamBuilder* builder;
+	aaudio_result_t result = AAudio_createStreamBuilder(&builder);
+	if (result != AAUDIO_OK)
+	{
+		ERROR_LOG(AUDIO, "AAudio: can't create a stream builder: %s", AAudio_convertResultToText(result));
+		return false;
+	}
+
+	// The mixer is pulled from the callback, which AAudio runs on its own high priority thread
+	AAudioStreamBuilder_setDirection(builder, AAUDIO_DIRECTION_OUTPUT);
+	AAudioStreamBuilder_setPerformanceMode(builder, AAUDIO_PERFORMANCE_MODE_LOW_LATENCY);
+	AAudioStreamBuilder_setSharingMode(builder, AAUDIO_SHARING_MODE_EXCLUSIVE);
+	AAudioStreamBuilder_setFormat(builder, AAUDIO_FORMAT_PCM_I16);
+	AAudioStreamBuilder_setChannelCount(builder, 2);
+	AAudioStreamBuilder_setSampleRate(builder, m_mixer->GetSampleRate());
+	AAudioStreamBuilder_setDataCallback(builder, DataCallback, this);
+	AAudioStreamBuilder_setErrorCallback(builder, ErrorCallback, this);
+
+	result = AAudioStreamBuilder_openStream(builder, &m_stream);
+	AAudioStreamBuilder_delete(builder);
+	if (result != AAUDIO_OK)
+	{
+		ERROR_LOG(AUDIO, "AAudio: can't open a stream: %s", AAudio_convertResultToText(result));
+		m_stream = nullptr;
+		return false;
+	}
+
+	// Starts at two bursts, the least that doesn't glitch on most devices
+	m_burst_frames = AAudioStream_getFramesPerBurst(m_stream);
+	AAudioStream_setBufferSizeInFrames(m_stream, m_burst_frames * 2);
+	m_underruns = AAudioStream_getXRunCount(m_stream);
+
+	result = AAudioStream_requestStart(m_stream);
+	if (result != AAUDIO_OK)
+	{
+		ERROR_LOG(AUDIO, "AAudio: can't start the stream: %s", AAudio_convertResultToText(result));
+		CloseStream();
+		return false;
+	}
+
+	INFO_LOG(AUDIO, "AAudio: %s stream, %d Hz, bursts of %d frames",
+		AAudioStream_getSharingMode(m_stream) == AAUDIO_SHARING_MODE_EXCLUSIVE ? "exclusive" : "shared",
+		AAudioStream_getSampleRate(m_stream), m_burst_frames);
+	return true;
+}
+
+void AAudioSound::CloseStream()
+{
+	if (!m_stream)
+		return;
+
+	AAudioStream_requestStop(m_stream);
+	AAudioStream_close(m_stream);
+	m_stream = nullptr;
+}
+
+void AAudioSound::TuneBufferSize()
+{
+	const int32_t underruns = AAudioStream_getXRunCount(m_stream);
+	if (underruns <= m_underruns)
+		return;
+	m_underruns = underruns;
+
+	const int32_t size = AAudioStream_getBufferSizeInFrames(m_stream);
+	if (size + m_burst_frames <= AAudioStream_getBufferCapacityInFrames(m_stream))
+	{
+		AAudioStream_setBufferSizeInFrames(m_stream, size + m_burst_frames);
+		INFO_LOG(AUDIO, "AAudio: underrun, buffer grown to %d frames", size + m_burst_frames);
+	}
+}
+
+aaudio_data_callback_result_t AAudioSound::DataCallback(AAudioStream* stream, void* user_data,
+	void* audio_data, int32_t num_frames)
+{
+	AAudioSound* sound = static_cast<AAudioSound*>(user_data);
+	sound->m_mixer->Mix(static_cast<s16*>(audio_data), static_cast<u32>(num_frames));
+	sound->TuneBufferSize();
+	return AAUDIO_CALLBACK_RESULT_CONTINUE;
+}
+
+// A stream is disconnected when the output device changes, it has to be reopened, and not from
+// the callback thread
+void AAudioSound::ErrorCallback(AAudioStream* stream, void* user_data, aaudio_result_t error)
+{
+	AAudioSound* sound = static_cast<AAudioSound*>(user_data);
+	if (error != AAUDIO_ERROR_DISCONNECTED || sound->m_stopping)
+		return;
+
+	WARN_LOG(AUDIO, "AAudio: stream disconnected, reopening it");
+	// A previous restart is at most finishing to open the stream that is now disconnected
+	if (sound->m_restart_thread.joinable())
+		sound->m_restart_thread.join();
+	sound->m_restart_thread = std::thread([sound] {
+		std::lock_guard<std::mutex> lk(sound->m_stream_lock);
+		if (sound->m_stopping)
+			return;
+		sound->CloseStream();
+		sound->OpenStream();
+	});
+}
+#endif
@@ -0,0 +1,49 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+#if defined(HAVE_AAUDIO) && HAVE_AAUDIO
+#include <aaudio/AAudio.h>
+#endif
+
+#include "AudioCommon/SoundStream.h"
+#include "Common/CommonTypes.h"
+
+class AAudioSound final: public SoundStream
+{
+#if defined(HAVE_AAUDIO) && HAVE_AAUDIO
+public:
+	bool Start() override;
+	void Stop() override;
+
+	static bool isValid()
+	{
+		return true;
+	}
+
+private:
+	bool OpenStream();
+	void CloseStream();
+	// Adds a burst to the buffer after every underrun, up to its capacity
+	void TuneBufferSize();
+
+	static aaudio_data_callback_result_t DataCallback(AAudioStream* stream, void* user_data,
+		void* audio_data, int32_t num_frames);
+	static void ErrorCallback(AAudioStream* stream, void* user_data, aaudio_result_t error);
+
+	// Guards the stream against the thread that reopens it after a disconnect
+	std::mutex m_stream_lock;
+	AAudioStream* m_stream = nullptr;
+	std::thread m_restart_thread;
+	std::atomic<bool> m_stopping{ false };
+
+	int32_t m_burst_frames = 0;
+	int32_t m_underruns = 0;
+#endif
+};
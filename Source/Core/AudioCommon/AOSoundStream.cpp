@@ -14,6 +14,7 @@
 void AOSound::SoundLoop()
 {
 	Common::SetCurrentThreadName("Audio thread - ao");
+	Common::PlaceCurrentThread(Common::ThreadRole::Realtime);
 
 	uint_32 numBytesToRender = 256;
 	ao_initialize();
@@ -48,6 +48,7 @@ void AlsaSound::Update()
 void AlsaSound::SoundLoop()
 {
 	Common::SetCurrentThreadName("Audio thread - alsa");
+	Common::PlaceCurrentThread(Common::ThreadRole::Realtime);
 	while (m_thread_status.load() != ALSAThreadStatus::STOPPING)
 	{
 		while (m_thread_status.load() == ALSAThreadStatus::RUNNING)
@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include "AudioCommon/AudioCommon.h"
+#include "AudioCommon/AAudioSoundStream.h"
 #include "AudioCommon/AOSoundStream.h"
 #include "AudioCommon/AlsaSoundStream.h"
 #include "AudioCommon/CoreAudioSoundStream.h"
@@ -57,6 +58,8 @@ void InitSoundStream(void* hWnd)
     g_sound_stream = std::make_unique<PulseAudio>();
   else if (backend == BACKEND_OPENSLES && OpenSLESStream::isValid())
     g_sound_stream = std::make_unique<OpenSLESStream>();
+  else if (backend == BACKEND_AAUDIO && AAudioSound::isValid())
+    g_sound_stream = std::make_unique<AAudioSound>();
 
   if (!g_sound_stream && NullSound::isValid())
   {
@@ -123,6 +126,8 @@ std::vector<std::string> GetSoundBackends()
     backends.push_back(BACKEND_OPENAL);
   if (OpenSLESStream::isValid())
     backends.push_back(BACKEND_OPENSLES);
+  if (AAudioSound::isValid())
+    backends.push_back(BACKEND_AAUDIO);
   return backends;
 }
 
@@ -179,7 +184,7 @@ void SendAIBuffer(const short* samples, unsigned int num_samples)
 
   CMixer* pMixer = g_sound_stream->GetMixer();
 
-  if (pMixer && samples)
+  if (pMixer && samples && !Movie::IsTurboPlayback())
   {
     pMixer->PushSamples(samples, num_samples);
   }
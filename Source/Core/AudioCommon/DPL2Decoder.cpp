@@ -16,6 +16,7 @@
 
 #include "AudioCommon/DPL2Decoder.h"
 #include "Common/CommonTypes.h"
+#include "Common/Intrinsics.h"
 #include "Common/MathUtil.h"
 
 #ifndef M_PI
@@ -33,19 +34,39 @@ static float l_fwr, r_fwr, lpr_fwr, lmr_fwr;
 static std::vector<float> fwrbuf_l, fwrbuf_r;
 static float adapt_l_gain, adapt_r_gain, adapt_lpr_gain, adapt_lmr_gain;
 static std::vector<float> lf, rf, lr, rr, cf, cr;
-static float LFE_buf[256];
+// Doubled so the filter window is always contiguous, see FIRFilter()
+static float LFE_buf[256 * 2];
 static unsigned int lfe_pos;
 static float *filter_coefs_lfe;
 static unsigned int len125;
 
-template<class T, class _ftype_t>
-static _ftype_t DotProduct(int count, const T *buf, const _ftype_t *coefficients)
+static float DotProduct(int count, const float *buf, const float *coefficients)
 {
-	int i;
+	int i = 0;
+#ifdef _M_X86
+	__m128 sum0 = _mm_setzero_ps(), sum1 = _mm_setzero_ps();
+	__m128 sum2 = _mm_setzero_ps(), sum3 = _mm_setzero_ps();
+
+	// Unrolled loop, four independent accumulators to hide the add latency
+	for (; (i + 15) < count; i += 16)
+	{
+		const float* b = buf + i;
+		const float* c = coefficients + i;
+		sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(b + 0), _mm_loadu_ps(c + 0)));
+		sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_loadu_ps(b + 4), _mm_loadu_ps(c + 4)));
+		sum2 = _mm_add_ps(sum2, _mm_mul_ps(_mm_loadu_ps(b + 8), _mm_loadu_ps(c + 8)));
+		sum3 = _mm_add_ps(sum3, _mm_mul_ps(_mm_loadu_ps(b + 12), _mm_loadu_ps(c + 12)));
+	}
+
+	__m128 sum = _mm_add_ps(_mm_add_ps(sum0, sum1), _mm_add_ps(sum2, sum3));
+	sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+	sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(1, 1, 1, 1)));
+	float result = _mm_cvtss_f32(sum);
+#else
 	float sum0 = 0.0f, sum1 = 0.0f, sum2 = 0.0f, sum3 = 0.0f;
 
 	// Unrolled loop
-	for (i = 0; (i + 3) < count; i += 4)
+	for (; (i + 3) < count; i += 4)
 	{
 		sum0 += buf[i + 0] * coefficients[i + 0];
 		sum1 += buf[i + 1] * coefficients[i + 1];
@@ -53,36 +74,21 @@ static _ftype_t DotProduct(int count, const T *buf, const _ftype_t *coefficients
 		sum3 += buf[i + 3] * coefficients[i + 3];
 	}
 
+	float result = sum0 + sum1 + sum2 + sum3;
+#endif
+
 	// Epilogue of unrolled loop
 	for (; i < count; i++)
-		sum0 += buf[i] * coefficients[i];
+		result += buf[i] * coefficients[i];
 
-	return sum0 + sum1 + sum2 + sum3;
+	return result;
 }
 
-template<class T>
-static T FIRFilter(const T *buf, int pos, int len, int count, const float *coefficients)
+// buf holds the last len samples twice in a row, pos being the newest, so the window
+// never wraps.
+static float FIRFilter(const float *buf, int pos, int len, const float *coefficients)
 {
-	int count1, count2;
-
-	if (pos >= count)
-	{
-		pos -= count;
-		count1 = count; count2 = 0;
-	}
-	else
-	{
-		count2 = pos;
-		count1 = count - pos;
-		pos = len - count1;
-	}
-
-	// high part of window
-	const T *ptr = &buf[pos];
-
-	float r1 = DotProduct(count1, ptr, coefficients); coefficients += count1;
-	float r2 = DotProduct(count2, buf, coefficients);
-	return T(r1 + r2);
+	return DotProduct(len, &buf[pos], coefficients);
 }
 
 /*
@@ -367,8 +373,9 @@ void DPL2Decode(float *samples, int numsamples, float *out)
 		out[cur + 0] = lf[k];
 		out[cur + 1] = rf[k];
 		out[cur + 2] = cf[k];
-		LFE_buf[lfe_pos] = (lf[k] + rf[k] + 2.0f * cf[k] + lr[k] + rr[k]) / 2.0f;
-		out[cur + 3] = FIRFilter(LFE_buf, lfe_pos, len125, len125, filter_coefs_lfe);
+		LFE_buf[lfe_pos] = LFE_buf[lfe_pos + len125] =
+			(lf[k] + rf[k] + 2.0f * cf[k] + lr[k] + rr[k]) / 2.0f;
+		out[cur + 3] = FIRFilter(LFE_buf, lfe_pos, len125, filter_coefs_lfe);
 		lfe_pos++;
 		if (lfe_pos == len125)
 		{
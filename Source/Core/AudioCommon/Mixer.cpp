@@ -7,7 +7,9 @@
 #include "AudioCommon/Mixer.h"
 #include "Common/Atomic.h"
 #include "Common/CPUDetect.h"
+#include "Common/Intrinsics.h"
 #include "Common/MathUtil.h"
+#include "Common/Trace.h"
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
 #include "Core/HW/AudioInterface.h"
@@ -20,6 +22,9 @@
 const float CMixer::MAX_FREQ_SHIFT = 200;
 const float CMixer::CONTROL_FACTOR = 0.2f;
 const float CMixer::CONTROL_AVG = 32;
+const float CMixer::MIN_LATENCY = 8;
+const float CMixer::LATENCY_GROW_STEP = 8;
+const float CMixer::LATENCY_SHRINK_STEP = 1;
 
 CMixer::CMixer(u32 BackendSampleRate)
 	: m_dma_mixer(this, 32000)
@@ -30,15 +35,36 @@ CMixer::CMixer(u32 BackendSampleRate)
 	, m_log_dsp_audio(0)
 	, m_speed(0)
 {
+	const float latency = (float)SConfig::GetInstance().iTimingVariance;
+	m_dma_mixer.SetLatency(latency);
+	m_streaming_mixer.SetLatency(latency);
+	m_wiimote_speaker_mixer.SetLatency(latency);
 	INFO_LOG(AUDIO_INTERFACE, "Mixer is initialized");
 }
 
+#ifdef _M_X86
+// Stores l0 + l1 and r0 + r1 of [l0 r0 l1 r1].
+static void StoreStereoSum(__m128 sum, float* left_output, float* right_output)
+{
+	sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+	_mm_store_ss(left_output, sum);
+	_mm_store_ss(right_output, _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(1, 1, 1, 1)));
+}
+#endif
+
 void CMixer::LinearMixerFifo::Interpolate(u32 left_input_index, float* left_output, float* right_output)
 {
+#ifdef _M_X86
+	// [l0 r0 l1 r1], never wraps thanks to the padding
+	const float* input = &m_float_buffer[left_input_index & INDEX_MASK];
+	const __m128 coef = _mm_setr_ps(1 - m_fraction, 1 - m_fraction, m_fraction, m_fraction);
+	StoreStereoSum(_mm_mul_ps(_mm_loadu_ps(input), coef), left_output, right_output);
+#else
 	*left_output = (1 - m_fraction) * m_float_buffer[left_input_index & INDEX_MASK]
 		+ m_fraction * m_float_buffer[(left_input_index + 2) & INDEX_MASK];
 	*right_output = (1 - m_fraction) * m_float_buffer[(left_input_index + 1) & INDEX_MASK]
 		+ m_fraction * m_float_buffer[(left_input_index + 3) & INDEX_MASK];
+#endif
 }
 
 void CMixer::CubicMixerFifo::Interpolate(u32 left_input_index, float* left_output, float* right_output)
@@ -60,6 +86,13 @@ void CMixer::CubicMixerFifo::Interpolate(u32 left_input_index, float* left_outpu
 	float y2 = cubic_coef[8] * x0 + cubic_coef[9] * x1 + cubic_coef[10] * x2 + cubic_coef[11];
 	float y3 = cubic_coef[12] * x0 + cubic_coef[13] * x1 + cubic_coef[14] * x2 + cubic_coef[15];
 
+#ifdef _M_X86
+	// [l0 r0 l1 r1] [l2 r2 l3 r3], never wraps thanks to the padding
+	const float* input = &m_float_buffer[left_input_index & INDEX_MASK];
+	const __m128 sum = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(input), _mm_setr_ps(y0, y0, y1, y1)),
+		_mm_mul_ps(_mm_loadu_ps(input + 4), _mm_setr_ps(y2, y2, y3, y3)));
+	StoreStereoSum(sum, left_output, right_output);
+#else
 	*left_output = y0 * m_float_buffer[left_input_index & INDEX_MASK]
 		+ y1 * m_float_buffer[(left_input_index + 2) & INDEX_MASK]
 		+ y2 * m_float_buffer[(left_input_index + 4) & INDEX_MASK]
@@ -68,26 +101,71 @@ void CMixer::CubicMixerFifo::Interpolate(u32 left_input_index, float* left_outpu
 		+ y1 * m_float_buffer[(left_input_index + 3) & INDEX_MASK]
 		+ y2 * m_float_buffer[(left_input_index + 5) & INDEX_MASK]
 		+ y3 * m_float_buffer[(left_input_index + 7) & INDEX_MASK];
+#endif
+}
+
+// Scales to [-32768, 32767], clamps and truncates.
+static void FloatToSigned16(s16* dst, const float* src, u32 count)
+{
+	u32 i = 0;
+#ifdef _M_X86
+	const __m128 scale = _mm_set1_ps(32768.0f);
+	const __m128 min = _mm_set1_ps(-32768.0f);
+	const __m128 max = _mm_set1_ps(32767.0f);
+	for (; i + 8 <= count; i += 8)
+	{
+		const __m128 a = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(src + i), scale), min), max);
+		const __m128 b =
+			_mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(src + i + 4), scale), min), max);
+		const __m128i packed = _mm_packs_epi32(_mm_cvttps_epi32(a), _mm_cvttps_epi32(b));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), packed);
+	}
+#endif
+	for (; i < count; ++i)
+		dst[i] = s16(MathUtil::Clamp(src[i] * 32768.0f, -32768.f, 32767.f));
+}
+
+// Converts big endian samples to floats.
+static void Signed16BEToFloat(float* dst, const s16* src, u32 count)
+{
+	u32 i = 0;
+#ifdef _M_X86
+	const __m128 scale = _mm_set1_ps(1.0f / 32768.0f);
+	for (; i + 8 <= count; i += 8)
+	{
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+		v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+		// Sign extend to 32 bits
+		const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+		const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+		_mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+		_mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+	}
+#endif
+	for (; i < count; ++i)
+		dst[i] = Signed16ToFloat(Common::swap16(src[i]));
 }
 
 void CMixer::MixerFifo::Mix(float* samples, u32 numSamples, bool consider_framelimit)
 {
 	u32 current_sample = 0;
-	// Cache access in non-volatile variable so interpolation loop can be optimized
-	u32 read_index = m_read_index.load();
-	const u32 write_index = m_write_index.load();
+	// Cache access in non-volatile variable so interpolation loop can be optimized.
+	// Acquiring the write index makes the samples before it visible.
+	u32 read_index = m_read_index.load(std::memory_order_relaxed);
+	const u32 write_index = m_write_index.load(std::memory_order_acquire);
+	const u32 input_sample_rate = m_input_sample_rate.load(std::memory_order_relaxed);
 	// Sync input rate by fifo size
 	float num_left = (float)(((write_index - read_index) & INDEX_MASK) / 2);
 	m_num_left_i = (num_left + m_num_left_i * (CONTROL_AVG - 1)) / CONTROL_AVG;
 
-	u32 low_waterwark = m_input_sample_rate * SConfig::GetInstance().iTimingVariance / 1000;
+	u32 low_waterwark = (u32)(input_sample_rate * m_latency.load(std::memory_order_relaxed) / 1000);
 	low_waterwark = std::min(low_waterwark, MAX_SAMPLES / 2);
 
 	float offset = (m_num_left_i - low_waterwark) * CONTROL_FACTOR;
 	offset = MathUtil::Clamp(offset, -MAX_FREQ_SHIFT, MAX_FREQ_SHIFT);
 	// adjust framerate with framelimit
 	float emulationspeed = SConfig::GetInstance().m_EmulationSpeed;
-	float aid_sample_rate = m_input_sample_rate + offset;
+	float aid_sample_rate = input_sample_rate + offset;
 	if (consider_framelimit && emulationspeed > 0.0f)
 	{
 		aid_sample_rate = aid_sample_rate * emulationspeed;
@@ -114,6 +192,10 @@ void CMixer::MixerFifo::Mix(float* samples, u32 numSamples, bool consider_framel
 		read_index += 2 * (s32)m_fraction;
 		m_fraction = m_fraction - (s32)m_fraction;
 	}
+	// Running dry while the producer is still pushing samples is an underrun, running dry
+	// because emulation is paused isn't.
+	UpdateLatency(current_sample < numSamples * 2 && write_index != m_last_write_index, numSamples);
+	m_last_write_index = write_index;
 	// pad output if not enough input samples
 	float s[2];
 	s[0] = m_float_buffer[(read_index - 1) & INDEX_MASK] * r_volume;
@@ -123,13 +205,36 @@ void CMixer::MixerFifo::Mix(float* samples, u32 numSamples, bool consider_framel
 		samples[current_sample] += s[0];
 		samples[current_sample + 1] += s[1];
 	}
-	// update read index
-	m_read_index.store(read_index);
+	// update read index, releasing the samples to PushSamples()
+	m_read_index.store(read_index, std::memory_order_release);
+}
+
+void CMixer::MixerFifo::UpdateLatency(bool underrun, u32 num_samples)
+{
+	// The fifo can't hold more than half its size without PushSamples() dropping samples
+	const float max_latency = (MAX_SAMPLES / 2) * 1000.0f / m_input_sample_rate.load();
+	float latency = m_latency.load(std::memory_order_relaxed);
+	if (underrun)
+	{
+		latency += LATENCY_GROW_STEP;
+		m_stable_samples = 0;
+	}
+	else
+	{
+		// Shrink by one step for every second of glitch free output
+		m_stable_samples += num_samples;
+		if (m_stable_samples < m_mixer->m_sample_rate)
+			return;
+		latency -= LATENCY_SHRINK_STEP;
+		m_stable_samples = 0;
+	}
+	m_latency.store(MathUtil::Clamp(latency, MIN_LATENCY, std::max(max_latency, MIN_LATENCY)),
+		std::memory_order_relaxed);
 }
 
 u32 CMixer::MixerFifo::AvailableSamples()
 {
-	return ((m_write_index.load() - m_read_index.load()) & INDEX_MASK) * 48000 / (2 * m_input_sample_rate);
+	return ((m_write_index.load() - m_read_index.load()) & INDEX_MASK) * 48000 / (2 * m_input_sample_rate.load());
 }
 
 u32 CMixer::AvailableSamples()
@@ -148,33 +253,24 @@ u32 CMixer::AvailableSamples()
 
 u32 CMixer::Mix(s16* samples, u32 num_samples, bool consider_framelimit)
 {
+	TRACE_ZONE("CMixer::Mix");
 	if (!samples)
 		return 0;
-	std::lock_guard<std::mutex> lk(m_cs_mixing);
 	// reset float output buffer
 	m_output_buffer.resize(num_samples * 2);
 	std::fill_n(m_output_buffer.begin(), num_samples * 2, 0.f);
 	m_dma_mixer.Mix(m_output_buffer.data(), num_samples, consider_framelimit);
 	m_streaming_mixer.Mix(m_output_buffer.data(), num_samples, consider_framelimit);
 	m_wiimote_speaker_mixer.Mix(m_output_buffer.data(), num_samples, consider_framelimit);
-	// dither and clamp
-	for (u32 i = 0; i < num_samples * 2; i += 2)
-	{
-		float r_output = m_output_buffer[i] * 32768.0f;
-		float l_output = m_output_buffer[i + 1] * 32768.0f;
-		l_output = MathUtil::Clamp(l_output, -32768.f, 32767.f);
-		r_output = MathUtil::Clamp(r_output, -32768.f, 32767.f);
-		samples[i] = s16(r_output);
-		samples[i + 1] = s16(l_output);
-	}
+	FloatToSigned16(samples, m_output_buffer.data(), num_samples * 2);
 	return num_samples;
 }
 
 u32 CMixer::Mix(float* samples, u32 num_samples, bool consider_framelimit)
 {
+	TRACE_ZONE("CMixer::Mix");
 	if (!samples)
 		return 0;
-	std::lock_guard<std::mutex> lk(m_cs_mixing);
 	memset(samples, 0, num_samples * 2 * sizeof(float));
 	m_dma_mixer.Mix(samples, num_samples, consider_framelimit);
 	m_streaming_mixer.Mix(samples, num_samples, consider_framelimit);
@@ -188,19 +284,28 @@ void CMixer::MixerFifo::PushSamples(const s16* samples, u32 num_samples)
 	// Cache access in non-volatile variable
 	// indexR isn't allowed to cache in the audio throttling loop as it
 	// needs to get updates to not deadlock.
-	u32 current_write_index = m_write_index.load();
+	u32 current_write_index = m_write_index.load(std::memory_order_relaxed);
 	// Check if we have enough free space
 	// indexW == m_indexR results in empty buffer, so indexR must always be smaller than indexW
-	if (num_samples * 2 + ((current_write_index - m_read_index.load()) & INDEX_MASK) >= MAX_SAMPLES * 2)
+	if (num_samples * 2 + ((current_write_index - m_read_index.load(std::memory_order_acquire)) & INDEX_MASK) >= MAX_SAMPLES * 2)
 		return;
 	// AyuanX: Actual re-sampling work has been moved to sound thread
 	// to alleviate the workload on main thread
-	// convert to float while copying to buffer
-	for (u32 i = 0; i < num_samples * 2; ++i)
-	{
-		m_float_buffer[(current_write_index + i) & INDEX_MASK] = Signed16ToFloat(Common::swap16(samples[i]));
-	}
-	m_write_index.fetch_add(num_samples * 2);
+	// convert to float while copying to buffer, in at most two runs around the end of the ring
+	const u32 start = current_write_index & INDEX_MASK;
+	const u32 count = num_samples * 2;
+	const u32 first = std::min(count, MAX_SAMPLES * 2 - start);
+	Signed16BEToFloat(&m_float_buffer[start], samples, first);
+	Signed16BEToFloat(&m_float_buffer[0], samples + first, count - first);
+
+	// Mirror the samples just written to the start of the ring into the padding
+	const u32 mirror_begin = first < count ? 0 : start;
+	const u32 mirror_end = first < count ? count - first : start + count;
+	for (u32 i = mirror_begin; i < std::min(mirror_end, u32{BUFFER_PADDING}); ++i)
+		m_float_buffer[MAX_SAMPLES * 2 + i] = m_float_buffer[i];
+
+	// Publishes the samples to Mix()
+	m_write_index.fetch_add(num_samples * 2, std::memory_order_release);
 	return;
 }
 
@@ -260,7 +365,7 @@ void CMixer::SetWiimoteSpeakerVolume(u32 lvolume, u32 rvolume)
 
 void CMixer::MixerFifo::SetInputSampleRate(u32 rate)
 {
-	m_input_sample_rate = rate;
+	m_input_sample_rate.store(rate);
 }
 
 void CMixer::MixerFifo::SetVolume(u32 lvolume, u32 rvolume)
@@ -269,6 +374,17 @@ void CMixer::MixerFifo::SetVolume(u32 lvolume, u32 rvolume)
 	m_rvolume.store(rvolume + (rvolume >> 7));
 }
 
+void CMixer::MixerFifo::SetLatency(float latency)
+{
+	m_latency.store(std::max(latency, MIN_LATENCY));
+	m_stable_samples = 0;
+}
+
+float CMixer::MixerFifo::GetLatency() const
+{
+	return m_latency.load();
+}
+
 void CMixer::MixerFifo::GetVolume(u32* lvolume, u32* rvolume) const
 {
 	*lvolume = m_lvolume.load();
@@ -335,5 +451,5 @@ void CMixer::StopLogDSPAudio()
 
 unsigned int CMixer::MixerFifo::GetInputSampleRate() const
 {
-	return m_input_sample_rate;
+	return m_input_sample_rate.load();
 }
\ No newline at end of file
@@ -7,7 +7,6 @@
 #include <atomic>
 #include <cstring>
 #include <array>
-#include <mutex>
 #include <vector>
 
 #include "AudioCommon/WaveFile.h"
@@ -29,11 +28,16 @@ public:
 	static const float MAX_FREQ_SHIFT;
 	static const float CONTROL_FACTOR;
 	static const float CONTROL_AVG;
+	// Bounds and steps of the adaptive fifo latency, in ms
+	static const float MIN_LATENCY;
+	static const float LATENCY_GROW_STEP;
+	static const float LATENCY_SHRINK_STEP;
 
 	virtual ~CMixer()
 	{}
 
-	// Called from audio threads
+	// Called from the audio thread. PushSamples() and Mix() form a single producer single
+	// consumer ring per fifo, so neither side takes a lock.
 	u32 Mix(s16* samples, u32 numSamples, bool consider_framelimit = true);
 	u32 Mix(float* samples, u32 numSamples, bool consider_framelimit = true);
 	u32 AvailableSamples();
@@ -57,11 +61,6 @@ public:
 	void StartLogDSPAudio(const std::string& filename);
 	void StopLogDSPAudio();
 
-	std::mutex& MixerCritical()
-	{
-		return m_cs_mixing;
-	}
-
 	float GetCurrentSpeed() const
 	{
 		return m_speed.load();
@@ -71,6 +70,14 @@ public:
 		m_speed.store(val);
 	}
 
+	// Latency in ms the DMA fifo currently keeps buffered. It starts at the TimingVariance
+	// setting, grows whenever the backend runs the fifo dry and shrinks back toward
+	// MIN_LATENCY while it doesn't.
+	float GetCurrentLatency() const
+	{
+		return m_dma_mixer.GetLatency();
+	}
+
 protected:
 	class MixerFifo
 	{
@@ -84,6 +91,9 @@ protected:
 			, m_rvolume(255)
 			, m_num_left_i(0.0f)
 			, m_fraction(0)
+			, m_latency(0.0f)
+			, m_last_write_index(0)
+			, m_stable_samples(0)
 		{
 			srand((u32)time(nullptr));
 			m_float_buffer.fill(0.0f);
@@ -97,11 +107,18 @@ protected:
 		void SetVolume(u32 lvolume, u32 rvolume);
 		void GetVolume(u32* lvolume, u32* rvolume) const;
 		u32 AvailableSamples();
+		void SetLatency(float latency);
+		float GetLatency() const;
 	protected:
+		void UpdateLatency(bool underrun, u32 num_samples);
+
 		CMixer *m_mixer;
-		unsigned m_input_sample_rate;
+		std::atomic<u32> m_input_sample_rate;
 
-		std::array<float, MAX_SAMPLES * 2> m_float_buffer;
+		// Interpolation reads up to 8 floats from the read index. The first ones are mirrored
+		// past the end so those reads never need to wrap.
+		static const u32 BUFFER_PADDING = 8;
+		std::array<float, MAX_SAMPLES * 2 + BUFFER_PADDING> m_float_buffer;
 
 		std::atomic<u32> m_write_index;
 		std::atomic<u32> m_read_index;
@@ -112,6 +129,13 @@ protected:
 
 		float m_num_left_i;
 		float m_fraction;
+
+		// Target fill level in ms, only written by the audio thread
+		std::atomic<float> m_latency;
+		// Write index seen by the last Mix(), to tell underruns from a stopped producer
+		u32 m_last_write_index;
+		// Output samples mixed since the last latency change
+		u32 m_stable_samples;
 	};
 
 	class LinearMixerFifo: public MixerFifo
@@ -153,8 +177,6 @@ protected:
 	bool m_log_dtk_audio;
 	bool m_log_dsp_audio;
 
-	std::mutex m_cs_mixing;
-
 	std::atomic<float> m_speed; // Current rate of the emulation (1.0 = 100% speed)
 
 private:
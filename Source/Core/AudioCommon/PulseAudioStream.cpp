@@ -53,6 +53,7 @@ void PulseAudio::Update()
 void PulseAudio::SoundLoop()
 {
 	Common::SetCurrentThreadName("Audio thread - pulse");
+	Common::PlaceCurrentThread(Common::ThreadRole::Realtime);
 
 	if (PulseInit())
 	{
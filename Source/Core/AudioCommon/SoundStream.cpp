@@ -117,6 +117,7 @@ inline void s16ToFloat(float* dst, const s16 *src, u32 numsamples)
 void SoundStream::SoundLoop()
 {
 	Common::SetCurrentThreadName("Audio thread");
+	Common::PlaceCurrentThread(Common::ThreadRole::Realtime);
 	InitializeSoundLoop();
 	bool surroundSupported = SupportSurroundOutput() && SConfig::GetInstance().bDPL2Decoder;
 	memset(realtimeBuffer, 0, SOUND_MAX_FRAME_SIZE * sizeof(u16));
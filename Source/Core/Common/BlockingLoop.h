@@ -4,10 +4,13 @@
 
 #pragma once
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <mutex>
 #include <thread>
 
+#include "Common/CommonTypes.h"
 #include "Common/Event.h"
 #include "Common/Flag.h"
 
@@ -18,9 +21,15 @@ namespace Common
 // It's a thread-safe way to trigger a new iteration without busy loops.
 // It's optimized for high-usage iterations which usually are already running while it's triggered often.
 // Be careful when using Wait() and Wakeup() at the same time. Wait() may block forever while Wakeup() is called regularly.
+//
+// When the payload runs out of work, the worker keeps running it in a busy loop for a while before
+// it goes to sleep on an event. The spin window adapts to how long it usually takes until new work
+// arrives: twice the average if that is below MAX_SPIN_TIME_US, else the worker sleeps right away.
 class BlockingLoop
 {
 public:
+	static constexpr s64 MAX_SPIN_TIME_US = 200;
+
 	BlockingLoop()
 	{
 		m_stopped.Set();
@@ -133,6 +142,8 @@ public:
 			switch (m_running_state.load())
 			{
 			case STATE_NEED_EXECUTION:
+				EndIdle();
+
 				// We won't get notified while we are in the STATE_NEED_EXECUTION state, so maybe Wakeup was called.
 				// So we have to assume on finishing the STATE_NEED_EXECUTION state, that there may be some remaining tasks.
 				// To process this tasks, we call the payload again within the STATE_LAST_EXECUTION state.
@@ -154,8 +165,11 @@ public:
 
 			case STATE_DONE:
 				// We're done now. So time to check if we want to sleep or if we want to stay in a busy loop.
-				if (m_may_sleep.TestAndClear())
+				BeginIdle();
+				if (m_may_sleep.TestAndClear() || SpinTimedOut())
 				{
+					EndSpin();
+
 					// Try to set the sleeping state.
 					if (m_running_state-- != STATE_DONE)
 						break;
@@ -170,11 +184,13 @@ public:
 				// Just relax
 				if (timeout > 0)
 				{
-					m_new_work_event.WaitFor(std::chrono::milliseconds(timeout));
+					if (m_new_work_event.WaitFor(std::chrono::milliseconds(timeout)))
+						m_wakeups.fetch_add(1, std::memory_order_relaxed);
 				}
 				else
 				{
 					m_new_work_event.Wait();
+					m_wakeups.fetch_add(1, std::memory_order_relaxed);
 				}
 				break;
 			}
@@ -215,6 +231,12 @@ public:
 		return m_stopped.IsSet() || m_running_state.load() <= STATE_DONE;
 	}
 
+	// The worker is asleep or about to wait for the next Wakeup
+	bool IsSleeping() const
+	{
+		return m_running_state.load() == STATE_SLEEPING;
+	}
+
 	// This function should be triggered regularly over time so
 	// that we will fall back from the busy loop to sleeping.
 	void AllowSleep()
@@ -222,7 +244,72 @@ public:
 		m_may_sleep.Set();
 	}
 
+	// Number of times the worker was woken up from sleeping
+	u64 GetWakeupCount() const
+	{
+		return m_wakeups.load(std::memory_order_relaxed);
+	}
+
+	// Total time the worker spent in the busy loop waiting for new work
+	u64 GetSpinTimeUs() const
+	{
+		return m_spin_time_us.load(std::memory_order_relaxed);
+	}
+
 private:
+	using Clock = std::chrono::steady_clock;
+
+	// The idle time tracking is only touched by the worker thread
+	void BeginIdle()
+	{
+		if (m_idle)
+			return;
+
+		m_idle = true;
+		m_spinning = true;
+		m_idle_start = Clock::now();
+	}
+
+	void EndSpin()
+	{
+		if (!m_spinning)
+			return;
+
+		m_spinning = false;
+		AddSpinTime(Clock::now() - m_idle_start);
+	}
+
+	void EndIdle()
+	{
+		if (!m_idle)
+			return;
+
+		const auto idle_time = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - m_idle_start);
+		if (m_spinning)
+			AddSpinTime(idle_time);
+		m_idle = false;
+		m_spinning = false;
+
+		// Moving average of the time until new work arrived, long sleeps are capped so the
+		// window reopens soon once the work gets frequent again
+		const s64 sample = std::min<s64>(idle_time.count(), 2 * MAX_SPIN_TIME_US);
+		m_average_idle_time_us += (sample - m_average_idle_time_us) / 8;
+	}
+
+	bool SpinTimedOut() const
+	{
+		const s64 max_spin_us = MAX_SPIN_TIME_US;
+		const s64 window_us = m_average_idle_time_us <= max_spin_us ?
+			std::min(2 * m_average_idle_time_us, max_spin_us) : 0;
+		return Clock::now() - m_idle_start >= std::chrono::microseconds(window_us);
+	}
+
+	void AddSpinTime(Clock::duration duration)
+	{
+		m_spin_time_us.fetch_add(std::chrono::duration_cast<std::chrono::microseconds>(duration).count(),
+			std::memory_order_relaxed);
+	}
+
 	std::mutex m_wait_lock;
 	std::mutex m_prepare_lock;
 
@@ -242,6 +329,14 @@ private:
 	std::atomic<int> m_running_state; // must be of type RUNNING_TYPE
 
 	Flag m_may_sleep; // If this is set, we fall back from the busy loop to an event based synchronization.
+
+	bool m_idle = false;
+	bool m_spinning = false;
+	Clock::time_point m_idle_start;
+	s64 m_average_idle_time_us = MAX_SPIN_TIME_US / 2;
+
+	std::atomic<u64> m_wakeups{ 0 };
+	std::atomic<u64> m_spin_time_us{ 0 };
 };
 
 }
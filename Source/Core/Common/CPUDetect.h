@@ -46,6 +46,8 @@ struct CPUInfo
 	bool bFMA = false;
 	bool bFMA4 = false;
 	bool bAES = false;
+	// SHA-1/SHA-256 extensions
+	bool bSHA = false;
 	// FXSAVE/FXRSTOR
 	bool bFXSR = false;
 	bool bMOVBE = false;
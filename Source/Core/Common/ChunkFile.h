@@ -70,6 +70,11 @@ public:
 	PointerWrap(u8** ptr_, Mode mode_) : ptr(ptr_), mode(mode_) {}
 	void SetMode(Mode mode_) { mode = mode_; }
 	Mode GetMode() const { return mode; }
+	// Writing past end switches to MODE_MEASURE instead, so that a buffer sized from an earlier
+	// state can be written without measuring first. *ptr still ends up past everything the state
+	// needs, the caller retries with a buffer that big when IsWriteLimitReached.
+	void SetWriteLimit(u8* end) { m_write_limit = end; }
+	bool IsWriteLimitReached() const { return m_write_limit_reached; }
 	template <typename K, class V>
 	void Do(std::map<K, V>& x)
 	{
@@ -131,7 +136,7 @@ public:
 	template <typename T>
 	void Do(std::vector<T>& x)
 	{
-		DoContainer(x);
+		DoContiguousContainer(x);
 	}
 
 	template <typename T>
@@ -149,7 +154,7 @@ public:
 	template <typename T>
 	void Do(std::basic_string<T>& x)
 	{
-		DoContainer(x);
+		DoContiguousContainer(x);
 	}
 
 	template <typename T, typename U>
@@ -264,12 +269,41 @@ public:
 	}
 
 private:
+	u8* m_write_limit = nullptr;
+	bool m_write_limit_reached = false;
+
 	template <typename T>
 	void DoContainer(T& x)
 	{
 		DoEachElement(x, [](PointerWrap& p, typename T::value_type& elem) { p.Do(elem); });
 	}
 
+	// Elements that Do would copy one by one are copied all at once, in the same format.
+	// bool is the exception, its size varies and Do always stores it in a byte.
+	template <typename T>
+	void DoContiguousContainer(T& x)
+	{
+		using Elem = typename T::value_type;
+		DoContiguousContainer(x, std::integral_constant<bool, std::is_trivial<Elem>::value &&
+			!std::is_same<Elem, bool>::value>());
+	}
+
+	template <typename T>
+	void DoContiguousContainer(T& x, std::false_type)
+	{
+		DoContainer(x);
+	}
+
+	template <typename T>
+	void DoContiguousContainer(T& x, std::true_type)
+	{
+		u32 size = static_cast<u32>(x.size());
+		Do(size);
+		x.resize(size);
+		if (size)
+			DoVoid(&x[0], size * sizeof(typename T::value_type));
+	}
+
 	__forceinline void DoVoid(void* data, u32 size)
 	{
 		switch (mode)
@@ -279,6 +313,12 @@ private:
 			break;
 
 		case MODE_WRITE:
+			if (m_write_limit && size > static_cast<size_t>(m_write_limit - *ptr))
+			{
+				m_write_limit_reached = true;
+				mode = MODE_MEASURE;
+				break;
+			}
 			memcpy(*ptr, data, size);
 			break;
 
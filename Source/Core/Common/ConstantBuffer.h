@@ -32,6 +32,7 @@
 
 #pragma once
 #include <algorithm>
+#include <cstring>
 #include <utility>
 #include <vector>
 #include "Common.h"
@@ -183,4 +184,24 @@ public:
 		return m_dirtyRegions;
 	}
 
+	// Copies the dirty regions to copy, which holds the values of the last upload.
+	// Returns false if it already held them, so the last upload can be used again.
+	__forceinline bool UpdateCopy(void* copy) const
+	{
+		bool changed = m_dirtyregiondisabled;
+		for (const std::pair<u32, u32>& region : m_dirtyRegions)
+		{
+			const size_t offset = region.first * 4 * sizeof(float);
+			const size_t size = (region.second - region.first + 1) * 4 * sizeof(float);
+			u8* dst = static_cast<u8*>(copy) + offset;
+			const u8* src = static_cast<const u8*>(m_buffer) + offset;
+			if (memcmp(dst, src, size) != 0)
+			{
+				memcpy(dst, src, size);
+				changed = true;
+			}
+		}
+		return changed;
+	}
+
 };
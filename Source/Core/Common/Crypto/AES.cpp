@@ -0,0 +1,147 @@
+// Copyright 2016 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <cstring>
+
+#include "Common/CPUDetect.h"
+#include "Common/Crypto/AES.h"
+#include "Common/Intrinsics.h"
+
+namespace Common
+{
+namespace AES
+{
+#ifdef _M_X86
+// Standard AES-128 key expansion step: rcon has to be a constant, hence the macro.
+#define EXPAND_KEY(prev, rcon) ExpandKeyStep(prev, _mm_aeskeygenassist_si128(prev, rcon))
+
+ATTRIBUTE_TARGET("aes")
+static __m128i ExpandKeyStep(__m128i key, __m128i assist)
+{
+	assist = _mm_shuffle_epi32(assist, _MM_SHUFFLE(3, 3, 3, 3));
+	key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+	key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+	key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+	return _mm_xor_si128(key, assist);
+}
+
+ATTRIBUTE_TARGET("aes")
+static void ExpandDecryptionKeys(const u8* key, u8 (*out)[16])
+{
+	__m128i enc[11];
+	enc[0] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(key));
+	enc[1] = EXPAND_KEY(enc[0], 0x01);
+	enc[2] = EXPAND_KEY(enc[1], 0x02);
+	enc[3] = EXPAND_KEY(enc[2], 0x04);
+	enc[4] = EXPAND_KEY(enc[3], 0x08);
+	enc[5] = EXPAND_KEY(enc[4], 0x10);
+	enc[6] = EXPAND_KEY(enc[5], 0x20);
+	enc[7] = EXPAND_KEY(enc[6], 0x40);
+	enc[8] = EXPAND_KEY(enc[7], 0x80);
+	enc[9] = EXPAND_KEY(enc[8], 0x1B);
+	enc[10] = EXPAND_KEY(enc[9], 0x36);
+
+	// The equivalent inverse cipher runs the keys backwards, with InvMixColumns applied to all
+	// but the first and last one.
+	_mm_store_si128(reinterpret_cast<__m128i*>(out[0]), enc[10]);
+	for (int i = 1; i < 10; i++)
+		_mm_store_si128(reinterpret_cast<__m128i*>(out[i]), _mm_aesimc_si128(enc[10 - i]));
+	_mm_store_si128(reinterpret_cast<__m128i*>(out[10]), enc[0]);
+}
+
+#undef EXPAND_KEY
+
+ATTRIBUTE_TARGET("aes")
+static void DecryptCBCAESNI(const u8 (*round_keys)[16], const u8* iv, const u8* in, u8* out,
+	size_t size)
+{
+	__m128i keys[11];
+	for (int i = 0; i < 11; i++)
+		keys[i] = _mm_load_si128(reinterpret_cast<const __m128i*>(round_keys[i]));
+
+	const __m128i* src = reinterpret_cast<const __m128i*>(in);
+	__m128i* dst = reinterpret_cast<__m128i*>(out);
+	size_t blocks = size / 16;
+	__m128i prev = _mm_loadu_si128(reinterpret_cast<const __m128i*>(iv));
+
+	// Eight independent blocks hide the latency of aesdec.
+	while (blocks >= 8)
+	{
+		__m128i cipher[8];
+		__m128i state[8];
+		for (int j = 0; j < 8; j++)
+		{
+			cipher[j] = _mm_loadu_si128(src + j);
+			state[j] = _mm_xor_si128(cipher[j], keys[0]);
+		}
+		for (int r = 1; r < 10; r++)
+		{
+			for (int j = 0; j < 8; j++)
+				state[j] = _mm_aesdec_si128(state[j], keys[r]);
+		}
+		for (int j = 0; j < 8; j++)
+		{
+			state[j] = _mm_aesdeclast_si128(state[j], keys[10]);
+			_mm_storeu_si128(dst + j, _mm_xor_si128(state[j], j == 0 ? prev : cipher[j - 1]));
+		}
+		prev = cipher[7];
+		src += 8;
+		dst += 8;
+		blocks -= 8;
+	}
+
+	for (; blocks > 0; blocks--)
+	{
+		const __m128i cipher = _mm_loadu_si128(src++);
+		__m128i state = _mm_xor_si128(cipher, keys[0]);
+		for (int r = 1; r < 10; r++)
+			state = _mm_aesdec_si128(state, keys[r]);
+		state = _mm_aesdeclast_si128(state, keys[10]);
+		_mm_storeu_si128(dst++, _mm_xor_si128(state, prev));
+		prev = cipher;
+	}
+}
+#endif
+
+CBCDecryptor::CBCDecryptor(const u8* key)
+{
+	mbedtls_aes_init(&m_ctx);
+	SetKey(key);
+}
+
+CBCDecryptor::~CBCDecryptor()
+{
+	mbedtls_aes_free(&m_ctx);
+}
+
+void CBCDecryptor::SetKey(const u8* key)
+{
+	mbedtls_aes_setkey_dec(&m_ctx, key, 128);
+#ifdef _M_X86
+	m_use_aesni = cpu_info.bAES;
+	if (m_use_aesni)
+		ExpandDecryptionKeys(key, m_round_keys);
+#endif
+}
+
+void CBCDecryptor::DecryptCBC(const u8* iv, const u8* in, u8* out, size_t size) const
+{
+#ifdef _M_X86
+	if (m_use_aesni)
+	{
+		DecryptCBCAESNI(m_round_keys, iv, in, out, size);
+		return;
+	}
+#endif
+
+	// mbedtls updates the IV and wants a mutable context, even though decrypting doesn't
+	// change it.
+	u8 iv_copy[16];
+	std::memcpy(iv_copy, iv, sizeof(iv_copy));
+	mbedtls_aes_crypt_cbc(const_cast<mbedtls_aes_context*>(&m_ctx), MBEDTLS_AES_DECRYPT, size,
+		iv_copy, in, out);
+}
+
+}  // namespace AES
+}  // namespace Common
@@ -0,0 +1,41 @@
+// Copyright 2016 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <mbedtls/aes.h>
+
+#include "Common/CommonTypes.h"
+
+namespace Common
+{
+namespace AES
+{
+// AES-128 CBC decryption for bulk data such as Wii disc clusters.
+// mbedtls decrypts one block at a time, which leaves AES-NI waiting on the latency of every
+// round. CBC decryption has no dependency between blocks, so the AES-NI path keeps eight
+// blocks in flight. Other CPUs use mbedtls.
+// DecryptCBC() doesn't modify the object and can be called from several threads at once.
+class CBCDecryptor
+{
+public:
+	explicit CBCDecryptor(const u8* key);
+	~CBCDecryptor();
+
+	void SetKey(const u8* key);
+
+	// size must be a multiple of 16. in and out may be the same buffer. Unlike mbedtls, iv is
+	// not updated.
+	void DecryptCBC(const u8* iv, const u8* in, u8* out, size_t size) const;
+
+private:
+	mbedtls_aes_context m_ctx;
+	bool m_use_aesni = false;
+	// Decryption round keys for the AES-NI path, in the order they are used.
+	alignas(16) u8 m_round_keys[11][16];
+};
+
+}  // namespace AES
+}  // namespace Common
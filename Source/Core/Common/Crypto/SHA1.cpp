@@ -0,0 +1,168 @@
+// Copyright 2016 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+
+#include "Common/CPUDetect.h"
+#include "Common/Crypto/SHA1.h"
+#include "Common/Intrinsics.h"
+
+namespace Common
+{
+namespace SHA1
+{
+#ifdef _M_X86
+// Four rounds. func selects the round function and constant, which have to be immediates.
+#define SHA1_ROUNDS(func)                                                                          \
+	do                                                                                               \
+	{                                                                                                \
+		if (i > 0)                                                                                     \
+			e = _mm_sha1nexte_epu32(abcd_prev, msg[i % 4]);                                              \
+		abcd_prev = abcd;                                                                              \
+		abcd = _mm_sha1rnds4_epu32(abcd, e, func);                                                     \
+	} while (0)
+
+ATTRIBUTE_TARGET("sha,ssse3,sse4.1")
+static void ProcessBlocksSHANI(u32* state, const u8* data, size_t blocks)
+{
+	const __m128i byte_swap = _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+	__m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0x1B);
+	__m128i e0 = _mm_set_epi32(state[4], 0, 0, 0);
+
+	for (; blocks > 0; blocks--, data += 64)
+	{
+		const __m128i abcd_save = abcd;
+		const __m128i e0_save = e0;
+		__m128i msg[4];
+		for (int j = 0; j < 4; j++)
+		{
+			msg[j] = _mm_shuffle_epi8(
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + j * 16)), byte_swap);
+		}
+
+		__m128i e = _mm_add_epi32(e0, msg[0]);
+		__m128i abcd_prev = abcd;
+		for (int i = 0; i < 20; i++)
+		{
+			// W[4i..4i+3] from the previous sixteen words.
+			if (i >= 4)
+			{
+				msg[i % 4] = _mm_sha1msg2_epu32(
+					_mm_xor_si128(_mm_sha1msg1_epu32(msg[i % 4], msg[(i + 1) % 4]), msg[(i + 2) % 4]),
+					msg[(i + 3) % 4]);
+			}
+
+			if (i < 5)
+				SHA1_ROUNDS(0);
+			else if (i < 10)
+				SHA1_ROUNDS(1);
+			else if (i < 15)
+				SHA1_ROUNDS(2);
+			else
+				SHA1_ROUNDS(3);
+		}
+
+		e0 = _mm_sha1nexte_epu32(abcd_prev, e0_save);
+		abcd = _mm_add_epi32(abcd, abcd_save);
+	}
+
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(state), _mm_shuffle_epi32(abcd, 0x1B));
+	state[4] = static_cast<u32>(_mm_extract_epi32(e0, 3));
+}
+
+#undef SHA1_ROUNDS
+#endif
+
+Context::Context()
+{
+#ifdef _M_X86
+	m_use_sha_ni = cpu_info.bSHA;
+#endif
+	if (m_use_sha_ni)
+	{
+		static const u32 initial_state[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476,
+			0xC3D2E1F0};
+		std::copy(std::begin(initial_state), std::end(initial_state), m_state);
+		return;
+	}
+
+	mbedtls_sha1_init(&m_ctx);
+	mbedtls_sha1_starts(&m_ctx);
+}
+
+Context::~Context()
+{
+	if (!m_use_sha_ni)
+		mbedtls_sha1_free(&m_ctx);
+}
+
+void Context::Update(const u8* data, size_t size)
+{
+	if (!m_use_sha_ni)
+	{
+		mbedtls_sha1_update(&m_ctx, data, size);
+		return;
+	}
+
+#ifdef _M_X86
+	m_length += size;
+	if (m_buffered)
+	{
+		const size_t copy_size = std::min(size, sizeof(m_buffer) - m_buffered);
+		std::memcpy(m_buffer + m_buffered, data, copy_size);
+		m_buffered += copy_size;
+		data += copy_size;
+		size -= copy_size;
+		if (m_buffered < sizeof(m_buffer))
+			return;
+		ProcessBlocksSHANI(m_state, m_buffer, 1);
+		m_buffered = 0;
+	}
+
+	ProcessBlocksSHANI(m_state, data, size / 64);
+	m_buffered = size % 64;
+	std::memcpy(m_buffer, data + size - m_buffered, m_buffered);
+#endif
+}
+
+Digest Context::Finish()
+{
+	Digest digest;
+	if (!m_use_sha_ni)
+	{
+		mbedtls_sha1_finish(&m_ctx, digest.data());
+		return digest;
+	}
+
+#ifdef _M_X86
+	// 0x80, zeros up to 56 bytes into the last block, then the length in bits, big endian.
+	const u64 bit_length = m_length * 8;
+	u8 padding[72] = {0x80};
+	const size_t padding_size = (m_buffered < 56 ? 56 : 120) - m_buffered;
+	Update(padding, padding_size);
+	for (int i = 0; i < 8; i++)
+		padding[i] = static_cast<u8>(bit_length >> (56 - 8 * i));
+	Update(padding, 8);
+
+	for (int i = 0; i < 5; i++)
+	{
+		digest[i * 4 + 0] = static_cast<u8>(m_state[i] >> 24);
+		digest[i * 4 + 1] = static_cast<u8>(m_state[i] >> 16);
+		digest[i * 4 + 2] = static_cast<u8>(m_state[i] >> 8);
+		digest[i * 4 + 3] = static_cast<u8>(m_state[i]);
+	}
+#endif
+	return digest;
+}
+
+Digest CalculateDigest(const u8* data, size_t size)
+{
+	Context context;
+	context.Update(data, size);
+	return context.Finish();
+}
+
+}  // namespace SHA1
+}  // namespace Common
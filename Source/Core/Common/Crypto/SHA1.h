@@ -0,0 +1,43 @@
+// Copyright 2016 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <mbedtls/sha1.h>
+
+#include "Common/CommonTypes.h"
+
+namespace Common
+{
+namespace SHA1
+{
+using Digest = std::array<u8, 20>;
+
+// SHA-1 that uses the SHA extensions on CPUs that have them and mbedtls everywhere else.
+class Context
+{
+public:
+	Context();
+	~Context();
+
+	void Update(const u8* data, size_t size);
+	Digest Finish();
+
+private:
+	bool m_use_sha_ni = false;
+	mbedtls_sha1_context m_ctx;
+
+	// State of the SHA extensions path
+	u32 m_state[5];
+	u64 m_length = 0;
+	u8 m_buffer[64];
+	size_t m_buffered = 0;
+};
+
+Digest CalculateDigest(const u8* data, size_t size);
+
+}  // namespace SHA1
+}  // namespace Common
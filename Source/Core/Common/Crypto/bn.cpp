@@ -8,6 +8,10 @@
 #include "Common/CommonTypes.h"
 #include "Common/Crypto/bn.h"
 
+// Numbers are big endian byte strings of up to 512 bytes. Multiplication and exponentiation
+// work on little endian 32-bit limbs internally.
+static const u32 MAX_LIMBS = 512 / 4;
+
 static void bn_zero(u8* d, u32 n)
 {
 	memset(d, 0, n);
@@ -18,6 +22,96 @@ static void bn_copy(u8* d, const u8* a, u32 n)
 	memcpy(d, a, n);
 }
 
+static u32 limb_count(u32 n)
+{
+	return (n + 3) / 4;
+}
+
+static void limbs_from_bytes(u32* d, const u8* a, u32 n)
+{
+	memset(d, 0, limb_count(n) * sizeof(u32));
+	for (u32 i = 0; i < n; i++)
+		d[i / 4] |= static_cast<u32>(a[n - 1 - i]) << (8 * (i % 4));
+}
+
+static void limbs_to_bytes(u8* d, const u32* a, u32 n)
+{
+	for (u32 i = 0; i < n; i++)
+		d[n - 1 - i] = static_cast<u8>(a[i / 4] >> (8 * (i % 4)));
+}
+
+// Only the low n bytes count, a number of n bytes wraps at 2**(8*n) like the byte version
+static void limbs_truncate(u32* a, u32 n)
+{
+	if (n % 4)
+		a[n / 4] &= (1u << (8 * (n % 4))) - 1;
+}
+
+static int limbs_compare(const u32* a, const u32* b, u32 limbs)
+{
+	for (u32 i = limbs; i-- > 0;)
+	{
+		if (a[i] < b[i])
+			return -1;
+		if (a[i] > b[i])
+			return 1;
+	}
+
+	return 0;
+}
+
+static void limbs_sub_modulus(u32* a, const u32* N, u32 n)
+{
+	const u32 limbs = limb_count(n);
+	u64 borrow = 0;
+	for (u32 i = 0; i < limbs; i++)
+	{
+		const u64 dig = static_cast<u64>(a[i]) - N[i] - borrow;
+		a[i] = static_cast<u32>(dig);
+		borrow = (dig >> 32) & 1;
+	}
+	limbs_truncate(a, n);
+}
+
+static void limbs_add(u32* d, const u32* a, const u32* b, const u32* N, u32 n)
+{
+	const u32 limbs = limb_count(n);
+	u64 dig = 0;
+	for (u32 i = 0; i < limbs; i++)
+	{
+		dig = static_cast<u64>(a[i]) + b[i] + (dig >> 32);
+		d[i] = static_cast<u32>(dig);
+	}
+
+	bool carry = (dig >> 32) != 0;
+	if (n % 4)
+	{
+		carry = (d[limbs - 1] >> (8 * (n % 4))) != 0;
+		limbs_truncate(d, n);
+	}
+
+	if (carry)
+		limbs_sub_modulus(d, N, n);
+
+	if (limbs_compare(d, N, limbs) >= 0)
+		limbs_sub_modulus(d, N, n);
+}
+
+static void limbs_mul(u32* d, const u32* a, const u32* b, const u32* N, u32 n)
+{
+	const u32 limbs = limb_count(n);
+	u32 t[MAX_LIMBS] = {};
+
+	for (u32 bit = n * 8; bit-- > 0;)
+	{
+		limbs_add(t, t, t, N, n);
+		if ((a[bit / 32] >> (bit % 32)) & 1)
+			limbs_add(t, t, b, N, n);
+	}
+
+	memcpy(d, t, limbs * sizeof(u32));
+}
+
 int bn_compare(const u8* a, const u8* b, u32 n)
 {
 	u32 i;
@@ -71,37 +165,32 @@ void bn_add(u8* d, const u8* a, const u8* b, const u8* N, u32 n)
 
 void bn_mul(u8* d, const u8* a, const u8* b, const u8* N, u32 n)
 {
-	u32 i;
-	u8 mask;
-
-	bn_zero(d, n);
+	u32 la[MAX_LIMBS], lb[MAX_LIMBS], lN[MAX_LIMBS];
 
-	for (i = 0; i < n; i++)
-		for (mask = 0x80; mask != 0; mask >>= 1)
-		{
-			bn_add(d, d, d, N, n);
-			if ((a[i] & mask) != 0)
-				bn_add(d, d, b, N, n);
-		}
+	limbs_from_bytes(la, a, n);
+	limbs_from_bytes(lb, b, n);
+	limbs_from_bytes(lN, N, n);
+	limbs_mul(la, la, lb, lN, n);
+	limbs_to_bytes(d, la, n);
 }
 
 void bn_exp(u8* d, const u8* a, const u8* N, u32 n, const u8* e, u32 en)
 {
-	u8 t[512];
+	u32 ld[MAX_LIMBS] = {}, la[MAX_LIMBS], lN[MAX_LIMBS];
 	u32 i;
 	u8 mask;
 
-	bn_zero(d, n);
-	d[n - 1] = 1;
+	limbs_from_bytes(la, a, n);
+	limbs_from_bytes(lN, N, n);
+	ld[0] = 1;
 	for (i = 0; i < en; i++)
 		for (mask = 0x80; mask != 0; mask >>= 1)
 		{
-			bn_mul(t, d, d, N, n);
+			limbs_mul(ld, ld, ld, lN, n);
 			if ((e[i] & mask) != 0)
-				bn_mul(d, t, a, N, n);
-			else
-				bn_copy(d, t, n);
+				limbs_mul(ld, ld, la, lN, n);
 		}
+	limbs_to_bytes(d, ld, n);
 }
 
 // only for prime N -- stupid but lazy, see if I care
@@ -32,132 +32,146 @@ static const u8 ec_G[60] =
 ,0x01,0x00,0x6a,0x08,0xa4,0x19,0x03,0x35,0x06,0x78,0xe5,0x85,0x28,0xbe,0xbf
 ,0x8a,0x0b,0xef,0xf8,0x67,0xa7,0xca,0x36,0x71,0x6f,0x7e,0x01,0xf8,0x10,0x52 };
 
-static void elt_copy(u8* d, const u8* a)
-{
-	memcpy(d, a, 30);
-}
-
-static void elt_zero(u8* d)
-{
-	memset(d, 0, 30);
-}
+// Field elements are polynomials over GF(2) modulo x**233 + x**74 + 1, stored in 64-bit words
+// with the lowest terms first. Bignums and the byte strings outside this file are big endian.
 
-static int elt_is_zero(const u8* d)
+static void elt_from_bytes(u64* d, const u8* a)
 {
 	u32 i;
 
+	memset(d, 0, 4 * sizeof(u64));
 	for (i = 0; i < 30; i++)
-		if (d[i] != 0)
-			return 0;
-
-	return 1;
+		d[i / 8] |= static_cast<u64>(a[29 - i]) << (8 * (i % 8));
 }
 
-static void elt_add(u8* d, const u8* a, const u8* b)
+static void elt_to_bytes(u8* d, const u64* a)
 {
 	u32 i;
 
 	for (i = 0; i < 30; i++)
-		d[i] = a[i] ^ b[i];
+		d[29 - i] = static_cast<u8>(a[i / 8] >> (8 * (i % 8)));
 }
 
-static void elt_mul_x(u8* d, const u8* a)
+static void elt_copy(u64* d, const u64* a)
 {
-	u8 carry, x, y;
-	u32 i;
-
-	carry = a[0] & 1;
-
-	x = 0;
-	for (i = 0; i < 29; i++)
-	{
-		y = a[i + 1];
-		d[i] = x ^ (y >> 7);
-		x = y << 1;
-	}
-	d[29] = x ^ carry;
-
-	d[20] ^= carry << 2;
+	memcpy(d, a, 4 * sizeof(u64));
 }
 
-static void elt_mul(u8* d, const u8* a, const u8* b)
+static void elt_zero(u64* d)
 {
-	u32 i, n;
-	u8 mask;
-
-	elt_zero(d);
-
-	i = 0;
-	mask = 1;
-	for (n = 0; n < 233; n++)
-	{
-		elt_mul_x(d, d);
-
-		if ((a[i] & mask) != 0)
-			elt_add(d, d, b);
-
-		mask >>= 1;
-		if (mask == 0)
-		{
-			mask = 0x80;
-			i++;
-		}
-	}
+	memset(d, 0, 4 * sizeof(u64));
 }
 
-static const u8 square[16] =
-{ 0x00,0x01,0x04,0x05,0x10,0x11,0x14,0x15,0x40,0x41,0x44,0x45,0x50,0x51,0x54,0x55 };
+static int elt_is_zero(const u64* d)
+{
+	return (d[0] | d[1] | d[2] | d[3]) == 0;
+}
 
-static void elt_square_to_wide(u8* d, const u8* a)
+static void elt_add(u64* d, const u64* a, const u64* b)
 {
 	u32 i;
 
-	for (i = 0; i < 30; i++)
-	{
-		d[2 * i] = square[a[i] >> 4];
-		d[2 * i + 1] = square[a[i] & 15];
-	}
+	for (i = 0; i < 4; i++)
+		d[i] = a[i] ^ b[i];
 }
 
-static void wide_reduce(u8* d)
+// x**233 = x**74 + 1, a word at x**(64*i) folds onto x**(64*i - 233) and x**(64*i - 159)
+static void wide_reduce(u64* d)
 {
 	u32 i;
-	u8 x;
+	u64 x;
 
-	for (i = 0; i < 30; i++)
+	for (i = 7; i >= 4; i--)
 	{
 		x = d[i];
 
-		d[i + 19] ^= x >> 7;
-		d[i + 20] ^= x << 1;
+		d[i - 4] ^= x << 23;
+		d[i - 3] ^= x >> 41;
 
-		d[i + 29] ^= x >> 1;
-		d[i + 30] ^= x << 7;
+		d[i - 3] ^= x << 33;
+		d[i - 2] ^= x >> 31;
 	}
 
-	x = d[30] & ~1;
+	x = d[3] >> 41;
+
+	d[0] ^= x;
+	d[1] ^= x << 10;
+
+	d[3] &= (1ULL << 41) - 1;
+}
+
+static void elt_mul(u64* d, const u64* a, const u64* b)
+{
+	u64 table[16][5];
+	u64 wide[8] = {};
+	u32 i, j;
+	int k;
+
+	// b times every polynomial of degree below 4
+	memset(table[0], 0, sizeof(table[0]));
+	for (i = 0; i < 4; i++)
+		table[1][i] = b[i];
+	table[1][4] = 0;
+	for (i = 2; i < 16; i += 2)
+	{
+		table[i][0] = table[i / 2][0] << 1;
+		for (j = 1; j < 5; j++)
+			table[i][j] = (table[i / 2][j] << 1) | (table[i / 2][j - 1] >> 63);
+		for (j = 0; j < 5; j++)
+			table[i + 1][j] = table[i][j] ^ table[1][j];
+	}
 
-	d[49] ^= x >> 7;
-	d[50] ^= x << 1;
+	for (k = 60; k >= 0; k -= 4)
+	{
+		for (i = 0; i < 4; i++)
+		{
+			const u64* t = table[(a[i] >> k) & 15];
+			for (j = 0; j < 5 && i + j < 8; j++)
+				wide[i + j] ^= t[j];
+		}
+		if (k != 0)
+		{
+			for (i = 7; i > 0; i--)
+				wide[i] = (wide[i] << 4) | (wide[i - 1] >> 60);
+			wide[0] <<= 4;
+		}
+	}
 
-	d[59] ^= x >> 1;
+	wide_reduce(wide);
+	elt_copy(d, wide);
+}
 
-	d[30] &= 1;
+// Squaring puts a zero between every two bits
+static u64 spread_bits(u32 a)
+{
+	u64 x = a;
+
+	x = (x | (x << 16)) & 0x0000FFFF0000FFFFULL;
+	x = (x | (x << 8)) & 0x00FF00FF00FF00FFULL;
+	x = (x | (x << 4)) & 0x0F0F0F0F0F0F0F0FULL;
+	x = (x | (x << 2)) & 0x3333333333333333ULL;
+	x = (x | (x << 1)) & 0x5555555555555555ULL;
+	return x;
 }
 
-static void elt_square(u8* d, const u8* a)
+static void elt_square(u64* d, const u64* a)
 {
-	u8 wide[60];
+	u64 wide[8];
+	u32 i;
 
-	elt_square_to_wide(wide, a);
+	for (i = 0; i < 4; i++)
+	{
+		wide[2 * i] = spread_bits(static_cast<u32>(a[i]));
+		wide[2 * i + 1] = spread_bits(static_cast<u32>(a[i] >> 32));
+	}
 	wide_reduce(wide);
 
-	elt_copy(d, wide + 30);
+	elt_copy(d, wide);
 }
 
-static void itoh_tsujii(u8* d, const u8* a, const u8* b, u32 j)
+static void itoh_tsujii(u64* d, const u64* a, const u64* b, u32 j)
 {
-	u8 t[30];
+	u64 t[4];
 
 	elt_copy(t, a);
 	while (j--)
@@ -169,10 +183,10 @@ static void itoh_tsujii(u8* d, const u8* a, const u8* b, u32 j)
 	elt_mul(d, t, b);
 }
 
-static void elt_inv(u8* d, const u8* a)
+static void elt_inv(u64* d, const u64* a)
 {
-	u8 t[30];
-	u8 s[30];
+	u64 t[4];
+	u64 s[4];
 
 	itoh_tsujii(t, a, a, 1);
 	itoh_tsujii(s, t, a, 1);
@@ -187,13 +201,26 @@ static void elt_inv(u8* d, const u8* a)
 	elt_square(d, s);
 }
 
-UNUSED static int point_is_on_curve(u8* p)
+// Points are the x and y elements one after the other
+static void point_from_bytes(u64* d, const u8* a)
+{
+	elt_from_bytes(d, a);
+	elt_from_bytes(d + 4, a + 30);
+}
+
+static void point_to_bytes(u8* d, const u64* a)
 {
-	u8 s[30], t[30];
-	u8* x, *y;
+	elt_to_bytes(d, a);
+	elt_to_bytes(d + 30, a + 4);
+}
+
+UNUSED static int point_is_on_curve(const u64* p)
+{
+	u64 s[4], t[4], b[4];
+	const u64* x, *y;
 
 	x = p;
-	y = p + 30;
+	y = p + 4;
 
 	elt_square(t, x);
 	elt_mul(s, t, x);
@@ -206,26 +233,27 @@ UNUSED static int point_is_on_curve(u8* p)
 	elt_mul(t, x, y);
 	elt_add(s, s, t);
 
-	elt_add(s, s, ec_b);
+	elt_from_bytes(b, ec_b);
+	elt_add(s, s, b);
 
 	return elt_is_zero(s);
 }
 
-static int point_is_zero(const u8* p)
+static int point_is_zero(const u64* p)
 {
-	return elt_is_zero(p) && elt_is_zero(p + 30);
+	return elt_is_zero(p) && elt_is_zero(p + 4);
 }
 
-static void point_double(u8* r, const u8* p)
+static void point_double(u64* r, const u64* p)
 {
-	u8 s[30], t[30];
-	const u8* px, *py;
-	u8* rx, *ry;
+	u64 s[4], t[4];
+	const u64* px, *py;
+	u64* rx, *ry;
 
 	px = p;
-	py = p + 30;
+	py = p + 4;
 	rx = r;
-	ry = r + 30;
+	ry = r + 4;
 
 	if (elt_is_zero(px))
 	{
@@ -243,25 +271,25 @@ static void point_double(u8* r, const u8* p)
 
 	elt_square(rx, s);
 	elt_add(rx, rx, s);
-	rx[29] ^= 1;
+	rx[0] ^= 1;
 
 	elt_mul(ry, s, rx);
 	elt_add(ry, ry, rx);
 	elt_add(ry, ry, t);
 }
 
-static void point_add(u8* r, const u8* p, const u8* q)
+static void point_add(u64* r, const u64* p, const u64* q)
 {
-	u8 s[30], t[30], u[30];
-	const u8* px, *py, *qx, *qy;
-	u8* rx, *ry;
+	u64 s[4], t[4], u[4];
+	const u64* px, *py, *qx, *qy;
+	u64* rx, *ry;
 
 	px = p;
-	py = p + 30;
+	py = p + 4;
 	qx = q;
-	qy = q + 30;
+	qy = q + 4;
 	rx = r;
-	ry = r + 30;
+	ry = r + 4;
 
 	if (point_is_zero(p))
 	{
@@ -300,7 +328,7 @@ static void point_add(u8* r, const u8* p, const u8* q)
 	elt_square(t, s);
 	elt_add(t, t, s);
 	elt_add(t, t, qx);
-	t[29] ^= 1;
+	t[0] ^= 1;
 
 	elt_mul(u, s, t);
 	elt_add(s, u, py);
@@ -308,13 +336,13 @@ static void point_add(u8* r, const u8* p, const u8* q)
 	elt_add(ry, s, rx);
 }
 
-static void point_mul(u8* d, const u8* a, const u8* b) // a is bignum
+static void point_mul(u64* d, const u8* a, const u64* b) // a is bignum
 {
 	u32 i;
 	u8 mask;
 
 	elt_zero(d);
-	elt_zero(d + 30);
+	elt_zero(d + 4);
 
 	for (i = 0; i < 30; i++)
 		for (mask = 0x80; mask != 0; mask >>= 1)
@@ -325,6 +353,33 @@ static void point_mul(u8* d, const u8* a, const u8* b) // a is bignum
 		}
 }
 
+// 2**i * G for every bit of a bignum, computed on first use
+struct BasePointTable
+{
+	u64 points[240][8];
+
+	BasePointTable()
+	{
+		point_from_bytes(points[0], ec_G);
+		for (u32 i = 1; i < 240; i++)
+			point_double(points[i], points[i - 1]);
+	}
+};
+
+// Only adds, the doublings are in the table
+static void point_mul_G(u64* d, const u8* a) // a is bignum
+{
+	static const BasePointTable table;
+	u32 i;
+
+	elt_zero(d);
+	elt_zero(d + 4);
+
+	for (i = 0; i < 240; i++)
+		if ((a[29 - i / 8] >> (i % 8)) & 1)
+			point_add(d, d, table.points[i]);
+}
+
 static void silly_random(u8 * rndArea, u8 count)
 {
 	u16 i;
@@ -342,10 +397,10 @@ void generate_ecdsa(u8* R, u8* S, const u8* k, const u8* hash)
 	u8 kk[30];
 	u8 m[30];
 	u8 minv[30];
-	u8 mG[60];
+	u64 mG[8];
 	//FILE *fp;
 
-	elt_zero(e);
+	memset(e, 0, 30);
 	memcpy(e + 10, hash, 20);
 
 	//Changing random number generator to a lame one...
@@ -358,14 +413,14 @@ void generate_ecdsa(u8* R, u8* S, const u8* k, const u8* hash)
 
 	//	R = (mG).x
 
-	point_mul(mG, m, ec_G);
-	elt_copy(R, mG);
+	point_mul_G(mG, m);
+	elt_to_bytes(R, mG);
 	if (bn_compare(R, ec_N, 30) >= 0)
 		bn_sub_modulus(R, ec_N, 30);
 
 	//	S = m**-1*(e + Rk) (mod N)
 
-	elt_copy(kk, k);
+	memcpy(kk, k, 30);
 	if (bn_compare(kk, ec_N, 30) >= 0)
 		bn_sub_modulus(kk, ec_N, 30);
 	bn_mul(S, R, kk, ec_N, 30);
@@ -379,28 +434,34 @@ UNUSED static int check_ecdsa(u8* Q, u8* R, u8* S, const u8* hash)
 	u8 Sinv[30];
 	u8 e[30];
 	u8 w1[30], w2[30];
-	u8 r1[60], r2[60];
+	u64 q[8], r1[8], r2[8];
+	u8 rx[30];
 
 	bn_inv(Sinv, S, ec_N, 30);
 
-	elt_zero(e);
+	memset(e, 0, 30);
 	memcpy(e + 10, hash, 20);
 
 	bn_mul(w1, e, Sinv, ec_N, 30);
 	bn_mul(w2, R, Sinv, ec_N, 30);
 
-	point_mul(r1, w1, ec_G);
-	point_mul(r2, w2, Q);
+	point_from_bytes(q, Q);
+	point_mul_G(r1, w1);
+	point_mul(r2, w2, q);
 
 	point_add(r1, r1, r2);
 
-	if (bn_compare(r1, ec_N, 30) >= 0)
-		bn_sub_modulus(r1, ec_N, 30);
+	elt_to_bytes(rx, r1);
+	if (bn_compare(rx, ec_N, 30) >= 0)
+		bn_sub_modulus(rx, ec_N, 30);
 
-	return (bn_compare(r1, R, 30) == 0);
+	return (bn_compare(rx, R, 30) == 0);
 }
 
 void ec_priv_to_pub(const u8* k, u8* Q)
 {
-	point_mul(Q, k, ec_G);
+	u64 q[8];
+
+	point_mul_G(q, k);
+	point_to_bytes(Q, q);
 }
@@ -0,0 +1,87 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Common/FileLock.h"
+#include "Common/StringUtil.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+#endif
+
+namespace File
+{
+FileLock::~FileLock()
+{
+	Close();
+}
+
+bool FileLock::Open(const std::string& filename)
+{
+	Close();
+#ifdef _WIN32
+	HANDLE file = CreateFile(UTF8ToTStr(filename).c_str(), GENERIC_READ | GENERIC_WRITE,
+		FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_ALWAYS,
+		FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+	m_file = file;
+#else
+	m_fd = open(filename.c_str(), O_RDWR | O_CREAT, 0644);
+	if (m_fd < 0)
+		return false;
+#endif
+	return true;
+}
+
+void FileLock::Close()
+{
+#ifdef _WIN32
+	if (!m_file)
+		return;
+	CloseHandle(m_file);
+	m_file = nullptr;
+#else
+	if (m_fd < 0)
+		return;
+	close(m_fd);
+	m_fd = -1;
+#endif
+}
+
+void FileLock::lock()
+{
+#ifdef _WIN32
+	if (!m_file)
+		return;
+	OVERLAPPED overlapped = {};
+	LockFileEx(m_file, LOCKFILE_EXCLUSIVE_LOCK, 0, 1, 0, &overlapped);
+#else
+	if (m_fd < 0)
+		return;
+	while (flock(m_fd, LOCK_EX) != 0 && errno == EINTR)
+	{
+	}
+#endif
+}
+
+void FileLock::unlock()
+{
+#ifdef _WIN32
+	if (!m_file)
+		return;
+	OVERLAPPED overlapped = {};
+	UnlockFileEx(m_file, 0, 1, 0, &overlapped);
+#else
+	if (m_fd < 0)
+		return;
+	flock(m_fd, LOCK_UN);
+#endif
+}
+
+}  // namespace File
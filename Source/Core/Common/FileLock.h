@@ -0,0 +1,37 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+
+#include "Common/CommonTypes.h"
+#include "Common/NonCopyable.h"
+
+namespace File
+{
+// Exclusive lock shared between processes, held on a file of its own next to the data it guards.
+// It is advisory, only the code that takes the same lock is kept out. Usable with std::lock_guard.
+// A lock that couldn't be opened does nothing, the callers are left as unprotected as without it.
+class FileLock : public NonCopyable
+{
+public:
+	FileLock() {}
+	~FileLock();
+
+	bool Open(const std::string& filename);
+	void Close();
+
+	void lock();
+	void unlock();
+
+private:
+#ifdef _WIN32
+	void* m_file = nullptr;
+#else
+	int m_fd = -1;
+#endif
+};
+
+}  // namespace File
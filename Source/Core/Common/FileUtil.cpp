@@ -424,6 +424,20 @@ u64 GetSize(FILE* f)
 	return size;
 }
 
+// Returns the last modification time of filename in seconds since the epoch
+u64 GetModificationTime(const std::string& filename)
+{
+	struct stat buf;
+#ifdef _WIN32
+	if (_tstat64(UTF8ToTStr(filename).c_str(), &buf) == 0)
+#else
+	if (stat(filename.c_str(), &buf) == 0)
+#endif
+		return static_cast<u64>(buf.st_mtime);
+
+	return 0;
+}
+
 // creates an empty file filename, returns true on success
 bool CreateEmptyFile(const std::string& filename)
 {
@@ -1003,6 +1017,21 @@ bool IOFile::Flush()
 	return m_good;
 }
 
+bool IOFile::Sync()
+{
+	if (!Flush() ||
+		0 !=
+#ifdef _WIN32
+		_commit(_fileno(m_file))
+#else
+		fsync(fileno(m_file))
+#endif
+		)
+		m_good = false;
+
+	return m_good;
+}
+
 bool IOFile::Resize(u64 size)
 {
 	if (!IsOpen() ||
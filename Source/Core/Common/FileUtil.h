@@ -89,6 +89,9 @@ u64 GetSize(const int fd);
 // Overloaded GetSize, accepts FILE*
 u64 GetSize(FILE* f);
 
+// Returns the last modification time of filename in seconds since the epoch, or 0 on failure
+u64 GetModificationTime(const std::string& filename);
+
 // Returns true if successful, or path already exists.
 bool CreateDir(const std::string& filename);
 
@@ -224,6 +227,8 @@ public:
 	u64 GetSize();
 	bool Resize(u64 size);
 	bool Flush();
+	// Flushes and waits until the data is on the disk
+	bool Sync();
 
 	// clear error state
 	void Clear()
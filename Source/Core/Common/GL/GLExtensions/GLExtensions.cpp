@@ -899,6 +899,11 @@ PFNDOLGETSYNCIVPROC dolGetSynciv;
 PFNDOLISSYNCPROC dolIsSync;
 PFNDOLWAITSYNCPROC dolWaitSync;
 
+// ARB_timer_query
+PFNDOLQUERYCOUNTERPROC dolQueryCounter;
+PFNDOLGETQUERYOBJECTI64VPROC dolGetQueryObjecti64v;
+PFNDOLGETQUERYOBJECTUI64VPROC dolGetQueryObjectui64v;
+
 // ARB_texture_multisample
 PFNDOLTEXIMAGE2DMULTISAMPLEPROC dolTexImage2DMultisample;
 PFNDOLTEXIMAGE3DMULTISAMPLEPROC dolTexImage3DMultisample;
@@ -951,6 +956,9 @@ PFNDOLDEBUGMESSAGECONTROLARBPROC dolDebugMessageControlARB;
 PFNDOLDEBUGMESSAGEINSERTARBPROC dolDebugMessageInsertARB;
 PFNDOLGETDEBUGMESSAGELOGARBPROC dolGetDebugMessageLogARB;
 
+// KHR_parallel_shader_compile
+PFNDOLMAXSHADERCOMPILERTHREADSKHRPROC dolMaxShaderCompilerThreads;
+
 // KHR_debug
 PFNDOLDEBUGMESSAGECALLBACKPROC dolDebugMessageCallback;
 PFNDOLDEBUGMESSAGECONTROLPROC dolDebugMessageControl;
@@ -1670,6 +1678,11 @@ const GLFunc gl_function_array[] = {
 								GLFUNC_REQUIRES(glIsSync, "GL_ARB_sync |VERSION_GLES_3"),
 								GLFUNC_REQUIRES(glWaitSync, "GL_ARB_sync |VERSION_GLES_3"),
 
+								// ARB_timer_query
+								GLFUNC_REQUIRES(glQueryCounter, "GL_ARB_timer_query"),
+								GLFUNC_REQUIRES(glGetQueryObjecti64v, "GL_ARB_timer_query"),
+								GLFUNC_REQUIRES(glGetQueryObjectui64v, "GL_ARB_timer_query"),
+
 								// ARB_texture_multisample
 								GLFUNC_REQUIRES(glTexImage2DMultisample, "GL_ARB_texture_multisample"),
 								GLFUNC_REQUIRES(glTexImage3DMultisample, "GL_ARB_texture_multisample"),
@@ -1756,6 +1769,13 @@ const GLFunc gl_function_array[] = {
 	GLFUNC_REQUIRES(glDebugMessageInsertARB, "GL_ARB_debug_output"),
 	GLFUNC_REQUIRES(glGetDebugMessageLogARB, "GL_ARB_debug_output"),
 
+	// KHR_parallel_shader_compile
+	GLFUNC_SUFFIX(glMaxShaderCompilerThreads, KHR, "GL_KHR_parallel_shader_compile"),
+
+	// ARB_parallel_shader_compile
+	GLFUNC_SUFFIX(glMaxShaderCompilerThreads, ARB,
+								"GL_ARB_parallel_shader_compile !GL_KHR_parallel_shader_compile"),
+
 	// KHR_debug
 	GLFUNC_SUFFIX(glDebugMessageCallback, KHR, "GL_KHR_debug VERSION_GLES_3"),
 	GLFUNC_SUFFIX(glDebugMessageControl, KHR, "GL_KHR_debug VERSION_GLES_3"),
@@ -1793,6 +1813,10 @@ const GLFunc gl_function_array[] = {
 	GLFUNC_SUFFIX(glNamedBufferStorage, EXT,
 								"GL_ARB_buffer_storage GL_EXT_direct_state_access !VERSION_4_5"),
 
+	// ARB_multi_bind
+	GLFUNC_REQUIRES(glBindTextures, "GL_ARB_multi_bind !VERSION_4_4"),
+	GLFUNC_REQUIRES(glBindSamplers, "GL_ARB_multi_bind !VERSION_4_4"),
+
 	// EXT_buffer_storage
 	GLFUNC_SUFFIX(glBufferStorage, EXT,
 								"GL_EXT_buffer_storage !GL_ARB_buffer_storage !VERSION_4_4"),
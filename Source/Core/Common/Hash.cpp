@@ -4,10 +4,18 @@
 
 #include <algorithm>
 #include <cstring>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <xxhash.h>
 #include "Common/CommonFuncs.h"
 #include "Common/CPUDetect.h"
+#include "Common/FileUtil.h"
 #include "Common/Hash.h"
 #include "Common/Intrinsics.h"
+#include "Common/Timer.h"
+#include "Common/Logging/Log.h"
 
 static u64(*ptrHashFunction)(const u8* src, u32 len, u32 samples) = &GetMurmurHash3;
 
@@ -473,30 +481,114 @@ u64 GetMurmurHash3(const u8* src, u32 len, u32 samples)
 }
 #endif
 
+u64 GetXXHash64(const u8* src, u32 len, u32 samples)
+{
+	return XXH64(src, len, samples);
+}
+
 u64 GetHash64(const u8* src, u32 len, u32 samples)
 {
 	return ptrHashFunction(src, len, samples);
 }
 
-// sets the hash function used for the texture cache
-void SetHash64Function()
+namespace
+{
+struct HashFunction
+{
+	const char* name;
+	u64(*func)(const u8* src, u32 len, u32 samples);
+};
+
+std::vector<HashFunction> GetHashFunctions()
 {
+	std::vector<HashFunction> functions = { { "Murmur3", &GetMurmurHash3 },{ "XXH64", &GetXXHash64 } };
 #if _M_SSE >= 0x402
-	if (cpu_info.bSSE4_2) // sse crc32 version
-	{
-		ptrHashFunction = &GetCRC32;
-	}
-	else
+	if (cpu_info.bSSE4_2)
+		functions.push_back({ "CRC32", &GetCRC32 });
 #elif defined(_M_ARM_64)
 	if (cpu_info.bCRC32)
+		functions.push_back({ "CRC32", &GetCRC32 });
+#endif
+	return functions;
+}
+
+// Best of a few runs over texture sized data, whole and with the safe texture cache samples
+u64 MeasureHashFunction(const HashFunction& function, const std::vector<u8>& data)
+{
+	static const u32 s_samples[] = { 0, 512 };
+	u64 best = std::numeric_limits<u64>::max();
+	volatile u64 result = 0;
+	for (int run = 0; run < 5; run++)
 	{
-		ptrHashFunction = &GetCRC32;
+		const u64 start = Common::Timer::GetTimeUs();
+		for (u32 samples : s_samples)
+		{
+			for (u32 size = 1024; size <= data.size(); size *= 8)
+				result = result + function.func(data.data(), size, samples);
+		}
+		best = std::min(best, Common::Timer::GetTimeUs() - start);
 	}
-	else
-#endif
+	return best;
+}
+
+HashFunction BenchmarkHashFunctions(const std::vector<HashFunction>& functions)
+{
+	std::vector<u8> data(512 * 1024);
+	for (size_t i = 0; i < data.size(); i++)
+		data[i] = static_cast<u8>(i * 2654435761u >> 24);
+
+	HashFunction fastest = functions[0];
+	u64 fastest_time = std::numeric_limits<u64>::max();
+	for (const HashFunction& function : functions)
 	{
-		ptrHashFunction = &GetMurmurHash3;
+		const u64 time = MeasureHashFunction(function, data);
+		INFO_LOG(VIDEO, "Hash function %s: %llu us", function.name, static_cast<unsigned long long>(time));
+		if (time < fastest_time)
+		{
+			fastest = function;
+			fastest_time = time;
+		}
 	}
+	return fastest;
+}
+}
+
+// sets the hash function used for the texture cache
+// The fastest one is measured once per CPU and remembered in the cache directory, so the hashes
+// that end up in disk caches do not change between runs.
+void SetHash64Function()
+{
+	static bool s_chosen = false;
+	if (s_chosen)
+		return;
+	s_chosen = true;
+
+	const std::vector<HashFunction> functions = GetHashFunctions();
+	const std::string cpu = cpu_info.cpu_string;
+	const std::string& cache_dir = File::GetUserPath(D_CACHE_IDX);
+	const std::string filename = cache_dir + "HashFunction.txt";
+
+	std::string contents;
+	if (File::ReadFileToString(filename, contents))
+	{
+		std::istringstream stream(contents);
+		std::string saved_cpu, saved_name;
+		std::getline(stream, saved_cpu);
+		std::getline(stream, saved_name);
+		auto it = std::find_if(functions.begin(), functions.end(),
+			[&saved_name](const HashFunction& f) { return saved_name == f.name; });
+		if (saved_cpu == cpu && it != functions.end())
+		{
+			ptrHashFunction = it->func;
+			return;
+		}
+	}
+
+	const HashFunction fastest = BenchmarkHashFunctions(functions);
+	NOTICE_LOG(VIDEO, "Using the %s texture hash", fastest.name);
+	ptrHashFunction = fastest.func;
+	if (!cache_dir.empty() && File::IsDirectory(cache_dir))
+		File::WriteStringToFile(cpu + "\n" + fastest.name + "\n", filename);
 }
 
 
@@ -13,5 +13,6 @@ u32 HashAdler32(const u8* data, size_t len);         // Fairly accurate, slightl
 u32 HashEctor(const u8* ptr, int length);            // JUNK. DO NOT USE FOR NEW THINGS
 u64 GetCRC32(const u8* src, u32 len, u32 samples);   // SSE4.2 version of CRC32
 u64 GetMurmurHash3(const u8* src, u32 len, u32 samples);
+u64 GetXXHash64(const u8* src, u32 len, u32 samples);
 u64 GetHash64(const u8* src, u32 len, u32 samples);
 void SetHash64Function();
@@ -28,4 +28,12 @@
 # endif
 #endif
 
+// Lets a single function use instructions beyond the build's baseline, for code that is
+// only reached after checking cpu_info. MSVC allows any intrinsic without it.
+#ifdef _MSC_VER
+#define ATTRIBUTE_TARGET(x)
+#else
+#define ATTRIBUTE_TARGET(x) __attribute__((target(x)))
+#endif
+
 #endif // _M_X86
@@ -4,27 +4,42 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cstring>
 #include <fstream>
+#include <mutex>
 #include <string>
 #include <type_traits>
+#include <vector>
 
 #include "Common/Common.h"
 #include "Common/CommonTypes.h"
+#include "Common/FileLock.h"
 #include "Common/FileUtil.h"
+#include "Common/MappedFile.h"
 
 // On disk format:
 //header{
-// u32 'DCAC';
-// u32 version;  // svn_rev
+// u32 'DCA2';
 // u16 sizeof(key_type);
 // u16 sizeof(value_type);
+// char version[40];  // svn_rev
+// u32 record_count;  // key_value_pairs in the file, including overwritten keys
+// u32 index_count;
+// u64 index_offset;  // 0 while the file is being appended to, ~0 once it was replaced
 //}
 
 //key_value_pair{
 // u32 value_size;
 // key_type   key;
 // value_type[value_size]   value;
+// u32 entry_number;
+//}
+
+//index_entry{  // after the last key_value_pair, one per live key
+// key_type   key;
+// u32 value_size;
+// u64 value_offset;
 //}
 
 template <typename K, typename V>
@@ -35,11 +50,24 @@ public:
 };
 
 // Dead simple unsorted key-value store with append functionality.
-// No random read functionality, all reading is done in OpenAndRead.
 // Keys and values can contain any characters, including \0.
 //
+// The file is memory mapped on open and the index stored at its end is used to find the
+// entries, so values are only touched when they are read: either all of them through
+// OpenAndRead or one by one through Find. A file that wasn't closed properly is recovered by
+// scanning the records. Files where more than a quarter of the records were overwritten by
+// later appends of the same key are compacted on open. Files of a different version are
+// discarded as a whole.
+//
+// Several processes can use the same file at once, like emulator instances sharing a user
+// directory. Opening, appending and closing take a lock file next to it, and an instance first
+// takes in the records the others appended, so each record lands at the end with the next entry
+// number. The mapping is shared, so the values read by all of them are in memory once. Records
+// appended by other instances show up the next time the file is opened. Compacting replaces the
+// file with a new one and marks the old one as replaced, the other instances then reopen the file
+// before they append to it.
+//
 // Suitable for caching generated shader bytecode between executions.
-// Not tuned for extreme performance but should be reasonably fast.
 // Does not support keys or values larger than 2GB, which should be reasonable.
 // Keys must have non-zero length; values can have zero length.
 
@@ -50,11 +78,9 @@ template <typename K, typename V>
 class LinearDiskCache
 {
 public:
-	// return number of read entries
-	u32 OpenAndRead(const std::string& filename, LinearDiskCacheReader<K, V> &reader)
+	// Opens the cache without reading the values, returns the number of entries.
+	u32 Open(const std::string& filename)
 	{
-		using std::ios_base;
-
 		// Since we're reading/writing directly to the storage of K instances,
 		// K must be trivially copyable. TODO: Remove #if once GCC 5.0 is a
 		// minimum requirement.
@@ -66,67 +92,76 @@ public:
 
 		// close any currently opened file
 		Close();
-		m_num_entries = 0;
-
-		// try opening for reading/writing
-		OpenFStream(m_file, filename, ios_base::in | ios_base::out | ios_base::binary);
+		m_filename = filename;
+		m_lock.Open(filename + ".lock");
+		std::lock_guard<File::FileLock> guard(m_lock);
 
-		m_file.seekg(0, std::ios::end);
-		std::fstream::pos_type end_pos = m_file.tellg();
-		m_file.seekg(0, std::ios::beg);
-		std::fstream::pos_type start_pos = m_file.tellg();
-		std::streamoff file_size = end_pos - start_pos;
+		if (Load())
+			return static_cast<u32>(m_index.size());
 
+		// failed to open file for reading or bad header
+		// close and recreate file
+		CloseFiles();
+		// ValidateHeader took the counts and the index offset from the rejected file
 		m_header.Init();
-		if (m_file.is_open() && ValidateHeader())
+		m_filename = filename;
+		// Other instances can still map the rejected file, so it is replaced instead of truncated
+		// under them, and marked so they reopen the new one.
+		if (File::Exists(filename))
 		{
-			// good header, read some key/value pairs
-			K key;
-
-			V* value = nullptr;
-			u32 value_size = 0;
-			u32 entry_number = 0;
-
-			std::fstream::pos_type last_pos = m_file.tellg();
+			Header replaced_header = m_header;
+			replaced_header.index_offset = REPLACED_INDEX_OFFSET;
+			WriteFileHeader(replaced_header);
+		}
+		const std::string temp_filename = filename + ".tmp";
+		std::fstream temp;
+		OpenFStream(temp, temp_filename, std::ios_base::out | std::ios_base::trunc | std::ios_base::binary);
+		const bool written = temp.is_open() &&
+			temp.write(reinterpret_cast<const char*>(&m_header), sizeof(m_header)).good();
+		temp.close();
+		if (!written || !File::Rename(temp_filename, filename))
+		{
+			// Nothing is cached until the next Open
+			File::Delete(temp_filename);
+			return 0;
+		}
+		OpenFStream(m_file, filename, std::ios_base::in | std::ios_base::out | std::ios_base::binary);
+		m_append_offset = sizeof(Header);
+		m_file.seekp(m_append_offset);
+		return 0;
+	}
 
-			while (Read(&value_size))
+	// return number of read entries
+	u32 OpenAndRead(const std::string& filename, LinearDiskCacheReader<K, V> &reader)
+	{
+		u32 count = Open(filename);
+		std::vector<V> aligned_value;
+		for (const IndexEntry& entry : m_index)
+		{
+			const V* value = GetValue(entry);
+			// Values are packed behind the keys, copy them if V needs a stricter alignment.
+			if (reinterpret_cast<uintptr_t>(value) % alignof(V) != 0)
 			{
-				std::streamoff next_extent = (last_pos - start_pos) + sizeof(value_size) + value_size;
-				if (next_extent > file_size)
-					break;
-
-				delete[] value;
-				value = new V[value_size];
-
-				// read key/value and pass to reader
-				if (Read(&key) &&
-					Read(value, value_size) &&
-					Read(&entry_number) &&
-					entry_number == m_num_entries + 1)
-				{
-					reader.Read(key, value, value_size);
-				}
-				else
-				{
-					break;
-				}
-
-				m_num_entries++;
-				last_pos = m_file.tellg();
+				aligned_value.resize(entry.value_size);
+				std::memcpy(aligned_value.data(), value, entry.value_size * sizeof(V));
+				value = aligned_value.data();
 			}
-			m_file.seekp(last_pos);
-			m_file.clear();
-
-			delete[] value;
-			return m_num_entries;
+			reader.Read(entry.key, value, entry.value_size);
 		}
+		return count;
+	}
 
-		// failed to open file for reading or bad header
-		// close and recreate file
-		Close();
-		m_file.open(filename, ios_base::out | ios_base::trunc | ios_base::binary);
-		WriteHeader();
-		return 0;
+	// Returns the value stored for key when the cache was opened, or nullptr.
+	// Entries appended since then aren't visible. The pointer is valid until the next Append or
+	// Close, and might not be aligned for V if sizeof(K) isn't a multiple of its alignment.
+	const V* Find(const K& key, u32* value_size) const
+	{
+		auto it = std::lower_bound(m_lookup.begin(), m_lookup.end(), key,
+			[this](u32 index, const K& k) { return KeyLess(m_index[index].key, k); });
+		if (it == m_lookup.end() || KeyLess(key, m_index[*it].key))
+			return nullptr;
+		*value_size = m_index[*it].value_size;
+		return GetValue(m_index[*it]);
 	}
 
 	void Sync()
@@ -137,46 +172,377 @@ public:
 	void Close()
 	{
 		if (m_file.is_open())
+		{
+			std::lock_guard<File::FileLock> guard(m_lock);
+			if (CatchUp())
+				WriteIndex();
 			m_file.close();
-		// clear any error flags
-		m_file.clear();
+		}
+		CloseFiles();
+		m_lock.Close();
 	}
 
 	// Appends a key-value pair to the store.
 	void Append(const K& key, const V* value, u32 value_size)
 	{
+		std::lock_guard<File::FileLock> guard(m_lock);
+		// The file was replaced by another instance, leave it to that one
+		if (!CatchUp())
+			return;
+
 		// TODO: Should do a check that we don't already have "key"? (I think each caller does that already.)
+		if (m_header.index_offset != 0)
+		{
+			// The records overwrite the index, invalidate it until Close writes the new one
+			m_index_valid = false;
+			m_header.index_offset = 0;
+			m_file.seekp(0);
+			WriteHeader();
+			m_file.flush();
+			m_file.seekp(m_append_offset);
+		}
+		IndexEntry entry;
+		entry.key = key;
+		entry.value_size = value_size;
+		entry.value_offset = m_append_offset + sizeof(value_size) + sizeof(K);
+		m_index.push_back(entry);
+
 		Write(&value_size);
 		Write(&key);
 		Write(value, value_size);
 		m_num_entries++;
 		Write(&m_num_entries);
+		m_append_offset = entry.value_offset + value_size * sizeof(V) + sizeof(m_num_entries);
+		// Complete before the others can look at the file
+		m_file.flush();
 	}
 
 private:
-	void WriteHeader()
+	struct Header;
+
+	struct IndexEntry
 	{
-		Write(&m_header);
+		K key;
+		u32 value_size;
+		u64 value_offset;
+	};
+
+	static constexpr u64 INDEX_ENTRY_SIZE = sizeof(K) + sizeof(u32) + sizeof(u64);
+	// Header index_offset of a file that Compact replaced while other instances had it open
+	static constexpr u64 REPLACED_INDEX_OFFSET = ~0ULL;
+
+	// With the lock held. Maps m_filename and opens it for appending, compacting it first if needed.
+	bool Load()
+	{
+		m_header.Init();
+		if (!m_map.Open(m_filename) || !ValidateHeader() || !(ReadIndex() || ScanRecords()) ||
+			!BuildLookup() || (m_stale_records * 4 > m_index.size() && !Compact()))
+			return false;
+
+		// The mapping stays readable while the records are appended behind it
+		OpenFStream(m_file, m_filename, std::ios_base::in | std::ios_base::out | std::ios_base::binary);
+		if (!m_file.is_open())
+			return false;
+		m_file.seekp(m_append_offset);
+		return true;
 	}
 
-	bool ValidateHeader()
+	// Close without the lock or the index
+	void CloseFiles()
 	{
-		char file_header[sizeof(Header)];
+		m_file.close();
+		// clear any error flags
+		m_file.clear();
+		m_map.Close();
+		m_index.clear();
+		m_lookup.clear();
+		m_num_entries = 0;
+		m_stale_records = 0;
+		m_append_offset = 0;
+		m_index_valid = false;
+	}
 
-		return (Read(file_header, sizeof(Header)) &&
-			!memcmp((const char*)&m_header, file_header, sizeof(Header)));
+	template <typename D>
+	bool ReadFile(u64 offset, D* data)
+	{
+		m_file.seekg(offset);
+		return m_file.read(reinterpret_cast<char*>(data), sizeof(D)).good();
+	}
+
+	// With the lock held. Takes in the records other instances appended since this one last wrote,
+	// and leaves the put position at the end of them. Returns false if the file was recreated
+	// below what this instance has seen.
+	bool CatchUp()
+	{
+		m_file.flush();
+		Header file_header;
+		if (!ReadFile(0, &file_header))
+		{
+			m_file.clear();
+			return false;
+		}
+		if (file_header.index_offset == REPLACED_INDEX_OFFSET)
+		{
+			// Another instance compacted the file, which only left this one the old copy. The new
+			// file has all the records of the old one.
+			CloseFiles();
+			return Load();
+		}
+		m_file.seekg(0, std::ios_base::end);
+		const u64 size = static_cast<u64>(m_file.tellg());
+		const u64 end = file_header.index_offset ? file_header.index_offset : size;
+		if (end < m_append_offset || end > size)
+			return false;
+
+		u64 offset = m_append_offset;
+		u32 value_size;
+		while (offset < end && ReadFile(offset, &value_size))
+		{
+			IndexEntry entry;
+			entry.value_size = value_size;
+			entry.value_offset = offset + sizeof(value_size) + sizeof(K);
+			const u64 entry_number_offset = entry.value_offset + u64(value_size) * sizeof(V);
+			u32 entry_number;
+			if (entry_number_offset + sizeof(entry_number) > end ||
+				!ReadFile(offset + sizeof(value_size), &entry.key) ||
+				!ReadFile(entry_number_offset, &entry_number) || entry_number != m_num_entries + 1)
+				break;
+			m_index.push_back(entry);
+			m_num_entries++;
+			m_index_valid = false;
+			offset = entry_number_offset + sizeof(entry_number);
+		}
+		// A record cut short by an instance that crashed is overwritten
+		m_file.clear();
+		m_append_offset = offset;
+		m_header.index_offset = file_header.index_offset;
+		m_file.seekp(m_append_offset);
+		return true;
+	}
+
+	static bool KeyLess(const K& a, const K& b)
+	{
+		return std::memcmp(&a, &b, sizeof(K)) < 0;
 	}
 
 	template <typename D>
-	bool Write(const D* data, u32 count = 1)
+	bool ReadMapped(u64 offset, D* data) const
 	{
-		return m_file.write((const char*)data, count * sizeof(D)).good();
+		if (offset + sizeof(D) > m_map.GetSize())
+			return false;
+		std::memcpy(data, m_map.GetData() + offset, sizeof(D));
+		return true;
+	}
+
+	const V* GetValue(const IndexEntry& entry) const
+	{
+		return reinterpret_cast<const V*>(m_map.GetData() + entry.value_offset);
+	}
+
+	bool ValidateHeader()
+	{
+		Header file_header;
+		if (!ReadMapped(0, &file_header) ||
+			std::memcmp(&m_header, &file_header, Header::IDENTITY_SIZE) != 0)
+			return false;
+		m_header.record_count = file_header.record_count;
+		m_header.index_count = file_header.index_count;
+		m_header.index_offset = file_header.index_offset;
+		return true;
+	}
+
+	bool ReadIndex()
+	{
+		const u64 offset = m_header.index_offset;
+		const u64 count = m_header.index_count;
+		if (offset < sizeof(Header) || offset > m_map.GetSize() ||
+			count * INDEX_ENTRY_SIZE > m_map.GetSize() - offset)
+			return false;
+		m_index.resize(static_cast<size_t>(count));
+		const u8* data = m_map.GetData() + offset;
+		for (IndexEntry& entry : m_index)
+		{
+			std::memcpy(&entry.key, data, sizeof(K));
+			std::memcpy(&entry.value_size, data + sizeof(K), sizeof(u32));
+			std::memcpy(&entry.value_offset, data + sizeof(K) + sizeof(u32), sizeof(u64));
+			data += INDEX_ENTRY_SIZE;
+			if (entry.value_offset < sizeof(Header) ||
+				entry.value_offset + u64(entry.value_size) * sizeof(V) > offset)
+			{
+				m_index.clear();
+				return false;
+			}
+		}
+		m_num_entries = m_header.record_count;
+		m_stale_records = m_num_entries > count ? m_num_entries - static_cast<u32>(count) : 0;
+		m_append_offset = offset;
+		m_index_valid = true;
+		return true;
+	}
+
+	// Recovers the entries of a file whose index wasn't written, stops at the first broken record.
+	bool ScanRecords()
+	{
+		u64 offset = sizeof(Header);
+		u32 value_size;
+		while (ReadMapped(offset, &value_size))
+		{
+			IndexEntry entry;
+			entry.value_size = value_size;
+			entry.value_offset = offset + sizeof(value_size) + sizeof(K);
+			u64 entry_number_offset = entry.value_offset + u64(value_size) * sizeof(V);
+			u32 entry_number;
+			if (!ReadMapped(offset + sizeof(value_size), &entry.key) ||
+				!ReadMapped(entry_number_offset, &entry_number) ||
+				entry_number != m_num_entries + 1)
+				break;
+			m_index.push_back(entry);
+			m_num_entries++;
+			offset = entry_number_offset + sizeof(entry_number);
+		}
+		m_append_offset = offset;
+		return true;
+	}
+
+	// Drops the records overwritten by a later one with the same key and sorts the lookup table.
+	bool BuildLookup()
+	{
+		m_lookup.resize(m_index.size());
+		for (u32 i = 0; i < m_lookup.size(); i++)
+			m_lookup[i] = i;
+		std::stable_sort(m_lookup.begin(), m_lookup.end(),
+			[this](u32 a, u32 b) { return KeyLess(m_index[a].key, m_index[b].key); });
+
+		std::vector<bool> live(m_index.size(), true);
+		size_t dropped = 0;
+		for (size_t i = 1; i < m_lookup.size(); i++)
+		{
+			if (!KeyLess(m_index[m_lookup[i - 1]].key, m_index[m_lookup[i]].key))
+			{
+				live[m_lookup[i - 1]] = false;
+				dropped++;
+			}
+		}
+		if (dropped == 0)
+			return true;
+
+		std::vector<IndexEntry> index;
+		index.reserve(m_index.size() - dropped);
+		for (size_t i = 0; i < m_index.size(); i++)
+		{
+			if (live[i])
+				index.push_back(m_index[i]);
+		}
+		m_index.swap(index);
+		m_stale_records += static_cast<u32>(dropped);
+		m_index_valid = false;
+		return BuildLookup();
+	}
+
+	// Rewrites the file with only the live entries. Returns false if the file was lost.
+	bool Compact()
+	{
+		std::string temp_filename = m_filename + ".tmp";
+		std::fstream temp;
+		OpenFStream(temp, temp_filename, std::ios_base::out | std::ios_base::trunc | std::ios_base::binary);
+		if (!temp.is_open())
+			return true;
+
+		Header header;
+		header.Init();
+		temp.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		std::vector<IndexEntry> index(m_index);
+		u64 offset = sizeof(Header);
+		u32 entry_number = 0;
+		for (IndexEntry& entry : index)
+		{
+			entry_number++;
+			temp.write(reinterpret_cast<const char*>(&entry.value_size), sizeof(u32));
+			temp.write(reinterpret_cast<const char*>(&entry.key), sizeof(K));
+			temp.write(reinterpret_cast<const char*>(GetValue(entry)), entry.value_size * sizeof(V));
+			temp.write(reinterpret_cast<const char*>(&entry_number), sizeof(u32));
+			entry.value_offset = offset + sizeof(u32) + sizeof(K);
+			offset = entry.value_offset + entry.value_size * sizeof(V) + sizeof(u32);
+		}
+		bool written = temp.good();
+		temp.close();
+		if (!written)
+		{
+			// Keep using the old file
+			File::Delete(temp_filename);
+			return true;
+		}
+
+		// Other instances keep appending to the old file after the rename, mark it so they reopen
+		// the new one. The lock is held, so none of them sees the mark if the rename fails.
+		Header replaced_header = m_header;
+		replaced_header.index_offset = REPLACED_INDEX_OFFSET;
+		if (!WriteFileHeader(replaced_header))
+		{
+			File::Delete(temp_filename);
+			return true;
+		}
+
+		// Renaming over a file with open handles fails on Windows, so this instance closes its own
+		// first. The rename still fails while other instances have the file open there.
+		m_map.Close();
+		if (!File::Rename(temp_filename, m_filename))
+		{
+			WriteFileHeader(m_header);
+			File::Delete(temp_filename);
+			return m_map.Open(m_filename);
+		}
+		if (!m_map.Open(m_filename))
+			return false;
+		m_index.swap(index);
+		BuildLookup();
+		m_num_entries = entry_number;
+		m_stale_records = 0;
+		m_append_offset = offset;
+		m_index_valid = false;
+		return true;
+	}
+
+	void WriteIndex()
+	{
+		if (m_index_valid)
+			return;
+		// Keep only the latest record of keys appended more than once
+		BuildLookup();
+		m_file.seekp(m_append_offset);
+		for (const IndexEntry& entry : m_index)
+		{
+			Write(&entry.key);
+			Write(&entry.value_size);
+			Write(&entry.value_offset);
+		}
+		m_header.record_count = m_num_entries;
+		m_header.index_count = static_cast<u32>(m_index.size());
+		m_header.index_offset = m_append_offset;
+		m_file.seekp(0);
+		WriteHeader();
+		m_index_valid = true;
+	}
+
+	void WriteHeader()
+	{
+		Write(&m_header);
+	}
+
+	// Overwrites the header of the file at m_filename through a handle of its own, closed again
+	// before returning.
+	bool WriteFileHeader(const Header& header)
+	{
+		std::fstream file;
+		OpenFStream(file, m_filename, std::ios_base::in | std::ios_base::out | std::ios_base::binary);
+		return file.is_open() &&
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header)).flush().good();
 	}
 
 	template <typename D>
-	bool Read(const D* data, u32 count = 1)
+	bool Write(const D* data, u32 count = 1)
 	{
-		return m_file.read((char*)data, count * sizeof(D)).good();
+		return m_file.write((const char*)data, count * sizeof(D)).good();
 	}
 
 	struct Header
@@ -184,17 +550,36 @@ private:
 		void Init()
 		{
 			// Null-terminator is intentionally not copied.
-			std::memcpy(&id, "DCAC", sizeof(u32));
+			std::memcpy(&id, "DCA2", sizeof(u32));
 			std::memcpy(ver, scm_rev_cache_str.c_str(), std::min(scm_rev_cache_str.size(), sizeof(ver)));
+			record_count = 0;
+			index_count = 0;
+			index_offset = 0;
 		}
 
 		u32 id;
-		const u16 key_t_size = sizeof(K);
-		const u16 value_t_size = sizeof(V);
+		u16 key_t_size = sizeof(K);
+		u16 value_t_size = sizeof(V);
 		char ver[40] = {};
+		u32 record_count = 0;
+		u32 index_count = 0;
+		u64 index_offset = 0;
 
+		// Files are only compatible when everything up to here matches
+		static constexpr size_t IDENTITY_SIZE = sizeof(u32) + 2 * sizeof(u16) + 40;
 	} m_header;
 
+	std::string m_filename;
+	File::FileLock m_lock;
+	File::MappedFile m_map;
 	std::fstream m_file;
-	u32 m_num_entries;
+	// Live entries in file order
+	std::vector<IndexEntry> m_index;
+	// m_index sorted by key, for Find
+	std::vector<u32> m_lookup;
+	u32 m_num_entries = 0;
+	u32 m_stale_records = 0;
+	u64 m_append_offset = 0;
+	// The index in the file matches m_index
+	bool m_index_valid = false;
 };
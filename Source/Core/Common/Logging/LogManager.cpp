@@ -2,8 +2,12 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <chrono>
 #include <cstdarg>
 #include <cstring>
+#include <ctime>
+#include <memory>
 #include <mutex>
 #include <ostream>
 #include <set>
@@ -16,7 +20,7 @@
 #include "Common/Logging/Log.h"
 #include "Common/Logging/LogManager.h"
 #include "Common/StringUtil.h"
-#include "Common/Timer.h"
+#include "Common/Thread.h"
 
 void GenericLog(LogTypes::LOG_LEVELS level, LogTypes::LOG_TYPE type, const char* file, int line,
 	const char* fmt, ...)
@@ -30,6 +34,89 @@ void GenericLog(LogTypes::LOG_LEVELS level, LogTypes::LOG_TYPE type, const char*
 
 LogManager* LogManager::m_logManager = nullptr;
 
+struct LogEntry
+{
+	u64 sequence;
+	u64 time_ms;
+	const char* file;
+	int line;
+	LogTypes::LOG_LEVELS level;
+	LogTypes::LOG_TYPE type;
+	char text[MAX_MSGLEN];
+};
+
+// Written by one thread and read by the writer, without locks
+struct LogRing
+{
+	static const u32 SIZE = 128;
+
+	std::array<LogEntry, SIZE> entries;
+	// Only the owner advances head and only the writer advances tail
+	std::atomic<u32> head{0};
+	std::atomic<u32> tail{0};
+	std::atomic<bool> in_use{true};
+};
+
+// The writer waits at most this long before it writes what was logged
+static const std::chrono::milliseconds WRITE_INTERVAL(10);
+
+// The rings are never freed, the ring of a thread that exited is reused by the next thread
+// that logs. The writer still writes the messages the old thread left in it.
+static std::mutex s_rings_lock;
+static std::vector<LogRing*> s_rings;
+
+static LogRing* AcquireRing()
+{
+	std::lock_guard<std::mutex> lk(s_rings_lock);
+	for (LogRing* ring : s_rings)
+	{
+		bool in_use = false;
+		if (ring->in_use.compare_exchange_strong(in_use, true))
+			return ring;
+	}
+	s_rings.push_back(new LogRing());
+	return s_rings.back();
+}
+
+class ThreadRing
+{
+public:
+	~ThreadRing()
+	{
+		if (m_ring)
+			m_ring->in_use.store(false, std::memory_order_release);
+	}
+
+	LogRing* Get()
+	{
+		if (!m_ring)
+			m_ring = AcquireRing();
+		return m_ring;
+	}
+
+private:
+	LogRing* m_ring = nullptr;
+};
+
+static thread_local ThreadRing t_ring;
+static thread_local bool t_is_writer = false;
+
+static u64 GetTimeMs()
+{
+	return std::chrono::duration_cast<std::chrono::milliseconds>(
+		std::chrono::system_clock::now().time_since_epoch())
+		.count();
+}
+
+// Same format as Timer::GetTimeFormatted, for the time the message was logged
+static std::string FormatTime(u64 time_ms)
+{
+	const time_t seconds = static_cast<time_t>(time_ms / 1000);
+	char tmp[6];
+	strftime(tmp, sizeof(tmp), "%M:%S", localtime(&seconds));
+	return StringFromFormat("%s:%03d", tmp, static_cast<int>(time_ms % 1000));
+}
+
 static size_t DeterminePathCutOffPoint()
 {
 	constexpr const char* pattern = DIR_SEP "Source" DIR_SEP "Core" DIR_SEP;
@@ -41,6 +128,8 @@ static size_t DeterminePathCutOffPoint()
 
 LogManager::LogManager()
 {
+	m_listeners.fill(nullptr);
+
 	// create log containers
 	m_Log[LogTypes::ACTIONREPLAY] = new LogContainer("ActionReplay", "ActionReplay");
 	m_Log[LogTypes::AUDIO] = new LogContainer("Audio", "Audio Emulator");
@@ -114,10 +203,20 @@ LogManager::LogManager()
 	}
 
 	m_path_cutoff_point = DeterminePathCutOffPoint();
+
+	m_writer = std::thread(&LogManager::WriterThread, this);
 }
 
 LogManager::~LogManager()
 {
+	// The writer writes everything that is left before it exits
+	{
+		std::lock_guard<std::mutex> lk(m_writer_lock);
+		m_writer_running = false;
+	}
+	m_writer_wake.notify_one();
+	m_writer.join();
+
 	for (LogContainer* container : m_Log)
 		delete container;
 
@@ -129,22 +228,143 @@ LogManager::~LogManager()
 void LogManager::Log(LogTypes::LOG_LEVELS level, LogTypes::LOG_TYPE type, const char* file,
 	int line, const char* format, va_list args)
 {
-	char temp[MAX_MSGLEN];
 	LogContainer* log = m_Log[type];
 
 	if (!log->IsEnabled() || level > log->GetLevel() || !log->HasListeners())
 		return;
 
-	CharArrayFromFormatV(temp, MAX_MSGLEN, format, args);
+	LogRing* ring = t_ring.Get();
+	const u32 head = ring->head.load(std::memory_order_relaxed);
+	while (head - ring->tail.load(std::memory_order_acquire) >= LogRing::SIZE)
+	{
+		// The writer can't make room while it's the one logging, from a listener
+		if (t_is_writer)
+			return;
+		WakeWriter();
+		std::this_thread::yield();
+	}
 
-	const char* path_to_print = file + m_path_cutoff_point;
+	LogEntry& entry = ring->entries[head % LogRing::SIZE];
+	CharArrayFromFormatV(entry.text, MAX_MSGLEN, format, args);
+	entry.time_ms = GetTimeMs();
+	entry.file = file + m_path_cutoff_point;
+	entry.line = line;
+	entry.level = level;
+	entry.type = type;
+	entry.sequence = m_next_sequence.fetch_add(1, std::memory_order_relaxed);
+	ring->head.store(head + 1, std::memory_order_release);
 
-	std::string msg = StringFromFormat(
-		"%s %s:%u %c[%s]: %s\n", Common::Timer::GetTimeFormatted().c_str(), path_to_print, line,
-		LogTypes::LOG_LEVEL_TO_CHAR[(int)level], log->GetShortName().c_str(), temp);
+	// Don't wait for the interval when a burst of messages is filling the ring
+	if (head + 1 - ring->tail.load(std::memory_order_relaxed) == LogRing::SIZE / 2)
+		WakeWriter();
+}
 
-	for (auto listener_id : *log)
-		m_listeners[listener_id]->Log(level, msg.c_str());
+void LogManager::Flush()
+{
+	if (t_is_writer)
+		return;
+
+	const u64 target = m_next_sequence.load();
+	std::unique_lock<std::mutex> lk(m_writer_lock);
+	m_wake_requested = true;
+	m_writer_wake.notify_one();
+	m_written_event.wait(lk, [&] { return m_written >= target || !m_writer_running; });
+}
+
+void LogManager::RegisterListener(LogListener::LISTENER id, LogListener* listener)
+{
+	std::lock_guard<std::mutex> lk(m_listener_lock);
+	m_listeners[id] = listener;
+}
+
+void LogManager::WakeWriter()
+{
+	{
+		std::lock_guard<std::mutex> lk(m_writer_lock);
+		m_wake_requested = true;
+	}
+	m_writer_wake.notify_one();
+}
+
+void LogManager::WriterThread()
+{
+	Common::SetCurrentThreadName("Log writer");
+	t_is_writer = true;
+
+	std::vector<std::pair<LogRing*, u32>> rings;
+	std::vector<const LogEntry*> batch;
+	while (true)
+	{
+		if (WriteBatch(rings, batch))
+			continue;
+
+		std::unique_lock<std::mutex> lk(m_writer_lock);
+		if (!m_writer_running)
+			break;
+		m_writer_wake.wait_for(lk, WRITE_INTERVAL,
+			[this] { return m_wake_requested || !m_writer_running; });
+		m_wake_requested = false;
+	}
+}
+
+size_t LogManager::WriteBatch(std::vector<std::pair<LogRing*, u32>>& rings,
+	std::vector<const LogEntry*>& batch)
+{
+	rings.clear();
+	{
+		std::lock_guard<std::mutex> lk(s_rings_lock);
+		for (LogRing* ring : s_rings)
+			rings.emplace_back(ring, ring->head.load(std::memory_order_acquire));
+	}
+
+	batch.clear();
+	for (const auto& ring : rings)
+	{
+		for (u32 i = ring.first->tail.load(std::memory_order_relaxed); i != ring.second; i++)
+			batch.push_back(&ring.first->entries[i % LogRing::SIZE]);
+	}
+	if (batch.empty())
+		return 0;
+
+	// Interleave the threads in the order they logged
+	std::sort(batch.begin(), batch.end(),
+		[](const LogEntry* a, const LogEntry* b) { return a->sequence < b->sequence; });
+
+	{
+		std::lock_guard<std::mutex> lk(m_listener_lock);
+		BitSet32 written_to;
+		for (const LogEntry* entry : batch)
+		{
+			LogContainer* log = m_Log[entry->type];
+			if (!log->HasListeners())
+				continue;
+
+			std::string msg = StringFromFormat(
+				"%s %s:%u %c[%s]: %s\n", FormatTime(entry->time_ms).c_str(), entry->file, entry->line,
+				LogTypes::LOG_LEVEL_TO_CHAR[(int)entry->level], log->GetShortName().c_str(), entry->text);
+
+			for (auto listener_id : *log)
+			{
+				if (m_listeners[listener_id])
+				{
+					m_listeners[listener_id]->Log(entry->level, msg.c_str());
+					written_to[listener_id] = true;
+				}
+			}
+		}
+		for (auto listener_id : written_to)
+			m_listeners[listener_id]->Flush();
+	}
+
+	for (const auto& ring : rings)
+		ring.first->tail.store(ring.second, std::memory_order_release);
+
+	{
+		std::lock_guard<std::mutex> lk(m_writer_lock);
+		m_written += batch.size();
+	}
+	m_written_event.notify_all();
+	return batch.size();
 }
 
 void LogManager::Init()
@@ -175,5 +395,14 @@ void FileLogListener::Log(LogTypes::LOG_LEVELS, const char* msg)
 		return;
 
 	std::lock_guard<std::mutex> lk(m_log_lock);
-	m_logfile << msg << std::flush;
+	m_logfile << msg;
+}
+
+void FileLogListener::Flush()
+{
+	if (!IsValid())
+		return;
+
+	std::lock_guard<std::mutex> lk(m_log_lock);
+	m_logfile.flush();
 }
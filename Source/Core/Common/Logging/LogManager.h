@@ -5,11 +5,16 @@
 #pragma once
 
 #include <array>
+#include <atomic>
+#include <condition_variable>
 #include <cstdarg>
 #include <fstream>
 #include <mutex>
 #include <set>
 #include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include "Common/BitSet.h"
 #include "Common/CommonTypes.h"
@@ -24,6 +29,8 @@ class LogListener
 public:
 	virtual ~LogListener() {}
 	virtual void Log(LogTypes::LOG_LEVELS, const char* msg) = 0;
+	// Called after every batch of messages, listeners that buffer their output write it here.
+	virtual void Flush() {}
 
 	enum LISTENER
 	{
@@ -41,6 +48,7 @@ public:
 	FileLogListener(const std::string& filename);
 
 	void Log(LogTypes::LOG_LEVELS, const char* msg) override;
+	void Flush() override;
 
 	bool IsValid() const { return m_logfile.good(); }
 	bool IsEnabled() const { return m_enable; }
@@ -80,7 +88,12 @@ private:
 };
 
 class ConsoleListener;
+struct LogEntry;
+struct LogRing;
 
+// Log only formats the message into a ring buffer of the calling thread, a writer thread
+// timestamps the messages of all the threads, sends them to the listeners in the order they
+// were logged and flushes the listeners once per batch.
 class LogManager : NonCopyable
 {
 private:
@@ -89,13 +102,34 @@ private:
 	std::array<LogListener*, LogListener::NUMBER_OF_LISTENERS> m_listeners;
 	size_t m_path_cutoff_point = 0;
 
+	// Held by the writer while it calls the listeners
+	std::mutex m_listener_lock;
+
+	std::thread m_writer;
+	std::mutex m_writer_lock;
+	std::condition_variable m_writer_wake;
+	std::condition_variable m_written_event;
+	bool m_writer_running = true;
+	bool m_wake_requested = false;
+	// Messages taken from the rings, the next one gets this sequence number
+	std::atomic<u64> m_next_sequence{0};
+	// Messages the listeners received, guarded by m_writer_lock
+	u64 m_written = 0;
+
 	LogManager();
 	~LogManager();
 
+	void WriterThread();
+	size_t WriteBatch(std::vector<std::pair<LogRing*, u32>>& rings,
+		std::vector<const LogEntry*>& batch);
+	void WakeWriter();
+
 public:
 	static u32 GetMaxLevel() { return MAX_LOGLEVEL; }
 	void Log(LogTypes::LOG_LEVELS level, LogTypes::LOG_TYPE type, const char* file, int line,
 		const char* fmt, va_list args);
+	// Blocks until the listeners received everything logged before the call.
+	void Flush();
 
 	void SetLogLevel(LogTypes::LOG_TYPE type, LogTypes::LOG_LEVELS level)
 	{
@@ -110,10 +144,8 @@ public:
 
 	std::string GetShortName(LogTypes::LOG_TYPE type) const { return m_Log[type]->GetShortName(); }
 	std::string GetFullName(LogTypes::LOG_TYPE type) const { return m_Log[type]->GetFullName(); }
-	void RegisterListener(LogListener::LISTENER id, LogListener* listener)
-	{
-		m_listeners[id] = listener;
-	}
+	// The writer doesn't use the previous listener of id anymore when this returns.
+	void RegisterListener(LogListener::LISTENER id, LogListener* listener);
 
 	void AddListener(LogTypes::LOG_TYPE type, LogListener::LISTENER id)
 	{
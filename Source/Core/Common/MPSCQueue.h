@@ -0,0 +1,119 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+// a lockless thread-safe,
+// multiple writer, single reader queue
+//
+// Push is wait-free: a writer swaps itself in as the new head and then links the previous head
+// to it. Until the link is stored the reader can't see the element, or any element pushed after
+// it, so Pop may return false while a Push is in progress. The element shows up on a later Pop.
+
+#include <atomic>
+#include <utility>
+
+namespace Common
+{
+
+template <typename T>
+class MPSCQueue
+{
+public:
+	MPSCQueue() : m_head(&m_stub), m_tail(&m_stub)
+	{
+	}
+
+	~MPSCQueue()
+	{
+		Clear();
+	}
+
+	MPSCQueue(const MPSCQueue&) = delete;
+	MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+	// Any thread
+	template <typename Arg>
+	void Push(Arg&& t)
+	{
+		PushNode(new Node(std::forward<Arg>(t)));
+	}
+
+	// Only the reader thread
+	bool Empty() const
+	{
+		// m_tail is the next element to pop, unless it is the stub
+		return m_tail == &m_stub && !m_stub.next.load(std::memory_order_acquire);
+	}
+
+	// Only the reader thread
+	bool Pop(T& t)
+	{
+		Node* tail = m_tail;
+		Node* next = tail->next.load(std::memory_order_acquire);
+		if (tail == &m_stub)
+		{
+			if (!next)
+				return false;
+			m_tail = next;
+			tail = next;
+			next = next->next.load(std::memory_order_acquire);
+		}
+
+		if (!next)
+		{
+			// A writer swapped the head but didn't link it yet
+			if (tail != m_head.load(std::memory_order_acquire))
+				return false;
+
+			// tail is the last element, put the stub behind it so it can be unlinked
+			PushNode(&m_stub);
+			next = tail->next.load(std::memory_order_acquire);
+			if (!next)
+				return false;
+		}
+
+		m_tail = next;
+		t = std::move(tail->value);
+		delete tail;
+		return true;
+	}
+
+	// Only the reader thread
+	void Clear()
+	{
+		for (T t; Pop(t);)
+		{
+		}
+	}
+
+private:
+	struct Node
+	{
+		Node() : next(nullptr)
+		{
+		}
+		template <typename Arg>
+		explicit Node(Arg&& t) : next(nullptr), value(std::forward<Arg>(t))
+		{
+		}
+
+		std::atomic<Node*> next;
+		T value;
+	};
+
+	void PushNode(Node* node)
+	{
+		node->next.store(nullptr, std::memory_order_relaxed);
+		Node* prev = m_head.exchange(node, std::memory_order_acq_rel);
+		prev->next.store(node, std::memory_order_release);
+	}
+
+	// The writers only touch m_head, keep it away from the reader's line
+	alignas(64) std::atomic<Node*> m_head;
+	alignas(64) Node* m_tail;
+	Node m_stub;
+};
+
+}
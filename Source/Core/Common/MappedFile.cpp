@@ -0,0 +1,122 @@
+// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+
+#include "Common/MappedFile.h"
+#include "Common/StringUtil.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace File
+{
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+bool MappedFile::Open(const std::string& filename)
+{
+	Close();
+#ifdef _WIN32
+	HANDLE file = CreateFile(UTF8ToTStr(filename).c_str(), GENERIC_READ,
+		FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+	{
+		CloseHandle(file);
+		return false;
+	}
+	HANDLE mapping = CreateFileMapping(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mapping)
+	{
+		CloseHandle(file);
+		return false;
+	}
+	void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!data)
+	{
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+	m_file = file;
+	m_mapping = mapping;
+	m_size = static_cast<u64>(size.QuadPart);
+#else
+	int fd = open(filename.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size == 0)
+	{
+		close(fd);
+		return false;
+	}
+	void* data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+	// The mapping holds its own reference to the file.
+	close(fd);
+	if (data == MAP_FAILED)
+		return false;
+	m_size = static_cast<u64>(st.st_size);
+#endif
+	m_data = static_cast<const u8*>(data);
+	return true;
+}
+
+void MappedFile::Prefetch(u64 offset, u64 size) const
+{
+	if (!m_data || offset >= m_size)
+		return;
+	size = std::min(size, m_size - offset);
+
+	// Both calls want the range aligned to pages.
+	const u64 page_size = 4096;
+	const u64 start = offset & ~(page_size - 1);
+	size += offset - start;
+#ifdef _WIN32
+	// PrefetchVirtualMemory is only available starting with Windows 8.
+	typedef BOOL(WINAPI * PrefetchVirtualMemoryFn)(HANDLE, ULONG_PTR, PWIN32_MEMORY_RANGE_ENTRY,
+		ULONG);
+	static const PrefetchVirtualMemoryFn prefetch = reinterpret_cast<PrefetchVirtualMemoryFn>(
+		GetProcAddress(GetModuleHandle(TEXT("kernel32.dll")), "PrefetchVirtualMemory"));
+	if (!prefetch)
+		return;
+	WIN32_MEMORY_RANGE_ENTRY range;
+	range.VirtualAddress = const_cast<u8*>(m_data + start);
+	range.NumberOfBytes = static_cast<SIZE_T>(size);
+	prefetch(GetCurrentProcess(), 1, &range, 0);
+#else
+	madvise(const_cast<u8*>(m_data + start), static_cast<size_t>(size), MADV_WILLNEED);
+#endif
+}
+
+void MappedFile::Close()
+{
+	if (!m_data)
+		return;
+#ifdef _WIN32
+	UnmapViewOfFile(m_data);
+	CloseHandle(m_mapping);
+	CloseHandle(m_file);
+	m_mapping = nullptr;
+	m_file = nullptr;
+#else
+	munmap(const_cast<u8*>(m_data), static_cast<size_t>(m_size));
+#endif
+	m_data = nullptr;
+	m_size = 0;
+}
+
+}  // namespace File
@@ -0,0 +1,43 @@
+// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+
+#include "Common/CommonTypes.h"
+#include "Common/NonCopyable.h"
+
+namespace File
+{
+// Read-only view of a whole file.
+// The file can still be written through other handles while it is mapped, the view keeps the
+// size the file had when it was opened.
+class MappedFile : public NonCopyable
+{
+public:
+	MappedFile() {}
+	~MappedFile();
+
+	bool Open(const std::string& filename);
+	void Close();
+
+	bool IsOpen() const { return m_data != nullptr; }
+	const u8* GetData() const { return m_data; }
+	u64 GetSize() const { return m_size; }
+
+	// Hints the OS to start paging in the given range, for reads that are about to happen.
+	// Out-of-range parts are ignored.
+	void Prefetch(u64 offset, u64 size) const;
+
+private:
+	const u8* m_data = nullptr;
+	u64 m_size = 0;
+#ifdef _WIN32
+	void* m_file = nullptr;
+	void* m_mapping = nullptr;
+#endif
+};
+
+}  // namespace File
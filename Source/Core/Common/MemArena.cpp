@@ -10,6 +10,7 @@
 #include "Common/CommonTypes.h"
 #include "Common/Logging/Log.h"
 #include "Common/MemArena.h"
+#include "Common/MemoryUtil.h"
 #include "Common/MsgHandler.h"
 #include "Common/StringUtil.h"
 
@@ -96,6 +97,9 @@ void MemArena::ReleaseSHMSegment()
 
 void* MemArena::CreateView(s64 offset, size_t size, void* base)
 {
+	// Explicit large pages (SEC_LARGE_PAGES, hugetlbfs) would need every view to cover whole large
+	// pages, but the BAT and page table views map pieces as small as 128KB. Transparent huge pages
+	// have no such limit and back the parts that are large and aligned enough.
 #ifdef _WIN32
 	return MapViewOfFileEx(hMemoryMapping, FILE_MAP_ALL_ACCESS, 0, (DWORD)((u64)offset), size, base);
 #else
@@ -109,6 +113,15 @@ void* MemArena::CreateView(s64 offset, size_t size, void* base)
 	}
 	else
 	{
+#ifdef MADV_HUGEPAGE
+		// Shared memory only gets them when /sys/kernel/mm/transparent_hugepage/shmem_enabled
+		// is "advise" or "always"
+		if (Common::GetLargePagesEnabled() && size >= Common::LARGE_PAGE_SIZE &&
+			madvise(retval, size, MADV_HUGEPAGE) != 0)
+		{
+			NOTICE_LOG(MEMMAP, "Transparent huge pages are unavailable: %s", strerror(errno));
+		}
+#endif
 		return retval;
 	}
 #endif
@@ -17,6 +17,8 @@
 #include <windows.h>
 #include "Common/StringUtil.h"
 #else
+#include <cerrno>
+#include <cstring>
 #include <stdio.h>
 #include <sys/mman.h>
 #include <sys/types.h>
@@ -42,11 +44,105 @@ static uintptr_t RoundPage(uintptr_t addr)
 }
 #endif
 
+static bool s_large_pages_enabled = false;
+
+void SetLargePagesEnabled(bool enabled)
+{
+	s_large_pages_enabled = enabled;
+}
+
+bool GetLargePagesEnabled()
+{
+	return s_large_pages_enabled;
+}
+
+#ifdef _WIN32
+// Large pages can't be paged out, so Windows only hands them to accounts with the
+// "Lock pages in memory" right, and only once the process enabled it.
+static bool EnableLockMemoryPrivilege()
+{
+	HANDLE token;
+	if (!OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &token))
+		return false;
+
+	TOKEN_PRIVILEGES privileges = {};
+	privileges.PrivilegeCount = 1;
+	privileges.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+	const bool enabled =
+		LookupPrivilegeValue(nullptr, SE_LOCK_MEMORY_NAME, &privileges.Privileges[0].Luid) &&
+		AdjustTokenPrivileges(token, FALSE, &privileges, 0, nullptr, nullptr) &&
+		GetLastError() == ERROR_SUCCESS;
+	CloseHandle(token);
+	return enabled;
+}
+
+static void* AllocateExecutableLargePages(size_t size)
+{
+	static const bool privilege = EnableLockMemoryPrivilege();
+	const size_t large_page_size = GetLargePageMinimum();
+	if (!privilege || !large_page_size)
+	{
+		NOTICE_LOG(MEMMAP, "Large pages need the \"Lock pages in memory\" user right");
+		return nullptr;
+	}
+
+	size = (size + large_page_size - 1) & ~(large_page_size - 1);
+	return VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES,
+		PAGE_EXECUTE_READWRITE);
+}
+#elif defined(__linux__) && defined(MADV_HUGEPAGE)
+// Transparent huge pages only back 2MB aligned ranges, so map a little more and trim the ends.
+static void* AllocateExecutableLargePages(size_t size, bool low)
+{
+	const size_t padded_size = size + LARGE_PAGE_SIZE;
+	int flags = MAP_ANON | MAP_PRIVATE;
+#if defined(_M_X86_64) && defined(MAP_32BIT)
+	if (low)
+		flags |= MAP_32BIT;
+#endif
+	void* base = mmap(nullptr, padded_size, PROT_READ | PROT_WRITE | PROT_EXEC, flags, -1, 0);
+	if (base == MAP_FAILED)
+		return nullptr;
+
+	u8* const start = static_cast<u8*>(base);
+	u8* const ptr = reinterpret_cast<u8*>(
+		(reinterpret_cast<uintptr_t>(start) + LARGE_PAGE_SIZE - 1) & ~(LARGE_PAGE_SIZE - 1));
+	if (ptr != start)
+		munmap(start, ptr - start);
+	if (ptr + size != start + padded_size)
+		munmap(ptr + size, start + padded_size - (ptr + size));
+
+	if (madvise(ptr, size, MADV_HUGEPAGE) != 0)
+		NOTICE_LOG(MEMMAP, "Transparent huge pages are unavailable: %s", strerror(errno));
+	return ptr;
+}
+#endif
+
 // This is purposely not a full wrapper for virtualalloc/mmap, but it
 // provides exactly the primitive operations that Dolphin needs.
 
 void* AllocateExecutableMemory(size_t size, bool low)
 {
+#if defined(_WIN32) || (defined(__linux__) && defined(MADV_HUGEPAGE))
+	if (s_large_pages_enabled && size >= LARGE_PAGE_SIZE)
+	{
+#ifdef _WIN32
+		void* large_ptr = AllocateExecutableLargePages(size);
+#else
+		void* large_ptr = AllocateExecutableLargePages(size, low);
+#endif
+		// The JIT can't use it above 2GB either
+		if (large_ptr && (!low || reinterpret_cast<uintptr_t>(large_ptr) < 0x80000000))
+		{
+			INFO_LOG(MEMMAP, "Allocated %zu bytes of executable memory with large pages", size);
+			return large_ptr;
+		}
+		if (large_ptr)
+			FreeMemoryPages(large_ptr, size);
+		NOTICE_LOG(MEMMAP, "Falling back to normal pages for %zu bytes of executable memory", size);
+	}
+#endif
+
 #if defined(_WIN32)
 	void* ptr = VirtualAlloc(0, size, MEM_COMMIT, PAGE_EXECUTE_READWRITE);
 #else
@@ -9,6 +9,13 @@
 
 namespace Common
 {
+// Large pages save TLB misses on big regions that are accessed all over, like the emulated RAM
+// and the JIT cache. When enabled, AllocateExecutableMemory and MemArena use them for regions of
+// at least LARGE_PAGE_SIZE and fall back to normal pages when the OS has none to give.
+const size_t LARGE_PAGE_SIZE = 2 * 1024 * 1024;
+void SetLargePagesEnabled(bool enabled);
+bool GetLargePagesEnabled();
+
 void* AllocateExecutableMemory(size_t size, bool low = true);
 void* AllocateMemoryPages(size_t size);
 void FreeMemoryPages(void* ptr, size_t size);
@@ -2,16 +2,33 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <mutex>
+#include <string>
+#include <vector>
+
 #include "Common/Thread.h"
 #include "Common/CommonFuncs.h"
 #include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Common/StringUtil.h"
+#include "Common/Trace.h"
+#include "Common/Logging/Log.h"
 
 #ifndef _WIN32
 #include <unistd.h>
 #endif
 
+#ifdef __linux__
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#endif
+
 #ifdef __APPLE__
 #include <mach/mach.h>
+#include <pthread/qos.h>
 #elif defined BSD4_4 || defined __FreeBSD__ || defined __OpenBSD__
 #include <pthread_np.h>
 #endif
@@ -89,6 +106,10 @@ void SetCurrentThreadName(const char* szThreadName)
 	__except (EXCEPTION_CONTINUE_EXECUTION)
 	{
 	}
+
+#ifdef USE_TRACING
+	Trace::SetThreadName(szThreadName);
+#endif
 }
 
 #else  // !WIN32, so must be POSIX threads
@@ -143,8 +164,365 @@ void SetCurrentThreadName(const char* szThreadName)
 	// API.
 	__itt_thread_set_name(szThreadName);
 #endif
+#ifdef USE_TRACING
+	Trace::SetThreadName(szThreadName);
+#endif
 }
 
 #endif
 
+// Thread placement
+
+namespace
+{
+struct PhysicalCore
+{
+	// Logical CPUs of the core, more than one with SMT
+	u64 mask;
+	// Logical CPUs sharing its L3 cache, 0 if unknown
+	u64 l3_mask;
+	// Higher is faster, equal on everything but hybrid CPUs
+	int efficiency;
+};
+
+struct Placement
+{
+	// 0 leaves the role unpinned
+	u64 cpu = 0;
+	u64 gpu = 0;
+	u64 realtime = 0;
+	u64 workers = 0;
+	// Every logical CPU the process may run on, the first 64 only
+	u64 all = 0;
+};
+
+std::atomic<bool> s_placement_enabled(false);
+std::atomic<u32> s_placement_generation(0);
+
+#ifdef _WIN32
+
+std::vector<PhysicalCore> DetectCores(u64* all)
+{
+	std::vector<PhysicalCore> cores;
+	DWORD_PTR process_mask, system_mask;
+	if (!GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask))
+		return cores;
+	*all = process_mask;
+
+	DWORD size = 0;
+	GetLogicalProcessorInformationEx(RelationAll, nullptr, &size);
+	std::vector<u8> buffer(size);
+	if (size == 0 || !GetLogicalProcessorInformationEx(RelationAll,
+		reinterpret_cast<SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(buffer.data()), &size))
+		return cores;
+
+	// Only processor group 0 is used, like the rest of the affinity functions
+	std::vector<u64> l3_masks;
+	for (DWORD offset = 0; offset < size;)
+	{
+		const auto* info = reinterpret_cast<const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(buffer.data() + offset);
+		if (info->Relationship == RelationProcessorCore && info->Processor.GroupMask[0].Group == 0)
+		{
+			const u64 mask = info->Processor.GroupMask[0].Mask & process_mask;
+			if (mask)
+				cores.push_back({ mask, 0, info->Processor.EfficiencyClass });
+		}
+		else if (info->Relationship == RelationCache && info->Cache.Level == 3 &&
+			info->Cache.GroupMask.Group == 0)
+		{
+			l3_masks.push_back(info->Cache.GroupMask.Mask);
+		}
+		offset += info->Size;
+	}
+	for (PhysicalCore& core : cores)
+	{
+		for (u64 l3_mask : l3_masks)
+		{
+			if (core.mask & l3_mask)
+				core.l3_mask = l3_mask;
+		}
+	}
+	return cores;
+}
+
+void SetCurrentThreadCPUs(u64 mask)
+{
+	SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(mask));
+}
+
+void RaiseCurrentThreadPriority()
+{
+	SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_HIGHEST);
+}
+
+void SetCurrentThreadBackground(bool background)
+{
+}
+
+#elif defined __linux__ && !defined ANDROID
+
+// Parses the kernel's CPU lists, like "0-3,8,10-11", ignoring CPUs above 63
+u64 ParseCPUList(const std::string& list)
+{
+	u64 mask = 0;
+	std::vector<std::string> ranges;
+	SplitString(StripSpaces(list), ',', ranges);
+	for (const std::string& range : ranges)
+	{
+		int first, last;
+		const size_t dash = range.find('-');
+		if (dash == std::string::npos)
+		{
+			if (!TryParse(range, &first))
+				continue;
+			last = first;
+		}
+		else if (!TryParse(range.substr(0, dash), &first) || !TryParse(range.substr(dash + 1), &last))
+		{
+			continue;
+		}
+		for (int cpu = std::max(first, 0); cpu <= std::min(last, 63); cpu++)
+			mask |= 1ULL << cpu;
+	}
+	return mask;
+}
+
+std::string ReadSysFile(const std::string& path)
+{
+	std::string contents;
+	File::ReadFileToString(path, contents);
+	return StripSpaces(contents);
+}
+
+std::vector<PhysicalCore> DetectCores(u64* all)
+{
+	std::vector<PhysicalCore> cores;
+	cpu_set_t allowed;
+	CPU_ZERO(&allowed);
+	if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+		return cores;
+	for (int cpu = 0; cpu < 64; cpu++)
+	{
+		if (CPU_ISSET(cpu, &allowed))
+			*all |= 1ULL << cpu;
+	}
+
+	// Intel hybrid CPUs list their E-cores here, other CPUs may rank their cores by capacity
+	const std::string atom_cpus = ReadSysFile("/sys/devices/cpu_atom/cpus");
+	const u64 atom_mask = ParseCPUList(atom_cpus);
+
+	u64 seen = 0;
+	for (int cpu = 0; cpu < 64; cpu++)
+	{
+		const u64 bit = 1ULL << cpu;
+		if (!(*all & bit) || (seen & bit))
+			continue;
+		const std::string base = StringFromFormat("/sys/devices/system/cpu/cpu%d/", cpu);
+
+		PhysicalCore core;
+		core.mask = ParseCPUList(ReadSysFile(base + "topology/thread_siblings_list")) & *all;
+		core.mask = core.mask ? core.mask | bit : bit;
+		seen |= core.mask;
+
+		core.l3_mask = 0;
+		for (int index = 0; index < 8; index++)
+		{
+			const std::string cache = StringFromFormat("%scache/index%d/", base.c_str(), index);
+			if (ReadSysFile(cache + "level") == "3")
+				core.l3_mask = ParseCPUList(ReadSysFile(cache + "shared_cpu_list"));
+		}
+
+		core.efficiency = 0;
+		if (atom_mask)
+			core.efficiency = (atom_mask & bit) ? 0 : 1;
+		else
+			TryParse(ReadSysFile(base + "cpu_capacity"), &core.efficiency);
+		cores.push_back(core);
+	}
+	return cores;
+}
+
+void SetCurrentThreadCPUs(u64 mask)
+{
+	cpu_set_t cpu_set;
+	CPU_ZERO(&cpu_set);
+	for (int cpu = 0; cpu < 64; cpu++)
+	{
+		if ((mask >> cpu) & 1)
+			CPU_SET(cpu, &cpu_set);
+	}
+	pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set);
+}
+
+void RaiseCurrentThreadPriority()
+{
+	// Per thread on Linux, this fails without CAP_SYS_NICE or a raised RLIMIT_NICE
+	setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), -5);
+}
+
+void SetCurrentThreadBackground(bool background)
+{
+}
+
+#else
+
+// macOS doesn't allow pinning, its scheduler places threads by their QoS class instead
+std::vector<PhysicalCore> DetectCores(u64* all)
+{
+	return {};
+}
+
+void SetCurrentThreadCPUs(u64 mask)
+{
+}
+
+void RaiseCurrentThreadPriority()
+{
+#ifdef __APPLE__
+	pthread_set_qos_class_self_np(QOS_CLASS_USER_INTERACTIVE, 0);
+#endif
+}
+
+void SetCurrentThreadBackground(bool background)
+{
+#ifdef __APPLE__
+	// Utility threads run on the efficiency cores of Apple CPUs
+	pthread_set_qos_class_self_np(background ? QOS_CLASS_UTILITY : QOS_CLASS_DEFAULT, 0);
+#endif
+}
+
+#endif
+
+Placement ComputePlacement()
+{
+	Placement placement;
+	std::vector<PhysicalCore> cores = DetectCores(&placement.all);
+	if (cores.size() < 2)
+		return placement;
+
+	int fastest = cores[0].efficiency;
+	for (const PhysicalCore& core : cores)
+		fastest = std::max(fastest, core.efficiency);
+	std::vector<PhysicalCore> fast_cores;
+	u64 slow_mask = 0;
+	for (const PhysicalCore& core : cores)
+	{
+		if (core.efficiency == fastest)
+			fast_cores.push_back(core);
+		else
+			slow_mask |= core.mask;
+	}
+
+	// The CPU and GPU threads talk through the FIFO all the time, so they want two fast cores
+	// behind the same L3 cache, the CCX with the most fast cores on multi-CCD CPUs
+	const PhysicalCore* cpu_core = nullptr;
+	const PhysicalCore* gpu_core = nullptr;
+	size_t best_shared = 0;
+	for (const PhysicalCore& core : fast_cores)
+	{
+		const PhysicalCore* partner = nullptr;
+		size_t shared = 0;
+		for (const PhysicalCore& other : fast_cores)
+		{
+			if (other.l3_mask == core.l3_mask)
+			{
+				if (&other != &core && !partner)
+					partner = &other;
+				shared++;
+			}
+		}
+		if (partner && shared > best_shared)
+		{
+			best_shared = shared;
+			cpu_core = &core;
+			gpu_core = partner;
+		}
+	}
+	if (!cpu_core)
+	{
+		if (fast_cores.size() < 2)
+			return placement;
+		cpu_core = &fast_cores[0];
+		gpu_core = &fast_cores[1];
+	}
+	placement.cpu = cpu_core->mask;
+	placement.gpu = gpu_core->mask;
+
+	for (const PhysicalCore& core : fast_cores)
+	{
+		if (&core != cpu_core && &core != gpu_core)
+			placement.realtime |= core.mask;
+	}
+
+	if (slow_mask)
+		placement.workers = slow_mask;
+	else if (cores.size() >= 4)
+		placement.workers = placement.all & ~(placement.cpu | placement.gpu);
+
+	INFO_LOG(COMMON, "Thread placement: %d cores, %d fast, CPU %016" PRIx64 " GPU %016" PRIx64
+		" realtime %016" PRIx64 " workers %016" PRIx64, static_cast<int>(cores.size()),
+		static_cast<int>(fast_cores.size()), placement.cpu, placement.gpu, placement.realtime, placement.workers);
+	return placement;
+}
+
+const Placement& GetPlacement()
+{
+	static std::once_flag once;
+	static Placement placement;
+	std::call_once(once, [] { placement = ComputePlacement(); });
+	return placement;
+}
+}
+
+void SetThreadPlacementEnabled(bool enabled)
+{
+	if (s_placement_enabled.exchange(enabled) != enabled)
+		s_placement_generation.fetch_add(1);
+}
+
+u32 GetThreadPlacementGeneration()
+{
+	return s_placement_generation.load();
+}
+
+void PlaceCurrentThread(ThreadRole role)
+{
+	if (!s_placement_enabled.load())
+	{
+		// Workers outlive the emulation, undo what an earlier session did
+		if (role == ThreadRole::Worker)
+		{
+			if (GetPlacement().workers)
+				SetCurrentThreadCPUs(GetPlacement().all);
+			SetCurrentThreadBackground(false);
+		}
+		return;
+	}
+
+	const Placement& placement = GetPlacement();
+	switch (role)
+	{
+	case ThreadRole::CPU:
+		if (placement.cpu)
+			SetCurrentThreadCPUs(placement.cpu);
+		RaiseCurrentThreadPriority();
+		break;
+	case ThreadRole::GPU:
+		if (placement.gpu)
+			SetCurrentThreadCPUs(placement.gpu);
+		RaiseCurrentThreadPriority();
+		break;
+	case ThreadRole::Realtime:
+		if (placement.realtime)
+			SetCurrentThreadCPUs(placement.realtime);
+		RaiseCurrentThreadPriority();
+		break;
+	case ThreadRole::Worker:
+		if (placement.workers)
+			SetCurrentThreadCPUs(placement.workers);
+		SetCurrentThreadBackground(true);
+		break;
+	}
+}
+
 }  // namespace Common
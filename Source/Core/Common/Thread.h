@@ -37,4 +37,30 @@ inline void YieldCPU()
 
 void SetCurrentThreadName(const char* name);
 
+// What a thread does, PlaceCurrentThread picks its cores and priority from it
+enum class ThreadRole
+{
+	// The emulated CPU, or CPU and GPU in single core mode
+	CPU,
+	// The GPU thread of dual core mode
+	GPU,
+	// DSP LLE and audio output, which stutter when they fall behind
+	Realtime,
+	// The thread pool workers
+	Worker,
+};
+
+// The placement is off until enabled, then the next PlaceCurrentThread calls pin the threads. The
+// generation changes every time the setting does, long living threads compare it to re-place
+// themselves.
+void SetThreadPlacementEnabled(bool enabled);
+u32 GetThreadPlacementGeneration();
+
+// Places the calling thread from the detected core topology: the CPU and GPU threads get two
+// physical cores sharing an L3 cache, the realtime threads the other fast cores, and the workers
+// the efficiency cores of hybrid CPUs, else everything the CPU and GPU threads don't use. The time
+// critical roles get a higher priority. Does nothing while the placement is disabled, except
+// unpinning workers.
+void PlaceCurrentThread(ThreadRole role);
+
 } // namespace Common
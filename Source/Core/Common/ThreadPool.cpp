@@ -6,32 +6,93 @@
 #endif
 using namespace Common;
 
-ThreadPool::ThreadPool(): m_workflag(0), m_workercount(0), m_workers(16)
+namespace
+{
+// Index of the worker running on this thread, -1 on the other threads
+thread_local int t_workerIndex = -1;
+
+// Growable ring buffer, it only allocates when it outgrows its largest size so far
+class TaskRing
+{
+private:
+	std::vector<Task> m_tasks;
+	size_t m_head;
+	size_t m_count;
+	void Grow()
+	{
+		std::vector<Task> tasks(m_tasks.empty() ? 16 : m_tasks.size() * 2);
+		for (size_t i = 0; i < m_count; i++)
+			tasks[i] = std::move(m_tasks[(m_head + i) & (m_tasks.size() - 1)]);
+		m_tasks.swap(tasks);
+		m_head = 0;
+	}
+public:
+	TaskRing() : m_head(0), m_count(0)
+	{}
+	void Push(Task&& task)
+	{
+		if (m_count == m_tasks.size())
+			Grow();
+		m_tasks[(m_head + m_count) & (m_tasks.size() - 1)] = std::move(task);
+		m_count++;
+	}
+	bool Pop(Task& task)
+	{
+		if (m_count == 0)
+			return false;
+		task = std::move(m_tasks[m_head]);
+		m_head = (m_head + 1) & (m_tasks.size() - 1);
+		m_count--;
+		return true;
+	}
+};
+}
+
+struct ThreadPool::WorkerQueue
+{
+	std::mutex lock;
+	TaskRing tasks[TASK_PRIORITY_COUNT];
+	// Lets the other workers skip empty queues without taking the lock
+	std::atomic<s32> sizes[TASK_PRIORITY_COUNT];
+	WorkerQueue()
+	{
+		for (auto& size : sizes)
+			size.store(0);
+	}
+};
+
+ThreadPool::ThreadPool(): m_pending(0), m_sleeping(0), m_nextQueue(0)
 {
 	m_working.store(true);
 	int workers = cpu_info.logical_cpu_count - 1;
 	workers = workers < 1 ? 1 : workers;
-	for (size_t i = 0; i < workers; i++)
+	for (int i = 0; i < workers; i++)
 	{
-		std::thread* current = new std::thread(&ThreadPool::Workloop, std::ref(*this), i);
-		m_workerThreads.push_back(std::unique_ptr<std::thread>(current));
+		m_queues.push_back(std::make_unique<WorkerQueue>());
+	}
+	for (int i = 0; i < workers; i++)
+	{
+		m_workerThreads.emplace_back(&ThreadPool::Workloop, this, i);
 #ifdef _WIN32
-		SetThreadPriority(current->native_handle(), THREAD_MODE_BACKGROUND_BEGIN);
+		SetThreadPriority(m_workerThreads.back().native_handle(), THREAD_MODE_BACKGROUND_BEGIN);
 #endif
 	}
 }
 
 ThreadPool::~ThreadPool()
 {
-	m_working.store(false);
-	for (u32 i = 0; i < m_workerThreads.size(); i++)
 	{
-		std::thread* current = m_workerThreads[i].get();
-		if (current->joinable())
+		std::lock_guard<std::mutex> guard(m_sleepLock);
+		m_working.store(false);
+		m_wake.notify_all();
+	}
+	for (std::thread& thread : m_workerThreads)
+	{
+		if (thread.joinable())
 		{
-			current->join();
+			thread.join();
 		}
-	};
+	}
 }
 
 ThreadPool& ThreadPool::Getinstance()
@@ -40,117 +101,188 @@ ThreadPool& ThreadPool::Getinstance()
 	return instance;
 }
 
-void ThreadPool::NotifyWorkPending()
+void ThreadPool::SubmitTask(Task&& task, TaskPriority priority)
 {
-	ThreadPool::Getinstance().m_workflag.fetch_add(2);
+	ThreadPool& instance = Getinstance();
+	const int p = static_cast<int>(priority);
+	const int index = t_workerIndex >= 0 ? t_workerIndex :
+		static_cast<int>(instance.m_nextQueue.fetch_add(1) % instance.m_queues.size());
+	WorkerQueue& queue = *instance.m_queues[index];
+	{
+		std::lock_guard<std::mutex> guard(queue.lock);
+		queue.tasks[p].Push(std::move(task));
+		queue.sizes[p].fetch_add(1);
+	}
+	instance.m_pending.fetch_add(1);
+	// A worker going to sleep counts itself before it checks m_pending, so either it sees the
+	// task or it is seen here
+	if (instance.m_sleeping.load() > 0)
+	{
+		std::lock_guard<std::mutex> guard(instance.m_sleepLock);
+		instance.m_wake.notify_one();
+	}
 }
 
-static SpinLock<true> workerLock;
-void ThreadPool::RegisterWorker(IWorker* worker)
-{
-	workerLock.lock();
-	ThreadPool& instance = ThreadPool::Getinstance();
-	size_t count = instance.m_workercount.fetch_add(1);
-	instance.m_workers[count] = worker;
-	workerLock.unlock();
-}
-void ThreadPool::UnregisterWorker(IWorker* worker)
+bool ThreadPool::PopTask(int index, Task& task)
 {
-	workerLock.lock();
-	ThreadPool& instance = ThreadPool::Getinstance();
-	u32 count = instance.m_workercount.load();
-	u32 index = 0;
-	for (u32 i = 0; i < count; i++)
+	if (m_pending.load() <= 0)
+		return false;
+	const int count = static_cast<int>(m_queues.size());
+	const int start = index >= 0 ? index : static_cast<int>(m_nextQueue.load() % count);
+	for (int p = 0; p < TASK_PRIORITY_COUNT; p++)
 	{
-		if (instance.m_workers[i] == worker)
+		for (int i = 0; i < count; i++)
 		{
-			index = i;
-			break;
+			WorkerQueue& queue = *m_queues[(start + i) % count];
+			if (queue.sizes[p].load(std::memory_order_relaxed) <= 0)
+				continue;
+			std::lock_guard<std::mutex> guard(queue.lock);
+			if (queue.tasks[p].Pop(task))
+			{
+				queue.sizes[p].fetch_sub(1);
+				m_pending.fetch_sub(1);
+				return true;
+			}
 		}
 	}
-	instance.m_workers[index] = instance.m_workers[count - 1];
-	instance.m_workercount.fetch_sub(1);
-	workerLock.unlock();
+	return false;
 }
 
-void ThreadPool::Workloop(ThreadPool &state, size_t ID)
+void ThreadPool::Workloop(int index)
 {
-	u32 rest_time = 1;
-	while (state.m_working.load())
+	t_workerIndex = index;
+	Common::SetCurrentThreadName("Worker");
+	u32 placement_generation = 0;
+	Task task;
+	while (m_working.load())
 	{
-		if (state.m_workflag.load() > ID)
+		// The workers outlive the emulation sessions, which may change the placement
+		if (placement_generation != Common::GetThreadPlacementGeneration())
 		{
-			bool worked = false;
-			u32 count = state.m_workercount.load();
-			for (u32 i = 0; i < count; i++)
-			{
-				IWorker* worker = state.m_workers[i];
-				if (worker)
-				{
-					if (worker->NextTask())
-					{
-						worked = true;
-						state.m_workflag.fetch_sub(1);
-					}
-				}
-			}
-			if (worked)
-			{
-				Common::YieldCPU();
-				continue;
-			}
-			else if (state.m_workflag.load() > ID)
-			{
-				state.m_workflag.fetch_sub(1);
-			}
-			rest_time = 1;
+			placement_generation = Common::GetThreadPlacementGeneration();
+			Common::PlaceCurrentThread(Common::ThreadRole::Worker);
 		}
-		else
+		if (PopTask(index, task))
 		{
-			rest_time++;
-			rest_time = rest_time > 5 ? 5 : rest_time;
+			task();
+			task.Reset();
+			continue;
 		}
-		SleepCurrentThread(rest_time);
+		std::unique_lock<std::mutex> lk(m_sleepLock);
+		m_sleeping.fetch_add(1);
+		m_wake.wait(lk, [this] { return m_pending.load() > 0 || !m_working.load(); });
+		m_sleeping.fetch_sub(1);
 	}
 }
 
-AsyncWorker& AsyncWorker::Getinstance()
+bool ThreadPool::RunPendingTask()
 {
-	static AsyncWorker intance;
-	return intance;
+	Task task;
+	if (!Getinstance().PopTask(t_workerIndex, task))
+		return false;
+	task();
+	return true;
 }
 
-AsyncWorker::AsyncWorker(): m_inputsize(0), m_TaskQueue()
+bool ThreadPool::IsWorkerThread()
 {
-	ThreadPool::RegisterWorker(this);
+	return t_workerIndex >= 0;
 }
 
-AsyncWorker::~AsyncWorker()
+int ThreadPool::GetWorkerCount()
 {
-	ThreadPool::UnregisterWorker(this);
+	return static_cast<int>(Getinstance().m_queues.size());
 }
 
-bool AsyncWorker::NextTask()
+void TaskGroup::Finish()
 {
-	if (m_inputsize.load() > 0)
+	// The lock keeps Wait from returning, and the group from being destroyed, before the
+	// notification is done
+	std::lock_guard<std::mutex> guard(m_lock);
+	if (m_pending.fetch_sub(1) == 1)
+		m_done.notify_all();
+}
+
+void TaskGroup::Wait()
+{
+	if (ThreadPool::IsWorkerThread())
 	{
-		std::function<void()> func;
-		if (m_TaskQueue.try_pop(func))
+		size_t count = 0;
+		while (m_pending.load() > 0)
 		{
-			func();
-			m_inputsize.fetch_sub(1);
-			return true;
+			if (ThreadPool::RunPendingTask())
+				count = 0;
+			else
+				cYield(count++);
 		}
+		std::lock_guard<std::mutex> guard(m_lock);
+		return;
 	}
-	return false;
+	std::unique_lock<std::mutex> lk(m_lock);
+	m_done.wait(lk, [this] { return m_pending.load() == 0; });
 }
 
-void AsyncWorker::ExecuteAsync(std::function<void()> &&func)
+ParallelLoop::ParallelLoop(TaskPriority priority): m_priority(priority)
 {
-	AsyncWorker& instance = Getinstance();
-	instance.m_inputsize.fetch_add(1);
-	instance.m_TaskQueue.push(std::move(func));
-	ThreadPool::NotifyWorkPending();
 }
 
+bool ParallelLoop::Bands::Run()
+{
+	u64 current = state.load(std::memory_order_acquire);
+	u32 band;
+	do
+	{
+		band = static_cast<u32>(current);
+		if (band >= static_cast<u32>(current >> 32))
+			return false;
+	} while (!state.compare_exchange_weak(current, current + 1, std::memory_order_acquire));
+	int l = lower + static_cast<int>(band) * band_size;
+	int u = l + band_size;
+	u = u > upper ? upper : u;
+	(*func)(l, u);
+	done.fetch_add(1, std::memory_order_release);
+	return true;
+}
 
+void ParallelLoop::Loop(const std::function<void(int, int)>& func, int lower, int upper, int min_band_size)
+{
+	int range = upper - lower;
+	int bands = range / (min_band_size < 1 ? 1 : min_band_size);
+	bands = bands > cpu_info.logical_cpu_count ? cpu_info.logical_cpu_count : bands;
+	if (bands <= 1)
+	{
+		if (range > 0)
+			func(lower, upper);
+		return;
+	}
+	// Helpers of an earlier loop that didn't get to run yet still look at its bands
+	if (!m_bands || m_bands.use_count() > 1)
+	{
+		m_bands = std::make_shared<Bands>();
+	}
+	Bands& b = *m_bands;
+	b.func = &func;
+	b.lower = lower;
+	b.upper = upper;
+	b.band_size = (range + bands - 1) / bands;
+	bands = (range + b.band_size - 1) / b.band_size;
+	b.done.store(0, std::memory_order_relaxed);
+	b.state.store(static_cast<u64>(bands) << 32, std::memory_order_release);
+	for (int i = 1; i < bands; i++)
+	{
+		std::shared_ptr<Bands> helper = m_bands;
+		ThreadPool::Submit([helper] {
+			while (helper->Run())
+			{
+			}
+		}, m_priority);
+	}
+	while (b.Run())
+	{
+	}
+	size_t count = 0;
+	while (b.done.load(std::memory_order_acquire) < bands)
+	{
+		cYield(count++);
+	}
+}
@@ -31,8 +31,16 @@
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #pragma once
 #include <atomic>
+#include <condition_variable>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
 #include <vector>
+#include "Common/Common.h"
 #include "Common/Thread.h"
 
 namespace Common
@@ -429,44 +437,244 @@ public:
 	}
 };
 
-class IWorker
+enum class TaskPriority
+{
+	// Shader and pipeline compiles, and work the emulation is blocked on
+	High,
+	// Texture decoding and scaling
+	Normal,
+	// Dumping, prefetching and background compression
+	Low,
+};
+const int TASK_PRIORITY_COUNT = 3;
+
+// A move-only void() callable. Callables up to INLINE_SIZE bytes, like lambdas capturing a few
+// pointers or a shared_ptr, are stored inline so queueing them doesn't allocate.
+class Task final
 {
 public:
-	virtual ~IWorker()
+	static const size_t INLINE_SIZE = 48;
+
+	Task() : m_ops(nullptr)
 	{}
-	virtual bool NextTask() = 0;
+	template <typename F, typename = typename std::enable_if<
+		!std::is_same<typename std::decay<F>::type, Task>::value>::type>
+	Task(F&& func) : m_ops(nullptr)
+	{
+		typedef typename std::decay<F>::type Callable;
+		if (IsInline<Callable>())
+		{
+			new (&m_storage) Callable(std::forward<F>(func));
+			m_ops = &InlineOps<Callable>::ops;
+		}
+		else
+		{
+			*reinterpret_cast<Callable**>(&m_storage) = new Callable(std::forward<F>(func));
+			m_ops = &HeapOps<Callable>::ops;
+		}
+	}
+	Task(Task&& other) : m_ops(nullptr)
+	{
+		MoveFrom(other);
+	}
+	Task& operator=(Task&& other)
+	{
+		if (this != &other)
+		{
+			Reset();
+			MoveFrom(other);
+		}
+		return *this;
+	}
+	Task(const Task&) = delete;
+	Task& operator=(const Task&) = delete;
+	~Task()
+	{
+		Reset();
+	}
+
+	void operator()()
+	{
+		m_ops->invoke(&m_storage);
+	}
+	explicit operator bool() const
+	{
+		return m_ops != nullptr;
+	}
+	// Destroys the callable, and with it everything it captured
+	void Reset()
+	{
+		if (m_ops)
+		{
+			m_ops->destroy(&m_storage);
+			m_ops = nullptr;
+		}
+	}
+	template <typename F>
+	static constexpr bool IsInline()
+	{
+		return sizeof(F) <= INLINE_SIZE && alignof(F) <= alignof(Storage) &&
+			std::is_nothrow_move_constructible<F>::value;
+	}
+
+private:
+	typedef typename std::aligned_storage<INLINE_SIZE>::type Storage;
+	struct Ops
+	{
+		void(*invoke)(void* storage);
+		// Moves the callable from src to dst and leaves src empty
+		void(*move)(void* dst, void* src);
+		void(*destroy)(void* storage);
+	};
+	template <typename F>
+	struct InlineOps
+	{
+		static void Invoke(void* storage)
+		{
+			(*static_cast<F*>(storage))();
+		}
+		static void Move(void* dst, void* src)
+		{
+			new (dst) F(std::move(*static_cast<F*>(src)));
+			static_cast<F*>(src)->~F();
+		}
+		static void Destroy(void* storage)
+		{
+			static_cast<F*>(storage)->~F();
+		}
+		static const Ops ops;
+	};
+	template <typename F>
+	struct HeapOps
+	{
+		static void Invoke(void* storage)
+		{
+			(**static_cast<F**>(storage))();
+		}
+		static void Move(void* dst, void* src)
+		{
+			*static_cast<F**>(dst) = *static_cast<F**>(src);
+		}
+		static void Destroy(void* storage)
+		{
+			delete *static_cast<F**>(storage);
+		}
+		static const Ops ops;
+	};
+	void MoveFrom(Task& other)
+	{
+		if (other.m_ops)
+		{
+			other.m_ops->move(&m_storage, &other.m_storage);
+			m_ops = other.m_ops;
+			other.m_ops = nullptr;
+		}
+	}
+
+	Storage m_storage;
+	const Ops* m_ops;
 };
 
+template <typename F>
+const Task::Ops Task::InlineOps<F>::ops = { Invoke, Move, Destroy };
+template <typename F>
+const Task::Ops Task::HeapOps<F>::ops = { Invoke, Move, Destroy };
+
+// Work-stealing scheduler: every worker has its own queue per priority, tasks submitted by a
+// worker go to its own queue and the others are spread over all queues. An idle worker takes the
+// oldest task of the highest priority, from its own queue first and else from the other workers',
+// and sleeps on a condition variable once every queue is empty.
 class ThreadPool
 {
 private:
-	std::vector<std::unique_ptr<std::thread>> m_workerThreads;
-	std::vector<IWorker*> m_workers;
-	std::atomic<s32> m_workflag;
-	std::atomic<s32> m_workercount;
+	struct WorkerQueue;
+	std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+	std::vector<std::thread> m_workerThreads;
+	// Tasks queued and not taken yet
+	std::atomic<s32> m_pending;
+	std::atomic<s32> m_sleeping;
+	std::atomic<u32> m_nextQueue;
 	std::atomic<bool> m_working;
-	static void Workloop(ThreadPool &state, size_t ID);
+	std::mutex m_sleepLock;
+	std::condition_variable m_wake;
+	void Workloop(int index);
+	bool PopTask(int index, Task& task);
 	static ThreadPool &Getinstance();
 	ThreadPool(ThreadPool const&);
 	void operator=(ThreadPool const&);
 	ThreadPool();
 public:
 	virtual ~ThreadPool();
-	static void NotifyWorkPending();
-	static void RegisterWorker(IWorker* worker);
-	static void UnregisterWorker(IWorker* worker);
+	template <typename F>
+	static void Submit(F&& func, TaskPriority priority = TaskPriority::Normal)
+	{
+		SubmitTask(Task(std::forward<F>(func)), priority);
+	}
+	static void SubmitTask(Task&& task, TaskPriority priority);
+	// Runs one queued task on the calling thread, returns false if there was none
+	static bool RunPendingTask();
+	static bool IsWorkerThread();
+	static int GetWorkerCount();
 };
 
-class AsyncWorker final: IWorker
+// Tasks run through a group can be waited for together. The group must outlive its tasks, the
+// destructor waits for them.
+class TaskGroup final
 {
 private:
-	std::atomic<s32> m_inputsize;
-	ManyToManyQueue<std::function<void()>, CircularQueue<std::function<void()>>> m_TaskQueue;
-	static AsyncWorker &Getinstance();
-	AsyncWorker();
+	std::atomic<s32> m_pending;
+	std::mutex m_lock;
+	std::condition_variable m_done;
+	void Finish();
+	TaskGroup(TaskGroup const&);
+	void operator=(TaskGroup const&);
+public:
+	TaskGroup() : m_pending(0)
+	{}
+	~TaskGroup()
+	{
+		Wait();
+	}
+	template <typename F>
+	void Run(F&& func, TaskPriority priority = TaskPriority::Normal)
+	{
+		m_pending.fetch_add(1);
+		ThreadPool::Submit([this, func = std::forward<F>(func)]() mutable {
+			func();
+			Finish();
+		}, priority);
+	}
+	// Returns once every task run through the group is done. A worker thread runs other queued
+	// tasks meanwhile, so tasks can wait for the groups they started without deadlocking the pool.
+	void Wait();
+	bool IsDone() const
+	{
+		return m_pending.load() == 0;
+	}
+};
+
+// Splits a range into bands that are processed by the calling thread and the pool workers,
+// Loop returns once every band is done.
+class ParallelLoop final
+{
+private:
+	struct Bands
+	{
+		// band count in the upper half, next unclaimed band in the lower half
+		std::atomic<u64> state;
+		std::atomic<s32> done;
+		const std::function<void(int, int)>* func;
+		int lower;
+		int upper;
+		int band_size;
+		bool Run();
+	};
+	// Shared with the helper tasks, which may only get to run after Loop returned
+	std::shared_ptr<Bands> m_bands;
+	TaskPriority m_priority;
 public:
-	virtual ~AsyncWorker();
-	bool NextTask() override;
-	static void ExecuteAsync(std::function<void()> &&func);
+	explicit ParallelLoop(TaskPriority priority = TaskPriority::Normal);
+	// func is called with [l, u) sub ranges of [lower, upper), at least min_band_size long
+	void Loop(const std::function<void(int, int)>& func, int lower, int upper, int min_band_size = 16);
 };
 }
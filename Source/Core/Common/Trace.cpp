@@ -0,0 +1,164 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Common/CommonPaths.h"
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Common/StringUtil.h"
+#include "Common/Trace.h"
+#include "Common/Logging/Log.h"
+
+namespace Trace
+{
+#ifdef USE_TRACING
+namespace
+{
+struct ThreadBuffer
+{
+	u32 thread_id;
+	std::string thread_name;
+	// Held by the owning thread while recording, so only GetEvents ever waits for it
+	std::mutex lock;
+	// Allocated by the first zone, not every named thread records any
+	std::vector<Event> events;
+	size_t next = 0;
+	size_t count = 0;
+};
+}
+
+// Buffers of threads that exited are kept, they hold the zones from before the exit
+static std::mutex s_buffers_lock;
+static std::vector<std::unique_ptr<ThreadBuffer>> s_buffers;
+
+static thread_local ThreadBuffer* s_thread_buffer = nullptr;
+
+static ThreadBuffer* GetThreadBuffer()
+{
+	if (s_thread_buffer)
+		return s_thread_buffer;
+
+	std::lock_guard<std::mutex> guard(s_buffers_lock);
+	std::unique_ptr<ThreadBuffer> buffer = std::make_unique<ThreadBuffer>();
+	buffer->thread_id = static_cast<u32>(s_buffers.size() + 1);
+	buffer->thread_name = StringFromFormat("Thread %u", buffer->thread_id);
+	s_thread_buffer = buffer.get();
+	s_buffers.push_back(std::move(buffer));
+	return s_thread_buffer;
+}
+
+void SetThreadName(const char* name)
+{
+	ThreadBuffer* buffer = GetThreadBuffer();
+	std::lock_guard<std::mutex> guard(buffer->lock);
+	buffer->thread_name = name;
+}
+
+void Record(const char* name, u64 start_us, u64 end_us)
+{
+	ThreadBuffer* buffer = GetThreadBuffer();
+	std::lock_guard<std::mutex> guard(buffer->lock);
+	if (buffer->events.empty())
+		buffer->events.resize(EVENT_COUNT);
+
+	buffer->events[buffer->next] = { name, start_us, end_us - start_us };
+	buffer->next = (buffer->next + 1) % EVENT_COUNT;
+	buffer->count = std::min(buffer->count + 1, EVENT_COUNT);
+}
+
+std::vector<ThreadEvents> GetEvents()
+{
+	std::vector<ThreadEvents> threads;
+	std::lock_guard<std::mutex> guard(s_buffers_lock);
+	for (const auto& buffer : s_buffers)
+	{
+		std::lock_guard<std::mutex> buffer_guard(buffer->lock);
+		if (buffer->count == 0)
+			continue;
+
+		ThreadEvents thread;
+		thread.thread_id = buffer->thread_id;
+		thread.thread_name = buffer->thread_name;
+		thread.events.reserve(buffer->count);
+		const size_t first = (buffer->next + EVENT_COUNT - buffer->count) % EVENT_COUNT;
+		for (size_t i = 0; i < buffer->count; i++)
+			thread.events.push_back(buffer->events[(first + i) % EVENT_COUNT]);
+		threads.push_back(std::move(thread));
+	}
+	return threads;
+}
+#else
+void SetThreadName(const char* name)
+{
+}
+
+void Record(const char* name, u64 start_us, u64 end_us)
+{
+}
+
+std::vector<ThreadEvents> GetEvents()
+{
+	return {};
+}
+#endif
+
+static std::string EscapeJSON(const std::string& str)
+{
+	std::string escaped;
+	for (char c : str)
+	{
+		if (c == '"' || c == '\\')
+			escaped += '\\';
+		if (static_cast<u8>(c) >= 0x20)
+			escaped += c;
+	}
+	return escaped;
+}
+
+std::string ToJSON(const std::vector<ThreadEvents>& threads)
+{
+	// Zones of different threads nest independently, one track per thread
+	std::string json = "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+	bool first = true;
+	for (const ThreadEvents& thread : threads)
+	{
+		json += StringFromFormat("%s\n  {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, "
+			"\"tid\": %u, \"args\": {\"name\": \"%s\"}}", first ? "" : ",", thread.thread_id,
+			EscapeJSON(thread.thread_name).c_str());
+		first = false;
+		for (const Event& event : thread.events)
+		{
+			json += StringFromFormat(",\n  {\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": %u, "
+				"\"ts\": %llu, \"dur\": %llu}", EscapeJSON(event.name).c_str(), thread.thread_id,
+				static_cast<unsigned long long>(event.start_us),
+				static_cast<unsigned long long>(event.duration_us));
+		}
+	}
+	json += "\n]}\n";
+	return json;
+}
+
+bool Export()
+{
+	const std::vector<ThreadEvents> threads = GetEvents();
+	const std::string path = File::GetUserPath(D_LOGS_IDX) + "trace.json";
+	if (!File::WriteStringToFile(ToJSON(threads), path))
+	{
+		ERROR_LOG(COMMON, "Failed to write trace to %s", path.c_str());
+		return false;
+	}
+
+	size_t events = 0;
+	for (const ThreadEvents& thread : threads)
+		events += thread.events.size();
+	NOTICE_LOG(COMMON, "Trace of %zu zones on %zu threads saved to %s", events, threads.size(),
+		path.c_str());
+	return true;
+}
+}
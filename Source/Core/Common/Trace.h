@@ -0,0 +1,80 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/Timer.h"
+
+// Scoped zones timing the hot paths of the emulation threads, so a stall of one thread can be
+// matched with what the others were doing at the time. Each thread records into its own ring of
+// its last EVENT_COUNT zones, Export writes the rings of all threads as a Chrome trace, which
+// chrome://tracing and the Perfetto UI open.
+//
+// The zones are only compiled in with USE_TRACING (the ENABLE_TRACING CMake option), without it
+// TRACE_ZONE expands to nothing and there is nothing to export.
+namespace Trace
+{
+static constexpr size_t EVENT_COUNT = 16384;
+
+struct Event
+{
+	// A string literal
+	const char* name;
+	u64 start_us;
+	u64 duration_us;
+};
+
+struct ThreadEvents
+{
+	u32 thread_id;
+	std::string thread_name;
+	// Oldest first
+	std::vector<Event> events;
+};
+
+constexpr bool IsCompiledIn()
+{
+#ifdef USE_TRACING
+	return true;
+#else
+	return false;
+#endif
+}
+
+// Any thread, the times are Common::Timer::GetTimeUs times
+void SetThreadName(const char* name);
+void Record(const char* name, u64 start_us, u64 end_us);
+
+// The zones of every thread that recorded any, including threads that exited since
+std::vector<ThreadEvents> GetEvents();
+std::string ToJSON(const std::vector<ThreadEvents>& threads);
+
+// Writes trace.json to the log directory
+bool Export();
+
+class Zone final
+{
+public:
+	explicit Zone(const char* name) : m_name(name), m_start_us(Common::Timer::GetTimeUs()) {}
+	~Zone() { Record(m_name, m_start_us, Common::Timer::GetTimeUs()); }
+	Zone(const Zone&) = delete;
+	Zone& operator=(const Zone&) = delete;
+
+private:
+	const char* m_name;
+	u64 m_start_us;
+};
+}
+
+#ifdef USE_TRACING
+#define TRACE_ZONE_NAME2(line) trace_zone_##line
+#define TRACE_ZONE_NAME(line) TRACE_ZONE_NAME2(line)
+#define TRACE_ZONE(name) Trace::Zone TRACE_ZONE_NAME(__LINE__)(name)
+#else
+#define TRACE_ZONE(name) ((void)0)
+#endif
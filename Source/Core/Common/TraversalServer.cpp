@@ -1,6 +1,8 @@
 // This file is public domain, in case it's useful to anyone. -comex
 
 // The central server implementation.
+#include <algorithm>
+#include <array>
 #include <cerrno>
 #include <cstdio>
 #include <cstdlib>
@@ -19,8 +21,64 @@
 
 #define DEBUG 1
 #define NUMBER_OF_TRIES 5
+// packets read or written with one system call
+#define IO_BATCH_SIZE 64
 
 static u64 currentTime;
+static const u64 expiryTime = 30 * 1000000; // 30s
+static const u64 resendInterval = 300000;
+
+// Deadlines hashed into a ring of slots by tick, so finding the expired ones only looks at the
+// slots that passed instead of everything pending. Deadlines more than a full turn away just
+// stay in their slot until their round comes.
+template <typename T, u64 tickLength, size_t numSlots>
+class TimerWheel
+{
+public:
+	void Schedule(u64 deadline, const T& value)
+	{
+		const u64 tick = std::max((deadline + tickLength - 1) / tickLength, nextTick);
+		slots[tick % numSlots].push_back({tick, value});
+	}
+
+	template <typename F>
+	void Advance(u64 now, F&& onExpired)
+	{
+		const u64 nowTick = now / tickLength;
+		if (nowTick < nextTick)
+			return;
+		// after a long stall every slot is due at most once
+		if (nowTick - nextTick >= numSlots)
+			nextTick = nowTick - numSlots + 1;
+		while (nextTick <= nowTick)
+		{
+			// advanced first so that anything scheduled from onExpired lands in a later tick
+			const u64 tick = nextTick++;
+			std::vector<Entry> slot;
+			slot.swap(slots[tick % numSlots]);
+			auto& pending = slots[tick % numSlots];
+			for (const Entry& entry : slot)
+			{
+				if (entry.tick > nowTick)
+					pending.push_back(entry);
+			}
+			for (const Entry& entry : slot)
+			{
+				if (entry.tick <= nowTick)
+					onExpired(entry.value);
+			}
+		}
+	}
+
+private:
+	struct Entry
+	{
+		u64 tick;
+		T value;
+	};
+	std::array<std::vector<Entry>, numSlots> slots;
+	u64 nextTick = 0;
+};
 
 struct OutgoingPacketInfo
 {
@@ -48,29 +106,16 @@ struct EvictFindResult
 template <typename K, typename V>
 EvictFindResult<V> EvictFind(std::unordered_map<K, EvictEntry<V>>& map, const K& key, bool refresh = false)
 {
-	retry:
-	const u64 expiryTime = 30 * 1000000; // 30s
 	EvictFindResult<V> result;
-	if (map.bucket_count())
+	auto it = map.find(key);
+	// expired entries that the wheel didn't sweep yet are already gone for lookups
+	if (it != map.end() && currentTime - it->second.updateTime <= expiryTime)
 	{
-		auto bucket = map.bucket(key);
-		auto it = map.begin(bucket);
-		for (; it != map.end(bucket); ++it)
-		{
-			if (currentTime - it->second.updateTime > expiryTime)
-			{
-				map.erase(it->first);
-				goto retry;
-			}
-			if (it->first == key)
-			{
-				if (refresh)
-					it->second.updateTime = currentTime;
-				result.found = true;
-				result.value = &it->second.value;
-				return result;
-			}
-		}
+		if (refresh)
+			it->second.updateTime = currentTime;
+		result.found = true;
+		result.value = &it->second.value;
+		return result;
 	}
 #if DEBUG
 	printf("failed to find key '");
@@ -99,8 +144,10 @@ namespace std
 	{
 		size_t operator()(const TraversalHostId& id) const
 		{
-			auto p = (u32*) id.data();
-			return p[0] ^ ((p[1] << 13) | (p[1] >> 19));
+			// the ids are hex digits, so the raw bytes need mixing to spread over the buckets
+			u64 value;
+			memcpy(&value, id.data(), sizeof(value));
+			return (size_t) ((value * 0x9E3779B97F4A7C15ULL) >> 32);
 		}
 	};
 }
@@ -115,6 +162,11 @@ static std::unordered_map<
 	TraversalHostId,
 	EvictEntry<TraversalInetAddress>
 > connectedClients;
+// packets allocated since the last flush, sent for the first time at the end of the batch
+static std::vector<TraversalRequestId> newPackets;
+static std::vector<std::pair<TraversalPacket, sockaddr_in6>> sendQueue;
+static TimerWheel<TraversalRequestId, 100000, 64> resendWheel;   // 100ms ticks
+static TimerWheel<TraversalHostId, 1000000, 64> clientExpiryWheel; // 1s ticks
 
 static TraversalInetAddress MakeInetAddress(const sockaddr_in6& addr)
 {
@@ -198,16 +250,54 @@ static const char* SenderName(sockaddr_in6* addr)
 	return buf;
 }
 
-static void TrySend(const void* buffer, size_t size, sockaddr_in6* addr)
+static void TrySend(const TraversalPacket& packet, const sockaddr_in6& addr)
+{
+	sendQueue.emplace_back(packet, addr);
+}
+
+static void FlushSends()
 {
 #if DEBUG
-	printf("-> %d %llu %s\n", ((TraversalPacket*) buffer)->type,
-		   (long long)((TraversalPacket*) buffer)->requestId, SenderName(addr));
+	for (auto& p : sendQueue)
+		printf("-> %d %llu %s\n", p.first.type, (long long)p.first.requestId, SenderName(&p.second));
 #endif
-	if ((size_t) sendto(sock, buffer, size, 0, (sockaddr*) addr, sizeof(*addr)) != size)
+#ifdef __linux__
+	mmsghdr msgs[IO_BATCH_SIZE];
+	iovec iovecs[IO_BATCH_SIZE];
+	size_t sent = 0;
+	while (sent < sendQueue.size())
 	{
-		perror("sendto");
+		const size_t count = std::min<size_t>(IO_BATCH_SIZE, sendQueue.size() - sent);
+		for (size_t i = 0; i < count; i++)
+		{
+			iovecs[i].iov_base = &sendQueue[sent + i].first;
+			iovecs[i].iov_len = sizeof(TraversalPacket);
+			memset(&msgs[i], 0, sizeof(msgs[i]));
+			msgs[i].msg_hdr.msg_name = &sendQueue[sent + i].second;
+			msgs[i].msg_hdr.msg_namelen = sizeof(sockaddr_in6);
+			msgs[i].msg_hdr.msg_iov = &iovecs[i];
+			msgs[i].msg_hdr.msg_iovlen = 1;
+		}
+		int rv = sendmmsg(sock, msgs, count, 0);
+		if (rv <= 0)
+		{
+			// drop the packet that failed, the resends cover it like any other loss
+			perror("sendmmsg");
+			rv = 1;
+		}
+		sent += rv;
+	}
+#else
+	for (auto& p : sendQueue)
+	{
+		if (sendto(sock, &p.first, sizeof(p.first), 0, (sockaddr*) &p.second, sizeof(p.second)) !=
+			sizeof(p.first))
+		{
+			perror("sendto");
+		}
 	}
+#endif
+	sendQueue.clear();
 }
 
 static TraversalPacket* AllocPacket(const sockaddr_in6& dest, TraversalRequestId misc = 0)
@@ -219,6 +309,7 @@ static TraversalPacket* AllocPacket(const sockaddr_in6& dest, TraversalRequestId
 	info->misc = misc;
 	info->tries = 0;
 	info->sendTime = currentTime;
+	newPackets.push_back(requestId);
 	TraversalPacket* result = &info->packet;
 	memset(result, 0, sizeof(*result));
 	result->requestId = requestId;
@@ -229,35 +320,44 @@ static void SendPacket(OutgoingPacketInfo* info)
 {
 	info->tries++;
 	info->sendTime = currentTime;
-	TrySend(&info->packet, sizeof(info->packet), &info->dest);
+	TrySend(info->packet, info->dest);
+	resendWheel.Schedule(currentTime + resendInterval * info->tries, info->packet.requestId);
 }
 
+static void SendNewPackets()
+{
+	for (TraversalRequestId requestId : newPackets)
+	{
+		auto it = outgoingPackets.find(requestId);
+		if (it != outgoingPackets.end() && it->second.tries == 0)
+			SendPacket(&it->second);
+	}
+	newPackets.clear();
+}
 
 static void ResendPackets()
 {
 	std::vector<std::pair<TraversalInetAddress, TraversalRequestId>> todoFailures;
-	todoFailures.clear();
-	for (auto it = outgoingPackets.begin(); it != outgoingPackets.end();)
-	{
+	resendWheel.Advance(currentTime, [&](TraversalRequestId requestId) {
+		// acked packets are simply not found anymore
+		auto it = outgoingPackets.find(requestId);
+		if (it == outgoingPackets.end())
+			return;
+
 		OutgoingPacketInfo* info = &it->second;
-		if (currentTime - info->sendTime >= (u64) (300000 * info->tries))
+		if (info->tries >= NUMBER_OF_TRIES)
 		{
-			if (info->tries >= NUMBER_OF_TRIES)
-			{
-				if (info->packet.type == TraversalPacketPleaseSendPacket)
-				{
-					todoFailures.push_back(std::make_pair(info->packet.pleaseSendPacket.address, info->misc));
-				}
-				it = outgoingPackets.erase(it);
-				continue;
-			}
-			else
+			if (info->packet.type == TraversalPacketPleaseSendPacket)
 			{
-				SendPacket(info);
+				todoFailures.push_back(std::make_pair(info->packet.pleaseSendPacket.address, info->misc));
 			}
+			outgoingPackets.erase(it);
 		}
-		++it;
-	}
+		else
+		{
+			SendPacket(info);
+		}
+	});
 
 	for (const auto& p : todoFailures)
 	{
@@ -268,6 +368,21 @@ static void ResendPackets()
 	}
 }
 
+static void ExpireClients()
+{
+	clientExpiryWheel.Advance(currentTime, [](const TraversalHostId& hostId) {
+		auto it = connectedClients.find(hostId);
+		if (it == connectedClients.end())
+			return;
+		// pings since this was scheduled push the deadline back
+		const u64 deadline = it->second.updateTime + expiryTime;
+		if (deadline > currentTime)
+			clientExpiryWheel.Schedule(deadline, hostId);
+		else
+			connectedClients.erase(it);
+	});
+}
+
 static void HandlePacket(TraversalPacket* packet, sockaddr_in6* addr)
 {
 #if DEBUG
@@ -329,6 +444,7 @@ static void HandlePacket(TraversalPacket* packet, sockaddr_in6* addr)
 				if (!r.found)
 				{
 					iaddr = EvictSet(connectedClients, hostId);
+					clientExpiryWheel.Schedule(currentTime + expiryTime, hostId);
 					break;
 				}
 			}
@@ -368,7 +484,7 @@ static void HandlePacket(TraversalPacket* packet, sockaddr_in6* addr)
 		ack.type = TraversalPacketAck;
 		ack.requestId = packet->requestId;
 		ack.ack.ok = packetOk;
-		TrySend(&ack, sizeof(ack), addr);
+		TrySend(ack, *addr);
 	}
 }
 
@@ -416,7 +532,7 @@ int main()
 
 	timeval tv;
 	tv.tv_sec = 0;
-	tv.tv_usec = 300000;
+	tv.tv_usec = 100000;
 	rv = setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
 	if (rv < 0)
 	{
@@ -424,14 +540,32 @@ int main()
 		return 1;
 	}
 
+	static sockaddr_in6 raddrs[IO_BATCH_SIZE];
+	static TraversalPacket packets[IO_BATCH_SIZE];
+#ifdef __linux__
+	mmsghdr msgs[IO_BATCH_SIZE];
+	iovec iovecs[IO_BATCH_SIZE];
+#endif
+
 	while (true)
 	{
-		sockaddr_in6 raddr;
-		socklen_t addrLen = sizeof(raddr);
-		TraversalPacket packet;
-		// note: switch to recvmmsg (yes, mmsg) if this becomes
-		// expensive
-		rv = recvfrom(sock, &packet, sizeof(packet), 0, (sockaddr*) &raddr, &addrLen);
+#ifdef __linux__
+		// everything that queued up while we were busy is read in one call
+		for (int i = 0; i < IO_BATCH_SIZE; i++)
+		{
+			iovecs[i].iov_base = &packets[i];
+			iovecs[i].iov_len = sizeof(packets[i]);
+			memset(&msgs[i], 0, sizeof(msgs[i]));
+			msgs[i].msg_hdr.msg_name = &raddrs[i];
+			msgs[i].msg_hdr.msg_namelen = sizeof(raddrs[i]);
+			msgs[i].msg_hdr.msg_iov = &iovecs[i];
+			msgs[i].msg_hdr.msg_iovlen = 1;
+		}
+		rv = recvmmsg(sock, msgs, IO_BATCH_SIZE, MSG_WAITFORONE, nullptr);
+#else
+		socklen_t addrLen = sizeof(raddrs[0]);
+		rv = recvfrom(sock, &packets[0], sizeof(packets[0]), 0, (sockaddr*) &raddrs[0], &addrLen);
+#endif
 		if (gettimeofday(&tv, nullptr) < 0)
 		{
 			perror("gettimeofday");
@@ -446,14 +580,29 @@ int main()
 				return 1;
 			}
 		}
-		else if ((size_t) rv < sizeof(packet))
-		{
-			fprintf(stderr, "received short packet from %s\n", SenderName(&raddr));
-		}
 		else
 		{
-			HandlePacket(&packet, &raddr);
+#ifdef __linux__
+			const int count = rv;
+#else
+			const int count = 1;
+#endif
+			for (int i = 0; i < count; i++)
+			{
+#ifdef __linux__
+				const size_t size = msgs[i].msg_len;
+#else
+				const size_t size = rv;
+#endif
+				if (size < sizeof(packets[i]))
+					fprintf(stderr, "received short packet from %s\n", SenderName(&raddrs[i]));
+				else
+					HandlePacket(&packets[i], &raddrs[i]);
+			}
 		}
 		ResendPackets();
+		ExpireClients();
+		SendNewPackets();
+		FlushSends();
 	}
 }
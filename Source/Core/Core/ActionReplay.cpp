@@ -21,13 +21,14 @@
 
 #include <algorithm>
 #include <atomic>
-#include <iterator>
+#include <cstring>
 #include <mutex>
 #include <string>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
+#include "Common/CommonFuncs.h"
 #include "Common/CommonTypes.h"
 #include "Common/IniFile.h"
 #include "Common/Logging/LogManager.h"
@@ -38,6 +39,7 @@
 #include "Core/ActionReplay.h"
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
+#include "Core/HW/Memmap.h"
 #include "Core/PowerPC/PowerPC.h"
 
 namespace ActionReplay
@@ -78,9 +80,42 @@ enum
 	SUB_MASTER_CODE = 0x03,
 };
 
+// A line of a code decoded for RunCompiledLocked
+struct CompiledOp
+{
+	enum Kind : u8
+	{
+		WRITE_AND_FILL,
+		WRITE_TO_POINTER,
+		ADD,
+		CONDITIONAL,
+		END,
+		// Zero codes that do nothing here, like the endif line
+		NOP,
+	};
+
+	Kind kind;
+	u8 size;
+	// Compare type of conditionals
+	u8 compare;
+	// Lines a failed conditional skips, as for ConditionalCode
+	s8 skip;
+	// "00000000 40000000", which ends CONDTIONAL_ALL_LINES_UNTIL
+	bool endif;
+	u32 address;
+	u32 data;
+};
+
+struct ActiveCode
+{
+	ARCode code;
+	// Empty if the code uses lines that only RunCodeLocked handles
+	std::vector<CompiledOp> compiled;
+};
+
 // General lock. Protects codes list and internal log.
 static std::mutex s_lock;
-static std::vector<ARCode> s_active_codes;
+static std::vector<ActiveCode> s_active_codes;
 static std::vector<std::string> s_internal_log;
 static std::atomic<bool> s_use_internal_log{ false };
 // pointer to the code currently being run, (used by log messages that include the code name)
@@ -105,6 +140,8 @@ struct ARAddr
 	operator u32() const { return address; }
 };
 
+static std::vector<CompiledOp> CompileCode(const ARCode& code);
+
 // ----------------------
 // AR Remote Functions
 void ApplyCodes(const std::vector<ARCode>& codes)
@@ -115,8 +152,11 @@ void ApplyCodes(const std::vector<ARCode>& codes)
 	std::lock_guard<std::mutex> guard(s_lock);
 	s_disable_logging = false;
 	s_active_codes.clear();
-	std::copy_if(codes.begin(), codes.end(), std::back_inserter(s_active_codes),
-		[](const ARCode& code) { return code.active; });
+	for (const ARCode& code : codes)
+	{
+		if (code.active)
+			s_active_codes.push_back({ code, CompileCode(code) });
+	}
 	s_active_codes.shrink_to_fit();
 }
 
@@ -129,7 +169,8 @@ void AddCode(ARCode code)
 	{
 		std::lock_guard<std::mutex> guard(s_lock);
 		s_disable_logging = false;
-		s_active_codes.emplace_back(std::move(code));
+		std::vector<CompiledOp> compiled = CompileCode(code);
+		s_active_codes.push_back({ std::move(code), std::move(compiled) });
 	}
 }
 
@@ -931,6 +972,241 @@ static bool RunCodeLocked(const ARCode& arcode)
 	return true;
 }
 
+// Decodes the lines of a code once. Anything that isn't a plain write, add, conditional or end,
+// or that RunCodeLocked would reject, leaves the code to RunCodeLocked.
+static std::vector<CompiledOp> CompileCode(const ARCode& code)
+{
+	std::vector<CompiledOp> compiled;
+	compiled.reserve(code.ops.size());
+	for (const AREntry& entry : code.ops)
+	{
+		const ARAddr addr(entry.cmd_addr);
+		CompiledOp op = {};
+		op.address = addr.GCAddress();
+		op.data = entry.value;
+		op.size = addr.size;
+		op.endif = addr == 0 && entry.value == 0x40000000;
+
+		if (addr >= 0x00002000 && addr < 0x00003000)
+			return {};
+
+		if (addr == 0)
+		{
+			switch (entry.value >> 29)
+			{
+			case ZCODE_END:
+				op.kind = CompiledOp::END;
+				break;
+			case ZCODE_NORM:
+				op.kind = CompiledOp::NOP;
+				break;
+			default:
+				// Fill & slide and memory copy use the next line as well
+				return {};
+			}
+		}
+		else if (addr.type == 0)
+		{
+			switch (addr.subtype)
+			{
+			case SUB_RAM_WRITE:
+				op.kind = CompiledOp::WRITE_AND_FILL;
+				break;
+			case SUB_WRITE_POINTER:
+				op.kind = CompiledOp::WRITE_TO_POINTER;
+				break;
+			case SUB_ADD_CODE:
+				op.kind = CompiledOp::ADD;
+				break;
+			default:
+				return {};
+			}
+		}
+		else
+		{
+			op.kind = CompiledOp::CONDITIONAL;
+			op.compare = addr.type;
+			if (addr.subtype == CONDTIONAL_ONE_LINE || addr.subtype == CONDTIONAL_TWO_LINES)
+				op.skip = addr.subtype + 1;
+			else
+				op.skip = -static_cast<s8>(addr.subtype);
+		}
+		compiled.push_back(op);
+	}
+	return compiled;
+}
+
+// Returns the host memory of a range the code writes when it is plain RAM for the game
+static u8* GetRAMRange(u32 address, u32 size)
+{
+	const u32 last = address + size - 1;
+	if (last < address || !PowerPC::IsOptimizableRAMAddress(address) ||
+		!PowerPC::IsOptimizableRAMAddress(last))
+	{
+		return nullptr;
+	}
+
+	u8* pointer = Memory::GetPointer(address);
+	if (Memory::GetPointer(last) != pointer + size - 1)
+		return nullptr;
+	return pointer;
+}
+
+static void CompiledRamWriteAndFill(const CompiledOp& op)
+{
+	switch (op.size)
+	{
+	case DATATYPE_8BIT:
+	{
+		const u32 count = (op.data >> 8) + 1;
+		if (u8* pointer = GetRAMRange(op.address, count))
+		{
+			std::fill_n(pointer, count, static_cast<u8>(op.data));
+		}
+		else
+		{
+			for (u32 i = 0; i < count; ++i)
+				PowerPC::HostWrite_U8(op.data & 0xFF, op.address + i);
+		}
+		break;
+	}
+
+	case DATATYPE_16BIT:
+	{
+		const u32 count = (op.data >> 16) + 1;
+		if (u8* pointer = GetRAMRange(op.address, count * 2))
+		{
+			const u16 value = Common::swap16(static_cast<u16>(op.data));
+			for (u32 i = 0; i < count; ++i)
+				std::memcpy(pointer + i * 2, &value, sizeof(value));
+		}
+		else
+		{
+			for (u32 i = 0; i < count; ++i)
+				PowerPC::HostWrite_U16(op.data & 0xFFFF, op.address + i * 2);
+		}
+		break;
+	}
+
+	default:
+		PowerPC::HostWrite_U32(op.data, op.address);
+		break;
+	}
+}
+
+static u32 CompiledRead(const CompiledOp& op)
+{
+	switch (op.size)
+	{
+	case DATATYPE_8BIT:
+		return PowerPC::HostRead_U8(op.address);
+	case DATATYPE_16BIT:
+		return PowerPC::HostRead_U16(op.address);
+	default:
+		return PowerPC::HostRead_U32(op.address);
+	}
+}
+
+// RunCodeLocked for the codes CompileCode decoded, without the logging
+static void RunCompiledLocked(const std::vector<CompiledOp>& ops)
+{
+	int skip_count = 0;
+	for (const CompiledOp& op : ops)
+	{
+		if (skip_count)
+		{
+			if (skip_count > 0)
+				--skip_count;
+			else if (-CONDTIONAL_ALL_LINES == skip_count)
+				return;
+			else if (op.endif)
+				skip_count = 0;
+			continue;
+		}
+
+		switch (op.kind)
+		{
+		case CompiledOp::WRITE_AND_FILL:
+			CompiledRamWriteAndFill(op);
+			break;
+
+		case CompiledOp::WRITE_TO_POINTER:
+		{
+			const u32 ptr = PowerPC::HostRead_U32(op.address);
+			if (op.size == DATATYPE_8BIT)
+				PowerPC::HostWrite_U8(op.data & 0xFF, ptr + (op.data >> 8));
+			else if (op.size == DATATYPE_16BIT)
+				PowerPC::HostWrite_U16(op.data & 0xFFFF, ptr + ((op.data >> 16) << 1));
+			else
+				PowerPC::HostWrite_U32(op.data, ptr);
+			break;
+		}
+
+		case CompiledOp::ADD:
+			if (op.size == DATATYPE_8BIT)
+			{
+				PowerPC::HostWrite_U8(PowerPC::HostRead_U8(op.address) + op.data, op.address);
+			}
+			else if (op.size == DATATYPE_16BIT)
+			{
+				PowerPC::HostWrite_U16(PowerPC::HostRead_U16(op.address) + op.data, op.address);
+			}
+			else if (op.size == DATATYPE_32BIT)
+			{
+				PowerPC::HostWrite_U32(PowerPC::HostRead_U32(op.address) + op.data, op.address);
+			}
+			else
+			{
+				const u32 read = PowerPC::HostRead_U32(op.address);
+				const float fread = reinterpret_cast<const float&>(read) + static_cast<float>(op.data);
+				PowerPC::HostWrite_U32(reinterpret_cast<const u32&>(fread), op.address);
+			}
+			break;
+
+		case CompiledOp::CONDITIONAL:
+		{
+			const u32 value = CompiledRead(op);
+			const u32 data = op.size == DATATYPE_8BIT ? op.data & 0xFF :
+				op.size == DATATYPE_16BIT ? op.data & 0xFFFF : op.data;
+			bool result;
+			switch (op.compare)
+			{
+			case CONDTIONAL_EQUAL:
+				result = value == data;
+				break;
+			case CONDTIONAL_NOT_EQUAL:
+				result = value != data;
+				break;
+			case CONDTIONAL_LESS_THAN_SIGNED:
+				result = static_cast<s32>(value) < static_cast<s32>(data);
+				break;
+			case CONDTIONAL_GREATER_THAN_SIGNED:
+				result = static_cast<s32>(value) > static_cast<s32>(data);
+				break;
+			case CONDTIONAL_LESS_THAN_UNSIGNED:
+				result = value < data;
+				break;
+			case CONDTIONAL_GREATER_THAN_UNSIGNED:
+				result = value > data;
+				break;
+			default:
+				result = !!(value & data);
+				break;
+			}
+			if (!result)
+				skip_count = op.skip;
+			break;
+		}
+
+		case CompiledOp::END:
+			return;
+
+		case CompiledOp::NOP:
+			break;
+		}
+	}
+}
+
 void RunAllActive()
 {
 	if (!SConfig::GetInstance().bEnableCheats)
@@ -940,9 +1216,16 @@ void RunAllActive()
 	// are only atomic ops unless contested. It should be rare for this to
 	// be contested.
 	std::lock_guard<std::mutex> guard(s_lock);
+	// The first run after the codes changed goes through RunCodeLocked for the log
+	const bool run_compiled = s_disable_logging;
 	s_active_codes.erase(std::remove_if(s_active_codes.begin(), s_active_codes.end(),
-		[](const ARCode& code) {
-		bool success = RunCodeLocked(code);
+		[run_compiled](const ActiveCode& active) {
+		if (run_compiled && !active.compiled.empty())
+		{
+			RunCompiledLocked(active.compiled);
+			return false;
+		}
+		bool success = RunCodeLocked(active.code);
 		LogInfo("\n");
 		return !success;
 	}),
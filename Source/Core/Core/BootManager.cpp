@@ -65,6 +65,7 @@ private:
 	bool bCPUThread;
 	bool bEnableCheats;
 	bool bSyncGPUOnSkipIdleHack;
+	bool bJITDetectIdleLoops;
 	bool bFPRF;
 	bool bAccurateNaNs;
 	bool bMMU;
@@ -72,6 +73,7 @@ private:
 	bool m_EnableJIT;
 	bool bSyncGPU;
 	bool bFastDiscSpeed;
+	bool bNativeSDKFunctions;
 	bool bDSPHLE;
 	bool bHLE_BS2;
 	bool bProgressive;
@@ -83,6 +85,9 @@ private:
 	int iCPUCore;
 	int Volume;
 	float m_EmulationSpeed;
+	bool m_OCAuto;
+	float m_OCAutoMin;
+	float m_OCAutoMax;
 	bool bTimeStretching;
 	std::string strBackend;
 	std::string sBackend;
@@ -99,6 +104,7 @@ void ConfigCache::SaveConfig(const SConfig& config)
 	bCPUThread = config.bCPUThread;
 	bEnableCheats = config.bEnableCheats;
 	bSyncGPUOnSkipIdleHack = config.bSyncGPUOnSkipIdleHack;
+	bJITDetectIdleLoops = config.bJITDetectIdleLoops;
 	bFPRF = config.bFPRF;
 	bAccurateNaNs = config.bAccurateNaNs;
 	bMMU = config.bMMU;
@@ -106,6 +112,7 @@ void ConfigCache::SaveConfig(const SConfig& config)
 	m_EnableJIT = config.m_DSPEnableJIT;
 	bSyncGPU = config.bSyncGPU;
 	bFastDiscSpeed = config.bFastDiscSpeed;
+	bNativeSDKFunctions = config.bNativeSDKFunctions;
 	bDSPHLE = config.bDSPHLE;
 	bHLE_BS2 = config.bHLE_BS2;
 	bProgressive = config.bProgressive;
@@ -114,6 +121,9 @@ void ConfigCache::SaveConfig(const SConfig& config)
 	iCPUCore = config.iCPUCore;
 	Volume = config.m_Volume;
 	m_EmulationSpeed = config.m_EmulationSpeed;
+	m_OCAuto = config.m_OCAuto;
+	m_OCAutoMin = config.m_OCAutoMin;
+	m_OCAutoMax = config.m_OCAutoMax;
 	strBackend = config.m_strVideoBackend;
 	sBackend = config.sBackend;
 	m_strGPUDeterminismMode = config.m_strGPUDeterminismMode;
@@ -142,6 +152,7 @@ void ConfigCache::RestoreConfig(SConfig* config)
 	config->bCPUThread = bCPUThread;
 	config->bEnableCheats = bEnableCheats;
 	config->bSyncGPUOnSkipIdleHack = bSyncGPUOnSkipIdleHack;
+	config->bJITDetectIdleLoops = bJITDetectIdleLoops;
 	config->bFPRF = bFPRF;
 	config->bAccurateNaNs = bAccurateNaNs;
 	config->bMMU = bMMU;
@@ -149,6 +160,7 @@ void ConfigCache::RestoreConfig(SConfig* config)
 	config->m_DSPEnableJIT = m_EnableJIT;
 	config->bSyncGPU = bSyncGPU;
 	config->bFastDiscSpeed = bFastDiscSpeed;
+	config->bNativeSDKFunctions = bNativeSDKFunctions;
 	config->bDSPHLE = bDSPHLE;
 	config->bHLE_BS2 = bHLE_BS2;
 	config->bProgressive = bProgressive;
@@ -159,6 +171,9 @@ void ConfigCache::RestoreConfig(SConfig* config)
 	config->bHalfAudioRate = bHalfAudioRate;
 	config->bTimeStretching = bTimeStretching;
 	config->bRSHACK = bRSHACK;
+	config->m_OCAuto = m_OCAuto;
+	config->m_OCAutoMin = m_OCAutoMin;
+	config->m_OCAutoMax = m_OCAutoMax;
 	// Only change these back if they were actually set by game ini, since they can be changed while a
 	// game is running.
 	if (bSetVolume)
@@ -246,6 +261,8 @@ bool BootCore(const std::string& _rFilename)
 		core_section->Get("EnableCheats", &StartUp.bEnableCheats, StartUp.bEnableCheats);
 		core_section->Get("SyncOnSkipIdle", &StartUp.bSyncGPUOnSkipIdleHack,
 			StartUp.bSyncGPUOnSkipIdleHack);
+		core_section->Get("JITDetectIdleLoops", &StartUp.bJITDetectIdleLoops,
+			StartUp.bJITDetectIdleLoops);
 		core_section->Get("FPRF", &StartUp.bFPRF, StartUp.bFPRF);
 		core_section->Get("AccurateNaNs", &StartUp.bAccurateNaNs, StartUp.bAccurateNaNs);
 		core_section->Get("MMU", &StartUp.bMMU, StartUp.bMMU);
@@ -255,7 +272,12 @@ bool BootCore(const std::string& _rFilename)
 		core_section->Get("TimeStretching", &StartUp.bTimeStretching, StartUp.bTimeStretching);
 		core_section->Get("RSHACK", &StartUp.bRSHACK, StartUp.bRSHACK);
 		core_section->Get("SyncGPU", &StartUp.bSyncGPU, StartUp.bSyncGPU);
+		core_section->Get("OverclockAuto", &StartUp.m_OCAuto, StartUp.m_OCAuto);
+		core_section->Get("OverclockAutoMin", &StartUp.m_OCAutoMin, StartUp.m_OCAutoMin);
+		core_section->Get("OverclockAutoMax", &StartUp.m_OCAutoMax, StartUp.m_OCAutoMax);
 		core_section->Get("FastDiscSpeed", &StartUp.bFastDiscSpeed, StartUp.bFastDiscSpeed);
+		core_section->Get("NativeSDKFunctions", &StartUp.bNativeSDKFunctions,
+			StartUp.bNativeSDKFunctions);
 		core_section->Get("DSPHLE", &StartUp.bDSPHLE, StartUp.bDSPHLE);
 		core_section->Get("GFXBackend", &StartUp.m_strVideoBackend, StartUp.m_strVideoBackend);
 		core_section->Get("CPUCore", &StartUp.iCPUCore, StartUp.iCPUCore);
@@ -253,12 +253,21 @@ void SConfig::SaveCoreSettings(IniFile& ini)
 
 	core->Set("HLE_BS2", bHLE_BS2);
 	core->Set("TimingVariance", iTimingVariance);
+	core->Set("GCZCacheSize", iGCZCacheSize);
 	core->Set("CPUCore", iCPUCore);
 	core->Set("Fastmem", bFastmem);
+	core->Set("LargePages", bLargePages);
+	core->Set("ThreadPlacement", bThreadPlacement);
+	core->Set("JITWarmStart", bJITWarmStart);
+	core->Set("JITInterpretColdBlocks", bJITInterpretColdBlocks);
+	core->Set("JITInlineLeafFunctions", bJITInlineLeafFunctions);
+	core->Set("JITProfileHostCycles", bJITProfileHostCycles);
+	core->Set("JITDetectIdleLoops", bJITDetectIdleLoops);
 	core->Set("CPUThread", bCPUThread);
 	core->Set("DSPHLE", bDSPHLE);
 	core->Set("SyncOnSkipIdle", bSyncGPUOnSkipIdleHack);
 	core->Set("SyncGPU", bSyncGPU);
+	core->Set("NativeSDKFunctions", bNativeSDKFunctions);
 	core->Set("SyncGpuMaxDistance", iSyncGpuMaxDistance);
 	core->Set("SyncGpuMinDistance", iSyncGpuMinDistance);
 	core->Set("SyncGpuOverclock", fSyncGpuOverclock);
@@ -268,6 +277,9 @@ void SConfig::SaveCoreSettings(IniFile& ini)
 	core->Set("DVDRoot", m_strDVDRoot);
 	core->Set("Apploader", m_strApploader);
 	core->Set("EnableCheats", bEnableCheats);
+	core->Set("DeltaSavestates", bDeltaSavestates);
+	core->Set("RewindSeconds", iRewindSeconds);
+	core->Set("RewindSnapshotsPerSecond", iRewindSnapshotsPerSecond);
 	core->Set("SelectedLanguage", SelectedLanguage);
 	core->Set("OverrideGCLang", bOverrideGCLanguage);
 	core->Set("DPL2Decoder", bDPL2Decoder);
@@ -298,6 +310,9 @@ void SConfig::SaveCoreSettings(IniFile& ini)
 	core->Set("FrameSkip", m_FrameSkip);
 	core->Set("Overclock", m_OCFactor);
 	core->Set("OverclockEnable", m_OCEnable);
+	core->Set("OverclockAuto", m_OCAuto);
+	core->Set("OverclockAutoMin", m_OCAutoMin);
+	core->Set("OverclockAutoMax", m_OCAutoMax);
 	core->Set("GFXBackend", m_strVideoBackend);
 	core->Set("GPUDeterminismMode", m_strGPUDeterminismMode);
 	core->Set("PerfMapDir", m_perfDir);
@@ -310,6 +325,7 @@ void SConfig::SaveMovieSettings(IniFile& ini)
 	IniFile::Section* movie = ini.GetOrCreateSection("Movie");
 
 	movie->Set("PauseMovie", m_PauseMovie);
+	movie->Set("Turbo", m_MovieTurbo);
 	movie->Set("Author", m_strMovieAuthor);
 	movie->Set("DumpFrames", m_DumpFrames);
 	movie->Set("DumpFramesSilent", m_DumpFramesSilent);
@@ -334,6 +350,8 @@ void SConfig::SaveInputSettings(IniFile& ini)
 	IniFile::Section* input = ini.GetOrCreateSection("Input");
 
 	input->Set("BackgroundInput", m_BackgroundInput);
+	input->Set("PollingRate", m_InputPollingRate);
+	input->Set("LateLatching", m_LateInputLatching);
 }
 
 void SConfig::SaveFifoPlayerSettings(IniFile& ini)
@@ -568,14 +586,25 @@ void SConfig::LoadCoreSettings(IniFile& ini)
 	core->Get("CPUCore", &iCPUCore, PowerPC::CORE_INTERPRETER);
 #endif
 	core->Get("Fastmem", &bFastmem, true);
+	core->Get("LargePages", &bLargePages, false);
+	core->Get("ThreadPlacement", &bThreadPlacement, false);
+	core->Get("JITWarmStart", &bJITWarmStart, true);
+	core->Get("JITInterpretColdBlocks", &bJITInterpretColdBlocks, true);
+	core->Get("JITInlineLeafFunctions", &bJITInlineLeafFunctions, true);
+	core->Get("JITProfileHostCycles", &bJITProfileHostCycles, false);
+	core->Get("JITDetectIdleLoops", &bJITDetectIdleLoops, true);
 	core->Get("DSPHLE", &bDSPHLE, true);
 	core->Get("TimingVariance", &iTimingVariance, 40);
+	core->Get("GCZCacheSize", &iGCZCacheSize, 4);
 	core->Get("CPUThread", &bCPUThread, true);
 	core->Get("SyncOnSkipIdle", &bSyncGPUOnSkipIdleHack, true);
 	core->Get("DefaultISO", &m_strDefaultISO);
 	core->Get("DVDRoot", &m_strDVDRoot);
 	core->Get("Apploader", &m_strApploader);
 	core->Get("EnableCheats", &bEnableCheats, false);
+	core->Get("DeltaSavestates", &bDeltaSavestates, false);
+	core->Get("RewindSeconds", &iRewindSeconds, 0);
+	core->Get("RewindSnapshotsPerSecond", &iRewindSnapshotsPerSecond, 10);
 	core->Get("SelectedLanguage", &SelectedLanguage, 0);
 	core->Get("OverrideGCLang", &bOverrideGCLanguage, false);
 	core->Get("DPL2Decoder", &bDPL2Decoder, false);
@@ -612,12 +641,16 @@ void SConfig::LoadCoreSettings(IniFile& ini)
 	core->Get("SyncGpuMinDistance", &iSyncGpuMinDistance, -200000);
 	core->Get("SyncGpuOverclock", &fSyncGpuOverclock, 1.0);
 	core->Get("FastDiscSpeed", &bFastDiscSpeed, false);
+	core->Get("NativeSDKFunctions", &bNativeSDKFunctions, true);
 	core->Get("DCBZ", &bDCBZOFF, false);
 	core->Get("FPRF", &bFPRF, false);
 	core->Get("AccurateNaNs", &bAccurateNaNs, false);
 	core->Get("EmulationSpeed", &m_EmulationSpeed, 1.0f);
 	core->Get("Overclock", &m_OCFactor, 1.0f);
 	core->Get("OverclockEnable", &m_OCEnable, false);
+	core->Get("OverclockAuto", &m_OCAuto, false);
+	core->Get("OverclockAutoMin", &m_OCAutoMin, 0.75f);
+	core->Get("OverclockAutoMax", &m_OCAutoMax, 1.0f);
 	core->Get("FrameSkip", &m_FrameSkip, 0);
 	core->Get("GFXBackend", &m_strVideoBackend, "");
 	core->Get("GPUDeterminismMode", &m_strGPUDeterminismMode, "auto");
@@ -632,6 +665,7 @@ void SConfig::LoadMovieSettings(IniFile& ini)
 	IniFile::Section* movie = ini.GetOrCreateSection("Movie");
 
 	movie->Get("PauseMovie", &m_PauseMovie, false);
+	movie->Get("Turbo", &m_MovieTurbo, false);
 	movie->Get("Author", &m_strMovieAuthor, "");
 	movie->Get("DumpFrames", &m_DumpFrames, false);
 	movie->Get("DumpFramesSilent", &m_DumpFramesSilent, false);
@@ -652,6 +686,8 @@ void SConfig::LoadDSPSettings(IniFile& ini)
 	dsp->Get("Backend", &sBackend, BACKEND_COREAUDIO);
 #elif defined _WIN32
 	dsp->Get("Backend", &sBackend, BACKEND_XAUDIO2);
+#elif defined ANDROID && HAVE_AAUDIO
+	dsp->Get("Backend", &sBackend, BACKEND_AAUDIO);
 #elif defined ANDROID
 	dsp->Get("Backend", &sBackend, BACKEND_OPENSLES);
 #else
@@ -668,6 +704,8 @@ void SConfig::LoadInputSettings(IniFile& ini)
 	IniFile::Section* input = ini.GetOrCreateSection("Input");
 
 	input->Get("BackgroundInput", &m_BackgroundInput, false);
+	input->Get("PollingRate", &m_InputPollingRate, 500);
+	input->Get("LateLatching", &m_LateInputLatching, false);
 }
 
 void SConfig::LoadFifoPlayerSettings(IniFile& ini)
@@ -750,11 +788,14 @@ void SConfig::LoadDefaults()
 
 	iCPUCore = PowerPC::CORE_JIT64;
 	iTimingVariance = 40;
+	iGCZCacheSize = 4;
 	bCPUThread = false;
 	bSyncGPUOnSkipIdleHack = true;
 	bRunCompareServer = false;
 	bDSPHLE = true;
 	bFastmem = true;
+	bLargePages = false;
+	bThreadPlacement = false;
 	bFPRF = false;
 	bAccurateNaNs = false;
 	bMMU = false;
@@ -764,6 +805,7 @@ void SConfig::LoadDefaults()
 	bHalfAudioRate = false;
 	bSyncGPU = false;
 	bFastDiscSpeed = false;
+	bNativeSDKFunctions = true;
 	m_strWiiSDCardPath = File::GetUserPath(F_WIISDCARD_IDX);
 	bEnableMemcardSdWriting = true;
 	SelectedLanguage = 0;
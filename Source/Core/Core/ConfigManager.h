@@ -28,6 +28,7 @@ enum class Language;
 #define BACKEND_PULSEAUDIO "Pulse"
 #define BACKEND_XAUDIO2 "XAudio2"
 #define BACKEND_OPENSLES "OpenSLES"
+#define BACKEND_AAUDIO "AAudio"
 
 enum GPUDeterminismMode
 {
@@ -83,12 +84,22 @@ struct SConfig : NonCopyable
 	bool bJITBranchOff = false;
 	bool bJITILTimeProfiling = false;
 	bool bJITILOutputIR = false;
+	bool bJITWarmStart = true;
+	bool bJITInterpretColdBlocks = true;
+	bool bJITInlineLeafFunctions = true;
+	bool bJITProfileHostCycles = false;
+	bool bJITDetectIdleLoops = true;
 
 	bool bFastmem;
+	// Back the emulated RAM and the JIT cache with large pages where the OS allows it
+	bool bLargePages = false;
+	// Pin the emulation threads to cores picked from the CPU topology, see PlaceCurrentThread
+	bool bThreadPlacement = false;
 	bool bFPRF = false;
 	bool bAccurateNaNs = false;
 
 	int iTimingVariance = 40;  // in milli secounds
+	int iGCZCacheSize = 4;  // in MiB, decompressed GCZ blocks kept per disc
 	bool bCPUThread = true;
 	bool bDSPThread = false;
 	bool bDSPHLE = true;
@@ -97,6 +108,9 @@ struct SConfig : NonCopyable
 	bool bForceNTSCJ = false;
 	bool bHLE_BS2 = true;
 	bool bEnableCheats = false;
+	bool bDeltaSavestates = false;  // Slot saves only store the pages changed since a keyframe
+	int iRewindSeconds = 0;  // 0 disables rewinding
+	int iRewindSnapshotsPerSecond = 10;
 	bool bEnableMemcardSdWriting = true;
 
 	bool bDPL2Decoder = false;
@@ -111,6 +125,7 @@ struct SConfig : NonCopyable
 	bool bDCBZOFF = false;
 	int iBBDumpPort = 0;
 	bool bFastDiscSpeed = false;
+	bool bNativeSDKFunctions = true;
 	int iVideoRate = 1;
 	bool bHalfAudioRate = false;
 
@@ -242,6 +257,10 @@ struct SConfig : NonCopyable
 	float m_EmulationSpeed;
 	bool m_OCEnable;
 	float m_OCFactor;
+	// Scale the CPU clock between these bounds from the idle-skip ratio and the emulation speed
+	bool m_OCAuto;
+	float m_OCAutoMin;
+	float m_OCAutoMax;
 	// other interface settings
 	bool m_InterfaceToolbar;
 	bool m_InterfaceStatusbar;
@@ -286,6 +305,7 @@ struct SConfig : NonCopyable
 
 	std::string m_WirelessMac;
 	bool m_PauseMovie;
+	bool m_MovieTurbo;
 	bool m_ShowLag;
 	bool m_ShowFrameCount;
 	bool m_ShowRTC;
@@ -308,6 +328,10 @@ struct SConfig : NonCopyable
 
 	// Input settings
 	bool m_BackgroundInput;
+	// How many times a second the input thread polls the devices, 0 polls them when the game reads
+	int m_InputPollingRate;
+	// Polls the devices again right before each SI poll, at the cost of waiting for them there
+	bool m_LateInputLatching;
 	bool m_AdapterRumble[4];
 	bool m_AdapterKonga[4];
 
@@ -25,6 +25,7 @@
 #include "Common/NandPaths.h"
 #include "Common/StringUtil.h"
 #include "Common/Thread.h"
+#include "Common/ThreadPool.h"
 #include "Common/Timer.h"
 
 #include "Core/Analytics.h"
@@ -73,6 +74,7 @@
 #include "InputCommon/ControllerInterface/ControllerInterface.h"
 #include "InputCommon/GCAdapter.h"
 #include "VideoCommon/Fifo.h"
+#include "VideoCommon/FrameTelemetry.h"
 #include "VideoCommon/OnScreenDisplay.h"
 #include "VideoCommon/RenderBase.h"
 #include "VideoCommon/VideoBackendBase.h"
@@ -157,7 +159,10 @@ void SetStateFileName(const std::string& val)
 void FrameUpdateOnCPUThread()
 {
 	if (NetPlay::IsNetPlayRunning())
+	{
 		NetPlayClient::SendTimeBase();
+		NetPlayClient::SendMemoryDigests();
+	}
 }
 
 // Display messages and return values
@@ -358,6 +363,7 @@ static void CpuThread()
 		Common::SetCurrentThreadName("CPU-GPU thread");
 		video_backend->Video_Prepare();
 	}
+	Common::PlaceCurrentThread(Common::ThreadRole::CPU);
 
 	// This needs to be delayed until after the video backend is ready.
 	DolphinAnalytics::Instance()->ReportGameStart();
@@ -429,6 +435,7 @@ static void FifoPlayerThread()
 		video_backend->Video_Prepare();
 		Common::SetCurrentThreadName("FIFO-GPU thread");
 	}
+	Common::PlaceCurrentThread(Common::ThreadRole::CPU);
 
 	// Enter CPU run loop. When we leave it - we are done.
 	if (FifoPlayer::GetInstance().Open(_CoreParameter.m_strFilename))
@@ -487,17 +494,70 @@ void EmuThread()
 	// For a time this acts as the CPU thread...
 	DeclareAsCPUThread();
 
+	FrameTelemetry::BeginBoot();
+	u64 step_start = Common::Timer::GetTimeUs();
+
 	Movie::Init();
 
+	Common::SetLargePagesEnabled(core_parameter.bLargePages);
+	Common::SetThreadPlacementEnabled(core_parameter.bThreadPlacement);
 	HW::Init();
+	FrameTelemetry::AddBootStep("hw", step_start);
+
+	// Enumerating the controllers, and waiting for real Wiimotes with a savestate to load, only
+	// needs the hardware, so it runs on the pool while the video backend and the DSP start.
+	const bool init_controllers = !g_controller_interface.IsInit();
+	const bool init_wiimotes = core_parameter.bWii && !SConfig::GetInstance().m_bt_passthrough_enabled;
+	Common::TaskGroup controller_init;
+	controller_init.Run([init_controllers, init_wiimotes] {
+		const u64 start = Common::Timer::GetTimeUs();
+		if (init_controllers)
+		{
+			g_controller_interface.Initialize(s_window_handle);
+			Pad::Initialize();
+			Keyboard::Initialize();
+		}
+		else
+		{
+			// Update references in case controllers were refreshed
+			Pad::LoadConfig();
+			Keyboard::LoadConfig();
+		}
+
+		// Load and Init Wiimotes - only if we are booting in Wii mode
+		if (init_wiimotes)
+		{
+			if (init_controllers)
+				Wiimote::Initialize(!s_state_filename.empty() ?
+					Wiimote::InitializeMode::DO_WAIT_FOR_WIIMOTES :
+					Wiimote::InitializeMode::DO_NOT_WAIT_FOR_WIIMOTES);
+			else
+				Wiimote::LoadConfig();
+		}
+		FrameTelemetry::AddBootStep("controllers", start);
+	}, Common::TaskPriority::High);
 
+	// Undoes the controller initialization when the boot fails
+	auto shutdown_controllers = [&controller_init, init_controllers] {
+		controller_init.Wait();
+		if (!init_controllers)
+			return;
+		Wiimote::Shutdown();
+		Keyboard::Shutdown();
+		Pad::Shutdown();
+		g_controller_interface.Shutdown();
+	};
+
+	step_start = Common::Timer::GetTimeUs();
 	if (!video_backend->Initialize(s_window_handle))
 	{
+		shutdown_controllers();
 		s_is_booting.Clear();
 		PanicAlert("Failed to initialize video backend!");
 		Host_Message(WM_USER_STOP);
 		return;
 	}
+	FrameTelemetry::AddBootStep("video_backend", step_start);
 
 	OSD::AddMessage("Dolphin " + video_backend->GetName() + " Video Backend.", 5000);
 
@@ -506,8 +566,10 @@ void EmuThread()
 	else
 		SConfig::GetInstance().bDSPThread = cpu_info.num_cores > 2;
 
+	step_start = Common::Timer::GetTimeUs();
 	if (!DSP::GetDSPEmulator()->Initialize(core_parameter.bWii, core_parameter.bDSPThread))
 	{
+		shutdown_controllers();
 		s_is_booting.Clear();
 		HW::Shutdown();
 		video_backend->Shutdown();
@@ -515,40 +577,21 @@ void EmuThread()
 		Host_Message(WM_USER_STOP);
 		return;
 	}
+	FrameTelemetry::AddBootStep("dsp", step_start);
 
-	bool init_controllers = false;
-	if (!g_controller_interface.IsInit())
-	{
-		g_controller_interface.Initialize(s_window_handle);
-		Pad::Initialize();
-		Keyboard::Initialize();
-		init_controllers = true;
-	}
-	else
-	{
-		// Update references in case controllers were refreshed
-		Pad::LoadConfig();
-		Keyboard::LoadConfig();
-	}
+	step_start = Common::Timer::GetTimeUs();
+	AudioCommon::InitSoundStream(s_window_handle);
+	FrameTelemetry::AddBootStep("audio", step_start);
 
-	// Load and Init Wiimotes - only if we are booting in Wii mode
-	if (core_parameter.bWii && !SConfig::GetInstance().m_bt_passthrough_enabled)
+	controller_init.Wait();
+	if (init_wiimotes)
 	{
-		if (init_controllers)
-			Wiimote::Initialize(!s_state_filename.empty() ?
-				Wiimote::InitializeMode::DO_WAIT_FOR_WIIMOTES :
-				Wiimote::InitializeMode::DO_NOT_WAIT_FOR_WIIMOTES);
-		else
-			Wiimote::LoadConfig();
-
 		// Activate Wiimotes which don't have source set to "None"
 		for (unsigned int i = 0; i != MAX_BBMOTES; ++i)
 			if (g_wiimote_sources[i])
 				GetUsbPointer()->AccessWiiMote(i | 0x100)->Activate(true);
 	}
 
-	AudioCommon::InitSoundStream(s_window_handle);
-
 	// The hardware is initialized.
 	s_hardware_initialized = true;
 	s_is_booting.Clear();
@@ -559,7 +602,9 @@ void EmuThread()
 	// Load GCM/DOL/ELF whatever ... we boot with the interpreter core
 	PowerPC::SetMode(PowerPC::MODE_INTERPRETER);
 
+	step_start = Common::Timer::GetTimeUs();
 	CBoot::BootUp();
+	FrameTelemetry::AddBootStep("boot", step_start);
 
 	// This adds the SyncGPU handler to CoreTiming, so now CoreTiming::Advance might block.
 	Fifo::Prepare();
@@ -595,8 +640,11 @@ void EmuThread()
 		// This thread, after creating the EmuWindow, spawns a CPU
 		// thread, and then takes over and becomes the video thread
 		Common::SetCurrentThreadName("Video thread");
+		Common::PlaceCurrentThread(Common::ThreadRole::GPU);
 
+		step_start = Common::Timer::GetTimeUs();
 		video_backend->Video_Prepare();
+		FrameTelemetry::AddBootStep("video_prepare", step_start);
 
 		// Spawn the CPU thread
 		s_cpu_thread = std::thread(cpuThreadFunc);
@@ -662,7 +710,6 @@ void EmuThread()
 		Keyboard::Shutdown();
 		Pad::Shutdown();
 		g_controller_interface.Shutdown();
-		init_controllers = false;
 	}
 
 	video_backend->Shutdown();
@@ -892,6 +939,7 @@ void Callback_VideoCopiedToXFB(bool video_update)
 		s_drawn_frame++;
 
 	Movie::FrameUpdate();
+	State::RewindFrameUpdate();
 }
 
 void UpdateTitle()
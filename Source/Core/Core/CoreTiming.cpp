@@ -3,22 +3,27 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <array>
 #include <cinttypes>
-#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 #include "Common/Assert.h"
+#include "Common/BitSet.h"
 #include "Common/ChunkFile.h"
-#include "Common/FifoQueue.h"
 #include "Common/Logging/Log.h"
+#include "Common/MPSCQueue.h"
+#include "Common/MathUtil.h"
 #include "Common/StringUtil.h"
 #include "Common/Thread.h"
+#include "Common/Timer.h"
+#include "Common/Trace.h"
 
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
 #include "Core/CoreTiming.h"
+#include "Core/HW/SystemTimers.h"
 #include "Core/PowerPC/PowerPC.h"
 
 #include "VideoCommon/Fifo.h"
@@ -55,17 +60,48 @@ static bool operator<(const Event& left, const Event& right)
 static std::unordered_map<std::string, EventType> s_event_types;
 
 // STATE_TO_SAVE
-// The queue is a min-heap using std::make_heap/push_heap/pop_heap.
+// Pending events are kept in a timing wheel of WHEEL_SLOTS slots, each slot holds the events of
+// WHEEL_SLOT_CYCLES cycles in no particular order. The wheel covers the WHEEL_SLOTS slots starting
+// at s_wheel_time, events scheduled past that go to s_event_queue, a min-heap using
+// std::make_heap/push_heap/pop_heap, and move to the wheel once it gets close to them.
+// Events scheduled before s_wheel_time are late and go to the current slot.
+//
+// The wheel spans 2^18 cycles, about half a millisecond at the GameCube clock and a third of one
+// on Wii. That covers the densest events: the VI half-lines, audio DMA, LLE DSP slices, SI
+// transfers and the interrupt updates scheduled a few cycles ahead. For those, scheduling is a
+// push_back and finding the next event is a short scan of the current slot. The once per
+// millisecond events (HLE DSP updates, the throttle, Wii IPC HLE updates) and anything further
+// ahead, like the patch engine each field, DVD read completions, device changes and long
+// decrementer periods, go to the heap and move to the wheel once it gets close to them.
 // We don't use std::priority_queue because we need to be able to serialize, unserialize and
 // erase arbitrary events (RemoveEvent()) regardless of the queue order. These aren't accomodated
 // by the standard adaptor class.
+static constexpr int WHEEL_SLOT_SHIFT = 10;
+static constexpr s64 WHEEL_SLOT_CYCLES = s64(1) << WHEEL_SLOT_SHIFT;
+static constexpr u32 WHEEL_SLOTS = 256;
+static constexpr s64 WHEEL_CYCLES = WHEEL_SLOT_CYCLES * WHEEL_SLOTS;
+
+static std::array<std::vector<Event>, WHEEL_SLOTS> s_wheel;
+// One bit per slot with events
+static std::array<u64, WHEEL_SLOTS / 64> s_wheel_used;
+static s64 s_wheel_time;
+static size_t s_wheel_count;
 static std::vector<Event> s_event_queue;
 static u64 s_event_fifo_id;
-static std::mutex s_ts_write_lock;
-static Common::FifoQueue<Event, false> s_ts_queue;
+static Common::MPSCQueue<Event> s_ts_queue;
 
 static float s_last_OC_factor;
 float g_last_OC_factor_inverted;
+
+// Automatic clock scaling, the factor is re-evaluated every AUTO_OC_FIELDS fields from the
+// share of idle-skipped cycles and the emulation speed over them.
+static constexpr u32 AUTO_OC_FIELDS = 30;
+static constexpr float AUTO_OC_STEP = 0.05f;
+static float s_auto_OC_factor;
+static u32 s_auto_OC_fields;
+static s64 s_auto_OC_start_ticks;
+static s64 s_auto_OC_start_idled;
+static u64 s_auto_OC_start_us;
 int g_slice_length;
 static constexpr int MAX_SLICE_LENGTH = 20000;
 
@@ -103,6 +139,131 @@ static int CyclesToDowncount(int cycles)
 	return static_cast<int>(cycles * s_last_OC_factor);
 }
 
+// The automatic factor isn't deterministic, movies and netplay use the fixed one
+static float GetOCFactor()
+{
+	const SConfig& config = SConfig::GetInstance();
+	if (config.m_OCAuto && !Core::g_want_determinism)
+		return s_auto_OC_factor;
+	return config.m_OCEnable ? config.m_OCFactor : 1.0f;
+}
+
+static void ResetAutoClock()
+{
+	s_auto_OC_fields = 0;
+	s_auto_OC_start_ticks = g_global_timer;
+	s_auto_OC_start_idled = s_idled_cycles;
+	s_auto_OC_start_us = Common::Timer::GetTimeUs();
+}
+
+static u32 WheelSlot(s64 time)
+{
+	return static_cast<u32>(time >> WHEEL_SLOT_SHIFT) & (WHEEL_SLOTS - 1);
+}
+
+static void InsertEvent(Event ev)
+{
+	u32 slot;
+	if (ev.time < s_wheel_time + WHEEL_SLOT_CYCLES)
+	{
+		slot = WheelSlot(s_wheel_time);
+	}
+	else if (ev.time < s_wheel_time + WHEEL_CYCLES)
+	{
+		slot = WheelSlot(ev.time);
+	}
+	else
+	{
+		s_event_queue.emplace_back(std::move(ev));
+		std::push_heap(s_event_queue.begin(), s_event_queue.end(), std::greater<Event>());
+		return;
+	}
+
+	s_wheel[slot].emplace_back(std::move(ev));
+	s_wheel_used[slot / 64] |= u64(1) << (slot % 64);
+	s_wheel_count++;
+}
+
+// Moves the events of the far queue which the wheel covers now
+static void MoveFarEvents()
+{
+	while (!s_event_queue.empty() && s_event_queue.front().time < s_wheel_time + WHEEL_CYCLES)
+	{
+		std::pop_heap(s_event_queue.begin(), s_event_queue.end(), std::greater<Event>());
+		Event ev = std::move(s_event_queue.back());
+		s_event_queue.pop_back();
+		InsertEvent(std::move(ev));
+	}
+}
+
+// Number of slots from the current one to the next slot with events, there must be one
+static u32 NextUsedSlotDistance()
+{
+	const u32 current = WheelSlot(s_wheel_time);
+	for (u32 i = 0; i <= s_wheel_used.size(); i++)
+	{
+		const u32 word = (current / 64 + i) % s_wheel_used.size();
+		u64 bits = s_wheel_used[word];
+		// Only the slots from the current one on in the first word, the rest of it comes last
+		if (i == 0)
+			bits &= ~u64(0) << (current % 64);
+		else if (i == s_wheel_used.size())
+			bits &= ~(~u64(0) << (current % 64));
+		if (bits)
+			return (word * 64 + LeastSignificantSetBit(bits) + WHEEL_SLOTS - current) % WHEEL_SLOTS;
+	}
+	return 0;
+}
+
+// Returns the earliest event, or nullptr when there are none. The pointer is valid until the
+// next event is scheduled or removed.
+static Event* GetNextEvent()
+{
+	if (s_wheel_count == 0)
+	{
+		if (s_event_queue.empty())
+			return nullptr;
+
+		// Jump straight to the next far event
+		s_wheel_time = s_event_queue.front().time & ~(WHEEL_SLOT_CYCLES - 1);
+		MoveFarEvents();
+	}
+
+	// The far events which move into the wheel are all behind the slot found here
+	const u32 distance = NextUsedSlotDistance();
+	if (distance != 0)
+	{
+		s_wheel_time += distance * WHEEL_SLOT_CYCLES;
+		MoveFarEvents();
+	}
+
+	std::vector<Event>& slot = s_wheel[WheelSlot(s_wheel_time)];
+	return &*std::min_element(slot.begin(), slot.end());
+}
+
+// ev must have been returned by GetNextEvent()
+static Event PopEvent(Event* ev)
+{
+	const u32 slot_index = WheelSlot(s_wheel_time);
+	std::vector<Event>& slot = s_wheel[slot_index];
+	Event result = std::move(*ev);
+	*ev = std::move(slot.back());
+	slot.pop_back();
+	if (slot.empty())
+		s_wheel_used[slot_index / 64] &= ~(u64(1) << (slot_index % 64));
+	s_wheel_count--;
+	return result;
+}
+
+// All pending events in no particular order
+static std::vector<Event> GetAllEvents()
+{
+	std::vector<Event> events(s_event_queue);
+	for (const std::vector<Event>& slot : s_wheel)
+		events.insert(events.end(), slot.begin(), slot.end());
+	return events;
+}
+
 EventType* RegisterEvent(const std::string& name, TimedCallback callback)
 {
 	// check for existing type with same name.
@@ -120,18 +281,22 @@ EventType* RegisterEvent(const std::string& name, TimedCallback callback)
 
 void UnregisterAllEvents()
 {
-	_assert_msg_(POWERPC, s_event_queue.empty(), "Cannot unregister events with events pending");
+	_assert_msg_(POWERPC, s_wheel_count == 0 && s_event_queue.empty(),
+		"Cannot unregister events with events pending");
 	s_event_types.clear();
 }
 
 void Init()
 {
-	s_last_OC_factor = SConfig::GetInstance().m_OCEnable ? SConfig::GetInstance().m_OCFactor : 1.0f;
+	const SConfig& config = SConfig::GetInstance();
+	s_auto_OC_factor = MathUtil::Clamp(1.0f, config.m_OCAutoMin, config.m_OCAutoMax);
+	s_last_OC_factor = GetOCFactor();
 	g_last_OC_factor_inverted = 1.0f / s_last_OC_factor;
 	PowerPC::ppcState.downcount = CyclesToDowncount(MAX_SLICE_LENGTH);
 	g_slice_length = MAX_SLICE_LENGTH;
 	g_global_timer = 0;
 	s_idled_cycles = 0;
+	ResetAutoClock();
 
 	// The time between CoreTiming being intialized and the first call to Advance() is considered
 	// the slice boundary between slice -1 and slice 0. Dispatcher loops must call Advance() before
@@ -140,12 +305,12 @@ void Init()
 	s_is_global_timer_sane = true;
 
 	s_event_fifo_id = 0;
+	s_wheel_time = 0;
 	s_ev_lost = RegisterEvent("_lost_event", &EmptyTimedCallback);
 }
 
 void Shutdown()
 {
-	std::lock_guard<std::mutex> lk(s_ts_write_lock);
 	MoveEvents();
 	ClearPendingEvents();
 	UnregisterAllEvents();
@@ -153,7 +318,6 @@ void Shutdown()
 
 void DoState(PointerWrap& p)
 {
-	std::lock_guard<std::mutex> lk(s_ts_write_lock);
 	p.Do(g_slice_length);
 	p.Do(g_global_timer);
 	p.Do(s_idled_cycles);
@@ -164,11 +328,18 @@ void DoState(PointerWrap& p)
 	p.Do(s_last_OC_factor);
 	p.Do(s_event_fifo_id);
 	g_last_OC_factor_inverted = 1.0f / s_last_OC_factor;
+	if (p.GetMode() == PointerWrap::MODE_READ)
+	{
+		const SConfig& config = SConfig::GetInstance();
+		s_auto_OC_factor = MathUtil::Clamp(s_last_OC_factor, config.m_OCAutoMin, config.m_OCAutoMax);
+		ResetAutoClock();
+	}
 
 	p.DoMarker("CoreTimingData");
 
 	MoveEvents();
-	p.DoEachElement(s_event_queue, [](PointerWrap& pw, Event& ev) {
+	std::vector<Event> events = GetAllEvents();
+	p.DoEachElement(events, [](PointerWrap& pw, Event& ev) {
 		pw.Do(ev.time);
 		pw.Do(ev.fifo_order);
 		// this is why we can't have (nice things) pointers as userdata
@@ -201,10 +372,14 @@ void DoState(PointerWrap& p)
 	p.DoMarker("CoreTimingEvents");
 
 	// When loading from a save state, we must assume the Event order is random and meaningless.
-	// The exact layout of the heap in memory is implementation defined, therefore it is platform
-	// and library version specific.
+	// The events are saved in wheel order, which depends on the wheel position.
 	if (p.GetMode() == PointerWrap::MODE_READ)
-		std::make_heap(s_event_queue.begin(), s_event_queue.end(), std::greater<Event>());
+	{
+		ClearPendingEvents();
+		s_wheel_time = g_global_timer & ~(WHEEL_SLOT_CYCLES - 1);
+		for (Event& ev : events)
+			InsertEvent(std::move(ev));
+	}
 }
 
 // This should only be called from the CPU thread. If you are calling
@@ -227,6 +402,10 @@ u64 GetIdleTicks()
 
 void ClearPendingEvents()
 {
+	for (std::vector<Event>& slot : s_wheel)
+		slot.clear();
+	s_wheel_used.fill(0);
+	s_wheel_count = 0;
 	s_event_queue.clear();
 }
 
@@ -254,8 +433,7 @@ void ScheduleEvent(s64 cycles_into_future, EventType* event_type, u64 userdata,
 		if (!s_is_global_timer_sane)
 			ForceExceptionCheck(cycles_into_future);
 
-		s_event_queue.emplace_back(Event{ timeout, s_event_fifo_id++, userdata, event_type });
-		std::push_heap(s_event_queue.begin(), s_event_queue.end(), std::greater<Event>());
+		InsertEvent(Event{ timeout, s_event_fifo_id++, userdata, event_type });
 	}
 	else
 	{
@@ -266,13 +444,23 @@ void ScheduleEvent(s64 cycles_into_future, EventType* event_type, u64 userdata,
 				event_type->name->c_str());
 		}
 
-		std::lock_guard<std::mutex> lk(s_ts_write_lock);
 		s_ts_queue.Push(Event{ g_global_timer + cycles_into_future, 0, userdata, event_type });
 	}
 }
 
 void RemoveEvent(EventType* event_type)
 {
+	for (u32 i = 0; i < WHEEL_SLOTS; i++)
+	{
+		std::vector<Event>& slot = s_wheel[i];
+		auto slot_itr = std::remove_if(slot.begin(), slot.end(),
+			[&](const Event& e) { return e.type == event_type; });
+		s_wheel_count -= slot.end() - slot_itr;
+		slot.erase(slot_itr, slot.end());
+		if (slot.empty())
+			s_wheel_used[i / 64] &= ~(u64(1) << (i % 64));
+	}
+
 	auto itr = std::remove_if(s_event_queue.begin(), s_event_queue.end(),
 		[&](const Event& e) { return e.type == event_type; });
 
@@ -294,11 +482,9 @@ void RemoveAllEvents(EventType* event_type)
 void ProcessFifoWaitEvents()
 {
 	MoveEvents();
-	while (!s_event_queue.empty() && s_event_queue.front().time <= g_global_timer)
+	for (Event* next = GetNextEvent(); next && next->time <= g_global_timer; next = GetNextEvent())
 	{
-		Event evt = std::move(s_event_queue.front());
-		std::pop_heap(s_event_queue.begin(), s_event_queue.end(), std::greater<Event>());
-		s_event_queue.pop_back();
+		Event evt = PopEvent(next);
 		// NOTICE_LOG(POWERPC, "[Scheduler] %-20s (%lld, %lld)", evt.type->name->c_str(),
 		//            g_global_timer, evt.time);
 		evt.type->callback(evt.userdata, g_global_timer - evt.time);
@@ -322,28 +508,27 @@ void MoveEvents()
 	for (Event ev; s_ts_queue.Pop(ev);)
 	{
 		ev.fifo_order = s_event_fifo_id++;
-		s_event_queue.emplace_back(std::move(ev));
-		std::push_heap(s_event_queue.begin(), s_event_queue.end(), std::greater<Event>());
+		InsertEvent(std::move(ev));
 	}
 }
 
 void Advance()
 {
+	TRACE_ZONE("CoreTiming::Advance");
 	MoveEvents();
 
 	int cyclesExecuted = g_slice_length - DowncountToCycles(PowerPC::ppcState.downcount);
 	g_global_timer += cyclesExecuted;
-	s_last_OC_factor = SConfig::GetInstance().m_OCEnable ? SConfig::GetInstance().m_OCFactor : 1.0f;
+	s_last_OC_factor = GetOCFactor();
 	g_last_OC_factor_inverted = 1.0f / s_last_OC_factor;
 	g_slice_length = MAX_SLICE_LENGTH;
 
 	s_is_global_timer_sane = true;
 
-	while (!s_event_queue.empty() && s_event_queue.front().time <= g_global_timer)
+	Event* next = GetNextEvent();
+	for (; next && next->time <= g_global_timer; next = GetNextEvent())
 	{
-		Event evt = std::move(s_event_queue.front());
-		std::pop_heap(s_event_queue.begin(), s_event_queue.end(), std::greater<Event>());
-		s_event_queue.pop_back();
+		Event evt = PopEvent(next);
 		// NOTICE_LOG(POWERPC, "[Scheduler] %-20s (%lld, %lld)", evt.type->name->c_str(),
 		//            g_global_timer, evt.time);
 		evt.type->callback(evt.userdata, g_global_timer - evt.time);
@@ -352,10 +537,10 @@ void Advance()
 	s_is_global_timer_sane = false;
 
 	// Still events left (scheduled in the future)
-	if (!s_event_queue.empty())
+	if (next)
 	{
-		g_slice_length = static_cast<int>(
-			std::min<s64>(s_event_queue.front().time - g_global_timer, MAX_SLICE_LENGTH));
+		g_slice_length =
+			static_cast<int>(std::min<s64>(next->time - g_global_timer, MAX_SLICE_LENGTH));
 	}
 
 	PowerPC::ppcState.downcount = CyclesToDowncount(g_slice_length);
@@ -369,7 +554,7 @@ void Advance()
 
 void LogPendingEvents()
 {
-	auto clone = s_event_queue;
+	auto clone = GetAllEvents();
 	std::sort(clone.begin(), clone.end());
 	for (const Event& ev : clone)
 	{
@@ -392,12 +577,52 @@ void Idle()
 	PowerPC::ppcState.downcount = 0;
 }
 
+void UpdateAutoClock()
+{
+	if (++s_auto_OC_fields < AUTO_OC_FIELDS)
+		return;
+
+	const SConfig& config = SConfig::GetInstance();
+	const s64 ticks = g_global_timer - s_auto_OC_start_ticks;
+	const s64 idled = s_idled_cycles - s_auto_OC_start_idled;
+	const u64 host_us = Common::Timer::GetTimeUs() - s_auto_OC_start_us;
+	ResetAutoClock();
+	if (!config.m_OCAuto || ticks <= 0 || host_us == 0)
+		return;
+
+	// Speed relative to the emulation speed limit, an unlimited speed never counts as lagging
+	const double emulated_us = ticks * 1000000.0 / SystemTimers::GetTicksPerSecond();
+	double speed = emulated_us / host_us;
+	if (config.m_EmulationSpeed > 0.0f)
+		speed /= config.m_EmulationSpeed;
+	else
+		speed = 1.0;
+	const double idle_ratio = static_cast<double>(idled) / ticks;
+
+	float factor = s_auto_OC_factor;
+	// The host can't keep up while the game has cycles to spare, or the game mostly idles:
+	// run fewer instructions to leave host time to the GPU thread.
+	if ((speed < 0.95 && idle_ratio > 0.1) || idle_ratio > 0.5)
+		factor -= AUTO_OC_STEP;
+	// Full speed and no idle time left, the game itself is lagging
+	else if (speed > 0.98 && idle_ratio < 0.05)
+		factor += AUTO_OC_STEP;
+	factor = MathUtil::Clamp(factor, config.m_OCAutoMin, config.m_OCAutoMax);
+
+	if (factor != s_auto_OC_factor)
+	{
+		DEBUG_LOG(POWERPC, "Auto clock: %.0f%% (speed %.2f, idle %.2f)", factor * 100.0f, speed,
+			idle_ratio);
+		s_auto_OC_factor = factor;
+	}
+}
+
 std::string GetScheduledEventsSummary()
 {
 	std::string text = "Scheduled events\n";
 	text.reserve(1000);
 
-	auto clone = s_event_queue;
+	auto clone = GetAllEvents();
 	std::sort(clone.begin(), clone.end());
 	for (const Event& ev : clone)
 	{
@@ -85,6 +85,9 @@ void ProcessFifoWaitEvents();
 // Pretend that the main CPU has executed enough cycles to reach the next event.
 void Idle();
 
+// Called once per VI field, scales the CPU clock when SConfig::m_OCAuto is set.
+void UpdateAutoClock();
+
 // Clear all pending events. This should ONLY be done on exit or state load.
 void ClearPendingEvents();
 
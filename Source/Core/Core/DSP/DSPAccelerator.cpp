@@ -10,38 +10,93 @@
 #include "Core/DSP/DSPHost.h"
 #include "Core/DSP/DSPHWInterface.h"
 #include "Core/DSP/DSPInterpreter.h"
+// Reading samples one at a time meant refetching and redecoding the frame header for every
+// sample, so the rest of the frame is decoded on the first read and later reads are served
+// from here. Only gdsp_ifx_write() can change the decoder state (address, YN1/YN2,
+// coefficients, format) behind our back, and it invalidates the cache.
+struct ADPCMFrameCache
+{
+	bool valid = false;
+	// Nibble address the next read has to be at to hit the cache.
+	u32 next_address;
+	// Indexed by the nibble offset of the read within the frame.
+	s16 samples[16];
+	u16 pred_scale[16];
+	u8 advance[16];
+};
+static ADPCMFrameCache s_adpcm_cache;
+
+void dsp_invalidate_accelerator()
+{
+	s_adpcm_cache.valid = false;
+}
+
 // The hardware adpcm decoder :)
-static s16 ADPCM_Step(u32& _rSamplePos)
+// Decodes from sample_pos to the end of its frame, starting from the current registers.
+static void DecodeADPCMFrame(u32 sample_pos)
 {
 	const s16 *pCoefTable = (const s16 *)&g_dsp.ifx_regs[DSP_COEF_A1_0];
+	u16 pred_scale = g_dsp.ifx_regs[DSP_PRED_SCALE];
+	s32 yn1 = (s16)g_dsp.ifx_regs[DSP_YN1];
+	s32 yn2 = (s16)g_dsp.ifx_regs[DSP_YN2];
 
-	if ((_rSamplePos & 15) == 0)
+	do
 	{
-		g_dsp.ifx_regs[DSP_PRED_SCALE] = DSPHost::ReadHostMemory((_rSamplePos & ~15) >> 1);
-		_rSamplePos += 2;
-	}
+		const u32 read_pos = sample_pos;
+		if ((sample_pos & 15) == 0)
+		{
+			pred_scale = DSPHost::ReadHostMemory((sample_pos & ~15) >> 1);
+			sample_pos += 2;
+		}
+
+		int scale = 1 << (pred_scale & 0xF);
+		int coef_idx = (pred_scale >> 4) & 0x7;
 
-	int scale = 1 << (g_dsp.ifx_regs[DSP_PRED_SCALE] & 0xF);
-	int coef_idx = (g_dsp.ifx_regs[DSP_PRED_SCALE] >> 4) & 0x7;
+		s32 coef1 = pCoefTable[coef_idx * 2 + 0];
+		s32 coef2 = pCoefTable[coef_idx * 2 + 1];
 
-	s32 coef1 = pCoefTable[coef_idx * 2 + 0];
-	s32 coef2 = pCoefTable[coef_idx * 2 + 1];
+		int temp = (sample_pos & 1) ?
+			(DSPHost::ReadHostMemory(sample_pos >> 1) & 0xF) :
+			(DSPHost::ReadHostMemory(sample_pos >> 1) >> 4);
 
-	int temp = (_rSamplePos & 1) ?
-		(DSPHost::ReadHostMemory(_rSamplePos >> 1) & 0xF) :
-		(DSPHost::ReadHostMemory(_rSamplePos >> 1) >> 4);
+		if (temp >= 8)
+			temp -= 16;
 
-	if (temp >= 8)
-		temp -= 16;
+		// 0x400 = 0.5  in 11-bit fixed point
+		int val = (scale * temp) + ((0x400 + coef1 * yn1 + coef2 * yn2) >> 11);
+		val = MathUtil::Clamp(val, -0x7FFF, 0x7FFF);
 
-	// 0x400 = 0.5  in 11-bit fixed point
-	int val = (scale * temp) + ((0x400 + coef1 * (s16)g_dsp.ifx_regs[DSP_YN1] + coef2 * (s16)g_dsp.ifx_regs[DSP_YN2]) >> 11);
-	val = MathUtil::Clamp(val, -0x7FFF, 0x7FFF);
+		yn2 = yn1;
+		yn1 = val;
 
+		sample_pos++;
+
+		const u32 idx = read_pos & 15;
+		s_adpcm_cache.samples[idx] = val;
+		s_adpcm_cache.pred_scale[idx] = pred_scale;
+		s_adpcm_cache.advance[idx] = sample_pos - read_pos;
+	} while (sample_pos & 15);
+}
+
+static s16 ADPCM_Step(u32& _rSamplePos)
+{
+	if (!s_adpcm_cache.valid || _rSamplePos != s_adpcm_cache.next_address)
+	{
+		DecodeADPCMFrame(_rSamplePos);
+		s_adpcm_cache.valid = true;
+	}
+
+	const u32 idx = _rSamplePos & 15;
+	const s16 val = s_adpcm_cache.samples[idx];
+	g_dsp.ifx_regs[DSP_PRED_SCALE] = s_adpcm_cache.pred_scale[idx];
 	g_dsp.ifx_regs[DSP_YN2] = g_dsp.ifx_regs[DSP_YN1];
 	g_dsp.ifx_regs[DSP_YN1] = val;
 
-	_rSamplePos++;
+	_rSamplePos += s_adpcm_cache.advance[idx];
+	// The next frame needs decoding
+	if ((_rSamplePos & 15) == 0)
+		s_adpcm_cache.valid = false;
+	s_adpcm_cache.next_address = _rSamplePos;
 
 	// The advanced interpolation (linear, polyphase,...) is done by the ucode,
 	// so we don't need to bother with it here.
@@ -103,6 +158,7 @@ void dsp_write_aram_d3(u16 value)
 
 	g_dsp.ifx_regs[DSP_ACCAH] = Address >> 16;
 	g_dsp.ifx_regs[DSP_ACCAL] = Address & 0xffff;
+	dsp_invalidate_accelerator();
 }
 
 u16 dsp_read_accelerator()
@@ -171,6 +227,8 @@ u16 dsp_read_accelerator()
 		// Set address back to start address.
 		Address = (g_dsp.ifx_regs[DSP_ACSAH] << 16) | g_dsp.ifx_regs[DSP_ACSAL];
 		DSPCore_SetException(EXP_ACCOV);
+		// The loop may start in the middle of the cached frame, with other YN1/YN2
+		dsp_invalidate_accelerator();
 	}
 
 	g_dsp.ifx_regs[DSP_ACCAH] = Address >> 16;
@@ -7,6 +7,8 @@
 #include "Common/CommonTypes.h"
 
 u16 dsp_read_accelerator();
+// Drops the decoded ADPCM frame, must be called whenever the accelerator state changes.
+void dsp_invalidate_accelerator();
 
 u16 dsp_read_aram_d3();
 void dsp_write_aram_d3(u16 value);
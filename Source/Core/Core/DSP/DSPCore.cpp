@@ -14,6 +14,7 @@
 #include "Common/Hash.h"
 #include "Common/MemoryUtil.h"
 
+#include "Core/DSP/DSPAccelerator.h"
 #include "Core/DSP/DSPAnalyzer.h"
 #include "Core/DSP/DSPCore.h"
 #include "Core/DSP/DSPEmitter.h"
@@ -173,6 +174,7 @@ void DSPCore_Reset()
 	g_dsp.pc = DSP_RESET_VECTOR;
 
 	std::fill(std::begin(g_dsp.r.wr), std::end(g_dsp.r.wr), 0xffff);
+	dsp_invalidate_accelerator();
 
 	DSPAnalyzer::Analyze();
 }
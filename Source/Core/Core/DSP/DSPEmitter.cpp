@@ -98,6 +98,32 @@ void DSPEmitter::checkExceptions(u32 retval)
 	SetJumpTarget(skipCheck);
 }
 
+void DSPEmitter::WriteBlockLink(u16 dest)
+{
+	// Jump directly to the block if it has already been compiled.
+	if (blockLinks[dest] != nullptr)
+	{
+		// Linked blocks are entered after their LoadRegs(), the statically allocated
+		// registers stay in their host registers across the jump.
+		gpr.FlushRegs();
+		// Check if we have enough cycles to execute the next block
+		MOV(16, R(ECX), M(&g_cycles_left));
+		CMP(16, R(ECX), Imm16(blockSize[startAddr] + blockSize[dest]));
+		FixupBranch notEnoughCycles = J_CC(CC_BE);
+
+		SUB(16, R(ECX), Imm16(blockSize[startAddr]));
+		MOV(16, M(&g_cycles_left), R(ECX));
+		JMP(blockLinks[dest], true);
+		SetJumpTarget(notEnoughCycles);
+	}
+	else
+	{
+		// The destination has not been compiled yet.  Add it to the list
+		// of blocks that this block is waiting on.
+		unresolvedJumps[startAddr].push_back(dest);
+	}
+}
+
 bool DSPEmitter::FlagsNeeded()
 {
 	if (!(DSPAnalyzer::code_flags[compilePC] & DSPAnalyzer::CODE_START_OF_INST) ||
@@ -324,6 +350,10 @@ void DSPEmitter::Compile(u16 start_addr)
 
 	if (fixup_pc)
 	{
+		// The block ended without a branch, continue into the next block unless this one has to
+		// report idle skip cycles to the dispatcher.
+		if (DSPHost::OnThread() || !(DSPAnalyzer::code_flags[start_addr] & DSPAnalyzer::CODE_IDLE_SKIP))
+			WriteBlockLink(compilePC);
 		MOV(16, M(&(g_dsp.pc)), Imm16(compilePC));
 	}
 
@@ -48,6 +48,9 @@ public:
 	void setCompileSR(u16 bit);
 	void clrCompileSR(u16 bit);
 	void checkExceptions(u32 retval);
+	// Jump straight to the block at dest if it is compiled and there are enough cycles left,
+	// otherwise fall through
+	void WriteBlockLink(u16 dest);
 
 	// Memory helper functions
 	void increment_addr_reg(int reg);
@@ -69,8 +69,8 @@ u16 gdsp_mbox_read_h(Mailbox mbx)
 
 u16 gdsp_mbox_read_l(Mailbox mbx)
 {
-	const u32 value = g_dsp.mbox[mbx].load(std::memory_order_acquire);
-	g_dsp.mbox[mbx].store(value & ~0x80000000, std::memory_order_release);
+	// The other side may write a new mail at any time, only clear the bit of the one read here
+	const u32 value = g_dsp.mbox[mbx].fetch_and(~0x80000000, std::memory_order_acq_rel);
 
 	if (g_init_hax && mbx == MAILBOX_DSP)
 	{
@@ -166,6 +166,8 @@ void gdsp_ifx_write(u32 addr, u32 val)
 			ERROR_LOG(DSPLLE, "%04x MW %04x (%04x)", g_dsp.pc, addr, val);
 		}
 		g_dsp.ifx_regs[addr & 0xFF] = val;
+		// Address, format, coefficient and predictor writes all end up here
+		dsp_invalidate_accelerator();
 		break;
 	}
 }
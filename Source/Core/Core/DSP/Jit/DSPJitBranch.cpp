@@ -90,41 +90,19 @@ static void WriteBranchExit(DSPEmitter& emitter)
 	emitter.gpr.FlushRegs(c, false);
 }
 
-static void WriteBlockLink(DSPEmitter& emitter, u16 dest)
+static void WriteBranchLink(DSPEmitter& emitter, u16 dest)
 {
-	// Jump directly to the called block if it has already been compiled.
+	// Branches back into the block being compiled can't be linked
 	if (!(dest >= emitter.startAddr && dest <= emitter.compilePC))
-	{
-		if (emitter.blockLinks[dest] != nullptr)
-		{
-			emitter.gpr.FlushRegs();
-			// Check if we have enough cycles to execute the next block
-			emitter.MOV(16, R(ECX), M(&g_cycles_left));
-			emitter.CMP(16, R(ECX), Imm16(emitter.blockSize[emitter.startAddr] + emitter.blockSize[dest]));
-			FixupBranch notEnoughCycles = emitter.J_CC(CC_BE);
-
-			emitter.SUB(16, R(ECX), Imm16(emitter.blockSize[emitter.startAddr]));
-			emitter.MOV(16, M(&g_cycles_left), R(ECX));
-			emitter.JMP(emitter.blockLinks[dest], true);
-			emitter.SetJumpTarget(notEnoughCycles);
-		}
-		else
-		{
-			// The destination has not been compiled yet.  Add it to the list
-			// of blocks that this block is waiting on.
-			emitter.unresolvedJumps[emitter.startAddr].push_back(dest);
-		}
-	}
+		emitter.WriteBlockLink(dest);
 }
 
 static void r_jcc(const UDSPInstruction opc, DSPEmitter& emitter)
 {
 	u16 dest = dsp_imem_read(emitter.compilePC + 1);
-	const DSPOPCTemplate *opcode = GetOpTemplate(opc);
 
-	// If the block is unconditional, attempt to link block
-	if (opcode->uncond_branch)
-		WriteBlockLink(emitter, dest);
+	// Also link the taken path of conditional branches
+	WriteBranchLink(emitter, dest);
 	emitter.MOV(16, M(&(g_dsp.pc)), Imm16(dest));
 	WriteBranchExit(emitter);
 }
@@ -166,11 +144,9 @@ static void r_call(const UDSPInstruction opc, DSPEmitter& emitter)
 	emitter.MOV(16, R(DX), Imm16(emitter.compilePC + 2));
 	emitter.dsp_reg_store_stack(DSP_STACK_C);
 	u16 dest = dsp_imem_read(emitter.compilePC + 1);
-	const DSPOPCTemplate *opcode = GetOpTemplate(opc);
 
-	// If the block is unconditional, attempt to link block
-	if (opcode->uncond_branch)
-		WriteBlockLink(emitter, dest);
+	// Also link the taken path of conditional branches
+	WriteBranchLink(emitter, dest);
 	emitter.MOV(16, M(&(g_dsp.pc)), Imm16(dest));
 	WriteBranchExit(emitter);
 }
@@ -4,20 +4,48 @@
 
 #include <algorithm>
 #include <string>
+#include <unordered_map>
+#include <zlib.h>
 
 #include "Common/FileUtil.h"
+#include "Common/Hash.h"
+#include "Common/Thread.h"
+#include "Common/ThreadPool.h"
 
 #include "Core/FifoPlayer/FifoDataFile.h"
 #include "Core/FifoPlayer/FifoFileStruct.h"
 
 using namespace FifoFileStruct;
 
+// Frames of a loaded file kept in memory, so multi-GB captures play in constant memory
+static const size_t FRAME_CACHE_SIZE = 256 * 1024 * 1024;
+// How far the frames after the one being played are read ahead
+static const u32 READ_AHEAD_FRAMES = 8;
+static const size_t READ_AHEAD_SIZE = 64 * 1024 * 1024;
+
+static size_t GetFrameSize(const FifoFrameInfo& frame)
+{
+	size_t size = frame.fifoData.size();
+	for (const MemoryUpdate& update : frame.memoryUpdates)
+		size += update.data.size();
+	return size;
+}
+
 FifoDataFile::FifoDataFile() : m_Flags(0)
 {
 }
 
 FifoDataFile::~FifoDataFile()
 {
+	if (m_ReadAheadThread.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lk(m_CacheLock);
+			m_ReadAheadQuit = true;
+		}
+		m_ReadAheadWake.notify_one();
+		m_ReadAheadThread.join();
+	}
 }
 
 bool FifoDataFile::HasBrokenEFBCopies() const
@@ -37,21 +65,177 @@ bool FifoDataFile::GetIsWii() const
 
 void FifoDataFile::AddFrame(const FifoFrameInfo& frameInfo)
 {
-	m_Frames.push_back(frameInfo);
+	m_Frames.push_back(std::make_shared<FifoFrameInfo>(frameInfo));
+}
+
+u32 FifoDataFile::GetFrameCount() const
+{
+	return static_cast<u32>(m_File ? m_FrameIndex.size() : m_Frames.size());
+}
+
+std::shared_ptr<const FifoFrameInfo> FifoDataFile::GetFrame(u32 frame) const
+{
+	if (!m_File)
+		return m_Frames[frame];
+
+	{
+		std::lock_guard<std::mutex> lk(m_CacheLock);
+		m_ReadAheadFrom = frame + 1;
+		m_ReadAheadPending = true;
+		m_ReadAheadWake.notify_one();
+
+		auto it = m_FrameCache.find(frame);
+		if (it != m_FrameCache.end())
+		{
+			it->second.lastUse = ++m_CacheUseCounter;
+			return it->second.frame;
+		}
+	}
+
+	std::shared_ptr<const FifoFrameInfo> data = ReadFrame(frame);
+	std::lock_guard<std::mutex> lk(m_CacheLock);
+	AddToCache(frame, data);
+	return data;
+}
+
+std::shared_ptr<const FifoFrameInfo> FifoDataFile::ReadFrame(u32 frame) const
+{
+	const FrameIndexEntry& entry = m_FrameIndex[frame];
+	auto data = std::make_shared<FifoFrameInfo>();
+	data->fifoData.resize(entry.fifoDataSize);
+	data->fifoStart = entry.fifoStart;
+	data->fifoEnd = entry.fifoEnd;
+
+	std::lock_guard<std::mutex> lk(m_FileLock);
+	ReadData(entry.fifoDataOffset, data->fifoData.data(), entry.fifoDataSize);
+	ReadMemoryUpdates(entry.memoryUpdatesOffset, entry.numMemoryUpdates, data->memoryUpdates);
+	return data;
 }
 
-bool FifoDataFile::Save(const std::string& filename)
+void FifoDataFile::AddToCache(u32 frame, std::shared_ptr<const FifoFrameInfo> data) const
+{
+	// the read ahead thread may have been faster
+	if (m_FrameCache.count(frame))
+		return;
+
+	const size_t size = GetFrameSize(*data);
+	m_FrameCache[frame] = {std::move(data), size, ++m_CacheUseCounter};
+	m_CacheSize += size;
+
+	while (m_CacheSize > FRAME_CACHE_SIZE && m_FrameCache.size() > 1)
+	{
+		auto oldest = m_FrameCache.begin();
+		for (auto it = m_FrameCache.begin(); it != m_FrameCache.end(); ++it)
+		{
+			if (it->second.lastUse < oldest->second.lastUse)
+				oldest = it;
+		}
+		m_CacheSize -= oldest->second.size;
+		m_FrameCache.erase(oldest);
+	}
+}
+
+void FifoDataFile::ReadAheadThread() const
+{
+	std::unique_lock<std::mutex> lk(m_CacheLock);
+	while (true)
+	{
+		m_ReadAheadWake.wait(lk, [this] { return m_ReadAheadQuit || m_ReadAheadPending; });
+		if (m_ReadAheadQuit)
+			return;
+		m_ReadAheadPending = false;
+
+		// Playback loops back to the start, so the read ahead does too
+		const u32 count = GetFrameCount();
+		const u32 from = m_ReadAheadFrom;
+		size_t size = 0;
+		for (u32 i = 0; i < std::min(READ_AHEAD_FRAMES, count) && size < READ_AHEAD_SIZE; i++)
+		{
+			const u32 frame = (from + i) % count;
+			auto it = m_FrameCache.find(frame);
+			if (it != m_FrameCache.end())
+			{
+				size += it->second.size;
+				continue;
+			}
+
+			lk.unlock();
+			std::shared_ptr<const FifoFrameInfo> data = ReadFrame(frame);
+			lk.lock();
+			size += GetFrameSize(*data);
+			AddToCache(frame, std::move(data));
+
+			// start over from wherever playback is now
+			if (m_ReadAheadQuit || m_ReadAheadPending)
+				break;
+		}
+	}
+}
+
+bool FifoDataFile::Save(const std::string& filename, bool compress)
 {
 	File::IOFile file;
 	if (!file.Open(filename, "wb"))
 		return false;
 
+	const u32 frameCount = GetFrameCount();
+	std::vector<std::shared_ptr<const FifoFrameInfo>> frames(frameCount);
+	for (u32 i = 0; i < frameCount; ++i)
+		frames[i] = GetFrame(i);
+
+	// Every block of data is written once. Games upload the same textures and vertices over and
+	// over, so memory updates with the same data share a block.
+	std::vector<const std::vector<u8>*> blocks;
+	std::vector<size_t> fifoBlocks(frameCount);
+	std::vector<std::vector<size_t>> updateBlocks(frameCount);
+	std::unordered_map<u64, std::vector<size_t>> blocksByHash;
+	for (u32 i = 0; i < frameCount; ++i)
+	{
+		fifoBlocks[i] = blocks.size();
+		blocks.push_back(&frames[i]->fifoData);
+
+		for (const MemoryUpdate& update : frames[i]->memoryUpdates)
+		{
+			const u64 hash =
+				GetMurmurHash3(update.data.data(), static_cast<u32>(update.data.size()), 0);
+			std::vector<size_t>& candidates = blocksByHash[hash];
+			auto it = std::find_if(candidates.begin(), candidates.end(),
+				[&](size_t block) { return *blocks[block] == update.data; });
+			if (it == candidates.end())
+			{
+				candidates.push_back(blocks.size());
+				it = candidates.end() - 1;
+				blocks.push_back(&update.data);
+			}
+			updateBlocks[i].push_back(*it);
+		}
+	}
+
+	std::vector<std::vector<u8>> compressedBlocks;
+	if (compress)
+	{
+		compressedBlocks.resize(blocks.size());
+		Common::ParallelLoop loop;
+		loop.Loop([&](int lower, int upper) {
+			for (int i = lower; i < upper; ++i)
+			{
+				const std::vector<u8>& src = *blocks[i];
+				std::vector<u8>& dst = compressedBlocks[i];
+				uLongf size = compressBound(static_cast<uLong>(src.size()));
+				dst.resize(size);
+				compress2(dst.data(), &size, src.data(), static_cast<uLong>(src.size()),
+					Z_DEFAULT_COMPRESSION);
+				dst.resize(size);
+			}
+		}, 0, static_cast<int>(blocks.size()), 16);
+	}
+
 	// Add space for header
 	PadFile(sizeof(FileHeader), file);
 
 	// Add space for frame list
 	u64 frameListOffset = file.Tell();
-	PadFile(m_Frames.size() * sizeof(FileFrameInfo), file);
+	PadFile(frameCount * sizeof(FileFrameInfo), file);
 
 	u64 bpMemOffset = file.Tell();
 	file.WriteArray(m_BPMem, BP_MEM_SIZE);
@@ -65,11 +249,57 @@ bool FifoDataFile::Save(const std::string& filename)
 	u64 xfRegsOffset = file.Tell();
 	file.WriteArray(m_XFRegs, XF_REGS_SIZE);
 
+	// Write data blocks
+	std::vector<u64> blockOffsets(blocks.size());
+	for (size_t i = 0; i < blocks.size(); ++i)
+	{
+		blockOffsets[i] = file.Tell();
+		if (compress)
+		{
+			const u32 size = static_cast<u32>(compressedBlocks[i].size());
+			file.WriteBytes(&size, sizeof(size));
+			file.WriteBytes(compressedBlocks[i].data(), size);
+		}
+		else
+		{
+			file.WriteBytes(blocks[i]->data(), blocks[i]->size());
+		}
+	}
+
+	// Write memory update and frame lists
+	std::vector<FileFrameInfo> frameList(frameCount);
+	for (u32 i = 0; i < frameCount; ++i)
+	{
+		const FifoFrameInfo& srcFrame = *frames[i];
+		FileFrameInfo& dstFrame = frameList[i];
+		dstFrame.fifoDataSize = static_cast<u32>(srcFrame.fifoData.size());
+		dstFrame.fifoDataOffset = blockOffsets[fifoBlocks[i]];
+		dstFrame.fifoStart = srcFrame.fifoStart;
+		dstFrame.fifoEnd = srcFrame.fifoEnd;
+		dstFrame.memoryUpdatesOffset = file.Tell();
+		dstFrame.numMemoryUpdates = static_cast<u32>(srcFrame.memoryUpdates.size());
+
+		for (size_t j = 0; j < srcFrame.memoryUpdates.size(); ++j)
+		{
+			const MemoryUpdate& srcUpdate = srcFrame.memoryUpdates[j];
+			FileMemoryUpdate dstUpdate;
+			dstUpdate.address = srcUpdate.address;
+			dstUpdate.dataOffset = blockOffsets[updateBlocks[i][j]];
+			dstUpdate.dataSize = static_cast<u32>(srcUpdate.data.size());
+			dstUpdate.fifoPosition = srcUpdate.fifoPosition;
+			dstUpdate.type = srcUpdate.type;
+			file.WriteBytes(&dstUpdate, sizeof(FileMemoryUpdate));
+		}
+	}
+
+	file.Seek(frameListOffset, SEEK_SET);
+	file.WriteArray(frameList.data(), frameList.size());
+
 	// Write header
 	FileHeader header;
 	header.fileId = FILE_ID;
 	header.file_version = VERSION_NUMBER;
-	header.min_loader_version = MIN_LOADER_VERSION;
+	header.min_loader_version = compress ? MIN_COMPRESSED_LOADER_VERSION : MIN_LOADER_VERSION;
 
 	header.bpMemOffset = bpMemOffset;
 	header.bpMemSize = BP_MEM_SIZE;
@@ -84,39 +314,14 @@ bool FifoDataFile::Save(const std::string& filename)
 	header.xfRegsSize = XF_REGS_SIZE;
 
 	header.frameListOffset = frameListOffset;
-	header.frameCount = (u32)m_Frames.size();
+	header.frameCount = frameCount;
 
-	header.flags = m_Flags;
+	// m_Flags describes the loaded file, which may be read from while saving
+	header.flags = compress ? (m_Flags | FLAG_COMPRESSED) : (m_Flags & ~FLAG_COMPRESSED);
 
 	file.Seek(0, SEEK_SET);
 	file.WriteBytes(&header, sizeof(FileHeader));
 
-	// Write frames list
-	for (unsigned int i = 0; i < m_Frames.size(); ++i)
-	{
-		const FifoFrameInfo& srcFrame = m_Frames[i];
-
-		// Write FIFO data
-		file.Seek(0, SEEK_END);
-		u64 dataOffset = file.Tell();
-		file.WriteBytes(srcFrame.fifoData.data(), srcFrame.fifoData.size());
-
-		u64 memoryUpdatesOffset = WriteMemoryUpdates(srcFrame.memoryUpdates, file);
-
-		FileFrameInfo dstFrame;
-		dstFrame.fifoDataSize = static_cast<u32>(srcFrame.fifoData.size());
-		dstFrame.fifoDataOffset = dataOffset;
-		dstFrame.fifoStart = srcFrame.fifoStart;
-		dstFrame.fifoEnd = srcFrame.fifoEnd;
-		dstFrame.memoryUpdatesOffset = memoryUpdatesOffset;
-		dstFrame.numMemoryUpdates = static_cast<u32>(srcFrame.memoryUpdates.size());
-
-		// Write frame info
-		u64 frameOffset = frameListOffset + (i * sizeof(FileFrameInfo));
-		file.Seek(frameOffset, SEEK_SET);
-		file.WriteBytes(&dstFrame, sizeof(FileFrameInfo));
-	}
-
 	if (!file.Close())
 		return false;
 
@@ -166,29 +371,31 @@ std::unique_ptr<FifoDataFile> FifoDataFile::Load(const std::string& filename, bo
 	file.Seek(header.xfRegsOffset, SEEK_SET);
 	file.ReadArray(dataFile->m_XFRegs, size);
 
-	// Read frames
-	for (u32 i = 0; i < header.frameCount; ++i)
-	{
-		u64 frameOffset = header.frameListOffset + (i * sizeof(FileFrameInfo));
-		file.Seek(frameOffset, SEEK_SET);
-		FileFrameInfo srcFrame;
-		file.ReadBytes(&srcFrame, sizeof(FileFrameInfo));
-
-		FifoFrameInfo dstFrame;
-		dstFrame.fifoData.resize(srcFrame.fifoDataSize);
-		dstFrame.fifoStart = srcFrame.fifoStart;
-		dstFrame.fifoEnd = srcFrame.fifoEnd;
-
-		file.Seek(srcFrame.fifoDataOffset, SEEK_SET);
-		file.ReadBytes(dstFrame.fifoData.data(), srcFrame.fifoDataSize);
-
-		ReadMemoryUpdates(srcFrame.memoryUpdatesOffset, srcFrame.numMemoryUpdates,
-			dstFrame.memoryUpdates, file);
+	// Only the frame list is read now, see GetFrame
+	std::vector<FileFrameInfo> frameList(header.frameCount);
+	file.Seek(header.frameListOffset, SEEK_SET);
+	if (!file.ReadArray(frameList.data(), frameList.size()))
+		return nullptr;
 
-		dataFile->AddFrame(dstFrame);
+	dataFile->m_FrameIndex.reserve(frameList.size());
+	for (const FileFrameInfo& srcFrame : frameList)
+	{
+		FrameIndexEntry entry;
+		entry.fifoDataOffset = srcFrame.fifoDataOffset;
+		entry.fifoDataSize = srcFrame.fifoDataSize;
+		entry.fifoStart = srcFrame.fifoStart;
+		entry.fifoEnd = srcFrame.fifoEnd;
+		entry.memoryUpdatesOffset = srcFrame.memoryUpdatesOffset;
+		entry.numMemoryUpdates = srcFrame.numMemoryUpdates;
+		dataFile->m_FrameIndex.push_back(entry);
 	}
 
-	file.Close();
+	dataFile->m_File = std::make_unique<File::IOFile>(std::move(file));
+	FifoDataFile* const dataFilePtr = dataFile.get();
+	dataFile->m_ReadAheadThread = std::thread([dataFilePtr] {
+		Common::SetCurrentThreadName("FIFO log read ahead");
+		dataFilePtr->ReadAheadThread();
+	});
 
 	return dataFile;
 }
@@ -212,48 +419,35 @@ bool FifoDataFile::GetFlag(u32 flag) const
 	return !!(m_Flags & flag);
 }
 
-u64 FifoDataFile::WriteMemoryUpdates(const std::vector<MemoryUpdate>& memUpdates,
-	File::IOFile& file)
+bool FifoDataFile::ReadData(u64 fileOffset, u8* data, u32 size) const
 {
-	// Add space for memory update list
-	u64 updateListOffset = file.Tell();
-	PadFile(memUpdates.size() * sizeof(FileMemoryUpdate), file);
+	m_File->Seek(fileOffset, SEEK_SET);
+	if (!GetFlag(FLAG_COMPRESSED))
+		return m_File->ReadBytes(data, size);
 
-	for (unsigned int i = 0; i < memUpdates.size(); ++i)
-	{
-		const MemoryUpdate& srcUpdate = memUpdates[i];
-
-		// Write memory
-		file.Seek(0, SEEK_END);
-		u64 dataOffset = file.Tell();
-		file.WriteBytes(srcUpdate.data.data(), srcUpdate.data.size());
-
-		FileMemoryUpdate dstUpdate;
-		dstUpdate.address = srcUpdate.address;
-		dstUpdate.dataOffset = dataOffset;
-		dstUpdate.dataSize = static_cast<u32>(srcUpdate.data.size());
-		dstUpdate.fifoPosition = srcUpdate.fifoPosition;
-		dstUpdate.type = srcUpdate.type;
-
-		u64 updateOffset = updateListOffset + (i * sizeof(FileMemoryUpdate));
-		file.Seek(updateOffset, SEEK_SET);
-		file.WriteBytes(&dstUpdate, sizeof(FileMemoryUpdate));
-	}
+	u32 compressedSize;
+	if (!m_File->ReadBytes(&compressedSize, sizeof(compressedSize)))
+		return false;
+	std::vector<u8> compressed(compressedSize);
+	if (!m_File->ReadBytes(compressed.data(), compressedSize))
+		return false;
 
-	return updateListOffset;
+	uLongf uncompressedSize = size;
+	return uncompress(data, &uncompressedSize, compressed.data(), compressedSize) == Z_OK &&
+		uncompressedSize == size;
 }
 
 void FifoDataFile::ReadMemoryUpdates(u64 fileOffset, u32 numUpdates,
-	std::vector<MemoryUpdate>& memUpdates, File::IOFile& file)
+	std::vector<MemoryUpdate>& memUpdates) const
 {
 	memUpdates.resize(numUpdates);
 
 	for (u32 i = 0; i < numUpdates; ++i)
 	{
 		u64 updateOffset = fileOffset + (i * sizeof(FileMemoryUpdate));
-		file.Seek(updateOffset, SEEK_SET);
+		m_File->Seek(updateOffset, SEEK_SET);
 		FileMemoryUpdate srcUpdate;
-		file.ReadBytes(&srcUpdate, sizeof(FileMemoryUpdate));
+		m_File->ReadBytes(&srcUpdate, sizeof(FileMemoryUpdate));
 
 		MemoryUpdate& dstUpdate = memUpdates[i];
 		dstUpdate.address = srcUpdate.address;
@@ -261,7 +455,6 @@ void FifoDataFile::ReadMemoryUpdates(u64 fileOffset, u32 numUpdates,
 		dstUpdate.data.resize(srcUpdate.dataSize);
 		dstUpdate.type = static_cast<MemoryUpdate::Type>(srcUpdate.type);
 
-		file.Seek(srcUpdate.dataOffset, SEEK_SET);
-		file.ReadBytes(dstUpdate.data.data(), srcUpdate.dataSize);
+		ReadData(srcUpdate.dataOffset, dstUpdate.data.data(), srcUpdate.dataSize);
 	}
 }
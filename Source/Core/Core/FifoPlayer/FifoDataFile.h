@@ -4,8 +4,12 @@
 
 #pragma once
 
+#include <condition_variable>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "Common/CommonTypes.h"
@@ -65,16 +69,21 @@ public:
 	u32* GetXFMem() { return m_XFMem; }
 	u32* GetXFRegs() { return m_XFRegs; }
 	void AddFrame(const FifoFrameInfo& frameInfo);
-	const FifoFrameInfo& GetFrame(u32 frame) const { return m_Frames[frame]; }
-	u32 GetFrameCount() const { return static_cast<u32>(m_Frames.size()); }
-	bool Save(const std::string& filename);
+	// Loaded files only keep the frame list in memory. The frames are read when they are first
+	// used and kept in a bounded cache, which the following frames are read into ahead of time.
+	// The returned pointer keeps the frame alive after the cache dropped it. Any thread.
+	std::shared_ptr<const FifoFrameInfo> GetFrame(u32 frame) const;
+	u32 GetFrameCount() const;
+	// Compression runs on all cores when the file is saved, recording itself doesn't pay for it
+	bool Save(const std::string& filename, bool compress = true);
 
 	static std::unique_ptr<FifoDataFile> Load(const std::string& filename, bool flagsOnly);
 
 private:
 	enum
 	{
-		FLAG_IS_WII = 1
+		FLAG_IS_WII = 1,
+		FLAG_COMPRESSED = 2,
 	};
 
 	void PadFile(size_t numBytes, File::IOFile& file);
@@ -82,9 +91,32 @@ private:
 	void SetFlag(u32 flag, bool set);
 	bool GetFlag(u32 flag) const;
 
-	u64 WriteMemoryUpdates(const std::vector<MemoryUpdate>& memUpdates, File::IOFile& file);
-	static void ReadMemoryUpdates(u64 fileOffset, u32 numUpdates,
-		std::vector<MemoryUpdate>& memUpdates, File::IOFile& file);
+	// m_FileLock has to be held
+	bool ReadData(u64 fileOffset, u8* data, u32 size) const;
+	void ReadMemoryUpdates(u64 fileOffset, u32 numUpdates,
+		std::vector<MemoryUpdate>& memUpdates) const;
+
+	struct FrameIndexEntry
+	{
+		u64 fifoDataOffset;
+		u32 fifoDataSize;
+		u32 fifoStart;
+		u32 fifoEnd;
+		u64 memoryUpdatesOffset;
+		u32 numMemoryUpdates;
+	};
+
+	struct CachedFrame
+	{
+		std::shared_ptr<const FifoFrameInfo> frame;
+		size_t size;
+		u64 lastUse;
+	};
+
+	std::shared_ptr<const FifoFrameInfo> ReadFrame(u32 frame) const;
+	// m_CacheLock has to be held
+	void AddToCache(u32 frame, std::shared_ptr<const FifoFrameInfo> data) const;
+	void ReadAheadThread() const;
 
 	u32 m_BPMem[BP_MEM_SIZE];
 	u32 m_CPMem[CP_MEM_SIZE];
@@ -94,5 +126,20 @@ private:
 	u32 m_Flags;
 	u32 m_Version;
 
-	std::vector<FifoFrameInfo> m_Frames;
+	// Recorded frames
+	std::vector<std::shared_ptr<const FifoFrameInfo>> m_Frames;
+
+	// Loaded files
+	std::unique_ptr<File::IOFile> m_File;
+	std::vector<FrameIndexEntry> m_FrameIndex;
+	mutable std::mutex m_FileLock;
+	mutable std::mutex m_CacheLock;
+	mutable std::map<u32, CachedFrame> m_FrameCache;
+	mutable size_t m_CacheSize = 0;
+	mutable u64 m_CacheUseCounter = 0;
+	mutable u32 m_ReadAheadFrom = 0;
+	mutable bool m_ReadAheadPending = false;
+	bool m_ReadAheadQuit = false;
+	mutable std::condition_variable m_ReadAheadWake;
+	std::thread m_ReadAheadThread;
 };
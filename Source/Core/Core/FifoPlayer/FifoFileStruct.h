@@ -11,8 +11,10 @@ namespace FifoFileStruct
 enum
 {
 	FILE_ID = 0x0d01f1f0,
-	VERSION_NUMBER = 3,
+	VERSION_NUMBER = 4,
 	MIN_LOADER_VERSION = 1,
+	// Files with FLAG_COMPRESSED can't be read by older versions
+	MIN_COMPRESSED_LOADER_VERSION = 4,
 };
 
 #pragma pack(push, 4)
@@ -51,6 +53,9 @@ union FileFrameInfo {
 	u32 rawData[16];
 };
 
+// In compressed files, every block of FIFO or memory data is stored as a u32 size followed by
+// that many bytes of zlib data. The sizes in the frame and memory update lists are uncompressed.
+// Memory updates that upload the same data point at the same block.
 struct FileMemoryUpdate
 {
 	u32 fifoPosition;
@@ -13,7 +13,6 @@ struct AnalyzedFrameInfo
 {
 	std::vector<u32> objectStarts;
 	std::vector<u32> objectEnds;
-	std::vector<MemoryUpdate> memoryUpdates;
 };
 
 namespace FifoPlaybackAnalyzer
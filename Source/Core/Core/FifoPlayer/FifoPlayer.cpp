@@ -72,6 +72,8 @@ public:
 		IsPlayingBackFifologWithBrokenEFBCopies = m_parent->m_File->HasBrokenEFBCopies();
 
 		m_parent->m_CurrentFrame = m_parent->m_FrameRangeStart;
+		m_parent->m_LoopsPlayed = 0;
+		m_parent->m_FramesPlayed = 0;
 		m_parent->LoadMemory();
 	}
 
@@ -116,7 +118,8 @@ int FifoPlayer::AdvanceFrame()
 {
 	if (m_CurrentFrame >= m_FrameRangeEnd)
 	{
-		if (!m_Loop)
+		const bool loop = m_LoopCount ? ++m_LoopsPlayed < m_LoopCount : m_Loop;
+		if (!loop)
 			return CPU::CPU_POWERDOWN;
 		// If there are zero frames in the range then sleep instead of busy spinning
 		if (m_FrameRangeStart >= m_FrameRangeEnd)
@@ -131,9 +134,10 @@ int FifoPlayer::AdvanceFrame()
 	if (m_EarlyMemoryUpdates && m_CurrentFrame == m_FrameRangeStart)
 		WriteAllMemoryUpdates();
 
-	WriteFrame(m_File->GetFrame(m_CurrentFrame), m_FrameInfo[m_CurrentFrame]);
+	WriteFrame(*m_File->GetFrame(m_CurrentFrame), m_FrameInfo[m_CurrentFrame]);
 
 	++m_CurrentFrame;
+	++m_FramesPlayed;
 	return CPU::CPU_RUNNING;
 }
 
@@ -196,7 +200,8 @@ FifoPlayer& FifoPlayer::GetInstance()
 }
 
 FifoPlayer::FifoPlayer()
-	: m_CurrentFrame(0), m_FrameRangeStart(0), m_FrameRangeEnd(0), m_ObjectRangeStart(0),
+	: m_LoopCount(0), m_LoopsPlayed(0), m_FramesPlayed(0), m_CurrentFrame(0),
+	m_FrameRangeStart(0), m_FrameRangeEnd(0), m_ObjectRangeStart(0),
 	m_ObjectRangeEnd(10000), m_EarlyMemoryUpdates(false), m_FileLoadedCb(nullptr),
 	m_FrameWrittenCb(nullptr), m_File(nullptr)
 {
@@ -276,7 +281,7 @@ void FifoPlayer::WriteFramePart(u32 dataStart, u32 dataEnd, u32& nextMemUpdate,
 
 	while (nextMemUpdate < frame.memoryUpdates.size() && dataStart < dataEnd)
 	{
-		const MemoryUpdate& memUpdate = info.memoryUpdates[nextMemUpdate];
+		const MemoryUpdate& memUpdate = frame.memoryUpdates[nextMemUpdate];
 
 		if (memUpdate.fifoPosition < dataEnd)
 		{
@@ -307,8 +312,8 @@ void FifoPlayer::WriteAllMemoryUpdates()
 
 	for (u32 frameNum = 0; frameNum < m_File->GetFrameCount(); ++frameNum)
 	{
-		const FifoFrameInfo& frame = m_File->GetFrame(frameNum);
-		for (auto& update : frame.memoryUpdates)
+		const auto frame = m_File->GetFrame(frameNum);
+		for (auto& update : frame->memoryUpdates)
 		{
 			WriteMemory(update);
 		}
@@ -363,7 +368,8 @@ void FifoPlayer::SetupFifo()
 	WriteCP(CommandProcessor::CTRL_REGISTER, 0);   // disable read, BP, interrupts
 	WriteCP(CommandProcessor::CLEAR_REGISTER, 7);  // clear overflow, underflow, metrics
 
-	const FifoFrameInfo& frame = m_File->GetFrame(m_CurrentFrame);
+	const auto frame_data = m_File->GetFrame(m_CurrentFrame);
+	const FifoFrameInfo& frame = *frame_data;
 
 	// Set fifo bounds
 	WriteCP(CommandProcessor::FIFO_BASE_LO, frame.fifoStart);
@@ -84,6 +84,12 @@ public:
 	// If enabled then all memory updates happen at once before the first frame
 	// Default is disabled
 	void SetEarlyMemoryUpdates(bool enabled) { m_EarlyMemoryUpdates = enabled; }
+
+	// Plays the frame range this many times and then stops, for benchmarks.
+	// 0 loops forever or plays once depending on the loop setting.
+	void SetLoopCount(u32 count) { m_LoopCount = count; }
+	u32 GetLoopsPlayed() const { return m_LoopsPlayed; }
+	u64 GetFramesPlayed() const { return m_FramesPlayed; }
 	// Callbacks
 	void SetFileLoadedCallback(CallbackFunc callback) { m_FileLoadedCb = callback; }
 	void SetFrameWrittenCallback(CallbackFunc callback) { m_FrameWrittenCb = callback; }
@@ -127,6 +133,9 @@ private:
 	static bool IsHighWatermarkSet();
 
 	bool m_Loop;
+	u32 m_LoopCount;
+	u32 m_LoopsPlayed;
+	u64 m_FramesPlayed;
 
 	u32 m_CurrentFrame;
 	u32 m_FrameRangeStart;
@@ -13,6 +13,7 @@
 #include "Core/HLE/HLE.h"
 #include "Core/HLE/HLE_Misc.h"
 #include "Core/HLE/HLE_OS.h"
+#include "Core/HLE/HLE_SDK.h"
 #include "Core/HW/Memmap.h"
 #include "Core/IPC_HLE/WII_IPC_HLE_Device_es.h"
 #include "Core/PowerPC/PPCSymbolDB.h"
@@ -65,6 +66,16 @@ static const SPatch OSPatches[] = {
 	{"__write_console", HLE_OS::HLE_write_console, HLE_HOOK_REPLACE,
 	 HLE_TYPE_DEBUG},  // used by sysmenu (+more?)
 
+	// Library functions games spend a lot of time in
+	{"memcpy", HLE_SDK::memmove, HLE_HOOK_REPLACE, HLE_TYPE_NATIVE},
+	{"memmove", HLE_SDK::memmove, HLE_HOOK_REPLACE, HLE_TYPE_NATIVE},
+	{"memset", HLE_SDK::memset, HLE_HOOK_REPLACE, HLE_TYPE_NATIVE},
+	{"DCFlushRange", HLE_SDK::DCRange, HLE_HOOK_REPLACE, HLE_TYPE_NATIVE},
+	{"DCFlushRangeNoSync", HLE_SDK::DCRange, HLE_HOOK_REPLACE, HLE_TYPE_NATIVE},
+	{"DCStoreRange", HLE_SDK::DCRange, HLE_HOOK_REPLACE, HLE_TYPE_NATIVE},
+	{"DCStoreRangeNoSync", HLE_SDK::DCRange, HLE_HOOK_REPLACE, HLE_TYPE_NATIVE},
+	{"DCInvalidateRange", HLE_SDK::DCRange, HLE_HOOK_REPLACE, HLE_TYPE_NATIVE},
+
 	{"GeckoCodehandler", HLE_Misc::GeckoCodeHandlerICacheFlush, HLE_HOOK_START, HLE_TYPE_FIXED},
 	{"GeckoHandlerReturnTrampoline", HLE_Misc::GeckoReturnTrampoline, HLE_HOOK_REPLACE,
 	 HLE_TYPE_FIXED},
@@ -180,6 +191,12 @@ bool IsEnabled(int flags)
 		PowerPC::GetMode() != MODE_INTERPRETER)
 		return false;
 
+	// The native functions can't raise the page faults of the guest code, nor hit memory checks
+	if (flags == HLE::HLE_TYPE_NATIVE &&
+		(!SConfig::GetInstance().bNativeSDKFunctions || SConfig::GetInstance().bMMU ||
+			SConfig::GetInstance().bEnableDebugging))
+		return false;
+
 	return true;
 }
 
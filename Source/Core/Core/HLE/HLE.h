@@ -22,6 +22,7 @@ enum HookFlag
 	HLE_TYPE_GENERIC = 0,  // Miscellaneous function
 	HLE_TYPE_DEBUG = 1,    // Debug output function
 	HLE_TYPE_FIXED = 2,    // An arbitrary hook mapped to a fixed address instead of a symbol
+	HLE_TYPE_NATIVE = 3,   // Native version of a library function, games can opt out of them
 };
 
 void PatchFunctions();
@@ -0,0 +1,112 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <cstring>
+
+#include "Common/CommonTypes.h"
+#include "Core/HLE/HLE_SDK.h"
+#include "Core/HW/Memmap.h"
+#include "Core/PowerPC/JitInterface.h"
+#include "Core/PowerPC/PowerPC.h"
+
+namespace HLE_SDK
+{
+// Returns the host memory of [address, address + size) when the game reaches all of it through
+// the BATs as plain RAM. Anything else, like MMIO or the locked L1 cache, takes the slow accessors.
+static u8* GetRAMRange(u32 address, u32 size)
+{
+	const u32 last = address + size - 1;
+	if (last < address || !PowerPC::IsOptimizableRAMAddress(address) ||
+		!PowerPC::IsOptimizableRAMAddress(last))
+	{
+		return nullptr;
+	}
+
+	u8* pointer = Memory::GetPointer(address);
+	if (Memory::GetPointer(last) != pointer + size - 1)
+		return nullptr;
+	return pointer;
+}
+
+// void* memmove(void* dst, const void* src, u32 size), also memcpy: the one of MSL picks the copy
+// direction from the addresses the same way, so overlapping ranges come out the same.
+void memmove()
+{
+	const u32 dst = GPR(3);
+	const u32 src = GPR(4);
+	const u32 size = GPR(5);
+
+	if (size != 0)
+	{
+		u8* dst_pointer = GetRAMRange(dst, size);
+		const u8* src_pointer = GetRAMRange(src, size);
+		if (dst_pointer && src_pointer)
+		{
+			std::memmove(dst_pointer, src_pointer, size);
+		}
+		else if (src < dst)
+		{
+			for (u32 i = size; i-- > 0;)
+				PowerPC::Write_U8(PowerPC::Read_U8(src + i), dst + i);
+		}
+		else
+		{
+			for (u32 i = 0; i < size; i++)
+				PowerPC::Write_U8(PowerPC::Read_U8(src + i), dst + i);
+		}
+	}
+
+	// r3 still holds dst, which is returned
+	NPC = LR;
+}
+
+// void* memset(void* dst, int value, u32 size)
+void memset()
+{
+	const u32 dst = GPR(3);
+	const u8 value = static_cast<u8>(GPR(4));
+	const u32 size = GPR(5);
+
+	if (size != 0)
+	{
+		if (u8* dst_pointer = GetRAMRange(dst, size))
+		{
+			std::memset(dst_pointer, value, size);
+		}
+		else
+		{
+			for (u32 i = 0; i < size; i++)
+				PowerPC::Write_U8(value, dst + i);
+		}
+	}
+
+	NPC = LR;
+}
+
+// void DCFlushRange(void* address, u32 size), and DCStoreRange and DCInvalidateRange with their
+// NoSync versions. They run dcbf, dcbst or dcbi on every 32 byte line the range touches, which all
+// come down to invalidating the JIT blocks there.
+void DCRange()
+{
+	const u32 address = GPR(3);
+	const u32 size = GPR(4);
+
+	if (size != 0)
+	{
+		const u32 start = address & ~0x1f;
+		const u32 lines = (size + (address & 0x1f) + 0x1f) >> 5;
+		if (GetRAMRange(start, lines * 32))
+		{
+			JitInterface::InvalidateICache(start, lines * 32, false);
+		}
+		else
+		{
+			for (u32 i = 0; i < lines; i++)
+				JitInterface::InvalidateICache(start + i * 32, 32, false);
+		}
+	}
+
+	NPC = LR;
+}
+}
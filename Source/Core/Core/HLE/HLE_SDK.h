@@ -0,0 +1,14 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+// Native versions of guest library functions that games call all the time. They leave memory and
+// the return value exactly as the guest code would, only the volatile registers differ.
+namespace HLE_SDK
+{
+void memmove();
+void memset();
+void DCRange();
+}
@@ -14,6 +14,7 @@
 #include "Core/HW/EXI_DeviceEthernet.h"
 
 #ifdef __linux__
+#include <cerrno>
 #include <fcntl.h>
 #include <linux/if_tun.h>
 #include <net/if.h>
@@ -67,6 +68,8 @@ bool CEXIETHERNET::Activate()
     }
   }
   ioctl(fd, TUNSETNOCSUM, 1);
+  // The read thread takes every frame that is waiting after each select
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
 
   INFO_LOG(SP1, "BBA initialized with associated tap %s", ifr.ifr_name);
   return RecvInit();
@@ -137,17 +140,22 @@ static void ReadThreadHandler(CEXIETHERNET* self)
     if (select(self->fd + 1, &rfds, nullptr, nullptr, &timeout) <= 0)
       continue;
 
-    int readBytes = read(self->fd, self->mRecvBuffer.get(), BBA_RECV_SIZE);
-    if (readBytes < 0)
+    while (true)
     {
-      ERROR_LOG(SP1, "Failed to read from BBA, err=%d", readBytes);
-    }
-    else if (self->readEnabled.IsSet())
-    {
-      DEBUG_LOG(SP1, "Read data: %s",
-                ArrayToString(self->mRecvBuffer.get(), readBytes, 0x10).c_str());
-      self->mRecvBufferLength = readBytes;
-      self->RecvHandlePacket();
+      int readBytes = read(self->fd, self->mRecvBuffer.get(), BBA_RECV_SIZE);
+      if (readBytes < 0)
+      {
+        if (errno != EAGAIN && errno != EWOULDBLOCK)
+          ERROR_LOG(SP1, "Failed to read from BBA, err=%d", errno);
+        break;
+      }
+      else if (self->readEnabled.IsSet())
+      {
+        DEBUG_LOG(SP1, "Read data: %s",
+                  ArrayToString(self->mRecvBuffer.get(), readBytes, 0x10).c_str());
+        self->mRecvBufferLength = readBytes;
+        self->RecvHandlePacket();
+      }
     }
   }
 }
@@ -3,12 +3,16 @@
 // Refer to the license.txt file included.
 
 #include "Core/HW/DSPHLE/UCodes/AX.h"
+
+#include <algorithm>
+
 #include "Common/ChunkFile.h"
 #include "Common/CommonFuncs.h"
 #include "Common/CommonTypes.h"
 #include "Common/FileUtil.h"
 #include "Common/Logging/Log.h"
 #include "Common/MathUtil.h"
+#include "Common/Trace.h"
 #include "Core/ConfigManager.h"
 #include "Core/HW/DSP.h"
 #include "Core/HW/DSPHLE/UCodes/AXStructs.h"
@@ -76,6 +80,7 @@ void AXUCode::SignalWorkEnd()
 
 void AXUCode::HandleCommandList()
 {
+	TRACE_ZONE("AXUCode::HandleCommandList");
 	// Temp variables for addresses computation
 	u16 addr_hi, addr_lo;
 	u16 addr2_hi, addr2_lo;
@@ -405,6 +410,75 @@ void AXUCode::DownloadAndMixWithVolume(u32 addr, u16 vol_main, u16 vol_auxa, u16
 }
 
 void AXUCode::ProcessPBList(u32 pb_addr)
+{
+	// Walk the list first, the voices don't depend on each other after that. The updates may
+	// change next_pb, so they are applied to the copy read here too.
+	m_voice_addrs.clear();
+	AXPB pb;
+	while (pb_addr)
+	{
+		m_voice_addrs.push_back(pb_addr);
+		ReadPB(pb_addr, pb);
+
+		u16* updates = (u16*)HLEMemory_Get_Pointer(HILO_TO_32(pb.updates.data));
+		for (int curr_ms = 0; curr_ms < 5; ++curr_ms)
+			ApplyUpdatesForMs(curr_ms, (u16*)&pb, pb.updates.num_updates, updates);
+
+		pb_addr = HILO_TO_32(pb.next_pb);
+	}
+
+	int* const main_buses[BAND_BUS_COUNT] = {
+		m_samples_left, m_samples_right, m_samples_surround, m_samples_auxA_left,
+		m_samples_auxA_right, m_samples_auxA_surround, m_samples_auxB_left,
+		m_samples_auxB_right, m_samples_auxB_surround
+	};
+
+	const u32 voice_count = static_cast<u32>(m_voice_addrs.size());
+	u32 bands = std::max(voice_count / MIN_VOICES_PER_BAND, 1u);
+	if (bands > MAX_VOICE_BANDS)
+		bands = MAX_VOICE_BANDS;
+	if (bands == 1)
+	{
+		ProcessVoices(0, voice_count, main_buses);
+		return;
+	}
+
+	const u32 voices_per_band = (voice_count + bands - 1) / bands;
+	m_voice_loop.Loop([&](int lower, int upper) {
+		for (int band = lower; band < upper; ++band)
+		{
+			const u32 first = band * voices_per_band;
+			const u32 last = std::min(first + voices_per_band, voice_count);
+			if (band == 0)
+			{
+				ProcessVoices(first, last, main_buses);
+				continue;
+			}
+
+			std::array<int, BAND_BUS_COUNT * 32 * 5>& samples = m_band_buses[band - 1];
+			samples.fill(0);
+			int* buses[BAND_BUS_COUNT];
+			for (u32 i = 0; i < BAND_BUS_COUNT; ++i)
+				buses[i] = &samples[i * 32 * 5];
+			ProcessVoices(first, last, buses);
+		}
+	}, 0, bands, 1);
+
+	// Integer sums, the result doesn't depend on the band count
+	for (u32 band = 1; band < bands; ++band)
+	{
+		const std::array<int, BAND_BUS_COUNT * 32 * 5>& samples = m_band_buses[band - 1];
+		for (u32 i = 0; i < BAND_BUS_COUNT; ++i)
+		{
+			for (u32 j = 0; j < 32 * 5; ++j)
+				main_buses[i][j] += samples[i * 32 * 5 + j];
+		}
+	}
+}
+
+// Renders the voices [first, last) of m_voice_addrs into buses, which are laid out like
+// AXBuffers. May run on any thread.
+void AXUCode::ProcessVoices(u32 first, u32 last, int* const* buses)
 {
 	// Samples per millisecond. In theory DSP sampling rate can be changed from
 	// 32KHz to 48KHz, but AX always process at 32KHz.
@@ -412,14 +486,11 @@ void AXUCode::ProcessPBList(u32 pb_addr)
 
 	AXPB pb;
 
-	while (pb_addr)
+	for (u32 voice = first; voice < last; ++voice)
 	{
-		AXBuffers buffers = { 
-		{
-			m_samples_left, m_samples_right, m_samples_surround, m_samples_auxA_left,
-			m_samples_auxA_right, m_samples_auxA_surround, m_samples_auxB_left,
-			m_samples_auxB_right, m_samples_auxB_surround
-		} };
+		const u32 pb_addr = m_voice_addrs[voice];
+		AXBuffers buffers;
+		std::copy(buses, buses + BAND_BUS_COUNT, buffers.ptrs);
 
 		ReadPB(pb_addr, pb);
 
@@ -439,7 +510,6 @@ void AXUCode::ProcessPBList(u32 pb_addr)
 		}
 
 		WritePB(pb_addr, pb);
-		pb_addr = HILO_TO_32(pb.next_pb);
 	}
 }
 
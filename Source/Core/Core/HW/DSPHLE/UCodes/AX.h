@@ -12,7 +12,11 @@
 
 #pragma once
 
+#include <array>
+#include <vector>
+
 #include "Common/CommonTypes.h"
+#include "Common/ThreadPool.h"
 #include "Core/HW/DSPHLE/UCodes/UCodes.h"
 
 // We can't directly use the mixer_control field from the PB because it does
@@ -86,6 +90,16 @@ protected:
 	u16 m_cmdlist[512];
 	u32 m_cmdlist_size;
 
+	// Voices are rendered in up to MAX_VOICE_BANDS bands on the thread pool. Band 0 mixes into
+	// the buffers above, the others into their own buses which are then added to them in order.
+	static constexpr u32 MAX_VOICE_BANDS = 8;
+	static constexpr u32 MIN_VOICES_PER_BAND = 8;
+	static constexpr u32 BAND_BUS_COUNT = 9;
+	// The emulation waits for the mix, so it goes before texture work
+	Common::ParallelLoop m_voice_loop{Common::TaskPriority::High};
+	std::vector<u32> m_voice_addrs;
+	std::array<std::array<int, BAND_BUS_COUNT * 32 * 5>, MAX_VOICE_BANDS - 1> m_band_buses;
+
 	// Table of coefficients for polyphase sample rate conversion.
 	// The coefficients aren't always available (they are part of the DSP DROM)
 	// so we also need to know if they are valid or not.
@@ -111,6 +125,7 @@ protected:
 	void SetupProcessing(u32 init_addr);
 	void DownloadAndMixWithVolume(u32 addr, u16 vol_main, u16 vol_auxa, u16 vol_auxb);
 	void ProcessPBList(u32 pb_addr);
+	void ProcessVoices(u32 first, u32 last, int* const* buses);
 	void MixAUXSamples(int aux_id, u32 write_addr, u32 read_addr);
 	void UploadLRS(u32 dst_addr);
 	void SetMainLR(u32 src_addr);
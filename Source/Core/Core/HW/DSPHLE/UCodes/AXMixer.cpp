@@ -0,0 +1,110 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Core/HW/DSPHLE/UCodes/AXMixer.h"
+
+#include "Common/Intrinsics.h"
+#include "Common/MathUtil.h"
+
+namespace AXMixer
+{
+static s16 ScaleSample(s16 sample, u16 volume)
+{
+	// The product always fits in 32 bits
+	return static_cast<s16>(MathUtil::Clamp((sample * volume) >> 15, -32767, 32767));
+}
+
+u16 ApplyVolumeGeneric(s16* out, const s16* input, u32 count, u16 volume, u16 delta)
+{
+	for (u32 i = 0; i < count; ++i)
+	{
+		out[i] = ScaleSample(input[i], volume);
+		volume += delta;
+	}
+	return volume;
+}
+
+u16 MixAddGeneric(int* out, const s16* input, u32 count, u16 volume, u16 delta, s16* last)
+{
+	for (u32 i = 0; i < count; ++i)
+	{
+		const s16 sample = ScaleSample(input[i], volume);
+		out[i] += sample;
+		volume += delta;
+		*last = sample;
+	}
+	return volume;
+}
+
+#ifdef _M_X86
+// Eight ScaleSample() at once
+static __m128i ScaleSamples(__m128i samples, __m128i volumes)
+{
+	const __m128i lo = _mm_mullo_epi16(samples, volumes);
+	// mulhi_epi16 takes the volumes as signed, volumes >= 0x8000 are short of 0x10000 * sample
+	__m128i hi = _mm_mulhi_epi16(samples, volumes);
+	hi = _mm_add_epi16(hi, _mm_and_si128(samples, _mm_srai_epi16(volumes, 15)));
+
+	const __m128i p0 = _mm_srai_epi32(_mm_unpacklo_epi16(lo, hi), 15);
+	const __m128i p1 = _mm_srai_epi32(_mm_unpackhi_epi16(lo, hi), 15);
+	// packs saturates to [-32768, 32767]
+	return _mm_max_epi16(_mm_packs_epi32(p0, p1), _mm_set1_epi16(-32767));
+}
+
+static __m128i VolumeRamp(u16 volume, u16 delta)
+{
+	return _mm_add_epi16(_mm_set1_epi16(volume),
+		_mm_mullo_epi16(_mm_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7), _mm_set1_epi16(delta)));
+}
+
+u16 ApplyVolume(s16* out, const s16* input, u32 count, u16 volume, u16 delta)
+{
+	__m128i volumes = VolumeRamp(volume, delta);
+	const __m128i step = _mm_set1_epi16(static_cast<u16>(delta * 8));
+
+	u32 i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		const __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), ScaleSamples(samples, volumes));
+		volumes = _mm_add_epi16(volumes, step);
+		volume += delta * 8;
+	}
+	return ApplyVolumeGeneric(out + i, input + i, count - i, volume, delta);
+}
+
+u16 MixAdd(int* out, const s16* input, u32 count, u16 volume, u16 delta, s16* last)
+{
+	__m128i volumes = VolumeRamp(volume, delta);
+	const __m128i step = _mm_set1_epi16(static_cast<u16>(delta * 8));
+
+	u32 i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		const __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+		const __m128i scaled = ScaleSamples(samples, volumes);
+		__m128i* dst = reinterpret_cast<__m128i*>(out + i);
+		// Sign extend to 32 bits
+		const __m128i s0 = _mm_srai_epi32(_mm_unpacklo_epi16(scaled, scaled), 16);
+		const __m128i s1 = _mm_srai_epi32(_mm_unpackhi_epi16(scaled, scaled), 16);
+		_mm_storeu_si128(dst, _mm_add_epi32(_mm_loadu_si128(dst), s0));
+		_mm_storeu_si128(dst + 1, _mm_add_epi32(_mm_loadu_si128(dst + 1), s1));
+		*last = static_cast<s16>(_mm_extract_epi16(scaled, 7));
+		volumes = _mm_add_epi16(volumes, step);
+		volume += delta * 8;
+	}
+	return MixAddGeneric(out + i, input + i, count - i, volume, delta, last);
+}
+#else
+u16 ApplyVolume(s16* out, const s16* input, u32 count, u16 volume, u16 delta)
+{
+	return ApplyVolumeGeneric(out, input, count, volume, delta);
+}
+
+u16 MixAdd(int* out, const s16* input, u32 count, u16 volume, u16 delta, s16* last)
+{
+	return MixAddGeneric(out, input, count, volume, delta, last);
+}
+#endif
+}
@@ -0,0 +1,24 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+// Per sample volume loops shared by AX GC and AX Wii, with SIMD versions that process
+// eight samples at a time. The generic versions are the reference the SIMD ones must match
+// bit for bit.
+
+#pragma once
+
+#include "Common/CommonTypes.h"
+
+namespace AXMixer
+{
+// Scales count samples by a volume which starts at volume and moves by delta after every
+// sample (wrapping around at 16 bits), clamping to [-32767, 32767]. out may be input.
+// Returns the volume after the last sample.
+u16 ApplyVolume(s16* out, const s16* input, u32 count, u16 volume, u16 delta);
+u16 ApplyVolumeGeneric(s16* out, const s16* input, u32 count, u16 volume, u16 delta);
+
+// Same scaling, but adds the samples to out and stores the last one in *last.
+u16 MixAdd(int* out, const s16* input, u32 count, u16 volume, u16 delta, s16* last);
+u16 MixAddGeneric(int* out, const s16* input, u32 count, u16 volume, u16 delta, s16* last);
+}
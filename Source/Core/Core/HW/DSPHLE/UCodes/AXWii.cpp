@@ -11,6 +11,7 @@
 #include "Common/Logging/Log.h"
 #include "Common/MathUtil.h"
 #include "Common/StringUtil.h"
+#include "Common/Trace.h"
 #include "Core/HW/DSPHLE/UCodes/AXStructs.h"
 #include "Core/HW/DSPHLE/UCodes/AXVoice.h"
 #include "Core/HW/DSPHLE/UCodes/UCodes.h"
@@ -31,6 +32,7 @@ AXWiiUCode::~AXWiiUCode()
 
 void AXWiiUCode::HandleCommandList()
 {
+	TRACE_ZONE("AXWiiUCode::HandleCommandList");
 	// Temp variables for addresses computation
 	u16 addr_hi, addr_lo;
 	u16 addr2_hi, addr2_lo;
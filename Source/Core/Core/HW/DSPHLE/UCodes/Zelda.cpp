@@ -13,6 +13,7 @@
 #include "Core/HW/DSPHLE/UCodes/GBA.h"
 #include "Core/HW/DSPHLE/UCodes/UCodes.h"
 #include "Core/HW/DSPHLE/UCodes/Zelda.h"
+#include "Core/HW/DSPHLE/UCodes/ZeldaMixer.h"
 
 // Uncomment this to have a strict version of the HLE implementation, which
 // PanicAlerts on recoverable unknown behaviors instead of silently ignoring
@@ -1031,14 +1032,7 @@ void ZeldaAudioRenderer::ApplyReverb(bool post_rendering)
 
 			auto ApplyFilter = [&]() {
 				// Filter the buffer using provided coefficients.
-				for (u16 i = 0; i < 0x50; ++i)
-				{
-					s32 sample = 0;
-					for (u16 j = 0; j < 8; ++j)
-						sample += (s32)buffer[i + j] * rpb.filter_coeffs[j];
-					sample >>= 15;
-					buffer[i] = MathUtil::Clamp(sample, -0x8000, 0x7FFF);
-				}
+				ZeldaMixer::ApplyFilter(buffer.data(), 0x50, rpb.filter_coeffs);
 			};
 
 			// LSB set -> pre-filtering.
@@ -0,0 +1,177 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Core/HW/DSPHLE/UCodes/ZeldaMixer.h"
+
+#include "Common/Intrinsics.h"
+#include "Common/MathUtil.h"
+
+namespace ZeldaMixer
+{
+void ApplyVolumeInPlaceGeneric(s16* buf, size_t count, u16 vol, int int_bits)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		s32 tmp = (u32)buf[i] * (u32)vol;
+		tmp >>= 16 - int_bits;
+
+		buf[i] = (s16)MathUtil::Clamp(tmp, -0x8000, 0x7FFF);
+	}
+}
+
+s32 AddBuffersWithVolumeRampGeneric(s16* dst, const s16* src, size_t count, s32 vol, s32 step)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		dst[i] += ((vol >> 16) * src[i]) >> 16;
+		vol += step;
+	}
+	return vol;
+}
+
+void AddBuffersWithVolumeGeneric(s16* dst, const s16* src, size_t count, u16 vol)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		s32 vol_src = ((s32)src[i] * (s32)vol) >> 15;
+		dst[i] += MathUtil::Clamp(vol_src, -0x8000, 0x7FFF);
+	}
+}
+
+void ApplyFilterGeneric(s16* buf, size_t count, const s16* coeffs)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		s32 sample = 0;
+		for (size_t j = 0; j < 8; ++j)
+			sample += (s32)buf[i + j] * coeffs[j];
+		sample >>= 15;
+		buf[i] = MathUtil::Clamp(sample, -0x8000, 0x7FFF);
+	}
+}
+
+#ifdef _M_X86
+// Eight (sample * vol) >> shift, saturated to s16. vol is unsigned, which mulhi_epi16 doesn't
+// know about: for vol >= 0x8000 the high halves are short of 0x10000 * sample.
+static __m128i ScaleSamples(__m128i samples, __m128i vol, __m128i shift)
+{
+	const __m128i lo = _mm_mullo_epi16(samples, vol);
+	__m128i hi = _mm_mulhi_epi16(samples, vol);
+	hi = _mm_add_epi16(hi, _mm_and_si128(samples, _mm_srai_epi16(vol, 15)));
+
+	const __m128i p0 = _mm_sra_epi32(_mm_unpacklo_epi16(lo, hi), shift);
+	const __m128i p1 = _mm_sra_epi32(_mm_unpackhi_epi16(lo, hi), shift);
+	return _mm_packs_epi32(p0, p1);
+}
+
+void ApplyVolumeInPlace(s16* buf, size_t count, u16 vol, int int_bits)
+{
+	const __m128i volumes = _mm_set1_epi16(vol);
+	const __m128i shift = _mm_cvtsi32_si128(16 - int_bits);
+
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m128i* ptr = reinterpret_cast<__m128i*>(buf + i);
+		_mm_storeu_si128(ptr, ScaleSamples(_mm_loadu_si128(ptr), volumes, shift));
+	}
+	ApplyVolumeInPlaceGeneric(buf + i, count - i, vol, int_bits);
+}
+
+s32 AddBuffersWithVolumeRamp(s16* dst, const s16* src, size_t count, s32 vol, s32 step)
+{
+	if (!vol && !step)
+		return vol;
+
+	// The 32 bit volumes of eight consecutive samples, wrapping around like the scalar loop
+	const u32 ustep = static_cast<u32>(step);
+	__m128i vol0 =
+		_mm_add_epi32(_mm_set1_epi32(vol), _mm_setr_epi32(0, ustep, 2 * ustep, 3 * ustep));
+	__m128i vol1 = _mm_add_epi32(vol0, _mm_set1_epi32(4 * ustep));
+	const __m128i vol_step = _mm_set1_epi32(8 * ustep);
+
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		// The high halves are s16 already, so packs only gathers them
+		const __m128i vol_hi =
+			_mm_packs_epi32(_mm_srai_epi32(vol0, 16), _mm_srai_epi32(vol1, 16));
+		const __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+		__m128i* ptr = reinterpret_cast<__m128i*>(dst + i);
+		_mm_storeu_si128(ptr, _mm_add_epi16(_mm_loadu_si128(ptr), _mm_mulhi_epi16(vol_hi, samples)));
+
+		vol0 = _mm_add_epi32(vol0, vol_step);
+		vol1 = _mm_add_epi32(vol1, vol_step);
+	}
+	return AddBuffersWithVolumeRampGeneric(dst + i, src + i, count - i, _mm_cvtsi128_si32(vol0),
+		step);
+}
+
+void AddBuffersWithVolume(s16* dst, const s16* src, size_t count, u16 vol)
+{
+	const __m128i volumes = _mm_set1_epi16(vol);
+	const __m128i shift = _mm_cvtsi32_si128(15);
+
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		const __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+		__m128i* ptr = reinterpret_cast<__m128i*>(dst + i);
+		_mm_storeu_si128(ptr,
+			_mm_add_epi16(_mm_loadu_si128(ptr), ScaleSamples(samples, volumes, shift)));
+	}
+	AddBuffersWithVolumeGeneric(dst + i, src + i, count - i, vol);
+}
+
+void ApplyFilter(s16* buf, size_t count, const s16* coeffs)
+{
+	__m128i taps[8];
+	for (size_t j = 0; j < 8; ++j)
+		taps[j] = _mm_set1_epi16(coeffs[j]);
+
+	// Eight outputs at a time. They only read inputs at or after their own position, so the
+	// block can be stored before the next one is loaded.
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m128i acc0 = _mm_setzero_si128();
+		__m128i acc1 = _mm_setzero_si128();
+		for (size_t j = 0; j < 8; ++j)
+		{
+			const __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + i + j));
+			const __m128i lo = _mm_mullo_epi16(samples, taps[j]);
+			const __m128i hi = _mm_mulhi_epi16(samples, taps[j]);
+			acc0 = _mm_add_epi32(acc0, _mm_unpacklo_epi16(lo, hi));
+			acc1 = _mm_add_epi32(acc1, _mm_unpackhi_epi16(lo, hi));
+		}
+		const __m128i result =
+			_mm_packs_epi32(_mm_srai_epi32(acc0, 15), _mm_srai_epi32(acc1, 15));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(buf + i), result);
+	}
+	ApplyFilterGeneric(buf + i, count - i, coeffs);
+}
+#else
+void ApplyVolumeInPlace(s16* buf, size_t count, u16 vol, int int_bits)
+{
+	ApplyVolumeInPlaceGeneric(buf, count, vol, int_bits);
+}
+
+s32 AddBuffersWithVolumeRamp(s16* dst, const s16* src, size_t count, s32 vol, s32 step)
+{
+	if (!vol && !step)
+		return vol;
+	return AddBuffersWithVolumeRampGeneric(dst, src, count, vol, step);
+}
+
+void AddBuffersWithVolume(s16* dst, const s16* src, size_t count, u16 vol)
+{
+	AddBuffersWithVolumeGeneric(dst, src, count, vol);
+}
+
+void ApplyFilter(s16* buf, size_t count, const s16* coeffs)
+{
+	ApplyFilterGeneric(buf, count, coeffs);
+}
+#endif
+}
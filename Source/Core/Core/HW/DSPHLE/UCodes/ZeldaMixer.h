@@ -0,0 +1,35 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+// Per sample volume loops of the Zelda ucode renderer, with SIMD versions that process
+// eight samples at a time. The generic versions are the reference the SIMD ones must match
+// bit for bit.
+
+#pragma once
+
+#include <cstddef>
+
+#include "Common/CommonTypes.h"
+
+namespace ZeldaMixer
+{
+// Scales count samples by a fixed point volume with int_bits integer bits (1 for 1.15,
+// 4 for 4.12), clamping to the s16 range.
+void ApplyVolumeInPlace(s16* buf, size_t count, u16 vol, int int_bits);
+void ApplyVolumeInPlaceGeneric(s16* buf, size_t count, u16 vol, int int_bits);
+
+// Adds src scaled by a 1.31 volume that moves by step after every sample to dst. The sums
+// wrap around like the DSP accumulators do. Returns the volume after the last sample.
+s32 AddBuffersWithVolumeRamp(s16* dst, const s16* src, size_t count, s32 vol, s32 step);
+s32 AddBuffersWithVolumeRampGeneric(s16* dst, const s16* src, size_t count, s32 vol, s32 step);
+
+// Adds src scaled by a constant 1.15 volume to dst.
+void AddBuffersWithVolume(s16* dst, const s16* src, size_t count, u16 vol);
+void AddBuffersWithVolumeGeneric(s16* dst, const s16* src, size_t count, u16 vol);
+
+// Runs the 8 tap reverb filter over buf, which holds count + 7 samples. Output i is written
+// over input i.
+void ApplyFilter(s16* buf, size_t count, const s16* coeffs);
+void ApplyFilterGeneric(s16* buf, size_t count, const s16* coeffs);
+}
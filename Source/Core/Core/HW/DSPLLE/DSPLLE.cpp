@@ -13,8 +13,10 @@
 #include "Common/Event.h"
 #include "Common/Logging/Log.h"
 #include "Common/Thread.h"
+#include "Common/Trace.h"
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
+#include "Core/DSP/DSPAccelerator.h"
 #include "Core/DSP/DSPCaptureLogger.h"
 #include "Core/DSP/DSPCore.h"
 #include "Core/DSP/DSPHWInterface.h"
@@ -62,6 +64,8 @@ void DSPLLE::DoState(PointerWrap& p)
 
 	p.Do(g_dsp.step_counter);
 	p.DoArray(g_dsp.ifx_regs);
+	if (p.GetMode() == PointerWrap::MODE_READ)
+		dsp_invalidate_accelerator();
 	p.Do(g_dsp.mbox[0]);
 	p.Do(g_dsp.mbox[1]);
 	Common::UnWriteProtectMemory(g_dsp.iram, DSP_IRAM_BYTE_SIZE, false);
@@ -75,30 +79,39 @@ void DSPLLE::DoState(PointerWrap& p)
 	p.Do(m_cycle_count);
 }
 
+// The CPU thread only waits for the DSP thread once it is more than this many DSP_Update()
+// slices behind, the rest of the time both run freely.
+static constexpr u32 DSP_THREAD_MAX_BACKLOG_SLICES = 2;
+
 // Regular thread
 void DSPLLE::DSPThread(DSPLLE* dsp_lle)
 {
 	Common::SetCurrentThreadName("DSP thread");
+	Common::PlaceCurrentThread(Common::ThreadRole::Realtime);
 
 	while (dsp_lle->m_bIsRunning.IsSet())
 	{
-		const int cycles = static_cast<int>(dsp_lle->m_cycle_count.load());
+		const u32 cycles = dsp_lle->m_cycle_count.load();
 		if (cycles > 0)
 		{
-			std::lock_guard<std::mutex> dsp_thread_lock(dsp_lle->m_csDSPThreadActive);
-			if (g_dsp_jit)
-			{
-				DSPCore_RunCycles(cycles);
-			}
-			else
 			{
-				DSPInterpreter::RunCyclesThread(cycles);
+				std::lock_guard<std::mutex> dsp_thread_lock(dsp_lle->m_csDSPThreadActive);
+				if (g_dsp_jit)
+				{
+					DSPCore_RunCycles(cycles);
+				}
+				else
+				{
+					DSPInterpreter::RunCyclesThread(cycles);
+				}
 			}
-			dsp_lle->m_cycle_count.store(0);
+			// Cycles added by the CPU thread in the meantime stay queued
+			dsp_lle->m_cycle_count.fetch_sub(cycles);
+			ppcEvent.Set();
 		}
 		else
 		{
-			ppcEvent.Set();
+			// The CPU thread sets the event whenever it hands over cycles to an idle DSP thread
 			dspEvent.Wait();
 		}
 	}
@@ -279,6 +292,7 @@ void DSPLLE::DSP_WriteMailBoxLow(bool _CPUMailbox, u16 _uLowMail)
 
 void DSPLLE::DSP_Update(int cycles)
 {
+	TRACE_ZONE("DSPLLE::DSP_Update");
 	int dsp_cycles = cycles / 6;
 
 	if (dsp_cycles <= 0)
@@ -310,6 +324,8 @@ void DSPLLE::DSP_Update(int cycles)
 			m_bDSPThread = false;
 			requestDisableThread = false;
 			SConfig::GetInstance().bDSPThread = false;
+			// Run what the thread didn't get to
+			dsp_cycles += static_cast<int>(m_cycle_count.exchange(0));
 		}
 	}
 
@@ -321,10 +337,14 @@ void DSPLLE::DSP_Update(int cycles)
 	}
 	else
 	{
-		// Wait for DSP thread to complete its cycle. Note: this logic should be thought through.
-		ppcEvent.Wait();
-		m_cycle_count.fetch_add(dsp_cycles);
-		dspEvent.Set();
+		// The DSP thread only sleeps once it has run all queued cycles
+		if (m_cycle_count.fetch_add(dsp_cycles) == 0)
+			dspEvent.Set();
+
+		// Don't let the DSP fall too far behind
+		const u32 max_backlog = static_cast<u32>(dsp_cycles) * DSP_THREAD_MAX_BACKLOG_SLICES;
+		while (m_cycle_count.load() > max_backlog && m_bIsRunning.IsSet())
+			ppcEvent.Wait();
 	}
 }
 
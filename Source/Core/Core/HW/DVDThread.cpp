@@ -2,7 +2,9 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <cinttypes>
+#include <deque>
 #include <map>
 #include <mutex>
 #include <thread>
@@ -54,7 +56,28 @@ struct ReadRequest
 	u64 realtime_done_us;
 };
 
-using ReadResult = std::pair<ReadRequest, std::vector<u8>>;
+struct ReadResult
+{
+	ReadRequest request;
+	std::vector<u8> buffer;
+
+	// Set instead of buffer when the data can be copied to emulated RAM straight from a memory
+	// mapped disc image. Only valid while the volume it was read from is inserted.
+	const u8* mapped_data = nullptr;
+
+	bool Succeeded() const { return mapped_data || !buffer.empty(); }
+	// Copies mapped data into the buffer, so the result no longer depends on the volume.
+	void MaterializeBuffer()
+	{
+		if (!mapped_data)
+			return;
+		buffer.assign(mapped_data, mapped_data + request.length);
+		mapped_data = nullptr;
+	}
+};
+
+// How results are stored in savestates.
+using SavedReadResult = std::pair<ReadRequest, std::vector<u8>>;
 
 static void StartDVDThread();
 static void StopDVDThread();
@@ -79,6 +102,38 @@ static Common::FifoQueue<ReadRequest, false> s_request_queue;
 static Common::FifoQueue<ReadResult, false> s_result_queue;
 static std::map<u64, ReadResult> s_result_map;
 
+// Read-ahead state. Only touched by the DVD thread, and by the CPU thread while the DVD thread
+// is stopped.
+
+// Bytes kept ahead of sequential reads.
+static const u64 SEQUENTIAL_READ_AHEAD = 1024 * 1024;
+// Prefetching is done in pieces of this size, so a new request never waits for more than one.
+static const u64 PREFETCH_CHUNK_SIZE = 256 * 1024;
+// Upper bound of the prefetched data kept around. The oldest data is dropped first.
+static const u64 PREFETCH_CACHE_SIZE = 8 * 1024 * 1024;
+// Upper bound of a read that adjacent queued requests are merged into.
+static const u64 MAX_COALESCED_READ_SIZE = 4 * 1024 * 1024;
+
+struct PrefetchedData
+{
+	u64 offset;
+	bool decrypt;
+	std::vector<u8> data;
+
+	u64 End() const { return offset + data.size(); }
+};
+
+static std::deque<PrefetchedData> s_prefetch_cache;
+static u64 s_prefetch_cache_size = 0;
+
+// The access pattern of the previous requests and the range that is predicted to be read next.
+static u64 s_last_offset = 0;
+static u64 s_last_end = 0;
+static s64 s_last_stride = 0;
+static bool s_last_decrypt = false;
+static u64 s_prefetch_next = 0;
+static u64 s_prefetch_end = 0;
+
 void Start()
 {
 	s_finish_read = CoreTiming::RegisterEvent("FinishReadDVDThread", FinishRead);
@@ -95,9 +150,23 @@ void Start()
 	StartDVDThread();
 }
 
+static void ResetPrefetch()
+{
+	s_prefetch_cache.clear();
+	s_prefetch_cache_size = 0;
+	s_last_offset = 0;
+	s_last_end = 0;
+	s_last_stride = 0;
+	s_last_decrypt = false;
+	s_prefetch_next = 0;
+	s_prefetch_end = 0;
+}
+
 static void StartDVDThread()
 {
 	_assert_(!s_dvd_thread.joinable());
+	// The volume may have changed while the thread was stopped.
+	ResetPrefetch();
 	s_dvd_thread_exiting.Clear();
 	s_dvd_thread = std::thread(DVDThread);
 }
@@ -124,22 +193,30 @@ void DoState(PointerWrap& p)
 {
 	// By waiting for the DVD thread to be done working, we ensure that
 	// there are no pending requests. The DVD thread won't be touching
-	// s_result_queue, and everything we need to save will be in either
-	// s_result_queue or s_result_map (other than s_next_id).
+	// s_result_queue, and everything we need to save will be in
+	// s_result_map (other than s_next_id), with mapped data copied into buffers.
 	WaitUntilIdle();
 
-	// Move everything from s_result_queue to s_result_map because
-	// PointerWrap::Do supports std::map but not Common::FifoQueue.
-	// This won't affect the behavior of FinishRead.
-	ReadResult result;
-	while (s_result_queue.Pop(result))
-		s_result_map.emplace(result.first.id, std::move(result));
-
 	// Everything is now in s_result_map, so we simply savestate that.
 	// We also savestate s_next_id to avoid ID collisions.
-	p.Do(s_result_map);
+	std::map<u64, SavedReadResult> saved_results;
+	for (auto& entry : s_result_map)
+	{
+		saved_results.emplace(entry.first, SavedReadResult(entry.second.request,
+			std::move(entry.second.buffer)));
+	}
+	p.Do(saved_results);
 	p.Do(s_next_id);
 
+	s_result_map.clear();
+	for (auto& entry : saved_results)
+	{
+		ReadResult result;
+		result.request = entry.second.first;
+		result.buffer = std::move(entry.second.second);
+		s_result_map.emplace(entry.first, std::move(result));
+	}
+
 	// TODO: Savestates can be smaller if the buffers of results aren't saved,
 	// but instead get re-read from the disc when loading the savestate.
 
@@ -159,6 +236,17 @@ void WaitUntilIdle()
 		s_result_queue_expanded.Wait();
 
 	StopDVDThread();
+
+	// Move everything from s_result_queue to s_result_map because
+	// PointerWrap::Do supports std::map but not Common::FifoQueue.
+	// This won't affect the behavior of FinishRead. Results that point into
+	// the volume get their own copy, since the caller may be about to change it.
+	ReadResult result;
+	while (s_result_queue.Pop(result))
+		s_result_map.emplace(result.request.id, std::move(result));
+	for (auto& entry : s_result_map)
+		entry.second.MaterializeBuffer();
+
 	StartDVDThread();
 }
 
@@ -228,16 +316,16 @@ static void FinishRead(u64 id, s64 cycles_late)
 			while (!s_result_queue.Pop(result))
 				s_result_queue_expanded.Wait();
 
-			if (result.first.id == id)
+			if (result.request.id == id)
 				break;
 			else
-				s_result_map.emplace(result.first.id, std::move(result));
+				s_result_map.emplace(result.request.id, std::move(result));
 		}
 	}
 	// We have now obtained the right ReadResult.
 
-	const ReadRequest& request = result.first;
-	const std::vector<u8>& buffer = result.second;
+	const ReadRequest& request = result.request;
+	const std::vector<u8>& buffer = result.buffer;
 
 	DEBUG_LOG(DVDINTERFACE, "Disc has been read. Real time: %" PRIu64 " us. "
 		"Real time including delay: %" PRIu64 " us. "
@@ -247,7 +335,7 @@ static void FinishRead(u64 id, s64 cycles_late)
 		(CoreTiming::GetTicks() - request.time_started_ticks) /
 		(SystemTimers::GetTicksPerSecond() / 1000000));
 
-	if (buffer.empty())
+	if (!result.Succeeded())
 	{
 		PanicAlertT("The disc could not be read (at 0x%" PRIx64 " - 0x%" PRIx64 ").",
 			request.dvd_offset, request.dvd_offset + request.length);
@@ -255,7 +343,10 @@ static void FinishRead(u64 id, s64 cycles_late)
 	else
 	{
 		if (request.copy_to_ram)
-			Memory::CopyToEmu(request.output_address, buffer.data(), request.length);
+		{
+			Memory::CopyToEmu(request.output_address,
+				result.mapped_data ? result.mapped_data : buffer.data(), request.length);
+		}
 	}
 
 	// Notify the emulated software that the command has been executed
@@ -263,32 +354,213 @@ static void FinishRead(u64 id, s64 cycles_late)
 		buffer);
 }
 
-static void DVDThread()
+// Copies the range from prefetched data. Fails unless all of it is cached.
+static bool ReadFromPrefetchCache(u64 offset, u64 length, bool decrypt, u8* out_ptr)
 {
-	Common::SetCurrentThreadName("DVD thread");
+	while (length > 0)
+	{
+		auto it = std::find_if(s_prefetch_cache.begin(), s_prefetch_cache.end(),
+			[&](const PrefetchedData& entry) {
+			return entry.decrypt == decrypt && entry.offset <= offset && offset < entry.End();
+		});
+		if (it == s_prefetch_cache.end())
+			return false;
+
+		const u64 copy_size = std::min(length, it->End() - offset);
+		std::copy_n(it->data.begin() + (offset - it->offset), copy_size, out_ptr);
+		offset += copy_size;
+		length -= copy_size;
+		out_ptr += copy_size;
+	}
+	return true;
+}
 
-	while (true)
+// Remembers the request and predicts which range will be read next: the data following a
+// sequential read, or the next request of reads that step through the disc with a fixed stride.
+static void UpdateAccessPattern(u64 offset, u64 length, bool decrypt)
+{
+	const s64 stride = static_cast<s64>(offset - s_last_offset);
+	const bool same_space = decrypt == s_last_decrypt;
+
+	if (same_space && offset == s_last_end)
 	{
-		s_request_queue_expanded.Wait();
+		// Keep the read-ahead window in front of the reads. Prefetch() skips the part of it that
+		// is already cached.
+		s_prefetch_next = offset + length;
+		s_prefetch_end = s_prefetch_next + SEQUENTIAL_READ_AHEAD;
+	}
+	else if (same_space && stride != 0 && stride == s_last_stride &&
+		static_cast<s64>(offset) + stride >= 0)
+	{
+		s_prefetch_next = offset + stride;
+		s_prefetch_end = s_prefetch_next + length;
+	}
+	else
+	{
+		s_prefetch_next = s_prefetch_end = 0;
+	}
 
-		if (s_dvd_thread_exiting.IsSet())
-			return;
+	s_last_stride = stride;
+	s_last_offset = offset;
+	s_last_end = offset + length;
+	s_last_decrypt = decrypt;
+}
+
+// Reads the next piece of the predicted range into the cache.
+// Returns false when there is nothing left to prefetch.
+static bool Prefetch()
+{
+	if (s_prefetch_next >= s_prefetch_end || !DVDInterface::VolumeIsValid())
+		return false;
+
+	// Skip what is already cached.
+	for (const PrefetchedData& entry : s_prefetch_cache)
+	{
+		if (entry.decrypt == s_last_decrypt && entry.offset <= s_prefetch_next &&
+			s_prefetch_next < entry.End())
+		{
+			s_prefetch_next = std::min(entry.End(), s_prefetch_end);
+			return true;
+		}
+	}
+
+	PrefetchedData entry;
+	entry.offset = s_prefetch_next;
+	entry.decrypt = s_last_decrypt;
+	entry.data.resize(std::min(PREFETCH_CHUNK_SIZE, s_prefetch_end - s_prefetch_next));
+	const DiscIO::IVolume& volume = DVDInterface::GetVolume();
+	if (!volume.Read(entry.offset, entry.data.size(), entry.data.data(), entry.decrypt))
+	{
+		// Most likely the end of the disc or partition.
+		s_prefetch_next = s_prefetch_end = 0;
+		return false;
+	}
+
+	s_prefetch_next = entry.End();
+	s_prefetch_cache_size += entry.data.size();
+	s_prefetch_cache.push_back(std::move(entry));
+	while (s_prefetch_cache_size > PREFETCH_CACHE_SIZE)
+	{
+		s_prefetch_cache_size -= s_prefetch_cache.front().data.size();
+		s_prefetch_cache.pop_front();
+	}
+	return true;
+}
+
+// Serves a batch of queued requests. Requests that aren't memory mapped or prefetched are read
+// from the volume, and runs of adjacent ones are merged into a single read. The results are
+// queued in request order, FinishRead still completes every request at its scheduled time.
+static void ProcessRequests(std::vector<ReadRequest>& requests)
+{
+	const DiscIO::IVolume& volume = DVDInterface::GetVolume();
+	std::vector<ReadResult> results(requests.size());
+	std::vector<bool> served(requests.size(), false);
+
+	for (size_t i = 0; i < requests.size(); i++)
+	{
+		const ReadRequest& request = requests[i];
+		ReadResult& result = results[i];
+
+		// Reads to emulated RAM skip the intermediate buffer when the image is memory mapped.
+		if (request.copy_to_ram)
+		{
+			result.mapped_data =
+				volume.GetMappedData(request.dvd_offset, request.length, request.decrypt);
+			if (result.mapped_data)
+			{
+				served[i] = true;
+				continue;
+			}
+		}
+
+		UpdateAccessPattern(request.dvd_offset, request.length, request.decrypt);
+
+		result.buffer.resize(request.length);
+		served[i] = ReadFromPrefetchCache(request.dvd_offset, request.length, request.decrypt,
+			result.buffer.data());
+	}
 
-		ReadRequest request;
-		while (s_request_queue.Pop(request))
+	for (size_t first = 0; first < requests.size();)
+	{
+		if (served[first])
+		{
+			first++;
+			continue;
+		}
+
+		// Find the run of adjacent requests that need a read.
+		size_t last = first + 1;
+		u64 end = requests[first].dvd_offset + requests[first].length;
+		while (last < requests.size() && !served[last] &&
+			requests[last].decrypt == requests[first].decrypt && requests[last].dvd_offset == end &&
+			end + requests[last].length - requests[first].dvd_offset <= MAX_COALESCED_READ_SIZE)
+		{
+			end += requests[last].length;
+			last++;
+		}
+
+		const u64 start = requests[first].dvd_offset;
+		const bool decrypt = requests[first].decrypt;
+		if (last - first == 1)
 		{
-			std::vector<u8> buffer(request.length);
-			const DiscIO::IVolume& volume = DVDInterface::GetVolume();
-			if (!volume.Read(request.dvd_offset, request.length, buffer.data(), request.decrypt))
+			std::vector<u8>& buffer = results[first].buffer;
+			if (!volume.Read(start, buffer.size(), buffer.data(), decrypt))
 				buffer.resize(0);
+		}
+		else
+		{
+			std::vector<u8> buffer(end - start);
+			const bool success = volume.Read(start, buffer.size(), buffer.data(), decrypt);
+			for (size_t i = first; i < last; i++)
+			{
+				std::vector<u8>& out = results[i].buffer;
+				if (success)
+				{
+					std::copy_n(buffer.begin() + (requests[i].dvd_offset - start), out.size(),
+						out.begin());
+				}
+				else
+				{
+					out.resize(0);
+				}
+			}
+		}
 
-			request.realtime_done_us = Common::Timer::GetTimeUs();
+		first = last;
+	}
 
-			s_result_queue.Push(ReadResult(std::move(request), std::move(buffer)));
-			s_result_queue_expanded.Set();
+	for (size_t i = 0; i < requests.size(); i++)
+	{
+		requests[i].realtime_done_us = Common::Timer::GetTimeUs();
+		results[i].request = std::move(requests[i]);
+		s_result_queue.Push(std::move(results[i]));
+	}
+	s_result_queue_expanded.Set();
+}
 
+static void DVDThread()
+{
+	Common::SetCurrentThreadName("DVD thread");
+
+	while (true)
+	{
+		s_request_queue_expanded.Wait();
+
+		while (true)
+		{
 			if (s_dvd_thread_exiting.IsSet())
 				return;
+
+			std::vector<ReadRequest> requests;
+			ReadRequest request;
+			while (s_request_queue.Pop(request))
+				requests.push_back(std::move(request));
+
+			if (!requests.empty())
+				ProcessRequests(requests);
+			// Read ahead while there is nothing else to do.
+			else if (!Prefetch())
+				break;
 		}
 	}
 }
@@ -2,6 +2,8 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <cstring>
 #include <string>
 
 #include "Common/ChunkFile.h"
@@ -507,15 +509,19 @@ bool CEXIETHERNET::RecvHandlePacket()
 	descriptor = (Descriptor*)write_ptr;
 	write_ptr += 4;
 
-	for (u32 i = 0, off = 4; i < mRecvBufferLength; ++i, ++off)
+	for (u32 copied = 0; copied < mRecvBufferLength;)
 	{
-		*write_ptr++ = mRecvBuffer[i];
+		// The ring and its pointers are made of whole pages, so only the end of a page can wrap
+		// around or run into the read pointer
+		const u32 page_left = 0x100 - ((write_ptr - mBbaMem.get()) & 0xff);
+		const u32 chunk = std::min(mRecvBufferLength - copied, page_left);
+		memcpy(write_ptr, &mRecvBuffer[copied], chunk);
+		write_ptr += chunk;
+		copied += chunk;
+		if (chunk != page_left)
+			break;
 
-		if (off == 0xff)
-		{
-			off = 0;
-			inc_rwp();
-		}
+		inc_rwp();
 
 		if (write_ptr == end_ptr)
 			write_ptr = ptr_from_page_ptr(BBA_BP);
@@ -540,7 +546,7 @@ bool CEXIETHERNET::RecvHandlePacket()
 	}
 
 	// Align up to next page
-	if ((mRecvBufferLength + 4) % 256)
+	if ((write_ptr - mBbaMem.get()) & 0xff)
 		inc_rwp();
 
 #ifdef BBA_TRACK_PAGE_PTRS
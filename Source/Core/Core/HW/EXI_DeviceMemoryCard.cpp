@@ -28,6 +28,7 @@
 #include "Core/HW/Sram.h"
 #include "Core/HW/SystemTimers.h"
 #include "Core/Movie.h"
+#include "Core/NetPlayProto.h"
 #include "DiscIO/Enums.h"
 #include "DiscIO/NANDContentLoader.h"
 
@@ -254,6 +255,13 @@ void CEXIMemoryCard::SetupRawMemcard(u16 sizeMb)
 		Movie::IsStartingFromClearSave())
 		filename = File::GetUserPath(D_GCUSER_IDX) +
 		StringFromFormat("Movie%s.raw", (card_index == 0) ? "A" : "B");
+	else if (NetPlay::IsNetPlayRunning() && sizeMb != MemCard251Mb)
+	{
+		// The copy of the host's card made before the game started
+		const std::string synced_path = NetPlay::GetSyncedMemcardPath(card_index);
+		if (!synced_path.empty())
+			filename = synced_path;
+	}
 
 	if (sizeMb == MemCard251Mb)
 	{
@@ -302,7 +302,11 @@ public:
 	std::vector<GCMBlock> m_save_data;
 	std::vector<u16> m_used_blocks;
 	int UsesBlock(u16 blocknum);
+	void MarkBlockDirty(int index);
 	bool m_dirty;
+	// The save blocks written since the last flush. When they line up with the file, the flush writes
+	// only those, else the whole file.
+	std::vector<bool> m_dirty_blocks;
 	std::string m_filename;
 };
 
@@ -23,22 +23,93 @@
 
 const int NO_INDEX = -1;
 static const char* MC_HDR = "MC_SYSTEM_AREA";
+static const char* GCI_INDEX = "MC_GCI_INDEX";
+static const u32 GCI_INDEX_MAGIC = 0x58494347;  // "GCIX"
+static const u32 GCI_INDEX_VERSION = 1;
 
-int GCMemcardDirectory::LoadGCI(const std::string& fileName, DiscIO::Country card_region,
-	bool currentGameOnly)
+void GCMemcardDirectory::LoadGCIIndex()
 {
-	File::IOFile gcifile(fileName, "rb");
-	if (gcifile)
+	File::IOFile file(m_SaveDirectory + GCI_INDEX, "rb");
+	u32 magic = 0, version = 0, count = 0;
+	if (!file || !file.ReadArray(&magic, 1) || !file.ReadArray(&version, 1) ||
+		!file.ReadArray(&count, 1) || magic != GCI_INDEX_MAGIC || version != GCI_INDEX_VERSION)
+	{
+		return;
+	}
+
+	for (u32 i = 0; i < count; i++)
 	{
-		GCIFile gci;
-		gci.m_filename = fileName;
-		gci.m_dirty = false;
-		if (!gcifile.ReadBytes(&(gci.m_gci_header), DENTRY_SIZE))
+		u32 name_length;
+		if (!file.ReadArray(&name_length, 1) || name_length > 0x1000)
+			break;
+		std::string name(name_length, '\0');
+		GCIIndexEntry entry;
+		if (!file.ReadBytes(&name[0], name_length) || !file.ReadArray(&entry.mtime, 1) ||
+			!file.ReadArray(&entry.size, 1) || !file.ReadBytes(&entry.header, DENTRY_SIZE))
 		{
-			ERROR_LOG(EXPANSIONINTERFACE, "%s failed to read header", fileName.c_str());
-			return NO_INDEX;
+			break;
 		}
+		m_gci_index.emplace(std::move(name), entry);
+	}
+}
+
+void GCMemcardDirectory::SaveGCIIndex()
+{
+	File::IOFile file(m_SaveDirectory + GCI_INDEX, "wb");
+	const u32 count = static_cast<u32>(m_new_gci_index.size());
+	file.WriteArray(&GCI_INDEX_MAGIC, 1);
+	file.WriteArray(&GCI_INDEX_VERSION, 1);
+	file.WriteArray(&count, 1);
+	for (const auto& entry : m_new_gci_index)
+	{
+		const u32 name_length = static_cast<u32>(entry.first.size());
+		file.WriteArray(&name_length, 1);
+		file.WriteBytes(entry.first.data(), name_length);
+		file.WriteArray(&entry.second.mtime, 1);
+		file.WriteArray(&entry.second.size, 1);
+		file.WriteBytes(&entry.second.header, DENTRY_SIZE);
+	}
+}
+
+bool GCMemcardDirectory::ReadGCIHeader(const std::string& fileName, DEntry* header,
+	u64* file_size)
+{
+	const std::string name = fileName.substr(fileName.find_last_of("/\\") + 1);
+	const u64 mtime = File::GetModificationTime(fileName);
+	const u64 size = File::GetSize(fileName);
 
+	auto cached = m_gci_index.find(name);
+	if (cached != m_gci_index.end() && cached->second.mtime == mtime && cached->second.size == size)
+	{
+		*header = cached->second.header;
+		*file_size = size;
+		m_new_gci_index.emplace(name, cached->second);
+		return true;
+	}
+
+	File::IOFile gcifile(fileName, "rb");
+	if (!gcifile)
+		return false;
+	if (!gcifile.ReadBytes(header, DENTRY_SIZE))
+	{
+		ERROR_LOG(EXPANSIONINTERFACE, "%s failed to read header", fileName.c_str());
+		return false;
+	}
+	*file_size = gcifile.GetSize();
+	m_new_gci_index[name] = {mtime, *file_size, *header};
+	m_gci_index_changed = true;
+	return true;
+}
+
+int GCMemcardDirectory::LoadGCI(const std::string& fileName, DiscIO::Country card_region,
+	bool currentGameOnly)
+{
+	GCIFile gci;
+	gci.m_filename = fileName;
+	gci.m_dirty = false;
+	u64 file_size;
+	if (ReadGCIHeader(fileName, &gci.m_gci_header, &file_size))
+	{
 		DiscIO::Country gci_region;
 		// check region
 		switch (gci.m_gci_header.Gamecode[3])
@@ -91,7 +162,6 @@ int GCMemcardDirectory::LoadGCI(const std::string& fileName, DiscIO::Country car
 		}
 
 		u32 size = numBlocks * BLOCK_SIZE;
-		u64 file_size = gcifile.GetSize();
 		if (file_size != size + DENTRY_SIZE)
 		{
 			PanicAlertT("%s\nwas not loaded because it is an invalid GCI.\n File size (0x%" PRIx64
@@ -100,11 +170,8 @@ int GCMemcardDirectory::LoadGCI(const std::string& fileName, DiscIO::Country car
 			return NO_INDEX;
 		}
 
-		if (m_GameId == BE32(gci.m_gci_header.Gamecode))
-		{
-			gci.LoadSaveBlocks();
-		}
-		else
+		// The save data is read when the game first touches it
+		if (m_GameId != BE32(gci.m_gci_header.Gamecode))
 		{
 			if (currentGameOnly)
 			{
@@ -147,7 +214,8 @@ int GCMemcardDirectory::LoadGCI(const std::string& fileName, DiscIO::Country car
 
 GCMemcardDirectory::GCMemcardDirectory(const std::string& directory, int slot, u16 sizeMb,
 	bool ascii, DiscIO::Country card_region, int gameId)
-	: MemoryCardBase(slot, sizeMb), m_GameId(gameId), m_LastBlock(-1), m_hdr(slot, sizeMb, ascii),
+	: MemoryCardBase(slot, sizeMb), m_GameId(gameId), m_LastBlock(-1), m_LastSave(-1),
+	m_LastSaveBlock(-1), m_hdr(slot, sizeMb, ascii),
 	m_bat1(sizeMb), m_saves(0), m_SaveDirectory(directory), m_exiting(false)
 {
 	// Use existing header data if available
@@ -159,6 +227,9 @@ GCMemcardDirectory::GCMemcardDirectory(const std::string& directory, int slot, u
 
 	std::vector<std::string> rFilenames = DoFileSearch({ ".gci" }, { m_SaveDirectory });
 
+	// The headers of the files that didn't change since the last boot come from the index
+	LoadGCIIndex();
+
 	if (rFilenames.size() > 112)
 	{
 		Core::DisplayMessage("Warning: There are more than 112 save files on this memory card.\n"
@@ -184,6 +255,11 @@ GCMemcardDirectory::GCMemcardDirectory(const std::string& directory, int slot, u
 	}
 
 	m_loaded_saves.clear();
+	// Every file found that the index didn't know is in m_new_gci_index, the removed ones are not
+	if (m_gci_index_changed || m_new_gci_index.size() != m_gci_index.size())
+		SaveGCIIndex();
+	m_gci_index.clear();
+	m_new_gci_index.clear();
 	m_dir1.fixChecksums();
 	m_dir2 = m_dir1;
 	m_bat2 = m_bat1;
@@ -347,6 +423,8 @@ s32 GCMemcardDirectory::Write(u32 destaddress, s32 length, u8* srcaddress)
 	}
 
 	memcpy(m_LastBlockAddress + offset, srcaddress, length);
+	if (block >= MC_FST_BLOCKS && m_LastSave != -1)
+		m_saves[m_LastSave].MarkBlockDirty(m_LastSaveBlock);
 
 	l.unlock();
 	if (extra)
@@ -481,9 +559,11 @@ inline s32 GCMemcardDirectory::SaveAreaRW(u32 block, bool writing)
 
 				if (writing)
 				{
-					m_saves[i].m_dirty = true;
+					m_saves[i].MarkBlockDirty(idx);
 				}
 
+				m_LastSave = i;
+				m_LastSaveBlock = idx;
 				m_LastBlock = block;
 				m_LastBlockAddress = m_saves[i].m_save_data[idx].block;
 				return m_LastBlock;
@@ -584,26 +664,19 @@ void GCMemcardDirectory::FlushToFile()
 							defaultSaveName.c_str());
 					m_saves[i].m_filename = defaultSaveName;
 				}
-				File::IOFile GCI(m_saves[i].m_filename, "wb");
-				if (GCI)
+				if (FlushSave(m_saves[i]))
 				{
-					GCI.WriteBytes(&m_saves[i].m_gci_header, DENTRY_SIZE);
-					GCI.WriteBytes(m_saves[i].m_save_data.data(), BLOCK_SIZE * m_saves[i].m_save_data.size());
-
-					if (GCI.IsGood())
-					{
-						Core::DisplayMessage(
-							StringFromFormat("Wrote save contents to %s", m_saves[i].m_filename.c_str()), 4000);
-					}
-					else
-					{
-						++errors;
-						Core::DisplayMessage(StringFromFormat("Failed to write save contents to %s",
-							m_saves[i].m_filename.c_str()),
-							4000);
-						ERROR_LOG(EXPANSIONINTERFACE, "Failed to save data to %s",
-							m_saves[i].m_filename.c_str());
-					}
+					Core::DisplayMessage(
+						StringFromFormat("Wrote save contents to %s", m_saves[i].m_filename.c_str()), 4000);
+				}
+				else
+				{
+					++errors;
+					Core::DisplayMessage(StringFromFormat("Failed to write save contents to %s",
+						m_saves[i].m_filename.c_str()),
+						4000);
+					ERROR_LOG(EXPANSIONINTERFACE, "Failed to save data to %s",
+						m_saves[i].m_filename.c_str());
 				}
 			}
 			else if (m_saves[i].m_filename.length() != 0)
@@ -641,11 +714,70 @@ void GCMemcardDirectory::FlushToFile()
 #endif
 }
 
+bool GCMemcardDirectory::FlushSave(GCIFile& save)
+{
+	const u64 file_size = DENTRY_SIZE + BLOCK_SIZE * static_cast<u64>(save.m_save_data.size());
+
+	// When the file holds the blocks that didn't change, only the header and the others are written
+	if (save.m_dirty_blocks.size() == save.m_save_data.size() && File::Exists(save.m_filename) &&
+		File::GetSize(save.m_filename) == file_size)
+	{
+		File::IOFile GCI(save.m_filename, "r+b");
+		if (!GCI)
+			return false;
+
+		GCI.WriteBytes(&save.m_gci_header, DENTRY_SIZE);
+		for (size_t first = 0; first < save.m_dirty_blocks.size();)
+		{
+			if (!save.m_dirty_blocks[first])
+			{
+				first++;
+				continue;
+			}
+
+			size_t end = first + 1;
+			while (end < save.m_dirty_blocks.size() && save.m_dirty_blocks[end])
+				end++;
+			GCI.Seek(DENTRY_SIZE + BLOCK_SIZE * static_cast<s64>(first), SEEK_SET);
+			GCI.WriteBytes(&save.m_save_data[first], BLOCK_SIZE * (end - first));
+			first = end;
+		}
+		if (!GCI.IsGood())
+			return false;
+	}
+	else
+	{
+		File::IOFile GCI(save.m_filename, "wb");
+		if (!GCI)
+			return false;
+
+		GCI.WriteBytes(&save.m_gci_header, DENTRY_SIZE);
+		GCI.WriteBytes(save.m_save_data.data(), BLOCK_SIZE * save.m_save_data.size());
+		if (!GCI.IsGood())
+			return false;
+	}
+
+	save.m_dirty_blocks.assign(save.m_save_data.size(), false);
+	return true;
+}
+
 void GCMemcardDirectory::DoState(PointerWrap& p)
 {
 	std::unique_lock<std::mutex> l(m_write_mutex);
 	m_LastBlock = -1;
 	m_LastBlockAddress = nullptr;
+	m_LastSave = -1;
+
+	// The saves of the running game load lazily, but states hold all of their data
+	if (p.GetMode() != PointerWrap::MODE_READ)
+	{
+		for (GCIFile& save : m_saves)
+		{
+			if (BE32(save.m_gci_header.Gamecode) == m_GameId)
+				save.LoadSaveBlocks();
+		}
+	}
+
 	p.Do(m_SaveDirectory);
 	p.DoPOD<Header>(m_hdr);
 	p.DoPOD<Directory>(m_dir1);
@@ -682,10 +814,20 @@ bool GCIFile::LoadSaveBlocks()
 			m_save_data.clear();
 			return false;
 		}
+		m_dirty_blocks.assign(num_blocks, false);
 	}
 	return true;
 }
 
+void GCIFile::MarkBlockDirty(int index)
+{
+	m_dirty = true;
+	// Without a record of which blocks match the file, all of them are written
+	if (m_dirty_blocks.size() != m_save_data.size())
+		m_dirty_blocks.assign(m_save_data.size(), true);
+	m_dirty_blocks[index] = true;
+}
+
 int GCIFile::UsesBlock(u16 blocknum)
 {
 	for (u16 i = 0; i < m_used_blocks.size(); ++i)
@@ -709,6 +851,10 @@ void GCIFile::DoState(PointerWrap& p)
 		p.DoPOD<GCMBlock>(*itr);
 	}
 	p.Do(m_used_blocks);
+
+	// The loaded data can differ from the file anywhere
+	if (p.GetMode() == PointerWrap::MODE_READ)
+		m_dirty_blocks.assign(m_save_data.size(), true);
 }
 
 void MigrateFromMemcardFile(const std::string& strDirectoryName, int card_index)
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <chrono>
+#include <map>
 #include <mutex>
 #include <string>
 #include <thread>
@@ -35,7 +36,19 @@ public:
 	void DoState(PointerWrap& p) override;
 
 private:
+	// What the index remembers of a GCI file, so boot doesn't have to open every one of them
+	struct GCIIndexEntry
+	{
+		u64 mtime;
+		u64 size;
+		DEntry header;
+	};
+
 	int LoadGCI(const std::string& fileName, DiscIO::Country card_region, bool currentGameOnly);
+	bool ReadGCIHeader(const std::string& fileName, DEntry* header, u64* file_size);
+	void LoadGCIIndex();
+	void SaveGCIIndex();
+	bool FlushSave(GCIFile& save);
 	inline s32 SaveAreaRW(u32 block, bool writing = false);
 	// s32 DirectoryRead(u32 offset, u32 length, u8* destaddress);
 	s32 DirectoryWrite(u32 destaddress, u32 length, u8* srcaddress);
@@ -45,6 +58,9 @@ private:
 	u32 m_GameId;
 	s32 m_LastBlock;
 	u8* m_LastBlockAddress;
+	// The save and its block m_LastBlock is in, when it is in the save area
+	int m_LastSave;
+	int m_LastSaveBlock;
 
 	Header m_hdr;
 	Directory m_dir1, m_dir2;
@@ -52,6 +68,10 @@ private:
 	std::vector<GCIFile> m_saves;
 
 	std::vector<std::string> m_loaded_saves;
+	// By file name, the index read at boot and the one of the files found. Only used while booting.
+	std::map<std::string, GCIIndexEntry> m_gci_index;
+	std::map<std::string, GCIIndexEntry> m_new_gci_index;
+	bool m_gci_index_changed = false;
 	std::string m_SaveDirectory;
 	const std::chrono::seconds flush_interval = std::chrono::seconds(1);
 	Common::Event m_flush_trigger;
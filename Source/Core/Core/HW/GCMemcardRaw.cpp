@@ -2,10 +2,13 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <chrono>
 #include <cstring>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "Common/ChunkFile.h"
 #include "Common/CommonTypes.h"
@@ -52,6 +55,7 @@ MemoryCard::MemoryCard(const std::string& filename, int _card_index, u16 sizeMb)
 	// Class members (including inherited ones) have now been initialized, so
 	// it's safe to startup the flush thread (which reads them).
 	m_flush_buffer = std::make_unique<u8[]>(memory_card_size);
+	m_dirty_blocks.resize((memory_card_size + BLOCK_SIZE - 1) / BLOCK_SIZE);
 	m_flush_thread = std::thread(&MemoryCard::FlushThread, this);
 }
 
@@ -120,11 +124,50 @@ void MemoryCard::FlushThread()
 			return;
 		}
 
+		// Only the changed blocks are written back, in place, merged into runs of adjacent blocks. A
+		// new or truncated file gets all of them.
+		const bool write_all = pFile.GetSize() != memory_card_size;
+		std::vector<std::pair<u32, u32>> runs;
 		{
 			std::unique_lock<std::mutex> l(m_flush_mutex);
-			memcpy(&m_flush_buffer[0], &m_memcard_data[0], memory_card_size);
+			const u32 num_blocks = static_cast<u32>(m_dirty_blocks.size());
+			for (u32 first = 0; first < num_blocks;)
+			{
+				if (!write_all && !m_dirty_blocks[first])
+				{
+					first++;
+					continue;
+				}
+
+				u32 end = first + 1;
+				while (end < num_blocks && (write_all || m_dirty_blocks[end]))
+					end++;
+
+				const u32 offset = first * BLOCK_SIZE;
+				const u32 length = std::min<u32>(end * BLOCK_SIZE, memory_card_size) - offset;
+				memcpy(&m_flush_buffer[offset], &m_memcard_data[offset], length);
+				runs.emplace_back(offset, length);
+				first = end;
+			}
+			std::fill(m_dirty_blocks.begin(), m_dirty_blocks.end(), false);
+		}
+
+		for (const auto& run : runs)
+		{
+			pFile.Seek(run.first, SEEK_SET);
+			pFile.WriteBytes(&m_flush_buffer[run.first], run.second);
+		}
+		if (!runs.empty())
+			pFile.Sync();
+
+		if (!pFile.IsGood())
+		{
+			// Try these blocks again on the next flush
+			std::unique_lock<std::mutex> l(m_flush_mutex);
+			for (const auto& run : runs)
+				MarkDirtyBlocks(run.first, run.second);
+			MakeDirty();
 		}
-		pFile.WriteBytes(&m_flush_buffer[0], memory_card_size);
 
 		if (!do_exit)
 		{
@@ -145,6 +188,18 @@ void MemoryCard::MakeDirty()
 	m_dirty.Set();
 }
 
+void MemoryCard::MarkDirtyBlocks(u32 address, u32 length)
+{
+	if (length == 0 || address >= memory_card_size)
+		return;
+
+	const u32 end = std::min<u32>(address + length, memory_card_size);
+	const size_t first_block = std::min<size_t>(address / BLOCK_SIZE, m_dirty_blocks.size());
+	const size_t end_block =
+		std::min<size_t>((end + BLOCK_SIZE - 1) / BLOCK_SIZE, m_dirty_blocks.size());
+	std::fill(m_dirty_blocks.begin() + first_block, m_dirty_blocks.begin() + end_block, true);
+}
+
 s32 MemoryCard::Read(u32 srcaddress, s32 length, u8* destaddress)
 {
 	if (!IsAddressInBounds(srcaddress))
@@ -168,6 +223,7 @@ s32 MemoryCard::Write(u32 destaddress, s32 length, u8* srcaddress)
 	{
 		std::unique_lock<std::mutex> l(m_flush_mutex);
 		memcpy(&m_memcard_data[destaddress], srcaddress, length);
+		MarkDirtyBlocks(destaddress, length);
 	}
 	MakeDirty();
 	return length;
@@ -184,6 +240,7 @@ void MemoryCard::ClearBlock(u32 address)
 	{
 		std::unique_lock<std::mutex> l(m_flush_mutex);
 		memset(&m_memcard_data[address], 0xFF, BLOCK_SIZE);
+		MarkDirtyBlocks(address, BLOCK_SIZE);
 	}
 	MakeDirty();
 }
@@ -193,6 +250,7 @@ void MemoryCard::ClearAll()
 	{
 		std::unique_lock<std::mutex> l(m_flush_mutex);
 		memset(&m_memcard_data[0], 0xFF, memory_card_size);
+		MarkDirtyBlocks(0, memory_card_size);
 	}
 	MakeDirty();
 }
@@ -202,4 +260,11 @@ void MemoryCard::DoState(PointerWrap& p)
 	p.Do(card_index);
 	p.Do(memory_card_size);
 	p.DoArray(&m_memcard_data[0], memory_card_size);
+
+	// The loaded card can differ anywhere from the file
+	if (p.GetMode() == PointerWrap::MODE_READ)
+	{
+		std::unique_lock<std::mutex> l(m_flush_mutex);
+		MarkDirtyBlocks(0, memory_card_size);
+	}
 }
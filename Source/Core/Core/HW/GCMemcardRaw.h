@@ -8,6 +8,7 @@
 #include <mutex>
 #include <string>
 #include <thread>
+#include <vector>
 #include "Common/Event.h"
 #include "Common/Flag.h"
 #include "Core/HW/GCMemcard.h"
@@ -29,9 +30,14 @@ public:
 	void DoState(PointerWrap& p) override;
 
 private:
+	// Must be called with m_flush_mutex held
+	void MarkDirtyBlocks(u32 address, u32 length);
+
 	std::string m_filename;
 	std::unique_ptr<u8[]> m_memcard_data;
 	std::unique_ptr<u8[]> m_flush_buffer;
+	// The blocks changed since the last flush, which writes only those back to the file
+	std::vector<bool> m_dirty_blocks;
 	std::thread m_flush_thread;
 	std::mutex m_flush_mutex;
 	Common::Event m_flush_trigger;
@@ -2,6 +2,7 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <cstring>
 
 #include "Common/ChunkFile.h"
@@ -56,27 +57,30 @@ void ResetGatherPipe()
 
 static void UpdateGatherPipe()
 {
-	u32 cnt;
-	u8* curMem = Memory::GetPointer(ProcessorInterface::Fifo_CPUWritePointer);
-	for (cnt = 0; m_gatherPipeCount >= GATHER_PIPE_SIZE; cnt += GATHER_PIPE_SIZE)
+	u32 cnt = 0;
+	while (m_gatherPipeCount >= GATHER_PIPE_SIZE)
 	{
-		// copy the GatherPipe
-		memcpy(curMem, m_gatherPipe + cnt, GATHER_PIPE_SIZE);
-		m_gatherPipeCount -= GATHER_PIPE_SIZE;
+		// All full bursts up to the end of the fifo are copied at once, the fifo end is the
+		// address of the last burst.
+		const u32 write_ptr = ProcessorInterface::Fifo_CPUWritePointer;
+		const u32 end = ProcessorInterface::Fifo_CPUEnd;
+		u32 size = m_gatherPipeCount & ~(GATHER_PIPE_SIZE - 1);
+		if (end >= write_ptr)
+			size = std::min(size, end - write_ptr + GATHER_PIPE_SIZE);
+		else
+			size = GATHER_PIPE_SIZE;
+
+		memcpy(Memory::GetPointer(write_ptr), m_gatherPipe + cnt, size);
+		m_gatherPipeCount -= size;
+		cnt += size;
 
 		// increase the CPUWritePointer
-		if (ProcessorInterface::Fifo_CPUWritePointer == ProcessorInterface::Fifo_CPUEnd)
-		{
+		if (write_ptr + size - GATHER_PIPE_SIZE == end)
 			ProcessorInterface::Fifo_CPUWritePointer = ProcessorInterface::Fifo_CPUBase;
-			curMem = Memory::GetPointer(ProcessorInterface::Fifo_CPUWritePointer);
-		}
 		else
-		{
-			curMem += GATHER_PIPE_SIZE;
-			ProcessorInterface::Fifo_CPUWritePointer += GATHER_PIPE_SIZE;
-		}
+			ProcessorInterface::Fifo_CPUWritePointer += size;
 
-		CommandProcessor::GatherPipeBursted();
+		CommandProcessor::GatherPipeBursted(size);
 	}
 
 	// move back the spill bytes
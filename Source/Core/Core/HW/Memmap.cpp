@@ -7,14 +7,18 @@
 // However, if a JITed instruction (for example lwz) wants to access a bad memory area that call
 // may be redirected here (for example to Read_U32()).
 
+#include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <memory>
+#include <mutex>
 
 #include "Common/ChunkFile.h"
 #include "Common/CommonFuncs.h"
 #include "Common/CommonTypes.h"
 #include "Common/Logging/Log.h"
 #include "Common/MemArena.h"
+#include "Common/MemoryUtil.h"
 #include "Core/ConfigManager.h"
 #include "Core/HW/AudioInterface.h"
 #include "Core/HW/DSP.h"
@@ -111,6 +115,7 @@ struct LogicalMemoryView
 {
 	void* mapped_pointer;
 	u32 mapped_size;
+	u32 physical_address;
 };
 
 // Dolphin allocates memory to represent four regions:
@@ -162,6 +167,24 @@ static PhysicalMemoryRegion physical_regions[] = {
 
 static std::vector<LogicalMemoryView> logical_mapped_entries;
 
+// Write watch state. Every watched page of RAM and EXRAM is write protected in all of its
+// views, the first write faults, unprotects the page and stamps it with a new epoch.
+// A range is unchanged as long as none of its pages got a later epoch than the one returned
+// when it was watched.
+enum
+{
+	WATCH_PAGE_SHIFT = 12,
+	WATCH_PAGE_SIZE = 1 << WATCH_PAGE_SHIFT,
+	RAM_WATCH_PAGES = RAM_SIZE >> WATCH_PAGE_SHIFT,
+	WATCH_PAGES = (RAM_SIZE + EXRAM_SIZE) >> WATCH_PAGE_SHIFT,
+};
+static std::atomic<u64> s_watch_epoch;
+// Ranges watched before this epoch may have lost their protection in a remap
+static std::atomic<u64> s_watch_reset_epoch;
+static std::unique_ptr<std::atomic<u64>[]> s_page_write_epoch;
+static std::atomic<bool> s_write_watch_active;
+static std::mutex s_write_watch_lock;
+
 void Init()
 {
 	bool wii = SConfig::GetInstance().bWii;
@@ -222,6 +245,7 @@ void Init()
 
 void UpdateLogicalMemory(const PowerPC::BatTable& dbat_table)
 {
+	std::lock_guard<std::mutex> lk(s_write_watch_lock);
 	for (auto& entry : logical_mapped_entries)
 	{
 		g_arena.ReleaseView(entry.mapped_pointer, entry.mapped_size);
@@ -254,11 +278,14 @@ void UpdateLogicalMemory(const PowerPC::BatTable& dbat_table)
 						PanicAlert("MemoryMap_Setup: Failed finding a memory base.");
 						exit(0);
 					}
-					logical_mapped_entries.push_back({ mapped_pointer, mapped_size });
+					logical_mapped_entries.push_back({ mapped_pointer, mapped_size, intersection_start });
 				}
 			}
 		}
 	}
+	// The new views are not protected, so everything watched so far has to be hashed again
+	if (s_write_watch_active)
+		s_watch_reset_epoch = ++s_watch_epoch;
 }
 
 void DoState(PointerWrap& p)
@@ -278,6 +305,8 @@ void DoState(PointerWrap& p)
 void Shutdown()
 {
 	m_IsInitialized = false;
+	std::lock_guard<std::mutex> lk(s_write_watch_lock);
+	s_write_watch_active = false;
 	u32 flags = 0;
 	if (SConfig::GetInstance().bWii)
 		flags |= PhysicalMemoryRegion::WII_ONLY;
@@ -299,6 +328,9 @@ void Shutdown()
 	physical_base = nullptr;
 	logical_base = nullptr;
 	mmio_mapping.reset();
+	s_page_write_epoch.reset();
+	s_watch_epoch = 0;
+	s_watch_reset_epoch = 0;
 	INFO_LOG(MEMMAP, "Memory system shut down.");
 }
 
@@ -314,6 +346,151 @@ void Clear()
 		memset(m_pEXRAM, 0, EXRAM_SIZE);
 }
 
+static bool GetWatchPages(u32 address, u32 size, u32* first, u32* last)
+{
+	address &= 0x3FFFFFFF;
+	if (size == 0)
+		return false;
+	if (address < RAM_SIZE && size <= RAM_SIZE - address)
+	{
+		*first = address >> WATCH_PAGE_SHIFT;
+		*last = (address + size - 1) >> WATCH_PAGE_SHIFT;
+		return true;
+	}
+	if ((address >> 28) == 0x1 && m_pEXRAM && (address & EXRAM_MASK) + size <= EXRAM_SIZE)
+	{
+		*first = RAM_WATCH_PAGES + ((address & EXRAM_MASK) >> WATCH_PAGE_SHIFT);
+		*last = RAM_WATCH_PAGES + (((address & EXRAM_MASK) + size - 1) >> WATCH_PAGE_SHIFT);
+		return true;
+	}
+	return false;
+}
+
+static u32 GetWatchPagePhysicalAddress(u32 page)
+{
+	if (page < RAM_WATCH_PAGES)
+		return page << WATCH_PAGE_SHIFT;
+	return 0x10000000 | ((page - RAM_WATCH_PAGES) << WATCH_PAGE_SHIFT);
+}
+
+// The pages from first to last are in the same bank, one call protects them all
+static void SetWatchPageProtection(u32 first, u32 last, bool protect)
+{
+	const u32 physical_address = GetWatchPagePhysicalAddress(first);
+	const u32 size = (last - first + 1) << WATCH_PAGE_SHIFT;
+	auto set_protection = [protect](void* ptr, u32 size) {
+		if (protect)
+			Common::WriteProtectMemory(ptr, size, false);
+		else
+			Common::UnWriteProtectMemory(ptr, size, false);
+	};
+	set_protection(physical_base + physical_address, size);
+	for (const LogicalMemoryView& view : logical_mapped_entries)
+	{
+		const u32 start = std::max(physical_address, view.physical_address);
+		const u32 end = std::min(physical_address + size, view.physical_address + view.mapped_size);
+		if (start < end)
+		{
+			set_protection(static_cast<u8*>(view.mapped_pointer) + start - view.physical_address,
+				end - start);
+		}
+	}
+}
+
+u64 WatchRange(u32 address, u32 size)
+{
+	u32 first, last;
+	if (!m_IsInitialized || !SConfig::GetInstance().bFastmem ||
+		!GetWatchPages(address, size, &first, &last))
+		return 0;
+
+	std::lock_guard<std::mutex> lk(s_write_watch_lock);
+	if (!s_page_write_epoch)
+	{
+		s_page_write_epoch.reset(new std::atomic<u64>[WATCH_PAGES]);
+		for (u32 i = 0; i < WATCH_PAGES; i++)
+			s_page_write_epoch[i] = 0;
+	}
+	s_write_watch_active = true;
+
+	// Take the epoch before protecting, a write racing with the protection gets a later one
+	const u64 epoch = ++s_watch_epoch;
+	SetWatchPageProtection(first, last, true);
+	return epoch;
+}
+
+void UnwatchRange(u32 address, u32 size)
+{
+	u32 first, last;
+	if (!s_write_watch_active || !GetWatchPages(address, size, &first, &last))
+		return;
+
+	std::lock_guard<std::mutex> lk(s_write_watch_lock);
+	SetWatchPageProtection(first, last, false);
+	for (u32 page = first; page <= last; page++)
+		s_page_write_epoch[page] = ++s_watch_epoch;
+}
+
+bool IsRangeModified(u32 address, u32 size, u64 epoch)
+{
+	u32 first, last;
+	if (epoch == 0 || epoch <= s_watch_reset_epoch || !GetWatchPages(address, size, &first, &last))
+		return true;
+
+	for (u32 page = first; page <= last; page++)
+	{
+		if (s_page_write_epoch[page] > epoch)
+			return true;
+	}
+	return false;
+}
+
+bool HandleWriteWatchFault(uintptr_t fault_address)
+{
+	// Called from the fault handler, so no locking here
+	if (!s_write_watch_active)
+		return false;
+
+	u32 physical_address;
+	const uintptr_t physical_start = reinterpret_cast<uintptr_t>(physical_base);
+	const uintptr_t logical_start = reinterpret_cast<uintptr_t>(logical_base);
+	if (fault_address >= physical_start && fault_address - physical_start < 0x100000000ULL)
+	{
+		physical_address = static_cast<u32>(fault_address - physical_start);
+	}
+	else if (logical_base && fault_address >= logical_start &&
+		fault_address - logical_start < 0x100000000ULL)
+	{
+		const LogicalMemoryView* mapping = nullptr;
+		for (const LogicalMemoryView& view : logical_mapped_entries)
+		{
+			const uintptr_t view_start = reinterpret_cast<uintptr_t>(view.mapped_pointer);
+			if (fault_address >= view_start && fault_address - view_start < view.mapped_size)
+			{
+				mapping = &view;
+				break;
+			}
+		}
+		if (!mapping)
+			return false;
+		physical_address = mapping->physical_address +
+			static_cast<u32>(fault_address - reinterpret_cast<uintptr_t>(mapping->mapped_pointer));
+	}
+	else
+	{
+		return false;
+	}
+
+	u32 page, last;
+	if (!GetWatchPages(physical_address, 1, &page, &last) || (physical_address >> 30) != 0)
+		return false;
+
+	// Unprotect first, so a page stamped with the new epoch can't be silently written afterwards
+	SetWatchPageProtection(page, page, false);
+	s_page_write_epoch[page] = ++s_watch_epoch;
+	return true;
+}
+
 static inline u8* GetPointerForRange(u32 address, size_t size)
 {
 	// Make sure we don't have a range spanning 2 separate banks
@@ -67,6 +67,18 @@ void UpdateLogicalMemory(const PowerPC::BatTable& dbat_table);
 
 void Clear();
 
+// Write watches, only available with fastmem since they rely on the fault handler.
+// WatchRange write protects the pages of a RAM or EXRAM range and returns an epoch for
+// IsRangeModified, 0 if the range can't be watched. The range counts as modified if any of
+// its pages was written after that, or if the epoch is 0.
+u64 WatchRange(u32 address, u32 size);
+bool IsRangeModified(u32 address, u32 size, u64 epoch);
+// Host code writing guest memory through the kernel (fread and friends) has to unwatch
+// the range first, those writes fail instead of faulting.
+void UnwatchRange(u32 address, u32 size);
+// Returns true if the fault was a write to a watched page, which is writable again afterwards.
+bool HandleWriteWatchFault(uintptr_t fault_address);
+
 // Routines to access physically addressed memory, designed for use by
 // emulated hardware outside the CPU. Use "Device_" prefix.
 std::string GetString(u32 em_address, size_t size = 0);
@@ -554,7 +554,10 @@ void UpdateDevices()
 {
 	// Update inputs at the rate of SI
 	// Typically 120hz but is variable
-	g_controller_interface.UpdateInput();
+	if (SConfig::GetInstance().m_LateInputLatching)
+		g_controller_interface.LatchInput();
+	else
+		g_controller_interface.UpdateInput();
 
 	// Update channels and set the status bit if there's new data
 	g_StatusReg.RDST0 =
@@ -569,6 +572,12 @@ void UpdateDevices()
 	UpdateInterrupts();
 }
 
+void PrepareUpdateDevices()
+{
+	if (SConfig::GetInstance().m_LateInputLatching)
+		g_controller_interface.RequestInputPoll();
+}
+
 SIDevices GetDeviceType(int channel)
 {
 	if (channel < 0 || channel > 3)
@@ -29,6 +29,8 @@ void DoState(PointerWrap& p);
 
 void RegisterMMIO(MMIO::Mapping* mmio, u32 base);
 
+// Called a half-line before UpdateDevices, so late latched input can be polled in the meantime
+void PrepareUpdateDevices();
 void UpdateDevices();
 
 void RemoveDevice(int _iDeviceNumber);
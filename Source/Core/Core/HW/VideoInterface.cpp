@@ -6,12 +6,14 @@
 
 #include "Common/ChunkFile.h"
 #include "Common/CommonTypes.h"
+#include "Common/Hash.h"
 #include "Common/Logging/Log.h"
 #include "Common/MathUtil.h"
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
 #include "Core/CoreTiming.h"
 #include "Core/HW/MMIO.h"
+#include "Core/HW/Memmap.h"
 #include "Core/HW/ProcessorInterface.h"
 #include "Core/HW/SI.h"
 #include "Core/HW/SystemTimers.h"
@@ -67,6 +69,10 @@ static u32 s_odd_field_first_hl;   // index first halfline of the odd field
 static u32 s_even_field_last_hl;   // index last halfline of the even field
 static u32 s_odd_field_last_hl;    // index last halfline of the odd field
 
+// XFB of the last field, for checking movie playback
+static u32 s_last_field_address;
+static u32 s_last_field_size;
+
 void DoState(PointerWrap& p)
 {
 	p.DoPOD(m_VerticalTimingRegister);
@@ -188,6 +194,8 @@ void Preset(bool _bNTSC)
 void Init()
 {
 	Preset(true);
+	s_last_field_address = 0;
+	s_last_field_size = 0;
 }
 
 void RegisterMMIO(MMIO::Mapping* mmio, u32 base)
@@ -446,6 +454,18 @@ u32 GetXFBAddressBottom()
 		return m_XFBInfoBottom.FBB;
 }
 
+u64 GetLastFieldHash()
+{
+	const u8* xfb = Memory::GetPointer(s_last_field_address);
+	if (!xfb || s_last_field_size == 0 ||
+		!Memory::GetPointer(s_last_field_address + s_last_field_size - 1))
+	{
+		return 0;
+	}
+
+	return GetMurmurHash3(xfb, s_last_field_size, 0);
+}
+
 static u32 GetHalfLinesPerEvenField()
 {
 	return (3 * m_VerticalTimingRegister.EQU + m_VBlankTimingEven.PRB +
@@ -706,12 +726,15 @@ static void BeginField(FieldType field, u64 ticks)
 	// frame is scanning out.
 	// To correctly handle that case we would need to collate all changes
 	// to VI during scanout and delay outputting the frame till then.
+	s_last_field_address = xfbAddr;
+	s_last_field_size = 2 * fbStride * fbHeight;
 	if (xfbAddr)
 		g_video_backend->Video_BeginField(xfbAddr, fbWidth, fbStride, fbHeight, ticks);
 }
 
 static void EndField()
 {
+	CoreTiming::UpdateAutoClock();
 	Core::VideoThrottle();
 }
 
@@ -724,6 +747,10 @@ void Update(u64 ticks)
 		SerialInterface::UpdateDevices();
 		s_half_line_of_next_si_poll += SerialInterface::GetPollXLines();
 	}
+	else if (s_half_line_of_next_si_poll == s_half_line_count + 1)
+	{
+		SerialInterface::PrepareUpdateDevices();
+	}
 	if (s_half_line_count == s_even_field_first_hl)
 	{
 		BeginField(FIELD_EVEN, ticks);
@@ -335,6 +335,8 @@ void RegisterMMIO(MMIO::Mapping* mmio, u32 base);
 // returns a pointer to the current visible xfb
 u32 GetXFBAddressTop();
 u32 GetXFBAddressBottom();
+// Hash of the XFB in memory that the last field was scanned out from, 0 before the first field
+u64 GetLastFieldHash();
 
 // Update and draw framebuffer
 void Update(u64 ticks);
@@ -5,6 +5,7 @@
 #include <bluetooth/bluetooth.h>
 #include <bluetooth/hci.h>
 #include <bluetooth/hci_lib.h>
+#include <algorithm>
 #include <bluetooth/l2cap.h>
 #include <unistd.h>
 
@@ -199,7 +200,7 @@ int WiimoteLinux::IORead(u8* buf)
   FD_SET(m_int_sock, &fds);
   FD_SET(m_wakeup_pipe_r, &fds);
 
-  if (select(m_int_sock + 1, &fds, nullptr, nullptr, nullptr) == -1)
+  if (select(std::max(m_int_sock, m_wakeup_pipe_r) + 1, &fds, nullptr, nullptr, nullptr) == -1)
   {
     ERROR_LOG(WIIMOTE, "Unable to select Wiimote %i input socket.", m_index + 1);
     return -1;
@@ -207,8 +208,9 @@ int WiimoteLinux::IORead(u8* buf)
 
   if (FD_ISSET(m_wakeup_pipe_r, &fds))
   {
-    char c;
-    if (read(m_wakeup_pipe_r, &c, 1) != 1)
+    // Take all the wakeups at once, the thread handles everything they were for next
+    char c[64];
+    if (read(m_wakeup_pipe_r, c, sizeof(c)) < 1)
     {
       ERROR_LOG(WIIMOTE, "Unable to read from wakeup pipe.");
     }
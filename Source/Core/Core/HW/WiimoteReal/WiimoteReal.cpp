@@ -76,7 +76,10 @@ void Wiimote::WriteReport(Report rpt)
 	}
 
 	m_write_reports.Push(std::move(rpt));
-	IOWakeup();
+	// The thread writes everything queued when it wakes up, so one wakeup covers a burst of reports
+	// like the speaker stream
+	if (!m_write_wakeup_pending.exchange(true))
+		IOWakeup();
 }
 
 // to be called from CPU thread
@@ -224,28 +227,32 @@ void Wiimote::Read()
 	}
 }
 
+// Writes all the queued reports
 bool Wiimote::Write()
 {
-	// nothing written, but this is not an error
-	if (m_write_reports.Empty())
-		return true;
-
-	Report const& rpt = m_write_reports.Front();
+	// Reports queued from now on need a new wakeup
+	m_write_wakeup_pending.store(false);
 
-	if (SConfig::GetInstance().iBBDumpPort > 0 && m_index == WIIMOTE_BALANCE_BOARD)
+	while (!m_write_reports.Empty())
 	{
-		static sf::UdpSocket Socket;
-		Socket.send((char*)rpt.data(), rpt.size(), sf::IpAddress::LocalHost,
-			SConfig::GetInstance().iBBDumpPort);
-	}
-	int ret = IOWrite(rpt.data(), rpt.size());
+		Report const& rpt = m_write_reports.Front();
+
+		if (SConfig::GetInstance().iBBDumpPort > 0 && m_index == WIIMOTE_BALANCE_BOARD)
+		{
+			static sf::UdpSocket Socket;
+			Socket.send((char*)rpt.data(), rpt.size(), sf::IpAddress::LocalHost,
+				SConfig::GetInstance().iBBDumpPort);
+		}
+		int ret = IOWrite(rpt.data(), rpt.size());
 
-	m_write_reports.Pop();
+		m_write_reports.Pop();
 
-	if (!m_write_reports.Empty())
-		IOWakeup();
+		if (ret == 0)
+			return false;
+	}
 
-	return ret != 0;
+	// nothing written is not an error
+	return true;
 }
 
 bool Wiimote::IsBalanceBoard()
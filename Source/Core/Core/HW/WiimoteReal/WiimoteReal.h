@@ -111,6 +111,8 @@ private:
 
 	Common::FifoQueue<Report> m_read_reports;
 	Common::FifoQueue<Report> m_write_reports;
+	// Set from queueing a report until the thread starts writing them, to wake it up only once
+	std::atomic<bool> m_write_wakeup_pending{false};
 };
 
 class WiimoteScannerBackend
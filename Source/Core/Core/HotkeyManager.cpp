@@ -125,11 +125,14 @@ const std::string hotkey_labels[] = {
 		_trans("Save Oldest State"),
 		_trans("Undo Load State"),
 		_trans("Undo Save State"),
+		_trans("Rewind"),
 		_trans("Save State"),
 		_trans("Load State"),
 		_trans("Reload Post-Processing Shaders"),
 		_trans("Switch Hires Textures"),
 		_trans("Switch Material Textures"),
+		_trans("Export Frame Telemetry"),
+		_trans("Export Trace"),
 };
 static_assert(NUM_HOTKEYS == sizeof(hotkey_labels) / sizeof(hotkey_labels[0]),
 	"Wrong count of hotkey_labels");
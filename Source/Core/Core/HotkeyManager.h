@@ -125,12 +125,15 @@ enum Hotkey
 	HK_SAVE_FIRST_STATE,
 	HK_UNDO_LOAD_STATE,
 	HK_UNDO_SAVE_STATE,
+	HK_REWIND,
 	HK_SAVE_STATE_FILE,
 	HK_LOAD_STATE_FILE,
 
 	HK_RELOAD_POSTPROCESS_SHADERS,
 	HK_TOGGLE_HIRES_TEXTURES,
 	HK_TOGGLE_MATERIAL_TEXTURES,
+	HK_EXPORT_FRAME_TELEMETRY,
+	HK_EXPORT_TRACE,
 	NUM_HOTKEYS,
 };
 
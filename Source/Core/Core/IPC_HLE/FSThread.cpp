@@ -0,0 +1,198 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <utility>
+
+#include "Common/Assert.h"
+#include "Common/ChunkFile.h"
+#include "Common/CommonTypes.h"
+#include "Common/Event.h"
+#include "Common/FifoQueue.h"
+#include "Common/Flag.h"
+#include "Common/Thread.h"
+
+#include "Core/Core.h"
+#include "Core/HW/Memmap.h"
+#include "Core/IPC_HLE/FSThread.h"
+
+namespace FSThread
+{
+struct Request
+{
+	u32 command_address;
+	u32 output_address;
+	Operation operation;
+};
+
+struct Result
+{
+	u32 return_value;
+	u32 output_address;
+	std::vector<u8> data;
+};
+
+static std::thread s_fs_thread;
+static Common::Event s_request_queue_expanded;   // Is set by CPU thread
+static Common::Flag s_fs_thread_exiting(false);  // Is set by CPU thread
+static Common::FifoQueue<Request, false> s_request_queue;
+
+// Guards the results and the count of operations that haven't produced one yet
+static std::mutex s_result_lock;
+static std::condition_variable s_result_ready;
+static std::map<u32, Result> s_results;
+static u32 s_queued = 0;
+
+// Commands whose reply hasn't been queued yet. Only used by the CPU thread.
+static std::set<u32> s_pending;
+
+static void FSThreadFunc()
+{
+	Common::SetCurrentThreadName("FS thread");
+
+	while (true)
+	{
+		s_request_queue_expanded.Wait();
+
+		Request request;
+		while (s_request_queue.Pop(request))
+		{
+			Result result;
+			result.output_address = request.output_address;
+			result.return_value = request.operation(result.data);
+
+			std::lock_guard<std::mutex> lk(s_result_lock);
+			s_results[request.command_address] = std::move(result);
+			s_queued--;
+			s_result_ready.notify_all();
+		}
+
+		if (s_fs_thread_exiting.IsSet())
+			return;
+	}
+}
+
+void Start()
+{
+	_assert_(!s_fs_thread.joinable());
+	s_request_queue_expanded.Reset();
+	s_request_queue.Clear();
+	s_results.clear();
+	s_queued = 0;
+	s_pending.clear();
+
+	s_fs_thread_exiting.Clear();
+	s_fs_thread = std::thread(FSThreadFunc);
+}
+
+void Stop()
+{
+	_assert_(s_fs_thread.joinable());
+
+	// The thread finishes the queued operations first, the writes among them have to happen
+	s_fs_thread_exiting.Set();
+	s_request_queue_expanded.Set();
+	s_fs_thread.join();
+
+	s_results.clear();
+	s_pending.clear();
+}
+
+void Reset()
+{
+	WaitUntilIdle();
+	s_results.clear();
+	s_pending.clear();
+}
+
+void WaitUntilIdle()
+{
+	std::unique_lock<std::mutex> lk(s_result_lock);
+	s_result_ready.wait(lk, [] { return s_queued == 0; });
+}
+
+void DoState(PointerWrap& p)
+{
+	// Every operation is done once the thread is idle, what is left is the results that wait for
+	// their reply
+	WaitUntilIdle();
+
+	u32 count = static_cast<u32>(s_results.size());
+	p.Do(count);
+	if (p.GetMode() == PointerWrap::MODE_READ)
+	{
+		s_results.clear();
+		s_pending.clear();
+		for (u32 i = 0; i < count; i++)
+		{
+			u32 command_address = 0;
+			Result result;
+			p.Do(command_address);
+			p.Do(result.return_value);
+			p.Do(result.output_address);
+			p.Do(result.data);
+			s_results.emplace(command_address, std::move(result));
+			s_pending.insert(command_address);
+		}
+	}
+	else
+	{
+		for (auto& entry : s_results)
+		{
+			u32 command_address = entry.first;
+			p.Do(command_address);
+			p.Do(entry.second.return_value);
+			p.Do(entry.second.output_address);
+			p.Do(entry.second.data);
+		}
+	}
+}
+
+void StartOperation(u32 command_address, u32 output_address, Operation operation)
+{
+	_assert_(Core::IsCPUThread());
+
+	{
+		std::lock_guard<std::mutex> lk(s_result_lock);
+		s_queued++;
+	}
+	s_pending.insert(command_address);
+
+	Request request;
+	request.command_address = command_address;
+	request.output_address = output_address;
+	request.operation = std::move(operation);
+	s_request_queue.Push(std::move(request));
+	s_request_queue_expanded.Set();
+}
+
+void FinishCommand(u32 command_address)
+{
+	auto pending = s_pending.find(command_address);
+	if (pending == s_pending.end())
+		return;
+	s_pending.erase(pending);
+
+	Result result;
+	{
+		std::unique_lock<std::mutex> lk(s_result_lock);
+		s_result_ready.wait(lk, [&] { return s_results.count(command_address) != 0; });
+		auto it = s_results.find(command_address);
+		result = std::move(it->second);
+		s_results.erase(it);
+	}
+
+	if (!result.data.empty())
+	{
+		const u32 size = static_cast<u32>(result.data.size());
+		Memory::UnwatchRange(result.output_address, size);
+		Memory::CopyToEmu(result.output_address, result.data.data(), size);
+	}
+	Memory::Write_U32(result.return_value, command_address + 4);
+}
+}
@@ -0,0 +1,40 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+
+class PointerWrap;
+
+// Runs the host file I/O of IOS FS reads and writes, so that slow disks don't stall the CPU
+// thread. The commands still reply at the emulated time they would have replied at, their
+// results only become visible to the emulated software when the reply is queued.
+namespace FSThread
+{
+void Start();
+void Stop();
+void DoState(PointerWrap& p);
+
+// Drops the results of commands that won't get a reply anymore
+void Reset();
+
+// Blocks until every queued operation ran. Anything that touches the NAND or the state of a file
+// directly calls this first, so that it sees the effects of the earlier commands.
+void WaitUntilIdle();
+
+// Returns the value that is written to the command, with the data that was read in output
+using Operation = std::function<u32(std::vector<u8>& output)>;
+
+// Runs operation on the I/O thread, in order with the other operations. When the reply to
+// command_address is queued, its return value is written and the data copied to output_address.
+void StartOperation(u32 command_address, u32 output_address, Operation operation);
+
+// Called on the CPU thread when the reply to command_address is queued. Waits for its operation
+// if it hasn't finished yet.
+void FinishCommand(u32 command_address);
+}
@@ -40,6 +40,7 @@ They will also generate a true or false return for UpdateInterrupts() in WII_IPC
 #include "Core/HW/Memmap.h"
 #include "Core/HW/SystemTimers.h"
 #include "Core/HW/WII_IPC.h"
+#include "Core/IPC_HLE/FSThread.h"
 
 #include "Core/IPC_HLE/WII_IPC_HLE.h"
 #include "Core/IPC_HLE/WII_IPC_HLE_Device.h"
@@ -98,6 +99,7 @@ static void EnqueueEvent(u64 userdata, s64 cycles_late = 0)
 	}
 	else
 	{
+		FSThread::FinishCommand(static_cast<u32>(userdata));
 		s_reply_queue.push_back(static_cast<u32>(userdata));
 	}
 	Update();
@@ -168,6 +170,7 @@ void Reinit()
 void Init()
 {
 	Reinit();
+	FSThread::Start();
 
 	s_event_enqueue = CoreTiming::RegisterEvent("IPCEvent", EnqueueEvent);
 	s_event_sdio_notify = CoreTiming::RegisterEvent("SDIO_EventNotify", SDIO_EventNotify_CPUThread);
@@ -210,6 +213,7 @@ void Reset(bool hard)
 
 	s_request_queue.clear();
 	s_reply_queue.clear();
+	FSThread::Reset();
 
 	s_last_reply_time = 0;
 }
@@ -217,6 +221,7 @@ void Reset(bool hard)
 void Shutdown()
 {
 	Reset(true);
+	FSThread::Stop();
 }
 
 void SetDefaultContentFile(const std::string& file_name)
@@ -295,6 +300,7 @@ void DoState(PointerWrap& p)
 	p.Do(s_request_queue);
 	p.Do(s_reply_queue);
 	p.Do(s_last_reply_time);
+	FSThread::DoState(p);
 
 	// We need to make sure all file handles are closed so WII_IPC_Devices_fs::DoState can
 	// successfully save or re-create /tmp
@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <vector>
 
 #include "Common/ChunkFile.h"
 #include "Common/CommonPaths.h"
@@ -12,6 +13,8 @@
 #include "Common/StringUtil.h"
 
 #include "Core/Core.h"
+#include "Core/HW/Memmap.h"
+#include "Core/IPC_HLE/FSThread.h"
 #include "Core/IPC_HLE/WII_IPC_HLE.h"
 #include "Core/IPC_HLE/WII_IPC_HLE_Device_FileIO.h"
 #include "Core/IPC_HLE/WII_IPC_HLE_Device_fs.h"
@@ -88,6 +91,7 @@ CWII_IPC_HLE_Device_FileIO::~CWII_IPC_HLE_Device_FileIO()
 IPCCommandResult CWII_IPC_HLE_Device_FileIO::Close(u32 _CommandAddress, bool _bForce)
 {
 	INFO_LOG(WII_IPC_FILEIO, "FileIO: Close %s (DeviceID=%08x)", m_Name.c_str(), m_DeviceID);
+	FSThread::WaitUntilIdle();
 	m_Mode = 0;
 
 	// Let go of our pointer to the file, it will automatically close if we are the last handle
@@ -108,6 +112,7 @@ IPCCommandResult CWII_IPC_HLE_Device_FileIO::Open(u32 _CommandAddress, u32 _Mode
 
 	static const char* const Modes[] = { "Unk Mode", "Read only", "Write only", "Read and Write" };
 
+	FSThread::WaitUntilIdle();
 	m_filepath = HLE_IPC_BuildFilename(m_Name);
 
 	// The file must exist before we can open it
@@ -181,6 +186,9 @@ IPCCommandResult CWII_IPC_HLE_Device_FileIO::Seek(u32 _CommandAddress)
 	const s32 SeekPosition = Memory::Read_U32(_CommandAddress + 0xC);
 	const s32 Mode = Memory::Read_U32(_CommandAddress + 0x10);
 
+	// The file size and the position have to include the reads and writes before
+	FSThread::WaitUntilIdle();
+
 	if (m_file->IsOpen())
 	{
 		ReturnValue = FS_RESULT_FATAL;
@@ -240,9 +248,10 @@ IPCCommandResult CWII_IPC_HLE_Device_FileIO::Seek(u32 _CommandAddress)
 	return GetDefaultReply();
 }
 
+// Reads and writes run on the FS thread, they are the only commands that touch m_SeekPos until
+// WaitUntilIdle. Their return value is written when the reply is queued.
 IPCCommandResult CWII_IPC_HLE_Device_FileIO::Read(u32 _CommandAddress)
 {
-	u32 ReturnValue = FS_EACCESS;
 	const u32 Address = Memory::Read_U32(_CommandAddress + 0xC);  // Read to this memory address
 	const u32 Size = Memory::Read_U32(_CommandAddress + 0x10);
 
@@ -253,21 +262,24 @@ IPCCommandResult CWII_IPC_HLE_Device_FileIO::Read(u32 _CommandAddress)
 			WARN_LOG(WII_IPC_FILEIO,
 				"FileIO: Attempted to read 0x%x bytes to 0x%08x on a write-only file %s", Size,
 				Address, m_Name.c_str());
+			Memory::Write_U32(FS_EACCESS, _CommandAddress + 0x4);
 		}
 		else
 		{
 			DEBUG_LOG(WII_IPC_FILEIO, "FileIO: Read 0x%x bytes to 0x%08x from %s", Size, Address,
 				m_Name.c_str());
-			m_file->Seek(m_SeekPos, SEEK_SET);  // File might be opened twice, need to seek before we read
-			ReturnValue = (u32)fread(Memory::GetPointer(Address), 1, Size, m_file->GetHandle());
-			if (ReturnValue != Size && ferror(m_file->GetHandle()))
-			{
-				ReturnValue = FS_EACCESS;
-			}
-			else
-			{
+			std::shared_ptr<File::IOFile> file = m_file;
+			FSThread::StartOperation(_CommandAddress, Address,
+				[this, file, Size](std::vector<u8>& output) -> u32 {
+				output.resize(Size);
+				file->Seek(m_SeekPos, SEEK_SET);  // File might be opened twice, need to seek before we read
+				const u32 read = (u32)fread(output.data(), 1, Size, file->GetHandle());
+				output.resize(read);
+				if (read != Size && ferror(file->GetHandle()))
+					return FS_EACCESS;
 				m_SeekPos += Size;
-			}
+				return read;
+			});
 		}
 	}
 	else
@@ -275,16 +287,14 @@ IPCCommandResult CWII_IPC_HLE_Device_FileIO::Read(u32 _CommandAddress)
 		ERROR_LOG(WII_IPC_FILEIO, "FileIO: Failed to read from %s (Addr=0x%08x Size=0x%x) - file could "
 			"not be opened or does not exist",
 			m_Name.c_str(), Address, Size);
-		ReturnValue = FS_FILE_NOT_EXIST;
+		Memory::Write_U32(FS_FILE_NOT_EXIST, _CommandAddress + 0x4);
 	}
 
-	Memory::Write_U32(ReturnValue, _CommandAddress + 0x4);
 	return GetDefaultReply();
 }
 
 IPCCommandResult CWII_IPC_HLE_Device_FileIO::Write(u32 _CommandAddress)
 {
-	u32 ReturnValue = FS_EACCESS;
 	const u32 Address =
 		Memory::Read_U32(_CommandAddress + 0xC);  // Write data from this memory address
 	const u32 Size = Memory::Read_U32(_CommandAddress + 0x10);
@@ -296,18 +306,24 @@ IPCCommandResult CWII_IPC_HLE_Device_FileIO::Write(u32 _CommandAddress)
 			WARN_LOG(WII_IPC_FILEIO,
 				"FileIO: Attempted to write 0x%x bytes from 0x%08x to a read-only file %s", Size,
 				Address, m_Name.c_str());
+			Memory::Write_U32(FS_EACCESS, _CommandAddress + 0x4);
 		}
 		else
 		{
 			DEBUG_LOG(WII_IPC_FILEIO, "FileIO: Write 0x%04x bytes from 0x%08x to %s", Size, Address,
 				m_Name.c_str());
-			m_file->Seek(m_SeekPos,
-				SEEK_SET);  // File might be opened twice, need to seek before we write
-			if (m_file->WriteBytes(Memory::GetPointer(Address), Size))
-			{
-				ReturnValue = Size;
-				m_SeekPos += Size;
-			}
+			// The data is taken now, the emulated software may reuse the buffer once it has the reply
+			std::vector<u8> data(Size);
+			Memory::CopyFromEmu(data.data(), Address, Size);
+			std::shared_ptr<File::IOFile> file = m_file;
+			FSThread::StartOperation(_CommandAddress, 0,
+				[this, file, data = std::move(data)](std::vector<u8>&) -> u32 {
+				file->Seek(m_SeekPos, SEEK_SET);  // File might be opened twice, need to seek before we write
+				if (!file->WriteBytes(data.data(), data.size()))
+					return FS_EACCESS;
+				m_SeekPos += (u32)data.size();
+				return (u32)data.size();
+			});
 		}
 	}
 	else
@@ -315,10 +331,9 @@ IPCCommandResult CWII_IPC_HLE_Device_FileIO::Write(u32 _CommandAddress)
 		ERROR_LOG(WII_IPC_FILEIO, "FileIO: Failed to read from %s (Addr=0x%08x Size=0x%x) - file could "
 			"not be opened or does not exist",
 			m_Name.c_str(), Address, Size);
-		ReturnValue = FS_FILE_NOT_EXIST;
+		Memory::Write_U32(FS_FILE_NOT_EXIST, _CommandAddress + 0x4);
 	}
 
-	Memory::Write_U32(ReturnValue, _CommandAddress + 0x4);
 	return GetDefaultReply();
 }
 
@@ -331,6 +346,8 @@ IPCCommandResult CWII_IPC_HLE_Device_FileIO::IOCtl(u32 _CommandAddress)
 	const u32 Parameter = Memory::Read_U32(_CommandAddress + 0xC);
 	u32 ReturnValue = 0;
 
+	FSThread::WaitUntilIdle();
+
 	switch (Parameter)
 	{
 	case ISFS_IOCTL_GETFILESTATS:
@@ -369,6 +386,7 @@ void CWII_IPC_HLE_Device_FileIO::PrepareForState(PointerWrap::Mode mode)
 {
 	// Temporally close the file, to prevent any issues with the savestating of /tmp
 	// it can be opened again with another call to OpenFile()
+	FSThread::WaitUntilIdle();
 	m_file.reset();
 }
 
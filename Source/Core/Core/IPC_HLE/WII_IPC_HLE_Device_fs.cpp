@@ -13,6 +13,7 @@
 #include "Common/StringUtil.h"
 
 #include "Core/HW/SystemTimers.h"
+#include "Core/IPC_HLE/FSThread.h"
 #include "Core/IPC_HLE/WII_IPC_HLE_Device_FileIO.h"
 #include "Core/IPC_HLE/WII_IPC_HLE_Device_fs.h"
 
@@ -71,6 +72,9 @@ IPCCommandResult CWII_IPC_HLE_Device_fs::IOCtlV(u32 _CommandAddress)
 	u32 ReturnValue = FS_RESULT_OK;
 	SIOCtlVBuffer CommandBuffer(_CommandAddress);
 
+	// The files have to be written before they can be listed, moved or deleted
+	FSThread::WaitUntilIdle();
+
 	// Prepare the out buffer(s) with zeros as a safety precaution
 	// to avoid returning bad values
 	for (u32 i = 0; i < CommandBuffer.NumberPayloadBuffer; i++)
@@ -233,6 +237,8 @@ IPCCommandResult CWII_IPC_HLE_Device_fs::IOCtl(u32 _CommandAddress)
 	u32 BufferOut = Memory::Read_U32(_CommandAddress + 0x18);
 	u32 BufferOutSize = Memory::Read_U32(_CommandAddress + 0x1C);
 
+	FSThread::WaitUntilIdle();
+
 	/* Prepare the out buffer(s) with zeroes as a safety precaution
 		 to avoid returning bad values. */
 		 // LOG(WII_IPC_FILEIO, "Cleared %u bytes of the out buffer", _BufferOutSize);
@@ -513,6 +519,7 @@ s32 CWII_IPC_HLE_Device_fs::ExecuteCommand(u32 _Parameter, u32 _BufferIn, u32 _B
 
 void CWII_IPC_HLE_Device_fs::DoState(PointerWrap& p)
 {
+	FSThread::WaitUntilIdle();
 	DoStateShared(p);
 
 	// handle /tmp
@@ -3,9 +3,11 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <map>
 
 #include "Common/FileUtil.h"
 #include "Common/NandPaths.h"
+#include "Common/Thread.h"
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
 #include "Core/IPC_HLE/WII_IPC_HLE_Device_net_ssl.h"
@@ -13,6 +15,11 @@
 
 WII_SSL CWII_IPC_HLE_Device_net_ssl::_SSL[NET_SSL_MAXINSTANCES];
 
+// The sessions of the last handshakes by host name. Games connect to the same few servers over
+// and over, resuming skips the key exchange and the certificate chain of a full handshake.
+static std::map<std::string, mbedtls_ssl_session> s_sessions;
+static constexpr size_t MAX_SESSIONS = 32;
+
 static constexpr mbedtls_x509_crt_profile mbedtls_x509_crt_profile_wii = {
 	/* Hashes from SHA-1 and above */
 	MBEDTLS_X509_ID_FLAG(MBEDTLS_MD_SHA1) | MBEDTLS_X509_ID_FLAG(MBEDTLS_MD_RIPEMD160) |
@@ -30,6 +37,8 @@ CWII_IPC_HLE_Device_net_ssl::CWII_IPC_HLE_Device_net_ssl(u32 _DeviceID,
 	for (WII_SSL& ssl : _SSL)
 	{
 		ssl.active = false;
+		ssl.handshake_started = false;
+		ssl.handshake_running = false;
 	}
 }
 
@@ -39,25 +48,76 @@ CWII_IPC_HLE_Device_net_ssl::~CWII_IPC_HLE_Device_net_ssl()
 	for (WII_SSL& ssl : _SSL)
 	{
 		if (ssl.active)
-		{
-			mbedtls_ssl_close_notify(&ssl.ctx);
+			FreeSSL(ssl);
+	}
+
+	for (auto& session : s_sessions)
+		mbedtls_ssl_session_free(&session.second);
+	s_sessions.clear();
+}
+
+void CWII_IPC_HLE_Device_net_ssl::FreeSSL(WII_SSL& ssl)
+{
+	WaitForHandshake(ssl);
+	ssl.handshake_started = false;
+
+	mbedtls_ssl_close_notify(&ssl.ctx);
 
-			mbedtls_x509_crt_free(&ssl.cacert);
-			mbedtls_x509_crt_free(&ssl.clicert);
+	mbedtls_x509_crt_free(&ssl.cacert);
+	mbedtls_x509_crt_free(&ssl.clicert);
 
-			mbedtls_ssl_session_free(&ssl.session);
-			mbedtls_ssl_free(&ssl.ctx);
-			mbedtls_ssl_config_free(&ssl.config);
-			mbedtls_ctr_drbg_free(&ssl.ctr_drbg);
-			mbedtls_entropy_free(&ssl.entropy);
+	mbedtls_ssl_session_free(&ssl.session);
+	mbedtls_ssl_free(&ssl.ctx);
+	mbedtls_ssl_config_free(&ssl.config);
+	mbedtls_ctr_drbg_free(&ssl.ctr_drbg);
+	mbedtls_entropy_free(&ssl.entropy);
 
-			ssl.hostname.clear();
+	ssl.hostname.clear();
 
-			ssl.active = false;
+	ssl.active = false;
+}
+
+void CWII_IPC_HLE_Device_net_ssl::WaitForHandshake(const WII_SSL& ssl)
+{
+	while (ssl.handshake_running.load(std::memory_order_acquire))
+		Common::YieldCPU();
+}
+
+void CWII_IPC_HLE_Device_net_ssl::SaveSession(const WII_SSL& ssl)
+{
+	if (ssl.hostname.empty())
+		return;
+
+	auto it = s_sessions.find(ssl.hostname);
+	if (it == s_sessions.end())
+	{
+		if (s_sessions.size() >= MAX_SESSIONS)
+		{
+			mbedtls_ssl_session_free(&s_sessions.begin()->second);
+			s_sessions.erase(s_sessions.begin());
 		}
+		it = s_sessions.emplace(ssl.hostname, mbedtls_ssl_session()).first;
+		mbedtls_ssl_session_init(&it->second);
+	}
+
+	if (mbedtls_ssl_get_session(&ssl.ctx, &it->second))
+	{
+		mbedtls_ssl_session_free(&it->second);
+		s_sessions.erase(it);
 	}
 }
 
+void CWII_IPC_HLE_Device_net_ssl::ResumeSession(WII_SSL& ssl)
+{
+	auto it = s_sessions.find(ssl.hostname);
+	if (it == s_sessions.end())
+		return;
+
+	// The server decides whether to resume, a full handshake follows if it doesn't
+	if (mbedtls_ssl_set_session(&ssl.ctx, &it->second) == 0)
+		INFO_LOG(WII_IPC_SSL, "Resuming the TLS session with %s", ssl.hostname.c_str());
+}
+
 int CWII_IPC_HLE_Device_net_ssl::GetSSLFreeID() const
 {
 	for (int i = 0; i < NET_SSL_MAXINSTANCES; i++)
@@ -188,6 +248,9 @@ IPCCommandResult CWII_IPC_HLE_Device_net_ssl::IOCtlV(u32 _CommandAddress)
 				MBEDTLS_SSL_MINOR_VERSION_2);
 			mbedtls_ssl_conf_cert_profile(&ssl->config, &mbedtls_x509_crt_profile_wii);
 			mbedtls_ssl_set_session(&ssl->ctx, &ssl->session);
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+			mbedtls_ssl_conf_session_tickets(&ssl->config, MBEDTLS_SSL_SESSION_TICKETS_ENABLED);
+#endif
 
 			if (SConfig::GetInstance().m_SSLVerifyCert && verifyOption)
 				mbedtls_ssl_conf_authmode(&ssl->config, MBEDTLS_SSL_VERIFY_REQUIRED);
@@ -221,22 +284,7 @@ IPCCommandResult CWII_IPC_HLE_Device_net_ssl::IOCtlV(u32 _CommandAddress)
 		int sslID = Memory::Read_U32(BufferOut) - 1;
 		if (SSLID_VALID(sslID))
 		{
-			WII_SSL* ssl = &_SSL[sslID];
-
-			mbedtls_ssl_close_notify(&ssl->ctx);
-
-			mbedtls_x509_crt_free(&ssl->cacert);
-			mbedtls_x509_crt_free(&ssl->clicert);
-
-			mbedtls_ssl_session_free(&ssl->session);
-			mbedtls_ssl_free(&ssl->ctx);
-			mbedtls_ssl_config_free(&ssl->config);
-			mbedtls_ctr_drbg_free(&ssl->ctr_drbg);
-			mbedtls_entropy_free(&ssl->entropy);
-
-			ssl->hostname.clear();
-
-			ssl->active = false;
+			FreeSSL(_SSL[sslID]);
 
 			Memory::Write_U32(SSL_OK, _BufferIn);
 		}
@@ -400,6 +448,7 @@ IPCCommandResult CWII_IPC_HLE_Device_net_ssl::IOCtlV(u32 _CommandAddress)
 			ssl->sockfd = Memory::Read_U32(BufferOut2);
 			INFO_LOG(WII_IPC_SSL, "IOCTLV_NET_SSL_CONNECT socket = %d", ssl->sockfd);
 			mbedtls_ssl_set_bio(&ssl->ctx, &ssl->sockfd, mbedtls_net_send, mbedtls_net_recv, nullptr);
+			ResumeSession(*ssl);
 			Memory::Write_U32(SSL_OK, _BufferIn);
 		}
 		else
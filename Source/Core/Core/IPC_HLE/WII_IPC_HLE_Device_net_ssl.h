@@ -12,6 +12,7 @@
 #include <mbedtls/entropy.h>
 #include <mbedtls/net.h>
 #include <mbedtls/ssl.h>
+#include <atomic>
 #include <string>
 
 // clang-format on
@@ -74,6 +75,12 @@ struct WII_SSL
 	int sockfd;
 	std::string hostname;
 	bool active;
+
+	// The handshake runs on a worker thread. The CPU thread leaves ctx alone while handshake_running
+	// is set, then reads handshake_result. handshake_started is only used by the CPU thread.
+	bool handshake_started;
+	std::atomic<bool> handshake_running;
+	int handshake_result;
 };
 
 class CWII_IPC_HLE_Device_net_ssl : public IWII_IPC_HLE_Device
@@ -91,5 +98,16 @@ public:
 
 	int GetSSLFreeID() const;
 
+	// Blocks until the handshake running on a worker for ssl, if any, is done
+	static void WaitForHandshake(const WII_SSL& ssl);
+	// Keeps the session of a completed handshake, so the next connection to the same host can resume
+	// it instead of doing a full handshake
+	static void SaveSession(const WII_SSL& ssl);
+
 	static WII_SSL _SSL[NET_SSL_MAXINSTANCES];
+
+private:
+	// Offers the session last saved for the host of ssl to its server
+	static void ResumeSession(WII_SSL& ssl);
+	static void FreeSSL(WII_SSL& ssl);
 };
@@ -15,6 +15,7 @@
 #include "Core/IPC_HLE/WII_IPC_HLE.h"
 #include "Core/IPC_HLE/WII_IPC_HLE_Device_usb_bt_emu.h"
 #include "Core/IPC_HLE/WII_IPC_HLE_WiiMote.h"
+#include "Core/IPC_HLE/l2cap.h"
 #include "Core/Movie.h"
 #include "InputCommon/ControllerInterface/ControllerInterface.h"
 
@@ -354,28 +355,59 @@ void CWII_IPC_HLE_Device_usb_oh1_57e_305_emu::SendACLPacket(u16 connection_handl
 {
 	DEBUG_LOG(WII_IPC_WIIMOTE, "ACL packet from %x ready to send to stack...", connection_handle);
 
-	if (m_ACLEndpoint.IsValid() && !m_HCIEndpoint.IsValid() && m_EventQueue.empty())
-	{
-		DEBUG_LOG(WII_IPC_WIIMOTE, "ACL endpoint valid, sending packet to %08x",
-			m_ACLEndpoint.m_cmd_address);
+	bool to_endpoint;
+	u8* payload = StartACLPacket(connection_handle, size, &to_endpoint);
+	if (payload == nullptr)
+		return;
 
-		hci_acldata_hdr_t* header =
-			reinterpret_cast<hci_acldata_hdr_t*>(Memory::GetPointer(m_ACLEndpoint.m_payload_addr));
-		header->con_handle = HCI_MK_CON_HANDLE(connection_handle, HCI_PACKET_START, HCI_POINT2POINT);
-		header->length = size;
+	memcpy(payload, data, size);
+	FinishACLPacket(size, to_endpoint);
+}
 
-		// Write the packet to the buffer
-		memcpy(reinterpret_cast<u8*>(header) + sizeof(hci_acldata_hdr_t), data, header->length);
+void CWII_IPC_HLE_Device_usb_oh1_57e_305_emu::SendL2capPacket(u16 connection_handle, u16 dcid,
+	const u8* data, u32 size)
+{
+	const u32 frame_size = sizeof(l2cap_hdr_t) + size;
+	bool to_endpoint;
+	u8* frame = StartACLPacket(connection_handle, frame_size, &to_endpoint);
+	if (frame == nullptr)
+		return;
 
-		m_ACLEndpoint.SetRetVal(sizeof(hci_acldata_hdr_t) + size);
-		EnqueueReply(m_ACLEndpoint.m_cmd_address);
-		m_ACLEndpoint.Invalidate();
-	}
-	else
+	l2cap_hdr_t* header = reinterpret_cast<l2cap_hdr_t*>(frame);
+	header->dcid = dcid;
+	header->length = size;
+	memcpy(frame + sizeof(l2cap_hdr_t), data, size);
+	FinishACLPacket(frame_size, to_endpoint);
+}
+
+u8* CWII_IPC_HLE_Device_usb_oh1_57e_305_emu::StartACLPacket(u16 connection_handle, u32 size,
+	bool* to_endpoint)
+{
+	*to_endpoint = m_ACLEndpoint.IsValid() && !m_HCIEndpoint.IsValid() && m_EventQueue.empty();
+	if (!*to_endpoint)
 	{
 		DEBUG_LOG(WII_IPC_WIIMOTE, "ACL endpoint not currently valid, queuing...");
-		m_acl_pool.Store(data, size, connection_handle);
+		return m_acl_pool.Push(size, connection_handle);
 	}
+
+	DEBUG_LOG(WII_IPC_WIIMOTE, "ACL endpoint valid, sending packet to %08x",
+		m_ACLEndpoint.m_cmd_address);
+
+	hci_acldata_hdr_t* header =
+		reinterpret_cast<hci_acldata_hdr_t*>(Memory::GetPointer(m_ACLEndpoint.m_payload_addr));
+	header->con_handle = HCI_MK_CON_HANDLE(connection_handle, HCI_PACKET_START, HCI_POINT2POINT);
+	header->length = size;
+	return reinterpret_cast<u8*>(header) + sizeof(hci_acldata_hdr_t);
+}
+
+void CWII_IPC_HLE_Device_usb_oh1_57e_305_emu::FinishACLPacket(u32 size, bool to_endpoint)
+{
+	if (!to_endpoint)
+		return;
+
+	m_ACLEndpoint.SetRetVal(sizeof(hci_acldata_hdr_t) + size);
+	EnqueueReply(m_ACLEndpoint.m_cmd_address);
+	m_ACLEndpoint.Invalidate();
 }
 
 // These messages are sent from the Wii Remote to the game, for example RequestConnection()
@@ -499,29 +531,27 @@ u32 CWII_IPC_HLE_Device_usb_oh1_57e_305_emu::Update()
 	return packet_transferred;
 }
 
-void CWII_IPC_HLE_Device_usb_oh1_57e_305_emu::ACLPool::Store(const u8* data, const u16 size,
-	const u16 conn_handle)
+u8* CWII_IPC_HLE_Device_usb_oh1_57e_305_emu::ACLPool::Push(const u16 size, const u16 conn_handle)
 {
-	if (m_queue.size() >= 100)
+	if (m_count >= MAX_PACKETS)
 	{
-		// Many simultaneous exchanges of ACL packets tend to cause the queue to fill up.
-		ERROR_LOG(WII_IPC_WIIMOTE, "ACL queue size reached 100 - current packet will be dropped!");
-		return;
+		ERROR_LOG(WII_IPC_WIIMOTE, "ACL queue size reached %u - current packet will be dropped!",
+			MAX_PACKETS);
+		return nullptr;
 	}
 
 	_dbg_assert_msg_(WII_IPC_WIIMOTE, size < ACL_PKT_SIZE, "ACL packet too large for pool");
 
-	m_queue.push_back(Packet());
-	auto& packet = m_queue.back();
-
-	std::copy(data, data + size, packet.data);
+	Packet& packet = m_packets[(m_first + m_count) % MAX_PACKETS];
+	m_count++;
 	packet.size = size;
 	packet.conn_handle = conn_handle;
+	return packet.data;
 }
 
 void CWII_IPC_HLE_Device_usb_oh1_57e_305_emu::ACLPool::WriteToEndpoint(CtrlBuffer& endpoint)
 {
-	auto& packet = m_queue.front();
+	const Packet& packet = m_packets[m_first];
 
 	const u8* const data = packet.data;
 	const u16 size = packet.size;
@@ -540,12 +570,26 @@ void CWII_IPC_HLE_Device_usb_oh1_57e_305_emu::ACLPool::WriteToEndpoint(CtrlBuffe
 
 	endpoint.SetRetVal(sizeof(hci_acldata_hdr_t) + size);
 
-	m_queue.pop_front();
+	m_first = (m_first + 1) % MAX_PACKETS;
+	m_count--;
 
 	EnqueueReply(endpoint.m_cmd_address);
 	endpoint.Invalidate();
 }
 
+void CWII_IPC_HLE_Device_usb_oh1_57e_305_emu::ACLPool::DoState(PointerWrap& p)
+{
+	u32 count = m_count;
+	p.Do(count);
+	if (p.GetMode() == PointerWrap::MODE_READ)
+	{
+		m_first = 0;
+		m_count = std::min(count, MAX_PACKETS);
+	}
+	for (u32 i = 0; i < m_count; i++)
+		p.Do(m_packets[(m_first + i) % MAX_PACKETS]);
+}
+
 bool CWII_IPC_HLE_Device_usb_oh1_57e_305_emu::SendEventInquiryComplete()
 {
 	SQueuedEvent Event(sizeof(SHCIEventInquiryComplete), 0);
@@ -903,6 +947,14 @@ bool CWII_IPC_HLE_Device_usb_oh1_57e_305_emu::SendEventRoleChange(bdaddr_t _bd,
 
 bool CWII_IPC_HLE_Device_usb_oh1_57e_305_emu::SendEventNumberOfCompletedPackets()
 {
+	// This runs on every update, most of which have no packets to report
+	if (std::all_of(std::begin(m_PacketCount), std::begin(m_PacketCount) + m_WiiMotes.size(),
+		[](u32 count) { return count == 0; }))
+	{
+		DEBUG_LOG(WII_IPC_WIIMOTE, "SendEventNumberOfCompletedPackets: no packets; no event");
+		return true;
+	}
+
 	SQueuedEvent Event((u32)(sizeof(hci_event_hdr_t) + sizeof(hci_num_compl_pkts_ep) +
 		(sizeof(hci_num_compl_pkts_info) * m_WiiMotes.size())),
 		0);
@@ -918,8 +970,6 @@ bool CWII_IPC_HLE_Device_usb_oh1_57e_305_emu::SendEventNumberOfCompletedPackets(
 	event_hdr->length = sizeof(hci_num_compl_pkts_ep);
 	event->num_con_handles = 0;
 
-	u32 acc = 0;
-
 	for (unsigned int i = 0; i < m_WiiMotes.size(); i++)
 	{
 		event_hdr->length += sizeof(hci_num_compl_pkts_info);
@@ -930,19 +980,11 @@ bool CWII_IPC_HLE_Device_usb_oh1_57e_305_emu::SendEventNumberOfCompletedPackets(
 		DEBUG_LOG(WII_IPC_WIIMOTE, "  Connection_Handle: 0x%04x", info->con_handle);
 		DEBUG_LOG(WII_IPC_WIIMOTE, "  Number_Of_Completed_Packets: %i", info->compl_pkts);
 
-		acc += info->compl_pkts;
 		m_PacketCount[i] = 0;
 		info++;
 	}
 
-	if (acc)
-	{
-		AddEventToQueue(Event);
-	}
-	else
-	{
-		DEBUG_LOG(WII_IPC_WIIMOTE, "SendEventNumberOfCompletedPackets: no packets; no event");
-	}
+	AddEventToQueue(Event);
 
 	return true;
 }
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
 #include <deque>
 #include <queue>
 #include <vector>
@@ -60,6 +61,9 @@ public:
 
 	// Send ACL data back to Bluetooth stack
 	void SendACLPacket(u16 connection_handle, const u8* data, u32 size);
+	// Sends an L2CAP frame to channel dcid, writing its header in place rather than building the
+	// frame first. This is the path of every Wii Remote report.
+	void SendL2capPacket(u16 connection_handle, u16 dcid, const u8* data, u32 size);
 
 	bool RemoteDisconnect(u16 _connectionHandle);
 
@@ -104,17 +108,22 @@ private:
 			u16 conn_handle;
 		};
 
-		std::deque<Packet> m_queue;
+		// Many simultaneous exchanges of ACL packets tend to fill the queue, the packets past it are
+		// dropped. A fixed ring, as the queue fills and drains at the report rate of every remote.
+		static constexpr u32 MAX_PACKETS = 100;
+		std::array<Packet, MAX_PACKETS> m_packets;
+		u32 m_first = 0;
+		u32 m_count = 0;
 
 	public:
-		ACLPool() : m_queue() {}
-		void Store(const u8* data, const u16 size, const u16 conn_handle);
+		// Returns where the payload of a size bytes packet goes, or nullptr if the queue is full
+		u8* Push(const u16 size, const u16 conn_handle);
 
 		void WriteToEndpoint(CtrlBuffer& endpoint);
 
-		bool IsEmpty() const { return m_queue.empty(); }
-		// For SaveStates
-		void DoState(PointerWrap& p) { p.Do(m_queue); }
+		bool IsEmpty() const { return m_count == 0; }
+		// For SaveStates, in the format of the deque this used to be
+		void DoState(PointerWrap& p);
 	} m_acl_pool;
 
 	u32 m_PacketCount[MAX_BBMOTES];
@@ -126,6 +135,11 @@ private:
 
 	// Events
 	void AddEventToQueue(const SQueuedEvent& _event);
+
+	// Returns where the size bytes of an ACL packet go: the buffer of the ACL endpoint when the stack
+	// waits for one, else the pool. nullptr when the pool is full. FinishACLPacket sends it.
+	u8* StartACLPacket(u16 connection_handle, u32 size, bool* to_endpoint);
+	void FinishACLPacket(u32 size, bool to_endpoint);
 	bool SendEventCommandStatus(u16 _Opcode);
 	void SendEventCommandComplete(u16 opcode, const void* data, u32 data_size);
 	bool SendEventInquiryResponse();
@@ -4,12 +4,20 @@
 
 #include <algorithm>
 #include <mbedtls/error.h>
+#include <vector>
 #ifndef _WIN32
 #include <arpa/inet.h>
 #include <unistd.h>
 #endif
+#if defined(__linux__)
+#include <sys/epoll.h>
+#elif defined(__APPLE__) || defined(__FreeBSD__)
+#include <sys/event.h>
+#endif
 
 #include "Common/FileUtil.h"
+#include "Common/Thread.h"
+#include "Common/ThreadPool.h"
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
 #include "Core/IPC_HLE/WII_IPC_HLE.h"
@@ -180,13 +188,15 @@ s32 WiiSocket::FCntl(u32 cmd, u32 arg)
 	return ret;
 }
 
-void WiiSocket::Update(bool read, bool write, bool except)
+u32 WiiSocket::Update()
 {
+	u32 wants = 0;
 	auto it = pending_sockops.begin();
 	while (it != pending_sockops.end())
 	{
 		s32 ReturnValue = 0;
 		bool forceNonBlock = false;
+		bool waitingForWorker = false;
 		IPCCommandType ct = static_cast<IPCCommandType>(Memory::Read_U32(it->_CommandAddress));
 		if (!it->is_ssl && ct == IPC_CMD_IOCTL)
 		{
@@ -308,14 +318,39 @@ void WiiSocket::Update(bool read, bool write, bool except)
 			if (it->is_ssl)
 			{
 				int sslID = Memory::Read_U32(BufferOut) - 1;
-				if (SSLID_VALID(sslID))
+				// The context belongs to the worker running the handshake until it returns
+				if (SSLID_VALID(sslID) &&
+					CWII_IPC_HLE_Device_net_ssl::_SSL[sslID].handshake_running.load(std::memory_order_acquire))
+				{
+					waitingForWorker = true;
+				}
+				else if (SSLID_VALID(sslID))
 				{
 					switch (it->ssl_type)
 					{
 					case IOCTLV_NET_SSL_DOHANDSHAKE:
 					{
-						mbedtls_ssl_context* ctx = &CWII_IPC_HLE_Device_net_ssl::_SSL[sslID].ctx;
-						int ret = mbedtls_ssl_handshake(ctx);
+						WII_SSL& ssl = CWII_IPC_HLE_Device_net_ssl::_SSL[sslID];
+						mbedtls_ssl_context* ctx = &ssl.ctx;
+						// The key exchange and certificate checks take milliseconds, a worker does them
+						// and wakes the socket when the handshake returns
+						if (!ssl.handshake_started)
+						{
+							ssl.handshake_started = true;
+							ssl.handshake_running.store(true, std::memory_order_relaxed);
+							const s32 wake_fd = fd;
+							Common::ThreadPool::Submit([&ssl, wake_fd] {
+								ssl.handshake_result = mbedtls_ssl_handshake(&ssl.ctx);
+								ssl.handshake_running.store(false, std::memory_order_release);
+								WiiSockMan::GetInstance().WakeSocket(wake_fd);
+							});
+							waitingForWorker = true;
+							break;
+						}
+						ssl.handshake_started = false;
+						int ret = ssl.handshake_result;
+						if (ret == 0)
+							CWII_IPC_HLE_Device_net_ssl::SaveSession(ssl);
 						if (ret)
 						{
 							char error_buffer[256] = "";
@@ -567,7 +602,12 @@ void WiiSocket::Update(bool read, bool write, bool except)
 			}
 		}
 
-		if (nonBlock || forceNonBlock ||
+		if (waitingForWorker)
+		{
+			wants |= WANT_WAKEUP;
+			++it;
+		}
+		else if (nonBlock || forceNonBlock ||
 			(!it->is_ssl && ReturnValue != -SO_EAGAIN && ReturnValue != -SO_EINPROGRESS &&
 				ReturnValue != -SO_EALREADY) ||
 				(it->is_ssl && ReturnValue != SSL_ERR_WAGAIN && ReturnValue != SSL_ERR_RAGAIN))
@@ -581,9 +621,16 @@ void WiiSocket::Update(bool read, bool write, bool except)
 		}
 		else
 		{
+			if (it->is_ssl)
+				wants |= ReturnValue == SSL_ERR_RAGAIN ? WANT_READ : WANT_WRITE;
+			else if (it->net_type == IOCTL_SO_ACCEPT || it->net_type == IOCTLV_SO_RECVFROM)
+				wants |= WANT_READ;
+			else
+				wants |= WANT_WRITE;
 			++it;
 		}
 	}
+	return wants;
 }
 
 void WiiSocket::DoSock(u32 _CommandAddress, NET_IOCTL type)
@@ -620,60 +667,221 @@ s32 WiiSockMan::NewSocket(s32 af, s32 type, s32 protocol)
 s32 WiiSockMan::DeleteSocket(s32 s)
 {
 	auto socket_entry = WiiSockets.find(s);
+	Unwatch(s);
 	s32 ReturnValue = socket_entry->second.CloseFd();
 	WiiSockets.erase(socket_entry);
 	return ReturnValue;
 }
 
+void WiiSockMan::Clean()
+{
+	for (const auto& entry : WiiSockets)
+		Unwatch(entry.first);
+	WiiSockets.clear();
+	new_op_fds.clear();
+}
+
 void WiiSockMan::Update()
 {
-	s32 nfds = 0;
-	fd_set read_fds, write_fds, except_fds;
-	struct timeval t = { 0, 0 };
-	FD_ZERO(&read_fds);
-	FD_ZERO(&write_fds);
-	FD_ZERO(&except_fds);
+	if (new_op_fds.empty() && !has_ready_fds.load(std::memory_order_acquire))
+		return;
 
-	auto socket_iter = WiiSockets.begin();
-	auto end_socks = WiiSockets.end();
+	std::set<s32> fds;
+	fds.swap(new_op_fds);
+	if (has_ready_fds.exchange(false))
+	{
+		std::lock_guard<std::mutex> lk(ready_lock);
+		fds.insert(ready_fds.begin(), ready_fds.end());
+		ready_fds.clear();
+	}
 
-	while (socket_iter != end_socks)
+	for (s32 fd : fds)
 	{
-		WiiSocket& sock = socket_iter->second;
-		if (sock.IsValid())
-		{
-			FD_SET(sock.fd, &read_fds);
-			FD_SET(sock.fd, &write_fds);
-			FD_SET(sock.fd, &except_fds);
-			nfds = std::max(nfds, sock.fd + 1);
-			++socket_iter;
-		}
-		else
+		auto socket_entry = WiiSockets.find(fd);
+		if (socket_entry == WiiSockets.end())
+			continue;
+
+		WiiSocket& sock = socket_entry->second;
+		if (!sock.IsValid())
 		{
 			// Good time to clean up invalid sockets.
-			socket_iter = WiiSockets.erase(socket_iter);
+			WiiSockets.erase(socket_entry);
+			continue;
 		}
+
+		const u32 wants = sock.Update();
+		if (sock.pending_sockops.empty())
+			continue;
+		// Operations waiting on a worker only need its wake up
+		const u32 fd_wants = wants & (WiiSocket::WANT_READ | WiiSocket::WANT_WRITE);
+		if (fd_wants || !(wants & WiiSocket::WANT_WAKEUP))
+			Watch(fd, fd_wants ? fd_wants : WiiSocket::WANT_READ | WiiSocket::WANT_WRITE);
 	}
-	s32 ret = select(nfds, &read_fds, &write_fds, &except_fds, &t);
+}
 
-	if (ret >= 0)
+WiiSockMan::~WiiSockMan()
+{
+	if (net_thread.joinable())
 	{
-		for (auto& pair : WiiSockets)
-		{
-			WiiSocket& sock = pair.second;
-			sock.Update(FD_ISSET(sock.fd, &read_fds) != 0, FD_ISSET(sock.fd, &write_fds) != 0,
-				FD_ISSET(sock.fd, &except_fds) != 0);
-		}
+		net_thread_exiting.Set();
+#ifndef _WIN32
+		const char wakeup = 0;
+		if (write(wakeup_pipe[1], &wakeup, 1) < 0)
+			ERROR_LOG(WII_IPC_NET, "Failed to wake the network thread");
+#endif
+		net_thread.join();
 	}
-	else
+
+#ifndef _WIN32
+	for (int fd : {poller, wakeup_pipe[0], wakeup_pipe[1]})
+	{
+		if (fd >= 0)
+			close(fd);
+	}
+#endif
+}
+
+void WiiSockMan::StartNetThread()
+{
+#ifndef _WIN32
+#if defined(__linux__)
+	poller = epoll_create1(0);
+#else
+	poller = kqueue();
+#endif
+	if (poller < 0 || pipe(wakeup_pipe) != 0)
+	{
+		ERROR_LOG(WII_IPC_NET, "Failed to create the socket poller");
+		return;
+	}
+
+#if defined(__linux__)
+	epoll_event ev = {};
+	ev.events = EPOLLIN;
+	ev.data.fd = wakeup_pipe[0];
+	epoll_ctl(poller, EPOLL_CTL_ADD, wakeup_pipe[0], &ev);
+#else
+	struct kevent ev;
+	EV_SET(&ev, wakeup_pipe[0], EVFILT_READ, EV_ADD, 0, 0, nullptr);
+	kevent(poller, &ev, 1, nullptr, 0, nullptr);
+#endif
+#endif
+
+	net_thread = std::thread(&WiiSockMan::NetThread, this);
+}
+
+void WiiSockMan::WakeSocket(s32 fd)
+{
+	AddReady(fd);
+}
+
+void WiiSockMan::AddReady(s32 fd)
+{
+	std::lock_guard<std::mutex> lk(ready_lock);
+	ready_fds.insert(fd);
+	has_ready_fds.store(true, std::memory_order_release);
+}
+
+void WiiSockMan::NetThread()
+{
+	Common::SetCurrentThreadName("Wii socket thread");
+
+	while (!net_thread_exiting.IsSet())
 	{
-		for (auto& elem : WiiSockets)
+#if defined(__linux__)
+		epoll_event events[32];
+		const int count = epoll_wait(poller, events, 32, -1);
+		for (int i = 0; i < count; i++)
+		{
+			if (events[i].data.fd != wakeup_pipe[0])
+				AddReady(events[i].data.fd);
+		}
+#elif defined(__APPLE__) || defined(__FreeBSD__)
+		struct kevent events[32];
+		const int count = kevent(poller, nullptr, 0, events, 32, nullptr);
+		for (int i = 0; i < count; i++)
+		{
+			if (static_cast<int>(events[i].ident) != wakeup_pipe[0])
+				AddReady(static_cast<s32>(events[i].ident));
+		}
+#else
+		// No way to wake WSAPoll up, so it waits a little at a time for sockets that were added
+		std::vector<pollfd_t> fds;
 		{
-			elem.second.Update(false, false, false);
+			std::lock_guard<std::mutex> lk(ready_lock);
+			for (const auto& entry : watched_fds)
+				fds.push_back({static_cast<SOCKET>(entry.first), entry.second, 0});
 		}
+		if (fds.empty() || WSAPoll(fds.data(), static_cast<ULONG>(fds.size()), 10) <= 0)
+		{
+			if (fds.empty())
+				Common::SleepCurrentThread(10);
+			continue;
+		}
+
+		std::lock_guard<std::mutex> lk(ready_lock);
+		for (const pollfd_t& fd : fds)
+		{
+			if (fd.revents)
+			{
+				watched_fds.erase(static_cast<s32>(fd.fd));
+				ready_fds.insert(static_cast<s32>(fd.fd));
+				has_ready_fds.store(true, std::memory_order_release);
+			}
+		}
+#endif
 	}
 }
 
+void WiiSockMan::Watch(s32 fd, u32 wants)
+{
+	if (!net_thread.joinable())
+		StartNetThread();
+
+	const bool read = (wants & WiiSocket::WANT_READ) != 0;
+	const bool write = (wants & WiiSocket::WANT_WRITE) != 0;
+#if defined(__linux__)
+	epoll_event ev = {};
+	ev.events = (read ? EPOLLIN : 0) | (write ? EPOLLOUT : 0) | EPOLLONESHOT;
+	ev.data.fd = fd;
+	if (epoll_ctl(poller, EPOLL_CTL_MOD, fd, &ev) != 0)
+		epoll_ctl(poller, EPOLL_CTL_ADD, fd, &ev);
+#elif defined(__APPLE__) || defined(__FreeBSD__)
+	struct kevent changes[2];
+	int count = 0;
+	if (read)
+		EV_SET(&changes[count++], fd, EVFILT_READ, EV_ADD | EV_ONESHOT, 0, 0, nullptr);
+	if (write)
+		EV_SET(&changes[count++], fd, EVFILT_WRITE, EV_ADD | EV_ONESHOT, 0, 0, nullptr);
+	kevent(poller, changes, count, nullptr, 0, nullptr);
+#else
+	std::lock_guard<std::mutex> lk(ready_lock);
+	watched_fds[fd] = (read ? POLLRDNORM : 0) | (write ? POLLWRNORM : 0);
+#endif
+}
+
+void WiiSockMan::Unwatch(s32 fd)
+{
+	if (!net_thread.joinable())
+		return;
+
+#if defined(__linux__)
+	epoll_ctl(poller, EPOLL_CTL_DEL, fd, nullptr);
+#elif defined(__APPLE__) || defined(__FreeBSD__)
+	struct kevent changes[2];
+	EV_SET(&changes[0], fd, EVFILT_READ, EV_DELETE, 0, 0, nullptr);
+	EV_SET(&changes[1], fd, EVFILT_WRITE, EV_DELETE, 0, 0, nullptr);
+	// Either may not have been added, that error is fine
+	kevent(poller, changes, 2, nullptr, 0, nullptr);
+#endif
+
+	std::lock_guard<std::mutex> lk(ready_lock);
+#ifdef _WIN32
+	watched_fds.erase(fd);
+#endif
+	ready_fds.erase(fd);
+}
+
 void WiiSockMan::EnqueueReply(u32 CommandAddress, s32 ReturnValue, IPCCommandType CommandType)
 {
 	// The original hardware overwrites the command type with the async reply type.
@@ -42,12 +42,18 @@ typedef struct pollfd pollfd_t;
 #endif
 
 #include <algorithm>
+#include <atomic>
 #include <cstdio>
 #include <list>
+#include <map>
+#include <mutex>
+#include <set>
 #include <string>
+#include <thread>
 #include <unordered_map>
 
 #include "Common/CommonTypes.h"
+#include "Common/Flag.h"
 #include "Common/NonCopyable.h"
 #include "Core/IPC_HLE/WII_IPC_HLE.h"
 #include "Core/IPC_HLE/WII_IPC_HLE_Device_net.h"
@@ -189,7 +195,16 @@ private:
 
 	void DoSock(u32 _CommandAddress, NET_IOCTL type);
 	void DoSock(u32 _CommandAddress, SSL_IOCTL type);
-	void Update(bool read, bool write, bool except);
+
+	enum
+	{
+		WANT_READ = 1,
+		WANT_WRITE = 2,
+		// An operation waits for a worker thread, which calls WiiSockMan::WakeSocket when done
+		WANT_WAKEUP = 4,
+	};
+	// Tries the pending operations, returns what the ones that would block wait for
+	u32 Update();
 	bool IsValid() const { return fd >= 0; }
 public:
 	WiiSocket() : fd(-1), nonBlock(false) {}
@@ -208,6 +223,10 @@ public:
 		static WiiSockMan instance;  // Guaranteed to be destroyed.
 		return instance;             // Instantiated on first use.
 	}
+	~WiiSockMan();
+
+	// Runs the operations of the sockets that got new ones or became ready since the last update.
+	// The network thread waits for the others, so an update without either is free.
 	void Update();
 	static void EnqueueReply(u32 CommandAddress, s32 ReturnValue, IPCCommandType CommandType);
 	static void Convert(WiiSockAddrIn const& from, sockaddr_in& to);
@@ -218,7 +237,7 @@ public:
 	s32 DeleteSocket(s32 s);
 	s32 GetLastNetError() const { return errno_last; }
 	void SetLastNetError(s32 error) { errno_last = error; }
-	void Clean() { WiiSockets.clear(); }
+	void Clean();
 	template <typename T>
 	void DoSock(s32 sock, u32 CommandAddress, T type)
 	{
@@ -233,14 +252,41 @@ public:
 		else
 		{
 			socket_entry->second.DoSock(CommandAddress, type);
+			new_op_fds.insert(sock);
 		}
 	}
 
 	void UpdateWantDeterminism(bool want);
+	// Has the next update run the operations of fd, from any thread
+	void WakeSocket(s32 fd);
 
 private:
 	WiiSockMan() = default;
 
+	void StartNetThread();
+	void NetThread();
+	// Asks the network thread to report fd once, when it is ready for what wants says
+	void Watch(s32 fd, u32 wants);
+	void Unwatch(s32 fd);
+	void AddReady(s32 fd);
+
 	std::unordered_map<s32, WiiSocket> WiiSockets;
 	s32 errno_last;
+
+	// Sockets that got operations since the last update. Only used by the CPU thread.
+	std::set<s32> new_op_fds;
+
+	std::thread net_thread;
+	Common::Flag net_thread_exiting;
+	std::mutex ready_lock;
+	std::set<s32> ready_fds;
+	std::atomic<bool> has_ready_fds{false};
+#ifdef _WIN32
+	// WSAPoll is given these on every wait, guarded by ready_lock
+	std::map<s32, short> watched_fds;
+#else
+	// epoll or kqueue, with the read end of wakeup_pipe to stop the thread
+	int poller = -1;
+	int wakeup_pipe[2] = {-1, -1};
+#endif
 };
@@ -44,6 +44,11 @@ LONG NTAPI Handler(PEXCEPTION_POINTERS pPtrs)
 		uintptr_t badAddress = (uintptr_t)pPtrs->ExceptionRecord->ExceptionInformation[1];
 		CONTEXT* ctx = pPtrs->ContextRecord;
 
+		if (accessType == 1 && Memory::HandleWriteWatchFault(badAddress))
+		{
+			return (DWORD)EXCEPTION_CONTINUE_EXECUTION;
+		}
+
 		if (JitInterface::HandleFault(badAddress, ctx))
 		{
 			return (DWORD)EXCEPTION_CONTINUE_EXECUTION;
@@ -171,7 +176,8 @@ static void ExceptionThread(mach_port_t port)
 
 		x86_thread_state64_t* state = (x86_thread_state64_t*)msg_in.old_state;
 
-		bool ok = JitInterface::HandleFault((uintptr_t)msg_in.code[1], state);
+		bool ok = Memory::HandleWriteWatchFault((uintptr_t)msg_in.code[1]) ||
+			JitInterface::HandleFault((uintptr_t)msg_in.code[1], state);
 
 		// Set up the reply.
 		msg_out.Head.msgh_bits = MACH_MSGH_BITS(MACH_MSGH_BITS_REMOTE(msg_in.Head.msgh_bits), 0);
@@ -247,6 +253,8 @@ static void sigsegv_handler(int sig, siginfo_t* info, void* raw_context)
 		return;
 	}
 	uintptr_t bad_address = (uintptr_t)info->si_addr;
+	if (sicode == SEGV_ACCERR && Memory::HandleWriteWatchFault(bad_address))
+		return;
 
 	// Get all the information we can out of the context.
 #ifdef __OpenBSD__
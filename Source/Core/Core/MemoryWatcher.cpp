@@ -2,11 +2,13 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <memory>
 #include <sstream>
 #include <unistd.h>
+#include <sys/uio.h>
 
 #include "Common/FileUtil.h"
 #include "Core/CoreTiming.h"
@@ -17,6 +19,7 @@
 static std::unique_ptr<MemoryWatcher> s_memory_watcher;
 static CoreTiming::EventType* s_event;
 static const int MW_RATE = 600;  // Steps per second
+static const u32 MW_PAGE_SHIFT = 12;
 
 static void MWCallback(u64 userdata, s64 cyclesLate)
 {
@@ -66,19 +69,25 @@ bool MemoryWatcher::LoadAddresses(const std::string& path)
   while (std::getline(locations, line))
     ParseLine(line);
 
-  return m_values.size() > 0;
+  return m_watches.size() > 0;
 }
 
 void MemoryWatcher::ParseLine(const std::string& line)
 {
-  m_values[line] = 0;
-  m_addresses[line] = std::vector<u32>();
+  if (std::any_of(m_watches.begin(), m_watches.end(),
+                  [&line](const Watch& watch) { return watch.line == line; }))
+  {
+    return;
+  }
 
+  Watch watch;
+  watch.line = line;
   std::stringstream offsets(line);
   offsets >> std::hex;
   u32 offset;
   while (offsets >> offset)
-    m_addresses[line].push_back(offset);
+    watch.offsets.push_back(offset);
+  m_watches.push_back(std::move(watch));
 }
 
 bool MemoryWatcher::OpenSocket(const std::string& path)
@@ -91,11 +100,28 @@ bool MemoryWatcher::OpenSocket(const std::string& path)
   return m_fd >= 0;
 }
 
-u32 MemoryWatcher::ChasePointer(const std::string& line)
+// Watches the page of the address for writes before reading it, so a write after the read is seen
+// in the next step
+u32 MemoryWatcher::ReadWatched(size_t index, u32 address)
+{
+  const u32 page = address >> MW_PAGE_SHIFT;
+  Watch& watch = m_watches[index];
+  if (std::find(watch.pages.begin(), watch.pages.end(), page) == watch.pages.end())
+  {
+    WatchedPage& watched = m_pages[page];
+    if (!watched.epoch)
+      watched.epoch = Memory::WatchRange(page << MW_PAGE_SHIFT, 1 << MW_PAGE_SHIFT);
+    watched.watches.push_back(index);
+    watch.pages.push_back(page);
+  }
+  return Memory::Read_U32(address);
+}
+
+u32 MemoryWatcher::ChasePointer(size_t index)
 {
   u32 value = 0;
-  for (u32 offset : m_addresses[line])
-    value = Memory::Read_U32(value + offset);
+  for (u32 offset : m_watches[index].offsets)
+    value = ReadWatched(index, value + offset);
   return value;
 }
 
@@ -106,24 +132,90 @@ std::string MemoryWatcher::ComposeMessage(const std::string& line, u32 value)
   return message_stream.str();
 }
 
+void MemoryWatcher::SendMessages(const std::vector<std::string>& messages)
+{
+#ifdef __linux__
+  // Still one datagram per message, the readers expect that
+  std::vector<iovec> buffers(messages.size());
+  std::vector<mmsghdr> headers(messages.size());
+  for (size_t i = 0; i < messages.size(); i++)
+  {
+    buffers[i].iov_base = const_cast<char*>(messages[i].c_str());
+    buffers[i].iov_len = messages[i].size() + 1;
+    headers[i] = {};
+    headers[i].msg_hdr.msg_name = &m_addr;
+    headers[i].msg_hdr.msg_namelen = sizeof(m_addr);
+    headers[i].msg_hdr.msg_iov = &buffers[i];
+    headers[i].msg_hdr.msg_iovlen = 1;
+  }
+  size_t sent = 0;
+  while (sent < headers.size())
+  {
+    const int result =
+        sendmmsg(m_fd, &headers[sent], static_cast<unsigned int>(headers.size() - sent), 0);
+    if (result <= 0)
+      break;
+    sent += result;
+  }
+#else
+  for (const std::string& message : messages)
+  {
+    sendto(m_fd, message.c_str(), message.size() + 1, 0, reinterpret_cast<sockaddr*>(&m_addr),
+           sizeof(m_addr));
+  }
+#endif
+}
+
 void MemoryWatcher::Step()
 {
   if (!m_running)
     return;
 
-  for (auto& entry : m_values)
+  // Only the watches that read a page written since it was watched need to be read again. Without
+  // fastmem the epochs are 0 and every page counts as written.
+  std::vector<bool> stale(m_watches.size(), false);
+  for (auto& entry : m_pages)
   {
-    std::string address = entry.first;
-    u32& current_value = entry.second;
+    WatchedPage& page = entry.second;
+    if (!Memory::IsRangeModified(entry.first << MW_PAGE_SHIFT, 1 << MW_PAGE_SHIFT, page.epoch))
+      continue;
+    for (size_t index : page.watches)
+      stale[index] = true;
+    page.epoch = 0;
+  }
 
-    u32 new_value = ChasePointer(address);
-    if (new_value != current_value)
+  std::vector<std::string> messages;
+  for (size_t i = 0; i < m_watches.size(); i++)
+  {
+    Watch& watch = m_watches[i];
+    // Watches without pages have never been read
+    if (!stale[i] && !watch.pages.empty())
+      continue;
+
+    // A pointer may have moved, so the pages are collected again
+    for (u32 page : watch.pages)
     {
-      // Update the value
-      current_value = new_value;
-      std::string message = ComposeMessage(address, new_value);
-      sendto(m_fd, message.c_str(), message.size() + 1, 0, reinterpret_cast<sockaddr*>(&m_addr),
-             sizeof(m_addr));
+      std::vector<size_t>& watches = m_pages[page].watches;
+      watches.erase(std::remove(watches.begin(), watches.end(), i), watches.end());
     }
+    watch.pages.clear();
+
+    const u32 new_value = ChasePointer(i);
+    if (new_value != watch.value)
+    {
+      watch.value = new_value;
+      messages.push_back(ComposeMessage(watch.line, new_value));
+    }
+  }
+
+  for (auto it = m_pages.begin(); it != m_pages.end();)
+  {
+    if (it->second.watches.empty())
+      it = m_pages.erase(it);
+    else
+      ++it;
   }
+
+  if (!messages.empty())
+    SendMessages(messages);
 }
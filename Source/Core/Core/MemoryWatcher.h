@@ -5,6 +5,7 @@
 #pragma once
 
 #include <map>
+#include <string>
 #include <vector>
 #include <sys/socket.h>
 #include <sys/un.h>
@@ -17,6 +18,10 @@
 // "ABCD EF" will watch the address at (*0xABCD) + 0xEF.
 // The output to the socket is two lines. The first is the address from the
 // input file, and the second is the new value in hex.
+//
+// The watches are grouped by the pages they read, and only those on pages written since the last
+// step are read again when the write watches of Memory are available. The messages of a step are
+// sent with a single call where the platform has one.
 class MemoryWatcher final
 {
 public:
@@ -28,20 +33,40 @@ public:
 	static void Shutdown();
 
 private:
+	struct Watch
+	{
+		// Address as stored in the file
+		std::string line;
+		// Offsets to follow
+		std::vector<u32> offsets;
+		u32 value = 0;
+		// Pages the last read went through
+		std::vector<u32> pages;
+	};
+
+	struct WatchedPage
+	{
+		// From Memory::WatchRange, 0 while the page needs to be watched again
+		u64 epoch = 0;
+		// Indices into m_watches
+		std::vector<size_t> watches;
+	};
+
 	bool LoadAddresses(const std::string& path);
 	bool OpenSocket(const std::string& path);
 
 	void ParseLine(const std::string& line);
-	u32 ChasePointer(const std::string& line);
+	u32 ChasePointer(size_t index);
+	u32 ReadWatched(size_t index, u32 address);
 	std::string ComposeMessage(const std::string& line, u32 value);
+	void SendMessages(const std::vector<std::string>& messages);
 
 	bool m_running;
 
 	int m_fd;
 	sockaddr_un m_addr;
 
-	// Address as stored in the file -> list of offsets to follow
-	std::map<std::string, std::vector<u32>> m_addresses;
-	// Address as stored in the file -> current value
-	std::map<std::string, u32> m_values;
+	std::vector<Watch> m_watches;
+	// Page number -> the watches reading it
+	std::map<u32, WatchedPage> m_pages;
 };
@@ -5,6 +5,7 @@
 #include <algorithm>
 #include <array>
 #include <cctype>
+#include <cinttypes>
 #include <iterator>
 #include <mbedtls/config.h>
 #include <mbedtls/md.h>
@@ -29,6 +30,7 @@
 #include "Core/HW/EXI_DeviceIPL.h"
 #include "Core/HW/ProcessorInterface.h"
 #include "Core/HW/SI.h"
+#include "Core/HW/VideoInterface.h"
 #include "Core/HW/Wiimote.h"
 #include "Core/HW/WiimoteEmu/WiimoteEmu.h"
 #include "Core/HW/WiimoteEmu/WiimoteHid.h"
@@ -325,6 +327,11 @@ bool IsJustStartingPlayingInputFromSaveState()
 	return IsRecordingInputFromSaveState() && s_currentFrame == 1 && IsPlayingInput();
 }
 
+bool IsTurboPlayback()
+{
+	return IsPlayingInput() && SConfig::GetInstance().m_MovieTurbo;
+}
+
 bool IsPlayingInput()
 {
 	return (s_playMode == MODE_PLAYING);
@@ -1336,6 +1343,14 @@ bool PlayWiimote(int wiimote, u8* data, const WiimoteEmu::ReportFeatures& rptf,
 // NOTE: Host / EmuThread / CPU Thread
 void EndPlayInput(bool cont)
 {
+	if (IsTurboPlayback())
+	{
+		const u64 hash = VideoInterface::GetLastFieldHash();
+		NOTICE_LOG(COMMON, "Movie playback ended on frame %" PRIu64 " with frame hash %016" PRIx64,
+			s_currentFrame, hash);
+		Core::DisplayMessage(StringFromFormat("Final frame hash: %016" PRIx64, hash), 10000);
+	}
+
 	if (cont)
 	{
 		// If !IsMovieActive(), changing s_playMode requires calling UpdateWantDeterminism
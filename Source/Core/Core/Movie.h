@@ -117,6 +117,8 @@ bool IsRecordingInputFromSaveState();
 bool IsJustStartingRecordingInputFromSaveState();
 bool IsJustStartingPlayingInputFromSaveState();
 bool IsPlayingInput();
+// Playback without the frame limiter, audio and most of the presentation, for checking movies
+bool IsTurboPlayback();
 bool IsMovieActive();
 bool IsReadOnly();
 u64 GetRecordingStartTime();
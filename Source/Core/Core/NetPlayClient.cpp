@@ -8,15 +8,21 @@
 #include <mbedtls/md5.h>
 #include <memory>
 #include <thread>
+#include <xxhash.h>
+#include <zlib.h>
 #include "Common/Common.h"
 #include "Common/CommonPaths.h"
 #include "Common/CommonTypes.h"
+#include "Common/Crypto/SHA1.h"
 #include "Common/ENetUtil.h"
+#include "Common/FileUtil.h"
 #include "Common/MD5.h"
 #include "Common/MsgHandler.h"
+#include "Common/StringUtil.h"
 #include "Common/Timer.h"
 #include "Core/ConfigManager.h"
 #include "Core/HW/EXI_DeviceIPL.h"
+#include "Core/HW/Memmap.h"
 #include "Core/HW/SI.h"
 #include "Core/HW/SI_DeviceGCController.h"
 #include "Core/HW/Sram.h"
@@ -30,6 +36,8 @@
 
 static std::mutex crit_netplay_client;
 static NetPlayClient* netplay_client = nullptr;
+static std::mutex crit_synced_memcards;
+static std::array<std::string, 2> synced_memcard_paths;
 NetSettings g_NetPlaySettings;
 
 // called from ---GUI--- thread
@@ -419,6 +427,7 @@ unsigned int NetPlayClient::OnData(sf::Packet& packet)
 			g_NetPlaySettings.m_EXIDevice[0] = (TEXIDevices)tmp;
 			packet >> tmp;
 			g_NetPlaySettings.m_EXIDevice[1] = (TEXIDevices)tmp;
+			packet >> g_NetPlaySettings.m_MemoryCheck;
 
 			u32 time_low, time_high;
 			packet >> time_low;
@@ -485,6 +494,26 @@ unsigned int NetPlayClient::OnData(sf::Packet& packet)
 	}
 	break;
 
+	case NP_MSG_MEMORY_DESYNC:
+	{
+		int pid_to_blame;
+		u32 frame, region;
+		packet >> pid_to_blame;
+		packet >> frame;
+		packet >> region;
+
+		std::string player = "??";
+		std::lock_guard<std::recursive_mutex> lkp(m_crit.players);
+		{
+			auto it = m_players.find(pid_to_blame);
+			if (it != m_players.end())
+				player = it->second.name;
+		}
+		m_dialog->OnMemoryDesync(frame, player, NetPlay::GetMemoryDigestAddress(region),
+			NetPlay::MEMORY_CHECK_REGION_SIZE);
+	}
+	break;
+
 	case NP_MSG_SYNC_GC_SRAM:
 	{
 		u8 sram[sizeof(g_SRAM.p_SRAM)];
@@ -501,6 +530,39 @@ unsigned int NetPlayClient::OnData(sf::Packet& packet)
 	}
 	break;
 
+	case NP_MSG_SYNC_SAVE_HASHES:
+	{
+		OnSaveSyncHashes(packet);
+	}
+	break;
+
+	case NP_MSG_SYNC_SAVE_DATA:
+	{
+		u8 slot = 0;
+		u32 chunk = 0;
+		std::string compressed;
+		packet >> slot;
+		packet >> chunk;
+		packet >> compressed;
+
+		if (slot >= m_sync_cards.size() || chunk >= m_sync_cards[slot].hashes.size() ||
+			m_sync_cards[slot].missing == 0)
+			break;
+
+		// A broken chunk is caught by the hash check once everything arrived
+		SaveSyncCard& card = m_sync_cards[slot];
+		const size_t offset = static_cast<size_t>(chunk) * NetPlay::SAVE_SYNC_CHUNK_SIZE;
+		uLongf size = static_cast<uLongf>(
+			std::min<size_t>(NetPlay::SAVE_SYNC_CHUNK_SIZE, card.data.size() - offset));
+		uncompress(&card.data[offset], &size, reinterpret_cast<const Bytef*>(compressed.data()),
+			static_cast<uLong>(compressed.size()));
+
+		card.missing--;
+		if (m_sync_cards[0].missing == 0 && m_sync_cards[1].missing == 0)
+			FinishSaveSync();
+	}
+	break;
+
 	case NP_MSG_COMPUTE_MD5:
 	{
 		std::string file_identifier;
@@ -558,6 +620,107 @@ unsigned int NetPlayClient::OnData(sf::Packet& packet)
 	return 0;
 }
 
+// called from ---NETPLAY--- thread
+void NetPlayClient::OnSaveSyncHashes(sf::Packet& packet)
+{
+	for (int slot = 0; slot < 2; slot++)
+	{
+		SaveSyncCard& card = m_sync_cards[slot];
+		card = SaveSyncCard();
+		{
+			std::lock_guard<std::mutex> lk(crit_synced_memcards);
+			synced_memcard_paths[slot].clear();
+		}
+
+		bool has_card = false;
+		packet >> has_card;
+		if (!has_card)
+			continue;
+
+		u32 size = 0;
+		packet >> size;
+		card.hashes.resize((size + NetPlay::SAVE_SYNC_CHUNK_SIZE - 1) / NetPlay::SAVE_SYNC_CHUNK_SIZE);
+		for (u64& hash : card.hashes)
+		{
+			u32 hash_low, hash_high;
+			packet >> hash_low;
+			packet >> hash_high;
+			hash = hash_low | (static_cast<u64>(hash_high) << 32);
+		}
+
+		// Nothing has to be sent when our own card is the same as the host's
+		const std::string& local_path =
+			slot == 0 ? SConfig::GetInstance().m_strMemoryCardA : SConfig::GetInstance().m_strMemoryCardB;
+		std::string contents;
+		if (File::ReadFileToString(local_path, contents) && contents.size() == size)
+		{
+			card.data.assign(contents.begin(), contents.end());
+			if (NetPlay::GetSaveChunkHashes(card.data) == card.hashes)
+			{
+				card = SaveSyncCard();
+				continue;
+			}
+		}
+
+		// Otherwise the copy from the last session usually only differs in the blocks the host
+		// saved since, and our own card is the next best guess
+		card.path = File::GetUserPath(D_GCUSER_IDX) +
+			StringFromFormat("NetPlay%s.raw", slot == 0 ? "A" : "B");
+		if (File::ReadFileToString(card.path, contents))
+			card.data.assign(contents.begin(), contents.end());
+		card.data.resize(size);
+
+		const std::vector<u64> local_hashes = NetPlay::GetSaveChunkHashes(card.data);
+		std::vector<u32> chunks;
+		for (u32 i = 0; i < card.hashes.size(); i++)
+		{
+			if (local_hashes[i] != card.hashes[i])
+				chunks.push_back(i);
+		}
+		card.missing = chunks.size();
+		if (chunks.empty())
+			continue;
+
+		sf::Packet spac;
+		spac << static_cast<MessageId>(NP_MSG_SYNC_SAVE_REQUEST);
+		spac << static_cast<u8>(slot);
+		spac << static_cast<u32>(chunks.size());
+		for (u32 chunk : chunks)
+			spac << chunk;
+		Send(spac);
+	}
+
+	if (m_sync_cards[0].missing == 0 && m_sync_cards[1].missing == 0)
+		FinishSaveSync();
+}
+
+// called from ---NETPLAY--- thread
+void NetPlayClient::FinishSaveSync()
+{
+	for (int slot = 0; slot < 2; slot++)
+	{
+		const SaveSyncCard& card = m_sync_cards[slot];
+		if (card.path.empty())
+			continue;
+
+		// On failure the local card is used, which the desync detection will point out if it matters
+		if (NetPlay::GetSaveChunkHashes(card.data) != card.hashes ||
+			!File::IOFile(card.path, "wb").WriteBytes(card.data.data(), card.data.size()))
+		{
+			ERROR_LOG(NETPLAY, "Failed to sync memory card %c with the host", 'A' + slot);
+			continue;
+		}
+
+		std::lock_guard<std::mutex> lk(crit_synced_memcards);
+		synced_memcard_paths[slot] = card.path;
+	}
+	m_sync_cards = {};
+
+	sf::Packet spac;
+	spac << static_cast<MessageId>(NP_MSG_SYNC_SAVE_DONE);
+	Send(spac);
+}
+
 void NetPlayClient::Send(sf::Packet& packet)
 {
 	ENetPacket* epac =
@@ -690,7 +853,11 @@ void NetPlayClient::GetPlayerList(std::string& list, std::vector<int>& pid_list)
 		enumerate_player_controller_mappings(m_pad_map, player);
 		enumerate_player_controller_mappings(m_wiimote_map, player);
 
-		ss << " |\nPing: " << player.ping << "ms\n";
+		ss << " |";
+		if (std::find(m_pad_map.begin(), m_pad_map.end(), player.pid) == m_pad_map.end() &&
+			std::find(m_wiimote_map.begin(), m_wiimote_map.end(), player.pid) == m_wiimote_map.end())
+			ss << " spectating";
+		ss << "\nPing: " << player.ping << "ms\n";
 		ss << "Status: ";
 
 		switch (player.game_status)
@@ -797,6 +964,7 @@ bool NetPlayClient::StartGame(const std::string& path)
 	}
 
 	m_timebase_frame = 0;
+	NetPlay::ResetMemoryDigests();
 
 	m_is_running.Set();
 	NetPlay_Enable(this);
@@ -981,9 +1149,11 @@ bool NetPlayClient::GetNetPads(const int pad_nb, GCPadStatus* pad_status)
 
 			int ingame_pad = LocalPadToInGamePad(local_pad);
 
-			// adjust the buffer either up or down
-			// inserting multiple padstates or dropping states
-			while (m_pad_buffer[ingame_pad].Size() <= m_target_buffer_size)
+			// adjust the buffer either up or down, inserting padstates or dropping states
+			// it grows by at most one state per poll, so that a larger size doesn't repeat the
+			// same input for many frames at once
+			for (int pushed = 0; pushed < 2 && m_pad_buffer[ingame_pad].Size() <= m_target_buffer_size;
+				pushed++)
 			{
 				// add to buffer
 				m_pad_buffer[ingame_pad].Push(*pad_status);
@@ -1205,6 +1375,27 @@ void NetPlayClient::SendTimeBase()
 	netplay_client->SendAsync(std::move(spac));
 }
 
+// called from ---CPU--- thread, after SendTimeBase
+void NetPlayClient::SendMemoryDigests()
+{
+	std::lock_guard<std::mutex> lk(crit_netplay_client);
+
+	const u32 frame = netplay_client->m_timebase_frame - 1;
+	if (!g_NetPlaySettings.m_MemoryCheck || frame % NetPlay::MEMORY_CHECK_INTERVAL != 0)
+		return;
+
+	const std::vector<u64> digests = NetPlay::GetMemoryDigests();
+
+	auto spac = std::make_unique<sf::Packet>();
+	*spac << static_cast<MessageId>(NP_MSG_MEMORY_DIGESTS);
+	*spac << frame;
+	*spac << static_cast<u32>(digests.size());
+	for (u64 digest : digests)
+		*spac << static_cast<u32>(digest) << static_cast<u32>(digest >> 32);
+
+	netplay_client->SendAsync(std::move(spac));
+}
+
 bool NetPlayClient::DoAllPlayersHaveGame()
 {
 	std::lock_guard<std::recursive_mutex> lkp(m_crit.players);
@@ -1309,6 +1500,111 @@ bool NetPlay::IsNetPlayRunning()
 	return netplay_client != nullptr;
 }
 
+std::vector<u64> NetPlay::GetSaveChunkHashes(const std::vector<u8>& data)
+{
+	std::vector<u64> hashes((data.size() + SAVE_SYNC_CHUNK_SIZE - 1) / SAVE_SYNC_CHUNK_SIZE);
+	for (size_t i = 0; i < hashes.size(); i++)
+	{
+		const size_t offset = i * SAVE_SYNC_CHUNK_SIZE;
+		const Common::SHA1::Digest digest = Common::SHA1::CalculateDigest(
+			&data[offset], std::min<size_t>(SAVE_SYNC_CHUNK_SIZE, data.size() - offset));
+		for (int b = 0; b < 8; b++)
+			hashes[i] |= static_cast<u64>(digest[b]) << (b * 8);
+	}
+	return hashes;
+}
+
+// Hashes of the guest memory pages, and the epochs of the write watches they were hashed at
+static const u32 MEMORY_CHECK_PAGE_SIZE = 0x1000;
+static std::vector<u64> s_memory_page_hashes;
+static std::vector<u64> s_memory_page_epochs;
+
+std::vector<u64> NetPlay::GetMemoryDigests()
+{
+	struct Bank
+	{
+		u32 address;
+		const u8* data;
+		u32 size;
+	};
+	std::vector<Bank> banks = {{0, Memory::m_pRAM, Memory::REALRAM_SIZE}};
+	if (SConfig::GetInstance().bWii && Memory::m_pEXRAM)
+		banks.push_back({0x10000000, Memory::m_pEXRAM, Memory::EXRAM_SIZE});
+
+	size_t total_pages = 0;
+	for (const Bank& bank : banks)
+		total_pages += bank.size / MEMORY_CHECK_PAGE_SIZE;
+	if (s_memory_page_hashes.size() != total_pages)
+	{
+		s_memory_page_hashes.assign(total_pages, 0);
+		s_memory_page_epochs.assign(total_pages, 0);
+	}
+
+	// Without fastmem there are no write watches and every page counts as written
+	const u32 pages_per_region = MEMORY_CHECK_REGION_SIZE / MEMORY_CHECK_PAGE_SIZE;
+	std::vector<u64> digests;
+	size_t bank_page = 0;
+	for (const Bank& bank : banks)
+	{
+		u64* hashes = &s_memory_page_hashes[bank_page];
+		u64* epochs = &s_memory_page_epochs[bank_page];
+		auto is_written = [&](u32 page) {
+			return Memory::IsRangeModified(bank.address + page * MEMORY_CHECK_PAGE_SIZE,
+				MEMORY_CHECK_PAGE_SIZE, epochs[page]);
+		};
+
+		const u32 pages = bank.size / MEMORY_CHECK_PAGE_SIZE;
+		u32 page = 0;
+		while (page < pages)
+		{
+			if (!is_written(page))
+			{
+				page++;
+				continue;
+			}
+
+			// Written pages next to each other are watched again together, before they are read so
+			// that a write in between counts for the next check
+			u32 end = page + 1;
+			while (end < pages && is_written(end))
+				end++;
+			const u64 epoch = Memory::WatchRange(bank.address + page * MEMORY_CHECK_PAGE_SIZE,
+				(end - page) * MEMORY_CHECK_PAGE_SIZE);
+			for (; page < end; page++)
+			{
+				epochs[page] = epoch;
+				hashes[page] = XXH64(bank.data + page * MEMORY_CHECK_PAGE_SIZE, MEMORY_CHECK_PAGE_SIZE);
+			}
+		}
+
+		for (u32 region = 0; region < pages / pages_per_region; region++)
+			digests.push_back(XXH64(&hashes[region * pages_per_region], pages_per_region * sizeof(u64)));
+
+		bank_page += pages;
+	}
+	return digests;
+}
+
+void NetPlay::ResetMemoryDigests()
+{
+	s_memory_page_hashes.clear();
+	s_memory_page_epochs.clear();
+}
+
+u32 NetPlay::GetMemoryDigestAddress(u32 region)
+{
+	const u32 ram_regions = Memory::REALRAM_SIZE / MEMORY_CHECK_REGION_SIZE;
+	if (region < ram_regions)
+		return region * MEMORY_CHECK_REGION_SIZE;
+	return 0x10000000 + (region - ram_regions) * MEMORY_CHECK_REGION_SIZE;
+}
+
+std::string NetPlay::GetSyncedMemcardPath(int slot)
+{
+	std::lock_guard<std::mutex> lk(crit_synced_memcards);
+	return synced_memcard_paths[slot];
+}
+
 void NetPlay_Enable(NetPlayClient* const np)
 {
 	std::lock_guard<std::mutex> lk(crit_netplay_client);
@@ -34,6 +34,7 @@ public:
 	virtual void OnMsgStopGame() = 0;
 	virtual void OnPadBufferChanged(u32 buffer) = 0;
 	virtual void OnDesync(u32 frame, const std::string& player) = 0;
+	virtual void OnMemoryDesync(u32 frame, const std::string& player, u32 address, u32 size) = 0;
 	virtual void OnConnectionLost() = 0;
 	virtual void OnTraversalError(int error) = 0;
 	virtual bool IsRecording() = 0;
@@ -98,6 +99,7 @@ public:
 	int LocalPadToInGamePad(int localPad);
 
 	static void SendTimeBase();
+	static void SendMemoryDigests();
 	bool DoAllPlayersHaveGame();
 
 protected:
@@ -161,6 +163,8 @@ private:
 	void Disconnect();
 	bool Connect();
 	void ComputeMD5(const std::string& file_identifier);
+	void OnSaveSyncHashes(sf::Packet& packet);
+	void FinishSaveSync();
 	void DisplayPlayersPing();
 	u32 GetPlayersMaxPing() const;
 
@@ -179,6 +183,16 @@ private:
 	Common::Event m_wii_pad_event;
 
 	u32 m_timebase_frame = 0;
+
+	// Memory card being rebuilt from the chunks the host sends before the game starts
+	struct SaveSyncCard
+	{
+		std::vector<u8> data;
+		std::vector<u64> hashes;
+		std::string path;
+		size_t missing = 0;
+	};
+	std::array<SaveSyncCard, 2> m_sync_cards;
 };
 
 void NetPlay_Enable(NetPlayClient* const np);
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <array>
+#include <string>
 #include <vector>
 #include "Common/CommonTypes.h"
 #include "Core/HW/EXI_Device.h"
@@ -24,6 +25,7 @@ struct NetSettings
 	bool m_OCEnable;
 	float m_OCFactor;
 	TEXIDevices m_EXIDevice[2];
+	bool m_MemoryCheck;
 };
 
 extern NetSettings g_NetPlaySettings;
@@ -57,6 +59,8 @@ enum
 
 	NP_MSG_TIMEBASE = 0xB0,
 	NP_MSG_DESYNC_DETECTED = 0xB1,
+	NP_MSG_MEMORY_DIGESTS = 0xB2,
+	NP_MSG_MEMORY_DESYNC = 0xB3,
 
 	NP_MSG_COMPUTE_MD5 = 0xC0,
 	NP_MSG_MD5_PROGRESS = 0xC1,
@@ -72,6 +76,10 @@ enum
 	NP_MSG_PLAYER_PING_DATA = 0xE2,
 
 	NP_MSG_SYNC_GC_SRAM = 0xF0,
+	NP_MSG_SYNC_SAVE_HASHES = 0xF1,
+	NP_MSG_SYNC_SAVE_REQUEST = 0xF2,
+	NP_MSG_SYNC_SAVE_DATA = 0xF3,
+	NP_MSG_SYNC_SAVE_DONE = 0xF4,
 };
 
 enum
@@ -91,4 +99,21 @@ using PadMappingArray = std::array<PadMapping, 4>;
 namespace NetPlay
 {
 bool IsNetPlayRunning();
+
+// Before a game starts the clients get the host's memory cards. Only the chunks whose hashes
+// differ from the client's copy are sent, compressed.
+const u32 SAVE_SYNC_CHUNK_SIZE = 32 * 1024;
+std::vector<u64> GetSaveChunkHashes(const std::vector<u8>& data);
+// The host's card for the slot, or an empty string when the local card already matched
+std::string GetSyncedMemcardPath(int slot);
+
+// With the memory check on, the players compare digests of the emulated memory every
+// MEMORY_CHECK_INTERVAL frames, one for every MEMORY_CHECK_REGION_SIZE bytes of RAM and EXRAM.
+// Only the pages written since the last check are hashed again.
+const u32 MEMORY_CHECK_INTERVAL = 60;
+const u32 MEMORY_CHECK_REGION_SIZE = 1024 * 1024;
+std::vector<u64> GetMemoryDigests();
+void ResetMemoryDigests();
+// Guest address of the region a digest covers
+u32 GetMemoryDigestAddress(u32 region);
 }
@@ -3,9 +3,12 @@
 // Refer to the license.txt file included.
 
 #include "Core/NetPlayServer.h"
+#include <algorithm>
+#include <cmath>
 #include <memory>
 #include <string>
 #include <vector>
+#include <zlib.h>
 #include "Common/Common.h"
 #include "Common/ENetUtil.h"
 #include "Common/FileUtil.h"
@@ -13,6 +16,7 @@
 #include "Common/Logging/Log.h"
 #include "Common/MsgHandler.h"
 #include "Common/StringUtil.h"
+#include "Common/ThreadPool.h"
 #include "Core/ConfigManager.h"
 #include "Core/HW/EXI_DeviceIPL.h"
 #include "Core/HW/Sram.h"
@@ -29,6 +33,16 @@
 
 u64 g_netplay_initial_rtc = 1272737767;
 
+// Pads are polled about 120 times per second, each buffered state covers this much time
+static const double PAD_POLL_INTERVAL_MS = 1000.0 / 120;
+// Deviations above the mean latency that the automatic buffer covers, for roughly 1% of the
+// inputs arriving late
+static const double AUTO_BUFFER_STALL_QUANTILE = 2.33;
+// Pings in a row that have to allow a smaller buffer before it shrinks
+static const u32 AUTO_BUFFER_SHRINK_DELAY = 5;
+// Frames the confirmed timebases are kept for spectators, five minutes at 60 fps
+static const u32 SPECTATOR_CHECK_FRAMES = 60 * 60 * 5;
+
 NetPlayServer::~NetPlayServer()
 {
 	if (is_connected)
@@ -118,6 +132,9 @@ void NetPlayServer::ThreadFunc()
 			m_ping_timer.Start();
 			SendToClients(spac);
 			m_update_pings = false;
+
+			if (m_auto_buffer)
+				UpdateAutoPadBuffer();
 		}
 
 		ENetEvent netEvent;
@@ -364,6 +381,14 @@ unsigned int NetPlayServer::OnDisconnect(Client& player)
 		}
 	}
 
+	// a player that leaves during the memory card sync doesn't hold up the others
+	{
+		std::lock_guard<std::recursive_mutex> lkg(m_crit.game);
+		m_save_sync_pending.erase(pid);
+		if (m_save_sync_pending.empty() && m_start_game_packet)
+			SendAsyncToClients(std::move(m_start_game_packet));
+	}
+
 	sf::Packet spac;
 	spac << (MessageId)NP_MSG_PLAYER_LEAVE;
 	spac << pid;
@@ -424,6 +449,20 @@ void NetPlayServer::SetWiimoteMapping(const PadMappingArray& mappings)
 	UpdateWiimoteMapping();
 }
 
+// Clients without a controller only receive the inputs. They never hold up the others, so they
+// can watch a tournament without making it worse for the players.
+bool NetPlayServer::IsSpectator(PlayerId pid) const
+{
+	return std::find(m_pad_map.begin(), m_pad_map.end(), pid) == m_pad_map.end() &&
+		std::find(m_wiimote_map.begin(), m_wiimote_map.end(), pid) == m_wiimote_map.end();
+}
+
+size_t NetPlayServer::NumPlayingClients() const
+{
+	return std::count_if(m_players.begin(), m_players.end(),
+		[this](const std::pair<const PlayerId, Client>& entry) { return !IsSpectator(entry.first); });
+}
+
 // called from ---GUI--- thread and ---NETPLAY--- thread
 void NetPlayServer::UpdatePadMapping()
 {
@@ -463,6 +502,79 @@ void NetPlayServer::AdjustPadBufferSize(unsigned int size)
 	SendAsyncToClients(std::move(spac));
 }
 
+// called from ---GUI--- thread
+void NetPlayServer::SetAutoPadBuffer(bool enabled)
+{
+	std::lock_guard<std::recursive_mutex> lkg(m_crit.game);
+	m_auto_buffer = enabled;
+	m_auto_buffer_lower_count = 0;
+}
+
+// called from ---NETPLAY--- thread
+unsigned int NetPlayServer::ComputeAutoPadBufferSize()
+{
+	// ENet keeps the mean round trip time of every peer and its mean deviation. Half of them are
+	// taken as the mean and the deviation of the time an input takes to reach the host.
+	std::vector<std::pair<double, double>> legs;
+	for (const auto& entry : m_players)
+	{
+		// spectators only watch, nobody waits for their inputs
+		if (IsSpectator(entry.first))
+			continue;
+		const ENetPeer* peer = entry.second.socket;
+		legs.emplace_back(peer->roundTripTime / 2.0, peer->roundTripTimeVariance / 2.0);
+	}
+
+	// Inputs go through the host, so a pair of players sees the sum of both legs. The buffer has to
+	// cover the slowest pair, with a margin for the jitter.
+	double required_ms = 0.0;
+	for (size_t i = 0; i < legs.size(); i++)
+	{
+		for (size_t j = i + 1; j < legs.size(); j++)
+		{
+			const double mean = legs[i].first + legs[j].first;
+			const double deviation =
+				std::sqrt(legs[i].second * legs[i].second + legs[j].second * legs[j].second);
+			required_ms = std::max(required_ms, mean + AUTO_BUFFER_STALL_QUANTILE * deviation);
+		}
+	}
+
+	return std::max(1u, static_cast<unsigned int>(std::ceil(required_ms / PAD_POLL_INTERVAL_MS)));
+}
+
+// called from ---NETPLAY--- thread
+void NetPlayServer::UpdateAutoPadBuffer()
+{
+	std::lock_guard<std::recursive_mutex> lkg(m_crit.game);
+	unsigned int size;
+	{
+		std::lock_guard<std::recursive_mutex> lkp(m_crit.players);
+		if (NumPlayingClients() < 2)
+			return;
+		size = ComputeAutoPadBufferSize();
+	}
+
+	// Stalls are worse than latency: grow right away, but only shrink one step at a time once the
+	// connections have been faster for a while.
+	if (size > m_target_buffer_size)
+	{
+		m_auto_buffer_lower_count = 0;
+		AdjustPadBufferSize(size);
+	}
+	else if (size < m_target_buffer_size)
+	{
+		if (++m_auto_buffer_lower_count >= AUTO_BUFFER_SHRINK_DELAY)
+		{
+			m_auto_buffer_lower_count = 0;
+			AdjustPadBufferSize(m_target_buffer_size - 1);
+		}
+	}
+	else
+	{
+		m_auto_buffer_lower_count = 0;
+	}
+}
+
 void NetPlayServer::SendAsyncToClients(std::unique_ptr<sf::Packet> packet)
 {
 	{
@@ -584,6 +696,43 @@ unsigned int NetPlayServer::OnData(sf::Packet& packet, Client& player)
 	}
 	break;
 
+	case NP_MSG_SYNC_SAVE_REQUEST:
+	{
+		u8 slot = 0;
+		u32 count = 0;
+		packet >> slot;
+		packet >> count;
+
+		std::lock_guard<std::recursive_mutex> lkg(m_crit.game);
+		if (slot >= m_sync_cards.size() || count > m_sync_cards[slot].hashes.size())
+			return 1;
+
+		std::vector<u32> chunks(count);
+		for (u32& chunk : chunks)
+		{
+			packet >> chunk;
+			if (chunk >= m_sync_cards[slot].hashes.size())
+				return 1;
+		}
+		std::sort(chunks.begin(), chunks.end());
+		chunks.erase(std::unique(chunks.begin(), chunks.end()), chunks.end());
+
+		SendSaveChunks(player, slot, chunks);
+	}
+	break;
+
+	case NP_MSG_SYNC_SAVE_DONE:
+	{
+		std::lock_guard<std::recursive_mutex> lkg(m_crit.game);
+		m_save_sync_pending.erase(player.pid);
+		if (m_save_sync_pending.empty() && m_start_game_packet)
+		{
+			SendAsyncToClients(std::move(m_start_game_packet));
+			m_sync_cards = {};
+		}
+	}
+	break;
+
 	case NP_MSG_STOP_GAME:
 	{
 		// tell clients to stop game
@@ -625,9 +774,29 @@ unsigned int NetPlayServer::OnData(sf::Packet& packet, Client& player)
 			break;
 
 		u64 timebase = x | ((u64)y << 32);
+
+		// Spectators may be far behind, so they are checked against what the players agreed on
+		// instead of holding up the check. A desynced spectator is only told itself.
+		if (IsSpectator(player.pid))
+		{
+			auto confirmed = m_confirmed_timebases.find(frame);
+			if (confirmed != m_confirmed_timebases.end() && confirmed->second != timebase &&
+				!player.desync_reported)
+			{
+				player.desync_reported = true;
+
+				sf::Packet spac;
+				spac << (MessageId)NP_MSG_DESYNC_DETECTED;
+				spac << static_cast<int>(player.pid);
+				spac << frame;
+				Send(player.socket, spac);
+			}
+			break;
+		}
+
 		std::vector<std::pair<PlayerId, u64>>& timebases = m_timebase_by_frame[frame];
 		timebases.emplace_back(player.pid, timebase);
-		if (timebases.size() >= m_players.size())
+		if (timebases.size() >= NumPlayingClients())
 		{
 			// we have all records for this frame
 
@@ -656,11 +825,82 @@ unsigned int NetPlayServer::OnData(sf::Packet& packet, Client& player)
 
 				m_desync_detected = true;
 			}
+			else
+			{
+				m_confirmed_timebases.emplace(frame, timebases[0].second);
+				if (frame >= SPECTATOR_CHECK_FRAMES)
+				{
+					m_confirmed_timebases.erase(m_confirmed_timebases.begin(),
+						m_confirmed_timebases.lower_bound(frame - SPECTATOR_CHECK_FRAMES));
+				}
+			}
 			m_timebase_by_frame.erase(frame);
 		}
 	}
 	break;
 
+	case NP_MSG_MEMORY_DIGESTS:
+	{
+		u32 frame, count;
+		packet >> frame;
+		packet >> count;
+
+		// Spectators aren't checked, they only hash memory because they run the same code
+		if (m_desync_detected || IsSpectator(player.pid))
+			break;
+
+		std::vector<u64> digests(count);
+		for (u64& digest : digests)
+		{
+			u32 low, high;
+			packet >> low >> high;
+			digest = low | (static_cast<u64>(high) << 32);
+		}
+
+		auto& reports = m_memory_digests_by_frame[frame];
+		reports.emplace_back(player.pid, std::move(digests));
+		if (reports.size() < NumPlayingClients())
+			break;
+
+		// The first region that differs, and the player whose digest of it nobody else has
+		size_t regions = 0;
+		for (const auto& report : reports)
+			regions = std::max(regions, report.second.size());
+		for (u32 region = 0; region < regions; region++)
+		{
+			auto digest = [region](const std::pair<PlayerId, std::vector<u64>>& report) {
+				return region < report.second.size() ? report.second[region] : 0;
+			};
+			if (std::all_of(reports.begin(), reports.end(),
+				[&](const auto& report) { return digest(report) == digest(reports[0]); }))
+				continue;
+
+			int pid_to_blame = -1;
+			for (const auto& report : reports)
+			{
+				if (std::all_of(reports.begin(), reports.end(), [&](const auto& other) {
+					return other.first == report.first || digest(other) != digest(report);
+				}))
+				{
+					pid_to_blame = report.first;
+					break;
+				}
+			}
+
+			sf::Packet spac;
+			spac << (MessageId)NP_MSG_MEMORY_DESYNC;
+			spac << pid_to_blame;
+			spac << frame;
+			spac << region;
+			SendToClients(spac);
+
+			m_desync_detected = true;
+			break;
+		}
+		m_memory_digests_by_frame.erase(frame);
+	}
+	break;
+
 	case NP_MSG_MD5_PROGRESS:
 	{
 		int progress;
@@ -781,7 +1021,14 @@ void NetPlayServer::SetNetSettings(const NetSettings& settings)
 bool NetPlayServer::StartGame()
 {
 	m_timebase_by_frame.clear();
+	m_confirmed_timebases.clear();
+	m_memory_digests_by_frame.clear();
 	m_desync_detected = false;
+	{
+		std::lock_guard<std::recursive_mutex> lkp(m_crit.players);
+		for (auto& entry : m_players)
+			entry.second.desync_reported = false;
+	}
 	std::lock_guard<std::recursive_mutex> lkg(m_crit.game);
 	m_current_game = Common::Timer::GetTimeMs();
 
@@ -811,16 +1058,103 @@ bool NetPlayServer::StartGame()
 	*spac << m_settings.m_OCFactor;
 	*spac << m_settings.m_EXIDevice[0];
 	*spac << m_settings.m_EXIDevice[1];
+	*spac << m_settings.m_MemoryCheck;
 	*spac << (u32)g_netplay_initial_rtc;
 	*spac << (u32)(g_netplay_initial_rtc >> 32);
 
-	SendAsyncToClients(std::move(spac));
+	// the game starts once every client has the host's memory cards
+	m_start_game_packet = std::move(spac);
+	if (!PrepareSaveSync())
+		SendAsyncToClients(std::move(m_start_game_packet));
 
 	m_is_running = true;
 
 	return true;
 }
 
+// called from ---GUI--- thread
+bool NetPlayServer::PrepareSaveSync()
+{
+	std::lock_guard<std::recursive_mutex> lkp(m_crit.players);
+	m_save_sync_pending.clear();
+	for (const auto& entry : m_players)
+		m_save_sync_pending.insert(entry.first);
+	if (m_save_sync_pending.empty())
+		return false;
+
+	auto spac = std::make_unique<sf::Packet>();
+	*spac << static_cast<MessageId>(NP_MSG_SYNC_SAVE_HASHES);
+	for (int slot = 0; slot < 2; slot++)
+	{
+		SaveSyncCard& card = m_sync_cards[slot];
+		card = SaveSyncCard();
+
+		const std::string& path =
+			slot == 0 ? SConfig::GetInstance().m_strMemoryCardA : SConfig::GetInstance().m_strMemoryCardB;
+		std::string contents;
+		const bool has_card = m_settings.m_EXIDevice[slot] == EXIDEVICE_MEMORYCARD &&
+			File::ReadFileToString(path, contents) && !contents.empty();
+		*spac << has_card;
+		if (!has_card)
+			continue;
+
+		card.data.assign(contents.begin(), contents.end());
+		card.hashes = NetPlay::GetSaveChunkHashes(card.data);
+		card.compressed.resize(card.hashes.size());
+		*spac << static_cast<u32>(card.data.size());
+		for (u64 hash : card.hashes)
+			*spac << static_cast<u32>(hash) << static_cast<u32>(hash >> 32);
+	}
+
+	SendAsyncToClients(std::move(spac));
+	return true;
+}
+
+// called from ---NETPLAY--- thread
+void NetPlayServer::SendSaveChunks(Client& player, int slot, const std::vector<u32>& chunks)
+{
+	SaveSyncCard& card = m_sync_cards[slot];
+
+	// the chunks no client asked for yet are compressed on all cores
+	std::vector<u32> uncompressed;
+	for (u32 chunk : chunks)
+	{
+		if (card.compressed[chunk].empty())
+			uncompressed.push_back(chunk);
+	}
+
+	Common::ParallelLoop compress_loop;
+	compress_loop.Loop([&](int lower, int upper) {
+		for (int i = lower; i < upper; i++)
+		{
+			const u32 chunk = uncompressed[i];
+			const size_t offset = static_cast<size_t>(chunk) * NetPlay::SAVE_SYNC_CHUNK_SIZE;
+			const uLong size = static_cast<uLong>(
+				std::min<size_t>(NetPlay::SAVE_SYNC_CHUNK_SIZE, card.data.size() - offset));
+			uLongf compressed_size = compressBound(size);
+			std::string& out = card.compressed[chunk];
+			out.resize(compressed_size);
+			if (compress2(reinterpret_cast<Bytef*>(&out[0]), &compressed_size, &card.data[offset], size,
+				Z_BEST_COMPRESSION) != Z_OK)
+			{
+				compressed_size = 0;
+			}
+			out.resize(compressed_size);
+		}
+	}, 0, static_cast<int>(uncompressed.size()), 1);
+
+	// ENet sends to every peer at once, so the clients get their chunks in parallel
+	for (u32 chunk : chunks)
+	{
+		sf::Packet spac;
+		spac << static_cast<MessageId>(NP_MSG_SYNC_SAVE_DATA);
+		spac << static_cast<u8>(slot);
+		spac << chunk;
+		spac << card.compressed[chunk];
+		Send(player.socket, spac);
+	}
+}
+
 // called from multiple threads
 void NetPlayServer::SendToClients(sf::Packet& packet, const PlayerId skip_pid)
 {
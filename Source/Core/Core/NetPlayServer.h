@@ -5,9 +5,12 @@
 #pragma once
 
 #include <SFML/Network/Packet.hpp>
+#include <array>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <queue>
+#include <set>
 #include <sstream>
 #include <thread>
 #include <unordered_map>
@@ -47,6 +50,8 @@ public:
 	void SetWiimoteMapping(const PadMappingArray& mappings);
 
 	void AdjustPadBufferSize(unsigned int size);
+	// Sizes the pad buffer from the round trip times of the players
+	void SetAutoPadBuffer(bool enabled);
 
 	void KickPlayer(PlayerId player);
 
@@ -74,6 +79,7 @@ private:
 		ENetPeer* socket;
 		u32 ping;
 		u32 current_game;
+		bool desync_reported = false;
 
 		bool operator==(const Client& other) const { return this == &other; }
 	};
@@ -89,6 +95,12 @@ private:
 	void OnConnectFailed(u8) override {}
 	void UpdatePadMapping();
 	void UpdateWiimoteMapping();
+	bool IsSpectator(PlayerId pid) const;
+	size_t NumPlayingClients() const;
+	bool PrepareSaveSync();
+	void SendSaveChunks(Client& player, int slot, const std::vector<u32>& chunks);
+	unsigned int ComputeAutoPadBufferSize();
+	void UpdateAutoPadBuffer();
 	std::vector<std::pair<std::string, std::string>> GetInterfaceListInternal();
 
 	NetSettings m_settings;
@@ -100,12 +112,30 @@ private:
 	bool m_update_pings = false;
 	u32 m_current_game = 0;
 	unsigned int m_target_buffer_size = 0;
+	bool m_auto_buffer = false;
+	u32 m_auto_buffer_lower_count = 0;
 	PadMappingArray m_pad_map;
 	PadMappingArray m_wiimote_map;
 
 	std::map<PlayerId, Client> m_players;
 
+	// The host's memory cards while the clients sync them, the chunks are compressed when a client
+	// first asks for them
+	struct SaveSyncCard
+	{
+		std::vector<u8> data;
+		std::vector<u64> hashes;
+		std::vector<std::string> compressed;
+	};
+	std::array<SaveSyncCard, 2> m_sync_cards;
+	std::set<PlayerId> m_save_sync_pending;
+	std::unique_ptr<sf::Packet> m_start_game_packet;
+
 	std::unordered_map<u32, std::vector<std::pair<PlayerId, u64>>> m_timebase_by_frame;
+	// Timebases the players agreed on, kept a while for the spectators that lag behind
+	std::map<u32, u64> m_confirmed_timebases;
+	std::unordered_map<u32, std::vector<std::pair<PlayerId, std::vector<u64>>>>
+		m_memory_digests_by_frame;
 	bool m_desync_detected;
 
 	struct
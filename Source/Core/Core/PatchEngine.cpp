@@ -43,6 +43,8 @@ const char* PatchTypeStrings[] = {
 
 static std::vector<Patch> onFrame;
 static std::map<u32, int> speedHacks;
+// Sorted addresses of the active entries of onFrame
+static std::vector<u32> s_patched_addresses;
 
 void LoadPatchSection(const std::string& section, std::vector<Patch>& patches, IniFile& globalIni,
 	IniFile& localIni)
@@ -164,6 +166,15 @@ void LoadPatches()
 	IniFile localIni = SConfig::GetInstance().LoadLocalGameIni();
 
 	LoadPatchSection("OnFrame", onFrame, globalIni, localIni);
+	s_patched_addresses.clear();
+	for (const Patch& patch : onFrame)
+	{
+		if (!patch.active)
+			continue;
+		for (const PatchEntry& entry : patch.entries)
+			s_patched_addresses.push_back(entry.address);
+	}
+	std::sort(s_patched_addresses.begin(), s_patched_addresses.end());
 	ActionReplay::LoadAndApplyCodes(globalIni, localIni);
 
 	// lil silly
@@ -184,16 +195,21 @@ static void ApplyPatches(const std::vector<Patch>& patches)
 			{
 				u32 addr = entry.address;
 				u32 value = entry.value;
+				// Memory that already holds the value isn't written again, a write can fault on a
+				// write watched page and mark the textures and watches there as changed.
 				switch (entry.type)
 				{
 				case PATCH_8BIT:
-					PowerPC::HostWrite_U8((u8)value, addr);
+					if (PowerPC::HostRead_U8(addr) != (u8)value)
+						PowerPC::HostWrite_U8((u8)value, addr);
 					break;
 				case PATCH_16BIT:
-					PowerPC::HostWrite_U16((u16)value, addr);
+					if (PowerPC::HostRead_U16(addr) != (u16)value)
+						PowerPC::HostWrite_U16((u16)value, addr);
 					break;
 				case PATCH_32BIT:
-					PowerPC::HostWrite_U32(value, addr);
+					if (PowerPC::HostRead_U32(addr) != value)
+						PowerPC::HostWrite_U32(value, addr);
 					break;
 				default:
 					// unknown patchtype
@@ -255,9 +271,27 @@ bool ApplyFramePatches()
 	return true;
 }
 
+void ApplyPatchesInRange(u32 address, u32 size)
+{
+	if (s_patched_addresses.empty() || size == 0)
+		return;
+
+	// An entry is at most 4 bytes, so one starting up to 3 bytes before the range reaches into it
+	const u32 first = address >= 3 ? address - 3 : 0;
+	auto it = std::lower_bound(s_patched_addresses.begin(), s_patched_addresses.end(), first);
+	if (it == s_patched_addresses.end() || *it - first >= size + 3)
+		return;
+
+	// Patch addresses are effective addresses
+	if (!UReg_MSR(MSR).DR)
+		return;
+	ApplyPatches(onFrame);
+}
+
 void Shutdown()
 {
 	onFrame.clear();
+	s_patched_addresses.clear();
 	speedHacks.clear();
 	ActionReplay::ApplyCodes({});
 	Gecko::Shutdown();
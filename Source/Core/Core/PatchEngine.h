@@ -44,6 +44,9 @@ void LoadPatchSection(const std::string& section, std::vector<Patch>& patches, I
 	IniFile& localIni);
 void LoadPatches();
 bool ApplyFramePatches();
+// Applies the frame patches right away when code in the range is invalidated, so code that is
+// loaded or rewritten there doesn't run unpatched until the next frame
+void ApplyPatchesInRange(u32 address, u32 size);
 void Shutdown();
 
 inline int GetPatchTypeCharLength(PatchType type)
@@ -32,11 +32,89 @@ void CachedInterpreter::Shutdown()
 	JitBaseBlockCache::Shutdown();
 }
 
+static inline void SetPC(u32 address)
+{
+	PC = address;
+	NPC = address + 4;
+}
+
+void CachedInterpreter::RunEndBlock(const Instruction& code)
+{
+	SetPC(code.address);
+	code.common_callback(UGeckoInstruction(code.data));
+	PC = NPC;
+	PowerPC::ppcState.downcount -= code.downcount;
+}
+
+bool CachedInterpreter::RunMemcheck(const Instruction& code)
+{
+	SetPC(code.address);
+	code.common_callback(UGeckoInstruction(code.data));
+	if (PowerPC::ppcState.Exceptions & EXCEPTION_DSI)
+	{
+		PowerPC::CheckExceptions();
+		PowerPC::ppcState.downcount -= code.downcount;
+		return true;
+	}
+	return false;
+}
+
+bool CachedInterpreter::RunCheckFPU(const Instruction& code)
+{
+	SetPC(code.address);
+	UReg_MSR& msr = (UReg_MSR&)MSR;
+	if (!msr.FP)
+	{
+		PowerPC::ppcState.Exceptions |= EXCEPTION_FPU_UNAVAILABLE;
+		PowerPC::CheckExceptions();
+		PowerPC::ppcState.downcount -= code.downcount;
+		return true;
+	}
+	return false;
+}
+
+// Direct threaded dispatch with computed gotos where the compiler supports them, so every
+// handler has its own indirect jump to the next one instead of sharing the switch's.
+#if defined(__GNUC__) || defined(__clang__)
+#define CACHED_INTERPRETER_THREADED_DISPATCH
+#endif
+
 void CachedInterpreter::ExecuteOneBlock()
 {
 	const u8* normal_entry = JitBaseBlockCache::Dispatch();
 	const Instruction* code = reinterpret_cast<const Instruction*>(normal_entry);
 
+#ifdef CACHED_INTERPRETER_THREADED_DISPATCH
+	static void* const handlers[] = { &&abort, &&common, &&end_block, &&memcheck, &&check_fpu };
+#define DISPATCH() goto* handlers[code->type]
+#define NEXT()                                                                                     \
+	do                                                                                               \
+	{                                                                                                \
+		++code;                                                                                        \
+		DISPATCH();                                                                                    \
+	} while (0)
+
+	DISPATCH();
+common:
+	code->common_callback(UGeckoInstruction(code->data));
+	NEXT();
+end_block:
+	RunEndBlock(*code);
+	return;
+memcheck:
+	if (RunMemcheck(*code))
+		return;
+	NEXT();
+check_fpu:
+	if (RunCheckFPU(*code))
+		return;
+	NEXT();
+abort:
+	return;
+
+#undef NEXT
+#undef DISPATCH
+#else
 	for (; code->type != Instruction::INSTRUCTION_ABORT; ++code)
 	{
 		switch (code->type)
@@ -45,8 +123,17 @@ void CachedInterpreter::ExecuteOneBlock()
 			code->common_callback(UGeckoInstruction(code->data));
 			break;
 
-		case Instruction::INSTRUCTION_TYPE_CONDITIONAL:
-			if (code->conditional_callback(code->data))
+		case Instruction::INSTRUCTION_TYPE_END_BLOCK:
+			RunEndBlock(*code);
+			return;
+
+		case Instruction::INSTRUCTION_TYPE_MEMCHECK:
+			if (RunMemcheck(*code))
+				return;
+			break;
+
+		case Instruction::INSTRUCTION_TYPE_CHECK_FPU:
+			if (RunCheckFPU(*code))
 				return;
 			break;
 
@@ -55,6 +142,7 @@ void CachedInterpreter::ExecuteOneBlock()
 			break;
 		}
 	}
+#endif
 }
 
 void CachedInterpreter::Run()
@@ -87,8 +175,7 @@ static void EndBlock(UGeckoInstruction data)
 
 static void WritePC(UGeckoInstruction data)
 {
-	PC = data.hex;
-	NPC = data.hex + 4;
+	SetPC(data.hex);
 }
 
 static void WriteBrokenBlockNPC(UGeckoInstruction data)
@@ -96,30 +183,6 @@ static void WriteBrokenBlockNPC(UGeckoInstruction data)
 	NPC = data.hex;
 }
 
-static bool CheckFPU(u32 data)
-{
-	UReg_MSR& msr = (UReg_MSR&)MSR;
-	if (!msr.FP)
-	{
-		PowerPC::ppcState.Exceptions |= EXCEPTION_FPU_UNAVAILABLE;
-		PowerPC::CheckExceptions();
-		PowerPC::ppcState.downcount -= data;
-		return true;
-	}
-	return false;
-}
-
-static bool CheckDSI(u32 data)
-{
-	if (PowerPC::ppcState.Exceptions & EXCEPTION_DSI)
-	{
-		PowerPC::CheckExceptions();
-		PowerPC::ppcState.downcount -= data;
-		return true;
-	}
-	return false;
-}
-
 void CachedInterpreter::Jit(u32 address)
 {
 	if (m_code.size() >= CODE_SIZE / sizeof(Instruction) - 0x1000 || IsFull() ||
@@ -167,14 +230,15 @@ void CachedInterpreter::Jit(u32 address)
 				int flags = HLE::GetFunctionFlagsByIndex(function);
 				if (HLE::IsEnabled(flags))
 				{
-					m_code.emplace_back(WritePC, ops[i].address);
-					m_code.emplace_back(Interpreter::HLEFunction, ops[i].inst);
 					if (type == HLE::HLE_HOOK_REPLACE)
 					{
-						m_code.emplace_back(EndBlock, js.downcountAmount);
+						m_code.emplace_back(Instruction::INSTRUCTION_TYPE_END_BLOCK, Interpreter::HLEFunction,
+							ops[i].inst, ops[i].address, js.downcountAmount);
 						m_code.emplace_back();
 						break;
 					}
+					m_code.emplace_back(WritePC, ops[i].address);
+					m_code.emplace_back(Interpreter::HLEFunction, ops[i].inst);
 				}
 			}
 		}
@@ -185,20 +249,30 @@ void CachedInterpreter::Jit(u32 address)
 			bool endblock = (ops[i].opinfo->flags & FL_ENDBLOCK) != 0;
 			bool memcheck = (ops[i].opinfo->flags & FL_LOADSTORE) && jo.memcheck;
 
+			const Instruction::CommonCallback op = GetInterpreterOp(ops[i].inst);
 			if (check_fpu)
 			{
-				m_code.emplace_back(WritePC, ops[i].address);
-				m_code.emplace_back(CheckFPU, js.downcountAmount);
+				m_code.emplace_back(Instruction::INSTRUCTION_TYPE_CHECK_FPU, nullptr, ops[i].inst,
+					ops[i].address, js.downcountAmount);
 				js.firstFPInstructionFound = true;
 			}
 
-			if (endblock || memcheck)
-				m_code.emplace_back(WritePC, ops[i].address);
-			m_code.emplace_back(GetInterpreterOp(ops[i].inst), ops[i].inst);
 			if (memcheck)
-				m_code.emplace_back(CheckDSI, js.downcountAmount);
-			if (endblock)
-				m_code.emplace_back(EndBlock, js.downcountAmount);
+			{
+				m_code.emplace_back(Instruction::INSTRUCTION_TYPE_MEMCHECK, op, ops[i].inst,
+					ops[i].address, js.downcountAmount);
+				if (endblock)
+					m_code.emplace_back(EndBlock, js.downcountAmount);
+			}
+			else if (endblock)
+			{
+				m_code.emplace_back(Instruction::INSTRUCTION_TYPE_END_BLOCK, op, ops[i].inst,
+					ops[i].address, js.downcountAmount);
+			}
+			else
+			{
+				m_code.emplace_back(op, ops[i].inst);
+			}
 		}
 	}
 	if (code_block.m_broken)
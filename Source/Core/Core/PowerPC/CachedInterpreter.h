@@ -25,6 +25,7 @@ public:
 	void SingleStep() override;
 
 	void Jit(u32 address) override;
+	bool HasColdBlockTier() const override { return false; }
 
 	JitBaseBlockCache* GetBlockCache() override { return this; }
 	const char* GetName() override { return "Cached Interpreter"; }
@@ -34,27 +35,41 @@ private:
 	struct Instruction
 	{
 		typedef void(*CommonCallback)(UGeckoInstruction);
-		typedef bool(*ConditionalCallback)(u32 data);
+
+		// The types besides INSTRUCTION_TYPE_COMMON are superinstructions, which fuse the
+		// bookkeeping around an interpreter op into the op so it only takes a single dispatch.
+		enum Type : u32
+		{
+			INSTRUCTION_ABORT,
+			INSTRUCTION_TYPE_COMMON,
+			// Writes PC, runs the op and leaves the block
+			INSTRUCTION_TYPE_END_BLOCK,
+			// Writes PC, runs the op and leaves the block on a DSI
+			INSTRUCTION_TYPE_MEMCHECK,
+			// Writes PC and leaves the block if the FPU is disabled
+			INSTRUCTION_TYPE_CHECK_FPU,
+		};
 
 		Instruction() : type(INSTRUCTION_ABORT){};
 		Instruction(const CommonCallback c, UGeckoInstruction i)
 			: common_callback(c), data(i.hex), type(INSTRUCTION_TYPE_COMMON){};
-		Instruction(const ConditionalCallback c, u32 d)
-			: conditional_callback(c), data(d), type(INSTRUCTION_TYPE_CONDITIONAL){};
+		Instruction(Type t, const CommonCallback c, UGeckoInstruction i, u32 address_,
+			u32 downcount_)
+			: common_callback(c), data(i.hex), type(t), address(address_), downcount(downcount_){};
 
-		union {
-			const CommonCallback common_callback;
-			const ConditionalCallback conditional_callback;
-		};
-		u32 data;
-		enum
-		{
-			INSTRUCTION_ABORT,
-			INSTRUCTION_TYPE_COMMON,
-			INSTRUCTION_TYPE_CONDITIONAL,
-		} type;
+		const CommonCallback common_callback = nullptr;
+		u32 data = 0;
+		Type type;
+		u32 address = 0;
+		// The cycles of the block up to and including this instruction
+		u32 downcount = 0;
 	};
 
+	// The superinstructions which can continue return true when they leave the block
+	static void RunEndBlock(const Instruction& code);
+	static bool RunMemcheck(const Instruction& code);
+	static bool RunCheckFPU(const Instruction& code);
+
 	const u8* GetCodePtr() { return (u8*)(m_code.data() + m_code.size()); }
 	void ExecuteOneBlock();
 
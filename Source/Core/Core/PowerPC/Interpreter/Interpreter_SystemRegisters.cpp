@@ -176,6 +176,7 @@ static void SetSR(int index, u32 value)
 	DEBUG_LOG(POWERPC, "%08x: MMU: Segment register %i set to %08x", PowerPC::ppcState.pc, index,
 		value);
 	PowerPC::ppcState.sr[index] = value;
+	PowerPC::ClearJitTLB();
 }
 
 void Interpreter::mtsr(UGeckoInstruction _inst)
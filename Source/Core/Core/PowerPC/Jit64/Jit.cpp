@@ -2,6 +2,8 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <array>
 #include <map>
 #include <string>
 
@@ -14,6 +16,7 @@
 #include "Common/Logging/Log.h"
 #include "Common/MemoryUtil.h"
 #include "Common/StringUtil.h"
+#include "Common/Trace.h"
 #include "Common/x64ABI.h"
 #include "Core/Core.h"
 #include "Core/CoreTiming.h"
@@ -261,6 +264,7 @@ void Jit64::ClearCache()
 	ClearCodeSpace();
 	Clear();
 	UpdateMemoryOptions();
+	m_branch_profiles.clear();
 }
 
 void Jit64::Shutdown()
@@ -287,6 +291,8 @@ void Jit64::FallBackToInterpreter(UGeckoInstruction inst)
 	ABI_PushRegistersAndAdjustStack({}, 0);
 	ABI_CallFunctionC(instr, inst.hex);
 	ABI_PopRegistersAndAdjustStack({}, 0);
+	// The interpreter sets the host rounding mode itself
+	js.knownRoundingMode = -1;
 	if (js.op->opinfo->flags & FL_ENDBLOCK)
 	{
 		if (js.isLastInstruction)
@@ -314,6 +320,7 @@ void Jit64::HLEFunction(UGeckoInstruction _inst)
 	ABI_PushRegistersAndAdjustStack({}, 0);
 	ABI_CallFunctionCC(HLE::Execute, js.compilerPC, _inst.hex);
 	ABI_PopRegistersAndAdjustStack({}, 0);
+	js.knownRoundingMode = -1;
 }
 
 void Jit64::DoNothing(UGeckoInstruction _inst)
@@ -388,6 +395,41 @@ void Jit64::WriteExit(u32 destination, bool bl, u32 after)
 	JustWriteExit(destination, bl, after);
 }
 
+bool Jit64::IsLoopExit(u32 destination, bool bl) const
+{
+	return m_loop_head && !bl && destination == js.blockStart;
+}
+
+void Jit64::WriteLoopExit()
+{
+	// Only the taken path of a conditional branch goes through here, the code after it
+	// continues with the current allocation.
+	const RegCache::State gpr_state = gpr.GetState();
+	const RegCache::State fpr_state = fpr.GetState();
+
+	gpr.BindToLoopHead(m_loop_gpr_mapping);
+	fpr.BindToLoopHead(m_loop_fpr_mapping);
+
+	if (jo.optimizeGatherPipe && js.fifoBytesSinceCheck > 0)
+	{
+		BitSet32 registersInUse = CallerSavedRegistersInUse();
+		ABI_PushRegistersAndAdjustStack(registersInUse, 0);
+		ABI_CallFunction(GPFifo::FastCheckGatherPipe);
+		ABI_PopRegistersAndAdjustStack(registersInUse, 0);
+	}
+
+	SUB(32, PPCSTATE(downcount), Imm32(js.downcountAmount));
+	J_CC(CC_G, m_loop_head);
+
+	// Out of cycles, the checked entry of the block sends us to CoreTiming
+	gpr.Flush();
+	fpr.Flush();
+	JustWriteExit(js.blockStart, false, 0);
+
+	gpr.SetState(gpr_state);
+	fpr.SetState(fpr_state);
+}
+
 void Jit64::JustWriteExit(u32 destination, bool bl, u32 after)
 {
 	// If nobody has taken care of this yet (this can be removed when all branches are done)
@@ -530,6 +572,7 @@ void Jit64::Trace()
 
 void Jit64::Jit(u32 em_address)
 {
+	TRACE_ZONE("Jit64::Jit");
 	if (m_cleanup_after_stackfault)
 	{
 		ClearCache();
@@ -567,6 +610,9 @@ void Jit64::Jit(u32 em_address)
 				analyzer.ClearOption(PPCAnalyst::PPCAnalyzer::OPTION_BRANCH_MERGE);
 				analyzer.ClearOption(PPCAnalyst::PPCAnalyzer::OPTION_CROR_MERGE);
 				analyzer.ClearOption(PPCAnalyst::PPCAnalyzer::OPTION_CARRY_MERGE);
+				analyzer.ClearOption(PPCAnalyst::PPCAnalyzer::OPTION_DEAD_WRITE_ELIMINATION);
+				analyzer.ClearOption(PPCAnalyst::PPCAnalyzer::OPTION_LEAF_INLINE);
+				analyzer.ClearOption(PPCAnalyst::PPCAnalyzer::OPTION_IDLE_LOOP_DETECTION);
 			}
 			Trace();
 		}
@@ -596,6 +642,7 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer* code_buf, JitBloc
 {
 	js.firstFPInstructionFound = false;
 	js.isLastInstruction = false;
+	js.knownRoundingMode = -1;
 	js.blockStart = em_address;
 	js.fifoBytesSinceCheck = 0;
 	js.mustCheckFifo = false;
@@ -637,7 +684,14 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer* code_buf, JitBloc
 		b->ticStart = 0;
 		b->ticStop = 0;
 		// get start tic
-		PROFILER_QUERY_PERFORMANCE_COUNTER(&b->ticStart);
+		if (Profiler::UseHostCycles())
+		{
+			PROFILER_READ_TIME_STAMP_COUNTER(&b->ticStart);
+		}
+		else
+		{
+			PROFILER_QUERY_PERFORMANCE_COUNTER(&b->ticStart);
+		}
 	}
 #if defined(_DEBUG) || defined(DEBUGFAST) || defined(NAN_CHECK)
 	// should help logged stack-traces become more accurate
@@ -690,7 +744,17 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer* code_buf, JitBloc
 		}
 	}
 
-	if (js.noSpeculativeConstantsAddresses.find(js.blockStart) ==
+	StartBranchProfile(ops, code_block.m_num_instructions);
+
+	// Speculative constants are only checked on entry, a loop can't keep them
+	m_loop_head = nullptr;
+	m_loop_gprs = BitSet32(0);
+	m_loop_fprs = BitSet32(0);
+	if (CanKeepRegistersAcrossLoop(code_block, ops))
+	{
+		StartLoop(ops, code_block.m_num_instructions);
+	}
+	else if (js.noSpeculativeConstantsAddresses.find(js.blockStart) ==
 		js.noSpeculativeConstantsAddresses.end())
 	{
 		IntializeSpeculativeConstants();
@@ -715,12 +779,21 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer* code_buf, JitBloc
 			if (Profiler::g_ProfileBlocks)
 			{
 				// WARNING - cmp->branch merging will screw this up.
-				PROFILER_VPUSH;
-				// get end tic
-				PROFILER_QUERY_PERFORMANCE_COUNTER(&b->ticStop);
-				// tic counter += (end tic - start tic)
-				PROFILER_UPDATE_TIME(b);
-				PROFILER_VPOP;
+				if (Profiler::UseHostCycles())
+				{
+					// Only RSCRATCH and RSCRATCH2 are clobbered, they are never cached
+					PROFILER_READ_TIME_STAMP_COUNTER(&b->ticStop);
+					PROFILER_UPDATE_TIME(b);
+				}
+				else
+				{
+					PROFILER_VPUSH;
+					// get end tic
+					PROFILER_QUERY_PERFORMANCE_COUNTER(&b->ticStop);
+					// tic counter += (end tic - start tic)
+					PROFILER_UPDATE_TIME(b);
+					PROFILER_VPOP;
+				}
 			}
 			js.isLastInstruction = true;
 		}
@@ -900,9 +973,10 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer* code_buf, JitBloc
 			}
 
 			// If we have a register that will never be used again, flush it.
-			for (int j : ~ops[i].gprInUse)
+			// The registers of a loop are used again by the next iteration.
+			for (int j : ~ops[i].gprInUse & ~m_loop_gprs)
 				gpr.StoreFromRegister(j);
-			for (int j : ~ops[i].fprInUse)
+			for (int j : ~ops[i].fprInUse & ~m_loop_fprs)
 				fpr.StoreFromRegister(j);
 
 			if (opinfo->flags & FL_LOADSTORE)
@@ -932,6 +1006,12 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer* code_buf, JitBloc
 
 	b->codeSize = (u32)(GetCodePtr() - start);
 	b->originalSize = code_block.m_num_instructions;
+	for (const auto& inlined : code_block.m_inlined)
+	{
+		b->originalSize -= inlined.second;
+		b->inlinedCode.emplace_back(PowerPC::JitCache_TranslateAddress(inlined.first).address,
+			inlined.second);
+	}
 
 #ifdef JIT_LOG_X86
 	LogGeneratedX86(code_block.m_num_instructions, code_buf, start, b);
@@ -940,6 +1020,180 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer* code_buf, JitBloc
 	return normalEntry;
 }
 
+bool Jit64::CanKeepRegistersAcrossLoop(const PPCAnalyst::CodeBlock& cb,
+	PPCAnalyst::CodeOp* ops) const
+{
+	// The backward branch bypasses the block entry, so anything that needs every entry to go
+	// through it keeps the plain exit.
+	if (!jo.enableBlocklink || Profiler::g_ProfileBlocks || ImHereDebug ||
+		SConfig::GetInstance().bEnableDebugging || MMCR0.Hex || MMCR1.Hex)
+		return false;
+
+	bool loops = false;
+	for (u32 i = 0; i < cb.m_num_instructions; i++)
+	{
+		const UGeckoInstruction inst = ops[i].inst;
+		// icbi could invalidate this block while it loops
+		if (inst.OPCD == 31 && inst.SUBOP10 == 982)
+			return false;
+
+		if (inst.OPCD == 16)  // bcx
+		{
+			const u32 destination =
+				inst.AA ? SignExt16(inst.BD << 2) : ops[i].address + SignExt16(inst.BD << 2);
+			loops |= !inst.LK && destination == js.blockStart && !ops[i].branchIsIdleLoop;
+		}
+		else if (inst.OPCD == 18 && i == cb.m_num_instructions - 1)  // bx
+		{
+			const u32 destination =
+				inst.AA ? SignExt26(inst.LI << 2) : ops[i].address + SignExt26(inst.LI << 2);
+			// A branch to itself is an idle loop
+			loops |= !inst.LK && destination == js.blockStart && destination != ops[i].address;
+		}
+	}
+	return loops;
+}
+
+static BitSet32 PickLoopRegisters(const std::array<int, 32>& uses, int count)
+{
+	BitSet32 picked;
+	for (int i = 0; i < count; i++)
+	{
+		int best = -1;
+		for (int reg = 0; reg < 32; reg++)
+		{
+			if (uses[reg] > 0 && !picked[reg] && (best < 0 || uses[reg] > uses[best]))
+				best = reg;
+		}
+		if (best < 0)
+			break;
+		picked[best] = true;
+	}
+	return picked;
+}
+
+// Executions of a block that count its branches before it is recompiled
+static constexpr u32 BRANCH_PROFILE_EXECUTIONS = 256;
+// Times a branch has to be reached for its counts to matter
+static constexpr u32 BRANCH_PROFILE_MIN_SAMPLES = 64;
+// A branch taken less than once in this many times it is reached is cold
+static constexpr u32 BRANCH_PROFILE_COLD_RATIO = 16;
+
+static bool IsConditionalBranch(UGeckoInstruction inst)
+{
+	const bool bc = inst.OPCD == 16;
+	const bool bclr = inst.OPCD == 19 && inst.SUBOP10 == 16;
+	return (bc || bclr) &&
+		((inst.BO & BO_DONT_DECREMENT_FLAG) == 0 || (inst.BO & BO_DONT_CHECK_CONDITION) == 0);
+}
+
+void Jit64::StartBranchProfile(PPCAnalyst::CodeOp* ops, u32 num_instructions)
+{
+	m_branch_profile = nullptr;
+	m_branch_layout = nullptr;
+
+	if (js.branchProfiledAddresses.count(js.blockStart))
+	{
+		auto it = m_branch_profiles.find(js.blockStart);
+		if (it != m_branch_profiles.end())
+			m_branch_layout = &it->second;
+		return;
+	}
+
+	if (SConfig::GetInstance().bEnableDebugging || Profiler::g_ProfileBlocks)
+		return;
+	if (std::none_of(ops, ops + num_instructions,
+		[](const PPCAnalyst::CodeOp& op) { return IsConditionalBranch(op.inst); }))
+	{
+		return;
+	}
+
+	// Restarts the profile of a block recompiled before it finished
+	m_branch_profile = &m_branch_profiles[js.blockStart];
+	m_branch_profile->executions_left = BRANCH_PROFILE_EXECUTIONS;
+	m_branch_profile->branches.clear();
+
+	SwitchToFarCode();
+	const u8* recompile = GetCodePtr();
+	MOV(32, PPCSTATE(pc), Imm32(js.blockStart));
+	ABI_PushRegistersAndAdjustStack({}, 0);
+	ABI_CallFunctionC(JitInterface::CompileExceptionCheck,
+		(u32)JitInterface::ExceptionType::EXCEPTIONS_BRANCH_PROFILE);
+	ABI_PopRegistersAndAdjustStack({}, 0);
+	JMP(asm_routines.dispatcherNoCheck, true);
+	SwitchToNearCode();
+
+	MOV(64, R(RSCRATCH), Imm64((u64)&m_branch_profile->executions_left));
+	SUB(32, MatR(RSCRATCH), Imm8(1));
+	J_CC(CC_Z, recompile);
+}
+
+Jit64::BranchCounts* Jit64::ProfileBranch()
+{
+	if (!m_branch_profile)
+		return nullptr;
+
+	BranchCounts& counts = m_branch_profile->branches[js.compilerPC];
+	counts = {};
+	return &counts;
+}
+
+void Jit64::CountBranch(u32* counter)
+{
+	MOV(64, R(RSCRATCH), Imm64((u64)counter));
+	ADD(32, MatR(RSCRATCH), Imm8(1));
+}
+
+bool Jit64::IsColdBranch() const
+{
+	if (!m_branch_layout)
+		return false;
+
+	auto it = m_branch_layout->branches.find(js.compilerPC);
+	if (it == m_branch_layout->branches.end())
+		return false;
+
+	// Too few samples say nothing, the block may have left earlier most of the time
+	const BranchCounts& counts = it->second;
+	return counts.reached >= BRANCH_PROFILE_MIN_SAMPLES &&
+		counts.taken * BRANCH_PROFILE_COLD_RATIO < counts.reached;
+}
+
+void Jit64::StartLoop(PPCAnalyst::CodeOp* ops, u32 num_instructions)
+{
+	// Leave some host registers to the allocator for the other guest registers
+	constexpr int MAX_LOOP_GPRS = 8;
+	constexpr int MAX_LOOP_FPRS = 8;
+
+	// The guest registers read most often are loaded once before the first iteration
+	std::array<int, 32> gpr_uses = {};
+	std::array<int, 32> fpr_uses = {};
+	for (u32 i = 0; i < num_instructions; i++)
+	{
+		for (int reg : ops[i].regsIn)
+			gpr_uses[reg]++;
+		for (int reg : ops[i].fregsIn)
+			fpr_uses[reg]++;
+	}
+	m_loop_gprs = PickLoopRegisters(gpr_uses, MAX_LOOP_GPRS);
+	m_loop_fprs = PickLoopRegisters(fpr_uses, MAX_LOOP_FPRS);
+
+	m_loop_gpr_mapping.fill(INVALID_REG);
+	m_loop_fpr_mapping.fill(INVALID_REG);
+	for (int reg : m_loop_gprs)
+	{
+		gpr.BindToRegister(reg, true, true);
+		m_loop_gpr_mapping[reg] = gpr.RX(reg);
+	}
+	for (int reg : m_loop_fprs)
+	{
+		fpr.BindToRegister(reg, true, true);
+		m_loop_fpr_mapping[reg] = fpr.RX(reg);
+	}
+
+	m_loop_head = GetCodePtr();
+}
+
 BitSet8 Jit64::ComputeStaticGQRs(const PPCAnalyst::CodeBlock& cb) const
 {
 	return cb.m_gqr_used & ~cb.m_gqr_modified;
@@ -971,6 +1225,13 @@ void Jit64::EnableOptimization()
 	analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_BRANCH_MERGE);
 	analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_CROR_MERGE);
 	analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_CARRY_MERGE);
+	// Breakpoints may inspect the registers in between instructions
+	if (!SConfig::GetInstance().bEnableDebugging)
+		analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_DEAD_WRITE_ELIMINATION);
+	if (SConfig::GetInstance().bJITInlineLeafFunctions && !SConfig::GetInstance().bEnableDebugging)
+		analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_LEAF_INLINE);
+	if (SConfig::GetInstance().bJITDetectIdleLoops)
+		analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_IDLE_LOOP_DETECTION);
 }
 
 void Jit64::IntializeSpeculativeConstants()
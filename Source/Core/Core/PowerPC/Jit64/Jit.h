@@ -18,6 +18,10 @@
 // ----------
 #pragma once
 
+#include <array>
+#include <unordered_map>
+
+#include "Common/BitSet.h"
 #include "Common/CommonTypes.h"
 #include "Common/x64ABI.h"
 #include "Common/x64Emitter.h"
@@ -45,6 +49,57 @@ private:
 	bool m_cleanup_after_stackfault;
 	u8* m_stack;
 
+	// Set while compiling a block that branches back to its own start. The guest registers
+	// the loop uses stay in the same host registers across the backward branch.
+	const u8* m_loop_head = nullptr;
+	BitSet32 m_loop_gprs;
+	BitSet32 m_loop_fprs;
+	std::array<Gen::X64Reg, 32> m_loop_gpr_mapping;
+	std::array<Gen::X64Reg, 32> m_loop_fpr_mapping;
+
+	bool CanKeepRegistersAcrossLoop(const PPCAnalyst::CodeBlock& cb, PPCAnalyst::CodeOp* ops) const;
+	void StartLoop(PPCAnalyst::CodeOp* ops, u32 num_instructions);
+
+	// A block with conditional branches counts how they go for its first executions, then it is
+	// recompiled with the taken paths of the rarely taken ones in far code.
+	struct BranchCounts
+	{
+		u32 reached;
+		u32 taken;
+	};
+	struct BranchProfile
+	{
+		u32 executions_left;
+		// By the address of the branch
+		std::unordered_map<u32, BranchCounts> branches;
+	};
+	// By block address, kept until the cache is cleared since the code refers to the counters
+	std::unordered_map<u32, BranchProfile> m_branch_profiles;
+	// Collected by the block being compiled
+	BranchProfile* m_branch_profile = nullptr;
+	// Finished profile of the block being compiled
+	const BranchProfile* m_branch_layout = nullptr;
+
+	void StartBranchProfile(PPCAnalyst::CodeOp* ops, u32 num_instructions);
+	// Counters of the branch at js.compilerPC while the block is profiled
+	BranchCounts* ProfileBranch();
+	void CountBranch(u32* counter);
+	// Whether the profile saw the branch at js.compilerPC rarely taken
+	bool IsColdBranch() const;
+
+	// Tests of a conditional branch, see JumpIfBranchNotTaken
+	struct BranchConditions
+	{
+		Gen::FixupBranch ctr;
+		Gen::FixupBranch condition;
+		bool test_ctr;
+		bool test_condition;
+		// The taken path is in far code
+		bool cold;
+	};
+	BranchConditions JumpIfBranchNotTaken(UGeckoInstruction inst, bool cold);
+	void ContinueAfterBranch(const BranchConditions& conditions);
+
 public:
 	Jit64() : code_buffer(32000) {}
 	~Jit64() {}
@@ -90,6 +145,9 @@ public:
 	void WriteExceptionExit();
 	void WriteExternalExceptionExit();
 	void WriteRfiExitDestInRSCRATCH();
+	// Backward branch to the start of the block, see m_loop_head
+	bool IsLoopExit(u32 destination, bool bl) const;
+	void WriteLoopExit();
 	bool Cleanup();
 
 	void GenerateConstantOverflow(bool overflow);
@@ -135,6 +193,7 @@ public:
 		bool preserve_inputs, bool roundRHS = false);
 	void FloatCompare(UGeckoInstruction inst, bool upper = false);
 	void UpdateMXCSR();
+	void SetMXCSR(u32 rounding_mode);
 
 	// OPCODES
 	using Instruction = void (Jit64::*)(UGeckoInstruction instCode);
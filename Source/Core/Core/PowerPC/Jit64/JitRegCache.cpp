@@ -57,6 +57,33 @@ void RegCache::Start()
 	// But only preload IF written OR reads >= 3
 }
 
+void RegCache::BindToLoopHead(const std::array<X64Reg, 32>& mapping)
+{
+	// Registers in the wrong place go through ppcState, so the moves can't conflict
+	for (size_t i = 0; i < regs.size(); i++)
+	{
+		if (regs[i].away && (mapping[i] == INVALID_REG || !regs[i].location.IsSimpleReg(mapping[i])))
+			StoreFromRegister(i);
+	}
+
+	for (size_t i = 0; i < regs.size(); i++)
+	{
+		const X64Reg xr = mapping[i];
+		if (xr == INVALID_REG)
+			continue;
+
+		if (!regs[i].away)
+		{
+			LoadRegister(i, xr);
+			xregs[xr].free = false;
+			xregs[xr].ppcReg = i;
+			regs[i].away = true;
+			regs[i].location = ::Gen::R(xr);
+		}
+		xregs[xr].dirty = true;
+	}
+}
+
 void RegCache::UnlockAll()
 {
 	for (auto& reg : regs)
@@ -52,10 +52,28 @@ protected:
 	float ScoreRegister(Gen::X64Reg xreg);
 
 public:
+	struct State
+	{
+		std::array<PPCCachedReg, 32> regs;
+		std::array<X64CachedReg, NUMXREGS> xregs;
+	};
+
 	RegCache();
 	virtual ~RegCache() {}
 	void Start();
 
+	// For code paths that are skipped by the code emitted after them
+	State GetState() const { return { regs, xregs }; }
+	void SetState(const State& state)
+	{
+		regs = state.regs;
+		xregs = state.xregs;
+	}
+
+	// Brings the cache into the state at the head of a loop: the guest registers in mapping
+	// dirty in their host registers, all others in ppcState.
+	void BindToLoopHead(const std::array<Gen::X64Reg, 32>& mapping);
+
 	void DiscardRegContentsIfCached(size_t preg);
 	void SetEmitter(Gen::XEmitter* emitter) { emit = emitter; }
 	void FlushR(Gen::X64Reg reg);
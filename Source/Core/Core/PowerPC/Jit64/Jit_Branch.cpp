@@ -77,19 +77,26 @@ void Jit64::bx(UGeckoInstruction inst)
 		return;
 	}
 
-	gpr.Flush();
-	fpr.Flush();
-
 	u32 destination;
 	if (inst.AA)
 		destination = SignExt26(inst.LI << 2);
 	else
 		destination = js.compilerPC + SignExt26(inst.LI << 2);
+
+	if (destination != js.compilerPC && !js.op->branchIsIdleLoop && IsLoopExit(destination, inst.LK))
+	{
+		WriteLoopExit();
+		return;
+	}
+
+	gpr.Flush();
+	fpr.Flush();
+
 #ifdef ACID_TEST
 	if (inst.LK)
 		AND(32, PPCSTATE(cr), Imm32(~(0xFF000000)));
 #endif
-	if (destination == js.compilerPC)
+	if (destination == js.compilerPC || js.op->branchIsIdleLoop)
 	{
 		ABI_PushRegistersAndAdjustStack({}, 0);
 		ABI_CallFunction(CoreTiming::Idle);
@@ -101,35 +108,68 @@ void Jit64::bx(UGeckoInstruction inst)
 	WriteExit(destination, inst.LK, js.compilerPC + 4);
 }
 
-// TODO - optimize to hell and beyond
-// TODO - make nice easy to optimize special cases for the most common
-// variants of this instruction.
-void Jit64::bcx(UGeckoInstruction inst)
+// Emits the tests of a conditional branch, the code after it is the taken path. The tests jump
+// past that when the branch isn't taken, unless the profile found the branch cold: then they jump
+// to the taken path in far code and the path that isn't taken falls through.
+Jit64::BranchConditions Jit64::JumpIfBranchNotTaken(UGeckoInstruction inst, bool cold)
 {
-	INSTRUCTION_START
-		JITDISABLE(bJITBranchOff);
-
-	// USES_CR
+	BranchConditions conditions;
+	conditions.test_ctr = (inst.BO & BO_DONT_DECREMENT_FLAG) == 0;
+	conditions.test_condition = (inst.BO & BO_DONT_CHECK_CONDITION) == 0;
+	conditions.cold = cold && (conditions.test_ctr || conditions.test_condition);
 
-	FixupBranch pCTRDontBranch;
-	if ((inst.BO & BO_DONT_DECREMENT_FLAG) == 0)  // Decrement and test CTR
+	if (conditions.test_ctr)  // Decrement and test CTR
 	{
+		// Followed by a CR test, the CTR test still skips it when the branch isn't taken
+		const bool jump_if_taken = conditions.cold && !conditions.test_condition;
 		SUB(32, PPCSTATE_CTR, Imm8(1));
-		if (inst.BO & BO_BRANCH_IF_CTR_0)
-			pCTRDontBranch = J_CC(CC_NZ, true);
+		if (((inst.BO & BO_BRANCH_IF_CTR_0) != 0) != jump_if_taken)
+			conditions.ctr = J_CC(CC_NZ, true);
 		else
-			pCTRDontBranch = J_CC(CC_Z, true);
+			conditions.ctr = J_CC(CC_Z, true);
 	}
 
-	FixupBranch pConditionDontBranch;
-	if ((inst.BO & BO_DONT_CHECK_CONDITION) == 0)  // Test a CR bit
+	if (conditions.test_condition)  // Test a CR bit
 	{
-		pConditionDontBranch =
-			JumpIfCRFieldBit(inst.BI >> 2, 3 - (inst.BI & 3), !(inst.BO_2 & BO_BRANCH_IF_TRUE));
+		const bool branch_if_true = (inst.BO_2 & BO_BRANCH_IF_TRUE) != 0;
+		conditions.condition = JumpIfCRFieldBit(inst.BI >> 2, 3 - (inst.BI & 3),
+			conditions.cold ? branch_if_true : !branch_if_true);
 	}
 
-	if (inst.LK)
-		MOV(32, PPCSTATE_LR, Imm32(js.compilerPC + 4));
+	if (conditions.cold)
+	{
+		SwitchToFarCode();
+		SetJumpTarget(conditions.test_condition ? conditions.condition : conditions.ctr);
+	}
+	return conditions;
+}
+
+// Continues with the path that isn't taken, after the taken path ended with an exit
+void Jit64::ContinueAfterBranch(const BranchConditions& conditions)
+{
+	if (conditions.cold)
+	{
+		SwitchToNearCode();
+		if (conditions.test_ctr && conditions.test_condition)
+			SetJumpTarget(conditions.ctr);
+		return;
+	}
+
+	if (conditions.test_condition)
+		SetJumpTarget(conditions.condition);
+	if (conditions.test_ctr)
+		SetJumpTarget(conditions.ctr);
+}
+
+// TODO - optimize to hell and beyond
+// TODO - make nice easy to optimize special cases for the most common
+// variants of this instruction.
+void Jit64::bcx(UGeckoInstruction inst)
+{
+	INSTRUCTION_START
+		JITDISABLE(bJITBranchOff);
+
+	// USES_CR
 
 	u32 destination;
 	if (inst.AA)
@@ -137,14 +177,42 @@ void Jit64::bcx(UGeckoInstruction inst)
 	else
 		destination = js.compilerPC + SignExt16(inst.BD << 2);
 
-	gpr.Flush(FLUSH_MAINTAIN_STATE);
-	fpr.Flush(FLUSH_MAINTAIN_STATE);
-	WriteExit(destination, inst.LK, js.compilerPC + 4);
+	const bool cold = !js.op->branchIsIdleLoop && !IsLoopExit(destination, inst.LK) && IsColdBranch();
+	BranchCounts* counts = ProfileBranch();
+	if (counts)
+		CountBranch(&counts->reached);
+
+	BranchConditions conditions = JumpIfBranchNotTaken(inst, cold);
 
-	if ((inst.BO & BO_DONT_CHECK_CONDITION) == 0)
-		SetJumpTarget(pConditionDontBranch);
-	if ((inst.BO & BO_DONT_DECREMENT_FLAG) == 0)
-		SetJumpTarget(pCTRDontBranch);
+	if (counts)
+		CountBranch(&counts->taken);
+
+	if (inst.LK)
+		MOV(32, PPCSTATE_LR, Imm32(js.compilerPC + 4));
+
+	if (js.op->branchIsIdleLoop)
+	{
+		// Nothing changes until the next event
+		gpr.Flush(FLUSH_MAINTAIN_STATE);
+		fpr.Flush(FLUSH_MAINTAIN_STATE);
+		ABI_PushRegistersAndAdjustStack({}, 0);
+		ABI_CallFunction(CoreTiming::Idle);
+		ABI_PopRegistersAndAdjustStack({}, 0);
+		MOV(32, PPCSTATE(pc), Imm32(destination));
+		WriteExceptionExit();
+	}
+	else if (IsLoopExit(destination, inst.LK))
+	{
+		WriteLoopExit();
+	}
+	else
+	{
+		gpr.Flush(FLUSH_MAINTAIN_STATE);
+		fpr.Flush(FLUSH_MAINTAIN_STATE);
+		WriteExit(destination, inst.LK, js.compilerPC + 4);
+	}
+
+	ContinueAfterBranch(conditions);
 
 	if (!analyzer.HasOption(PPCAnalyst::PPCAnalyzer::OPTION_CONDITIONAL_CONTINUE))
 	{
@@ -212,22 +280,15 @@ void Jit64::bclrx(UGeckoInstruction inst)
 	INSTRUCTION_START
 		JITDISABLE(bJITBranchOff);
 
-	FixupBranch pCTRDontBranch;
-	if ((inst.BO & BO_DONT_DECREMENT_FLAG) == 0)  // Decrement and test CTR
-	{
-		SUB(32, PPCSTATE_CTR, Imm8(1));
-		if (inst.BO & BO_BRANCH_IF_CTR_0)
-			pCTRDontBranch = J_CC(CC_NZ, true);
-		else
-			pCTRDontBranch = J_CC(CC_Z, true);
-	}
+	const bool cold = IsColdBranch();
+	BranchCounts* counts = ProfileBranch();
+	if (counts)
+		CountBranch(&counts->reached);
 
-	FixupBranch pConditionDontBranch;
-	if ((inst.BO & BO_DONT_CHECK_CONDITION) == 0)  // Test a CR bit
-	{
-		pConditionDontBranch =
-			JumpIfCRFieldBit(inst.BI >> 2, 3 - (inst.BI & 3), !(inst.BO_2 & BO_BRANCH_IF_TRUE));
-	}
+	BranchConditions conditions = JumpIfBranchNotTaken(inst, cold);
+
+	if (counts)
+		CountBranch(&counts->taken);
 
 	// This below line can be used to prove that blr "eats flags" in practice.
 	// This observation could let us do some useful optimizations.
@@ -250,10 +311,7 @@ void Jit64::bclrx(UGeckoInstruction inst)
 	fpr.Flush(FLUSH_MAINTAIN_STATE);
 	WriteBLRExit();
 
-	if ((inst.BO & BO_DONT_CHECK_CONDITION) == 0)
-		SetJumpTarget(pConditionDontBranch);
-	if ((inst.BO & BO_DONT_DECREMENT_FLAG) == 0)
-		SetJumpTarget(pCTRDontBranch);
+	ContinueAfterBranch(conditions);
 
 	if (!analyzer.HasOption(PPCAnalyst::PPCAnalyzer::OPTION_CONDITIONAL_CONTINUE))
 	{
@@ -222,9 +222,16 @@ void Jit64::fp_arith(UGeckoInstruction inst)
 	default:
 		_assert_msg_(DYNA_REC, 0, "fp_arith WTF!!!");
 	}
-	HandleNaNs(inst, fpr.RX(d), dest);
+	// Round straight out of the temporary, that saves a copy when the inputs had to be preserved
 	if (single)
-		ForceSinglePrecision(fpr.RX(d), fpr.R(d), packed, true);
+	{
+		HandleNaNs(inst, dest, dest);
+		ForceSinglePrecision(fpr.RX(d), R(dest), packed, true);
+	}
+	else
+	{
+		HandleNaNs(inst, fpr.RX(d), dest);
+	}
 	SetFPRFIfNeeded(fpr.RX(d));
 	fpr.UnlockAll();
 }
@@ -319,16 +326,15 @@ void Jit64::fmaddXX(UGeckoInstruction inst)
 	{
 		// We implement nmsub a little differently ((b - a*c) instead of -(a*c - b)), so handle it
 		// separately.
-		MOVAPD(XMM1, fpr.R(b));
 		if (packed)
 		{
 			MULPD(XMM0, fpr.R(a));
-			SUBPD(XMM1, R(XMM0));
+			avx_op(&XEmitter::VSUBPD, &XEmitter::SUBPD, XMM1, fpr.R(b), R(XMM0));
 		}
 		else
 		{
 			MULSD(XMM0, fpr.R(a));
-			SUBSD(XMM1, R(XMM0));
+			avx_op(&XEmitter::VSUBSD, &XEmitter::SUBSD, XMM1, fpr.R(b), R(XMM0));
 		}
 	}
 	else
@@ -352,17 +358,12 @@ void Jit64::fmaddXX(UGeckoInstruction inst)
 		if (inst.SUBOP5 == 31)  // nmadd
 			XORPD(XMM1, M(packed ? psSignBits2 : psSignBits));
 	}
+	HandleNaNs(inst, XMM1, XMM1);
 	fpr.BindToRegister(d, !single);
 	if (single)
-	{
-		HandleNaNs(inst, fpr.RX(d), XMM1);
-		ForceSinglePrecision(fpr.RX(d), fpr.R(d), packed, true);
-	}
+		ForceSinglePrecision(fpr.RX(d), R(XMM1), packed, true);
 	else
-	{
-		HandleNaNs(inst, XMM1, XMM1);
 		MOVSD(fpr.RX(d), R(XMM1));
-	}
 	SetFPRFIfNeeded(fpr.RX(d));
 	fpr.UnlockAll();
 }
@@ -414,10 +414,18 @@ void Jit64::DoMergedBranchCondition()
 	else  // SO bit, do not branch (we don't emulate SO for cmp).
 		pDontBranch = J(true);
 
-	gpr.Flush(FLUSH_MAINTAIN_STATE);
-	fpr.Flush(FLUSH_MAINTAIN_STATE);
+	if (next.OPCD == 16 &&
+		IsLoopExit(next.AA ? SignExt16(next.BD << 2) : nextPC + SignExt16(next.BD << 2), next.LK))
+	{
+		WriteLoopExit();
+	}
+	else
+	{
+		gpr.Flush(FLUSH_MAINTAIN_STATE);
+		fpr.Flush(FLUSH_MAINTAIN_STATE);
 
-	DoMergedBranch();
+		DoMergedBranch();
+	}
 
 	SetJumpTarget(pDontBranch);
 
@@ -450,7 +458,12 @@ void Jit64::DoMergedBranchImmediate(s64 val)
 	else  // SO bit, do not branch (we don't emulate SO for cmp).
 		branch = false;
 
-	if (branch)
+	if (branch && next.OPCD == 16 &&
+		IsLoopExit(next.AA ? SignExt16(next.BD << 2) : nextPC + SignExt16(next.BD << 2), next.LK))
+	{
+		WriteLoopExit();
+	}
+	else if (branch)
 	{
 		gpr.Flush();
 		fpr.Flush();
@@ -664,6 +664,17 @@ void Jit64::UpdateMXCSR()
 	LEA(64, RSCRATCH2, M(&s_fpscr_to_mxcsr));
 	AND(32, R(RSCRATCH), Imm32(7));
 	LDMXCSR(MComplex(RSCRATCH2, RSCRATCH, SCALE_4, 0));
+	js.knownRoundingMode = -1;
+}
+
+// For an FPSCR & 7 known at compile time. LDMXCSR serializes, so it is left out when the block
+// already set the same rounding mode.
+void Jit64::SetMXCSR(u32 rounding_mode)
+{
+	if (js.knownRoundingMode == static_cast<int>(rounding_mode))
+		return;
+	LDMXCSR(M(&s_fpscr_to_mxcsr[rounding_mode]));
+	js.knownRoundingMode = rounding_mode;
 }
 
 void Jit64::mtfsb0x(UGeckoInstruction inst)
@@ -677,6 +688,11 @@ void Jit64::mtfsb0x(UGeckoInstruction inst)
 	{
 		AND(32, PPCSTATE(fpscr), Imm32(mask));
 	}
+	else if (js.knownRoundingMode >= 0)
+	{
+		AND(32, PPCSTATE(fpscr), Imm32(mask));
+		SetMXCSR(js.knownRoundingMode & mask);
+	}
 	else
 	{
 		MOV(32, R(RSCRATCH), PPCSTATE(fpscr));
@@ -707,7 +723,12 @@ void Jit64::mtfsb1x(UGeckoInstruction inst)
 	}
 	MOV(32, PPCSTATE(fpscr), R(RSCRATCH));
 	if (inst.CRBD >= 29)
-		UpdateMXCSR();
+	{
+		if (js.knownRoundingMode >= 0)
+			SetMXCSR(js.knownRoundingMode | mask);
+		else
+			UpdateMXCSR();
+	}
 }
 
 void Jit64::mtfsfix(UGeckoInstruction inst)
@@ -727,7 +748,7 @@ void Jit64::mtfsfix(UGeckoInstruction inst)
 
 	// Field 7 contains NI and RN.
 	if (inst.CRFD == 7)
-		LDMXCSR(M(&s_fpscr_to_mxcsr[imm & 7]));
+		SetMXCSR(imm & 7);
 }
 
 void Jit64::mtfsfx(UGeckoInstruction inst)
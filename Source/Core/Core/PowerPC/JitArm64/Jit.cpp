@@ -2,7 +2,9 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <cstddef>
 #include <cstdio>
+#include <vector>
 
 #include "Common/Arm64Emitter.h"
 #include "Common/CommonTypes.h"
@@ -10,6 +12,7 @@
 #include "Common/MathUtil.h"
 #include "Common/PerformanceCounter.h"
 #include "Common/StringUtil.h"
+#include "Common/Trace.h"
 
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
@@ -57,6 +60,10 @@ void JitArm64::Init()
   analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_CARRY_MERGE);
 
   m_supports_cycle_counter = HasCycleCounters();
+
+  // The continuations bl pushes are only valid as long as the block links
+  m_enable_blr_optimization = jo.enableBlocklink && !SConfig::GetInstance().bEnableDebugging;
+  ResetReturnStack();
 }
 
 void JitArm64::ClearCache()
@@ -70,6 +77,7 @@ void JitArm64::ClearCache()
   UpdateMemoryOptions();
 
   GenerateAsm();
+  ResetReturnStack();
 }
 
 void JitArm64::Shutdown()
@@ -191,10 +199,60 @@ void JitArm64::DoDownCount()
   gpr.Unlock(WA, WB);
 }
 
+void JitArm64::ResetReturnStack()
+{
+  for (ReturnStackEntry& entry : m_return_stack.entries)
+    entry = {RETURN_STACK_EMPTY, nullptr};
+  m_return_stack.top = 0;
+}
+
+// Pushes the return address of a bl. Returns the ADR of the host address, which
+// WriteReturnContinuation points to the continuation once it is emitted.
+u8* JitArm64::WriteReturnStackPush(u32 exit_address_after_return)
+{
+  ARM64Reg WA = gpr.GetReg();
+  ARM64Reg WB = gpr.GetReg();
+  ARM64Reg XA = EncodeRegTo64(WA);
+  ARM64Reg XB = EncodeRegTo64(WB);
+
+  MOVP2R(XA, &m_return_stack);
+  LDR(INDEX_UNSIGNED, WB, XA, offsetof(ReturnStack, top));
+  ADD(WB, WB, 1);
+  ANDI2R(WB, WB, RETURN_STACK_SIZE - 1);
+  STR(INDEX_UNSIGNED, WB, XA, offsetof(ReturnStack, top));
+  ADD(XA, XA, XB, ArithOption(XB, ST_LSL, 4));
+  MOVI2R(WB, exit_address_after_return);
+  u8* host_address_load = GetWritableCodePtr();
+  ADR(X30, 0);
+  STP(INDEX_SIGNED, XB, X30, XA, offsetof(ReturnStack, entries));
+
+  gpr.Unlock(WA, WB);
+  return host_address_load;
+}
+
+// The blr of the callee jumps here on a correct prediction. It took its downcount already and left
+// the flags of a positive one, which the linked exit expects.
+void JitArm64::WriteReturnContinuation(u8* host_address_load, u32 exit_address_after_return)
+{
+  ARM64XEmitter emit(host_address_load);
+  emit.ADR(X30, static_cast<s32>(GetCodePtr() - host_address_load));
+
+  JitBlock::LinkData linkData;
+  linkData.exitAddress = exit_address_after_return;
+  linkData.exitPtrs = GetWritableCodePtr();
+  linkData.linkStatus = false;
+  js.curBlock->linkData.push_back(linkData);
+
+  MOVI2R(DISPATCHER_PC, exit_address_after_return);
+  B(dispatcher);
+}
+
 // Exits
-void JitArm64::WriteExit(u32 destination)
+void JitArm64::WriteExit(u32 destination, bool LK, u32 exit_address_after_return)
 {
   Cleanup();
+  LK &= m_enable_blr_optimization;
+  u8* host_address_load = LK ? WriteReturnStackPush(exit_address_after_return) : nullptr;
   DoDownCount();
 
   if (Profiler::g_ProfileBlocks)
@@ -210,11 +268,16 @@ void JitArm64::WriteExit(u32 destination)
 
   MOVI2R(DISPATCHER_PC, destination);
   B(dispatcher);
+
+  if (LK)
+    WriteReturnContinuation(host_address_load, exit_address_after_return);
 }
 
-void JitArm64::WriteExit(ARM64Reg Reg)
+void JitArm64::WriteExit(ARM64Reg Reg, bool LK, u32 exit_address_after_return)
 {
   Cleanup();
+  LK &= m_enable_blr_optimization;
+  u8* host_address_load = LK ? WriteReturnStackPush(exit_address_after_return) : nullptr;
   DoDownCount();
 
   if (Reg != DISPATCHER_PC)
@@ -225,6 +288,57 @@ void JitArm64::WriteExit(ARM64Reg Reg)
     EndTimeProfile(js.curBlock);
 
   B(dispatcher);
+
+  if (LK)
+    WriteReturnContinuation(host_address_load, exit_address_after_return);
+}
+
+void JitArm64::WriteBLRExit(ARM64Reg dest)
+{
+  if (!m_enable_blr_optimization)
+  {
+    WriteExit(dest);
+    return;
+  }
+
+  Cleanup();
+  DoDownCount();
+
+  if (dest != DISPATCHER_PC)
+    MOV(DISPATCHER_PC, dest);
+  gpr.Unlock(dest);
+
+  if (Profiler::g_ProfileBlocks)
+    EndTimeProfile(js.curBlock);
+
+  // Out of cycles, the dispatcher goes to CoreTiming
+  FixupBranch has_cycles = B(CC_PL);
+  B(dispatcher);
+  SetJumpTarget(has_cycles);
+
+  ARM64Reg WA = gpr.GetReg();
+  ARM64Reg WB = gpr.GetReg();
+  ARM64Reg WC = gpr.GetReg();
+  ARM64Reg XA = EncodeRegTo64(WA);
+  ARM64Reg XB = EncodeRegTo64(WB);
+  ARM64Reg XC = EncodeRegTo64(WC);
+
+  // Pop the top entry, whether it matches or not
+  MOVP2R(XA, &m_return_stack);
+  LDR(INDEX_UNSIGNED, WB, XA, offsetof(ReturnStack, top));
+  ADD(XC, XA, XB, ArithOption(XB, ST_LSL, 4));
+  SUB(WB, WB, 1);
+  ANDI2R(WB, WB, RETURN_STACK_SIZE - 1);
+  STR(INDEX_UNSIGNED, WB, XA, offsetof(ReturnStack, top));
+  LDP(INDEX_SIGNED, XB, XC, XC, offsetof(ReturnStack, entries));
+
+  // An equal compare leaves N clear, so the continuation sees a positive downcount
+  CMP(WB, DISPATCHER_PC);
+  FixupBranch mispredicted = B(CC_NEQ);
+  BR(XC);
+  SetJumpTarget(mispredicted);
+  gpr.Unlock(WA, WB, WC);
+  B(dispatcherNoCheck);
 }
 
 void JitArm64::WriteExceptionExit(u32 destination, bool only_external)
@@ -368,6 +482,7 @@ void JitArm64::SingleStep()
 
 void JitArm64::Jit(u32)
 {
+  TRACE_ZONE("JitArm64::Jit");
   if (IsAlmostFull() || farcode.IsAlmostFull() || blocks.IsFull() ||
       SConfig::GetInstance().bJITNoBlockCache)
   {
@@ -414,7 +529,7 @@ const u8* JitArm64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer* code_buf, JitB
 
   js.isLastInstruction = false;
   js.firstFPInstructionFound = false;
-  js.assumeNoPairedQuantize = false;
+  js.constantGqr.clear();
   js.blockStart = em_address;
   js.fifoBytesSinceCheck = 0;
   js.mustCheckFifo = false;
@@ -456,27 +571,43 @@ const u8* JitArm64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer* code_buf, JitB
     BeginTimeProfile(b);
   }
 
-  if (code_block.m_gqr_used.Count() == 1 &&
+  // GQRs the block uses but doesn't set are assumed to keep the value they have now, which lets
+  // psq_l and psq_st specialize on it. The block is recompiled without that when they change.
+  const BitSet8 gqr_static = code_block.m_gqr_used & ~code_block.m_gqr_modified;
+  if (gqr_static &&
       js.pairedQuantizeAddresses.find(js.blockStart) == js.pairedQuantizeAddresses.end())
   {
-    int gqr = *code_block.m_gqr_used.begin();
-    if (!code_block.m_gqr_modified[gqr] && !GQR(gqr))
+    std::vector<FixupBranch> changed;
+    for (int gqr : gqr_static)
     {
+      const u32 value = GQR(gqr);
+      js.constantGqr[gqr] = value;
       LDR(INDEX_UNSIGNED, W0, PPC_REG, PPCSTATE_OFF(spr[SPR_GQR0]) + gqr * 4);
-      FixupBranch no_fail = CBZ(W0);
-      FixupBranch fail = B();
-      SwitchToFarCode();
-      SetJumpTarget(fail);
-      MOVI2R(DISPATCHER_PC, js.blockStart);
-      STR(INDEX_UNSIGNED, DISPATCHER_PC, PPC_REG, PPCSTATE_OFF(pc));
-      MOVI2R(W0, (u32)JitInterface::ExceptionType::EXCEPTIONS_PAIRED_QUANTIZE);
-      MOVP2R(X1, &JitInterface::CompileExceptionCheck);
-      BLR(X1);
-      B(dispatcher);
-      SwitchToNearCode();
-      SetJumpTarget(no_fail);
-      js.assumeNoPairedQuantize = true;
+      if (value)
+      {
+        MOVI2R(W1, value);
+        CMP(W0, W1);
+        changed.push_back(B(CC_NEQ));
+      }
+      else
+      {
+        changed.push_back(CBNZ(W0));
+      }
     }
+    FixupBranch no_fail = B();
+    for (FixupBranch& branch : changed)
+      SetJumpTarget(branch);
+    FixupBranch fail = B();
+    SwitchToFarCode();
+    SetJumpTarget(fail);
+    MOVI2R(DISPATCHER_PC, js.blockStart);
+    STR(INDEX_UNSIGNED, DISPATCHER_PC, PPC_REG, PPCSTATE_OFF(pc));
+    MOVI2R(W0, (u32)JitInterface::ExceptionType::EXCEPTIONS_PAIRED_QUANTIZE);
+    MOVP2R(X1, &JitInterface::CompileExceptionCheck);
+    BLR(X1);
+    B(dispatcher);
+    SwitchToNearCode();
+    SetJumpTarget(no_fail);
   }
 
   gpr.Start(js.gpa);
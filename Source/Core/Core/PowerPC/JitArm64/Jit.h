@@ -186,6 +186,29 @@ private:
   // Do we support cycle counter profiling?
   bool m_supports_cycle_counter;
 
+  // Return address prediction of blr. bl pushes the guest return address with the host code
+  // continuing the caller there, blr pops the top entry and jumps there directly when it matches.
+  // The stack wraps around, so deep call chains only lose predictions.
+  static constexpr u32 RETURN_STACK_SIZE = 32;
+  // Never matches, blr wipes the bottom bits of its target
+  static constexpr u64 RETURN_STACK_EMPTY = 1;
+  struct ReturnStackEntry
+  {
+    u64 guest_address;
+    const u8* host_address;
+  };
+  struct ReturnStack
+  {
+    ReturnStackEntry entries[RETURN_STACK_SIZE];
+    u32 top;
+  };
+  ReturnStack m_return_stack;
+  bool m_enable_blr_optimization;
+
+  void ResetReturnStack();
+  u8* WriteReturnStackPush(u32 exit_address_after_return);
+  void WriteReturnContinuation(u8* host_address_load, u32 exit_address_after_return);
+
   void EmitResetCycleCounters();
   void EmitGetCycles(Arm64Gen::ARM64Reg reg);
 
@@ -230,8 +253,9 @@ private:
   void EndTimeProfile(JitBlock* b);
 
   // Exits
-  void WriteExit(u32 destination);
-  void WriteExit(Arm64Gen::ARM64Reg dest);
+  void WriteExit(u32 destination, bool LK = false, u32 exit_address_after_return = 0);
+  void WriteExit(Arm64Gen::ARM64Reg dest, bool LK = false, u32 exit_address_after_return = 0);
+  void WriteBLRExit(Arm64Gen::ARM64Reg dest);
   void WriteExceptionExit(u32 destination, bool only_external = false);
   void WriteExceptionExit(Arm64Gen::ARM64Reg dest, bool only_external = false);
 
@@ -108,7 +108,7 @@ void JitArm64::bx(UGeckoInstruction inst)
 		return;
   }
 
-  WriteExit(destination);
+  WriteExit(destination, inst.LK, js.compilerPC + 4);
 }
 
 void JitArm64::bcx(UGeckoInstruction inst)
@@ -158,7 +158,7 @@ void JitArm64::bcx(UGeckoInstruction inst)
   gpr.Flush(FlushMode::FLUSH_MAINTAIN_STATE);
   fpr.Flush(FlushMode::FLUSH_MAINTAIN_STATE);
 
-  WriteExit(destination);
+  WriteExit(destination, inst.LK, js.compilerPC + 4);
 
   SwitchToNearCode();
 
@@ -207,7 +207,7 @@ void JitArm64::bcctrx(UGeckoInstruction inst)
 
   LDR(INDEX_UNSIGNED, WA, PPC_REG, PPCSTATE_OFF(spr[SPR_CTR]));
   AND(WA, WA, 30, 29);  // Wipe the bottom 2 bits.
-  WriteExit(WA);
+  WriteExit(WA, inst.LK_3, js.compilerPC + 4);
 }
 
 void JitArm64::bclrx(UGeckoInstruction inst)
@@ -260,7 +260,7 @@ void JitArm64::bclrx(UGeckoInstruction inst)
   gpr.Flush(conditional ? FlushMode::FLUSH_MAINTAIN_STATE : FlushMode::FLUSH_ALL);
   fpr.Flush(conditional ? FlushMode::FLUSH_MAINTAIN_STATE : FlushMode::FLUSH_ALL);
 
-  WriteExit(WA);
+  WriteBLRExit(WA);
 
   if (conditional)
     SwitchToNearCode();
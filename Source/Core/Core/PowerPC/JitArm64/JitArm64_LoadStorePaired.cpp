@@ -62,7 +62,12 @@ void JitArm64::psq_l(UGeckoInstruction inst)
     MOV(arm_addr, addr_reg);
   }
 
-  if (js.assumeNoPairedQuantize)
+  auto it = js.constantGqr.find(inst.I);
+  const bool gqr_is_constant = it != js.constantGqr.end();
+  const u32 gqr = gqr_is_constant ? it->second >> 16 : 0;
+  const EQuantizeType type = static_cast<EQuantizeType>(gqr & 7);
+
+  if (gqr_is_constant && type == QUANTIZE_FLOAT)
   {
     VS = fpr.RW(inst.RS, REG_REG_SINGLE);
     if (!inst.W)
@@ -76,6 +81,51 @@ void JitArm64::psq_l(UGeckoInstruction inst)
     }
     m_float_emit.REV32(8, EncodeRegToDouble(VS), EncodeRegToDouble(VS));
   }
+  else if (gqr_is_constant && type >= QUANTIZE_U8)
+  {
+    // The same as the routine for the type in JitAsm, inlined with the scale folded in
+    const bool is_signed = type == QUANTIZE_S8 || type == QUANTIZE_S16;
+    const bool is_byte = type == QUANTIZE_U8 || type == QUANTIZE_S8;
+    const u32 scale = (gqr >> 8) & 0x3F;
+
+    ADD(EncodeRegTo64(addr_reg), EncodeRegTo64(addr_reg), MEM_REG);
+    if (is_byte)
+    {
+      m_float_emit.LDR(inst.W ? 8 : 16, INDEX_UNSIGNED, D0, EncodeRegTo64(addr_reg), 0);
+      if (is_signed)
+        m_float_emit.SXTL(8, D0, D0);
+      else
+        m_float_emit.UXTL(8, D0, D0);
+    }
+    else
+    {
+      if (inst.W)
+        m_float_emit.LDR(16, INDEX_UNSIGNED, D0, EncodeRegTo64(addr_reg), 0);
+      else
+        m_float_emit.LD1(16, 1, D0, EncodeRegTo64(addr_reg));
+      m_float_emit.REV16(8, D0, D0);
+    }
+    if (is_signed)
+    {
+      m_float_emit.SXTL(16, D0, D0);
+      m_float_emit.SCVTF(32, D0, D0);
+    }
+    else
+    {
+      m_float_emit.UXTL(16, D0, D0);
+      m_float_emit.UCVTF(32, D0, D0);
+    }
+
+    if (scale)
+    {
+      MOVP2R(EncodeRegTo64(type_reg), &m_dequantizeTableS[scale * 2]);
+      m_float_emit.LDR(32, INDEX_UNSIGNED, D1, EncodeRegTo64(type_reg), 0);
+      m_float_emit.FMUL(32, D0, D0, D1, 0);
+    }
+
+    VS = fpr.RW(inst.RS, REG_REG_SINGLE);
+    m_float_emit.ORR(EncodeRegToDouble(VS), D0, D0);
+  }
   else
   {
     LDR(INDEX_UNSIGNED, scale_reg, PPC_REG, PPCSTATE_OFF(spr[SPR_GQR0 + inst.I]));
@@ -154,7 +204,12 @@ void JitArm64::psq_st(UGeckoInstruction inst)
     MOV(arm_addr, addr_reg);
   }
 
-  if (js.assumeNoPairedQuantize)
+  auto it = js.constantGqr.find(inst.I);
+  const bool gqr_is_constant = it != js.constantGqr.end();
+  const u32 gqr = gqr_is_constant ? it->second & 0xFFFF : 0;
+  const EQuantizeType type = static_cast<EQuantizeType>(gqr & 7);
+
+  if (gqr_is_constant && type == QUANTIZE_FLOAT)
   {
     u32 flags = BackPatchInfo::FLAG_STORE;
 
@@ -180,9 +235,18 @@ void JitArm64::psq_st(UGeckoInstruction inst)
         m_float_emit.FCVTN(32, D0, VS);
     }
 
-    LDR(INDEX_UNSIGNED, scale_reg, PPC_REG, PPCSTATE_OFF(spr[SPR_GQR0 + inst.I]));
-    UBFM(type_reg, scale_reg, 0, 2);    // Type
-    UBFM(scale_reg, scale_reg, 8, 13);  // Scale
+    // A constant GQR calls the routine of its type directly with the scale in place
+    const bool known_type = gqr_is_constant && type >= QUANTIZE_U8;
+    if (known_type)
+    {
+      MOVI2R(scale_reg, (gqr >> 8) & 0x3F);
+    }
+    else
+    {
+      LDR(INDEX_UNSIGNED, scale_reg, PPC_REG, PPCSTATE_OFF(spr[SPR_GQR0 + inst.I]));
+      UBFM(type_reg, scale_reg, 0, 2);    // Type
+      UBFM(scale_reg, scale_reg, 8, 13);  // Scale
+    }
 
     // Inline address check
     // FIXME: This doesn't correctly account for the BAT configuration.
@@ -193,8 +257,15 @@ void JitArm64::psq_st(UGeckoInstruction inst)
     SwitchToFarCode();
     SetJumpTarget(fail);
     // Slow
-    MOVP2R(X30, &pairedStoreQuantized[16 + inst.W * 8]);
-    LDR(EncodeRegTo64(type_reg), X30, ArithOption(EncodeRegTo64(type_reg), true));
+    if (known_type)
+    {
+      MOVP2R(EncodeRegTo64(type_reg), pairedStoreQuantized[16 + inst.W * 8 + type]);
+    }
+    else
+    {
+      MOVP2R(X30, &pairedStoreQuantized[16 + inst.W * 8]);
+      LDR(EncodeRegTo64(type_reg), X30, ArithOption(EncodeRegTo64(type_reg), true));
+    }
 
     ABI_PushRegisters(gprs_in_use);
     m_float_emit.ABI_PushRegisters(fprs_in_use, X30);
@@ -206,9 +277,16 @@ void JitArm64::psq_st(UGeckoInstruction inst)
     SetJumpTarget(pass);
 
     // Fast
-    MOVP2R(X30, &pairedStoreQuantized[inst.W * 8]);
-    LDR(EncodeRegTo64(type_reg), X30, ArithOption(EncodeRegTo64(type_reg), true));
-    BLR(EncodeRegTo64(type_reg));
+    if (known_type)
+    {
+      BL(pairedStoreQuantized[inst.W * 8 + type]);
+    }
+    else
+    {
+      MOVP2R(X30, &pairedStoreQuantized[inst.W * 8]);
+      LDR(EncodeRegTo64(type_reg), X30, ArithOption(EncodeRegTo64(type_reg), true));
+      BLR(EncodeRegTo64(type_reg));
+    }
 
     SetJumpTarget(continue1);
   }
@@ -65,6 +65,8 @@ bool Jitx86Base::BackPatch(u32 emAddress, SContext* ctx)
 	// into the original code if necessary to ensure there is enough space
 	// to insert the backpatch jump.)
 
+	jit->js.fastmemFaults[info.pc]++;
+
 	jit->js.generatingTrampoline = true;
 	jit->js.trampolineExceptionHandler = exceptionHandler;
 
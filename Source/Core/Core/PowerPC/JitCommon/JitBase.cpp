@@ -12,8 +12,11 @@
 #include "Common/Logging/Log.h"
 #include "Common/StringUtil.h"
 #include "Core/ConfigManager.h"
+#include "Core/Core.h"
 #include "Core/HW/CPU.h"
+#include "Core/PowerPC/Interpreter/Interpreter.h"
 #include "Core/PowerPC/JitCommon/JitBase.h"
+#include "Core/PowerPC/JitInterface.h"
 #include "Core/PowerPC/PPCAnalyst.h"
 #include "Core/PowerPC/PowerPC.h"
 
@@ -21,7 +24,9 @@ JitBase* jit;
 
 void Jit(u32 em_address)
 {
-	jit->Jit(em_address);
+	JitInterface::CompileProfiledBlocks();
+	if (!jit->InterpretColdBlock(em_address))
+		jit->Jit(em_address);
 }
 
 u32 Helper_Mask(u8 mb, u8 me)
@@ -68,6 +73,35 @@ void LogGeneratedX86(int size, PPCAnalyst::CodeBuffer* code_buffer, const u8* no
 	}
 }
 
+bool JitBase::InterpretColdBlock(u32 em_address)
+{
+	// The dispatcher keeps looking for a block at the new PC without checking the downcount,
+	// so cold blocks are only interpreted while the slice lasts. Interpreted and compiled
+	// blocks don't account cycles the same way, keep the timing of the compiled code when
+	// the emulation has to be deterministic.
+	const SConfig& config = SConfig::GetInstance();
+	if (!HasColdBlockTier() || !config.bJITInterpretColdBlocks || Core::g_want_determinism ||
+		config.bEnableDebugging || PowerPC::ppcState.downcount <= 0)
+		return false;
+
+	u8& runs = m_cold_block_runs[(em_address >> 2) & (COLD_BLOCK_SLOTS - 1)];
+	if (runs >= COLD_BLOCK_RUNS)
+	{
+		runs = 0;
+		return false;
+	}
+	runs++;
+
+	// Same as the fast loop of Interpreter::Run, for a single block
+	Interpreter* interpreter = Interpreter::getInstance();
+	Interpreter::m_EndBlock = false;
+	int cycles = 0;
+	while (!Interpreter::m_EndBlock)
+		cycles += interpreter->SingleStepInner();
+	PowerPC::ppcState.downcount -= cycles;
+	return true;
+}
+
 bool JitBase::MergeAllowedNextInstructions(int count)
 {
 	if (CPU::GetState() == CPU::CPU_STEPPING || js.instructionsLeft < count)
@@ -90,4 +124,5 @@ void JitBase::UpdateMemoryOptions()
 	jo.fastmem = SConfig::GetInstance().bFastmem && !any_watchpoints;
 	jo.memcheck = SConfig::GetInstance().bMMU || any_watchpoints;
 	jo.alwaysUseMemFuncs = any_watchpoints;
+	jo.inlineTLBLookup = SConfig::GetInstance().bMMU && !any_watchpoints;
 }
@@ -8,7 +8,9 @@
 //#define JIT_LOG_GPR     // Enables logging of the PPC general purpose regs
 //#define JIT_LOG_FPR     // Enables logging of the PPC floating point regs
 
+#include <array>
 #include <map>
+#include <unordered_map>
 #include <unordered_set>
 
 #include "Common/CommonTypes.h"
@@ -70,6 +72,7 @@ protected:
 		bool fastmem;
 		bool memcheck;
 		bool alwaysUseMemFuncs;
+		bool inlineTLBLookup;
 	};
 	struct JitState
 	{
@@ -92,13 +95,14 @@ protected:
 		int revertGprLoad;
 		int revertFprLoad;
 
-		bool assumeNoPairedQuantize;
 		std::map<u8, u32> constantGqr;
 		bool firstFPInstructionFound;
 		bool isLastInstruction;
 		int skipInstructions;
 		bool carryFlagSet;
 		bool carryFlagInverted;
+		// FPSCR & 7 that the host rounding mode was last set from in this block, or -1 if unknown
+		int knownRoundingMode;
 
 		bool generatingTrampoline = false;
 		u8* trampolineExceptionHandler;
@@ -117,6 +121,10 @@ protected:
 		std::unordered_set<u32> fifoWriteAddresses;
 		std::unordered_set<u32> pairedQuantizeAddresses;
 		std::unordered_set<u32> noSpeculativeConstantsAddresses;
+		// Blocks whose branch profile is complete, see Jit64::BranchProfile
+		std::unordered_set<u32> branchProfiledAddresses;
+		// PPC address -> number of times a fastmem access of the instruction was backpatched
+		std::unordered_map<u32, u32> fastmemFaults;
 	};
 
 	PPCAnalyst::CodeBlock code_block;
@@ -126,16 +134,39 @@ protected:
 
 	void UpdateMemoryOptions();
 
+	// Runs until a block is compiled for an address, indexed by the masked address. Colliding
+	// addresses only make a block get compiled earlier or later.
+	static constexpr u32 COLD_BLOCK_SLOTS = 0x10000;
+	static constexpr u8 COLD_BLOCK_RUNS = 2;
+	std::array<u8, COLD_BLOCK_SLOTS> m_cold_block_runs{};
+
 public:
 	// This should probably be removed from public:
 	JitOptions jo;
 	JitState js;
 
+	// An instruction whose fastmem access faulted again after its block was compiled again is
+	// compiled without fastmem from then on
+	static constexpr u32 FASTMEM_FAULT_LIMIT = 2;
+	bool IsFastmemFaulting(u32 address) const
+	{
+		auto it = js.fastmemFaults.find(address);
+		return it != js.fastmemFaults.end() && it->second >= FASTMEM_FAULT_LIMIT;
+	}
+
 	static const u8* Dispatch() { return jit->GetBlockCache()->Dispatch(); };
 	virtual JitBaseBlockCache* GetBlockCache() = 0;
 
 	virtual void Jit(u32 em_address) = 0;
 
+	// Tiered compilation: the first COLD_BLOCK_RUNS times a block is dispatched it is run
+	// in the interpreter instead, so code that only runs a few times, like loading and
+	// initialization code, doesn't pay for its compilation. Returns false if the block at
+	// em_address should be compiled now.
+	bool InterpretColdBlock(u32 em_address);
+	// Cores which compile as fast as they interpret don't need a cold tier
+	virtual bool HasColdBlockTier() const { return true; }
+
 	virtual const CommonAsmRoutinesBase* GetAsmRoutines() = 0;
 
 	virtual bool HandleFault(uintptr_t access_address, SContext* ctx) = 0;
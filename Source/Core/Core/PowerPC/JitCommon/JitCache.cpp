@@ -9,15 +9,19 @@
 // performance hit, it's not enabled by default, but it's useful for
 // locating performance issues.
 
+#include <algorithm>
 #include <cstring>
 #include <map>
 #include <utility>
+#include <vector>
 
 #include "Common/CommonTypes.h"
+#include "Common/Hash.h"
 #include "Common/JitRegister.h"
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
 #include "Core/CoreTiming.h"
+#include "Core/HW/Memmap.h"
 #include "Core/PowerPC/JitCommon/JitBase.h"
 #include "Core/PowerPC/JitInterface.h"
 #include "Core/PowerPC/PowerPC.h"
@@ -46,6 +50,7 @@ void JitBaseBlockCache::Init()
 	JitRegister::Init(SConfig::GetInstance().m_perfDir);
 
 	iCache.fill(0);
+	num_blocks_compiled = 0;
 	Clear();
 }
 
@@ -68,6 +73,7 @@ void JitBaseBlockCache::Clear()
 #endif
 	jit->js.fifoWriteAddresses.clear();
 	jit->js.pairedQuantizeAddresses.clear();
+	jit->js.branchProfiledAddresses.clear();
 	for (int i = 1; i < num_blocks; i++)
 	{
 		DestroyBlock(i, false);
@@ -111,7 +117,9 @@ int JitBaseBlockCache::AllocateBlock(u32 em_address)
 	b.physicalAddress = PowerPC::JitCache_TranslateAddress(em_address).address;
 	b.msrBits = MSR & JitBlock::JIT_CACHE_MSR_MASK;
 	b.linkData.clear();
+	b.inlinedCode.clear();
 	num_blocks++;  // commit the current block
+	num_blocks_compiled++;
 	return num_blocks - 1;
 }
 
@@ -124,21 +132,15 @@ void JitBaseBlockCache::FinalizeBlock(int block_num, bool block_link, const u8*
 		// This should be very rare. This will only happen if the same block
 		// is called both with DR/IR enabled or disabled.
 		WARN_LOG(DYNA_REC, "Invalidating compiled block at same address %08x", b.physicalAddress);
-		int old_block_num = start_block_map[b.physicalAddress];
-		const JitBlock& old_b = blocks[old_block_num];
-		block_map.erase(
-			std::make_pair(old_b.physicalAddress + 4 * old_b.originalSize - 1, old_b.physicalAddress));
-		DestroyBlock(old_block_num, true);
+		DestroyBlock(start_block_map[b.physicalAddress], true);
 	}
 	start_block_map[b.physicalAddress] = block_num;
 	FastLookupEntryForAddress(b.effectiveAddress) = block_num;
 
-	u32 pAddr = b.physicalAddress;
-
-	for (u32 block = pAddr / 32; block <= (pAddr + (b.originalSize - 1) * 4) / 32; ++block)
-		valid_block.Set(block);
-
-	block_map[std::make_pair(pAddr + 4 * b.originalSize - 1, pAddr)] = block_num;
+	AddBlockRange(block_num, b.physicalAddress, b.originalSize);
+	for (const auto& inlined : b.inlinedCode)
+		AddBlockRange(block_num, inlined.first, inlined.second);
+	b.codeHash = HashBlockCode(b);
 
 	if (block_link)
 	{
@@ -153,6 +155,65 @@ void JitBaseBlockCache::FinalizeBlock(int block_num, bool block_link, const u8*
 	JitRegister::Register(b.checkedEntry, b.codeSize, "JIT_PPC_%08x", b.physicalAddress);
 }
 
+void JitBaseBlockCache::AddBlockRange(int block_num, u32 pAddr, u32 size)
+{
+	if (size == 0)
+		return;
+
+	for (u32 block = pAddr / 32; block <= (pAddr + (size - 1) * 4) / 32; ++block)
+		valid_block.Set(block);
+
+	for (u32 page = pAddr >> HW_PAGE_INDEX_SHIFT;
+		page <= (pAddr + (size - 1) * 4) >> HW_PAGE_INDEX_SHIFT; ++page)
+		block_map[page].insert(block_num);
+}
+
+void JitBaseBlockCache::RemoveBlockRange(int block_num, u32 pAddr, u32 size)
+{
+	if (size == 0)
+		return;
+
+	for (u32 page = pAddr >> HW_PAGE_INDEX_SHIFT;
+		page <= (pAddr + (size - 1) * 4) >> HW_PAGE_INDEX_SHIFT; ++page)
+	{
+		auto it = block_map.find(page);
+		if (it == block_map.end())
+			continue;
+		it->second.erase(block_num);
+		if (it->second.empty())
+			block_map.erase(it);
+	}
+}
+
+bool JitBaseBlockCache::BlockOverlaps(const JitBlock& b, u32 pAddr, u64 end) const
+{
+	auto overlaps = [pAddr, end](u32 start, u32 size) {
+		return start < end && static_cast<u64>(start) + 4 * size > pAddr;
+	};
+	if (overlaps(b.physicalAddress, b.originalSize))
+		return true;
+	for (const auto& inlined : b.inlinedCode)
+	{
+		if (overlaps(inlined.first, inlined.second))
+			return true;
+	}
+	return false;
+}
+
+u64 JitBaseBlockCache::HashBlockCode(const JitBlock& b) const
+{
+	u64 hash = 0;
+	auto add_range = [&hash](u32 start, u32 size) {
+		const u8* code = Memory::GetPointer(start);
+		if (code && size != 0)
+			hash = hash * 31 + GetMurmurHash3(code, size * 4, 0);
+	};
+	add_range(b.physicalAddress, b.originalSize);
+	for (const auto& inlined : b.inlinedCode)
+		add_range(inlined.first, inlined.second);
+	return hash;
+}
+
 int JitBaseBlockCache::GetBlockNumberFromStartAddress(u32 addr, u32 msr)
 {
 	u32 translated_addr = addr;
@@ -293,6 +354,10 @@ void JitBaseBlockCache::DestroyBlock(int block_num, bool invalidate)
 	start_block_map.erase(b.physicalAddress);
 	FastLookupEntryForAddress(b.effectiveAddress) = 0;
 
+	RemoveBlockRange(block_num, b.physicalAddress, b.originalSize);
+	for (const auto& inlined : b.inlinedCode)
+		RemoveBlockRange(block_num, inlined.first, inlined.second);
+
 	UnlinkBlock(block_num);
 
 	// Delete linking addresses
@@ -317,38 +382,52 @@ void JitBaseBlockCache::InvalidateICache(u32 address, const u32 length, bool for
 	u32 pAddr = translated.address;
 
 	// Optimize the common case of length == 32 which is used by Interpreter::dcb*
-	bool destroy_block = true;
-	if (length == 32)
+	if (length == 0 || (length == 32 && !valid_block.Test(pAddr / 32)))
+		return;
+
+	// Only the pages in the range are looked at. The blocks are collected first, since
+	// destroying a block removes it from its pages.
+	const u64 end = static_cast<u64>(pAddr) + length;
+	std::vector<int> overlapping;
+	auto last_page = block_map.upper_bound(static_cast<u32>((end - 1) >> HW_PAGE_INDEX_SHIFT));
+	for (auto it = block_map.lower_bound(pAddr >> HW_PAGE_INDEX_SHIFT); it != last_page; ++it)
 	{
-		if (!valid_block.Test(pAddr / 32))
-			destroy_block = false;
-		else
-			valid_block.Clear(pAddr / 32);
+		for (int block_num : it->second)
+		{
+			if (BlockOverlaps(blocks[block_num], pAddr, end))
+				overlapping.push_back(block_num);
+		}
 	}
+	std::sort(overlapping.begin(), overlapping.end());
+	overlapping.erase(std::unique(overlapping.begin(), overlapping.end()), overlapping.end());
 
-	// destroy JIT blocks
-	// !! this works correctly under assumption that any two overlapping blocks end at the same
-	// address
-	if (destroy_block)
+	bool kept = false, destroyed = false;
+	for (int block_num : overlapping)
 	{
-		auto it = block_map.lower_bound(std::make_pair(pAddr, 0));
-		while (it != block_map.end() && it->first.second < pAddr + length)
+		if (!forced && blocks[block_num].codeHash == HashBlockCode(blocks[block_num]))
 		{
-			DestroyBlock(it->second, true);
-			it = block_map.erase(it);
+			kept = true;
+			continue;
 		}
+		DestroyBlock(block_num, true);
+		destroyed = true;
+	}
 
-		// If the code was actually modified, we need to clear the relevant entries from the
-		// FIFO write address cache, so we don't end up with FIFO checks in places they shouldn't
-		// be (this can clobber flags, and thus break any optimization that relies on flags
-		// being in the right place between instructions).
-		if (!forced)
+	if (length == 32 && !kept)
+		valid_block.Clear(pAddr / 32);
+
+	// If the code was actually modified, we need to clear the relevant entries from the
+	// FIFO write address cache, so we don't end up with FIFO checks in places they shouldn't
+	// be (this can clobber flags, and thus break any optimization that relies on flags
+	// being in the right place between instructions).
+	if (!forced && (destroyed || !kept))
+	{
+		for (u32 i = address; i < address + length; i += 4)
 		{
-			for (u32 i = address; i < address + length; i += 4)
-			{
-				jit->js.fifoWriteAddresses.erase(i);
-				jit->js.pairedQuantizeAddresses.erase(i);
-			}
+			jit->js.fifoWriteAddresses.erase(i);
+			jit->js.pairedQuantizeAddresses.erase(i);
+			jit->js.branchProfiledAddresses.erase(i);
+			jit->js.fastmemFaults.erase(i);
 		}
 	}
 }
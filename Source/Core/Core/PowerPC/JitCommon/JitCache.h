@@ -8,6 +8,8 @@
 #include <bitset>
 #include <map>
 #include <memory>
+#include <set>
+#include <utility>
 #include <vector>
 
 #include "Common/CommonTypes.h"
@@ -49,6 +51,12 @@ struct JitBlock
 	// The number of PPC instructions represented by this block. Mostly
 	// useful for logging.
 	u32 originalSize;
+	// Leaf functions inlined into this block, as (physical address, number of instructions)
+	// pairs. They are invalidated along with the code at physicalAddress.
+	std::vector<std::pair<u32, u32>> inlinedCode;
+	// Hash of the PPC code of the block, including the inlined code. An invalidation which finds
+	// the same code, e.g. from an overlay that was loaded again, keeps the block.
+	u64 codeHash;
 	int runCount;  // for profiling.
 
 	// Whether this struct refers to a valid block. This is mostly useful as
@@ -117,14 +125,16 @@ private:
 	// Note: blocks[0] must not be used as it is referenced as invalid block in iCache.
 	std::array<JitBlock, MAX_NUM_BLOCKS> blocks;  // number -> JitBlock
 	int num_blocks;
+	// Blocks compiled since Init, including the ones that got cleared since
+	u64 num_blocks_compiled = 0;
 
 	// links_to hold all exit points of all valid blocks in a reverse way.
 	// It is used to query all blocks which links to an address.
 	std::multimap<u32, int> links_to;  // destination_PC -> number
 
-	// Map indexed by the physical memory location.
-	// It is used to invalidate blocks based on memory location.
-	std::map<std::pair<u32, u32>, u32> block_map;  // (end_addr, start_addr) -> number
+	// Map indexed by the physical page, with the blocks that have code in the page, including
+	// inlined leaf functions. It is used to invalidate blocks based on memory location.
+	std::map<u32, std::set<int>> block_map;  // physical_addr >> HW_PAGE_INDEX_SHIFT -> numbers
 
 	// Map indexed by the physical address of the entry point.
 	// This is used to query the block based on the current PC in a slow way.
@@ -144,6 +154,10 @@ private:
 	void UnlinkBlock(int i);
 
 	void DestroyBlock(int block_num, bool invalidate);
+	void AddBlockRange(int block_num, u32 pAddr, u32 size);
+	void RemoveBlockRange(int block_num, u32 pAddr, u32 size);
+	bool BlockOverlaps(const JitBlock& b, u32 pAddr, u64 end) const;
+	u64 HashBlockCode(const JitBlock& b) const;
 
 	void MoveBlockIntoFastCache(u32 em_address, u32 msr);
 
@@ -171,6 +185,7 @@ public:
 	JitBlock* GetBlocks() { return blocks.data(); }
 	int* GetICache() { return iCache.data(); }
 	int GetNumBlocks() const;
+	u64 GetNumBlocksCompiled() const { return num_blocks_compiled; }
 
 	// Look for the block in the slow but accurate way.
 	// This function shall be used if FastLookupEntryForAddress() failed.
@@ -2,6 +2,8 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <cstddef>
+
 #include "Core/PowerPC/JitCommon/Jit_Util.h"
 #include "Common/BitSet.h"
 #include "Common/CommonTypes.h"
@@ -242,13 +244,50 @@ FixupBranch EmuCodeBlock::CheckIfSafeAddress(const OpArg& reg_value, X64Reg reg_
 	return J_CC(CC_Z, farcode.Enabled());
 }
 
+bool EmuCodeBlock::JitTLBLookup(const PowerPC::JitTLB& tlb, X64Reg reg_addr, int accessSize,
+	BitSet32 registers_in_use, OpArg* host, FixupBranch* miss)
+{
+	registers_in_use[reg_addr] = true;
+
+	X64Reg scratch[2];
+	size_t count = 0;
+	for (X64Reg reg : { RSCRATCH, RSCRATCH2, RSCRATCH_EXTRA })
+	{
+		if (count < 2 && !registers_in_use[reg])
+			scratch[count++] = reg;
+	}
+	if (count < 2)
+		return false;
+
+	const X64Reg page = scratch[0];
+	const X64Reg offset = scratch[1];
+	const u32 table = (u32)(u64)&tlb[0];
+
+	MOV(32, R(page), R(reg_addr));
+	SHR(32, R(page), Imm8(HW_PAGE_INDEX_SHIFT - 4));
+	AND(32, R(page), Imm32((PowerPC::JIT_TLB_SIZE - 1) << 4));
+
+	// Tag of the page of the last byte, so accesses that cross into the next page miss
+	LEA(32, offset, MDisp(reg_addr, accessSize / 8 - 1));
+	AND(32, R(offset), Imm32(~((1 << HW_PAGE_INDEX_SHIFT) - 1)));
+	CMP(32, R(offset), MDisp(page, table + offsetof(PowerPC::JitTLBEntry, tag)));
+	*miss = J_CC(CC_NE);
+
+	MOV(64, R(page), MDisp(page, table + offsetof(PowerPC::JitTLBEntry, host_page)));
+	MOV(32, R(offset), R(reg_addr));
+	AND(32, R(offset), Imm32((1 << HW_PAGE_INDEX_SHIFT) - 1));
+	*host = MComplex(page, offset, SCALE_1, 0);
+	return true;
+}
+
 void EmuCodeBlock::SafeLoadToReg(X64Reg reg_value, const Gen::OpArg& opAddress, int accessSize,
 	s32 offset, BitSet32 registersInUse, bool signExtend, int flags)
 {
 	bool slowmem = (flags & SAFE_LOADSTORE_FORCE_SLOWMEM) != 0 || jit->jo.alwaysUseMemFuncs;
 
 	registersInUse[reg_value] = false;
-	if (jit->jo.fastmem && !(flags & SAFE_LOADSTORE_NO_FASTMEM) && !slowmem)
+	if (jit->jo.fastmem && !(flags & SAFE_LOADSTORE_NO_FASTMEM) && !slowmem &&
+		!jit->IsFastmemFaulting(jit->js.compilerPC))
 	{
 		u8* backpatchStart = GetWritableCodePtr();
 		MovInfo mov;
@@ -307,6 +346,26 @@ void EmuCodeBlock::SafeLoadToReg(X64Reg reg_value, const Gen::OpArg& opAddress,
 			exit = J(true);
 		SetJumpTarget(slow);
 	}
+
+	// Page table translated accesses, which fail the BAT check, may hit the JIT TLB
+	bool tlb_hit = false;
+	FixupBranch tlb_miss, tlb_exit;
+	if (fast_check_address && jit->jo.inlineTLBLookup)
+	{
+		BitSet32 tlb_registers = registersInUse;
+		OpArg host;
+		if (reg_value != reg_addr)
+			tlb_registers[reg_value] = false;
+		tlb_hit = JitTLBLookup(PowerPC::jit_read_tlb, reg_addr, accessSize, tlb_registers, &host,
+			&tlb_miss);
+		if (tlb_hit)
+		{
+			LoadAndSwap(accessSize, reg_value, host, signExtend);
+			tlb_exit = J(true);
+			SetJumpTarget(tlb_miss);
+		}
+	}
+
 	size_t rsp_alignment = (flags & SAFE_LOADSTORE_NO_PROLOG) ? 8 : 0;
 	ABI_PushRegistersAndAdjustStack(registersInUse, rsp_alignment);
 	switch (accessSize)
@@ -337,6 +396,9 @@ void EmuCodeBlock::SafeLoadToReg(X64Reg reg_value, const Gen::OpArg& opAddress,
 		MOVZX(64, accessSize, reg_value, R(ABI_RETURN));
 	}
 
+	if (tlb_hit)
+		SetJumpTarget(tlb_exit);
+
 	if (fast_check_address)
 	{
 		if (farcode.Enabled())
@@ -520,7 +582,8 @@ void EmuCodeBlock::SafeWriteRegToReg(OpArg reg_value, X64Reg reg_addr, int acces
 	// set the correct immediate format
 	reg_value = FixImmediate(accessSize, reg_value);
 
-	if (jit->jo.fastmem && !(flags & SAFE_LOADSTORE_NO_FASTMEM) && !slowmem)
+	if (jit->jo.fastmem && !(flags & SAFE_LOADSTORE_NO_FASTMEM) && !slowmem &&
+		!jit->IsFastmemFaulting(jit->js.compilerPC))
 	{
 		u8* backpatchStart = GetWritableCodePtr();
 		MovInfo mov;
@@ -576,8 +639,32 @@ void EmuCodeBlock::SafeWriteRegToReg(OpArg reg_value, X64Reg reg_addr, int acces
 		SetJumpTarget(slow);
 	}
 
+	bool tlb_hit = false;
+	FixupBranch tlb_miss, tlb_exit;
+	if (fast_check_address && jit->jo.inlineTLBLookup)
+	{
+		BitSet32 tlb_registers = registersInUse;
+		OpArg host;
+		if (reg_value.IsSimpleReg())
+			tlb_registers[reg_value.GetSimpleReg()] = true;
+		tlb_hit = JitTLBLookup(PowerPC::jit_write_tlb, reg_addr, accessSize, tlb_registers, &host,
+			&tlb_miss);
+		if (tlb_hit)
+		{
+			if (reg_value.IsImm())
+				MOV(accessSize, host, swap ? SwapImmediate(accessSize, reg_value) : reg_value);
+			else if (swap)
+				SwapAndStore(accessSize, host, reg_value.GetSimpleReg());
+			else
+				MOV(accessSize, host, reg_value);
+			tlb_exit = J(true);
+			SetJumpTarget(tlb_miss);
+		}
+	}
+
 	// PC is used by memory watchpoints (if enabled) or to print accurate PC locations in debug logs
-	MOV(32, PPCSTATE(pc), Imm32(jit->js.compilerPC));
+	if (!(flags & SAFE_LOADSTORE_PC_SET))
+		MOV(32, PPCSTATE(pc), Imm32(jit->js.compilerPC));
 
 	size_t rsp_alignment = (flags & SAFE_LOADSTORE_NO_PROLOG) ? 8 : 0;
 	ABI_PushRegistersAndAdjustStack(registersInUse, rsp_alignment);
@@ -613,6 +700,9 @@ void EmuCodeBlock::SafeWriteRegToReg(OpArg reg_value, X64Reg reg_addr, int acces
 
 	MemoryExceptionCheck();
 
+	if (tlb_hit)
+		SetJumpTarget(tlb_exit);
+
 	if (fast_check_address)
 	{
 		if (farcode.Enabled())
@@ -124,6 +124,11 @@ public:
 
 	Gen::FixupBranch CheckIfSafeAddress(const Gen::OpArg& reg_value, Gen::X64Reg reg_addr,
 		BitSet32 registers_in_use);
+	// Probes tlb for the page of an access at reg_addr. On a hit host is the address of the
+	// access in host memory, miss is taken if the page is not cached or the access crosses it.
+	// Returns false without emitting anything if there are no two free scratch registers.
+	bool JitTLBLookup(const PowerPC::JitTLB& tlb, Gen::X64Reg reg_addr, int accessSize,
+		BitSet32 registers_in_use, Gen::OpArg* host, Gen::FixupBranch* miss);
 	void UnsafeLoadRegToReg(Gen::X64Reg reg_addr, Gen::X64Reg reg_value, int accessSize,
 		s32 offset = 0, bool signExtend = false);
 	void UnsafeLoadRegToRegNoSwap(Gen::X64Reg reg_addr, Gen::X64Reg reg_value, int accessSize,
@@ -155,6 +160,8 @@ public:
 		// Force slowmem (used when generating fallbacks in trampolines)
 		SAFE_LOADSTORE_FORCE_SLOWMEM = 16,
 		SAFE_LOADSTORE_DR_ON = 32,
+		// The caller already stored the PC of the write, as the trampolines do
+		SAFE_LOADSTORE_PC_SET = 64,
 	};
 
 	void SafeLoadToReg(Gen::X64Reg reg_value, const Gen::OpArg& opAddress, int accessSize, s32 offset,
@@ -8,6 +8,7 @@
 #include "Common/CommonFuncs.h"
 #include "Common/CommonTypes.h"
 #include "Common/JitRegister.h"
+#include "Common/Logging/Log.h"
 #include "Common/x64ABI.h"
 #include "Common/x64Emitter.h"
 #include "Core/PowerPC/JitCommon/JitBase.h"
@@ -28,6 +29,15 @@ void TrampolineCache::Init(int size)
 
 void TrampolineCache::ClearCodeSpace()
 {
+	if (m_backpatches != 0)
+	{
+		INFO_LOG(DYNA_REC, "Trampoline cache cleared after %u backpatches, %u shared trampolines "
+			"used %u times", m_backpatches, GetSharedTrampolineCount(), m_shared_hits);
+	}
+	m_shared.clear();
+	m_backpatches = 0;
+	m_shared_hits = 0;
+
 	X64CodeBlock::ClearCodeSpace();
 }
 
@@ -38,6 +48,25 @@ void TrampolineCache::Shutdown()
 
 const u8* TrampolineCache::GenerateTrampoline(const TrampolineInfo& info)
 {
+	m_backpatches++;
+
+	// The shared code is called, so it has to realign the stack itself
+	if (!jit->js.trampolineExceptionHandler && !(info.flags & SAFE_LOADSTORE_NO_PROLOG) &&
+		info.op_arg.IsSimpleReg())
+	{
+		if (GetSpaceLeft() < 1024)
+			PanicAlert("Trampoline cache full");
+
+		const u8* shared = GetSharedTrampoline(info);
+		const u8* trampoline = GetCodePtr();
+		if (!info.read)
+			MOV(32, PPCSTATE(pc), Imm32(info.pc));
+		CALL(shared);
+		JMP(info.start + info.len, true);
+		JitRegister::Register(trampoline, GetCodePtr(), "JIT_TrampolineStub_%x", info.pc);
+		return trampoline;
+	}
+
 	if (info.read)
 	{
 		return GenerateReadTrampoline(info);
@@ -46,6 +75,39 @@ const u8* TrampolineCache::GenerateTrampoline(const TrampolineInfo& info)
 	return GenerateWriteTrampoline(info);
 }
 
+const u8* TrampolineCache::GetSharedTrampoline(const TrampolineInfo& info)
+{
+	const Signature signature(
+		info.accessSize | info.read << 4 | info.signExtend << 5 | info.flags << 8 |
+		info.op_reg << 16 | info.op_arg.GetSimpleReg() << 24,
+		info.registersInUse.m_val, info.offset);
+	auto it = m_shared.find(signature);
+	if (it != m_shared.end())
+	{
+		m_shared_hits++;
+		return it->second;
+	}
+
+	const u8* shared = GetCodePtr();
+	const int flags = info.flags | SAFE_LOADSTORE_FORCE_SLOWMEM | SAFE_LOADSTORE_NO_PROLOG |
+		SAFE_LOADSTORE_PC_SET;
+	if (info.read)
+	{
+		SafeLoadToReg(info.op_reg, info.op_arg, info.accessSize << 3, info.offset,
+			info.registersInUse, info.signExtend, flags);
+	}
+	else
+	{
+		SafeWriteRegToReg(info.op_arg, info.op_reg, info.accessSize << 3, info.offset,
+			info.registersInUse, flags);
+	}
+	RET();
+
+	JitRegister::Register(shared, GetCodePtr(), "JIT_SharedTrampoline_%x", info.pc);
+	m_shared.emplace(signature, shared);
+	return shared;
+}
+
 const u8* TrampolineCache::GenerateReadTrampoline(const TrampolineInfo& info)
 {
 	if (GetSpaceLeft() < 1024)
@@ -76,7 +138,7 @@ const u8* TrampolineCache::GenerateWriteTrampoline(const TrampolineInfo& info)
 	MOV(32, PPCSTATE(pc), Imm32(info.pc));
 
 	SafeWriteRegToReg(info.op_arg, info.op_reg, info.accessSize << 3, info.offset,
-		info.registersInUse, info.flags | SAFE_LOADSTORE_FORCE_SLOWMEM);
+		info.registersInUse, info.flags | SAFE_LOADSTORE_FORCE_SLOWMEM | SAFE_LOADSTORE_PC_SET);
 
 	JMP(info.start + info.len, true);
 
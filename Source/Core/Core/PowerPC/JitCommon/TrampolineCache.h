@@ -4,6 +4,9 @@
 
 #pragma once
 
+#include <map>
+#include <tuple>
+
 #include "Common/BitSet.h"
 #include "Common/CommonTypes.h"
 #include "Common/x64Emitter.h"
@@ -14,14 +17,30 @@ struct InstructionInfo;
 // We need at least this many bytes for backpatching.
 const int BACKPATCH_SIZE = 5;
 
+// Accesses that only differ in their PC share the code of the slow access, which returns to a
+// small stub per access that sets the PC and jumps back into the block. Accesses which check
+// for exceptions get a trampoline of their own.
 class TrampolineCache : public EmuCodeBlock
 {
 	const u8* GenerateReadTrampoline(const TrampolineInfo& info);
 	const u8* GenerateWriteTrampoline(const TrampolineInfo& info);
+	const u8* GetSharedTrampoline(const TrampolineInfo& info);
+
+	// (access size, read, sign extend and flags, registers in use, op_reg and op_arg, offset)
+	using Signature = std::tuple<u32, u32, s32>;
+	std::map<Signature, const u8*> m_shared;
+
+	u32 m_backpatches = 0;
+	u32 m_shared_hits = 0;
 
 public:
 	void Init(int size);
 	void Shutdown();
 	const u8* GenerateTrampoline(const TrampolineInfo& info);
 	void ClearCodeSpace();
+
+	// Since the last ClearCodeSpace
+	u32 GetBackpatchCount() const { return m_backpatches; }
+	u32 GetSharedTrampolineCount() const { return static_cast<u32>(m_shared.size()); }
+	u32 GetSharedHitCount() const { return m_shared_hits; }
 };
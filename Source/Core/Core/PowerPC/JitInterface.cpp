@@ -4,7 +4,11 @@
 
 #include <algorithm>
 #include <cinttypes>
+#include <map>
+#include <set>
 #include <string>
+#include <utility>
+#include <vector>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -12,8 +16,14 @@
 #include "Common/PerformanceCounter.h"
 #endif
 
+#include "Common/FileUtil.h"
+#include "Common/Hash.h"
+#include "Common/Logging/Log.h"
+#include "Common/StringUtil.h"
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
+#include "Core/HW/Memmap.h"
+#include "Core/PatchEngine.h"
 #include "Core/PowerPC/CachedInterpreter.h"
 #include "Core/PowerPC/JitCommon/JitBase.h"
 #include "Core/PowerPC/JitInterface.h"
@@ -35,6 +45,200 @@
 
 namespace JitInterface
 {
+struct ProfiledBlock
+{
+	u32 address;
+	u32 msr_bits;
+	// In instructions
+	u32 size;
+	u32 hash;
+	u32 run_count;
+};
+
+struct BlockProfileHeader
+{
+	u32 magic;
+	u32 version;
+	u32 count;
+};
+
+static constexpr u32 BLOCK_PROFILE_MAGIC = 0x4650424A;  // "JBPF"
+static constexpr u32 BLOCK_PROFILE_VERSION = 1;
+static constexpr size_t MAX_PROFILED_BLOCKS = JitBaseBlockCache::MAX_NUM_BLOCKS / 2;
+static constexpr int MAX_COMPILED_PER_CALL = 16;
+static constexpr int MAX_CHECKED_PER_CALL = 256;
+// Blocks that are not in RAM yet are retried, until this many passes over the profile
+// didn't compile anything.
+static constexpr int MAX_IDLE_PASSES = 4;
+
+static std::vector<ProfiledBlock> s_profiled_blocks;
+static std::vector<bool> s_profiled_block_done;
+static size_t s_profiled_blocks_left = 0;
+static size_t s_next_profiled_block = 0;
+static bool s_compiled_this_pass = false;
+static int s_idle_passes = 0;
+static bool s_block_profile_loaded = false;
+
+static std::string GetBlockProfilePath()
+{
+	const std::string& game_id = SConfig::GetInstance().GetGameID();
+	if (game_id.empty())
+		return "";
+	return File::GetUserPath(D_CACHE_IDX) + game_id + ".jitprofile";
+}
+
+// Hash of the code of a block, read directly from RAM so the emulated icache is not touched.
+// Returns 0 if the block is not entirely in RAM.
+static u32 HashBlockCode(u32 physical_address, u32 size)
+{
+	const u32 length = size * sizeof(u32);
+	const u32 address = physical_address & 0x3FFFFFFF;
+	const u8* ptr = nullptr;
+	if (address < Memory::REALRAM_SIZE && length <= Memory::REALRAM_SIZE - address)
+		ptr = Memory::m_pRAM + address;
+	else if (Memory::m_pEXRAM && (address >> 28) == 0x1 &&
+		length <= Memory::EXRAM_SIZE - (address & 0x0fffffff))
+		ptr = Memory::m_pEXRAM + (address & Memory::EXRAM_MASK);
+	if (!ptr || length == 0)
+		return 0;
+	return HashAdler32(ptr, length);
+}
+
+static void ResetBlockProfile()
+{
+	s_profiled_blocks.clear();
+	s_profiled_block_done.clear();
+	s_profiled_blocks_left = 0;
+	s_next_profiled_block = 0;
+	s_compiled_this_pass = false;
+	s_idle_passes = 0;
+	s_block_profile_loaded = false;
+}
+
+static void LoadBlockProfile()
+{
+	const std::string path = GetBlockProfilePath();
+	if (path.empty() || !File::Exists(path))
+		return;
+
+	File::IOFile file(path, "rb");
+	BlockProfileHeader header;
+	if (!file.ReadArray(&header, 1) || header.magic != BLOCK_PROFILE_MAGIC ||
+		header.version != BLOCK_PROFILE_VERSION || header.count > MAX_PROFILED_BLOCKS)
+	{
+		WARN_LOG(DYNA_REC, "Ignoring invalid JIT block profile %s", path.c_str());
+		return;
+	}
+
+	s_profiled_blocks.resize(header.count);
+	if (!file.ReadArray(s_profiled_blocks.data(), s_profiled_blocks.size()))
+	{
+		WARN_LOG(DYNA_REC, "Ignoring truncated JIT block profile %s", path.c_str());
+		s_profiled_blocks.clear();
+		return;
+	}
+	s_profiled_block_done.assign(s_profiled_blocks.size(), false);
+	s_profiled_blocks_left = s_profiled_blocks.size();
+	INFO_LOG(DYNA_REC, "Loaded %zu blocks from JIT block profile %s", s_profiled_blocks.size(),
+		path.c_str());
+}
+
+static void SaveBlockProfile()
+{
+	const std::string path = GetBlockProfilePath();
+	if (path.empty() || !SConfig::GetInstance().bJITWarmStart)
+		return;
+
+	// The blocks of this session come first, the hottest first. With block profiling off all
+	// run counts are 0 and the blocks stay in the order they were first compiled.
+	std::vector<ProfiledBlock> profile;
+	std::set<std::pair<u32, u32>> seen;
+	JitBaseBlockCache* cache = jit->GetBlockCache();
+	for (int i = 1; i < cache->GetNumBlocks(); i++)
+	{
+		const JitBlock* block = cache->GetBlock(i);
+		if (block->invalid)
+			continue;
+		const u32 hash = HashBlockCode(block->physicalAddress, block->originalSize);
+		if (hash == 0 || !seen.emplace(block->effectiveAddress, block->msrBits).second)
+			continue;
+		profile.push_back({ block->effectiveAddress, block->msrBits, block->originalSize, hash,
+			static_cast<u32>(std::max(block->runCount, 0)) });
+	}
+	std::stable_sort(profile.begin(), profile.end(),
+		[](const ProfiledBlock& a, const ProfiledBlock& b) { return a.run_count > b.run_count; });
+
+	// Keep the blocks of previous sessions that were not run this time, the cache may have
+	// been cleared or the game took another path.
+	for (const ProfiledBlock& block : s_profiled_blocks)
+	{
+		if (seen.emplace(block.address, block.msr_bits).second)
+			profile.push_back(block);
+	}
+	if (profile.empty())
+		return;
+	if (profile.size() > MAX_PROFILED_BLOCKS)
+		profile.resize(MAX_PROFILED_BLOCKS);
+
+	File::IOFile file(path, "wb");
+	const BlockProfileHeader header = { BLOCK_PROFILE_MAGIC, BLOCK_PROFILE_VERSION,
+		static_cast<u32>(profile.size()) };
+	if (!file.WriteArray(&header, 1) || !file.WriteArray(profile.data(), profile.size()))
+		WARN_LOG(DYNA_REC, "Failed to write JIT block profile %s", path.c_str());
+}
+
+void CompileProfiledBlocks()
+{
+	// The game ID and the main executable are only known once the game has booted
+	if (!s_block_profile_loaded)
+	{
+		s_block_profile_loaded = true;
+		if (SConfig::GetInstance().bJITWarmStart)
+			LoadBlockProfile();
+	}
+
+	// Compiling reads the code through the emulated icache, so don't change which lines get
+	// cached when the emulation has to be deterministic.
+	const SConfig& config = SConfig::GetInstance();
+	if (s_profiled_blocks_left == 0 || s_idle_passes >= MAX_IDLE_PASSES ||
+		Core::g_want_determinism || config.bEnableDebugging || config.bJITNoBlockCache)
+		return;
+
+	JitBaseBlockCache* cache = jit->GetBlockCache();
+	const u32 msr_bits = MSR & JitBlock::JIT_CACHE_MSR_MASK;
+	int compiled = 0;
+	for (int checked = 0; checked < MAX_CHECKED_PER_CALL && compiled < MAX_COMPILED_PER_CALL &&
+		!cache->IsFull(); checked++)
+	{
+		const size_t index = s_next_profiled_block;
+		if (++s_next_profiled_block == s_profiled_blocks.size())
+		{
+			s_next_profiled_block = 0;
+			s_idle_passes = s_compiled_this_pass ? 0 : s_idle_passes + 1;
+			s_compiled_this_pass = false;
+		}
+
+		const ProfiledBlock& block = s_profiled_blocks[index];
+		if (s_profiled_block_done[index] || block.msr_bits != msr_bits)
+			continue;
+
+		if (cache->GetBlockNumberFromStartAddress(block.address, MSR) < 0)
+		{
+			const PowerPC::TranslateResult translated = PowerPC::JitCache_TranslateAddress(block.address);
+			if (!translated.valid || HashBlockCode(translated.address, block.size) != block.hash)
+				continue;
+
+			jit->Jit(block.address);
+			compiled++;
+			s_compiled_this_pass = true;
+		}
+
+		s_profiled_block_done[index] = true;
+		if (--s_profiled_blocks_left == 0)
+			break;
+	}
+}
+
 void DoState(PointerWrap& p)
 {
 	if (jit && p.GetMode() == PointerWrap::MODE_READ)
@@ -69,6 +273,7 @@ CPUCoreBase* InitJitCore(int core)
 	}
 	jit = static_cast<JitBase*>(ptr);
 	jit->Init();
+	ResetBlockProfile();
 	return ptr;
 }
 void InitTables(int core)
@@ -124,6 +329,42 @@ void WriteProfileResults(const std::string& filename)
 			name.c_str(), stat.run_count, stat.cost, stat.tick_counter, percent, timePercent,
 			(double)stat.tick_counter * 1000.0 / (double)prof_stats.countsPerSec, stat.block_size);
 	}
+
+	fprintf(f.GetHandle(), "\nfuncAddr\tfuncName\tblocks\trunCount\ttimeCost\ttimePercent\tTime(ms)\n");
+	for (auto& stat : prof_stats.function_stats)
+	{
+		double timePercent = 100.0 * (double)stat.tick_counter / (double)prof_stats.timecost_sum;
+		fprintf(f.GetHandle(), "%08x\t%s\t%u\t%" PRIu64 "\t%" PRIu64 "\t%.2f\t%.2f\n", stat.addr,
+			stat.name.c_str(), stat.block_count, stat.run_count, stat.tick_counter, timePercent,
+			(double)stat.tick_counter * 1000.0 / (double)prof_stats.countsPerSec);
+	}
+
+	// Collapsed stacks for flamegraph.pl and compatible viewers, next to the text results
+	std::string folded_filename = filename.substr(0, filename.rfind('.')) + ".folded";
+	File::IOFile folded(folded_filename, "w");
+	if (!folded)
+	{
+		PanicAlert("Failed to open %s", folded_filename.c_str());
+		return;
+	}
+	for (auto& stat : prof_stats.block_stats)
+	{
+		if (stat.tick_counter == 0)
+			continue;
+		Symbol* symbol = g_symbolDB.GetSymbolFromAddr(stat.addr);
+		std::string name = symbol ? symbol->name : StringFromFormat("%08x", stat.addr);
+		// ';' separates the frames
+		std::replace(name.begin(), name.end(), ';', ':');
+		fprintf(folded.GetHandle(), "%s;%08x %" PRIu64 "\n", name.c_str(), stat.addr,
+			stat.tick_counter);
+	}
+}
+
+u64 GetNumBlocksCompiled()
+{
+	if (!jit)
+		return 0;
+	return jit->GetBlockCache()->GetNumBlocksCompiled();
 }
 
 void GetProfileResults(ProfileStats* prof_stats)
@@ -136,12 +377,16 @@ void GetProfileResults(ProfileStats* prof_stats)
 	prof_stats->timecost_sum = 0;
 	prof_stats->block_stats.clear();
 	prof_stats->block_stats.reserve(jit->GetBlockCache()->GetNumBlocks());
+	prof_stats->function_stats.clear();
 
 	Core::EState old_state = Core::GetState();
 	if (old_state == Core::CORE_RUN)
 		Core::SetState(Core::CORE_PAUSE);
 
-	QueryPerformanceFrequency((LARGE_INTEGER*)&prof_stats->countsPerSec);
+	if (Profiler::UseHostCycles())
+		prof_stats->countsPerSec = Profiler::GetHostCycleFrequency();
+	else
+		QueryPerformanceFrequency((LARGE_INTEGER*)&prof_stats->countsPerSec);
 	for (int i = 0; i < jit->GetBlockCache()->GetNumBlocks(); i++)
 	{
 		const JitBlock* block = jit->GetBlockCache()->GetBlock(i);
@@ -157,6 +402,27 @@ void GetProfileResults(ProfileStats* prof_stats)
 	}
 
 	sort(prof_stats->block_stats.begin(), prof_stats->block_stats.end());
+
+	std::map<u32, FunctionStat> functions;
+	for (const BlockStat& stat : prof_stats->block_stats)
+	{
+		Symbol* symbol = g_symbolDB.GetSymbolFromAddr(stat.addr);
+		u32 function_addr = symbol ? symbol->address : stat.addr;
+		auto it = functions.find(function_addr);
+		if (it == functions.end())
+		{
+			std::string name = symbol ? symbol->name : StringFromFormat("%08x", stat.addr);
+			it = functions.emplace(function_addr, FunctionStat(function_addr, name)).first;
+		}
+		it->second.tick_counter += stat.tick_counter;
+		it->second.run_count += stat.run_count;
+		it->second.block_count++;
+	}
+	prof_stats->function_stats.reserve(functions.size());
+	for (auto& function : functions)
+		prof_stats->function_stats.push_back(std::move(function.second));
+	sort(prof_stats->function_stats.begin(), prof_stats->function_stats.end());
+
 	if (old_state == Core::CORE_RUN)
 		Core::SetState(Core::CORE_RUN);
 }
@@ -241,6 +507,7 @@ void ClearSafe()
 
 void InvalidateICache(u32 address, u32 size, bool forced)
 {
+	PatchEngine::ApplyPatchesInRange(address, size);
 	if (jit)
 		jit->GetBlockCache()->InvalidateICache(address, size, forced);
 }
@@ -263,6 +530,9 @@ void CompileExceptionCheck(ExceptionType type)
 	case ExceptionType::EXCEPTIONS_SPECULATIVE_CONSTANTS:
 		exception_addresses = &jit->js.noSpeculativeConstantsAddresses;
 		break;
+	case ExceptionType::EXCEPTIONS_BRANCH_PROFILE:
+		exception_addresses = &jit->js.branchProfiledAddresses;
+		break;
 	}
 
 	if (PC != 0 && (exception_addresses->find(PC)) == (exception_addresses->end()))
@@ -286,6 +556,8 @@ void Shutdown()
 {
 	if (jit)
 	{
+		SaveBlockProfile();
+		ResetBlockProfile();
 		jit->Shutdown();
 		delete jit;
 		jit = nullptr;
@@ -16,7 +16,8 @@ enum class ExceptionType
 {
 	EXCEPTIONS_FIFO_WRITE,
 	EXCEPTIONS_PAIRED_QUANTIZE,
-	EXCEPTIONS_SPECULATIVE_CONSTANTS
+	EXCEPTIONS_SPECULATIVE_CONSTANTS,
+	EXCEPTIONS_BRANCH_PROFILE
 };
 
 void DoState(PointerWrap& p);
@@ -29,11 +30,18 @@ CPUCoreBase* GetCore();
 void WriteProfileResults(const std::string& filename);
 void GetProfileResults(ProfileStats* prof_stats);
 int GetHostCode(u32* address, const u8** code, u32* code_size);
+// Blocks compiled since the JIT started, 0 for the interpreter
+u64 GetNumBlocksCompiled();
 
 // Memory Utilities
 bool HandleFault(uintptr_t access_address, SContext* ctx);
 bool HandleStackFault();
 
+// Warm start: compiles a few of the blocks recorded in the block profile of the previous
+// session of this game ahead of their first execution. Called by the dispatcher before
+// compiling a missing block. The profile is written on shutdown.
+void CompileProfiledBlocks();
+
 // Clearing CodeCache
 void ClearCache();
 
@@ -160,6 +160,33 @@ static void EFB_Write(u32 data, u32 addr)
 BatTable ibat_table;
 BatTable dbat_table;
 
+JitTLB jit_read_tlb;
+JitTLB jit_write_tlb;
+
+static void UpdateJitTLB(JitTLB& tlb, u32 em_address, u32 physical_address)
+{
+	u8* host_page = nullptr;
+	if ((physical_address & 0xF8000000) == 0x00000000)
+		host_page = &Memory::m_pRAM[physical_address & Memory::RAM_MASK & ~(HW_PAGE_SIZE - 1)];
+	else if (Memory::m_pEXRAM && (physical_address >> 28) == 0x1 &&
+		(physical_address & 0x0FFFFFFF) < Memory::EXRAM_SIZE)
+		host_page = &Memory::m_pEXRAM[physical_address & 0x0FFFFFFF & ~(HW_PAGE_SIZE - 1)];
+	else
+		return;
+
+	JitTLBEntry& entry = tlb[(em_address >> HW_PAGE_INDEX_SHIFT) & (JIT_TLB_SIZE - 1)];
+	entry.tag = em_address & ~(HW_PAGE_SIZE - 1);
+	entry.host_page = host_page;
+}
+
+void ClearJitTLB()
+{
+	for (JitTLBEntry& entry : jit_read_tlb)
+		entry.tag = TLB_TAG_INVALID;
+	for (JitTLBEntry& entry : jit_write_tlb)
+		entry.tag = TLB_TAG_INVALID;
+}
+
 static void GenerateDSIException(u32 _EffectiveAddress, bool _bWrite);
 
 template <XCheckTLBFlag flag, typename T, bool never_translate = false>
@@ -198,6 +225,9 @@ static T ReadFromHardware(u32 em_address)
 			}
 			return var;
 		}
+		if (flag == FLAG_READ &&
+			translated_addr.result == TranslateAddressResult::PAGE_TABLE_TRANSLATED)
+			UpdateJitTLB(jit_read_tlb, em_address, translated_addr.address);
 		em_address = translated_addr.address;
 	}
 
@@ -280,6 +310,9 @@ static void WriteToHardware(u32 em_address, const T data)
 			}
 			return;
 		}
+		if (flag == FLAG_WRITE &&
+			translated_addr.result == TranslateAddressResult::PAGE_TABLE_TRANSLATED)
+			UpdateJitTLB(jit_write_tlb, em_address, translated_addr.address);
 		em_address = translated_addr.address;
 	}
 
@@ -923,6 +956,8 @@ static void GenerateISIException(u32 _EffectiveAddress)
 
 void SDRUpdated()
 {
+	ClearJitTLB();
+
 	u32 htabmask = SDR1_HTABMASK(PowerPC::ppcState.spr[SPR_SDR]);
 	u32 x = 1;
 	u32 xx = 0;
@@ -1028,6 +1063,14 @@ void InvalidateTLBEntry(u32 address)
 		&PowerPC::ppcState.tlb[1][(address >> HW_PAGE_INDEX_SHIFT) & HW_PAGE_INDEX_MASK];
 	tlbe_i->tag[0] = TLB_TAG_INVALID;
 	tlbe_i->tag[1] = TLB_TAG_INVALID;
+
+	// tlbie invalidates the whole congruence class, which spans several JIT TLB entries
+	for (u32 i = (address >> HW_PAGE_INDEX_SHIFT) & HW_PAGE_INDEX_MASK; i < JIT_TLB_SIZE;
+		i += HW_PAGE_INDEX_MASK + 1)
+	{
+		jit_read_tlb[i].tag = TLB_TAG_INVALID;
+		jit_write_tlb[i].tag = TLB_TAG_INVALID;
+	}
 }
 
 // Page Address Translation
@@ -1195,6 +1238,7 @@ static void UpdateFakeMMUBat(BatTable& bat_table, u32 start_addr)
 
 void DBATUpdated()
 {
+	ClearJitTLB();
 	dbat_table = {};
 	UpdateBATs(dbat_table, SPR_DBAT0U);
 	bool extended_bats = SConfig::GetInstance().bWii && HID4.SBE;
@@ -3,13 +3,19 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <map>
+#include <mutex>
 #include <queue>
 #include <string>
+#include <unordered_set>
+#include <vector>
 
 #include "Common/CommonTypes.h"
 #include "Common/Logging/Log.h"
 #include "Common/StringUtil.h"
+#include "Common/ThreadPool.h"
 #include "Core/ConfigManager.h"
+#include "Core/HLE/HLE.h"
 #include "Core/PowerPC/JitCommon/JitCache.h"
 #include "Core/PowerPC/PPCAnalyst.h"
 #include "Core/PowerPC/PPCSymbolDB.h"
@@ -35,6 +41,9 @@ constexpr int CODEBUFFER_SIZE = 32000;
 // 0 does not perform block merging
 constexpr u32 FUNCTION_FOLLOWING_THRESHOLD = 16;
 
+// Longest leaf function inlined into a block, including its blr.
+constexpr u32 LEAF_INLINE_MAX_INSTRUCTIONS = 16;
+
 constexpr u32 INVALID_BRANCH_TARGET = 0xFFFFFFFF;
 
 CodeBuffer::CodeBuffer(int size)
@@ -266,34 +275,56 @@ static bool CanSwapAdjacentOps(const CodeOp& a, const CodeOp& b)
 // called by another function. Therefore, let's scan the
 // entire space for bl operations and find what functions
 // get called.
+// Finding the calls only reads memory, so the range is scanned in parallel bands. The functions are
+// then added in the order of the calls, the same as scanning it in one go.
 static void FindFunctionsFromBranches(u32 startAddr, u32 endAddr, SymbolDB* func_db)
 {
-	for (u32 addr = startAddr; addr < endAddr; addr += 4)
-	{
-		const UGeckoInstruction instr = PowerPC::HostRead_Instruction(addr);
-
-		if (PPCTables::IsValidInstruction(instr))
+	std::mutex targets_lock;
+	std::map<int, std::vector<u32>> band_targets;
+	const int num_instructions = static_cast<int>((endAddr - startAddr + 3) / 4);
+	Common::ParallelLoop().Loop([&](int lower, int upper) {
+		std::vector<u32> targets;
+		for (int i = lower; i < upper; i++)
 		{
-			switch (instr.OPCD)
-			{
-			case 18:  // branch instruction
+			const u32 addr = startAddr + i * 4;
+			const UGeckoInstruction instr = PowerPC::HostRead_Instruction(addr);
+
+			if (PPCTables::IsValidInstruction(instr))
 			{
-				if (instr.LK)  // bl
+				switch (instr.OPCD)
 				{
-					u32 target = SignExt26(instr.LI << 2);
-					if (!instr.AA)
-						target += addr;
-					if (PowerPC::HostIsRAMAddress(target))
+				case 18:  // branch instruction
+				{
+					if (instr.LK)  // bl
 					{
-						func_db->AddFunction(target);
+						u32 target = SignExt26(instr.LI << 2);
+						if (!instr.AA)
+							target += addr;
+						if (PowerPC::HostIsRAMAddress(target))
+						{
+							targets.push_back(target);
+						}
 					}
 				}
-			}
-			break;
-			default:
 				break;
+				default:
+					break;
+				}
 			}
 		}
+		std::lock_guard<std::mutex> lk(targets_lock);
+		band_targets[lower] = std::move(targets);
+	}, 0, num_instructions, 0x10000);
+
+	// Most functions are called from many places, only the first call adds them
+	std::unordered_set<u32> seen;
+	for (const auto& band : band_targets)
+	{
+		for (u32 target : band.second)
+		{
+			if (seen.insert(target).second)
+				func_db->AddFunction(target);
+		}
 	}
 }
 
@@ -485,6 +516,95 @@ void PPCAnalyzer::ReorderInstructions(u32 instructions, CodeOp* code)
 		ReorderInstructionsCore(instructions, code, false, REORDER_CMP);
 }
 
+// Integer ALU ops that can't leave the block and only touch GPRs
+static bool isPureIntegerOp(const CodeOp& a)
+{
+	return a.opinfo->type == OPTYPE_INTEGER && !a.canEndBlock && !a.isBranchTarget;
+}
+
+// Branches that have no effect other than leaving the loop
+static bool IsPlainBranch(const CodeOp& a)
+{
+	const UGeckoInstruction inst = a.inst;
+	if (inst.OPCD == 18)  // bx
+		return !inst.LK;
+	if (inst.OPCD == 16)  // bcx
+		return !inst.LK && (inst.BO & BO_DONT_DECREMENT_FLAG);
+	return false;
+}
+
+void PPCAnalyzer::FindIdleLoop(CodeBlock* block, CodeOp* code)
+{
+	// A register that the loop reads before writing it must not be written anywhere in the loop,
+	// otherwise an iteration could depend on the previous one.
+	BitSet32 read_first, written;
+	for (u32 i = 0; i < block->m_num_instructions; i++)
+	{
+		const CodeOp& op = code[i];
+		if (op.skip)
+			continue;
+
+		if (op.opinfo->type == OPTYPE_BRANCH)
+		{
+			if (!IsPlainBranch(op))
+				return;
+
+			u32 destination;
+			if (op.inst.OPCD == 18)
+				destination = (op.inst.AA ? 0 : op.address) + SignExt26(op.inst.LI << 2);
+			else
+				destination = (op.inst.AA ? 0 : op.address) + SignExt16(op.inst.BD << 2);
+			if (destination == block->m_address)
+			{
+				code[i].branchIsIdleLoop = true;
+				INFO_LOG(POWERPC, "Idle loop at %08x, %u instructions", block->m_address, i + 1);
+				return;
+			}
+			// Forward branches out of the loop are fine, anything else isn't a simple loop
+			if (destination > block->m_address && destination <= op.address)
+				return;
+			continue;
+		}
+
+		if (op.opinfo->type != OPTYPE_INTEGER && op.opinfo->type != OPTYPE_LOAD)
+			return;
+		if (op.wantsCA || op.canEndBlock)
+			return;
+
+		read_first |= op.regsIn & ~written;
+		if (op.regsOut & read_first)
+			return;
+		written |= op.regsOut;
+	}
+}
+
+void PPCAnalyzer::EliminateDeadWrites(u32 instructions, CodeOp* code)
+{
+	for (u32 i = 0; i < instructions; i++)
+	{
+		CodeOp& a = code[i];
+		// The op may only have the register as its side effect
+		if (a.skip || !isPureIntegerOp(a) || a.regsOut.Count() != 1 || a.outputCR0 || a.outputCR1 ||
+			a.outputCA || (a.opinfo->flags & FL_SET_OE))
+			continue;
+
+		const int reg = *a.regsOut.begin();
+		for (u32 j = i + 1; j < instructions && isPureIntegerOp(code[j]); j++)
+		{
+			if (code[j].regsIn[reg])
+				break;
+			if (code[j].regsOut[reg])
+			{
+				// The value never escapes, the instruction still counts towards the downcount
+				a.skip = true;
+				a.regsIn = BitSet32(0);
+				a.regsOut = BitSet32(0);
+				break;
+			}
+		}
+	}
+}
+
 void PPCAnalyzer::SetInstructionStats(CodeBlock* block, CodeOp* code, GekkoOPInfo* opinfo,
 	u32 index)
 {
@@ -626,6 +746,47 @@ void PPCAnalyzer::SetInstructionStats(CodeBlock* block, CodeOp* code, GekkoOPInf
 	}
 }
 
+static bool IsUnconditionalReturn(UGeckoInstruction inst)
+{
+	return inst.OPCD == 19 && inst.SUBOP10 == 16 && (inst.BO & BO_DONT_DECREMENT_FLAG) &&
+		(inst.BO & BO_DONT_CHECK_CONDITION) && !inst.LK;
+}
+
+// Returns the number of instructions of the leaf function at address including its blr, or 0
+// if it can't be inlined. A leaf function here is straight line code without a stack frame which
+// doesn't touch any SPRs or the MSR, so LR still holds the return address at the blr.
+static u32 GetInlinableLeafSize(u32 address)
+{
+	// HLE hooks are only checked at the start of the function
+	if (HLE::GetFunctionIndex(address) != 0)
+		return 0;
+
+	for (u32 i = 0; i < LEAF_INLINE_MAX_INSTRUCTIONS; i++, address += 4)
+	{
+		// The block cache needs a fixed physical address to invalidate the inlined code
+		auto result = PowerPC::TryReadInstruction(address);
+		if (!result.valid || !result.from_bat)
+			return 0;
+
+		UGeckoInstruction inst = result.hex;
+		if (IsUnconditionalReturn(inst))
+			return i + 1;
+
+		const GekkoOPInfo* opinfo = GetOpInfo(inst);
+		if (!opinfo || (opinfo->flags & FL_ENDBLOCK) || opinfo->type == OPTYPE_INVALID ||
+			opinfo->type == OPTYPE_UNKNOWN || opinfo->type == OPTYPE_BRANCH ||
+			opinfo->type == OPTYPE_SPR || opinfo->type == OPTYPE_SYSTEM ||
+			opinfo->type == OPTYPE_ICACHE)
+		{
+			return 0;
+		}
+
+		if (((opinfo->flags & FL_OUT_A) && inst.RA == 1) || ((opinfo->flags & FL_OUT_D) && inst.RD == 1))
+			return 0;
+	}
+	return 0;
+}
+
 u32 PPCAnalyzer::Analyze(u32 address, CodeBlock* block, CodeBuffer* buffer, u32 blockSize)
 {
 	// Clear block stats
@@ -646,12 +807,14 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock* block, CodeBuffer* buffer, u32
 	block->m_memory_exception = false;
 	block->m_num_instructions = 0;
 	block->m_gqr_used = BitSet8(0);
+	block->m_inlined.clear();
 
 	CodeOp* code = buffer->codebuffer;
 
 	bool found_exit = false;
 	u32 return_address = 0;
 	u32 numFollows = 0;
+	u32 inline_start = 0;
 	u32 num_inst = 0;
 	bool prev_inst_from_bat = true;
 
@@ -698,47 +861,34 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock* block, CodeBuffer* buffer, u32
 		// Do we inline leaf functions?
 		if (HasOption(OPTION_LEAF_INLINE))
 		{
-			if (inst.OPCD == 18 && blockSize > 1)
-			{
-				// Is bx - should we inline? yes!
-				if (inst.AA)
-					destination = SignExt26(inst.LI << 2);
-				else
-					destination = address + SignExt26(inst.LI << 2);
-				if (destination != block->m_address)
-					follow = true;
-			}
-			else if (inst.OPCD == 19 && inst.SUBOP10 == 16 && (inst.BO & (1 << 4)) &&
-				(inst.BO & (1 << 2)) && return_address != 0)
+			if (return_address != 0 && IsUnconditionalReturn(inst))
 			{
-				// bclrx with unconditional branch = return
+				// The end of the inlined function, continue after the bl
 				follow = true;
 				destination = return_address;
 				return_address = 0;
-
-				if (inst.LK)
-					return_address = address + 4;
+				code[i].skip = true;
+				block->m_inlined.back().second = i - inline_start + 1;
 			}
-			else if (inst.OPCD == 31 && inst.SUBOP10 == 467)
+			else if (inst.OPCD == 18 && inst.LK && return_address == 0 &&
+				numFollows < FUNCTION_FOLLOWING_THRESHOLD)
 			{
-				// mtspr
-				const u32 index = (inst.SPRU << 5) | (inst.SPRL & 0x1F);
-				if (index == SPR_LR)
+				if (inst.AA)
+					destination = SignExt26(inst.LI << 2);
+				else
+					destination = address + SignExt26(inst.LI << 2);
+
+				// Leave room for at least one instruction after the return, the bl can't be the last
+				// instruction of the block either way.
+				const u32 leaf_size = GetInlinableLeafSize(destination);
+				if (leaf_size != 0 && i + leaf_size + 1 < blockSize)
 				{
-					// We give up to follow the return address
-					// because we have to check the register usage.
-					return_address = 0;
+					follow = true;
+					return_address = address + 4;
+					inline_start = i + 1;
+					block->m_inlined.emplace_back(destination, 0);
 				}
 			}
-
-			// TODO: Find the optimal value for FUNCTION_FOLLOWING_THRESHOLD.
-			//       If it is small, the performance will be down.
-			//       If it is big, the size of generated code will be big and
-			//       cache clearning will happen many times.
-			// TODO: Investivate the reason why
-			//       "0" is fastest in some games, MP2 for example.
-			if (numFollows > FUNCTION_FOLLOWING_THRESHOLD)
-				follow = false;
 		}
 
 		if (HasOption(OPTION_CONDITIONAL_CONTINUE))
@@ -777,25 +927,31 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock* block, CodeBuffer* buffer, u32
 				break;
 			}
 		}
-		// XXX: We don't support inlining yet.
-#if 0
 		else
 		{
 			numFollows++;
-			// We don't "code[i].skip = true" here
-			// because bx may store a certain value to the link register.
+			// We don't "code[i].skip = true" on the bl
+			// because it has to store the return address to the link register.
 			// Instead, we skip a part of bx in Jit**::bx().
 			address = destination;
-			merged_addresses[size_of_merged_addresses++] = address;
 		}
-#endif
 	}
 
+	// The block ended inside of an inlined function, e.g. on a page fault
+	if (return_address != 0)
+		block->m_inlined.back().second = num_inst - inline_start;
+
 	block->m_num_instructions = num_inst;
 
 	if (block->m_num_instructions > 1)
 		ReorderInstructions(block->m_num_instructions, code);
 
+	if (HasOption(OPTION_DEAD_WRITE_ELIMINATION))
+		EliminateDeadWrites(block->m_num_instructions, code);
+
+	if (HasOption(OPTION_IDLE_LOOP_DETECTION))
+		FindIdleLoop(block, code);
+
 	if ((!found_exit && num_inst > 0) || blockSize == 1)
 	{
 		// We couldn't find an exit
@@ -8,6 +8,7 @@
 #include <cstdlib>
 #include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "Common/BitSet.h"
@@ -42,6 +43,8 @@ struct CodeOp  // 16B
 	bool outputCA;
 	bool canEndBlock;
 	bool skip;  // followed BL-s for example
+	// branch back to the start of a block that only polls memory, see OPTION_IDLE_LOOP_DETECTION
+	bool branchIsIdleLoop;
 	// which registers are still needed after this instruction in this block
 	BitSet32 fprInUse;
 	BitSet32 gprInUse;
@@ -157,6 +160,10 @@ struct CodeBlock
 
 	// Which GPRs this block reads from before defining, if any.
 	BitSet32 m_gpr_inputs;
+
+	// Leaf functions inlined into this block, as (address, number of instructions) pairs.
+	// The instructions of the block outside of these are contiguous from m_address.
+	std::vector<std::pair<u32, u32>> m_inlined;
 };
 
 class PPCAnalyzer
@@ -171,6 +178,8 @@ private:
 
 	void ReorderInstructionsCore(u32 instructions, CodeOp* code, bool reverse, ReorderType type);
 	void ReorderInstructions(u32 instructions, CodeOp* code);
+	void EliminateDeadWrites(u32 instructions, CodeOp* code);
+	void FindIdleLoop(CodeBlock* block, CodeOp* code);
 	void SetInstructionStats(CodeBlock* block, CodeOp* code, GekkoOPInfo* opinfo, u32 index);
 
 	// Options
@@ -185,10 +194,9 @@ public:
 		// Requires JIT support to be enabled.
 		OPTION_CONDITIONAL_CONTINUE = (1 << 0),
 
-		// If there is a unconditional branch that jumps to a leaf function then inline it.
-		// Might require JIT intervention to support it correctly.
-		// Requires JITBLock support for inlined code
-		// XXX: NOT COMPLETE
+		// If there is a bl to a short leaf function then inline it, up to its blr.
+		// The bl still has to set LR when it isn't the last instruction, and the blr is skipped.
+		// The callee code is listed in CodeBlock::m_inlined so the block cache can invalidate it.
 		OPTION_LEAF_INLINE = (1 << 1),
 
 		// Complex blocks support jumping backwards on to themselves.
@@ -213,6 +221,15 @@ public:
 
 		// Reorder cror instructions next to their associated fcmp.
 		OPTION_CROR_MERGE = (1 << 6),
+
+		// Skip integer instructions whose result is overwritten before it is read, with
+		// nothing in between that could leave the block.
+		OPTION_DEAD_WRITE_ELIMINATION = (1 << 7),
+
+		// Mark the branch back to the start of a busy wait loop, which only loads from memory,
+		// computes on the values and branches, as branchIsIdleLoop. Every iteration does the same
+		// until an event changes the memory, so the JIT skips ahead to the next event instead.
+		OPTION_IDLE_LOOP_DETECTION = (1 << 8),
 	};
 
 	PPCAnalyzer() : m_options(0) {}
@@ -61,6 +61,7 @@ void InstructionCache::Reset()
 	memset(lookup_table, 0xff, sizeof(lookup_table));
 	memset(lookup_table_ex, 0xff, sizeof(lookup_table_ex));
 	memset(lookup_table_vmem, 0xff, sizeof(lookup_table_vmem));
+	last_line = ICACHE_INVALID_LINE;
 	JitInterface::ClearSafe();
 }
 
@@ -68,6 +69,8 @@ void InstructionCache::Init()
 {
 	memset(data, 0, sizeof(data));
 	memset(tags, 0, sizeof(tags));
+	last_set = 0;
+	last_way = 0;
 
 	Reset();
 }
@@ -89,6 +92,8 @@ void InstructionCache::Invalidate(u32 addr)
 				lookup_table[((tags[set][i] << 7) | set) & 0xfffff] = 0xff;
 		}
 	valid[set] = 0;
+	if (((last_line >> 5) & 0x7f) == set)
+		last_line = ICACHE_INVALID_LINE;
 	JitInterface::InvalidateICache(addr & ~0x1f, 32, false);
 }
 
@@ -96,6 +101,8 @@ u32 InstructionCache::ReadInstruction(u32 addr)
 {
 	if (!HID0.ICE)  // instruction cache is disabled
 		return Memory::Read_U32(addr);
+	if ((addr & ~0x1f) == last_line)
+		return Common::swap32(data[last_set][last_way][(addr >> 2) & 7]);
 	u32 set = (addr >> 5) & 0x7f;
 	u32 tag = addr >> 12;
 
@@ -145,6 +152,9 @@ u32 InstructionCache::ReadInstruction(u32 addr)
 	}
 	// update plru
 	plru[set] = (plru[set] & ~s_plru_mask[t]) | s_plru_value[t];
+	last_line = addr & ~0x1f;
+	last_set = set;
+	last_way = t;
 	u32 res = Common::swap32(data[set][t][(addr >> 2) & 7]);
 	return res;
 }
@@ -15,6 +15,8 @@ const u32 ICACHE_BLOCK_SIZE = 8;
 
 const u32 ICACHE_EXRAM_BIT = 0x10000000;
 const u32 ICACHE_VMEM_BIT = 0x20000000;
+// Not a line address, those are 32 byte aligned
+const u32 ICACHE_INVALID_LINE = 0xffffffff;
 
 struct InstructionCache
 {
@@ -30,6 +32,13 @@ struct InstructionCache
 	u8 lookup_table_ex[1 << 21];
 	u8 lookup_table_vmem[1 << 20];
 
+	// Address of the line the last fetch hit and where it is. Fetches mostly run through a line, so
+	// those after the first skip the lookup, and the PLRU bits, which already point away from it.
+	// Indices rather than a pointer, this is part of the savestates.
+	u32 last_line;
+	u32 last_set;
+	u32 last_way;
+
 	InstructionCache();
 	u32 ReadInstruction(u32 addr);
 	void Invalidate(u32 addr);
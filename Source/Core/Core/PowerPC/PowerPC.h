@@ -269,6 +269,7 @@ void SDRUpdated();
 void InvalidateTLBEntry(u32 address);
 void DBATUpdated();
 void IBATUpdated();
+void ClearJitTLB();
 
 // Result changes based on the BAT registers and MSR.DR.  Returns whether
 // it's safe to optimize a read or write to this address to an unguarded
@@ -297,6 +298,22 @@ inline bool TranslateBatAddess(const BatTable& bat_table, u32* address)
 	*address = (bat_result & ~3) | (*address & 0x0001FFFF);
 	return true;
 }
+
+// Direct mapped cache of the page table translations to RAM, which the JIT probes before it
+// calls the memory functions. Write entries are only added by writes, which have already set
+// the C bit of the page. Cleared whenever a segment register, SDR1, the BATs or the TLB change.
+struct JitTLBEntry
+{
+	// Effective address of the page, or TLB_TAG_INVALID
+	u32 tag;
+	u32 padding;
+	u8* host_page;
+};
+static_assert(sizeof(JitTLBEntry) == 16, "The JIT indexes the TLB with a shift");
+static const u32 JIT_TLB_SIZE = 256;
+using JitTLB = std::array<JitTLBEntry, JIT_TLB_SIZE>;
+extern JitTLB jit_read_tlb;
+extern JitTLB jit_write_tlb;
 }  // namespace
 
 enum CRBits
@@ -4,12 +4,44 @@
 
 #include "Core/PowerPC/Profiler.h"
 #include <string>
+#include "Common/Intrinsics.h"
+#include "Common/Thread.h"
+#include "Core/ConfigManager.h"
 #include "Core/PowerPC/JitInterface.h"
 
 namespace Profiler
 {
 bool g_ProfileBlocks;
 
+bool UseHostCycles()
+{
+#if defined(_M_X86_64)
+	return SConfig::GetInstance().bJITProfileHostCycles;
+#else
+	return false;
+#endif
+}
+
+u64 GetHostCycleFrequency()
+{
+	static u64 s_frequency = 0;
+#if defined(_M_X86_64)
+	if (s_frequency == 0)
+	{
+		u64 counts_per_sec, start, stop;
+		QueryPerformanceFrequency((LARGE_INTEGER*)&counts_per_sec);
+		QueryPerformanceCounter((LARGE_INTEGER*)&start);
+		u64 tsc_start = __rdtsc();
+		Common::SleepCurrentThread(50);
+		u64 tsc_stop = __rdtsc();
+		QueryPerformanceCounter((LARGE_INTEGER*)&stop);
+		if (stop > start)
+			s_frequency = (tsc_stop - tsc_start) * counts_per_sec / (stop - start);
+	}
+#endif
+	return s_frequency;
+}
+
 void WriteProfileResults(const std::string& filename)
 {
 	JitInterface::WriteProfileResults(filename);
@@ -18,6 +18,14 @@
   MOV(64, R(ABI_PARAM1), Imm64(reinterpret_cast<u64>(pt)));                                        \
   ABI_CallFunction(QueryPerformanceCounter)
 
+// *pt = rdtsc, without a call. Clobbers RAX and RDX.
+#define PROFILER_READ_TIME_STAMP_COUNTER(pt)                                                       \
+  RDTSC();                                                                                         \
+  SHL(64, R(RDX), Imm8(32));                                                                       \
+  OR(64, R(RAX), R(RDX));                                                                          \
+  MOV(64, R(RDX), Imm64(reinterpret_cast<u64>(pt)));                                               \
+  MOV(64, MatR(RDX), R(RAX))
+
 // block->ticCounter += block->ticStop - block->ticStart
 #define PROFILER_UPDATE_TIME(block)                                                                \
   MOV(64, R(RSCRATCH2), Imm64((u64)block));                                                        \
@@ -35,6 +43,7 @@
 #else
 
 #define PROFILER_QUERY_PERFORMANCE_COUNTER(pt)
+#define PROFILER_READ_TIME_STAMP_COUNTER(pt)
 #define PROFILER_UPDATE_TIME(b)
 #define PROFILER_VPUSH
 #define PROFILER_VPOP
@@ -56,9 +65,22 @@ struct BlockStat
 
 	bool operator<(const BlockStat& other) const { return cost > other.cost; }
 };
+// The blocks of a PPCSymbolDB function, blocks outside of any symbol are their own function
+struct FunctionStat
+{
+	FunctionStat(u32 _addr, const std::string& _name) : addr(_addr), name(_name) {}
+	u32 addr;
+	std::string name;
+	u64 tick_counter = 0;
+	u64 run_count = 0;
+	u32 block_count = 0;
+
+	bool operator<(const FunctionStat& other) const { return tick_counter > other.tick_counter; }
+};
 struct ProfileStats
 {
 	std::vector<BlockStat> block_stats;
+	std::vector<FunctionStat> function_stats;
 	u64 cost_sum;
 	u64 timecost_sum;
 	u64 countsPerSec;
@@ -68,5 +90,11 @@ namespace Profiler
 {
 extern bool g_ProfileBlocks;
 
+// Whether the block times are host cycles read inline with rdtsc (SConfig::bJITProfileHostCycles)
+// instead of calls to QueryPerformanceCounter. Only changes for blocks compiled afterwards.
+bool UseHostCycles();
+// Time stamp counter ticks per second, measured on the first call
+u64 GetHostCycleFrequency();
+
 void WriteProfileResults(const std::string& filename);
 }
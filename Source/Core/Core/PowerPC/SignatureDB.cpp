@@ -2,7 +2,10 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <cstring>
 #include <string>
+#include <vector>
 
 #include "Common/CommonTypes.h"
 #include "Common/FileUtil.h"
@@ -31,18 +34,19 @@ bool SignatureDB::Load(const std::string& filename)
 		return false;
 	u32 fcount = 0;
 	f.ReadArray(&fcount, 1);
-	for (size_t i = 0; i < fcount; i++)
-	{
-		FuncDesc temp;
-		memset(&temp, 0, sizeof(temp));
 
-		f.ReadArray(&temp, 1);
+	// Read the entries in one go rather than one small read each
+	std::vector<FuncDesc> entries(fcount);
+	if (!f.ReadArray(entries.data(), fcount))
+		entries.resize(0);
+	database.reserve(database.size() + entries.size());
+	for (FuncDesc& temp : entries)
+	{
 		temp.name[sizeof(temp.name) - 1] = 0;
 
-		DBFunc dbf;
+		DBFunc& dbf = database[temp.checkSum];
 		dbf.name = temp.name;
 		dbf.size = temp.size;
-		database[temp.checkSum] = dbf;
 	}
 
 	return true;
@@ -58,13 +62,20 @@ bool SignatureDB::Save(const std::string& filename)
 	}
 	u32 fcount = (u32)database.size();
 	f.WriteArray(&fcount, 1);
+	// Sorted by hash, so saving the same functions always makes the same file
+	std::vector<const FuncDB::value_type*> entries;
+	entries.reserve(database.size());
 	for (const auto& entry : database)
+		entries.push_back(&entry);
+	std::sort(entries.begin(), entries.end(),
+		[](const FuncDB::value_type* a, const FuncDB::value_type* b) { return a->first < b->first; });
+	for (const auto* entry : entries)
 	{
 		FuncDesc temp;
 		memset(&temp, 0, sizeof(temp));
-		temp.checkSum = entry.first;
-		temp.size = entry.second.size;
-		strncpy(temp.name, entry.second.name.c_str(), 127);
+		temp.checkSum = entry->first;
+		temp.size = entry->second.size;
+		strncpy(temp.name, entry->second.name.c_str(), 127);
 		f.WriteArray(&temp, 1);
 	}
 
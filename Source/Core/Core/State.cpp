@@ -2,8 +2,14 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <deque>
 #include <lzo/lzo1x.h>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
@@ -13,11 +19,14 @@
 #include "Common/ChunkFile.h"
 #include "Common/CommonTypes.h"
 #include "Common/Event.h"
+#include "Common/FileSearch.h"
 #include "Common/FileUtil.h"
+#include "Common/Hash.h"
 #include "Common/MsgHandler.h"
 #include "Common/ScopeGuard.h"
 #include "Common/StringUtil.h"
 #include "Common/Thread.h"
+#include "Common/ThreadPool.h"
 #include "Common/Timer.h"
 
 #include "Core/ConfigManager.h"
@@ -46,14 +55,33 @@ static const u32 IN_LEN = 60 * 1024u;
 static const u32 IN_LEN = 128 * 1024u;
 #endif
 
-static const u32 OUT_LEN = IN_LEN + (IN_LEN / 16) + 64 + 3;
+// Worst case size of LZO compressed data
+static constexpr u32 GetMaxCompressedSize(u32 size)
+{
+	return size + (size / 16) + 64 + 3;
+}
+
+static const u32 OUT_LEN = GetMaxCompressedSize(IN_LEN);
 
-static unsigned char __LZO_MMODEL out[OUT_LEN];
+// States are compressed in independent chunks so that all cores can work on them when saving and
+// loading. The chunked format starts with a marker that can't be the length of an IN_LEN chunk,
+// which is what the older format that compressed the chunks one after the other starts with.
+static const u32 CHUNKED_STATE_MAGIC = 0x4B484353;  // "SCHK"
+static const u32 STATE_CHUNK_SIZE = 1024 * 1024;
+// Chunks compressed in parallel before they are written
+static const u32 STATE_CHUNK_BATCH = 32;
 
-#define HEAP_ALLOC(var, size)                                                                      \
-  lzo_align_t __LZO_MMODEL var[((size) + (sizeof(lzo_align_t) - 1)) / sizeof(lzo_align_t)]
+// Delta states only store the pages that differ from a keyframe, which is a full state of the same
+// game kept in memory and in its own file. Every DELTA_KEYFRAME_INTERVAL deltas a new one is made.
+static const u32 DELTA_STATE_MAGIC = 0x544C4453;  // "SDLT"
+static const u32 DELTA_PAGE_SIZE = 4096;
+static const int DELTA_KEYFRAME_INTERVAL = 30;
 
-static HEAP_ALLOC(wrkmem, LZO1X_1_MEM_COMPRESS);
+static std::mutex g_cs_keyframe;
+static std::vector<u8> g_keyframe_buffer;
+static std::string g_keyframe_game_id;
+static u64 g_keyframe_hash = 0;
+static int g_deltas_since_keyframe = 0;
 
 static std::string g_last_filename;
 
@@ -71,7 +99,7 @@ static Common::Event g_compressAndDumpStateSyncEvent;
 static std::thread g_save_thread;
 
 // Don't forget to increase this after doing changes on the savestate system
-static const u32 STATE_VERSION = 65;  // Last changed in PR 4120
+static const u32 STATE_VERSION = 67;  // Last changed for the icache last line
 
 																			// Maps savestate versions to Dolphin versions.
 																			// Versions after 42 don't need to be added to this list,
@@ -202,20 +230,53 @@ void LoadFromBuffer(std::vector<u8>& buffer)
 	Core::PauseAndLock(false, wasUnpaused);
 }
 
-void SaveToBuffer(std::vector<u8>& buffer)
+// Size of the last state that was saved. States barely change size between saves, so the next
+// one is written straight into a buffer a little bigger than that instead of being measured first.
+static std::atomic<size_t> s_last_state_size(0);
+
+// Returns false if DoState aborted the save
+static bool WriteStateToBuffer(std::vector<u8>& buffer)
 {
-	bool wasUnpaused = Core::PauseAndLock(true);
+	size_t size = s_last_state_size.load();
+	if (size == 0)
+	{
+		u8* ptr = nullptr;
+		PointerWrap p(&ptr, PointerWrap::MODE_MEASURE);
+		DoState(p);
+		size = reinterpret_cast<size_t>(ptr);
+	}
+	else
+	{
+		size += size / 32;
+	}
 
-	u8* ptr = nullptr;
-	PointerWrap p(&ptr, PointerWrap::MODE_MEASURE);
+	while (true)
+	{
+		buffer.resize(size);
+		u8* ptr = buffer.data();
+		PointerWrap p(&ptr, PointerWrap::MODE_WRITE);
+		p.SetWriteLimit(ptr + size);
+		DoState(p);
+		size = static_cast<size_t>(ptr - buffer.data());
 
-	DoState(p);
-	const size_t buffer_size = reinterpret_cast<size_t>(ptr);
-	buffer.resize(buffer_size);
+		// The state grew, the pointer counted how much room it needs
+		if (p.IsWriteLimitReached())
+			continue;
 
-	ptr = &buffer[0];
-	p.SetMode(PointerWrap::MODE_WRITE);
-	DoState(p);
+		if (p.GetMode() != PointerWrap::MODE_WRITE)
+			return false;
+
+		buffer.resize(size);
+		s_last_state_size.store(size);
+		return true;
+	}
+}
+
+void SaveToBuffer(std::vector<u8>& buffer)
+{
+	bool wasUnpaused = Core::PauseAndLock(true);
+
+	WriteStateToBuffer(buffer);
 
 	Core::PauseAndLock(false, wasUnpaused);
 }
@@ -284,8 +345,558 @@ struct CompressAndDumpState_args
 	std::mutex* buffer_mutex;
 	std::string filename;
 	bool wait;
+	bool delta;
+};
+
+// Appends the chunk table and the compressed chunks of a state to out
+static bool CompressChunks(const u8* data, size_t size, std::vector<u8>* out)
+{
+	const u32 num_chunks = static_cast<u32>((size + STATE_CHUNK_SIZE - 1) / STATE_CHUNK_SIZE);
+	const u32 chunk_header[2] = {STATE_CHUNK_SIZE, num_chunks};
+	const size_t header_offset = out->size();
+	const size_t header_size = sizeof(chunk_header) + sizeof(u32) * num_chunks;
+	out->resize(header_offset + header_size);
+	memcpy(&(*out)[header_offset], chunk_header, sizeof(chunk_header));
+
+	// The compressed sizes come before the data, they are filled in once every chunk is done
+	std::vector<u32> compressed_sizes(num_chunks);
+
+	const u32 max_out_size = GetMaxCompressedSize(STATE_CHUNK_SIZE);
+	std::vector<u8> out_buffer(static_cast<size_t>(max_out_size) *
+		std::min(num_chunks, STATE_CHUNK_BATCH));
+	std::atomic<bool> failed(false);
+	Common::ParallelLoop compress_loop;
+
+	for (u32 first = 0; first < num_chunks; first += STATE_CHUNK_BATCH)
+	{
+		const u32 count = std::min(STATE_CHUNK_BATCH, num_chunks - first);
+		compress_loop.Loop([&](int lower, int upper) {
+			std::vector<lzo_align_t> wrkmem(
+				(LZO1X_1_MEM_COMPRESS + sizeof(lzo_align_t) - 1) / sizeof(lzo_align_t));
+			for (int j = lower; j < upper; j++)
+			{
+				const size_t offset = static_cast<size_t>(first + j) * STATE_CHUNK_SIZE;
+				const lzo_uint in_len =
+					static_cast<lzo_uint>(std::min<size_t>(STATE_CHUNK_SIZE, size - offset));
+				lzo_uint out_len = 0;
+				if (lzo1x_1_compress(data + offset, in_len, &out_buffer[static_cast<size_t>(j) * max_out_size],
+					&out_len, wrkmem.data()) != LZO_E_OK)
+				{
+					failed.store(true);
+				}
+				compressed_sizes[first + j] = static_cast<u32>(out_len);
+			}
+		}, 0, static_cast<int>(count), 1);
+
+		if (failed.load())
+			return false;
+
+		for (u32 j = 0; j < count; j++)
+		{
+			const u8* chunk = &out_buffer[static_cast<size_t>(j) * max_out_size];
+			out->insert(out->end(), chunk, chunk + compressed_sizes[first + j]);
+		}
+	}
+
+	if (num_chunks)
+	{
+		memcpy(&(*out)[header_offset + sizeof(chunk_header)], compressed_sizes.data(),
+			sizeof(u32) * num_chunks);
+	}
+	return true;
+}
+
+// Decompresses what CompressChunks made. buffer has to be sized to the state.
+static bool DecompressChunks(const u8* in, size_t in_size, std::vector<u8>& buffer)
+{
+	u32 chunk_header[2];
+	if (in_size < sizeof(chunk_header))
+		return false;
+	memcpy(chunk_header, in, sizeof(chunk_header));
+	in += sizeof(chunk_header);
+	in_size -= sizeof(chunk_header);
+
+	const u32 chunk_size = chunk_header[0];
+	const u32 num_chunks = chunk_header[1];
+	if (chunk_size == 0 ||
+		static_cast<u64>(chunk_size) * num_chunks < buffer.size() ||
+		(num_chunks != 0 && static_cast<u64>(chunk_size) * (num_chunks - 1) >= buffer.size()) ||
+		static_cast<u64>(num_chunks) * sizeof(u32) > in_size)
+	{
+		return false;
+	}
+
+	std::vector<u32> compressed_sizes(num_chunks);
+	if (num_chunks)
+		memcpy(compressed_sizes.data(), in, sizeof(u32) * num_chunks);
+	in += sizeof(u32) * num_chunks;
+	in_size -= sizeof(u32) * num_chunks;
+
+	// The chunks are found from their sizes
+	std::vector<size_t> offsets(num_chunks + 1, 0);
+	for (u32 i = 0; i < num_chunks; i++)
+		offsets[i + 1] = offsets[i] + compressed_sizes[i];
+	if (offsets.back() > in_size)
+		return false;
+
+	std::atomic<bool> failed(false);
+	Common::ParallelLoop decompress_loop;
+	decompress_loop.Loop([&](int lower, int upper) {
+		for (int i = lower; i < upper; i++)
+		{
+			const size_t offset = static_cast<size_t>(i) * chunk_size;
+			const lzo_uint expected_len =
+				static_cast<lzo_uint>(std::min<size_t>(chunk_size, buffer.size() - offset));
+			lzo_uint new_len = expected_len;
+			const int res = lzo1x_decompress_safe(in + offsets[i], compressed_sizes[i],
+				&buffer[offset], &new_len, nullptr);
+			if (res != LZO_E_OK || new_len != expected_len)
+				failed.store(true);
+		}
+	}, 0, static_cast<int>(num_chunks), 1);
+
+	return !failed.load();
+}
+
+static bool CompressStateChunked(File::IOFile& f, const u8* data, size_t size)
+{
+	std::vector<u8> compressed;
+	return CompressChunks(data, size, &compressed) && f.WriteArray(&CHUNKED_STATE_MAGIC, 1) &&
+		f.WriteBytes(compressed.data(), compressed.size());
+}
+
+// Reads the rest of a chunked state after its marker. buffer has to be sized to the state.
+static bool DecompressStateChunked(File::IOFile& f, std::vector<u8>& buffer)
+{
+	const u64 position = f.Tell();
+	const u64 file_size = f.GetSize();
+	if (position > file_size)
+		return false;
+
+	std::vector<u8> compressed(static_cast<size_t>(file_size - position));
+	return f.ReadBytes(compressed.data(), compressed.size()) &&
+		DecompressChunks(compressed.data(), compressed.size(), buffer);
+}
+
+// Indices of the pages that differ between data and base, which have the same size. The pages are
+// compared on all cores, most of them are usually the same.
+static std::vector<u32> FindChangedPages(const u8* data, const u8* base, size_t size)
+{
+	const u32 num_pages = static_cast<u32>((size + DELTA_PAGE_SIZE - 1) / DELTA_PAGE_SIZE);
+	std::vector<u8> changed(num_pages);
+	Common::ParallelLoop compare_loop;
+	compare_loop.Loop([&](int lower, int upper) {
+		for (int i = lower; i < upper; i++)
+		{
+			const size_t offset = static_cast<size_t>(i) * DELTA_PAGE_SIZE;
+			const size_t page_size = std::min<size_t>(DELTA_PAGE_SIZE, size - offset);
+			changed[i] = memcmp(data + offset, base + offset, page_size) != 0;
+		}
+	}, 0, static_cast<int>(num_pages), 256);
+
+	std::vector<u32> pages;
+	for (u32 i = 0; i < num_pages; i++)
+	{
+		if (changed[i])
+			pages.push_back(i);
+	}
+	return pages;
+}
+
+// The contents of the pages, one after the other
+static std::vector<u8> GatherPages(const u8* data, size_t size, const std::vector<u32>& pages,
+	u32 page_size)
+{
+	std::vector<u8> page_data;
+	for (u32 page : pages)
+	{
+		const size_t offset = static_cast<size_t>(page) * page_size;
+		page_data.insert(page_data.end(), data + offset,
+			data + offset + std::min<size_t>(page_size, size - offset));
+	}
+	return page_data;
+}
+
+static void ApplyPages(std::vector<u8>& buffer, const std::vector<u32>& pages, u32 page_size,
+	const u8* page_data)
+{
+	for (u32 page : pages)
+	{
+		const size_t offset = static_cast<size_t>(page) * page_size;
+		const size_t size = std::min<size_t>(page_size, buffer.size() - offset);
+		std::copy(page_data, page_data + size, &buffer[offset]);
+		page_data += size;
+	}
+}
+
+static std::string MakeKeyframeFilename(const std::string& game_id, u64 hash)
+{
+	return StringFromFormat("%s%s.%016" PRIx64 ".keyframe", File::GetUserPath(D_STATESAVES_IDX).c_str(),
+		game_id.c_str(), hash);
+}
+
+// Returns the hash of the keyframe a state file is based on, or 0 for a full state
+static u64 GetStateKeyframeHash(const std::string& filename)
+{
+	File::IOFile f(filename, "rb");
+	StateHeader header;
+	u32 marker = 0;
+	u64 hash = 0;
+	if (!f.ReadArray(&header, 1) || !f.ReadArray(&marker, 1) || marker != DELTA_STATE_MAGIC ||
+		!f.ReadArray(&hash, 1))
+	{
+		return 0;
+	}
+
+	return hash;
+}
+
+// Deletes the keyframes of the game that neither the current keyframe nor a state slot uses
+static void RemoveUnusedKeyframes(const std::string& game_id)
+{
+	std::vector<u64> used = {g_keyframe_hash,
+		GetStateKeyframeHash(File::GetUserPath(D_STATESAVES_IDX) + "lastState.sav")};
+	for (int i = 1; i <= (int)NUM_STATES; i++)
+		used.push_back(GetStateKeyframeHash(MakeStateFilename(i)));
+
+	const std::string prefix = File::GetUserPath(D_STATESAVES_IDX) + game_id + ".";
+	for (const std::string& path :
+		DoFileSearch({".keyframe"}, {File::GetUserPath(D_STATESAVES_IDX)}))
+	{
+		if (path.compare(0, prefix.size(), prefix) != 0)
+			continue;
+
+		const bool is_used = std::any_of(used.begin(), used.end(), [&](u64 hash) {
+			return path == MakeKeyframeFilename(game_id, hash);
+		});
+		if (!is_used)
+			File::Delete(path);
+	}
+}
+
+// Makes the state the new keyframe and writes it to its file. g_cs_keyframe must be held.
+static bool WriteKeyframe(const u8* data, size_t size, const std::string& game_id)
+{
+	const u64 hash = GetMurmurHash3(data, static_cast<u32>(size), 0);
+
+	File::IOFile f(MakeKeyframeFilename(game_id, hash), "wb");
+	StateHeader header = {};
+	strncpy(header.gameID, game_id.c_str(), 6);
+	header.size = static_cast<u32>(size);
+	header.time = Common::Timer::GetDoubleTime();
+	if (!f || !f.WriteArray(&header, 1) || !CompressStateChunked(f, data, size))
+		return false;
+
+	g_keyframe_buffer.assign(data, data + size);
+	g_keyframe_game_id = game_id;
+	g_keyframe_hash = hash;
+	g_deltas_since_keyframe = 0;
+
+	RemoveUnusedKeyframes(game_id);
+	return true;
+}
+
+static bool WriteDeltaState(File::IOFile& f, const u8* data, size_t size, const std::string& game_id)
+{
+	std::lock_guard<std::mutex> lk(g_cs_keyframe);
+
+	if (g_keyframe_buffer.size() != size || g_keyframe_game_id != game_id ||
+		g_deltas_since_keyframe >= DELTA_KEYFRAME_INTERVAL)
+	{
+		if (!WriteKeyframe(data, size, game_id))
+			return false;
+	}
+
+	const std::vector<u32> pages = FindChangedPages(data, g_keyframe_buffer.data(), size);
+	const std::vector<u8> page_data = GatherPages(data, size, pages, DELTA_PAGE_SIZE);
+
+	const u32 delta_header[2] = {DELTA_PAGE_SIZE, static_cast<u32>(pages.size())};
+	if (!f.WriteArray(&DELTA_STATE_MAGIC, 1) || !f.WriteArray(&g_keyframe_hash, 1) ||
+		!f.WriteArray(delta_header, 2) || !f.WriteArray(pages.data(), pages.size()) ||
+		!CompressStateChunked(f, page_data.data(), page_data.size()))
+	{
+		return false;
+	}
+
+	g_deltas_since_keyframe++;
+	return true;
+}
+
+// Reads the rest of a delta state after its marker. buffer has to be sized to the state.
+static bool LoadDeltaState(File::IOFile& f, std::vector<u8>& buffer, const std::string& game_id)
+{
+	u64 keyframe_hash;
+	u32 delta_header[2];
+	if (!f.ReadArray(&keyframe_hash, 1) || !f.ReadArray(delta_header, 2))
+		return false;
+
+	const u32 page_size = delta_header[0];
+	const u32 num_changed = delta_header[1];
+	if (page_size == 0 || num_changed > (buffer.size() + page_size - 1) / page_size)
+		return false;
+
+	std::vector<u32> pages(num_changed);
+	if (!f.ReadArray(pages.data(), num_changed))
+		return false;
+
+	size_t page_data_size = 0;
+	for (u32 i = 0; i < num_changed; i++)
+	{
+		const size_t offset = static_cast<size_t>(pages[i]) * page_size;
+		if (offset >= buffer.size() || (i > 0 && pages[i] <= pages[i - 1]))
+			return false;
+		page_data_size += std::min<size_t>(page_size, buffer.size() - offset);
+	}
+
+	std::vector<u8> page_data(page_data_size);
+	u32 marker = 0;
+	if (!f.ReadArray(&marker, 1) || marker != CHUNKED_STATE_MAGIC ||
+		!DecompressStateChunked(f, page_data))
+	{
+		return false;
+	}
+
+	{
+		std::lock_guard<std::mutex> lk(g_cs_keyframe);
+		if (g_keyframe_hash == keyframe_hash && g_keyframe_game_id == game_id &&
+			g_keyframe_buffer.size() == buffer.size())
+		{
+			std::copy(g_keyframe_buffer.begin(), g_keyframe_buffer.end(), buffer.begin());
+		}
+		else
+		{
+			File::IOFile keyframe(MakeKeyframeFilename(game_id, keyframe_hash), "rb");
+			StateHeader header;
+			if (!keyframe || !keyframe.ReadArray(&header, 1) || header.size != buffer.size() ||
+				!keyframe.ReadArray(&marker, 1) || marker != CHUNKED_STATE_MAGIC ||
+				!DecompressStateChunked(keyframe, buffer) ||
+				GetMurmurHash3(buffer.data(), static_cast<u32>(buffer.size()), 0) != keyframe_hash)
+			{
+				Core::DisplayMessage("The keyframe of this state is missing or damaged", 2000);
+				return false;
+			}
+
+			// Later deltas are based on the loaded keyframe
+			g_keyframe_buffer = buffer;
+			g_keyframe_game_id = game_id;
+			g_keyframe_hash = keyframe_hash;
+			g_deltas_since_keyframe = 0;
+		}
+	}
+
+	ApplyPages(buffer, pages, page_size, page_data.data());
+	return true;
+}
+
+// Rewinding goes back through snapshots kept in memory. A snapshot is either a compressed full
+// state or the compressed pages that differ from the last full one before it.
+struct RewindEntry
+{
+	bool keyframe;
+	u32 state_size;
+	std::vector<u32> pages;
+	std::vector<u8> compressed;
 };
 
+// Taking a snapshot pauses the emulation, so the snapshots are spaced out further when they take
+// more than this share of the time.
+static const double REWIND_CPU_BUDGET = 0.03;
+static const u32 REWIND_MAX_INTERVAL_FRAMES = 600;
+static const int REWIND_KEYFRAME_INTERVAL = 60;
+
+static std::mutex g_cs_rewind;
+static std::deque<RewindEntry> g_rewind_entries;
+// Uncompressed copy of the keyframe the next delta is based on
+static std::vector<u8> g_rewind_keyframe;
+static int g_rewind_deltas_since_keyframe = 0;
+// Snapshots that were taken before a rewind or a clear are dropped
+static std::atomic<u32> g_rewind_generation(0);
+static std::atomic<bool> g_rewind_snapshot_pending(false);
+static std::atomic<u32> g_rewind_frames_since_snapshot(0);
+static std::atomic<u32> g_rewind_interval_frames(1);
+// Host thread only
+static std::chrono::steady_clock::time_point g_rewind_last_snapshot;
+static double g_rewind_average_cost = 0.0;
+
+// g_cs_rewind must be held
+static void ClearRewindEntries()
+{
+	g_rewind_generation++;
+	g_rewind_entries.clear();
+	std::vector<u8>().swap(g_rewind_keyframe);
+	g_rewind_deltas_since_keyframe = 0;
+}
+
+static u32 GetRewindRequestedInterval()
+{
+	const int snapshots_per_second = std::max(SConfig::GetInstance().iRewindSnapshotsPerSecond, 1);
+	return static_cast<u32>(std::max(60 / snapshots_per_second, 1));
+}
+
+static void AddRewindSnapshot(std::vector<u8>& state, u32 generation)
+{
+	std::lock_guard<std::mutex> lk(g_cs_rewind);
+	if (generation != g_rewind_generation.load())
+		return;
+
+	const SConfig& config = SConfig::GetInstance();
+	const size_t capacity = static_cast<size_t>(std::max(config.iRewindSeconds, 0)) *
+		std::max(config.iRewindSnapshotsPerSecond, 1);
+
+	// Short buffers get more keyframes, so that dropping the oldest group doesn't empty them
+	RewindEntry entry;
+	entry.state_size = static_cast<u32>(state.size());
+	entry.keyframe = g_rewind_keyframe.size() != state.size() ||
+		static_cast<size_t>(g_rewind_deltas_since_keyframe) >=
+		std::min<size_t>(REWIND_KEYFRAME_INTERVAL, capacity / 4);
+	if (entry.keyframe)
+	{
+		if (!CompressChunks(state.data(), state.size(), &entry.compressed))
+			return;
+		g_rewind_keyframe.swap(state);
+		g_rewind_deltas_since_keyframe = 0;
+	}
+	else
+	{
+		entry.pages = FindChangedPages(state.data(), g_rewind_keyframe.data(), state.size());
+		const std::vector<u8> page_data =
+			GatherPages(state.data(), state.size(), entry.pages, DELTA_PAGE_SIZE);
+		if (!CompressChunks(page_data.data(), page_data.size(), &entry.compressed))
+			return;
+		g_rewind_deltas_since_keyframe++;
+	}
+	g_rewind_entries.push_back(std::move(entry));
+
+	// The deltas can't be used without their keyframe, so the oldest ones go together with it
+	while (g_rewind_entries.size() > capacity)
+	{
+		do
+			g_rewind_entries.pop_front();
+		while (!g_rewind_entries.empty() && !g_rewind_entries.front().keyframe);
+	}
+	if (g_rewind_entries.empty())
+		std::vector<u8>().swap(g_rewind_keyframe);
+}
+
+// Runs on the host thread
+static void TakeRewindSnapshot(u32 frames)
+{
+	if (!Core::IsRunningAndStarted() || SConfig::GetInstance().iRewindSeconds <= 0)
+	{
+		g_rewind_snapshot_pending.store(false);
+		return;
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+	const std::chrono::duration<double> since_last = start - g_rewind_last_snapshot;
+	auto state = std::make_shared<std::vector<u8>>();
+	SaveToBuffer(*state);
+	const auto end = std::chrono::steady_clock::now();
+	g_rewind_last_snapshot = end;
+
+	// Keep the time spent on snapshots within the budget, based on how long a frame took lately
+	const double cost = std::chrono::duration<double>(end - start).count();
+	g_rewind_average_cost = g_rewind_average_cost * 0.75 + cost * 0.25;
+	const u32 requested = GetRewindRequestedInterval();
+	u32 interval = requested;
+	if (frames != 0 && since_last.count() < 1.0)
+	{
+		const double frame_time = since_last.count() / frames;
+		const double budget_frames = g_rewind_average_cost / (REWIND_CPU_BUDGET * frame_time);
+		interval = static_cast<u32>(std::min<double>(std::max<double>(budget_frames, requested),
+			REWIND_MAX_INTERVAL_FRAMES));
+	}
+	g_rewind_interval_frames.store(interval);
+
+	// Compressing the snapshot doesn't need the emulation to wait
+	const u32 generation = g_rewind_generation.load();
+	Common::ThreadPool::Submit([state, generation] {
+		AddRewindSnapshot(*state, generation);
+		g_rewind_snapshot_pending.store(false);
+	}, Common::TaskPriority::Low);
+}
+
+void RewindFrameUpdate()
+{
+	if (SConfig::GetInstance().iRewindSeconds <= 0 || NetPlay::IsNetPlayRunning())
+		return;
+
+	const u32 frames = ++g_rewind_frames_since_snapshot;
+	if (frames < g_rewind_interval_frames.load() || g_rewind_snapshot_pending.exchange(true))
+		return;
+
+	g_rewind_frames_since_snapshot.store(0);
+	Core::QueueHostJob([frames] { TakeRewindSnapshot(frames); });
+}
+
+bool Rewind()
+{
+	std::vector<u8> buffer;
+	{
+		std::lock_guard<std::mutex> lk(g_cs_rewind);
+		g_rewind_generation++;
+		if (g_rewind_entries.empty())
+		{
+			Core::DisplayMessage("Nothing to rewind", 2000);
+			return false;
+		}
+
+		RewindEntry entry = std::move(g_rewind_entries.back());
+		g_rewind_entries.pop_back();
+
+		auto keyframe = std::find_if(g_rewind_entries.rbegin(), g_rewind_entries.rend(),
+			[](const RewindEntry& e) { return e.keyframe; });
+		if (!entry.keyframe && keyframe == g_rewind_entries.rend())
+		{
+			ClearRewindEntries();
+			return false;
+		}
+
+		const RewindEntry& base = entry.keyframe ? entry : *keyframe;
+		buffer.resize(base.state_size);
+		if (!DecompressChunks(base.compressed.data(), base.compressed.size(), buffer))
+		{
+			ClearRewindEntries();
+			return false;
+		}
+
+		if (entry.keyframe)
+		{
+			// The next snapshot is a keyframe again
+			std::vector<u8>().swap(g_rewind_keyframe);
+		}
+		else
+		{
+			g_rewind_keyframe = buffer;
+			g_rewind_deltas_since_keyframe = static_cast<int>(keyframe - g_rewind_entries.rbegin());
+
+			size_t page_data_size = 0;
+			for (u32 page : entry.pages)
+			{
+				page_data_size += std::min<size_t>(DELTA_PAGE_SIZE,
+					buffer.size() - static_cast<size_t>(page) * DELTA_PAGE_SIZE);
+			}
+			std::vector<u8> page_data(page_data_size);
+			if (!DecompressChunks(entry.compressed.data(), entry.compressed.size(), page_data))
+			{
+				ClearRewindEntries();
+				return false;
+			}
+			ApplyPages(buffer, entry.pages, DELTA_PAGE_SIZE, page_data.data());
+		}
+	}
+
+	g_rewind_frames_since_snapshot.store(0);
+	LoadFromBuffer(buffer);
+	return true;
+}
+
+void ClearRewindBuffer()
+{
+	std::lock_guard<std::mutex> lk(g_cs_rewind);
+	ClearRewindEntries();
+}
+
 static void CompressAndDumpState(CompressAndDumpState_args save_args)
 {
 	std::lock_guard<std::mutex> lk(*save_args.buffer_mutex);
@@ -344,35 +955,15 @@ static void CompressAndDumpState(CompressAndDumpState_args save_args)
 
 	f.WriteArray(&header, 1);
 
-	if (header.size != 0)  // non-zero header size means the state is compressed
+	if (header.size != 0 && save_args.delta)
 	{
-		lzo_uint i = 0;
-		while (true)
-		{
-			lzo_uint32 cur_len = 0;
-			lzo_uint out_len = 0;
-
-			if ((i + IN_LEN) >= buffer_size)
-			{
-				cur_len = (lzo_uint32)(buffer_size - i);
-			}
-			else
-			{
-				cur_len = IN_LEN;
-			}
-
-			if (lzo1x_1_compress(buffer_data + i, cur_len, out, &out_len, wrkmem) != LZO_E_OK)
-				PanicAlertT("Internal LZO Error - compression failed");
-
-			// The size of the data to write is 'out_len'
-			f.WriteArray((lzo_uint32*)&out_len, 1);
-			f.WriteBytes(out, out_len);
-
-			if (cur_len != IN_LEN)
-				break;
-
-			i += cur_len;
-		}
+		if (!WriteDeltaState(f, buffer_data, buffer_size, SConfig::GetInstance().GetGameID()))
+			PanicAlertT("Failed to write the delta state");
+	}
+	else if (header.size != 0)  // non-zero header size means the state is compressed
+	{
+		if (!CompressStateChunked(f, buffer_data, buffer_size))
+			PanicAlertT("Internal LZO Error - compression failed");
 	}
 	else  // uncompressed
 	{
@@ -383,27 +974,18 @@ static void CompressAndDumpState(CompressAndDumpState_args save_args)
 	Host_UpdateMainFrame();
 }
 
-void SaveAs(const std::string& filename, bool wait)
+static void SaveStateAs(const std::string& filename, bool wait, bool delta)
 {
 	// Pause the core while we save the state
 	bool wasUnpaused = Core::PauseAndLock(true);
 
-	// Measure the size of the buffer.
-	u8* ptr = nullptr;
-	PointerWrap p(&ptr, PointerWrap::MODE_MEASURE);
-	DoState(p);
-	const size_t buffer_size = reinterpret_cast<size_t>(ptr);
-
-	// Then actually do the write.
+	bool written;
 	{
 		std::lock_guard<std::mutex> lk(g_cs_current_buffer);
-		g_current_buffer.resize(buffer_size);
-		ptr = &g_current_buffer[0];
-		p.SetMode(PointerWrap::MODE_WRITE);
-		DoState(p);
+		written = WriteStateToBuffer(g_current_buffer);
 	}
 
-	if (p.GetMode() == PointerWrap::MODE_WRITE)
+	if (written)
 	{
 		Core::DisplayMessage("Saving State...", 1000);
 
@@ -412,6 +994,7 @@ void SaveAs(const std::string& filename, bool wait)
 		save_args.buffer_mutex = &g_cs_current_buffer;
 		save_args.filename = filename;
 		save_args.wait = wait;
+		save_args.delta = delta;
 
 		Flush();
 		g_save_thread = std::thread(CompressAndDumpState, save_args);
@@ -429,6 +1012,11 @@ void SaveAs(const std::string& filename, bool wait)
 	Core::PauseAndLock(false, wasUnpaused);
 }
 
+void SaveAs(const std::string& filename, bool wait)
+{
+	SaveStateAs(filename, wait, false);
+}
+
 bool ReadHeader(const std::string& filename, StateHeader& header)
 {
 	Flush();
@@ -484,27 +1072,63 @@ static void LoadFileStateData(const std::string& filename, std::vector<u8>& ret_
 
 		buffer.resize(header.size);
 
-		lzo_uint i = 0;
-		while (true)
+		u32 marker = 0;
+		if (!f.ReadArray(&marker, 1))
 		{
-			lzo_uint32 cur_len = 0;  // number of bytes to read
-			lzo_uint new_len = 0;    // number of bytes to write
-
-			if (!f.ReadArray(&cur_len, 1))
-				break;
+			Core::DisplayMessage("Could not read state", 2000);
+			return;
+		}
 
-			f.ReadBytes(out, cur_len);
-			const int res = lzo1x_decompress(out, cur_len, &buffer[i], &new_len, nullptr);
-			if (res != LZO_E_OK)
+		if (marker == CHUNKED_STATE_MAGIC)
+		{
+			if (!DecompressStateChunked(f, buffer))
+			{
+				PanicAlertT("Internal LZO Error - decompression failed\n"
+					"Try loading the state again");
+				return;
+			}
+		}
+		else if (marker == DELTA_STATE_MAGIC)
+		{
+			if (!LoadDeltaState(f, buffer, std::string(header.gameID, strnlen(header.gameID, 6))))
 			{
-				// This doesn't seem to happen anymore.
-				PanicAlertT("Internal LZO Error - decompression failed (%d) (%li, %li) \n"
-					"Try loading the state again",
-					res, i, new_len);
+				Core::DisplayMessage("Could not load the delta state", 2000);
 				return;
 			}
+		}
+		else
+		{
+			// States from before the chunked format, with the size in front of every chunk
+			f.Seek(-static_cast<s64>(sizeof(marker)), SEEK_CUR);
 
-			i += new_len;
+			std::vector<u8> out(OUT_LEN);
+			lzo_uint i = 0;
+			while (true)
+			{
+				lzo_uint32 cur_len = 0;  // number of bytes to read
+				lzo_uint new_len = buffer.size() - i;  // number of bytes to write
+
+				if (!f.ReadArray(&cur_len, 1))
+					break;
+
+				if (cur_len > OUT_LEN || !f.ReadBytes(out.data(), cur_len))
+				{
+					Core::DisplayMessage("Could not read state", 2000);
+					return;
+				}
+
+				const int res = lzo1x_decompress_safe(out.data(), cur_len, &buffer[i], &new_len, nullptr);
+				if (res != LZO_E_OK)
+				{
+					// This doesn't seem to happen anymore.
+					PanicAlertT("Internal LZO Error - decompression failed (%d) (%li, %li) \n"
+						"Try loading the state again",
+						res, i, new_len);
+					return;
+				}
+
+				i += new_len;
+			}
 		}
 	}
 	else  // uncompressed
@@ -652,6 +1276,15 @@ void Shutdown()
 		std::lock_guard<std::mutex> lk(g_cs_undo_load_buffer);
 		std::vector<u8>().swap(g_undo_load_buffer);
 	}
+
+	{
+		std::lock_guard<std::mutex> lk(g_cs_keyframe);
+		std::vector<u8>().swap(g_keyframe_buffer);
+		g_keyframe_game_id.clear();
+		g_keyframe_hash = 0;
+	}
+
+	ClearRewindBuffer();
 }
 
 static std::string MakeStateFilename(int number)
@@ -662,7 +1295,7 @@ static std::string MakeStateFilename(int number)
 
 void Save(int slot, bool wait)
 {
-	SaveAs(MakeStateFilename(slot), wait);
+	SaveStateAs(MakeStateFilename(slot), wait, SConfig::GetInstance().bDeltaSavestates);
 }
 
 void Load(int slot)
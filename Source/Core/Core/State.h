@@ -57,6 +57,13 @@ void SaveFirstSaved();
 void UndoSaveState();
 void UndoLoadState();
 
+// Rewinding keeps the last iRewindSeconds of emulation in memory as compressed snapshots.
+// RewindFrameUpdate is called for every frame and schedules the snapshots. Rewind loads the newest
+// snapshot and drops it, so calling it again steps further back.
+void RewindFrameUpdate();
+bool Rewind();
+void ClearRewindBuffer();
+
 // wait until previously scheduled savestate event (if any) is done
 void Flush();
 
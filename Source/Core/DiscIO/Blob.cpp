@@ -14,6 +14,7 @@
 
 #include "DiscIO/Blob.h"
 #include "DiscIO/CISOBlob.h"
+#include "DiscIO/ChunkedBlob.h"
 #include "DiscIO/CompressedBlob.h"
 #include "DiscIO/DriveBlob.h"
 #include "DiscIO/FileBlob.h"
@@ -38,6 +39,13 @@ void SectorReader::SetChunkSize(int block_cnt)
 	SetSectorSize(m_block_size);
 }
 
+void SectorReader::SetCacheSize(int chunks)
+{
+	m_cache.resize(std::max(chunks, 1));
+	// Clear cache and size the new lines
+	SetSectorSize(m_block_size);
+}
+
 SectorReader::~SectorReader()
 {
 }
@@ -49,23 +57,15 @@ const SectorReader::Cache* SectorReader::FindCacheLine(u64 block_num)
 	if (itr == m_cache.end())
 		return nullptr;
 
-	itr->MarkUsed();
+	itr->MarkUsed(++m_use_counter);
 	return &*itr;
 }
 
 SectorReader::Cache* SectorReader::GetEmptyCacheLine()
 {
-	Cache* oldest = &m_cache[0];
 	// Find the Least Recently Used cache line to replace.
-	std::for_each(m_cache.begin() + 1, m_cache.end(), [&](Cache& line) {
-		if (line.IsLessRecentlyUsedThan(*oldest))
-		{
-			oldest->ShiftLRU();
-			oldest = &line;
-			return;
-		}
-		line.ShiftLRU();
-	});
+	Cache* oldest = &*std::min_element(m_cache.begin(), m_cache.end(),
+		[](const Cache& a, const Cache& b) { return a.IsLessRecentlyUsedThan(b); });
 	oldest->Reset();
 	return oldest;
 }
@@ -82,7 +82,7 @@ const SectorReader::Cache* SectorReader::GetCacheLine(u64 block_num)
 	u32 blocks_read = ReadChunk(cache->data.data(), chunk_idx);
 	if (!blocks_read)
 		return nullptr;
-	cache->Fill(chunk_idx * m_chunk_blocks, blocks_read);
+	cache->Fill(chunk_idx * m_chunk_blocks, blocks_read, ++m_use_counter);
 
 	// Secondary check for out-of-bounds read.
 	// If we got less than m_chunk_blocks, we may still have missed.
@@ -185,6 +185,9 @@ std::unique_ptr<IBlobReader> CreateBlobReader(const std::string& filename)
 	if (IsGCZBlob(filename))
 		return CompressedBlobReader::Create(filename);
 
+	if (IsChunkedBlob(filename))
+		return ChunkedBlobReader::Create(filename);
+
 	if (IsCISOBlob(filename))
 		return CISOFileReader::Create(filename);
 
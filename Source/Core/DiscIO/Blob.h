@@ -14,9 +14,9 @@
 // detect whether the file is a compressed blob, or just a big hunk of data, or a drive, and
 // automatically do the right thing.
 
-#include <array>
 #include <memory>
 #include <string>
+#include <vector>
 #include "Common/CommonFuncs.h"
 #include "Common/CommonTypes.h"
 
@@ -30,7 +30,8 @@ enum class BlobType
 	DIRECTORY,
 	GCZ,
 	CISO,
-	WBFS
+	WBFS,
+	CHUNKED
 };
 
 class IBlobReader
@@ -42,6 +43,10 @@ public:
 	virtual u64 GetDataSize() const = 0;
 	// NOT thread-safe - can't call this from multiple threads.
 	virtual bool Read(u64 offset, u64 size, u8* out_ptr) = 0;
+	// Returns a pointer to the data in the given range if the blob can be read without copying
+	// (a memory mapped uncompressed image), nullptr otherwise. The pointer stays valid for the
+	// lifetime of the reader. Same threading rules as Read.
+	virtual const u8* GetMappedData(u64 offset, u64 size) { return nullptr; }
 
 protected:
 	IBlobReader() {}
@@ -67,6 +72,8 @@ protected:
 	// as large reads are slow and will take too long to resolve.
 	void SetChunkSize(int blocks);
 	int GetChunkSize() const { return m_chunk_blocks; }
+	// Set the number of chunks kept in the cache. Clears the cache.
+	void SetCacheSize(int chunks);
 	// Read a single block/sector.
 	virtual bool GetBlock(u64 block_num, u8* out) = 0;
 
@@ -82,33 +89,26 @@ private:
 		u64 block_idx = 0;
 		u32 num_blocks = 0;
 
-		// [Pseudo-] Least Recently Used Shift Register
-		// When an empty cache line is needed, the line with the lowest value
-		// is taken and reset; the LRU register is then shifted down 1 place
-		// on all lines (low bit discarded). When a line is used, the high bit
-		// is set marking it as most recently used.
-		u32 lru_sreg = 0;
+		// Value of the reader's use counter when the line was last used. The line with the
+		// lowest value is the least recently used one and gets replaced first; empty lines
+		// have 0.
+		u64 last_use = 0;
 
 		void Reset()
 		{
 			block_idx = 0;
 			num_blocks = 0;
-			lru_sreg = 0;
+			last_use = 0;
 		}
-		void Fill(u64 block, u32 count)
+		void Fill(u64 block, u32 count, u64 use)
 		{
 			block_idx = block;
 			num_blocks = count;
-			// NOTE: Setting only the high bit means the newest line will
-			//   be selected for eviction if every line in the cache was
-			//   touched. This gives MRU behavior which is probably
-			//   desirable in that case.
-			MarkUsed();
+			MarkUsed(use);
 		}
 		bool Contains(u64 block) const { return block >= block_idx && block - block_idx < num_blocks; }
-		void MarkUsed() { lru_sreg |= 0x80000000; }
-		void ShiftLRU() { lru_sreg >>= 1; }
-		bool IsLessRecentlyUsedThan(const Cache& other) const { return lru_sreg < other.lru_sreg; }
+		void MarkUsed(u64 use) { last_use = use; }
+		bool IsLessRecentlyUsedThan(const Cache& other) const { return last_use < other.last_use; }
 	};
 
 	// Gets the cache line that contains the given block, or nullptr.
@@ -132,7 +132,8 @@ private:
 	static constexpr int CACHE_LINES = 32;
 	u32 m_block_size = 0;    // Bytes in a sector/block
 	u32 m_chunk_blocks = 1;  // Number of sectors/blocks in a chunk
-	std::array<Cache, CACHE_LINES> m_cache;
+	std::vector<Cache> m_cache = std::vector<Cache>(CACHE_LINES);
+	u64 m_use_counter = 0;
 };
 
 class CBlobBigEndianReader
@@ -0,0 +1,388 @@
+// Copyright 2016 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include <zlib.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Common/Hash.h"
+#include "Common/Logging/Log.h"
+#include "Common/MsgHandler.h"
+#include "Common/StringUtil.h"
+#include "Common/ThreadPool.h"
+#include "DiscIO/Blob.h"
+#include "DiscIO/ChunkedBlob.h"
+#include "DiscIO/CompressedBlob.h"
+#include "DiscIO/DiscScrubber.h"
+
+namespace DiscIO
+{
+// Chunks converted per batch, each batch is spread over the thread pool.
+static const u32 COMPRESSION_BATCH_CHUNKS = 32;
+
+// Raw deflate streams, the index already holds a hash of every chunk.
+static const int ZLIB_WINDOW_BITS = -15;
+
+// Chunks have to be whole disc sectors and small enough to keep a few in the cache.
+static const u32 MIN_CHUNK_SIZE = 0x8000;
+static const u32 MAX_CHUNK_SIZE = 0x800000;
+
+static bool IsFilled(const u8* data, size_t size)
+{
+	return size == 0 || std::memcmp(data, data + 1, size - 1) == 0;
+}
+
+ChunkedBlobReader::ChunkedBlobReader(const std::string& filename) : m_file_name(filename)
+{
+	m_file.Open(filename, "rb");
+	m_file_size = File::GetSize(filename);
+}
+
+bool ChunkedBlobReader::Initialize()
+{
+	if (!m_file.ReadArray(&m_header, 1) || m_header.magic_cookie != kChunkedBlobCookie)
+		return false;
+
+	if (m_header.version != kChunkedBlobVersion)
+	{
+		ERROR_LOG(DISCIO, "%s: unsupported chunked blob version %u", m_file_name.c_str(),
+			m_header.version);
+		return false;
+	}
+
+	const u64 expected_chunks =
+		(m_header.data_size + m_header.chunk_size - 1) / std::max(m_header.chunk_size, 1u);
+	if (m_header.chunk_size < MIN_CHUNK_SIZE || m_header.chunk_size > MAX_CHUNK_SIZE ||
+		m_header.num_chunks != expected_chunks ||
+		m_header.index_offset + sizeof(ChunkedBlobIndexEntry) * m_header.num_chunks > m_file_size)
+	{
+		ERROR_LOG(DISCIO, "%s: corrupt chunked blob header", m_file_name.c_str());
+		return false;
+	}
+
+	m_index.resize(m_header.num_chunks);
+	if (!m_file.Seek(m_header.index_offset, SEEK_SET) ||
+		!m_file.ReadArray(m_index.data(), m_index.size()))
+	{
+		return false;
+	}
+
+	SetSectorSize(m_header.chunk_size);
+	m_read_buffer.resize(m_header.chunk_size);
+	return true;
+}
+
+std::unique_ptr<ChunkedBlobReader> ChunkedBlobReader::Create(const std::string& filename)
+{
+	std::unique_ptr<ChunkedBlobReader> reader(new ChunkedBlobReader(filename));
+	if (!reader->Initialize())
+		return nullptr;
+
+	return reader;
+}
+
+bool ChunkedBlobReader::GetBlock(u64 block_num, u8* out_ptr)
+{
+	if (block_num >= m_index.size())
+		return false;
+
+	const ChunkedBlobIndexEntry& entry = m_index[block_num];
+	const u32 chunk_size = m_header.chunk_size;
+
+	if (entry.method == ChunkMethod::FILL)
+	{
+		std::fill(out_ptr, out_ptr + chunk_size, entry.fill);
+		return true;
+	}
+
+	const u32 stored_size = entry.stored_size;
+	if (stored_size > chunk_size || entry.offset + stored_size > m_file_size)
+	{
+		ERROR_LOG(DISCIO, "%s: chunk %" PRIu64 " points outside of the file", m_file_name.c_str(),
+			block_num);
+		return false;
+	}
+
+	u8* source = entry.method == ChunkMethod::STORED ? out_ptr : m_read_buffer.data();
+	m_file.Seek(entry.offset, SEEK_SET);
+	if (!m_file.ReadBytes(source, stored_size))
+	{
+		PanicAlertT("The disc image \"%s\" is truncated, some of the data is missing.",
+			m_file_name.c_str());
+		return false;
+	}
+
+	if (HashAdler32(source, stored_size) != entry.hash)
+	{
+		PanicAlertT("Hash of chunk %" PRIu64 " is %08x instead of %08x.\n"
+			"Your disc image \"%s\" is corrupt.",
+			block_num, HashAdler32(source, stored_size), entry.hash, m_file_name.c_str());
+		return false;
+	}
+
+	if (entry.method == ChunkMethod::STORED)
+		return stored_size == chunk_size;
+
+	if (entry.method != ChunkMethod::ZLIB)
+	{
+		ERROR_LOG(DISCIO, "%s: chunk %" PRIu64 " uses unknown method %u", m_file_name.c_str(),
+			block_num, static_cast<u32>(entry.method));
+		return false;
+	}
+
+	z_stream z = {};
+	z.next_in = source;
+	z.avail_in = stored_size;
+	z.next_out = out_ptr;
+	z.avail_out = chunk_size;
+	if (inflateInit2(&z, ZLIB_WINDOW_BITS) != Z_OK)
+		return false;
+	const int status = inflate(&z, Z_FINISH);
+	inflateEnd(&z);
+
+	if (status != Z_STREAM_END || z.avail_out != 0)
+	{
+		ERROR_LOG(DISCIO, "%s: failed to inflate chunk %" PRIu64 " (%d)", m_file_name.c_str(),
+			block_num, status);
+		return false;
+	}
+
+	return true;
+}
+
+bool CompressFileToChunkedBlob(const std::string& infile, const std::string& outfile,
+	u32 sub_type, int chunk_size, CompressCB callback, void* arg)
+{
+	if (chunk_size < (int)MIN_CHUNK_SIZE || chunk_size > (int)MAX_CHUNK_SIZE ||
+		chunk_size % 0x8000 != 0)
+	{
+		PanicAlertT("Invalid chunk size %i.", chunk_size);
+		return false;
+	}
+
+	if (IsGCZBlob(infile) || IsChunkedBlob(infile))
+	{
+		PanicAlertT("\"%s\" is already compressed! Cannot compress it further.", infile.c_str());
+		return false;
+	}
+
+	File::IOFile inf(infile, "rb");
+	if (!inf)
+	{
+		PanicAlertT("Failed to open the input file \"%s\".", infile.c_str());
+		return false;
+	}
+
+	File::IOFile f(outfile, "wb");
+	if (!f)
+	{
+		PanicAlertT("Failed to open the output file \"%s\".\n"
+			"Check that you have permissions to write the target folder and that the media can "
+			"be written.",
+			outfile.c_str());
+		return false;
+	}
+
+	bool scrubbing = false;
+	DiscScrubber disc_scrubber;
+	if (sub_type == 1)
+	{
+		if (!disc_scrubber.SetupScrub(infile))
+		{
+			PanicAlertT("\"%s\" failed to be scrubbed. Probably the image is corrupt.", infile.c_str());
+			return false;
+		}
+
+		scrubbing = true;
+	}
+
+	if (callback)
+		callback(GetStringT("Files opened, ready to compress."), 0, arg);
+
+	ChunkedBlobHeader header = {};
+	header.magic_cookie = kChunkedBlobCookie;
+	header.version = kChunkedBlobVersion;
+	header.sub_type = sub_type;
+	header.chunk_size = chunk_size;
+	header.data_size = File::GetSize(infile);
+	header.num_chunks = (u32)((header.data_size + (chunk_size - 1)) / chunk_size);
+
+	// Chunks are read, compressed and written a batch at a time, like CompressFileToBlob does.
+	const u32 batch_chunks = std::min(COMPRESSION_BATCH_CHUNKS, std::max(header.num_chunks, 1u));
+	std::vector<ChunkedBlobIndexEntry> index(header.num_chunks);
+	std::vector<u8> in_buf((size_t)chunk_size * batch_chunks);
+	std::vector<u8> out_buf((size_t)chunk_size * batch_chunks);
+	Common::ParallelLoop compress_loop;
+	std::atomic<bool> deflate_failed(false);
+
+	// The index is written after the data, only the header is filled in at the end.
+	f.Seek(sizeof(ChunkedBlobHeader), SEEK_SET);
+
+	u64 position = sizeof(ChunkedBlobHeader);
+	int progress_monitor = std::max<int>(1, header.num_chunks / 1000);
+	bool success = true;
+
+	for (u32 first = 0; first < header.num_chunks && success; first += batch_chunks)
+	{
+		const u32 count = std::min(batch_chunks, header.num_chunks - first);
+
+		for (u32 j = 0; j < count; j++)
+		{
+			const u32 i = first + j;
+			if (callback && i % progress_monitor == 0)
+			{
+				const u64 inpos = inf.Tell();
+				int ratio = 0;
+				if (inpos != 0)
+					ratio = (int)(100 * position / inpos);
+
+				std::string temp =
+					StringFromFormat(GetStringT("%i of %i blocks. Compression ratio %i%%").c_str(), i,
+						header.num_chunks, ratio);
+				if (!callback(temp, (float)i / (float)header.num_chunks, arg))
+				{
+					success = false;
+					break;
+				}
+			}
+
+			u8* chunk_in = &in_buf[(size_t)j * chunk_size];
+			size_t read_bytes;
+			if (scrubbing && disc_scrubber.CanBlockBeScrubbed((u64)i * chunk_size, chunk_size))
+			{
+				// Nothing but unused clusters, which are written as zeros without being read
+				inf.Seek(chunk_size, SEEK_CUR);
+				read_bytes = 0;
+			}
+			else
+			{
+				inf.ReadArray(chunk_in, chunk_size, &read_bytes);
+			}
+			if (read_bytes < (size_t)chunk_size)
+				std::fill(chunk_in + read_bytes, chunk_in + chunk_size, 0);
+		}
+		if (!success)
+			break;
+
+		compress_loop.Loop([&](int lower, int upper) {
+			z_stream z = {};
+			if (deflateInit2(&z, 9, Z_DEFLATED, ZLIB_WINDOW_BITS, 9, Z_DEFAULT_STRATEGY) != Z_OK)
+			{
+				deflate_failed.store(true);
+				return;
+			}
+
+			for (int j = lower; j < upper; j++)
+			{
+				const u8* chunk_in = &in_buf[(size_t)j * chunk_size];
+				u8* chunk_out = &out_buf[(size_t)j * chunk_size];
+				ChunkedBlobIndexEntry& entry = index[first + j];
+
+				if (IsFilled(chunk_in, chunk_size))
+				{
+					entry.method = ChunkMethod::FILL;
+					entry.fill = chunk_in[0];
+					continue;
+				}
+
+				if (deflateReset(&z) != Z_OK)
+				{
+					deflate_failed.store(true);
+					break;
+				}
+				z.next_in = const_cast<u8*>(chunk_in);
+				z.avail_in = chunk_size;
+				z.next_out = chunk_out;
+				z.avail_out = chunk_size;
+
+				const int status = deflate(&z, Z_FINISH);
+				// Chunks that don't shrink by at least 3% are not worth inflating on every read.
+				if (status == Z_STREAM_END && z.avail_out >= (u32)chunk_size / 32)
+				{
+					entry.method = ChunkMethod::ZLIB;
+					entry.stored_size = chunk_size - z.avail_out;
+					entry.hash = HashAdler32(chunk_out, entry.stored_size);
+				}
+				else
+				{
+					entry.method = ChunkMethod::STORED;
+					entry.stored_size = chunk_size;
+					entry.hash = HashAdler32(chunk_in, chunk_size);
+				}
+			}
+
+			deflateEnd(&z);
+		}, 0, (int)count, 1);
+
+		if (deflate_failed.load())
+		{
+			ERROR_LOG(DISCIO, "Deflate failed");
+			success = false;
+			break;
+		}
+
+		for (u32 j = 0; j < count; j++)
+		{
+			ChunkedBlobIndexEntry& entry = index[first + j];
+			entry.offset = position;
+			if (entry.method == ChunkMethod::FILL)
+				continue;
+
+			const u8* write_buf = entry.method == ChunkMethod::STORED ?
+				&in_buf[(size_t)j * chunk_size] :
+				&out_buf[(size_t)j * chunk_size];
+			if (!f.WriteBytes(write_buf, entry.stored_size))
+			{
+				PanicAlertT("Failed to write the output file \"%s\".\n"
+					"Check that you have enough space available on the target drive.",
+					outfile.c_str());
+				success = false;
+				break;
+			}
+
+			position += entry.stored_size;
+		}
+	}
+
+	if (success)
+	{
+		header.index_offset = position;
+		success = f.WriteArray(index.data(), index.size()) && f.Seek(0, SEEK_SET) &&
+			f.WriteArray(&header, 1);
+		if (!success)
+		{
+			PanicAlertT("Failed to write the output file \"%s\".\n"
+				"Check that you have enough space available on the target drive.",
+				outfile.c_str());
+		}
+	}
+
+	if (!success)
+	{
+		// Remove the incomplete output file.
+		f.Close();
+		File::Delete(outfile);
+	}
+
+	if (success && callback)
+		callback(GetStringT("Done compressing disc image."), 1.0f, arg);
+	return success;
+}
+
+bool IsChunkedBlob(const std::string& filename)
+{
+	File::IOFile f(filename, "rb");
+
+	ChunkedBlobHeader header;
+	return f.ReadArray(&header, 1) && (header.magic_cookie == kChunkedBlobCookie);
+}
+
+}  // namespace
@@ -0,0 +1,99 @@
+// Copyright 2016 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+// WARNING Code not big-endian safe.
+
+// To create new chunked BLOBs, use CompressFileToChunkedBlob.
+
+// File format
+// * Header
+// * [Chunk data]
+// * [Chunk index]
+//
+// Compared to GCZ, the chunks are larger (which compresses better and needs fewer inflate
+// calls), the index is written last so the writer never has to seek back over the data, and
+// chunks that are filled with a single byte value (such as the areas DiscScrubber blanks out)
+// take no space in the file and are regenerated on read instead of being inflated.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "DiscIO/Blob.h"
+
+namespace DiscIO
+{
+bool IsChunkedBlob(const std::string& filename);
+
+const u32 kChunkedBlobCookie = 0xB10BC4C0;
+const u32 kChunkedBlobVersion = 1;
+
+enum class ChunkMethod : u8
+{
+	// The chunk is stored as is.
+	STORED = 0,
+	// The chunk is a raw deflate stream.
+	ZLIB = 1,
+	// Every byte of the chunk has the value in ChunkedBlobIndexEntry::fill, nothing is stored.
+	FILL = 2
+};
+
+struct ChunkedBlobHeader  // 40 bytes
+{
+	u32 magic_cookie;  // kChunkedBlobCookie
+	u32 version;
+	u32 sub_type;      // 1 if the image was scrubbed
+	u32 chunk_size;
+	u64 data_size;
+	u64 index_offset;
+	u32 num_chunks;
+	u32 reserved;
+};
+
+struct ChunkedBlobIndexEntry  // 24 bytes
+{
+	u64 offset;         // File offset of the stored data
+	u32 stored_size;    // 0 for FILL chunks
+	u32 hash;           // Adler32 of the stored data
+	ChunkMethod method;
+	u8 fill;
+	u16 reserved1;
+	u32 reserved2;
+};
+
+static_assert(sizeof(ChunkedBlobHeader) == 40, "Wrong ChunkedBlobHeader size");
+static_assert(sizeof(ChunkedBlobIndexEntry) == 24, "Wrong ChunkedBlobIndexEntry size");
+
+class ChunkedBlobReader : public SectorReader
+{
+public:
+	static std::unique_ptr<ChunkedBlobReader> Create(const std::string& filename);
+
+	const ChunkedBlobHeader& GetHeader() const { return m_header; }
+	BlobType GetBlobType() const override { return BlobType::CHUNKED; }
+	u64 GetDataSize() const override { return m_header.data_size; }
+	u64 GetRawSize() const override { return m_file_size; }
+	bool GetBlock(u64 block_num, u8* out_ptr) override;
+
+private:
+	ChunkedBlobReader(const std::string& filename);
+	bool Initialize();
+
+	ChunkedBlobHeader m_header;
+	std::vector<ChunkedBlobIndexEntry> m_index;
+	File::IOFile m_file;
+	u64 m_file_size;
+	std::vector<u8> m_read_buffer;
+	std::string m_file_name;
+};
+
+bool CompressFileToChunkedBlob(const std::string& infile, const std::string& outfile,
+	u32 sub_type = 0, int chunk_size = 128 * 1024,
+	CompressCB callback = nullptr, void* arg = nullptr);
+
+}  // namespace
@@ -8,6 +8,7 @@
 #endif
 
 #include <algorithm>
+#include <atomic>
 #include <cinttypes>
 #include <cstdio>
 #include <cstring>
@@ -22,12 +23,24 @@
 #include "Common/Logging/Log.h"
 #include "Common/MsgHandler.h"
 #include "Common/StringUtil.h"
+#include "Common/Thread.h"
+#include "Common/ThreadPool.h"
 #include "DiscIO/Blob.h"
 #include "DiscIO/CompressedBlob.h"
 #include "DiscIO/DiscScrubber.h"
 
 namespace DiscIO
 {
+// Blocks converted per batch, each batch is spread over the thread pool.
+static const u32 COMPRESSION_BATCH_BLOCKS = 128;
+
+static std::atomic<u32> s_cache_size{512 * 1024};
+
+void SetCompressedBlobCacheSize(u32 bytes)
+{
+	s_cache_size.store(bytes);
+}
+
 CompressedBlobReader::CompressedBlobReader(const std::string& filename) : m_file_name(filename)
 {
 	m_file.Open(filename, "rb");
@@ -51,6 +64,9 @@ CompressedBlobReader::CompressedBlobReader(const std::string& filename) : m_file
 // I still add some safety margin.
 	const u32 zlib_buffer_size = m_header.block_size + 64;
 	m_zlib_buffer.resize(zlib_buffer_size);
+
+	if (m_header.block_size)
+		SetCacheSize(s_cache_size.load() / m_header.block_size);
 }
 
 std::unique_ptr<CompressedBlobReader> CompressedBlobReader::Create(const std::string& filename)
@@ -63,6 +79,12 @@ std::unique_ptr<CompressedBlobReader> CompressedBlobReader::Create(const std::st
 
 CompressedBlobReader::~CompressedBlobReader()
 {
+	if (m_read_ahead_thread.joinable())
+	{
+		m_read_ahead_running.store(false);
+		m_read_ahead_event.Set();
+		m_read_ahead_thread.join();
+	}
 }
 
 // IMPORTANT: Calling this function invalidates all earlier pointers gotten from this function.
@@ -80,32 +102,118 @@ u64 CompressedBlobReader::GetBlockCompressedSize(u64 block_num) const
 
 bool CompressedBlobReader::GetBlock(u64 block_num, u8* out_ptr)
 {
-	bool uncompressed = false;
-	u32 comp_block_size = (u32)GetBlockCompressedSize(block_num);
-	u64 offset = m_block_pointers[block_num] + m_data_offset;
+	std::lock_guard<std::mutex> lk(m_mutex);
+	UpdateReadAhead(block_num);
 
-	if (offset & (1ULL << 63))
+	auto it = m_read_ahead_blocks.find(block_num);
+	if (it != m_read_ahead_blocks.end())
 	{
-		if (comp_block_size != m_header.block_size)
-			PanicAlert("Uncompressed block with wrong size");
-		uncompressed = true;
-		offset &= ~(1ULL << 63);
+		std::copy(it->second.begin(), it->second.end(), out_ptr);
+		m_read_ahead_blocks.erase(it);
+		return true;
 	}
 
 	// clear unused part of zlib buffer. maybe this can be deleted when it works fully.
+	const u32 comp_block_size = (u32)GetBlockCompressedSize(block_num);
 	memset(&m_zlib_buffer[comp_block_size], 0, m_zlib_buffer.size() - comp_block_size);
 
+	return ReadCompressedBlock(block_num, m_zlib_buffer.data()) &&
+		DecompressBlock(block_num, m_zlib_buffer.data(), out_ptr);
+}
+
+// Called with m_mutex held.
+void CompressedBlobReader::UpdateReadAhead(u64 block_num)
+{
+	if (block_num == m_last_block + 1)
+		m_sequential_blocks++;
+	else
+		m_sequential_blocks = 0;
+	m_last_block = block_num;
+
+	// Blocks behind the reader won't be asked for again
+	m_read_ahead_blocks.erase(m_read_ahead_blocks.begin(),
+		m_read_ahead_blocks.lower_bound(block_num));
+
+	if (m_sequential_blocks < SEQUENTIAL_READ_BLOCKS)
+	{
+		// Random access, stop the worker after its current block
+		m_read_ahead_end = m_read_ahead_next;
+		return;
+	}
+
+	if (m_read_ahead_next <= block_num || m_read_ahead_next > block_num + READ_AHEAD_BLOCKS)
+		m_read_ahead_next = block_num + 1;
+	m_read_ahead_end = std::min<u64>(block_num + 1 + READ_AHEAD_BLOCKS, m_header.num_blocks);
+
+	if (!m_read_ahead_thread.joinable())
+	{
+		m_read_ahead_running.store(true);
+		m_read_ahead_thread = std::thread(&CompressedBlobReader::ReadAheadThread, this);
+	}
+	m_read_ahead_event.Set();
+}
+
+void CompressedBlobReader::ReadAheadThread()
+{
+	Common::SetCurrentThreadName("GCZ read-ahead");
+
+	std::vector<u8> compressed(m_header.block_size);
+	while (m_read_ahead_running.load())
+	{
+		m_read_ahead_event.Wait();
+
+		while (m_read_ahead_running.load())
+		{
+			u64 block_num;
+			{
+				std::lock_guard<std::mutex> lk(m_mutex);
+				if (m_read_ahead_next >= m_read_ahead_end)
+					break;
+				block_num = m_read_ahead_next++;
+				if (m_read_ahead_blocks.count(block_num))
+					continue;
+				if (!ReadCompressedBlock(block_num, compressed.data()))
+					break;
+			}
+
+			// Inflating doesn't touch any shared state, GetBlock() can run meanwhile
+			std::vector<u8> block(m_header.block_size);
+			if (!DecompressBlock(block_num, compressed.data(), block.data()))
+				break;
+
+			std::lock_guard<std::mutex> lk(m_mutex);
+			if (block_num > m_last_block)
+				m_read_ahead_blocks[block_num] = std::move(block);
+		}
+	}
+}
+
+bool CompressedBlobReader::ReadCompressedBlock(u64 block_num, u8* buffer)
+{
+	u32 comp_block_size = (u32)GetBlockCompressedSize(block_num);
+	u64 offset = (m_block_pointers[block_num] & ~(1ULL << 63)) + m_data_offset;
+
 	m_file.Seek(offset, SEEK_SET);
-	if (!m_file.ReadBytes(m_zlib_buffer.data(), comp_block_size))
+	if (!m_file.ReadBytes(buffer, comp_block_size))
 	{
 		PanicAlertT("The disc image \"%s\" is truncated, some of the data is missing.",
 			m_file_name.c_str());
 		m_file.Clear();
 		return false;
 	}
+	return true;
+}
+
+bool CompressedBlobReader::DecompressBlock(u64 block_num, const u8* data, u8* out_ptr) const
+{
+	u32 comp_block_size = (u32)GetBlockCompressedSize(block_num);
+	const bool uncompressed = (m_block_pointers[block_num] & (1ULL << 63)) != 0;
+
+	if (uncompressed && comp_block_size != m_header.block_size)
+		PanicAlert("Uncompressed block with wrong size");
 
 	// First, check hash.
-	u32 block_hash = HashAdler32(m_zlib_buffer.data(), comp_block_size);
+	u32 block_hash = HashAdler32(data, comp_block_size);
 	if (block_hash != m_hashes[block_num])
 		PanicAlertT("The disc image \"%s\" is corrupt.\n"
 			"Hash of block %" PRIu64 " is %08x instead of %08x.",
@@ -113,12 +221,12 @@ bool CompressedBlobReader::GetBlock(u64 block_num, u8* out_ptr)
 
 	if (uncompressed)
 	{
-		std::copy(m_zlib_buffer.begin(), m_zlib_buffer.begin() + comp_block_size, out_ptr);
+		std::copy(data, data + comp_block_size, out_ptr);
 	}
 	else
 	{
 		z_stream z = {};
-		z.next_in = m_zlib_buffer.data();
+		z.next_in = const_cast<u8*>(data);
 		z.avail_in = comp_block_size;
 		if (z.avail_in > m_header.block_size)
 		{
@@ -173,9 +281,10 @@ bool CompressFileToBlob(const std::string& infile, const std::string& outfile, u
 		return false;
 	}
 
+	DiscScrubber disc_scrubber;
 	if (sub_type == 1)
 	{
-		if (!DiscScrubber::SetupScrub(infile, block_size))
+		if (!disc_scrubber.SetupScrub(infile))
 		{
 			PanicAlertT("\"%s\" failed to be scrubbed. Probably the image is corrupt.", infile.c_str());
 			return false;
@@ -184,13 +293,6 @@ bool CompressFileToBlob(const std::string& infile, const std::string& outfile, u
 		scrubbing = true;
 	}
 
-	z_stream z = {};
-	if (deflateInit(&z, 9) != Z_OK)
-	{
-		DiscScrubber::Cleanup();
-		return false;
-	}
-
 	callback(GetStringT("Files opened, ready to compress."), 0, arg);
 
 	CompressedBlobHeader header;
@@ -202,10 +304,18 @@ bool CompressFileToBlob(const std::string& infile, const std::string& outfile, u
 	// round upwards!
 	header.num_blocks = (u32)((header.data_size + (block_size - 1)) / block_size);
 
+	// Blocks are read, compressed and written a batch at a time. Reading and writing stay on
+	// this thread and in order, deflating is spread over the thread pool, so the output is the
+	// same as compressing one block after the other.
+	const u32 batch_blocks = std::min(COMPRESSION_BATCH_BLOCKS, std::max(header.num_blocks, 1u));
 	std::vector<u64> offsets(header.num_blocks);
 	std::vector<u32> hashes(header.num_blocks);
-	std::vector<u8> out_buf(block_size);
-	std::vector<u8> in_buf(block_size);
+	std::vector<u8> out_buf((size_t)block_size * batch_blocks);
+	std::vector<u8> in_buf((size_t)block_size * batch_blocks);
+	// Compressed size of each block in the batch, 0 when it is stored as is
+	std::vector<int> comp_sizes(batch_blocks);
+	Common::ParallelLoop compress_loop;
+	std::atomic<bool> deflate_failed(false);
 
 	// seek past the header (we will write it at the end)
 	f.Seek(sizeof(CompressedBlobHeader), SEEK_CUR);
@@ -219,84 +329,133 @@ bool CompressFileToBlob(const std::string& infile, const std::string& outfile, u
 	int progress_monitor = std::max<int>(1, header.num_blocks / 1000);
 	bool success = true;
 
-	for (u32 i = 0; i < header.num_blocks; i++)
+	for (u32 first = 0; first < header.num_blocks && success; first += batch_blocks)
 	{
-		if (i % progress_monitor == 0)
+		const u32 count = std::min(batch_blocks, header.num_blocks - first);
+
+		for (u32 j = 0; j < count; j++)
 		{
-			const u64 inpos = inf.Tell();
-			int ratio = 0;
-			if (inpos != 0)
-				ratio = (int)(100 * position / inpos);
-
-			std::string temp =
-				StringFromFormat(GetStringT("%i of %i blocks. Compression ratio %i%%").c_str(), i,
-					header.num_blocks, ratio);
-			bool was_cancelled = !callback(temp, (float)i / (float)header.num_blocks, arg);
-			if (was_cancelled)
+			const u32 i = first + j;
+			if (i % progress_monitor == 0)
 			{
-				success = false;
-				break;
+				const u64 inpos = inf.Tell();
+				int ratio = 0;
+				if (inpos != 0)
+					ratio = (int)(100 * position / inpos);
+
+				std::string temp =
+					StringFromFormat(GetStringT("%i of %i blocks. Compression ratio %i%%").c_str(), i,
+						header.num_blocks, ratio);
+				bool was_cancelled = !callback(temp, (float)i / (float)header.num_blocks, arg);
+				if (was_cancelled)
+				{
+					success = false;
+					break;
+				}
+			}
+
+			u8* block_in = &in_buf[(size_t)j * block_size];
+			size_t read_bytes;
+			if (scrubbing && disc_scrubber.CanBlockBeScrubbed((u64)i * block_size, block_size))
+			{
+				// Nothing but unused clusters, which are written as zeros without being read
+				inf.Seek(block_size, SEEK_CUR);
+				read_bytes = 0;
+			}
+			else
+			{
+				inf.ReadArray(block_in, header.block_size, &read_bytes);
 			}
+			if (read_bytes < header.block_size)
+				std::fill(block_in + read_bytes, block_in + header.block_size, 0);
 		}
+		if (!success)
+			break;
 
-		offsets[i] = position;
+		compress_loop.Loop([&](int lower, int upper) {
+			z_stream z = {};
+			if (deflateInit(&z, 9) != Z_OK)
+			{
+				deflate_failed.store(true);
+				return;
+			}
 
-		size_t read_bytes;
-		if (scrubbing)
-			read_bytes = DiscScrubber::GetNextBlock(inf, in_buf.data());
-		else
-			inf.ReadArray(in_buf.data(), header.block_size, &read_bytes);
-		if (read_bytes < header.block_size)
-			std::fill(in_buf.begin() + read_bytes, in_buf.begin() + header.block_size, 0);
+			for (int j = lower; j < upper; j++)
+			{
+				u8* block_in = &in_buf[(size_t)j * block_size];
+				u8* block_out = &out_buf[(size_t)j * block_size];
+
+				int retval = deflateReset(&z);
+				z.next_in = block_in;
+				z.avail_in = header.block_size;
+				z.next_out = block_out;
+				z.avail_out = block_size;
+
+				if (retval != Z_OK)
+				{
+					deflate_failed.store(true);
+					break;
+				}
+
+				int status = deflate(&z, Z_FINISH);
+				int comp_size = block_size - z.avail_out;
+
+				if ((status != Z_STREAM_END) || (z.avail_out < 10))
+				{
+					// let's store uncompressed
+					comp_sizes[j] = 0;
+					hashes[first + j] = HashAdler32(block_in, block_size);
+				}
+				else
+				{
+					// let's store compressed
+					comp_sizes[j] = comp_size;
+					hashes[first + j] = HashAdler32(block_out, comp_size);
+				}
+			}
 
-		int retval = deflateReset(&z);
-		z.next_in = in_buf.data();
-		z.avail_in = header.block_size;
-		z.next_out = out_buf.data();
-		z.avail_out = block_size;
+			deflateEnd(&z);
+		}, 0, (int)count, 1);
 
-		if (retval != Z_OK)
+		if (deflate_failed.load())
 		{
 			ERROR_LOG(DISCIO, "Deflate failed");
 			success = false;
 			break;
 		}
 
-		int status = deflate(&z, Z_FINISH);
-		int comp_size = block_size - z.avail_out;
-
-		u8* write_buf;
-		int write_size;
-		if ((status != Z_STREAM_END) || (z.avail_out < 10))
+		for (u32 j = 0; j < count; j++)
 		{
-			// PanicAlert("%i %i Store %i", i*block_size, position, comp_size);
-			// let's store uncompressed
-			write_buf = in_buf.data();
-			offsets[i] |= 0x8000000000000000ULL;
-			write_size = block_size;
-			num_stored++;
-		}
-		else
-		{
-			// let's store compressed
-			// PanicAlert("Comp %i to %i", block_size, comp_size);
-			write_buf = out_buf.data();
-			write_size = comp_size;
-			num_compressed++;
-		}
+			const u32 i = first + j;
+			offsets[i] = position;
 
-		if (!f.WriteBytes(write_buf, write_size))
-		{
-			PanicAlertT("Failed to write the output file \"%s\".\n"
-				"Check that you have enough space available on the target drive.",
-				outfile.c_str());
-			success = false;
-			break;
-		}
+			u8* write_buf;
+			int write_size;
+			if (comp_sizes[j] == 0)
+			{
+				write_buf = &in_buf[(size_t)j * block_size];
+				offsets[i] |= 0x8000000000000000ULL;
+				write_size = block_size;
+				num_stored++;
+			}
+			else
+			{
+				write_buf = &out_buf[(size_t)j * block_size];
+				write_size = comp_sizes[j];
+				num_compressed++;
+			}
 
-		position += write_size;
+			if (!f.WriteBytes(write_buf, write_size))
+			{
+				PanicAlertT("Failed to write the output file \"%s\".\n"
+					"Check that you have enough space available on the target drive.",
+					outfile.c_str());
+				success = false;
+				break;
+			}
 
-		hashes[i] = HashAdler32(write_buf, write_size);
+			position += write_size;
+		}
 	}
 
 	header.compressed_data_size = position;
@@ -316,10 +475,6 @@ bool CompressFileToBlob(const std::string& infile, const std::string& outfile, u
 		f.WriteArray(hashes.data(), header.num_blocks);
 	}
 
-	// Cleanup
-	deflateEnd(&z);
-	DiscScrubber::Cleanup();
-
 	if (success)
 	{
 		callback(GetStringT("Done compressing disc image."), 1.0f, arg);
@@ -353,16 +508,18 @@ bool DecompressBlobToFile(const std::string& infile, const std::string& outfile,
 		return false;
 	}
 
+	// Reading stays on this thread and in order, inflating is spread over the thread pool.
 	const CompressedBlobHeader& header = reader->GetHeader();
-	static const size_t BUFFER_BLOCKS = 32;
-	size_t buffer_size = header.block_size * BUFFER_BLOCKS;
-	size_t last_buffer_size = header.block_size * (header.num_blocks % BUFFER_BLOCKS);
-	std::vector<u8> buffer(buffer_size);
+	static const u32 BUFFER_BLOCKS = COMPRESSION_BATCH_BLOCKS;
+	std::vector<u8> compressed((size_t)header.block_size * BUFFER_BLOCKS);
+	std::vector<u8> buffer((size_t)header.block_size * BUFFER_BLOCKS);
 	u32 num_buffers = (header.num_blocks + BUFFER_BLOCKS - 1) / BUFFER_BLOCKS;
 	int progress_monitor = std::max<int>(1, num_buffers / 100);
+	Common::ParallelLoop decompress_loop;
+	std::atomic<bool> decompress_failed(false);
 	bool success = true;
 
-	for (u64 i = 0; i < num_buffers; i++)
+	for (u32 i = 0; i < num_buffers; i++)
 	{
 		if (i % progress_monitor == 0)
 		{
@@ -373,8 +530,28 @@ bool DecompressBlobToFile(const std::string& infile, const std::string& outfile,
 				break;
 			}
 		}
-		const size_t sz = i == num_buffers - 1 ? last_buffer_size : buffer_size;
-		reader->Read(i * buffer_size, sz, buffer.data());
+		const u32 first = i * BUFFER_BLOCKS;
+		const u32 count = std::min(BUFFER_BLOCKS, header.num_blocks - first);
+		for (u32 j = 0; j < count && success; j++)
+			success = reader->ReadCompressedBlock(first + j, &compressed[(size_t)j * header.block_size]);
+		if (!success)
+			break;
+
+		decompress_loop.Loop([&](int lower, int upper) {
+			for (int j = lower; j < upper; j++)
+			{
+				const size_t offset = (size_t)j * header.block_size;
+				if (!reader->DecompressBlock(first + j, &compressed[offset], &buffer[offset]))
+					decompress_failed.store(true);
+			}
+		}, 0, (int)count, 1);
+		if (decompress_failed.load())
+		{
+			success = false;
+			break;
+		}
+
+		const size_t sz = (size_t)header.block_size * count;
 		if (!f.WriteBytes(buffer.data(), sz))
 		{
 			PanicAlertT("Failed to write the output file \"%s\".\n"
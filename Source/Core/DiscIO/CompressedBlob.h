@@ -13,11 +13,16 @@
 
 #pragma once
 
+#include <atomic>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "Common/CommonTypes.h"
+#include "Common/Event.h"
 #include "Common/FileUtil.h"
 #include "DiscIO/Blob.h"
 
@@ -25,6 +30,9 @@ namespace DiscIO
 {
 bool IsGCZBlob(const std::string& filename);
 
+// Bytes of decompressed blocks each CompressedBlobReader created afterwards keeps cached.
+void SetCompressedBlobCacheSize(u32 bytes);
+
 const u32 kBlobCookie = 0xB10BC001;
 
 // GCZ file structure:
@@ -55,9 +63,36 @@ public:
 	u64 GetBlockCompressedSize(u64 block_num) const;
 	bool GetBlock(u64 block_num, u8* out_ptr) override;
 
+	// GetBlock() split in two, so bulk conversions can decompress on several threads.
+	// ReadCompressedBlock() reads the stored data of a block (up to block_size bytes) and must
+	// be called from one thread at a time. DecompressBlock() checks and inflates that data and
+	// can run on any thread.
+	bool ReadCompressedBlock(u64 block_num, u8* buffer);
+	bool DecompressBlock(u64 block_num, const u8* data, u8* out_ptr) const;
+
 private:
 	CompressedBlobReader(const std::string& filename);
 
+	// Sequential reads of at least this many blocks start the read-ahead worker, which keeps
+	// the next READ_AHEAD_BLOCKS blocks decompressed.
+	static const u32 SEQUENTIAL_READ_BLOCKS = 2;
+	static const u32 READ_AHEAD_BLOCKS = 16;
+
+	void UpdateReadAhead(u64 block_num);
+	void ReadAheadThread();
+
+	// Guards the file, the zlib buffer and the read-ahead state between GetBlock() and the
+	// read-ahead worker.
+	std::mutex m_mutex;
+	std::thread m_read_ahead_thread;
+	Common::Event m_read_ahead_event;
+	std::atomic<bool> m_read_ahead_running{false};
+	std::map<u64, std::vector<u8>> m_read_ahead_blocks;
+	u64 m_read_ahead_next = 0;
+	u64 m_read_ahead_end = 0;
+	u64 m_last_block = ~0ULL;
+	u32 m_sequential_blocks = 0;
+
 	CompressedBlobHeader m_header;
 	std::vector<u64> m_block_pointers;
 	std::vector<u32> m_hashes;
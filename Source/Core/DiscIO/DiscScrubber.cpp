@@ -3,16 +3,16 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <atomic>
 #include <cinttypes>
 #include <cstddef>
-#include <cstdio>
 #include <memory>
 #include <string>
 #include <vector>
 
 #include "Common/CommonTypes.h"
-#include "Common/FileUtil.h"
 #include "Common/Logging/Log.h"
+#include "Common/ThreadPool.h"
 #include "DiscIO/DiscScrubber.h"
 #include "DiscIO/Filesystem.h"
 #include "DiscIO/Volume.h"
@@ -20,162 +20,91 @@
 
 namespace DiscIO
 {
-namespace DiscScrubber
-{
-#define CLUSTER_SIZE 0x8000
-
-static u8* m_FreeTable = nullptr;
-static u64 m_FileSize;
-static u64 m_BlockCount;
-static u32 m_BlockSize;
-static int m_BlocksPerCluster;
-static bool m_isScrubbing = false;
+static const u64 CLUSTER_SIZE = 0x8000;
+static const u64 CLUSTER_DATA_SIZE = 0x7c00;
 
-static std::string m_Filename;
-static std::unique_ptr<IVolume> s_disc;
-
-struct SPartitionHeader
-{
-	u8* Ticket[0x2a4];
-	u32 TMDSize;
-	u64 TMDOffset;
-	u32 CertChainSize;
-	u64 CertChainOffset;
-	// H3Size is always 0x18000
-	u64 H3Offset;
-	u64 DataOffset;
-	u64 DataSize;
-	// TMD would be here
-	u64 DOLOffset;
-	u64 DOLSize;
-	u64 FSTOffset;
-	u64 FSTSize;
-	u32 ApploaderSize;
-	u32 ApploaderTrailerSize;
-};
-struct SPartition
-{
-	u32 GroupNumber;
-	u32 Number;
-	u64 Offset;
-	u32 Type;
-	SPartitionHeader Header;
-};
-struct SPartitionGroup
-{
-	u32 numPartitions;
-	u64 PartitionsOffset;
-	std::vector<SPartition> PartitionsVec;
-};
-static SPartitionGroup PartitionGroup[4];
-
-void MarkAsUsed(u64 _Offset, u64 _Size);
-void MarkAsUsedE(u64 partition_data_offset, u64 offset, u64 size);
-bool ReadFromVolume(u64 _Offset, u32& _Buffer, bool _Decrypt);
-bool ReadFromVolume(u64 _Offset, u64& _Buffer, bool _Decrypt);
-bool ParseDisc();
-bool ParsePartitionData(SPartition& _rPartition);
-
-bool SetupScrub(const std::string& filename, int block_size)
+// Helper functions for reading the BE volume
+static bool ReadFromVolume(const IVolume& volume, u64 offset, u32& buffer, bool decrypt)
 {
-	bool success = true;
-	m_Filename = filename;
-	m_BlockSize = block_size;
+	return volume.ReadSwapped(offset, &buffer, decrypt);
+}
 
-	if (CLUSTER_SIZE % m_BlockSize != 0)
-	{
-		ERROR_LOG(DISCIO, "Block size %i is not a factor of 0x8000, scrubbing not possible",
-			m_BlockSize);
+static bool ReadFromVolume(const IVolume& volume, u64 offset, u64& buffer, bool decrypt)
+{
+	u32 temp_buffer;
+	if (!volume.ReadSwapped(offset, &temp_buffer, decrypt))
 		return false;
-	}
+	buffer = static_cast<u64>(temp_buffer) << 2;
+	return true;
+}
 
-	m_BlocksPerCluster = CLUSTER_SIZE / m_BlockSize;
+bool DiscScrubber::SetupScrub(const std::string& filename)
+{
+	m_filename = filename;
 
-	s_disc = CreateVolumeFromFilename(filename);
-	if (!s_disc)
+	std::unique_ptr<IVolume> disc = CreateVolumeFromFilename(filename);
+	if (!disc)
 		return false;
 
-	m_FileSize = s_disc->GetSize();
+	m_file_size = disc->GetSize();
+	disc.reset();
 
-	u32 numClusters = (u32)(m_FileSize / CLUSTER_SIZE);
+	const u64 num_clusters = (m_file_size + CLUSTER_SIZE - 1) / CLUSTER_SIZE;
 
 	// Warn if not DVD5 or DVD9 size
-	if (numClusters != 0x23048 && numClusters != 0x46090)
-		WARN_LOG(DISCIO, "%s is not a standard sized Wii disc! (%x blocks)", filename.c_str(),
-			numClusters);
-
-	// Table of free blocks
-	m_FreeTable = new u8[numClusters];
-	std::fill(m_FreeTable, m_FreeTable + numClusters, 1);
+	if (num_clusters != 0x23048 && num_clusters != 0x46090)
+		WARN_LOG(DISCIO, "%s is not a standard sized Wii disc! (%" PRIx64 " blocks)",
+			filename.c_str(), num_clusters);
 
-	// Fill out table of free blocks
-	success = ParseDisc();
+	// Table of free clusters
+	m_free_table.assign(num_clusters, 1);
 
-	// Done with it; need it closed for the next part
-	s_disc.reset();
-	m_BlockCount = 0;
-
-	// Let's not touch the file if we've failed up to here :p
-	if (!success)
-		Cleanup();
+	// Fill out table of free clusters
+	if (!ParseDisc())
+	{
+		// Let's not touch the file if we've failed up to here :p
+		m_free_table.clear();
+		return false;
+	}
 
-	m_isScrubbing = success;
-	return success;
+	return true;
 }
 
-size_t GetNextBlock(File::IOFile& in, u8* buffer)
+bool DiscScrubber::CanBlockBeScrubbed(u64 offset, u64 size) const
 {
-	u64 CurrentOffset = m_BlockCount * m_BlockSize;
-	u64 i = CurrentOffset / CLUSTER_SIZE;
+	if (m_free_table.empty() || size == 0)
+		return false;
 
-	size_t ReadBytes = 0;
-	if (m_isScrubbing && m_FreeTable[i])
+	const u64 first_cluster = offset / CLUSTER_SIZE;
+	const u64 end_cluster = std::min<u64>((offset + size - 1) / CLUSTER_SIZE + 1, m_free_table.size());
+	for (u64 i = first_cluster; i < end_cluster; i++)
 	{
-		DEBUG_LOG(DISCIO, "Freeing 0x%016" PRIx64, CurrentOffset);
-		std::fill(buffer, buffer + m_BlockSize, 0x00);
-		in.Seek(m_BlockSize, SEEK_CUR);
-		ReadBytes = m_BlockSize;
-	}
-	else
-	{
-		DEBUG_LOG(DISCIO, "Used    0x%016" PRIx64, CurrentOffset);
-		in.ReadArray(buffer, m_BlockSize, &ReadBytes);
+		if (!m_free_table[i])
+			return false;
 	}
 
-	m_BlockCount++;
-	return ReadBytes;
+	return first_cluster < end_cluster;
 }
 
-void Cleanup()
+void DiscScrubber::MarkAsUsed(u64 offset, u64 size)
 {
-	if (m_FreeTable)
-		delete[] m_FreeTable;
-	m_FreeTable = nullptr;
-	m_FileSize = 0;
-	m_BlockCount = 0;
-	m_BlockSize = 0;
-	m_BlocksPerCluster = 0;
-	m_isScrubbing = false;
-}
+	u64 current_offset = offset;
+	const u64 end_offset = current_offset + size;
 
-void MarkAsUsed(u64 _Offset, u64 _Size)
-{
-	u64 CurrentOffset = _Offset;
-	u64 EndOffset = CurrentOffset + _Size;
+	DEBUG_LOG(DISCIO, "Marking 0x%016" PRIx64 " - 0x%016" PRIx64 " as used", offset, end_offset);
 
-	DEBUG_LOG(DISCIO, "Marking 0x%016" PRIx64 " - 0x%016" PRIx64 " as used", _Offset, EndOffset);
-
-	while ((CurrentOffset < EndOffset) && (CurrentOffset < m_FileSize))
+	while (current_offset < end_offset && current_offset < m_file_size)
 	{
-		m_FreeTable[CurrentOffset / CLUSTER_SIZE] = 0;
-		CurrentOffset += CLUSTER_SIZE;
+		m_free_table[current_offset / CLUSTER_SIZE] = 0;
+		current_offset += CLUSTER_SIZE;
 	}
 }
 
 // Compensate for 0x400 (SHA-1) per 0x8000 (cluster), and round to whole clusters
-void MarkAsUsedE(u64 partition_data_offset, u64 offset, u64 size)
+void DiscScrubber::AddEncryptedRange(u64 partition_data_offset, u64 offset, u64 size,
+	std::vector<UsedRange>* used)
 {
-	u64 first_cluster_start = offset / 0x7c00 * CLUSTER_SIZE + partition_data_offset;
+	u64 first_cluster_start = offset / CLUSTER_DATA_SIZE * CLUSTER_SIZE + partition_data_offset;
 
 	u64 last_cluster_end;
 	if (size == 0)
@@ -185,147 +114,142 @@ void MarkAsUsedE(u64 partition_data_offset, u64 offset, u64 size)
 	}
 	else
 	{
-		last_cluster_end = ((offset + size - 1) / 0x7c00 + 1) * CLUSTER_SIZE + partition_data_offset;
+		last_cluster_end =
+			((offset + size - 1) / CLUSTER_DATA_SIZE + 1) * CLUSTER_SIZE + partition_data_offset;
 	}
 
-	MarkAsUsed(first_cluster_start, last_cluster_end - first_cluster_start);
+	used->push_back({first_cluster_start, last_cluster_end - first_cluster_start});
 }
 
-// Helper functions for reading the BE volume
-bool ReadFromVolume(u64 _Offset, u32& _Buffer, bool _Decrypt)
+bool DiscScrubber::ParseDisc()
 {
-	return s_disc->ReadSwapped(_Offset, &_Buffer, _Decrypt);
-}
-
-bool ReadFromVolume(u64 _Offset, u64& _Buffer, bool _Decrypt)
-{
-	u32 temp_buffer;
-	if (!s_disc->ReadSwapped(_Offset, &temp_buffer, _Decrypt))
+	std::unique_ptr<IVolume> disc = CreateVolumeFromFilename(m_filename);
+	if (!disc)
 		return false;
-	_Buffer = static_cast<u64>(temp_buffer) << 2;
-	return true;
-}
 
-bool ParseDisc()
-{
 	// Mark the header as used - it's mostly 0s anyways
 	MarkAsUsed(0, 0x50000);
 
-	for (int x = 0; x < 4; x++)
+	std::vector<Partition> partitions;
+	for (u32 x = 0; x < 4; x++)
 	{
-		if (!ReadFromVolume(0x40000 + (x * 8) + 0, PartitionGroup[x].numPartitions, false) ||
-			!ReadFromVolume(0x40000 + (x * 8) + 4, PartitionGroup[x].PartitionsOffset, false))
+		u32 num_partitions;
+		u64 partitions_offset;
+		if (!ReadFromVolume(*disc, 0x40000 + (x * 8) + 0, num_partitions, false) ||
+			!ReadFromVolume(*disc, 0x40000 + (x * 8) + 4, partitions_offset, false))
 			return false;
 
 		// Read all partitions
-		for (u32 i = 0; i < PartitionGroup[x].numPartitions; i++)
+		for (u32 i = 0; i < num_partitions; i++)
 		{
-			SPartition Partition;
-
-			Partition.GroupNumber = x;
-			Partition.Number = i;
-
-			if (!ReadFromVolume(PartitionGroup[x].PartitionsOffset + (i * 8) + 0, Partition.Offset,
-				false) ||
-				!ReadFromVolume(PartitionGroup[x].PartitionsOffset + (i * 8) + 4, Partition.Type,
-					false) ||
-				!ReadFromVolume(Partition.Offset + 0x2a4, Partition.Header.TMDSize, false) ||
-				!ReadFromVolume(Partition.Offset + 0x2a8, Partition.Header.TMDOffset, false) ||
-				!ReadFromVolume(Partition.Offset + 0x2ac, Partition.Header.CertChainSize, false) ||
-				!ReadFromVolume(Partition.Offset + 0x2b0, Partition.Header.CertChainOffset, false) ||
-				!ReadFromVolume(Partition.Offset + 0x2b4, Partition.Header.H3Offset, false) ||
-				!ReadFromVolume(Partition.Offset + 0x2b8, Partition.Header.DataOffset, false) ||
-				!ReadFromVolume(Partition.Offset + 0x2bc, Partition.Header.DataSize, false))
+			Partition partition;
+			partition.group_number = x;
+			partition.number = i;
+
+			PartitionHeader& header = partition.header;
+			if (!ReadFromVolume(*disc, partitions_offset + (i * 8) + 0, partition.offset, false) ||
+				!ReadFromVolume(*disc, partitions_offset + (i * 8) + 4, partition.type, false) ||
+				!ReadFromVolume(*disc, partition.offset + 0x2a4, header.tmd_size, false) ||
+				!ReadFromVolume(*disc, partition.offset + 0x2a8, header.tmd_offset, false) ||
+				!ReadFromVolume(*disc, partition.offset + 0x2ac, header.cert_chain_size, false) ||
+				!ReadFromVolume(*disc, partition.offset + 0x2b0, header.cert_chain_offset, false) ||
+				!ReadFromVolume(*disc, partition.offset + 0x2b4, header.h3_offset, false) ||
+				!ReadFromVolume(*disc, partition.offset + 0x2b8, header.data_offset, false) ||
+				!ReadFromVolume(*disc, partition.offset + 0x2bc, header.data_size, false))
 				return false;
 
-			PartitionGroup[x].PartitionsVec.push_back(Partition);
-		}
+			MarkAsUsed(partition.offset, 0x2c0);
 
-		for (auto& rPartition : PartitionGroup[x].PartitionsVec)
-		{
-			const SPartitionHeader& rHeader = rPartition.Header;
-
-			MarkAsUsed(rPartition.Offset, 0x2c0);
-
-			MarkAsUsed(rPartition.Offset + rHeader.TMDOffset, rHeader.TMDSize);
-			MarkAsUsed(rPartition.Offset + rHeader.CertChainOffset, rHeader.CertChainSize);
-			MarkAsUsed(rPartition.Offset + rHeader.H3Offset, 0x18000);
+			MarkAsUsed(partition.offset + header.tmd_offset, header.tmd_size);
+			MarkAsUsed(partition.offset + header.cert_chain_offset, header.cert_chain_size);
+			MarkAsUsed(partition.offset + header.h3_offset, 0x18000);
 			// This would mark the whole (encrypted) data area
 			// we need to parse FST and other crap to find what's free within it!
-			// MarkAsUsed(rPartition.Offset + rHeader.DataOffset, rHeader.DataSize);
+			// MarkAsUsed(partition.offset + header.data_offset, header.data_size);
 
-			// Parse Data! This is where the big gain is
-			if (!ParsePartitionData(rPartition))
-				return false;
+			partitions.push_back(partition);
 		}
 	}
+	disc.reset();
+
+	// Parse Data! This is where the big gain is. Every partition gets its own volume, so the
+	// decryption and filesystem parsing run in parallel, and the results are marked afterwards.
+	std::vector<std::vector<UsedRange>> used(partitions.size());
+	std::atomic<bool> parsed_ok(true);
+	Common::ParallelLoop parse_loop;
+	parse_loop.Loop([&](int lower, int upper) {
+		for (int i = lower; i < upper; i++)
+		{
+			if (!ParsePartitionData(partitions[i], &used[i]))
+				parsed_ok.store(false);
+		}
+	}, 0, static_cast<int>(partitions.size()), 1);
+
+	if (!parsed_ok.load())
+		return false;
+
+	for (const std::vector<UsedRange>& ranges : used)
+	{
+		for (const UsedRange& range : ranges)
+			MarkAsUsed(range.offset, range.size);
+	}
 
 	return true;
 }
 
-// Operations dealing with encrypted space are done here - the volume is swapped to allow this
-bool ParsePartitionData(SPartition& partition)
+// Operations dealing with encrypted space are done here
+bool DiscScrubber::ParsePartitionData(const Partition& partition,
+	std::vector<UsedRange>* used) const
 {
-	bool parsed_ok = true;
-
-	// Switch out the main volume temporarily
-	std::unique_ptr<IVolume> old_volume;
-	s_disc.swap(old_volume);
-
-	// Ready some stuff
-	s_disc = CreateVolumeFromFilename(m_Filename, partition.GroupNumber, partition.Number);
-	if (s_disc == nullptr)
+	std::unique_ptr<IVolume> volume =
+		CreateVolumeFromFilename(m_filename, partition.group_number, partition.number);
+	if (volume == nullptr)
 	{
-		ERROR_LOG(DISCIO, "Failed to create volume from file %s", m_Filename.c_str());
-		s_disc.swap(old_volume);
+		ERROR_LOG(DISCIO, "Failed to create volume from file %s", m_filename.c_str());
 		return false;
 	}
 
-	std::unique_ptr<IFileSystem> filesystem(CreateFileSystem(s_disc.get()));
+	std::unique_ptr<IFileSystem> filesystem(CreateFileSystem(volume.get()));
 	if (!filesystem)
 	{
-		ERROR_LOG(DISCIO, "Failed to create filesystem for group %d partition %u",
-			partition.GroupNumber, partition.Number);
-		parsed_ok = false;
+		ERROR_LOG(DISCIO, "Failed to create filesystem for group %u partition %u",
+			partition.group_number, partition.number);
+		return false;
 	}
-	else
+
+	const u64 data_offset = partition.offset + partition.header.data_offset;
+	bool parsed_ok = true;
+
+	// Mark things as used which are not in the filesystem
+	// Header, Header Information, Apploader
+	u32 apploader_size = 0;
+	u32 apploader_trailer_size = 0;
+	parsed_ok = parsed_ok && ReadFromVolume(*volume, 0x2440 + 0x14, apploader_size, true);
+	parsed_ok = parsed_ok && ReadFromVolume(*volume, 0x2440 + 0x18, apploader_trailer_size, true);
+	AddEncryptedRange(data_offset, 0, 0x2440 + apploader_size + apploader_trailer_size, used);
+
+	// DOL
+	const u64 dol_offset = filesystem->GetBootDOLOffset();
+	const u64 dol_size = filesystem->GetBootDOLSize(dol_offset);
+	parsed_ok = parsed_ok && dol_offset && dol_size;
+	AddEncryptedRange(data_offset, dol_offset, dol_size, used);
+
+	// FST
+	u64 fst_offset = 0;
+	u64 fst_size = 0;
+	parsed_ok = parsed_ok && ReadFromVolume(*volume, 0x424, fst_offset, true);
+	parsed_ok = parsed_ok && ReadFromVolume(*volume, 0x428, fst_size, true);
+	AddEncryptedRange(data_offset, fst_offset, fst_size, used);
+
+	// Go through the filesystem and mark entries as used
+	for (const SFileInfo& file : filesystem->GetFileList())
 	{
-		// Mark things as used which are not in the filesystem
-		// Header, Header Information, Apploader
-		parsed_ok = parsed_ok && ReadFromVolume(0x2440 + 0x14, partition.Header.ApploaderSize, true);
-		parsed_ok =
-			parsed_ok && ReadFromVolume(0x2440 + 0x18, partition.Header.ApploaderTrailerSize, true);
-		MarkAsUsedE(partition.Offset + partition.Header.DataOffset, 0,
-			0x2440 + partition.Header.ApploaderSize + partition.Header.ApploaderTrailerSize);
-
-		// DOL
-		partition.Header.DOLOffset = filesystem->GetBootDOLOffset();
-		partition.Header.DOLSize = filesystem->GetBootDOLSize(partition.Header.DOLOffset);
-		parsed_ok = parsed_ok && partition.Header.DOLOffset && partition.Header.DOLSize;
-		MarkAsUsedE(partition.Offset + partition.Header.DataOffset, partition.Header.DOLOffset,
-			partition.Header.DOLSize);
-
-		// FST
-		parsed_ok = parsed_ok && ReadFromVolume(0x424, partition.Header.FSTOffset, true);
-		parsed_ok = parsed_ok && ReadFromVolume(0x428, partition.Header.FSTSize, true);
-		MarkAsUsedE(partition.Offset + partition.Header.DataOffset, partition.Header.FSTOffset,
-			partition.Header.FSTSize);
-
-		// Go through the filesystem and mark entries as used
-		for (SFileInfo file : filesystem->GetFileList())
-		{
-			DEBUG_LOG(DISCIO, "%s", file.m_FullPath.empty() ? "/" : file.m_FullPath.c_str());
-			if ((file.m_NameOffset & 0x1000000) == 0)
-				MarkAsUsedE(partition.Offset + partition.Header.DataOffset, file.m_Offset, file.m_FileSize);
-		}
+		DEBUG_LOG(DISCIO, "%s", file.m_FullPath.empty() ? "/" : file.m_FullPath.c_str());
+		if ((file.m_NameOffset & 0x1000000) == 0)
+			AddEncryptedRange(data_offset, file.m_Offset, file.m_FileSize, used);
 	}
 
-	// Swap back
-	s_disc.swap(old_volume);
-
 	return parsed_ok;
 }
 
-}  // namespace DiscScrubber
-
 }  // namespace DiscIO
@@ -13,21 +13,64 @@
 #pragma once
 
 #include <string>
-#include "Common/CommonTypes.h"
+#include <vector>
 
-namespace File
-{
-class IOFile;
-}
+#include "Common/CommonTypes.h"
 
 namespace DiscIO
 {
-namespace DiscScrubber
+class DiscScrubber final
 {
-bool SetupScrub(const std::string& filename, int block_size);
-size_t GetNextBlock(File::IOFile& in, u8* buffer);
-void Cleanup();
+public:
+	// Parses the disc and builds the table of used clusters. The partitions are parsed in
+	// parallel, each with its own volume.
+	bool SetupScrub(const std::string& filename);
+
+	// True if no data is stored in [offset, offset + size), so the range can be written as zeros.
+	// Only reads the table, so compression workers can call it concurrently after setup.
+	bool CanBlockBeScrubbed(u64 offset, u64 size) const;
+
+private:
+	struct PartitionHeader
+	{
+		u32 tmd_size;
+		u64 tmd_offset;
+		u32 cert_chain_size;
+		u64 cert_chain_offset;
+		// H3 size is always 0x18000
+		u64 h3_offset;
+		u64 data_offset;
+		u64 data_size;
+	};
+
+	struct Partition
+	{
+		u32 group_number;
+		u32 number;
+		u64 offset;
+		u32 type;
+		PartitionHeader header;
+	};
+
+	// A range of disc offsets that holds data
+	struct UsedRange
+	{
+		u64 offset;
+		u64 size;
+	};
+
+	// Compensates for the hashes in every cluster of a partition's encrypted data area
+	static void AddEncryptedRange(u64 partition_data_offset, u64 offset, u64 size,
+		std::vector<UsedRange>* used);
+
+	void MarkAsUsed(u64 offset, u64 size);
+	bool ParseDisc();
+	bool ParsePartitionData(const Partition& partition, std::vector<UsedRange>* used) const;
 
-}  // namespace DiscScrubber
+	std::string m_filename;
+	u64 m_file_size = 0;
+	// One entry per cluster, nonzero if the cluster is unused
+	std::vector<u8> m_free_table;
+};
 
 }  // namespace DiscIO
@@ -0,0 +1,119 @@
+// Copyright 2016 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <mbedtls/md5.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include <zlib.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/Crypto/SHA1.h"
+#include "Common/StringUtil.h"
+#include "Common/ThreadPool.h"
+#include "DiscIO/Blob.h"
+#include "DiscIO/DiscVerifier.h"
+
+namespace DiscIO
+{
+// Large reads keep the drive streaming, and two buffers of this size are in memory at once.
+static const size_t HASH_READ_SIZE = 8 * 1024 * 1024;
+
+enum HashTask
+{
+	TASK_READ_NEXT,
+	TASK_MD5,
+	TASK_SHA1,
+	TASK_CRC32,
+	NUM_HASH_TASKS
+};
+
+template <typename T>
+static std::string ToHex(const T& digest)
+{
+	std::string out;
+	for (u8 n : digest)
+		out += StringFromFormat("%02x", n);
+	return out;
+}
+
+bool HashDisc(const std::string& file_path, DiscHashes* hashes,
+	const std::function<bool(int)>& report_progress)
+{
+	std::unique_ptr<IBlobReader> file(CreateBlobReader(file_path));
+	if (!file)
+		return false;
+
+	const u64 game_size = file->GetDataSize();
+	std::vector<u8> buffers[2];
+	buffers[0].resize(HASH_READ_SIZE);
+	buffers[1].resize(HASH_READ_SIZE);
+
+	mbedtls_md5_context md5;
+	mbedtls_md5_init(&md5);
+	mbedtls_md5_starts(&md5);
+	Common::SHA1::Context sha1;
+	uLong crc = crc32(0, Z_NULL, 0);
+
+	u64 read_offset = 0;
+	size_t read_size = static_cast<size_t>(std::min<u64>(HASH_READ_SIZE, game_size));
+	bool success = file->Read(0, read_size, buffers[0].data());
+	Common::ParallelLoop hash_loop;
+
+	for (int current = 0; success && read_size > 0; current ^= 1)
+	{
+		const u8* data = buffers[current].data();
+		const u64 next_offset = read_offset + read_size;
+		const size_t next_size =
+			static_cast<size_t>(std::min<u64>(HASH_READ_SIZE, game_size - next_offset));
+
+		// The hashes are sequential by nature, but each one can run on its own thread, and the
+		// next block is read at the same time.
+		hash_loop.Loop([&](int lower, int upper) {
+			for (int task = lower; task < upper; task++)
+			{
+				switch (task)
+				{
+				case TASK_READ_NEXT:
+					if (next_size)
+						success = file->Read(next_offset, next_size, buffers[current ^ 1].data());
+					break;
+				case TASK_MD5:
+					mbedtls_md5_update(&md5, data, read_size);
+					break;
+				case TASK_SHA1:
+					sha1.Update(data, read_size);
+					break;
+				case TASK_CRC32:
+					crc = crc32(crc, data, static_cast<uInt>(read_size));
+					break;
+				}
+			}
+		}, 0, NUM_HASH_TASKS, 1);
+
+		read_offset = next_offset;
+		read_size = next_size;
+
+		int progress =
+			static_cast<int>(static_cast<float>(read_offset) / static_cast<float>(game_size) * 100);
+		if (!report_progress(progress))
+			success = false;
+	}
+
+	std::array<u8, 16> md5_digest;
+	mbedtls_md5_finish(&md5, md5_digest.data());
+	mbedtls_md5_free(&md5);
+	if (!success)
+		return false;
+
+	hashes->md5 = ToHex(md5_digest);
+	hashes->sha1 = ToHex(sha1.Finish());
+	hashes->crc32 = StringFromFormat("%08x", static_cast<u32>(crc));
+	return true;
+}
+
+}  // namespace
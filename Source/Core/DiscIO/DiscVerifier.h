@@ -0,0 +1,26 @@
+// Copyright 2016 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <functional>
+#include <string>
+
+namespace DiscIO
+{
+// Lowercase hex digests of the disc data (after decompression for compressed images).
+struct DiscHashes
+{
+	std::string md5;
+	std::string sha1;
+	std::string crc32;
+};
+
+// Hashes the whole disc in one pass. The image is read in large blocks, and every block is
+// hashed with the three algorithms on separate threads while the next block is read.
+// report_progress gets the percentage done and cancels the hashing by returning false.
+bool HashDisc(const std::string& file_path, DiscHashes* hashes,
+	const std::function<bool(int)>& report_progress);
+
+}  // namespace
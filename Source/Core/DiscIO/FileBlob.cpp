@@ -3,27 +3,55 @@
 // Refer to the license.txt file included.
 
 #include "DiscIO/FileBlob.h"
+#include <cstring>
 #include <memory>
 #include <string>
 
 namespace DiscIO
 {
-PlainFileReader::PlainFileReader(std::FILE* file) : m_file(file)
+PlainFileReader::PlainFileReader(std::FILE* file, const std::string& filename) : m_file(file)
 {
 	m_size = m_file.GetSize();
+	if (m_map.Open(filename) && m_map.GetSize() != static_cast<u64>(m_size))
+		m_map.Close();
 }
 
 std::unique_ptr<PlainFileReader> PlainFileReader::Create(const std::string& filename)
 {
 	File::IOFile f(filename, "rb");
 	if (f)
-		return std::unique_ptr<PlainFileReader>(new PlainFileReader(f.ReleaseHandle()));
+		return std::unique_ptr<PlainFileReader>(new PlainFileReader(f.ReleaseHandle(), filename));
 
 	return nullptr;
 }
 
+bool PlainFileReader::PrepareMappedRead(u64 offset, u64 nbytes)
+{
+	if (!m_map.IsOpen() || offset > m_map.GetSize() || nbytes > m_map.GetSize() - offset)
+		return false;
+
+	if (offset == m_last_read_end)
+		m_map.Prefetch(offset + nbytes, READ_AHEAD_SIZE);
+	m_last_read_end = offset + nbytes;
+	return true;
+}
+
+const u8* PlainFileReader::GetMappedData(u64 offset, u64 nbytes)
+{
+	if (!PrepareMappedRead(offset, nbytes))
+		return nullptr;
+
+	return m_map.GetData() + offset;
+}
+
 bool PlainFileReader::Read(u64 offset, u64 nbytes, u8* out_ptr)
 {
+	if (PrepareMappedRead(offset, nbytes))
+	{
+		std::memcpy(out_ptr, m_map.GetData() + offset, static_cast<size_t>(nbytes));
+		return true;
+	}
+
 	if (m_file.Seek(offset, SEEK_SET) && m_file.ReadBytes(out_ptr, nbytes))
 	{
 		return true;
@@ -10,6 +10,7 @@
 
 #include "Common/CommonTypes.h"
 #include "Common/FileUtil.h"
+#include "Common/MappedFile.h"
 #include "DiscIO/Blob.h"
 
 namespace DiscIO
@@ -23,12 +24,24 @@ public:
 	u64 GetDataSize() const override { return m_size; }
 	u64 GetRawSize() const override { return m_size; }
 	bool Read(u64 offset, u64 nbytes, u8* out_ptr) override;
+	const u8* GetMappedData(u64 offset, u64 nbytes) override;
 
 private:
-	PlainFileReader(std::FILE* file);
+	PlainFileReader(std::FILE* file, const std::string& filename);
+
+	// Once reads continue where the previous one ended, the OS is asked to page in this many
+	// bytes past the end of every read.
+	static const u64 READ_AHEAD_SIZE = 4 * 1024 * 1024;
+
+	// Checks the range against the mapping and starts paging in what follows sequential reads.
+	bool PrepareMappedRead(u64 offset, u64 nbytes);
 
 	File::IOFile m_file;
+	// Images are read straight from the mapping when the address space allows it (it usually
+	// doesn't for dual layer images on 32-bit builds), m_file is the fallback.
+	File::MappedFile m_map;
 	s64 m_size;
+	u64 m_last_read_end = 0;
 };
 
 }  // namespace
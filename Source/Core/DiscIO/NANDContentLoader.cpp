@@ -15,6 +15,7 @@
 #include <vector>
 
 #include "Common/CommonFuncs.h"
+#include "Common/CommonPaths.h"
 #include "Common/CommonTypes.h"
 #include "Common/FileUtil.h"
 #include "Common/Logging/Log.h"
@@ -22,6 +23,7 @@
 #include "Common/MsgHandler.h"
 #include "Common/NandPaths.h"
 #include "Common/StringUtil.h"
+#include "Common/Crypto/SHA1.h"
 
 #include "DiscIO/Enums.h"
 #include "DiscIO/NANDContentLoader.h"
@@ -266,11 +268,24 @@ void CNANDContentLoader::InitializeContentEntries(const std::vector<u8>& tmd,
 		{
 			u32 rounded_size = ROUND_UP(content.m_Size, 0x40);
 
+			// Contents decrypted by an earlier load are read from the cache as they are accessed
+			const std::string cache_filename = GetCachedContentPath(content);
+			if (File::Exists(cache_filename) && File::GetSize(cache_filename) == content.m_Size)
+			{
+				content.m_Data = std::make_unique<CNANDContentDataFile>(cache_filename);
+				data_app_offset += rounded_size;
+				continue;
+			}
+
 			iv.fill(0);
 			std::copy(&tmd[entry_offset + 0x01E8], &tmd[entry_offset + 0x01E8 + 2], iv.begin());
 
-			content.m_Data = std::make_unique<CNANDContentDataBuffer>(AESDecode(
-				decrypted_title_key.data(), iv.data(), &data_app[data_app_offset], rounded_size));
+			std::vector<u8> decrypted = AESDecode(decrypted_title_key.data(), iv.data(),
+				&data_app[data_app_offset], rounded_size);
+			if (StoreCachedContent(content, decrypted, cache_filename))
+				content.m_Data = std::make_unique<CNANDContentDataFile>(cache_filename);
+			else
+				content.m_Data = std::make_unique<CNANDContentDataBuffer>(decrypted);
 
 			data_app_offset += rounded_size;
 			continue;
@@ -290,6 +305,44 @@ void CNANDContentLoader::InitializeContentEntries(const std::vector<u8>& tmd,
 	}
 }
 
+// The cache is shared by all titles, a file is named after the hash the TMD gives its content
+std::string CNANDContentLoader::GetCachedContentPath(const SNANDContent& content)
+{
+	std::string filename = File::GetUserPath(D_CACHE_IDX) + "NANDContent" DIR_SEP;
+	for (u8 byte : content.m_SHA1Hash)
+		filename += StringFromFormat("%02x", byte);
+	return filename + ".app";
+}
+
+bool CNANDContentLoader::StoreCachedContent(const SNANDContent& content,
+	const std::vector<u8>& decrypted, const std::string& filename)
+{
+	if (decrypted.size() < content.m_Size)
+		return false;
+
+	const Common::SHA1::Digest hash = Common::SHA1::CalculateDigest(decrypted.data(), content.m_Size);
+	if (!std::equal(hash.begin(), hash.end(), content.m_SHA1Hash))
+	{
+		WARN_LOG(DISCIO, "Content %08x does not match the hash in the TMD, not caching it",
+			content.m_ContentID);
+		return false;
+	}
+
+	// Written under another name first so that a cached file is always complete
+	const std::string temp_filename = filename + ".tmp";
+	File::CreateFullPath(filename);
+	{
+		File::IOFile file(temp_filename, "wb");
+		if (!file.WriteBytes(decrypted.data(), content.m_Size))
+		{
+			file.Close();
+			File::Delete(temp_filename);
+			return false;
+		}
+	}
+	return File::Rename(temp_filename, filename);
+}
+
 std::vector<u8> CNANDContentLoader::AESDecode(const u8* key, u8* iv, const u8* src, u32 size)
 {
 	mbedtls_aes_context aes_ctx;
@@ -110,6 +110,11 @@ private:
 		const std::vector<u8>& decrypted_title_key,
 		const std::vector<u8>& data_app);
 
+	// Decrypted WAD contents are kept on disk so that loading the title again neither decrypts
+	// them nor keeps them in memory
+	static std::string GetCachedContentPath(const SNANDContent& content);
+	static bool StoreCachedContent(const SNANDContent& content, const std::vector<u8>& decrypted,
+		const std::string& filename);
 	static std::vector<u8> AESDecode(const u8* key, u8* iv, const u8* src, u32 size);
 	static std::vector<u8> GetKeyFromTicket(const std::vector<u8>& ticket);
 
@@ -25,6 +25,9 @@ public:
 	virtual ~IVolume() {}
 	// decrypt parameter must be false if not reading a Wii disc
 	virtual bool Read(u64 _Offset, u64 _Length, u8* _pBuffer, bool decrypt) const = 0;
+	// Zero-copy variant of Read, see IBlobReader::GetMappedData. Returns nullptr when the data
+	// has to be read with Read instead.
+	virtual const u8* GetMappedData(u64 offset, u64 length, bool decrypt) const { return nullptr; }
 	template <typename T>
 	bool ReadSwapped(u64 offset, T* buffer, bool decrypt) const
 	{
@@ -27,6 +27,7 @@ public:
 	CVolumeGC(std::unique_ptr<IBlobReader> reader);
 	~CVolumeGC();
 	bool Read(u64 _Offset, u64 _Length, u8* _pBuffer, bool decrypt = false) const override;
+	const u8* GetMappedData(u64 offset, u64 length, bool decrypt) const override;
 	std::string GetGameID() const override;
 	std::string GetMakerID() const override;
 	u16 GetRevision() const override;
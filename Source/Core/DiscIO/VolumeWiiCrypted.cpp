@@ -2,11 +2,11 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <atomic>
 #include <cstddef>
 #include <cstring>
 #include <map>
-#include <mbedtls/aes.h>
-#include <mbedtls/sha1.h>
 #include <memory>
 #include <string>
 #include <utility>
@@ -14,8 +14,11 @@
 
 #include "Common/CommonFuncs.h"
 #include "Common/CommonTypes.h"
+#include "Common/Crypto/AES.h"
+#include "Common/Crypto/SHA1.h"
 #include "Common/Logging/Log.h"
 #include "Common/MsgHandler.h"
+#include "Common/ThreadPool.h"
 #include "DiscIO/Blob.h"
 #include "DiscIO/Enums.h"
 #include "DiscIO/FileMonitor.h"
@@ -27,22 +30,30 @@
 
 namespace DiscIO
 {
+// The hash tree: each cluster holds the H0 hashes of its data, and the H1 and H2 tables of
+// the subgroup of 8 clusters and the group of 64 clusters it belongs to. The H3 table has
+// one hash per group.
+static const u32 CLUSTERS_PER_SUBGROUP = 8;
+static const u32 CLUSTERS_PER_GROUP = 64;
+static const u64 H3_TABLE_SIZE = 0x18000;
+// Groups read at once by CheckIntegrity, twice that is kept in memory.
+static const u32 INTEGRITY_BATCH_GROUPS = 8;
+
 CVolumeWiiCrypted::CVolumeWiiCrypted(std::unique_ptr<IBlobReader> reader, u64 _VolumeOffset,
 	const unsigned char* _pVolumeKey)
-	: m_pReader(std::move(reader)), m_AES_ctx(std::make_unique<mbedtls_aes_context>()),
-	m_VolumeOffset(_VolumeOffset), m_dataOffset(0x20000), m_LastDecryptedBlockOffset(-1)
+	: m_pReader(std::move(reader)),
+	m_decryptor(std::make_unique<Common::AES::CBCDecryptor>(_pVolumeKey)),
+	m_VolumeOffset(_VolumeOffset), m_dataOffset(0x20000), m_cluster_cache(CLUSTER_CACHE_SIZE)
 {
-	mbedtls_aes_setkey_dec(m_AES_ctx.get(), _pVolumeKey, 128);
 }
 
 bool CVolumeWiiCrypted::ChangePartition(u64 offset)
 {
 	m_VolumeOffset = offset;
-	m_LastDecryptedBlockOffset = -1;
 
 	u8 volume_key[16];
 	DiscIO::VolumeKeyForPartition(*m_pReader, offset, volume_key);
-	mbedtls_aes_setkey_dec(m_AES_ctx.get(), volume_key, 128);
+	m_decryptor->SetKey(volume_key);
 	return true;
 }
 
@@ -60,39 +71,35 @@ bool CVolumeWiiCrypted::Read(u64 _ReadOffset, u64 _Length, u8* _pBuffer, bool de
 
 	FileMon::FindFilename(_ReadOffset);
 
-	std::vector<u8> read_buffer(s_block_total_size);
 	while (_Length > 0)
 	{
 		// Calculate block offset
 		u64 Block = _ReadOffset / s_block_data_size;
 		u64 Offset = _ReadOffset % s_block_data_size;
 
-		if (m_LastDecryptedBlockOffset != Block)
+		u64 CopySize;
+		if (const CachedCluster* cluster = FindCachedCluster(Block))
 		{
-			// Read the current block
-			if (!m_pReader->Read(m_VolumeOffset + m_dataOffset + Block * s_block_total_size,
-				s_block_total_size, read_buffer.data()))
-				return false;
-
-			// Decrypt the block's data.
-			// 0x3D0 - 0x3DF in m_pBuffer will be overwritten,
-			// but that won't affect anything, because we won't
-			// use the content of m_pBuffer anymore after this
-			mbedtls_aes_crypt_cbc(m_AES_ctx.get(), MBEDTLS_AES_DECRYPT, s_block_data_size,
-				&read_buffer[0x3D0], &read_buffer[s_block_header_size],
-				m_LastDecryptedBlock);
-			m_LastDecryptedBlockOffset = Block;
-
-			// The only thing we currently use from the 0x000 - 0x3FF part
-			// of the block is the IV (at 0x3D0), but it also contains SHA-1
-			// hashes that IOS uses to check that discs aren't tampered with.
-			// http://wiibrew.org/wiki/Wii_Disc#Encrypted
+			// Copy the decrypted data
+			u64 MaxSizeToCopy = s_block_data_size - Offset;
+			CopySize = (_Length > MaxSizeToCopy) ? MaxSizeToCopy : _Length;
+			memcpy(_pBuffer, &cluster->data[Offset], (size_t)CopySize);
 		}
+		else
+		{
+			// Decrypt the run of clusters the read still needs that aren't cached.
+			const u64 last_block = (_ReadOffset + _Length - 1) / s_block_data_size;
+			u64 count = 1;
+			while (Block + count <= last_block && count < MAX_DECRYPT_BATCH_CLUSTERS &&
+				!FindCachedCluster(Block + count))
+			{
+				count++;
+			}
 
-		// Copy the decrypted data
-		u64 MaxSizeToCopy = s_block_data_size - Offset;
-		u64 CopySize = (_Length > MaxSizeToCopy) ? MaxSizeToCopy : _Length;
-		memcpy(_pBuffer, &m_LastDecryptedBlock[Offset], (size_t)CopySize);
+			CopySize = ReadClusters(Block, count, Offset, _Length, _pBuffer);
+			if (!CopySize)
+				return false;
+		}
 
 		// Update offsets
 		_Length -= CopySize;
@@ -103,6 +110,92 @@ bool CVolumeWiiCrypted::Read(u64 _ReadOffset, u64 _Length, u8* _pBuffer, bool de
 	return true;
 }
 
+const CVolumeWiiCrypted::CachedCluster* CVolumeWiiCrypted::FindCachedCluster(u64 block) const
+{
+	const u64 offset = GetClusterOffset(block);
+	for (CachedCluster& cluster : m_cluster_cache)
+	{
+		if (cluster.offset == offset)
+		{
+			cluster.last_use = ++m_cluster_use_counter;
+			return &cluster;
+		}
+	}
+	return nullptr;
+}
+
+CVolumeWiiCrypted::CachedCluster* CVolumeWiiCrypted::GetEmptyCachedCluster(u64 block) const
+{
+	CachedCluster* oldest = &*std::min_element(m_cluster_cache.begin(), m_cluster_cache.end(),
+		[](const CachedCluster& a, const CachedCluster& b) { return a.last_use < b.last_use; });
+	oldest->offset = GetClusterOffset(block);
+	oldest->last_use = ++m_cluster_use_counter;
+	return oldest;
+}
+
+void CVolumeWiiCrypted::DecryptCluster(const u8* encrypted, u8* out) const
+{
+	// The IV is at 0x3D0 in the cluster's hash block. The only thing we currently use from the
+	// 0x000 - 0x3FF part of the cluster is that IV, but it also contains SHA-1 hashes that IOS
+	// uses to check that discs aren't tampered with.
+	// http://wiibrew.org/wiki/Wii_Disc#Encrypted
+	m_decryptor->DecryptCBC(&encrypted[0x3D0], &encrypted[s_block_header_size], out,
+		s_block_data_size);
+}
+
+u64 CVolumeWiiCrypted::ReadClusters(u64 block, u64 count, u64 offset_in_block, u64 length,
+	u8* out_ptr) const
+{
+	// Adjacent clusters are adjacent in the image, so the run is a single read.
+	std::vector<u8> encrypted(count * s_block_total_size);
+	if (!m_pReader->Read(GetClusterOffset(block), encrypted.size(), encrypted.data()))
+		return 0;
+
+	if (count == 1)
+	{
+		CachedCluster* cluster = GetEmptyCachedCluster(block);
+		DecryptCluster(encrypted.data(), cluster->data.data());
+		const u64 copy_size = std::min<u64>(length, s_block_data_size - offset_in_block);
+		memcpy(out_ptr, &cluster->data[offset_in_block], (size_t)copy_size);
+		return copy_size;
+	}
+
+	std::vector<u8> decrypted(count * s_block_data_size);
+	auto decrypt = [&](int lower, int upper) {
+		for (int i = lower; i < upper; i++)
+		{
+			DecryptCluster(&encrypted[i * s_block_total_size], &decrypted[i * s_block_data_size]);
+		}
+	};
+	if (count >= PARALLEL_DECRYPT_CLUSTERS)
+	{
+		Common::ParallelLoop decrypt_loop;
+		decrypt_loop.Loop(decrypt, 0, static_cast<int>(count), 2);
+	}
+	else
+	{
+		decrypt(0, static_cast<int>(count));
+	}
+
+	const u64 copy_size = std::min<u64>(length, decrypted.size() - offset_in_block);
+	memcpy(out_ptr, &decrypted[offset_in_block], (size_t)copy_size);
+
+	// Only the last cluster is kept, the next read usually continues in it.
+	const u64 last = count - 1;
+	std::copy_n(&decrypted[last * s_block_data_size], s_block_data_size,
+		GetEmptyCachedCluster(block + last)->data.begin());
+	return copy_size;
+}
+
+const u8* CVolumeWiiCrypted::GetMappedData(u64 offset, u64 length, bool decrypt) const
+{
+	// Decrypted data never exists as is in the image.
+	if (decrypt || m_pReader == nullptr)
+		return nullptr;
+
+	return m_pReader->GetMappedData(offset, length);
+}
+
 bool CVolumeWiiCrypted::GetTitleID(u64* buffer) const
 {
 	// Tik is at m_VolumeOffset size 0x2A4
@@ -315,29 +408,22 @@ u64 CVolumeWiiCrypted::GetRawSize() const
 		return 0;
 }
 
-bool CVolumeWiiCrypted::CheckIntegrity() const
+bool CVolumeWiiCrypted::CheckGroupIntegrity(u32 group, const u8* encrypted, u32 num_clusters,
+	const u8* h3_hash) const
 {
-	// Get partition data size
-	u32 partSizeDiv4;
-	Read(m_VolumeOffset + 0x2BC, 4, (u8*)&partSizeDiv4, false);
-	u64 partDataSize = (u64)Common::swap32(partSizeDiv4) * 4;
-
-	u32 nClusters = (u32)(partDataSize / 0x8000);
-	for (u32 clusterID = 0; clusterID < nClusters; ++clusterID)
+	const u32 first_cluster = group * CLUSTERS_PER_GROUP;
+	std::vector<u8> hash_blocks(num_clusters * s_block_header_size);
+	std::vector<u8> cluster_data(s_block_data_size);
+	bool all_meaningful = true;
+	bool meaningful[CLUSTERS_PER_GROUP];
+
+	// H0: the hashes of the 31 0x400 byte pieces of each cluster's data.
+	for (u32 c = 0; c < num_clusters; ++c)
 	{
-		u64 clusterOff = m_VolumeOffset + m_dataOffset + (u64)clusterID * 0x8000;
-
-		// Read and decrypt the cluster metadata
-		u8 clusterMDCrypted[0x400];
-		u8 clusterMD[0x400];
-		u8 IV[16] = { 0 };
-		if (!m_pReader->Read(clusterOff, 0x400, clusterMDCrypted))
-		{
-			WARN_LOG(DISCIO, "Integrity Check: fail at cluster %d: could not read metadata", clusterID);
-			return false;
-		}
-		mbedtls_aes_crypt_cbc(m_AES_ctx.get(), MBEDTLS_AES_DECRYPT, 0x400, IV, clusterMDCrypted,
-			clusterMD);
+		const u8* cluster = encrypted + c * s_block_total_size;
+		u8* clusterMD = &hash_blocks[c * s_block_header_size];
+		const u8 IV[16] = { 0 };
+		m_decryptor->DecryptCBC(IV, cluster, clusterMD, s_block_header_size);
 
 		// Some clusters have invalid data and metadata because they aren't
 		// meant to be read by the game (for example, holes between files). To
@@ -347,37 +433,174 @@ bool CVolumeWiiCrypted::CheckIntegrity() const
 		// This may cause some false negatives though: some bad clusters may be
 		// skipped because they are *too* bad and are not even recognized as
 		// valid clusters. To be improved.
-		bool meaningless = false;
-		for (u32 idx = 0x26C; idx < 0x280; ++idx)
-			if (clusterMD[idx] != 0)
-				meaningless = true;
-
-		if (meaningless)
+		meaningful[c] = std::all_of(clusterMD + 0x26C, clusterMD + 0x280, [](u8 b) { return b == 0; });
+		all_meaningful &= meaningful[c];
+		if (!meaningful[c])
 			continue;
 
-		u8 clusterData[0x7C00];
-		if (!Read((u64)clusterID * 0x7C00, 0x7C00, clusterData, true))
+		DecryptCluster(cluster, cluster_data.data());
+		for (u32 hashID = 0; hashID < 31; ++hashID)
 		{
-			WARN_LOG(DISCIO, "Integrity Check: fail at cluster %d: could not read data", clusterID);
-			return false;
+			const Common::SHA1::Digest hash =
+				Common::SHA1::CalculateDigest(&cluster_data[hashID * 0x400], 0x400);
+
+			// Note that we do not use strncmp here
+			if (memcmp(hash.data(), clusterMD + hashID * 20, 20))
+			{
+				WARN_LOG(DISCIO, "Integrity Check: fail at cluster %d: hash %d is invalid",
+					first_cluster + c, hashID);
+				return false;
+			}
 		}
+	}
 
-		for (u32 hashID = 0; hashID < 31; ++hashID)
+	// H1: every cluster of a subgroup of 8 holds the hashes of the H0 tables of the subgroup.
+	for (u32 first = 0; first < num_clusters; first += CLUSTERS_PER_SUBGROUP)
+	{
+		const u32 count = std::min(CLUSTERS_PER_SUBGROUP, num_clusters - first);
+		if (!std::all_of(meaningful + first, meaningful + first + count, [](bool b) { return b; }))
+			continue;
+
+		for (u32 j = 0; j < count; ++j)
 		{
-			u8 hash[20];
+			const Common::SHA1::Digest hash =
+				Common::SHA1::CalculateDigest(&hash_blocks[(first + j) * s_block_header_size], 0x26C);
+			for (u32 c = first; c < first + count; ++c)
+			{
+				if (memcmp(hash.data(), &hash_blocks[c * s_block_header_size + 0x280 + j * 20], 20))
+				{
+					WARN_LOG(DISCIO, "Integrity Check: fail at cluster %d: H1 hash %d is invalid",
+						first_cluster + c, j);
+					return false;
+				}
+			}
+		}
+	}
 
-			mbedtls_sha1(clusterData + hashID * 0x400, 0x400, hash);
+	if (!all_meaningful)
+		return true;
 
-			// Note that we do not use strncmp here
-			if (memcmp(hash, clusterMD + hashID * 20, 20))
+	// H2: every cluster of the group holds the hashes of the H1 tables of the subgroups.
+	for (u32 s = 0; s * CLUSTERS_PER_SUBGROUP < num_clusters; ++s)
+	{
+		const Common::SHA1::Digest hash = Common::SHA1::CalculateDigest(
+			&hash_blocks[s * CLUSTERS_PER_SUBGROUP * s_block_header_size + 0x280], 0xA0);
+		for (u32 c = 0; c < num_clusters; ++c)
+		{
+			if (memcmp(hash.data(), &hash_blocks[c * s_block_header_size + 0x340 + s * 20], 20))
 			{
-				WARN_LOG(DISCIO, "Integrity Check: fail at cluster %d: hash %d is invalid", clusterID,
-					hashID);
+				WARN_LOG(DISCIO, "Integrity Check: fail at cluster %d: H2 hash %d is invalid",
+					first_cluster + c, s);
 				return false;
 			}
 		}
 	}
 
+	// H3: the partition's H3 table holds the hash of the group's H2 table.
+	const Common::SHA1::Digest hash = Common::SHA1::CalculateDigest(&hash_blocks[0x340], 0xA0);
+	if (memcmp(hash.data(), h3_hash, 20))
+	{
+		WARN_LOG(DISCIO, "Integrity Check: fail at group %d: H3 hash is invalid", group);
+		return false;
+	}
+
+	return true;
+}
+
+bool CVolumeWiiCrypted::CheckIntegrity() const
+{
+	// Get partition data size
+	u32 partSizeDiv4;
+	Read(m_VolumeOffset + 0x2BC, 4, (u8*)&partSizeDiv4, false);
+	u64 partDataSize = (u64)Common::swap32(partSizeDiv4) * 4;
+
+	u32 nClusters = (u32)(partDataSize / 0x8000);
+	u32 nGroups = (nClusters + CLUSTERS_PER_GROUP - 1) / CLUSTERS_PER_GROUP;
+
+	// The H3 table has to match the hash in the TMD, which is signed.
+	u32 h3OffsetDiv4;
+	std::vector<u8> h3Table(H3_TABLE_SIZE);
+	if (!Read(m_VolumeOffset + 0x2B4, 4, (u8*)&h3OffsetDiv4, false) ||
+		!m_pReader->Read(m_VolumeOffset + (u64)Common::swap32(h3OffsetDiv4) * 4, H3_TABLE_SIZE,
+			h3Table.data()))
+	{
+		WARN_LOG(DISCIO, "Integrity Check: could not read the H3 table");
+		return false;
+	}
+	if ((u64)nGroups * 20 > H3_TABLE_SIZE)
+	{
+		WARN_LOG(DISCIO, "Integrity Check: the partition is too large");
+		return false;
+	}
+	const std::vector<u8> tmd = GetTMD();
+	const Common::SHA1::Digest h3Hash = Common::SHA1::CalculateDigest(h3Table.data(), h3Table.size());
+	if (tmd.size() < 0x1F4 + 20 || memcmp(h3Hash.data(), &tmd[0x1F4], 20))
+	{
+		WARN_LOG(DISCIO, "Integrity Check: the H3 table does not match the TMD");
+		return false;
+	}
+
+	// Groups are read a batch at a time. The groups of a batch are checked in parallel while
+	// the next batch is read.
+	const u64 group_size = (u64)CLUSTERS_PER_GROUP * s_block_total_size;
+	std::vector<u8> buffers[2];
+	buffers[0].resize(INTEGRITY_BATCH_GROUPS * group_size);
+	buffers[1].resize(INTEGRITY_BATCH_GROUPS * group_size);
+	auto read_batch = [&](u32 first_group, std::vector<u8>& buffer) {
+		const u32 first_cluster = first_group * CLUSTERS_PER_GROUP;
+		const u32 clusters = std::min(INTEGRITY_BATCH_GROUPS * CLUSTERS_PER_GROUP,
+			nClusters - first_cluster);
+		return m_pReader->Read(GetClusterOffset(first_cluster), (u64)clusters * s_block_total_size,
+			buffer.data());
+	};
+
+	if (nGroups && !read_batch(0, buffers[0]))
+	{
+		WARN_LOG(DISCIO, "Integrity Check: fail at cluster 0: could not read data");
+		return false;
+	}
+
+	Common::ParallelLoop check_loop;
+	std::atomic<bool> failed(false);
+	for (u32 first_group = 0; first_group < nGroups; first_group += INTEGRITY_BATCH_GROUPS)
+	{
+		const u32 batch = (first_group / INTEGRITY_BATCH_GROUPS) % 2;
+		const u32 groups = std::min(INTEGRITY_BATCH_GROUPS, nGroups - first_group);
+		const u32 next_group = first_group + groups;
+		bool next_read = true;
+
+		// Task 0 reads the next batch, the others check one group each.
+		check_loop.Loop([&](int lower, int upper) {
+			for (int task = lower; task < upper && !failed.load(); task++)
+			{
+				if (task == 0)
+				{
+					if (next_group < nGroups)
+						next_read = read_batch(next_group, buffers[batch ^ 1]);
+					continue;
+				}
+
+				const u32 group = first_group + task - 1;
+				const u32 first_cluster = group * CLUSTERS_PER_GROUP;
+				const u32 clusters = std::min(CLUSTERS_PER_GROUP, nClusters - first_cluster);
+				if (!CheckGroupIntegrity(group, &buffers[batch][(task - 1) * group_size], clusters,
+					&h3Table[group * 20]))
+				{
+					failed.store(true);
+				}
+			}
+		}, 0, (int)groups + 1, 1);
+
+		if (failed.load())
+			return false;
+		if (!next_read)
+		{
+			WARN_LOG(DISCIO, "Integrity Check: fail at cluster %d: could not read data",
+				next_group * CLUSTERS_PER_GROUP);
+			return false;
+		}
+	}
+
 	return true;
 }
 
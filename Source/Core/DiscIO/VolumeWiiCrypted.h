@@ -4,13 +4,15 @@
 
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <map>
-#include <mbedtls/aes.h>
 #include <memory>
 #include <string>
 #include <vector>
 
 #include "Common/CommonTypes.h"
+#include "Common/Crypto/AES.h"
 #include "DiscIO/Volume.h"
 
 // --- this volume type is used for encrypted Wii images ---
@@ -29,6 +31,7 @@ public:
 		const unsigned char* _pVolumeKey);
 	~CVolumeWiiCrypted();
 	bool Read(u64 _Offset, u64 _Length, u8* _pBuffer, bool decrypt) const override;
+	const u8* GetMappedData(u64 offset, u64 length, bool decrypt) const override;
 	bool GetTitleID(u64* buffer) const override;
 	std::vector<u8> GetTMD() const override;
 	std::string GetGameID() const override;
@@ -56,14 +59,44 @@ private:
 	static const unsigned int s_block_data_size = 0x7C00;
 	static const unsigned int s_block_total_size = s_block_header_size + s_block_data_size;
 
+	// Decrypted clusters kept around, about 1 MiB.
+	static const size_t CLUSTER_CACHE_SIZE = 32;
+	// Reads that miss this many clusters in a row decrypt them on several threads.
+	static const u64 PARALLEL_DECRYPT_CLUSTERS = 4;
+	// Upper bound of the clusters read and decrypted at once.
+	static const u64 MAX_DECRYPT_BATCH_CLUSTERS = 64;
+
+	struct CachedCluster
+	{
+		// Offset of the encrypted cluster in the image, which also identifies the partition.
+		u64 offset = UINT64_MAX;
+		u64 last_use = 0;
+		std::array<u8, s_block_data_size> data;
+	};
+
+	u64 GetClusterOffset(u64 block) const
+	{
+		return m_VolumeOffset + m_dataOffset + block * s_block_total_size;
+	}
+	const CachedCluster* FindCachedCluster(u64 block) const;
+	// Replaces the least recently used cluster.
+	CachedCluster* GetEmptyCachedCluster(u64 block) const;
+	void DecryptCluster(const u8* encrypted, u8* out) const;
+	// Reads and decrypts up to count uncached clusters starting at block, copying the requested
+	// part to out_ptr. Returns the number of bytes copied, 0 on failure.
+	u64 ReadClusters(u64 block, u64 count, u64 offset_in_block, u64 length, u8* out_ptr) const;
+	// Checks the H0 to H3 hashes of the encrypted clusters of a group. Can run on any thread.
+	bool CheckGroupIntegrity(u32 group, const u8* encrypted, u32 num_clusters,
+		const u8* h3_hash) const;
+
 	std::unique_ptr<IBlobReader> m_pReader;
-	std::unique_ptr<mbedtls_aes_context> m_AES_ctx;
+	std::unique_ptr<Common::AES::CBCDecryptor> m_decryptor;
 
 	u64 m_VolumeOffset;
 	u64 m_dataOffset;
 
-	mutable u64 m_LastDecryptedBlockOffset;
-	mutable unsigned char m_LastDecryptedBlock[s_block_data_size];
+	mutable std::vector<CachedCluster> m_cluster_cache;
+	mutable u64 m_cluster_use_counter = 0;
 };
 
 }  // namespace
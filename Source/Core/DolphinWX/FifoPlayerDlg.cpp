@@ -455,7 +455,8 @@ void FifoPlayerDlg::OnBeginSearch(wxCommandEvent& event)
 	int const frame_idx = m_framesList->GetSelection();
 	FifoPlayer& player = FifoPlayer::GetInstance();
 	const AnalyzedFrameInfo& frame = player.GetAnalyzedFrameInfo(frame_idx);
-	const FifoFrameInfo& fifo_frame = player.GetFile()->GetFrame(frame_idx);
+	const auto fifo_frame_data = player.GetFile()->GetFrame(frame_idx);
+	const FifoFrameInfo& fifo_frame = *fifo_frame_data;
 
 	// TODO: Support searching through the last object... How do we know were the cmd data ends?
 	// TODO: Support searching for bit patterns
@@ -619,7 +620,8 @@ void FifoPlayerDlg::OnObjectListSelectionChanged(wxCommandEvent& event)
 	if (frame_idx != -1 && object_idx != -1)
 	{
 		const AnalyzedFrameInfo& frame = player.GetAnalyzedFrameInfo(frame_idx);
-		const FifoFrameInfo& fifo_frame = player.GetFile()->GetFrame(frame_idx);
+		const auto fifo_frame_data = player.GetFile()->GetFrame(frame_idx);
+	const FifoFrameInfo& fifo_frame = *fifo_frame_data;
 		const u8* objectdata_start = &fifo_frame.fifoData[frame.objectStarts[object_idx]];
 		const u8* objectdata_end = &fifo_frame.fifoData[frame.objectEnds[object_idx]];
 		u8* objectdata = (u8*)objectdata_start;
@@ -753,7 +755,8 @@ void FifoPlayerDlg::OnObjectCmdListSelectionChanged(wxCommandEvent& event)
 
 	FifoPlayer& player = FifoPlayer::GetInstance();
 	const AnalyzedFrameInfo& frame = player.GetAnalyzedFrameInfo(frame_idx);
-	const FifoFrameInfo& fifo_frame = player.GetFile()->GetFrame(frame_idx);
+	const auto fifo_frame_data = player.GetFile()->GetFrame(frame_idx);
+	const FifoFrameInfo& fifo_frame = *fifo_frame_data;
 	const u8* cmddata =
 		&fifo_frame.fifoData[frame.objectStarts[object_idx]] + m_objectCmdOffsets[event.GetInt()];
 
@@ -905,7 +908,7 @@ wxString FifoPlayerDlg::CreateRecordingFifoSizeLabel() const
 	{
 		size_t fifoBytes = 0;
 		for (size_t i = 0; i < file->GetFrameCount(); ++i)
-			fifoBytes += file->GetFrame(i).fifoData.size();
+			fifoBytes += file->GetFrame(i)->fifoData.size();
 
 		return wxString::Format(_("%zu FIFO bytes"), fifoBytes);
 	}
@@ -922,8 +925,8 @@ wxString FifoPlayerDlg::CreateRecordingMemSizeLabel() const
 		size_t memBytes = 0;
 		for (size_t frameNum = 0; frameNum < file->GetFrameCount(); ++frameNum)
 		{
-			const std::vector<MemoryUpdate>& memUpdates = file->GetFrame(frameNum).memoryUpdates;
-			for (const auto& memUpdate : memUpdates)
+			const auto frame = file->GetFrame(frameNum);
+			for (const auto& memUpdate : frame->memoryUpdates)
 				memBytes += memUpdate.data.size();
 		}
 
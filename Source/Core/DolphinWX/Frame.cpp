@@ -38,6 +38,7 @@
 #include "Common/Flag.h"
 #include "Common/Logging/ConsoleListener.h"
 #include "Common/Thread.h"
+#include "Common/Trace.h"
 
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
@@ -62,6 +63,7 @@
 
 #include "InputCommon/GCPadStatus.h"
 
+#include "VideoCommon/FrameTelemetry.h"
 #include "VideoCommon/OnScreenDisplay.h"
 #include "VideoCommon/PostProcessing.h"
 #include "VideoCommon/RenderBase.h"
@@ -1447,6 +1449,19 @@ void CFrame::ParseHotkeys()
 		g_Config.bHiresMaterialMaps = !g_Config.bHiresMaterialMaps;
 	}
 
+	if (IsHotkey(HK_EXPORT_FRAME_TELEMETRY))
+	{
+		FrameTelemetry::RequestExport();
+	}
+
+	if (IsHotkey(HK_EXPORT_TRACE))
+	{
+		if (!Trace::IsCompiledIn())
+			Core::DisplayMessage("Tracing is not enabled in this build", 3000);
+		else if (Trace::Export())
+			Core::DisplayMessage("Trace saved to " + File::GetUserPath(D_LOGS_IDX) + "trace.json", 3000);
+	}
+
 	static float debugSpeed = 1.0f;
 	if (IsHotkey(HK_FREELOOK_DECREASE_SPEED, true))
 		debugSpeed /= 1.1f;
@@ -1494,6 +1509,8 @@ void CFrame::ParseHotkeys()
 		State::UndoLoadState();
 	if (IsHotkey(HK_UNDO_SAVE_STATE))
 		State::UndoSaveState();
+	if (IsHotkey(HK_REWIND))
+		State::Rewind();
 }
 
 void CFrame::HandleFrameSkipHotkeys()
@@ -144,6 +144,7 @@ void CFrame::BindMenuBarEvents()
 	Bind(wxEVT_MENU, &CFrame::OnRecordReadOnly, this, IDM_RECORD_READ_ONLY);
 	Bind(wxEVT_MENU, &CFrame::OnTASInput, this, IDM_TAS_INPUT);
 	Bind(wxEVT_MENU, &CFrame::OnTogglePauseMovie, this, IDM_TOGGLE_PAUSE_MOVIE);
+	Bind(wxEVT_MENU, &CFrame::OnToggleMovieTurbo, this, IDM_TOGGLE_MOVIE_TURBO);
 	Bind(wxEVT_MENU, &CFrame::OnShowLag, this, IDM_SHOW_LAG);
 	Bind(wxEVT_MENU, &CFrame::OnShowFrameCount, this, IDM_SHOW_FRAME_COUNT);
 	Bind(wxEVT_MENU, &CFrame::OnShowInputDisplay, this, IDM_SHOW_INPUT_DISPLAY);
@@ -392,6 +393,12 @@ void CFrame::OnTogglePauseMovie(wxCommandEvent& WXUNUSED(event))
 	SConfig::GetInstance().SaveSettings();
 }
 
+void CFrame::OnToggleMovieTurbo(wxCommandEvent& WXUNUSED(event))
+{
+	SConfig::GetInstance().m_MovieTurbo = !SConfig::GetInstance().m_MovieTurbo;
+	SConfig::GetInstance().SaveSettings();
+}
+
 void CFrame::OnToggleDumpFrames(wxCommandEvent& WXUNUSED(event))
 {
 	SConfig::GetInstance().m_DumpFrames = !SConfig::GetInstance().m_DumpFrames;
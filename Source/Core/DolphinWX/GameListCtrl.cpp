@@ -8,8 +8,11 @@
 #include <cstddef>
 #include <cstdio>
 #include <cstring>
+#include <iterator>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -44,6 +47,8 @@
 #include "Common/MathUtil.h"
 #include "Common/StringUtil.h"
 #include "Common/SysConf.h"
+#include "Common/Thread.h"
+#include "Common/ThreadPool.h"
 #include "Core/Boot/Boot.h"
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
@@ -156,6 +161,10 @@ static int CompareGameListItems(const GameListItem* iso1, const GameListItem* is
 }
 
 wxDEFINE_EVENT(DOLPHIN_EVT_RELOAD_GAMELIST, wxCommandEvent);
+wxDEFINE_EVENT(DOLPHIN_EVT_GAMELIST_SCAN_RESULTS, wxThreadEvent);
+
+// Games constructed in parallel before the list is updated
+static const size_t SCAN_BATCH_SIZE = 32;
 
 CGameListCtrl::CGameListCtrl(wxWindow* parent, const wxWindowID id, const wxPoint& pos,
 	const wxSize& size, long style)
@@ -183,12 +192,14 @@ CGameListCtrl::CGameListCtrl(wxWindow* parent, const wxWindowID id, const wxPoin
 	Bind(wxEVT_MENU, &CGameListCtrl::OnNetPlayHost, this, IDM_START_NETPLAY);
 
 	Bind(DOLPHIN_EVT_RELOAD_GAMELIST, &CGameListCtrl::OnReloadGameList, this);
+	Bind(DOLPHIN_EVT_GAMELIST_SCAN_RESULTS, &CGameListCtrl::OnScanResults, this);
 
 	wxTheApp->Bind(DOLPHIN_EVT_LOCAL_INI_CHANGED, &CGameListCtrl::OnLocalIniModified, this);
 }
 
 CGameListCtrl::~CGameListCtrl()
 {
+	StopScan();
 }
 
 template <typename T>
@@ -289,17 +300,23 @@ void CGameListCtrl::BrowseForDirectory()
 
 void CGameListCtrl::ReloadList()
 {
-	int scrollPos = wxWindow::GetScrollPos(wxVERTICAL);
 	// Don't let the user refresh it while a game is running
 	if (Core::GetState() != Core::CORE_UNINITIALIZED)
 		return;
 
-	ScanForISOs();
+	StartScan();
+	RebuildList();
+}
+
+void CGameListCtrl::RebuildList()
+{
+	int scrollPos = wxWindow::GetScrollPos(wxVERTICAL);
 
 	Freeze();
 	ClearAll();
 
-	if (m_ISOFiles.size() != 0)
+	// The columns go up while scanning so that the games can be added as they are found
+	if (!m_ISOFiles.empty() || m_scanning)
 	{
 		// Don't load bitmaps unless there are games to list
 		InitBitmaps();
@@ -344,6 +361,8 @@ void CGameListCtrl::ReloadList()
 			SConfig::GetInstance().m_showRegionColumn ? FromDIP(32 + platform_padding) : 0);
 		SetColumnWidth(COLUMN_EMULATION_STATE,
 			SConfig::GetInstance().m_showStateColumn ? FromDIP(48 + platform_padding) : 0);
+		SetColumnWidth(COLUMN_SIZE,
+			SConfig::GetInstance().m_showSizeColumn ? FromDIP(75 + platform_padding) : 0);
 
 		// add all items
 		for (int i = 0; i < (int)m_ISOFiles.size(); i++)
@@ -353,19 +372,10 @@ void CGameListCtrl::ReloadList()
 				SetItemTextColour(i, wxColour(0xFF0000));
 		}
 
-		// Sort items by Title
-		if (!sorted)
-			last_column = 0;
-		sorted = false;
-		wxListEvent event;
-		event.m_col = SConfig::GetInstance().m_ListSort2;
-		OnColumnClick(event);
+		SortList();
 
-		event.m_col = SConfig::GetInstance().m_ListSort;
-		OnColumnClick(event);
-		sorted = true;
-
-		SetColumnWidth(COLUMN_SIZE, SConfig::GetInstance().m_showSizeColumn ? wxLIST_AUTOSIZE : 0);
+		if (!m_ISOFiles.empty())
+			SetColumnWidth(COLUMN_SIZE, SConfig::GetInstance().m_showSizeColumn ? wxLIST_AUTOSIZE : 0);
 	}
 	else
 	{
@@ -405,6 +415,21 @@ void CGameListCtrl::ReloadList()
 	SetFocus();
 }
 
+void CGameListCtrl::SortList()
+{
+	// Sort items by the last two columns that were clicked
+	if (!sorted)
+		last_column = 0;
+	sorted = false;
+	wxListEvent event;
+	event.m_col = SConfig::GetInstance().m_ListSort2;
+	OnColumnClick(event);
+
+	event.m_col = SConfig::GetInstance().m_ListSort;
+	OnColumnClick(event);
+	sorted = true;
+}
+
 static wxString NiceSizeFormat(u64 size)
 {
 	// Return a pretty filesize string from byte count.
@@ -511,9 +536,6 @@ void CGameListCtrl::InsertItemInReportView(long index)
 		if (GetColumnWidth(i) != 0)
 			UpdateItemAtColumn(item_index, i);
 	}
-
-	// Background color
-	SetBackgroundColor();
 }
 
 static wxColour blend50(const wxColour& c1, const wxColour& c2)
@@ -537,13 +559,102 @@ void CGameListCtrl::SetBackgroundColor()
 	}
 }
 
-void CGameListCtrl::ScanForISOs()
+static bool ShouldListGame(const GameListItem& item)
 {
+	bool list = true;
+
+	switch (item.GetPlatform())
+	{
+	case DiscIO::Platform::WII_DISC:
+		if (!SConfig::GetInstance().m_ListWii)
+			list = false;
+		break;
+	case DiscIO::Platform::WII_WAD:
+		if (!SConfig::GetInstance().m_ListWad)
+			list = false;
+		break;
+	case DiscIO::Platform::ELF_DOL:
+		if (!SConfig::GetInstance().m_ListElfDol)
+			list = false;
+		break;
+	default:
+		if (!SConfig::GetInstance().m_ListGC)
+			list = false;
+		break;
+	}
+
+	switch (item.GetCountry())
+	{
+	case DiscIO::Country::COUNTRY_AUSTRALIA:
+		if (!SConfig::GetInstance().m_ListAustralia)
+			list = false;
+		break;
+	case DiscIO::Country::COUNTRY_EUROPE:
+		if (!SConfig::GetInstance().m_ListPal)
+			list = false;
+		break;
+	case DiscIO::Country::COUNTRY_FRANCE:
+		if (!SConfig::GetInstance().m_ListFrance)
+			list = false;
+		break;
+	case DiscIO::Country::COUNTRY_GERMANY:
+		if (!SConfig::GetInstance().m_ListGermany)
+			list = false;
+		break;
+	case DiscIO::Country::COUNTRY_ITALY:
+		if (!SConfig::GetInstance().m_ListItaly)
+			list = false;
+		break;
+	case DiscIO::Country::COUNTRY_JAPAN:
+		if (!SConfig::GetInstance().m_ListJap)
+			list = false;
+		break;
+	case DiscIO::Country::COUNTRY_KOREA:
+		if (!SConfig::GetInstance().m_ListKorea)
+			list = false;
+		break;
+	case DiscIO::Country::COUNTRY_NETHERLANDS:
+		if (!SConfig::GetInstance().m_ListNetherlands)
+			list = false;
+		break;
+	case DiscIO::Country::COUNTRY_RUSSIA:
+		if (!SConfig::GetInstance().m_ListRussia)
+			list = false;
+		break;
+	case DiscIO::Country::COUNTRY_SPAIN:
+		if (!SConfig::GetInstance().m_ListSpain)
+			list = false;
+		break;
+	case DiscIO::Country::COUNTRY_TAIWAN:
+		if (!SConfig::GetInstance().m_ListTaiwan)
+			list = false;
+		break;
+	case DiscIO::Country::COUNTRY_USA:
+		if (!SConfig::GetInstance().m_ListUsa)
+			list = false;
+		break;
+	case DiscIO::Country::COUNTRY_WORLD:
+		if (!SConfig::GetInstance().m_ListWorld)
+			list = false;
+		break;
+	case DiscIO::Country::COUNTRY_UNKNOWN:
+	default:
+		if (!SConfig::GetInstance().m_ListUnknown)
+			list = false;
+		break;
+	}
+
+	return list;
+}
+
+void CGameListCtrl::StartScan()
+{
+	StopScan();
 	m_ISOFiles.clear();
 
 	// Load custom game titles from titles.txt
 	// http://www.gametdb.com/Wii/Downloads
-	std::unordered_map<std::string, std::string> custom_title_map;
+	std::unordered_map<std::string, std::string> custom_titles;
 	std::ifstream titlestxt;
 	OpenFStream(titlestxt, File::GetUserPath(D_LOAD_IDX) + "titles.txt", std::ios::in);
 
@@ -557,7 +668,7 @@ void CGameListCtrl::ScanForISOs()
 		{
 			const size_t equals_index = line.find('=');
 			if (equals_index != std::string::npos)
-				custom_title_map.emplace(StripSpaces(line.substr(0, equals_index)),
+				custom_titles.emplace(StripSpaces(line.substr(0, equals_index)),
 					StripSpaces(line.substr(equals_index + 1)));
 		}
 		titlestxt.close();
@@ -582,134 +693,146 @@ void CGameListCtrl::ScanForISOs()
 		Extensions.push_back(".elf");
 	}
 
-	auto rFilenames = DoFileSearch(Extensions, SConfig::GetInstance().m_ISOFolder,
+	auto paths = DoFileSearch(Extensions, SConfig::GetInstance().m_ISOFolder,
 		SConfig::GetInstance().m_RecursiveISOFolder);
 
-	if (rFilenames.size() > 0)
-	{
-		wxProgressDialog dialog(
-			_("Scanning for ISOs"), _("Scanning..."), (int)rFilenames.size() - 1, this,
-			wxPD_APP_MODAL | wxPD_AUTO_HIDE | wxPD_CAN_ABORT | wxPD_ELAPSED_TIME | wxPD_ESTIMATED_TIME |
-			wxPD_REMAINING_TIME | wxPD_SMOOTH  // - makes updates as small as possible (down to 1px)
-		);
+	m_scanning = true;
+	m_scan_cancelled = false;
+	m_scan_thread = std::thread(&CGameListCtrl::ScanThread, this, ++m_scan_generation,
+		std::move(paths), std::move(custom_titles));
+}
 
-		for (u32 i = 0; i < rFilenames.size(); i++)
+void CGameListCtrl::StopScan()
+{
+	if (!m_scan_thread.joinable())
+		return;
+
+	m_scan_cancelled = true;
+	m_scan_thread.join();
+	m_scanning = false;
+
+	std::lock_guard<std::mutex> lk(m_scan_results_lock);
+	m_scan_results.clear();
+}
+
+void CGameListCtrl::ScanThread(int generation, std::vector<std::string> paths,
+	std::unordered_map<std::string, std::string> custom_titles)
+{
+	Common::SetCurrentThreadName("Game list scanner");
+
+	GameListCache cache;
+	cache.Load();
+
+	// Cached games don't need their images opened, so they go first and fill the list quickly
+	std::stable_partition(paths.begin(), paths.end(),
+		[&cache](const std::string& path) { return cache.Find(path) != nullptr; });
+
+	Common::ParallelLoop loop;
+	for (size_t first = 0; first < paths.size() && !m_scan_cancelled; first += SCAN_BATCH_SIZE)
+	{
+		const size_t count = std::min(SCAN_BATCH_SIZE, paths.size() - first);
+		std::vector<std::unique_ptr<GameListItem>> items(count);
+		loop.Loop([&](int lower, int upper) {
+			for (int i = lower; i < upper; i++)
+				items[i] = std::make_unique<GameListItem>(paths[first + i], custom_titles, cache);
+		}, 0, static_cast<int>(count), 1);
+
+		for (auto& item : items)
 		{
-			std::string FileName;
-			SplitPath(rFilenames[i], nullptr, &FileName, nullptr);
+			if (item->IsValid() && item->IsCacheOutdated())
+				cache.Add(item->GetFileName(), item->GetCacheData());
+		}
 
-			// Update with the progress (i) and the message
-			dialog.Update(i, wxString::Format(_("Scanning %s"), StrToWxStr(FileName)));
-			if (dialog.WasCancelled())
-				break;
+		items.erase(std::remove_if(items.begin(), items.end(),
+			[](const std::unique_ptr<GameListItem>& item) {
+			return !item->IsValid() || !ShouldListGame(*item);
+		}),
+			items.end());
+		PostScanResults(generation, std::move(items), false);
+	}
 
-			auto iso_file = std::make_unique<GameListItem>(rFilenames[i], custom_title_map);
+	std::vector<std::unique_ptr<GameListItem>> drive_items;
+	if (!m_scan_cancelled)
+	{
+		// Entries of files that have been removed or renamed would never be used again
+		cache.Prune(paths);
 
-			if (iso_file->IsValid())
+		if (SConfig::GetInstance().m_ListDrives)
+		{
+			for (const auto& drive : cdio_get_devices())
 			{
-				bool list = true;
-
-				switch (iso_file->GetPlatform())
-				{
-				case DiscIO::Platform::WII_DISC:
-					if (!SConfig::GetInstance().m_ListWii)
-						list = false;
-					break;
-				case DiscIO::Platform::WII_WAD:
-					if (!SConfig::GetInstance().m_ListWad)
-						list = false;
-					break;
-				case DiscIO::Platform::ELF_DOL:
-					if (!SConfig::GetInstance().m_ListElfDol)
-						list = false;
-					break;
-				default:
-					if (!SConfig::GetInstance().m_ListGC)
-						list = false;
-					break;
-				}
-
-				switch (iso_file->GetCountry())
-				{
-				case DiscIO::Country::COUNTRY_AUSTRALIA:
-					if (!SConfig::GetInstance().m_ListAustralia)
-						list = false;
-					break;
-				case DiscIO::Country::COUNTRY_EUROPE:
-					if (!SConfig::GetInstance().m_ListPal)
-						list = false;
-					break;
-				case DiscIO::Country::COUNTRY_FRANCE:
-					if (!SConfig::GetInstance().m_ListFrance)
-						list = false;
-					break;
-				case DiscIO::Country::COUNTRY_GERMANY:
-					if (!SConfig::GetInstance().m_ListGermany)
-						list = false;
-					break;
-				case DiscIO::Country::COUNTRY_ITALY:
-					if (!SConfig::GetInstance().m_ListItaly)
-						list = false;
-					break;
-				case DiscIO::Country::COUNTRY_JAPAN:
-					if (!SConfig::GetInstance().m_ListJap)
-						list = false;
-					break;
-				case DiscIO::Country::COUNTRY_KOREA:
-					if (!SConfig::GetInstance().m_ListKorea)
-						list = false;
-					break;
-				case DiscIO::Country::COUNTRY_NETHERLANDS:
-					if (!SConfig::GetInstance().m_ListNetherlands)
-						list = false;
-					break;
-				case DiscIO::Country::COUNTRY_RUSSIA:
-					if (!SConfig::GetInstance().m_ListRussia)
-						list = false;
-					break;
-				case DiscIO::Country::COUNTRY_SPAIN:
-					if (!SConfig::GetInstance().m_ListSpain)
-						list = false;
-					break;
-				case DiscIO::Country::COUNTRY_TAIWAN:
-					if (!SConfig::GetInstance().m_ListTaiwan)
-						list = false;
-					break;
-				case DiscIO::Country::COUNTRY_USA:
-					if (!SConfig::GetInstance().m_ListUsa)
-						list = false;
-					break;
-				case DiscIO::Country::COUNTRY_WORLD:
-					if (!SConfig::GetInstance().m_ListWorld)
-						list = false;
-					break;
-				case DiscIO::Country::COUNTRY_UNKNOWN:
-				default:
-					if (!SConfig::GetInstance().m_ListUnknown)
-						list = false;
-					break;
-				}
-
-				if (list)
-					m_ISOFiles.push_back(std::move(iso_file));
+				auto gli = std::make_unique<GameListItem>(drive, custom_titles, cache);
+
+				if (gli->IsValid())
+					drive_items.push_back(std::move(gli));
 			}
 		}
 	}
 
-	if (SConfig::GetInstance().m_ListDrives)
+	if (cache.IsDirty())
+		cache.Save();
+
+	PostScanResults(generation, std::move(drive_items), true);
+}
+
+void CGameListCtrl::PostScanResults(int generation,
+	std::vector<std::unique_ptr<GameListItem>> items, bool finished)
+{
 	{
-		const std::vector<std::string> drives = cdio_get_devices();
+		std::lock_guard<std::mutex> lk(m_scan_results_lock);
+		std::move(items.begin(), items.end(), std::back_inserter(m_scan_results));
+	}
 
-		for (const auto& drive : drives)
-		{
-			auto gli = std::make_unique<GameListItem>(drive, custom_title_map);
+	wxThreadEvent* event = new wxThreadEvent(DOLPHIN_EVT_GAMELIST_SCAN_RESULTS);
+	event->SetInt(generation);
+	event->SetExtraLong(finished);
+	QueueEvent(event);
+}
 
-			if (gli->IsValid())
-				m_ISOFiles.push_back(std::move(gli));
-		}
+void CGameListCtrl::OnScanResults(wxThreadEvent& event)
+{
+	// Events of a scan that was stopped can still be in the queue
+	if (event.GetInt() != m_scan_generation)
+		return;
+
+	std::vector<std::unique_ptr<GameListItem>> items;
+	{
+		std::lock_guard<std::mutex> lk(m_scan_results_lock);
+		items.swap(m_scan_results);
 	}
 
-	std::sort(m_ISOFiles.begin(), m_ISOFiles.end());
+	const bool finished = event.GetExtraLong() != 0;
+	if (finished)
+	{
+		m_scan_thread.join();
+		m_scanning = false;
+	}
+
+	if (m_ISOFiles.empty() && items.empty())
+	{
+		// Nothing was found, which gets a message instead of the columns
+		if (finished)
+			RebuildList();
+		return;
+	}
+
+	Freeze();
+	for (auto& item : items)
+	{
+		const long index = static_cast<long>(m_ISOFiles.size());
+		m_ISOFiles.push_back(std::move(item));
+		InsertItemInReportView(index);
+		if (SConfig::GetInstance().m_ColorCompressed && m_ISOFiles[index]->IsCompressed())
+			SetItemTextColour(index, wxColour(0xFF0000));
+	}
+
+	SortList();
+	if (finished)
+		SetColumnWidth(COLUMN_SIZE, SConfig::GetInstance().m_showSizeColumn ? wxLIST_AUTOSIZE : 0);
+	Thaw();
+
+	if (finished)
+		AutomaticColumnWidth();
 }
 
 void CGameListCtrl::OnReloadGameList(wxCommandEvent& WXUNUSED(event))
@@ -4,9 +4,13 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstddef>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 #include <wx/listctrl.h>
@@ -68,13 +72,23 @@ public:
 
 private:
 	void ReloadList();
+	void RebuildList();
+	void SortList();
 
 	void ClearIsoFiles() { m_ISOFiles.clear(); }
 	void InitBitmaps();
 	void UpdateItemAtColumn(long _Index, int column);
 	void InsertItemInReportView(long _Index);
 	void SetBackgroundColor();
-	void ScanForISOs();
+
+	// The games are loaded on a separate thread and added to the list in batches as they come in
+	void StartScan();
+	void StopScan();
+	void ScanThread(int generation, std::vector<std::string> paths,
+		std::unordered_map<std::string, std::string> custom_titles);
+	void PostScanResults(int generation, std::vector<std::unique_ptr<GameListItem>> items,
+		bool finished);
+	void OnScanResults(wxThreadEvent& event);
 
 	// events
 	void OnReloadGameList(wxCommandEvent& event);
@@ -113,6 +127,13 @@ private:
 	std::vector<int> m_utility_game_banners;
 	std::vector<std::unique_ptr<GameListItem>> m_ISOFiles;
 
+	std::thread m_scan_thread;
+	std::atomic<bool> m_scan_cancelled{false};
+	bool m_scanning = false;
+	int m_scan_generation = 0;
+	std::mutex m_scan_results_lock;
+	std::vector<std::unique_ptr<GameListItem>> m_scan_results;
+
 	int last_column;
 	int last_sort;
 	wxSize lastpos;
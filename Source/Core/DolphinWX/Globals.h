@@ -74,6 +74,7 @@ enum
 	IDM_RECORD_READ_ONLY,
 	IDM_TAS_INPUT,
 	IDM_TOGGLE_PAUSE_MOVIE,
+	IDM_TOGGLE_MOVIE_TURBO,
 	IDM_SHOW_LAG,
 	IDM_SHOW_FRAME_COUNT,
 	IDM_SHOW_INPUT_DISPLAY,
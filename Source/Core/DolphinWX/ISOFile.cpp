@@ -3,12 +3,12 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
-#include <cinttypes>
 #include <cstdio>
 #include <cstring>
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 #include <wx/app.h>
@@ -21,7 +21,6 @@
 #include "Common/CommonPaths.h"
 #include "Common/CommonTypes.h"
 #include "Common/FileUtil.h"
-#include "Common/Hash.h"
 #include "Common/IniFile.h"
 #include "Common/StringUtil.h"
 
@@ -36,7 +35,7 @@
 #include "DolphinWX/ISOFile.h"
 #include "DolphinWX/WxUtils.h"
 
-static const u32 CACHE_REVISION = 0x127;  // Last changed in PR 3309
+static const u32 CACHE_REVISION = 0x129;  // Last changed for the consolidated cache
 
 static std::string GetLanguageString(DiscIO::Language language,
 	std::map<DiscIO::Language, std::string> strings)
@@ -61,13 +60,110 @@ static std::string GetLanguageString(DiscIO::Language language,
 	return "";
 }
 
+static std::string GetCacheFilename()
+{
+	return File::GetUserPath(D_CACHE_IDX) + "gamelist.cache";
+}
+
+bool GameListCache::Load()
+{
+	return CChunkFileReader::Load<GameListCache>(GetCacheFilename(), CACHE_REVISION, *this);
+}
+
+bool GameListCache::Save()
+{
+	if (!File::IsDirectory(File::GetUserPath(D_CACHE_IDX)))
+		File::CreateDir(File::GetUserPath(D_CACHE_IDX));
+
+	if (!CChunkFileReader::Save<GameListCache>(GetCacheFilename(), CACHE_REVISION, *this))
+		return false;
+
+	m_dirty = false;
+	return true;
+}
+
+const std::vector<u8>* GameListCache::Find(const std::string& path) const
+{
+	auto it = m_entries.find(path);
+	if (it == m_entries.end())
+		return nullptr;
+
+	const Entry& entry = it->second;
+	if (entry.size != File::GetSize(path) ||
+		entry.modification_time != File::GetModificationTime(path))
+	{
+		return nullptr;
+	}
+
+	return &entry.data;
+}
+
+void GameListCache::Add(const std::string& path, std::vector<u8> data)
+{
+	Entry& entry = m_entries[path];
+	entry.size = File::GetSize(path);
+	entry.modification_time = File::GetModificationTime(path);
+	entry.data = std::move(data);
+	m_dirty = true;
+}
+
+void GameListCache::Prune(const std::vector<std::string>& paths)
+{
+	const std::unordered_set<std::string> present(paths.begin(), paths.end());
+	for (auto it = m_entries.begin(); it != m_entries.end();)
+	{
+		if (present.count(it->first))
+		{
+			++it;
+		}
+		else
+		{
+			it = m_entries.erase(it);
+			m_dirty = true;
+		}
+	}
+}
+
+void GameListCache::DoState(PointerWrap& p)
+{
+	u32 count = static_cast<u32>(m_entries.size());
+	p.Do(count);
+
+	if (p.GetMode() == PointerWrap::MODE_READ)
+	{
+		m_entries.clear();
+		m_entries.reserve(count);
+		for (u32 i = 0; i < count; i++)
+		{
+			std::string path;
+			Entry entry;
+			p.Do(path);
+			p.Do(entry.size);
+			p.Do(entry.modification_time);
+			p.Do(entry.data);
+			m_entries.emplace(std::move(path), std::move(entry));
+		}
+		return;
+	}
+
+	for (auto& it : m_entries)
+	{
+		std::string path = it.first;
+		p.Do(path);
+		p.Do(it.second.size);
+		p.Do(it.second.modification_time);
+		p.Do(it.second.data);
+	}
+}
+
 GameListItem::GameListItem(const std::string& _rFileName,
-	const std::unordered_map<std::string, std::string>& custom_titles)
+	const std::unordered_map<std::string, std::string>& custom_titles,
+	const GameListCache& cache)
 	: m_FileName(_rFileName), m_title_id(0), m_emu_state(0), m_FileSize(0),
 	m_Country(DiscIO::Country::COUNTRY_UNKNOWN), m_Revision(0), m_Valid(false), m_ImageWidth(0),
-	m_ImageHeight(0), m_disc_number(0), m_has_custom_name(false)
+	m_ImageHeight(0), m_disc_number(0), m_has_custom_name(false), m_cache_outdated(false)
 {
-	if (LoadFromCache())
+	if (LoadFromCache(cache))
 	{
 		m_Valid = true;
 
@@ -79,8 +175,7 @@ GameListItem::GameListItem(const std::string& _rFileName,
 			std::vector<u32> buffer =
 				DiscIO::IVolume::GetWiiBanner(&m_ImageWidth, &m_ImageHeight, m_title_id);
 			ReadVolumeBanner(buffer, m_ImageWidth, m_ImageHeight);
-			if (!m_pImage.empty())
-				SaveToCache();
+			m_cache_outdated = !m_pImage.empty();
 		}
 	}
 	else
@@ -113,7 +208,7 @@ GameListItem::GameListItem(const std::string& _rFileName,
 			ReadVolumeBanner(buffer, m_ImageWidth, m_ImageHeight);
 
 			m_Valid = true;
-			SaveToCache();
+			m_cache_outdated = true;
 		}
 	}
 
@@ -192,17 +287,28 @@ void GameListItem::ReloadINI()
 	}
 }
 
-bool GameListItem::LoadFromCache()
+bool GameListItem::LoadFromCache(const GameListCache& cache)
 {
-	return CChunkFileReader::Load<GameListItem>(CreateCacheFilename(), CACHE_REVISION, *this);
+	const std::vector<u8>* data = cache.Find(m_FileName);
+	if (!data)
+		return false;
+
+	u8* ptr = const_cast<u8*>(data->data());
+	PointerWrap p(&ptr, PointerWrap::MODE_READ);
+	DoState(p);
+	return true;
 }
 
-void GameListItem::SaveToCache()
+std::vector<u8> GameListItem::GetCacheData()
 {
-	if (!File::IsDirectory(File::GetUserPath(D_CACHE_IDX)))
-		File::CreateDir(File::GetUserPath(D_CACHE_IDX));
-
-	CChunkFileReader::Save<GameListItem>(CreateCacheFilename(), CACHE_REVISION, *this);
+	u8* ptr = nullptr;
+	PointerWrap p(&ptr, PointerWrap::MODE_MEASURE);
+	DoState(p);
+	std::vector<u8> data(reinterpret_cast<size_t>(ptr));
+	ptr = data.data();
+	p.SetMode(PointerWrap::MODE_WRITE);
+	DoState(p);
+	return data;
 }
 
 void GameListItem::DoState(PointerWrap& p)
@@ -234,26 +340,6 @@ bool GameListItem::IsElfOrDol() const
 	return name_end == ".elf" || name_end == ".dol";
 }
 
-std::string GameListItem::CreateCacheFilename() const
-{
-	std::string Filename, LegalPathname, extension;
-	SplitPath(m_FileName, &LegalPathname, &Filename, &extension);
-
-	if (Filename.empty())
-		return Filename;  // Disc Drive
-
-	// Filename.extension_HashOfFolderPath_Size.cache
-	// Append hash to prevent ISO name-clashing in different folders.
-	Filename.append(
-		StringFromFormat("%s_%x_%" PRIx64 ".cache", extension.c_str(),
-			HashFletcher((const u8*)LegalPathname.c_str(), LegalPathname.size()),
-			File::GetSize(m_FileName)));
-
-	std::string fullname(File::GetUserPath(D_CACHE_IDX));
-	fullname += Filename;
-	return fullname;
-}
-
 // Outputs to m_pImage
 void GameListItem::ReadVolumeBanner(const std::vector<u32>& buffer, int width, int height)
 {
@@ -387,5 +473,5 @@ const std::string GameListItem::GetWiiFSPath() const
 bool GameListItem::IsCompressed() const
 {
 	return m_blob_type == DiscIO::BlobType::GCZ || m_blob_type == DiscIO::BlobType::CISO ||
-		m_blob_type == DiscIO::BlobType::WBFS;
+		m_blob_type == DiscIO::BlobType::WBFS || m_blob_type == DiscIO::BlobType::CHUNKED;
 }
@@ -26,11 +26,41 @@ enum class Platform;
 
 class PointerWrap;
 
+// The cached data of every game in the list, kept in a single file. An entry is only used while
+// the size and modification time of its file are still the ones it was created with.
+class GameListCache
+{
+public:
+	bool Load();
+	bool Save();
+
+	// Safe to call from several threads at once as long as nothing is added meanwhile
+	const std::vector<u8>* Find(const std::string& path) const;
+	void Add(const std::string& path, std::vector<u8> data);
+	// Drops the entries of every file that isn't in paths
+	void Prune(const std::vector<std::string>& paths);
+	bool IsDirty() const { return m_dirty; }
+
+	void DoState(PointerWrap& p);
+
+private:
+	struct Entry
+	{
+		u64 size;
+		u64 modification_time;
+		std::vector<u8> data;
+	};
+
+	std::unordered_map<std::string, Entry> m_entries;
+	bool m_dirty = false;
+};
+
 class GameListItem
 {
 public:
 	GameListItem(const std::string& _rFileName,
-		const std::unordered_map<std::string, std::string>& custom_titles);
+		const std::unordered_map<std::string, std::string>& custom_titles,
+		const GameListCache& cache);
 	~GameListItem();
 
 	// Reload settings after INI changes
@@ -66,6 +96,10 @@ public:
 
 	void DoState(PointerWrap& p);
 
+	// True if the item was read from the volume, or has changed since it was cached
+	bool IsCacheOutdated() const { return m_cache_outdated; }
+	std::vector<u8> GetCacheData();
+
 private:
 	std::string m_FileName;
 
@@ -98,12 +132,11 @@ private:
 	std::string m_custom_name_titles_txt;  // Custom title from titles.txt
 	std::string m_custom_name;             // Custom title from INI or titles.txt
 	bool m_has_custom_name;
+	bool m_cache_outdated;
 
-	bool LoadFromCache();
-	void SaveToCache();
+	bool LoadFromCache(const GameListCache& cache);
 
 	bool IsElfOrDol() const;
-	std::string CreateCacheFilename() const;
 
 	// Outputs to m_pImage
 	void ReadVolumeBanner(const std::vector<u32>& buffer, int width, int height);
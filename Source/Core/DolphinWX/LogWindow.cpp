@@ -154,6 +154,7 @@ void CLogWindow::CreateGUIControls()
 CLogWindow::~CLogWindow()
 {
 	RemoveAllListeners();
+	m_LogManager->RegisterListener(LogListener::LOG_WINDOW_LISTENER, nullptr);
 }
 
 void CLogWindow::RemoveAllListeners()
@@ -146,6 +146,8 @@ wxMenu* MainMenuBar::CreateMovieMenu() const
 	movie_menu->AppendSeparator();
 	movie_menu->AppendCheckItem(IDM_TOGGLE_PAUSE_MOVIE, _("Pause at End of Movie"));
 	movie_menu->Check(IDM_TOGGLE_PAUSE_MOVIE, config_instance.m_PauseMovie);
+	movie_menu->AppendCheckItem(IDM_TOGGLE_MOVIE_TURBO, _("Turbo Playback"));
+	movie_menu->Check(IDM_TOGGLE_MOVIE_TURBO, config_instance.m_MovieTurbo);
 	movie_menu->AppendCheckItem(IDM_SHOW_LAG, _("Show Lag Counter"));
 	movie_menu->Check(IDM_SHOW_LAG, config_instance.m_ShowLag);
 	movie_menu->AppendCheckItem(IDM_SHOW_FRAME_COUNT, _("Show Frame Counter"));
@@ -2,8 +2,10 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <chrono>
 #include <cstddef>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <getopt.h>
 #include <signal.h>
@@ -13,25 +15,34 @@
 
 #include "Common/CommonTypes.h"
 #include "Common/Event.h"
+#include "Common/FileUtil.h"
 #include "Common/Flag.h"
 #include "Common/Logging/LogManager.h"
 #include "Common/MsgHandler.h"
+#include "Common/StringUtil.h"
+#include "Common/Timer.h"
 
 #include "Core/Analytics.h"
 #include "Core/BootManager.h"
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
+#include "Core/FifoPlayer/FifoPlayer.h"
 #include "Core/HW/Wiimote.h"
 #include "Core/Host.h"
 #include "Core/IPC_HLE/WII_IPC_HLE.h"
 #include "Core/IPC_HLE/WII_IPC_HLE_Device_stm.h"
 #include "Core/IPC_HLE/WII_IPC_HLE_Device_usb_bt_emu.h"
 #include "Core/IPC_HLE/WII_IPC_HLE_WiiMote.h"
+#include "Core/Movie.h"
+#include "Core/PowerPC/JitInterface.h"
 #include "Core/State.h"
 
 #include "UICommon/UICommon.h"
 
+#include "VideoCommon/FrameTelemetry.h"
+#include "VideoCommon/TexturePack.h"
 #include "VideoCommon/VideoBackendBase.h"
+#include "VideoCommon/VideoConfig.h"
 
 static bool rendererHasFocus = true;
 static bool rendererIsFullscreen = false;
@@ -39,6 +50,18 @@ static Common::Flag s_running{ true };
 static Common::Flag s_shutdown_requested{ false };
 static Common::Flag s_tried_graceful_shutdown{ false };
 
+// Benchmark mode: run this many frames unthrottled, or play a FIFO log this many times, then
+// write the report and exit
+static u64 s_benchmark_frames = 0;
+static u32 s_benchmark_fifo_loops = 0;
+static std::string s_benchmark_report = "benchmark.json";
+static u64 s_benchmark_start_frame = 0;
+static u64 s_benchmark_frames_run = 0;
+static u64 s_benchmark_start_us = 0;
+static u64 s_benchmark_end_us = 0;
+static u64 s_benchmark_jit_blocks = 0;
+static bool s_benchmark_completed = false;
+
 static void signal_handler(int)
 {
 	const char message[] = "A signal was received. A second signal will force Dolphin to stop.\n";
@@ -53,6 +76,83 @@ namespace ProcessorInterface
 void PowerButton_Tap();
 }
 
+// Called from the main loops, stops the emulation once enough frames ran
+static void UpdateBenchmark()
+{
+	if ((!s_benchmark_frames && !s_benchmark_fifo_loops) || s_benchmark_completed ||
+		!Core::IsRunning())
+		return;
+
+	if (!s_benchmark_start_us)
+	{
+		Core::SetIsThrottlerTempDisabled(true);
+		g_Config.bFrameTelemetry = true;
+		g_Config.bGPUProfiling = true;
+		s_benchmark_start_frame = Movie::GetCurrentFrame();
+		s_benchmark_start_us = Common::Timer::GetTimeUs();
+		return;
+	}
+
+	// FIFO logs stop by themselves after the last loop
+	if (s_benchmark_fifo_loops)
+		return;
+
+	s_benchmark_frames_run = Movie::GetCurrentFrame() - s_benchmark_start_frame;
+	if (s_benchmark_frames_run < s_benchmark_frames)
+		return;
+
+	// The counters are read while the CPU thread is paused
+	Core::SetState(Core::CORE_PAUSE);
+	s_benchmark_end_us = Common::Timer::GetTimeUs();
+	s_benchmark_jit_blocks = JitInterface::GetNumBlocksCompiled();
+	s_benchmark_completed = true;
+	s_running.Clear();
+}
+
+static bool WriteBenchmarkReport(const std::string& game)
+{
+	const std::vector<FrameTelemetry::Sample> samples = FrameTelemetry::GetSamples();
+	const FrameTelemetry::Summary summary = FrameTelemetry::Summarize(samples);
+	u64 shader_compiles = 0;
+	for (const FrameTelemetry::Sample& sample : samples)
+		shader_compiles += sample.shader_compiles;
+
+	const double elapsed_s =
+		s_benchmark_start_us ? (s_benchmark_end_us - s_benchmark_start_us) / 1000000.0 : 0.0;
+	std::string json = "{\n";
+	json += StringFromFormat("  \"revision\": \"%s\",\n", scm_rev_str.c_str());
+	json += StringFromFormat("  \"game\": \"%s\",\n", game.c_str());
+	json += StringFromFormat("  \"video_backend\": \"%s\",\n",
+		g_video_backend ? g_video_backend->GetName().c_str() : "");
+	json += StringFromFormat("  \"cpu_core\": %d,\n", SConfig::GetInstance().iCPUCore);
+	json += StringFromFormat("  \"completed\": %s,\n", s_benchmark_completed ? "true" : "false");
+	json += StringFromFormat("  \"frames_requested\": %llu,\n",
+		static_cast<unsigned long long>(s_benchmark_frames));
+	json += StringFromFormat("  \"fifo_loops\": %u,\n", s_benchmark_fifo_loops);
+	json += StringFromFormat("  \"frames\": %llu,\n",
+		static_cast<unsigned long long>(s_benchmark_frames_run));
+	json += StringFromFormat("  \"elapsed_s\": %.3f,\n", elapsed_s);
+	json += StringFromFormat("  \"emulated_fps\": %.3f,\n",
+		elapsed_s > 0.0 ? s_benchmark_frames_run / elapsed_s : 0.0);
+	json += StringFromFormat("  \"jit_blocks_compiled\": %llu,\n",
+		static_cast<unsigned long long>(s_benchmark_jit_blocks));
+	json += StringFromFormat("  \"shader_compiles\": %llu,\n",
+		static_cast<unsigned long long>(shader_compiles));
+	// Only the last FrameTelemetry::FRAME_COUNT frames are in the samples
+	json += "  \"telemetry\": " + FrameTelemetry::ToJSON(samples, summary);
+	json += "}\n";
+
+	if (!File::WriteStringToFile(json, s_benchmark_report))
+	{
+		fprintf(stderr, "Could not write %s\n", s_benchmark_report.c_str());
+		return false;
+	}
+	fprintf(stderr, "%llu frames in %.2fs, %.1f fps, 1%% low %.1f fps, written to %s\n",
+		static_cast<unsigned long long>(s_benchmark_frames_run), elapsed_s, summary.average_fps,
+		summary.low_1_fps, s_benchmark_report.c_str());
+	return true;
+}
+
 class Platform
 {
 public:
@@ -62,6 +162,7 @@ public:
 	{
 		while (s_running.IsSet())
 		{
+			UpdateBenchmark();
 			Core::HostDispatchJobs();
 			std::this_thread::sleep_for(std::chrono::milliseconds(100));
 		}
@@ -84,6 +185,8 @@ void Host_Message(int Id)
 {
 	if (Id == WM_USER_STOP)
 	{
+		if (s_benchmark_start_us && !s_benchmark_end_us)
+			s_benchmark_end_us = Common::Timer::GetTimeUs();
 		s_running.Clear();
 		updateMainFrameEvent.Set();
 	}
@@ -326,6 +429,7 @@ class PlatformX11 : public Platform
 					&depthDummy);
 				rendererIsFullscreen = false;
 			}
+			UpdateBenchmark();
 			Core::HostDispatchJobs();
 			usleep(100000);
 		}
@@ -361,14 +465,51 @@ int main(int argc, char* argv[])
 	struct option longopts[] = { { "exec", no_argument, nullptr, 'e' },
 	{ "help", no_argument, nullptr, 'h' },
 	{ "version", no_argument, nullptr, 'v' },
+	{ "pack-textures", required_argument, nullptr, 'p' },
+	{ "movie", required_argument, nullptr, 'm' },
+	{ "benchmark", required_argument, nullptr, 'b' },
+	{ "report", required_argument, nullptr, 'o' },
+	{ "fifo-loops", required_argument, nullptr, 'l' },
+	{ "video-backend", required_argument, nullptr, 'g' },
 	{ nullptr, 0, nullptr, 0 } };
+	std::string movie;
+	std::string video_backend;
 
-	while ((ch = getopt_long(argc, argv, "eh?v", longopts, 0)) != -1)
+	while ((ch = getopt_long(argc, argv, "eh?vp:m:b:o:l:g:", longopts, 0)) != -1)
 	{
 		switch (ch)
 		{
 		case 'e':
 			break;
+		case 'm':
+			movie = optarg;
+			break;
+		case 'b':
+			s_benchmark_frames = strtoull(optarg, nullptr, 10);
+			break;
+		case 'o':
+			s_benchmark_report = optarg;
+			break;
+		case 'l':
+			s_benchmark_fifo_loops = static_cast<u32>(strtoul(optarg, nullptr, 10));
+			break;
+		case 'g':
+			video_backend = optarg;
+			break;
+		case 'p':
+		{
+			// Tool mode, packs a custom texture directory into <directory>.itp
+			std::string directory = optarg;
+			while (directory.size() > 1 && (directory.back() == '/' || directory.back() == '\\'))
+				directory.pop_back();
+			if (!TexturePack::Build(directory, directory + ".itp"))
+			{
+				fprintf(stderr, "Could not pack %s\n", directory.c_str());
+				return 1;
+			}
+			fprintf(stderr, "Packed %s into %s.itp\n", directory.c_str(), directory.c_str());
+			return 0;
+		}
 		case 'h':
 		case '?':
 			help = 1;
@@ -383,10 +524,18 @@ int main(int argc, char* argv[])
 	{
 		fprintf(stderr, "%s\n\n", scm_rev_str.c_str());
 		fprintf(stderr, "A multi-platform GameCube/Wii emulator\n\n");
-		fprintf(stderr, "Usage: %s [-e <file>] [-h] [-v]\n", argv[0]);
+		fprintf(stderr, "Usage: %s [-e <file>] [-h] [-v] [-p <directory>] [-m <movie>] "
+			"[-g <backend>] [-b <frames> | -l <loops>] [-o <report>]\n", argv[0]);
 		fprintf(stderr, "  -e, --exec     Load the specified file\n");
 		fprintf(stderr, "  -h, --help     Show this help message\n");
 		fprintf(stderr, "  -v, --version  Print version and exit\n");
+		fprintf(stderr, "  -p, --pack-textures  Pack a custom texture directory into <directory>.itp\n");
+		fprintf(stderr, "  -m, --movie    Play the specified input recording\n");
+		fprintf(stderr, "  -b, --benchmark  Run this many frames without the frame limiter, write\n"
+			"                   the frame telemetry report and exit, 2 if stopped early\n");
+		fprintf(stderr, "  -l, --fifo-loops  Benchmark a FIFO log by playing it this many times\n");
+		fprintf(stderr, "  -g, --video-backend  Use this video backend\n");
+		fprintf(stderr, "  -o, --report   Benchmark report file, benchmark.json by default\n");
 		return 1;
 	}
 
@@ -400,6 +549,13 @@ int main(int argc, char* argv[])
 	UICommon::SetUserDirectory("");  // Auto-detect user folder
 	UICommon::Init();
 
+	if (!video_backend.empty())
+	{
+		SConfig::GetInstance().m_strVideoBackend = video_backend;
+		VideoBackendBase::ActivateBackend(video_backend);
+	}
+	FifoPlayer::GetInstance().SetLoopCount(s_benchmark_fifo_loops);
+
 	Core::SetOnStoppedCallback([]() { s_running.Clear(); });
 	platform->Init();
 
@@ -413,6 +569,12 @@ int main(int argc, char* argv[])
 
 	DolphinAnalytics::Instance()->ReportDolphinStart("nogui");
 
+	if (!movie.empty() && !Movie::PlayInput(movie))
+	{
+		fprintf(stderr, "Could not play %s\n", movie.c_str());
+		return 1;
+	}
+
 	if (!BootManager::BootCore(argv[optind]))
 	{
 		fprintf(stderr, "Could not boot %s\n", argv[optind]);
@@ -427,13 +589,37 @@ int main(int argc, char* argv[])
 
 	if (s_running.IsSet())
 		platform->MainLoop();
+	std::string game = SConfig::GetInstance().GetGameID();
+	if (s_benchmark_fifo_loops)
+	{
+		std::string name, extension;
+		SplitPath(argv[optind], nullptr, &name, &extension);
+		game = name + extension;
+	}
 	Core::Stop();
 
 	Core::Shutdown();
 	platform->Shutdown();
+
+	int status = 0;
+	if (s_benchmark_fifo_loops)
+	{
+		s_benchmark_frames_run = FifoPlayer::GetInstance().GetFramesPlayed();
+		s_benchmark_completed = FifoPlayer::GetInstance().GetLoopsPlayed() >= s_benchmark_fifo_loops;
+	}
+	if (s_benchmark_frames || s_benchmark_fifo_loops)
+	{
+		if (!s_benchmark_end_us)
+			s_benchmark_end_us = Common::Timer::GetTimeUs();
+		if (!WriteBenchmarkReport(game))
+			status = 1;
+		else if (!s_benchmark_completed)
+			status = 2;
+	}
+
 	UICommon::Shutdown();
 
 	delete platform;
 
-	return 0;
+	return status;
 }
@@ -33,6 +33,7 @@
 #include "Common/FileUtil.h"
 #include "Common/IniFile.h"
 #include "Common/MsgHandler.h"
+#include "Common/StringUtil.h"
 
 #include "Core/ConfigManager.h"
 #include "Core/HW/EXI_Device.h"
@@ -250,18 +251,30 @@ wxSizer* NetPlayDialog::CreateBottomGUI(wxWindow* parent)
 		m_start_btn->Bind(wxEVT_BUTTON, &NetPlayDialog::OnStart, this);
 
 		wxStaticText* buffer_lbl = new wxStaticText(parent, wxID_ANY, _("Buffer:"));
-		wxSpinCtrl* const padbuf_spin =
+		m_padbuf_spin =
 			new wxSpinCtrl(parent, wxID_ANY, std::to_string(INITIAL_PAD_BUFFER_SIZE), wxDefaultPosition,
 				wxDefaultSize, wxSP_ARROW_KEYS, 0, 200, INITIAL_PAD_BUFFER_SIZE);
-		padbuf_spin->Bind(wxEVT_SPINCTRL, &NetPlayDialog::OnAdjustBuffer, this);
-		padbuf_spin->SetMinSize(WxUtils::GetTextWidgetMinSize(padbuf_spin));
+		m_padbuf_spin->Bind(wxEVT_SPINCTRL, &NetPlayDialog::OnAdjustBuffer, this);
+		m_padbuf_spin->SetMinSize(WxUtils::GetTextWidgetMinSize(m_padbuf_spin));
+
+		wxCheckBox* const autobuf_chkbox = new wxCheckBox(parent, wxID_ANY, _("Auto"));
+		autobuf_chkbox->SetToolTip(
+			_("Sets the buffer from the players' pings, large enough that inputs rarely arrive late."));
+		autobuf_chkbox->Bind(wxEVT_CHECKBOX, &NetPlayDialog::OnAutoBuffer, this);
 
 		m_memcard_write = new wxCheckBox(parent, wxID_ANY, _("Write to memcards/SD"));
 
+		m_memory_check = new wxCheckBox(parent, wxID_ANY, _("Check memory"));
+		m_memory_check->SetToolTip(
+			_("Compares the emulated memory of the players every second and reports the first region "
+				"that differs. Works best with fastmem, which lets only the written memory be hashed."));
+
 		bottom_szr->Add(m_start_btn, 0, wxALIGN_CENTER_VERTICAL);
 		bottom_szr->Add(buffer_lbl, 0, wxALIGN_CENTER_VERTICAL | wxLEFT, space5);
-		bottom_szr->Add(padbuf_spin, 0, wxALIGN_CENTER_VERTICAL | wxLEFT, space5);
+		bottom_szr->Add(m_padbuf_spin, 0, wxALIGN_CENTER_VERTICAL | wxLEFT, space5);
+		bottom_szr->Add(autobuf_chkbox, 0, wxALIGN_CENTER_VERTICAL | wxLEFT, space5);
 		bottom_szr->Add(m_memcard_write, 0, wxALIGN_CENTER_VERTICAL | wxLEFT, space5);
+		bottom_szr->Add(m_memory_check, 0, wxALIGN_CENTER_VERTICAL | wxLEFT, space5);
 		bottom_szr->AddSpacer(space5);
 	}
 
@@ -332,6 +345,7 @@ void NetPlayDialog::GetNetSettings(NetSettings& settings)
 	settings.m_OCFactor = instance.m_OCFactor;
 	settings.m_EXIDevice[0] = instance.m_EXIDevice[0];
 	settings.m_EXIDevice[1] = instance.m_EXIDevice[1];
+	settings.m_MemoryCheck = m_memory_check->GetValue();
 }
 
 std::string NetPlayDialog::FindGame(const std::string& target_game)
@@ -406,6 +420,7 @@ void NetPlayDialog::OnMsgStartGame()
 	{
 		m_start_btn->Disable();
 		m_memcard_write->Disable();
+		m_memory_check->Disable();
 		m_game_btn->Disable();
 		m_player_config_btn->Disable();
 	}
@@ -421,6 +436,7 @@ void NetPlayDialog::OnMsgStopGame()
 	{
 		m_start_btn->Enable();
 		m_memcard_write->Enable();
+		m_memory_check->Enable();
 		m_game_btn->Enable();
 		m_player_config_btn->Enable();
 	}
@@ -433,6 +449,12 @@ void NetPlayDialog::OnAdjustBuffer(wxCommandEvent& event)
 	netplay_server->AdjustPadBufferSize(val);
 }
 
+void NetPlayDialog::OnAutoBuffer(wxCommandEvent& event)
+{
+	m_padbuf_spin->Enable(!event.IsChecked());
+	netplay_server->SetAutoPadBuffer(event.IsChecked());
+}
+
 void NetPlayDialog::OnPadBufferChanged(u32 buffer)
 {
 	m_pad_buffer = buffer;
@@ -448,6 +470,16 @@ void NetPlayDialog::OnDesync(u32 frame, const std::string& player)
 	GetEventHandler()->AddPendingEvent(evt);
 }
 
+void NetPlayDialog::OnMemoryDesync(u32 frame, const std::string& player, u32 address, u32 size)
+{
+	m_desync_frame = frame;
+	m_desync_player = player;
+	m_desync_address = address;
+	m_desync_size = size;
+	wxThreadEvent evt(wxEVT_THREAD, NP_GUI_EVT_MEMORY_DESYNC);
+	GetEventHandler()->AddPendingEvent(evt);
+}
+
 void NetPlayDialog::OnConnectionLost()
 {
 	wxThreadEvent evt(wxEVT_THREAD, NP_GUI_EVT_CONNECTION_LOST);
@@ -577,6 +609,8 @@ void NetPlayDialog::OnThread(wxThreadEvent& event)
 	case NP_GUI_EVT_PAD_BUFFER_CHANGE:
 	{
 		std::string msg = StringFromFormat("Pad buffer: %d", m_pad_buffer);
+		if (m_padbuf_spin)
+			m_padbuf_spin->SetValue(m_pad_buffer);
 
 		if (g_ActiveConfig.bShowNetPlayMessages)
 		{
@@ -599,6 +633,20 @@ void NetPlayDialog::OnThread(wxThreadEvent& event)
 		}
 	}
 	break;
+	case NP_GUI_EVT_MEMORY_DESYNC:
+	{
+		std::string msg = StringFromFormat(
+			"Memory desync detected from player %s on frame %u in %08x-%08x", m_desync_player.c_str(),
+			m_desync_frame, m_desync_address, m_desync_address + m_desync_size - 1);
+
+		AddChatMessage(ChatMessageType::Error, msg);
+
+		if (g_ActiveConfig.bShowNetPlayMessages)
+		{
+			OSD::AddMessage(msg, OSD::Duration::VERY_LONG, OSD::Color::RED);
+		}
+	}
+	break;
 	case NP_GUI_EVT_CONNECTION_LOST:
 	{
 		std::string msg = "Lost connection to server";
@@ -34,6 +34,7 @@ enum
 	NP_GUI_EVT_MD5_RESULT,
 	NP_GUI_EVT_PAD_BUFFER_CHANGE,
 	NP_GUI_EVT_DESYNC,
+	NP_GUI_EVT_MEMORY_DESYNC,
 	NP_GUI_EVT_CONNECTION_LOST,
 	NP_GUI_EVT_TRAVERSAL_CONNECTION_ERROR,
 };
@@ -91,6 +92,7 @@ public:
 	void OnMsgStopGame() override;
 	void OnPadBufferChanged(u32 buffer) override;
 	void OnDesync(u32 frame, const std::string& player) override;
+	void OnMemoryDesync(u32 frame, const std::string& player, u32 address, u32 size) override;
 	void OnConnectionLost() override;
 	void OnTraversalError(int error) override;
 
@@ -115,6 +117,7 @@ private:
 	void OnChangeGame(wxCommandEvent& event);
 	void OnMD5ComputeRequested(wxCommandEvent& event);
 	void OnAdjustBuffer(wxCommandEvent& event);
+	void OnAutoBuffer(wxCommandEvent& event);
 	void OnAssignPads(wxCommandEvent& event);
 	void OnKick(wxCommandEvent& event);
 	void OnPlayerSelect(wxCommandEvent& event);
@@ -131,6 +134,8 @@ private:
 	wxTextCtrl* m_chat_text;
 	wxTextCtrl* m_chat_msg_text;
 	wxCheckBox* m_memcard_write;
+	wxCheckBox* m_memory_check;
+	wxSpinCtrl* m_padbuf_spin = nullptr;
 	wxCheckBox* m_record_chkbox;
 
 	std::string m_selected_game;
@@ -148,6 +153,8 @@ private:
 	u32 m_pad_buffer;
 	u32 m_desync_frame;
 	std::string m_desync_player;
+	u32 m_desync_address;
+	u32 m_desync_size;
 
 	std::vector<int> m_playerids;
 
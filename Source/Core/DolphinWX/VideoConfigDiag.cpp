@@ -129,6 +129,7 @@ static wxString disable_filtering_desc = _("Disable texture filtering even if th
 static wxString Use_Scaling_filter_desc = _("Use filtering when efb scaled size is larger than the target resolution.");
 static wxString borderless_fullscreen_desc = _("Implement fullscreen mode with a borderless window spanning the whole screen instead of using exclusive mode.\nAllows for faster transitions between fullscreen and windowed mode, but increases input latency, makes movement less smooth and slightly decreases performance.\nExclusive mode is required to support Nvidia 3D Vision in the Direct3D backend.\n\nIf unsure, leave this unchecked.");
 static wxString internal_res_desc = _("Specifies the resolution used to render at. A high resolution greatly improves visual quality, but also greatly increases GPU load and can cause issues in certain games.\n\"Multiple of 640x528\" will result in a size slightly larger than \"Window Size\" but yield fewer issues. Generally speaking, the lower the internal resolution is, the better your performance will be. Auto (Window Size), 1.5x, and 2.5x may cause issues in some games.\n\nIf unsure, select Native.");
+static wxString dynamic_resolution_desc = _("Lowers the internal resolution while the GPU takes too long to render a frame, and raises it again up to the selected one once there is headroom. Each change briefly recreates the render targets.\nOnly works with a fixed internal resolution and a backend that can time the GPU.\n\nIf unsure, leave this unchecked.");
 static wxString efb_access_desc = _("Ignore any requests of the CPU to read from or write to the EFB.\nImproves performance in some games, but might disable some gameplay-related features or graphical effects.\n\nIf unsure, leave this unchecked.");
 static wxString efb_fast_access_desc = _("Use a fast efb caching method to speed up access. This method is inaccurate but will make games run faster and efb reads and writes will still work.");
 static wxString efb_emulate_format_changes_desc = _("Ignore any changes to the EFB format.\nImproves performance in many games without any negative effect. Causes graphical defects in a small number of other games though.\n\nIf unsure, leave this checked.");
@@ -179,8 +180,10 @@ static wxString dump_frames_desc = _("Dump all rendered frames to an AVI file in
 static wxString use_ffv1_desc = _("Encode frame dumps using the FFV1 codec.\n\nIf unsure, leave this unchecked.");
 #endif
 static wxString free_look_desc = _("This feature allows you to change the game's camera.\nMove the mouse while holding the right mouse button to pan and while holding the middle button to move.\nHold SHIFT and press one of the WASD keys to move the camera by a certain step distance (SHIFT+0 to move faster and SHIFT+9 to move slower). Press SHIFT+R to reset the camera.\n\nIf unsure, leave this unchecked.");
+static wxString background_shader_precompile_desc = _("Compiles the shaders of Compile Shaders on Startup while the game already runs, a few milliseconds per frame, instead of before it starts. The game can stutter until they are done.");
 static wxString shader_precompile_desc = _("If a database of shader for the current game exists, precompile all known shaders to void issues and stutering during gameplay. This option will increase startup time but will improve gaming experience. Warning: with a clean shader cache dx9 can have up to 20 minutes shader compilation time in some games.");
 static wxString crop_desc = _("Crop the picture from its native aspect ratio to 4:3 or 16:9.\n\nIf unsure, leave this unchecked.");
+static wxString vs_line_point_expansion_desc = _("Draw wide lines and large points by expanding them in the vertex shader instead of the geometry shader.\nGeometry shaders are slow on some drivers, which shows in games with many particles. Needs storage buffers in the vertex shader, OpenGL only.\n\nIf unsure, leave this unchecked.");
 static wxString opencl_desc = _("[EXPERIMENTAL]\nAims to speed up emulation by offloading texture decoding to the GPU using the OpenCL framework.\nHowever, right now it's known to cause texture defects in various games. Also it's slower than regular CPU texture decoding in most cases.\n\nIf unsure, leave this unchecked.");
 static wxString pptrigger_desc = _("Determines when to apply post-processing.\nOn Swap will apply post-processing before presenting to the screen. On Projection applies post-processing before the game draws 2D elements on the screen. However, this may not work with all games. On EFB Copy applies post-processing when an EFB copy of a perspective scene is requested. This may work for for other games. After blit will apply post processing after bliting reducing gpu usage when using High efb scales.\n\nIf unsure, select On Swap.");
 static wxString ppshader_list_desc = _("Applies post-processing effects when the trigger chosen in the occurs, by default this is at the end of a frame.\n\nPost-processing is performed at the selected internal resolution.\n\nIf unsure, leave the list empty.");
@@ -428,7 +431,7 @@ VideoConfigDiag::VideoConfigDiag(wxWindow* parent, const std::string &title)
 
 			szr_enh->Add(new wxStaticText(page_enh, wxID_ANY, _("Internal Resolution:")), 1, wxALIGN_CENTER_VERTICAL, 0);
 			szr_enh->Add(choice_efbscale);
-			szr_enh->AddSpacer(0);
+			szr_enh->Add(CreateCheckBox(page_enh, _("Dynamic"), (dynamic_resolution_desc), vconfig.bDynamicResolution));
 		}
 
 		// AA
@@ -912,6 +915,7 @@ VideoConfigDiag::VideoConfigDiag(wxWindow* parent, const std::string &title)
 			szr_utility->Add(CreateCheckBox(page_advanced, _("Dump EFB Target"), (dump_efb_desc), vconfig.bDumpEFBTarget));
 			szr_utility->Add(CreateCheckBox(page_advanced, _("Free Look"), (free_look_desc), vconfig.bFreeLook));
 			szr_utility->Add(shaderprecompile = CreateCheckBox(page_advanced, _("Compile Shaders on Startup"), (shader_precompile_desc), vconfig.bCompileShaderOnStartup));
+			szr_utility->Add(background_shader_precompile = CreateCheckBox(page_advanced, _("Compile Shaders in Background"), (background_shader_precompile_desc), vconfig.bBackgroundShaderPrecompile));
 
 #if !defined WIN32 && defined HAVE_LIBAV
 			szr_utility->Add(CreateCheckBox(page_advanced, _("Frame Dumps Use FFV1"), (use_ffv1_desc), vconfig.bUseFFV1));
@@ -928,6 +932,7 @@ VideoConfigDiag::VideoConfigDiag(wxWindow* parent, const std::string &title)
 
 			szr_misc->Add(CreateCheckBox(page_advanced, _("Show Input Display"), (show_input_display_desc), vconfig.bShowInputDisplay));
 			szr_misc->Add(CreateCheckBox(page_advanced, _("Crop"), (crop_desc), vconfig.bCrop));
+			szr_misc->Add(CreateCheckBox(page_advanced, _("Expand Lines and Points in Vertex Shader"), (vs_line_point_expansion_desc), vconfig.bPreferVSForLinePointExpansion));
 
 			// Progressive Scan
 			{
@@ -1445,6 +1450,8 @@ void VideoConfigDiag::OnUpdateUI(wxUpdateUIEvent& ev)
 	hires_texturemaps->Enable(vconfig.bHiresTextures && vconfig.bEnablePixelLighting);
 	hires_texturemaps->Show(vconfig.backend_info.bSupportsNormalMaps);
 
+	background_shader_precompile->Enable(vconfig.bCompileShaderOnStartup);
+
 
 	Async_Shader_compilation->Show(vconfig.backend_info.APIType != API_OPENGL);
 	Compute_Shader_decoding->Show(vconfig.backend_info.bSupportsComputeTextureDecoding);
@@ -1469,6 +1476,7 @@ void VideoConfigDiag::OnUpdateUI(wxUpdateUIEvent& ev)
 			Compute_Shader_encoding->Disable();
 		}
 		shaderprecompile->Disable();
+		background_shader_precompile->Disable();
 		choice_backend->Disable();
 		label_backend->Disable();
 
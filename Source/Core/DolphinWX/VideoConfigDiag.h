@@ -174,6 +174,7 @@ protected:
 	SettingCheckBox* hires_texturemaps;
 	SettingCheckBox* cache_hires_textures;
 	SettingCheckBox* shaderprecompile;
+	SettingCheckBox* background_shader_precompile;
 
 	wxButton* button_config_scalingshader;
 
@@ -2,9 +2,11 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <chrono>
 #include <mutex>
 
 #include "Common/Thread.h"
+#include "Core/ConfigManager.h"
 #include "InputCommon/ControllerInterface/ControllerInterface.h"
 
 #ifdef CIFACE_USE_XINPUT
@@ -81,6 +83,8 @@ void ControllerInterface::Initialize(void* const hwnd)
 #endif
 
 	m_is_init = true;
+
+	SetPollingRate(SConfig::GetInstance().m_InputPollingRate);
 }
 
 void ControllerInterface::Reinitialize()
@@ -102,6 +106,8 @@ void ControllerInterface::Shutdown()
 	if (!m_is_init)
 		return;
 
+	StopInputThread();
+
 #ifdef CIFACE_USE_XINPUT
 	ciface::XInput::DeInit();
 #endif
@@ -175,6 +181,10 @@ void ControllerInterface::RemoveDevice(std::function<bool(const ciface::Core::De
 //
 void ControllerInterface::UpdateInput()
 {
+	// The input thread already keeps the states fresh
+	if (m_input_thread_running.IsSet())
+		return;
+
 	// Don't block the UI or CPU thread (to avoid a short but noticeable frame drop)
 	if (m_devices_mutex.try_lock())
 	{
@@ -184,6 +194,113 @@ void ControllerInterface::UpdateInput()
 	}
 }
 
+//
+// SetPollingRate
+//
+// Start, stop or retime the input thread
+//
+void ControllerInterface::SetPollingRate(int rate)
+{
+	rate = std::min(std::max(rate, 0), 1000);
+	StopInputThread();
+	m_polling_rate = rate;
+	if (m_is_init && m_polling_rate > 0)
+		StartInputThread();
+}
+
+void ControllerInterface::StartInputThread()
+{
+	m_input_thread_wakeup.Reset();
+	m_input_thread_running.Set();
+	m_input_thread = std::thread(&ControllerInterface::InputThread, this);
+}
+
+void ControllerInterface::StopInputThread()
+{
+	if (!m_input_thread.joinable())
+		return;
+
+	m_input_thread_running.Clear();
+	m_input_thread_wakeup.Set();
+	m_input_thread.join();
+	// Readers go back to the live states, which UpdateInput refreshes again from now on
+	ciface::Core::Device::s_states_published.store(false, std::memory_order_release);
+}
+
+//
+// RequestInputPoll / LatchInput
+//
+// Late latching: the SI requests a poll a little before it reads the pads, then waits for it
+//
+void ControllerInterface::RequestInputPoll()
+{
+	if (!m_input_thread_running.IsSet())
+		return;
+
+	// A poll that already started might have read some devices before now
+	m_latch_poll = m_polls_started.load() + 1;
+	m_input_thread_wakeup.Set();
+}
+
+void ControllerInterface::LatchInput()
+{
+	if (!m_input_thread_running.IsSet())
+	{
+		std::lock_guard<std::mutex> lk(m_devices_mutex);
+		for (const auto& d : m_devices)
+			d->UpdateInput();
+		return;
+	}
+
+	if (m_latch_poll == 0)
+		RequestInputPoll();
+
+	// Don't hang the emulation on a stuck backend, the last published states will do
+	const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(2);
+	while (static_cast<s32>(m_polls_completed.load() - m_latch_poll) < 0)
+	{
+		const auto now = std::chrono::steady_clock::now();
+		if (now >= deadline)
+			break;
+		m_input_polled.WaitFor(deadline - now);
+	}
+	m_latch_poll = 0;
+}
+
+//
+// InputThread
+//
+// Polls every device at the polling rate and publishes what it read, so the emulated
+// controllers never wait for a slow backend
+//
+void ControllerInterface::InputThread()
+{
+	Common::SetCurrentThreadName("Input thread");
+
+	const auto period = std::chrono::microseconds(1000000 / m_polling_rate);
+	auto next_poll = std::chrono::steady_clock::now();
+	while (m_input_thread_running.IsSet())
+	{
+		m_polls_started++;
+		{
+			std::lock_guard<std::mutex> lk(m_devices_mutex);
+			for (const auto& d : m_devices)
+			{
+				d->UpdateInput();
+				d->PublishInputs();
+			}
+		}
+		ciface::Core::Device::s_states_published.store(true, std::memory_order_release);
+		m_polls_completed++;
+		m_input_polled.Set();
+
+		// Keep the rate steady, but don't make up for polls a stall made us miss
+		const auto now = std::chrono::steady_clock::now();
+		next_poll = std::max(next_poll + period, now);
+		m_input_thread_wakeup.WaitFor(next_poll - now);
+	}
+}
+
 //
 // RegisterHotplugCallback
 //
@@ -5,12 +5,16 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <map>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "Common/CommonTypes.h"
+#include "Common/Event.h"
+#include "Common/Flag.h"
 #include "Common/Thread.h"
 #include "InputCommon/ControllerInterface/Device.h"
 #include "InputCommon/ControllerInterface/ExpressionParser.h"
@@ -124,14 +128,36 @@ public:
 	void UpdateReference(ControlReference* control,
 		const ciface::Core::DeviceQualifier& default_device) const;
 	void UpdateInput();
+	// Polls the devices on the input thread this many times a second, up to 1000.
+	// With 0 they are polled by UpdateInput instead, on the thread that reads them.
+	void SetPollingRate(int rate);
+	// Has the input thread poll the devices now, without waiting for it
+	void RequestInputPoll();
+	// Waits until the devices were polled after the last RequestInputPoll, or polls them now when
+	// there was none. Without the input thread it polls them on the calling thread.
+	void LatchInput();
 
 	void RegisterHotplugCallback(std::function<void(void)> callback);
 	void InvokeHotplugCallbacks() const;
 
 private:
+	void StartInputThread();
+	void StopInputThread();
+	void InputThread();
+
 	std::vector<std::function<void()>> m_hotplug_callbacks;
 	bool m_is_init;
 	void* m_hwnd;
+
+	int m_polling_rate = 0;
+	std::thread m_input_thread;
+	Common::Flag m_input_thread_running;
+	Common::Event m_input_thread_wakeup;
+	Common::Event m_input_polled;
+	std::atomic<u32> m_polls_started{0};
+	std::atomic<u32> m_polls_completed{0};
+	// The first poll LatchInput waits for, 0 when nothing was requested
+	u32 m_latch_poll = 0;
 };
 
 extern ControllerInterface g_controller_interface;
@@ -24,6 +24,8 @@ namespace Core
 //
 // Destructor, delete all inputs/outputs on device destruction
 //
+std::atomic<bool> Device::s_states_published{false};
+
 Device::~Device()
 {
 	// delete inputs
@@ -45,6 +47,12 @@ void Device::AddOutput(Device::Output* const o)
 	m_outputs.push_back(o);
 }
 
+void Device::PublishInputs()
+{
+	for (Device::Input* input : m_inputs)
+		input->PublishState();
+}
+
 Device::Input* Device::FindInput(const std::string& name) const
 {
 	for (Input* input : m_inputs)
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -63,12 +64,25 @@ public:
 		ControlState GetGatedState()
 		{
 			if (InputGateOn())
-				return GetState();
+				return GetPublishedState();
 			else
 				return 0.0;
 		}
 
+		// The state the input thread saw on its last poll, or the live one when it isn't running.
+		// Only a load, so reading it never waits for a device backend.
+		ControlState GetPublishedState() const
+		{
+			if (s_states_published.load(std::memory_order_acquire))
+				return m_published_state.load(std::memory_order_relaxed);
+			else
+				return GetState();
+		}
+
+		void PublishState() { m_published_state.store(GetState(), std::memory_order_relaxed); }
 		Input* ToInput() override { return this; }
+	private:
+		std::atomic<ControlState> m_published_state{0.0};
 	};
 
 	//
@@ -98,12 +112,17 @@ public:
 	virtual std::string GetName() const = 0;
 	virtual std::string GetSource() const = 0;
 	virtual void UpdateInput() {}
+	// Copies the state of every input to where GetPublishedState reads it
+	void PublishInputs();
 	virtual bool IsValid() const { return true; }
 	const std::vector<Input*>& Inputs() const { return m_inputs; }
 	const std::vector<Output*>& Outputs() const { return m_outputs; }
 	Input* FindInput(const std::string& name) const;
 	Output* FindOutput(const std::string& name) const;
 
+	// Set while the input thread keeps the published states up to date
+	static std::atomic<bool> s_states_published;
+
 protected:
 	void AddInput(Input* const i);
 	void AddOutput(Output* const o);
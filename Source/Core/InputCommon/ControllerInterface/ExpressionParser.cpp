@@ -207,6 +207,84 @@ public:
 	}
 };
 
+// Deepest value stack a compiled expression may need, deeper ones walk the tree instead
+static const int MAX_STACK_DEPTH = 16;
+
+class ExpressionCompiler
+{
+public:
+	explicit ExpressionCompiler(std::vector<ExpressionOp>& ops_) : ops(ops_) {}
+	void Input(Device::Input* input)
+	{
+		ExpressionOp op;
+		op.type = ExpressionOp::OP_INPUT;
+		op.input = input;
+		Push(op, 1);
+	}
+
+	void Constant(ControlState value)
+	{
+		ExpressionOp op;
+		op.type = ExpressionOp::OP_CONSTANT;
+		op.value = value;
+		Push(op, 1);
+	}
+
+	void Operator(ExpressionOp::Type type)
+	{
+		const bool unary = type == ExpressionOp::OP_NOT;
+		const size_t operands = unary ? 1 : 2;
+		ExpressionOp op;
+		op.type = type;
+
+		// Operators on constants only are replaced by their result
+		if (ops.size() >= operands &&
+			std::all_of(ops.end() - operands, ops.end(),
+				[](const ExpressionOp& o) { return o.type == ExpressionOp::OP_CONSTANT; }))
+		{
+			const ControlState lhs = ops[ops.size() - operands].value;
+			const ControlState rhs = ops.back().value;
+			ops.resize(ops.size() - operands);
+			depth -= static_cast<int>(operands);
+			Constant(Apply(type, lhs, rhs));
+			return;
+		}
+
+		Push(op, unary ? 0 : -1);
+	}
+
+	static ControlState Apply(ExpressionOp::Type type, ControlState lhs, ControlState rhs)
+	{
+		switch (type)
+		{
+		case ExpressionOp::OP_AND:
+			return std::min(lhs, rhs);
+		case ExpressionOp::OP_OR:
+			return std::max(lhs, rhs);
+		case ExpressionOp::OP_ADD:
+			return std::min(lhs + rhs, 1.0);
+		case ExpressionOp::OP_NOT:
+			return 1.0 - rhs;
+		default:
+			assert(false);
+			return 0;
+		}
+	}
+
+	int max_depth = 0;
+
+private:
+	void Push(const ExpressionOp& op, int depth_change)
+	{
+		ops.push_back(op);
+		depth += depth_change;
+		max_depth = std::max(max_depth, depth);
+	}
+
+	std::vector<ExpressionOp>& ops;
+	int depth = 0;
+};
+
 class ExpressionNode
 {
 public:
@@ -214,6 +292,7 @@ public:
 	virtual ControlState GetValue() { return 0; }
 	virtual void SetValue(ControlState state) {}
 	virtual int CountNumControls() { return 0; }
+	virtual void Compile(ExpressionCompiler& compiler) { compiler.Constant(GetValue()); }
 	virtual operator std::string() { return ""; }
 };
 
@@ -244,6 +323,14 @@ public:
 	ControlState GetValue() override { return control->ToInput()->GetGatedState(); }
 	void SetValue(ControlState value) override { control->ToOutput()->SetGatedState(value); }
 	int CountNumControls() override { return 1; }
+	void Compile(ExpressionCompiler& compiler) override
+	{
+		// Output expressions are only ever set, what they read doesn't matter
+		if (Device::Input* input = control->ToInput())
+			compiler.Input(input);
+		else
+			compiler.Constant(0.0);
+	}
 	operator std::string() override { return "`" + (std::string)qualifier + "`"; }
 private:
 	std::shared_ptr<Device> m_device;
@@ -293,6 +380,26 @@ public:
 	}
 
 	int CountNumControls() override { return lhs->CountNumControls() + rhs->CountNumControls(); }
+	void Compile(ExpressionCompiler& compiler) override
+	{
+		lhs->Compile(compiler);
+		rhs->Compile(compiler);
+		switch (op)
+		{
+		case TOK_AND:
+			compiler.Operator(ExpressionOp::OP_AND);
+			break;
+		case TOK_OR:
+			compiler.Operator(ExpressionOp::OP_OR);
+			break;
+		case TOK_ADD:
+			compiler.Operator(ExpressionOp::OP_ADD);
+			break;
+		default:
+			assert(false);
+		}
+	}
+
 	operator std::string() override
 	{
 		return OpName(op) + "(" + (std::string)(*lhs) + ", " + (std::string)(*rhs) + ")";
@@ -334,6 +441,12 @@ public:
 	}
 
 	int CountNumControls() override { return inner->CountNumControls(); }
+	void Compile(ExpressionCompiler& compiler) override
+	{
+		inner->Compile(compiler);
+		compiler.Operator(ExpressionOp::OP_NOT);
+	}
+
 	operator std::string() override { return OpName(op) + "(" + (std::string)(*inner) + ")"; }
 };
 
@@ -499,7 +612,32 @@ private:
 
 ControlState Expression::GetValue()
 {
-	return node->GetValue();
+	if (stack_depth > MAX_STACK_DEPTH)
+		return node->GetValue();
+
+	// On the stack rather than in the expression, the UI reads expressions while the game does
+	ControlState stack[MAX_STACK_DEPTH];
+	int top = -1;
+	for (const ExpressionOp& op : ops)
+	{
+		switch (op.type)
+		{
+		case ExpressionOp::OP_INPUT:
+			stack[++top] = op.input->GetGatedState();
+			break;
+		case ExpressionOp::OP_CONSTANT:
+			stack[++top] = op.value;
+			break;
+		case ExpressionOp::OP_NOT:
+			stack[top] = 1.0 - stack[top];
+			break;
+		default:
+			stack[top - 1] = ExpressionCompiler::Apply(op.type, stack[top - 1], stack[top]);
+			--top;
+			break;
+		}
+	}
+	return stack[0];
 }
 
 void Expression::SetValue(ControlState value)
@@ -511,6 +649,10 @@ Expression::Expression(ExpressionNode* node_)
 {
 	node = node_;
 	num_controls = node->CountNumControls();
+
+	ExpressionCompiler compiler(ops);
+	node->Compile(compiler);
+	stack_depth = compiler.max_depth;
 }
 
 Expression::~Expression()
@@ -6,6 +6,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 #include "InputCommon/ControllerInterface/Device.h"
 
 namespace ciface
@@ -46,6 +47,26 @@ private:
 	bool is_input;
 };
 
+// One step of a compiled expression, which runs them in order on a small value stack
+struct ExpressionOp
+{
+	enum Type
+	{
+		OP_INPUT,     // Push the state of input
+		OP_CONSTANT,  // Push value
+		OP_AND,
+		OP_OR,
+		OP_ADD,
+		OP_NOT,
+	};
+
+	Type type;
+	union {
+		Core::Device::Input* input;
+		ControlState value;
+	};
+};
+
 class ExpressionNode;
 class Expression
 {
@@ -57,6 +78,11 @@ public:
 	void SetValue(ControlState state);
 	int num_controls;
 	ExpressionNode* node;
+
+	// The tree compiled to postfix order, with constant subexpressions folded. The tree is kept
+	// for setting outputs and for expressions too deep for the stack GetValue runs them on.
+	std::vector<ExpressionOp> ops;
+	int stack_depth;
 };
 
 enum ExpressionParseStatus
@@ -3,12 +3,14 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <atomic>
 #include <libusb.h>
 #include <mutex>
 
 #include "Common/Flag.h"
 #include "Common/Logging/Log.h"
 #include "Common/Thread.h"
+#include "Common/Timer.h"
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
 #include "Core/CoreTiming.h"
@@ -34,11 +36,28 @@ static u8 s_controller_type[MAX_SI_CHANNELS] = {
 		ControllerTypes::CONTROLLER_NONE, ControllerTypes::CONTROLLER_NONE };
 static u8 s_controller_rumble[4];
 
-static std::mutex s_mutex;
-static u8 s_controller_payload[37];
-static u8 s_controller_payload_swap[37];
-
-static std::atomic<int> s_controller_payload_size = { 0 };
+// The reports go from the transfer callbacks to Input through a triple buffer: the callbacks fill
+// the back sample and swap it with the middle one, Input swaps the middle one with its front
+// sample when it is newer. Neither side ever waits for the other.
+struct AdapterSample
+{
+	u8 payload[37];
+	int size;
+	// Common::Timer::GetTimeUs when the report arrived, 0 before the first one
+	u64 time;
+};
+static AdapterSample s_samples[3];
+static int s_back_sample = 0;
+static int s_front_sample = 2;
+// Index of the middle sample, with SAMPLE_FRESH set until Input takes it
+static std::atomic<int> s_middle_sample = { 1 };
+static const int SAMPLE_FRESH = 4;
+
+// Reports the adapter can send while Input is busy with one, so none of its 1ms slots go unused
+static const int NUM_TRANSFERS = 4;
+static libusb_transfer* s_transfers[NUM_TRANSFERS];
+static u8 s_transfer_buffers[NUM_TRANSFERS][sizeof(AdapterSample::payload)];
+static std::atomic<int> s_transfers_pending = { 0 };
 
 static std::thread s_adapter_thread;
 static Common::Flag s_adapter_thread_running;
@@ -61,21 +80,79 @@ static u8 s_endpoint_out = 0;
 
 static u64 s_last_init = 0;
 
+static void PublishSample(const u8* payload, int size)
+{
+	AdapterSample& sample = s_samples[s_back_sample];
+	std::copy(payload, payload + size, sample.payload);
+	sample.size = size;
+	sample.time = Common::Timer::GetTimeUs();
+	s_back_sample = s_middle_sample.exchange(s_back_sample | SAMPLE_FRESH) & ~SAMPLE_FRESH;
+}
+
+static const AdapterSample& LatestSample()
+{
+	if (s_middle_sample.load(std::memory_order_relaxed) & SAMPLE_FRESH)
+		s_front_sample = s_middle_sample.exchange(s_front_sample) & ~SAMPLE_FRESH;
+	return s_samples[s_front_sample];
+}
+
+// Runs on whichever thread handles the libusb events, one at a time
+static void LIBUSB_CALL ReadCallback(libusb_transfer* transfer)
+{
+	if (transfer->status != LIBUSB_TRANSFER_CANCELLED)
+	{
+		// Errors publish an empty report, which makes Input reset the adapter
+		const int size = transfer->status == LIBUSB_TRANSFER_COMPLETED ? transfer->actual_length : 0;
+		PublishSample(transfer->buffer, size);
+	}
+
+	if (transfer->status != LIBUSB_TRANSFER_CANCELLED &&
+		transfer->status != LIBUSB_TRANSFER_NO_DEVICE && s_adapter_thread_running.IsSet() &&
+		libusb_submit_transfer(transfer) == LIBUSB_SUCCESS)
+	{
+		return;
+	}
+	s_transfers_pending--;
+}
+
 static void Read()
 {
-	int payload_size = 0;
-	while (s_adapter_thread_running.IsSet())
+	Common::SetCurrentThreadName("GC Adapter Read Thread");
+	Common::PlaceCurrentThread(Common::ThreadRole::Realtime);
+
+	for (int i = 0; i < NUM_TRANSFERS; i++)
 	{
-		libusb_interrupt_transfer(s_handle, s_endpoint_in, s_controller_payload_swap,
-			sizeof(s_controller_payload_swap), &payload_size, 16);
+		s_transfers[i] = libusb_alloc_transfer(0);
+		libusb_fill_interrupt_transfer(s_transfers[i], s_handle, s_endpoint_in, s_transfer_buffers[i],
+			sizeof(s_transfer_buffers[i]), ReadCallback, nullptr, 16);
+		if (libusb_submit_transfer(s_transfers[i]) == LIBUSB_SUCCESS)
+			s_transfers_pending++;
+	}
 
-		{
-			std::lock_guard<std::mutex> lk(s_mutex);
-			std::swap(s_controller_payload_swap, s_controller_payload);
-			s_controller_payload_size.store(payload_size);
-		}
+	while (s_adapter_thread_running.IsSet() && s_transfers_pending > 0)
+	{
+		timeval tv = { 0, 16000 };
+		libusb_handle_events_timeout_completed(s_libusb_context, &tv, nullptr);
+	}
 
-		Common::YieldCPU();
+	for (libusb_transfer* transfer : s_transfers)
+		libusb_cancel_transfer(transfer);
+	// The hotplug callback stops this thread from the thread handling the events, which then can't
+	// complete the cancelled transfers. Leak them rather than free them while libusb has them.
+	for (int tries = 0; s_transfers_pending > 0 && tries < 10; tries++)
+	{
+		timeval tv = { 0, 16000 };
+		libusb_handle_events_timeout_completed(s_libusb_context, &tv, nullptr);
+	}
+	if (s_transfers_pending > 0)
+	{
+		ERROR_LOG(SERIALINTERFACE, "%d GC Adapter transfers didn't finish", s_transfers_pending.load());
+		return;
+	}
+	for (libusb_transfer*& transfer : s_transfers)
+	{
+		libusb_free_transfer(transfer);
+		transfer = nullptr;
 	}
 }
 
@@ -315,6 +392,8 @@ static void AddGCAdapter(libusb_device* device)
 	unsigned char payload = 0x13;
 	libusb_interrupt_transfer(s_handle, s_endpoint_out, &payload, sizeof(payload), &tmp, 16);
 
+	for (AdapterSample& sample : s_samples)
+		sample = {};
 	s_adapter_thread_running.Set(true);
 	s_adapter_thread = std::thread(Read);
 
@@ -379,18 +458,16 @@ GCPadStatus Input(int chan)
 	if (s_handle == nullptr || !s_detected)
 		return{};
 
-	int payload_size = 0;
-	u8 controller_payload_copy[37];
+	const AdapterSample& sample = LatestSample();
+	// The adapter hasn't sent its first report yet
+	if (sample.time == 0)
+		return{};
 
-	{
-		std::lock_guard<std::mutex> lk(s_mutex);
-		std::copy(std::begin(s_controller_payload), std::end(s_controller_payload),
-			std::begin(controller_payload_copy));
-		payload_size = s_controller_payload_size.load();
-	}
+	const int payload_size = sample.size;
+	const u8* controller_payload_copy = sample.payload;
 
 	GCPadStatus pad = {};
-	if (payload_size != sizeof(controller_payload_copy) ||
+	if (payload_size != sizeof(sample.payload) ||
 		controller_payload_copy[0] != LIBUSB_DT_HID)
 	{
 		ERROR_LOG(SERIALINTERFACE, "error reading payload (size: %d, type: %02x)", payload_size,
@@ -61,6 +61,9 @@ HWND hWnd;
 // End extern'd variables.
 
 static ComPtr<IDXGISwapChain> s_swap_chain;
+static UINT s_swap_chain_flags = 0;
+// Signaled when the swap chain can take another frame, only created in low latency mode.
+static HANDLE s_frame_latency_waitable = nullptr;
 static unsigned int s_monitor_refresh_rate = 0;
 
 static LARGE_INTEGER s_qpc_frequency;
@@ -248,7 +251,8 @@ HRESULT Create(HWND wnd)
 	swap_chain_desc.SampleDesc.Quality = 0;
 	swap_chain_desc.Windowed = true;
 	swap_chain_desc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_SEQUENTIAL;
-	swap_chain_desc.Flags = 0;
+	s_swap_chain_flags = g_ActiveConfig.bLowLatencyPresent ? DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT : 0;
+	swap_chain_desc.Flags = s_swap_chain_flags;
 
 	swap_chain_desc.BufferDesc.Width = s_xres;
 	swap_chain_desc.BufferDesc.Height = s_yres;
@@ -341,6 +345,14 @@ HRESULT Create(HWND wnd)
 
 		CheckHR(factory->CreateSwapChain(command_queue.Get(), &swap_chain_desc, s_swap_chain.ReleaseAndGetAddressOf()));
 
+		ComPtr<IDXGISwapChain2> swap_chain2;
+		if (s_swap_chain_flags & DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT &&
+			SUCCEEDED(s_swap_chain.As(&swap_chain2)))
+		{
+			swap_chain2->SetMaximumFrameLatency(1);
+			s_frame_latency_waitable = swap_chain2->GetFrameLatencyWaitableObject();
+		}
+
 		s_current_back_buf = 0;
 	}
 
@@ -707,6 +719,11 @@ void Close()
 	D3D::CleanupPersistentD3DTextureResources();
 
 	s_swap_chain.Reset();
+	if (s_frame_latency_waitable)
+	{
+		CloseHandle(s_frame_latency_waitable);
+		s_frame_latency_waitable = nullptr;
+	}
 
 	gpu_descriptor_heap_mgr.reset();
 	sampler_descriptor_heap_mgr.reset();
@@ -823,7 +840,7 @@ void Reset()
 	s_xres = client.right - client.left;
 	s_yres = client.bottom - client.top;
 
-	CheckHR(s_swap_chain->ResizeBuffers(SWAP_CHAIN_BUFFER_COUNT, s_xres, s_yres, DXGI_FORMAT_R8G8B8A8_UNORM, 0));
+	CheckHR(s_swap_chain->ResizeBuffers(SWAP_CHAIN_BUFFER_COUNT, s_xres, s_yres, DXGI_FORMAT_R8G8B8A8_UNORM, s_swap_chain_flags));
 
 	// recreate back buffer textures
 
@@ -916,7 +933,10 @@ void Present()
 
 	command_list_mgr->ExecuteQueuedWorkAndPresent(s_swap_chain.Get(), g_ActiveConfig.IsVSync() ? 1 : 0, present_flags);
 
-
+	// Wait before starting the next frame until the swap chain has room for it, instead of
+	// queueing frames behind the ones that are waiting to be shown.
+	if (s_frame_latency_waitable)
+		WaitForSingleObjectEx(s_frame_latency_waitable, 1000, TRUE);
 }
 
 HRESULT SetFullscreenState(bool enable_fullscreen)
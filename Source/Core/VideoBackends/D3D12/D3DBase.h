@@ -78,6 +78,7 @@ void WaitForOutstandingRenderingToComplete();
 void Close();
 
 extern ID3D12Device* device;
+extern ComPtr<ID3D12CommandQueue> command_queue;
 
 extern unsigned int resource_descriptor_size;
 extern unsigned int sampler_descriptor_size;
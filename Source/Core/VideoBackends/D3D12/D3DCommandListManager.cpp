@@ -213,7 +213,13 @@ void D3DCommandListManager::ResetAllCommandAllocators()
 	for (auto& allocator_list : m_command_allocator_lists)
 	{
 		for (auto& allocator : allocator_list)
+		{
+#ifdef USE_D3D12_QUEUED_COMMAND_LISTS
+			m_queued_command_list->ResetCommandAllocator(allocator);
+#else
 			allocator->Reset();
+#endif
+		}
 	}
 
 	// Move back to the start, using the first allocator of first list.
@@ -283,7 +289,11 @@ void D3DCommandListManager::PerformGPURolloverChecks()
 
 	for (UINT i = 0; i < m_command_allocator_lists[safe_to_reset_command_allocator_list].size(); i++)
 	{
+#ifdef USE_D3D12_QUEUED_COMMAND_LISTS
+		CheckHR(m_queued_command_list->ResetCommandAllocator(m_command_allocator_lists[safe_to_reset_command_allocator_list][i]));
+#else
 		CheckHR(m_command_allocator_lists[safe_to_reset_command_allocator_list][i]->Reset());
+#endif
 	}
 
 	m_command_allocator_list_fences[m_current_command_allocator_list] = m_queue_frame_fence_value;
@@ -104,6 +104,9 @@ void D3DDescriptorHeapManager::Free(size_t index)
 	size_t group = index / BITSET_SIZE;
 	size_t bit = index % BITSET_SIZE;
 	m_free_slots[group][bit] = true;
+
+	if (!m_tables.empty())
+		m_tables.clear();
 }
 
 bool D3DDescriptorHeapManager::AllocateTemporary(size_t num_handles,
@@ -131,6 +134,41 @@ bool D3DDescriptorHeapManager::AllocateTemporary(size_t num_handles,
 	return false;
 }
 
+bool D3DDescriptorHeapManager::GetTemporaryTable(const D3D12_CPU_DESCRIPTOR_HANDLE* sources,
+	size_t num_handles,
+	D3D12_GPU_DESCRIPTOR_HANDLE* out_gpu_base_handle)
+{
+	_assert_(num_handles <= MAX_TABLE_SIZE);
+
+	TableKey key;
+	key.count = num_handles;
+	for (size_t i = 0; i < num_handles; i++)
+		key.sources[i] = sources[i].ptr;
+
+	auto iter = m_tables.find(key);
+	if (iter != m_tables.end())
+	{
+		*out_gpu_base_handle = iter->second;
+		return true;
+	}
+
+	D3D12_CPU_DESCRIPTOR_HANDLE cpu_base_handle;
+	if (!AllocateTemporary(num_handles, &cpu_base_handle, out_gpu_base_handle))
+		return false;
+
+	// One range for the table, one source range per descriptor
+	std::array<UINT, MAX_TABLE_SIZE> source_sizes;
+	source_sizes.fill(1);
+	const UINT table_size = static_cast<UINT>(num_handles);
+	D3D::device->CopyDescriptors(1, &cpu_base_handle, &table_size, table_size, sources,
+		source_sizes.data(), D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+
+	if (m_tables.size() >= MAX_CACHED_TABLES)
+		m_tables.clear();
+	m_tables.emplace(key, *out_gpu_base_handle);
+	return true;
+}
+
 bool D3DDescriptorHeapManager::TryAllocateTemporaryHandles(size_t num_handles,
 	D3D12_CPU_DESCRIPTOR_HANDLE* out_cpu_base_handle,
 	D3D12_GPU_DESCRIPTOR_HANDLE* out_gpu_base_handle)
@@ -189,6 +227,7 @@ bool D3DDescriptorHeapManager::TryAllocateTemporaryHandles(size_t num_handles,
 void D3DDescriptorHeapManager::QueueFenceCallback(void* owner, u64 fence_value)
 {
 	D3DDescriptorHeapManager* this_ptr = reinterpret_cast<D3DDescriptorHeapManager*>(owner);
+	this_ptr->m_tables.clear();
 
 	// Don't add a new entry when the offset doesn't change.
 	size_t current_index = this_ptr->m_current_temporary_descriptor_index;
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <bitset>
 #include <d3d12.h>
 #include <memory>
@@ -40,6 +42,12 @@ public:
 		D3D12_CPU_DESCRIPTOR_HANDLE* out_cpu_base_handle,
 		D3D12_GPU_DESCRIPTOR_HANDLE* out_gpu_base_handle);
 
+	// Returns a table of temporary descriptors holding copies of the given shadow heap descriptors.
+	// A table is reused while the same descriptors are bound again in the same command list, instead
+	// of allocating and copying a new one. Returns false when the ring is full, like AllocateTemporary.
+	bool GetTemporaryTable(const D3D12_CPU_DESCRIPTOR_HANDLE* sources, size_t num_handles,
+		D3D12_GPU_DESCRIPTOR_HANDLE* out_gpu_base_handle);
+
 	static std::unique_ptr<D3DDescriptorHeapManager> Create(ID3D12Device* device,
 		D3D12_DESCRIPTOR_HEAP_TYPE type,
 		D3D12_DESCRIPTOR_HEAP_FLAGS flags,
@@ -74,6 +82,33 @@ private:
 	// Fences tracking GPU index
 	std::deque<std::pair<u64, size_t>> m_fences;
 	ID3D12Fence* m_fence = nullptr;
+
+	// Tables handed out by GetTemporaryTable since the last fence. Reusing older ones is not safe:
+	// the ring only keeps the slots past the last completed fence. Freeing a fixed descriptor clears
+	// them too, as a new descriptor may be written to the same slot.
+	static constexpr size_t MAX_TABLE_SIZE = 16;
+	static constexpr size_t MAX_CACHED_TABLES = 256;
+	struct TableKey
+	{
+		std::array<SIZE_T, MAX_TABLE_SIZE> sources;
+		size_t count;
+		bool operator==(const TableKey& other) const
+		{
+			return count == other.count &&
+				std::equal(sources.begin(), sources.begin() + count, other.sources.begin());
+		}
+	};
+	struct TableKeyHasher
+	{
+		size_t operator()(const TableKey& key) const
+		{
+			size_t hash = key.count;
+			for (size_t i = 0; i < key.count; i++)
+				hash = hash * 31 + key.sources[i];
+			return hash;
+		}
+	};
+	std::unordered_map<TableKey, D3D12_GPU_DESCRIPTOR_HANDLE, TableKeyHasher> m_tables;
 };
 
 class D3DSamplerHeapManager
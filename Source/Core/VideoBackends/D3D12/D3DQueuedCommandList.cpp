@@ -14,19 +14,278 @@ constexpr size_t BufferOffsetForQueueItemType()
 	return sizeof(T) + sizeof(D3DQueueItemType) * 2;
 }
 
-void ID3D12QueuedCommandList::BackgroundThreadFunction(ID3D12QueuedCommandList* parent_queued_command_list)
+static size_t BufferOffsetForQueueItem(D3DQueueItemType type)
+{
+	switch (type)
+	{
+	case D3DQueueItemType::SetPipelineState:                  return BufferOffsetForQueueItemType<SetPipelineStateArguments>();
+	case D3DQueueItemType::SetRenderTargets:                  return BufferOffsetForQueueItemType<SetRenderTargetsArguments>();
+	case D3DQueueItemType::SetVertexBuffers:                  return BufferOffsetForQueueItemType<SetVertexBuffersArguments>();
+	case D3DQueueItemType::SetIndexBuffer:                    return BufferOffsetForQueueItemType<SetIndexBufferArguments>();
+	case D3DQueueItemType::RSSetViewports:                    return BufferOffsetForQueueItemType<D3D12_VIEWPORT>();
+	case D3DQueueItemType::RSSetScissorRects:                 return BufferOffsetForQueueItemType<RSSetScissorRectsArguments>();
+	case D3DQueueItemType::SetGraphicsRootDescriptorTable:    return BufferOffsetForQueueItemType<SetGraphicsRootDescriptorTableArguments>();
+	case D3DQueueItemType::SetGraphicsRootConstantBufferView: return BufferOffsetForQueueItemType<SetGraphicsRootConstantBufferViewArguments>();
+	case D3DQueueItemType::SetGraphicsRootSignature:          return BufferOffsetForQueueItemType<SetGraphicsRootSignatureArguments>();
+	case D3DQueueItemType::ClearRenderTargetView:             return BufferOffsetForQueueItemType<ClearRenderTargetViewArguments>();
+	case D3DQueueItemType::ClearDepthStencilView:             return BufferOffsetForQueueItemType<ClearDepthStencilViewArguments>();
+	case D3DQueueItemType::DrawInstanced:                     return BufferOffsetForQueueItemType<DrawInstancedArguments>();
+	case D3DQueueItemType::DrawIndexedInstanced:              return BufferOffsetForQueueItemType<DrawIndexedInstancedArguments>();
+	case D3DQueueItemType::IASetPrimitiveTopology:            return BufferOffsetForQueueItemType<IASetPrimitiveTopologyArguments>();
+	case D3DQueueItemType::CopyBufferRegion:                  return BufferOffsetForQueueItemType<CopyBufferRegionArguments>();
+	case D3DQueueItemType::CopyResource:                      return BufferOffsetForQueueItemType<CopyResourceArguments>();
+	case D3DQueueItemType::CopyTextureRegion:                 return BufferOffsetForQueueItemType<CopyTextureRegionArguments>();
+	case D3DQueueItemType::SetDescriptorHeaps:                return BufferOffsetForQueueItemType<SetDescriptorHeapsArguments>();
+	case D3DQueueItemType::ResourceBarrier:                   return BufferOffsetForQueueItemType<ResourceBarrierArguments>();
+	case D3DQueueItemType::ResolveSubresource:                return BufferOffsetForQueueItemType<ResolveSubresourceArguments>();
+	case D3DQueueItemType::BeginQuery:                        return BufferOffsetForQueueItemType<BeginQueryArguments>();
+	case D3DQueueItemType::EndQuery:                          return BufferOffsetForQueueItemType<EndQueryArguments>();
+	case D3DQueueItemType::ResolveQueryData:                  return BufferOffsetForQueueItemType<ResolveQueryDataArguments>();
+	case D3DQueueItemType::ExecuteCommandList:                return BufferOffsetForQueueItemType<ExecuteCommandListArguments>();
+	case D3DQueueItemType::CloseCommandList:                  return BufferOffsetForQueueItemType<CloseCommandListArguments>();
+	case D3DQueueItemType::Present:                           return BufferOffsetForQueueItemType<PresentArguments>();
+	case D3DQueueItemType::ResetCommandList:                  return BufferOffsetForQueueItemType<ResetCommandListArguments>();
+	case D3DQueueItemType::ResetCommandAllocator:             return BufferOffsetForQueueItemType<ResetCommandAllocatorArguments>();
+	case D3DQueueItemType::FenceGpuSignal:                    return BufferOffsetForQueueItemType<FenceGpuSignalArguments>();
+	case D3DQueueItemType::FenceCpuSignal:                    return BufferOffsetForQueueItemType<FenceCpuSignalArguments>();
+	case D3DQueueItemType::Stop:                              return BufferOffsetForQueueItemType<StopArguments>();
+	default:
+		DEBUGCHECK(0, "Error: Unknown item in ID3D12QueuedCommandList.");
+		return 0;
+	}
+}
+
+// Follows the queue back to the front, the same way ProcessQueuedItems moves m_queue_array_back.
+static byte* SkipStopItem(byte* queue_array, byte* item)
 {
-	ID3D12GraphicsCommandList* command_list = parent_queued_command_list->m_command_list;
+	const bool eligible_to_move_to_front_of_queue = reinterpret_cast<const D3DQueueItem*>(item)->Stop.eligible_to_move_to_front_of_queue;
+
+	item += BufferOffsetForQueueItemType<StopArguments>();
+
+	if (eligible_to_move_to_front_of_queue && item - queue_array > QUEUE_ARRAY_SIZE * 2 / 3)
+	{
+		item = queue_array;
+	}
+
+	return item;
+}
 
+// The background thread walks the queue, hands each command list segment (Reset to Close) to the
+// next recorder thread, and submits the queue level work in order once the segments it depends on
+// are recorded. Every segment is started by a Reset followed by the full command list state
+// (D3DCommandListManager::SetInitialCommandListState), so segments can be recorded independently.
+void ID3D12QueuedCommandList::BackgroundThreadFunction(ID3D12QueuedCommandList* parent_queued_command_list)
+{
 	byte* queue_array = parent_queued_command_list->m_queue_array;
+	byte* item = queue_array;
+	UINT64 batch = 0;
+
+	// The backing command list is created open, recorder 0 records into it from the front of the queue.
+	QueuedRecorder* open_recorder = &parent_queued_command_list->m_recorders[0];
+	QueuedRecorder* closed_recorder = nullptr;
+
+	std::deque<QueuedOperation> operations;
+	bool terminate_worker_thread = false;
+
+	while (true)
+	{
+		const HANDLE events[2] = { parent_queued_command_list->m_begin_execution_event, parent_queued_command_list->m_recorder_progress_event };
+
+		// Pending operations also have to be submitted when a recorder makes progress.
+		DWORD wait_result = WaitForMultipleObjects(operations.empty() ? 1 : 2, events, FALSE, INFINITE);
+
+		if (wait_result == WAIT_OBJECT_0)
+		{
+			// Wake recorders waiting for this batch.
+			parent_queued_command_list->m_available_batches.store(batch + 1);
+			for (QueuedRecorder& recorder : parent_queued_command_list->m_recorders)
+			{
+				if (recorder.recording.load())
+					SetEvent(recorder.wake_event);
+			}
+
+			bool end_of_batch = false;
+			while (!end_of_batch)
+			{
+				const D3DQueueItem* qitem = reinterpret_cast<const D3DQueueItem*>(item);
+				switch (qitem->Type)
+				{
+				case D3DQueueItemType::ResetCommandList:
+				{
+					QueuedRecorder* recorder = &parent_queued_command_list->m_recorders[qitem->ResetCommandList.recorder];
+
+					// The recorder's command list can only be reset once its last segment was executed.
+					while (recorder->pending_execute)
+					{
+						if (!parent_queued_command_list->SubmitQueuedOperation(&operations))
+							WaitForSingleObject(parent_queued_command_list->m_recorder_progress_event, INFINITE);
+					}
+
+					recorder->segment = item;
+					recorder->segment_batch = batch;
+					recorder->batch.store(batch);
+					recorder->recording.store(true);
+					SetEvent(recorder->wake_event);
+
+					open_recorder = recorder;
+
+					item += BufferOffsetForQueueItemType<ResetCommandListArguments>();
+					break;
+				}
+
+				case D3DQueueItemType::CloseCommandList:
+				{
+					closed_recorder = open_recorder;
+					open_recorder = nullptr;
+
+					item += BufferOffsetForQueueItemType<CloseCommandListArguments>();
+					break;
+				}
+
+				case D3DQueueItemType::ExecuteCommandList:
+				{
+					closed_recorder->pending_execute = true;
+					operations.push_back({ *qitem, closed_recorder, batch });
+
+					item += BufferOffsetForQueueItemType<ExecuteCommandListArguments>();
+					break;
+				}
+
+				case D3DQueueItemType::Present:
+				case D3DQueueItemType::FenceGpuSignal:
+				case D3DQueueItemType::FenceCpuSignal:
+				{
+					operations.push_back({ *qitem, nullptr, batch });
+
+					item += BufferOffsetForQueueItem(qitem->Type);
+					break;
+				}
+
+				case D3DQueueItemType::Stop:
+				{
+					// A stop in the middle of a segment is only passed once its recorder gets there.
+					if (qitem->Stop.signal_stop_event || qitem->Stop.terminate_worker_thread)
+						operations.push_back({ *qitem, open_recorder, batch });
+
+					terminate_worker_thread |= qitem->Stop.terminate_worker_thread;
+
+					item = SkipStopItem(queue_array, item);
+					batch++;
+					end_of_batch = true;
+					break;
+				}
+
+				default:
+				{
+					// Recorded by the recorder threads.
+					item += BufferOffsetForQueueItem(qitem->Type);
+					break;
+				}
+				}
+			}
+		}
+
+		while (parent_queued_command_list->SubmitQueuedOperation(&operations))
+		{
+		}
+
+		if (terminate_worker_thread && operations.empty())
+		{
+			for (QueuedRecorder& recorder : parent_queued_command_list->m_recorders)
+			{
+				recorder.exit.store(true);
+				SetEvent(recorder.wake_event);
+				recorder.thread.join();
+			}
+
+			return;
+		}
+	}
+}
+
+bool ID3D12QueuedCommandList::SubmitQueuedOperation(std::deque<QueuedOperation>* operations)
+{
+	if (operations->empty())
+		return false;
+
+	QueuedOperation& operation = operations->front();
+	const D3DQueueItem* qitem = &operation.item;
+
+	switch (qitem->Type)
+	{
+	case D3DQueueItemType::ExecuteCommandList:
+	{
+		if (operation.recorder->recording.load())
+			return false;
+
+		m_command_queue->ExecuteCommandLists(1, reinterpret_cast<ID3D12CommandList**>(&operation.recorder->command_list));
+		operation.recorder->pending_execute = false;
+		break;
+	}
+
+	case D3DQueueItemType::Present:
+	{
+		CheckHR(qitem->Present.swapChain->Present(qitem->Present.syncInterval, qitem->Present.flags));
+		break;
+	}
+
+	case D3DQueueItemType::FenceGpuSignal:
+	{
+		CheckHR(m_command_queue->Signal(qitem->FenceGpuSignal.fence, qitem->FenceGpuSignal.fence_value));
+		break;
+	}
+
+	case D3DQueueItemType::FenceCpuSignal:
+	{
+		CheckHR(qitem->FenceCpuSignal.fence->Signal(qitem->FenceCpuSignal.fence_value));
+		break;
+	}
+
+	case D3DQueueItemType::Stop:
+	{
+		if (operation.recorder && operation.recorder->recording.load() && operation.recorder->batch.load() <= operation.batch)
+			return false;
+
+		if (qitem->Stop.signal_stop_event)
+		{
+			SetEvent(m_stop_execution_event);
+		}
+
+		break;
+	}
+	}
+
+	operations->pop_front();
+	return true;
+}
+
+void ID3D12QueuedCommandList::RecorderThreadFunction(ID3D12QueuedCommandList* parent_queued_command_list, QueuedRecorder* recorder)
+{
+	ID3D12GraphicsCommandList* command_list = recorder->command_list;
 
-	unsigned int queue_array_front = 0;
+	byte* queue_array = parent_queued_command_list->m_queue_array;
 
 	while (true)
 	{
-		WaitForSingleObject(parent_queued_command_list->m_begin_execution_event, INFINITE);
+		WaitForSingleObject(recorder->wake_event, INFINITE);
+
+		if (recorder->exit.load())
+			return;
+
+		// Woken for a new batch between segments.
+		if (!recorder->recording.load())
+			continue;
 
-		byte* item = &queue_array[queue_array_front];
+		byte* item = recorder->segment;
+		UINT64 batch = recorder->segment_batch;
+
+		while (parent_queued_command_list->m_available_batches.load() <= batch)
+		{
+			WaitForSingleObject(recorder->wake_event, INFINITE);
+
+			if (recorder->exit.load())
+				return;
+		}
 
 		while (true)
 		{
@@ -315,30 +574,6 @@ void ID3D12QueuedCommandList::BackgroundThreadFunction(ID3D12QueuedCommandList*
 				break;
 			}
 
-			case D3DQueueItemType::CloseCommandList:
-			{
-				CheckHR(command_list->Close());
-
-				item += BufferOffsetForQueueItemType<CloseCommandListArguments>();
-				break;
-			}
-
-			case D3DQueueItemType::ExecuteCommandList:
-			{
-				parent_queued_command_list->m_command_queue->ExecuteCommandLists(1, reinterpret_cast<ID3D12CommandList**>(&command_list));
-
-				item += BufferOffsetForQueueItemType<ExecuteCommandListArguments>();
-				break;
-			}
-
-			case D3DQueueItemType::Present:
-			{
-				CheckHR(qitem->Present.swapChain->Present(qitem->Present.syncInterval, qitem->Present.flags));
-
-				item += BufferOffsetForQueueItemType<PresentArguments>();
-				break;
-			}
-
 			case D3DQueueItemType::ResetCommandList:
 			{
 				CheckHR(command_list->Reset(qitem->ResetCommandList.allocator, nullptr));
@@ -355,47 +590,44 @@ void ID3D12QueuedCommandList::BackgroundThreadFunction(ID3D12QueuedCommandList*
 				break;
 			}
 
+			case D3DQueueItemType::ExecuteCommandList:
+			case D3DQueueItemType::Present:
 			case D3DQueueItemType::FenceGpuSignal:
+			case D3DQueueItemType::FenceCpuSignal:
 			{
-				CheckHR(parent_queued_command_list->m_command_queue->Signal(qitem->FenceGpuSignal.fence, qitem->FenceGpuSignal.fence_value));
-
-				item += BufferOffsetForQueueItemType<FenceGpuSignalArguments>();
+				// Submitted by the background thread.
+				item += BufferOffsetForQueueItem(qitem->Type);
 				break;
 			}
 
-			case D3DQueueItemType::FenceCpuSignal:
+			case D3DQueueItemType::Stop:
 			{
-				CheckHR(qitem->FenceCpuSignal.fence->Signal(qitem->FenceCpuSignal.fence_value));
+				item = SkipStopItem(queue_array, item);
+				batch++;
+
+				recorder->batch.store(batch);
+				SetEvent(parent_queued_command_list->m_recorder_progress_event);
+
+				// The rest of the segment is queued after the next ProcessQueuedItems.
+				while (parent_queued_command_list->m_available_batches.load() <= batch)
+				{
+					WaitForSingleObject(recorder->wake_event, INFINITE);
+
+					if (recorder->exit.load())
+						return;
+				}
 
-				item += BufferOffsetForQueueItemType<FenceCpuSignalArguments>();
 				break;
 			}
 
-			case D3DQueueItemType::Stop:
+			case D3DQueueItemType::CloseCommandList:
 
 				// Use a goto to break out of the loop, since we can't exit the loop from
 				// within a switch statement. We could use a separate 'if' after the switch,
 				// but that was the highest source of overhead in the function after profiling.
 				// http://stackoverflow.com/questions/1420029/how-to-break-out-of-a-loop-from-inside-a-switch
 
-				bool eligible_to_move_to_front_of_queue = qitem->Stop.eligible_to_move_to_front_of_queue;
-				bool signal_stop_event = qitem->Stop.signal_stop_event;
-				bool terminate_worker_thread = qitem->Stop.terminate_worker_thread;
-
-				item += BufferOffsetForQueueItemType<StopArguments>();
-
-				if (eligible_to_move_to_front_of_queue && item - queue_array > QUEUE_ARRAY_SIZE * 2 / 3)
-				{
-					item = queue_array;
-				}
-
-				if (signal_stop_event)
-				{
-					SetEvent(parent_queued_command_list->m_stop_execution_event);
-				}
-
-				if (terminate_worker_thread)
-					return;
+				CheckHR(command_list->Close());
 
 				goto exitLoop;
 			}
@@ -403,7 +635,8 @@ void ID3D12QueuedCommandList::BackgroundThreadFunction(ID3D12QueuedCommandList*
 
 	exitLoop:
 
-		queue_array_front = static_cast<unsigned int>(item - queue_array);
+		recorder->recording.store(false);
+		SetEvent(parent_queued_command_list->m_recorder_progress_event);
 	}
 }
 
@@ -417,18 +650,59 @@ ID3D12QueuedCommandList::ID3D12QueuedCommandList(ID3D12GraphicsCommandList* back
 
 	m_begin_execution_event = CreateSemaphore(nullptr, 0, 256, nullptr);
 	m_stop_execution_event = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+	m_recorder_progress_event = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+
+	CheckHR(backing_command_list->GetDevice(IID_PPV_ARGS(&m_device)));
+	m_command_list_type = backing_command_list->GetType();
+
+	// The backing command list is open, recorder 0 continues it from the front of the queue.
+	m_recorders[0].command_list = backing_command_list;
+	m_recorders[0].segment = m_queue_array;
+	m_recorders[0].recording.store(true);
+
+	for (unsigned int i = 1; i < QUEUE_RECORDER_THREAD_COUNT; i++)
+	{
+		// Command lists are created open, keep them closed until their first segment.
+		CheckHR(m_device->CreateCommandAllocator(m_command_list_type, IID_PPV_ARGS(&m_recorders[i].initial_allocator)));
+		CheckHR(m_device->CreateCommandList(0, m_command_list_type, m_recorders[i].initial_allocator, nullptr, IID_PPV_ARGS(&m_recorders[i].command_list)));
+		CheckHR(m_recorders[i].command_list->Close());
+	}
+
+	for (QueuedRecorder& recorder : m_recorders)
+	{
+		recorder.wake_event = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+		recorder.thread = std::thread(RecorderThreadFunction, this, &recorder);
+	}
 
 	m_background_thread = std::thread(BackgroundThreadFunction, this);
 }
 
 ID3D12QueuedCommandList::~ID3D12QueuedCommandList()
 {
-	// Kick worker thread, and tell it to exit.
+	// Kick worker thread, and tell it to exit. It stops the recorder threads.
 	ProcessQueuedItems(true, true, true);
 	m_background_thread.join();
 
+	for (unsigned int i = 0; i < QUEUE_RECORDER_THREAD_COUNT; i++)
+	{
+		CloseHandle(m_recorders[i].wake_event);
+
+		// Recorder 0 uses the backing command list and allocators.
+		if (i == 0)
+			continue;
+
+		m_recorders[i].command_list->Release();
+		m_recorders[i].initial_allocator->Release();
+
+		for (auto& allocators : m_recorder_allocators)
+			allocators.second[i]->Release();
+	}
+
+	m_device->Release();
+
 	CloseHandle(m_begin_execution_event);
 	CloseHandle(m_stop_execution_event);
+	CloseHandle(m_recorder_progress_event);
 }
 
 void ID3D12QueuedCommandList::CheckForOverflow()
@@ -535,6 +809,18 @@ void ID3D12QueuedCommandList::ProcessQueuedItems(bool eligible_to_move_to_front_
 	}
 }
 
+HRESULT ID3D12QueuedCommandList::ResetCommandAllocator(ID3D12CommandAllocator* allocator)
+{
+	auto allocators = m_recorder_allocators.find(allocator);
+	if (allocators != m_recorder_allocators.end())
+	{
+		for (unsigned int i = 1; i < QUEUE_RECORDER_THREAD_COUNT; i++)
+			allocators->second[i]->Reset();
+	}
+
+	return allocator->Reset();
+}
+
 ULONG ID3D12QueuedCommandList::AddRef()
 {
 	m_ref.fetch_add(1);
@@ -669,8 +955,24 @@ HRESULT STDMETHODCALLTYPE ID3D12QueuedCommandList::Reset(
 {
 	DEBUGCHECK(pInitialState == nullptr, "Error: Invalid assumption in ID3D12QueuedCommandList.");
 
+	auto allocators = m_recorder_allocators.find(pAllocator);
+	if (allocators == m_recorder_allocators.end())
+	{
+		std::array<ID3D12CommandAllocator*, QUEUE_RECORDER_THREAD_COUNT> recorder_allocators;
+		recorder_allocators[0] = pAllocator;
+		for (unsigned int i = 1; i < QUEUE_RECORDER_THREAD_COUNT; i++)
+			CheckHR(m_device->CreateCommandAllocator(m_command_list_type, IID_PPV_ARGS(&recorder_allocators[i])));
+
+		allocators = m_recorder_allocators.emplace(pAllocator, recorder_allocators).first;
+	}
+
+	// Hand the segments to the recorders in turn.
+	unsigned int recorder = m_next_recorder;
+	m_next_recorder = (m_next_recorder + 1) % QUEUE_RECORDER_THREAD_COUNT;
+
 	reinterpret_cast<D3DQueueItem*>(m_queue_array_back)->Type = D3DQueueItemType::ResetCommandList;
-	reinterpret_cast<D3DQueueItem*>(m_queue_array_back)->ResetCommandList.allocator = pAllocator;
+	reinterpret_cast<D3DQueueItem*>(m_queue_array_back)->ResetCommandList.allocator = allocators->second[recorder];
+	reinterpret_cast<D3DQueueItem*>(m_queue_array_back)->ResetCommandList.recorder = recorder;
 
 	m_queue_array_back += BufferOffsetForQueueItemType<ResetCommandListArguments>();
 
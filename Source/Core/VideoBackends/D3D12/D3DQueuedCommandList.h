@@ -4,15 +4,22 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <d3d12.h>
+#include <deque>
 #include <thread>
+#include <unordered_map>
 
 namespace DX12
 {
 
 static const unsigned int QUEUE_ARRAY_SIZE = 24 * 1024 * 1024;
 
+// Each command list segment (from a Reset to the following Close) is recorded on one of these
+// threads, into its own command list and command allocators.
+static const unsigned int QUEUE_RECORDER_THREAD_COUNT = 3;
+
 enum D3DQueueItemType
 {
 	AbortProcessing = 0,
@@ -209,6 +216,7 @@ struct PresentArguments
 struct ResetCommandListArguments
 {
 	ID3D12CommandAllocator* allocator;
+	unsigned int recorder;
 };
 
 struct ResetCommandAllocatorArguments
@@ -288,6 +296,10 @@ public:
 	void QueueFenceCpuSignal(ID3D12Fence* fence_to_signal, UINT64 fence_value);
 	void QueuePresent(IDXGISwapChain* swap_chain, UINT sync_interval, UINT flags);
 
+	// Resets allocator along with the allocators the recorder threads use in its place.
+	// Like ID3D12CommandAllocator::Reset, the GPU must be done with all lists recorded into it.
+	HRESULT ResetCommandAllocator(ID3D12CommandAllocator* allocator);
+
 	// IUnknown methods
 
 	ULONG STDMETHODCALLTYPE AddRef();
@@ -638,7 +650,41 @@ private:
 	void ResetQueueOverflowTracking();
 	void CheckForOverflow();
 
+	struct QueuedRecorder
+	{
+		ID3D12GraphicsCommandList* command_list = nullptr;
+		ID3D12CommandAllocator* initial_allocator = nullptr;
+		std::thread thread;
+		HANDLE wake_event = nullptr;
+
+		// Start of the segment and the batch (run of items up to a Stop) it starts in,
+		// written by the background thread before setting recording.
+		byte* segment = nullptr;
+		UINT64 segment_batch = 0;
+
+		// Batch the recorder has reached in the queue.
+		std::atomic<UINT64> batch{ 0 };
+		std::atomic<bool> recording{ false };
+		std::atomic<bool> exit{ false };
+
+		// Only used by the background thread, set once the list is closed until it is executed.
+		bool pending_execute = false;
+	};
+
+	// Queue level work (execution, presents, fences, stops), submitted in queue order once the
+	// segments they depend on are recorded.
+	struct QueuedOperation
+	{
+		D3DQueueItem item;
+		QueuedRecorder* recorder;
+		UINT64 batch;
+	};
+
 	static void BackgroundThreadFunction(ID3D12QueuedCommandList* parent_queued_command_list);
+	static void RecorderThreadFunction(ID3D12QueuedCommandList* parent_queued_command_list, QueuedRecorder* recorder);
+
+	// Returns false when the front operation is not ready yet, or there is none.
+	bool SubmitQueuedOperation(std::deque<QueuedOperation>* operations);
 
 	byte m_queue_array[QUEUE_ARRAY_SIZE];
 	byte* m_queue_array_back = m_queue_array;
@@ -650,6 +696,22 @@ private:
 	HANDLE m_begin_execution_event;
 	HANDLE m_stop_execution_event;
 
+	// Set by the recorders whenever they finish a segment or pass a Stop.
+	HANDLE m_recorder_progress_event;
+
+	// Number of batches the background thread has handed out.
+	std::atomic<UINT64> m_available_batches{ 0 };
+
+	std::array<QueuedRecorder, QUEUE_RECORDER_THREAD_COUNT> m_recorders;
+	unsigned int m_next_recorder = 1;
+
+	// Allocators for each recorder, keyed by the allocator passed to Reset (used by recorder 0).
+	// Only accessed from the thread calling Reset.
+	std::unordered_map<ID3D12CommandAllocator*, std::array<ID3D12CommandAllocator*, QUEUE_RECORDER_THREAD_COUNT>> m_recorder_allocators;
+
+	ID3D12Device* m_device = nullptr;
+	D3D12_COMMAND_LIST_TYPE m_command_list_type;
+
 	ID3D12GraphicsCommandList* m_command_list;
 	ID3D12CommandQueue* m_command_queue;
 
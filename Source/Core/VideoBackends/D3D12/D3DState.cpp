@@ -86,18 +86,29 @@ public:
 
 		desc.InputLayout = reinterpret_cast<D3DVertexFormat*>(native.get())->GetActiveInputLayout();
 
-		desc.CachedPSO.CachedBlobSizeInBytes = value_size;
-		desc.CachedPSO.pCachedBlob = value;
-
 		ComPtr<ID3D12PipelineState> pso;
-		HRESULT hr = D3D::device->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(pso.ReleaseAndGetAddressOf()));
+		HRESULT hr = E_FAIL;
+		if (gx_state_cache.m_pso_library)
+		{
+			hr = gx_state_cache.m_pso_library->LoadGraphicsPipeline(StateCache::GetPipelineName(key).c_str(), &desc, IID_PPV_ARGS(pso.ReleaseAndGetAddressOf()));
+		}
 
 		if (FAILED(hr))
 		{
-			// Failure can occur if disk cache is corrupted, or a driver upgrade invalidates the existing blobs.
-			// In this case, we need to clear the disk cache.
-			s_cache_is_corrupted = true;
-			return;
+			// Not in the library (or no library), fall back to the cached blob.
+			desc.CachedPSO.CachedBlobSizeInBytes = value_size;
+			desc.CachedPSO.pCachedBlob = value;
+
+			hr = D3D::device->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(pso.ReleaseAndGetAddressOf()));
+
+			if (FAILED(hr))
+			{
+				// Failure can occur if disk cache is corrupted, or a driver upgrade invalidates the existing blobs.
+				// In this case, we need to clear the disk cache.
+				s_cache_is_corrupted = true;
+				return;
+			}
+			gx_state_cache.StorePipeline(key, pso.Get());
 		}
 
 		SmallPsoDesc small_desc = {};
@@ -141,6 +152,9 @@ void StateCache::Init()
 
 	std::string cache_filename = StringFromFormat("%sIdx12-%s-pso.cache", File::GetUserPath(D_SHADERCACHE_IDX).c_str(),
 		SConfig::GetInstance().m_strGameID.c_str());
+	gx_state_cache.m_pso_library_filename = StringFromFormat("%sIdx12-%s-pso.library", File::GetUserPath(D_SHADERCACHE_IDX).c_str(),
+		SConfig::GetInstance().m_strGameID.c_str());
+	gx_state_cache.CreatePipelineLibrary(true);
 
 	PipelineStateCacheInserter inserter;
 	s_pso_disk_cache.OpenAndRead(cache_filename, inserter);
@@ -158,6 +172,8 @@ void StateCache::Init()
 		gx_state_cache.m_small_pso_map.clear();
 
 		File::Delete(cache_filename);
+		File::Delete(gx_state_cache.m_pso_library_filename);
+		gx_state_cache.CreatePipelineLibrary(false);
 
 		s_pso_disk_cache.OpenAndRead(cache_filename, inserter);
 
@@ -165,6 +181,90 @@ void StateCache::Init()
 	}
 }
 
+void StateCache::CreatePipelineLibrary(bool load_from_disk)
+{
+	m_pso_library.Reset();
+	m_pso_library_data.clear();
+	m_pso_library_dirty = false;
+
+	ComPtr<ID3D12Device1> device1;
+	if (FAILED(D3D::device->QueryInterface(IID_PPV_ARGS(device1.ReleaseAndGetAddressOf()))))
+	{
+		return;
+	}
+
+	if (load_from_disk && File::Exists(m_pso_library_filename))
+	{
+		File::IOFile file(m_pso_library_filename, "rb");
+		m_pso_library_data.resize(static_cast<size_t>(file.GetSize()));
+		if (m_pso_library_data.empty() || !file.ReadBytes(m_pso_library_data.data(), m_pso_library_data.size()))
+		{
+			m_pso_library_data.clear();
+		}
+	}
+
+	HRESULT hr = E_FAIL;
+	if (!m_pso_library_data.empty())
+	{
+		hr = device1->CreatePipelineLibrary(m_pso_library_data.data(), m_pso_library_data.size(), IID_PPV_ARGS(m_pso_library.ReleaseAndGetAddressOf()));
+	}
+	if (FAILED(hr))
+	{
+		// Missing, corrupted, or created by another driver/adapter, start with an empty one.
+		m_pso_library_data.clear();
+		hr = device1->CreatePipelineLibrary(nullptr, 0, IID_PPV_ARGS(m_pso_library.ReleaseAndGetAddressOf()));
+		if (FAILED(hr))
+		{
+			WARN_LOG(VIDEO, "Failed to create D3D12 pipeline library (%x), using cached PSO blobs", hr);
+			m_pso_library.Reset();
+		}
+	}
+}
+
+void StateCache::SavePipelineLibrary()
+{
+	if (!m_pso_library || !m_pso_library_dirty)
+	{
+		return;
+	}
+	std::vector<u8> data(m_pso_library->GetSerializedSize());
+	if (!data.empty() && SUCCEEDED(m_pso_library->Serialize(data.data(), data.size())))
+	{
+		// The library still references the old data, write it out under a new name first.
+		std::string temp_filename = m_pso_library_filename + ".tmp";
+		{
+			File::IOFile file(temp_filename, "wb");
+			if (!file.WriteBytes(data.data(), data.size()))
+			{
+				file.Close();
+				File::Delete(temp_filename);
+				return;
+			}
+		}
+		File::Rename(temp_filename, m_pso_library_filename);
+	}
+	m_pso_library_dirty = false;
+}
+
+void StateCache::StorePipeline(const SmallPsoDiskDesc& disk_desc, ID3D12PipelineState* pso)
+{
+	if (!m_pso_library)
+	{
+		return;
+	}
+	// E_INVALIDARG means the name is already stored, which is fine.
+	if (SUCCEEDED(m_pso_library->StorePipeline(GetPipelineName(disk_desc).c_str(), pso)))
+	{
+		m_pso_library_dirty = true;
+	}
+}
+
+std::wstring StateCache::GetPipelineName(const SmallPsoDiskDesc& disk_desc)
+{
+	u64 hash = GetHash64(reinterpret_cast<const u8*>(&disk_desc), static_cast<u32>(sizeof(disk_desc)), 0);
+	return UTF8ToUTF16(StringFromFormat("PSO%016llX", hash));
+}
+
 void StateCache::CheckDiskCacheState(IDXGIAdapter* adapter)
 {
 	DXGI_ADAPTER_DESC adapter_desc = {};
@@ -491,6 +591,7 @@ HRESULT StateCache::GetPipelineStateObjectFromCache(const SmallPsoDesc& pso_desc
 			{
 				s_pso_disk_cache.Append(disk_desc, reinterpret_cast<const u8*>(psoBlob->GetBufferPointer()), static_cast<u32>(psoBlob->GetBufferSize()));
 			}
+			StorePipeline(disk_desc, new_pso.Get());
 		}
 	}
 	else
@@ -506,6 +607,10 @@ void StateCache::Clear()
 	m_pso_map.clear();
 	m_small_pso_map.clear();
 
+	SavePipelineLibrary();
+	m_pso_library.Reset();
+	m_pso_library_data.clear();
+
 	s_pso_disk_cache.Sync();
 	s_pso_disk_cache.Close();
 }
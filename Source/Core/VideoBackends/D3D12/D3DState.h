@@ -5,7 +5,9 @@
 #pragma once
 
 #include <stack>
+#include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "Common/BitField.h"
 #include "Common/CommonTypes.h"
@@ -215,6 +217,18 @@ private:
 
 	std::unordered_map<SmallPsoDesc, ComPtr<ID3D12PipelineState>, hash_small_pso_desc, equality_small_pipeline_state_desc> m_small_pso_map;
 	bool m_enable_disk_cache = true;
+
+	// Serialized PSOs, only available when the runtime supports ID3D12Device1.
+	// The blob cache is still written so the PSOs can be rebuilt when the library is invalidated.
+	void CreatePipelineLibrary(bool load_from_disk);
+	void SavePipelineLibrary();
+	void StorePipeline(const SmallPsoDiskDesc& disk_desc, ID3D12PipelineState* pso);
+	static std::wstring GetPipelineName(const SmallPsoDiskDesc& disk_desc);
+
+	ComPtr<ID3D12PipelineLibrary> m_pso_library;
+	std::vector<u8> m_pso_library_data; // Referenced by m_pso_library, must outlive it.
+	std::string m_pso_library_filename;
+	bool m_pso_library_dirty = false;
 };
 
 }  // namespace DX12
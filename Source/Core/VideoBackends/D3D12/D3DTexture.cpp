@@ -23,12 +23,17 @@ namespace D3D
 constexpr size_t SYNC_TEXTURE_UPLOAD_BUFFER_SIZE = 4 * 512 * 512;
 constexpr size_t INITIAL_TEXTURE_UPLOAD_BUFFER_SIZE = 8 * 1024 * 1024;
 constexpr size_t MAXIMUM_TEXTURE_UPLOAD_BUFFER_SIZE = 64 * 1024 * 1024;
+// Large uploads are executed once this much of them is recorded, so the GPU starts on the copies
+// while the rest is recorded without splitting the command list for each texture of a pack.
+constexpr size_t TEXTURE_UPLOAD_EXECUTE_BUDGET = 16 * 1024 * 1024;
 
 static std::unique_ptr<D3DStreamBuffer> s_texture_upload_stream_buffer;
+static size_t s_pending_upload_bytes = 0;
 
 void CleanupPersistentD3DTextureResources()
 {
 	s_texture_upload_stream_buffer.reset();
+	s_pending_upload_bytes = 0;
 }
 
 void ReplaceTexture2D(ID3D12Resource* texture12, const u8* buffer, DXGI_FORMAT fmt, unsigned int width, unsigned int height, unsigned int src_pitch, unsigned int level, D3D12_RESOURCE_STATES current_resource_state)
@@ -111,8 +116,12 @@ void ReplaceTexture2D(ID3D12Resource* texture12, const u8* buffer, DXGI_FORMAT f
 	}
 	else if (upload_size > SYNC_TEXTURE_UPLOAD_BUFFER_SIZE)
 	{
-		// To grant that the texture data is in place to start rendering we have to execute the copy operation now
-		D3D::command_list_mgr->ExecuteQueuedWork();
+		s_pending_upload_bytes += upload_size;
+		if (s_pending_upload_bytes >= TEXTURE_UPLOAD_EXECUTE_BUDGET)
+		{
+			D3D::command_list_mgr->ExecuteQueuedWork();
+			s_pending_upload_bytes = 0;
+		}
 	}
 	ResourceBarrier(current_command_list, texture12, D3D12_RESOURCE_STATE_COPY_DEST, current_resource_state, level);
 }
@@ -0,0 +1,82 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <cstring>
+
+#include "Common/CommonTypes.h"
+#include "VideoBackends/D3D12/D3DBase.h"
+#include "VideoBackends/D3D12/D3DCommandListManager.h"
+#include "VideoBackends/D3D12/GPUProfiler.h"
+
+namespace DX12
+{
+
+GPUProfiler::GPUProfiler()
+{
+	D3D12_QUERY_HEAP_DESC desc = { D3D12_QUERY_HEAP_TYPE_TIMESTAMP, QUERY_COUNT, 0 };
+	CheckHR(D3D::device->CreateQueryHeap(&desc, IID_PPV_ARGS(m_query_heap.ReleaseAndGetAddressOf())));
+
+	CheckHR(D3D::device->CreateCommittedResource(
+		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_READBACK),
+		D3D12_HEAP_FLAG_NONE,
+		&CD3DX12_RESOURCE_DESC::Buffer(QUERY_READBACK_BUFFER_SIZE),
+		D3D12_RESOURCE_STATE_COPY_DEST,
+		nullptr,
+		IID_PPV_ARGS(m_query_readback_buffer.ReleaseAndGetAddressOf())));
+
+	m_tracking_fence = D3D::command_list_mgr->RegisterQueueFenceCallback(this, &GPUProfiler::QueueFenceCallback);
+}
+
+GPUProfiler::~GPUProfiler()
+{
+	D3D::command_list_mgr->RemoveQueueFenceCallback(this);
+	m_query_heap.Reset();
+	D3D::command_list_mgr->DestroyResourceAfterCurrentCommandListExecuted(m_query_readback_buffer.Detach());
+}
+
+void GPUProfiler::WriteTimestamp(u32 query)
+{
+	D3D::current_command_list->EndQuery(m_query_heap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, query);
+}
+
+void GPUProfiler::EndQueries(u32 frame, u32 count)
+{
+	const UINT first = frame * MAX_TIMESTAMPS;
+	D3D::current_command_list->ResolveQueryData(m_query_heap.Get(), D3D12_QUERY_TYPE_TIMESTAMP,
+		first, count, m_query_readback_buffer.Get(), first * sizeof(UINT64));
+	m_frame_fence_values[frame] = m_next_fence_value;
+}
+
+bool GPUProfiler::GetResults(u32 frame, u32 count, u64* timestamps, u64* frequency)
+{
+	if (m_tracking_fence->GetCompletedValue() < m_frame_fence_values[frame])
+		return false;
+
+	const size_t first = frame * MAX_TIMESTAMPS;
+	D3D12_RANGE range = { sizeof(UINT64) * first, sizeof(UINT64) * (first + count) };
+	void* readback_buffer_map;
+	CheckHR(m_query_readback_buffer->Map(0, &range, &readback_buffer_map));
+	memcpy(timestamps, reinterpret_cast<u8*>(readback_buffer_map) + sizeof(UINT64) * first, sizeof(UINT64) * count);
+	D3D12_RANGE write_range = {};
+	m_query_readback_buffer->Unmap(0, &write_range);
+
+	UINT64 timestamp_frequency = 0;
+	if (FAILED(D3D::command_queue->GetTimestampFrequency(&timestamp_frequency)))
+		timestamp_frequency = 0;
+	*frequency = timestamp_frequency;
+	return true;
+}
+
+void GPUProfiler::QueueFenceCallback(void* owning_object, UINT64 fence_value)
+{
+	GPUProfiler* owning_profiler = static_cast<GPUProfiler*>(owning_object);
+	owning_profiler->QueueFence(fence_value);
+}
+
+void GPUProfiler::QueueFence(UINT64 fence_value)
+{
+	m_next_fence_value = fence_value + 1;
+}
+
+} // namespace
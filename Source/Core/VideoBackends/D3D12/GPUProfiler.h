@@ -0,0 +1,43 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <d3d12.h>
+
+#include "VideoBackends/D3D12/D3DBase.h"
+#include "VideoCommon/GPUProfilerBase.h"
+
+namespace DX12
+{
+
+// The timestamps of a frame are resolved into a readback buffer at the end of the frame,
+// they can be read once the fence of the command list that resolved them has completed.
+class GPUProfiler final : public GPUProfilerBase
+{
+public:
+	GPUProfiler();
+	~GPUProfiler();
+
+protected:
+	void WriteTimestamp(u32 query) override;
+	void EndQueries(u32 frame, u32 count) override;
+	bool GetResults(u32 frame, u32 count, u64* timestamps, u64* frequency) override;
+
+private:
+	static void QueueFenceCallback(void* owning_object, UINT64 fence_value);
+	void QueueFence(UINT64 fence_value);
+
+	static constexpr size_t QUERY_READBACK_BUFFER_SIZE = QUERY_COUNT * sizeof(UINT64);
+
+	ComPtr<ID3D12QueryHeap> m_query_heap;
+	ComPtr<ID3D12Resource> m_query_readback_buffer;
+
+	ID3D12Fence* m_tracking_fence = nullptr;
+	UINT64 m_next_fence_value = 0;
+	std::array<UINT64, FRAME_COUNT> m_frame_fence_values = {};
+};
+
+} // namespace
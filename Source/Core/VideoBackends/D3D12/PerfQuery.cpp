@@ -41,14 +41,15 @@ PerfQuery::~PerfQuery()
 
 void PerfQuery::EnableQuery(PerfQueryGroup type)
 {
-	if (m_query_count > m_query_buffer.size() / 2)
+	if (ShouldCollectResults(static_cast<u32>(m_query_buffer.size())))
 		WeakFlush();
 
-	// all queries already used?
-	if (m_query_buffer.size() == m_query_count)
+	// all queries allowed in flight already used?
+	if (m_query_count >= GetMaxQueriesInFlight(static_cast<u32>(m_query_buffer.size())))
 	{
+		if (m_query_count == m_query_buffer.size())
+			ERROR_LOG(VIDEO, "Flushed query buffer early!");
 		FlushOne();
-		ERROR_LOG(VIDEO, "Flushed query buffer early!");
 	}
 	// Query start need to be delayed until beforre the draw command to grant
 	// that the query will be executed in the same list
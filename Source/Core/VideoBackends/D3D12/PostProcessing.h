@@ -41,6 +41,8 @@ private:
 	void ReleaseBindingSampler(uintptr_t binding) override;
 	uintptr_t CreateBindingSampler(const PostProcessingShaderConfiguration::RenderPass::Input& input_config) override;
 	void ReleasePassNativeResources(RenderPassData& pass) override;
+	void PollPassCompilation() override;
+	bool CreatePassShader(RenderPassData& pass, const std::vector<u8>& binary) override;
 	bool RecompileShaders() override;
 };
 
@@ -35,6 +35,7 @@
 #include "VideoCommon/AVIDump.h"
 #include "VideoCommon/BPFunctions.h"
 #include "VideoCommon/Fifo.h"
+#include "VideoCommon/GPUProfilerBase.h"
 #include "VideoCommon/OnScreenDisplay.h"
 #include "VideoCommon/PixelEngine.h"
 #include "VideoCommon/PixelShaderManager.h"
@@ -688,6 +689,7 @@ void Renderer::SwapImpl(u32 xfb_addr, u32 fb_width, u32 fb_stride, u32 fb_height
 	UpdateDrawRectangle(s_backbuffer_width, s_backbuffer_height);
 	TargetRectangle target_rc = GetTargetRectangle();
 
+	SetGPUPass(GPU_PASS_PRESENT);
 	D3D::GetBackBuffer()->TransitionToResourceState(D3D::current_command_list, D3D12_RESOURCE_STATE_RENDER_TARGET);
 	D3D::current_command_list->OMSetRenderTargets(1, &D3D::GetBackBuffer()->GetRTV(), FALSE, nullptr);
 
@@ -748,6 +750,7 @@ void Renderer::SwapImpl(u32 xfb_addr, u32 fb_width, u32 fb_stride, u32 fb_height
 	}
 	else
 	{
+		SetGPUPass(GPU_PASS_POST_PROCESSING);
 		m_post_processor->OnEndFrame();
 		TargetRectangle blit_rect = Renderer::ConvertEFBRectangle(rc);
 		TargetSize blit_size(s_target_width, s_target_height);
@@ -777,6 +780,7 @@ void Renderer::SwapImpl(u32 xfb_addr, u32 fb_width, u32 fb_stride, u32 fb_height
 		{
 			blit_depth_tex = FramebufferManager::GetResolvedEFBDepthTexture();
 		}
+		SetGPUPass(GPU_PASS_PRESENT);
 		BlitScreen(target_rc, blit_rect, blit_size, blit_tex, blit_depth_tex, gamma);
 	}
 
@@ -818,7 +822,6 @@ void Renderer::SwapImpl(u32 xfb_addr, u32 fb_width, u32 fb_stride, u32 fb_height
 		AVIDump::Frame state = AVIDump::FetchState(ticks);
 		DumpFrameData(reinterpret_cast<const u8*>(screenshot_texture_map), source_width, source_height,
 			dst_location.PlacedFootprint.Footprint.RowPitch, state);
-		FinishFrameData();
 
 		D3D12_RANGE write_range = {};
 		s_screenshot_texture->Unmap(0, &write_range);
@@ -830,6 +833,7 @@ void Renderer::SwapImpl(u32 xfb_addr, u32 fb_width, u32 fb_stride, u32 fb_height
 	Renderer::DrawDebugText();
 
 	OSD::DrawMessages();
+	g_gpu_profiler->EndFrame();
 	D3D::EndFrame();
 
 	TextureCacheBase::Cleanup(frameCount);
@@ -924,6 +928,11 @@ void Renderer::SwapImpl(u32 xfb_addr, u32 fb_width, u32 fb_stride, u32 fb_height
 		D3D::command_list_mgr->ExecuteQueuedWork(true);
 		m_post_processor->ReloadShaders();
 	}
+	if (m_post_processor->PendingShadersReady())
+	{
+		D3D::command_list_mgr->ExecuteQueuedWork(true);
+		m_post_processor->ActivatePendingShaders();
+	}
 }
 
 void Renderer::ResetAPIState()
@@ -15,6 +15,7 @@
 
 #include "VideoCommon/Debugger.h"
 #include "VideoCommon/HLSLCompiler.h"
+#include "VideoCommon/ShaderPrecompiler.h"
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/ObjectUsageProfiler.h"
 
@@ -204,87 +205,26 @@ void ShaderCache::Init()
 	SETSTAT(stats.numVertexShadersCreated, 0);
 	if (g_ActiveConfig.bCompileShaderOnStartup)
 	{
-		size_t shader_count = 0;
-		ps_bytecode_cache->ForEachMostUsedByCategory(gameid,
-			[&](const PixelShaderUid& it, size_t total)
-		{
-			PixelShaderUid item = it;
-			item.ClearHASH();
-			item.CalculateUIDHash();
-			HandlePSUIDChange(item, true);
-			shader_count++;
-			if ((shader_count & 7) == 0)
-			{
-				Host_UpdateTitle(StringFromFormat("Compiling Pixel Shaders %i %% (%i/%i)", (shader_count * 100) / total, shader_count, total));
-				s_compiler->WaitForFinish();
-			}
-		},
-			[](ByteCodeCacheEntry& entry)
-		{
-			return !entry.m_shader_bytecode.pShaderBytecode;
-		}
-		, true);
-		shader_count = 0;
-		vs_bytecode_cache->ForEachMostUsedByCategory(gameid,
-			[&](const VertexShaderUid& it, size_t total)
-		{
-			VertexShaderUid item = it;
-			item.ClearHASH();
-			item.CalculateUIDHash();
-			HandleVSUIDChange(item, true);
-			shader_count++;
-			if ((shader_count & 31) == 0)
-			{
-				Host_UpdateTitle(StringFromFormat("Compiling Vertex Shaders %i %% (%i/%i)", (shader_count * 100) / total, shader_count, total));
-				s_compiler->WaitForFinish();
-			}
-		},
-			[](ByteCodeCacheEntry& entry)
-		{
-			return !entry.m_shader_bytecode.pShaderBytecode;
-		}
-		, true);
-		shader_count = 0;
-		gs_bytecode_cache->ForEachMostUsedByCategory(gameid,
-			[&](const GeometryShaderUid& it, size_t total)
-		{
-			GeometryShaderUid item = it;
-			item.ClearHASH();
-			item.CalculateUIDHash();
-			HandleGSUIDChange(item, true);
-			shader_count++;
-			if ((shader_count & 7) == 0)
-			{
-				Host_UpdateTitle(StringFromFormat("Compiling Geometry Shaders %i %% (%i/%i)", (shader_count * 100) / total, shader_count, total));
-				s_compiler->WaitForFinish();
-			}
-		},
-			[](ByteCodeCacheEntry& entry)
-		{
-			return !entry.m_shader_bytecode.pShaderBytecode;
-		}
-		, true);
-		shader_count = 0;
-		ts_bytecode_cache->ForEachMostUsedByCategory(gameid,
-			[&](const TessellationShaderUid& it, size_t total)
-		{
-			TessellationShaderUid item = it;
-			item.ClearHASH();
-			item.CalculateUIDHash();
-			HandleTSUIDChange(item, true);
-			shader_count++;
-			if ((shader_count & 31) == 0)
-			{
-				Host_UpdateTitle(StringFromFormat("Compiling Tessellation Shaders %i %% (%i/%i)", (shader_count * 100) / total, shader_count, total));
-				s_compiler->WaitForFinish();
-			}
-		},
-			[](std::pair<ByteCodeCacheEntry, ByteCodeCacheEntry>& entry)
-		{
-			return !entry.first.m_shader_bytecode.pShaderBytecode;
-		}
-		, true);
-		s_compiler->WaitForFinish();
+		auto needs_compile = [](ByteCodeCacheEntry& entry) { return !entry.m_shader_bytecode.pShaderBytecode; };
+		std::vector<PixelShaderUid> ps_uids = ShaderPrecompiler::CollectUids<PixelShaderUid>(*ps_bytecode_cache, gameid, needs_compile);
+		std::vector<VertexShaderUid> vs_uids = ShaderPrecompiler::CollectUids<VertexShaderUid>(*vs_bytecode_cache, gameid, needs_compile);
+		std::vector<GeometryShaderUid> gs_uids = ShaderPrecompiler::CollectUids<GeometryShaderUid>(*gs_bytecode_cache, gameid, needs_compile);
+		std::vector<TessellationShaderUid> ts_uids = ShaderPrecompiler::CollectUids<TessellationShaderUid>(*ts_bytecode_cache, gameid,
+			[](std::pair<ByteCodeCacheEntry, ByteCodeCacheEntry>& entry) { return !entry.first.m_shader_bytecode.pShaderBytecode; });
+		const size_t ps_count = ps_uids.size();
+		const size_t vs_count = vs_uids.size();
+		const size_t gs_count = gs_uids.size();
+		const size_t ts_count = ts_uids.size();
+
+		ShaderPrecompiler::Run({
+			s_compiler->PrecompileJob("Pixel Shaders", ps_count,
+				[uids = std::move(ps_uids)](size_t index) { HandlePSUIDChange(uids[index], false); }),
+			s_compiler->PrecompileJob("Vertex Shaders", vs_count,
+				[uids = std::move(vs_uids)](size_t index) { HandleVSUIDChange(uids[index], false); }),
+			s_compiler->PrecompileJob("Geometry Shaders", gs_count,
+				[uids = std::move(gs_uids)](size_t index) { HandleGSUIDChange(uids[index], false); }),
+			s_compiler->PrecompileJob("Tessellation Shaders", ts_count,
+				[uids = std::move(ts_uids)](size_t index) { HandleTSUIDChange(uids[index], false); }) });
 	}
 }
 
@@ -295,6 +235,7 @@ void ShaderCache::Clear()
 
 void ShaderCache::Shutdown()
 {
+	ShaderPrecompiler::Cancel();
 	if (s_compiler)
 	{
 		s_compiler->WaitForFinish();
@@ -131,13 +131,14 @@ bool TextureCache::TCacheEntry::Save(const std::string& filename, unsigned int l
 	}
 	else
 	{
-		saved = TextureToPng(
+		TextureToPngAsync(
 			static_cast<u8*>(readback_texture_map),
 			dst_location.PlacedFootprint.Footprint.RowPitch,
 			filename,
 			dst_location.PlacedFootprint.Footprint.Width,
 			dst_location.PlacedFootprint.Footprint.Height
 		);
+		saved = true;
 	}
 	m_texture->TransitionToResourceState(D3D::current_command_list, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
 	D3D12_RANGE write_range = {};
@@ -264,7 +265,7 @@ PC_TexFormat TextureCache::GetNativeTextureFormat(const s32 texformat, const Tlu
 
 TextureCacheBase::TCacheEntryBase* TextureCache::CreateTexture(const TCacheEntryConfig& config)
 {
-	static const DXGI_FORMAT PC_TexFormat_To_DXGIFORMAT[12]
+	static const DXGI_FORMAT PC_TexFormat_To_DXGIFORMAT[14]
 	{
 		DXGI_FORMAT_UNKNOWN,//PC_TEX_FMT_NONE
 		DXGI_FORMAT_R8G8B8A8_UNORM,//PC_TEX_FMT_BGRA32
@@ -278,6 +279,8 @@ TextureCacheBase::TCacheEntryBase* TextureCache::CreateTexture(const TCacheEntry
 		DXGI_FORMAT_BC2_UNORM,//PC_TEX_FMT_DXT3
 		DXGI_FORMAT_BC3_UNORM,//PC_TEX_FMT_DXT5
 		DXGI_FORMAT_R32_FLOAT,//PC_TEX_FMT_R32
+		DXGI_FORMAT_BC5_UNORM,//PC_TEX_FMT_BC5
+		DXGI_FORMAT_BC7_UNORM,//PC_TEX_FMT_BC7
 	};
 	if (config.rendertarget)
 	{
@@ -732,63 +735,30 @@ void TextureCache::BindTextures()
 		return;
 	}
 
-	// If more than one texture, allocate space for group.
-	D3D12_CPU_DESCRIPTOR_HANDLE s_group_base_texture_cpu_handle;
-	D3D12_GPU_DESCRIPTOR_HANDLE s_group_base_texture_gpu_handle;
+	// Gather the descriptors of the group, unused stages and material maps get the null SRV.
+	D3D12_CPU_DESCRIPTOR_HANDLE sources[16];
 	const unsigned int num_handles = use_materials ? 16 : 8;
-	if (!D3D::gpu_descriptor_heap_mgr->AllocateTemporary(num_handles, &s_group_base_texture_cpu_handle, &s_group_base_texture_gpu_handle))
+	for (unsigned int stage = 0; stage < 8; stage++)
 	{
-		// Kick command buffer before attempting to allocate again. This is slow.
-		D3D::command_list_mgr->ExecuteQueuedWork();
-		if (!D3D::gpu_descriptor_heap_mgr->AllocateTemporary(num_handles, &s_group_base_texture_cpu_handle, &s_group_base_texture_gpu_handle))
+		const TCacheEntry* entry = reinterpret_cast<TCacheEntry*>(bound_textures[stage]);
+		sources[stage] = entry ? entry->m_texture->GetSRVCPUShadow() : DX12::D3D::null_srv_cpu_shadow;
+		if (use_materials)
 		{
-			PanicAlert("Failed to allocate temporary descriptors.");
-			return;
+			sources[8 + stage] = entry && entry->m_nrm_texture ?
+				entry->m_nrm_texture->GetSRVCPUShadow() : DX12::D3D::null_srv_cpu_shadow;
 		}
 	}
 
-	for (unsigned int stage = 0; stage < 8; stage++)
+	// Draws that bind the same textures share one table per command list.
+	D3D12_GPU_DESCRIPTOR_HANDLE s_group_base_texture_gpu_handle;
+	if (!D3D::gpu_descriptor_heap_mgr->GetTemporaryTable(sources, num_handles, &s_group_base_texture_gpu_handle))
 	{
-		if (bound_textures[stage] != nullptr)
-		{
-			D3D12_CPU_DESCRIPTOR_HANDLE textureDestDescriptor;
-			textureDestDescriptor.ptr =
-				s_group_base_texture_cpu_handle.ptr + stage * D3D::resource_descriptor_size;
-
-			DX12::D3D::device->CopyDescriptorsSimple(
-				1, textureDestDescriptor, reinterpret_cast<TCacheEntry*>(bound_textures[stage])
-				->m_texture->GetSRVCPUShadow(),
-				D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
-			if (reinterpret_cast<TCacheEntry*>(bound_textures[stage])->m_nrm_texture && use_materials)
-			{
-				textureDestDescriptor.ptr = s_group_base_texture_cpu_handle.ptr + ((8 + stage) * D3D::resource_descriptor_size);
-				DX12::D3D::device->CopyDescriptorsSimple(
-					1,
-					textureDestDescriptor,
-					reinterpret_cast<TCacheEntry*>(bound_textures[stage])->m_nrm_texture->GetSRVCPUShadow(),
-					D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV
-				);
-			}
-		}
-		else
+		// Kick command buffer before attempting to allocate again. This is slow.
+		D3D::command_list_mgr->ExecuteQueuedWork();
+		if (!D3D::gpu_descriptor_heap_mgr->GetTemporaryTable(sources, num_handles, &s_group_base_texture_gpu_handle))
 		{
-			D3D12_CPU_DESCRIPTOR_HANDLE nullDestDescriptor;
-			nullDestDescriptor.ptr =
-				s_group_base_texture_cpu_handle.ptr + stage * D3D::resource_descriptor_size;
-
-			DX12::D3D::device->CopyDescriptorsSimple(1, nullDestDescriptor,
-				DX12::D3D::null_srv_cpu_shadow,
-				D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
-			if (use_materials)
-			{
-				nullDestDescriptor.ptr = s_group_base_texture_cpu_handle.ptr + ((8 + stage) * D3D::resource_descriptor_size);
-				DX12::D3D::device->CopyDescriptorsSimple(
-					1,
-					nullDestDescriptor,
-					DX12::D3D::null_srv_cpu_shadow,
-					D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV
-				);
-			}
+			PanicAlert("Failed to allocate temporary descriptors.");
+			return;
 		}
 	}
 
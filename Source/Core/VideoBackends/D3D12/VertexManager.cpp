@@ -177,11 +177,6 @@ void VertexManager::vFlush(bool use_dst_alpha)
 	D3D::command_list_mgr->EnsureDrawLimit();
 }
 
-u16* VertexManager::GetIndexBuffer()
-{
-	return IndexGenerator::GetBasePointer();
-}
-
 void VertexManager::ResetBuffer(u32 stride)
 {
 	s_pCurBufferPointer = m_vertex_cpu_buffer.data();
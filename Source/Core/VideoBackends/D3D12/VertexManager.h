@@ -29,7 +29,6 @@ public:
 
 protected:
 	void ResetBuffer(u32 stride) override;
-	u16* GetIndexBuffer() override;
 private:
 
 	void PrepareDrawBuffers(u32 stride);
@@ -15,6 +15,7 @@
 #include "VideoBackends/D3D12/D3DCommandListManager.h"
 #include "VideoBackends/D3D12/D3DBase.h"
 #include "VideoBackends/D3D12/D3DUtil.h"
+#include "VideoBackends/D3D12/GPUProfiler.h"
 #include "VideoBackends/D3D12/PerfQuery.h"
 #include "VideoBackends/D3D12/Render.h"
 #include "VideoBackends/D3D12/ShaderCache.h"
@@ -88,6 +89,8 @@ void VideoBackend::InitBackendInfo()
 	g_Config.backend_info.bSupportedFormats[PC_TEX_FMT_DXT1] = true;
 	g_Config.backend_info.bSupportedFormats[PC_TEX_FMT_DXT3] = true;
 	g_Config.backend_info.bSupportedFormats[PC_TEX_FMT_DXT5] = true;
+	g_Config.backend_info.bSupportedFormats[PC_TEX_FMT_BC5] = true;
+	g_Config.backend_info.bSupportedFormats[PC_TEX_FMT_BC7] = true;
 
 	g_Config.backend_info.bSupportsScaling = false;
 	g_Config.backend_info.bSupportsExclusiveFullscreen = false;
@@ -98,6 +101,7 @@ void VideoBackend::InitBackendInfo()
 	g_Config.backend_info.bSupportsGeometryShaders = true;
 	g_Config.backend_info.bSupports3DVision = true;
 	g_Config.backend_info.bSupportsPostProcessing = true;
+	g_Config.backend_info.bSupportsPostProcessingCompute = false;
 	g_Config.backend_info.bSupportsClipControl = true;
 	g_Config.backend_info.bSupportsNormalMaps = true;
 	g_Config.backend_info.bSupportsEarlyZ = true;
@@ -111,6 +115,10 @@ void VideoBackend::InitBackendInfo()
 	g_Config.backend_info.bSupportsDepthClamp = true;
 	g_Config.backend_info.bSupportsMultithreading = false;
 	g_Config.backend_info.bSupportsReversedDepthRange = true;
+	g_Config.backend_info.bSupportsPrimitiveRestart = false;
+	g_Config.backend_info.bSupports32BitIndices = false;
+	g_Config.backend_info.bSupportsDeferredEFBCopies = false;
+	g_Config.backend_info.bSupportsVirtualXFBWriteBack = false;
 	IDXGIFactory* factory;
 	IDXGIAdapter* ad;
 	hr = create_dxgi_factory(__uuidof(IDXGIFactory), (void**)&factory);
@@ -178,6 +186,7 @@ void VideoBackend::Video_Prepare()
 	g_texture_cache = std::make_unique<TextureCache>();
 	g_vertex_manager = std::make_unique<VertexManager>();
 	g_perf_query = std::make_unique<PerfQuery>();
+	g_gpu_profiler = std::make_unique<GPUProfiler>();
 	g_xfb_encoder = std::make_unique<XFBEncoder>();
 	ShaderCache::Init();
 	ShaderConstantsManager::Init();
@@ -201,6 +210,7 @@ void VideoBackend::Shutdown()
 	D3D::WaitForOutstandingRenderingToComplete();
 
 	g_xfb_encoder.reset();
+	g_gpu_profiler.reset();
 	g_perf_query.reset();
 	g_vertex_manager.reset();
 	g_texture_cache.reset();
@@ -392,6 +392,18 @@ HRESULT Create(HWND wnd)
 	hr = factory->MakeWindowAssociation(wnd, DXGI_MWA_NO_WINDOW_CHANGES);
 	if (FAILED(hr)) MessageBox(wnd, _T("Failed to associate the window"), _T("Dolphin Direct3D 11 backend"), MB_OK | MB_ICONERROR);
 
+	// The blit model swap chain has no waitable object, capping the frames the driver may queue
+	// ahead gives most of the latency benefit.
+	if (g_ActiveConfig.bLowLatencyPresent)
+	{
+		IDXGIDevice1* dxgi_device = nullptr;
+		if (SUCCEEDED(device->QueryInterface(__uuidof(IDXGIDevice1), (void**)&dxgi_device)))
+		{
+			dxgi_device->SetMaximumFrameLatency(1);
+			dxgi_device->Release();
+		}
+	}
+
 	SetDebugObjectName(context, "device context");
 	SAFE_RELEASE(factory);
 	SAFE_RELEASE(output);
@@ -9,6 +9,7 @@
 #include "VideoBackends/DX11/D3DBase.h"
 #include "VideoBackends/DX11/D3DState.h"
 
+#include "VideoCommon/IndexGenerator.h"
 #include "VideoCommon/VideoConfig.h"
 #include "VideoCommon/SamplerCommon.h"
 
@@ -229,7 +230,8 @@ void StateManager::Apply()
 
 		if (m_dirtyFlags & DirtyFlag_IndexBuffer)
 		{
-			D3D::context->IASetIndexBuffer(m_pending.indexBuffer, DXGI_FORMAT_R16_UINT, 0);
+			D3D::context->IASetIndexBuffer(m_pending.indexBuffer,
+				IndexGenerator::Uses32BitIndices() ? DXGI_FORMAT_R32_UINT : DXGI_FORMAT_R16_UINT, 0);
 			m_current.indexBuffer = m_pending.indexBuffer;
 		}
 
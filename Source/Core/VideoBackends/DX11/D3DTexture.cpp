@@ -56,6 +56,8 @@ inline void LoadDataMap(ID3D11Texture2D* pTexture, const u8* buffer, const s32 l
 	case DXGI_FORMAT_BC1_UNORM:
 	case DXGI_FORMAT_BC2_UNORM:
 	case DXGI_FORMAT_BC3_UNORM:
+	case DXGI_FORMAT_BC5_UNORM:
+	case DXGI_FORMAT_BC7_UNORM:
 		TextureUtil::CopyCompressedTextureData((u8*)map.pData, buffer, width, height, pitch, fmt == DXGI_FORMAT_BC1_UNORM ? 8 : 16, map.RowPitch);
 		break;
 	default:
@@ -92,6 +94,8 @@ inline void LoadDataResource(ID3D11Texture2D* pTexture, const u8* buffer, const
 	case DXGI_FORMAT_BC1_UNORM:
 	case DXGI_FORMAT_BC2_UNORM:
 	case DXGI_FORMAT_BC3_UNORM:
+	case DXGI_FORMAT_BC5_UNORM:
+	case DXGI_FORMAT_BC7_UNORM:
 		pitch = (pitch + 3) >> 2;
 		pixelsize = (fmt == DXGI_FORMAT_BC1_UNORM ? 8 : 16);
 		dest_region.right = width < 4 ? 4 : width;
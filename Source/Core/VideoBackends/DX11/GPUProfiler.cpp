@@ -0,0 +1,68 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Common/CommonTypes.h"
+#include "VideoBackends/DX11/D3DBase.h"
+#include "VideoBackends/DX11/GPUProfiler.h"
+
+namespace DX11 {
+
+GPUProfiler::GPUProfiler()
+{
+	D3D11_QUERY_DESC qdesc = CD3D11_QUERY_DESC(D3D11_QUERY_TIMESTAMP_DISJOINT, 0);
+	for (ID3D11Query*& query : m_disjoint_queries)
+		D3D::device->CreateQuery(&qdesc, &query);
+
+	qdesc = CD3D11_QUERY_DESC(D3D11_QUERY_TIMESTAMP, 0);
+	for (ID3D11Query*& query : m_timestamp_queries)
+		D3D::device->CreateQuery(&qdesc, &query);
+}
+
+GPUProfiler::~GPUProfiler()
+{
+	for (ID3D11Query*& query : m_disjoint_queries)
+		SAFE_RELEASE(query);
+	for (ID3D11Query*& query : m_timestamp_queries)
+		SAFE_RELEASE(query);
+}
+
+void GPUProfiler::BeginQueries(u32 frame)
+{
+	D3D::context->Begin(m_disjoint_queries[frame]);
+}
+
+void GPUProfiler::WriteTimestamp(u32 query)
+{
+	D3D::context->End(m_timestamp_queries[query]);
+}
+
+void GPUProfiler::EndQueries(u32 frame, u32 count)
+{
+	D3D::context->End(m_disjoint_queries[frame]);
+}
+
+bool GPUProfiler::GetResults(u32 frame, u32 count, u64* timestamps, u64* frequency)
+{
+	D3D11_QUERY_DATA_TIMESTAMP_DISJOINT disjoint;
+	if (D3D::context->GetData(m_disjoint_queries[frame], &disjoint, sizeof(disjoint),
+		D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK)
+	{
+		return false;
+	}
+
+	for (u32 i = 0; i < count; i++)
+	{
+		if (D3D::context->GetData(m_timestamp_queries[frame * MAX_TIMESTAMPS + i], &timestamps[i],
+			sizeof(u64), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK)
+		{
+			return false;
+		}
+	}
+
+	// The clock changed during the frame, the timestamps can't be used
+	*frequency = disjoint.Disjoint ? 0 : disjoint.Frequency;
+	return true;
+}
+
+} // namespace
@@ -0,0 +1,33 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+
+#include "VideoBackends/DX11/D3DBase.h"
+#include "VideoCommon/GPUProfilerBase.h"
+
+namespace DX11 {
+
+// Every frame is enclosed in a disjoint query, which gives the timestamp frequency and
+// tells if the timestamps of the frame can be compared at all.
+class GPUProfiler : public GPUProfilerBase
+{
+public:
+	GPUProfiler();
+	~GPUProfiler();
+
+protected:
+	void BeginQueries(u32 frame) override;
+	void WriteTimestamp(u32 query) override;
+	void EndQueries(u32 frame, u32 count) override;
+	bool GetResults(u32 frame, u32 count, u64* timestamps, u64* frequency) override;
+
+private:
+	std::array<ID3D11Query*, FRAME_COUNT> m_disjoint_queries = {};
+	std::array<ID3D11Query*, QUERY_COUNT> m_timestamp_queries = {};
+};
+
+} // namespace
@@ -22,6 +22,7 @@
 #include "VideoCommon/GeometryShaderGen.h"
 #include "VideoCommon/GeometryShaderManager.h"
 #include "VideoCommon/HLSLCompiler.h"
+#include "VideoCommon/ShaderPrecompiler.h"
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/VideoConfig.h"
 
@@ -185,27 +186,11 @@ void GeometryShaderCache::Init()
 
 	if (g_ActiveConfig.bCompileShaderOnStartup)
 	{
-		size_t shader_count = 0;
-		s_geometry_shaders->ForEachMostUsedByCategory(gameid,
-			[&](const GeometryShaderUid& it, size_t total)
-		{
-			GeometryShaderUid item = it;
-			item.ClearHASH();
-			item.CalculateUIDHash();
-			CompileGShader(item, true);
-			shader_count++;
-			if ((shader_count & 7) == 0)
-			{
-				Host_UpdateTitle(StringFromFormat("Compiling Geometry Shaders %i %% (%i/%i)", (shader_count * 100) / total, shader_count, total));
-				s_compiler->WaitForFinish();
-			}
-		},
-			[](GSCacheEntry& entry)
-		{
-			return !entry.shader;
-		}
-		, true);
-		s_compiler->WaitForFinish();
+		std::vector<GeometryShaderUid> uids = ShaderPrecompiler::CollectUids<GeometryShaderUid>(*s_geometry_shaders, gameid,
+			[](GSCacheEntry& entry) { return !entry.shader; });
+		const size_t count = uids.size();
+		ShaderPrecompiler::Run({ s_compiler->PrecompileJob("Geometry Shaders", count,
+			[uids = std::move(uids)](size_t index) { CompileGShader(uids[index], false); }) });
 	}
 
 	s_last_entry = nullptr;
@@ -229,6 +214,7 @@ void GeometryShaderCache::Clear()
 
 void GeometryShaderCache::Shutdown()
 {
+	ShaderPrecompiler::Cancel();
 	if (s_compiler)
 	{
 		s_compiler->WaitForFinish();
@@ -21,6 +21,7 @@
 #include "VideoCommon/Debugger.h"
 #include "VideoCommon/TessellationShaderManager.h"
 #include "VideoCommon/HLSLCompiler.h"
+#include "VideoCommon/ShaderPrecompiler.h"
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/VideoConfig.h"
 
@@ -110,27 +111,11 @@ void HullDomainShaderCache::Init()
 	SETSTAT(stats.numHullShadersAlive, 0);
 	if (g_ActiveConfig.bCompileShaderOnStartup)
 	{
-		size_t shader_count = 0;
-		s_hulldomain_shaders->ForEachMostUsedByCategory(gameid,
-			[&](const TessellationShaderUid& it, size_t total)
-		{
-			TessellationShaderUid item = it;
-			item.ClearHASH();
-			item.CalculateUIDHash();
-			CompileHDShader(item, true);
-			shader_count++;
-			if ((shader_count & 7) == 0)
-			{
-				Host_UpdateTitle(StringFromFormat("Compiling Tessellation Shaders %i %% (%i/%i)", (shader_count * 100) / total, shader_count, total));
-				s_compiler->WaitForFinish();
-			}
-		},
-			[](HDCacheEntry& entry)
-		{
-			return !entry.domainshader;
-		}
-		, true);
-		s_compiler->WaitForFinish();
+		std::vector<TessellationShaderUid> uids = ShaderPrecompiler::CollectUids<TessellationShaderUid>(*s_hulldomain_shaders, gameid,
+			[](HDCacheEntry& entry) { return !entry.domainshader; });
+		const size_t count = uids.size();
+		ShaderPrecompiler::Run({ s_compiler->PrecompileJob("Tessellation Shaders", count,
+			[uids = std::move(uids)](size_t index) { CompileHDShader(uids[index], false); }) });
 	}
 	s_last_entry = nullptr;
 }
@@ -153,6 +138,7 @@ void HullDomainShaderCache::Clear()
 
 void HullDomainShaderCache::Shutdown()
 {
+	ShaderPrecompiler::Cancel();
 	if (s_compiler)
 	{
 		s_compiler->WaitForFinish();
@@ -34,15 +34,14 @@ PerfQuery::~PerfQuery()
 
 void PerfQuery::EnableQuery(PerfQueryGroup type)
 {
-	// Is this sane?
-	if (m_query_count > m_query_buffer.size() / 2)
+	if (ShouldCollectResults(static_cast<u32>(m_query_buffer.size())))
 		WeakFlush();
 
-	if (m_query_buffer.size() == m_query_count)
+	if (m_query_count >= GetMaxQueriesInFlight(static_cast<u32>(m_query_buffer.size())))
 	{
-		// TODO
+		if (m_query_count == m_query_buffer.size())
+			ERROR_LOG(VIDEO, "Flushed query buffer early!");
 		FlushOne();
-		ERROR_LOG(VIDEO, "Flushed query buffer early!");
 	}
 
 	// start query
@@ -14,6 +14,7 @@
 #include "VideoBackends/DX11/VertexShaderCache.h"
 
 #include "VideoCommon/Debugger.h"
+#include "VideoCommon/ShaderPrecompiler.h"
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/VideoConfig.h"
 #include "VideoCommon/HLSLCompiler.h"
@@ -28,9 +29,14 @@ PixelShaderCache::PSCache* PixelShaderCache::s_pixel_shaders;
 const PixelShaderCache::PSCacheEntry* PixelShaderCache::s_last_entry;
 PixelShaderUid PixelShaderCache::s_last_uid;
 PixelShaderUid PixelShaderCache::s_external_last_uid;
+PixelShaderCache::UberPSCache PixelShaderCache::s_uber_shaders;
+const PixelShaderCache::PSCacheEntry* PixelShaderCache::s_last_uber_entry;
+PixelShaderUid PixelShaderCache::s_uber_constants_uid;
+bool PixelShaderCache::s_use_uber_shader = false;
 static HLSLAsyncCompiler *s_compiler;
 static Common::SpinLock<true> s_pixel_shaders_lock;
 static bool s_previous_per_pixel_lighting = false;
+static bool s_uber_constants_valid = false;
 LinearDiskCache<PixelShaderUid, u8> g_ps_disk_cache;
 
 D3D::PixelShaderPtr s_ColorMatrixProgram[2];
@@ -42,6 +48,7 @@ D3D::PixelShaderPtr s_rgba6_to_rgb8[2];
 D3D::PixelShaderPtr s_rgb8_to_rgba6[2];
 
 D3D::ConstantStreamBuffer* pscbuf;
+D3D::ConstantStreamBuffer* uberpscbuf;
 
 const char* clear_program_code = R"hlsl(
 	void main(
@@ -447,6 +454,21 @@ D3D::BufferDescriptor PixelShaderCache::GetConstantBuffer()
 	return pscbuf->GetDescriptor();
 }
 
+D3D::BufferDescriptor PixelShaderCache::GetUberConstantBuffer()
+{
+	// The TEV configuration only changes together with the specialized shader uid
+	if (!s_uber_constants_valid || !(s_uber_constants_uid == s_last_uid))
+	{
+		UberPixelShaderConstants constants;
+		GetUberPixelShaderConstants(constants, s_last_uid.GetUidData());
+		uberpscbuf->AppendData(&constants, sizeof(constants));
+		s_uber_constants_uid = s_last_uid;
+		s_uber_constants_valid = true;
+		ADDSTAT(stats.thisFrame.bytesUniformStreamed, sizeof(constants));
+	}
+	return uberpscbuf->GetDescriptor();
+}
+
 // this class will load the precompiled shaders into our cache
 class PixelShaderCacheInserter : public LinearDiskCacheReader<PixelShaderUid, u8>
 {
@@ -467,6 +489,11 @@ void PixelShaderCache::Init()
 	ID3D11Buffer* buf = pscbuf->GetBuffer();
 	CHECK(buf != nullptr, "Create pixel shader constant buffer");
 	D3D::SetDebugObjectName(buf, "pixel shader constant buffer used to emulate the GX pipeline");
+	cbsize = sizeof(UberPixelShaderConstants) * (use_partial_buffer_update ? 1024 : 1);
+	uberpscbuf = new D3D::ConstantStreamBuffer(cbsize);
+	buf = uberpscbuf->GetBuffer();
+	CHECK(buf != nullptr, "Create pixel ubershader constant buffer");
+	D3D::SetDebugObjectName(buf, "pixel shader constant buffer holding the TEV configuration for the ubershader");
 
 	// used when drawing clear quads
 	s_ClearProgram = D3D::CompileAndCreatePixelShader(clear_program_code);
@@ -515,27 +542,11 @@ void PixelShaderCache::Init()
 	g_ps_disk_cache.OpenAndRead(cache_filename, inserter);
 	if (g_ActiveConfig.bCompileShaderOnStartup)
 	{
-		size_t shader_count = 0;
-		s_pixel_shaders->ForEachMostUsedByCategory(gameid,
-			[&](const PixelShaderUid& it, size_t total)
-		{
-			PixelShaderUid item = it;
-			item.ClearHASH();
-			item.CalculateUIDHash();
-			CompilePShader(item, true);
-			shader_count++;
-			if ((shader_count & 7) == 0)
-			{
-				Host_UpdateTitle(StringFromFormat("Compiling Pixel Shaders %i %% (%i/%i)", (shader_count * 100) / total, shader_count, total));
-				s_compiler->WaitForFinish();
-			}
-		},
-			[](PSCacheEntry& entry)
-		{
-			return !entry.shader;
-		}
-		, true);
-		s_compiler->WaitForFinish();
+		std::vector<PixelShaderUid> uids = ShaderPrecompiler::CollectUids<PixelShaderUid>(*s_pixel_shaders, gameid,
+			[](PSCacheEntry& entry) { return !entry.shader; });
+		const size_t count = uids.size();
+		ShaderPrecompiler::Run({ s_compiler->PrecompileJob("Pixel Shaders", count,
+			[uids = std::move(uids)](size_t index) { CompilePShader(uids[index], false); }) });
 	}
 	s_last_entry = nullptr;
 }
@@ -553,7 +564,15 @@ void PixelShaderCache::Clear()
 		});
 		s_pixel_shaders_lock.unlock();
 	}
+	for (auto& item : s_uber_shaders)
+	{
+		item.second.Destroy();
+	}
+	s_uber_shaders.clear();
 	s_last_entry = nullptr;
+	s_last_uber_entry = nullptr;
+	s_use_uber_shader = false;
+	s_uber_constants_valid = false;
 }
 
 // Used in Swap() when AA mode has changed
@@ -569,6 +588,7 @@ void PixelShaderCache::InvalidateMSAAShaders()
 
 void PixelShaderCache::Shutdown()
 {
+	ShaderPrecompiler::Cancel();
 	if (s_compiler)
 	{
 		s_compiler->WaitForFinish();
@@ -578,6 +598,11 @@ void PixelShaderCache::Shutdown()
 		delete pscbuf;
 	}
 	pscbuf = nullptr;
+	if (uberpscbuf != nullptr)
+	{
+		delete uberpscbuf;
+	}
+	uberpscbuf = nullptr;
 	s_ClearProgram.reset();
 	s_DepthResolveProgram.reset();
 	for (auto & p : s_ColorCopyProgram)
@@ -693,6 +718,7 @@ void PixelShaderCache::PrepareShader(PIXEL_SHADER_RENDER_MODE render_mode,
 bool PixelShaderCache::TestShader()
 {
 	int count = 0;
+	s_use_uber_shader = false;
 	while (!s_last_entry->compiled)
 	{
 		s_compiler->ProcCompilationResults();
@@ -702,7 +728,80 @@ bool PixelShaderCache::TestShader()
 		}
 		Common::cYield(count++);
 	}
-	return s_last_entry->shader != nullptr && s_last_entry->compiled;
+	if (s_last_entry->compiled)
+	{
+		return s_last_entry->shader != nullptr;
+	}
+	// Render with the ubershader instead of skipping the draw while the specialized
+	// shader is still being compiled
+	return g_ActiveConfig.bUberShaderFallback && TestUberShader();
+}
+
+bool PixelShaderCache::TestUberShader()
+{
+	UberPixelShaderUid uid;
+	if (!GetUberPixelShaderUID(uid, s_last_uid.GetUidData()))
+	{
+		return false;
+	}
+	PSCacheEntry* entry = &s_uber_shaders[uid];
+	if (!entry->initialized.test_and_set())
+	{
+		CompileUberShader(uid, entry);
+	}
+	if (!entry->compiled || entry->shader == nullptr)
+	{
+		return false;
+	}
+	s_last_uber_entry = entry;
+	s_use_uber_shader = true;
+	return true;
+}
+
+void PixelShaderCache::CompileUberShader(const UberPixelShaderUid& uid, PSCacheEntry* entry)
+{
+	ShaderCompilerWorkUnit *wunit = s_compiler->NewUnit(UBERPIXELSHADERGEN_BUFFERSIZE);
+	wunit->GenerateCodeHandler = [uid](ShaderCompilerWorkUnit* wunit)
+	{
+		ShaderCode code;
+		code.SetBuffer(wunit->code.data());
+		GenerateUberPixelShaderCodeD3D11(code, uid.GetUidData());
+		wunit->codesize = (u32)code.BufferSize();
+	};
+
+	wunit->entrypoint = "main";
+#if defined(_DEBUG) || defined(DEBUGFAST)
+	wunit->flags = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
+#else
+	wunit->flags = D3DCOMPILE_SKIP_VALIDATION | D3DCOMPILE_OPTIMIZATION_LEVEL3;
+#endif
+	wunit->target = D3D::PixelShaderVersionString();
+	wunit->ResultHandler = [entry](ShaderCompilerWorkUnit* wunit)
+	{
+		if (SUCCEEDED(wunit->cresult))
+		{
+			ID3DBlob* shaderBuffer = wunit->shaderbytecode;
+			entry->shader = std::move(D3D::CreatePixelShaderFromByteCode(shaderBuffer->GetBufferPointer(), (u32)shaderBuffer->GetBufferSize()));
+			if (entry->shader != nullptr)
+			{
+				D3D::SetDebugObjectName(entry->shader.get(), "a pixel ubershader of PixelShaderCache");
+			}
+		}
+		else
+		{
+			// Not fatal, draws are skipped as if the fallback was disabled
+			static int num_failures = 0;
+			std::string filename = StringFromFormat("%sbad_uber_ps_%04i.txt", File::GetUserPath(D_DUMP_IDX).c_str(), num_failures++);
+			std::ofstream file;
+			OpenFStream(file, filename, std::ios_base::out);
+			file << ((const char *)wunit->code.data());
+			file << ((const char *)wunit->error->GetBufferPointer());
+			file.close();
+			ERROR_LOG(VIDEO, "Failed to compile pixel ubershader, see %s", filename.c_str());
+		}
+		entry->compiled = true;
+	};
+	s_compiler->CompileShaderAsync(wunit);
 }
 
 void PixelShaderCache::PushByteCode(const void* bytecode, u32 bytecodelen, PixelShaderCache::PSCacheEntry* entry)
@@ -11,6 +11,7 @@
 
 #include "VideoCommon/ObjectUsageProfiler.h"
 #include "VideoCommon/PixelShaderGen.h"
+#include "VideoCommon/UberShaderPixel.h"
 
 
 namespace DX11
@@ -32,9 +33,14 @@ public:
 
 	static ID3D11PixelShader* GetActiveShader()
 	{
-		return s_last_entry->shader.get();
+		return s_use_uber_shader ? s_last_uber_entry->shader.get() : s_last_entry->shader.get();
+	}
+	static bool UsingUberShader()
+	{
+		return s_use_uber_shader;
 	}
 	static D3D::BufferDescriptor GetConstantBuffer();
+	static D3D::BufferDescriptor GetUberConstantBuffer();
 
 	static ID3D11PixelShader* GetColorMatrixProgram(bool multisampled);
 	static ID3D11PixelShader* GetColorCopyProgram(bool multisampled, bool ssaa = false);
@@ -69,6 +75,14 @@ private:
 	static PixelShaderUid s_last_uid;
 	static PixelShaderUid s_external_last_uid;
 	static void CompilePShader(const PixelShaderUid& uid, bool ongputhread);
+
+	typedef std::unordered_map<UberPixelShaderUid, PSCacheEntry, UberPixelShaderUid::ShaderUidHasher> UberPSCache;
+	static UberPSCache s_uber_shaders;
+	static const PSCacheEntry* s_last_uber_entry;
+	static PixelShaderUid s_uber_constants_uid;
+	static bool s_use_uber_shader;
+	static void CompileUberShader(const UberPixelShaderUid& uid, PSCacheEntry* entry);
+	static bool TestUberShader();
 };
 
 }  // namespace DX11
@@ -17,6 +17,7 @@
 #include "VideoBackends/DX11/Render.h"
 #include "VideoBackends/DX11/VertexShaderCache.h"
 
+#include "VideoCommon/HLSLCompiler.h"
 #include "VideoCommon/OnScreenDisplay.h"
 #include "VideoCommon/Statistics.h"
 
@@ -149,21 +150,35 @@ uintptr_t D3DPostProcessingShader::CreateBindingSampler(const PostProcessingShad
 	return reinterpret_cast<uintptr_t>(sampler);
 }
 
+void D3DPostProcessingShader::PollPassCompilation()
+{
+	HLSLAsyncCompiler::getInstance().ProcCompilationResults();
+}
+
+bool D3DPostProcessingShader::CreatePassShader(RenderPassData& pass, const std::vector<u8>& binary)
+{
+	ID3D11PixelShader* pixel_shader = nullptr;
+	HRESULT hr = D3D::device->CreatePixelShader(binary.data(), binary.size(), nullptr, &pixel_shader);
+	if (FAILED(hr))
+		return false;
+
+	pass.shader = reinterpret_cast<uintptr_t>(pixel_shader);
+	return true;
+}
+
 bool D3DPostProcessingShader::RecompileShaders()
 {
-	static const char *inputs[] = { "0", "1", "2", "3", "4" };
-	static D3D_SHADER_MACRO macros[] = {
-		{ "API_D3D", "1" },
-		{ "HLSL", "1" },
-		{ "COLOR_BUFFER_INPUT_INDEX", 0 },
-		{ "DEPTH_BUFFER_INPUT_INDEX", 0 },
-		{ "PREV_OUTPUT_INPUT_INDEX", 0 },
-		{ nullptr, nullptr }
-	};
+#if defined(_DEBUG) || defined(DEBUGFAST)
+	const u32 flags = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION | D3DCOMPILE_ENABLE_BACKWARDS_COMPATIBILITY;
+#else
+	const u32 flags = D3DCOMPILE_SKIP_VALIDATION | D3DCOMPILE_ENABLE_BACKWARDS_COMPATIBILITY | D3DCOMPILE_OPTIMIZATION_LEVEL3;
+#endif
+	const char* target = D3D::PixelShaderVersionString();
+	HLSLAsyncCompiler& compiler = HLSLAsyncCompiler::getInstance();
+	std::shared_ptr<PassCompilation> compilation = BeginPassCompilation();
 	std::string common_source = PostProcessor::GetCommonFragmentShaderSource(API_D3D11, m_config);
 	for (size_t i = 0; i < m_passes.size(); i++)
 	{
-		RenderPassData& pass = m_passes[i];
 		const PostProcessingShaderConfiguration::RenderPass& pass_config = m_config->GetPass(i);
 
 		int color_buffer_index = 0;
@@ -172,21 +187,41 @@ bool D3DPostProcessingShader::RecompileShaders()
 
 		pass_config.GetInputLocations(color_buffer_index, depth_buffer_index, prev_output_index);
 
-		macros[2].Definition = inputs[color_buffer_index];
-		macros[3].Definition = inputs[depth_buffer_index];
-		macros[4].Definition = inputs[prev_output_index];
+		// The macros are part of the source, it is compiled after this returns
+		std::string hlsl_source = StringFromFormat(
+			"#define API_D3D 1\n#define HLSL 1\n#define COLOR_BUFFER_INPUT_INDEX %d\n"
+			"#define DEPTH_BUFFER_INPUT_INDEX %d\n#define PREV_OUTPUT_INPUT_INDEX %d\n",
+			color_buffer_index, depth_buffer_index, prev_output_index);
+		hlsl_source += common_source;
+		hlsl_source += PostProcessor::GetPassFragmentShaderSource(API_D3D11, m_config, &pass_config);
 
-		std::string hlsl_source = PostProcessor::GetPassFragmentShaderSource(API_D3D11, m_config, &pass_config);
-		ReleasePassNativeResources(pass);
-		ID3D11PixelShader* ptr = D3D::CompileAndCreatePixelShaderPtr(common_source + hlsl_source, macros, "passmain");
-		pass.shader = reinterpret_cast<uintptr_t>(ptr);
-		if (!pass.shader)
+		u64 key = PostProcessor::GetShaderBinaryKey(hlsl_source, target, flags);
+		if (PostProcessor::FindShaderBinary(key, &compilation->binaries[i]))
+			continue;
+
+		ShaderCompilerWorkUnit* wunit = compiler.NewUnit(static_cast<u32>(hlsl_source.size()));
+		memcpy(wunit->code.data(), hlsl_source.data(), hlsl_source.size());
+		wunit->entrypoint = "passmain";
+		wunit->flags = flags;
+		wunit->target = target;
+		wunit->ResultHandler = [compilation, i, key](ShaderCompilerWorkUnit* wunit)
 		{
-			ReleasePassNativeResources(pass);
-			ERROR_LOG(VIDEO, "Failed to compile post-processing shader %s (pass %s)", m_config->GetShaderName().c_str(), pass_config.entry_point.c_str());
-			m_ready = false;
-			return false;
-		}
+			compilation->remaining--;
+			if (FAILED(wunit->cresult))
+			{
+				if (wunit->error)
+					ERROR_LOG(VIDEO, "%s", static_cast<const char*>(wunit->error->GetBufferPointer()));
+				compilation->failed = true;
+				return;
+			}
+
+			const u8* bytecode = static_cast<const u8*>(wunit->shaderbytecode->GetBufferPointer());
+			u32 bytecode_size = static_cast<u32>(wunit->shaderbytecode->GetBufferSize());
+			compilation->binaries[i].assign(bytecode, bytecode + bytecode_size);
+			PostProcessor::StoreShaderBinary(key, bytecode, bytecode_size);
+		};
+		compilation->remaining++;
+		compiler.CompileShaderAsync(wunit);
 	}
 	return true;
 }
@@ -348,6 +383,7 @@ void D3DPostProcessingShader::Draw(PostProcessor* p,
 
 D3DPostProcessor::~D3DPostProcessor()
 {
+	CloseShaderBinaryCache();
 }
 
 bool D3DPostProcessor::Initialize()
@@ -360,6 +396,8 @@ bool D3DPostProcessor::Initialize()
 	if (!CreateUniformBuffer())
 		return false;
 
+	OpenShaderBinaryCache(StringFromFormat("%sIDX11-postprocessing-ps.cache", File::GetUserPath(D_SHADERCACHE_IDX).c_str()));
+
 	// Load the currently-configured shader (this may fail, and that's okay)
 	ReloadShaders();
 	return true;
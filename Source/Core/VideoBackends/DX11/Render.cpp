@@ -37,6 +37,7 @@
 #include "VideoCommon/AVIDump.h"
 #include "VideoCommon/BPFunctions.h"
 #include "VideoCommon/Fifo.h"
+#include "VideoCommon/GPUProfilerBase.h"
 #include "VideoCommon/OnScreenDisplay.h"
 #include "VideoCommon/PixelEngine.h"
 #include "VideoCommon/PixelShaderManager.h"
@@ -58,9 +59,30 @@ D3D::BlendStatePtr resetblendstate;
 D3D::DepthStencilStatePtr resetdepthstate;
 D3D::RasterizerStatePtr resetraststate;
 
-static D3D::Texture2dPtr s_screenshot_texture;
+// Frame dumps are read back FRAME_DUMP_BUFFERED_FRAMES - 1 frames late, so mapping the staging
+// texture doesn't wait for the GPU to finish the frame.
+static const size_t FRAME_DUMP_BUFFERED_FRAMES = 2;
+struct FrameDumpTexture
+{
+	D3D::Texture2dPtr texture;
+	unsigned int width = 0;
+	unsigned int height = 0;
+	AVIDump::Frame state;
+	bool pending = false;
+};
+static std::array<FrameDumpTexture, FRAME_DUMP_BUFFERED_FRAMES> s_frame_dump_textures;
+static size_t s_current_frame_dump_texture = 0;
 static D3DTexture2D* s_3d_vision_texture = nullptr;
 
+static void ResetFrameDumpTextures()
+{
+	for (FrameDumpTexture& frame : s_frame_dump_textures)
+	{
+		frame.texture.reset();
+		frame.pending = false;
+	}
+}
+
 // Nvidia stereo blitting struct defined in "nvstereo.h" from the Nvidia SDK
 typedef struct _Nv_Stereo_Image_Header
 {
@@ -156,7 +178,7 @@ static void SetupDeviceObjects()
 	CHECK(hr == S_OK, "Create rasterizer state for Renderer::ResetAPIState");
 	D3D::SetDebugObjectName(resetraststate.get(), "rasterizer state for Renderer::ResetAPIState");
 
-	s_screenshot_texture.reset();
+	ResetFrameDumpTextures();
 }
 
 // Kill off all device objects
@@ -174,21 +196,21 @@ static void TeardownDeviceObjects()
 	resetblendstate.reset();
 	resetdepthstate.reset();
 	resetraststate.reset();
-	s_screenshot_texture.reset();
+	ResetFrameDumpTextures();
 	SAFE_RELEASE(s_3d_vision_texture);
 	s_television.Shutdown();
 
 	gx_state_cache.Clear();
 }
 
-static void CreateScreenshotTexture()
+static void CreateScreenshotTexture(D3D::Texture2dPtr& texture)
 {
 	// We can't render anything outside of the backbuffer anyway, so use the backbuffer size as the screenshot buffer size.
 	// This texture is released to be recreated when the window is resized in Renderer::SwapImpl.
 	D3D11_TEXTURE2D_DESC scrtex_desc = CD3D11_TEXTURE2D_DESC(DXGI_FORMAT_R8G8B8A8_UNORM, D3D::GetBackBufferWidth(), D3D::GetBackBufferHeight(), 1, 1, 0, D3D11_USAGE_STAGING, D3D11_CPU_ACCESS_READ | D3D11_CPU_ACCESS_WRITE);
-	HRESULT hr = D3D::device->CreateTexture2D(&scrtex_desc, nullptr, D3D::ToAddr(s_screenshot_texture));
+	HRESULT hr = D3D::device->CreateTexture2D(&scrtex_desc, nullptr, D3D::ToAddr(texture));
 	CHECK(hr == S_OK, "Create screenshot staging texture");
-	D3D::SetDebugObjectName(s_screenshot_texture.get(), "staging screenshot texture");
+	D3D::SetDebugObjectName(texture.get(), "staging screenshot texture");
 }
 
 static D3D11_BOX GetScreenshotSourceBox(const TargetRectangle& targetRc)
@@ -282,6 +304,7 @@ Renderer::Renderer(void *&window_handle)
 
 Renderer::~Renderer()
 {
+	FlushFrameDump();
 	m_post_processor.reset();
 	TeardownDeviceObjects();
 	D3D::EndFrame();
@@ -643,6 +666,7 @@ void Renderer::SwapImpl(u32 xfbAddr, u32 fbWidth, u32 fbStride, u32 fbHeight, co
 	}
 
 	ResetAPIState();
+	SetGPUPass(GPU_PASS_PRESENT);
 
 	// Prepare to copy the XFBs to our backbuffer
 	UpdateDrawRectangle(s_backbuffer_width, s_backbuffer_height);
@@ -708,6 +732,7 @@ void Renderer::SwapImpl(u32 xfbAddr, u32 fbWidth, u32 fbStride, u32 fbHeight, co
 		}
 		else
 		{
+			SetGPUPass(GPU_PASS_POST_PROCESSING);
 			m_post_processor->OnEndFrame();
 			TargetRectangle blit_rect = Renderer::ConvertEFBRectangle(rc);
 			TargetSize blit_size(s_target_width, s_target_height);
@@ -737,6 +762,7 @@ void Renderer::SwapImpl(u32 xfbAddr, u32 fbWidth, u32 fbStride, u32 fbHeight, co
 			{
 				blit_depth_tex = FramebufferManager::GetResolvedEFBDepthTexture();
 			}
+			SetGPUPass(GPU_PASS_PRESENT);
 			BlitScreen(targetRc, blit_rect, blit_size, blit_tex, blit_depth_tex, Gamma);
 		}
 		D3D11_VIEWPORT vp = CD3D11_VIEWPORT((float)targetRc.left, (float)targetRc.top, (float)targetRc.GetWidth(), (float)targetRc.GetHeight());
@@ -746,24 +772,18 @@ void Renderer::SwapImpl(u32 xfbAddr, u32 fbWidth, u32 fbStride, u32 fbHeight, co
 	// Dump frames
 	if (IsFrameDumping())
 	{
-		if (!s_screenshot_texture)
-			CreateScreenshotTexture();
-
-		D3D11_BOX source_box = GetScreenshotSourceBox(targetRc);
-		unsigned int source_width = source_box.right - source_box.left;
-		unsigned int source_height = source_box.bottom - source_box.top;
-		D3D::context->CopySubresourceRegion(s_screenshot_texture.get(), 0, 0, 0, 0, (ID3D11Resource*)D3D::GetBackBuffer()->GetTex(), 0, &source_box);
-		D3D11_MAPPED_SUBRESOURCE map;
-		D3D::context->Map(s_screenshot_texture.get(), 0, D3D11_MAP_READ, 0, &map);
-		AVIDump::Frame state = AVIDump::FetchState(ticks);
-		DumpFrameData(reinterpret_cast<const u8*>(map.pData), source_width, source_height,
-			map.RowPitch, state);
-		FinishFrameData();
-		D3D::context->Unmap(s_screenshot_texture.get(), 0);
+		DumpFrame(targetRc, ticks);
+	}
+	else
+	{
+		// Frames still in flight when dumping stops are dropped
+		for (FrameDumpTexture& frame : s_frame_dump_textures)
+			frame.pending = false;
 	}
 
 	Renderer::DrawDebugText();
 	OSD::DrawMessages();
+	g_gpu_profiler->EndFrame();
 	D3D::EndFrame();
 
 	TextureCacheBase::Cleanup(frameCount);
@@ -806,8 +826,9 @@ void Renderer::SwapImpl(u32 xfbAddr, u32 fbWidth, u32 fbStride, u32 fbHeight, co
 		if (windowResized)
 		{
 			// TODO: Aren't we still holding a reference to the back buffer right now?
+			FlushFrameDump();
 			D3D::Reset();
-			s_screenshot_texture.reset();
+			ResetFrameDumpTextures();
 			SAFE_RELEASE(s_3d_vision_texture);
 			s_backbuffer_width = D3D::GetBackBufferWidth();
 			s_backbuffer_height = D3D::GetBackBufferHeight();
@@ -839,6 +860,51 @@ void Renderer::SwapImpl(u32 xfbAddr, u32 fbWidth, u32 fbStride, u32 fbHeight, co
 	// if the configuration has changed, reload post processor (can fail, which will deactivate it)
 	if (m_post_processor->RequiresReload())
 		m_post_processor->ReloadShaders();
+	if (m_post_processor->PendingShadersReady())
+		m_post_processor->ActivatePendingShaders();
+}
+
+void Renderer::DumpFrame(const TargetRectangle& target_rc, u64 ticks)
+{
+	// Reuse the oldest texture, its frame has to be written first
+	s_current_frame_dump_texture = (s_current_frame_dump_texture + 1) % FRAME_DUMP_BUFFERED_FRAMES;
+	FrameDumpTexture& frame = s_frame_dump_textures[s_current_frame_dump_texture];
+	if (frame.pending)
+		WriteFrameDumpTexture(s_current_frame_dump_texture);
+
+	if (!frame.texture)
+		CreateScreenshotTexture(frame.texture);
+
+	D3D11_BOX source_box = GetScreenshotSourceBox(target_rc);
+	frame.width = source_box.right - source_box.left;
+	frame.height = source_box.bottom - source_box.top;
+	D3D::context->CopySubresourceRegion(frame.texture.get(), 0, 0, 0, 0, (ID3D11Resource*)D3D::GetBackBuffer()->GetTex(), 0, &source_box);
+	frame.state = AVIDump::FetchState(ticks);
+	frame.pending = true;
+}
+
+void Renderer::WriteFrameDumpTexture(size_t index)
+{
+	FrameDumpTexture& frame = s_frame_dump_textures[index];
+	D3D11_MAPPED_SUBRESOURCE map;
+	if (SUCCEEDED(D3D::context->Map(frame.texture.get(), 0, D3D11_MAP_READ, 0, &map)))
+	{
+		DumpFrameData(reinterpret_cast<const u8*>(map.pData), frame.width, frame.height,
+			map.RowPitch, frame.state);
+		D3D::context->Unmap(frame.texture.get(), 0);
+	}
+	frame.pending = false;
+}
+
+void Renderer::FlushFrameDump()
+{
+	// Oldest first
+	for (size_t i = 1; i <= FRAME_DUMP_BUFFERED_FRAMES; i++)
+	{
+		const size_t index = (s_current_frame_dump_texture + i) % FRAME_DUMP_BUFFERED_FRAMES;
+		if (s_frame_dump_textures[index].pending)
+			WriteFrameDumpTexture(index);
+	}
 }
 
 // ALWAYS call RestoreAPIState for each ResetAPIState call you're doing
@@ -894,7 +960,16 @@ void Renderer::ApplyState(bool bUseDstAlpha)
 		D3D::stateman->SetHullDomainConstants(2, pbuffer);
 	}
 	D3D::stateman->SetPixelConstants(0, pbuffer);
-	D3D::stateman->SetPixelConstants(1, vbuffer);
+	if (PixelShaderCache::UsingUberShader())
+	{
+		// The ubershader never uses per pixel lighting, the VSBlock slot holds the TEV configuration instead
+		D3D::BufferDescriptor uberbuffer = PixelShaderCache::GetUberConstantBuffer();
+		D3D::stateman->SetPixelConstants(1, uberbuffer);
+	}
+	else
+	{
+		D3D::stateman->SetPixelConstants(1, vbuffer);
+	}
 
 	D3D::stateman->SetVertexShader(VertexShaderCache::GetActiveShader());
 	D3D::stateman->SetGeometryShader(geometry_shader);
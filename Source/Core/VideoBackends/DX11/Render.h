@@ -14,6 +14,9 @@ class Renderer : public ::Renderer
 {
 private:
 	void BlitScreen(TargetRectangle dst_rect, TargetRectangle src_rect, TargetSize src_size, D3DTexture2D* src_texture, D3DTexture2D* depth_texture, float Gamma);
+	void DumpFrame(const TargetRectangle& target_rc, u64 ticks);
+	void WriteFrameDumpTexture(size_t index);
+	void FlushFrameDump();
 public:
 	Renderer(void *&window_handle);
 	~Renderer();
@@ -88,7 +88,8 @@ bool TextureCache::TCacheEntry::Save(const std::string& filename, u32 level)
 	}
 	else
 	{
-		encode_result = TextureToPng(reinterpret_cast<u8*>(map.pData), map.RowPitch, filename, mip_width, mip_height);
+		TextureToPngAsync(reinterpret_cast<u8*>(map.pData), map.RowPitch, filename, mip_width, mip_height);
+		encode_result = true;
 	}
 	D3D::context->Unmap(staging_texture, 0);
 	staging_texture->Release();
@@ -304,7 +305,7 @@ PC_TexFormat TextureCache::GetNativeTextureFormat(const s32 texformat, const Tlu
 
 TextureCache::TCacheEntryBase* TextureCache::CreateTexture(const TCacheEntryConfig& config)
 {
-	static const DXGI_FORMAT PC_TexFormat_To_DXGIFORMAT[12]
+	static const DXGI_FORMAT PC_TexFormat_To_DXGIFORMAT[14]
 	{
 		DXGI_FORMAT_UNKNOWN,//PC_TEX_FMT_NONE
 		DXGI_FORMAT_B8G8R8A8_UNORM,//PC_TEX_FMT_BGRA32
@@ -318,6 +319,8 @@ TextureCache::TCacheEntryBase* TextureCache::CreateTexture(const TCacheEntryConf
 		DXGI_FORMAT_BC2_UNORM,//PC_TEX_FMT_DXT3
 		DXGI_FORMAT_BC3_UNORM,//PC_TEX_FMT_DXT5
 		DXGI_FORMAT_R32_FLOAT,//PC_TEX_FMT_R32
+		DXGI_FORMAT_BC5_UNORM,//PC_TEX_FMT_BC5
+		DXGI_FORMAT_BC7_UNORM,//PC_TEX_FMT_BC7
 	};
 	if (config.rendertarget)
 	{
@@ -347,7 +350,9 @@ TextureCache::TCacheEntryBase* TextureCache::CreateTexture(const TCacheEntryConf
 	}
 	bool compressed = format == DXGI_FORMAT_BC1_UNORM
 		|| format == DXGI_FORMAT_BC2_UNORM
-		|| format == DXGI_FORMAT_BC3_UNORM;
+		|| format == DXGI_FORMAT_BC3_UNORM
+		|| format == DXGI_FORMAT_BC5_UNORM
+		|| format == DXGI_FORMAT_BC7_UNORM;
 	D3D11_USAGE usage = D3D11_USAGE_DEFAULT;
 	D3D11_CPU_ACCESS_FLAG cpu_access = (D3D11_CPU_ACCESS_FLAG)0;
 
@@ -77,7 +77,7 @@ void VertexManager::PrepareDrawBuffers(u32 stride)
 {
 	D3D11_MAPPED_SUBRESOURCE map;
 	u32 vertexBufferSize = u32(s_pCurBufferPointer - s_pBaseBufferPointer);
-	u32 indexBufferSize = IndexGenerator::GetIndexLen() * sizeof(u16);
+	u32 indexBufferSize = IndexGenerator::GetIndexLen() * IndexGenerator::GetIndexSize();
 	u32 totalBufferSize = vertexBufferSize + indexBufferSize;
 
 	u32 cursor = m_bufferCursor;
@@ -117,7 +117,7 @@ void VertexManager::Draw(UINT stride)
 	D3D::stateman->SetIndexBuffer(m_buffers[m_currentBuffer].get());
 
 	u32 baseVertex = m_vertexDrawOffset / stride;
-	u32 startIndex = m_indexDrawOffset / sizeof(u16);
+	u32 startIndex = m_indexDrawOffset / IndexGenerator::GetIndexSize();
 
 	if (current_primitive_type == PRIMITIVE_TRIANGLES)
 	{
@@ -25,10 +25,6 @@ public:
 		bool fromgputhread = true);
 protected:
 	void ResetBuffer(u32 stride) override;
-	u16* GetIndexBuffer() override
-	{
-		return m_index_buffer_start;
-	}
 private:
 
 	void PrepareDrawBuffers(u32 stride);
@@ -48,8 +44,9 @@ private:
 	D3D::BufferPtr m_buffers[MAX_BUFFER_COUNT];
 
 	std::vector<u8, Common::aligned_allocator<u8, 256>> LocalVBuffer;
-	std::vector<u16, Common::aligned_allocator<u16, 256>> LocalIBuffer;
-	u16* m_index_buffer_start;
+	// 32 bit indices, see IndexGenerator::Uses32BitIndices
+	std::vector<u32, Common::aligned_allocator<u32, 256>> LocalIBuffer;
+	u32* m_index_buffer_start;
 };
 
 }  // namespace
\ No newline at end of file
@@ -11,6 +11,7 @@
 
 #include "VideoCommon/Debugger.h"
 #include "VideoCommon/HLSLCompiler.h"
+#include "VideoCommon/ShaderPrecompiler.h"
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/VertexShaderGen.h"
 #include "VideoCommon/VertexShaderManager.h"
@@ -179,27 +180,11 @@ void VertexShaderCache::Init()
 	g_vs_disk_cache.OpenAndRead(cache_filename, inserter);
 	if (g_ActiveConfig.bCompileShaderOnStartup)
 	{
-		size_t shader_count = 0;
-		s_vshaders->ForEachMostUsedByCategory(gameid,
-			[&](const VertexShaderUid& it, size_t total)
-		{
-			VertexShaderUid item = it;
-			item.ClearHASH();
-			item.CalculateUIDHash();
-			CompileVShader(item, true);
-			shader_count++;
-			if ((shader_count & 7) == 0)
-			{
-				Host_UpdateTitle(StringFromFormat("Compiling Vertex Shaders %i %% (%i/%i)", (shader_count * 100) / total, shader_count, total));
-				s_compiler->WaitForFinish();
-			}
-		},
-			[](VSCacheEntry& entry)
-		{
-			return !entry.shader;
-		}
-		, true);
-		s_compiler->WaitForFinish();
+		std::vector<VertexShaderUid> uids = ShaderPrecompiler::CollectUids<VertexShaderUid>(*s_vshaders, gameid,
+			[](VSCacheEntry& entry) { return !entry.shader; });
+		const size_t count = uids.size();
+		ShaderPrecompiler::Run({ s_compiler->PrecompileJob("Vertex Shaders", count,
+			[uids = std::move(uids)](size_t index) { CompileVShader(uids[index], false); }) });
 	}
 	s_last_entry = nullptr;
 }
@@ -221,6 +206,7 @@ void VertexShaderCache::Clear()
 
 void VertexShaderCache::Shutdown()
 {
+	ShaderPrecompiler::Cancel();
 	if (s_compiler)
 	{
 		s_compiler->WaitForFinish();
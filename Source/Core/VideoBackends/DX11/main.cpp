@@ -32,6 +32,7 @@
 #include "VideoBackends/DX11/D3DUtil.h"
 #include "VideoBackends/DX11/D3DBase.h"
 #include "VideoBackends/DX11/GeometryShaderCache.h"
+#include "VideoBackends/DX11/GPUProfiler.h"
 #include "VideoBackends/DX11/HullDomainShaderCache.h"
 #include "VideoBackends/DX11/PerfQuery.h"
 #include "VideoBackends/DX11/PixelShaderCache.h"
@@ -90,6 +91,7 @@ void VideoBackend::InitBackendInfo()
 	g_Config.backend_info.bSupportedFormats[PC_TEX_FMT_DXT1] = true;
 	g_Config.backend_info.bSupportedFormats[PC_TEX_FMT_DXT3] = true;
 	g_Config.backend_info.bSupportedFormats[PC_TEX_FMT_DXT5] = true;
+	g_Config.backend_info.bSupportedFormats[PC_TEX_FMT_BC5] = true;
 
 	g_Config.backend_info.bSupportsScaling = false;
 	g_Config.backend_info.bSupportsExclusiveFullscreen = true;
@@ -100,11 +102,16 @@ void VideoBackend::InitBackendInfo()
 	g_Config.backend_info.bSupportsGeometryShaders = true;
 	g_Config.backend_info.bSupports3DVision = true;
 	g_Config.backend_info.bSupportsPostProcessing = true;
+	g_Config.backend_info.bSupportsPostProcessingCompute = false;
 	g_Config.backend_info.bSupportsClipControl = true;
 	g_Config.backend_info.bSupportsNormalMaps = true;
 	g_Config.backend_info.bSupportsDepthClamp = true;
 	g_Config.backend_info.bSupportsMultithreading = false;
 	g_Config.backend_info.bSupportsReversedDepthRange = true;
+	g_Config.backend_info.bSupportsPrimitiveRestart = false;
+	g_Config.backend_info.bSupports32BitIndices = true;
+	g_Config.backend_info.bSupportsDeferredEFBCopies = false;
+	g_Config.backend_info.bSupportsVirtualXFBWriteBack = false;
 	IDXGIFactory* factory;
 	IDXGIAdapter* ad;
 	hr = DX11::PCreateDXGIFactory(__uuidof(IDXGIFactory), (void**)&factory);
@@ -142,6 +149,7 @@ void VideoBackend::InitBackendInfo()
 			g_Config.backend_info.bSupportsTessellation = shader_model_5_supported;
 			g_Config.backend_info.bSupportsSSAA = shader_model_5_supported;
 			g_Config.backend_info.bSupportsComputeTextureDecoding = shader_model_5_supported;
+			g_Config.backend_info.bSupportedFormats[PC_TEX_FMT_BC7] = shader_model_5_supported;
 			g_Config.backend_info.bSupportsComputeTextureEncoding = shader_model_5_supported;
 		}
 
@@ -172,6 +180,7 @@ void VideoBackend::Video_Prepare()
 	g_texture_cache = std::make_unique<TextureCache>();
 	g_vertex_manager = std::make_unique<VertexManager>();
 	g_perf_query = std::make_unique<PerfQuery>();
+	g_gpu_profiler = std::make_unique<GPUProfiler>();
 	VertexShaderCache::Init();
 	PixelShaderCache::Init();
 	GeometryShaderCache::Init();
@@ -190,6 +199,7 @@ void VideoBackend::Shutdown()
 	VertexShaderCache::Shutdown();
 	BBox::Shutdown();
 
+	g_gpu_profiler.reset();
 	g_perf_query.reset();
 	g_vertex_manager.reset();
 	g_texture_cache.reset();
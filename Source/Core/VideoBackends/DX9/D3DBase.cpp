@@ -2,6 +2,9 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <iterator>
+
 #include "Common/StringUtil.h"
 #include "VideoBackends/DX9/D3DBase.h"
 #include "VideoBackends/DX9/Render.h"
@@ -66,35 +69,100 @@ const int MaxRenderStates = 210 + 46;
 const int MaxTextureTypes = 33;
 const int MaxSamplerSize = 13;
 const int MaxSamplerTypes = 15;
-static std::vector<bool> m_RenderStatesSet(MaxRenderStates);
-static std::vector<DWORD> m_RenderStates(MaxRenderStates);
-static std::vector<bool> m_RenderStatesChanged(MaxRenderStates);
 
-static std::vector<DWORD> m_TextureStageStates(MaxTextureStages * MaxTextureTypes);
-static std::vector<bool> m_TextureStageStatesSet(MaxTextureStages * MaxTextureTypes);
-static std::vector<bool> m_TextureStageStatesChanged(MaxTextureStages * MaxTextureTypes);
+// The value Set asked for, which Refresh restores after a temporary Change, next to the value the
+// device holds. Every call is filtered against the device value, so changing a state back and
+// forth or setting what a change already left there doesn't reach the runtime.
+template <typename T>
+struct CachedState
+{
+	T value;
+	T current;
+	// value holds something
+	bool set;
+	// current matches the device
+	bool known;
+
+	void Reset()
+	{
+		value = T();
+		current = T();
+		set = false;
+		known = false;
+	}
+
+	template <typename Apply>
+	void Set(T new_value, Apply apply)
+	{
+		value = new_value;
+		set = true;
+		Change(new_value, apply);
+	}
+
+	template <typename Apply>
+	void Change(T new_value, Apply apply)
+	{
+		if (!set)
+		{
+			value = new_value;
+			set = true;
+		}
+		if (!known || current != new_value)
+		{
+			apply(new_value);
+			current = new_value;
+			known = true;
+		}
+	}
+
+	template <typename Apply>
+	void Refresh(Apply apply)
+	{
+		if (set)
+			Change(value, apply);
+	}
+};
 
-static std::vector<DWORD> m_SamplerStates(MaxSamplerSize * MaxSamplerTypes);
-static std::vector<bool> m_SamplerStatesSet(MaxSamplerSize * MaxSamplerTypes);
-static std::vector<bool> m_SamplerStatesChanged(MaxSamplerSize * MaxSamplerTypes);
+static CachedState<DWORD> m_RenderStates[MaxRenderStates];
+static CachedState<DWORD> m_TextureStageStates[MaxTextureStages * MaxTextureTypes];
+static CachedState<DWORD> m_SamplerStates[MaxSamplerSize * MaxSamplerTypes];
 
 static LPDIRECT3DBASETEXTURE9 m_Textures[16];
-static LPDIRECT3DVERTEXDECLARATION9 m_VtxDecl;
-static bool m_VtxDeclChanged;
-static LPDIRECT3DPIXELSHADER9 m_PixelShader;
-static bool m_PixelShaderChanged;
-static LPDIRECT3DVERTEXSHADER9 m_VertexShader;
-static bool m_VertexShaderChanged;
+static CachedState<LPDIRECT3DVERTEXDECLARATION9> m_VtxDecl;
+static CachedState<LPDIRECT3DPIXELSHADER9> m_PixelShader;
+static CachedState<LPDIRECT3DVERTEXSHADER9> m_VertexShader;
 struct StreamSourceDescriptor
 {
 	LPDIRECT3DVERTEXBUFFER9 pStreamData;
 	UINT OffsetInBytes;
 	UINT Stride;
+
+	bool operator!=(const StreamSourceDescriptor& other) const
+	{
+		return pStreamData != other.pStreamData || OffsetInBytes != other.OffsetInBytes ||
+			Stride != other.Stride;
+	}
 };
-static StreamSourceDescriptor m_stream_sources[MaxStreamSources];
-static std::vector<bool> m_stream_sources_Changed(MaxStreamSources);
-static LPDIRECT3DINDEXBUFFER9 m_index_buffer;
-static bool m_index_buffer_Changed;
+static CachedState<StreamSourceDescriptor> m_stream_sources[MaxStreamSources];
+static CachedState<LPDIRECT3DINDEXBUFFER9> m_index_buffer;
+
+// Forgets the device values, the next call of each state reaches the device
+static void ResetStateCache()
+{
+	memset(m_Textures, 0, sizeof(m_Textures));
+	for (auto& state : m_RenderStates)
+		state.Reset();
+	for (auto& state : m_TextureStageStates)
+		state.Reset();
+	for (auto& state : m_SamplerStates)
+		state.Reset();
+	m_VtxDecl.Reset();
+	m_PixelShader.Reset();
+	m_VertexShader.Reset();
+	for (auto& state : m_stream_sources)
+		state.Reset();
+	m_index_buffer.Reset();
+}
 
 // Z buffer formats to be used for EFB depth surface
 D3DFORMAT DepthFormats[] = {
@@ -492,28 +560,10 @@ HRESULT Create(int adapter, HWND wnd, int _resolution, int aa_mode, bool auto_de
 	dev->GetRenderTarget(0, &back_buffer);
 	if (dev->GetDepthStencilSurface(&back_buffer_z) == D3DERR_NOTFOUND)
 		back_buffer_z = nullptr;
+	ResetStateCache();
 	SetRenderState(D3DRS_ZENABLE, D3DZB_TRUE);
 	SetRenderState(D3DRS_FILLMODE, g_Config.bWireFrame ? D3DFILL_WIREFRAME : D3DFILL_SOLID);
-	memset(m_Textures, 0, sizeof(m_Textures));
-	m_TextureStageStatesSet.assign(MaxTextureStages * MaxTextureTypes, false);
-	m_TextureStageStatesChanged.assign(MaxTextureStages * MaxTextureTypes, false);
-	m_RenderStates.assign(MaxRenderStates, 0);
-	m_RenderStatesSet.assign(MaxRenderStates, false);
-	m_RenderStatesChanged.assign(MaxRenderStates, false);
-	m_SamplerStatesSet.assign(MaxSamplerSize * MaxSamplerTypes, false);
-	m_SamplerStatesChanged.assign(MaxSamplerSize * MaxSamplerTypes, false);
-	m_VtxDecl = nullptr;
-	m_PixelShader = nullptr;
-	m_VertexShader = nullptr;
-	m_index_buffer = nullptr;
-	memset(m_stream_sources, 0, sizeof(m_stream_sources));
-	m_index_buffer = nullptr;
-
-	m_VtxDeclChanged = false;
-	m_PixelShaderChanged = false;
-	m_VertexShaderChanged = false;
-	m_stream_sources_Changed.assign(MaxStreamSources, false);
-	m_index_buffer_Changed = false;
+
 	g_Config.backend_info.bSupportedFormats[PC_TEX_FMT_BGRA32] = true;
 	g_Config.backend_info.bSupportedFormats[PC_TEX_FMT_RGBA32] = false;
 	const bool alpha_luminiscente_supported = CheckTextureSupport(0, D3DFMT_A8L8);
@@ -729,37 +779,29 @@ void Present()
 
 void ApplyCachedState()
 {
+	// Only the render and sampler states are restored after a reset, we don't bother with the others
+	// so let's just wipe their state copy so no stale state is around.
+	CachedState<DWORD> render_states[MaxRenderStates];
+	CachedState<DWORD> sampler_states[MaxSamplerSize * MaxSamplerTypes];
+	std::copy(std::begin(m_RenderStates), std::end(m_RenderStates), render_states);
+	std::copy(std::begin(m_SamplerStates), std::end(m_SamplerStates), sampler_states);
+	ResetStateCache();
+
 	for (int sampler = 0; sampler < 8; sampler++)
 	{
-		for (int type = 0; type < MaxSamplerTypes; type++)
+		for (int type = D3DSAMP_ADDRESSU; type <= D3DSAMP_DMAPOFFSET; type++)
 		{
-			u32 index = sampler * MaxSamplerSize + type;
-			if (m_SamplerStatesSet[index])
-				dev->SetSamplerState(sampler, (D3DSAMPLERSTATETYPE)type, m_SamplerStates[index]);
+			const CachedState<DWORD>& state = sampler_states[sampler * MaxSamplerSize + type];
+			if (state.set)
+				SetSamplerState(sampler, (D3DSAMPLERSTATETYPE)type, state.value);
 		}
 	}
 
 	for (int rs = 0; rs < MaxRenderStates; rs++)
 	{
-		if (m_RenderStatesSet[rs])
-			dev->SetRenderState((D3DRENDERSTATETYPE)rs, m_RenderStates[rs]);
+		if (render_states[rs].set)
+			SetRenderState((D3DRENDERSTATETYPE)rs, render_states[rs].value);
 	}
-
-	// We don't bother restoring these so let's just wipe the state copy
-	// so no stale state is around.
-	memset(m_Textures, 0, sizeof(m_Textures));
-	m_TextureStageStatesSet.assign(MaxTextureStages * MaxTextureTypes, false);
-	m_TextureStageStatesChanged.assign(MaxTextureStages * MaxTextureTypes, false);
-	m_VtxDecl = nullptr;
-	m_PixelShader = nullptr;
-	m_VertexShader = nullptr;
-	memset(m_stream_sources, 0, sizeof(m_stream_sources));
-	m_index_buffer = nullptr;
-	m_VtxDeclChanged = false;
-	m_PixelShaderChanged = false;
-	m_VertexShaderChanged = false;
-	m_stream_sources_Changed.assign(MaxStreamSources, false);
-	m_index_buffer_Changed = false;
 }
 
 void SetTexture(DWORD Stage, LPDIRECT3DBASETEXTURE9 pTexture)
@@ -773,257 +815,171 @@ void SetTexture(DWORD Stage, LPDIRECT3DBASETEXTURE9 pTexture)
 
 void RefreshRenderState(D3DRENDERSTATETYPE State)
 {
-	if (m_RenderStatesSet[State] && m_RenderStatesChanged[State])
-	{
-		dev->SetRenderState(State, m_RenderStates[State]);
-		m_RenderStatesChanged[State] = false;
-	}
+	m_RenderStates[State].Refresh([State](DWORD value) { dev->SetRenderState(State, value); });
 }
 
 void SetRenderState(D3DRENDERSTATETYPE State, DWORD Value)
 {
-	if (m_RenderStates[State] != Value || !m_RenderStatesSet[State] || m_RenderStatesChanged[State])
-	{
-		m_RenderStates[State] = Value;
-		m_RenderStatesSet[State] = true;
-		m_RenderStatesChanged[State] = false;
-		dev->SetRenderState(State, Value);
-	}
+	m_RenderStates[State].Set(Value, [State](DWORD value) { dev->SetRenderState(State, value); });
 }
 
 void ChangeRenderState(D3DRENDERSTATETYPE State, DWORD Value)
 {
-	if (!m_RenderStatesSet[State] || m_RenderStates[State] != Value || m_RenderStatesChanged[State])
-	{
-		if (!m_RenderStatesSet[State])
-		{
-			m_RenderStates[State] = Value;
-			m_RenderStatesSet[State] = true;
-		}
-		m_RenderStatesChanged[State] = m_RenderStatesSet[State] && m_RenderStates[State] != Value;
-		dev->SetRenderState(State, Value);
-	}
+	m_RenderStates[State].Change(Value, [State](DWORD value) { dev->SetRenderState(State, value); });
 }
 
 void SetTextureStageState(DWORD Stage, D3DTEXTURESTAGESTATETYPE Type, DWORD Value)
 {
-	u32 index = Stage * MaxTextureStages + Type;
-	if (m_TextureStageStates[index] != Value || !m_TextureStageStatesSet[index] || m_TextureStageStatesChanged[index])
+	m_TextureStageStates[Stage * MaxTextureTypes + Type].Set(Value, [Stage, Type](DWORD value)
 	{
-		m_TextureStageStates[index] = Value;
-		m_TextureStageStatesSet[index] = true;
-		m_TextureStageStatesChanged[index] = false;
-		dev->SetTextureStageState(Stage, Type, Value);
-	}
+		dev->SetTextureStageState(Stage, Type, value);
+	});
 }
 
 void RefreshTextureStageState(DWORD Stage, D3DTEXTURESTAGESTATETYPE Type)
 {
-	u32 index = Stage * MaxTextureStages + Type;
-	if (m_TextureStageStatesSet[index] && m_TextureStageStatesChanged[index])
+	m_TextureStageStates[Stage * MaxTextureTypes + Type].Refresh([Stage, Type](DWORD value)
 	{
-		dev->SetTextureStageState(Stage, Type, m_TextureStageStates[index]);
-		m_TextureStageStatesChanged[index] = false;
-	}
+		dev->SetTextureStageState(Stage, Type, value);
+	});
 }
 
 void ChangeTextureStageState(DWORD Stage, D3DTEXTURESTAGESTATETYPE Type, DWORD Value)
 {
-	u32 index = Stage * MaxTextureStages + Type;
-	if (m_TextureStageStates[index] != Value || !m_TextureStageStatesSet[index] || m_TextureStageStatesChanged[index])
+	m_TextureStageStates[Stage * MaxTextureTypes + Type].Change(Value, [Stage, Type](DWORD value)
 	{
-		if (!m_TextureStageStatesSet[index])
-		{
-			m_TextureStageStates[index] = Value;
-			m_TextureStageStatesSet[index] = true;
-		}
-		m_TextureStageStatesChanged[index] = m_TextureStageStatesSet[index] && m_TextureStageStates[index] != Value;
-		dev->SetTextureStageState(Stage, Type, Value);
-	}
+		dev->SetTextureStageState(Stage, Type, value);
+	});
 }
 
 void SetSamplerState(DWORD Sampler, D3DSAMPLERSTATETYPE Type, DWORD Value)
 {
-	u32 index = Sampler * MaxSamplerSize + Type;
-	if (m_SamplerStates[index] != Value || !m_SamplerStatesSet[index] || m_SamplerStatesChanged[index])
+	m_SamplerStates[Sampler * MaxSamplerSize + Type].Set(Value, [Sampler, Type](DWORD value)
 	{
-		m_SamplerStates[index] = Value;
-		m_SamplerStatesSet[index] = true;
-		m_SamplerStatesChanged[index] = false;
-		dev->SetSamplerState(Sampler, Type, Value);
-	}
+		dev->SetSamplerState(Sampler, Type, value);
+	});
 }
 
 void RefreshSamplerState(DWORD Sampler, D3DSAMPLERSTATETYPE Type)
 {
-	u32 index = Sampler * MaxSamplerSize + Type;
-	if (m_SamplerStatesSet[index] && m_SamplerStatesChanged[index])
+	m_SamplerStates[Sampler * MaxSamplerSize + Type].Refresh([Sampler, Type](DWORD value)
 	{
-		dev->SetSamplerState(Sampler, Type, m_SamplerStates[index]);
-		m_SamplerStatesChanged[index] = false;
-	}
+		dev->SetSamplerState(Sampler, Type, value);
+	});
 }
 
 void ChangeSamplerState(DWORD Sampler, D3DSAMPLERSTATETYPE Type, DWORD Value)
 {
-	u32 index = Sampler * MaxSamplerSize + Type;
-	if (m_SamplerStates[index] != Value || !m_SamplerStatesSet[index] || m_SamplerStatesChanged[index])
+	m_SamplerStates[Sampler * MaxSamplerSize + Type].Change(Value, [Sampler, Type](DWORD value)
 	{
-		if (!m_SamplerStatesSet[index])
-		{
-			m_SamplerStates[index] = Value;
-			m_SamplerStatesSet[index] = true;
-		}
-		m_SamplerStatesChanged[index] = m_SamplerStatesSet[index] && m_SamplerStates[index] != Value;
-		dev->SetSamplerState(Sampler, Type, Value);
-	}
+		dev->SetSamplerState(Sampler, Type, value);
+	});
+}
+
+static void ApplyVertexDeclaration(LPDIRECT3DVERTEXDECLARATION9 decl)
+{
+	dev->SetVertexDeclaration(decl);
 }
 
 void RefreshVertexDeclaration()
 {
-	if (m_VtxDeclChanged)
-	{
-		dev->SetVertexDeclaration(m_VtxDecl);
-		m_VtxDeclChanged = false;
-	}
+	m_VtxDecl.Refresh(ApplyVertexDeclaration);
 }
 
 void SetVertexDeclaration(LPDIRECT3DVERTEXDECLARATION9 decl)
 {
-	if (decl != m_VtxDecl || m_VtxDeclChanged)
-	{
-		dev->SetVertexDeclaration(decl);
-		m_VtxDecl = decl;
-		m_VtxDeclChanged = false;
-	}
+	m_VtxDecl.Set(decl, ApplyVertexDeclaration);
 }
 
 void ChangeVertexDeclaration(LPDIRECT3DVERTEXDECLARATION9 decl)
 {
-	if (decl != m_VtxDecl || m_VtxDeclChanged)
-	{
-		dev->SetVertexDeclaration(decl);
-		m_VtxDeclChanged = true;
-	}
+	m_VtxDecl.Change(decl, ApplyVertexDeclaration);
+}
+
+static void ApplyVertexShader(LPDIRECT3DVERTEXSHADER9 shader)
+{
+	dev->SetVertexShader(shader);
 }
 
 void ChangeVertexShader(LPDIRECT3DVERTEXSHADER9 shader)
 {
-	if (shader != m_VertexShader || m_VertexShaderChanged)
-	{
-		dev->SetVertexShader(shader);
-		m_VertexShaderChanged = true;
-	}
+	m_VertexShader.Change(shader, ApplyVertexShader);
 }
 
 void RefreshVertexShader()
 {
-	if (m_VertexShaderChanged)
-	{
-		dev->SetVertexShader(m_VertexShader);
-		m_VertexShaderChanged = false;
-	}
+	m_VertexShader.Refresh(ApplyVertexShader);
 }
 
 void SetVertexShader(LPDIRECT3DVERTEXSHADER9 shader)
 {
-	if (shader != m_VertexShader || m_VertexShaderChanged)
-	{
-		dev->SetVertexShader(shader);
-		m_VertexShader = shader;
-		m_VertexShaderChanged = false;
-	}
+	m_VertexShader.Set(shader, ApplyVertexShader);
+}
+
+static void ApplyPixelShader(LPDIRECT3DPIXELSHADER9 shader)
+{
+	dev->SetPixelShader(shader);
 }
 
 void RefreshPixelShader()
 {
-	if (m_PixelShaderChanged)
-	{
-		dev->SetPixelShader(m_PixelShader);
-		m_PixelShaderChanged = false;
-	}
+	m_PixelShader.Refresh(ApplyPixelShader);
 }
 
 void SetPixelShader(LPDIRECT3DPIXELSHADER9 shader)
 {
-	if (shader != m_PixelShader || m_PixelShaderChanged)
-	{
-		dev->SetPixelShader(shader);
-		m_PixelShader = shader;
-		m_PixelShaderChanged = false;
-	}
+	m_PixelShader.Set(shader, ApplyPixelShader);
 }
 
 void ChangePixelShader(LPDIRECT3DPIXELSHADER9 shader)
 {
-	dev->SetPixelShader(shader);
-	m_PixelShaderChanged = true;
+	m_PixelShader.Change(shader, ApplyPixelShader);
 }
 
 void SetStreamSource(UINT StreamNumber, IDirect3DVertexBuffer9* pStreamData, UINT OffsetInBytes, UINT Stride)
 {
-	if (m_stream_sources[StreamNumber].OffsetInBytes != OffsetInBytes
-		|| m_stream_sources[StreamNumber].pStreamData != pStreamData
-		|| m_stream_sources[StreamNumber].Stride != Stride || m_stream_sources_Changed[StreamNumber])
+	m_stream_sources[StreamNumber].Set({ pStreamData, OffsetInBytes, Stride },
+		[StreamNumber](const StreamSourceDescriptor& source)
 	{
-		m_stream_sources[StreamNumber].OffsetInBytes = OffsetInBytes;
-		m_stream_sources[StreamNumber].pStreamData = pStreamData;
-		m_stream_sources[StreamNumber].Stride = Stride;
-		dev->SetStreamSource(StreamNumber, pStreamData, OffsetInBytes, Stride);
-		m_stream_sources_Changed[StreamNumber] = false;
-	}
+		dev->SetStreamSource(StreamNumber, source.pStreamData, source.OffsetInBytes, source.Stride);
+	});
 }
 
 void ChangeStreamSource(UINT StreamNumber, IDirect3DVertexBuffer9* pStreamData, UINT OffsetInBytes, UINT Stride)
 {
-	if (m_stream_sources[StreamNumber].OffsetInBytes != OffsetInBytes
-		|| m_stream_sources[StreamNumber].pStreamData != pStreamData
-		|| m_stream_sources[StreamNumber].Stride != Stride || m_stream_sources_Changed[StreamNumber])
+	m_stream_sources[StreamNumber].Change({ pStreamData, OffsetInBytes, Stride },
+		[StreamNumber](const StreamSourceDescriptor& source)
 	{
-		dev->SetStreamSource(StreamNumber, pStreamData, OffsetInBytes, Stride);
-		m_stream_sources_Changed[StreamNumber] = true;
-	}
+		dev->SetStreamSource(StreamNumber, source.pStreamData, source.OffsetInBytes, source.Stride);
+	});
 }
 
 void RefreshStreamSource(UINT StreamNumber)
 {
-	if (m_PixelShaderChanged)
+	m_stream_sources[StreamNumber].Refresh([StreamNumber](const StreamSourceDescriptor& source)
 	{
-		dev->SetStreamSource(
-			StreamNumber,
-			m_stream_sources[StreamNumber].pStreamData,
-			m_stream_sources[StreamNumber].OffsetInBytes,
-			m_stream_sources[StreamNumber].Stride);
-		m_stream_sources_Changed[StreamNumber] = false;
-	}
+		dev->SetStreamSource(StreamNumber, source.pStreamData, source.OffsetInBytes, source.Stride);
+	});
+}
+
+static void ApplyIndices(LPDIRECT3DINDEXBUFFER9 pIndexData)
+{
+	dev->SetIndices(pIndexData);
 }
 
 void SetIndices(LPDIRECT3DINDEXBUFFER9 pIndexData)
 {
-	if (pIndexData != m_index_buffer || m_index_buffer_Changed)
-	{
-		m_index_buffer = pIndexData;
-		dev->SetIndices(pIndexData);
-		m_index_buffer_Changed = false;
-	}
+	m_index_buffer.Set(pIndexData, ApplyIndices);
 }
 
 void ChangeIndices(LPDIRECT3DINDEXBUFFER9 pIndexData)
 {
-	if (pIndexData != m_index_buffer || m_index_buffer_Changed)
-	{
-		dev->SetIndices(pIndexData);
-		m_index_buffer_Changed = true;
-	}
+	m_index_buffer.Change(pIndexData, ApplyIndices);
 }
 
 void RefreshIndices()
 {
-	if (m_index_buffer_Changed)
-	{
-		dev->SetIndices(m_index_buffer);
-		m_index_buffer_Changed = false;
-	}
+	m_index_buffer.Refresh(ApplyIndices);
 }
 
 HRESULT SetFullscreenState(bool enable_fullscreen)
@@ -41,15 +41,14 @@ void PerfQuery::EnableQuery(PerfQueryGroup type)
 {
 	if (!ShouldEmulate())
 		return;
-	// Is this sane?
-	if (m_query_count > ArraySize(m_query_buffer) / 2)
+	if (ShouldCollectResults(static_cast<u32>(ArraySize(m_query_buffer))))
 		WeakFlush();
 
-	if (ArraySize(m_query_buffer) == m_query_count)
+	if (m_query_count >= GetMaxQueriesInFlight(static_cast<u32>(ArraySize(m_query_buffer))))
 	{
-		// TODO
+		if (m_query_count == ArraySize(m_query_buffer))
+			ERROR_LOG(VIDEO, "Flushed query buffer early!");
 		FlushOne();
-		ERROR_LOG(VIDEO, "Flushed query buffer early!");
 	}
 
 	// start query
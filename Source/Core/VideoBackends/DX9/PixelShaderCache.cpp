@@ -24,6 +24,7 @@
 #include "VideoCommon/ImageWrite.h"
 #include "VideoCommon/Debugger.h"
 #include "VideoCommon/HLSLCompiler.h"
+#include "VideoCommon/ShaderPrecompiler.h"
 
 namespace DX9
 {
@@ -306,45 +307,37 @@ void PixelShaderCache::Init()
 
 	if (g_ActiveConfig.bCompileShaderOnStartup)
 	{
-		std::vector<PixelShaderUid> shaders;
-		size_t shader_count = 0;
-		s_pshaders->ForEachMostUsedByCategory(gameid,
-			[&](const PixelShaderUid& item, size_t total)
+		std::vector<PixelShaderUid> profiled = ShaderPrecompiler::CollectUids<PixelShaderUid>(*s_pshaders, gameid,
+			[](PSCacheEntry& entry) { return !entry.shader; });
+		std::vector<std::pair<PixelShaderUid, PIXEL_SHADER_RENDER_MODE>> shaders;
+		shaders.reserve(profiled.size());
+		for (PixelShaderUid& uid : profiled)
 		{
-			PixelShaderUid newitem = item;
-			pixel_shader_uid_data& uid_data = newitem.GetUidData<pixel_shader_uid_data>();
-
+			pixel_shader_uid_data& uid_data = uid.GetUidData<pixel_shader_uid_data>();
 			if (uid_data.render_mode == PSRM_DUAL_SOURCE_BLEND && !g_ActiveConfig.backend_info.bSupportsDualSourceBlend)
 			{
 				uid_data.render_mode = PSRM_DEFAULT;
-				newitem.ClearHASH();
-				newitem.CalculateUIDHash();
-				CompilePShader(newitem, PIXEL_SHADER_RENDER_MODE::PSRM_DEFAULT, true);
+				uid.ClearHASH();
+				uid.CalculateUIDHash();
+				shaders.emplace_back(uid, PSRM_DEFAULT);
 				uid_data.render_mode = PSRM_ALPHA_PASS;
 				uid_data.fog_proj = 0;
 				uid_data.fog_RangeBaseEnabled = 0;
-				newitem.ClearHASH();
-				newitem.CalculateUIDHash();
-				CompilePShader(newitem, PIXEL_SHADER_RENDER_MODE::PSRM_ALPHA_PASS, true);
+				uid.ClearHASH();
+				uid.CalculateUIDHash();
+				shaders.emplace_back(uid, PSRM_ALPHA_PASS);
 			}
 			else
 			{
-				newitem.ClearHASH();
-				newitem.CalculateUIDHash();
-				CompilePShader(newitem, PIXEL_SHADER_RENDER_MODE::PSRM_DEFAULT, true);
-			}
-			shader_count++;
-			if ((shader_count & 7) == 0)
-			{
-				Host_UpdateTitle(StringFromFormat("Compiling Pixel Shaders %i %% (%i/%i)", (shader_count * 100) / total, shader_count, total));
-				s_compiler->WaitForFinish();
+				shaders.emplace_back(uid, PSRM_DEFAULT);
 			}
-		},
-			[](PSCacheEntry& entry)
+		}
+		const size_t count = shaders.size();
+		ShaderPrecompiler::Run({ s_compiler->PrecompileJob("Pixel Shaders", count,
+			[shaders = std::move(shaders)](size_t index)
 		{
-			return !entry.shader;
-		}, true);
-		s_compiler->WaitForFinish();
+			CompilePShader(shaders[index].first, shaders[index].second, false);
+		}) });
 	}
 }
 
@@ -371,6 +364,7 @@ void PixelShaderCache::Clear()
 
 void PixelShaderCache::Shutdown()
 {
+	ShaderPrecompiler::Cancel();
 	if (s_compiler)
 	{
 		s_compiler->WaitForFinish();
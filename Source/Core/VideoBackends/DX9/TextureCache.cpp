@@ -38,7 +38,7 @@ extern s32 frameCount;
 namespace DX9
 {
 
-static const D3DFORMAT PC_TexFormat_To_D3DFORMAT[12]
+static const D3DFORMAT PC_TexFormat_To_D3DFORMAT[14]
 {
 	D3DFMT_UNKNOWN,//PC_TEX_FMT_NONE
 	D3DFMT_A8R8G8B8,//PC_TEX_FMT_BGRA32
@@ -52,9 +52,11 @@ static const D3DFORMAT PC_TexFormat_To_D3DFORMAT[12]
 	D3DFMT_DXT3,//PC_TEX_FMT_DXT3
 	D3DFMT_DXT5,//PC_TEX_FMT_DXT5
 	D3DFMT_R32F,//PC_TEX_FMT_R32
+	D3DFMT_UNKNOWN,//PC_TEX_FMT_BC5
+	D3DFMT_UNKNOWN,//PC_TEX_FMT_BC7
 };
 
-static const u32 PC_TexFormat_To_Buffer_Index[12]
+static const u32 PC_TexFormat_To_Buffer_Index[14]
 {
 	0,//PC_TEX_FMT_NONE
 	0,//PC_TEX_FMT_BGRA32
@@ -68,6 +70,8 @@ static const u32 PC_TexFormat_To_Buffer_Index[12]
 	4,//PC_TEX_FMT_DXT3
 	5,//PC_TEX_FMT_DXT5
 	6,//PC_TEX_FMT_R32
+	0,//PC_TEX_FMT_BC5
+	0,//PC_TEX_FMT_BC7
 };
 
 #define MEM_TEXTURE_POOL_SIZE 6
@@ -13,6 +13,7 @@
 #include "VideoCommon/VideoConfig.h"
 #include "VideoCommon/VertexLoader.h"
 #include "VideoCommon/HLSLCompiler.h"
+#include "VideoCommon/ShaderPrecompiler.h"
 
 #include "VideoBackends/DX9/D3DBase.h"
 #include "VideoBackends/DX9/D3DShader.h"
@@ -135,29 +136,19 @@ void VertexShaderCache::Init()
 
 	if (s_vshaders && g_ActiveConfig.bCompileShaderOnStartup)
 	{
-		size_t shader_count = 0;
-		s_vshaders->ForEachMostUsedByCategory(gameid,
-			[&](const VertexShaderUid& item, size_t total)
+		std::vector<VertexShaderUid> uids = ShaderPrecompiler::CollectUids<VertexShaderUid>(*s_vshaders, gameid,
+			[](VSCacheEntry& entry) { return !entry.shader; });
+		for (VertexShaderUid& uid : uids)
 		{
-			VertexShaderUid newitem = item;
-			vertex_shader_uid_data& uid_data = newitem.GetUidData<vertex_shader_uid_data>();
+			vertex_shader_uid_data& uid_data = uid.GetUidData<vertex_shader_uid_data>();
 			uid_data.msaa = false;
 			uid_data.ssaa = false;
-			newitem.ClearHASH();
-			newitem.CalculateUIDHash();
-			CompileVShader(newitem, true);
-			shader_count++;
-			if ((shader_count & 7) == 0)
-			{
-				Host_UpdateTitle(StringFromFormat("Compiling Vertex Shaders %i %% (%i/%i)", (shader_count * 100) / total, shader_count, total));
-				s_compiler->WaitForFinish();
-			}
-		},
-			[](VSCacheEntry& entry)
-		{
-			return !entry.shader;
-		}, true);
-		s_compiler->WaitForFinish();
+			uid.ClearHASH();
+			uid.CalculateUIDHash();
+		}
+		const size_t count = uids.size();
+		ShaderPrecompiler::Run({ s_compiler->PrecompileJob("Vertex Shaders", count,
+			[uids = std::move(uids)](size_t index) { CompileVShader(uids[index], false); }) });
 	}
 	s_last_entry = NULL;
 }
@@ -183,6 +174,7 @@ void VertexShaderCache::Clear()
 
 void VertexShaderCache::Shutdown()
 {
+	ShaderPrecompiler::Cancel();
 	if (s_compiler)
 	{
 		s_compiler->WaitForFinish();
@@ -89,6 +89,7 @@ void VideoBackend::InitBackendInfo()
 	g_Config.backend_info.bSupportsGeometryShaders = false;
 	g_Config.backend_info.bSupports3DVision = false;
 	g_Config.backend_info.bSupportsPostProcessing = false;
+	g_Config.backend_info.bSupportsPostProcessingCompute = false;
 	g_Config.backend_info.bSupportsClipControl = true;
 	g_Config.backend_info.bSupportsSSAA = false;
 	g_Config.backend_info.bSupportsTessellation = false;
@@ -97,6 +98,10 @@ void VideoBackend::InitBackendInfo()
 	g_Config.backend_info.bSupportsDepthClamp = true;
 	g_Config.backend_info.bSupportsMultithreading = false;
 	g_Config.backend_info.bSupportsReversedDepthRange = false;
+	g_Config.backend_info.bSupportsPrimitiveRestart = false;
+	g_Config.backend_info.bSupports32BitIndices = false;
+	g_Config.backend_info.bSupportsDeferredEFBCopies = false;
+	g_Config.backend_info.bSupportsVirtualXFBWriteBack = false;
 	// adapters
 	g_Config.backend_info.Adapters.clear();
 	for (int i = 0; i < DX9::D3D::GetNumAdapters(); ++i)
@@ -0,0 +1,193 @@
+// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <string>
+
+#include "Common/Logging/Log.h"
+
+#include "VideoBackends/OGL/CSTextureDecoder.h"
+#include "VideoBackends/OGL/TextureCache.h"
+
+#include "VideoCommon/TextureConversionShader.h"
+
+namespace OGL
+{
+
+CSTextureDecoder::~CSTextureDecoder()
+{
+	for (auto& it : m_programs)
+		it.second.shader.Destroy();
+	for (auto& it : m_scaling_programs)
+		it.second.shader.Destroy();
+
+	m_stream_buffer.reset();
+	glDeleteTextures(1, &m_raw_data_texture);
+	glDeleteTextures(1, &m_palette_texture);
+	glDeleteTextures(1, &m_rgba8_texture);
+}
+
+bool CSTextureDecoder::Init()
+{
+	// Large enough for the biggest texture (1024x1024 RGBA8) several times over,
+	// but the buffer texture must not exceed the driver limit.
+	s32 max_buffer_size = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &max_buffer_size);
+	m_buffer_size = std::min<u32>(16 * 1024 * 1024, max_buffer_size);
+
+	m_stream_buffer = StreamBuffer::Create(GL_TEXTURE_BUFFER, m_buffer_size);
+	if (!m_stream_buffer)
+		return false;
+
+	// Views of the same buffer, the palette is read in 16 bit units and the scaling shaders
+	// read whole texels.
+	glGenTextures(1, &m_raw_data_texture);
+	glBindTexture(GL_TEXTURE_BUFFER, m_raw_data_texture);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_R8UI, m_stream_buffer->m_buffer);
+	glGenTextures(1, &m_palette_texture);
+	glBindTexture(GL_TEXTURE_BUFFER, m_palette_texture);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_R16UI, m_stream_buffer->m_buffer);
+	glGenTextures(1, &m_rgba8_texture);
+	glBindTexture(GL_TEXTURE_BUFFER, m_rgba8_texture);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA8, m_stream_buffer->m_buffer);
+	glBindTexture(GL_TEXTURE_BUFFER, 0);
+	return true;
+}
+
+bool CSTextureDecoder::FormatSupported(u32 format) const
+{
+	return TextureConversionShader::IsDecodingShaderSupported(format);
+}
+
+CSTextureDecoder::DecodingProgram* CSTextureDecoder::GetProgram(u32 format, TlutFormat tlutfmt)
+{
+	// The palette format only matters for paletted textures.
+	if (format != GX_TF_C4 && format != GX_TF_C8 && format != GX_TF_C14X2)
+		tlutfmt = GX_TL_IA8;
+
+	ComboKey key = MakeComboKey(format, tlutfmt);
+	auto iter = m_programs.find(key);
+	if (iter != m_programs.end())
+		return iter->second.shader.glprogid ? &iter->second : nullptr;
+
+	// Failures are stored as well, so we don't try to compile the shader again.
+	DecodingProgram& program = m_programs[key];
+	if (!InitProgram(program,
+		TextureConversionShader::GenerateDecodingShader(format, tlutfmt, API_OPENGL)))
+	{
+		ERROR_LOG(VIDEO, "Failed to compile texture decoding shader for format 0x%x", format);
+		return nullptr;
+	}
+	return &program;
+}
+
+CSTextureDecoder::DecodingProgram* CSTextureDecoder::GetScalingProgram(int scaling_type,
+	int factor)
+{
+	u32 key = static_cast<u32>(scaling_type) | (static_cast<u32>(factor) << 16);
+	auto iter = m_scaling_programs.find(key);
+	if (iter != m_scaling_programs.end())
+		return iter->second.shader.glprogid ? &iter->second : nullptr;
+
+	DecodingProgram& program = m_scaling_programs[key];
+	if (!InitProgram(program,
+		TextureConversionShader::GenerateScalingShader(scaling_type, factor, API_OPENGL)))
+	{
+		ERROR_LOG(VIDEO, "Failed to compile texture scaling shader for type %d", scaling_type);
+		return nullptr;
+	}
+	return &program;
+}
+
+bool CSTextureDecoder::InitProgram(DecodingProgram& program, const std::string& code)
+{
+	if (!ProgramShaderCache::CompileComputeShader(program.shader, code.c_str()))
+		return false;
+
+	program.shader.Bind();
+	program.params_location = glGetUniformLocation(program.shader.glprogid, "params");
+	program.dimensions_location = glGetUniformLocation(program.shader.glprogid, "dimensions");
+	glUniform1i(glGetUniformLocation(program.shader.glprogid, "s_output"), 0);
+	return true;
+}
+
+bool CSTextureDecoder::Decode(GLuint dst_texture, const u8* src, u32 width, u32 height,
+	u32 expanded_width, u32 expanded_height, u32 format, u32 tlutaddr, TlutFormat tlutfmt, u32 level)
+{
+	if (!FormatSupported(format))
+		return false;
+
+	u32 data_size = TexDecoder_GetTextureSizeInBytes(expanded_width, expanded_height, format);
+	u32 palette_size = 0;
+	if (format == GX_TF_C4 || format == GX_TF_C8 || format == GX_TF_C14X2)
+		palette_size = std::min(TexDecoder_GetPaletteSize(format), TMEM_SIZE - tlutaddr);
+	if (data_size + palette_size + sizeof(u16) > m_buffer_size)
+		return false;
+
+	DecodingProgram* program = GetProgram(format, tlutfmt);
+	if (!program)
+		return false;
+
+	u32 data_offset = m_stream_buffer->Stream(data_size, src);
+	u32 palette_offset = 0;
+	if (palette_size)
+		palette_offset = m_stream_buffer->Stream(palette_size, sizeof(u16), &texMem[tlutaddr]);
+
+	glActiveTexture(GL_TEXTURE9);
+	glBindTexture(GL_TEXTURE_BUFFER, m_raw_data_texture);
+	glActiveTexture(GL_TEXTURE10);
+	glBindTexture(GL_TEXTURE_BUFFER, m_palette_texture);
+	glBindImageTexture(0, dst_texture, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
+
+	program->shader.Bind();
+	glUniform4i(program->params_location, data_offset,
+		expanded_width / TexDecoder_GetBlockWidthInTexels(format), palette_offset / sizeof(u16), 0);
+	glUniform4i(program->dimensions_location, width, height, 0, 0);
+
+	const u32 group_size = TextureConversionShader::DECODING_SHADER_GROUP_SIZE;
+	glDispatchCompute((width + group_size - 1) / group_size, (height + group_size - 1) / group_size, 1);
+
+	// Make the texels visible to the draws sampling the texture.
+	glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT);
+	glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
+
+	TextureCache::SetStage();
+	return true;
+}
+
+bool CSTextureDecoder::Scale(GLuint dst_texture, const u8* src, u32 width, u32 height, u32 stride,
+	int scaling_type, int factor, u32 level)
+{
+	if (!TextureConversionShader::IsScalingShaderSupported(scaling_type, factor))
+		return false;
+
+	u32 data_size = stride * height * sizeof(u32);
+	if (data_size + sizeof(u32) > m_buffer_size)
+		return false;
+
+	DecodingProgram* program = GetScalingProgram(scaling_type, factor);
+	if (!program)
+		return false;
+
+	u32 data_offset = m_stream_buffer->Stream(data_size, sizeof(u32), src);
+
+	glActiveTexture(GL_TEXTURE9);
+	glBindTexture(GL_TEXTURE_BUFFER, m_rgba8_texture);
+	glBindImageTexture(0, dst_texture, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
+
+	program->shader.Bind();
+	glUniform4i(program->params_location, data_offset / sizeof(u32), stride, 0, 0);
+	glUniform4i(program->dimensions_location, width, height, 0, 0);
+
+	const u32 group_size = TextureConversionShader::DECODING_SHADER_GROUP_SIZE;
+	glDispatchCompute((width + group_size - 1) / group_size, (height + group_size - 1) / group_size, 1);
+
+	glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT);
+	glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
+
+	TextureCache::SetStage();
+	return true;
+}
+
+}  // namespace OGL
@@ -0,0 +1,73 @@
+// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include "Common/CommonTypes.h"
+#include "Common/GL/GLUtil.h"
+
+#include "VideoBackends/OGL/ProgramShaderCache.h"
+#include "VideoBackends/OGL/StreamBuffer.h"
+
+#include "VideoCommon/TextureDecoder.h"
+
+namespace OGL
+{
+
+// Decodes guest textures with compute shaders, the raw texture data is streamed into a
+// texture buffer and the decoded texels are stored directly into the destination texture.
+class CSTextureDecoder
+{
+public:
+	CSTextureDecoder() = default;
+	~CSTextureDecoder();
+
+	bool Init();
+	bool FormatSupported(u32 format) const;
+
+	// The destination level must already be allocated as GL_RGBA8.
+	// Returns false if the texture has to be decoded on the CPU instead.
+	bool Decode(GLuint dst_texture, const u8* src, u32 width, u32 height, u32 expanded_width,
+		u32 expanded_height, u32 format, u32 tlutaddr, TlutFormat tlutfmt, u32 level);
+
+	// Upscales decoded RGBA8 texels with one of the TextureScaler filters, the destination level
+	// must already be allocated as GL_RGBA8 and factor times larger.
+	// Returns false if the CPU scaler has to be used instead.
+	bool Scale(GLuint dst_texture, const u8* src, u32 width, u32 height, u32 stride,
+		int scaling_type, int factor, u32 level);
+
+private:
+	struct DecodingProgram
+	{
+		SHADER shader;
+		GLint params_location = -1;
+		GLint dimensions_location = -1;
+	};
+
+	typedef u32 ComboKey;
+	static ComboKey MakeComboKey(u32 format, TlutFormat tlutfmt)
+	{
+		return format | ((tlutfmt & 0xF) << 16);
+	}
+
+	DecodingProgram* GetProgram(u32 format, TlutFormat tlutfmt);
+	DecodingProgram* GetScalingProgram(int scaling_type, int factor);
+	bool InitProgram(DecodingProgram& program, const std::string& code);
+
+	// Programs are compiled on first use of each format/palette combination.
+	std::map<ComboKey, DecodingProgram> m_programs;
+	std::map<u32, DecodingProgram> m_scaling_programs;
+
+	std::unique_ptr<StreamBuffer> m_stream_buffer;
+	u32 m_buffer_size = 0;
+	GLuint m_raw_data_texture = 0;
+	GLuint m_palette_texture = 0;
+	GLuint m_rgba8_texture = 0;
+};
+
+}  // namespace OGL
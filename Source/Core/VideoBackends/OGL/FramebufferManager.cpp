@@ -36,6 +36,8 @@ GLuint FramebufferManager::m_efbColorSwap; // for hot swap when reinterpreting E
 std::vector<GLuint> FramebufferManager::m_resolvedFramebuffer;
 GLuint FramebufferManager::m_resolvedColorTexture;
 GLuint FramebufferManager::m_resolvedDepthTexture;
+EFBRectangle FramebufferManager::m_resolvedColorRect;
+EFBRectangle FramebufferManager::m_resolvedDepthRect;
 
 // reinterpret pixel format
 SHADER FramebufferManager::m_pixel_format_shaders[2];
@@ -53,6 +55,7 @@ FramebufferManager::FramebufferManager(int targetWidth, int targetHeight, int ms
 	m_efbColorSwap = 0;
 	m_resolvedColorTexture = 0;
 	m_resolvedDepthTexture = 0;
+	InvalidateResolvedEFB();
 
 	m_targetWidth = targetWidth;
 	m_targetHeight = targetHeight;
@@ -448,12 +451,48 @@ FramebufferManager::~FramebufferManager()
 	m_EfbPokes.Destroy();
 }
 
+static bool IsEmptyRect(const EFBRectangle& rc)
+{
+	return rc.left >= rc.right || rc.top >= rc.bottom;
+}
+
+static bool ContainsRect(const EFBRectangle& outer, const EFBRectangle& inner)
+{
+	return !IsEmptyRect(outer) && inner.left >= outer.left && inner.right <= outer.right &&
+		inner.top >= outer.top && inner.bottom <= outer.bottom;
+}
+
+static bool IntersectsRect(const EFBRectangle& a, const EFBRectangle& b)
+{
+	return !IsEmptyRect(a) && !IsEmptyRect(b) && a.left < b.right && b.left < a.right &&
+		a.top < b.bottom && b.top < a.bottom;
+}
+
+void FramebufferManager::InvalidateResolvedEFB(const EFBRectangle& rc, bool color, bool depth)
+{
+	if (color && IntersectsRect(m_resolvedColorRect, rc))
+		m_resolvedColorRect = EFBRectangle();
+	if (depth && IntersectsRect(m_resolvedDepthRect, rc))
+		m_resolvedDepthRect = EFBRectangle();
+}
+
+void FramebufferManager::InvalidateResolvedEFB()
+{
+	m_resolvedColorRect = EFBRectangle();
+	m_resolvedDepthRect = EFBRectangle();
+}
+
 GLuint FramebufferManager::GetEFBColorTexture(const EFBRectangle& sourceRc)
 {
 	if (m_msaaSamples <= 1)
 	{
 		return m_efbColor;
 	}
+	else if (ContainsRect(m_resolvedColorRect, sourceRc))
+	{
+		// Nothing was drawn there since the last resolve
+		return m_resolvedColorTexture;
+	}
 	else
 	{
 		// Transfer the EFB to a resolved texture. EXT_framebuffer_blit is
@@ -473,6 +512,7 @@ GLuint FramebufferManager::GetEFBColorTexture(const EFBRectangle& sourceRc)
 				GL_COLOR_BUFFER_BIT, GL_NEAREST
 			);
 		}
+		m_resolvedColorRect = sourceRc;
 
 		// Return to EFB.
 		glBindFramebuffer(GL_FRAMEBUFFER, m_efbFramebuffer[0]);
@@ -487,6 +527,10 @@ GLuint FramebufferManager::GetEFBDepthTexture(const EFBRectangle& sourceRc)
 	{
 		return m_efbDepth;
 	}
+	else if (ContainsRect(m_resolvedDepthRect, sourceRc))
+	{
+		return m_resolvedDepthTexture;
+	}
 	else
 	{
 		// Transfer the EFB to a resolved texture.
@@ -505,6 +549,7 @@ GLuint FramebufferManager::GetEFBDepthTexture(const EFBRectangle& sourceRc)
 				GL_DEPTH_BUFFER_BIT, GL_NEAREST
 			);
 		}
+		m_resolvedDepthRect = sourceRc;
 
 		// Return to EFB.
 		glBindFramebuffer(GL_FRAMEBUFFER, m_efbFramebuffer[0]);
@@ -584,6 +629,7 @@ void FramebufferManager::ReinterpretPixelData(unsigned int convtype)
 	glBindTexture(m_textureType, 0);
 
 	g_renderer->RestoreAPIState();
+	m_resolvedColorRect = EFBRectangle();
 }
 
 XFBSource::~XFBSource()
@@ -600,6 +646,19 @@ void XFBSource::DecodeToTexture(u32 xfbAddr, u32 fbWidth, u32 fbHeight)
 	TextureConverter::DecodeToTexture(xfbAddr, fbWidth, fbHeight, texture);
 }
 
+void XFBSource::EncodeToRam(u32 xfbAddr, u32 fbStride)
+{
+	u8* xfb_in_ram = Memory::GetPointer(xfbAddr);
+	if (!xfb_in_ram)
+	{
+		WARN_LOG(VIDEO, "Tried to write back to invalid XFB address");
+		return;
+	}
+
+	// sourceRc was converted like the one of CopyToRealXFB
+	TextureConverter::EncodeToRamYUYV(texture, sourceRc, xfb_in_ram, srcWidth, fbStride, srcHeight);
+}
+
 void XFBSource::CopyEFB(float Gamma)
 {
 	bool apply_post_proccesing = g_renderer->GetPostProcessor()->ShouldTriggerOnSwap();
@@ -701,7 +760,12 @@ void FramebufferManager::PokeEFB(EFBAccessType type, const EfbPokeData* data, si
 	g_renderer->RestoreAPIState();
 
 	// TODO: Could just update the EFB cache with the new value
-	ClearEFBCache();
+	for (size_t i = 0; i < num_points; i++)
+	{
+		const EFBRectangle rc(data[i].x, data[i].y, data[i].x + 1, data[i].y + 1);
+		ClearEFBCache(rc);
+		InvalidateResolvedEFB(rc, type != POKE_Z, type == POKE_Z);
+	}
 }
 
 }  // namespace OGL
@@ -60,6 +60,7 @@ struct XFBSource : public XFBSourceBase
 
 	void CopyEFB(float Gamma) override;
 	void DecodeToTexture(u32 xfbAddr, u32 fbWidth, u32 fbHeight) override;
+	void EncodeToRam(u32 xfbAddr, u32 fbStride) override;
 
 	const GLuint texture;
 	GLuint depthtexture;
@@ -105,6 +106,11 @@ public:
 	// After calling this, before you render anything else, you MUST bind the framebuffer you want to draw to.
 	static GLuint ResolveAndGetDepthTarget(const EFBRectangle &rect);
 
+	// With MSAA the resolved textures are reused while the requested EFB rectangle is still up to
+	// date in them. These forget the resolved parts that a write into rc of the EFB may change.
+	static void InvalidateResolvedEFB(const EFBRectangle& rc, bool color, bool depth);
+	static void InvalidateResolvedEFB();
+
 	// Convert EFB content on pixel format change.
 	// convtype=0 -> rgb8->rgba6, convtype=2 -> rgba6->rgb8
 	static void ReinterpretPixelData(unsigned int convtype);
@@ -132,6 +138,9 @@ private:
 	static std::vector<GLuint> m_resolvedFramebuffer;
 	static GLuint m_resolvedColorTexture;
 	static GLuint m_resolvedDepthTexture;
+	// The EFB rectangles the resolved textures hold up to date, empty when none
+	static EFBRectangle m_resolvedColorRect;
+	static EFBRectangle m_resolvedDepthRect;
 
 	// For pixel format draw
 	static SHADER m_pixel_format_shaders[2];
@@ -0,0 +1,49 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Common/GL/GLExtensions/GLExtensions.h"
+
+#include "VideoBackends/OGL/GPUProfiler.h"
+
+namespace OGL
+{
+GPUProfiler::GPUProfiler()
+{
+	glGenQueries(QUERY_COUNT, m_queries.data());
+}
+
+GPUProfiler::~GPUProfiler()
+{
+	glDeleteQueries(QUERY_COUNT, m_queries.data());
+}
+
+bool GPUProfiler::IsSupported()
+{
+	return GLExtensions::Supports("GL_ARB_timer_query");
+}
+
+void GPUProfiler::WriteTimestamp(u32 query)
+{
+	glQueryCounter(m_queries[query], GL_TIMESTAMP);
+}
+
+bool GPUProfiler::GetResults(u32 frame, u32 count, u64* timestamps, u64* frequency)
+{
+	// The queries complete in order, the last one being available means all of them are
+	const GLuint* queries = &m_queries[frame * MAX_TIMESTAMPS];
+	GLint available = 0;
+	glGetQueryObjectiv(queries[count - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+	if (!available)
+		return false;
+
+	for (u32 i = 0; i < count; i++)
+	{
+		GLuint64 result;
+		glGetQueryObjectui64v(queries[i], GL_QUERY_RESULT, &result);
+		timestamps[i] = result;
+	}
+	*frequency = 1000000000;
+	return true;
+}
+}
@@ -0,0 +1,31 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+
+#include "Common/GL/GLExtensions/GLExtensions.h"
+
+#include "VideoCommon/GPUProfilerBase.h"
+
+namespace OGL
+{
+// GL_ARB_timer_query, the timestamps are in nanoseconds
+class GPUProfiler : public GPUProfilerBase
+{
+public:
+	GPUProfiler();
+	~GPUProfiler();
+
+	static bool IsSupported();
+
+protected:
+	void WriteTimestamp(u32 query) override;
+	bool GetResults(u32 frame, u32 count, u64* timestamps, u64* frequency) override;
+
+private:
+	std::array<GLuint, QUERY_COUNT> m_queries;
+};
+}
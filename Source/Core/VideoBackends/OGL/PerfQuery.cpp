@@ -100,11 +100,10 @@ PerfQueryGL::~PerfQueryGL()
 
 void PerfQueryGL::EnableQuery(PerfQueryGroup type)
 {
-	// Is this sane?
-	if (m_query_count > m_query_buffer.size() / 2)
+	if (ShouldCollectResults(static_cast<u32>(m_query_buffer.size())))
 		WeakFlush();
 
-	if (m_query_buffer.size() == m_query_count)
+	if (m_query_count >= GetMaxQueriesInFlight(static_cast<u32>(m_query_buffer.size())))
 	{
 		FlushOne();
 		//ERROR_LOG(VIDEO, "Flushed query buffer early!");
@@ -193,11 +192,10 @@ PerfQueryGLESNV::~PerfQueryGLESNV()
 
 void PerfQueryGLESNV::EnableQuery(PerfQueryGroup type)
 {
-	// Is this sane?
-	if (m_query_count > m_query_buffer.size() / 2)
+	if (ShouldCollectResults(static_cast<u32>(m_query_buffer.size())))
 		WeakFlush();
 
-	if (m_query_buffer.size() == m_query_count)
+	if (m_query_count >= GetMaxQueriesInFlight(static_cast<u32>(m_query_buffer.size())))
 	{
 		FlushOne();
 		//ERROR_LOG(VIDEO, "Flushed query buffer early!");
@@ -155,6 +155,7 @@ uintptr_t OGLPostProcessingShader::CreateBindingSampler(const PostProcessingShad
 bool OGLPostProcessingShader::RecompileShaders()
 {
 	std::string common_source = PostProcessor::GetCommonFragmentShaderSource(API_OPENGL, m_config);
+	std::string common_compute_source;
 	for (size_t i = 0; i < m_passes.size(); i++)
 	{
 		RenderPassData& pass = m_passes[i];
@@ -176,6 +177,35 @@ bool OGLPostProcessingShader::RecompileShaders()
 		pass.shader = reinterpret_cast<uintptr_t>(shader);
 		// Compile shader for this pass
 		shader->program = std::make_unique<SHADER>();
+		if (pass.compute)
+		{
+			// Compute passes write every layer in one dispatch, so there is no GS program.
+			if (common_compute_source.empty())
+				common_compute_source = PostProcessor::GetCommonComputeShaderSource(API_OPENGL, m_config);
+
+			std::string compute_shader_source = header_shader_source + common_compute_source;
+			compute_shader_source += PostProcessor::GetPassComputeShaderSource(API_OPENGL, m_config, &pass_config);
+			if (!ProgramShaderCache::CompileComputeShader(*shader->program, compute_shader_source.c_str()))
+			{
+				ReleasePassNativeResources(pass);
+				ERROR_LOG(VIDEO, "Failed to compile post-processing compute shader %s (pass %s)", m_config->GetShaderName().c_str(), pass_config.compute_entry_point.c_str());
+				m_ready = false;
+				return false;
+			}
+
+			shader->program->Bind();
+			glUniform1i(glGetUniformLocation(shader->program->glprogid, "pp_output"), 0);
+
+			GLuint block_index = glGetUniformBlockIndex(shader->program->glprogid, "PostProcessingConstants");
+			if (block_index != GL_INVALID_INDEX)
+				glUniformBlockBinding(shader->program->glprogid, block_index, UNIFORM_BUFFER_BIND_POINT);
+
+			block_index = glGetUniformBlockIndex(shader->program->glprogid, "ConfigurationConstants");
+			if (block_index != GL_INVALID_INDEX)
+				glUniformBlockBinding(shader->program->glprogid, block_index, UNIFORM_BUFFER_BIND_POINT + 1);
+			continue;
+		}
+
 		std::string vertex_shader_source;
 		PostProcessor::GetUniformBufferShaderSource(API_OPENGL, m_config, vertex_shader_source);
 		vertex_shader_source += s_vertex_shader;
@@ -262,7 +292,8 @@ void OGLPostProcessingShader::Draw(PostProcessor* p,
 	bool skip_final_copy = !IsLastPassScaled() && (dst_texture != src_texture || !m_last_pass_uses_color_buffer) && !m_prev_frame_enabled;
 
 	// If the last pass is not at full scale, we can't skip the copy.
-	if (m_passes[m_last_pass_index].output_size != src_size)
+	// Compute passes can only store to their own output texture.
+	if (m_passes[m_last_pass_index].output_size != src_size || m_passes[m_last_pass_index].compute)
 		skip_final_copy = false;
 
 	MapAndUpdateConfigurationBuffer();
@@ -293,7 +324,11 @@ void OGLPostProcessingShader::Draw(PostProcessor* p,
 		}
 
 		// Setup framebuffer
-		if (output_texture != 0)
+		if (pass.compute)
+		{
+			glBindImageTexture(0, output_texture, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_RGBA8);
+		}
+		else if (output_texture != 0)
 		{
 			glBindFramebuffer(GL_DRAW_FRAMEBUFFER, parent->GetDrawFramebuffer());
 			if (src_layer < 0 && m_internal_layers > 1)
@@ -310,7 +345,9 @@ void OGLPostProcessingShader::Draw(PostProcessor* p,
 
 		OGLRenderPassData* shader = reinterpret_cast<OGLRenderPassData*>(pass.shader);
 		// Bind program and texture units here
-		if (src_layer < 0 && m_internal_layers > 1)
+		if (pass.compute)
+			shader->program->Bind();
+		else if (src_layer < 0 && m_internal_layers > 1)
 			shader->gs_program->Bind();
 		else
 			shader->program->Bind();
@@ -364,8 +401,22 @@ void OGLPostProcessingShader::Draw(PostProcessor* p,
 		}
 
 		parent->MapAndUpdateUniformBuffer(input_sizes, output_rect, output_size, src_rect, src_size, src_layer, gamma);
-		glViewport(output_rect.left, output_rect.bottom, output_rect.GetWidth(), output_rect.GetHeight());
-		glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+		if (pass.compute)
+		{
+			const u32* group_size = m_config->GetPass(pass_index).compute_group_size;
+			const u32 layers = (src_layer < 0) ? static_cast<u32>(m_internal_layers) : 1;
+			glDispatchCompute((output_rect.GetWidth() + group_size[0] - 1) / group_size[0],
+				(output_rect.GetHeight() + group_size[1] - 1) / group_size[1], layers);
+
+			// The output is sampled by the following passes, or copied out of as a framebuffer.
+			glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_FRAMEBUFFER_BARRIER_BIT);
+			glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
+		}
+		else
+		{
+			glViewport(output_rect.left, output_rect.bottom, output_rect.GetWidth(), output_rect.GetHeight());
+			glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+		}
 	}
 
 	// Unbind input textures after rendering, so that they can safely be used as outputs again.
@@ -2,11 +2,18 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <atomic>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "Common/Common.h"
+#include "Common/Flag.h"
+#include "Common/GL/GLInterfaceBase.h"
 #include "Common/MathUtil.h"
 #include "Common/StringUtil.h"
+#include "Common/Thread.h"
 
 #include "Core/Host.h"
 
@@ -19,6 +26,7 @@
 #include "VideoCommon/GeometryShaderManager.h"
 #include "VideoCommon/ImageWrite.h"
 #include "VideoCommon/PixelShaderManager.h"
+#include "VideoCommon/ShaderPrecompiler.h"
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/VertexShaderManager.h"
 
@@ -33,13 +41,146 @@ s32 ProgramShaderCache::s_ubo_align;
 static std::unique_ptr<StreamBuffer> s_buffer;
 static int num_failures = 0;
 
+// Constants of the last upload of each stage, draws that set the same values keep its range.
+static float s_uploaded_ps_constants[PixelShaderManager::ConstantBufferSize];
+static float s_uploaded_vs_constants[VertexShaderManager::ConstantBufferSize];
+static GeometryShaderConstants s_uploaded_gs_constants;
+static bool s_constants_uploaded = false;
+
 static LinearDiskCache<SHADERUID, u8> g_program_disk_cache;
 static GLuint CurrentProgram = 0;
 ProgramShaderCache::PCache* ProgramShaderCache::pshaders;
 ProgramShaderCache::PCacheEntry* ProgramShaderCache::last_entry;
 SHADERUID ProgramShaderCache::last_uid;
 
-static char s_glsl_header[2048] = "";
+static char s_glsl_header[4096] = "";
+
+// Uploads the program binaries of the disk cache on a context shared with the video thread,
+// big caches would otherwise stall the first frame while the driver validates every binary.
+// Programs are handed back in disk order, the fence of each upload is waited on by the video
+// context before the program is used.
+class ProgramBinaryLoader
+{
+public:
+	static std::unique_ptr<ProgramBinaryLoader> Create()
+	{
+		if (!g_ogl_config.bSupportsGLSync)
+			return nullptr;
+		std::unique_ptr<cInterfaceBase> context = GLInterface->CreateSharedContext();
+		if (!context)
+			return nullptr;
+		return std::make_unique<ProgramBinaryLoader>(std::move(context));
+	}
+
+	explicit ProgramBinaryLoader(std::unique_ptr<cInterfaceBase> context)
+		: m_context(std::move(context))
+	{
+		m_loaded.store(0);
+	}
+
+	~ProgramBinaryLoader()
+	{
+		m_stop.Set();
+		if (m_thread.joinable())
+			m_thread.join();
+		Retrieve(nullptr, false);
+		m_context->Shutdown();
+	}
+
+	// Must be called before Start.
+	void Add(ProgramShaderCache::PCacheEntry* entry, GLenum format, const u8* binary, u32 size)
+	{
+		m_programs.emplace_back();
+		Program& program = m_programs.back();
+		program.entry = entry;
+		program.format = format;
+		program.binary.assign(binary, binary + size);
+	}
+
+	bool Empty() const
+	{
+		return m_programs.empty();
+	}
+
+	void Start()
+	{
+		m_thread = std::thread(&ProgramBinaryLoader::Run, this);
+	}
+
+	// Hands the finished uploads over to their entries. Returns false if entry is still waiting
+	// for its upload, waiting for it when wait is set.
+	bool Retrieve(const ProgramShaderCache::PCacheEntry* entry, bool wait)
+	{
+		while (true)
+		{
+			size_t loaded = m_loaded.load(std::memory_order_acquire);
+			for (; m_retrieved < loaded; m_retrieved++)
+			{
+				Program& program = m_programs[m_retrieved];
+				if (program.fence)
+				{
+					glWaitSync(program.fence, 0, GL_TIMEOUT_IGNORED);
+					glDeleteSync(program.fence);
+				}
+				program.entry->shader.glprogid = program.glprogid;
+				if (!program.glprogid)
+					program.entry->pending = false;
+				if (program.entry == entry)
+				{
+					m_retrieved++;
+					return true;
+				}
+			}
+			if (!entry || m_retrieved == m_programs.size() || m_stop.IsSet())
+				return true;
+			if (!wait)
+				return false;
+			Common::YieldCPU();
+		}
+	}
+
+private:
+	struct Program
+	{
+		ProgramShaderCache::PCacheEntry* entry;
+		GLenum format;
+		std::vector<u8> binary;
+		GLuint glprogid = 0;
+		GLsync fence = 0;
+	};
+
+	void Run()
+	{
+		Common::SetCurrentThreadName("Program binary loader");
+		if (!m_context->MakeCurrent())
+		{
+			// Every entry is recompiled from source when it gets used.
+			ERROR_LOG(VIDEO, "Failed to make the program loader context current.");
+			m_loaded.store(m_programs.size(), std::memory_order_release);
+			return;
+		}
+		for (size_t i = 0; i < m_programs.size() && !m_stop.IsSet(); i++)
+		{
+			Program& program = m_programs[i];
+			program.glprogid = glCreateProgram();
+			glProgramBinary(program.glprogid, program.format, program.binary.data(), static_cast<GLsizei>(program.binary.size()));
+			program.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+			glFlush();
+			std::vector<u8>().swap(program.binary);
+			m_loaded.store(i + 1, std::memory_order_release);
+		}
+		m_context->ClearCurrent();
+	}
+
+	std::unique_ptr<cInterfaceBase> m_context;
+	std::vector<Program> m_programs;
+	std::atomic<size_t> m_loaded;
+	size_t m_retrieved = 0;
+	Common::Flag m_stop;
+	std::thread m_thread;
+};
+
+static std::unique_ptr<ProgramBinaryLoader> s_binary_loader;
 
 static std::string GetGLSLVersionString()
 {
@@ -70,6 +211,8 @@ static std::string GetGLSLVersionString()
 
 void SHADER::SetProgramVariables()
 {
+	vertex_expand_location = glGetUniformLocation(glprogid, I_VTXEXPAND);
+
 	// Bind UBO and texture samplers
 	if (!g_ActiveConfig.backend_info.bSupportsBindingLayout)
 	{
@@ -153,23 +296,50 @@ void ProgramShaderCache::UploadConstants()
 	u32 mask = 0;
 	if (PixelShaderManager::IsDirty())
 	{
-		required_size += s_p_ubo_buffer_size;
-		mask |= 1;
+		if (PixelShaderManager::UpdateUploadedConstants(s_uploaded_ps_constants))
+		{
+			required_size += s_p_ubo_buffer_size;
+			mask |= 1;
+		}
+		else
+		{
+			PixelShaderManager::Clear();
+		}
 	}
 	if (VertexShaderManager::IsDirty())
 	{
-		required_size += s_v_ubo_buffer_size;
-		mask |= 2;
+		if (VertexShaderManager::UpdateUploadedConstants(s_uploaded_vs_constants))
+		{
+			required_size += s_v_ubo_buffer_size;
+			mask |= 2;
+		}
+		else
+		{
+			VertexShaderManager::Clear();
+		}
 	}
 	if (GeometryShaderManager::IsDirty())
 	{
-		required_size += s_g_ubo_buffer_size;
-		mask |= 4;
+		if (memcmp(&s_uploaded_gs_constants, &GeometryShaderManager::constants, sizeof(GeometryShaderConstants)) != 0)
+		{
+			s_uploaded_gs_constants = GeometryShaderManager::constants;
+			required_size += s_g_ubo_buffer_size;
+			mask |= 4;
+		}
+		else
+		{
+			GeometryShaderManager::Clear();
+		}
 	}
-	if (!s_buffer->CanStreamWithoutRestart(required_size))
+	if (!s_constants_uploaded || !s_buffer->CanStreamWithoutRestart(required_size))
 	{
+		// Every stage moves to the new part of the buffer.
 		required_size = s_ubo_buffer_size;
 		mask = 7;
+		memcpy(s_uploaded_ps_constants, PixelShaderManager::GetBuffer(), sizeof(s_uploaded_ps_constants));
+		memcpy(s_uploaded_vs_constants, VertexShaderManager::GetBuffer(), sizeof(s_uploaded_vs_constants));
+		s_uploaded_gs_constants = GeometryShaderManager::constants;
+		s_constants_uploaded = true;
 	}
 	if (mask)
 	{
@@ -206,28 +376,22 @@ GLuint ProgramShaderCache::GetCurrentProgram()
 	return CurrentProgram;
 }
 
-SHADER* ProgramShaderCache::CompileShader(const SHADERUID& uid)
+void ProgramShaderCache::GenerateShaderCode(const SHADERUID& uid, ShaderCode& vcode, ShaderCode& pcode, ShaderCode& gcode)
 {
-	// Check if shader is already in cache
-	PCacheEntry& newentry = pshaders->GetOrAdd(uid);
-	if (newentry.shader.glprogid)
-	{
-		last_entry = &newentry;
-		GFX_DEBUGGER_PAUSE_AT(NEXT_PIXEL_SHADER_CHANGE, true);
-		last_entry->shader.Bind();
-		return &last_entry->shader;
-	}
-	// Make an entry in the table
-	last_entry = &newentry;
-	newentry.in_cache = 0;
-
-	ShaderCode vcode;
-	ShaderCode pcode;
-	ShaderCode gcode;
 	GenerateVertexShaderCodeGL(vcode, uid.vuid.GetUidData());
 	GeneratePixelShaderCodeGL(pcode, uid.puid.GetUidData());
 	if (g_ActiveConfig.backend_info.bSupportsGeometryShaders && !uid.guid.GetUidData().IsPassthrough())
 		GenerateGeometryShaderCode(gcode, uid.guid.GetUidData(), API_OPENGL);
+}
+
+bool ProgramShaderCache::CreateProgram(PCacheEntry& entry, const SHADERUID& uid)
+{
+	entry.in_cache = 0;
+
+	ShaderCode vcode;
+	ShaderCode pcode;
+	ShaderCode gcode;
+	GenerateShaderCode(uid, vcode, pcode, gcode);
 
 #if defined(_DEBUG) || defined(DEBUGFAST)
 	if (g_ActiveConfig.iLog & CONF_SAVESHADERS)
@@ -247,16 +411,78 @@ SHADER* ProgramShaderCache::CompileShader(const SHADERUID& uid)
 	}
 #endif
 
-	if (!CompileShader(newentry.shader, vcode.GetBuffer(), pcode.GetBuffer(), gcode.GetBuffer()))
+	// Without parallel compilation the driver compiles while the status is read back anyway.
+	if (!CompileShader(entry.shader, vcode.GetBuffer(), pcode.GetBuffer(), gcode.GetBuffer(), nullptr, 0, !g_ogl_config.bSupportsParallelShaderCompile))
+		return false;
+	entry.pending = g_ogl_config.bSupportsParallelShaderCompile;
+
+	INCSTAT(stats.numPixelShadersCreated);
+	SETSTAT(stats.numPixelShadersAlive, static_cast<int>(pshaders->size()));
+	return true;
+}
+
+bool ProgramShaderCache::ResolveEntry(PCacheEntry& entry, const SHADERUID& uid, bool wait)
+{
+	if (!entry.pending)
+		return entry.shader.glprogid != 0;
+
+	if (!entry.shader.glprogid && !s_binary_loader->Retrieve(&entry, wait))
+		return false;
+
+	if (entry.shader.glprogid && !wait && g_ogl_config.bSupportsParallelShaderCompile)
+	{
+		GLint complete = GL_FALSE;
+		glGetProgramiv(entry.shader.glprogid, GL_COMPLETION_STATUS_KHR, &complete);
+		if (complete != GL_TRUE)
+			return false;
+	}
+
+	entry.pending = false;
+	GLint link_status = GL_FALSE;
+	if (entry.shader.glprogid)
+		glGetProgramiv(entry.shader.glprogid, GL_LINK_STATUS, &link_status);
+	if (link_status == GL_TRUE)
+	{
+		entry.shader.SetProgramVariables();
+		return true;
+	}
+
+	glDeleteProgram(entry.shader.glprogid);
+	entry.shader.glprogid = 0;
+	if (entry.in_cache)
+	{
+		// The driver rejected the cached binary, build the program from source again.
+		return CreateProgram(entry, uid) && ResolveEntry(entry, uid, wait);
+	}
+
+	// Link it again in blocking mode, the info logs of the failed stages are only reported there.
+	ShaderCode vcode;
+	ShaderCode pcode;
+	ShaderCode gcode;
+	GenerateShaderCode(uid, vcode, pcode, gcode);
+	return CompileShader(entry.shader, vcode.GetBuffer(), pcode.GetBuffer(), gcode.GetBuffer());
+}
+
+SHADER* ProgramShaderCache::CompileShader(const SHADERUID& uid)
+{
+	// Check if shader is already in cache
+	PCacheEntry& newentry = pshaders->GetOrAdd(uid);
+	last_entry = &newentry;
+	if (!newentry.shader.glprogid && !newentry.pending && !CreateProgram(newentry, uid))
 	{
 		GFX_DEBUGGER_PAUSE_AT(NEXT_ERROR, true);
 		return nullptr;
 	}
 
-	INCSTAT(stats.numPixelShadersCreated);
-	SETSTAT(stats.numPixelShadersAlive, static_cast<int>(pshaders->size()));
-	GFX_DEBUGGER_PAUSE_AT(NEXT_PIXEL_SHADER_CHANGE, true);
+	// Under full async the draw is skipped until the driver is done with the program.
+	if (!ResolveEntry(newentry, uid, !g_ActiveConfig.bFullAsyncShaderCompilation))
+	{
+		if (!newentry.pending)
+			GFX_DEBUGGER_PAUSE_AT(NEXT_ERROR, true);
+		return nullptr;
+	}
 
+	GFX_DEBUGGER_PAUSE_AT(NEXT_PIXEL_SHADER_CHANGE, true);
 	last_entry->shader.Bind();
 	return &last_entry->shader;
 }
@@ -267,7 +493,7 @@ SHADER* ProgramShaderCache::SetShader(PIXEL_SHADER_RENDER_MODE render_mode, u32
 	GetShaderId(&uid, render_mode, components, primitive_type);
 	uid.CalculateHash();
 	// Check if the shader is already set
-	if (last_entry)
+	if (last_entry && !last_entry->pending)
 	{
 		if (uid == last_uid)
 		{
@@ -281,15 +507,15 @@ SHADER* ProgramShaderCache::SetShader(PIXEL_SHADER_RENDER_MODE render_mode, u32
 	return CompileShader(uid);
 }
 
-bool ProgramShaderCache::CompileShader(SHADER& shader, const char* vcode, const char* pcode, const char* gcode, const char **macros, const u32 macro_count)
+bool ProgramShaderCache::CompileShader(SHADER& shader, const char* vcode, const char* pcode, const char* gcode, const char **macros, const u32 macro_count, bool wait)
 {
-	GLuint vsid = CompileSingleShader(GL_VERTEX_SHADER, vcode, macros, macro_count);
-	GLuint psid = CompileSingleShader(GL_FRAGMENT_SHADER, pcode, macros, macro_count);
+	GLuint vsid = CompileSingleShader(GL_VERTEX_SHADER, vcode, macros, macro_count, wait);
+	GLuint psid = CompileSingleShader(GL_FRAGMENT_SHADER, pcode, macros, macro_count, wait);
 
 	// Optional geometry shader
 	GLuint gsid = 0;
 	if (gcode)
-		gsid = CompileSingleShader(GL_GEOMETRY_SHADER, gcode, macros, macro_count);
+		gsid = CompileSingleShader(GL_GEOMETRY_SHADER, gcode, macros, macro_count, wait);
 
 	if (!vsid || !psid || (gcode && !gsid))
 	{
@@ -318,6 +544,9 @@ bool ProgramShaderCache::CompileShader(SHADER& shader, const char* vcode, const
 	glDeleteShader(psid);
 	glDeleteShader(gsid);
 
+	if (!wait)
+		return true;
+
 	GLint linkStatus;
 	glGetProgramiv(pid, GL_LINK_STATUS, &linkStatus);
 	GLsizei length = 0;
@@ -363,8 +592,38 @@ bool ProgramShaderCache::CompileShader(SHADER& shader, const char* vcode, const
 	return true;
 }
 
+bool ProgramShaderCache::CompileComputeShader(SHADER& shader, const char* code)
+{
+	GLuint csid = CompileSingleShader(GL_COMPUTE_SHADER, code);
+	if (!csid)
+		return false;
+
+	GLuint pid = shader.glprogid = glCreateProgram();
+	glAttachShader(pid, csid);
+	glLinkProgram(pid);
+	glDeleteShader(csid);
+
+	GLint linkStatus;
+	glGetProgramiv(pid, GL_LINK_STATUS, &linkStatus);
+	if (linkStatus != GL_TRUE)
+	{
+		GLsizei length = 0;
+		glGetProgramiv(pid, GL_INFO_LOG_LENGTH, &length);
+		std::vector<GLchar> infoLog(std::max(length, 1));
+		glGetProgramInfoLog(pid, length, nullptr, infoLog.data());
+		ERROR_LOG(VIDEO, "Compute program linking failed:\n%s", infoLog.data());
+
+		glDeleteProgram(pid);
+		shader.glprogid = 0;
+		return false;
+	}
+
+	shader.SetProgramVariables();
+	return true;
+}
+
 GLuint ProgramShaderCache::CompileSingleShader(GLuint type, const char* code, const char **macros,
-	const u32 count)
+	const u32 count, bool check_status)
 {
 	GLuint result = glCreateShader(type);
 	std::vector<const char*> src(count + 2);
@@ -376,6 +635,9 @@ GLuint ProgramShaderCache::CompileSingleShader(GLuint type, const char* code, co
 	src[count + 2 - 1] = code;
 	glShaderSource(result, count + 2, src.data(), nullptr);
 	glCompileShader(result);
+	if (!check_status)
+		return result;
+
 	GLint compileStatus;
 	glGetShaderiv(result, GL_COMPILE_STATUS, &compileStatus);
 	GLsizei length = 0;
@@ -386,11 +648,11 @@ GLuint ProgramShaderCache::CompileSingleShader(GLuint type, const char* code, co
 		GLsizei charsWritten;
 		GLchar* infoLog = new GLchar[length];
 		glGetShaderInfoLog(result, length, &charsWritten, infoLog);
-		ERROR_LOG(VIDEO, "%s Shader info log:\n%s", type == GL_VERTEX_SHADER ? "VS" : type == GL_FRAGMENT_SHADER ? "PS" : "GS", infoLog);
+		ERROR_LOG(VIDEO, "%s Shader info log:\n%s", type == GL_VERTEX_SHADER ? "VS" : type == GL_FRAGMENT_SHADER ? "PS" : type == GL_COMPUTE_SHADER ? "CS" : "GS", infoLog);
 
 		std::string filename = StringFromFormat("%sbad_%s_%04i.txt",
 			File::GetUserPath(D_DUMP_IDX).c_str(),
-			type == GL_VERTEX_SHADER ? "vs" : type == GL_FRAGMENT_SHADER ? "ps" : "gs",
+			type == GL_VERTEX_SHADER ? "vs" : type == GL_FRAGMENT_SHADER ? "ps" : type == GL_COMPUTE_SHADER ? "cs" : "gs",
 			num_failures++);
 		std::ofstream file;
 		OpenFStream(file, filename, std::ios_base::out);
@@ -401,7 +663,7 @@ GLuint ProgramShaderCache::CompileSingleShader(GLuint type, const char* code, co
 		{
 			PanicAlert("Failed to compile %s shader: %s\n"
 				"Debug info (%s, %s, %s):\n%s",
-				type == GL_VERTEX_SHADER ? "vertex" : type == GL_FRAGMENT_SHADER ? "pixel" : "geometry",
+				type == GL_VERTEX_SHADER ? "vertex" : type == GL_FRAGMENT_SHADER ? "pixel" : type == GL_COMPUTE_SHADER ? "compute" : "geometry",
 				filename.c_str(),
 				g_ogl_config.gl_vendor, g_ogl_config.gl_renderer, g_ogl_config.gl_version, infoLog);
 		}
@@ -425,6 +687,15 @@ void ProgramShaderCache::GetShaderId(SHADERUID* uid, PIXEL_SHADER_RENDER_MODE re
 {
 	GetPixelShaderUID(uid->puid, render_mode, components, xfmem, bpmem);
 	GetVertexShaderUID(uid->vuid, components, xfmem, bpmem);
+	if (IsVertexShaderStereo(primitive_type) || IsVertexShaderExpand(primitive_type))
+	{
+		vertex_shader_uid_data& vuid_data = uid->vuid.GetUidData<vertex_shader_uid_data>();
+		vuid_data.stereo = IsVertexShaderStereo(primitive_type);
+		if (IsVertexShaderExpand(primitive_type))
+			vuid_data.vertex_expand = primitive_type == PRIMITIVE_LINES ? VSEXPAND_LINES : VSEXPAND_POINTS;
+		uid->vuid.ClearHASH();
+		uid->vuid.CalculateUIDHash();
+	}
 	GetGeometryShaderUid(uid->guid, primitive_type, xfmem, components);
 }
 
@@ -452,6 +723,11 @@ void ProgramShaderCache::Init()
 	s_buffer.reset();
 
 	s_buffer = StreamBuffer::Create(GL_UNIFORM_BUFFER, s_ubo_buffer_size * 2048);
+	s_constants_uploaded = false;
+
+	// Let the driver use as many compiler threads as it likes.
+	if (g_ogl_config.bSupportsParallelShaderCompile)
+		glMaxShaderCompilerThreads(0xFFFFFFFF);
 
 	pKey_t gameid = (pKey_t)GetMurmurHash3(reinterpret_cast<const u8*>(SConfig::GetInstance().m_strGameID.data()), (u32)SConfig::GetInstance().m_strGameID.size(), 0);
 	pshaders = PCache::Create(
@@ -479,8 +755,13 @@ void ProgramShaderCache::Init()
 			std::string cache_filename = StringFromFormat("%sIOGL-%s-shaders.cache", File::GetUserPath(D_SHADERCACHE_IDX).c_str(),
 				SConfig::GetInstance().m_strGameID.c_str());
 
+			s_binary_loader = ProgramBinaryLoader::Create();
 			ProgramShaderCacheInserter inserter;
 			g_program_disk_cache.OpenAndRead(cache_filename, inserter);
+			if (s_binary_loader && s_binary_loader->Empty())
+				s_binary_loader.reset();
+			else if (s_binary_loader)
+				s_binary_loader->Start();
 		}
 		SETSTAT(stats.numPixelShadersAlive, pshaders->size());
 	}
@@ -491,35 +772,39 @@ void ProgramShaderCache::Init()
 	last_entry = nullptr;
 	if (g_ActiveConfig.bCompileShaderOnStartup)
 	{
-		size_t shader_count = 0;
-		pshaders->ForEachMostUsedByCategory(gameid,
-			[&](const SHADERUID& it, size_t total)
+		std::vector<SHADERUID> uids = ShaderPrecompiler::CollectUids<SHADERUID>(*pshaders, gameid,
+			[](PCacheEntry& entry) { return !entry.shader.glprogid && !entry.pending; });
+		uids.erase(std::remove_if(uids.begin(), uids.end(), [](const SHADERUID& uid)
 		{
-			SHADERUID item = it;
-			item.puid.ClearHASH();
-			item.puid.CalculateUIDHash();
-			const pixel_shader_uid_data& uid_data = item.puid.GetUidData();
-			shader_count++;
-			if ((!uid_data.stereo || g_ActiveConfig.backend_info.bSupportsGeometryShaders)
-				&& (!uid_data.bounding_box || g_ActiveConfig.backend_info.bSupportsBBox))
-			{
-				Host_UpdateTitle(StringFromFormat("Compiling Shaders %zu %% (%zu/%zu)", (shader_count * 100) / total, shader_count, total));
-				CompileShader(item);
-			}
-		},
-			[](PCacheEntry& entry)
+			const pixel_shader_uid_data& uid_data = uid.puid.GetUidData();
+			return (uid_data.stereo && !g_ActiveConfig.backend_info.bSupportsGeometryShaders)
+				|| (uid.vuid.GetUidData().stereo && !g_ActiveConfig.backend_info.bSupportsVSLayerOutput)
+				|| (uid.vuid.GetUidData().vertex_expand && !g_ActiveConfig.backend_info.bSupportsVSLinePointExpand)
+				|| (uid_data.bounding_box && !g_ActiveConfig.backend_info.bSupportsBBox);
+		}), uids.end());
+
+		// Links need the GL context, so they are issued on the video thread. They are resolved when
+		// the programs are used.
+		ShaderPrecompiler::Job job;
+		job.name = "Shaders";
+		job.count = uids.size();
+		job.compile = [uids = std::move(uids)](size_t index)
 		{
-			return !entry.shader.glprogid;
-		}
-		, true);
+			PCacheEntry& entry = pshaders->GetOrAdd(uids[index]);
+			if (!entry.shader.glprogid && !entry.pending)
+				CreateProgram(entry, uids[index]);
+		};
+		ShaderPrecompiler::Run({ std::move(job) });
 	}
 }
 
 void ProgramShaderCache::Shutdown()
 {
+	ShaderPrecompiler::Cancel();
 	// store all shaders in cache on disk
 	if (g_ogl_config.bSupportsGLSLCache)
 	{
+		s_binary_loader.reset();
 		pshaders->Persist();
 		pshaders->Clear(
 			[&](const SHADERUID& uid, PCacheEntry& entry)
@@ -614,12 +899,14 @@ void ProgramShaderCache::CreateHeader()
 		"%s\n" // Varying location
 		"%s\n" // storage buffer
 		"%s\n" // shader5
+		"%s\n" // vertex shader layer
 		"%s\n" // SSAA
 		"%s\n" // Geometry point size
 		"%s\n" // AEP
 		"%s\n" // texture buffer
 		"%s\n" // ES texture buffer
 		"%s\n" // ES dual source blend
+		"%s\n" // compute shaders
 
 		// Precision defines for GLSL ES
 		"%s\n"
@@ -682,12 +969,17 @@ void ProgramShaderCache::CreateHeader()
 		, "#define VARYING_LOCATION(x)\n"
 		, !is_glsles && g_ActiveConfig.backend_info.bSupportsBBox ? "#extension GL_ARB_shader_storage_buffer_object : enable" : ""
 		, !is_glsles && g_ActiveConfig.backend_info.bSupportsGSInstancing ? "#extension GL_ARB_gpu_shader5 : enable" : ""
+		, !g_ActiveConfig.backend_info.bSupportsVSLayerOutput ? "" :
+		GLExtensions::Supports("GL_ARB_shader_viewport_layer_array") ?
+		"#extension GL_ARB_shader_viewport_layer_array : enable" :
+		"#extension GL_AMD_vertex_shader_layer : enable"
 		, SupportedESPointSize.c_str()
 		, g_ogl_config.bSupportsAEP ? "#extension GL_ANDROID_extension_pack_es31a : enable" : ""
 		, v < GLSL_140 && g_ActiveConfig.backend_info.bSupportsPaletteConversion ? "#extension GL_ARB_texture_buffer_object : enable" : ""
 		, v < GLSL_400 && g_ActiveConfig.backend_info.bSupportsSSAA ? "#extension GL_ARB_sample_shading : enable" : ""
 		, SupportedESTextureBuffer.c_str()
 		, is_glsles && g_ActiveConfig.backend_info.bSupportsDualSourceBlend ? "#extension GL_EXT_blend_func_extended : enable" : ""
+		, !is_glsles && g_ActiveConfig.backend_info.bSupportsComputeTextureDecoding ? "#extension GL_ARB_compute_shader : enable\n#extension GL_ARB_shader_image_load_store : enable" : ""
 		, is_glsles ? "precision highp float;" : ""
 		, is_glsles ? "precision highp int;" : ""
 		, is_glsles ? "precision highp sampler2DArray;" : ""
@@ -709,21 +1001,15 @@ void ProgramShaderCache::ProgramShaderCacheInserter::Read(const SHADERUID& key,
 
 	PCacheEntry& entry = pshaders->GetOrAdd(key);
 	entry.in_cache = 1;
-	entry.shader.glprogid = glCreateProgram();
-	glProgramBinary(entry.shader.glprogid, *prog_format, binary, binary_size);
-
-	GLint success;
-	glGetProgramiv(entry.shader.glprogid, GL_LINK_STATUS, &success);
-
-	if (success)
+	// The link status is checked on first use, so the driver can validate the binaries in parallel.
+	entry.pending = true;
+	if (s_binary_loader)
 	{
-		entry.shader.SetProgramVariables();
-	}
-	else
-	{
-		glDeleteProgram(entry.shader.glprogid);
-		entry.shader.glprogid = 0;
+		s_binary_loader->Add(&entry, *prog_format, binary, binary_size);
+		return;
 	}
+	entry.shader.glprogid = glCreateProgram();
+	glProgramBinary(entry.shader.glprogid, *prog_format, binary, binary_size);
 }
 
 
@@ -31,6 +31,20 @@ public:
 		GeometryShaderUid::ShaderUidHasher gshasher;
 		hash = vshasher(vuid) ^ pshasher(puid) ^ gshasher(guid);
 	}
+	// The hashes aren't part of the stored usage profile
+	void ClearHASH()
+	{
+		vuid.ClearHASH();
+		puid.ClearHASH();
+		guid.ClearHASH();
+	}
+	void CalculateUIDHash()
+	{
+		vuid.CalculateUIDHash();
+		puid.CalculateUIDHash();
+		guid.CalculateUIDHash();
+		CalculateHash();
+	}
 	bool operator <(const SHADERUID& r) const
 	{
 		if (puid < r.puid)
@@ -68,7 +82,7 @@ public:
 
 struct SHADER
 {
-	SHADER() : glprogid(0)
+	SHADER() : glprogid(0), vertex_expand_location(-1)
 	{}
 	void Destroy()
 	{
@@ -76,6 +90,8 @@ struct SHADER
 		glprogid = 0;
 	}
 	GLuint glprogid; // OpenGL program id
+	// I_VTXEXPAND, -1 unless the vertex shader expands lines or points
+	GLint vertex_expand_location;
 
 	void SetProgramVariables();
 	void SetProgramBindings();
@@ -89,7 +105,10 @@ public:
 	struct PCacheEntry
 	{
 		SHADER shader;
-		bool in_cache;
+		bool in_cache = false;
+		// The link or binary upload was issued but its result wasn't read back yet,
+		// a pending entry mustn't be bound before ResolveEntry succeeded.
+		bool pending = false;
 
 		void Destroy()
 		{
@@ -105,8 +124,10 @@ public:
 	static SHADER* CompileShader(const SHADERUID& uid);
 	static void GetShaderId(SHADERUID *uid, PIXEL_SHADER_RENDER_MODE render_mode, u32 components, u32 primitive_type);
 
-	static bool CompileShader(SHADER &shader, const char* vcode, const char* pcode, const char* gcode = nullptr, const char **macros = nullptr, const u32 macro_count = 0);
-	static GLuint CompileSingleShader(GLuint type, const char *code, const char **macros = nullptr, const u32 count = 0);
+	// With wait = false the link is only issued, the caller has to check GL_LINK_STATUS itself.
+	static bool CompileShader(SHADER &shader, const char* vcode, const char* pcode, const char* gcode = nullptr, const char **macros = nullptr, const u32 macro_count = 0, bool wait = true);
+	static bool CompileComputeShader(SHADER& shader, const char* code);
+	static GLuint CompileSingleShader(GLuint type, const char *code, const char **macros = nullptr, const u32 count = 0, bool check_status = true);
 	static void UploadConstants();
 
 	static void Init();
@@ -122,6 +143,10 @@ private:
 		void Read(const SHADERUID &key, const u8 *value, u32 value_size) override;
 	};
 
+	static void GenerateShaderCode(const SHADERUID& uid, ShaderCode& vcode, ShaderCode& pcode, ShaderCode& gcode);
+	static bool CreateProgram(PCacheEntry& entry, const SHADERUID& uid);
+	static bool ResolveEntry(PCacheEntry& entry, const SHADERUID& uid, bool wait);
+
 	static PCache* pshaders;
 	static PCacheEntry* last_entry;
 	static SHADERUID last_uid;
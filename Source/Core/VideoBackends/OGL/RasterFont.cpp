@@ -2,6 +2,7 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <cstddef>
 #include <vector>
 
 #include "Common/Common.h"
@@ -120,22 +121,24 @@ static const u8 rasters[CHAR_COUNT][CHAR_HEIGHT] = {
 
 static const char *s_vertexShaderSrc =
 "uniform vec2 charSize;\n"
-"uniform vec2 offset;"
 "in vec2 rawpos;\n"
 "in vec2 tex0;\n"
+"in vec4 color0;\n"
 "out vec2 uv0;\n"
+"out vec4 col0;\n"
 "void main(void) {\n"
-"	gl_Position = vec4(rawpos + offset,0,1);\n"
+"	gl_Position = vec4(rawpos,0,1);\n"
 "	uv0 = tex0 * charSize;\n"
+"	col0 = color0;\n"
 "}\n";
 
 static const char *s_fragmentShaderSrc =
 "SAMPLER_BINDING(8) uniform sampler2D samp8;\n"
-"uniform vec4 color;\n"
 "in vec2 uv0;\n"
+"in vec4 col0;\n"
 "out vec4 ocol0;\n"
 "void main(void) {\n"
-"	ocol0 = texture(samp8,uv0) * color;\n"
+"	ocol0 = texture(samp8,uv0) * col0;\n"
 "}\n";
 
 static SHADER s_shader;
@@ -167,10 +170,6 @@ RasterFont::RasterFont()
 
 	// bound uniforms
 	glUniform2f(glGetUniformLocation(s_shader.glprogid, "charSize"), 1.0f / GLfloat(CHAR_COUNT), 1.0f);
-	uniform_color_id = glGetUniformLocation(s_shader.glprogid, "color");
-	glUniform4f(uniform_color_id, 1.0f, 1.0f, 1.0f, 1.0f);
-	uniform_offset_id = glGetUniformLocation(s_shader.glprogid, "offset");
-	glUniform2f(uniform_offset_id, 0.0f, 0.0f);
 
 	// generate VBO & VAO
 	glGenBuffers(1, &VBO);
@@ -178,9 +177,11 @@ RasterFont::RasterFont()
 	glBindBuffer(GL_ARRAY_BUFFER, VBO);
 	glBindVertexArray(VAO);
 	glEnableVertexAttribArray(SHADER_POSITION_ATTRIB);
-	glVertexAttribPointer(SHADER_POSITION_ATTRIB, 2, GL_FLOAT, 0, sizeof(GLfloat) * 4, nullptr);
+	glVertexAttribPointer(SHADER_POSITION_ATTRIB, 2, GL_FLOAT, 0, sizeof(Vertex), (void*)offsetof(Vertex, x));
 	glEnableVertexAttribArray(SHADER_TEXTURE0_ATTRIB);
-	glVertexAttribPointer(SHADER_TEXTURE0_ATTRIB, 2, GL_FLOAT, 0, sizeof(GLfloat) * 4, (GLfloat*)nullptr + 2);
+	glVertexAttribPointer(SHADER_TEXTURE0_ATTRIB, 2, GL_FLOAT, 0, sizeof(Vertex), (void*)offsetof(Vertex, u));
+	glEnableVertexAttribArray(SHADER_COLOR0_ATTRIB);
+	glVertexAttribPointer(SHADER_COLOR0_ATTRIB, 4, GL_UNSIGNED_BYTE, 1, sizeof(Vertex), (void*)offsetof(Vertex, color));
 }
 
 RasterFont::~RasterFont()
@@ -193,13 +194,16 @@ RasterFont::~RasterFont()
 
 void RasterFont::printMultilineText(const std::string& text, double start_x, double start_y, double z, int bbWidth, int bbHeight, u32 color)
 {
-	std::vector<GLfloat> vertices(text.length() * 6 * 4);
-
-	int usage = 0;
 	GLfloat delta_x = GLfloat(2 * CHAR_WIDTH) / GLfloat(bbWidth);
 	GLfloat delta_y = GLfloat(2 * CHAR_HEIGHT) / GLfloat(bbHeight);
 	GLfloat border_x = 2.0f / GLfloat(bbWidth);
 	GLfloat border_y = 4.0f / GLfloat(bbHeight);
+	GLfloat shadow_x = 2.0f / GLfloat(bbWidth);
+	GLfloat shadow_y = -2.0f / GLfloat(bbHeight);
+
+	// color is ARGB, the vertices take RGBA bytes
+	u32 text_color = ((color >> 16) & 0xff) | (color & 0xff00) | ((color & 0xff) << 16) | (color & 0xff000000);
+	u32 shadow_color = color & 0xff000000;
 
 	GLfloat x = GLfloat(start_x);
 	GLfloat y = GLfloat(start_y);
@@ -223,59 +227,45 @@ void RasterFont::printMultilineText(const std::string& text, double start_x, dou
 		if (c < CHAR_OFFSET || c >= CHAR_COUNT + CHAR_OFFSET)
 			continue;
 
-		vertices[usage++] = x;
-		vertices[usage++] = y;
-		vertices[usage++] = GLfloat(c - CHAR_OFFSET);
-		vertices[usage++] = 0.0f;
-
-		vertices[usage++] = x + delta_x;
-		vertices[usage++] = y;
-		vertices[usage++] = GLfloat(c - CHAR_OFFSET + 1);
-		vertices[usage++] = 0.0f;
-
-		vertices[usage++] = x + delta_x;
-		vertices[usage++] = y + delta_y;
-		vertices[usage++] = GLfloat(c - CHAR_OFFSET + 1);
-		vertices[usage++] = 1.0f;
-
-		vertices[usage++] = x;
-		vertices[usage++] = y;
-		vertices[usage++] = GLfloat(c - CHAR_OFFSET);
-		vertices[usage++] = 0.0f;
-
-		vertices[usage++] = x + delta_x;
-		vertices[usage++] = y + delta_y;
-		vertices[usage++] = GLfloat(c - CHAR_OFFSET + 1);
-		vertices[usage++] = 1.0f;
-
-		vertices[usage++] = x;
-		vertices[usage++] = y + delta_y;
-		vertices[usage++] = GLfloat(c - CHAR_OFFSET);
-		vertices[usage++] = 1.0f;
+		GLfloat left = GLfloat(c - CHAR_OFFSET);
+		GLfloat right = GLfloat(c - CHAR_OFFSET + 1);
+		for (int shadow = 1; shadow >= 0; shadow--)
+		{
+			std::vector<Vertex>& batch = shadow ? shadow_vertices : vertices;
+			GLfloat x0 = shadow ? x + shadow_x : x;
+			GLfloat y0 = shadow ? y + shadow_y : y;
+			u32 vertex_color = shadow ? shadow_color : text_color;
+
+			batch.push_back({ x0, y0, left, 0.0f, vertex_color });
+			batch.push_back({ x0 + delta_x, y0, right, 0.0f, vertex_color });
+			batch.push_back({ x0 + delta_x, y0 + delta_y, right, 1.0f, vertex_color });
+			batch.push_back({ x0, y0, left, 0.0f, vertex_color });
+			batch.push_back({ x0 + delta_x, y0 + delta_y, right, 1.0f, vertex_color });
+			batch.push_back({ x0, y0 + delta_y, left, 1.0f, vertex_color });
+		}
 
 		x += delta_x + border_x;
 	}
+}
 
-	if (!usage)
-	{
+void RasterFont::Flush()
+{
+	if (vertices.empty())
 		return;
-	}
+
+	shadow_vertices.insert(shadow_vertices.end(), vertices.begin(), vertices.end());
+
 	glActiveTexture(GL_TEXTURE8);
 	glBindTexture(GL_TEXTURE_2D, texture);
 	glBindVertexArray(VAO);
 	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	glBufferData(GL_ARRAY_BUFFER, usage * sizeof(GLfloat), vertices.data(), GL_STREAM_DRAW);
+	glBufferData(GL_ARRAY_BUFFER, shadow_vertices.size() * sizeof(Vertex), shadow_vertices.data(), GL_STREAM_DRAW);
 
 	s_shader.Bind();
+	glDrawArrays(GL_TRIANGLES, 0, GLsizei(shadow_vertices.size()));
 
-	// shadows
-	glUniform2f(uniform_offset_id, 2.0f / GLfloat(bbWidth), -2.0f / GLfloat(bbHeight));
-	glUniform4f(uniform_color_id, 0.0f, 0.0f, 0.0f, GLfloat((color >> 24) & 0xff) / 255.f);
-	glDrawArrays(GL_TRIANGLES, 0, usage / 4);
-
-	glUniform2f(uniform_offset_id, 0.0f, 0.0f);
-	glUniform4f(uniform_color_id, GLfloat((color >> 16) & 0xff) / 255.f, GLfloat((color >> 8) & 0xff) / 255.f, GLfloat((color >> 0) & 0xff) / 255.f, GLfloat((color >> 24) & 0xff) / 255.f);
-	glDrawArrays(GL_TRIANGLES, 0, usage / 4);
+	shadow_vertices.clear();
+	vertices.clear();
 }
 
 }
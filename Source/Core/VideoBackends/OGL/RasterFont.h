@@ -5,6 +5,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include "Common/CommonTypes.h"
 
@@ -18,14 +19,24 @@ public:
 	~RasterFont();
 	static int debug;
 
+	// Adds the text to the batch drawn by Flush
 	void printMultilineText(const std::string& text, double x, double y, double z, int bbWidth, int bbHeight, u32 color);
+	// Draws all the text printed since the last flush with a single draw call
+	void Flush();
 private:
+	struct Vertex
+	{
+		float x, y;
+		float u, v;
+		u32 color;
+	};
 
 	u32 VBO;
 	u32 VAO;
 	u32 texture;
-	u32 uniform_color_id;
-	u32 uniform_offset_id;
+	// The shadows of all the glyphs are drawn before the glyphs themselves
+	std::vector<Vertex> shadow_vertices;
+	std::vector<Vertex> vertices;
 };
 
 }
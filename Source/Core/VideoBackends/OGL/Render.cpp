@@ -36,6 +36,7 @@
 #include "VideoCommon/BPFunctions.h"
 #include "VideoCommon/DriverDetails.h"
 #include "VideoCommon/Fifo.h"
+#include "VideoCommon/GPUProfilerBase.h"
 #include "VideoCommon/IndexGenerator.h"
 #include "VideoCommon/OnScreenDisplay.h"
 #include "VideoCommon/PixelEngine.h"
@@ -67,6 +68,8 @@ static bool s_last_xfb_mode = false;
 static u32 s_blendMode;
 
 static bool s_vsync;
+// Signaled when the previous frame was finished by the GPU, for low latency presentation.
+static GLsync s_last_frame_fence = 0;
 
 // EFB cache related
 static const u32 EFB_CACHE_RECT_SIZE = 64;  // Cache 64x64 blocks.
@@ -481,6 +484,7 @@ Renderer::Renderer()
 		GLExtensions::Supports("GL_OES_draw_elements_base_vertex");
 	g_ogl_config.bSupportsGLBufferStorage = GLExtensions::Supports("GL_ARB_buffer_storage") ||
 		GLExtensions::Supports("GL_EXT_buffer_storage");
+	g_ogl_config.bSupportsMultiBind = GLExtensions::Supports("GL_ARB_multi_bind");
 	g_ogl_config.bSupportsMSAA = GLExtensions::Supports("GL_ARB_texture_multisample");
 	g_ogl_config.bSupportViewportFloat = GLExtensions::Supports("GL_ARB_viewport_array");
 	g_ogl_config.bSupportsDebug =
@@ -494,6 +498,13 @@ Renderer::Renderer()
 		GLExtensions::Supports("GL_ARB_shader_image_load_store");
 	g_ogl_config.bSupportsConservativeDepth = GLExtensions::Supports("GL_ARB_conservative_depth");
 	g_ogl_config.bSupportsAniso = GLExtensions::Supports("GL_EXT_texture_filter_anisotropic");
+	g_ogl_config.bSupportsParallelShaderCompile =
+		GLExtensions::Supports("GL_KHR_parallel_shader_compile") ||
+		GLExtensions::Supports("GL_ARB_parallel_shader_compile");
+	g_Config.backend_info.bSupportsPrimitiveRestart =
+		!DriverDetails::HasBug(DriverDetails::BUG_PRIMITIVE_RESTART) &&
+		((GLInterface->GetMode() == GLInterfaceMode::MODE_OPENGLES3) ||
+			GLExtensions::Version() >= 310 || GLExtensions::Supports("GL_NV_primitive_restart"));
 
 	if (GLInterface->GetMode() == GLInterfaceMode::MODE_OPENGLES3)
 	{
@@ -608,9 +619,45 @@ Renderer::Renderer()
 		g_Config.backend_info.bSupportedFormats[PC_TEX_FMT_DXT1] = GLExtensions::Supports("GL_EXT_texture_compression_s3tc");
 		g_Config.backend_info.bSupportedFormats[PC_TEX_FMT_DXT3] = g_Config.backend_info.bSupportedFormats[PC_TEX_FMT_DXT1];
 		g_Config.backend_info.bSupportedFormats[PC_TEX_FMT_DXT5] = g_Config.backend_info.bSupportedFormats[PC_TEX_FMT_DXT1];
+		// RGTC is core since 3.0, BPTC since 4.2
+		g_Config.backend_info.bSupportedFormats[PC_TEX_FMT_BC5] = true;
+		g_Config.backend_info.bSupportedFormats[PC_TEX_FMT_BC7] = GLExtensions::Supports("GL_ARB_texture_compression_bptc") ||
+			GLExtensions::Version() >= 420;
 
 		// Desktop OpenGL can't have the Android Extension Pack
 		g_ogl_config.bSupportsAEP = false;
+
+		// The decoders read texel buffers and need the layout keyword for the image format.
+		g_Config.backend_info.bSupportsComputeTextureDecoding =
+			g_ogl_config.eSupportedGLSLVersion >= GLSL_150 &&
+			g_Config.backend_info.bSupportsPaletteConversion &&
+			GLExtensions::Supports("GL_ARB_compute_shader") &&
+			GLExtensions::Supports("GL_ARB_shader_image_load_store");
+
+		// Compute passes store into the layered pass outputs, the extensions are enabled along
+		// with the decoders.
+		g_Config.backend_info.bSupportsPostProcessingCompute =
+			g_Config.backend_info.bSupportsComputeTextureDecoding;
+
+		// Stereo triangles are sent to both eyes by an instanced draw whose vertex shader selects the
+		// layer, which needs the layered EFB of the geometry shader path.
+		g_Config.backend_info.bSupportsVSLayerOutput =
+			g_Config.backend_info.bSupportsGeometryShaders &&
+			(GLExtensions::Supports("GL_ARB_shader_viewport_layer_array") ||
+				GLExtensions::Supports("GL_AMD_vertex_shader_layer"));
+	}
+
+	// Lines and points expanded in the vertex shader read the index and vertex stream buffers as
+	// storage buffers, bound by the binding layout.
+	if (g_Config.backend_info.bSupportsBBox && g_Config.backend_info.bSupportsBindingLayout)
+	{
+		GLint max_vertex_blocks = 0;
+		glGetIntegerv(GL_MAX_VERTEX_SHADER_STORAGE_BLOCKS, &max_vertex_blocks);
+		g_Config.backend_info.bSupportsVSLinePointExpand = max_vertex_blocks >= 2;
+	}
+	else
+	{
+		g_Config.backend_info.bSupportsVSLinePointExpand = false;
 	}
 
 	// Either method can do early-z tests. See PixelShaderGen for details.
@@ -667,7 +714,7 @@ Renderer::Renderer()
 		g_ogl_config.gl_renderer, g_ogl_config.gl_version),
 		5000);
 
-	WARN_LOG(VIDEO, "Missing OGL Extensions: %s%s%s%s%s%s%s%s%s%s%s%s%s",
+	WARN_LOG(VIDEO, "Missing OGL Extensions: %s%s%s%s%s%s%s%s%s%s%s%s%s%s%s",
 		g_ActiveConfig.backend_info.bSupportsDualSourceBlend ? "" : "DualSourceBlend ",
 		g_ActiveConfig.backend_info.bSupportsEarlyZ ? "" : "EarlyZ ",
 		g_ogl_config.bSupportsGLPinnedMemory ? "" : "PinnedMemory ",
@@ -677,6 +724,8 @@ Renderer::Renderer()
 		g_ogl_config.bSupportsGLSync ? "" : "Sync ", g_ogl_config.bSupportsMSAA ? "" : "MSAA ",
 		g_ActiveConfig.backend_info.bSupportsSSAA ? "" : "SSAA ",
 		g_ActiveConfig.backend_info.bSupportsGSInstancing ? "" : "GSInstancing ",
+		g_ActiveConfig.backend_info.bSupportsVSLayerOutput ? "" : "VSLayerOutput ",
+		g_ActiveConfig.backend_info.bSupportsVSLinePointExpand ? "" : "VSLinePointExpand ",
 		g_ActiveConfig.backend_info.bSupportsClipControl ? "" : "ClipControl ",
 		g_ogl_config.bSupportsCopySubImage ? "" : "CopyImageSubData ",
 		g_ActiveConfig.backend_info.bSupportsDepthClamp ? "" : "DepthClamp ");
@@ -729,6 +778,31 @@ Renderer::Renderer()
 		glEnable(GL_DEPTH_CLAMP);
 	}
 
+	if (g_ActiveConfig.backend_info.bSupportsPrimitiveRestart)
+	{
+		if (GLInterface->GetMode() == GLInterfaceMode::MODE_OPENGLES3)
+		{
+			// GLES 3 only has the fixed index, the largest value of the index type.
+			glEnable(GL_PRIMITIVE_RESTART_FIXED_INDEX);
+		}
+		else
+		{
+			// The vertex manager, which sets up the index generator, doesn't exist yet
+			const GLuint restart_index = g_ActiveConfig.backend_info.bSupports32BitIndices ?
+				0xFFFFFFFF : IndexGenerator::PRIMITIVE_RESTART_INDEX;
+			if (GLExtensions::Version() >= 310)
+			{
+				glEnable(GL_PRIMITIVE_RESTART);
+				glPrimitiveRestartIndex(restart_index);
+			}
+			else
+			{
+				glEnableClientState(GL_PRIMITIVE_RESTART_NV);
+				glPrimitiveRestartIndexNV(restart_index);
+			}
+		}
+	}
+
 	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);  // 4-byte pixel alignment
 
 	glDisable(GL_STENCIL_TEST);
@@ -768,6 +842,12 @@ void Renderer::Shutdown()
 	s_raster_font.reset();
 	m_post_processor.reset();
 
+	if (s_last_frame_fence)
+	{
+		glDeleteSync(s_last_frame_fence);
+		s_last_frame_fence = 0;
+	}
+
 	OpenGL_DeleteAttributelessVAO();
 }
 
@@ -859,6 +939,23 @@ void ClearEFBCache()
 	}
 }
 
+void ClearEFBCache(const EFBRectangle& rc)
+{
+	if (s_efbCacheIsCleared || rc.left >= rc.right || rc.top >= rc.bottom)
+		return;
+
+	const u32 right = std::min<u32>((rc.right - 1) / EFB_CACHE_RECT_SIZE, EFB_CACHE_WIDTH - 1);
+	const u32 bottom = std::min<u32>((rc.bottom - 1) / EFB_CACHE_RECT_SIZE, EFB_CACHE_HEIGHT - 1);
+	for (u32 y = rc.top / EFB_CACHE_RECT_SIZE; y <= bottom; y++)
+	{
+		for (u32 x = rc.left / EFB_CACHE_RECT_SIZE; x <= right; x++)
+		{
+			s_efbCacheValid[0][y * EFB_CACHE_WIDTH + x] = false;
+			s_efbCacheValid[1][y * EFB_CACHE_WIDTH + x] = false;
+		}
+	}
+}
+
 void Renderer::UpdateEFBCache(EFBAccessType type, u32 cacheRectIdx, const EFBRectangle& efbPixelRc,
 	const TargetRectangle& targetPixelRc, const void* data)
 {
@@ -1215,7 +1312,8 @@ void Renderer::ClearScreen(const EFBRectangle& rc, bool colorEnable, bool alphaE
 
 	RestoreAPIState();
 
-	ClearEFBCache();
+	ClearEFBCache(rc);
+	FramebufferManager::InvalidateResolvedEFB(rc, colorEnable || alphaEnable, zEnable);
 }
 
 void Renderer::BlitScreen(const TargetRectangle& dst_rect, const TargetRectangle& src_rect, const TargetSize& src_size, GLuint src_texture, GLuint src_depth_texture, float gamma)
@@ -1421,6 +1519,8 @@ void Renderer::SwapImpl(u32 xfbAddr, u32 fbWidth, u32 fbStride, u32 fbHeight,
 
 	if (g_ActiveConfig.bUseXFB)
 	{
+		SetGPUPass(GPU_PASS_PRESENT);
+
 		// draw each xfb source
 		for (u32 i = 0; i < xfbCount; ++i)
 		{
@@ -1479,6 +1579,7 @@ void Renderer::SwapImpl(u32 xfbAddr, u32 fbWidth, u32 fbStride, u32 fbHeight,
 	}
 	else
 	{
+		SetGPUPass(GPU_PASS_POST_PROCESSING);
 		m_post_processor->OnEndFrame();
 		TargetRectangle target_rc = ConvertEFBRectangle(rc);
 
@@ -1506,6 +1607,7 @@ void Renderer::SwapImpl(u32 xfbAddr, u32 fbWidth, u32 fbStride, u32 fbHeight,
 		if (!depth_tex && (m_post_processor->GetScalingShaderConfig()->RequiresDepthBuffer() || (m_post_processor->ShouldTriggerAfterBlit() && m_post_processor->RequiresDepthBuffer())))
 			depth_tex = FramebufferManager::ResolveAndGetDepthTarget(rc);
 
+		SetGPUPass(GPU_PASS_PRESENT);
 		BlitScreen(flipped_trc, target_rc, tex_size, tex, depth_tex, Gamma);
 	}
 
@@ -1600,6 +1702,7 @@ void Renderer::SwapImpl(u32 xfbAddr, u32 fbWidth, u32 fbStride, u32 fbHeight,
 	// Do our OSD callbacks
 	OSD::DoCallbacks(OSD::CallbackType::OnFrame);
 	OSD::DrawMessages();
+	s_raster_font->Flush();
 
 #ifdef ANDROID
 	if (s_surface_needs_change.IsSet())
@@ -1612,9 +1715,24 @@ void Renderer::SwapImpl(u32 xfbAddr, u32 fbWidth, u32 fbStride, u32 fbHeight,
 	}
 #endif
 
+	if (g_gpu_profiler)
+		g_gpu_profiler->EndFrame();
+
 	// Copy the rendered frame to the real window
 	GLInterface->Swap();
 
+	// In low latency mode the next frame is only started once the GPU finished the previous one,
+	// so the driver does not queue frames behind the one being shown.
+	if (s_last_frame_fence)
+	{
+		if (g_ActiveConfig.bLowLatencyPresent)
+			glClientWaitSync(s_last_frame_fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+		glDeleteSync(s_last_frame_fence);
+		s_last_frame_fence = 0;
+	}
+	if (g_ActiveConfig.bLowLatencyPresent && g_ogl_config.bSupportsGLSync)
+		s_last_frame_fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
 	// Clear framebuffer
 	glClearColor(0, 0, 0, 0);
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -1650,6 +1768,8 @@ void Renderer::SwapImpl(u32 xfbAddr, u32 fbWidth, u32 fbStride, u32 fbHeight,
 	// if the configuration has changed, reload post processor (can fail, which will deactivate it)
 	if (m_post_processor->RequiresReload())
 		m_post_processor->ReloadShaders();
+	if (m_post_processor->PendingShadersReady())
+		m_post_processor->ActivatePendingShaders();
 }
 
 void Renderer::FlushFrameDump()
@@ -1657,7 +1777,6 @@ void Renderer::FlushFrameDump()
 	if (!m_last_frame_exported)
 		return;
 
-	FinishFrameData();
 	glBindBuffer(GL_PIXEL_PACK_BUFFER, m_frame_dumping_pbo[0]);
 	m_frame_pbo_is_mapped[0] = true;
 	void* data = glMapBufferRange(
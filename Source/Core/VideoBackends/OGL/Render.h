@@ -11,6 +11,8 @@
 namespace OGL
 {
 void ClearEFBCache();
+// Only drops the cached tiles overlapping rc
+void ClearEFBCache(const EFBRectangle& rc);
 
 enum GLSL_VERSION
 {
@@ -39,6 +41,7 @@ struct VideoConfig
 	bool bSupportsGLSync;
 	bool bSupportsGLBaseVertex;
 	bool bSupportsGLBufferStorage;
+	bool bSupportsMultiBind;
 	bool bSupportsMSAA;
 	GLSL_VERSION eSupportedGLSLVersion;
 	bool bSupportViewportFloat;
@@ -52,6 +55,7 @@ struct VideoConfig
 	bool bSupportsEarlyFragmentTests;
 	bool bSupportsConservativeDepth;
 	bool bSupportsAniso;
+	bool bSupportsParallelShaderCompile;
 
 	const char* gl_vendor;
 	const char* gl_renderer;
@@ -2,6 +2,8 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
+
 #include "Common/CommonFuncs.h"
 #include "Common/CommonTypes.h"
 #include "Common/GL/GLInterfaceBase.h"
@@ -81,7 +83,16 @@ void SamplerCache::SetSamplerState(int stage, const TexMode0& tm0, const TexMode
 		// Active sampler does not match parameters (or is invalid), bind the proper one.
 		active_sampler.first = params;
 		active_sampler.second = GetEntry(params);
-		glBindSampler(stage, active_sampler.second.sampler_id);
+		if (g_ogl_config.bSupportsMultiBind)
+		{
+			m_pending_samplers[stage] = active_sampler.second.sampler_id;
+			m_pending_first = std::min(m_pending_first, stage);
+			m_pending_last = std::max(m_pending_last, stage);
+		}
+		else
+		{
+			glBindSampler(stage, active_sampler.second.sampler_id);
+		}
 	}
 	if (custom_tex)
 	{
@@ -171,6 +182,24 @@ void SamplerCache::Clear()
 		glDeleteSamplers(1, &p.second.sampler_id);
 	}
 	m_cache.clear();
+	// The deleted samplers may still be active, make the next state bind again
+	for (auto& active_sampler : m_active_samplers)
+		active_sampler = {};
+	for (auto& sampler : m_pending_samplers)
+		sampler = 0;
+	m_pending_first = 8;
+	m_pending_last = -1;
+}
+
+void SamplerCache::ApplyBindings()
+{
+	if (m_pending_first > m_pending_last)
+		return;
+
+	glBindSamplers(m_pending_first, m_pending_last - m_pending_first + 1,
+		&m_pending_samplers[m_pending_first]);
+	m_pending_first = 8;
+	m_pending_last = -1;
 }
 
 }
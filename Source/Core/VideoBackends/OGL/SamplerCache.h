@@ -23,6 +23,8 @@ public:
 	void Clear();
 	void BindNearestSampler(int stage);
 	void BindLinearSampler(int stage);
+	// Binds the samplers of the stages changed since the last draw in one call, with multi bind
+	void ApplyBindings();
 
 private:
 	struct Params
@@ -74,6 +76,10 @@ private:
 
 	std::map<Params, Value> m_cache;
 	std::pair<Params, Value> m_active_samplers[8];
+	// With multi bind the stages are bound at the draw, [first, last] of them changed
+	GLuint m_pending_samplers[8] = {};
+	int m_pending_first = 8;
+	int m_pending_last = -1;
 
 	int m_last_max_anisotropy;
 	u32 m_sampler_id[2];
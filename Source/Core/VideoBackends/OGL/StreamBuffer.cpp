@@ -366,7 +366,8 @@ std::unique_ptr<StreamBuffer> StreamBuffer::Create(u32 type, u32 size)
 	{
 		// pinned memory is much faster than buffer storage on AMD cards
 		if (g_ogl_config.bSupportsGLPinnedMemory &&
-			!(DriverDetails::HasBug(DriverDetails::BUG_BROKEN_PINNED_MEMORY) && type == GL_ELEMENT_ARRAY_BUFFER))
+			!(DriverDetails::HasBug(DriverDetails::BUG_BROKEN_PINNED_MEMORY) && type == GL_ELEMENT_ARRAY_BUFFER) &&
+			!(DriverDetails::HasBug(DriverDetails::BUG_SLOW_PINNED_MEMORY) && g_ogl_config.bSupportsGLBufferStorage))
 			return std::make_unique<PinnedMemory>(type, size);
 
 		// buffer storage works well in most situations
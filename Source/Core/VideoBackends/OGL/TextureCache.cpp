@@ -2,6 +2,7 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <cmath>
 #include <fstream>
 #include <memory>
@@ -20,6 +21,7 @@
 
 #include "Core/HW/Memmap.h"
 
+#include "VideoBackends/OGL/CSTextureDecoder.h"
 #include "VideoBackends/OGL/FramebufferManager.h"
 #include "Common/GL/GLInterfaceBase.h"
 #include "VideoBackends/OGL/ProgramShaderCache.h"
@@ -33,6 +35,7 @@
 #include "VideoCommon/HiresTextures.h"
 #include "VideoCommon/ImageWrite.h"
 #include "VideoCommon/Statistics.h"
+#include "VideoCommon/TextureConversionShader.h"
 #include "VideoCommon/TextureDecoder.h"
 #include "VideoCommon/TextureScalerCommon.h"
 #include "VideoCommon/VideoConfig.h"
@@ -57,6 +60,10 @@ static u32 s_DepthCbufid;
 
 static u32 s_Textures[8];
 static u32 s_ActiveTexture;
+// With multi bind the stages are bound at the draw, [first, last] of them changed
+static GLuint s_pending_textures[8];
+static u32 s_pending_first = 8;
+static u32 s_pending_last = 0;
 
 static SHADER s_palette_pixel_shader[3];
 static std::unique_ptr<StreamBuffer> s_palette_stream_buffer;
@@ -65,6 +72,7 @@ static GLuint s_palette_buffer_offset_uniform[3];
 static GLuint s_palette_multiplier_uniform[3];
 static GLuint s_palette_copy_position_uniform[3];
 static std::unique_ptr<TextureScaler> s_scaler;
+static std::unique_ptr<CSTextureDecoder> s_cs_decoder;
 static u32 s_last_pallet_Buffer;
 static TlutFormat s_last_TlutFormat = TlutFormat::GX_TL_IA8;
 bool SaveTexture(const std::string& filename, u32 textarget, u32 tex, int virtual_width, int virtual_height, u32 level, bool compressed)
@@ -86,7 +94,8 @@ bool SaveTexture(const std::string& filename, u32 textarget, u32 tex, int virtua
 	else
 	{
 		glGetTexImage(textarget, level, GL_RGBA, GL_UNSIGNED_BYTE, data.data());
-		saved = TextureToPng(data.data(), width * 4, filename, width, height);
+		TextureToPngAsync(data.data(), width * 4, filename, width, height);
+		saved = true;
 	}
 	TextureCache::SetStage();
 	return saved;
@@ -99,6 +108,9 @@ TextureCache::TCacheEntry::~TCacheEntry()
 		for (auto& gtex : s_Textures)
 			if (gtex == texture)
 				gtex = 0;
+		for (auto& gtex : s_pending_textures)
+			if (gtex == texture)
+				gtex = 0;
 		glDeleteTextures(1, &texture);
 		texture = 0;
 	}
@@ -132,6 +144,16 @@ void TextureCache::TCacheEntry::Bind(u32 stage)
 		glActiveTexture(GL_TEXTURE8 + stage);
 		glBindTexture(GL_TEXTURE_2D_ARRAY, nrm_texture);
 	}
+	if (g_ogl_config.bSupportsMultiBind)
+	{
+		s_pending_textures[stage] = texture;
+		if (s_Textures[stage] != texture)
+		{
+			s_pending_first = std::min(s_pending_first, stage);
+			s_pending_last = std::max(s_pending_last, stage);
+		}
+		return;
+	}
 	if (s_Textures[stage] != texture)
 	{
 		if (s_ActiveTexture != stage)
@@ -152,6 +174,11 @@ bool TextureCache::TCacheEntry::Save(const std::string& filename, u32 level)
 
 PC_TexFormat TextureCache::GetNativeTextureFormat(const s32 texformat, const TlutFormat tlutfmt, u32 width, u32 height)
 {
+	if (s_cs_decoder && g_ActiveConfig.bEnableComputeTextureDecoding &&
+		s_cs_decoder->FormatSupported(texformat))
+	{
+		return PC_TEX_FMT_RGBA32;
+	}
 	const bool compressed_supported = ((width & 3) == 0) && ((height & 3) == 0);
 	PC_TexFormat pcfmt = GetPC_TexFormat(texformat, tlutfmt, compressed_supported);
 	pcfmt = !g_ActiveConfig.backend_info.bSupportedFormats[pcfmt] ? PC_TEX_FMT_RGBA32 : pcfmt;
@@ -223,6 +250,18 @@ void TextureCache::TCacheEntry::SetFormat()
 		gl_type = 0;
 		compressed = true;
 		break;
+	case PC_TEX_FMT_BC5:
+		gl_format = 0;
+		gl_iformat = GL_COMPRESSED_RG_RGTC2;
+		gl_type = 0;
+		compressed = true;
+		break;
+	case PC_TEX_FMT_BC7:
+		gl_format = 0;
+		gl_iformat = GL_COMPRESSED_RGBA_BPTC_UNORM;
+		gl_type = 0;
+		compressed = true;
+		break;
 	case PC_TEX_FMT_R32:
 		gl_format = GL_DEPTH_COMPONENT32F;
 		gl_iformat = GL_DEPTH_COMPONENT;
@@ -327,6 +366,8 @@ void TextureCache::TCacheEntry::Load(const u8* src, u32 width, u32 height,
 	case PC_TEX_FMT_DXT1:
 	case PC_TEX_FMT_DXT3:
 	case PC_TEX_FMT_DXT5:
+	case PC_TEX_FMT_BC5:
+	case PC_TEX_FMT_BC7:
 	{
 		if (expanded_width != width)
 		{
@@ -374,6 +415,8 @@ void TextureCache::TCacheEntry::LoadMaterialMap(const u8* src, u32 width, u32 he
 	case PC_TEX_FMT_DXT1:
 	case PC_TEX_FMT_DXT3:
 	case PC_TEX_FMT_DXT5:
+	case PC_TEX_FMT_BC5:
+	case PC_TEX_FMT_BC7:
 	{
 		glCompressedTexImage3D(GL_TEXTURE_2D_ARRAY, level, gl_iformat,
 			width, height, 1, 0, ((width + 3) >> 2) * ((height + 3) >> 2) * blocksize, src);
@@ -389,10 +432,25 @@ void TextureCache::TCacheEntry::LoadMaterialMap(const u8* src, u32 width, u32 he
 void TextureCache::TCacheEntry::Load(const u8* src, u32 width, u32 height, u32 expandedWidth,
 	u32 expandedHeight, const s32 texformat, const u32 tlutaddr, const TlutFormat tlutfmt, u32 level)
 {
+	if (s_cs_decoder && !is_scaled && g_ActiveConfig.bEnableComputeTextureDecoding &&
+		config.pcformat == PC_TEX_FMT_RGBA32 && s_cs_decoder->FormatSupported(texformat))
+	{
+		// Image binding needs a sized internal format.
+		glActiveTexture(GL_TEXTURE9);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+		glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGBA8, width, height, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+		if (s_cs_decoder->Decode(texture, src, width, height, expandedWidth, expandedHeight,
+			texformat, tlutaddr, tlutfmt, level))
+		{
+			return;
+		}
+	}
 	TexDecoder_Decode(TextureCache::temp, src, expandedWidth, expandedHeight, texformat, tlutaddr, tlutfmt, PC_TEX_FMT_RGBA32 == config.pcformat, compressed);
 	u8* data = TextureCache::temp;
 	if (is_scaled)
 	{
+		if (ScaleOnGPU(data, width, height, expandedWidth, level))
+			return;
 		data = (u8*)s_scaler->Scale((u32*)data, expandedWidth, height);
 		width *= g_ActiveConfig.iTexScalingFactor;
 		height *= g_ActiveConfig.iTexScalingFactor;
@@ -407,6 +465,8 @@ void TextureCache::TCacheEntry::LoadFromTmem(const u8* ar_src, const u8* gb_src,
 	u8* data = TextureCache::temp;
 	if (is_scaled)
 	{
+		if (ScaleOnGPU(data, width, height, expanded_width, level))
+			return;
 		data = (u8*)s_scaler->Scale((u32*)data, expanded_width, height);
 		width *= g_ActiveConfig.iTexScalingFactor;
 		height *= g_ActiveConfig.iTexScalingFactor;
@@ -415,6 +475,27 @@ void TextureCache::TCacheEntry::LoadFromTmem(const u8* ar_src, const u8* gb_src,
 	Load(data, width, height, expanded_width, level);
 }
 
+bool TextureCache::TCacheEntry::ScaleOnGPU(const u8* data, u32 width, u32 height, u32 stride,
+	u32 level)
+{
+	// Deposterization is only implemented by the CPU scaler.
+	const int factor = g_ActiveConfig.iTexScalingFactor;
+	if (!s_cs_decoder || !g_ActiveConfig.bEnableComputeTextureDecoding ||
+		g_ActiveConfig.bTexDeposterize || config.pcformat != PC_TEX_FMT_RGBA32 ||
+		!TextureConversionShader::IsScalingShaderSupported(g_ActiveConfig.iTexScalingType, factor))
+	{
+		return false;
+	}
+
+	// Image binding needs a sized internal format.
+	glActiveTexture(GL_TEXTURE9);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+	glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGBA8, width * factor, height * factor, 1, 0,
+		GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	return s_cs_decoder->Scale(texture, data, width, height, stride,
+		g_ActiveConfig.iTexScalingType, factor, level);
+}
+
 void TextureCache::TCacheEntry::FromRenderTarget(u8* dst, PEControl::PixelFormat srcFormat, const EFBRectangle& srcRect,
 	bool scaleByHalf, unsigned int cbufid, const float *colmat, u32 width, u32 height)
 {
@@ -483,6 +564,11 @@ void TextureCache::CopyEFB(u8* dst, u32 format, u32 native_width, u32 bytes_per_
 		srcRect);
 }
 
+void TextureCache::ReadbackDeferredEFBCopies()
+{
+	TextureConverter::ReadbackDeferredEncodes();
+}
+
 bool TextureCache::Palettize(TCacheEntryBase* src_entry, const TCacheEntryBase* base_entry)
 {
 	TextureCache::TCacheEntry* entry = (TextureCache::TCacheEntry*)src_entry;
@@ -524,6 +610,10 @@ TextureCache::TextureCache()
 	s_ActiveTexture = -1;
 	for (auto& gtex : s_Textures)
 		gtex = -1;
+	for (auto& gtex : s_pending_textures)
+		gtex = 0;
+	s_pending_first = 8;
+	s_pending_last = 0;
 	if (g_ActiveConfig.backend_info.bSupportsPaletteConversion)
 	{
 		s32 buffer_size = 1024 * 1024;
@@ -541,6 +631,16 @@ TextureCache::TextureCache()
 		glBindTexture(GL_TEXTURE_BUFFER, s_palette_resolv_texture);
 		glTexBuffer(GL_TEXTURE_BUFFER, GL_R16UI, s_palette_stream_buffer->m_buffer);
 	}
+	if (g_ActiveConfig.backend_info.bSupportsComputeTextureDecoding)
+	{
+		// Not fatal, textures are decoded on the CPU without it.
+		s_cs_decoder = std::make_unique<CSTextureDecoder>();
+		if (!s_cs_decoder->Init())
+		{
+			ERROR_LOG(VIDEO, "Failed to initialize compute shader texture decoder");
+			s_cs_decoder.reset();
+		}
+	}
 	s_scaler = std::make_unique<TextureScaler>();
 }
 
@@ -768,6 +868,7 @@ TextureCache::~TextureCache()
 		s_palette_stream_buffer.reset();
 		glDeleteTextures(1, &s_palette_resolv_texture);
 	}
+	s_cs_decoder.reset();
 	s_scaler.reset();
 }
 
@@ -806,4 +907,16 @@ void TextureCache::SetStage()
 		glActiveTexture(GL_TEXTURE0 + s_ActiveTexture);
 }
 
+void TextureCache::ApplyBindings()
+{
+	if (s_pending_first > s_pending_last)
+		return;
+
+	const u32 count = s_pending_last - s_pending_first + 1;
+	glBindTextures(s_pending_first, count, &s_pending_textures[s_pending_first]);
+	std::copy_n(&s_pending_textures[s_pending_first], count, &s_Textures[s_pending_first]);
+	s_pending_first = 8;
+	s_pending_last = 0;
+}
+
 }
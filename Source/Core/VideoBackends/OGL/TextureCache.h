@@ -22,6 +22,8 @@ public:
 
 	static void DisableStage(u32 stage);
 	static void SetStage();
+	// Binds the textures of the stages changed since the last draw in one call, with multi bind
+	static void ApplyBindings();
 
 private:
 	struct TCacheEntry : TextureCacheBase::TCacheEntryBase
@@ -53,6 +55,8 @@ private:
 			u32 expandedHeight, const s32 texformat, const u32 tlutaddr, const TlutFormat tlutfmt, u32 level) override;
 		void LoadFromTmem(const u8* ar_src, const u8* gb_src, u32 width, u32 height,
 			u32 expanded_width, u32 expanded_Height, u32 level) override;
+		// Upscales the decoded RGBA8 texels with the compute scaling shaders when possible.
+		bool ScaleOnGPU(const u8* data, u32 width, u32 height, u32 stride, u32 level);
 
 		void FromRenderTarget(u8* dst, PEControl::PixelFormat srcFormat, const EFBRectangle& srcRect,
 			bool scaleByHalf, unsigned int cbufid, const float *colmat, u32 width, u32 height) override;
@@ -75,6 +79,7 @@ private:
 	void CopyEFB(u8* dst, u32 format, u32 native_width, u32 bytes_per_row, u32 num_blocks_y, u32 memory_stride,
 		PEControl::PixelFormat srcFormat, const EFBRectangle& srcRect,
 		bool isIntensity, bool scaleByHalf) override;
+	void ReadbackDeferredEFBCopies() override;
 	bool Palettize(TCacheEntryBase* entry, const TCacheEntryBase* base_entry) override;
 	void LoadLut(u32 lutFmt, void* addr, u32 size) override;
 	bool CompileShaders() override;
@@ -5,6 +5,7 @@
 // Fast image conversion using OpenGL shaders.
 
 #include <string>
+#include <vector>
 
 #include "Common/Common.h"
 #include "Common/FileUtil.h"
@@ -52,6 +53,17 @@ static int s_encodingUniforms[NUM_ENCODING_PROGRAMS];
 
 static GLuint s_PBO = 0; // for readback with different strides
 
+// Deferred EFB copies, each one is read into its own PBO
+struct DeferredEncode
+{
+	u8* dest_addr;
+	u32 line_size;
+	u32 height;
+	u32 write_stride;
+};
+static GLuint s_deferred_PBOs[MAX_DEFERRED_EFB_COPIES] = {};
+static std::vector<DeferredEncode> s_deferred_encodes;
+
 static void CreatePrograms()
 {
 	/* TODO: Accuracy Improvements
@@ -190,6 +202,7 @@ void Init()
 	FramebufferManager::SetFramebuffer(0);
 
 	glGenBuffers(1, &s_PBO);
+	glGenBuffers(MAX_DEFERRED_EFB_COPIES, s_deferred_PBOs);
 
 	CreatePrograms();
 }
@@ -199,6 +212,7 @@ void Shutdown()
 	glDeleteTextures(1, &s_srcTexture);
 	glDeleteTextures(1, &s_dstTexture);
 	glDeleteBuffers(1, &s_PBO);
+	glDeleteBuffers(MAX_DEFERRED_EFB_COPIES, s_deferred_PBOs);
 	glDeleteFramebuffers(2, s_texConvFrameBuffer);
 
 	s_rgbToYuyvProgram.Destroy();
@@ -210,6 +224,9 @@ void Shutdown()
 	s_srcTexture = 0;
 	s_dstTexture = 0;
 	s_PBO = 0;
+	for (GLuint& pbo : s_deferred_PBOs)
+		pbo = 0;
+	s_deferred_encodes.clear();
 	s_texConvFrameBuffer[0] = 0;
 	s_texConvFrameBuffer[1] = 0;
 }
@@ -217,7 +234,7 @@ void Shutdown()
 // dst_line_size, writeStride in bytes
 static void EncodeToRamUsingShader(GLuint srcTexture,
 	u8* destAddr, u32 dst_line_size, u32 dstHeight,
-	u32 writeStride, bool linearFilter)
+	u32 writeStride, bool linearFilter, bool deferred = false)
 {
 	u32 dstWidth = (dst_line_size / 4);
 	// switch to texture converter frame buffer
@@ -242,7 +259,16 @@ static void EncodeToRamUsingShader(GLuint srcTexture,
 	// .. and then read back the results.
 	int dstSize = dst_line_size * dstHeight;
 
-	if ((writeStride != dst_line_size) && (dstHeight > 1))
+	if (deferred && s_deferred_encodes.size() < MAX_DEFERRED_EFB_COPIES)
+	{
+		// Start the transfer, it is only waited for in ReadbackDeferredEncodes
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, s_deferred_PBOs[s_deferred_encodes.size()]);
+		glBufferData(GL_PIXEL_PACK_BUFFER, dstSize, nullptr, GL_STREAM_READ);
+		glReadPixels(0, 0, (GLsizei)dstWidth, (GLsizei)dstHeight, GL_BGRA, GL_UNSIGNED_BYTE, nullptr);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		s_deferred_encodes.push_back({ destAddr, dst_line_size, dstHeight, writeStride });
+	}
+	else if ((writeStride != dst_line_size) && (dstHeight > 1))
 	{
 		// writing to a texture of a different size
 		// also copy more then one block line, so the different strides matters
@@ -287,12 +313,36 @@ void EncodeToRamFromTexture(u8* dest_ptr, u32 format, u32 native_width, u32 byte
 
 	EncodeToRamUsingShader(read_texture,
 		dest_ptr, bytes_per_row, num_blocks_y,
-		memory_stride, bScaleByHalf && srcFormat != PEControl::Z24);
+		memory_stride, bScaleByHalf && srcFormat != PEControl::Z24, g_ActiveConfig.bDeferEFBCopies);
 
 	FramebufferManager::SetFramebuffer(0);
 	g_renderer->RestoreAPIState();
 }
 
+void ReadbackDeferredEncodes()
+{
+	for (size_t i = 0; i < s_deferred_encodes.size(); i++)
+	{
+		const DeferredEncode& encode = s_deferred_encodes[i];
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, s_deferred_PBOs[i]);
+		const u8* pbo = (const u8*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0,
+			encode.line_size * encode.height, GL_MAP_READ_BIT);
+		if (pbo)
+		{
+			u8* dest = encode.dest_addr;
+			for (u32 y = 0; y < encode.height; y++)
+			{
+				memcpy(dest, pbo, encode.line_size);
+				pbo += encode.line_size;
+				dest += encode.write_stride;
+			}
+			glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+		}
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	s_deferred_encodes.clear();
+}
+
 void EncodeToRamYUYV(GLuint srcTexture, const TargetRectangle& sourceRc, u8* destAddr, u32 dstWidth, u32 dstStride, u32 dstHeight)
 {
 	g_renderer->ResetAPIState();
@@ -27,6 +27,9 @@ void DecodeToTexture(u32 xfbAddr, int srcWidth, int srcHeight, GLuint destTextur
 void EncodeToRamFromTexture(u8* dest_ptr, u32 format, u32 native_width, u32 bytes_per_row, u32 num_blocks_y, u32 memory_stride,
 	PEControl::PixelFormat srcFormat, bool bIsIntensityFmt, bool bScaleByHalf, const EFBRectangle& source);
 
+// Maps the PBOs of the copies EncodeToRamFromTexture deferred and writes them to RAM.
+void ReadbackDeferredEncodes();
+
 }
 
 }  // namespace OGL
@@ -13,11 +13,15 @@
 #include "Common/StringUtil.h"
 
 #include "VideoBackends/OGL/BoundingBox.h"
+#include "VideoBackends/OGL/FramebufferManager.h"
 #include "VideoBackends/OGL/ProgramShaderCache.h"
 #include "VideoBackends/OGL/Render.h"
+#include "VideoBackends/OGL/SamplerCache.h"
 #include "VideoBackends/OGL/StreamBuffer.h"
+#include "VideoBackends/OGL/TextureCache.h"
 #include "VideoBackends/OGL/VertexManager.h"
 
+#include "VideoCommon/BPFunctions.h"
 #include "VideoCommon/BPMemory.h"
 #include "VideoCommon/IndexGenerator.h"
 #include "VideoCommon/Statistics.h"
@@ -34,7 +38,7 @@ static std::unique_ptr<StreamBuffer> s_vertexBuffer;
 static std::unique_ptr<StreamBuffer> s_indexBuffer;
 static size_t s_baseVertex;
 static size_t s_index_offset;
-static u16* s_index_buffer_base;
+static GLint s_storage_buffer_align = 1;
 VertexManager::VertexManager() : m_cpu_v_buffer(MAXVBUFFERSIZE), m_cpu_i_buffer(MAXIBUFFERSIZE)
 {
 	CreateDeviceObjects();
@@ -53,6 +57,9 @@ void VertexManager::CreateDeviceObjects()
 	s_indexBuffer = StreamBuffer::Create(GL_ELEMENT_ARRAY_BUFFER, MAX_IBUFFER_SIZE);
 	m_index_buffers = s_indexBuffer->m_buffer;
 
+	if (g_ActiveConfig.backend_info.bSupportsVSLinePointExpand)
+		glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &s_storage_buffer_align);
+
 	m_last_vao = 0;
 }
 
@@ -65,9 +72,9 @@ void VertexManager::DestroyDeviceObjects()
 void VertexManager::PrepareDrawBuffers(u32 stride)
 {
 	u32 vertex_data_size = IndexGenerator::GetNumVerts() * stride;
-	u32 index_data_size = IndexGenerator::GetIndexLen() * sizeof(u16);
+	u32 index_data_size = IndexGenerator::GetIndexLen() * IndexGenerator::GetIndexSize();
 	s_baseVertex = s_vertexBuffer->Stream(vertex_data_size, stride, m_cpu_v_buffer.data()) / stride;
-	s_index_offset = s_indexBuffer->Stream(index_data_size, m_cpu_i_buffer.data());
+	s_index_offset = s_indexBuffer->Stream(index_data_size, IndexGenerator::GetIndexSize(), m_cpu_i_buffer.data());
 	ADDSTAT(stats.thisFrame.bytesVertexStreamed, vertex_data_size);
 	ADDSTAT(stats.thisFrame.bytesIndexStreamed, index_data_size);
 }
@@ -76,14 +83,51 @@ void VertexManager::ResetBuffer(u32 stride)
 {
 	s_pCurBufferPointer = s_pBaseBufferPointer = m_cpu_v_buffer.data();
 	s_pEndBufferPointer = s_pBaseBufferPointer + m_cpu_v_buffer.size();
-	s_index_buffer_base = m_cpu_i_buffer.data();
 	IndexGenerator::Start(m_cpu_i_buffer.data());
 }
 
+// Binds the streamed indices and vertices of the draw as storage buffers and passes their layout
+// to the vertex shader that expands the lines or points, see WriteVertexExpandHelpers.
+static void SetVertexExpandParameters(u32 stride)
+{
+	const GLint location = ProgramShaderCache::GetShaderProgram().shader.vertex_expand_location;
+	if (location == -1)
+		return;
+
+	const u32 align = static_cast<u32>(s_storage_buffer_align);
+	const u32 vertex_start = static_cast<u32>(s_baseVertex) * stride;
+	const u32 vertex_bound = vertex_start - vertex_start % align;
+	const u32 index_start = static_cast<u32>(s_index_offset);
+	const u32 index_bound = index_start - index_start % align;
+	glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 1, s_indexBuffer->m_buffer, index_bound,
+		(index_start - index_bound + IndexGenerator::GetIndexLen() * IndexGenerator::GetIndexSize() + 3) & ~3);
+	glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 2, s_vertexBuffer->m_buffer, vertex_bound,
+		vertex_start - vertex_bound + IndexGenerator::GetNumVerts() * stride);
+
+	const PortableVertexDeclaration& decl = VertexLoaderManager::GetCurrentVertexFormat()->GetVertexDeclaration();
+	GLint params[20] = {};
+	params[0] = stride;
+	params[1] = vertex_start - vertex_bound;
+	params[2] = (index_start - index_bound) / IndexGenerator::GetIndexSize();
+	for (int i = 0; i < 3; i++)
+		params[4 + i] = decl.normals[i].offset;
+	params[7] = decl.posmtx.offset;
+	params[8] = decl.colors[0].offset;
+	params[9] = decl.colors[1].offset;
+	for (int i = 0; i < 8; i++)
+	{
+		if (decl.texcoords[i].enable)
+			params[3] |= decl.texcoords[i].components << (i * 2);
+		params[12 + i] = decl.texcoords[i].offset;
+	}
+	glUniform4iv(location, 5, params);
+}
+
 void VertexManager::Draw(u32 stride)
 {
 	u32 index_size = IndexGenerator::GetIndexLen();
 	u32 max_index = IndexGenerator::GetNumVerts();
+	const GLenum index_type = IndexGenerator::Uses32BitIndices() ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT;
 	GLenum primitive_mode = 0;
 	static const GLenum modes[3] = {
 		GL_POINTS, 
@@ -91,19 +135,36 @@ void VertexManager::Draw(u32 stride)
 		GL_TRIANGLES
 	};
 	primitive_mode = modes[current_primitive_type];
-	bool cull_changed = primitive_mode != GL_TRIANGLES && bpmem.genMode.cullmode > 0;
+	if (primitive_mode == GL_TRIANGLES && IndexGenerator::UsesPrimitiveRestart())
+		primitive_mode = GL_TRIANGLE_STRIP;
+	bool cull_changed = current_primitive_type != PRIMITIVE_TRIANGLES && bpmem.genMode.cullmode > 0;
 	if(cull_changed)
 	{
 		glDisable(GL_CULL_FACE);
 	}
 
-	if (g_ogl_config.bSupportsGLBaseVertex)
+	if (IsVertexShaderExpand(current_primitive_type))
 	{
-		glDrawRangeElementsBaseVertex(primitive_mode, 0, max_index, index_size, GL_UNSIGNED_SHORT, (u8*)nullptr + s_index_offset, (GLint)s_baseVertex);
+		// Two triangles per line or point, the vertex shader fetches the indices itself
+		SetVertexExpandParameters(stride);
+		const u32 primitives = current_primitive_type == PRIMITIVE_LINES ? index_size / 2 : index_size;
+		glDrawArrays(GL_TRIANGLES, 0, primitives * 6);
+	}
+	else if (IsVertexShaderStereo(current_primitive_type))
+	{
+		// One instance per eye, the vertex shader picks the layer
+		if (g_ogl_config.bSupportsGLBaseVertex)
+			glDrawElementsInstancedBaseVertex(primitive_mode, index_size, index_type, (u8*)nullptr + s_index_offset, 2, (GLint)s_baseVertex);
+		else
+			glDrawElementsInstanced(primitive_mode, index_size, index_type, (u8*)nullptr + s_index_offset, 2);
+	}
+	else if (g_ogl_config.bSupportsGLBaseVertex)
+	{
+		glDrawRangeElementsBaseVertex(primitive_mode, 0, max_index, index_size, index_type, (u8*)nullptr + s_index_offset, (GLint)s_baseVertex);
 	}
 	else
 	{
-		glDrawRangeElements(primitive_mode, 0, max_index, index_size, GL_UNSIGNED_SHORT, (u8*)nullptr + s_index_offset);
+		glDrawRangeElements(primitive_mode, 0, max_index, index_size, index_type, (u8*)nullptr + s_index_offset);
 	}
 
 	INCSTAT(stats.thisFrame.numDrawCalls);
@@ -117,10 +178,6 @@ void VertexManager::PrepareShaders(PrimitiveType primitive, u32 components, cons
 
 }
 
-u16* VertexManager::GetIndexBuffer()
-{
-	return s_index_buffer_base;
-}
 void VertexManager::vFlush(bool useDstAlpha)
 {
 	GLVertexFormat* nativeVertexFmt = (GLVertexFormat*)VertexLoaderManager::GetCurrentVertexFormat();
@@ -131,15 +188,20 @@ void VertexManager::vFlush(bool useDstAlpha)
 
 	// If host supports GL_ARB_blend_func_extended, we can do dst alpha in
 	// the same pass as regular rendering.
+	SHADER* shader;
 	if (useDstAlpha && dualSourcePossible)
 	{
-		ProgramShaderCache::SetShader(PSRM_DUAL_SOURCE_BLEND, VertexLoaderManager::g_current_components, current_primitive_type);
+		shader = ProgramShaderCache::SetShader(PSRM_DUAL_SOURCE_BLEND, VertexLoaderManager::g_current_components, current_primitive_type);
 	}
 	else
 	{
-		ProgramShaderCache::SetShader(PSRM_DEFAULT, VertexLoaderManager::g_current_components, current_primitive_type);
+		shader = ProgramShaderCache::SetShader(PSRM_DEFAULT, VertexLoaderManager::g_current_components, current_primitive_type);
 	}
 
+	// The program failed to build or is still being linked in the background.
+	if (!shader)
+		return;
+
 	// upload global constants
 	ProgramShaderCache::UploadConstants();
 
@@ -151,6 +213,11 @@ void VertexManager::vFlush(bool useDstAlpha)
 		m_last_vao = nativeVertexFmt->VAO;
 	}
 	PrepareDrawBuffers(stride);
+	if (g_ogl_config.bSupportsMultiBind)
+	{
+		TextureCache::ApplyBindings();
+		g_sampler_cache->ApplyBindings();
+	}
 	g_renderer->ApplyState(false);
 	Draw(stride);
 	// If the GPU does not support dual-source blending, we can approximate the effect by drawing
@@ -161,9 +228,9 @@ void VertexManager::vFlush(bool useDstAlpha)
 	// blending and logic ops concurrently.
 	const bool logic_op_enabled = bpmem.blendmode.logicopenable && bpmem.blendmode.logicmode != BlendMode::LogicOp::COPY && !bpmem.blendmode.blendenable;
 	// run through vertex groups again to set alpha
-	if (useDstAlpha && (!dualSourcePossible || logic_op_enabled))
+	if (useDstAlpha && (!dualSourcePossible || logic_op_enabled) &&
+		ProgramShaderCache::SetShader(PSRM_ALPHA_PASS, VertexLoaderManager::g_current_components, current_primitive_type))
 	{
-		ProgramShaderCache::SetShader(PSRM_ALPHA_PASS, VertexLoaderManager::g_current_components, current_primitive_type);
 
 		// only update alpha
 		glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_TRUE);
@@ -184,7 +251,12 @@ void VertexManager::vFlush(bool useDstAlpha)
 	}
 	g_Config.iSaveTargetId++;
 
-	ClearEFBCache();
+	// Peeks and resolves outside of the scissor rect still see the same values
+	const EFBRectangle scissor_rect = BPFunctions::GetScissorRect();
+	ClearEFBCache(scissor_rect);
+	FramebufferManager::InvalidateResolvedEFB(scissor_rect,
+		bpmem.blendmode.colorupdate || bpmem.blendmode.alphaupdate || useDstAlpha,
+		bpmem.zmode.updateenable != 0);
 }
 
 }  // namespace
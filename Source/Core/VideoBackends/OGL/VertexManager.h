@@ -38,7 +38,6 @@ public:
 
 protected:
 	void ResetBuffer(u32 stride) override;
-	u16* GetIndexBuffer() override;
 private:
 	void Draw(u32 stride);
 	void vFlush(bool useDstAlpha) override;
@@ -46,6 +45,7 @@ private:
 
 	// Alternative buffers in CPU memory for primatives we are going to discard.
 	std::vector<u8, Common::aligned_allocator<u8, 16>> m_cpu_v_buffer;
-	std::vector<u16, Common::aligned_allocator<u16, 16>> m_cpu_i_buffer;
+	// 32 bit indices, see IndexGenerator::Uses32BitIndices
+	std::vector<u32, Common::aligned_allocator<u32, 16>> m_cpu_i_buffer;
 };
 }
@@ -47,6 +47,7 @@ Make AA apply instantly during gameplay if possible
 #include "Core/Host.h"
 
 #include "VideoBackends/OGL/BoundingBox.h"
+#include "VideoBackends/OGL/GPUProfiler.h"
 #include "VideoBackends/OGL/PerfQuery.h"
 #include "VideoBackends/OGL/ProgramShaderCache.h"
 #include "VideoBackends/OGL/Render.h"
@@ -111,6 +112,7 @@ void VideoBackend::InitBackendInfo()
 	g_Config.backend_info.bSupportsGeometryShaders = true;
 	g_Config.backend_info.bSupports3DVision = false;
 	g_Config.backend_info.bSupportsPostProcessing = true;
+	g_Config.backend_info.bSupportsPostProcessingCompute = false;
 	g_Config.backend_info.bSupportsSSAA = true;
 	g_Config.backend_info.bSupportsPixelLighting = true;
 	g_Config.backend_info.bSupportsNormalMaps = true;
@@ -120,6 +122,10 @@ void VideoBackend::InitBackendInfo()
 	g_Config.backend_info.bSupportsDepthClamp = true;
 	g_Config.backend_info.bSupportsMultithreading = false;
 	g_Config.backend_info.bSupportsReversedDepthRange = true;
+	g_Config.backend_info.bSupportsPrimitiveRestart = false;
+	g_Config.backend_info.bSupports32BitIndices = true;
+	g_Config.backend_info.bSupportsDeferredEFBCopies = true;
+	g_Config.backend_info.bSupportsVirtualXFBWriteBack = true;
 	g_Config.backend_info.Adapters.clear();
 
 	// aamodes - 1 is to stay consistent with D3D (means no AA)
@@ -152,6 +158,8 @@ void VideoBackend::Video_Prepare()
 
 	g_vertex_manager = std::make_unique<VertexManager>();
 	g_perf_query = GetPerfQuery();
+	if (GPUProfiler::IsSupported())
+		g_gpu_profiler = std::make_unique<GPUProfiler>();
 	ProgramShaderCache::Init();
 	g_texture_cache = std::make_unique<TextureCache>();
 	g_sampler_cache = std::make_unique<SamplerCache>();
@@ -178,6 +186,7 @@ void VideoBackend::Video_Cleanup()
 	g_sampler_cache.reset();
 	g_texture_cache.reset();
 	ProgramShaderCache::Shutdown();
+	g_gpu_profiler.reset();
 	g_perf_query.reset();
 	g_vertex_manager.reset();
 	g_renderer.reset();
@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <cstring>
 
 #include "Common/CommonFuncs.h"
 #include "Common/CommonTypes.h"
@@ -17,7 +18,7 @@ static u8 efb[EFB_WIDTH*EFB_HEIGHT * 6];
 
 namespace EfbInterface
 {
-u32 perf_values[PQ_NUM_MEMBERS];
+std::atomic<u32> perf_values[PQ_NUM_MEMBERS];
 
 static inline u32 GetColorOffset(u16 x, u16 y)
 {
@@ -29,6 +30,20 @@ static inline u32 GetDepthOffset(u16 x, u16 y)
 	return (x + y * EFB_WIDTH) * 3 + DEPTH_BUFFER_START;
 }
 
+// Pixels are packed into 3 bytes and the tiles drawn on other threads start right behind them, so
+// only the 3 bytes of the pixel itself may be read or written.
+static inline u32 ReadPixel(u32 offset)
+{
+	u32 val = 0;
+	std::memcpy(&val, &efb[offset], 3);
+	return val;
+}
+
+static inline void WritePixel(u32 offset, u32 val)
+{
+	std::memcpy(&efb[offset], &val, 3);
+}
+
 static void SetPixelAlphaOnly(u32 offset, u8 a)
 {
 	switch (bpmem.zcontrol.pixel_format)
@@ -41,10 +56,9 @@ static void SetPixelAlphaOnly(u32 offset, u8 a)
 	case PEControl::RGBA6_Z24:
 	{
 		u32 a32 = a;
-		u32 *dst = (u32*)&efb[offset];
-		u32 val = *dst & 0xffffffc0;
+		u32 val = ReadPixel(offset) & 0x00ffffc0;
 		val |= (a32 >> 2) & 0x0000003f;
-		*dst = val;
+		WritePixel(offset, val);
 	}
 	break;
 	default:
@@ -60,31 +74,26 @@ static void SetPixelColorOnly(u32 offset, u8 *rgb)
 	case PEControl::Z24:
 	{
 		u32 src = *(u32*)rgb;
-		u32 *dst = (u32*)&efb[offset];
-		u32 val = *dst & 0xff000000;
-		val |= src >> 8;
-		*dst = val;
+		u32 val = src >> 8;
+		WritePixel(offset, val);
 	}
 	break;
 	case PEControl::RGBA6_Z24:
 	{
 		u32 src = *(u32*)rgb;
-		u32 *dst = (u32*)&efb[offset];
-		u32 val = *dst & 0xff00003f;
+		u32 val = ReadPixel(offset) & 0x0000003f;
 		val |= (src >> 4) & 0x00000fc0; // blue
 		val |= (src >> 6) & 0x0003f000; // green
 		val |= (src >> 8) & 0x00fc0000; // red
-		*dst = val;
+		WritePixel(offset, val);
 	}
 	break;
 	case PEControl::RGB565_Z16:
 	{
 		INFO_LOG(VIDEO, "RGB565_Z16 is not supported correctly yet");
 		u32 src = *(u32*)rgb;
-		u32 *dst = (u32*)&efb[offset];
-		u32 val = *dst & 0xff000000;
-		val |= src >> 8;
-		*dst = val;
+		u32 val = src >> 8;
+		WritePixel(offset, val);
 	}
 	break;
 	default:
@@ -100,32 +109,26 @@ static void SetPixelAlphaColor(u32 offset, u8 *color)
 	case PEControl::Z24:
 	{
 		u32 src = *(u32*)color;
-		u32 *dst = (u32*)&efb[offset];
-		u32 val = *dst & 0xff000000;
-		val |= src >> 8;
-		*dst = val;
+		u32 val = src >> 8;
+		WritePixel(offset, val);
 	}
 	break;
 	case PEControl::RGBA6_Z24:
 	{
 		u32 src = *(u32*)color;
-		u32 *dst = (u32*)&efb[offset];
-		u32 val = *dst & 0xff000000;
-		val |= (src >> 2) & 0x0000003f; // alpha
+		u32 val = (src >> 2) & 0x0000003f; // alpha
 		val |= (src >> 4) & 0x00000fc0; // blue
 		val |= (src >> 6) & 0x0003f000; // green
 		val |= (src >> 8) & 0x00fc0000; // red
-		*dst = val;
+		WritePixel(offset, val);
 	}
 	break;
 	case PEControl::RGB565_Z16:
 	{
 		INFO_LOG(VIDEO, "RGB565_Z16 is not supported correctly yet");
 		u32 src = *(u32*)color;
-		u32 *dst = (u32*)&efb[offset];
-		u32 val = *dst & 0xff000000;
-		val |= src >> 8;
-		*dst = val;
+		u32 val = src >> 8;
+		WritePixel(offset, val);
 	}
 	break;
 	default:
@@ -140,7 +143,7 @@ static void GetPixelColor(u32 offset, u8 *color)
 	case PEControl::RGB8_Z24:
 	case PEControl::Z24:
 	{
-		u32 src = *(u32*)&efb[offset];
+		u32 src = ReadPixel(offset);
 		u32 *dst = (u32*)color;
 		u32 val = 0xff | ((src & 0x00ffffff) << 8);
 		*dst = val;
@@ -148,7 +151,7 @@ static void GetPixelColor(u32 offset, u8 *color)
 	break;
 	case PEControl::RGBA6_Z24:
 	{
-		u32 src = *(u32*)&efb[offset];
+		u32 src = ReadPixel(offset);
 		color[ALP_C] = Convert6To8(src & 0x3f);
 		color[BLU_C] = Convert6To8((src >> 6) & 0x3f);
 		color[GRN_C] = Convert6To8((src >> 12) & 0x3f);
@@ -158,7 +161,7 @@ static void GetPixelColor(u32 offset, u8 *color)
 	case PEControl::RGB565_Z16:
 	{
 		INFO_LOG(VIDEO, "RGB565_Z16 is not supported correctly yet");
-		u32 src = *(u32*)&efb[offset];
+		u32 src = ReadPixel(offset);
 		u32 *dst = (u32*)color;
 		u32 val = 0xff | ((src & 0x00ffffff) << 8);
 		*dst = val;
@@ -177,19 +180,15 @@ static void SetPixelDepth(u32 offset, u32 depth)
 	case PEControl::RGBA6_Z24:
 	case PEControl::Z24:
 	{
-		u32 *dst = (u32*)&efb[offset];
-		u32 val = *dst & 0xff000000;
-		val |= depth & 0x00ffffff;
-		*dst = val;
+		u32 val = depth & 0x00ffffff;
+		WritePixel(offset, val);
 	}
 	break;
 	case PEControl::RGB565_Z16:
 	{
 		INFO_LOG(VIDEO, "RGB565_Z16 is not supported correctly yet");
-		u32 *dst = (u32*)&efb[offset];
-		u32 val = *dst & 0xff000000;
-		val |= depth & 0x00ffffff;
-		*dst = val;
+		u32 val = depth & 0x00ffffff;
+		WritePixel(offset, val);
 	}
 	break;
 	default:
@@ -207,13 +206,13 @@ static u32 GetPixelDepth(u32 offset)
 	case PEControl::RGBA6_Z24:
 	case PEControl::Z24:
 	{
-		depth = (*(u32*)&efb[offset]) & 0x00ffffff;
+		depth = ReadPixel(offset);
 	}
 	break;
 	case PEControl::RGB565_Z16:
 	{
 		INFO_LOG(VIDEO, "RGB565_Z16 is not supported correctly yet");
-		depth = (*(u32*)&efb[offset]) & 0x00ffffff;
+		depth = ReadPixel(offset);
 	}
 	break;
 	default:
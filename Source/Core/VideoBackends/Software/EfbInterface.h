@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <atomic>
+
 #include "Common/CommonTypes.h"
 #include "VideoCommon/PerfQueryBase.h"
 #include "VideoCommon/VideoCommon.h"
@@ -60,17 +62,18 @@ u8* GetPixelPointer(u16 x, u16 y, bool depth);
 void CopyToXFB(yuv422_packed* xfb_in_ram, u32 fbWidth, u32 fbHeight, const EFBRectangle& sourceRc, float Gamma);
 void BypassXFB(u8* texture, u32 fbWidth, u32 fbHeight, const EFBRectangle& sourceRc, float Gamma);
 
-extern u32 perf_values[PQ_NUM_MEMBERS];
+// Atomic as the rasterizer threads draw pixels at the same time.
+extern std::atomic<u32> perf_values[PQ_NUM_MEMBERS];
 inline void IncPerfCounterQuadCount(PerfQueryType type)
 {
 	// NOTE: hardware doesn't process individual pixels but quads instead.
 	// Current software renderer architecture works on pixels though, so
 	// we have this "quad" hack here to only increment the registers on
 	// every fourth rendered pixel
-	static u32 quad[PQ_NUM_MEMBERS];
+	thread_local u32 quad[PQ_NUM_MEMBERS];
 	if (++quad[type] != 3)
 		return;
 	quad[type] = 0;
-	++perf_values[type];
+	perf_values[type].fetch_add(1, std::memory_order_relaxed);
 }
 }
@@ -3,9 +3,16 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
 
 #include "Common/CommonTypes.h"
+#include "Common/Event.h"
+#include "Common/Thread.h"
 #include "VideoBackends/Software/EfbInterface.h"
 #include "VideoBackends/Software/NativeVertexFormat.h"
 #include "VideoBackends/Software/Rasterizer.h"
@@ -20,32 +27,136 @@ namespace Rasterizer
 {
 static constexpr int BLOCK_SIZE = 2;
 
-static Slope ZSlope;
-static Slope WSlope;
-static Slope ColorSlopes[2][4];
-static Slope TexSlopes[8][3];
+// Triangles are sorted into tiles of the EFB, which are drawn in parallel. Each tile draws its
+// triangles in submission order. Tiles are a multiple of the block size, so no block is split.
+static constexpr s32 TILE_SIZE = 32;
+static constexpr s32 TILES_X = (EFB_WIDTH + TILE_SIZE - 1) / TILE_SIZE;
+static constexpr s32 TILES_Y = (EFB_HEIGHT + TILE_SIZE - 1) / TILE_SIZE;
+// Bins are drawn early when a draw call has more triangles than this.
+static constexpr size_t MAX_BINNED_TRIANGLES = 16384;
+
+// Result of the triangle setup, everything needed to draw the triangle's pixels.
+struct TriangleSetup
+{
+	Slope ZSlope;
+	Slope WSlope;
+	Slope ColorSlopes[2][4];
+	Slope TexSlopes[8][3];
+
+	s32 vertex0X;
+	s32 vertex0Y;
+	float vertexOffsetX;
+	float vertexOffsetY;
+
+	// 28.4 fixed point edge deltas and half-edge constants
+	s32 DX12, DX23, DX31;
+	s32 DY12, DY23, DY31;
+	s32 C1, C2, C3;
+
+	// Scissored bounding rectangle, in pixels
+	s32 minx, maxx, miny, maxy;
+};
+
+// State of one thread drawing pixels.
+struct RasterContext
+{
+	Tev tev;
+	RasterBlock rasterBlock;
+	u32 rasterizedPixels;
+
+	void Init()
+	{
+		tev.Init();
+		rasterizedPixels = 0;
+	}
+};
+
+struct Worker
+{
+	std::thread thread;
+	Common::Event wake;
+	RasterContext context;
+};
 
-static s32 vertex0X;
-static s32 vertex0Y;
-static float vertexOffsetX;
-static float vertexOffsetY;
+// Z plane of the last triangle, kept for zfreeze.
+static Slope ZSlope;
 
 static s32 scissorLeft = 0;
 static s32 scissorTop = 0;
 static s32 scissorRight = 0;
 static s32 scissorBottom = 0;
 
-static Tev tev;
-static RasterBlock rasterBlock;
+// Used by the video thread, which also draws tiles along with the workers.
+static RasterContext s_context;
+
+static std::vector<std::unique_ptr<Worker>> s_workers;
+static std::atomic<bool> s_workers_exit{ false };
+static std::atomic<u32> s_next_tile{ 0 };
+static std::atomic<u32> s_busy_workers{ 0 };
+static Common::Event s_tiles_done;
+
+static std::vector<TriangleSetup> s_triangles;
+static std::array<std::vector<u32>, TILES_X * TILES_Y> s_tile_triangles;
+static std::vector<u32> s_active_tiles;
+
+static void DrawTiles(RasterContext& context);
+
+static void WorkerThread(Worker* worker)
+{
+	Common::SetCurrentThreadName("SW rasterizer");
+	while (true)
+	{
+		worker->wake.Wait();
+		if (s_workers_exit.load())
+			return;
+
+		DrawTiles(worker->context);
+		if (s_busy_workers.fetch_sub(1) == 1)
+			s_tiles_done.Set();
+	}
+}
 
 void Init()
 {
-	tev.Init();
+	Shutdown();
+	s_context.Init();
 
 	// Set initial z reference plane in the unlikely case that zfreeze is enabled when drawing the first primitive.
 	// TODO: This is just a guess!
 	ZSlope.dfdx = ZSlope.dfdy = 0.f;
 	ZSlope.f0 = 1.f;
+
+	int num_threads = g_ActiveConfig.iSWRasterizerThreads;
+	if (num_threads == 0)
+		num_threads = std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+
+	// The video thread draws tiles too, so it is not counted as a worker.
+	s_workers_exit.store(false);
+	for (int i = 1; i < num_threads; i++)
+	{
+		std::unique_ptr<Worker> worker = std::make_unique<Worker>();
+		worker->context.Init();
+		worker->thread = std::thread(WorkerThread, worker.get());
+		s_workers.push_back(std::move(worker));
+	}
+	if (!s_workers.empty())
+		s_triangles.reserve(MAX_BINNED_TRIANGLES);
+}
+
+void Shutdown()
+{
+	s_workers_exit.store(true);
+	for (auto& worker : s_workers)
+	{
+		worker->wake.Set();
+		worker->thread.join();
+	}
+	s_workers.clear();
+
+	s_triangles.clear();
+	for (std::vector<u32>& tile : s_tile_triangles)
+		tile.clear();
+	s_active_tiles.clear();
 }
 
 // Returns approximation of log2(f) in s28.4
@@ -94,17 +205,22 @@ void SetScissor()
 
 void SetTevReg(int reg, int comp, bool konst, s16 color)
 {
-	tev.SetRegColor(reg, comp, konst, color);
+	s_context.tev.SetRegColor(reg, comp, konst, color);
+}
+
+void SetTevStages()
+{
+	s_context.tev.SetupStages();
 }
 
-static void Draw(s32 x, s32 y, s32 xi, s32 yi)
+static void Draw(const TriangleSetup& tri, RasterContext& context, s32 x, s32 y, s32 xi, s32 yi)
 {
-	INCSTAT(stats.thisFrame.rasterizedPixels);
+	context.rasterizedPixels++;
 
-	float dx = vertexOffsetX + (float)(x - vertex0X);
-	float dy = vertexOffsetY + (float)(y - vertex0Y);
+	float dx = tri.vertexOffsetX + (float)(x - tri.vertex0X);
+	float dy = tri.vertexOffsetY + (float)(y - tri.vertex0Y);
 
-	s32 z = (s32)MathUtil::Clamp<float>(ZSlope.GetValue(dx, dy), 0.0f, 16777215.0f);
+	s32 z = (s32)MathUtil::Clamp<float>(tri.ZSlope.GetValue(dx, dy), 0.0f, 16777215.0f);
 
 	if (!BoundingBox::active && bpmem.UseEarlyDepthTest() && g_ActiveConfig.bZComploc)
 	{
@@ -119,7 +235,9 @@ static void Draw(s32 x, s32 y, s32 xi, s32 yi)
 		EfbInterface::IncPerfCounterQuadCount(PQ_ZCOMP_OUTPUT_ZCOMPLOC);
 	}
 
+	RasterBlock& rasterBlock = context.rasterBlock;
 	RasterBlockPixel& pixel = rasterBlock.Pixel[xi][yi];
+	Tev& tev = context.tev;
 
 	tev.Position[0] = x;
 	tev.Position[1] = y;
@@ -130,7 +248,7 @@ static void Draw(s32 x, s32 y, s32 xi, s32 yi)
 	{
 		for (int comp = 0; comp < 4; comp++)
 		{
-			u16 color = (u16)ColorSlopes[i][comp].GetValue(dx, dy);
+			u16 color = (u16)tri.ColorSlopes[i][comp].GetValue(dx, dy);
 
 			// clamp color value to 0
 			u16 mask = ~(color >> 8);
@@ -162,16 +280,16 @@ static void Draw(s32 x, s32 y, s32 xi, s32 yi)
 	tev.Draw();
 }
 
-static void InitTriangle(float X1, float Y1, s32 xi, s32 yi)
+static void InitTriangle(TriangleSetup* tri, float X1, float Y1, s32 xi, s32 yi)
 {
-	vertex0X = xi;
-	vertex0Y = yi;
+	tri->vertex0X = xi;
+	tri->vertex0Y = yi;
 
 	// adjust a little less than 0.5
 	const float adjust = 0.495f;
 
-	vertexOffsetX = ((float)xi - X1) + adjust;
-	vertexOffsetY = ((float)yi - Y1) + adjust;
+	tri->vertexOffsetX = ((float)xi - X1) + adjust;
+	tri->vertexOffsetY = ((float)yi - Y1) + adjust;
 }
 
 static void InitSlope(Slope *slope, float f1, float f2, float f3, float DX31, float DX12, float DY12, float DY31)
@@ -186,7 +304,7 @@ static void InitSlope(Slope *slope, float f1, float f2, float f3, float DX31, fl
 	slope->f0 = f1;
 }
 
-static inline void CalculateLOD(s32* lodp, bool* linear, u32 texmap, u32 texcoord)
+static inline void CalculateLOD(const RasterBlock& rasterBlock, s32* lodp, bool* linear, u32 texmap, u32 texcoord)
 {
 	const FourTexUnits& texUnit = bpmem.tex[(texmap >> 2) & 1];
 	const u8 subTexmap = texmap & 3;
@@ -199,17 +317,17 @@ static inline void CalculateLOD(s32* lodp, bool* linear, u32 texmap, u32 texcoor
 	float sDelta, tDelta;
 	if (tm0.diag_lod)
 	{
-		float *uv0 = rasterBlock.Pixel[0][0].Uv[texcoord];
-		float *uv1 = rasterBlock.Pixel[1][1].Uv[texcoord];
+		const float *uv0 = rasterBlock.Pixel[0][0].Uv[texcoord];
+		const float *uv1 = rasterBlock.Pixel[1][1].Uv[texcoord];
 
 		sDelta = fabsf(uv0[0] - uv1[0]);
 		tDelta = fabsf(uv0[1] - uv1[1]);
 	}
 	else
 	{
-		float *uv0 = rasterBlock.Pixel[0][0].Uv[texcoord];
-		float *uv1 = rasterBlock.Pixel[1][0].Uv[texcoord];
-		float *uv2 = rasterBlock.Pixel[0][1].Uv[texcoord];
+		const float *uv0 = rasterBlock.Pixel[0][0].Uv[texcoord];
+		const float *uv1 = rasterBlock.Pixel[1][0].Uv[texcoord];
+		const float *uv2 = rasterBlock.Pixel[0][1].Uv[texcoord];
 
 		sDelta = std::max(fabsf(uv0[0] - uv1[0]), fabsf(uv0[0] - uv2[0]));
 		tDelta = std::max(fabsf(uv0[1] - uv1[1]), fabsf(uv0[1] - uv2[1]));
@@ -234,18 +352,19 @@ static inline void CalculateLOD(s32* lodp, bool* linear, u32 texmap, u32 texcoor
 	*lodp = lod;
 }
 
-static void BuildBlock(s32 blockX, s32 blockY)
+static void BuildBlock(const TriangleSetup& tri, RasterContext& context, s32 blockX, s32 blockY)
 {
+	RasterBlock& rasterBlock = context.rasterBlock;
 	for (s32 yi = 0; yi < BLOCK_SIZE; yi++)
 	{
 		for (s32 xi = 0; xi < BLOCK_SIZE; xi++)
 		{
 			RasterBlockPixel& pixel = rasterBlock.Pixel[xi][yi];
 
-			float dx = vertexOffsetX + (float)(xi + blockX - vertex0X);
-			float dy = vertexOffsetY + (float)(yi + blockY - vertex0Y);
+			float dx = tri.vertexOffsetX + (float)(xi + blockX - tri.vertex0X);
+			float dy = tri.vertexOffsetY + (float)(yi + blockY - tri.vertex0Y);
 
-			float invW = 1.0f / WSlope.GetValue(dx, dy);
+			float invW = 1.0f / tri.WSlope.GetValue(dx, dy);
 			pixel.InvW = invW;
 
 			// tex coords
@@ -254,13 +373,13 @@ static void BuildBlock(s32 blockX, s32 blockY)
 				float projection = invW;
 				if (xfmem.texMtxInfo[i].projection)
 				{
-					float q = TexSlopes[i][2].GetValue(dx, dy) * invW;
+					float q = tri.TexSlopes[i][2].GetValue(dx, dy) * invW;
 					if (q != 0.0f)
 						projection = invW / q;
 				}
 
-				pixel.Uv[i][0] = TexSlopes[i][0].GetValue(dx, dy) * projection;
-				pixel.Uv[i][1] = TexSlopes[i][1].GetValue(dx, dy) * projection;
+				pixel.Uv[i][0] = tri.TexSlopes[i][0].GetValue(dx, dy) * projection;
+				pixel.Uv[i][1] = tri.TexSlopes[i][1].GetValue(dx, dy) * projection;
 			}
 		}
 	}
@@ -273,7 +392,7 @@ static void BuildBlock(s32 blockX, s32 blockY)
 		u32 texcoord = indref & 3;
 		indref >>= 3;
 
-		CalculateLOD(&rasterBlock.IndirectLod[i], &rasterBlock.IndirectLinear[i], texmap, texcoord);
+		CalculateLOD(rasterBlock, &rasterBlock.IndirectLod[i], &rasterBlock.IndirectLinear[i], texmap, texcoord);
 	}
 
 	for (unsigned int i = 0; i <= bpmem.genMode.numtevstages; i++)
@@ -285,12 +404,12 @@ static void BuildBlock(s32 blockX, s32 blockY)
 			u32 texmap = order.getTexMap(stageOdd);
 			u32 texcoord = order.getTexCoord(stageOdd);
 
-			CalculateLOD(&rasterBlock.TextureLod[i], &rasterBlock.TextureLinear[i], texmap, texcoord);
+			CalculateLOD(rasterBlock, &rasterBlock.TextureLod[i], &rasterBlock.TextureLinear[i], texmap, texcoord);
 		}
 	}
 }
 
-static inline void PrepareBlock(s32 blockX, s32 blockY)
+static inline void PrepareBlock(const TriangleSetup& tri, RasterContext& context, s32 blockX, s32 blockY)
 {
 	static s32 x = -1;
 	static s32 y = -1;
@@ -302,34 +421,16 @@ static inline void PrepareBlock(s32 blockX, s32 blockY)
 	{
 		x = blockX;
 		y = blockY;
-		BuildBlock(x, y);
+		BuildBlock(tri, context, x, y);
 	}
 }
 
-void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVertexData *v2)
+// Draws the pixels of the triangle within [minx, maxx) and [miny, maxy), which start on a block.
+static void DrawBlocks(const TriangleSetup& tri, RasterContext& context, s32 minx, s32 maxx, s32 miny, s32 maxy)
 {
-	INCSTAT(stats.thisFrame.numTrianglesDrawn);
-
-	// adapted from http://devmaster.net/posts/6145/advanced-rasterization
-
-	// 28.4 fixed-pou32 coordinates. rounded to nearest and adjusted to match hardware output
-	// could also take floor and adjust -8
-	const s32 Y1 = iround(16.0f * v0->screenPosition[1]) - 9;
-	const s32 Y2 = iround(16.0f * v1->screenPosition[1]) - 9;
-	const s32 Y3 = iround(16.0f * v2->screenPosition[1]) - 9;
-
-	const s32 X1 = iround(16.0f * v0->screenPosition[0]) - 9;
-	const s32 X2 = iround(16.0f * v1->screenPosition[0]) - 9;
-	const s32 X3 = iround(16.0f * v2->screenPosition[0]) - 9;
-
-	// Deltas
-	const s32 DX12 = X1 - X2;
-	const s32 DX23 = X2 - X3;
-	const s32 DX31 = X3 - X1;
-
-	const s32 DY12 = Y1 - Y2;
-	const s32 DY23 = Y2 - Y3;
-	const s32 DY31 = Y3 - Y1;
+	const s32 DX12 = tri.DX12, DX23 = tri.DX23, DX31 = tri.DX31;
+	const s32 DY12 = tri.DY12, DY23 = tri.DY23, DY31 = tri.DY31;
+	const s32 C1 = tri.C1, C2 = tri.C2, C3 = tri.C3;
 
 	// Fixed-pos32 deltas
 	const s32 FDX12 = DX12 * 16;
@@ -340,208 +441,199 @@ void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVer
 	const s32 FDY23 = DY23 * 16;
 	const s32 FDY31 = DY31 * 16;
 
-	// Bounding rectangle
-	s32 minx = (std::min(std::min(X1, X2), X3) + 0xF) >> 4;
-	s32 maxx = (std::max(std::max(X1, X2), X3) + 0xF) >> 4;
-	s32 miny = (std::min(std::min(Y1, Y2), Y3) + 0xF) >> 4;
-	s32 maxy = (std::max(std::max(Y1, Y2), Y3) + 0xF) >> 4;
-
-	// scissor
-	minx = std::max(minx, scissorLeft);
-	maxx = std::min(maxx, scissorRight);
-	miny = std::max(miny, scissorTop);
-	maxy = std::min(maxy, scissorBottom);
-
-	if (minx >= maxx || miny >= maxy)
-		return;
-
-	// Setup slopes
-	float fltx1 = v0->screenPosition.x;
-	float flty1 = v0->screenPosition.y;
-	float fltdx31 = v2->screenPosition.x - fltx1;
-	float fltdx12 = fltx1 - v1->screenPosition.x;
-	float fltdy12 = flty1 - v1->screenPosition.y;
-	float fltdy31 = v2->screenPosition.y - flty1;
-
-	InitTriangle(fltx1, flty1, (X1 + 0xF) >> 4, (Y1 + 0xF) >> 4);
-
-	float w[3] = {1.0f / v0->projectedPosition.w, 1.0f / v1->projectedPosition.w, 1.0f / v2->projectedPosition.w};
-	InitSlope(&WSlope, w[0], w[1], w[2], fltdx31, fltdx12, fltdy12, fltdy31);
-
-	// TODO: The zfreeze emulation is not quite correct, yet!
-	// Many things might prevent us from reaching this line (culling, clipping, scissoring).
-	// However, the zslope is always guaranteed to be calculated unless all vertices are trivially rejected during clipping!
-	// We're currently sloppy at this since we abort early if any of the culling/clipping/scissoring tests fail.
-	if (!bpmem.genMode.zfreeze || !g_ActiveConfig.bZFreeze)
-		InitSlope(&ZSlope, v0->screenPosition[2], v1->screenPosition[2], v2->screenPosition[2], fltdx31, fltdx12, fltdy12, fltdy31);
-
-	for (unsigned int i = 0; i < bpmem.genMode.numcolchans; i++)
+	// Loop through blocks
+	for (s32 y = miny; y < maxy; y += BLOCK_SIZE)
 	{
-		for (int comp = 0; comp < 4; comp++)
-			InitSlope(&ColorSlopes[i][comp], v0->color[i][comp], v1->color[i][comp], v2->color[i][comp], fltdx31, fltdx12, fltdy12, fltdy31);
-	}
-
-	for (unsigned int i = 0; i < bpmem.genMode.numtexgens; i++)
-	{
-		for (int comp = 0; comp < 3; comp++)
-			InitSlope(&TexSlopes[i][comp], v0->texCoords[i][comp] * w[0], v1->texCoords[i][comp] * w[1], v2->texCoords[i][comp] * w[2], fltdx31, fltdx12, fltdy12, fltdy31);
-	}
-
-	// Half-edge constants
-	s32 C1 = DY12 * X1 - DX12 * Y1;
-	s32 C2 = DY23 * X2 - DX23 * Y2;
-	s32 C3 = DY31 * X3 - DX31 * Y3;
-
-	// Correct for fill convention
-	if (DY12 < 0 || (DY12 == 0 && DX12 > 0)) C1++;
-	if (DY23 < 0 || (DY23 == 0 && DX23 > 0)) C2++;
-	if (DY31 < 0 || (DY31 == 0 && DX31 > 0)) C3++;
-
-	if (!BoundingBox::active)
-	{
-		// Start in corner of 8x8 block
-		minx &= ~(BLOCK_SIZE - 1);
-		miny &= ~(BLOCK_SIZE - 1);
-		// Loop through blocks
-		for (s32 y = miny; y < maxy; y += BLOCK_SIZE)
+		for (s32 x = minx; x < maxx; x += BLOCK_SIZE)
 		{
-			for (s32 x = minx; x < maxx; x += BLOCK_SIZE)
+			// Corners of block
+			s32 x0 = x << 4;
+			s32 x1 = (x + BLOCK_SIZE - 1) << 4;
+			s32 y0 = y << 4;
+			s32 y1 = (y + BLOCK_SIZE - 1) << 4;
+
+			// Evaluate half-space functions
+			bool a00 = C1 + DX12 * y0 - DY12 * x0 > 0;
+			bool a10 = C1 + DX12 * y0 - DY12 * x1 > 0;
+			bool a01 = C1 + DX12 * y1 - DY12 * x0 > 0;
+			bool a11 = C1 + DX12 * y1 - DY12 * x1 > 0;
+			int a = (a00 << 0) | (a10 << 1) | (a01 << 2) | (a11 << 3);
+
+			bool b00 = C2 + DX23 * y0 - DY23 * x0 > 0;
+			bool b10 = C2 + DX23 * y0 - DY23 * x1 > 0;
+			bool b01 = C2 + DX23 * y1 - DY23 * x0 > 0;
+			bool b11 = C2 + DX23 * y1 - DY23 * x1 > 0;
+			int b = (b00 << 0) | (b10 << 1) | (b01 << 2) | (b11 << 3);
+
+			bool c00 = C3 + DX31 * y0 - DY31 * x0 > 0;
+			bool c10 = C3 + DX31 * y0 - DY31 * x1 > 0;
+			bool c01 = C3 + DX31 * y1 - DY31 * x0 > 0;
+			bool c11 = C3 + DX31 * y1 - DY31 * x1 > 0;
+			int c = (c00 << 0) | (c10 << 1) | (c01 << 2) | (c11 << 3);
+
+			// Skip block when outside an edge
+			if (a == 0x0 || b == 0x0 || c == 0x0)
+				continue;
+
+			BuildBlock(tri, context, x, y);
+
+			// Accept whole block when totally covered
+			if (a == 0xF && b == 0xF && c == 0xF)
 			{
-				// Corners of block
-				s32 x0 = x << 4;
-				s32 x1 = (x + BLOCK_SIZE - 1) << 4;
-				s32 y0 = y << 4;
-				s32 y1 = (y + BLOCK_SIZE - 1) << 4;
-
-				// Evaluate half-space functions
-				bool a00 = C1 + DX12 * y0 - DY12 * x0 > 0;
-				bool a10 = C1 + DX12 * y0 - DY12 * x1 > 0;
-				bool a01 = C1 + DX12 * y1 - DY12 * x0 > 0;
-				bool a11 = C1 + DX12 * y1 - DY12 * x1 > 0;
-				int a = (a00 << 0) | (a10 << 1) | (a01 << 2) | (a11 << 3);
-
-				bool b00 = C2 + DX23 * y0 - DY23 * x0 > 0;
-				bool b10 = C2 + DX23 * y0 - DY23 * x1 > 0;
-				bool b01 = C2 + DX23 * y1 - DY23 * x0 > 0;
-				bool b11 = C2 + DX23 * y1 - DY23 * x1 > 0;
-				int b = (b00 << 0) | (b10 << 1) | (b01 << 2) | (b11 << 3);
-
-				bool c00 = C3 + DX31 * y0 - DY31 * x0 > 0;
-				bool c10 = C3 + DX31 * y0 - DY31 * x1 > 0;
-				bool c01 = C3 + DX31 * y1 - DY31 * x0 > 0;
-				bool c11 = C3 + DX31 * y1 - DY31 * x1 > 0;
-				int c = (c00 << 0) | (c10 << 1) | (c01 << 2) | (c11 << 3);
-
-				// Skip block when outside an edge
-				if (a == 0x0 || b == 0x0 || c == 0x0)
-					continue;
-
-				BuildBlock(x, y);
-
-				// Accept whole block when totally covered
-				if (a == 0xF && b == 0xF && c == 0xF)
+				for (s32 iy = 0; iy < BLOCK_SIZE; iy++)
 				{
-					for (s32 iy = 0; iy < BLOCK_SIZE; iy++)
+					for (s32 ix = 0; ix < BLOCK_SIZE; ix++)
 					{
-						for (s32 ix = 0; ix < BLOCK_SIZE; ix++)
-						{
-							Draw(x + ix, y + iy, ix, iy);
-						}
+						Draw(tri, context, x + ix, y + iy, ix, iy);
 					}
 				}
-				else // Partially covered block
+			}
+			else // Partially covered block
+			{
+				s32 CY1 = C1 + DX12 * y0 - DY12 * x0;
+				s32 CY2 = C2 + DX23 * y0 - DY23 * x0;
+				s32 CY3 = C3 + DX31 * y0 - DY31 * x0;
+
+				for (s32 iy = 0; iy < BLOCK_SIZE; iy++)
 				{
-					s32 CY1 = C1 + DX12 * y0 - DY12 * x0;
-					s32 CY2 = C2 + DX23 * y0 - DY23 * x0;
-					s32 CY3 = C3 + DX31 * y0 - DY31 * x0;
+					s32 CX1 = CY1;
+					s32 CX2 = CY2;
+					s32 CX3 = CY3;
 
-					for (s32 iy = 0; iy < BLOCK_SIZE; iy++)
+					for (s32 ix = 0; ix < BLOCK_SIZE; ix++)
 					{
-						s32 CX1 = CY1;
-						s32 CX2 = CY2;
-						s32 CX3 = CY3;
-
-						for (s32 ix = 0; ix < BLOCK_SIZE; ix++)
+						if (CX1 > 0 && CX2 > 0 && CX3 > 0)
 						{
-							if (CX1 > 0 && CX2 > 0 && CX3 > 0)
-							{
-								Draw(x + ix, y + iy, ix, iy);
-							}
-
-							CX1 -= FDY12;
-							CX2 -= FDY23;
-							CX3 -= FDY31;
+							Draw(tri, context, x + ix, y + iy, ix, iy);
 						}
 
-						CY1 += FDX12;
-						CY2 += FDX23;
-						CY3 += FDX31;
+						CX1 -= FDY12;
+						CX2 -= FDY23;
+						CX3 -= FDY31;
 					}
+
+					CY1 += FDX12;
+					CY2 += FDX23;
+					CY3 += FDX31;
 				}
 			}
 		}
 	}
-	else
+}
+
+static void DrawBoundingBox(const TriangleSetup& tri, RasterContext& context)
+{
+	const s32 DX12 = tri.DX12, DX23 = tri.DX23, DX31 = tri.DX31;
+	const s32 DY12 = tri.DY12, DY23 = tri.DY23, DY31 = tri.DY31;
+	const s32 C1 = tri.C1, C2 = tri.C2, C3 = tri.C3;
+
+	const s32 FDX12 = DX12 * 16;
+	const s32 FDX23 = DX23 * 16;
+	const s32 FDX31 = DX31 * 16;
+
+	const s32 FDY12 = DY12 * 16;
+	const s32 FDY23 = DY23 * 16;
+	const s32 FDY31 = DY31 * 16;
+
+	s32 minx = tri.minx;
+	s32 maxx = tri.maxx;
+	s32 miny = tri.miny;
+	s32 maxy = tri.maxy;
+
+	// Calculating bbox
+	// First check for alpha channel - don't do anything it if always fails,
+	// Change bbox to primitive size if it always passes
+	AlphaTest::TEST_RESULT alphaRes = bpmem.alpha_test.TestResult();
+
+	if (alphaRes != AlphaTest::UNDETERMINED)
+	{
+		if (alphaRes == AlphaTest::PASS)
+		{
+			BoundingBox::coords[BoundingBox::TOP] = std::min(BoundingBox::coords[BoundingBox::TOP], (u16)miny);
+			BoundingBox::coords[BoundingBox::LEFT] = std::min(BoundingBox::coords[BoundingBox::LEFT], (u16)minx);
+			BoundingBox::coords[BoundingBox::BOTTOM] = std::max(BoundingBox::coords[BoundingBox::BOTTOM], (u16)maxy);
+			BoundingBox::coords[BoundingBox::RIGHT] = std::max(BoundingBox::coords[BoundingBox::RIGHT], (u16)maxx);
+		}
+		return;
+	}
+
+	// If we are calculating bbox with alpha, we only need to find the
+	// topmost, leftmost, bottom most and rightmost pixels to be drawn.
+	// So instead of drawing every single one of the triangle's pixels,
+	// four loops are run: one for the top pixel, one for the left, one for
+	// the bottom and one for the right. As soon as a pixel that is to be
+	// drawn is found, the loop breaks. This enables a ~150% speedbost in
+	// bbox calculation, albeit at the cost of some ugly repetitive code.
+	const s32 FLEFT = minx << 4;
+	const s32 FRIGHT = maxx << 4;
+	s32 FTOP = miny << 4;
+	s32 FBOTTOM = maxy << 4;
+
+	// Start checking for bbox top
+	s32 CY1 = C1 + DX12 * FTOP - DY12 * FLEFT;
+	s32 CY2 = C2 + DX23 * FTOP - DY23 * FLEFT;
+	s32 CY3 = C3 + DX31 * FTOP - DY31 * FLEFT;
+
+	// Loop
+	for (s32 y = miny; y <= maxy; ++y)
 	{
-		// Calculating bbox
-		// First check for alpha channel - don't do anything it if always fails,
-		// Change bbox to primitive size if it always passes
-		AlphaTest::TEST_RESULT alphaRes = bpmem.alpha_test.TestResult();
+		if (y >= BoundingBox::coords[BoundingBox::TOP])
+			break;
 
-		if (alphaRes != AlphaTest::UNDETERMINED)
+		s32 CX1 = CY1;
+		s32 CX2 = CY2;
+		s32 CX3 = CY3;
+
+		for (s32 x = minx; x <= maxx; ++x)
 		{
-			if (alphaRes == AlphaTest::PASS)
+			if (CX1 > 0 && CX2 > 0 && CX3 > 0)
 			{
-				BoundingBox::coords[BoundingBox::TOP] = std::min(BoundingBox::coords[BoundingBox::TOP], (u16)miny);
-				BoundingBox::coords[BoundingBox::LEFT] = std::min(BoundingBox::coords[BoundingBox::LEFT], (u16)minx);
-				BoundingBox::coords[BoundingBox::BOTTOM] = std::max(BoundingBox::coords[BoundingBox::BOTTOM], (u16)maxy);
-				BoundingBox::coords[BoundingBox::RIGHT] = std::max(BoundingBox::coords[BoundingBox::RIGHT], (u16)maxx);
+				// Build the new raster block every other pixel
+				PrepareBlock(tri, context, x, y);
+				Draw(tri, context, x, y, x & (BLOCK_SIZE - 1), y & (BLOCK_SIZE - 1));
+
+				if (y >= BoundingBox::coords[BoundingBox::TOP])
+					break;
 			}
-			return;
+
+			CX1 -= FDY12;
+			CX2 -= FDY23;
+			CX3 -= FDY31;
 		}
 
-		// If we are calculating bbox with alpha, we only need to find the
-		// topmost, leftmost, bottom most and rightmost pixels to be drawn.
-		// So instead of drawing every single one of the triangle's pixels,
-		// four loops are run: one for the top pixel, one for the left, one for
-		// the bottom and one for the right. As soon as a pixel that is to be
-		// drawn is found, the loop breaks. This enables a ~150% speedbost in
-		// bbox calculation, albeit at the cost of some ugly repetitive code.
-		const s32 FLEFT = minx << 4;
-		const s32 FRIGHT = maxx << 4;
-		s32 FTOP = miny << 4;
-		s32 FBOTTOM = maxy << 4;
-
-		// Start checking for bbox top
-		s32 CY1 = C1 + DX12 * FTOP - DY12 * FLEFT;
-		s32 CY2 = C2 + DX23 * FTOP - DY23 * FLEFT;
-		s32 CY3 = C3 + DX31 * FTOP - DY31 * FLEFT;
-
-		// Loop
-		for (s32 y = miny; y <= maxy; ++y)
-		{
-			if (y >= BoundingBox::coords[BoundingBox::TOP])
-				break;
+		CY1 += FDX12;
+		CY2 += FDX23;
+		CY3 += FDX31;
+	}
 
-			s32 CX1 = CY1;
-			s32 CX2 = CY2;
-			s32 CX3 = CY3;
+	// Update top limit
+	miny = std::max((s32)BoundingBox::coords[BoundingBox::TOP], miny);
+	FTOP = miny << 4;
 
-			for (s32 x = minx; x <= maxx; ++x)
-			{
-				if (CX1 > 0 && CX2 > 0 && CX3 > 0)
-				{
-					// Build the new raster block every other pixel
-					PrepareBlock(x, y);
-					Draw(x, y, x & (BLOCK_SIZE - 1), y & (BLOCK_SIZE - 1));
+	// Checking for bbox left
+	s32 CX1 = C1 + DX12 * FTOP - DY12 * FLEFT;
+	s32 CX2 = C2 + DX23 * FTOP - DY23 * FLEFT;
+	s32 CX3 = C3 + DX31 * FTOP - DY31 * FLEFT;
 
-					if (y >= BoundingBox::coords[BoundingBox::TOP])
-						break;
-				}
+	// Loop
+	for (s32 x = minx; x <= maxx; ++x)
+	{
+		if (x >= BoundingBox::coords[BoundingBox::LEFT])
+			break;
 
-				CX1 -= FDY12;
-				CX2 -= FDY23;
-				CX3 -= FDY31;
+		CY1 = CX1;
+		CY2 = CX2;
+		CY3 = CX3;
+
+		for (s32 y = miny; y <= maxy; ++y)
+		{
+			if (CY1 > 0 && CY2 > 0 && CY3 > 0)
+			{
+				PrepareBlock(tri, context, x, y);
+				Draw(tri, context, x, y, x & (BLOCK_SIZE - 1), y & (BLOCK_SIZE - 1));
+
+				if (x >= BoundingBox::coords[BoundingBox::LEFT])
+					break;
 			}
 
 			CY1 += FDX12;
@@ -549,79 +641,80 @@ void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVer
 			CY3 += FDX31;
 		}
 
-		// Update top limit
-		miny = std::max((s32)BoundingBox::coords[BoundingBox::TOP], miny);
-		FTOP = miny << 4;
+		CX1 -= FDY12;
+		CX2 -= FDY23;
+		CX3 -= FDY31;
+	}
 
-		// Checking for bbox left
-		s32 CX1 = C1 + DX12 * FTOP - DY12 * FLEFT;
-		s32 CX2 = C2 + DX23 * FTOP - DY23 * FLEFT;
-		s32 CX3 = C3 + DX31 * FTOP - DY31 * FLEFT;
+	// Update left limit
+	minx = std::max((s32)BoundingBox::coords[BoundingBox::LEFT], minx);
 
-		// Loop
-		for (s32 x = minx; x <= maxx; ++x)
-		{
-			if (x >= BoundingBox::coords[BoundingBox::LEFT])
-				break;
+	// Checking for bbox bottom
+	CY1 = C1 + DX12 * FBOTTOM - DY12 * FRIGHT;
+	CY2 = C2 + DX23 * FBOTTOM - DY23 * FRIGHT;
+	CY3 = C3 + DX31 * FBOTTOM - DY31 * FRIGHT;
 
-			CY1 = CX1;
-			CY2 = CX2;
-			CY3 = CX3;
+	// Loop
+	for (s32 y = maxy; y >= miny; --y)
+	{
+		CX1 = CY1;
+		CX2 = CY2;
+		CX3 = CY3;
 
-			for (s32 y = miny; y <= maxy; ++y)
-			{
-				if (CY1 > 0 && CY2 > 0 && CY3 > 0)
-				{
-					PrepareBlock(x, y);
-					Draw(x, y, x & (BLOCK_SIZE - 1), y & (BLOCK_SIZE - 1));
+		if (y <= BoundingBox::coords[BoundingBox::BOTTOM])
+			break;
 
-					if (x >= BoundingBox::coords[BoundingBox::LEFT])
-						break;
-				}
+		for (s32 x = maxx; x >= minx; --x)
+		{
+			if (CX1 > 0 && CX2 > 0 && CX3 > 0)
+			{
+				// Build the new raster block every other pixel
+				PrepareBlock(tri, context, x, y);
+				Draw(tri, context, x, y, x & (BLOCK_SIZE - 1), y & (BLOCK_SIZE - 1));
 
-				CY1 += FDX12;
-				CY2 += FDX23;
-				CY3 += FDX31;
+				if (y <= BoundingBox::coords[BoundingBox::BOTTOM])
+					break;
 			}
 
-			CX1 -= FDY12;
-			CX2 -= FDY23;
-			CX3 -= FDY31;
+			CX1 += FDY12;
+			CX2 += FDY23;
+			CX3 += FDY31;
 		}
 
-		// Update left limit
-		minx = std::max((s32)BoundingBox::coords[BoundingBox::LEFT], minx);
+		CY1 -= FDX12;
+		CY2 -= FDX23;
+		CY3 -= FDX31;
+	}
 
-		// Checking for bbox bottom
-		CY1 = C1 + DX12 * FBOTTOM - DY12 * FRIGHT;
-		CY2 = C2 + DX23 * FBOTTOM - DY23 * FRIGHT;
-		CY3 = C3 + DX31 * FBOTTOM - DY31 * FRIGHT;
+	// Update bottom limit
+	maxy = std::min((s32)BoundingBox::coords[BoundingBox::BOTTOM], maxy);
+	FBOTTOM = maxy << 4;
 
-		// Loop
-		for (s32 y = maxy; y >= miny; --y)
-		{
-			CX1 = CY1;
-			CX2 = CY2;
-			CX3 = CY3;
+	// Checking for bbox right
+	CX1 = C1 + DX12 * FBOTTOM - DY12 * FRIGHT;
+	CX2 = C2 + DX23 * FBOTTOM - DY23 * FRIGHT;
+	CX3 = C3 + DX31 * FBOTTOM - DY31 * FRIGHT;
 
-			if (y <= BoundingBox::coords[BoundingBox::BOTTOM])
-				break;
+	// Loop
+	for (s32 x = maxx; x >= minx; --x)
+	{
+		if (x <= BoundingBox::coords[BoundingBox::RIGHT])
+			break;
 
-			for (s32 x = maxx; x >= minx; --x)
-			{
-				if (CX1 > 0 && CX2 > 0 && CX3 > 0)
-				{
-					// Build the new raster block every other pixel
-					PrepareBlock(x, y);
-					Draw(x, y, x & (BLOCK_SIZE - 1), y & (BLOCK_SIZE - 1));
+		CY1 = CX1;
+		CY2 = CX2;
+		CY3 = CX3;
 
-					if (y <= BoundingBox::coords[BoundingBox::BOTTOM])
-						break;
-				}
+		for (s32 y = maxy; y >= miny; --y)
+		{
+			if (CY1 > 0 && CY2 > 0 && CY3 > 0)
+			{
+				// Build the new raster block every other pixel
+				PrepareBlock(tri, context, x, y);
+				Draw(tri, context, x, y, x & (BLOCK_SIZE - 1), y & (BLOCK_SIZE - 1));
 
-				CX1 += FDY12;
-				CX2 += FDY23;
-				CX3 += FDY31;
+				if (x <= BoundingBox::coords[BoundingBox::RIGHT])
+					break;
 			}
 
 			CY1 -= FDX12;
@@ -629,46 +722,209 @@ void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVer
 			CY3 -= FDX31;
 		}
 
-		// Update bottom limit
-		maxy = std::min((s32)BoundingBox::coords[BoundingBox::BOTTOM], maxy);
-		FBOTTOM = maxy << 4;
+		CX1 += FDY12;
+		CX2 += FDY23;
+		CX3 += FDY31;
+	}
+}
 
-		// Checking for bbox right
-		CX1 = C1 + DX12 * FBOTTOM - DY12 * FRIGHT;
-		CX2 = C2 + DX23 * FBOTTOM - DY23 * FRIGHT;
-		CX3 = C3 + DX31 * FBOTTOM - DY31 * FRIGHT;
+static void DrawTile(RasterContext& context, u32 tile)
+{
+	const s32 tile_left = static_cast<s32>(tile % TILES_X) * TILE_SIZE;
+	const s32 tile_top = static_cast<s32>(tile / TILES_X) * TILE_SIZE;
+	for (u32 index : s_tile_triangles[tile])
+	{
+		const TriangleSetup& tri = s_triangles[index];
+		DrawBlocks(tri, context,
+			std::max(tri.minx & ~(BLOCK_SIZE - 1), tile_left), std::min(tri.maxx, tile_left + TILE_SIZE),
+			std::max(tri.miny & ~(BLOCK_SIZE - 1), tile_top), std::min(tri.maxy, tile_top + TILE_SIZE));
+	}
+}
 
-		// Loop
-		for (s32 x = maxx; x >= minx; --x)
-		{
-			if (x <= BoundingBox::coords[BoundingBox::RIGHT])
-				break;
+static void DrawTiles(RasterContext& context)
+{
+	u32 i;
+	while ((i = s_next_tile.fetch_add(1)) < s_active_tiles.size())
+		DrawTile(context, s_active_tiles[i]);
+}
 
-			CY1 = CX1;
-			CY2 = CX2;
-			CY3 = CX3;
+static void FlushStatistics(RasterContext& context)
+{
+	ADDSTAT(stats.thisFrame.rasterizedPixels, context.rasterizedPixels);
+	ADDSTAT(stats.thisFrame.tevPixelsIn, context.tev.PixelsIn);
+	ADDSTAT(stats.thisFrame.tevPixelsOut, context.tev.PixelsOut);
+	context.rasterizedPixels = 0;
+	context.tev.PixelsIn = 0;
+	context.tev.PixelsOut = 0;
+}
 
-			for (s32 y = maxy; y >= miny; --y)
-			{
-				if (CY1 > 0 && CY2 > 0 && CY3 > 0)
-				{
-					// Build the new raster block every other pixel
-					PrepareBlock(x, y);
-					Draw(x, y, x & (BLOCK_SIZE - 1), y & (BLOCK_SIZE - 1));
+static bool UseWorkers()
+{
+	// The tev stage dumps write to shared buffers, bounding box reads need pixel order.
+	return !s_workers.empty() && !BoundingBox::active && !g_ActiveConfig.bDumpTevStages &&
+		!g_ActiveConfig.bDumpTevTextureFetches;
+}
 
-					if (x <= BoundingBox::coords[BoundingBox::RIGHT])
-						break;
-				}
+static void BinTriangle(const TriangleSetup& tri)
+{
+	const u32 index = static_cast<u32>(s_triangles.size());
+	s_triangles.push_back(tri);
+
+	// Blocks start on even pixels and can reach one pixel past maxx/maxy, which is still in the
+	// tile of the block's first pixel.
+	const s32 tile_left = (tri.minx & ~(BLOCK_SIZE - 1)) / TILE_SIZE;
+	const s32 tile_right = (tri.maxx - 1) / TILE_SIZE;
+	const s32 tile_top = (tri.miny & ~(BLOCK_SIZE - 1)) / TILE_SIZE;
+	const s32 tile_bottom = (tri.maxy - 1) / TILE_SIZE;
+	for (s32 ty = tile_top; ty <= tile_bottom; ty++)
+	{
+		for (s32 tx = tile_left; tx <= tile_right; tx++)
+		{
+			std::vector<u32>& triangles = s_tile_triangles[ty * TILES_X + tx];
+			if (triangles.empty())
+				s_active_tiles.push_back(static_cast<u32>(ty * TILES_X + tx));
+			triangles.push_back(index);
+		}
+	}
+
+	if (s_triangles.size() >= MAX_BINNED_TRIANGLES)
+		Flush();
+}
 
-				CY1 -= FDX12;
-				CY2 -= FDX23;
-				CY3 -= FDX31;
+void Flush()
+{
+	if (!s_active_tiles.empty())
+	{
+		s_next_tile.store(0);
+		if (s_active_tiles.size() > 1)
+		{
+			// Registers can change between draw calls, the rest of the state is in bpmem.
+			for (auto& worker : s_workers)
+			{
+				worker->context.tev.CopyRegisters(s_context.tev);
+				worker->context.tev.SetupStages();
 			}
 
-			CX1 += FDY12;
-			CX2 += FDY23;
-			CX3 += FDY31;
+			s_busy_workers.store(static_cast<u32>(s_workers.size()));
+			for (auto& worker : s_workers)
+				worker->wake.Set();
+			DrawTiles(s_context);
+			s_tiles_done.Wait();
+
+			for (auto& worker : s_workers)
+				FlushStatistics(worker->context);
 		}
+		else
+		{
+			DrawTiles(s_context);
+		}
+
+		for (u32 tile : s_active_tiles)
+			s_tile_triangles[tile].clear();
+		s_active_tiles.clear();
+		s_triangles.clear();
+	}
+
+	FlushStatistics(s_context);
+}
+
+void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVertexData *v2)
+{
+	INCSTAT(stats.thisFrame.numTrianglesDrawn);
+
+	// adapted from http://devmaster.net/posts/6145/advanced-rasterization
+
+	// 28.4 fixed-pou32 coordinates. rounded to nearest and adjusted to match hardware output
+	// could also take floor and adjust -8
+	const s32 Y1 = iround(16.0f * v0->screenPosition[1]) - 9;
+	const s32 Y2 = iround(16.0f * v1->screenPosition[1]) - 9;
+	const s32 Y3 = iround(16.0f * v2->screenPosition[1]) - 9;
+
+	const s32 X1 = iround(16.0f * v0->screenPosition[0]) - 9;
+	const s32 X2 = iround(16.0f * v1->screenPosition[0]) - 9;
+	const s32 X3 = iround(16.0f * v2->screenPosition[0]) - 9;
+
+	TriangleSetup tri;
+
+	// Deltas
+	tri.DX12 = X1 - X2;
+	tri.DX23 = X2 - X3;
+	tri.DX31 = X3 - X1;
+
+	tri.DY12 = Y1 - Y2;
+	tri.DY23 = Y2 - Y3;
+	tri.DY31 = Y3 - Y1;
+
+	// Bounding rectangle
+	s32 minx = (std::min(std::min(X1, X2), X3) + 0xF) >> 4;
+	s32 maxx = (std::max(std::max(X1, X2), X3) + 0xF) >> 4;
+	s32 miny = (std::min(std::min(Y1, Y2), Y3) + 0xF) >> 4;
+	s32 maxy = (std::max(std::max(Y1, Y2), Y3) + 0xF) >> 4;
+
+	// scissor
+	tri.minx = minx = std::max(minx, scissorLeft);
+	tri.maxx = maxx = std::min(maxx, scissorRight);
+	tri.miny = miny = std::max(miny, scissorTop);
+	tri.maxy = maxy = std::min(maxy, scissorBottom);
+
+	if (minx >= maxx || miny >= maxy)
+		return;
+
+	// Setup slopes
+	float fltx1 = v0->screenPosition.x;
+	float flty1 = v0->screenPosition.y;
+	float fltdx31 = v2->screenPosition.x - fltx1;
+	float fltdx12 = fltx1 - v1->screenPosition.x;
+	float fltdy12 = flty1 - v1->screenPosition.y;
+	float fltdy31 = v2->screenPosition.y - flty1;
+
+	InitTriangle(&tri, fltx1, flty1, (X1 + 0xF) >> 4, (Y1 + 0xF) >> 4);
+
+	float w[3] = {1.0f / v0->projectedPosition.w, 1.0f / v1->projectedPosition.w, 1.0f / v2->projectedPosition.w};
+	InitSlope(&tri.WSlope, w[0], w[1], w[2], fltdx31, fltdx12, fltdy12, fltdy31);
+
+	// TODO: The zfreeze emulation is not quite correct, yet!
+	// Many things might prevent us from reaching this line (culling, clipping, scissoring).
+	// However, the zslope is always guaranteed to be calculated unless all vertices are trivially rejected during clipping!
+	// We're currently sloppy at this since we abort early if any of the culling/clipping/scissoring tests fail.
+	if (!bpmem.genMode.zfreeze || !g_ActiveConfig.bZFreeze)
+		InitSlope(&ZSlope, v0->screenPosition[2], v1->screenPosition[2], v2->screenPosition[2], fltdx31, fltdx12, fltdy12, fltdy31);
+	tri.ZSlope = ZSlope;
+
+	for (unsigned int i = 0; i < bpmem.genMode.numcolchans; i++)
+	{
+		for (int comp = 0; comp < 4; comp++)
+			InitSlope(&tri.ColorSlopes[i][comp], v0->color[i][comp], v1->color[i][comp], v2->color[i][comp], fltdx31, fltdx12, fltdy12, fltdy31);
+	}
+
+	for (unsigned int i = 0; i < bpmem.genMode.numtexgens; i++)
+	{
+		for (int comp = 0; comp < 3; comp++)
+			InitSlope(&tri.TexSlopes[i][comp], v0->texCoords[i][comp] * w[0], v1->texCoords[i][comp] * w[1], v2->texCoords[i][comp] * w[2], fltdx31, fltdx12, fltdy12, fltdy31);
+	}
+
+	// Half-edge constants
+	tri.C1 = tri.DY12 * X1 - tri.DX12 * Y1;
+	tri.C2 = tri.DY23 * X2 - tri.DX23 * Y2;
+	tri.C3 = tri.DY31 * X3 - tri.DX31 * Y3;
+
+	// Correct for fill convention
+	if (tri.DY12 < 0 || (tri.DY12 == 0 && tri.DX12 > 0)) tri.C1++;
+	if (tri.DY23 < 0 || (tri.DY23 == 0 && tri.DX23 > 0)) tri.C2++;
+	if (tri.DY31 < 0 || (tri.DY31 == 0 && tri.DX31 > 0)) tri.C3++;
+
+	if (UseWorkers())
+	{
+		BinTriangle(tri);
+	}
+	else if (!BoundingBox::active)
+	{
+		// Start in corner of 8x8 block
+		DrawBlocks(tri, s_context, minx & ~(BLOCK_SIZE - 1), maxx, miny & ~(BLOCK_SIZE - 1), maxy);
+	}
+	else
+	{
+		DrawBoundingBox(tri, s_context);
 	}
 }
 
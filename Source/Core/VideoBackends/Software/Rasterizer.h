@@ -11,12 +11,16 @@ struct OutputVertexData;
 namespace Rasterizer
 {
 void Init();
+void Shutdown();
 
+// May only bin the triangle, Flush draws everything binned so far.
 void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVertexData *v2);
+void Flush();
 
 void SetScissor();
 
 void SetTevReg(int reg, int comp, bool konst, s16 color);
+void SetTevStages();
 
 struct Slope
 {
@@ -24,7 +28,7 @@ struct Slope
 	float dfdy;
 	float f0;
 
-	float GetValue(float dx, float dy)
+	float GetValue(float dx, float dy) const
 	{
 		return f0 + (dfdx * dx) + (dfdy * dy);
 	}
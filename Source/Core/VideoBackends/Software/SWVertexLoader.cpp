@@ -2,6 +2,7 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <limits>
 
 #include "Common/ChunkFile.h"
@@ -97,6 +98,13 @@ void SWVertexLoader::vFlush(bool useDstAlpha)
 		Rasterizer::SetTevReg(i, Tev::BLU_C, true, kcolors[i * 4 + 2]);
 		Rasterizer::SetTevReg(i, Tev::ALP_C, true, kcolors[i * 4 + 3]);
 	}
+	Rasterizer::SetTevStages();
+
+	const u32 num_vertices = IndexGenerator::GetNumVerts();
+	if (m_TransformedVertices.size() < num_vertices)
+		m_TransformedVertices.resize(num_vertices);
+	for (u32 first = 0; first < num_vertices; first += TRANSFORM_BATCH_SIZE)
+		TransformVertices(first, std::min(TRANSFORM_BATCH_SIZE, num_vertices - first), primitiveType);
 
 	for (u32 i = 0; i < IndexGenerator::GetIndexLen(); i++)
 	{
@@ -108,6 +116,23 @@ void SWVertexLoader::vFlush(bool useDstAlpha)
 			m_SetupUnit->Init(primitiveType);
 			continue;
 		}
+
+		// assemble and rasterize the primitive
+		*m_SetupUnit->GetVertex() = m_TransformedVertices[index];
+		m_SetupUnit->SetupVertex();
+
+		INCSTAT(stats.thisFrame.numVerticesLoaded)
+	}
+
+	Rasterizer::Flush();
+	DebugUtil::OnObjectEnd();
+}
+
+void SWVertexLoader::TransformVertices(u32 first, u32 count, u8 primitiveType)
+{
+	const PortableVertexDeclaration& vdec = VertexLoaderManager::GetCurrentVertexFormat()->GetVertexDeclaration();
+	for (u32 i = 0; i < count; i++)
+	{
 		memset(&m_Vertex, 0, sizeof(m_Vertex));
 
 		// Super Mario Sunshine requires those to be zero for those debug boxes.
@@ -115,26 +140,25 @@ void SWVertexLoader::vFlush(bool useDstAlpha)
 
 		// parse the videocommon format to our own struct format (m_Vertex)
 		SetFormat(g_main_cp_state.last_id, primitiveType);
-		ParseVertex(VertexLoaderManager::GetCurrentVertexFormat()->GetVertexDeclaration(), index);
+		ParseVertex(vdec, first + i);
+		m_VertexBatch[i] = m_Vertex;
+	}
 
-		// transform this vertex so that it can be used for rasterization (outVertex)
-		OutputVertexData* outVertex = m_SetupUnit->GetVertex();
-		TransformUnit::TransformPosition(&m_Vertex, outVertex);
+	// transform the vertices so that they can be used for rasterization
+	OutputVertexData* outVertices = &m_TransformedVertices[first];
+	TransformUnit::TransformPositions(m_VertexBatch, outVertices, count);
+	for (u32 i = 0; i < count; i++)
+	{
+		const InputVertexData* inVertex = &m_VertexBatch[i];
+		OutputVertexData* outVertex = &outVertices[i];
 		memset(&outVertex->normal, 0, sizeof(outVertex->normal));
 		if (VertexLoaderManager::g_current_components & VB_HAS_NRM0)
 		{
-			TransformUnit::TransformNormal(&m_Vertex, (VertexLoaderManager::g_current_components & VB_HAS_NRM2) != 0, outVertex);
+			TransformUnit::TransformNormal(inVertex, (VertexLoaderManager::g_current_components & VB_HAS_NRM2) != 0, outVertex);
 		}
-		TransformUnit::TransformColor(&m_Vertex, outVertex);
-		TransformUnit::TransformTexCoord(&m_Vertex, outVertex, m_TexGenSpecialCase);
-
-		// assemble and rasterize the primitive
-		m_SetupUnit->SetupVertex();
-
-		INCSTAT(stats.thisFrame.numVerticesLoaded)
+		TransformUnit::TransformColor(inVertex, outVertex);
+		TransformUnit::TransformTexCoord(inVertex, outVertex, m_TexGenSpecialCase);
 	}
-
-	DebugUtil::OnObjectEnd();
 }
 
 void SWVertexLoader::SetFormat(u8 attributeIndex, u8 primitiveType)
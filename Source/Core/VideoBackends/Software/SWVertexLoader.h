@@ -39,7 +39,13 @@ private:
 
 	InputVertexData m_Vertex;
 
+	// Every vertex of a draw call is transformed once in batches, the index list only copies the results.
+	static constexpr u32 TRANSFORM_BATCH_SIZE = 64;
+	InputVertexData m_VertexBatch[TRANSFORM_BATCH_SIZE];
+	std::vector<OutputVertexData> m_TransformedVertices;
+
 	void ParseVertex(const PortableVertexDeclaration& vdec, int index);
+	void TransformVertices(u32 first, u32 count, u8 primitiveType);
 
 	SetupUnit *m_SetupUnit;
 
@@ -55,7 +55,8 @@ public:
 	{}
 	void ResetQuery() override
 	{
-		memset(EfbInterface::perf_values, 0, sizeof(EfbInterface::perf_values));
+		for (std::atomic<u32>& value : EfbInterface::perf_values)
+			value.store(0);
 	}
 	u32 GetQueryResult(PerfQueryType type) override
 	{
@@ -191,6 +192,10 @@ void VideoSoftware::InitBackendInfo()
 	g_Config.backend_info.bSupportsDualSourceBlend = true;
 	g_Config.backend_info.bSupportsEarlyZ = true;
 	g_Config.backend_info.bSupportsOversizedViewports = true;
+	g_Config.backend_info.bSupportsPrimitiveRestart = false;
+	g_Config.backend_info.bSupports32BitIndices = false;
+	g_Config.backend_info.bSupportsDeferredEFBCopies = false;
+	g_Config.backend_info.bSupportsVirtualXFBWriteBack = false;
 
 	// aamodes
 	g_Config.backend_info.AAModes = {1};
@@ -243,6 +248,7 @@ void VideoSoftware::Video_Cleanup()
 		// The following calls are NOT Thread Safe
 		// And need to be called from the video thread
 		SWRenderer::Shutdown();
+		Rasterizer::Shutdown();
 		VertexLoaderManager::Shutdown();
 		g_framebuffer_manager.reset();
 		g_texture_cache.reset();
@@ -3,9 +3,11 @@
 // Refer to the license.txt file included.
 
 #include <cmath>
+#include <cstring>
 
 #include "Common/ChunkFile.h"
 #include "Common/CommonTypes.h"
+#include "Common/Intrinsics.h"
 #include "VideoBackends/Software/DebugUtil.h"
 #include "VideoBackends/Software/EfbInterface.h"
 #include "VideoBackends/Software/Tev.h"
@@ -13,7 +15,6 @@
 
 #include "VideoCommon/BoundingBox.h"
 #include "VideoCommon/PerfQueryBase.h"
-#include "VideoCommon/Statistics.h"
 #include "VideoCommon/VideoConfig.h"
 #include "VideoCommon/XFMemory.h"
 
@@ -25,6 +26,9 @@
 
 void Tev::Init()
 {
+	PixelsIn = 0;
+	PixelsOut = 0;
+
 	FixedConstants[0] = 0;
 	FixedConstants[1] = 32;
 	FixedConstants[2] = 64;
@@ -54,7 +58,7 @@ void Tev::Init()
 	m_ColorInputLUT[11][RED_INP] = &RasColor[ALP_C]; m_ColorInputLUT[11][GRN_INP] = &RasColor[ALP_C]; m_ColorInputLUT[11][BLU_INP] = &RasColor[ALP_C]; // ras.rgb
 	m_ColorInputLUT[12][RED_INP] = &FixedConstants[8]; m_ColorInputLUT[12][GRN_INP] = &FixedConstants[8]; m_ColorInputLUT[12][BLU_INP] = &FixedConstants[8]; // one
 	m_ColorInputLUT[13][RED_INP] = &FixedConstants[4]; m_ColorInputLUT[13][GRN_INP] = &FixedConstants[4]; m_ColorInputLUT[13][BLU_INP] = &FixedConstants[4]; // half
-	m_ColorInputLUT[14][RED_INP] = &StageKonst[RED_C]; m_ColorInputLUT[14][GRN_INP] = &StageKonst[GRN_C]; m_ColorInputLUT[14][BLU_INP] = &StageKonst[BLU_C]; // konst
+	m_ColorInputLUT[14][RED_INP] = nullptr; m_ColorInputLUT[14][GRN_INP] = nullptr; m_ColorInputLUT[14][BLU_INP] = nullptr; // konst, selected per stage by SetupStages
 	m_ColorInputLUT[15][RED_INP] = &FixedConstants[0]; m_ColorInputLUT[15][GRN_INP] = &FixedConstants[0]; m_ColorInputLUT[15][BLU_INP] = &FixedConstants[0]; // zero
 
 	m_AlphaInputLUT[0] = &Reg[0][ALP_C]; // prev
@@ -63,7 +67,7 @@ void Tev::Init()
 	m_AlphaInputLUT[3] = &Reg[3][ALP_C]; // c2
 	m_AlphaInputLUT[4] = &TexColor[ALP_C]; // tex
 	m_AlphaInputLUT[5] = &RasColor[ALP_C]; // ras
-	m_AlphaInputLUT[6] = &StageKonst[ALP_C]; // konst
+	m_AlphaInputLUT[6] = nullptr; // konst, selected per stage by SetupStages
 	m_AlphaInputLUT[7] = &Zero16[ALP_C]; // zero
 
 	for (int comp = 0; comp < 4; comp++)
@@ -136,28 +140,18 @@ static inline s16 Clamp1024(s16 in)
 	return in > 1023 ? 1023 : (in < -1024 ? -1024 : in);
 }
 
-void Tev::SetRasColor(int colorChan, int swaptable)
+void Tev::SetRasColor(int colorChan, const u8 swap[4])
 {
 	switch (colorChan)
 	{
 	case 0: // Color0
-	{
-		u8 *color = Color[0];
-		RasColor[RED_C] = color[bpmem.tevksel[swaptable].swap1];
-		RasColor[GRN_C] = color[bpmem.tevksel[swaptable].swap2];
-		swaptable++;
-		RasColor[BLU_C] = color[bpmem.tevksel[swaptable].swap1];
-		RasColor[ALP_C] = color[bpmem.tevksel[swaptable].swap2];
-	}
-	break;
 	case 1: // Color1
 	{
-		u8 *color = Color[1];
-		RasColor[RED_C] = color[bpmem.tevksel[swaptable].swap1];
-		RasColor[GRN_C] = color[bpmem.tevksel[swaptable].swap2];
-		swaptable++;
-		RasColor[BLU_C] = color[bpmem.tevksel[swaptable].swap1];
-		RasColor[ALP_C] = color[bpmem.tevksel[swaptable].swap2];
+		const u8 *color = Color[colorChan];
+		RasColor[RED_C] = color[swap[RED_C]];
+		RasColor[GRN_C] = color[swap[GRN_C]];
+		RasColor[BLU_C] = color[swap[BLU_C]];
+		RasColor[ALP_C] = color[swap[ALP_C]];
 	}
 	break;
 	case 5: // alpha bump
@@ -337,6 +331,63 @@ void Tev::DrawAlphaCompare(TevStageCombiner::AlphaCombiner& ac, const InputRegTy
 	}
 }
 
+#ifdef _M_X86
+// Same results as DrawColorRegular and DrawAlphaRegular followed by the clamps, with one
+// 32 bit lane per component in ABGR order. The lerp of all four components is a single madd.
+void Tev::DrawRegularSSE2(const TevStageCombiner::ColorCombiner& cc, const TevStageCombiner::AlphaCombiner& ac,
+	const InputRegType inputs[4])
+{
+	const int cl = m_ScaleLShiftLUT[cc.shift];
+	const int al = m_ScaleLShiftLUT[ac.shift];
+	u16 c[4];
+	for (int i = 0; i < 4; i++)
+		c[i] = inputs[i].c + (inputs[i].c >> 7);
+
+	// (a << shift) * (256 - c) + (b << shift) * c, the shifted inputs still fit in 16 bits
+	const __m128i ab = _mm_setr_epi16(
+		inputs[ALP_C].a << al, inputs[ALP_C].b << al, inputs[BLU_C].a << cl, inputs[BLU_C].b << cl,
+		inputs[GRN_C].a << cl, inputs[GRN_C].b << cl, inputs[RED_C].a << cl, inputs[RED_C].b << cl);
+	const __m128i weights = _mm_setr_epi16(
+		256 - c[ALP_C], c[ALP_C], 256 - c[BLU_C], c[BLU_C], 256 - c[GRN_C], c[GRN_C], 256 - c[RED_C], c[RED_C]);
+	__m128i temp = _mm_madd_epi16(ab, weights);
+
+	const s32 color_round = (cc.shift == 3) ? 0 : (cc.op == 1) ? 127 : 128;
+	const s32 alpha_round = (ac.shift != 3) ? 0 : (ac.op == 1) ? 127 : 128;
+	temp = _mm_add_epi32(temp, _mm_setr_epi32(alpha_round, color_round, color_round, color_round));
+
+	// The alpha combiner negates before the shift, the color combiner after it
+	const __m128i negate_before = _mm_setr_epi32(ac.op ? -1 : 0, 0, 0, 0);
+	const s32 color_negate = cc.op ? -1 : 0;
+	const __m128i negate_after = _mm_setr_epi32(0, color_negate, color_negate, color_negate);
+	temp = _mm_sub_epi32(_mm_xor_si128(temp, negate_before), negate_before);
+	temp = _mm_srai_epi32(temp, 8);
+	temp = _mm_sub_epi32(_mm_xor_si128(temp, negate_after), negate_after);
+
+	const __m128i d = _mm_setr_epi32(
+		(inputs[ALP_C].d + m_BiasLUT[ac.bias]) << al, (inputs[BLU_C].d + m_BiasLUT[cc.bias]) << cl,
+		(inputs[GRN_C].d + m_BiasLUT[cc.bias]) << cl, (inputs[RED_C].d + m_BiasLUT[cc.bias]) << cl);
+	__m128i result = _mm_add_epi32(d, temp);
+
+	const s32 color_halve = m_ScaleRShiftLUT[cc.shift] ? -1 : 0;
+	const __m128i halve = _mm_setr_epi32(m_ScaleRShiftLUT[ac.shift] ? -1 : 0, color_halve, color_halve, color_halve);
+	result = _mm_or_si128(_mm_andnot_si128(halve, result), _mm_and_si128(halve, _mm_srai_epi32(result, 1)));
+
+	// The results are well within 16 bits, so the saturating pack does not change them
+	__m128i packed = _mm_packs_epi32(result, result);
+	const s16 color_max = cc.clamp ? 255 : 1023;
+	const s16 color_min = cc.clamp ? 0 : -1024;
+	packed = _mm_min_epi16(packed, _mm_setr_epi16(ac.clamp ? 255 : 1023, color_max, color_max, color_max, 0, 0, 0, 0));
+	packed = _mm_max_epi16(packed, _mm_setr_epi16(ac.clamp ? 0 : -1024, color_min, color_min, color_min, 0, 0, 0, 0));
+
+	s16 output[4];
+	_mm_storel_epi64(reinterpret_cast<__m128i*>(output), packed);
+	Reg[cc.dest][BLU_C] = output[BLU_C];
+	Reg[cc.dest][GRN_C] = output[GRN_C];
+	Reg[cc.dest][RED_C] = output[RED_C];
+	Reg[ac.dest][ALP_C] = output[ALP_C];
+}
+#endif
+
 static bool AlphaCompare(int alpha, int ref, AlphaTest::CompareMode comp)
 {
 	switch (comp)
@@ -368,6 +419,53 @@ static bool TevAlphaTest(int alpha)
 	}
 }
 
+// Component order for a swap table pair, indexed by the ABGR component
+static void GetSwapTable(int swaptable, u8 swap[4])
+{
+	swap[Tev::RED_C] = bpmem.tevksel[swaptable].swap1;
+	swap[Tev::GRN_C] = bpmem.tevksel[swaptable].swap2;
+	swap[Tev::BLU_C] = bpmem.tevksel[swaptable + 1].swap1;
+	swap[Tev::ALP_C] = bpmem.tevksel[swaptable + 1].swap2;
+}
+
+void Tev::SetupStages()
+{
+	for (unsigned int stageNum = 0; stageNum <= bpmem.genMode.numtevstages.Value(); stageNum++)
+	{
+		int stageOdd = stageNum & 1;
+		const TwoTevStageOrders &order = bpmem.tevorders[stageNum >> 1];
+		const TevKSel &kSel = bpmem.tevksel[stageNum >> 1];
+		StageConfig& stage = m_Stages[stageNum];
+
+		stage.cc = bpmem.combiners[stageNum].colorC;
+		stage.ac = bpmem.combiners[stageNum].alphaC;
+		stage.texcoord = order.getTexCoord(stageOdd);
+		stage.texmap = order.getTexMap(stageOdd);
+		stage.tex_enable = order.getEnable(stageOdd) != 0;
+		stage.color_chan = order.getColorChan(stageOdd);
+		GetSwapTable(stage.ac.tswap * 2, stage.tex_swap);
+		GetSwapTable(stage.ac.rswap * 2, stage.ras_swap);
+
+		const int kc = kSel.getKC(stageOdd);
+		const int ka = kSel.getKA(stageOdd);
+		const u32 color_sel[4] = { stage.cc.a, stage.cc.b, stage.cc.c, stage.cc.d };
+		const u32 alpha_sel[4] = { stage.ac.a, stage.ac.b, stage.ac.c, stage.ac.d };
+		for (int input = 0; input < 4; input++)
+		{
+			for (int i = 0; i < 3; i++)
+			{
+				stage.color_inputs[input][i] = color_sel[input] == TEVCOLORARG_KONST ?
+					m_KonstLUT[kc][BLU_C + i] : m_ColorInputLUT[color_sel[input]][i];
+			}
+			stage.alpha_inputs[input] = alpha_sel[input] == TEVALPHAARG_KONST ?
+				m_KonstLUT[ka][ALP_C] : m_AlphaInputLUT[alpha_sel[input]];
+		}
+	}
+
+	for (int alpha = 0; alpha < 256; alpha++)
+		m_AlphaTestPass[alpha] = TevAlphaTest(alpha);
+}
+
 static inline s32 WrapIndirectCoord(s32 coord, int wrapMode)
 {
 	switch (wrapMode)
@@ -511,7 +609,7 @@ void Tev::Draw()
 	_assert_(Position[0] >= 0 && Position[0] < EFB_WIDTH);
 	_assert_(Position[1] >= 0 && Position[1] < EFB_HEIGHT);
 
-	INCSTAT(stats.thisFrame.tevPixelsIn);
+	PixelsIn++;
 
 	for (unsigned int stageNum = 0; stageNum < bpmem.genMode.numindstages.Value(); stageNum++)
 	{
@@ -544,94 +642,84 @@ void Tev::Draw()
 
 	for (unsigned int stageNum = 0; stageNum <= bpmem.genMode.numtevstages.Value(); stageNum++)
 	{
-		int stageNum2 = stageNum >> 1;
-		int stageOdd = stageNum & 1;
-		TwoTevStageOrders &order = bpmem.tevorders[stageNum2];
-		TevKSel &kSel = bpmem.tevksel[stageNum2];
-
-		// stage combiners
-		TevStageCombiner::ColorCombiner &cc = bpmem.combiners[stageNum].colorC;
-		TevStageCombiner::AlphaCombiner &ac = bpmem.combiners[stageNum].alphaC;
-
-		int texcoordSel = order.getTexCoord(stageOdd);
-		int texmap = order.getTexMap(stageOdd);
+		StageConfig& stage = m_Stages[stageNum];
+		TevStageCombiner::ColorCombiner &cc = stage.cc;
+		TevStageCombiner::AlphaCombiner &ac = stage.ac;
 
-		Indirect(stageNum, Uv[texcoordSel].s, Uv[texcoordSel].t);
+		Indirect(stageNum, Uv[stage.texcoord].s, Uv[stage.texcoord].t);
 
 		// sample texture
-		if (order.getEnable(stageOdd))
+		if (stage.tex_enable)
 		{
 			// RGBA
 			u8 texel[4];
 
-			TextureSampler::Sample(TexCoord.s, TexCoord.t, TextureLod[stageNum], TextureLinear[stageNum], texmap, texel);
+			TextureSampler::Sample(TexCoord.s, TexCoord.t, TextureLod[stageNum], TextureLinear[stageNum], stage.texmap, texel);
 
 #if ALLOW_TEV_DUMPS
 			if (g_ActiveConfig.bDumpTevTextureFetches)
 				DebugUtil::DrawTempBuffer(texel, DIRECT_TFETCH + stageNum);
 #endif
 
-			int swaptable = ac.tswap * 2;
-
-			TexColor[RED_C] = texel[bpmem.tevksel[swaptable].swap1];
-			TexColor[GRN_C] = texel[bpmem.tevksel[swaptable].swap2];
-			swaptable++;
-			TexColor[BLU_C] = texel[bpmem.tevksel[swaptable].swap1];
-			TexColor[ALP_C] = texel[bpmem.tevksel[swaptable].swap2];
+			TexColor[RED_C] = texel[stage.tex_swap[RED_C]];
+			TexColor[GRN_C] = texel[stage.tex_swap[GRN_C]];
+			TexColor[BLU_C] = texel[stage.tex_swap[BLU_C]];
+			TexColor[ALP_C] = texel[stage.tex_swap[ALP_C]];
 		}
 
-		// set konst for this stage
-		int kc = kSel.getKC(stageOdd);
-		int ka = kSel.getKA(stageOdd);
-		StageKonst[RED_C] = *(m_KonstLUT[kc][RED_C]);
-		StageKonst[GRN_C] = *(m_KonstLUT[kc][GRN_C]);
-		StageKonst[BLU_C] = *(m_KonstLUT[kc][BLU_C]);
-		StageKonst[ALP_C] = *(m_KonstLUT[ka][ALP_C]);
-
 		// set color
-		SetRasColor(order.getColorChan(stageOdd), ac.rswap * 2);
+		SetRasColor(stage.color_chan, stage.ras_swap);
 
 		// combine inputs
 		InputRegType inputs[4];
 		for (int i = 0; i < 3; i++)
 		{
-			inputs[BLU_C + i].a = *m_ColorInputLUT[cc.a][i];
-			inputs[BLU_C + i].b = *m_ColorInputLUT[cc.b][i];
-			inputs[BLU_C + i].c = *m_ColorInputLUT[cc.c][i];
-			inputs[BLU_C + i].d = *m_ColorInputLUT[cc.d][i];
+			inputs[BLU_C + i].a = *stage.color_inputs[0][i];
+			inputs[BLU_C + i].b = *stage.color_inputs[1][i];
+			inputs[BLU_C + i].c = *stage.color_inputs[2][i];
+			inputs[BLU_C + i].d = *stage.color_inputs[3][i];
 		}
-		inputs[ALP_C].a = *m_AlphaInputLUT[ac.a];
-		inputs[ALP_C].b = *m_AlphaInputLUT[ac.b];
-		inputs[ALP_C].c = *m_AlphaInputLUT[ac.c];
-		inputs[ALP_C].d = *m_AlphaInputLUT[ac.d];
-
-		if (cc.bias != 3)
-			DrawColorRegular(cc, inputs);
-		else
-			DrawColorCompare(cc, inputs);
+		inputs[ALP_C].a = *stage.alpha_inputs[0];
+		inputs[ALP_C].b = *stage.alpha_inputs[1];
+		inputs[ALP_C].c = *stage.alpha_inputs[2];
+		inputs[ALP_C].d = *stage.alpha_inputs[3];
 
-		if (cc.clamp)
+#ifdef _M_X86
+		if (cc.bias != 3 && ac.bias != 3)
 		{
-			Reg[cc.dest][RED_C] = Clamp255(Reg[cc.dest][RED_C]);
-			Reg[cc.dest][GRN_C] = Clamp255(Reg[cc.dest][GRN_C]);
-			Reg[cc.dest][BLU_C] = Clamp255(Reg[cc.dest][BLU_C]);
+			DrawRegularSSE2(cc, ac, inputs);
 		}
 		else
+#endif
 		{
-			Reg[cc.dest][RED_C] = Clamp1024(Reg[cc.dest][RED_C]);
-			Reg[cc.dest][GRN_C] = Clamp1024(Reg[cc.dest][GRN_C]);
-			Reg[cc.dest][BLU_C] = Clamp1024(Reg[cc.dest][BLU_C]);
-		}
+			if (cc.bias != 3)
+				DrawColorRegular(cc, inputs);
+			else
+				DrawColorCompare(cc, inputs);
 
-		if (ac.bias != 3)
-			DrawAlphaRegular(ac, inputs);
-		else
-			DrawAlphaCompare(ac, inputs);
+			if (cc.clamp)
+			{
+				Reg[cc.dest][RED_C] = Clamp255(Reg[cc.dest][RED_C]);
+				Reg[cc.dest][GRN_C] = Clamp255(Reg[cc.dest][GRN_C]);
+				Reg[cc.dest][BLU_C] = Clamp255(Reg[cc.dest][BLU_C]);
+			}
+			else
+			{
+				Reg[cc.dest][RED_C] = Clamp1024(Reg[cc.dest][RED_C]);
+				Reg[cc.dest][GRN_C] = Clamp1024(Reg[cc.dest][GRN_C]);
+				Reg[cc.dest][BLU_C] = Clamp1024(Reg[cc.dest][BLU_C]);
+			}
 
-		if (ac.clamp)
-			Reg[ac.dest][ALP_C] = Clamp255(Reg[ac.dest][ALP_C]);
-		else
-			Reg[ac.dest][ALP_C] = Clamp1024(Reg[ac.dest][ALP_C]);
+			if (ac.bias != 3)
+				DrawAlphaRegular(ac, inputs);
+			else
+				DrawAlphaCompare(ac, inputs);
+
+			if (ac.clamp)
+				Reg[ac.dest][ALP_C] = Clamp255(Reg[ac.dest][ALP_C]);
+			else
+				Reg[ac.dest][ALP_C] = Clamp1024(Reg[ac.dest][ALP_C]);
+		}
 
 #if ALLOW_TEV_DUMPS
 		if (g_ActiveConfig.bDumpTevStages)
@@ -653,7 +741,7 @@ void Tev::Draw()
 	// (i. e., only needed when using the SW renderer)
 	if (!BoundingBox::active)
 	{
-		if (!TevAlphaTest(output[ALP_C]))
+		if (!m_AlphaTestPass[output[ALP_C]])
 			return;
 		// z texture
 		if (bpmem.ztex2.op)
@@ -802,7 +890,7 @@ void Tev::Draw()
 	}
 #endif
 
-	INCSTAT(stats.thisFrame.tevPixelsOut);
+	PixelsOut++;
 	EfbInterface::IncPerfCounterQuadCount(PQ_BLEND_INPUT);
 
 	EfbInterface::BlendTev(Position[0], Position[1], output);
@@ -820,3 +908,9 @@ void Tev::SetRegColor(int reg, int comp, bool konst, s16 color)
 	}
 }
 
+void Tev::CopyRegisters(const Tev& other)
+{
+	memcpy(Reg, other.Reg, sizeof(Reg));
+	memcpy(KonstantColors, other.KonstantColors, sizeof(KonstantColors));
+}
+
@@ -27,7 +27,6 @@ class Tev
 	s16 KonstantColors[4][4];
 	s16 TexColor[4];
 	s16 RasColor[4];
-	s16 StageKonst[4];
 	s16 Zero16[4];
 
 	s16 FixedConstants[9];
@@ -35,6 +34,24 @@ class Tev
 	u8 IndirectTex[4][4];
 	TextureCoordinateType TexCoord;
 
+	// Stage state decoded from bpmem by SetupStages, so Draw does not decode it for every pixel.
+	// The konst inputs point straight at the selected constant.
+	struct StageConfig
+	{
+		TevStageCombiner::ColorCombiner cc;
+		TevStageCombiner::AlphaCombiner ac;
+		const s16* color_inputs[4][3]; // a, b, c, d
+		const s16* alpha_inputs[4];
+		u8 tex_swap[4];
+		u8 ras_swap[4];
+		int texmap;
+		int texcoord;
+		int color_chan;
+		bool tex_enable;
+	};
+	StageConfig m_Stages[16];
+	bool m_AlphaTestPass[256];
+
 	s16 *m_ColorInputLUT[16][3];
 	s16 *m_AlphaInputLUT[8];        // values must point to ABGR color
 	s16 *m_KonstLUT[32][4];
@@ -57,12 +74,16 @@ class Tev
 		INDIRECT = 32
 	};
 
-	void SetRasColor(int colorChan, int swaptable);
+	void SetRasColor(int colorChan, const u8 swap[4]);
 
 	void DrawColorRegular(TevStageCombiner::ColorCombiner& cc, const InputRegType inputs[4]);
 	void DrawColorCompare(TevStageCombiner::ColorCombiner& cc, const InputRegType inputs[4]);
 	void DrawAlphaRegular(TevStageCombiner::AlphaCombiner& ac, const InputRegType inputs[4]);
 	void DrawAlphaCompare(TevStageCombiner::AlphaCombiner& ac, const InputRegType inputs[4]);
+#ifdef _M_X86
+	void DrawRegularSSE2(const TevStageCombiner::ColorCombiner& cc, const TevStageCombiner::AlphaCombiner& ac,
+		const InputRegType inputs[4]);
+#endif
 
 	void Indirect(unsigned int stageNum, s32 s, s32 t);
 
@@ -83,9 +104,19 @@ public:
 		RED_C
 	};
 
+	// Drawn pixels, added to the statistics by the rasterizer so several instances can draw at once
+	u32 PixelsIn;
+	u32 PixelsOut;
+
 	void Init();
 
+	// Has to be called when the TEV or alpha test state in bpmem changed, before Draw.
+	void SetupStages();
+
 	void Draw();
 
 	void SetRegColor(int reg, int comp, bool konst, s16 color);
+
+	// Takes over the color and konst registers, the lookup tables stay with this instance.
+	void CopyRegisters(const Tev& other);
 };
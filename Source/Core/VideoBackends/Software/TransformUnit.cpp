@@ -6,6 +6,7 @@
 #include <cmath>
 
 #include "Common/CommonTypes.h"
+#include "Common/Intrinsics.h"
 #include "Common/MathUtil.h"
 
 #include "VideoBackends/Software/NativeVertexFormat.h"
@@ -85,6 +86,85 @@ void TransformPosition(const InputVertexData *src, OutputVertexData *dst)
 	}
 }
 
+#ifdef _M_X86
+// Four vertices in structure of arrays form, the operations are done in the same order as the
+// scalar functions so the results match exactly.
+static void TransformPositions4(const InputVertexData *src, OutputVertexData *dst)
+{
+	const float* mat = &xfmem.posMatrices[src[0].posMtx * 4];
+	const __m128 x = _mm_setr_ps(src[0].position.x, src[1].position.x, src[2].position.x, src[3].position.x);
+	const __m128 y = _mm_setr_ps(src[0].position.y, src[1].position.y, src[2].position.y, src[3].position.y);
+	const __m128 z = _mm_setr_ps(src[0].position.z, src[1].position.z, src[2].position.z, src[3].position.z);
+
+	__m128 mv[3];
+	for (int row = 0; row < 3; row++)
+	{
+		const float* m = &mat[row * 4];
+		mv[row] = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(m[0]), x),
+			_mm_mul_ps(_mm_set1_ps(m[1]), y)), _mm_mul_ps(_mm_set1_ps(m[2]), z)), _mm_set1_ps(m[3]));
+	}
+
+	const float* proj = xfmem.projection.rawProjection;
+	__m128 projected[4];
+	if (xfmem.projection.type == GX_PERSPECTIVE)
+	{
+		projected[0] = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(proj[0]), mv[0]), _mm_mul_ps(_mm_set1_ps(proj[1]), mv[2]));
+		projected[1] = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(proj[2]), mv[1]), _mm_mul_ps(_mm_set1_ps(proj[3]), mv[2]));
+		projected[2] = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(proj[4]), mv[2]), _mm_set1_ps(proj[5])),
+			_mm_set1_ps(1.0f - (float)1e-7));
+		projected[3] = _mm_xor_ps(mv[2], _mm_set1_ps(-0.0f));
+	}
+	else
+	{
+		projected[0] = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(proj[0]), mv[0]), _mm_set1_ps(proj[1]));
+		projected[1] = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(proj[2]), mv[1]), _mm_set1_ps(proj[3]));
+		projected[2] = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(proj[4]), mv[2]), _mm_set1_ps(proj[5]));
+		projected[3] = _mm_set1_ps(1.0f);
+	}
+
+	// Back to one vertex per register
+	_MM_TRANSPOSE4_PS(projected[0], projected[1], projected[2], projected[3]);
+	__m128 mv_w = _mm_setzero_ps();
+	_MM_TRANSPOSE4_PS(mv[0], mv[1], mv[2], mv_w);
+	const __m128 mv_out[4] = { mv[0], mv[1], mv[2], mv_w };
+	for (int i = 0; i < 4; i++)
+	{
+		float mv_values[4];
+		_mm_storeu_ps(mv_values, mv_out[i]);
+		dst[i].mvPosition = Vec3(mv_values[0], mv_values[1], mv_values[2]);
+
+		float projected_values[4];
+		_mm_storeu_ps(projected_values, projected[i]);
+		dst[i].projectedPosition.x = projected_values[0];
+		dst[i].projectedPosition.y = projected_values[1];
+		dst[i].projectedPosition.z = projected_values[2];
+		dst[i].projectedPosition.w = projected_values[3];
+	}
+}
+#endif
+
+void TransformPositions(const InputVertexData *src, OutputVertexData *dst, int count)
+{
+	int i = 0;
+#ifdef _M_X86
+	for (; i + 4 <= count; i += 4)
+	{
+		if (src[i].posMtx == src[i + 1].posMtx && src[i].posMtx == src[i + 2].posMtx &&
+			src[i].posMtx == src[i + 3].posMtx)
+		{
+			TransformPositions4(&src[i], &dst[i]);
+		}
+		else
+		{
+			for (int j = i; j < i + 4; j++)
+				TransformPosition(&src[j], &dst[j]);
+		}
+	}
+#endif
+	for (; i < count; i++)
+		TransformPosition(&src[i], &dst[i]);
+}
+
 void TransformNormal(const InputVertexData *src, bool nbt, OutputVertexData *dst)
 {
 	const float* mat = &xfmem.normalMatrices[(src->posMtx & 31) * 3];
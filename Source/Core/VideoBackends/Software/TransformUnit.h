@@ -10,6 +10,8 @@ struct OutputVertexData;
 namespace TransformUnit
 {
 void TransformPosition(const InputVertexData *src, OutputVertexData *dst);
+// Same as TransformPosition for count vertices, four at a time where they share a matrix.
+void TransformPositions(const InputVertexData *src, OutputVertexData *dst, int count);
 void TransformNormal(const InputVertexData *src, bool nbt, OutputVertexData *dst);
 void TransformColor(const InputVertexData *src, OutputVertexData *dst);
 void TransformTexCoord(const InputVertexData *src, OutputVertexData *dst, bool specialCase);
@@ -0,0 +1,432 @@
+// Copyright 2016 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "VideoBackends/Vulkan/CSTextureDecoder.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+#include "Common/CommonFuncs.h"
+#include "Common/Logging/Log.h"
+#include "Common/MathUtil.h"
+#include "Common/MsgHandler.h"
+
+#include "VideoBackends/Vulkan/CommandBufferManager.h"
+#include "VideoBackends/Vulkan/ObjectCache.h"
+#include "VideoBackends/Vulkan/StreamBuffer.h"
+#include "VideoBackends/Vulkan/Texture2D.h"
+#include "VideoBackends/Vulkan/Util.h"
+#include "VideoBackends/Vulkan/VulkanContext.h"
+
+#include "VideoCommon/TextureConversionShader.h"
+
+namespace Vulkan
+{
+CSTextureDecoder::CSTextureDecoder()
+{
+}
+
+CSTextureDecoder::~CSTextureDecoder()
+{
+	for (const auto& it : m_pipelines)
+	{
+		if (it.second != VK_NULL_HANDLE)
+			vkDestroyPipeline(g_vulkan_context->GetDevice(), it.second, nullptr);
+	}
+
+	for (const auto& it : m_scaling_pipelines)
+	{
+		if (it.second != VK_NULL_HANDLE)
+			vkDestroyPipeline(g_vulkan_context->GetDevice(), it.second, nullptr);
+	}
+
+	if (m_raw_data_view != VK_NULL_HANDLE)
+		vkDestroyBufferView(g_vulkan_context->GetDevice(), m_raw_data_view, nullptr);
+
+	if (m_palette_view != VK_NULL_HANDLE)
+		vkDestroyBufferView(g_vulkan_context->GetDevice(), m_palette_view, nullptr);
+
+	if (m_rgba8_view != VK_NULL_HANDLE)
+		vkDestroyBufferView(g_vulkan_context->GetDevice(), m_rgba8_view, nullptr);
+
+	if (m_pipeline_layout != VK_NULL_HANDLE)
+		vkDestroyPipelineLayout(g_vulkan_context->GetDevice(), m_pipeline_layout, nullptr);
+
+	if (m_set_layout != VK_NULL_HANDLE)
+		vkDestroyDescriptorSetLayout(g_vulkan_context->GetDevice(), m_set_layout, nullptr);
+}
+
+bool CSTextureDecoder::Initialize()
+{
+	if (!CreateBuffers())
+		return false;
+
+	if (!CreateDescriptorLayout())
+		return false;
+
+	return true;
+}
+
+bool CSTextureDecoder::FormatSupported(u32 format) const
+{
+	return TextureConversionShader::IsDecodingShaderSupported(format);
+}
+
+bool CSTextureDecoder::Decode(Texture2D* dst, const u8* src, u32 width, u32 height,
+	u32 expanded_width, u32 expanded_height, u32 format, u32 tlutaddr,
+	TlutFormat tlutfmt, u32 level)
+{
+	if (dst->GetFormat() != VK_FORMAT_R8G8B8A8_UNORM || !FormatSupported(format))
+		return false;
+
+	VkPipeline pipeline = GetPipeline(format, tlutfmt);
+	if (pipeline == VK_NULL_HANDLE)
+		return false;
+
+	// Can't decode data larger than the texture extents.
+	width = std::max(1u, std::min(width, dst->GetWidth() >> level));
+	height = std::max(1u, std::min(height, dst->GetHeight() >> level));
+
+	// The palette is placed right after the texture data, in the same allocation.
+	u32 data_size = TexDecoder_GetTextureSizeInBytes(expanded_width, expanded_height, format);
+	u32 palette_size = 0;
+	if (format == GX_TF_C4 || format == GX_TF_C8 || format == GX_TF_C14X2)
+		palette_size = std::min(TexDecoder_GetPaletteSize(format), TMEM_SIZE - tlutaddr);
+	u32 palette_start = ROUND_UP(data_size, 2);
+	u32 upload_size = palette_start + palette_size;
+	if (upload_size > m_upload_buffer->GetCurrentSize())
+		return false;
+
+	VkDescriptorSet descriptor_set =
+		ReserveUpload(upload_size, static_cast<u32>(g_vulkan_context->GetTexelBufferAlignment()));
+	if (descriptor_set == VK_NULL_HANDLE)
+		return false;
+
+	u32 upload_offset = static_cast<u32>(m_upload_buffer->GetCurrentOffset());
+	u8* upload_pointer = m_upload_buffer->GetCurrentHostPointer();
+	memcpy(upload_pointer, src, data_size);
+	if (palette_size)
+		memcpy(upload_pointer + palette_start, &texMem[tlutaddr], palette_size);
+	m_upload_buffer->CommitMemory(upload_size);
+
+	struct CSUniformBlock
+	{
+		int params[4];
+		int dimensions[4];
+	};
+	CSUniformBlock uniforms = {};
+	uniforms.params[0] = static_cast<int>(upload_offset);
+	uniforms.params[1] = static_cast<int>(expanded_width / TexDecoder_GetBlockWidthInTexels(format));
+	uniforms.params[2] = static_cast<int>((upload_offset + palette_start) / sizeof(u16));
+	uniforms.dimensions[0] = static_cast<int>(width);
+	uniforms.dimensions[1] = static_cast<int>(height);
+
+	const u32 group_size = TextureConversionShader::DECODING_SHADER_GROUP_SIZE;
+	return Dispatch(dst, level, pipeline, descriptor_set, m_raw_data_view, upload_offset,
+		upload_size, &uniforms, sizeof(uniforms), (width + group_size - 1) / group_size,
+		(height + group_size - 1) / group_size);
+}
+
+bool CSTextureDecoder::Scale(Texture2D* dst, const u8* src, u32 width, u32 height, u32 stride,
+	int scaling_type, int factor, u32 level)
+{
+	if (dst->GetFormat() != VK_FORMAT_R8G8B8A8_UNORM ||
+		!TextureConversionShader::IsScalingShaderSupported(scaling_type, factor))
+	{
+		return false;
+	}
+
+	// The scaled texels have to fit into the level.
+	if (width * factor > std::max(1u, dst->GetWidth() >> level) ||
+		height * factor > std::max(1u, dst->GetHeight() >> level))
+	{
+		return false;
+	}
+
+	VkPipeline pipeline = GetScalingPipeline(scaling_type, factor);
+	if (pipeline == VK_NULL_HANDLE)
+		return false;
+
+	u32 upload_size = stride * height * sizeof(u32);
+	if (upload_size > m_upload_buffer->GetCurrentSize())
+		return false;
+
+	// The texels are addressed through the RGBA8 view, so the offset must be texel aligned.
+	VkDescriptorSet descriptor_set = ReserveUpload(upload_size,
+		std::max(static_cast<u32>(g_vulkan_context->GetTexelBufferAlignment()), 4u));
+	if (descriptor_set == VK_NULL_HANDLE)
+		return false;
+
+	u32 upload_offset = static_cast<u32>(m_upload_buffer->GetCurrentOffset());
+	memcpy(m_upload_buffer->GetCurrentHostPointer(), src, upload_size);
+	m_upload_buffer->CommitMemory(upload_size);
+
+	struct CSUniformBlock
+	{
+		int params[4];
+		int dimensions[4];
+	};
+	CSUniformBlock uniforms = {};
+	uniforms.params[0] = static_cast<int>(upload_offset / sizeof(u32));
+	uniforms.params[1] = static_cast<int>(stride);
+	uniforms.dimensions[0] = static_cast<int>(width);
+	uniforms.dimensions[1] = static_cast<int>(height);
+
+	const u32 group_size = TextureConversionShader::DECODING_SHADER_GROUP_SIZE;
+	return Dispatch(dst, level, pipeline, descriptor_set, m_rgba8_view, upload_offset, upload_size,
+		&uniforms, sizeof(uniforms), (width + group_size - 1) / group_size,
+		(height + group_size - 1) / group_size);
+}
+
+VkDescriptorSet CSTextureDecoder::ReserveUpload(u32 upload_size, u32 alignment)
+{
+	VkDescriptorSet descriptor_set;
+	if (!m_upload_buffer->ReserveMemory(upload_size, alignment) ||
+		(descriptor_set = g_command_buffer_mgr->AllocateDescriptorSet(m_set_layout)) ==
+		VK_NULL_HANDLE)
+	{
+		WARN_LOG(VIDEO, "Executing command list while waiting for space in texture decoding buffer");
+		Util::ExecuteCurrentCommandsAndRestoreState(false);
+
+		if (!m_upload_buffer->ReserveMemory(upload_size, alignment) ||
+			(descriptor_set = g_command_buffer_mgr->AllocateDescriptorSet(m_set_layout)) ==
+			VK_NULL_HANDLE)
+		{
+			return VK_NULL_HANDLE;
+		}
+	}
+	return descriptor_set;
+}
+
+bool CSTextureDecoder::Dispatch(Texture2D* dst, u32 level, VkPipeline pipeline,
+	VkDescriptorSet descriptor_set, VkBufferView input_view, u32 upload_offset, u32 upload_size,
+	const void* uniforms, u32 uniforms_size, u32 groups_x, u32 groups_y)
+{
+	// A view of the single level we are writing, the texture's own view covers all of them.
+	VkImageViewCreateInfo view_info = {
+		VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+		nullptr,
+		0,
+		dst->GetImage(),
+		VK_IMAGE_VIEW_TYPE_2D,
+		VK_FORMAT_R8G8B8A8_UNORM,
+		{ VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY,
+			VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY },
+		{ VK_IMAGE_ASPECT_COLOR_BIT, level, 1, 0, 1 } };
+	VkImageView level_view;
+	VkResult res = vkCreateImageView(g_vulkan_context->GetDevice(), &view_info, nullptr, &level_view);
+	if (res != VK_SUCCESS)
+	{
+		LOG_VULKAN_ERROR(res, "vkCreateImageView failed: ");
+		return false;
+	}
+
+	// The palette binding is unused by the scaling shaders, but has to be valid.
+	VkDescriptorImageInfo image_info = { VK_NULL_HANDLE, level_view, VK_IMAGE_LAYOUT_GENERAL };
+	VkWriteDescriptorSet set_writes[] = {
+		{ VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, descriptor_set, 0, 0, 1,
+			VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER, nullptr, nullptr, &input_view },
+		{ VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, descriptor_set, 1, 0, 1,
+			VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER, nullptr, nullptr, &m_palette_view },
+		{ VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, nullptr, descriptor_set, 2, 0, 1,
+			VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, &image_info, nullptr, nullptr } };
+	vkUpdateDescriptorSets(g_vulkan_context->GetDevice(), static_cast<u32>(ArraySize(set_writes)),
+		set_writes, 0, nullptr);
+
+	// Like LoadData, this goes into the init command buffer, ahead of any draws using the texture.
+	VkCommandBuffer command_buffer = g_command_buffer_mgr->GetCurrentInitCommandBuffer();
+	Util::BufferMemoryBarrier(command_buffer, m_upload_buffer->GetBuffer(),
+		VK_ACCESS_HOST_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, upload_offset,
+		upload_size, VK_PIPELINE_STAGE_HOST_BIT,
+		VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+	// The previous contents of the level are discarded.
+	VkImageMemoryBarrier barrier = {
+		VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+		nullptr,
+		0,
+		VK_ACCESS_SHADER_WRITE_BIT,
+		VK_IMAGE_LAYOUT_UNDEFINED,
+		VK_IMAGE_LAYOUT_GENERAL,
+		VK_QUEUE_FAMILY_IGNORED,
+		VK_QUEUE_FAMILY_IGNORED,
+		dst->GetImage(),
+		{ VK_IMAGE_ASPECT_COLOR_BIT, level, 1, 0, 1 } };
+	vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+		VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+	vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+	vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipeline_layout, 0, 1,
+		&descriptor_set, 0, nullptr);
+	vkCmdPushConstants(command_buffer, m_pipeline_layout, VK_SHADER_STAGE_COMPUTE_BIT, 0,
+		uniforms_size, uniforms);
+	vkCmdDispatch(command_buffer, groups_x, groups_y, 1);
+
+	// Transition to shader read only.
+	barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	barrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+	barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+		VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+	dst->OverrideImageLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+	g_command_buffer_mgr->DeferImageViewDestruction(level_view);
+	return true;
+}
+
+VkPipeline CSTextureDecoder::CreatePipeline(const std::string& source)
+{
+	VkPipeline pipeline = VK_NULL_HANDLE;
+	VkShaderModule shader = Util::CompileAndCreateComputeShader(source);
+	if (shader == VK_NULL_HANDLE)
+		return VK_NULL_HANDLE;
+
+	VkComputePipelineCreateInfo pipeline_info = {
+		VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+		nullptr,
+		0,
+		{ VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0,
+			VK_SHADER_STAGE_COMPUTE_BIT, shader, "main", nullptr },
+		m_pipeline_layout,
+		VK_NULL_HANDLE,
+		-1 };
+
+	VkResult res = vkCreateComputePipelines(g_vulkan_context->GetDevice(), VK_NULL_HANDLE, 1,
+		&pipeline_info, nullptr, &pipeline);
+	if (res != VK_SUCCESS)
+	{
+		LOG_VULKAN_ERROR(res, "vkCreateComputePipelines failed: ");
+		pipeline = VK_NULL_HANDLE;
+	}
+
+	vkDestroyShaderModule(g_vulkan_context->GetDevice(), shader, nullptr);
+	return pipeline;
+}
+
+VkPipeline CSTextureDecoder::GetPipeline(u32 format, TlutFormat tlutfmt)
+{
+	// The palette format only matters for paletted textures.
+	if (format != GX_TF_C4 && format != GX_TF_C8 && format != GX_TF_C14X2)
+		tlutfmt = GX_TL_IA8;
+
+	ComboKey key = MakeComboKey(format, tlutfmt);
+	auto iter = m_pipelines.find(key);
+	if (iter != m_pipelines.end())
+		return iter->second;
+
+	// Failures are stored as well, so we don't try to compile the shader again.
+	VkPipeline pipeline =
+		CreatePipeline(TextureConversionShader::GenerateDecodingShader(format, tlutfmt, API_VULKAN));
+	m_pipelines.emplace(key, pipeline);
+	return pipeline;
+}
+
+VkPipeline CSTextureDecoder::GetScalingPipeline(int scaling_type, int factor)
+{
+	u32 key = static_cast<u32>(scaling_type) | (static_cast<u32>(factor) << 16);
+	auto iter = m_scaling_pipelines.find(key);
+	if (iter != m_scaling_pipelines.end())
+		return iter->second;
+
+	VkPipeline pipeline = CreatePipeline(
+		TextureConversionShader::GenerateScalingShader(scaling_type, factor, API_VULKAN));
+	m_scaling_pipelines.emplace(key, pipeline);
+	return pipeline;
+}
+
+bool CSTextureDecoder::CreateBuffers()
+{
+	// Large enough for the biggest texture (1024x1024 RGBA8) several times over,
+	// but the views must not exceed the device's texel buffer limit.
+	size_t buffer_size = std::min<size_t>(
+		16 * 1024 * 1024, g_vulkan_context->GetDeviceLimits().maxTexelBufferElements);
+
+	m_upload_buffer =
+		StreamBuffer::Create(VK_BUFFER_USAGE_UNIFORM_TEXEL_BUFFER_BIT, buffer_size, buffer_size);
+	if (!m_upload_buffer)
+		return false;
+
+	// Views of the whole buffer, the shader offsets its loads into them.
+	VkBufferViewCreateInfo view_info = {
+		VK_STRUCTURE_TYPE_BUFFER_VIEW_CREATE_INFO,  // VkStructureType            sType
+		nullptr,                                    // const void*                pNext
+		0,                                          // VkBufferViewCreateFlags    flags
+		m_upload_buffer->GetBuffer(),               // VkBuffer                   buffer
+		VK_FORMAT_R8_UINT,                          // VkFormat                   format
+		0,                                          // VkDeviceSize               offset
+		buffer_size                                 // VkDeviceSize               range
+	};
+
+	VkResult res =
+		vkCreateBufferView(g_vulkan_context->GetDevice(), &view_info, nullptr, &m_raw_data_view);
+	if (res != VK_SUCCESS)
+	{
+		LOG_VULKAN_ERROR(res, "vkCreateBufferView failed: ");
+		return false;
+	}
+
+	view_info.format = VK_FORMAT_R16_UINT;
+	res = vkCreateBufferView(g_vulkan_context->GetDevice(), &view_info, nullptr, &m_palette_view);
+	if (res != VK_SUCCESS)
+	{
+		LOG_VULKAN_ERROR(res, "vkCreateBufferView failed: ");
+		return false;
+	}
+
+	// Decoded texels for the scaling shaders.
+	view_info.format = VK_FORMAT_R8G8B8A8_UNORM;
+	res = vkCreateBufferView(g_vulkan_context->GetDevice(), &view_info, nullptr, &m_rgba8_view);
+	if (res != VK_SUCCESS)
+	{
+		LOG_VULKAN_ERROR(res, "vkCreateBufferView failed: ");
+		return false;
+	}
+
+	return true;
+}
+
+bool CSTextureDecoder::CreateDescriptorLayout()
+{
+	static const VkDescriptorSetLayoutBinding set_bindings[] = {
+		{ 0, VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT },
+		{ 1, VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT },
+		{ 2, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT },
+	};
+	static const VkDescriptorSetLayoutCreateInfo set_info = {
+		VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO, nullptr, 0,
+		static_cast<u32>(ArraySize(set_bindings)), set_bindings };
+
+	VkResult res =
+		vkCreateDescriptorSetLayout(g_vulkan_context->GetDevice(), &set_info, nullptr, &m_set_layout);
+	if (res != VK_SUCCESS)
+	{
+		LOG_VULKAN_ERROR(res, "vkCreateDescriptorSetLayout failed: ");
+		return false;
+	}
+
+	VkPushConstantRange push_constant_range = { VK_SHADER_STAGE_COMPUTE_BIT, 0,
+		PUSH_CONSTANT_BUFFER_SIZE };
+
+	VkPipelineLayoutCreateInfo pipeline_layout_info = { VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+		nullptr,
+		0,
+		1,
+		&m_set_layout,
+		1,
+		&push_constant_range };
+
+	res = vkCreatePipelineLayout(g_vulkan_context->GetDevice(), &pipeline_layout_info, nullptr,
+		&m_pipeline_layout);
+	if (res != VK_SUCCESS)
+	{
+		LOG_VULKAN_ERROR(res, "vkCreatePipelineLayout failed: ");
+		return false;
+	}
+
+	return true;
+}
+
+}  // namespace Vulkan
@@ -0,0 +1,72 @@
+// Copyright 2016 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include "Common/CommonTypes.h"
+#include "VideoBackends/Vulkan/StreamBuffer.h"
+#include "VideoCommon/TextureDecoder.h"
+
+namespace Vulkan
+{
+class Texture2D;
+
+// Decodes guest textures with compute shaders, the raw texture data is streamed to the GPU
+// and read through a uniform texel buffer, the decoded texels are stored directly into the
+// destination image.
+class CSTextureDecoder
+{
+public:
+	CSTextureDecoder();
+	~CSTextureDecoder();
+
+	bool Initialize();
+
+	bool FormatSupported(u32 format) const;
+
+	// Records the decode into the init command buffer.
+	// Returns false if the texture has to be decoded on the CPU instead.
+	bool Decode(Texture2D* dst, const u8* src, u32 width, u32 height, u32 expanded_width,
+		u32 expanded_height, u32 format, u32 tlutaddr, TlutFormat tlutfmt, u32 level);
+
+	// Upscales decoded RGBA8 texels with one of the TextureScaler filters into a level of dst,
+	// which has to be factor times larger. Returns false if the CPU scaler has to be used instead.
+	bool Scale(Texture2D* dst, const u8* src, u32 width, u32 height, u32 stride, int scaling_type,
+		int factor, u32 level);
+
+private:
+	bool CreateBuffers();
+	bool CreateDescriptorLayout();
+	VkPipeline CreatePipeline(const std::string& source);
+	VkPipeline GetPipeline(u32 format, TlutFormat tlutfmt);
+	VkPipeline GetScalingPipeline(int scaling_type, int factor);
+	VkDescriptorSet ReserveUpload(u32 upload_size, u32 alignment);
+	bool Dispatch(Texture2D* dst, u32 level, VkPipeline pipeline, VkDescriptorSet descriptor_set,
+		VkBufferView input_view, u32 upload_offset, u32 upload_size, const void* uniforms,
+		u32 uniforms_size, u32 groups_x, u32 groups_y);
+
+	typedef u32 ComboKey;
+	static ComboKey MakeComboKey(u32 format, TlutFormat tlutfmt)
+	{
+		return format | ((tlutfmt & 0xF) << 16);
+	}
+
+	VkDescriptorSetLayout m_set_layout = VK_NULL_HANDLE;
+	VkPipelineLayout m_pipeline_layout = VK_NULL_HANDLE;
+
+	// Pipelines are compiled on first use of each format/palette combination.
+	std::map<ComboKey, VkPipeline> m_pipelines;
+	std::map<u32, VkPipeline> m_scaling_pipelines;
+
+	std::unique_ptr<StreamBuffer> m_upload_buffer;
+	VkBufferView m_raw_data_view = VK_NULL_HANDLE;
+	VkBufferView m_palette_view = VK_NULL_HANDLE;
+	VkBufferView m_rgba8_view = VK_NULL_HANDLE;
+};
+
+}  // namespace Vulkan
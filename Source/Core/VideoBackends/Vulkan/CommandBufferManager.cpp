@@ -14,8 +14,10 @@
 
 namespace Vulkan
 {
-CommandBufferManager::CommandBufferManager(bool use_threaded_submission)
-	: m_submit_semaphore(1, 1), m_use_threaded_submission(use_threaded_submission)
+CommandBufferManager::CommandBufferManager(bool use_threaded_submission,
+	size_t num_command_buffers)
+	: m_frame_resources(std::max<size_t>(num_command_buffers, 1)), m_submit_semaphore(1, 1),
+	m_use_threaded_submission(use_threaded_submission)
 {
 }
 
@@ -77,6 +79,45 @@ bool CommandBufferManager::CreateCommandBuffers()
 			return false;
 		}
 
+		resources.transfer_command_pool = VK_NULL_HANDLE;
+		resources.transfer_command_buffer = VK_NULL_HANDLE;
+		resources.transfer_semaphore = VK_NULL_HANDLE;
+		resources.transfer_bytes = 0;
+		resources.transfer_command_buffer_used = false;
+		if (g_vulkan_context->HasTransferQueue())
+		{
+			VkCommandPoolCreateInfo transfer_pool_info = {
+				VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO, nullptr, 0,
+				g_vulkan_context->GetTransferQueueFamilyIndex() };
+			res = vkCreateCommandPool(device, &transfer_pool_info, nullptr,
+				&resources.transfer_command_pool);
+			if (res != VK_SUCCESS)
+			{
+				LOG_VULKAN_ERROR(res, "vkCreateCommandPool failed: ");
+				return false;
+			}
+
+			VkCommandBufferAllocateInfo transfer_buffer_info = {
+				VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO, nullptr, resources.transfer_command_pool,
+				VK_COMMAND_BUFFER_LEVEL_PRIMARY, 1 };
+			res = vkAllocateCommandBuffers(device, &transfer_buffer_info,
+				&resources.transfer_command_buffer);
+			if (res != VK_SUCCESS)
+			{
+				LOG_VULKAN_ERROR(res, "vkAllocateCommandBuffers failed: ");
+				return false;
+			}
+
+			VkSemaphoreCreateInfo semaphore_info = { VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO, nullptr,
+				0 };
+			res = vkCreateSemaphore(device, &semaphore_info, nullptr, &resources.transfer_semaphore);
+			if (res != VK_SUCCESS)
+			{
+				LOG_VULKAN_ERROR(res, "vkCreateSemaphore failed: ");
+				return false;
+			}
+		}
+
 		VkFenceCreateInfo fence_info = { VK_STRUCTURE_TYPE_FENCE_CREATE_INFO, nullptr,
 			VK_FENCE_CREATE_SIGNALED_BIT };
 
@@ -91,7 +132,8 @@ bool CommandBufferManager::CreateCommandBuffers()
 		VkDescriptorPoolSize pool_sizes[] = { { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 500000 },
 		{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 500000 },
 		{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 16 },
-		{ VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER, 1024 } };
+		{ VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER, 1024 },
+		{ VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1024 } };
 
 		VkDescriptorPoolCreateInfo pool_create_info = { VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
 			nullptr,
@@ -147,9 +189,48 @@ void CommandBufferManager::DestroyCommandBuffers()
 			vkDestroyCommandPool(device, resources.command_pool, nullptr);
 			resources.command_pool = VK_NULL_HANDLE;
 		}
+		if (resources.transfer_semaphore != VK_NULL_HANDLE)
+		{
+			vkDestroySemaphore(device, resources.transfer_semaphore, nullptr);
+			resources.transfer_semaphore = VK_NULL_HANDLE;
+		}
+		if (resources.transfer_command_pool != VK_NULL_HANDLE)
+		{
+			// Frees the command buffer as well
+			vkDestroyCommandPool(device, resources.transfer_command_pool, nullptr);
+			resources.transfer_command_pool = VK_NULL_HANDLE;
+			resources.transfer_command_buffer = VK_NULL_HANDLE;
+		}
 	}
 }
 
+VkCommandBuffer CommandBufferManager::GetCurrentTransferCommandBuffer(size_t num_bytes)
+{
+	FrameResources& resources = m_frame_resources[m_current_frame];
+	if (resources.transfer_command_buffer == VK_NULL_HANDLE ||
+		resources.transfer_bytes + num_bytes > ASYNC_TEXTURE_UPLOAD_BUDGET)
+	{
+		return VK_NULL_HANDLE;
+	}
+
+	// Begun on first use, most command buffers don't carry any large upload.
+	if (!resources.transfer_command_buffer_used)
+	{
+		VkCommandBufferBeginInfo begin_info = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, nullptr,
+			VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT, nullptr };
+		VkResult res = vkBeginCommandBuffer(resources.transfer_command_buffer, &begin_info);
+		if (res != VK_SUCCESS)
+		{
+			LOG_VULKAN_ERROR(res, "vkBeginCommandBuffer failed: ");
+			return VK_NULL_HANDLE;
+		}
+		resources.transfer_command_buffer_used = true;
+	}
+
+	resources.transfer_bytes += num_bytes;
+	return resources.transfer_command_buffer;
+}
+
 VkDescriptorSet CommandBufferManager::AllocateDescriptorSet(VkDescriptorSetLayout set_layout)
 {
 	VkDescriptorSetAllocateInfo allocate_info = {
@@ -266,6 +347,15 @@ void CommandBufferManager::SubmitCommandBuffer(bool submit_on_worker_thread,
 			PanicAlert("Failed to end command buffer");
 		}
 	}
+	if (resources.transfer_command_buffer_used)
+	{
+		VkResult res = vkEndCommandBuffer(resources.transfer_command_buffer);
+		if (res != VK_SUCCESS)
+		{
+			LOG_VULKAN_ERROR(res, "vkEndCommandBuffer failed: ");
+			PanicAlert("Failed to end command buffer");
+		}
+	}
 
 	// This command buffer now has commands, so can't be re-used without waiting.
 	resources.needs_fence_wait = true;
@@ -299,17 +389,45 @@ void CommandBufferManager::SubmitCommandBuffer(size_t index, VkSemaphore wait_se
 	FrameResources& resources = m_frame_resources[index];
 
 	// This may be executed on the worker thread, so don't modify any state of the manager class.
-	uint32_t wait_bits = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	std::array<VkSemaphore, 2> wait_semaphores;
+	std::array<VkPipelineStageFlags, 2> wait_bits;
 	VkSubmitInfo submit_info = { VK_STRUCTURE_TYPE_SUBMIT_INFO,
 		nullptr,
 		0,
-		nullptr,
-		&wait_bits,
+		wait_semaphores.data(),
+		wait_bits.data(),
 		static_cast<u32>(resources.command_buffers.size()),
 		resources.command_buffers.data(),
 		0,
 		nullptr };
 
+	// The uploads on the transfer queue go first. Nothing before the first sampling of a texture
+	// waits for them.
+	if (resources.transfer_command_buffer_used)
+	{
+		VkSubmitInfo transfer_submit_info = { VK_STRUCTURE_TYPE_SUBMIT_INFO,
+			nullptr,
+			0,
+			nullptr,
+			nullptr,
+			1,
+			&resources.transfer_command_buffer,
+			1,
+			&resources.transfer_semaphore };
+		VkResult res = vkQueueSubmit(g_vulkan_context->GetTransferQueue(), 1, &transfer_submit_info,
+			VK_NULL_HANDLE);
+		if (res != VK_SUCCESS)
+		{
+			LOG_VULKAN_ERROR(res, "vkQueueSubmit failed: ");
+			PanicAlert("Failed to submit transfer command buffer.");
+		}
+
+		wait_semaphores[submit_info.waitSemaphoreCount] = resources.transfer_semaphore;
+		wait_bits[submit_info.waitSemaphoreCount] =
+			VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+		submit_info.waitSemaphoreCount++;
+	}
+
 	// If the init command buffer did not have any commands recorded, don't submit it.
 	if (!m_frame_resources[index].init_command_buffer_used)
 	{
@@ -319,8 +437,9 @@ void CommandBufferManager::SubmitCommandBuffer(size_t index, VkSemaphore wait_se
 
 	if (wait_semaphore != VK_NULL_HANDLE)
 	{
-		submit_info.pWaitSemaphores = &wait_semaphore;
-		submit_info.waitSemaphoreCount = 1;
+		wait_semaphores[submit_info.waitSemaphoreCount] = wait_semaphore;
+		wait_bits[submit_info.waitSemaphoreCount] = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+		submit_info.waitSemaphoreCount++;
 	}
 
 	if (signal_semaphore != VK_NULL_HANDLE)
@@ -377,9 +496,13 @@ void CommandBufferManager::OnCommandBufferExecuted(size_t index)
 void CommandBufferManager::ActivateCommandBuffer()
 {
 	// Move to the next command buffer.
-	m_current_frame = (m_current_frame + 1) % NUM_COMMAND_BUFFERS;
+	m_current_frame = (m_current_frame + 1) % m_frame_resources.size();
 	FrameResources& resources = m_frame_resources[m_current_frame];
 
+	// With a single command buffer, the worker thread may not have submitted it yet.
+	if (m_use_threaded_submission && m_frame_resources.size() == 1)
+		WaitForWorkerThreadIdle();
+
 	// Wait for the GPU to finish with all resources for this command buffer.
 	if (resources.needs_fence_wait)
 	{
@@ -400,6 +523,13 @@ void CommandBufferManager::ActivateCommandBuffer()
 	res = vkResetCommandPool(g_vulkan_context->GetDevice(), resources.command_pool, 0);
 	if (res != VK_SUCCESS)
 		LOG_VULKAN_ERROR(res, "vkResetCommandPool failed: ");
+	if (resources.transfer_command_pool != VK_NULL_HANDLE)
+	{
+		// The draws waited for the transfers, so they are done as well
+		res = vkResetCommandPool(g_vulkan_context->GetDevice(), resources.transfer_command_pool, 0);
+		if (res != VK_SUCCESS)
+			LOG_VULKAN_ERROR(res, "vkResetCommandPool failed: ");
+	}
 
 	// Enable commands to be recorded to the two buffers again.
 	VkCommandBufferBeginInfo begin_info = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, nullptr,
@@ -418,6 +548,8 @@ void CommandBufferManager::ActivateCommandBuffer()
 
 	// Reset upload command buffer state
 	resources.init_command_buffer_used = false;
+	resources.transfer_command_buffer_used = false;
+	resources.transfer_bytes = 0;
 }
 
 void CommandBufferManager::ExecuteCommandBuffer(bool submit_off_thread, bool wait_for_completion)
@@ -426,7 +558,7 @@ void CommandBufferManager::ExecuteCommandBuffer(bool submit_off_thread, bool wai
 
 	// If we're waiting for completion, don't bother waking the worker thread.
 	PrepareToSubmitCommandBuffer();
-	SubmitCommandBuffer((submit_off_thread && wait_for_completion));
+	SubmitCommandBuffer(submit_off_thread && !wait_for_completion);
 	ActivateCommandBuffer();
 
 	if (wait_for_completion)
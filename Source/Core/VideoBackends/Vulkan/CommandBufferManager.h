@@ -28,7 +28,9 @@ namespace Vulkan
 class CommandBufferManager
 {
 public:
-	explicit CommandBufferManager(bool use_threaded_submission);
+	// Having two or more command buffers allows one buffer to be executed whilst another is
+	// being built, with one the CPU waits for the GPU after every submission.
+	CommandBufferManager(bool use_threaded_submission, size_t num_command_buffers);
 	~CommandBufferManager();
 
 	bool Initialize();
@@ -44,6 +46,11 @@ public:
 	{
 		return m_frame_resources[m_current_frame].command_buffers[1];
 	}
+	// Command buffer of the transfer queue, submitted ahead of the init and draw command buffers.
+	// They wait for it at the fragment and compute stages, so images written here have to be
+	// released to the graphics queue family and acquired on the init command buffer. Returns
+	// VK_NULL_HANDLE without a transfer queue, or once num_bytes more would go past the budget.
+	VkCommandBuffer GetCurrentTransferCommandBuffer(size_t num_bytes);
 	VkDescriptorPool GetCurrentDescriptorPool() const
 	{
 		return m_frame_resources[m_current_frame].descriptor_pool;
@@ -119,10 +126,17 @@ private:
 		bool init_command_buffer_used;
 		bool needs_fence_wait;
 
+		// Only created with a transfer queue
+		VkCommandPool transfer_command_pool;
+		VkCommandBuffer transfer_command_buffer;
+		VkSemaphore transfer_semaphore;
+		size_t transfer_bytes;
+		bool transfer_command_buffer_used;
+
 		std::vector<std::function<void()>> cleanup_resources;
 	};
 
-	std::array<FrameResources, NUM_COMMAND_BUFFERS> m_frame_resources = {};
+	std::vector<FrameResources> m_frame_resources;
 	size_t m_current_frame;
 
 	// callbacks when a fence point is set
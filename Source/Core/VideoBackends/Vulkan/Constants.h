@@ -12,10 +12,6 @@
 
 namespace Vulkan
 {
-// Number of command buffers. Having two allows one buffer to be
-// executed whilst another is being built.
-constexpr size_t NUM_COMMAND_BUFFERS = 2;
-
 // Staging buffer usage - optimize for uploads or readbacks
 enum STAGING_BUFFER_TYPE
 {
@@ -70,6 +66,12 @@ constexpr size_t MAXIMUM_TEXTURE_UPLOAD_BUFFER_SIZE = 64 * 1024 * 1024;
 // a limiting factor in these scenarios anyway.
 constexpr size_t STAGING_TEXTURE_UPLOAD_THRESHOLD = 1024 * 1024 * 4;
 
+// Uploads of at least this size go to the dedicated transfer queue, when the device has one, so
+// the graphics queue doesn't execute the copies itself. The transfers of one command buffer are
+// budgeted, past that the uploads are recorded on the init command buffer again.
+constexpr size_t ASYNC_TEXTURE_UPLOAD_THRESHOLD = 256 * 1024;
+constexpr size_t ASYNC_TEXTURE_UPLOAD_BUDGET = 32 * 1024 * 1024;
+
 // Streaming uniform buffer size
 constexpr size_t INITIAL_UNIFORM_STREAM_BUFFER_SIZE = 16 * 1024 * 1024;
 constexpr size_t MAXIMUM_UNIFORM_STREAM_BUFFER_SIZE = 32 * 1024 * 1024;
@@ -672,7 +672,7 @@ void FramebufferManager::DestroyConversionShaders()
 
 u32 FramebufferManager::PeekEFBColor(u32 x, u32 y)
 {
-	if (!m_color_readback_texture_valid && !PopulateColorReadbackTexture())
+	if (!m_color_readback_tiles_valid[GetPeekTile(x, y)] && !PopulateColorReadbackTexture())
 		return 0;
 
 	u32 value;
@@ -746,13 +746,13 @@ bool FramebufferManager::PopulateColorReadbackTexture()
 	if (!m_color_readback_texture->IsMapped() && !m_color_readback_texture->Map())
 		return false;
 
-	m_color_readback_texture_valid = true;
+	m_color_readback_tiles_valid.set();
 	return true;
 }
 
 float FramebufferManager::PeekEFBDepth(u32 x, u32 y)
 {
-	if (!m_depth_readback_texture_valid && !PopulateDepthReadbackTexture())
+	if (!m_depth_readback_tiles_valid[GetPeekTile(x, y)] && !PopulateDepthReadbackTexture())
 		return 0.0f;
 
 	float value;
@@ -830,14 +830,31 @@ bool FramebufferManager::PopulateDepthReadbackTexture()
 	if (!m_depth_readback_texture->IsMapped() && !m_depth_readback_texture->Map())
 		return false;
 
-	m_depth_readback_texture_valid = true;
+	m_depth_readback_tiles_valid.set();
 	return true;
 }
 
 void FramebufferManager::InvalidatePeekCache()
 {
-	m_color_readback_texture_valid = false;
-	m_depth_readback_texture_valid = false;
+	m_color_readback_tiles_valid.reset();
+	m_depth_readback_tiles_valid.reset();
+}
+
+void FramebufferManager::InvalidatePeekCache(const EFBRectangle& rc)
+{
+	if (rc.left >= rc.right || rc.top >= rc.bottom)
+		return;
+
+	const u32 right = std::min<u32>((rc.right - 1) / EFB_PEEK_TILE_SIZE, EFB_PEEK_TILES_X - 1);
+	const u32 bottom = std::min<u32>((rc.bottom - 1) / EFB_PEEK_TILE_SIZE, EFB_PEEK_TILES_Y - 1);
+	for (u32 y = rc.top / EFB_PEEK_TILE_SIZE; y <= bottom; y++)
+	{
+		for (u32 x = rc.left / EFB_PEEK_TILE_SIZE; x <= right; x++)
+		{
+			m_color_readback_tiles_valid[y * EFB_PEEK_TILES_X + x] = false;
+			m_depth_readback_tiles_valid[y * EFB_PEEK_TILES_X + x] = false;
+		}
+	}
 }
 
 bool FramebufferManager::CreateReadbackRenderPasses()
@@ -1041,10 +1058,10 @@ void FramebufferManager::DestroyReadbackTextures()
 {
 	m_color_copy_texture.reset();
 	m_color_readback_texture.reset();
-	m_color_readback_texture_valid = false;
+	m_color_readback_tiles_valid.reset();
 	m_depth_copy_texture.reset();
 	m_depth_readback_texture.reset();
-	m_depth_readback_texture_valid = false;
+	m_depth_readback_tiles_valid.reset();
 }
 
 bool FramebufferManager::CreateReadbackFramebuffer()
@@ -1106,7 +1123,7 @@ void FramebufferManager::PokeEFBColor(u32 x, u32 y, u32 color)
 	CreatePokeVertices(&m_color_poke_vertices, x, y, 0.0f, color);
 
 	// Update the peek cache if it's valid, since we know the color of the pixel now.
-	if (m_color_readback_texture_valid)
+	if (m_color_readback_tiles_valid[GetPeekTile(x, y)])
 		m_color_readback_texture->WriteTexel(x, y, &color, sizeof(color));
 }
 
@@ -1119,7 +1136,7 @@ void FramebufferManager::PokeEFBDepth(u32 x, u32 y, float depth)
 	CreatePokeVertices(&m_depth_poke_vertices, x, y, depth, 0);
 
 	// Update the peek cache if it's valid, since we know the color of the pixel now.
-	if (m_depth_readback_texture_valid)
+	if (m_depth_readback_tiles_valid[GetPeekTile(x, y)])
 		m_depth_readback_texture->WriteTexel(x, y, &depth, sizeof(depth));
 }
 
@@ -1442,6 +1459,16 @@ void XFBSource::DecodeToTexture(u32 xfb_addr, u32 fb_width, u32 fb_height)
 		fb_width * 2, fb_height);
 }
 
+void XFBSource::EncodeToRam(u32 xfb_addr, u32 fb_stride)
+{
+	u8* xfb_ptr = Memory::GetPointer(xfb_addr);
+	_assert_(xfb_ptr);
+
+	// sourceRc is already scaled to the internal resolution.
+	TextureCache::GetInstance()->EncodeYUYVTextureToMemory(xfb_ptr, srcWidth, fb_stride, srcHeight,
+		m_texture->GetTexture(), sourceRc);
+}
+
 void XFBSource::CopyEFB(float gamma)
 {
 	// Pending/batched EFB pokes should be included in the copied image.
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <bitset>
 #include <memory>
 
 #include "Common/CommonTypes.h"
@@ -70,6 +71,8 @@ public:
 	u32 PeekEFBColor(u32 x, u32 y);
 	float PeekEFBDepth(u32 x, u32 y);
 	void InvalidatePeekCache();
+	// Only invalidates the tiles overlapping rc, peeks elsewhere still hit the readback.
+	void InvalidatePeekCache(const EFBRectangle& rc);
 
 	// Writes a value to the framebuffer. This will never block, and writes will be batched.
 	void PokeEFBColor(u32 x, u32 y, u32 color);
@@ -147,8 +150,16 @@ private:
 	// CPU-side EFB readback texture
 	std::unique_ptr<StagingTexture2D> m_color_readback_texture;
 	std::unique_ptr<StagingTexture2D> m_depth_readback_texture;
-	bool m_color_readback_texture_valid = false;
-	bool m_depth_readback_texture_valid = false;
+	// Validity of the readback textures in tiles of EFB_PEEK_TILE_SIZE
+	static const u32 EFB_PEEK_TILE_SIZE = 64;
+	static const u32 EFB_PEEK_TILES_X = (EFB_WIDTH + EFB_PEEK_TILE_SIZE - 1) / EFB_PEEK_TILE_SIZE;
+	static const u32 EFB_PEEK_TILES_Y = (EFB_HEIGHT + EFB_PEEK_TILE_SIZE - 1) / EFB_PEEK_TILE_SIZE;
+	static u32 GetPeekTile(u32 x, u32 y)
+	{
+		return (y / EFB_PEEK_TILE_SIZE) * EFB_PEEK_TILES_X + x / EFB_PEEK_TILE_SIZE;
+	}
+	std::bitset<EFB_PEEK_TILES_X * EFB_PEEK_TILES_Y> m_color_readback_tiles_valid;
+	std::bitset<EFB_PEEK_TILES_X * EFB_PEEK_TILES_Y> m_depth_readback_tiles_valid;
 
 	// EFB poke drawing setup
 	std::unique_ptr<VertexFormat> m_poke_vertex_format;
@@ -178,6 +189,8 @@ public:
 	TextureCache::TCacheEntry* GetTexture() const { return m_texture.get(); }
 	// Guest -> GPU EFB Textures
 	void DecodeToTexture(u32 xfb_addr, u32 fb_width, u32 fb_height) override;
+	// GPU EFB Textures -> Guest
+	void EncodeToRam(u32 xfb_addr, u32 fb_stride) override;
 
 	// Used for virtual XFB
 	void CopyEFB(float gamma) override;
@@ -0,0 +1,83 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "VideoBackends/Vulkan/GPUProfiler.h"
+
+#include "Common/Logging/Log.h"
+
+#include "VideoBackends/Vulkan/CommandBufferManager.h"
+#include "VideoBackends/Vulkan/VulkanContext.h"
+
+namespace Vulkan
+{
+GPUProfiler::~GPUProfiler()
+{
+	if (m_query_pool != VK_NULL_HANDLE)
+		vkDestroyQueryPool(g_vulkan_context->GetDevice(), m_query_pool, nullptr);
+}
+
+bool GPUProfiler::IsSupported()
+{
+	return g_vulkan_context->GetGraphicsQueueProperties().timestampValidBits != 0 &&
+		g_vulkan_context->GetDeviceLimits().timestampPeriod > 0.0f;
+}
+
+bool GPUProfiler::Initialize()
+{
+	VkQueryPoolCreateInfo info = {
+		VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,  // VkStructureType                  sType
+		nullptr,                                   // const void*                      pNext
+		0,                                         // VkQueryPoolCreateFlags           flags
+		VK_QUERY_TYPE_TIMESTAMP,                   // VkQueryType                      queryType
+		QUERY_COUNT,                               // uint32_t                         queryCount
+		0                                          // VkQueryPipelineStatisticFlags    pipelineStatistics
+	};
+
+	VkResult res = vkCreateQueryPool(g_vulkan_context->GetDevice(), &info, nullptr, &m_query_pool);
+	if (res != VK_SUCCESS)
+	{
+		LOG_VULKAN_ERROR(res, "vkCreateQueryPool failed: ");
+		return false;
+	}
+
+	const u32 valid_bits = g_vulkan_context->GetGraphicsQueueProperties().timestampValidBits;
+	m_timestamp_mask = valid_bits >= 64 ? ~0ull : (1ull << valid_bits) - 1;
+	return true;
+}
+
+void GPUProfiler::BeginQueries(u32 frame)
+{
+	// Called outside of a render pass, the queries have to be reset before they are written
+	vkCmdResetQueryPool(g_command_buffer_mgr->GetCurrentCommandBuffer(), m_query_pool,
+		frame * MAX_TIMESTAMPS, MAX_TIMESTAMPS);
+}
+
+void GPUProfiler::WriteTimestamp(u32 query)
+{
+	vkCmdWriteTimestamp(g_command_buffer_mgr->GetCurrentCommandBuffer(),
+		VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_query_pool, query);
+}
+
+bool GPUProfiler::GetResults(u32 frame, u32 count, u64* timestamps, u64* frequency)
+{
+	VkResult res = vkGetQueryPoolResults(g_vulkan_context->GetDevice(), m_query_pool,
+		frame * MAX_TIMESTAMPS, count, count * sizeof(u64), timestamps, sizeof(u64),
+		VK_QUERY_RESULT_64_BIT);
+	if (res == VK_NOT_READY)
+		return false;
+
+	if (res != VK_SUCCESS)
+	{
+		LOG_VULKAN_ERROR(res, "vkGetQueryPoolResults failed: ");
+		*frequency = 0;
+		return true;
+	}
+
+	for (u32 i = 0; i < count; i++)
+		timestamps[i] &= m_timestamp_mask;
+	*frequency = static_cast<u64>(1000000000.0 / g_vulkan_context->GetDeviceLimits().timestampPeriod);
+	return true;
+}
+
+}  // namespace Vulkan
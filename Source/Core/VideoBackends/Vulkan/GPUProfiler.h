@@ -0,0 +1,31 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "VideoBackends/Vulkan/Constants.h"
+#include "VideoCommon/GPUProfilerBase.h"
+
+namespace Vulkan
+{
+// Timestamps are written at the bottom of the pipe into the current command buffer
+class GPUProfiler : public GPUProfilerBase
+{
+public:
+	~GPUProfiler();
+
+	static bool IsSupported();
+	bool Initialize();
+
+protected:
+	void BeginQueries(u32 frame) override;
+	void WriteTimestamp(u32 query) override;
+	bool GetResults(u32 frame, u32 count, u64* timestamps, u64* frequency) override;
+
+private:
+	VkQueryPool m_query_pool = VK_NULL_HANDLE;
+	u64 m_timestamp_mask = 0;
+};
+
+}  // namespace Vulkan
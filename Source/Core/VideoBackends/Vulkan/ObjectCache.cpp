@@ -5,12 +5,14 @@
 #include "VideoBackends/Vulkan/ObjectCache.h"
 
 #include <algorithm>
+#include <mutex>
 #include <sstream>
 #include <type_traits>
 #include <xxhash.h>
 
 #include "Common/CommonFuncs.h"
 #include "Common/LinearDiskCache.h"
+#include "Common/ThreadPool.h"
 #include "Core/ConfigManager.h"
 #include "Core/Host.h"
 
@@ -19,6 +21,7 @@
 #include "VideoBackends/Vulkan/Util.h"
 #include "VideoBackends/Vulkan/VertexFormat.h"
 #include "VideoBackends/Vulkan/VulkanContext.h"
+#include "VideoCommon/ShaderPrecompiler.h"
 #include "VideoCommon/Statistics.h"
 
 namespace Vulkan
@@ -35,6 +38,115 @@ namespace Vulkan
 
 std::unique_ptr<ObjectCache> g_object_cache;
 
+static VkPipeline CreateVulkanPipeline(const PipelineInfo& info, VkPipelineCache pipeline_cache);
+
+// Creates pipelines on the shared thread pool. Every job borrows a pipeline cache nobody else
+// is using so the workers don't contend on the driver's cache lock; the caches are merged into
+// the main one when it is saved to disk.
+class ObjectCache::PipelineCompiler final
+{
+public:
+	PipelineCompiler(const std::vector<u8>& initial_data)
+		: m_initial_data(initial_data), m_output(64)
+	{
+		m_in_flight.store(0);
+	}
+
+	~PipelineCompiler()
+	{
+		WaitForFinish();
+		for (VkPipelineCache cache : m_caches)
+			vkDestroyPipelineCache(g_vulkan_context->GetDevice(), cache, nullptr);
+	}
+
+	// info must stay alive until its result was popped, PipelineInfo isn't assignable so the
+	// tasks carry pointers to the pending set entries.
+	void Compile(const PipelineInfo* info)
+	{
+		m_in_flight.fetch_add(1);
+		Common::ThreadPool::Submit([this, info] {
+			VkPipelineCache cache = AcquireCache();
+			VkPipeline pipeline = CreateVulkanPipeline(*info, cache);
+			ReleaseCache(cache);
+			m_output.push(std::make_pair(info, pipeline));
+			m_in_flight.fetch_sub(1);
+		}, Common::TaskPriority::High);
+	}
+
+	bool PopResult(std::pair<const PipelineInfo*, VkPipeline>& result)
+	{
+		return m_output.try_pop(result);
+	}
+
+	void WaitForFinish()
+	{
+		u32 count = 0;
+		while (m_in_flight.load() != 0)
+			Common::cYield(count++);
+	}
+
+	// Caller must make sure no job is running.
+	void MergeInto(VkPipelineCache dst_cache)
+	{
+		if (m_caches.empty())
+			return;
+		VkResult res = vkMergePipelineCaches(g_vulkan_context->GetDevice(), dst_cache,
+			static_cast<u32>(m_caches.size()), m_caches.data());
+		if (res != VK_SUCCESS)
+			LOG_VULKAN_ERROR(res, "vkMergePipelineCaches failed: ");
+	}
+
+private:
+	VkPipelineCache AcquireCache()
+	{
+		{
+			std::lock_guard<std::mutex> guard(m_cache_lock);
+			if (!m_free_caches.empty())
+			{
+				VkPipelineCache cache = m_free_caches.back();
+				m_free_caches.pop_back();
+				return cache;
+			}
+		}
+		// One new cache per concurrently running job, seeded with the disk cache so
+		// pipelines built by previous sessions are still cheap to create.
+		VkPipelineCacheCreateInfo info = {
+			VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO, nullptr, 0,
+			m_initial_data.size(), !m_initial_data.empty() ? m_initial_data.data() : nullptr };
+		VkPipelineCache cache = VK_NULL_HANDLE;
+		VkResult res = vkCreatePipelineCache(g_vulkan_context->GetDevice(), &info, nullptr, &cache);
+		if (res != VK_SUCCESS)
+		{
+			info.initialDataSize = 0;
+			info.pInitialData = nullptr;
+			res = vkCreatePipelineCache(g_vulkan_context->GetDevice(), &info, nullptr, &cache);
+			if (res != VK_SUCCESS)
+			{
+				LOG_VULKAN_ERROR(res, "vkCreatePipelineCache failed: ");
+				return VK_NULL_HANDLE;
+			}
+		}
+		std::lock_guard<std::mutex> guard(m_cache_lock);
+		m_caches.push_back(cache);
+		return cache;
+	}
+
+	void ReleaseCache(VkPipelineCache cache)
+	{
+		if (cache == VK_NULL_HANDLE)
+			return;
+		std::lock_guard<std::mutex> guard(m_cache_lock);
+		m_free_caches.push_back(cache);
+	}
+
+	const std::vector<u8>& m_initial_data;
+	Common::ManyToOneQueue<std::pair<const PipelineInfo*, VkPipeline>> m_output;
+	std::atomic<s32> m_in_flight;
+	std::mutex m_cache_lock;
+	std::vector<VkPipelineCache> m_caches;
+	std::vector<VkPipelineCache> m_free_caches;
+};
+
 ObjectCache::ObjectCache()
 {
 }
@@ -170,12 +282,8 @@ GetVulkanColorBlendState(const BlendState& state,
 	return vk_state;
 }
 
-VkPipeline ObjectCache::GetPipeline(const PipelineInfo& info)
+static VkPipeline CreateVulkanPipeline(const PipelineInfo& info, VkPipelineCache pipeline_cache)
 {
-	auto iter = m_pipeline_objects.find(info);
-	if (iter != m_pipeline_objects.end())
-		return iter->second;
-
 	// Declare descriptors for empty vertex buffers/attributes
 	static const VkPipelineVertexInputStateCreateInfo empty_vertex_input_state = {
 		VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,  // VkStructureType sType
@@ -290,15 +398,64 @@ VkPipeline ObjectCache::GetPipeline(const PipelineInfo& info)
 	};
 
 	VkPipeline pipeline = VK_NULL_HANDLE;
-	VkResult res = vkCreateGraphicsPipelines(g_vulkan_context->GetDevice(), m_pipeline_cache, 1,
+	VkResult res = vkCreateGraphicsPipelines(g_vulkan_context->GetDevice(), pipeline_cache, 1,
 		&pipeline_info, nullptr, &pipeline);
 	if (res != VK_SUCCESS)
 		LOG_VULKAN_ERROR(res, "vkCreateGraphicsPipelines failed: ");
 
+	return pipeline;
+}
+
+VkPipeline ObjectCache::GetPipeline(const PipelineInfo& info)
+{
+	auto iter = m_pipeline_objects.find(info);
+	if (iter != m_pipeline_objects.end())
+		return iter->second;
+
+	// Already queued, waiting for it is cheaper than creating it twice.
+	if (m_pending_pipelines.count(info) != 0)
+	{
+		m_pipeline_compiler->WaitForFinish();
+		ProcessCompiledPipelines();
+		iter = m_pipeline_objects.find(info);
+		if (iter != m_pipeline_objects.end())
+			return iter->second;
+	}
+
+	VkPipeline pipeline = CreateVulkanPipeline(info, m_pipeline_cache);
 	m_pipeline_objects.emplace(info, pipeline);
 	return pipeline;
 }
 
+VkPipeline ObjectCache::GetPipelineAsync(const PipelineInfo& info, bool* pending)
+{
+	*pending = false;
+	auto iter = m_pipeline_objects.find(info);
+	if (iter != m_pipeline_objects.end())
+		return iter->second;
+
+	ProcessCompiledPipelines();
+	iter = m_pipeline_objects.find(info);
+	if (iter != m_pipeline_objects.end())
+		return iter->second;
+
+	*pending = true;
+	auto inserted = m_pending_pipelines.insert(info);
+	if (inserted.second)
+		m_pipeline_compiler->Compile(&*inserted.first);
+	return VK_NULL_HANDLE;
+}
+
+void ObjectCache::ProcessCompiledPipelines()
+{
+	std::pair<const PipelineInfo*, VkPipeline> result;
+	while (m_pipeline_compiler->PopResult(result))
+	{
+		m_pipeline_objects.emplace(*result.first, result.second);
+		m_pending_pipelines.erase(*result.first);
+	}
+}
+
 std::string ObjectCache::GetDiskCacheFileName(const char* type)
 {
 	return StringFromFormat("%sIVK-%s-%s.cache", File::GetUserPath(D_SHADERCACHE_IDX).c_str(),
@@ -332,7 +489,8 @@ bool ObjectCache::CreatePipelineCache(bool load_from_disk)
 	// we delete the old one, by which time the game's unique ID is already cleared.
 	m_pipeline_cache_filename = GetDiskCacheFileName("pipeline");
 
-	std::vector<u8> disk_data;
+	std::vector<u8>& disk_data = m_pipeline_cache_data;
+	disk_data.clear();
 	if (load_from_disk)
 	{
 		LinearDiskCache<u32, u8> disk_cache;
@@ -340,6 +498,7 @@ bool ObjectCache::CreatePipelineCache(bool load_from_disk)
 		if (disk_cache.OpenAndRead(m_pipeline_cache_filename, read_callback) != 1)
 			disk_data.clear();
 	}
+	m_pipeline_compiler = std::make_unique<PipelineCompiler>(m_pipeline_cache_data);
 
 	VkPipelineCacheCreateInfo info = {
 		VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,  // VkStructureType            sType
@@ -368,6 +527,14 @@ bool ObjectCache::CreatePipelineCache(bool load_from_disk)
 
 void ObjectCache::DestroyPipelineCache()
 {
+	if (m_pipeline_compiler)
+	{
+		m_pipeline_compiler->WaitForFinish();
+		ProcessCompiledPipelines();
+		m_pipeline_compiler.reset();
+	}
+	m_pending_pipelines.clear();
+
 	for (const auto& it : m_pipeline_objects)
 	{
 		if (it.second != VK_NULL_HANDLE)
@@ -390,6 +557,10 @@ void ObjectCache::ClearPipelineCache()
 
 void ObjectCache::SavePipelineCache()
 {
+	m_pipeline_compiler->WaitForFinish();
+	ProcessCompiledPipelines();
+	m_pipeline_compiler->MergeInto(m_pipeline_cache);
+
 	size_t data_size;
 	VkResult res =
 		vkGetPipelineCacheData(g_vulkan_context->GetDevice(), m_pipeline_cache, &data_size, nullptr);
@@ -479,67 +650,43 @@ void ObjectCache::LoadShaderCaches()
 
 	if (g_ActiveConfig.bCompileShaderOnStartup)
 	{
-		int shader_count = 0;
-		m_vs_cache.shader_map->ForEachMostUsedByCategory(gameid,
-			[&](const VertexShaderUid& uid, size_t total)
+		auto needs_compile = [](vkShaderItem& entry) { return !entry.compiled; };
+		std::vector<VertexShaderUid> vs_uids = ShaderPrecompiler::CollectUids<VertexShaderUid>(*m_vs_cache.shader_map, gameid, needs_compile);
+		std::vector<PixelShaderUid> ps_uids = ShaderPrecompiler::CollectUids<PixelShaderUid>(*m_ps_cache.shader_map, gameid, needs_compile);
+		std::vector<GeometryShaderUid> gs_uids;
+		if (g_vulkan_context->SupportsGeometryShaders())
+			gs_uids = ShaderPrecompiler::CollectUids<GeometryShaderUid>(*m_gs_cache.shader_map, gameid, needs_compile);
+
+		// Creating shader modules doesn't need external synchronization, so the whole compile is
+		// spread over the thread pool. The shader maps are only shared with the precompile workers.
+		std::vector<ShaderPrecompiler::Job> jobs(3);
+		jobs[0].name = "Vertex Shaders";
+		jobs[0].count = vs_uids.size();
+		jobs[0].compile = [this, uids = std::move(vs_uids)](size_t index)
 		{
-			VertexShaderUid item = uid;
-			item.ClearHASH();
-			item.CalculateUIDHash();
-			vkShaderItem& it = m_vs_cache.shader_map->GetOrAdd(item);
+			vkShaderItem& it = GetPrecompileItem(*m_vs_cache.shader_map, uids[index]);
 			if (!it.initialized.test_and_set())
-			{
-				Host_UpdateTitle(StringFromFormat("Compiling Vertex Shaders %i %% (%i/%i)", (shader_count * 100) / total, shader_count, total));
-				CompileVertexShaderForUid(item, it);
-			}
-		},
-			[](vkShaderItem& entry)
+				CompileVertexShaderForUid(uids[index], it);
+		};
+		jobs[1].name = "Pixel Shaders";
+		jobs[1].count = ps_uids.size();
+		jobs[1].compile = [this, uids = std::move(ps_uids)](size_t index)
 		{
-			return !entry.compiled;
-		}
-		, true);
-		shader_count = 0;
-		m_ps_cache.shader_map->ForEachMostUsedByCategory(gameid,
-			[&](const PixelShaderUid& uid, size_t total)
-		{
-			PixelShaderUid item = uid;
-			item.ClearHASH();
-			item.CalculateUIDHash();
-			vkShaderItem& it = m_ps_cache.shader_map->GetOrAdd(item);
+			vkShaderItem& it = GetPrecompileItem(*m_ps_cache.shader_map, uids[index]);
 			if (!it.initialized.test_and_set())
-			{
-				Host_UpdateTitle(StringFromFormat("Compiling Pixel Shaders %i %% (%i/%i)", (shader_count * 100) / total, shader_count, total));
-				CompilePixelShaderForUid(item, it);
-			}
-		},
-			[](vkShaderItem& entry)
-		{
-			return !entry.compiled;
-		}
-		, true);
-
-		if (g_vulkan_context->SupportsGeometryShaders())
+				CompilePixelShaderForUid(uids[index], it);
+		};
+		jobs[2].name = "Geometry Shaders";
+		jobs[2].count = gs_uids.size();
+		jobs[2].compile = [this, uids = std::move(gs_uids)](size_t index)
 		{
-			shader_count = 0;
-			m_gs_cache.shader_map->ForEachMostUsedByCategory(gameid,
-				[&](const GeometryShaderUid& uid, size_t total)
-			{
-				GeometryShaderUid item = uid;
-				item.ClearHASH();
-				item.CalculateUIDHash();
-				vkShaderItem& it = m_gs_cache.shader_map->GetOrAdd(item);
-				if (!it.initialized.test_and_set())
-				{
-					Host_UpdateTitle(StringFromFormat("Compiling Geometry Shaders %i %% (%i/%i)", (shader_count * 100) / total, shader_count, total));
-					CompileGeometryShaderForUid(item, it);
-				}
-			},
-				[](vkShaderItem& entry)
-			{
-				return !entry.compiled;
-			}
-			, true);
-		}
+			vkShaderItem& it = GetPrecompileItem(*m_gs_cache.shader_map, uids[index]);
+			if (!it.initialized.test_and_set())
+				CompileGeometryShaderForUid(uids[index], it);
+		};
+		for (ShaderPrecompiler::Job& job : jobs)
+			job.thread_safe = true;
+		ShaderPrecompiler::Run(std::move(jobs));
 	}
 
 	SETSTAT(stats.numVertexShadersCreated, static_cast<int>(m_vs_cache.shader_map->size()));
@@ -562,6 +709,7 @@ static void DestroyShaderCache(T& cache)
 
 void ObjectCache::DestroyShaderCaches()
 {
+	ShaderPrecompiler::Cancel();
 	DestroyShaderCache(m_vs_cache);
 	DestroyShaderCache(m_ps_cache);
 
@@ -584,6 +732,7 @@ void ObjectCache::CompileVertexShaderForUid(const VertexShaderUid& uid, ObjectCa
 		// Append to shader cache if it created successfully.
 		if (module != VK_NULL_HANDLE)
 		{
+			std::lock_guard<std::mutex> guard(m_shader_cache_lock);
 			m_vs_cache.disk_cache.Append(uid, spv.data(), static_cast<u32>(spv.size()));
 			INCSTAT(stats.numVertexShadersCreated);
 			INCSTAT(stats.numVertexShadersAlive);
@@ -607,7 +756,10 @@ void ObjectCache::CompileGeometryShaderForUid(const GeometryShaderUid& uid, Obje
 
 		// Append to shader cache if it created successfully.
 		if (module != VK_NULL_HANDLE)
+		{
+			std::lock_guard<std::mutex> guard(m_shader_cache_lock);
 			m_gs_cache.disk_cache.Append(uid, spv.data(), static_cast<u32>(spv.size()));
+		}
 	}
 	it.compiled = true;
 	// We still insert null entries to prevent further compilation attempts.
@@ -629,6 +781,7 @@ void ObjectCache::CompilePixelShaderForUid(const PixelShaderUid& uid, ObjectCach
 		// Append to shader cache if it created successfully.
 		if (module != VK_NULL_HANDLE)
 		{
+			std::lock_guard<std::mutex> guard(m_shader_cache_lock);
 			m_ps_cache.disk_cache.Append(uid, spv.data(), static_cast<u32>(spv.size()));
 			INCSTAT(stats.numPixelShadersCreated);
 			INCSTAT(stats.numPixelShadersAlive);
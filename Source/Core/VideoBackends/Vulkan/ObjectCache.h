@@ -8,8 +8,11 @@
 #include <cstddef>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include "Common/CommonTypes.h"
 #include "Common/LinearDiskCache.h"
@@ -137,6 +140,13 @@ public:
 	// Find a pipeline by the specified description, if not found, attempts to create it
 	VkPipeline GetPipeline(const PipelineInfo& info);
 
+	// Same as GetPipeline, but a missing pipeline is created by the worker threads.
+	// Returns VK_NULL_HANDLE and sets pending until it is ready.
+	VkPipeline GetPipelineAsync(const PipelineInfo& info, bool* pending);
+
+	// Moves the pipelines finished by the worker threads to the pipeline map.
+	void ProcessCompiledPipelines();
+
 	// Wipes out the pipeline cache, use when MSAA modes change, for example
 	// Also destroys the data that would be stored in the disk cache.
 	void ClearPipelineCache();
@@ -195,6 +205,12 @@ private:
 	void CompileVertexShaderForUid(const VertexShaderUid& uid, vkShaderItem& it);
 	void CompileGeometryShaderForUid(const GeometryShaderUid& uid, vkShaderItem& it);
 	void CompilePixelShaderForUid(const PixelShaderUid& uid, vkShaderItem& it);
+	template <typename Map, typename Uid>
+	vkShaderItem& GetPrecompileItem(Map& map, const Uid& uid)
+	{
+		std::lock_guard<std::mutex> guard(m_shader_cache_lock);
+		return map.GetOrAdd(uid);
+	}
 
 	template <typename Uid, typename UidHasher>
 	class ShaderCache
@@ -212,10 +228,17 @@ private:
 	VShaderCache m_vs_cache;
 	GShaderCache m_gs_cache;
 	PShaderCache m_ps_cache;
+	// Guards the shader maps, disk caches and statistics while the startup precompilation compiles
+	// on several threads
+	std::mutex m_shader_cache_lock;
 
 	std::unordered_map<PipelineInfo, VkPipeline, PipelineInfoHash> m_pipeline_objects;
+	std::unordered_set<PipelineInfo, PipelineInfoHash> m_pending_pipelines;
 	VkPipelineCache m_pipeline_cache = VK_NULL_HANDLE;
+	std::vector<u8> m_pipeline_cache_data;
 	std::string m_pipeline_cache_filename;
+	class PipelineCompiler;
+	std::unique_ptr<PipelineCompiler> m_pipeline_compiler;
 
 	VkSampler m_point_sampler = VK_NULL_HANDLE;
 	VkSampler m_linear_sampler = VK_NULL_HANDLE;
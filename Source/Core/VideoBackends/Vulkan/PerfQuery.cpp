@@ -61,12 +61,13 @@ bool PerfQuery::Initialize()
 
 void PerfQuery::EnableQuery(PerfQueryGroup type)
 {
-	// Have we used half of the query buffer already?
-	if (m_query_count > m_query_buffer.size() / 2)
+	// Have we used half of the queries allowed in flight already?
+	// The results are collected by the fence callbacks, so asynchronous reads need no extra flush.
+	if (m_query_count > GetMaxQueriesInFlight(PERF_QUERY_BUFFER_SIZE) / 2)
 		NonBlockingPartialFlush();
 
-	// Block if there are no free slots.
-	if (m_query_count == PERF_QUERY_BUFFER_SIZE)
+	// Block if there are no free slots left in the in flight budget.
+	if (m_query_count >= GetMaxQueriesInFlight(PERF_QUERY_BUFFER_SIZE))
 	{
 		// ERROR_LOG(VIDEO, "Flushed query buffer early!");
 		BlockingPartialFlush();
@@ -123,8 +123,6 @@ static const char VERTEX_SHADER_SOURCE[] = R"(
 
 layout(std140, push_constant) uniform PCBlock {
   vec2 char_size;
-  vec2 offset;
-  vec4 color;
 } PC;
 
 layout(location = 0) in vec4 ipos;
@@ -132,33 +130,30 @@ layout(location = 5) in vec4 icol0;
 layout(location = 8) in vec3 itex0;
 
 layout(location = 0) out vec2 uv0;
+layout(location = 1) out vec4 col0;
 
 void main()
 {
-  gl_Position = vec4(ipos.xy + PC.offset, 0.0f, 1.0f);
+  gl_Position = vec4(ipos.xy, 0.0f, 1.0f);
   gl_Position.y = -gl_Position.y;
   uv0 = itex0.xy * PC.char_size;
+  col0 = icol0;
 }
 
 )";
 
 static const char FRAGMENT_SHADER_SOURCE[] = R"(
 
-layout(std140, push_constant) uniform PCBlock {
-  vec2 char_size;
-  vec2 offset;
-  vec4 color;
-} PC;
-
 layout(set = 1, binding = 0) uniform sampler2D samp0;
 
 layout(location = 0) in vec2 uv0;
+layout(location = 1) in vec4 col0;
 
 layout(location = 0) out vec4 ocol0;
 
 void main()
 {
-  ocol0 = texture(samp0, uv0) * PC.color;
+  ocol0 = texture(samp0, uv0) * col0;
 }
 
 )";
@@ -291,28 +286,20 @@ bool RasterFont::CreateShaders()
 	return m_vertex_shader != VK_NULL_HANDLE && m_fragment_shader != VK_NULL_HANDLE;
 }
 
-void RasterFont::PrintMultiLineText(VkRenderPass render_pass, const std::string& text,
-	float start_x, float start_y, u32 bbWidth, u32 bbHeight,
-	u32 color)
+void RasterFont::PrintMultiLineText(const std::string& text, float start_x, float start_y,
+	u32 bbWidth, u32 bbHeight, u32 color)
 {
-	// skip empty strings
-	if (text.empty())
-		return;
-
-	UtilityShaderDraw draw(g_command_buffer_mgr->GetCurrentCommandBuffer(),
-		g_object_cache->GetPushConstantPipelineLayout(), render_pass,
-		m_vertex_shader, VK_NULL_HANDLE, m_fragment_shader);
-
-	UtilityShaderVertex* vertices =
-		draw.ReserveVertices(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, text.length() * 6);
-	size_t num_vertices = 0;
-	if (!vertices)
-		return;
-
 	float delta_x = float(2 * CHAR_WIDTH) / float(bbWidth);
 	float delta_y = float(2 * CHAR_HEIGHT) / float(bbHeight);
 	float border_x = 2.0f / float(bbWidth);
 	float border_y = 4.0f / float(bbHeight);
+	float shadow_x = 2.0f / float(bbWidth);
+	float shadow_y = -2.0f / float(bbHeight);
+
+	// color is ARGB, the vertices take RGBA bytes
+	u32 text_color = ((color >> 16) & 0xFF) | (color & 0xFF00) | ((color & 0xFF) << 16) |
+		(color & 0xFF000000);
+	u32 shadow_color = color & 0xFF000000;
 
 	float x = float(start_x);
 	float y = float(start_y);
@@ -336,54 +323,56 @@ void RasterFont::PrintMultiLineText(VkRenderPass render_pass, const std::string&
 		if (c < CHAR_OFFSET || c >= CHAR_COUNT + CHAR_OFFSET)
 			continue;
 
-		vertices[num_vertices].SetPosition(x, y);
-		vertices[num_vertices].SetTextureCoordinates(static_cast<float>(c - CHAR_OFFSET), 0.0f);
-		num_vertices++;
-
-		vertices[num_vertices].SetPosition(x + delta_x, y);
-		vertices[num_vertices].SetTextureCoordinates(static_cast<float>(c - CHAR_OFFSET + 1), 0.0f);
-		num_vertices++;
-
-		vertices[num_vertices].SetPosition(x + delta_x, y + delta_y);
-		vertices[num_vertices].SetTextureCoordinates(static_cast<float>(c - CHAR_OFFSET + 1), 1.0f);
-		num_vertices++;
-
-		vertices[num_vertices].SetPosition(x, y);
-		vertices[num_vertices].SetTextureCoordinates(static_cast<float>(c - CHAR_OFFSET), 0.0f);
-		num_vertices++;
-
-		vertices[num_vertices].SetPosition(x + delta_x, y + delta_y);
-		vertices[num_vertices].SetTextureCoordinates(static_cast<float>(c - CHAR_OFFSET + 1), 1.0f);
-		num_vertices++;
-
-		vertices[num_vertices].SetPosition(x, y + delta_y);
-		vertices[num_vertices].SetTextureCoordinates(static_cast<float>(c - CHAR_OFFSET), 1.0f);
-		num_vertices++;
+		float left = static_cast<float>(c - CHAR_OFFSET);
+		float right = static_cast<float>(c - CHAR_OFFSET + 1);
+		for (int shadow = 1; shadow >= 0; shadow--)
+		{
+			std::vector<UtilityShaderVertex>& batch = shadow ? m_shadow_vertices : m_vertices;
+			float x0 = shadow ? x + shadow_x : x;
+			float y0 = shadow ? y + shadow_y : y;
+			const float corners[6][4] = { { x0, y0, left, 0.0f },
+				{ x0 + delta_x, y0, right, 0.0f },
+				{ x0 + delta_x, y0 + delta_y, right, 1.0f },
+				{ x0, y0, left, 0.0f },
+				{ x0 + delta_x, y0 + delta_y, right, 1.0f },
+				{ x0, y0 + delta_y, left, 1.0f } };
+			for (const auto& corner : corners)
+			{
+				UtilityShaderVertex vertex;
+				vertex.SetPosition(corner[0], corner[1]);
+				vertex.SetTextureCoordinates(corner[2], corner[3]);
+				vertex.SetColor(shadow ? shadow_color : text_color);
+				batch.push_back(vertex);
+			}
+		}
 
 		x += delta_x + border_x;
 	}
+}
 
-	// skip all whitespace strings
-	if (num_vertices == 0)
+void RasterFont::Flush(VkRenderPass render_pass)
+{
+	// skip frames without text
+	if (m_vertices.empty())
 		return;
 
-	draw.CommitVertices(num_vertices);
+	m_shadow_vertices.insert(m_shadow_vertices.end(), m_vertices.begin(), m_vertices.end());
+
+	UtilityShaderDraw draw(g_command_buffer_mgr->GetCurrentCommandBuffer(),
+		g_object_cache->GetPushConstantPipelineLayout(), render_pass,
+		m_vertex_shader, VK_NULL_HANDLE, m_fragment_shader);
+
+	draw.UploadVertices(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, m_shadow_vertices.data(),
+		m_shadow_vertices.size());
 
 	struct PCBlock
 	{
 		float char_size[2];
-		float offset[2];
-		float color[4];
 	} pc_block = {};
 
 	pc_block.char_size[0] = 1.0f / static_cast<float>(CHAR_COUNT);
 	pc_block.char_size[1] = 1.0f;
 
-	// shadows
-	pc_block.offset[0] = 2.0f / bbWidth;
-	pc_block.offset[1] = -2.0f / bbHeight;
-	pc_block.color[3] = (color >> 24) / 255.0f;
-
 	draw.SetPushConstants(&pc_block, sizeof(pc_block));
 	draw.SetPSSampler(0, m_texture->GetView(), g_object_cache->GetLinearSampler());
 
@@ -397,14 +386,8 @@ void RasterFont::PrintMultiLineText(VkRenderPass render_pass, const std::string&
 
 	draw.Draw();
 
-	// non-shadowed part
-	pc_block.offset[0] = 0.0f;
-	pc_block.offset[1] = 0.0f;
-	pc_block.color[0] = ((color >> 16) & 0xFF) / 255.0f;
-	pc_block.color[1] = ((color >> 8) & 0xFF) / 255.0f;
-	pc_block.color[2] = (color & 0xFF) / 255.0f;
-	draw.SetPushConstants(&pc_block, sizeof(pc_block));
-	draw.Draw();
+	m_shadow_vertices.clear();
+	m_vertices.clear();
 }
 
 }  // namespace Vulkan
@@ -6,10 +6,12 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "Common/CommonTypes.h"
 
 #include "VideoBackends/Vulkan/Constants.h"
+#include "VideoBackends/Vulkan/Util.h"
 
 namespace Vulkan
 {
@@ -23,8 +25,11 @@ public:
 
 	bool Initialize();
 
-	void PrintMultiLineText(VkRenderPass render_pass, const std::string& text, float start_x,
-		float start_y, u32 bbWidth, u32 bbHeight, u32 color);
+	// Adds the text to the batch drawn by Flush
+	void PrintMultiLineText(const std::string& text, float start_x, float start_y, u32 bbWidth,
+		u32 bbHeight, u32 color);
+	// Draws all the text printed since the last flush with a single draw call
+	void Flush(VkRenderPass render_pass);
 
 private:
 	bool CreateTexture();
@@ -34,6 +39,10 @@ private:
 
 	VkShaderModule m_vertex_shader = VK_NULL_HANDLE;
 	VkShaderModule m_fragment_shader = VK_NULL_HANDLE;
+
+	// The shadows of all the glyphs are drawn before the glyphs themselves
+	std::vector<UtilityShaderVertex> m_shadow_vertices;
+	std::vector<UtilityShaderVertex> m_vertices;
 };
 
 }  // namespace Vulkan
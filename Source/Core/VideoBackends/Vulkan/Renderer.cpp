@@ -30,6 +30,7 @@
 #include "VideoCommon/AVIDump.h"
 #include "VideoCommon/BPFunctions.h"
 #include "VideoCommon/BPMemory.h"
+#include "VideoCommon/GPUProfilerBase.h"
 #include "VideoCommon/OnScreenDisplay.h"
 #include "VideoCommon/PixelEngine.h"
 #include "VideoCommon/PixelShaderManager.h"
@@ -169,7 +170,7 @@ void Renderer::RenderText(const std::string& text, int left, int top, u32 color)
 	u32 backbuffer_width = m_swap_chain->GetWidth();
 	u32 backbuffer_height = m_swap_chain->GetHeight();
 
-	m_raster_font->PrintMultiLineText(m_swap_chain->GetRenderPass(), text,
+	m_raster_font->PrintMultiLineText(text,
 		left * 2.0f / static_cast<float>(backbuffer_width) - 1,
 		1 - top * 2.0f / static_cast<float>(backbuffer_height),
 		backbuffer_width, backbuffer_height, color);
@@ -494,6 +495,7 @@ void Renderer::SwapImpl(u32 xfb_addr, u32 fb_width, u32 fb_stride, u32 fb_height
 	// End the current render pass.
 	StateTracker::GetInstance()->EndRenderPass();
 	StateTracker::GetInstance()->OnEndFrame();
+	SetGPUPass(GPU_PASS_PRESENT);
 
 	// Render the frame dump image if enabled.
 	if (IsFrameDumping())
@@ -517,9 +519,12 @@ void Renderer::SwapImpl(u32 xfb_addr, u32 fb_width, u32 fb_stride, u32 fb_height
 	g_command_buffer_mgr->PrepareToSubmitCommandBuffer();
 
 	// Draw to the screen if we have a swap chain.
+	VkFence frame_fence = g_command_buffer_mgr->GetCurrentCommandBufferFence();
 	if (m_swap_chain)
 	{
 		DrawScreen(rc, xfb_addr, xfb_sources, xfb_count, fb_width, fb_stride, fb_height);
+		if (g_gpu_profiler)
+			g_gpu_profiler->EndFrame();
 
 		// Submit the current command buffer, signaling rendering finished semaphore when it's done
 		// Because this final command buffer is rendering to the swap chain, we need to wait for
@@ -532,9 +537,17 @@ void Renderer::SwapImpl(u32 xfb_addr, u32 fb_width, u32 fb_stride, u32 fb_height
 	else
 	{
 		// No swap chain, just execute command buffer.
+		if (g_gpu_profiler)
+			g_gpu_profiler->EndFrame();
 		g_command_buffer_mgr->SubmitCommandBuffer(true);
 	}
 
+	// In low latency mode the next frame is only started once the GPU finished the previous one,
+	// so no more than one frame waits for the GPU and the newest input makes it into the next.
+	if (g_ActiveConfig.bLowLatencyPresent && m_last_frame_fence != VK_NULL_HANDLE)
+		g_command_buffer_mgr->WaitForFence(m_last_frame_fence);
+	m_last_frame_fence = frame_fence;
+
 	// NOTE: It is important that no rendering calls are made to the EFB between submitting the
 	// (now-previous) frame and after the below config checks are completed. If the target size
 	// changes, as the resize methods to not defer the destruction of the framebuffer, the current
@@ -695,6 +708,7 @@ void Renderer::DrawScreen(const EFBRectangle& source_rect, u32 xfb_addr,
 	DrawDebugText();
 	OSD::DoCallbacks(OSD::CallbackType::OnFrame);
 	OSD::DrawMessages();
+	m_raster_font->Flush(m_swap_chain->GetRenderPass());
 
 	// End drawing to backbuffer
 	vkCmdEndRenderPass(g_command_buffer_mgr->GetCurrentCommandBuffer());
@@ -816,13 +830,8 @@ void Renderer::WriteFrameDumpImage(size_t index)
 
 StagingTexture2D* Renderer::PrepareFrameDumpImage(u32 width, u32 height, u64 ticks)
 {
-	// Ensure the last frame that was sent to the frame dump has completed encoding before we send
-	// the next image to it.
-	FinishFrameData();
-
 	// If the last image hasn't been written to the frame dump yet, write it now.
-	// This is necessary so that the worker thread is no more than one frame behind, and the pointer
-	// (which is actually the buffer) is safe for us to re-use next time.
+	// DumpFrameData copies the image, so this only waits for the GPU, not for the encoder.
 	if (m_frame_dump_images[m_current_frame_dump_image].pending)
 		WriteFrameDumpImage(m_current_frame_dump_image);
 
@@ -1053,7 +1062,8 @@ void Renderer::CheckForSurfaceChange()
 				s_new_surface_handle);
 			if (surface != VK_NULL_HANDLE)
 			{
-				m_swap_chain = SwapChain::Create(s_new_surface_handle, surface, g_ActiveConfig.IsVSync());
+				m_swap_chain = SwapChain::Create(s_new_surface_handle, surface, g_ActiveConfig.IsVSync(),
+					g_ActiveConfig.bLowLatencyPresent);
 				if (!m_swap_chain)
 					PanicAlert("Failed to create swap chain.");
 			}
@@ -1145,6 +1155,11 @@ void Renderer::CheckForConfigChanges()
 		g_command_buffer_mgr->WaitForGPUIdle();
 		m_swap_chain->SetVSync(g_ActiveConfig.IsVSync());
 	}
+	if (m_swap_chain && g_ActiveConfig.bLowLatencyPresent != m_swap_chain->IsLowLatencyEnabled())
+	{
+		g_command_buffer_mgr->WaitForGPUIdle();
+		m_swap_chain->SetLowLatency(g_ActiveConfig.bLowLatencyPresent);
+	}
 
 	// Wipe sampler cache if force texture filtering or anisotropy changes.
 	if (anisotropy_changed || force_texture_filtering_changed)
@@ -141,6 +141,9 @@ private:
 	bool ResizeFrameDumpBuffer(u32 new_width, u32 new_height);
 	void DestroyFrameDumpResources();
 
+	// Fence of the last command buffer of the previous frame, for low latency presentation.
+	VkFence m_last_frame_fence = VK_NULL_HANDLE;
+
 	VkSemaphore m_image_available_semaphore = VK_NULL_HANDLE;
 	VkSemaphore m_rendering_finished_semaphore = VK_NULL_HANDLE;
 
@@ -208,20 +208,20 @@ bool CompileShaderToSPV(SPIRVCodeVector* out_code, EShLanguage stage, const char
 
 bool InitializeGlslang()
 {
-	static bool glslang_initialized = false;
-	if (glslang_initialized)
-		return true;
-
-	if (!glslang::InitializeProcess())
+	// The startup precompilation compiles from several threads, the static initialization makes
+	// the first ones wait for it
+	static const bool glslang_initialized = []
 	{
-		PanicAlert("Failed to initialize glslang shader compiler");
-		return false;
-	}
-
-	std::atexit([]() { glslang::FinalizeProcess(); });
+		if (!glslang::InitializeProcess())
+		{
+			PanicAlert("Failed to initialize glslang shader compiler");
+			return false;
+		}
 
-	glslang_initialized = true;
-	return true;
+		std::atexit([]() { glslang::FinalizeProcess(); });
+		return true;
+	}();
+	return glslang_initialized;
 }
 
 const TBuiltInResource* GetCompilerResourceLimits()
@@ -345,5 +345,12 @@ bool CompileFragmentShader(SPIRVCodeVector* out_code, const char* source_code,
 		prepend_header);
 }
 
+bool CompileComputeShader(SPIRVCodeVector* out_code, const char* source_code,
+	size_t source_code_length, bool prepend_header)
+{
+	return CompileShaderToSPV(out_code, EShLangCompute, "cs", source_code, source_code_length,
+		prepend_header);
+}
+
 }  // namespace ShaderCompiler
 }  // namespace Vulkan
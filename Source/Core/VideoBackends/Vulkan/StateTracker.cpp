@@ -4,9 +4,11 @@
 
 #include "VideoBackends/Vulkan/StateTracker.h"
 
+#include <algorithm>
 #include <cstring>
 
 #include "Common/Assert.h"
+#include "Common/Hash.h"
 
 #include "VideoBackends/Vulkan/CommandBufferManager.h"
 #include "VideoBackends/Vulkan/Constants.h"
@@ -107,6 +109,9 @@ bool StateTracker::Initialize()
 		g_vulkan_context->GetUniformBufferAlignment()) +
 		sizeof(GeometryShaderConstants);
 
+	m_uploaded_vs_constants.resize(VertexShaderManager::ConstantBufferSize);
+	m_uploaded_ps_constants.resize(PixelShaderManager::ConstantBufferSize);
+
 	// Default dirty flags include all descriptors
 	InvalidateDescriptorSets();
 	SetPendingRebind();
@@ -275,6 +280,12 @@ void StateTracker::UpdateVertexShaderConstants()
 	if (!VertexShaderManager::IsDirty())
 		return;
 
+	if (!VertexShaderManager::UpdateUploadedConstants(m_uploaded_vs_constants.data()))
+	{
+		VertexShaderManager::Clear();
+		return;
+	}
+
 	// Since the other stages uniform buffers' may be still be using the earlier data,
 	// we can't reuse the earlier part of the buffer without re-uploading everything.
 	if (!m_uniform_stream_buffer->ReserveMemory(m_uniform_buffer_reserve_size,
@@ -312,6 +323,14 @@ void StateTracker::UpdateGeometryShaderConstants()
 	if (m_pipeline_state.gs == VK_NULL_HANDLE || !GeometryShaderManager::IsDirty())
 		return;
 
+	if (memcmp(&m_uploaded_gs_constants, &GeometryShaderManager::constants,
+		sizeof(GeometryShaderConstants)) == 0)
+	{
+		GeometryShaderManager::Clear();
+		return;
+	}
+	m_uploaded_gs_constants = GeometryShaderManager::constants;
+
 	// Since the other stages uniform buffers' may be still be using the earlier data,
 	// we can't reuse the earlier part of the buffer without re-uploading everything.
 	if (!m_uniform_stream_buffer->ReserveMemory(m_uniform_buffer_reserve_size,
@@ -348,6 +367,12 @@ void StateTracker::UpdatePixelShaderConstants()
 	if (!PixelShaderManager::IsDirty())
 		return;
 
+	if (!PixelShaderManager::UpdateUploadedConstants(m_uploaded_ps_constants.data()))
+	{
+		PixelShaderManager::Clear();
+		return;
+	}
+
 	// Since the other stages uniform buffers' may be still be using the earlier data,
 	// we can't reuse the earlier part of the buffer without re-uploading everything.
 	if (!m_uniform_stream_buffer->ReserveMemory(m_uniform_buffer_reserve_size,
@@ -445,6 +470,12 @@ void StateTracker::UploadAllConstants()
 	// Finally, flush buffer memory after copying
 	m_uniform_stream_buffer->CommitMemory(total_allocation_size);
 
+	memcpy(m_uploaded_ps_constants.data(), PixelShaderManager::GetBuffer(),
+		PixelShaderManager::ConstantBufferSize * sizeof(float));
+	memcpy(m_uploaded_vs_constants.data(), VertexShaderManager::GetBuffer(),
+		VertexShaderManager::ConstantBufferSize * sizeof(float));
+	m_uploaded_gs_constants = GeometryShaderManager::constants;
+
 	// Clear dirty flags
 	VertexShaderManager::Clear();
 	GeometryShaderManager::Clear();
@@ -525,6 +556,9 @@ void StateTracker::InvalidateDescriptorSets()
 {
 	m_descriptor_sets.fill(VK_NULL_HANDLE);
 	m_dirty_flags |= DIRTY_FLAG_ALL_DESCRIPTOR_SETS;
+	m_uniform_buffer_sets.clear();
+	m_ps_sampler_sets.clear();
+	m_ps_ssbo_sets.clear();
 
 	// Defer SSBO descriptor update until bbox is actually enabled.
 	if (!m_bbox_enabled)
@@ -537,6 +571,8 @@ void StateTracker::SetPendingRebind()
 		DIRTY_FLAG_PIPELINE_BINDING | DIRTY_FLAG_VERTEX_BUFFER |
 		DIRTY_FLAG_INDEX_BUFFER | DIRTY_FLAG_VIEWPORT | DIRTY_FLAG_SCISSOR |
 		DIRTY_FLAG_PIPELINE;
+	m_bound_pipeline = VK_NULL_HANDLE;
+	m_bound_pipeline_layout = VK_NULL_HANDLE;
 }
 
 void StateTracker::BeginRenderPass()
@@ -614,7 +650,8 @@ bool StateTracker::Bind(bool rebind_all /*= false*/)
 	// Get new pipeline object if any parts have changed
 	if (m_dirty_flags & DIRTY_FLAG_PIPELINE && !UpdatePipeline())
 	{
-		ERROR_LOG(VIDEO, "Failed to get pipeline object, skipping draw");
+		if (!m_pipeline_pending)
+			ERROR_LOG(VIDEO, "Failed to get pipeline object, skipping draw");
 		return false;
 	}
 
@@ -649,21 +686,59 @@ bool StateTracker::Bind(bool rebind_all /*= false*/)
 		vkCmdBindIndexBuffer(command_buffer, m_index_buffer, m_index_buffer_offset, m_index_type);
 
 	if (m_dirty_flags & DIRTY_FLAG_PIPELINE_BINDING || rebind_all)
-		vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline_object);
+	{
+		if (m_pipeline_object != m_bound_pipeline || rebind_all)
+		{
+			vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline_object);
+			m_bound_pipeline = m_pipeline_object;
+		}
+		else
+		{
+			INCSTAT(stats.thisFrame.numRedundantBindsSkipped);
+		}
+	}
 
+	const bool offsets_changed = m_bindings.uniform_buffer_offsets != m_bound_uniform_buffer_offsets;
 	if (m_dirty_flags & DIRTY_FLAG_DESCRIPTOR_SET_BINDING || rebind_all)
 	{
-		vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
-			m_pipeline_state.pipeline_layout, 0, m_num_active_descriptor_sets,
-			m_descriptor_sets.data(), NUM_UBO_DESCRIPTOR_SET_BINDINGS,
-			m_bindings.uniform_buffer_offsets.data());
+		if (rebind_all || offsets_changed ||
+			m_pipeline_state.pipeline_layout != m_bound_pipeline_layout ||
+			m_num_active_descriptor_sets != m_bound_num_descriptor_sets ||
+			!std::equal(m_descriptor_sets.begin(), m_descriptor_sets.begin() + m_num_active_descriptor_sets,
+				m_bound_descriptor_sets.begin()))
+		{
+			vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+				m_pipeline_state.pipeline_layout, 0, m_num_active_descriptor_sets,
+				m_descriptor_sets.data(), NUM_UBO_DESCRIPTOR_SET_BINDINGS,
+				m_bindings.uniform_buffer_offsets.data());
+			m_bound_pipeline_layout = m_pipeline_state.pipeline_layout;
+			m_bound_descriptor_sets = m_descriptor_sets;
+			m_bound_num_descriptor_sets = m_num_active_descriptor_sets;
+			m_bound_uniform_buffer_offsets = m_bindings.uniform_buffer_offsets;
+		}
+		else
+		{
+			INCSTAT(stats.thisFrame.numRedundantBindsSkipped);
+		}
 	}
 	else if (m_dirty_flags & DIRTY_FLAG_DYNAMIC_OFFSETS)
 	{
-		vkCmdBindDescriptorSets(
-			command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline_state.pipeline_layout,
-			DESCRIPTOR_SET_UNIFORM_BUFFERS, 1, &m_descriptor_sets[DESCRIPTOR_SET_UNIFORM_BUFFERS],
-			NUM_UBO_DESCRIPTOR_SET_BINDINGS, m_bindings.uniform_buffer_offsets.data());
+		if (offsets_changed || m_pipeline_state.pipeline_layout != m_bound_pipeline_layout ||
+			m_descriptor_sets[DESCRIPTOR_SET_UNIFORM_BUFFERS] !=
+			m_bound_descriptor_sets[DESCRIPTOR_SET_UNIFORM_BUFFERS])
+		{
+			vkCmdBindDescriptorSets(
+				command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline_state.pipeline_layout,
+				DESCRIPTOR_SET_UNIFORM_BUFFERS, 1, &m_descriptor_sets[DESCRIPTOR_SET_UNIFORM_BUFFERS],
+				NUM_UBO_DESCRIPTOR_SET_BINDINGS, m_bindings.uniform_buffer_offsets.data());
+			m_bound_descriptor_sets[DESCRIPTOR_SET_UNIFORM_BUFFERS] =
+				m_descriptor_sets[DESCRIPTOR_SET_UNIFORM_BUFFERS];
+			m_bound_uniform_buffer_offsets = m_bindings.uniform_buffer_offsets;
+		}
+		else
+		{
+			INCSTAT(stats.thisFrame.numRedundantBindsSkipped);
+		}
 	}
 
 	if (m_dirty_flags & DIRTY_FLAG_VIEWPORT || rebind_all)
@@ -798,6 +873,8 @@ void StateTracker::EndClearRenderPass()
 
 bool StateTracker::UpdatePipeline()
 {
+	m_pipeline_pending = false;
+
 	// We need at least a vertex and fragment shader
 	if (m_pipeline_state.vs == VK_NULL_HANDLE || m_pipeline_state.ps == VK_NULL_HANDLE)
 		return false;
@@ -805,7 +882,12 @@ bool StateTracker::UpdatePipeline()
 	// Grab a new pipeline object, this can fail
 	if (m_dstalpha_mode != PIXEL_SHADER_RENDER_MODE::PSRM_ALPHA_PASS)
 	{
-		m_pipeline_object = g_object_cache->GetPipeline(m_pipeline_state);
+		// With full async shader compilation the draw is skipped until the worker threads
+		// have created the pipeline, instead of stalling the GPU thread.
+		if (g_ActiveConfig.bFullAsyncShaderCompilation)
+			m_pipeline_object = g_object_cache->GetPipelineAsync(m_pipeline_state, &m_pipeline_pending);
+		else
+			m_pipeline_object = g_object_cache->GetPipeline(m_pipeline_state);
 		if (m_pipeline_object == VK_NULL_HANDLE)
 			return false;
 	}
@@ -841,46 +923,27 @@ bool StateTracker::UpdateDescriptorSet()
 	std::array<VkWriteDescriptorSet, MAX_DESCRIPTOR_WRITES> writes;
 	u32 num_writes = 0;
 
+	// Sets with the same contents are reused within the command buffer, only new
+	// combinations are allocated and written.
 	if (m_dirty_flags & (DIRTY_FLAG_VS_UBO | DIRTY_FLAG_GS_UBO | DIRTY_FLAG_PS_UBO) ||
 		m_descriptor_sets[DESCRIPTOR_SET_UNIFORM_BUFFERS] == VK_NULL_HANDLE)
 	{
-		VkDescriptorSetLayout layout =
-			g_object_cache->GetDescriptorSetLayout(DESCRIPTOR_SET_UNIFORM_BUFFERS);
-		VkDescriptorSet set = g_command_buffer_mgr->AllocateDescriptorSet(layout);
-		if (set == VK_NULL_HANDLE)
-			return false;
-
-		for (size_t i = 0; i < NUM_UBO_DESCRIPTOR_SET_BINDINGS; i++)
+		VkDescriptorSet set;
+		auto iter = m_uniform_buffer_sets.find(m_bindings.uniform_buffer_bindings);
+		if (iter != m_uniform_buffer_sets.end())
 		{
-			writes[num_writes++] = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-				nullptr,
-				set,
-				static_cast<uint32_t>(i),
-				0,
-				1,
-				VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
-				nullptr,
-				&m_bindings.uniform_buffer_bindings[i],
-				nullptr };
+			set = iter->second;
+			INCSTAT(stats.thisFrame.numDescriptorSetsReused);
 		}
-
-		m_descriptor_sets[DESCRIPTOR_SET_UNIFORM_BUFFERS] = set;
-		m_dirty_flags |= DIRTY_FLAG_DESCRIPTOR_SET_BINDING;
-	}
-
-	if (m_dirty_flags & DIRTY_FLAG_PS_SAMPLERS ||
-		m_descriptor_sets[DESCRIPTOR_SET_PIXEL_SHADER_SAMPLERS] == VK_NULL_HANDLE)
-	{
-		VkDescriptorSetLayout layout =
-			g_object_cache->GetDescriptorSetLayout(DESCRIPTOR_SET_PIXEL_SHADER_SAMPLERS);
-		VkDescriptorSet set = g_command_buffer_mgr->AllocateDescriptorSet(layout);
-		if (set == VK_NULL_HANDLE)
-			return false;
-
-		for (size_t i = 0; i < NUM_PIXEL_SHADER_SAMPLERS; i++)
+		else
 		{
-			const VkDescriptorImageInfo& info = m_bindings.ps_samplers[i];
-			if (info.imageView != VK_NULL_HANDLE && info.sampler != VK_NULL_HANDLE)
+			VkDescriptorSetLayout layout =
+				g_object_cache->GetDescriptorSetLayout(DESCRIPTOR_SET_UNIFORM_BUFFERS);
+			set = g_command_buffer_mgr->AllocateDescriptorSet(layout);
+			if (set == VK_NULL_HANDLE)
+				return false;
+
+			for (size_t i = 0; i < NUM_UBO_DESCRIPTOR_SET_BINDINGS; i++)
 			{
 				writes[num_writes++] = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
 					nullptr,
@@ -888,40 +951,109 @@ bool StateTracker::UpdateDescriptorSet()
 					static_cast<uint32_t>(i),
 					0,
 					1,
-					VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-					&info,
+					VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
 					nullptr,
+					&m_bindings.uniform_buffer_bindings[i],
 					nullptr };
 			}
+
+			m_uniform_buffer_sets.emplace(m_bindings.uniform_buffer_bindings, set);
+			INCSTAT(stats.thisFrame.numDescriptorSetsAllocated);
+		}
+
+		if (m_descriptor_sets[DESCRIPTOR_SET_UNIFORM_BUFFERS] != set)
+		{
+			m_descriptor_sets[DESCRIPTOR_SET_UNIFORM_BUFFERS] = set;
+			m_dirty_flags |= DIRTY_FLAG_DESCRIPTOR_SET_BINDING;
+		}
+	}
+
+	if (m_dirty_flags & DIRTY_FLAG_PS_SAMPLERS ||
+		m_descriptor_sets[DESCRIPTOR_SET_PIXEL_SHADER_SAMPLERS] == VK_NULL_HANDLE)
+	{
+		VkDescriptorSet set;
+		auto iter = m_ps_sampler_sets.find(m_bindings.ps_samplers);
+		if (iter != m_ps_sampler_sets.end())
+		{
+			set = iter->second;
+			INCSTAT(stats.thisFrame.numDescriptorSetsReused);
+		}
+		else
+		{
+			VkDescriptorSetLayout layout =
+				g_object_cache->GetDescriptorSetLayout(DESCRIPTOR_SET_PIXEL_SHADER_SAMPLERS);
+			set = g_command_buffer_mgr->AllocateDescriptorSet(layout);
+			if (set == VK_NULL_HANDLE)
+				return false;
+
+			for (size_t i = 0; i < NUM_PIXEL_SHADER_SAMPLERS; i++)
+			{
+				const VkDescriptorImageInfo& info = m_bindings.ps_samplers[i];
+				if (info.imageView != VK_NULL_HANDLE && info.sampler != VK_NULL_HANDLE)
+				{
+					writes[num_writes++] = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+						nullptr,
+						set,
+						static_cast<uint32_t>(i),
+						0,
+						1,
+						VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+						&info,
+						nullptr,
+						nullptr };
+				}
+			}
+
+			m_ps_sampler_sets.emplace(m_bindings.ps_samplers, set);
+			INCSTAT(stats.thisFrame.numDescriptorSetsAllocated);
 		}
 
-		m_descriptor_sets[DESCRIPTOR_SET_PIXEL_SHADER_SAMPLERS] = set;
-		m_dirty_flags |= DIRTY_FLAG_DESCRIPTOR_SET_BINDING;
+		if (m_descriptor_sets[DESCRIPTOR_SET_PIXEL_SHADER_SAMPLERS] != set)
+		{
+			m_descriptor_sets[DESCRIPTOR_SET_PIXEL_SHADER_SAMPLERS] = set;
+			m_dirty_flags |= DIRTY_FLAG_DESCRIPTOR_SET_BINDING;
+		}
 	}
 
 	if (m_bbox_enabled &&
 		(m_dirty_flags & DIRTY_FLAG_PS_SSBO ||
 			m_descriptor_sets[DESCRIPTOR_SET_SHADER_STORAGE_BUFFERS] == VK_NULL_HANDLE))
 	{
-		VkDescriptorSetLayout layout =
-			g_object_cache->GetDescriptorSetLayout(DESCRIPTOR_SET_SHADER_STORAGE_BUFFERS);
-		VkDescriptorSet set = g_command_buffer_mgr->AllocateDescriptorSet(layout);
-		if (set == VK_NULL_HANDLE)
-			return false;
+		VkDescriptorSet set;
+		auto iter = m_ps_ssbo_sets.find(m_bindings.ps_ssbo);
+		if (iter != m_ps_ssbo_sets.end())
+		{
+			set = iter->second;
+			INCSTAT(stats.thisFrame.numDescriptorSetsReused);
+		}
+		else
+		{
+			VkDescriptorSetLayout layout =
+				g_object_cache->GetDescriptorSetLayout(DESCRIPTOR_SET_SHADER_STORAGE_BUFFERS);
+			set = g_command_buffer_mgr->AllocateDescriptorSet(layout);
+			if (set == VK_NULL_HANDLE)
+				return false;
+
+			writes[num_writes++] = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+				nullptr,
+				set,
+				0,
+				0,
+				1,
+				VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+				nullptr,
+				&m_bindings.ps_ssbo,
+				nullptr };
 
-		writes[num_writes++] = { VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-			nullptr,
-			set,
-			0,
-			0,
-			1,
-			VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
-			nullptr,
-			&m_bindings.ps_ssbo,
-			nullptr };
+			m_ps_ssbo_sets.emplace(m_bindings.ps_ssbo, set);
+			INCSTAT(stats.thisFrame.numDescriptorSetsAllocated);
+		}
 
-		m_descriptor_sets[DESCRIPTOR_SET_SHADER_STORAGE_BUFFERS] = set;
-		m_dirty_flags |= DIRTY_FLAG_DESCRIPTOR_SET_BINDING;
+		if (m_descriptor_sets[DESCRIPTOR_SET_SHADER_STORAGE_BUFFERS] != set)
+		{
+			m_descriptor_sets[DESCRIPTOR_SET_SHADER_STORAGE_BUFFERS] = set;
+			m_dirty_flags |= DIRTY_FLAG_DESCRIPTOR_SET_BINDING;
+		}
 	}
 
 	if (num_writes > 0)
@@ -930,4 +1062,56 @@ bool StateTracker::UpdateDescriptorSet()
 	return true;
 }
 
+size_t StateTracker::DescriptorSetKeyHash::operator()(const UniformBufferSetKey& key) const
+{
+	return static_cast<size_t>(
+		GetHash64(reinterpret_cast<const u8*>(key.data()), static_cast<u32>(sizeof(key)), 0));
+}
+
+size_t StateTracker::DescriptorSetKeyHash::operator()(const SamplerSetKey& key) const
+{
+	// VkDescriptorImageInfo has padding after the layout, so only the fields are hashed.
+	std::array<u64, NUM_PIXEL_SHADER_SAMPLERS * 3> values;
+	for (size_t i = 0; i < NUM_PIXEL_SHADER_SAMPLERS; i++)
+	{
+		values[i * 3 + 0] = reinterpret_cast<u64>(key[i].sampler);
+		values[i * 3 + 1] = reinterpret_cast<u64>(key[i].imageView);
+		values[i * 3 + 2] = static_cast<u64>(key[i].imageLayout);
+	}
+	return static_cast<size_t>(
+		GetHash64(reinterpret_cast<const u8*>(values.data()), static_cast<u32>(sizeof(values)), 0));
+}
+
+size_t StateTracker::DescriptorSetKeyHash::operator()(const VkDescriptorBufferInfo& key) const
+{
+	return static_cast<size_t>(
+		GetHash64(reinterpret_cast<const u8*>(&key), static_cast<u32>(sizeof(key)), 0));
+}
+
+bool StateTracker::DescriptorSetKeyEqual::operator()(const UniformBufferSetKey& lhs,
+	const UniformBufferSetKey& rhs) const
+{
+	return std::memcmp(lhs.data(), rhs.data(), sizeof(lhs)) == 0;
+}
+
+bool StateTracker::DescriptorSetKeyEqual::operator()(const SamplerSetKey& lhs,
+	const SamplerSetKey& rhs) const
+{
+	for (size_t i = 0; i < NUM_PIXEL_SHADER_SAMPLERS; i++)
+	{
+		if (lhs[i].sampler != rhs[i].sampler || lhs[i].imageView != rhs[i].imageView ||
+			lhs[i].imageLayout != rhs[i].imageLayout)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool StateTracker::DescriptorSetKeyEqual::operator()(const VkDescriptorBufferInfo& lhs,
+	const VkDescriptorBufferInfo& rhs) const
+{
+	return std::memcmp(&lhs, &rhs, sizeof(lhs)) == 0;
+}
+
 }  // namespace Vulkan
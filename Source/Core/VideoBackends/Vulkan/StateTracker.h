@@ -7,10 +7,13 @@
 #include <array>
 #include <cstddef>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 #include "Common/CommonTypes.h"
 #include "VideoBackends/Vulkan/Constants.h"
 #include "VideoBackends/Vulkan/ObjectCache.h"
+#include "VideoCommon/ConstantManager.h"
 #include "VideoCommon/GeometryShaderGen.h"
 #include "VideoCommon/PixelShaderGen.h"
 #include "VideoCommon/RenderBase.h"
@@ -158,6 +161,8 @@ private:
 	PipelineInfo m_pipeline_state = {};
 	PIXEL_SHADER_RENDER_MODE m_dstalpha_mode = PIXEL_SHADER_RENDER_MODE::PSRM_DEFAULT;
 	VkPipeline m_pipeline_object = VK_NULL_HANDLE;
+	// Set while the pipeline for the current state is still being created asynchronously.
+	bool m_pipeline_pending = false;
 
 	// shader bindings
 	std::array<VkDescriptorSet, NUM_DESCRIPTOR_SETS> m_descriptor_sets = {};
@@ -174,6 +179,38 @@ private:
 	u32 m_num_active_descriptor_sets = 0;
 	size_t m_uniform_buffer_reserve_size = 0;
 
+	// Descriptor sets written in the current command buffer, looked up by their contents.
+	// Cleared by InvalidateDescriptorSets, as sets do not outlive their command buffer's pool.
+	using UniformBufferSetKey = std::array<VkDescriptorBufferInfo, NUM_UBO_DESCRIPTOR_SET_BINDINGS>;
+	using SamplerSetKey = std::array<VkDescriptorImageInfo, NUM_PIXEL_SHADER_SAMPLERS>;
+	struct DescriptorSetKeyHash
+	{
+		size_t operator()(const UniformBufferSetKey& key) const;
+		size_t operator()(const SamplerSetKey& key) const;
+		size_t operator()(const VkDescriptorBufferInfo& key) const;
+	};
+	struct DescriptorSetKeyEqual
+	{
+		bool operator()(const UniformBufferSetKey& lhs, const UniformBufferSetKey& rhs) const;
+		bool operator()(const SamplerSetKey& lhs, const SamplerSetKey& rhs) const;
+		bool operator()(const VkDescriptorBufferInfo& lhs, const VkDescriptorBufferInfo& rhs) const;
+	};
+	template <typename T>
+	using DescriptorSetCache =
+		std::unordered_map<T, VkDescriptorSet, DescriptorSetKeyHash, DescriptorSetKeyEqual>;
+
+	DescriptorSetCache<UniformBufferSetKey> m_uniform_buffer_sets;
+	DescriptorSetCache<SamplerSetKey> m_ps_sampler_sets;
+	DescriptorSetCache<VkDescriptorBufferInfo> m_ps_ssbo_sets;
+
+	// What is currently bound to the command buffer, so repeated binds can be skipped.
+	// Forgotten by SetPendingRebind, since other draws may have bound their own objects.
+	VkPipeline m_bound_pipeline = VK_NULL_HANDLE;
+	VkPipelineLayout m_bound_pipeline_layout = VK_NULL_HANDLE;
+	std::array<VkDescriptorSet, NUM_DESCRIPTOR_SETS> m_bound_descriptor_sets = {};
+	std::array<uint32_t, NUM_UBO_DESCRIPTOR_SET_BINDINGS> m_bound_uniform_buffer_offsets = {};
+	u32 m_bound_num_descriptor_sets = 0;
+
 	// rasterization
 	VkViewport m_viewport = { 0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f };
 	VkRect2D m_scissor = { { 0, 0 },{ 1, 1 } };
@@ -181,6 +218,11 @@ private:
 	// uniform buffers
 	std::unique_ptr<StreamBuffer> m_uniform_stream_buffer;
 
+	// Constants of the last upload of each stage, draws that set the same values keep its offset.
+	std::vector<float> m_uploaded_vs_constants;
+	std::vector<float> m_uploaded_ps_constants;
+	GeometryShaderConstants m_uploaded_gs_constants = {};
+
 	VkFramebuffer m_framebuffer = VK_NULL_HANDLE;
 	VkRenderPass m_load_render_pass = VK_NULL_HANDLE;
 	VkRenderPass m_clear_render_pass = VK_NULL_HANDLE;
@@ -19,19 +19,21 @@ class ObjectCache;
 class SwapChain
 {
 public:
-	SwapChain(void* native_handle, VkSurfaceKHR surface, bool vsync);
+	SwapChain(void* native_handle, VkSurfaceKHR surface, bool vsync, bool low_latency);
 	~SwapChain();
 
 	// Creates a vulkan-renderable surface for the specified window handle.
 	static VkSurfaceKHR CreateVulkanSurface(VkInstance instance, void* hwnd);
 
 	// Create a new swap chain from a pre-existing surface.
-	static std::unique_ptr<SwapChain> Create(void* native_handle, VkSurfaceKHR surface, bool vsync);
+	static std::unique_ptr<SwapChain> Create(void* native_handle, VkSurfaceKHR surface, bool vsync,
+		bool low_latency);
 
 	void* GetNativeHandle() const { return m_native_handle; }
 	VkSurfaceKHR GetSurface() const { return m_surface; }
 	VkSurfaceFormatKHR GetSurfaceFormat() const { return m_surface_format; }
 	bool IsVSyncEnabled() const { return m_vsync_enabled; }
+	bool IsLowLatencyEnabled() const { return m_low_latency_enabled; }
 	VkSwapchainKHR GetSwapChain() const { return m_swap_chain; }
 	VkRenderPass GetRenderPass() const { return m_render_pass; }
 	u32 GetWidth() const { return m_width; }
@@ -58,6 +60,10 @@ public:
 	// Change vsync enabled state. This may fail as it causes a swapchain recreation.
 	bool SetVSync(bool enabled);
 
+	// Low latency prefers mailbox over fifo with vsync and queues fewer images.
+	// This may fail as it causes a swapchain recreation.
+	bool SetLowLatency(bool enabled);
+
 private:
 	bool SelectSurfaceFormat();
 	bool SelectPresentMode();
@@ -85,6 +91,7 @@ private:
 	VkSurfaceFormatKHR m_surface_format = {};
 	VkPresentModeKHR m_present_mode = VK_PRESENT_MODE_RANGE_SIZE_KHR;
 	bool m_vsync_enabled;
+	bool m_low_latency_enabled;
 
 	VkSwapchainKHR m_swap_chain = VK_NULL_HANDLE;
 	std::vector<SwapChainImage> m_swap_chain_images;
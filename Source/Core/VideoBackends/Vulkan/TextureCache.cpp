@@ -14,6 +14,7 @@
 #include "Common/Logging/Log.h"
 #include "Common/MsgHandler.h"
 
+#include "VideoBackends/Vulkan/CSTextureDecoder.h"
 #include "VideoBackends/Vulkan/CommandBufferManager.h"
 #include "VideoBackends/Vulkan/FramebufferManager.h"
 #include "VideoBackends/Vulkan/ObjectCache.h"
@@ -28,6 +29,7 @@
 #include "VideoBackends/Vulkan/VulkanContext.h"
 
 #include "VideoCommon/ImageWrite.h"
+#include "VideoCommon/TextureUtil.h"
 
 namespace Vulkan
 {
@@ -62,6 +64,13 @@ bool TextureCache::Initialize()
 		return false;
 	}
 
+	if (g_vulkan_context->HasTransferQueue())
+	{
+		m_transfer_upload_buffer =
+			StreamBuffer::Create(VK_BUFFER_USAGE_TRANSFER_SRC_BIT, INITIAL_TEXTURE_UPLOAD_BUFFER_SIZE,
+				MAXIMUM_TEXTURE_UPLOAD_BUFFER_SIZE);
+	}
+
 	if (!CreateRenderPasses())
 	{
 		PanicAlert("Failed to create copy render pass");
@@ -82,6 +91,17 @@ bool TextureCache::Initialize()
 		return false;
 	}
 
+	if (g_ActiveConfig.backend_info.bSupportsComputeTextureDecoding)
+	{
+		// Not fatal, textures are decoded on the CPU without it.
+		m_cs_texture_decoder = std::make_unique<CSTextureDecoder>();
+		if (!m_cs_texture_decoder->Initialize())
+		{
+			ERROR_LOG(VIDEO, "Failed to initialize compute shader texture decoder");
+			m_cs_texture_decoder.reset();
+		}
+	}
+
 	if (!CompileShaders())
 	{
 		PanicAlert("Failed to compile one or more shaders");
@@ -162,14 +182,24 @@ void TextureCache::CopyEFB(u8* dst, u32 format, u32 native_width, u32 bytes_per_
 
 	m_texture_encoder->EncodeTextureToRam(src_texture->GetView(), dst, format, native_width,
 		bytes_per_row, num_blocks_y, memory_stride, src_format,
-		is_intensity, scale_by_half, src_rect);
+		is_intensity, scale_by_half, src_rect, g_ActiveConfig.bDeferEFBCopies);
 
 	// Transition back to original state
 	src_texture->TransitionToLayout(g_command_buffer_mgr->GetCurrentCommandBuffer(), original_layout);
 }
 
+void TextureCache::ReadbackDeferredEFBCopies()
+{
+	m_texture_encoder->ReadbackDeferredCopies();
+}
+
 PC_TexFormat TextureCache::GetNativeTextureFormat(const s32 texformat, const TlutFormat tlutfmt, u32 width, u32 height)
 {
+	if (m_cs_texture_decoder && g_ActiveConfig.bEnableComputeTextureDecoding &&
+		m_cs_texture_decoder->FormatSupported(texformat))
+	{
+		return PC_TEX_FMT_RGBA32;
+	}
 	const bool compressed_supported = ((width & 3) == 0) && ((height & 3) == 0);
 	PC_TexFormat pcfmt = GetPC_TexFormat(texformat, tlutfmt, compressed_supported);
 	pcfmt = !g_ActiveConfig.backend_info.bSupportedFormats[pcfmt] ? PC_TEX_FMT_RGBA32 : pcfmt;
@@ -267,7 +297,7 @@ void TextureCache::ScaleTextureRectangle(TCacheEntry* dst_texture,
 
 TextureCacheBase::TCacheEntryBase* TextureCache::CreateTexture(const TCacheEntryConfig& config)
 {
-	static const VkFormat PC_TexFormat_To_VkFormat[12]
+	static const VkFormat PC_TexFormat_To_VkFormat[14]
 	{
 		VK_FORMAT_R8G8B8A8_UNORM,//PC_TEX_FMT_NONE
 		VK_FORMAT_R8G8B8A8_UNORM,//PC_TEX_FMT_BGRA32
@@ -281,12 +311,17 @@ TextureCacheBase::TCacheEntryBase* TextureCache::CreateTexture(const TCacheEntry
 		VK_FORMAT_BC2_UNORM_BLOCK,//PC_TEX_FMT_DXT3
 		VK_FORMAT_BC3_UNORM_BLOCK,//PC_TEX_FMT_DXT5
 		VK_FORMAT_R32_SFLOAT,//PC_TEX_FMT_R32
+		VK_FORMAT_BC5_UNORM_BLOCK,//PC_TEX_FMT_BC5
+		VK_FORMAT_BC7_UNORM_BLOCK,//PC_TEX_FMT_BC7
 	};
 	// Determine image usage, we need to flag as an attachment if it can be used as a rendertarget.
 	VkImageUsageFlags usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT |
 		VK_IMAGE_USAGE_SAMPLED_BIT;
 	if (config.rendertarget)
 		usage |= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+	// The compute shader decoder stores directly into the texture.
+	if (m_cs_texture_decoder && PC_TexFormat_To_VkFormat[config.pcformat] == VK_FORMAT_R8G8B8A8_UNORM)
+		usage |= VK_IMAGE_USAGE_STORAGE_BIT;
 
 	// Allocate texture object
 	std::unique_ptr<Texture2D> texture = Texture2D::Create(
@@ -337,7 +372,7 @@ TextureCacheBase::TCacheEntryBase* TextureCache::CreateTexture(const TCacheEntry
 			VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_VIEW_TYPE_2D_ARRAY, VK_IMAGE_TILING_OPTIMAL, usage);
 	}
 	TCacheEntry* entry = new TCacheEntry(config, std::move(texture), std::move(nrmtexture), framebuffer);
-	entry->compressed = config.pcformat >= PC_TEX_FMT_DXT1 && config.pcformat < PC_TEX_FMT_R32;
+	entry->compressed = TextureUtil::IsBlockCompressed(config.pcformat);
 	return entry;
 }
 
@@ -475,6 +510,37 @@ void TextureCache::LoadData(Texture2D* dst, const u8* src, u32 width, u32 height
 		block_H = std::max(1u, (block_H + 3) >> 2);
 		block_stride = std::max(1u, (block_stride + 3) >> 2);
 	}
+	// Does this texture data fit within the streaming buffer?
+	u32 upload_width = block_W;
+	u32 upload_pitch = upload_width * block_size;
+	u32 upload_size = upload_pitch * block_H;
+	u32 upload_alignment = static_cast<u32>(g_vulkan_context->GetBufferImageGranularity());
+	u32 source_pitch = block_stride * block_size;
+	const bool use_stream_buffer =
+		(upload_size + upload_alignment) <= STAGING_TEXTURE_UPLOAD_THRESHOLD &&
+		(upload_size + upload_alignment) <= MAXIMUM_TEXTURE_UPLOAD_BUFFER_SIZE;
+
+	// Large uploads of whole levels of textures the GPU hasn't used yet can go to the transfer
+	// queue. Those never had their ownership taken by the graphics queue, and the draws that follow
+	// wait for the copies only where they sample the texture. The transfer queue has its own
+	// streaming buffer, no other queue family ever reads it.
+	VkCommandBuffer command_buffer = VK_NULL_HANDLE;
+	StreamBuffer* upload_buffer = m_texture_upload_buffer.get();
+	if (m_transfer_upload_buffer && upload_size >= ASYNC_TEXTURE_UPLOAD_THRESHOLD &&
+		dst->GetLayout() == VK_IMAGE_LAYOUT_UNDEFINED &&
+		width == std::max(1u, dst->GetWidth() >> level) &&
+		height == std::max(1u, dst->GetHeight() >> level) &&
+		(!use_stream_buffer ||
+			m_transfer_upload_buffer->ReserveMemory(upload_size, upload_alignment, true, true, false)))
+	{
+		command_buffer = g_command_buffer_mgr->GetCurrentTransferCommandBuffer(upload_size);
+		if (command_buffer != VK_NULL_HANDLE)
+			upload_buffer = m_transfer_upload_buffer.get();
+	}
+	const bool use_transfer_queue = command_buffer != VK_NULL_HANDLE;
+	if (!use_transfer_queue)
+		command_buffer = g_command_buffer_mgr->GetCurrentInitCommandBuffer();
+
 	// We don't care about the existing contents of the texture, so we set the image layout to
 	// VK_IMAGE_LAYOUT_UNDEFINED here. However, if this texture is being re-used from the texture
 	// pool, it may still be in use. We assume that it's not, as non-efb-copy textures are only
@@ -493,29 +559,23 @@ void TextureCache::LoadData(Texture2D* dst, const u8* src, u32 width, u32 height
 		dst->GetImage(),                   // VkImage                    image
 		{ VK_IMAGE_ASPECT_COLOR_BIT, level, 1, 0, 1 },  // VkImageSubresourceRange    subresourceRange
 	};
-	vkCmdPipelineBarrier(g_command_buffer_mgr->GetCurrentInitCommandBuffer(),
+	vkCmdPipelineBarrier(command_buffer,
 		VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0,
 		nullptr, 0, nullptr, 1, &barrier);
 
-	// Does this texture data fit within the streaming buffer?
-	u32 upload_width = block_W;
-	u32 upload_pitch = upload_width * block_size;
-	u32 upload_size = upload_pitch * block_H;
-	u32 upload_alignment = static_cast<u32>(g_vulkan_context->GetBufferImageGranularity());
-	u32 source_pitch = block_stride * block_size;
-	if ((upload_size + upload_alignment) <= STAGING_TEXTURE_UPLOAD_THRESHOLD &&
-		(upload_size + upload_alignment) <= MAXIMUM_TEXTURE_UPLOAD_BUFFER_SIZE)
+	if (use_stream_buffer)
 	{
 		// Assume tightly packed rows, with no padding as the buffer source.
-		StreamBuffer* upload_buffer = m_texture_upload_buffer.get();
-
 		// Allocate memory from the streaming buffer for the texture data.
-		if (!upload_buffer->ReserveMemory(upload_size, g_vulkan_context->GetBufferImageGranularity()))
+		if (!use_transfer_queue &&
+			!upload_buffer->ReserveMemory(upload_size, g_vulkan_context->GetBufferImageGranularity()))
 		{
 			// Execute the command buffer first.
 			WARN_LOG(VIDEO, "Executing command list while waiting for space in texture upload buffer");
 			Util::ExecuteCurrentCommandsAndRestoreState(false);
 
+			command_buffer = g_command_buffer_mgr->GetCurrentInitCommandBuffer();
+
 			// Try allocating again. This may cause a fence wait.
 			if (!upload_buffer->ReserveMemory(upload_size, g_vulkan_context->GetBufferImageGranularity()))
 				PanicAlert("Failed to allocate space in texture upload buffer");
@@ -555,7 +615,7 @@ void TextureCache::LoadData(Texture2D* dst, const u8* src, u32 width, u32 height
 			{ 0, 0, 0 },                                 // VkOffset3D                  imageOffset
 			{ width, height, 1 }                         // VkExtent3D                  imageExtent
 		};
-		vkCmdCopyBufferToImage(g_command_buffer_mgr->GetCurrentInitCommandBuffer(), image_upload_buffer,
+		vkCmdCopyBufferToImage(command_buffer, image_upload_buffer,
 			dst->GetImage(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1,
 			&image_copy);
 	}
@@ -573,8 +633,8 @@ void TextureCache::LoadData(Texture2D* dst, const u8* src, u32 width, u32 height
 		}
 
 		// Copy data to staging texture first, then to the "real" texture.
-		staging_texture->WriteTexels(0, 0, width, height, TextureCache::temp, source_pitch);
-		staging_texture->CopyToImage(g_command_buffer_mgr->GetCurrentInitCommandBuffer(),
+		staging_texture->WriteTexels(0, 0, width, height, src, source_pitch);
+		staging_texture->CopyToImage(command_buffer,
 			dst->GetImage(), VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, width,
 			height, level, 0);
 	}
@@ -584,9 +644,30 @@ void TextureCache::LoadData(Texture2D* dst, const u8* src, u32 width, u32 height
 	barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
 	barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
 	barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-	vkCmdPipelineBarrier(g_command_buffer_mgr->GetCurrentInitCommandBuffer(),
-		VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0, 0,
-		nullptr, 0, nullptr, 1, &barrier);
+	if (use_transfer_queue)
+	{
+		// Release the level to the graphics queue, then acquire it on the init command buffer. The
+		// acquire runs at the stages the graphics queue waits for the transfers at.
+		const VkPipelineStageFlags sampling_stages =
+			VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+		barrier.srcQueueFamilyIndex = g_vulkan_context->GetTransferQueueFamilyIndex();
+		barrier.dstQueueFamilyIndex = g_vulkan_context->GetGraphicsQueueFamilyIndex();
+		barrier.dstAccessMask = 0;
+		vkCmdPipelineBarrier(command_buffer,
+			VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0,
+			nullptr, 0, nullptr, 1, &barrier);
+
+		barrier.srcAccessMask = 0;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		vkCmdPipelineBarrier(g_command_buffer_mgr->GetCurrentInitCommandBuffer(),
+			sampling_stages, sampling_stages, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+	}
+	else
+	{
+		vkCmdPipelineBarrier(command_buffer,
+			VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0, 0,
+			nullptr, 0, nullptr, 1, &barrier);
+	}
 	dst->OverrideImageLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
 }
 
@@ -626,6 +707,13 @@ void TextureCache::TCacheEntry::LoadMaterialMap(const u8* src, u32 width, u32 he
 void TextureCache::TCacheEntry::Load(const u8* src, u32 width, u32 height, u32 expandedWidth,
 	u32 expandedHeight, const s32 texformat, const u32 tlutaddr, const TlutFormat tlutfmt, u32 level)
 {
+	CSTextureDecoder* cs_decoder = TextureCache::GetInstance()->m_cs_texture_decoder.get();
+	if (cs_decoder && !is_scaled && g_ActiveConfig.bEnableComputeTextureDecoding &&
+		cs_decoder->Decode(m_texture.get(), src, width, height, expandedWidth, expandedHeight,
+			texformat, tlutaddr, tlutfmt, level))
+	{
+		return;
+	}
 	TexDecoder_Decode(
 		TextureCache::temp,
 		src,
@@ -639,6 +727,8 @@ void TextureCache::TCacheEntry::Load(const u8* src, u32 width, u32 height, u32 e
 	u8* data = TextureCache::temp;
 	if (is_scaled)
 	{
+		if (ScaleOnGPU(data, width, height, expandedWidth, level))
+			return;
 		data = (u8*)TextureCache::GetInstance()->m_scaler->Scale((u32*)data, expandedWidth, height);
 		width *= g_ActiveConfig.iTexScalingFactor;
 		height *= g_ActiveConfig.iTexScalingFactor;
@@ -659,6 +749,8 @@ void TextureCache::TCacheEntry::LoadFromTmem(const u8* ar_src, const u8* gb_src,
 	u8* data = TextureCache::temp;
 	if (is_scaled)
 	{
+		if (ScaleOnGPU(data, width, height, expanded_width, level))
+			return;
 		data = (u8*)TextureCache::GetInstance()->m_scaler->Scale((u32*)data, expanded_width, height);
 		width *= g_ActiveConfig.iTexScalingFactor;
 		height *= g_ActiveConfig.iTexScalingFactor;
@@ -667,6 +759,17 @@ void TextureCache::TCacheEntry::LoadFromTmem(const u8* ar_src, const u8* gb_src,
 	TextureCache::GetInstance()->LoadData(m_texture.get(), data, width, height, expanded_width, level);
 }
 
+bool TextureCache::TCacheEntry::ScaleOnGPU(const u8* data, u32 width, u32 height, u32 stride,
+	u32 level)
+{
+	// Deposterization is only implemented by the CPU scaler.
+	CSTextureDecoder* cs_decoder = TextureCache::GetInstance()->m_cs_texture_decoder.get();
+	return cs_decoder && g_ActiveConfig.bEnableComputeTextureDecoding &&
+		!g_ActiveConfig.bTexDeposterize && PC_TEX_FMT_RGBA32 == config.pcformat &&
+		cs_decoder->Scale(m_texture.get(), data, width, height, stride,
+			g_ActiveConfig.iTexScalingType, g_ActiveConfig.iTexScalingFactor, level);
+}
+
 void TextureCache::TCacheEntry::FromRenderTarget(u8* dst, PEControl::PixelFormat src_format,
 	const EFBRectangle& src_rect, bool scale_by_half,
 	unsigned int cbufid, const float* colmat, u32 width, u32 height)
@@ -799,11 +902,11 @@ bool TextureCache::TCacheEntry::Save(const std::string& filename, u32 level)
 	// Write texture out to file.
 	// It's okay to throw this texture away immediately, since we're done with it, and
 	// we blocked until the copy completed on the GPU anyway.
-	bool result = TextureToPng(reinterpret_cast<u8*>(staging_texture->GetMapPointer()),
+	TextureToPngAsync(reinterpret_cast<u8*>(staging_texture->GetMapPointer()),
 		staging_texture->GetRowStride(), filename, level_width, level_height);
 
 	staging_texture->Unmap();
-	return result;
+	return true;
 }
 
 bool TextureCache::CompileShaders()
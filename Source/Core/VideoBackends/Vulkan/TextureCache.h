@@ -13,6 +13,7 @@
 
 namespace Vulkan
 {
+class CSTextureDecoder;
 class PaletteTextureConverter;
 class StateTracker;
 class Texture2D;
@@ -55,6 +56,9 @@ public:
 		};
 		bool compressed;
 	private:
+		// Upscales the decoded RGBA8 texels with the compute scaling shaders when possible.
+		bool ScaleOnGPU(const u8* data, u32 width, u32 height, u32 stride, u32 level);
+
 		std::unique_ptr<Texture2D> m_texture;
 		std::unique_ptr<Texture2D> m_nrmtexture;
 
@@ -80,6 +84,7 @@ public:
 	void CopyEFB(u8* dst, u32 format, u32 native_width, u32 bytes_per_row, u32 num_blocks_y,
 		u32 memory_stride, PEControl::PixelFormat src_format, const EFBRectangle& src_rect,
 		bool is_intensity, bool scale_by_half) override;
+	void ReadbackDeferredEFBCopies() override;
 
 	void CopyRectangleFromTexture(TCacheEntry* dst_texture, const MathUtil::Rectangle<int>& dst_rect,
 		Texture2D* src_texture, const MathUtil::Rectangle<int>& src_rect);
@@ -108,11 +113,16 @@ private:
 	VkRenderPass m_update_render_pass = VK_NULL_HANDLE;
 
 	std::unique_ptr<StreamBuffer> m_texture_upload_buffer;
+	// Only with a transfer queue, for the uploads it executes
+	std::unique_ptr<StreamBuffer> m_transfer_upload_buffer;
 
 	std::unique_ptr<TextureEncoder> m_texture_encoder;
 
 	std::unique_ptr<PaletteTextureConverter> m_palette_texture_converter;
 
+	// Only created when the device supports compute texture decoding.
+	std::unique_ptr<CSTextureDecoder> m_cs_texture_decoder;
+
 	std::unique_ptr<TextureScaler> m_scaler;
 
 	VkShaderModule m_copy_shader = VK_NULL_HANDLE;
@@ -77,7 +77,7 @@ void TextureEncoder::EncodeTextureToRam(VkImageView src_texture, u8* dest_ptr, u
 	u32 native_width, u32 bytes_per_row, u32 num_blocks_y,
 	u32 memory_stride, PEControl::PixelFormat src_format,
 	bool is_intensity, int scale_by_half,
-	const EFBRectangle& src_rect)
+	const EFBRectangle& src_rect, bool deferred)
 {
 	if (m_texture_encoding_shaders[format] == VK_NULL_HANDLE)
 	{
@@ -116,6 +116,23 @@ void TextureEncoder::EncodeTextureToRam(VkImageView src_texture, u8* dest_ptr, u
 
 	// Transition the image before copying
 	m_encoding_texture->OverrideImageLayout(VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+
+	StagingTexture2D* deferred_texture =
+		deferred ? GetDeferredDownloadTexture(render_width, render_height) : nullptr;
+	if (deferred_texture)
+	{
+		deferred_texture->CopyFromImage(g_command_buffer_mgr->GetCurrentCommandBuffer(),
+			m_encoding_texture->GetImage(), VK_IMAGE_ASPECT_COLOR_BIT, 0, 0,
+			render_width, render_height, 0, 0);
+
+		// The next encode can't render over the texture before the copy has read it.
+		m_encoding_texture->TransitionToLayout(g_command_buffer_mgr->GetCurrentCommandBuffer(),
+			VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+		m_deferred_copies.push_back({ dest_ptr, render_width, render_height, memory_stride,
+			g_command_buffer_mgr->GetCurrentCommandBufferFence() });
+		return;
+	}
+
 	m_download_texture->CopyFromImage(g_command_buffer_mgr->GetCurrentCommandBuffer(),
 		m_encoding_texture->GetImage(), VK_IMAGE_ASPECT_COLOR_BIT, 0, 0,
 		render_width, render_height, 0, 0);
@@ -129,6 +146,59 @@ void TextureEncoder::EncodeTextureToRam(VkImageView src_texture, u8* dest_ptr, u
 	m_download_texture->ReadTexels(0, 0, render_width, render_height, dest_ptr, memory_stride);
 }
 
+void TextureEncoder::ReadbackDeferredCopies()
+{
+	if (m_deferred_copies.empty())
+		return;
+
+	// One wait for all of them, instead of one per copy. Copies made before the last
+	// submission only wait for their own command buffer.
+	if (m_deferred_copies.back().fence == g_command_buffer_mgr->GetCurrentCommandBufferFence())
+	{
+		StateTracker::GetInstance()->EndRenderPass();
+		StateTracker::GetInstance()->OnReadback();
+		g_command_buffer_mgr->ExecuteCommandBuffer(false, true);
+		StateTracker::GetInstance()->InvalidateDescriptorSets();
+		StateTracker::GetInstance()->SetPendingRebind();
+	}
+
+	for (size_t i = 0; i < m_deferred_copies.size(); i++)
+	{
+		const DeferredCopy& copy = m_deferred_copies[i];
+		g_command_buffer_mgr->WaitForFence(copy.fence);
+		m_deferred_download_textures[i]->ReadTexels(0, 0, copy.width, copy.height, copy.dest_ptr,
+			copy.memory_stride);
+	}
+	m_deferred_copies.clear();
+}
+
+StagingTexture2D* TextureEncoder::GetDeferredDownloadTexture(u32 width, u32 height)
+{
+	// The caller flushes before the ring is full
+	const size_t index = m_deferred_copies.size();
+	if (index >= m_deferred_download_textures.size())
+		return nullptr;
+
+	std::unique_ptr<StagingTexture2D>& texture = m_deferred_download_textures[index];
+	if (!texture || texture->GetWidth() < width || texture->GetHeight() < height)
+	{
+		// Grow the slot, most games copy the same sizes every frame
+		if (texture)
+		{
+			width = std::max(width, texture->GetWidth());
+			height = std::max(height, texture->GetHeight());
+		}
+		texture = StagingTexture2D::Create(STAGING_BUFFER_TYPE_READBACK, width, height,
+			ENCODING_TEXTURE_FORMAT);
+		if (!texture || !texture->Map())
+		{
+			texture.reset();
+			return nullptr;
+		}
+	}
+	return texture.get();
+}
+
 bool TextureEncoder::CompileShaders()
 {
 	// Texture encoding shaders
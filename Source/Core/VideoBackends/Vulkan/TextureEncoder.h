@@ -6,10 +6,12 @@
 
 #include <array>
 #include <memory>
+#include <vector>
 
 #include "Common/CommonTypes.h"
 #include "VideoBackends/Vulkan/VulkanLoader.h"
 #include "VideoCommon/BPMemory.h"
+#include "VideoCommon/TextureCacheBase.h"
 #include "VideoCommon/VideoCommon.h"
 
 namespace Vulkan
@@ -31,11 +33,16 @@ public:
 
 	// Uses an encoding shader to copy src_texture to dest_ptr.
 	// Assumes that no render pass is currently in progress.
-	// WARNING: Executes the current command buffer.
+	// WARNING: Executes the current command buffer, unless deferred is set. Deferred copies go to
+	// a ring of staging textures instead and reach dest_ptr in ReadbackDeferredCopies.
 	void EncodeTextureToRam(VkImageView src_texture, u8* dest_ptr, u32 format, u32 native_width,
 		u32 bytes_per_row, u32 num_blocks_y, u32 memory_stride,
 		PEControl::PixelFormat src_format, bool is_intensity, int scale_by_half,
-		const EFBRectangle& source);
+		const EFBRectangle& source, bool deferred = false);
+
+	// Waits for the deferred copies and writes them out, in order.
+	// WARNING: Executes the current command buffer.
+	void ReadbackDeferredCopies();
 
 private:
 	// From OGL.
@@ -48,6 +55,7 @@ private:
 	bool CreateEncodingRenderPass();
 	bool CreateEncodingTexture();
 	bool CreateDownloadTexture();
+	StagingTexture2D* GetDeferredDownloadTexture(u32 width, u32 height);
 
 	std::array<VkShaderModule, NUM_TEXTURE_ENCODING_SHADERS> m_texture_encoding_shaders = {};
 
@@ -57,6 +65,20 @@ private:
 	VkFramebuffer m_encoding_texture_framebuffer = VK_NULL_HANDLE;
 
 	std::unique_ptr<StagingTexture2D> m_download_texture;
+
+	struct DeferredCopy
+	{
+		u8* dest_ptr;
+		u32 width;
+		u32 height;
+		u32 memory_stride;
+		// Of the command buffer the copy was recorded to
+		VkFence fence;
+	};
+	// Copy i of m_deferred_copies is in m_deferred_download_textures[i]
+	std::vector<DeferredCopy> m_deferred_copies;
+	std::array<std::unique_ptr<StagingTexture2D>, MAX_DEFERRED_EFB_COPIES>
+		m_deferred_download_textures;
 };
 
 }  // namespace Vulkan
@@ -275,6 +275,18 @@ VkShaderModule CompileAndCreateFragmentShader(const std::string& source_code, bo
 	return CreateShaderModule(code.data(), code.size());
 }
 
+VkShaderModule CompileAndCreateComputeShader(const std::string& source_code, bool prepend_header)
+{
+	ShaderCompiler::SPIRVCodeVector code;
+	if (!ShaderCompiler::CompileComputeShader(&code, source_code.c_str(), source_code.length(),
+		prepend_header))
+	{
+		return VK_NULL_HANDLE;
+	}
+
+	return CreateShaderModule(code.data(), code.size());
+}
+
 }  // namespace Util
 
 UtilityShaderDraw::UtilityShaderDraw(VkCommandBuffer command_buffer,
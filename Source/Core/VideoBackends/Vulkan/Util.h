@@ -65,6 +65,10 @@ VkShaderModule CompileAndCreateGeometryShader(const std::string& source_code,
 // Compile a fragment shader and create a shader module, discarding the intermediate SPIR-V.
 VkShaderModule CompileAndCreateFragmentShader(const std::string& source_code,
 	bool prepend_header = true);
+
+// Compile a compute shader and create a shader module, discarding the intermediate SPIR-V.
+VkShaderModule CompileAndCreateComputeShader(const std::string& source_code,
+	bool prepend_header = true);
 }
 
 // Utility shader vertex format
@@ -30,12 +30,12 @@ public:
 protected:
 	void PrepareDrawBuffers(u32 stride);
 	void ResetBuffer(u32 stride) override;
-	u16* GetIndexBuffer() override;
 private:
 	void vFlush(bool use_dst_alpha) override;
 
 	std::vector<u8, Common::aligned_allocator<u8, 256>> m_cpu_vertex_buffer;
-	std::vector<u16, Common::aligned_allocator<u16, 256>> m_cpu_index_buffer;
+	// 32 bit indices, see IndexGenerator::Uses32BitIndices
+	std::vector<u32, Common::aligned_allocator<u32, 256>> m_cpu_index_buffer;
 
 	std::unique_ptr<StreamBuffer> m_vertex_stream_buffer;
 	std::unique_ptr<StreamBuffer> m_index_stream_buffer;
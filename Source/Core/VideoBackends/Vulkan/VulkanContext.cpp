@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <array>
 
 #include "Common/Assert.h"
 #include "Common/CommonFuncs.h"
@@ -234,6 +235,7 @@ void VulkanContext::PopulateBackendInfo(VideoConfig* config)
 	config->backend_info.bSupportsClipControl = true;           // Assumed support.
 	config->backend_info.bSupportsMultithreading = true;        // Assumed support.
 	config->backend_info.bSupportsPostProcessing = false;       // No support yet.
+	config->backend_info.bSupportsPostProcessingCompute = false;
 	config->backend_info.bSupportsDualSourceBlend = false;      // Dependent on features.
 	config->backend_info.bSupportsGeometryShaders = false;      // Dependent on features.
 	config->backend_info.bSupportsGSInstancing = false;         // Dependent on features.
@@ -241,6 +243,11 @@ void VulkanContext::PopulateBackendInfo(VideoConfig* config)
 	config->backend_info.bSupportsSSAA = false;                 // Dependent on features.
 	config->backend_info.bSupportsDepthClamp = false;           // Dependent on features.
 	config->backend_info.bSupportsReversedDepthRange = false;   // No support yet due to driver bugs.
+	config->backend_info.bSupportsPrimitiveRestart = false;     // Triangles are drawn as lists.
+	config->backend_info.bSupports32BitIndices = true;          // Core feature.
+	config->backend_info.bSupportsDeferredEFBCopies = true;     // Staging texture ring.
+	config->backend_info.bSupportsVirtualXFBWriteBack = true;   // YUYV encoder.
+	config->backend_info.bSupportsComputeTextureDecoding = true;  // Compute is always available.
 	config->backend_info.bSupportedFormats[PC_TEX_FMT_BGRA32] = false;
 	config->backend_info.bSupportedFormats[PC_TEX_FMT_RGBA32] = true;
 	config->backend_info.bSupportedFormats[PC_TEX_FMT_I4_AS_I8] = false;
@@ -290,6 +297,10 @@ void VulkanContext::PopulateBackendInfoFeatures(VideoConfig* config, VkPhysicalD
 	// Depth clamping implies shaderClipDistance and depthClamp
 	config->backend_info.bSupportsDepthClamp =
 		(features.depthClamp == VK_TRUE && features.shaderClipDistance == VK_TRUE);
+
+	// BC5 and BC7 are only used by custom textures, which are rejected when unsupported
+	config->backend_info.bSupportedFormats[PC_TEX_FMT_BC5] = (features.textureCompressionBC == VK_TRUE);
+	config->backend_info.bSupportedFormats[PC_TEX_FMT_BC7] = (features.textureCompressionBC == VK_TRUE);
 }
 
 void VulkanContext::PopulateBackendInfoMultisampleModes(
@@ -467,6 +478,7 @@ bool VulkanContext::SelectDeviceFeatures()
 	m_device_features.occlusionQueryPrecise = available_features.occlusionQueryPrecise;
 	m_device_features.shaderClipDistance = available_features.shaderClipDistance;
 	m_device_features.depthClamp = available_features.depthClamp;
+	m_device_features.textureCompressionBC = available_features.textureCompressionBC;
 	return true;
 }
 
@@ -524,6 +536,22 @@ bool VulkanContext::CreateDevice(VkSurfaceKHR surface, bool enable_validation_la
 		ERROR_LOG(VIDEO, "Vulkan: Failed to find an acceptable graphics queue.");
 		return false;
 	}
+	m_graphics_queue_properties = queue_family_properties[m_graphics_queue_family_index];
+
+	// Find a family dedicated to transfers for texture uploads. The graphics family can transfer as
+	// well, but a second queue of it wouldn't run the copies on other hardware.
+	u32 transfer_queue_family_index = queue_family_count;
+	for (u32 i = 0; i < queue_family_count; i++)
+	{
+		const VkQueueFlags flags = queue_family_properties[i].queueFlags;
+		if ((flags & VK_QUEUE_TRANSFER_BIT) &&
+			!(flags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)) &&
+			queue_family_properties[i].queueCount > 0)
+		{
+			transfer_queue_family_index = i;
+			break;
+		}
+	}
 
 	VkDeviceCreateInfo device_info = {};
 	device_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
@@ -531,15 +559,21 @@ bool VulkanContext::CreateDevice(VkSurfaceKHR surface, bool enable_validation_la
 	device_info.flags = 0;
 
 	static constexpr float queue_priorities[] = { 1.0f };
-	VkDeviceQueueCreateInfo queue_info = {};
-	queue_info.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-	queue_info.pNext = nullptr;
-	queue_info.flags = 0;
-	queue_info.queueFamilyIndex = m_graphics_queue_family_index;
-	queue_info.queueCount = 1;
-	queue_info.pQueuePriorities = queue_priorities;
+	std::array<VkDeviceQueueCreateInfo, 2> queue_infos = {};
+	queue_infos[0].sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+	queue_infos[0].pNext = nullptr;
+	queue_infos[0].flags = 0;
+	queue_infos[0].queueFamilyIndex = m_graphics_queue_family_index;
+	queue_infos[0].queueCount = 1;
+	queue_infos[0].pQueuePriorities = queue_priorities;
 	device_info.queueCreateInfoCount = 1;
-	device_info.pQueueCreateInfos = &queue_info;
+	device_info.pQueueCreateInfos = queue_infos.data();
+	if (transfer_queue_family_index != queue_family_count)
+	{
+		queue_infos[1] = queue_infos[0];
+		queue_infos[1].queueFamilyIndex = transfer_queue_family_index;
+		device_info.queueCreateInfoCount = 2;
+	}
 
 	ExtensionList enabled_extensions;
 	if (!SelectDeviceExtensions(&enabled_extensions, (surface != VK_NULL_HANDLE),
@@ -576,8 +610,14 @@ bool VulkanContext::CreateDevice(VkSurfaceKHR surface, bool enable_validation_la
 	if (!LoadVulkanDeviceFunctions(m_device))
 		return false;
 
-	// Grab the graphics queue (only one we're using at this point).
+	// Grab the graphics queue, and the transfer queue if there is one.
 	vkGetDeviceQueue(m_device, m_graphics_queue_family_index, 0, &m_graphics_queue);
+	if (transfer_queue_family_index != queue_family_count)
+	{
+		m_transfer_queue_family_index = transfer_queue_family_index;
+		vkGetDeviceQueue(m_device, m_transfer_queue_family_index, 0, &m_transfer_queue);
+		INFO_LOG(VIDEO, "Using queue family %u for texture uploads", m_transfer_queue_family_index);
+	}
 	return true;
 }
 
@@ -60,6 +60,10 @@ public:
 	{
 		return m_graphics_queue_properties;
 	}
+	// Queue of a family that only does transfers, like the DMA engines of discrete GPUs.
+	bool HasTransferQueue() const { return m_transfer_queue != VK_NULL_HANDLE; }
+	VkQueue GetTransferQueue() const { return m_transfer_queue; }
+	u32 GetTransferQueueFamilyIndex() const { return m_transfer_queue_family_index; }
 	const VkPhysicalDeviceMemoryProperties& GetDeviceMemoryProperties() const
 	{
 		return m_device_memory_properties;
@@ -120,6 +124,9 @@ private:
 	u32 m_graphics_queue_family_index = 0;
 	VkQueueFamilyProperties m_graphics_queue_properties = {};
 
+	VkQueue m_transfer_queue = VK_NULL_HANDLE;
+	u32 m_transfer_queue_family_index = 0;
+
 	VkDebugReportCallbackEXT m_debug_report_callback = VK_NULL_HANDLE;
 
 	VkPhysicalDeviceFeatures m_device_features = {};
@@ -9,6 +9,7 @@
 #include "VideoBackends/Vulkan/CommandBufferManager.h"
 #include "VideoBackends/Vulkan/Constants.h"
 #include "VideoBackends/Vulkan/FramebufferManager.h"
+#include "VideoBackends/Vulkan/GPUProfiler.h"
 #include "VideoBackends/Vulkan/ObjectCache.h"
 #include "VideoBackends/Vulkan/PerfQuery.h"
 #include "VideoBackends/Vulkan/Renderer.h"
@@ -169,7 +170,8 @@ bool VideoBackend::Initialize(void* window_handle)
 	std::unique_ptr<SwapChain> swap_chain;
 	if (surface != VK_NULL_HANDLE)
 	{
-		swap_chain = SwapChain::Create(window_handle, surface, g_Config.IsVSync());
+		swap_chain = SwapChain::Create(window_handle, surface, g_Config.IsVSync(),
+			g_Config.bLowLatencyPresent);
 		if (!swap_chain)
 		{
 			PanicAlert("Failed to create Vulkan swap chain.");
@@ -178,7 +180,8 @@ bool VideoBackend::Initialize(void* window_handle)
 	}
 
 	// Create command buffers. We do this separately because the other classes depend on it.
-	g_command_buffer_mgr = std::make_unique<CommandBufferManager>(g_Config.bBackendMultithreading);
+	g_command_buffer_mgr = std::make_unique<CommandBufferManager>(g_Config.bBackendMultithreading,
+		static_cast<size_t>(g_Config.iFramesInFlight));
 	if (!g_command_buffer_mgr->Initialize())
 	{
 		PanicAlert("Failed to create Vulkan command buffers");
@@ -234,6 +237,14 @@ bool VideoBackend::Initialize(void* window_handle)
 		return false;
 	}
 
+	// Profiling is optional, the backend works without it
+	if (GPUProfiler::IsSupported())
+	{
+		auto gpu_profiler = std::make_unique<GPUProfiler>();
+		if (gpu_profiler->Initialize())
+			g_gpu_profiler = std::move(gpu_profiler);
+	}
+
 	return true;
 }
 
@@ -268,6 +279,7 @@ void VideoBackend::Video_Cleanup()
 	// Save all cached pipelines out to disk for next time.
 	g_object_cache->SavePipelineCache();
 
+	g_gpu_profiler.reset();
 	g_perf_query.reset();
 	g_texture_cache.reset();
 	g_vertex_manager.reset();
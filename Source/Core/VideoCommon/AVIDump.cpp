@@ -6,7 +6,11 @@
 #define __STDC_CONSTANT_MACROS 1
 #endif
 
+#include <array>
+#include <condition_variable>
+#include <mutex>
 #include <string>
+#include <thread>
 
 extern "C" {
 #include <libavcodec/avcodec.h>
@@ -18,6 +22,7 @@ extern "C" {
 #include "Common/FileUtil.h"
 #include "Common/Logging/Log.h"
 #include "Common/MsgHandler.h"
+#include "Common/Thread.h"
 
 #include "Core/ConfigManager.h"
 #include "Core/HW/SystemTimers.h"
@@ -36,7 +41,6 @@ extern "C" {
 static AVFormatContext* s_format_context = nullptr;
 static AVStream* s_stream = nullptr;
 static AVFrame* s_src_frame = nullptr;
-static AVFrame* s_scaled_frame = nullptr;
 static AVPixelFormat s_pix_fmt = AV_PIX_FMT_BGR24;
 static SwsContext* s_sws_context = nullptr;
 static int s_width;
@@ -49,6 +53,18 @@ static int s_file_index = 0;
 static int s_savestate_index = 0;
 static int s_last_savestate_index = 0;
 
+// The frames are converted on the frame dumping thread and encoded on the encoder thread, so the
+// conversion of a frame overlaps with the encoding of the previous one.
+static constexpr size_t ENCODE_QUEUE_SIZE = 2;
+static std::array<AVFrame*, ENCODE_QUEUE_SIZE> s_scaled_frames = {};
+static std::thread s_encode_thread;
+// Guards the encode queue and s_encode_stop
+static std::mutex s_encode_mutex;
+static std::condition_variable s_encode_cv;
+static size_t s_encode_read_pos = 0;
+static size_t s_encode_count = 0;
+static bool s_encode_stop = false;
+
 static void InitAVCodec()
 {
 	static bool first_run = true;
@@ -59,6 +75,90 @@ static void InitAVCodec()
 	}
 }
 
+static void PreparePacket(AVPacket* pkt)
+{
+	av_init_packet(pkt);
+	pkt->data = nullptr;
+	pkt->size = 0;
+}
+
+static void EncodeFrame(AVFrame* frame)
+{
+	// Encode and write the image.
+	AVPacket pkt;
+	PreparePacket(&pkt);
+	int got_packet = 0;
+	int error = avcodec_encode_video2(s_stream->codec, &pkt, frame, &got_packet);
+	while (!error && got_packet)
+	{
+		// Write the compressed frame in the media file.
+		if (pkt.pts != (s64)AV_NOPTS_VALUE)
+		{
+			pkt.pts = av_rescale_q(pkt.pts, s_stream->codec->time_base, s_stream->time_base);
+		}
+		if (pkt.dts != (s64)AV_NOPTS_VALUE)
+		{
+			pkt.dts = av_rescale_q(pkt.dts, s_stream->codec->time_base, s_stream->time_base);
+		}
+#if LIBAVCODEC_VERSION_INT < AV_VERSION_INT(56, 60, 100)
+		if (s_stream->codec->coded_frame->key_frame)
+			pkt.flags |= AV_PKT_FLAG_KEY;
+#endif
+		pkt.stream_index = s_stream->index;
+		av_interleaved_write_frame(s_format_context, &pkt);
+
+		// Handle delayed frames.
+		PreparePacket(&pkt);
+		error = avcodec_encode_video2(s_stream->codec, &pkt, nullptr, &got_packet);
+	}
+	if (error)
+		ERROR_LOG(VIDEO, "Error while encoding video: %d", error);
+}
+
+static void EncodeFrames()
+{
+	Common::SetCurrentThreadName("FrameDumpEncoder");
+
+	std::unique_lock<std::mutex> lk(s_encode_mutex);
+	while (true)
+	{
+		// The queued frames are encoded before the thread stops
+		s_encode_cv.wait(lk, [] { return s_encode_count > 0 || s_encode_stop; });
+		if (s_encode_count == 0)
+			break;
+
+		AVFrame* frame = s_scaled_frames[s_encode_read_pos];
+		lk.unlock();
+		EncodeFrame(frame);
+		lk.lock();
+
+		s_encode_read_pos = (s_encode_read_pos + 1) % ENCODE_QUEUE_SIZE;
+		s_encode_count--;
+		s_encode_cv.notify_all();
+	}
+}
+
+static void StartEncodeThread()
+{
+	s_encode_read_pos = 0;
+	s_encode_count = 0;
+	s_encode_stop = false;
+	s_encode_thread = std::thread(EncodeFrames);
+}
+
+static void StopEncodeThread()
+{
+	if (!s_encode_thread.joinable())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lk(s_encode_mutex);
+		s_encode_stop = true;
+	}
+	s_encode_cv.notify_all();
+	s_encode_thread.join();
+}
+
 bool AVIDump::Start(int w, int h, bool fromBGRA)
 {
 	s_pix_fmt = fromBGRA ? AV_PIX_FMT_BGRA : AV_PIX_FMT_RGBA;
@@ -75,8 +175,11 @@ bool AVIDump::Start(int w, int h, bool fromBGRA)
 	{
 		CloseFile();
 		OSD::AddMessage("AVIDump Start failed");
+		return false;
 	}
-	return success;
+
+	StartEncodeThread();
+	return true;
 }
 
 bool AVIDump::CreateFile()
@@ -133,19 +236,21 @@ bool AVIDump::CreateFile()
 	}
 
 	s_src_frame = av_frame_alloc();
-	s_scaled_frame = av_frame_alloc();
-
-	s_scaled_frame->format = s_stream->codec->pix_fmt;
-	s_scaled_frame->width = s_width;
-	s_scaled_frame->height = s_height;
+	for (AVFrame*& scaled_frame : s_scaled_frames)
+	{
+		scaled_frame = av_frame_alloc();
+		scaled_frame->format = s_stream->codec->pix_fmt;
+		scaled_frame->width = s_width;
+		scaled_frame->height = s_height;
 
 #if LIBAVCODEC_VERSION_MAJOR >= 55
-	if (av_frame_get_buffer(s_scaled_frame, 1))
-		return false;
+		if (av_frame_get_buffer(scaled_frame, 1))
+			return false;
 #else
-	if (avcodec_default_get_buffer(s_stream->codec, s_scaled_frame))
-		return false;
+		if (avcodec_default_get_buffer(s_stream->codec, scaled_frame))
+			return false;
 #endif
+	}
 
 	NOTICE_LOG(VIDEO, "Opening file %s for dumping", s_format_context->filename);
 	if (avio_open(&s_format_context->pb, s_format_context->filename, AVIO_FLAG_WRITE) < 0 ||
@@ -161,13 +266,6 @@ bool AVIDump::CreateFile()
 	return true;
 }
 
-static void PreparePacket(AVPacket* pkt)
-{
-	av_init_packet(pkt);
-	pkt->data = nullptr;
-	pkt->size = 0;
-}
-
 void AVIDump::AddFrame(const u8* data, int width, int height, int stride, const Frame& state)
 {
 	// Assume that the timing is valid, if the savestate id of the new frame
@@ -179,26 +277,7 @@ void AVIDump::AddFrame(const u8* data, int width, int height, int stride, const
 	}
 
 	CheckResolution(width, height);
-	s_src_frame->data[0] = const_cast<u8*>(data);
-	s_src_frame->linesize[0] = stride;
-	s_src_frame->format = s_pix_fmt;
-	s_src_frame->width = s_width;
-	s_src_frame->height = s_height;
 
-	// Convert image from {BGR24, RGBA} to desired pixel format
-	if ((s_sws_context =
-		sws_getCachedContext(s_sws_context, width, height, s_pix_fmt, s_width, s_height,
-			s_stream->codec->pix_fmt, SWS_BICUBIC, nullptr, nullptr, nullptr)))
-	{
-		sws_scale(s_sws_context, s_src_frame->data, s_src_frame->linesize, 0, height,
-			s_scaled_frame->data, s_scaled_frame->linesize);
-	}
-
-	// Encode and write the image.
-	AVPacket pkt;
-	PreparePacket(&pkt);
-	int got_packet = 0;
-	int error = 0;
 	u64 delta;
 	s64 last_pts;
 	// Check to see if the first frame being dumped is the first frame of output from the emulator.
@@ -221,41 +300,46 @@ void AVIDump::AddFrame(const u8* data, int width, int height, int stride, const
 		last_pts = (s_last_pts * s_stream->codec->time_base.den) / state.ticks_per_second;
 	}
 	u64 pts_in_ticks = s_last_pts + delta;
-	s_scaled_frame->pts = (pts_in_ticks * s_stream->codec->time_base.den) / state.ticks_per_second;
-	if (s_scaled_frame->pts != last_pts)
+	s64 pts = (pts_in_ticks * s_stream->codec->time_base.den) / state.ticks_per_second;
+	if (pts == last_pts)
+		return;
+	s_last_frame = state.ticks;
+	s_last_pts = pts_in_ticks;
+
+	// Wait for a frame that isn't being encoded
+	AVFrame* scaled_frame;
 	{
-		s_last_frame = state.ticks;
-		s_last_pts = pts_in_ticks;
-		error = avcodec_encode_video2(s_stream->codec, &pkt, s_scaled_frame, &got_packet);
+		std::unique_lock<std::mutex> lk(s_encode_mutex);
+		s_encode_cv.wait(lk, [] { return s_encode_count < ENCODE_QUEUE_SIZE; });
+		scaled_frame = s_scaled_frames[(s_encode_read_pos + s_encode_count) % ENCODE_QUEUE_SIZE];
 	}
-	while (!error && got_packet)
+
+	s_src_frame->data[0] = const_cast<u8*>(data);
+	s_src_frame->linesize[0] = stride;
+	s_src_frame->format = s_pix_fmt;
+	s_src_frame->width = s_width;
+	s_src_frame->height = s_height;
+
+	// Convert image from {BGR24, RGBA} to desired pixel format
+	if ((s_sws_context =
+		sws_getCachedContext(s_sws_context, width, height, s_pix_fmt, s_width, s_height,
+			s_stream->codec->pix_fmt, SWS_BICUBIC, nullptr, nullptr, nullptr)))
 	{
-		// Write the compressed frame in the media file.
-		if (pkt.pts != (s64)AV_NOPTS_VALUE)
-		{
-			pkt.pts = av_rescale_q(pkt.pts, s_stream->codec->time_base, s_stream->time_base);
-		}
-		if (pkt.dts != (s64)AV_NOPTS_VALUE)
-		{
-			pkt.dts = av_rescale_q(pkt.dts, s_stream->codec->time_base, s_stream->time_base);
-		}
-#if LIBAVCODEC_VERSION_INT < AV_VERSION_INT(56, 60, 100)
-		if (s_stream->codec->coded_frame->key_frame)
-			pkt.flags |= AV_PKT_FLAG_KEY;
-#endif
-		pkt.stream_index = s_stream->index;
-		av_interleaved_write_frame(s_format_context, &pkt);
+		sws_scale(s_sws_context, s_src_frame->data, s_src_frame->linesize, 0, height,
+			scaled_frame->data, scaled_frame->linesize);
+	}
+	scaled_frame->pts = pts;
 
-		// Handle delayed frames.
-		PreparePacket(&pkt);
-		error = avcodec_encode_video2(s_stream->codec, &pkt, nullptr, &got_packet);
+	{
+		std::lock_guard<std::mutex> lk(s_encode_mutex);
+		s_encode_count++;
 	}
-	if (error)
-		ERROR_LOG(VIDEO, "Error while encoding video: %d", error);
+	s_encode_cv.notify_all();
 }
 
 void AVIDump::Stop()
 {
+	StopEncodeThread();
 	av_write_trailer(s_format_context);
 	CloseFile();
 	s_file_index = 0;
@@ -265,6 +349,8 @@ void AVIDump::Stop()
 
 void AVIDump::CloseFile()
 {
+	StopEncodeThread();
+
 	if (s_stream)
 	{
 		if (s_stream->codec)
@@ -278,7 +364,8 @@ void AVIDump::CloseFile()
 	}
 
 	av_frame_free(&s_src_frame);
-	av_frame_free(&s_scaled_frame);
+	for (AVFrame*& scaled_frame : s_scaled_frames)
+		av_frame_free(&scaled_frame);
 
 	if (s_format_context)
 	{
@@ -6,7 +6,9 @@
 
 #include "VideoCommon/AsyncRequests.h"
 #include "VideoCommon/BoundingBox.h"
+#include "VideoCommon/BPFunctions.h"
 #include "VideoCommon/Fifo.h"
+#include "VideoCommon/FramebufferManagerBase.h"
 #include "VideoCommon/RenderBase.h"
 #include "VideoCommon/VideoBackendBase.h"
 #include "VideoCommon/VideoCommon.h"
@@ -49,6 +51,9 @@ void AsyncRequests::PullEventsInternal()
 			} while (!m_queue.empty() && m_queue.front().type == first_event.type);
 
 			lock.unlock();
+			if (t == POKE_COLOR)
+				BPFunctions::ResolvePixelFormatChange();
+			FramebufferManagerBase::MarkEFBChanged();
 			g_renderer->PokeEFB(t, m_merged_efb_pokes.data(), m_merged_efb_pokes.size());
 			lock.lock();
 			continue;
@@ -119,6 +124,8 @@ void AsyncRequests::HandleEvent(const AsyncRequests::Event& e)
 	case Event::EFB_POKE_COLOR:
 	{
 		EfbPokeData poke = { e.efb_poke.x, e.efb_poke.y, e.efb_poke.data };
+		BPFunctions::ResolvePixelFormatChange();
+		FramebufferManagerBase::MarkEFBChanged();
 		g_renderer->PokeEFB(POKE_COLOR, &poke, 1);
 	}
 	break;
@@ -126,11 +133,13 @@ void AsyncRequests::HandleEvent(const AsyncRequests::Event& e)
 	case Event::EFB_POKE_Z:
 	{
 		EfbPokeData poke = { e.efb_poke.x, e.efb_poke.y, e.efb_poke.data };
+		FramebufferManagerBase::MarkEFBChanged();
 		g_renderer->PokeEFB(POKE_Z, &poke, 1);
 	}
 	break;
 
 	case Event::EFB_PEEK_COLOR:
+		BPFunctions::ResolvePixelFormatChange();
 		*e.efb_peek.data = g_renderer->AccessEFB(PEEK_COLOR, e.efb_peek.x, e.efb_peek.y, 0);
 		break;
 
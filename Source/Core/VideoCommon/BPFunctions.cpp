@@ -9,7 +9,9 @@
 
 #include "VideoCommon/BPFunctions.h"
 #include "VideoCommon/BPMemory.h"
+#include "VideoCommon/FramebufferManagerBase.h"
 #include "VideoCommon/GeometryShaderManager.h"
+#include "VideoCommon/GPUProfilerBase.h"
 #include "VideoCommon/PixelShaderManager.h"
 #include "VideoCommon/RenderBase.h"
 #include "VideoCommon/VertexManagerBase.h"
@@ -20,6 +22,11 @@
 
 namespace BPFunctions
 {
+// The EFB still holds the data of the format last stored with Renderer::StorePixelFormat. Games
+// switch formats several times per frame, often just to clear the EFB after, so the full screen
+// pass is only made once something uses the data.
+static bool s_pixel_format_change_pending = false;
+
 // ----------------------------------------------
 // State translation lookup tables
 // Reference: Yet Another Gamecube Documentation
@@ -36,7 +43,7 @@ void SetGenerationMode()
 	g_renderer->SetGenerationMode();
 }
 
-void SetScissor()
+EFBRectangle GetScissorRect()
 {
 	/* NOTE: the minimum value here for the scissor rect and offset is -342.
 	* GX internally adds on an offset of 342 to both the offset and scissor
@@ -63,6 +70,12 @@ void SetScissor()
 	if (rc.left > rc.right) std::swap(rc.right, rc.left);
 	if (rc.top > rc.bottom) std::swap(rc.bottom, rc.top);
 
+	return rc;
+}
+
+void SetScissor()
+{
+	const EFBRectangle rc = GetScissorRect();
 	TargetRectangle trc = g_renderer->ConvertEFBRectangle(rc);
 	g_renderer->SetScissorRect(trc);
 	VertexShaderManager::SetViewportChanged();
@@ -144,12 +157,33 @@ void ClearScreen(const EFBRectangle &rc)
 			color = RGBA8ToRGB565ToRGBA8(color);
 			z = Z24ToZ16ToZ24(z);
 		}
+		// A clear of all the color data makes the pending reinterpretation pointless
+		if (s_pixel_format_change_pending && colorEnable && (alphaEnable || pixel_format != PEControl::RGBA6_Z24) &&
+			rc.left <= 0 && rc.top <= 0 && rc.right >= EFB_WIDTH && rc.bottom >= EFB_HEIGHT)
+		{
+			s_pixel_format_change_pending = false;
+			Renderer::StorePixelFormat(pixel_format);
+		}
+		ResolvePixelFormatChange();
+
+		SetGPUPass(GPU_PASS_EFB_DRAW);
+		FramebufferManagerBase::MarkEFBChanged();
 		g_renderer->ClearScreen(rc, colorEnable, alphaEnable, zEnable, color, z);
 	}
 }
 
 void OnPixelFormatChange()
 {
+	if (g_ActiveConfig.bEFBEmulateFormatChanges)
+		s_pixel_format_change_pending = true;
+}
+
+void ResolvePixelFormatChange()
+{
+	if (!s_pixel_format_change_pending)
+		return;
+	s_pixel_format_change_pending = false;
+
 	int convtype = -1;
 
 	// TODO : Check for Z compression format change
@@ -212,6 +246,7 @@ void OnPixelFormatChange()
 		goto skip;
 	}
 
+	FramebufferManagerBase::MarkEFBChanged();
 	g_renderer->ReinterpretPixelData(convtype);
 
 skip:
@@ -19,6 +19,8 @@ namespace BPFunctions
 void FlushPipeline();
 void SetGenerationMode();
 void SetScissor();
+// The EFB area draws are clipped to, clamped to the EFB
+EFBRectangle GetScissorRect();
 void SetLineWidth();
 void SetDepthMode();
 void SetBlendMode();
@@ -26,6 +28,10 @@ void SetDitherMode();
 void SetLogicOpMode();
 void SetColorMask();
 void ClearScreen(const EFBRectangle &rc);
+// Records a change of bpmem.zcontrol.pixel_format, the EFB is reinterpreted with the new format
+// by ResolvePixelFormatChange
 void OnPixelFormatChange();
+// Reinterprets the EFB after a pixel format change, before it is drawn to, copied or accessed
+void ResolvePixelFormatChange();
 void SetInterlacingMode(const BPCmd &bp);
 };
\ No newline at end of file
@@ -1166,6 +1166,20 @@ struct BPMemory
 	{
 		return !zcontrol.early_ztest && zmode.testenable;
 	}
+	// Bitmask of the texture maps sampled by the active TEV stages, direct or indirect.
+	u32 GetUsedTextures() const
+	{
+		u32 usedtextures = 0;
+		for (u32 i = 0; i < genMode.numtevstages + 1u; ++i)
+			if (tevorders[i / 2].getEnable(i & 1))
+				usedtextures |= 1 << tevorders[i / 2].getTexMap(i & 1);
+
+		if (genMode.numindstages.Value() > 0)
+			for (u32 i = 0; i < genMode.numtevstages + 1u; ++i)
+				if (tevind[i].IsActive() && tevind[i].bt < genMode.numindstages.Value())
+					usedtextures |= 1 << tevindref.getTexMap(tevind[i].bt);
+		return usedtextures;
+	}
 };
 
 #pragma pack()
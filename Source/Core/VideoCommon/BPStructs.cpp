@@ -58,6 +58,69 @@ void BPInit()
 	mapTexFound = false;
 }
 
+// Returns false for writes that cannot change how the geometry batched so far is drawn,
+// letting compatible draws keep coalescing into the same flush. Everything else flushes.
+static bool BPWriteAffectsBatch(const BPCmd& bp)
+{
+	switch (bp.address)
+	{
+	// Only consumed when an EFB copy, TLUT load or TMEM preload is triggered,
+	// and those triggers flush on their own.
+	case BPMEM_DISPLAYCOPYFILTER:
+	case BPMEM_DISPLAYCOPYFILTER + 1:
+	case BPMEM_DISPLAYCOPYFILTER + 2:
+	case BPMEM_DISPLAYCOPYFILTER + 3:
+	case BPMEM_COPYFILTER0:
+	case BPMEM_COPYFILTER1:
+	case BPMEM_EFB_TL:
+	case BPMEM_EFB_BR:
+	case BPMEM_EFB_ADDR:
+	case BPMEM_MIPMAP_STRIDE:
+	case BPMEM_COPYYSCALE:
+	case BPMEM_CLEAR_AR:
+	case BPMEM_CLEAR_GB:
+	case BPMEM_CLEAR_Z:
+	case BPMEM_LOADTLUT0:
+	case BPMEM_PRELOAD_ADDR:
+	case BPMEM_PRELOAD_TMEMEVEN:
+	case BPMEM_PRELOAD_TMEMODD:
+	// Not emulated at all.
+	case BPMEM_BP_MASK:
+	case BPMEM_IND_IMASK:
+	case BPMEM_REVBITS:
+	case BPMEM_BUSCLOCK0:
+	case BPMEM_BUSCLOCK1:
+	case BPMEM_PERF0_TRI:
+	case BPMEM_PERF0_QUAD:
+	case BPMEM_PERF1:
+		return false;
+	default:
+		break;
+	}
+
+	const u32 numtevstages = bpmem.genMode.numtevstages + 1u;
+
+	// TEV stages past the active count are not part of the current shader.
+	// Enabling them takes a genMode write, which flushes first.
+	if ((bp.address & 0xE0) == BPMEM_TEV_COLOR_ENV)
+		return (u32)(bp.address - BPMEM_TEV_COLOR_ENV) / 2 < numtevstages;
+	if ((bp.address & 0xF0) == BPMEM_IND_CMD)
+		return (u32)(bp.address - BPMEM_IND_CMD) < numtevstages;
+	if ((bp.address & 0xF8) == BPMEM_TREF)
+		return (u32)(bp.address - BPMEM_TREF) * 2 < numtevstages;
+
+	// Texture maps the current TEV setup does not sample. Binding one to a stage
+	// goes through TREF / IREF / TEV_COLOR_ENV / IND_CMD, which flush first.
+	if ((bp.address >= BPMEM_TX_SETMODE0 && bp.address < BPMEM_TX_SETTLUT + 4)
+		|| (bp.address >= BPMEM_TX_SETMODE0_4 && bp.address < BPMEM_TX_SETTLUT_4 + 4))
+	{
+		const u32 texmap = (bp.address & 3) + (bp.address >= BPMEM_TX_SETMODE0_4 ? 4 : 0);
+		return (bpmem.GetUsedTextures() & (1 << texmap)) != 0;
+	}
+
+	return true;
+}
+
 void BPWritten(const BPCmd& bp)
 {
 	/*
@@ -117,7 +180,8 @@ void BPWritten(const BPCmd& bp)
 		}
 	}
 
-	FlushPipeline();
+	if (BPWriteAffectsBatch(bp))
+		FlushPipeline();
 
 	((u32*)&bpmem)[bp.address] = bp.newvalue;
 
@@ -215,6 +279,8 @@ void BPWritten(const BPCmd& bp)
 		switch (bp.newvalue & 0xFF)
 		{
 		case 0x02:
+			// The game may read back its EFB copies once the GPU is done
+			TextureCacheBase::FlushEFBCopies();
 			if (!Fifo::UseDeterministicGPUThread())
 				PixelEngine::SetFinish(); // may generate interrupt
 			DEBUG_LOG(VIDEO, "GXSetDrawDone SetPEFinish (value: 0x%02X)", (bp.newvalue & 0xFFFF));
@@ -226,11 +292,13 @@ void BPWritten(const BPCmd& bp)
 		}
 		return;
 	case BPMEM_PE_TOKEN_ID: // Pixel Engine Token ID
+		TextureCacheBase::FlushEFBCopies();
 		if (!Fifo::UseDeterministicGPUThread())
 			PixelEngine::SetToken(static_cast<u16>(bp.newvalue & 0xFFFF), false);
 		DEBUG_LOG(VIDEO, "SetPEToken 0x%04x", (bp.newvalue & 0xFFFF));
 		return;
 	case BPMEM_PE_TOKEN_INT_ID: // Pixel Engine Interrupt Token ID
+		TextureCacheBase::FlushEFBCopies();
 		if (!Fifo::UseDeterministicGPUThread())
 			PixelEngine::SetToken(static_cast<u16>(bp.newvalue & 0xFFFF), true);
 		DEBUG_LOG(VIDEO, "SetPEToken + INT 0x%04x", (bp.newvalue & 0xFFFF));
@@ -257,6 +325,8 @@ void BPWritten(const BPCmd& bp)
 		srcRect.bottom = (int)(bpmem.copyTexSrcXY.y + bpmem.copyTexSrcWH.y + 1);
 		UPE_Copy PE_copy = bpmem.triggerEFBCopy;
 
+		ResolvePixelFormatChange();
+
 		// Check if we are to copy from the EFB or draw to the XFB
 		if (PE_copy.copy_to_xfb == 0)
 		{
@@ -314,6 +384,7 @@ void BPWritten(const BPCmd& bp)
 		if (!SConfig::GetInstance().bWii)
 			addr = addr & 0x01FFFFFF;
 
+		TextureCacheBase::FlushEFBCopies(addr, tlutXferCount);
 		Memory::CopyFromEmu(texMem + tlutTMemAddr, addr, tlutXferCount);
 
 		if (g_bRecordFifoData)
@@ -491,6 +562,8 @@ void BPWritten(const BPCmd& bp)
 			// TODO: Not quite sure if this is completely correct (likely not)
 			// NOTE: libogc's implementation of GX_PreloadEntireTexture seems flawed, so it's not necessarily a good reference for RE'ing this feature.
 
+			TextureCacheBase::FlushEFBCopies();
+
 			BPS_TmemConfig& tmem_cfg = bpmem.tmem_config;
 			u32 src_addr = tmem_cfg.preload_addr << 5; // TODO: Should we add mask here on GC?
 			u32 bytes_read = 0;
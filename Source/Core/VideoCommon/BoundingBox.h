@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <atomic>
+
 #include "VideoCommon/NativeVertexFormat.h"
 
 // Bounding Box manager
@@ -17,6 +19,10 @@ extern bool active;
 // Bounding box current coordinates
 extern u16 coords[4];
 
+// Coordinates at the end of the last frame, returned to the CPU without syncing the GPU
+// when bBBoxAsyncReadback is set
+extern std::atomic<u16> readback_coords[4];
+
 extern u8 * bufferPos;
 extern const TPipelineState *pState;
 
@@ -14,10 +14,12 @@
 #include "Core/ConfigManager.h"
 #include "Core/CoreTiming.h"
 #include "Core/HW/GPFifo.h"
+#include "Core/HW/Memmap.h"
 #include "Core/HW/MMIO.h"
 #include "Core/HW/ProcessorInterface.h"
 #include "VideoCommon/CommandProcessor.h"
 #include "VideoCommon/Fifo.h"
+#include "VideoCommon/OpcodeDecodingSC.h"
 
 namespace CommandProcessor
 {
@@ -272,7 +274,7 @@ void RegisterMMIO(MMIO::Mapping* mmio, u32 base)
 		MMIO::DirectWrite<u16>(MMIO::Utils::HighPart(&fifo.CPReadPointer)));
 }
 
-void GatherPipeBursted()
+void GatherPipeBursted(u32 size)
 {
 	SetCPStatusFromCPU();
 
@@ -294,11 +296,14 @@ void GatherPipeBursted()
 		return;
 	}
 
+	if (Fifo::UsePredictiveFifo())
+		OpcodeDecoderSC_PushData(Memory::GetPointer(fifo.CPWritePointer), size);
+
 	// update the fifo pointer
-	if (fifo.CPWritePointer == fifo.CPEnd)
+	if (fifo.CPWritePointer + size - GATHER_PIPE_SIZE == fifo.CPEnd)
 		fifo.CPWritePointer = fifo.CPBase;
 	else
-		fifo.CPWritePointer += GATHER_PIPE_SIZE;
+		fifo.CPWritePointer += size;
 
 	if (m_CPCtrlReg.GPReadEnable && m_CPCtrlReg.GPLinkEnable)
 	{
@@ -311,7 +316,7 @@ void GatherPipeBursted()
 	if (fifo.bFF_HiWatermark)
 		CoreTiming::ForceExceptionCheck(0);
 
-	Common::AtomicAdd(fifo.CPReadWriteDistance, GATHER_PIPE_SIZE);
+	Common::AtomicAdd(fifo.CPReadWriteDistance, size);
 
 	Fifo::RunGpu();
 
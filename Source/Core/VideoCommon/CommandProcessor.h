@@ -146,7 +146,8 @@ void RegisterMMIO(MMIO::Mapping* mmio, u32 base);
 
 void SetCPStatusFromGPU();
 void SetCPStatusFromCPU();
-void GatherPipeBursted();
+// size is a multiple of the gather pipe size that does not cross the fifo end
+void GatherPipeBursted(u32 size);
 void UpdateInterrupts(u64 userdata);
 void UpdateInterruptsFromVideoBackend(u64 userdata);
 
@@ -27,6 +27,13 @@ struct PixelShaderConstants
 	float4 efbscale;
 };
 
+// TEV configuration read by the pixel ubershader, see UberShaderPixel.cpp for the layout.
+struct UberPixelShaderConstants
+{
+	uint4 stages[16];
+	uint4 config;
+};
+
 struct VertexShaderConstants
 {
 	float4 posnormalmatrix[6];
@@ -58,4 +65,5 @@ struct TessellationShaderConstants
 {
 	float4 tessparams;
 	int4 cullparams;
+	float4 tessscreen;
 };
@@ -29,6 +29,10 @@
 // THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
 // (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
 #include "ImageLoader.h"
 #include "Common/Common.h"
 #include "ImageWrite.h"
@@ -41,6 +45,29 @@
 #define FOURCC_DXT1  (MAKEFOURCC('D','X','T','1'))
 #define FOURCC_DXT3  (MAKEFOURCC('D','X','T','3'))
 #define FOURCC_DXT5  (MAKEFOURCC('D','X','T','5'))
+#define FOURCC_ATI2  (MAKEFOURCC('A','T','I','2'))
+#define FOURCC_BC5U  (MAKEFOURCC('B','C','5','U'))
+	/*
+	* The format is given by the DX10 extended header instead
+	*/
+#define FOURCC_DX10  (MAKEFOURCC('D','X','1','0'))
+	/*
+	* DXGI formats of the block compressed textures in DX10 headers
+	*/
+#define DXGI_FORMAT_BC1_TYPELESS	70
+#define DXGI_FORMAT_BC1_UNORM	71
+#define DXGI_FORMAT_BC1_UNORM_SRGB	72
+#define DXGI_FORMAT_BC2_TYPELESS	73
+#define DXGI_FORMAT_BC2_UNORM	74
+#define DXGI_FORMAT_BC2_UNORM_SRGB	75
+#define DXGI_FORMAT_BC3_TYPELESS	76
+#define DXGI_FORMAT_BC3_UNORM	77
+#define DXGI_FORMAT_BC3_UNORM_SRGB	78
+#define DXGI_FORMAT_BC5_TYPELESS	82
+#define DXGI_FORMAT_BC5_UNORM	83
+#define DXGI_FORMAT_BC7_TYPELESS	97
+#define DXGI_FORMAT_BC7_UNORM	98
+#define DXGI_FORMAT_BC7_UNORM_SRGB	99
 	/*
 	* Flags
 	*/
@@ -178,50 +205,88 @@ typedef struct _DDSHeader
 	u32      dwTextureStage;
 } DDSHeader;
 
+typedef struct _DDSHeaderDX10
+{
+	u32      dxgiFormat;
+	u32      resourceDimension;
+	u32      miscFlag;
+	u32      arraySize;
+	u32      miscFlags2;
+} DDSHeaderDX10;
+
+// Reads the file named by the loader params, or the image they point to in memory.
+class DDSReader
+{
+public:
+	explicit DDSReader(const ImageLoaderParams& loader_params)
+		: m_data(loader_params.src_data), m_size(loader_params.src_size)
+	{
+		if (m_data == nullptr)
+			m_file = fopen(loader_params.Path, "rb");
+	}
+
+	~DDSReader()
+	{
+		if (m_file != nullptr)
+			fclose(m_file);
+	}
+
+	bool IsOpen() const { return m_file != nullptr || m_data != nullptr; }
+
+	size_t Read(void* dst, size_t size)
+	{
+		if (m_file != nullptr)
+			return fread(dst, 1, size, m_file);
+		size = std::min(size, m_size - m_position);
+		memcpy(dst, m_data + m_position, size);
+		m_position += size;
+		return size;
+	}
+
+private:
+	FILE* m_file = nullptr;
+	const u8* m_data;
+	size_t m_size;
+	size_t m_position = 0;
+};
+
 DDSCompression ImageLoader::ReadDDS(ImageLoaderParams& loader_params)
 {
 	DDSCompression Result = DDSC_NONE;
 	DDSHeader ddsd;
-	FILE *pFile;
 	u32 block_size = 8;
 
 	// Open the file
-	pFile = fopen(loader_params.Path, "rb");
-
-	if (pFile == nullptr)
+	DDSReader reader(loader_params);
+	if (!reader.IsOpen())
 	{
 		return Result;
 	}
 
 	// Get the surface descriptor
-	u32 readedsize = (u32)fread(&ddsd, sizeof(ddsd), 1, pFile);
-	if (ddsd.dwSignature != DDS_SIGNARURE || ddsd.dwSize != 124)
+	u32 readedsize = (u32)reader.Read(&ddsd, sizeof(ddsd));
+	if (readedsize != sizeof(ddsd) || ddsd.dwSignature != DDS_SIGNARURE || ddsd.dwSize != 124)
 	{
-		fclose(pFile);
 		return Result;
 	}
 	// Check for a valid Header
 	u32 flag = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT;
 	if ((ddsd.dwFlags & flag) != flag)
 	{
-		fclose(pFile);
 		return Result;
 	}
 	flag = DDPF_FOURCC | DDPF_RGB;
 	if ((ddsd.ddpfPixelFormat.dwFlags & flag) == 0)
 	{
-		fclose(pFile);
 		return Result;
 	}
 	if (ddsd.ddpfPixelFormat.dwSize != 32)
 	{
-		fclose(pFile);
 		return Result;
 	}
 	// Support only block aligned files
 	if ((ddsd.dwWidth % 4) != 0 || (ddsd.dwHeight % 4) != 0)
 	{
-		fclose(pFile);
 		return Result;
 	}
 
@@ -229,23 +294,79 @@ DDSCompression ImageLoader::ReadDDS(ImageLoaderParams& loader_params)
 	// Suport only Basic DDS compresion Formats
 	//
 
+	DDSCompression compression = DDSC_NONE;
 	switch (ddsd.ddpfPixelFormat.dwFourCC)
 	{
 	case FOURCC_DXT1:
-		// DXT1's compression ratio is 8:1
-		block_size = 8;
+		compression = DDSC_DXT1;
 		break;
 	case FOURCC_DXT3:
-		// DXT3's compression ratio is 4:1
-		block_size = 16;
+		compression = DDSC_DXT3;
 		break;
 	case FOURCC_DXT5:
-		// DXT5's compression ratio is 4:1
+		compression = DDSC_DXT5;
+		break;
+	case FOURCC_ATI2:
+	case FOURCC_BC5U:
+		compression = DDSC_BC5;
+		break;
+	case FOURCC_DX10:
+	{
+		// BC5 and BC7 are usually only written with the extended header
+		DDSHeaderDX10 dx10;
+		if (reader.Read(&dx10, sizeof(dx10)) != sizeof(dx10) || dx10.arraySize > 1)
+		{
+			return Result;
+		}
+		switch (dx10.dxgiFormat)
+		{
+		case DXGI_FORMAT_BC1_TYPELESS:
+		case DXGI_FORMAT_BC1_UNORM:
+		case DXGI_FORMAT_BC1_UNORM_SRGB:
+			compression = DDSC_DXT1;
+			break;
+		case DXGI_FORMAT_BC2_TYPELESS:
+		case DXGI_FORMAT_BC2_UNORM:
+		case DXGI_FORMAT_BC2_UNORM_SRGB:
+			compression = DDSC_DXT3;
+			break;
+		case DXGI_FORMAT_BC3_TYPELESS:
+		case DXGI_FORMAT_BC3_UNORM:
+		case DXGI_FORMAT_BC3_UNORM_SRGB:
+			compression = DDSC_DXT5;
+			break;
+		case DXGI_FORMAT_BC5_TYPELESS:
+		case DXGI_FORMAT_BC5_UNORM:
+			compression = DDSC_BC5;
+			break;
+		case DXGI_FORMAT_BC7_TYPELESS:
+		case DXGI_FORMAT_BC7_UNORM:
+		case DXGI_FORMAT_BC7_UNORM_SRGB:
+			compression = DDSC_BC7;
+			break;
+		default:
+			break;
+		}
+		break;
+	}
+	default:
+		break;
+	}
+	switch (compression)
+	{
+	case DDSC_DXT1:
+		// DXT1's compression ratio is 8:1
+		block_size = 8;
+		break;
+	case DDSC_DXT3:
+	case DDSC_DXT5:
+	case DDSC_BC5:
+	case DDSC_BC7:
+		// The others compression ratio is 4:1
 		block_size = 16;
 		break;
 	default:
 		// the format is not supported so return inmediatelly
-		fclose(pFile);
 		return Result;
 	}
 
@@ -279,13 +400,10 @@ DDSCompression ImageLoader::ReadDDS(ImageLoaderParams& loader_params)
 	loader_params.dst = loader_params.request_buffer_delegate(loader_params.data_size, mipmapspresent);
 	if (loader_params.dst == nullptr)
 	{
-		fclose(pFile);
 		return Result;
 	}
 
-	readedsize = (u32)fread(loader_params.dst, 1, loader_params.data_size, pFile);
-	// Close the file
-	fclose(pFile);
+	readedsize = (u32)reader.Read(loader_params.dst, loader_params.data_size);
 	if ((readedsize + block_size) < loader_params.data_size)
 	{
 		// if the size readed is less than the size calculated then
@@ -300,8 +418,7 @@ DDSCompression ImageLoader::ReadDDS(ImageLoaderParams& loader_params)
 		ddsd.dwMipMapCount = 0;
 	}
 
-	u32 FourCC = ddsd.ddpfPixelFormat.dwFourCC;
-	Result = (FourCC == FOURCC_DXT1) ? DDSC_DXT1 : ((FourCC == FOURCC_DXT3) ? DDSC_DXT3 : DDSC_DXT5);
+	Result = compression;
 	loader_params.Width = ddsd.dwWidth;
 	loader_params.Height = ddsd.dwHeight;
 	loader_params.nummipmaps = ddsd.dwMipMapCount;
@@ -0,0 +1,29 @@
+// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "Common/CommonTypes.h"
+
+// Display list cache.
+// Display lists are identified by their address, size and a hash of their contents.
+// Once a list has been called a few times with the same contents the register loads it
+// contains are pre-decoded and the vertices it draws are kept in native format, so further
+// calls replay the recorded effects instead of going through OpcodeDecoder again.
+namespace DLCache
+{
+
+void Init();
+void Shutdown();
+void Clear();
+
+// Called once per frame from the GPU thread, drops lists that have not been used recently.
+void ProgressiveCleanup();
+
+// Returns true if the list was replayed from the cache, in which case cycles
+// receives the same cycle count OpcodeDecoder would have produced.
+// Returns false if the caller must interpret the list itself.
+bool HandleDisplayList(u32 address, u8* data, u32 size, u32* cycles);
+
+}  // namespace DLCache
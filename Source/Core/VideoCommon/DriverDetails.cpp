@@ -82,6 +82,8 @@ static BugInfo m_known_bugs[] = {
 	BUG_INTEL_BROKEN_BUFFER_STORAGE, 101810.3907, 101810.3960, true },
 	{ API_OPENGL, OS_ALL, VENDOR_ATI, DRIVER_ATI, Family::UNKNOWN, BUG_SLOW_GETBUFFERSUBDATA, -1.0,
 	-1.0, true },
+	{ API_OPENGL, OS_ALL, VENDOR_MESA, DRIVER_R600, Family::UNKNOWN, BUG_SLOW_PINNED_MEMORY, -1.0,
+	-1.0, true },
 	{ API_OPENGL, OS_ALL, VENDOR_MESA, DRIVER_I965, Family::UNKNOWN, BUG_BROKEN_CLIP_DISTANCE, -1.0,
 	-1.0, true },
 	{ API_VULKAN, OS_ALL, VENDOR_ATI, DRIVER_ATI, Family::UNKNOWN,
@@ -215,6 +215,15 @@ enum Bug
 	// everywhere else.
 	BUG_SLOW_GETBUFFERSUBDATA,
 
+	// Bug: AMD_pinned_memory streams slower than ARB_buffer_storage on Mesa
+	// Affected devices: Mesa radeon
+	// Started Version: -1
+	// Ended Version: -1
+	// Pinned memory is the fastest streaming method on the official AMD driver, which is why it is
+	// preferred. Mesa exposes the extension too, but its persistent coherent mappings of buffer
+	// storage are cheaper there, so use buffer storage instead.
+	BUG_SLOW_PINNED_MEMORY,
+
 	// Bug: Broken lines in geometry shaders when writing to gl_ClipDistance in the vertex shader
 	// Affected Devices: Mesa i965
 	// Started Version: -1
@@ -0,0 +1,110 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <atomic>
+
+#include "Common/CommonTypes.h"
+#include "Common/Logging/Log.h"
+
+#include "VideoCommon/DynamicResolution.h"
+#include "VideoCommon/GPUProfilerBase.h"
+#include "VideoCommon/VideoConfig.h"
+
+namespace DynamicResolution
+{
+// Frames to wait after a change, the profiler results lag a few frames and the first frames at a
+// new size are not representative
+static constexpr u32 SETTLE_FRAMES = 90;
+// Weight of the newest frame in the averaged GPU time
+static constexpr float AVERAGE_WEIGHT = 0.1f;
+// Steps up only while the time predicted for the next level stays this far below the target
+static constexpr float STEP_UP_MARGIN = 0.85f;
+
+// 0 while the configured scale is used
+static std::atomic<int> s_scale{ 0 };
+
+// Only touched by the video thread
+static u32 s_last_result_count = 0;
+static u32 s_settle_frames = SETTLE_FRAMES;
+static float s_average_ms = 0.0f;
+
+static bool IsSupportedScale(int scale)
+{
+	// The automatic scales follow the window size instead
+	return scale >= SCALE_1X;
+}
+
+// Scale factor of the levels of the EFB scale list
+static float GetScaleFactor(int scale)
+{
+	return scale <= SCALE_2_5X ? (scale - SCALE_1X) * 0.5f + 1.0f : (scale - SCALE_3X) + 3.0f;
+}
+
+int GetEFBScale(int configured_scale)
+{
+	const int scale = s_scale.load(std::memory_order_relaxed);
+	if (!g_Config.bDynamicResolution || !IsSupportedScale(configured_scale) || scale == 0)
+		return configured_scale;
+
+	return std::min(scale, configured_scale);
+}
+
+static void SetScale(int scale)
+{
+	INFO_LOG(VIDEO, "Dynamic resolution: %.1fx at %.2f ms", GetScaleFactor(scale), s_average_ms);
+	s_scale.store(scale, std::memory_order_relaxed);
+	s_settle_frames = SETTLE_FRAMES;
+	s_average_ms = 0.0f;
+}
+
+void OnPresent()
+{
+	const int configured_scale = g_Config.iEFBScale;
+	if (!g_ActiveConfig.bDynamicResolution || !IsSupportedScale(configured_scale) || !g_gpu_profiler)
+	{
+		Reset();
+		return;
+	}
+
+	// Frames without a new result, all query slots were in flight
+	const u32 result_count = g_gpu_profiler->GetResolvedFrameCount();
+	if (result_count == s_last_result_count)
+		return;
+	s_last_result_count = result_count;
+
+	if (s_settle_frames > 0)
+	{
+		s_settle_frames--;
+		return;
+	}
+
+	float frame_ms = 0.0f;
+	for (float pass_ms : g_gpu_profiler->GetPassTimes())
+		frame_ms += pass_ms;
+	s_average_ms = s_average_ms == 0.0f ? frame_ms :
+		s_average_ms + (frame_ms - s_average_ms) * AVERAGE_WEIGHT;
+
+	const int scale = GetEFBScale(configured_scale);
+	const float target_ms = g_ActiveConfig.fDynamicResolutionFrameTime;
+	if (s_average_ms > target_ms && scale > SCALE_1X)
+	{
+		SetScale(scale - 1);
+	}
+	else if (scale < configured_scale)
+	{
+		// Assumes all of the frame scales with the pixel count, which overestimates
+		const float ratio = GetScaleFactor(scale + 1) / GetScaleFactor(scale);
+		if (s_average_ms * ratio * ratio < target_ms * STEP_UP_MARGIN)
+			SetScale(scale + 1);
+	}
+}
+
+void Reset()
+{
+	s_scale.store(0, std::memory_order_relaxed);
+	s_settle_frames = SETTLE_FRAMES;
+	s_average_ms = 0.0f;
+}
+}
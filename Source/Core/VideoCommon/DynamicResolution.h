@@ -0,0 +1,23 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+// Internal resolution that follows the host GPU load, used with bDynamicResolution.
+//
+// The user's iEFBScale is the highest scale. While the host GPU frame time measured by
+// g_gpu_profiler stays above fDynamicResolutionFrameTime the scale steps down one level of the
+// EFB scale list, and it steps up again once the time predicted for the next level fits the
+// target. UpdateActiveConfig puts the chosen scale in g_ActiveConfig, so the backends recreate
+// the EFB the same way as for a changed setting and EFB copies and the XFB follow it. Changes
+// are spaced out, each one recreates the framebuffers.
+namespace DynamicResolution
+{
+// Any thread, the scale g_ActiveConfig uses for the configured scale
+int GetEFBScale(int configured_scale);
+
+// Video thread, once per presented frame
+void OnPresent();
+void Reset();
+}
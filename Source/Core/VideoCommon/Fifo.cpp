@@ -13,6 +13,8 @@
 #include "Common/FPURoundMode.h"
 #include "Common/MemoryUtil.h"
 #include "Common/MsgHandler.h"
+#include "Common/Timer.h"
+#include "Common/Trace.h"
 
 #include "Core/ConfigManager.h"
 #include "Core/CoreTiming.h"
@@ -26,7 +28,10 @@
 #include "VideoCommon/CommandProcessor.h"
 #include "VideoCommon/DataReader.h"
 #include "VideoCommon/Fifo.h"
+#include "VideoCommon/FrameTelemetry.h"
 #include "VideoCommon/OpcodeDecoding.h"
+#include "VideoCommon/OpcodeDecodingSC.h"
+#include "VideoCommon/Statistics.h"
 #include "VideoCommon/VertexLoaderManager.h"
 #include "VideoCommon/VertexManagerBase.h"
 #include "VideoCommon/VideoConfig.h"
@@ -50,6 +55,14 @@ static u8* s_fifo_aux_read_ptr;
 // This could be in SConfig, but it depends on multiple settings
 // and can change at runtime.
 static bool s_use_deterministic_gpu_thread;
+// Times the CPU thread waited for the deterministic GPU thread to catch up
+static std::atomic<u32> s_deterministic_syncs{ 0 };
+
+// Set by the GPU thread while the predictive fifo worker is running.
+static Common::Flag s_use_predictive_fifo;
+// Amount of fifo data copied to s_video_buffer, in the same units as
+// OpcodeDecoderSC_GetPushOffset. Owned by the GPU thread.
+static u64 s_gpu_fifo_offset;
 
 static CoreTiming::EventType* s_event_sync_gpu;
 
@@ -116,6 +129,7 @@ void Init()
 {
 	// Padded so that SIMD overreads in the vertex loader are safe
 	s_video_buffer = static_cast<u8*>(Common::AllocateMemoryPages(FIFO_SIZE + 4));
+	OpcodeDecoderSC_Init();
 	ResetVideoBuffer();
 	if (SConfig::GetInstance().bCPUThread)
 		s_gpu_mainloop.Prepare();
@@ -127,6 +141,7 @@ void Shutdown()
 	if (s_gpu_mainloop.IsRunning())
 		PanicAlert("Fifo shutting down while active");
 
+	OpcodeDecoderSC_Shutdown();
 	Common::FreeMemoryPages(s_video_buffer, FIFO_SIZE + 4);
 	s_video_buffer = nullptr;
 	s_video_buffer_write_ptr = nullptr;
@@ -159,11 +174,26 @@ void EmulatorState(bool running)
 		s_gpu_mainloop.AllowSleep();
 }
 
+// Start time for the FrameTelemetry thread times, 0 when they aren't kept
+static u64 TelemetryStart()
+{
+	return g_ActiveConfig.bFrameTelemetry ? Common::Timer::GetTimeUs() : 0;
+}
+
+static void WaitForGpuMainLoop()
+{
+	const u64 start = TelemetryStart();
+	s_gpu_mainloop.Wait();
+	if (start)
+		FrameTelemetry::AddCPUWaitTime(Common::Timer::GetTimeUs() - start);
+}
+
 void SyncGPU(SyncGPUReason reason, bool may_move_read_ptr)
 {
 	if (s_use_deterministic_gpu_thread)
 	{
-		s_gpu_mainloop.Wait();
+		s_deterministic_syncs.fetch_add(1, std::memory_order_relaxed);
+		WaitForGpuMainLoop();
 		if (!s_gpu_mainloop.IsRunning())
 			return;
 
@@ -243,6 +273,7 @@ static void ReadDataFromFifo(u32 readPtr)
 	// Copy new video instructions to s_video_buffer for future use in rendering the new picture
 	Memory::CopyFromEmu(s_video_buffer_write_ptr, readPtr, len);
 	s_video_buffer_write_ptr += len;
+	s_gpu_fifo_offset += len;
 }
 
 // The deterministic_gpu_thread version.
@@ -290,6 +321,23 @@ void ResetVideoBuffer()
 	s_video_buffer_pp_read_ptr = s_video_buffer;
 	s_fifo_aux_write_ptr = s_fifo_aux_data;
 	s_fifo_aux_read_ptr = s_fifo_aux_data;
+	ResetPredictiveFifo();
+}
+
+// Must be called while the GPU thread isn't reading from the fifo.
+void ResetPredictiveFifo()
+{
+	if (!s_use_predictive_fifo.IsSet())
+		return;
+	u32 distance = CommandProcessor::fifo.CPReadWriteDistance;
+	s_gpu_fifo_offset = OpcodeDecoderSC_GetPushOffset() - distance -
+		(s_video_buffer_write_ptr - s_video_buffer_read_ptr);
+	OpcodeDecoderSC_Reset();
+}
+
+bool UsePredictiveFifo()
+{
+	return s_use_predictive_fifo.IsSet();
 }
 
 // Description: Main FIFO update loop
@@ -299,6 +347,13 @@ void RunGpuLoop()
 	AsyncRequests::GetInstance()->SetEnable(true);
 	AsyncRequests::GetInstance()->SetPassthrough(false);
 
+	if (g_ActiveConfig.bPredictiveFifo && !s_use_deterministic_gpu_thread)
+	{
+		s_gpu_fifo_offset = OpcodeDecoderSC_GetPushOffset() - CommandProcessor::fifo.CPReadWriteDistance;
+		OpcodeDecoderSC_Start();
+		s_use_predictive_fifo.Set();
+	}
+
 	s_gpu_mainloop.Run(
 		[] {
 		const SConfig& param = SConfig::GetInstance();
@@ -309,6 +364,9 @@ void RunGpuLoop()
 		if (!s_emu_running_state.IsSet())
 			return;
 
+		TRACE_ZONE("Fifo::RunGpuLoop");
+		const u64 telemetry_start = TelemetryStart();
+
 		if (s_use_deterministic_gpu_thread)
 		{
 			AsyncRequests::GetInstance()->PullEvents();
@@ -319,6 +377,7 @@ void RunGpuLoop()
 			// See comment in SyncGPU
 			if (write_ptr > seen_ptr)
 			{
+				TRACE_ZONE("OpcodeDecoder::Run");
 				g_VideoData.SetReadPosition(s_video_buffer_read_ptr, write_ptr);
 				s_video_buffer_read_ptr = OpcodeDecoder::Run<false>(g_VideoData, nullptr);
 				s_video_buffer_seen_ptr = write_ptr;
@@ -356,6 +415,8 @@ void RunGpuLoop()
 				u8* write_ptr = s_video_buffer_write_ptr;
 				g_VideoData.SetReadPosition(s_video_buffer_read_ptr, write_ptr);
 				s_video_buffer_read_ptr = OpcodeDecoder::Run(g_VideoData, &cyclesExecuted);
+				if (s_use_predictive_fifo.IsSet())
+					OpcodeDecoderSC_SyncPoint(s_gpu_fifo_offset - (write_ptr - s_video_buffer_read_ptr));
 
 				Common::AtomicStore(fifo.CPReadPointer, readPtr);
 				Common::AtomicAdd(fifo.CPReadWriteDistance, -32);
@@ -392,9 +453,15 @@ void RunGpuLoop()
 			// Make sure VertexManager finishes drawing any primitives it has stored in it's buffer.
 			VertexManagerBase::Flush();
 		}
+
+		if (telemetry_start)
+			FrameTelemetry::AddGPUTime(Common::Timer::GetTimeUs() - telemetry_start);
 	},
 		100);
 
+	if (s_use_predictive_fifo.TestAndClear())
+		OpcodeDecoderSC_Stop();
+
 	AsyncRequests::GetInstance()->SetEnable(false);
 	AsyncRequests::GetInstance()->SetPassthrough(true);
 }
@@ -406,7 +473,7 @@ void FlushGpu()
 	if (!param.bCPUThread || s_use_deterministic_gpu_thread)
 		return;
 
-	s_gpu_mainloop.Wait();
+	WaitForGpuMainLoop();
 }
 
 void GpuMaySleep()
@@ -414,6 +481,21 @@ void GpuMaySleep()
 	s_gpu_mainloop.AllowSleep();
 }
 
+void UpdateGpuThreadStats()
+{
+	static u64 s_last_wakeups = 0;
+	static u64 s_last_spin_time_us = 0;
+
+	const u64 wakeups = s_gpu_mainloop.GetWakeupCount();
+	const u64 spin_time_us = s_gpu_mainloop.GetSpinTimeUs();
+	SETSTAT(stats.thisFrame.numGpuThreadWakeups, wakeups - s_last_wakeups);
+	SETSTAT(stats.thisFrame.gpuThreadSpinUs, spin_time_us - s_last_spin_time_us);
+	s_last_wakeups = wakeups;
+	s_last_spin_time_us = spin_time_us;
+
+	SETSTAT(stats.thisFrame.numDeterministicGpuSyncs, s_deterministic_syncs.exchange(0));
+}
+
 bool AtBreakpoint()
 {
 	SCPFifoStruct& fifo = CommandProcessor::fifo;
@@ -444,8 +526,11 @@ void RunGpu()
 
 static int RunGpuOnCpu(int ticks)
 {
+	TRACE_ZONE("Fifo::RunGpuOnCpu");
 	SCPFifoStruct& fifo = CommandProcessor::fifo;
 	bool reset_simd_state = false;
+	bool committed_chunks = false;
+	const u64 telemetry_start = TelemetryStart();
 	int available_ticks = int(ticks * SConfig::GetInstance().fSyncGpuOverclock) + s_sync_ticks.load();
 	while (fifo.bFF_GPReadEnable && fifo.CPReadWriteDistance && !AtBreakpoint() &&
 		available_ticks >= 0)
@@ -453,7 +538,7 @@ static int RunGpuOnCpu(int ticks)
 		if (s_use_deterministic_gpu_thread)
 		{
 			ReadDataFromFifoOnCPU(fifo.CPReadPointer);
-			s_gpu_mainloop.Wakeup();
+			committed_chunks = true;
 		}
 		else
 		{
@@ -478,6 +563,12 @@ static int RunGpuOnCpu(int ticks)
 		fifo.CPReadWriteDistance -= 32;
 	}
 
+	// The preprocessed chunks of this time slot are handed to the GPU thread at once. The slots
+	// are CoreTiming events, so the GPU thread trails the CPU by a replay stable amount and is
+	// woken once per slot instead of once per 32 bytes.
+	if (committed_chunks)
+		s_gpu_mainloop.Wakeup();
+
 	CommandProcessor::SetCPStatusFromGPU();
 
 	if (reset_simd_state)
@@ -485,6 +576,9 @@ static int RunGpuOnCpu(int ticks)
 		FPURoundMode::LoadSIMDState();
 	}
 
+	if (telemetry_start)
+		FrameTelemetry::AddGPUTime(Common::Timer::GetTimeUs() - telemetry_start);
+
 	// Discard all available ticks as there is nothing to do any more.
 	s_sync_ticks.store(std::min(available_ticks, 0));
 
@@ -569,7 +663,12 @@ static int WaitForGpuThread(int ticks)
 
 	// Wait for GPU
 	if (now >= param.iSyncGpuMaxDistance)
+	{
+		const u64 telemetry_start = TelemetryStart();
 		s_sync_wakeup_event.Wait();
+		if (telemetry_start)
+			FrameTelemetry::AddCPUWaitTime(Common::Timer::GetTimeUs() - telemetry_start);
+	}
 
 	return GPU_TIME_SLOT_SIZE;
 }
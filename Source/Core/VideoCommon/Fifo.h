@@ -42,10 +42,14 @@ void* PopFifoAuxBuffer(size_t size);
 void FlushGpu();
 void RunGpu();
 void GpuMaySleep();
+// Stores the GPU thread wakeups and spin time since the last call in stats.thisFrame
+void UpdateGpuThreadStats();
 void RunGpuLoop();
 void ExitGpuLoop();
 void EmulatorState(bool running);
 bool AtBreakpoint();
 void ResetVideoBuffer();
+void ResetPredictiveFifo();
+bool UsePredictiveFifo();
 
 } // namespace Fifo
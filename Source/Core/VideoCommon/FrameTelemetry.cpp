@@ -0,0 +1,303 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Common/StringUtil.h"
+#include "Common/Timer.h"
+#include "Common/Logging/Log.h"
+
+#include "VideoCommon/FrameTelemetry.h"
+#include "VideoCommon/GPUProfilerBase.h"
+#include "VideoCommon/OnScreenDisplay.h"
+#include "VideoCommon/Statistics.h"
+#include "VideoCommon/VideoConfig.h"
+
+namespace FrameTelemetry
+{
+static_assert(GPU_PASS_COUNT == 5, "Update the telemetry columns");
+
+static std::atomic<u64> s_cpu_wait_us{ 0 };
+static std::atomic<u64> s_gpu_time_us{ 0 };
+static std::atomic<bool> s_export_requested{ false };
+
+// Only touched by the video thread
+static std::array<Sample, FRAME_COUNT> s_samples;
+static size_t s_next_sample = 0;
+static size_t s_sample_count = 0;
+static u64 s_last_present_us = 0;
+static int s_last_shaders_created = 0;
+
+static std::mutex s_boot_lock;
+static std::vector<BootStep> s_boot_steps;
+static u64 s_boot_start_us = 0;
+// Set by BeginBoot, cleared by the first present after it
+static std::atomic<bool> s_first_frame_pending{ false };
+
+static int GetShadersCreated()
+{
+	return stats.numVertexShadersCreated + stats.numPixelShadersCreated +
+		stats.numGeometryShadersCreated + stats.numHullShadersCreated +
+		stats.numDomainShadersCreated;
+}
+
+void AddCPUWaitTime(u64 us)
+{
+	s_cpu_wait_us.fetch_add(us, std::memory_order_relaxed);
+}
+
+void AddGPUTime(u64 us)
+{
+	s_gpu_time_us.fetch_add(us, std::memory_order_relaxed);
+}
+
+void RequestExport()
+{
+	s_export_requested.store(true);
+}
+
+void BeginBoot()
+{
+	std::lock_guard<std::mutex> guard(s_boot_lock);
+	s_boot_steps.clear();
+	s_boot_start_us = Common::Timer::GetTimeUs();
+	s_first_frame_pending.store(true);
+}
+
+void AddBootStep(const std::string& name, u64 start_us)
+{
+	const u64 now = Common::Timer::GetTimeUs();
+	std::lock_guard<std::mutex> guard(s_boot_lock);
+	const u64 start = std::max(start_us, s_boot_start_us);
+	s_boot_steps.push_back({ name, start - s_boot_start_us, now - std::min(now, start) });
+}
+
+std::vector<BootStep> GetBootSteps()
+{
+	std::lock_guard<std::mutex> guard(s_boot_lock);
+	return s_boot_steps;
+}
+
+static void LogBootSteps()
+{
+	std::string breakdown;
+	for (const BootStep& step : GetBootSteps())
+	{
+		breakdown += StringFromFormat("%s%s %.1f ms", breakdown.empty() ? "" : ", ",
+			step.name.c_str(), step.duration_us / 1000.0);
+	}
+	NOTICE_LOG(BOOT, "Boot time: %s", breakdown.c_str());
+}
+
+void OnPresent()
+{
+	const u64 now = Common::Timer::GetTimeUs();
+	if (s_first_frame_pending.exchange(false))
+	{
+		AddBootStep("first_frame", 0);
+		LogBootSteps();
+	}
+	const u64 cpu_wait = s_cpu_wait_us.exchange(0, std::memory_order_relaxed);
+	const u64 gpu_time = s_gpu_time_us.exchange(0, std::memory_order_relaxed);
+	const int shaders_created = GetShadersCreated();
+
+	// The caches reset their counters when they are cleared
+	const u32 shader_compiles = shaders_created > s_last_shaders_created ?
+		shaders_created - s_last_shaders_created : 0;
+	s_last_shaders_created = shaders_created;
+
+	// The first interval after enabling would span the time it was disabled
+	if (g_ActiveConfig.bFrameTelemetry && s_last_present_us != 0)
+	{
+		Sample& sample = s_samples[s_next_sample];
+		sample.present_interval_us = now - s_last_present_us;
+		sample.cpu_time_us = sample.present_interval_us - std::min(cpu_wait, sample.present_interval_us);
+		sample.gpu_time_us = gpu_time;
+		sample.draw_calls = stats.thisFrame.numDrawCalls;
+		sample.flushes = stats.thisFrame.numFlushes;
+		sample.shader_compiles = shader_compiles;
+		sample.texture_uploads = stats.thisFrame.numTextureUploads;
+		for (u32 i = 0; i < GPU_PASS_COUNT; i++)
+			sample.gpu_pass_us[i] = g_gpu_profiler ?
+				static_cast<u32>(g_gpu_profiler->GetPassTimes()[i] * 1000.0f) : 0;
+		s_next_sample = (s_next_sample + 1) % FRAME_COUNT;
+		s_sample_count = std::min(s_sample_count + 1, FRAME_COUNT);
+	}
+	s_last_present_us = g_ActiveConfig.bFrameTelemetry ? now : 0;
+
+	if (s_export_requested.exchange(false))
+		Export();
+}
+
+void Reset()
+{
+	s_next_sample = 0;
+	s_sample_count = 0;
+	s_last_present_us = 0;
+	s_last_shaders_created = GetShadersCreated();
+	s_cpu_wait_us.store(0);
+	s_gpu_time_us.store(0);
+}
+
+std::vector<Sample> GetSamples()
+{
+	std::vector<Sample> samples;
+	samples.reserve(s_sample_count);
+	const size_t first = (s_next_sample + FRAME_COUNT - s_sample_count) % FRAME_COUNT;
+	for (size_t i = 0; i < s_sample_count; i++)
+		samples.push_back(s_samples[(first + i) % FRAME_COUNT]);
+	return samples;
+}
+
+// Nearest rank percentile of sorted values
+static u64 Percentile(const std::vector<u64>& sorted, double percentile)
+{
+	size_t rank = static_cast<size_t>(std::ceil(percentile * sorted.size()));
+	return sorted[std::max<size_t>(rank, 1) - 1];
+}
+
+static Distribution Distribute(std::vector<u64> values)
+{
+	Distribution distribution = {};
+	if (values.empty())
+		return distribution;
+
+	std::sort(values.begin(), values.end());
+	u64 total = 0;
+	for (u64 value : values)
+		total += value;
+	distribution.average_ms = total / 1000.0 / values.size();
+	distribution.median_ms = Percentile(values, 0.5) / 1000.0;
+	distribution.p99_ms = Percentile(values, 0.99) / 1000.0;
+	distribution.p999_ms = Percentile(values, 0.999) / 1000.0;
+	distribution.max_ms = values.back() / 1000.0;
+	return distribution;
+}
+
+static double ToFPS(double ms)
+{
+	return ms > 0.0 ? 1000.0 / ms : 0.0;
+}
+
+Summary Summarize(const std::vector<Sample>& samples)
+{
+	std::vector<u64> present_interval, cpu_time, gpu_time;
+	present_interval.reserve(samples.size());
+	cpu_time.reserve(samples.size());
+	gpu_time.reserve(samples.size());
+	for (const Sample& sample : samples)
+	{
+		present_interval.push_back(sample.present_interval_us);
+		cpu_time.push_back(sample.cpu_time_us);
+		gpu_time.push_back(sample.gpu_time_us);
+	}
+
+	Summary summary = {};
+	summary.frames = samples.size();
+	summary.present_interval = Distribute(std::move(present_interval));
+	summary.cpu_time = Distribute(std::move(cpu_time));
+	summary.gpu_time = Distribute(std::move(gpu_time));
+	summary.average_fps = ToFPS(summary.present_interval.average_ms);
+	summary.low_1_fps = ToFPS(summary.present_interval.p99_ms);
+	summary.low_01_fps = ToFPS(summary.present_interval.p999_ms);
+	return summary;
+}
+
+std::string ToCSV(const std::vector<Sample>& samples)
+{
+	std::string csv = "frame,present_interval_us,cpu_time_us,gpu_time_us,draw_calls,flushes,"
+		"shader_compiles,texture_uploads,gpu_efb_draw_us,gpu_efb_copy_us,gpu_xfb_us,"
+		"gpu_post_processing_us,gpu_present_us\n";
+	for (size_t i = 0; i < samples.size(); i++)
+	{
+		const Sample& sample = samples[i];
+		csv += StringFromFormat("%zu,%llu,%llu,%llu,%u,%u,%u,%u,%u,%u,%u,%u,%u\n", i,
+			static_cast<unsigned long long>(sample.present_interval_us),
+			static_cast<unsigned long long>(sample.cpu_time_us),
+			static_cast<unsigned long long>(sample.gpu_time_us), sample.draw_calls, sample.flushes,
+			sample.shader_compiles, sample.texture_uploads, sample.gpu_pass_us[0],
+			sample.gpu_pass_us[1], sample.gpu_pass_us[2], sample.gpu_pass_us[3],
+			sample.gpu_pass_us[4]);
+	}
+	return csv;
+}
+
+static std::string DistributionToJSON(const Distribution& distribution)
+{
+	return StringFromFormat("{\"average\": %.3f, \"median\": %.3f, \"p99\": %.3f, \"p999\": %.3f, "
+		"\"max\": %.3f}", distribution.average_ms, distribution.median_ms, distribution.p99_ms,
+		distribution.p999_ms, distribution.max_ms);
+}
+
+std::string ToJSON(const std::vector<Sample>& samples, const Summary& summary,
+	const std::vector<BootStep>& boot_steps)
+{
+	std::string json = "{\n";
+	if (!boot_steps.empty())
+	{
+		json += "  \"boot_ms\": {";
+		for (size_t i = 0; i < boot_steps.size(); i++)
+		{
+			json += StringFromFormat("%s\n    \"%s\": {\"start\": %.3f, \"duration\": %.3f}",
+				i ? "," : "", boot_steps[i].name.c_str(), boot_steps[i].start_us / 1000.0,
+				boot_steps[i].duration_us / 1000.0);
+		}
+		json += "\n  },\n";
+	}
+	json += StringFromFormat("  \"frames\": %zu,\n", summary.frames);
+	json += StringFromFormat("  \"average_fps\": %.3f,\n", summary.average_fps);
+	json += StringFromFormat("  \"low_1_fps\": %.3f,\n", summary.low_1_fps);
+	json += StringFromFormat("  \"low_01_fps\": %.3f,\n", summary.low_01_fps);
+	json += "  \"present_interval_ms\": " + DistributionToJSON(summary.present_interval) + ",\n";
+	json += "  \"cpu_time_ms\": " + DistributionToJSON(summary.cpu_time) + ",\n";
+	json += "  \"gpu_time_ms\": " + DistributionToJSON(summary.gpu_time) + ",\n";
+	json += "  \"samples\": [";
+	for (size_t i = 0; i < samples.size(); i++)
+	{
+		const Sample& sample = samples[i];
+		json += StringFromFormat("%s\n    [%llu, %llu, %llu, %u, %u, %u, %u, %u, %u, %u, %u, %u]",
+			i ? "," : "", static_cast<unsigned long long>(sample.present_interval_us),
+			static_cast<unsigned long long>(sample.cpu_time_us),
+			static_cast<unsigned long long>(sample.gpu_time_us), sample.draw_calls, sample.flushes,
+			sample.shader_compiles, sample.texture_uploads, sample.gpu_pass_us[0],
+			sample.gpu_pass_us[1], sample.gpu_pass_us[2], sample.gpu_pass_us[3],
+			sample.gpu_pass_us[4]);
+	}
+	json += "\n  ],\n";
+	json += "  \"sample_fields\": [\"present_interval_us\", \"cpu_time_us\", \"gpu_time_us\", "
+		"\"draw_calls\", \"flushes\", \"shader_compiles\", \"texture_uploads\", \"gpu_efb_draw_us\", "
+		"\"gpu_efb_copy_us\", \"gpu_xfb_us\", \"gpu_post_processing_us\", \"gpu_present_us\"]\n";
+	json += "}\n";
+	return json;
+}
+
+bool Export()
+{
+	const std::vector<Sample> samples = GetSamples();
+	const Summary summary = Summarize(samples);
+
+	const std::string path = File::GetUserPath(D_LOGS_IDX) + "frame_telemetry";
+	if (!File::WriteStringToFile(ToCSV(samples), path + ".csv") ||
+		!File::WriteStringToFile(ToJSON(samples, summary, GetBootSteps()), path + ".json"))
+	{
+		ERROR_LOG(VIDEO, "Failed to write frame telemetry to %s", path.c_str());
+		return false;
+	}
+
+	const std::string message = StringFromFormat("Frame telemetry: %zu frames, %.1f fps, "
+		"1%% low %.1f fps, 0.1%% low %.1f fps", summary.frames, summary.average_fps,
+		summary.low_1_fps, summary.low_01_fps);
+	NOTICE_LOG(VIDEO, "%s, saved to %s.csv/.json", message.c_str(), path.c_str());
+	OSD::AddMessage(message);
+	return true;
+}
+}
@@ -0,0 +1,94 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "VideoCommon/GPUProfilerBase.h"
+
+// Per frame timings and counters, kept for the last FRAME_COUNT frames so runs of different
+// builds can be compared, and stutter shows up in the 1% and 0.1% lows instead of being
+// averaged away by the fps counter.
+//
+// Samples are taken in Renderer::Swap on the video thread when bFrameTelemetry is set.
+// The CPU and GPU thread times are accumulated from the fifo code of the respective thread:
+// the GPU time is the time spent running the fifo, the CPU time is the present interval
+// minus the time the CPU thread was blocked waiting on the GPU thread. The host GPU pass
+// times come from g_gpu_profiler with bGPUProfiling, they lag a few frames behind.
+namespace FrameTelemetry
+{
+static constexpr size_t FRAME_COUNT = 4096;
+
+struct Sample
+{
+	u64 present_interval_us;
+	u64 cpu_time_us;
+	u64 gpu_time_us;
+	u32 draw_calls;
+	u32 flushes;
+	u32 shader_compiles;
+	u32 texture_uploads;
+	std::array<u32, GPU_PASS_COUNT> gpu_pass_us;
+};
+
+struct Distribution
+{
+	double average_ms;
+	double median_ms;
+	double p99_ms;
+	double p999_ms;
+	double max_ms;
+};
+
+struct Summary
+{
+	size_t frames;
+	Distribution present_interval;
+	Distribution cpu_time;
+	Distribution gpu_time;
+	// Frame rates at the average, 99th and 99.9th percentile frame times
+	double average_fps;
+	double low_1_fps;
+	double low_01_fps;
+};
+
+// One step of the last boot, relative to BeginBoot. Steps that ran concurrently overlap.
+struct BootStep
+{
+	std::string name;
+	u64 start_us;
+	u64 duration_us;
+};
+
+// Any thread
+void AddCPUWaitTime(u64 us);
+void AddGPUTime(u64 us);
+void RequestExport();
+
+// Emulation thread, at the start of a boot
+void BeginBoot();
+// Any thread, start_us is a Common::Timer::GetTimeUs time
+void AddBootStep(const std::string& name, u64 start_us);
+// The boot steps so far, the last one is the time to the first presented frame once there is one
+std::vector<BootStep> GetBootSteps();
+
+// Video thread, called once per presented frame
+void OnPresent();
+void Reset();
+
+// Oldest first
+std::vector<Sample> GetSamples();
+Summary Summarize(const std::vector<Sample>& samples);
+
+std::string ToCSV(const std::vector<Sample>& samples);
+std::string ToJSON(const std::vector<Sample>& samples, const Summary& summary,
+	const std::vector<BootStep>& boot_steps = {});
+
+// Writes frame_telemetry.csv and frame_telemetry.json to the log directory
+bool Export();
+}
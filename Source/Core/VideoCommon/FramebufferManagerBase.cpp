@@ -19,6 +19,8 @@ std::array<const XFBSourceBase*, FramebufferManagerBase::MAX_VIRTUAL_XFB> Frameb
 unsigned int FramebufferManagerBase::s_last_xfb_width = 1;
 unsigned int FramebufferManagerBase::s_last_xfb_height = 1;
 
+u64 FramebufferManagerBase::s_efb_generation = 0;
+
 unsigned int FramebufferManagerBase::m_EFBLayers = 1;
 
 FramebufferManagerBase::FramebufferManagerBase()
@@ -171,6 +173,8 @@ void FramebufferManagerBase::CopyToVirtualXFB(u32 xfbAddr, u32 fbStride, u32 fbH
 	vxfb->xfbSource->srcAddr = vxfb->xfbAddr = xfbAddr;
 	vxfb->xfbSource->srcWidth = vxfb->xfbWidth = sourceRc.GetWidth();
 	vxfb->xfbSource->srcHeight = vxfb->xfbHeight = fbHeight;
+	vxfb->xfbStride = fbStride;
+	vxfb->writtenBack = false;
 
 	vxfb->xfbSource->sourceRc = g_renderer->ConvertEFBRectangle(sourceRc);
 
@@ -181,6 +185,32 @@ void FramebufferManagerBase::CopyToVirtualXFB(u32 xfbAddr, u32 fbStride, u32 fbH
 	vxfb->xfbSource->CopyEFB(Gamma);
 }
 
+void FramebufferManagerBase::WriteBackVirtualXFB(u32 address, u32 size)
+{
+	if (!g_ActiveConfig.VirtualXFBEnabled() || !g_ActiveConfig.bVirtualXFBWriteBack ||
+		!g_ActiveConfig.backend_info.bSupportsVirtualXFBWriteBack)
+		return;
+
+	// Oldest first, so newer copies end up on top where they overlap
+	for (auto it = m_virtualXFBList.rbegin(); it != m_virtualXFBList.rend(); ++it)
+	{
+		VirtualXFB& vxfb = *it;
+		if (vxfb.writtenBack || !vxfb.xfbSource || !vxfb.xfbHeight)
+			continue;
+
+		// Partially replaced copies no longer match their texture
+		if (vxfb.xfbAddr != vxfb.xfbSource->srcAddr || vxfb.xfbHeight != vxfb.xfbSource->srcHeight)
+			continue;
+
+		if (AddressRangesOverlap(address, address + size, vxfb.xfbAddr,
+			vxfb.xfbAddr + 2 * vxfb.xfbStride * vxfb.xfbHeight))
+		{
+			vxfb.xfbSource->EncodeToRam(vxfb.xfbAddr, vxfb.xfbStride);
+			vxfb.writtenBack = true;
+		}
+	}
+}
+
 FramebufferManagerBase::VirtualXFBListType::iterator FramebufferManagerBase::FindVirtualXFB(u32 xfbAddr, u32 width, u32 height)
 {
 	const u32 srcLower = xfbAddr;
@@ -25,6 +25,10 @@ struct XFBSourceBase
 
 	virtual void CopyEFB(float Gamma) = 0;
 
+	// Encodes the virtual XFB copy into guest memory, as a real XFB copy would have done.
+	virtual void EncodeToRam(u32 xfbAddr, u32 fbStride)
+	{}
+
 	u32 srcAddr;
 	u32 srcWidth;
 	u32 srcHeight;
@@ -52,6 +56,10 @@ public:
 	static void CopyToXFB(u32 xfbAddr, u32 fbStride, u32 fbHeight, const EFBRectangle& sourceRc, float Gamma);
 	static const XFBSourceBase* const* GetXFBSource(u32 xfbAddr, u32 fbWidth, u32 fbHeight, u32* xfbCount);
 
+	// Virtual XFBs stay on the GPU, ones overlapping a range about to be read from RAM
+	// are written back to it first.
+	static void WriteBackVirtualXFB(u32 address, u32 size);
+
 	static void SetLastXfbWidth(unsigned int width)
 	{
 		s_last_xfb_width = width;
@@ -77,6 +85,18 @@ public:
 		return m_EFBLayers;
 	}
 
+	// Video thread. Counts what may change the EFB contents: draws, clears, pokes, format changes
+	// and post-processing, so that an EFB copy can tell nothing was drawn since the last one.
+	static void MarkEFBChanged()
+	{
+		s_efb_generation++;
+	}
+
+	static u64 GetEFBGeneration()
+	{
+		return s_efb_generation;
+	}
+
 protected:
 	struct VirtualXFB
 	{
@@ -87,6 +107,10 @@ protected:
 		u32 xfbAddr = 0;
 		u32 xfbWidth = 0;
 		u32 xfbHeight = 0;
+		u32 xfbStride = 0;
+
+		// Set once the copy was encoded into RAM, until the next copy to it
+		bool writtenBack = false;
 
 		std::unique_ptr<XFBSourceBase> xfbSource;
 	};
@@ -118,6 +142,8 @@ private:
 
 	static unsigned int s_last_xfb_width;
 	static unsigned int s_last_xfb_height;
+
+	static u64 s_efb_generation;
 };
 
 extern std::unique_ptr<FramebufferManagerBase> g_framebuffer_manager;
@@ -0,0 +1,101 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <array>
+#include <memory>
+#include <string>
+
+#include "Common/CommonTypes.h"
+#include "Common/StringUtil.h"
+
+#include "VideoCommon/GPUProfilerBase.h"
+#include "VideoCommon/VideoConfig.h"
+
+std::unique_ptr<GPUProfilerBase> g_gpu_profiler;
+
+void GPUProfilerBase::SetPass(GPUPass pass)
+{
+	Frame& frame = m_frames[m_current_frame];
+	if (!m_recording || (frame.count > 0 && pass == m_current_pass))
+		return;
+
+	// Keep one query for the end of the frame, the rest of the frame goes to the last pass
+	if (frame.count >= MAX_TIMESTAMPS - 1)
+		return;
+
+	WriteTimestamp(m_current_frame * MAX_TIMESTAMPS + frame.count);
+	frame.passes[frame.count++] = static_cast<u8>(pass);
+	m_current_pass = pass;
+}
+
+void GPUProfilerBase::EndFrame()
+{
+	Frame& frame = m_frames[m_current_frame];
+	if (m_recording && frame.count > 0)
+	{
+		WriteTimestamp(m_current_frame * MAX_TIMESTAMPS + frame.count);
+		frame.count++;
+		EndQueries(m_current_frame, frame.count);
+		frame.pending = true;
+		m_current_frame = (m_current_frame + 1) % FRAME_COUNT;
+		m_recording = false;
+	}
+
+	ResolveFrames();
+
+	// A frame without any pass keeps its queries for the next one
+	if (m_recording || (!g_ActiveConfig.bGPUProfiling && !g_ActiveConfig.bDynamicResolution))
+		return;
+
+	Frame& next = m_frames[m_current_frame];
+	if (next.pending)
+		return;
+
+	BeginQueries(m_current_frame);
+	next.count = 0;
+	m_recording = true;
+}
+
+void GPUProfilerBase::ResolveFrames()
+{
+	// The frames are resolved in submission order, starting with the oldest
+	for (u32 i = 0; i < FRAME_COUNT; i++)
+	{
+		const u32 index = (m_current_frame + i) % FRAME_COUNT;
+		Frame& frame = m_frames[index];
+		if (!frame.pending)
+			continue;
+
+		std::array<u64, MAX_TIMESTAMPS> timestamps;
+		u64 frequency = 0;
+		if (!GetResults(index, frame.count, timestamps.data(), &frequency))
+			break;
+
+		frame.pending = false;
+		if (frequency == 0)
+			continue;
+
+		m_pass_times.fill(0.0f);
+		for (u32 j = 0; j + 1 < frame.count; j++)
+		{
+			if (timestamps[j + 1] > timestamps[j])
+				m_pass_times[frame.passes[j]] += (timestamps[j + 1] - timestamps[j]) * 1000.0f / frequency;
+		}
+		m_resolved_frame_count++;
+	}
+}
+
+const char* GPUProfilerBase::GetPassName(GPUPass pass)
+{
+	static const char* names[GPU_PASS_COUNT] = { "EFB", "Copy", "XFB", "Post", "Present" };
+	return names[pass];
+}
+
+std::string GPUProfilerBase::ToString() const
+{
+	std::string str = "GPU:";
+	for (u32 i = 0; i < GPU_PASS_COUNT; i++)
+		str += StringFromFormat(" %s %.2f", GetPassName(static_cast<GPUPass>(i)), m_pass_times[i]);
+	return str + " ms";
+}
@@ -0,0 +1,86 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <memory>
+#include <string>
+
+#include "Common/CommonTypes.h"
+
+enum GPUPass
+{
+	GPU_PASS_EFB_DRAW = 0,
+	GPU_PASS_EFB_COPY,
+	GPU_PASS_XFB,
+	GPU_PASS_POST_PROCESSING,
+	GPU_PASS_PRESENT,
+	GPU_PASS_COUNT
+};
+
+// Measures the host GPU time spent in each pass of a frame with timestamp queries.
+//
+// A timestamp is written whenever the pass changes, the time up to the next timestamp is
+// attributed to the pass. The results of a frame are read back a few frames later without
+// stalling, if all query slots are still in flight the frame is not measured.
+// Only active while bGPUProfiling or bDynamicResolution is set.
+class GPUProfilerBase
+{
+public:
+	virtual ~GPUProfilerBase() {}
+
+	// Attributes the following host GPU commands to pass
+	void SetPass(GPUPass pass);
+
+	// Called by the backend after the last command of the frame was recorded, before the frame
+	// is submitted. Outside of any render pass.
+	void EndFrame();
+
+	// Milliseconds spent in each pass in the latest resolved frame
+	const std::array<float, GPU_PASS_COUNT>& GetPassTimes() const { return m_pass_times; }
+	// Increases whenever GetPassTimes holds the results of a newer frame
+	u32 GetResolvedFrameCount() const { return m_resolved_frame_count; }
+
+	static const char* GetPassName(GPUPass pass);
+	std::string ToString() const;
+
+protected:
+	// Frames of queries in flight
+	static constexpr u32 FRAME_COUNT = 4;
+	static constexpr u32 MAX_TIMESTAMPS = 512;
+	static constexpr u32 QUERY_COUNT = FRAME_COUNT * MAX_TIMESTAMPS;
+
+	// The queries of frame are [frame * MAX_TIMESTAMPS, frame * MAX_TIMESTAMPS + count)
+	// Called at the end of the previous frame, before the first query of frame is written.
+	virtual void BeginQueries(u32 frame) {}
+	virtual void WriteTimestamp(u32 query) = 0;
+	virtual void EndQueries(u32 frame, u32 count) {}
+	// Returns false while the results are not available yet, must not wait for them.
+	virtual bool GetResults(u32 frame, u32 count, u64* timestamps, u64* frequency) = 0;
+
+private:
+	void ResolveFrames();
+
+	struct Frame
+	{
+		std::array<u8, MAX_TIMESTAMPS> passes;
+		u32 count = 0;
+		bool pending = false;
+	};
+	std::array<Frame, FRAME_COUNT> m_frames;
+	u32 m_current_frame = 0;
+	bool m_recording = false;
+	GPUPass m_current_pass = GPU_PASS_EFB_DRAW;
+	std::array<float, GPU_PASS_COUNT> m_pass_times = {};
+	u32 m_resolved_frame_count = 0;
+};
+
+extern std::unique_ptr<GPUProfilerBase> g_gpu_profiler;
+
+inline void SetGPUPass(GPUPass pass)
+{
+	if (g_gpu_profiler)
+		g_gpu_profiler->SetPass(pass);
+}
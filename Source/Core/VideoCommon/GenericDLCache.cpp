@@ -1,52 +1,443 @@
-// Copyright (C) 2003-2009 Dolphin Project.
+// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
 
-// This program is free software: you can redistribute it and/or modify
-// it under the terms of the GNU General Public License as published by
-// the Free Software Foundation, version 2.0.
+// The cache works by running the list once through its own decoder, which executes every
+// command exactly like OpcodeDecoder::Run does while recording it. Later calls with the same
+// contents replay the pre-decoded commands. Vertices of draws that only use direct attributes
+// are stored in native format and copied straight into the vertex buffer, indexed draws still
+// go through the vertex loader because the arrays they read can change between calls.
+// Whenever the current state no longer matches what was recorded (for example a different VAT
+// changes the size of a vertex, and with it the layout of the rest of the list) the replay stops
+// and the remainder of the list is handed to OpcodeDecoder.
 
-// This program is distributed in the hope that it will be useful,
-// but WITHOUT ANY WARRANTY; without even the implied warranty of
-// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
-// GNU General Public License 2.0 for more details.
+#include <cstring>
+#include <unordered_map>
+#include <vector>
 
-// A copy of the GPL 2.0 should have been included with the program.
-// If not, see http://www.gnu.org/licenses/
+#include "Common/CommonTypes.h"
+#include "Common/Hash.h"
+#include "VideoCommon/BPMemory.h"
+#include "VideoCommon/CPMemory.h"
+#include "VideoCommon/DataReader.h"
+#include "VideoCommon/DLCache.h"
+#include "VideoCommon/OpcodeDecoding.h"
+#include "VideoCommon/Statistics.h"
+#include "VideoCommon/VertexLoaderManager.h"
+#include "VideoCommon/VertexManagerBase.h"
+#include "VideoCommon/VideoConfig.h"
+#include "VideoCommon/XFMemory.h"
 
-// Official SVN repository and contact information can be found at
-// http://code.google.com/p/dolphin-emu/
+namespace DLCache
+{
 
-// TODO: Handle cache-is-full condition :p
+// Number of calls with unchanged contents before a list gets recorded.
+constexpr u32 COMPILE_THRESHOLD = 2;
+// Lists that fail to replay this many times are not recorded again until their contents change.
+constexpr u32 MAX_REPLAY_FAILURES = 4;
+// Lists not called for this many frames are evicted.
+constexpr u32 MAX_UNUSED_FRAMES = 300;
+// Upper limit for the native vertex data kept by all lists.
+constexpr size_t MAX_VERTEX_DATA_SIZE = 64 * 1024 * 1024;
 
+enum CachedOpType : u8
+{
+	OP_LOAD_CP,
+	OP_LOAD_XF,
+	OP_LOAD_INDX,
+	OP_LOAD_BP,
+	OP_DRAW,
+};
 
-#include "Common.h"
-#include "DLCache.h"
+struct CachedOp
+{
+	CachedOpType type;
+	u8 cmd_byte;
+	u8 sub_cmd;
+	u8 primitive;       // draws
+	u32 start;          // offset of the opcode inside the list
+	u32 cycles;         // cycles of this command and the nops preceding it
+	u32 value;          // register value, for XF loads the destination address
+	u32 count;          // transfer size, index array or vertex count
+	// Draws only:
+	u32 vertex_size;
+	u32 vertex_offset;  // offset inside vertex_data, or NO_VERTEX_DATA
+	u32 final_count;
+	u32 matrix_index_a;
+	u32 matrix_index_b;
+	VertexLoaderBase* loader;
+};
 
-namespace DLCache
+constexpr u32 NO_VERTEX_DATA = 0xFFFFFFFF;
+
+struct CachedDisplayList
 {
+	u64 hash = 0;
+	u32 last_frame = 0;
+	u32 num_calls = 0;
+	u32 failures = 0;
+	u32 tail_cycles = 0;
+	bool compiled = false;
+	bool uncacheable = false;
+	std::vector<CachedOp> ops;
+	std::vector<u8> vertex_data;
+};
+
+static std::unordered_map<u64, CachedDisplayList> s_cache;
+static size_t s_vertex_data_size;
+static u32 s_frame;
+
+static void ResetEntry(CachedDisplayList& dl)
+{
+	s_vertex_data_size -= dl.vertex_data.size();
+	dl.ops.clear();
+	dl.vertex_data.clear();
+	dl.vertex_data.shrink_to_fit();
+	dl.compiled = false;
+	dl.num_calls = 0;
+	dl.tail_cycles = 0;
+}
+
+static inline bool SkipDraw()
+{
+	return xfmem.viewport.wd == 0.0f
+		|| xfmem.viewport.ht == 0.0f
+		|| (bpmem.scissorBR.x + 1 - bpmem.scissorTL.x) == 0
+		|| (bpmem.scissorBR.y + 1 - bpmem.scissorTL.y) == 0;
+}
+
+static inline void SetupDrawParameters(VertexLoaderParameters& parameters, u8 cmd_byte, u32 count, u8* source, size_t buf_size)
+{
+	CPState& state = g_main_cp_state;
+	u32 vtx_attr_group = cmd_byte & GX_VAT_MASK;
+	parameters.count = count;
+	parameters.buf_size = buf_size;
+	parameters.primitive = (cmd_byte & GX_PRIMITIVE_MASK) >> GX_PRIMITIVE_SHIFT;
+	parameters.vtx_attr_group = vtx_attr_group;
+	parameters.needloaderrefresh = (state.attr_dirty & (1u << vtx_attr_group)) != 0;
+	parameters.skip_draw = SkipDraw();
+	parameters.VtxDesc = &state.vtx_desc;
+	parameters.VtxAttr = &state.vtx_attr[vtx_attr_group];
+	parameters.source = source;
+	state.attr_dirty &= ~(1 << vtx_attr_group);
+}
+
+// Vertices can only be kept if the loader output depends on nothing but the list itself.
+static inline bool CanStoreVertices()
+{
+	if (g_ActiveConfig.iBBoxMode == BBoxCPU)
+		return false;
+	for (int i = 0; i < 12; i++)
+	{
+		if (g_main_cp_state.vtx_desc.GetVertexArrayStatus(i) >= 0x2)
+			return false;
+	}
+	return true;
+}
+
+static u32 RunRemainder(u8* data, u32 offset, u32 size)
+{
+	u32 cycles = 0;
+	g_VideoData.SetReadPosition(data + offset, data + size);
+	OpcodeDecoder::Run<false, false>(g_VideoData, &cycles);
+	return cycles;
+}
+
+// Executes the list like OpcodeDecoder::Run<false, false> while recording every command.
+// Anything the cache can't represent stops the recording and the rest of the list
+// is interpreted normally.
+static u32 CompileAndRun(CachedDisplayList& dl, u8* data, u32 size)
+{
+	DataReader reader(data, data + size);
+	u32 total_cycles = 0;
+	u32 pending_cycles = 0;
+	bool failed = false;
+	while (reader.size())
+	{
+		u8* opcode_start = reader.GetReadPosition();
+		u8 cmd_byte = reader.Read<u8>();
+		size_t distance = reader.size();
+		CachedOp op = {};
+		op.cmd_byte = cmd_byte;
+		op.start = u32(opcode_start - data);
+		switch (cmd_byte)
+		{
+		case GX_NOP:
+		case GX_UNKNOWN_RESET:
+		case GX_CMD_UNKNOWN_METRICS:
+		case GX_CMD_INVL_VC:
+			pending_cycles += GX_NOP_CYCLES;
+			continue;
+		case GX_LOAD_CP_REG:
+			if (distance < GX_LOAD_CP_REG_SIZE)
+			{
+				failed = true;
+				break;
+			}
+			op.type = OP_LOAD_CP;
+			op.cycles = GX_LOAD_CP_REG_CYCLES;
+			op.sub_cmd = reader.Read<u8>();
+			op.value = reader.Read<u32>();
+			LoadCPReg<false>(op.sub_cmd, op.value);
+			INCSTAT(stats.thisFrame.numCPLoads);
+			break;
+		case GX_LOAD_XF_REG:
+		{
+			if (distance < GX_LOAD_XF_REG_SIZE)
+			{
+				failed = true;
+				break;
+			}
+			u32 cmd2 = reader.Read<u32>();
+			u32 transfer_size = ((cmd2 >> 16) & 15) + 1;
+			if (distance - GX_LOAD_XF_REG_SIZE < transfer_size * sizeof(u32))
+			{
+				failed = true;
+				break;
+			}
+			op.type = OP_LOAD_XF;
+			op.cycles = GX_LOAD_XF_REG_BASE_CYCLES + GX_LOAD_XF_REG_TRANSFER_CYCLES * transfer_size;
+			op.value = cmd2 & 0xFFFF;
+			op.count = transfer_size;
+			g_VideoData.SetReadPosition(reader.GetReadPosition(), data + size);
+			LoadXFReg(transfer_size, op.value);
+			reader.ReadSkip(transfer_size * sizeof(u32));
+			INCSTAT(stats.thisFrame.numXFLoads);
+			break;
+		}
+		case GX_LOAD_INDX_A:
+		case GX_LOAD_INDX_B:
+		case GX_LOAD_INDX_C:
+		case GX_LOAD_INDX_D:
+			if (distance < GX_LOAD_INDX_SIZE)
+			{
+				failed = true;
+				break;
+			}
+			op.type = OP_LOAD_INDX;
+			op.cycles = GX_LOAD_INDX_CYCLES;
+			op.value = reader.Read<u32>();
+			op.count = (cmd_byte >> 3) + 8;
+			LoadIndexedXF(op.value, op.count);
+			break;
+		case GX_LOAD_BP_REG:
+			if (distance < GX_LOAD_BP_REG_SIZE)
+			{
+				failed = true;
+				break;
+			}
+			op.type = OP_LOAD_BP;
+			op.cycles = GX_LOAD_BP_REG_CYCLES;
+			op.value = reader.Read<u32>();
+			LoadBPReg(op.value);
+			INCSTAT(stats.thisFrame.numBPLoads);
+			break;
+		default:
+		{
+			// Nested display lists and unknown opcodes are left to OpcodeDecoder.
+			if ((cmd_byte & GX_DRAW_PRIMITIVES) != 0x80 || distance < GX_DRAW_PRIMITIVES_SIZE)
+			{
+				failed = true;
+				break;
+			}
+			u32 count = reader.Read<u16>();
+			distance -= GX_DRAW_PRIMITIVES_SIZE;
+			op.type = OP_DRAW;
+			op.count = count;
+			op.cycles = GX_NOP_CYCLES;
+			op.vertex_offset = NO_VERTEX_DATA;
+			if (!count)
+				break;
+			VertexLoaderParameters parameters;
+			SetupDrawParameters(parameters, cmd_byte, count, reader.GetReadPosition(), distance);
+			VertexLoaderBase* loader = VertexLoaderManager::GetLoader(parameters);
+			parameters.needloaderrefresh = false;
+			bool store_vertices = !parameters.skip_draw && CanStoreVertices()
+				&& s_vertex_data_size < MAX_VERTEX_DATA_SIZE;
+			u32 readsize = 0;
+			u32 writesize = 0;
+			if (!VertexLoaderManager::ConvertVertices(parameters, readsize, writesize))
+			{
+				failed = true;
+				break;
+			}
+			op.primitive = u8(parameters.primitive);
+			op.cycles += GX_DRAW_PRIMITIVES_CYCLES * count;
+			op.vertex_size = loader->m_VertexSize;
+			op.loader = loader;
+			op.matrix_index_a = g_main_cp_state.matrix_index_a.Hex;
+			op.matrix_index_b = g_main_cp_state.matrix_index_b.Hex;
+			// A draw culled with bCPUCull has no vertices to keep
+			if (store_vertices && writesize != 0)
+			{
+				op.vertex_offset = u32(dl.vertex_data.size());
+				op.final_count = writesize / loader->m_native_stride;
+				dl.vertex_data.insert(dl.vertex_data.end(), VertexManagerBase::s_pCurBufferPointer,
+					VertexManagerBase::s_pCurBufferPointer + writesize);
+				s_vertex_data_size += writesize;
+			}
+			reader.ReadSkip(readsize);
+			VertexManagerBase::s_pCurBufferPointer += writesize;
+			break;
+		}
+		}
+		if (failed)
+		{
+			total_cycles += pending_cycles + RunRemainder(data, op.start, size);
+			break;
+		}
+		op.cycles += pending_cycles;
+		pending_cycles = 0;
+		total_cycles += op.cycles;
+		dl.ops.push_back(op);
+	}
+	if (failed)
+	{
+		ResetEntry(dl);
+		dl.uncacheable = true;
+		return total_cycles;
+	}
+	dl.tail_cycles = pending_cycles;
+	dl.compiled = true;
+	dl.ops.shrink_to_fit();
+	dl.vertex_data.shrink_to_fit();
+	return total_cycles + pending_cycles;
+}
+
+// Returns false if the draw doesn't match the recording anymore.
+static inline bool ReplayDraw(const CachedDisplayList& dl, const CachedOp& op, u8* data, u32 size)
+{
+	u32 data_offset = op.start + 1 + GX_DRAW_PRIMITIVES_SIZE;
+	VertexLoaderParameters parameters;
+	SetupDrawParameters(parameters, op.cmd_byte, op.count, data + data_offset, size - data_offset);
+	VertexLoaderBase* loader = VertexLoaderManager::GetLoader(parameters);
+	parameters.needloaderrefresh = false;
+	if (u32(loader->m_VertexSize) != op.vertex_size)
+		return false;
+	if (parameters.skip_draw)
+		return true;
+	if (op.vertex_offset != NO_VERTEX_DATA
+		&& loader == op.loader
+		&& g_main_cp_state.matrix_index_a.Hex == op.matrix_index_a
+		&& g_main_cp_state.matrix_index_b.Hex == op.matrix_index_b
+		&& g_ActiveConfig.iBBoxMode != BBoxCPU)
+	{
+		VertexManagerBase::s_pCurBufferPointer += VertexLoaderManager::AppendConvertedVertices(
+			loader, op.primitive, &dl.vertex_data[op.vertex_offset], op.final_count);
+		return true;
+	}
+	u32 readsize = 0;
+	u32 writesize = 0;
+	if (!VertexLoaderManager::ConvertVertices(parameters, readsize, writesize))
+		return false;
+	VertexManagerBase::s_pCurBufferPointer += writesize;
+	return true;
+}
+
+static u32 Replay(CachedDisplayList& dl, u8* data, u32 size)
+{
+	u32 total_cycles = 0;
+	for (const CachedOp& op : dl.ops)
+	{
+		switch (op.type)
+		{
+		case OP_LOAD_CP:
+			LoadCPReg<false>(op.sub_cmd, op.value);
+			INCSTAT(stats.thisFrame.numCPLoads);
+			break;
+		case OP_LOAD_XF:
+			g_VideoData.SetReadPosition(data + op.start + 1 + GX_LOAD_XF_REG_SIZE, data + size);
+			LoadXFReg(op.count, op.value);
+			INCSTAT(stats.thisFrame.numXFLoads);
+			break;
+		case OP_LOAD_INDX:
+			LoadIndexedXF(op.value, op.count);
+			break;
+		case OP_LOAD_BP:
+			LoadBPReg(op.value);
+			INCSTAT(stats.thisFrame.numBPLoads);
+			break;
+		case OP_DRAW:
+			if (op.count && !ReplayDraw(dl, op, data, size))
+			{
+				// Everything up to this draw has been applied, so the rest of the list
+				// can simply be interpreted with the current state.
+				u32 start = op.start;
+				if (++dl.failures >= MAX_REPLAY_FAILURES)
+					dl.uncacheable = true;
+				ResetEntry(dl);
+				return total_cycles + RunRemainder(data, start, size);
+			}
+			break;
+		}
+		total_cycles += op.cycles;
+	}
+	return total_cycles + dl.tail_cycles;
+}
 
 void Init()
 {
+	s_cache.clear();
+	s_vertex_data_size = 0;
+	s_frame = 0;
 }
 
 void Shutdown()
 {
+	Clear();
 }
 
-void Clear() 
+void Clear()
 {
+	s_cache.clear();
+	s_vertex_data_size = 0;
 }
 
 void ProgressiveCleanup()
 {
+	s_frame++;
+	auto iter = s_cache.begin();
+	while (iter != s_cache.end())
+	{
+		if (s_frame - iter->second.last_frame > MAX_UNUSED_FRAMES)
+		{
+			s_vertex_data_size -= iter->second.vertex_data.size();
+			iter = s_cache.erase(iter);
+		}
+		else
+		{
+			++iter;
+		}
+	}
+	SETSTAT(stats.numDListsAlive, s_cache.size());
 }
-}  // namespace
 
-// NOTE - outside the namespace on purpose.
-bool HandleDisplayList(u32 address, u32 size)
+bool HandleDisplayList(u32 address, u8* data, u32 size, u32* cycles)
 {
-	return false;
+	if (!size)
+		return false;
+	u64 hash = GetHash64(data, size, 0);
+	CachedDisplayList& dl = s_cache[(u64(address) << 32) | size];
+	dl.last_frame = s_frame;
+	if (dl.hash != hash)
+	{
+		ResetEntry(dl);
+		dl.hash = hash;
+		dl.failures = 0;
+		dl.uncacheable = false;
+	}
+	if (dl.uncacheable)
+		return false;
+	if (!dl.compiled)
+	{
+		if (++dl.num_calls < COMPILE_THRESHOLD)
+			return false;
+		*cycles = CompileAndRun(dl, data, size);
+		return true;
+	}
+	*cycles = Replay(dl, data, size);
+	INCSTAT(stats.thisFrame.numDListsCached);
+	return true;
 }
 
-void IncrementCheckContextId()
-{
-}
+}  // namespace DLCache
@@ -20,8 +20,6 @@
 
 #include "CPUDetect.h"
 #include "TextureDecoder.h"
-#include "OpenCL.h"
-#include "OpenCL/OCLTextureDecoder.h"
 #include "VideoConfig.h"
 
 #include "LookUpTables.h"
@@ -1060,10 +1058,7 @@ void TexDecoder_SetTexFmtOverlayOptions(bool enable, bool center)
 
 PC_TexFormat TexDecoder_Decode(u8 *dst, const u8 *src, s32 width, s32 height, s32 texformat, s32 tlutaddr, s32 tlutfmt,bool rgbaOnly)
 {
-	PC_TexFormat retval = TexDecoder_Decode_OpenCL(dst, src,
-		width, height, texformat, tlutaddr, tlutfmt, rgbaOnly);
-	if (retval == PC_TEX_FMT_NONE)
-		retval = rgbaOnly ? TexDecoder_Decode_RGBA((u32*)dst, src,
+	PC_TexFormat retval = rgbaOnly ? TexDecoder_Decode_RGBA((u32*)dst, src,
 				width, height, texformat, tlutaddr, tlutfmt)
 			: TexDecoder_Decode_real(dst, src,
 				width, height, texformat, tlutaddr, tlutfmt);
@@ -28,15 +28,28 @@ static const char* primitives_d3d[] =
 	"triangle"
 };
 
+bool IsVertexShaderStereo(u32 primitive_type)
+{
+	return g_ActiveConfig.iStereoMode > 0 && g_ActiveConfig.backend_info.bSupportsVSLayerOutput &&
+		primitive_type == PRIMITIVE_TRIANGLES && !g_ActiveConfig.bWireFrame;
+}
+
+bool IsVertexShaderExpand(u32 primitive_type)
+{
+	return primitive_type != PRIMITIVE_TRIANGLES && g_ActiveConfig.backend_info.bSupportsVSLinePointExpand &&
+		(g_ActiveConfig.bPreferVSForLinePointExpansion || !g_ActiveConfig.backend_info.bSupportsGeometryShaders) &&
+		g_ActiveConfig.iStereoMode == 0 && !g_ActiveConfig.bWireFrame;
+}
+
 void GetGeometryShaderUid(GeometryShaderUid& out, u32 primitive_type, const XFMemory &xfr, const u32 components)
 {
 	out.ClearUID();
 	geometry_shader_uid_data& uid_data = out.GetUidData<geometry_shader_uid_data>();
-	uid_data.primitive_type = primitive_type;
+	uid_data.primitive_type = IsVertexShaderExpand(primitive_type) ? PRIMITIVE_TRIANGLES : primitive_type;
 	uid_data.wireframe = g_ActiveConfig.bWireFrame;
 	uid_data.msaa = g_ActiveConfig.iMultisamples > 1;
 	uid_data.ssaa = g_ActiveConfig.iMultisamples > 1 && g_ActiveConfig.bSSAA;
-	uid_data.stereo = g_ActiveConfig.iStereoMode > 0;
+	uid_data.stereo = g_ActiveConfig.iStereoMode > 0 && !IsVertexShaderStereo(primitive_type);
 	uid_data.numTexGens = xfr.numTexGen.numTexGens;
 	uid_data.pixel_lighting = g_ActiveConfig.PixelLightingEnabled(xfr, components);
 	out.CalculateUIDHash();
@@ -51,3 +51,9 @@ typedef ShaderUid<geometry_shader_uid_data> GeometryShaderUid;
 
 void GenerateGeometryShaderCode(ShaderCode& object, const geometry_shader_uid_data& uid_data, API_TYPE ApiType);
 void GetGeometryShaderUid(GeometryShaderUid& object, u32 primitive_type, const XFMemory &xfr, const u32 components);
+// Stereo triangles can skip the geometry shader when the backend draws them once per eye with
+// instancing, the vertex shader writing the layer. Lines, points and wireframe still expand in it.
+bool IsVertexShaderStereo(u32 primitive_type);
+// Lines and points can be expanded to quads by the vertex shader instead of the geometry shader,
+// which is slow on many drivers. They are then drawn as triangles, see VertexExpand.
+bool IsVertexShaderExpand(u32 primitive_type);
@@ -3,6 +3,10 @@
 // Refer to the license.txt file included.
 // Added for Ishiiruka By Tino
 
+#include <algorithm>
+#include <string>
+#include <utility>
+
 #include "Common/CPUDetect.h"
 #include "VideoCommon/HLSLCompiler.h"
 
@@ -58,11 +62,11 @@ void ShaderCompilerWorkUnit::Release()
 
 HLSLAsyncCompiler::HLSLAsyncCompiler() :
 	m_repositoryIndex(0),
-	m_input(256),
-	m_output(256)
+	m_pendingUnits(0),
+	m_queuedUnits(0),
+	m_output(HLSL_WORK_UNIT_REPOSITORY_SIZE)
 {
-	WorkUnitRepository = new ShaderCompilerWorkUnit[256];
-	Common::ThreadPool::RegisterWorker(this);
+	WorkUnitRepository = new ShaderCompilerWorkUnit[HLSL_WORK_UNIT_REPOSITORY_SIZE];
 }
 
 void HLSLAsyncCompiler::SetCompilerFunction(pD3DCompile compilerfunc)
@@ -73,38 +77,31 @@ void HLSLAsyncCompiler::SetCompilerFunction(pD3DCompile compilerfunc)
 HLSLAsyncCompiler::~HLSLAsyncCompiler()
 {
 	delete[] WorkUnitRepository;
-	Common::ThreadPool::UnregisterWorker(this);
 }
 
-bool HLSLAsyncCompiler::NextTask()
+void HLSLAsyncCompiler::Compile(ShaderCompilerWorkUnit* unit)
 {
-	ShaderCompilerWorkUnit* unit;
-	if (m_input.try_pop(unit))
+	if (unit->GenerateCodeHandler)
 	{
-		if (unit->GenerateCodeHandler)
-		{
-			unit->GenerateCodeHandler(unit);
-		}
-		unit->cresult = PD3DCompile(unit->code.data(),
-			unit->codesize,
-			nullptr,
-			(const D3D_SHADER_MACRO*)unit->defines,
-			nullptr,
-			unit->entrypoint,
-			unit->target,
-			unit->flags, 0,
-			&unit->shaderbytecode,
-			&unit->error);
-		m_output.push(unit);
-		return true;
+		unit->GenerateCodeHandler(unit);
 	}
-	return false;
+	unit->cresult = PD3DCompile(unit->code.data(),
+		unit->codesize,
+		nullptr,
+		(const D3D_SHADER_MACRO*)unit->defines,
+		nullptr,
+		unit->entrypoint,
+		unit->target,
+		unit->flags, 0,
+		&unit->shaderbytecode,
+		&unit->error);
+	m_output.push(unit);
+	m_queuedUnits.fetch_sub(1);
 }
 ShaderCompilerWorkUnit* HLSLAsyncCompiler::NewUnit(u32 codesize)
 {
-	Common::ThreadPool::NotifyWorkPending();
 	u32 index = m_repositoryIndex.fetch_add(1);
-	ShaderCompilerWorkUnit* result = &WorkUnitRepository[index & 255];
+	ShaderCompilerWorkUnit* result = &WorkUnitRepository[index & (HLSL_WORK_UNIT_REPOSITORY_SIZE - 1)];
 	result->Clear();
 	if (result->code.size() < codesize)
 	{
@@ -115,7 +112,9 @@ ShaderCompilerWorkUnit* HLSLAsyncCompiler::NewUnit(u32 codesize)
 }
 void HLSLAsyncCompiler::CompileShaderAsync(ShaderCompilerWorkUnit* unit)
 {
-	m_input.push(unit);
+	m_pendingUnits.fetch_add(1);
+	m_queuedUnits.fetch_add(1);
+	Common::ThreadPool::Submit([this, unit] { Compile(unit); }, Common::TaskPriority::High);
 }
 void HLSLAsyncCompiler::ProcCompilationResults()
 {
@@ -125,33 +124,49 @@ void HLSLAsyncCompiler::ProcCompilationResults()
 		while (m_output.try_pop(unit))
 		{
 			unit->ResultHandler(unit);
+			m_pendingUnits.fetch_sub(1);
 		}
 	}
 }
 bool HLSLAsyncCompiler::CompilationFinished()
 {
-	return m_input.Empty();
+	return m_queuedUnits.load() == 0;
 }
 void HLSLAsyncCompiler::WaitForCompilationFinished()
 {
 	u32 loopcount = 0;
-	while (!m_input.Empty())
+	while (m_queuedUnits.load() > 0)
 	{
 		Common::cYield(loopcount++);
 	}
 }
 void HLSLAsyncCompiler::WaitForFinish()
 {
-	ShaderCompilerWorkUnit* unit;
-	WaitForCompilationFinished();
-	if (!m_output.Empty())
+	// Wait for the results of the compiled units to be handled too.
+	u32 loopcount = 0;
+	ProcCompilationResults();
+	while (m_pendingUnits.load() > 0)
 	{
-		while (m_output.try_pop(unit))
-		{
-			unit->ResultHandler(unit);
-		}
+		Common::cYield(loopcount++);
+		ProcCompilationResults();
 	}
 }
+ShaderPrecompiler::Job HLSLAsyncCompiler::PrecompileJob(const std::string& name, size_t count,
+	std::function<void(size_t)> queue)
+{
+	ShaderPrecompiler::Job job;
+	job.name = name;
+	job.count = count;
+	job.compile = std::move(queue);
+	job.ready = [this]
+	{
+		// Leave room for the units queued by a single call and by the emulation threads.
+		ProcCompilationResults();
+		return m_pendingUnits.load() < HLSL_WORK_UNIT_REPOSITORY_SIZE / 2;
+	};
+	job.finish = [this] { WaitForFinish(); };
+	return job;
+}
 
 
 
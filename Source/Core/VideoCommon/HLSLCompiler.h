@@ -4,13 +4,18 @@
 // Added for Ishiiruka By Tino
 #pragma once
 
+#include <string>
 #include <vector>
 #include <D3Dcompiler.h>
 #include "VideoCommon/ShaderGenCommon.h"
+#include "VideoCommon/ShaderPrecompiler.h"
 #include "Common/ThreadPool.h"
 
 class HLSLAsyncCompiler;
 
+// Work units are recycled in a ring, at most this many may be queued or compiling at once.
+#define HLSL_WORK_UNIT_REPOSITORY_SIZE 256
+
 class ShaderCompilerWorkUnit
 {
 	friend class HLSLAsyncCompiler;
@@ -33,28 +38,35 @@ public:
 	void Release();
 };
 
-class HLSLAsyncCompiler final : Common::IWorker
+class HLSLAsyncCompiler final
 {
 	friend class HLSLCompiler;
 	pD3DCompile PD3DCompile;
 	HLSLAsyncCompiler();
 	std::atomic<s32> m_repositoryIndex;
+	// Units queued whose result handler didn't run yet
+	std::atomic<s32> m_pendingUnits;
+	// Units queued on the thread pool and not compiled yet
+	std::atomic<s32> m_queuedUnits;
 	ShaderCompilerWorkUnit* WorkUnitRepository;
-	Common::ManyToManyQueue<ShaderCompilerWorkUnit*, Common::CircularQueue<ShaderCompilerWorkUnit*>> m_input;
 	Common::ManyToOneQueue<ShaderCompilerWorkUnit*, Common::CircularQueue<ShaderCompilerWorkUnit*>> m_output;
 	HLSLAsyncCompiler(HLSLAsyncCompiler const&);
 	void operator=(HLSLAsyncCompiler const&);
+	void Compile(ShaderCompilerWorkUnit* unit);
 public:
 	static HLSLAsyncCompiler& getInstance();
 	void SetCompilerFunction(pD3DCompile compilerfunc);
 	virtual ~HLSLAsyncCompiler();
-	bool NextTask() override;
 	ShaderCompilerWorkUnit* NewUnit(u32 codesize);
 	void CompileShaderAsync(ShaderCompilerWorkUnit* unit);
 	void ProcCompilationResults();
 	bool CompilationFinished();
 	void WaitForCompilationFinished();
 	void WaitForFinish();
+	// Startup precompilation job calling queue(index) for the shaders, each call queueing a few
+	// units at most. Queueing waits while the repository would wrap over units still in flight.
+	ShaderPrecompiler::Job PrecompileJob(const std::string& name, size_t count,
+		std::function<void(size_t)> queue);
 };
 
 class HLSLCompiler
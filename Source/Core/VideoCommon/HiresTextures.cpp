@@ -4,11 +4,15 @@
 
 #include <algorithm>
 #include <cinttypes>
+#include <condition_variable>
 #include <cstring>
+#include <deque>
+#include <list>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 #include <xxhash.h>
@@ -22,6 +26,7 @@
 #include "Common/MemoryUtil.h"
 #include "Common/StringUtil.h"
 #include "Common/Thread.h"
+#include "Common/ThreadPool.h"
 #include "Common/Timer.h"
 #include "Common/Logging/Log.h"
 
@@ -30,6 +35,8 @@
 #include "VideoCommon/ImageLoader.h"
 #include "VideoCommon/HiresTextures.h"
 #include "VideoCommon/OnScreenDisplay.h"
+#include "VideoCommon/ScratchMemory.h"
+#include "VideoCommon/TexturePack.h"
 #include "VideoCommon/TextureUtil.h"
 #include "VideoCommon/VideoConfig.h"
 
@@ -38,9 +45,13 @@ struct hires_mip_level
 	bool is_compressed;
 	std::string path;
 	std::string extension;
-	hires_mip_level() : is_compressed(false), path(), extension()
+	// Points into the texture pack for packed files
+	const u8* data;
+	size_t size;
+	hires_mip_level() : is_compressed(false), path(), extension(), data(nullptr), size(0)
 	{}
-	hires_mip_level(const std::string &p, const std::string &e, bool compressed) : is_compressed(compressed), path(p), extension(e)
+	hires_mip_level(const std::string &p, const std::string &e, bool compressed, const u8* d, size_t sz) :
+		is_compressed(compressed), path(p), extension(e), data(d), size(sz)
 	{}
 };
 
@@ -77,16 +88,89 @@ struct HiresTextureCacheItem
 typedef std::unordered_map<std::string, HiresTextureCacheItem> HiresTextureCache;
 static HiresTextureCache s_textureMap;
 
-static std::unordered_map<std::string, std::shared_ptr<HiresTexture>> s_textureCache;
+// The cached textures are kept in least recently used order, the front of s_textureLRU is the
+// most recent one. When size_sum would exceed max_mem the tail is evicted, evicted textures
+// are loaded again in the background on their next use.
+// Everything is guarded by s_textureCacheMutex.
+struct CachedTexture
+{
+	std::shared_ptr<HiresTexture> texture;
+	std::list<std::string>::iterator lru;
+};
+static std::unordered_map<std::string, CachedTexture> s_textureCache;
+static std::list<std::string> s_textureLRU;
+static std::unordered_set<std::string> s_evictedTextures;
 static std::mutex s_textureCacheMutex;
 static Common::Flag s_textureCacheAbortLoading;
 
 static bool s_check_new_format;
 static std::atomic<size_t> size_sum;
 static size_t max_mem = 0;
-static std::thread s_prefetcher;
+// Prefetching runs one low priority task per texture
+static Common::TaskGroup s_prefetch_group;
+static std::atomic<size_t> s_prefetch_remaining;
+static u32 s_prefetch_start_time;
+static TexturePack s_texture_pack;
+
+// Streaming loads the custom textures on misses in s_streamer while the native texture is
+// used. Finished textures wait in s_streamed_textures until the texture cache reloads them.
+// Everything is guarded by s_textureCacheMutex.
+static std::thread s_streamer;
+static std::condition_variable s_stream_cv;
+static bool s_stream_exit = false;
+static std::deque<std::string> s_stream_queue;
+// Queued, loading, failed or waiting to be used, so each texture is requested only once
+static std::unordered_set<std::string> s_stream_requested;
+static std::unordered_map<std::string, std::shared_ptr<HiresTexture>> s_streamed_textures;
+static std::deque<std::string> s_stream_ready;
 
 static const std::string s_format_prefix = "tex1_";
+
+static void ClearCachedTextures()
+{
+	s_textureCache.clear();
+	s_textureLRU.clear();
+	s_evictedTextures.clear();
+	size_sum.store(0);
+}
+
+static void EraseCachedTexture(std::unordered_map<std::string, CachedTexture>::iterator iter)
+{
+	size_sum.fetch_sub(iter->second.texture->m_cached_data_size);
+	s_textureLRU.erase(iter->second.lru);
+	s_textureCache.erase(iter);
+}
+
+// Evicts the least recently used textures until required more bytes fit into the budget
+static void EvictCachedTextures(size_t required)
+{
+	while (!s_textureLRU.empty() && size_sum.load() + required > max_mem)
+	{
+		auto iter = s_textureCache.find(s_textureLRU.back());
+		s_evictedTextures.insert(iter->first);
+		EraseCachedTexture(iter);
+	}
+}
+
+static void InsertCachedTexture(const std::string& basename, std::shared_ptr<HiresTexture> ptr)
+{
+	auto iter = s_textureCache.find(basename);
+	if (iter != s_textureCache.end())
+	{
+		EraseCachedTexture(iter);
+	}
+	EvictCachedTextures(ptr->m_cached_data_size);
+	s_textureLRU.push_front(basename);
+	size_sum.fetch_add(ptr->m_cached_data_size);
+	s_textureCache.emplace(basename, CachedTexture{ std::move(ptr), s_textureLRU.begin() });
+	s_evictedTextures.erase(basename);
+}
+
+static void TouchCachedTexture(std::unordered_map<std::string, CachedTexture>::iterator iter)
+{
+	s_textureLRU.splice(s_textureLRU.begin(), s_textureLRU, iter->second.lru);
+}
+
 HiresTexture::HiresTexture() :
 	m_format(PC_TEX_FMT_NONE),
 	m_height(0),
@@ -99,23 +183,18 @@ HiresTexture::HiresTexture() :
 void HiresTexture::Init()
 {
 	size_sum.store(0);
-	size_t sys_mem = Common::MemPhysical();
-	size_t recommended_min_mem = 2 * size_t(1024 * 1024 * 1024);
-	// keep 2GB memory for system stability if system RAM is 4GB+ - use half of memory in other cases
-	max_mem = (sys_mem / 2 < recommended_min_mem) ? (sys_mem / 2) : (sys_mem - recommended_min_mem);
 	Update();
 }
 
 void HiresTexture::Shutdown()
 {
-	if (s_prefetcher.joinable())
-	{
-		s_textureCacheAbortLoading.Set();
-		s_prefetcher.join();
-	}
+	s_textureCacheAbortLoading.Set();
+	s_prefetch_group.Wait();
+	StopStreaming();
 
 	s_textureMap.clear();
-	s_textureCache.clear();
+	ClearCachedTextures();
+	s_texture_pack.Close();
 }
 
 std::string HiresTexture::GetTextureDirectory(const std::string& game_id)
@@ -129,31 +208,57 @@ std::string HiresTexture::GetTextureDirectory(const std::string& game_id)
 	return texture_directory;
 }
 
+std::string HiresTexture::GetTexturePackPath(const std::string& game_id)
+{
+	const std::string pack_path = File::GetUserPath(D_HIRESTEXTURES_IDX) + game_id + ".itp";
+
+	// Same fallback to the region-free ID as for the directory
+	if (!File::Exists(pack_path))
+		return File::GetUserPath(D_HIRESTEXTURES_IDX) + game_id.substr(0, 3) + ".itp";
+
+	return pack_path;
+}
+
 void HiresTexture::Update()
 {
 	s_check_new_format = false;
 	bool BuildMaterialMaps = g_ActiveConfig.bHiresMaterialMapsBuild;
-	if (s_prefetcher.joinable())
-	{
-		s_textureCacheAbortLoading.Set();
-		s_prefetcher.join();
-	}
+	s_textureCacheAbortLoading.Set();
+	s_prefetch_group.Wait();
+	// The streamer reads s_textureMap, which is rebuilt below
+	StopStreaming();
+
+	// The textures in the map point into the pack
+	s_textureMap.clear();
+	s_texture_pack.Close();
 
 	if (!g_ActiveConfig.bHiresTextures)
 	{
-		s_textureMap.clear();
-		s_textureCache.clear();
-		size_sum.store(0);
+		ClearCachedTextures();
 		return;
 	}
 
+	if (g_ActiveConfig.iHiresTextureMemoryBudget > 0)
+	{
+		max_mem = size_t(g_ActiveConfig.iHiresTextureMemoryBudget) * 1024 * 1024;
+	}
+	else
+	{
+		size_t sys_mem = Common::MemPhysical();
+		size_t recommended_min_mem = 2 * size_t(1024 * 1024 * 1024);
+		// keep 2GB memory for system stability if system RAM is 4GB+ - use half of memory in other cases
+		max_mem = (sys_mem / 2 < recommended_min_mem) ? (sys_mem / 2) : (sys_mem - recommended_min_mem);
+	}
+
 	if (!g_ActiveConfig.bCacheHiresTextures)
 	{
-		s_textureCache.clear();
-		size_sum.store(0);
+		ClearCachedTextures();
+	}
+	else
+	{
+		EvictCachedTextures(0);
 	}
 
-	s_textureMap.clear();
 	const std::string& game_id = SConfig::GetInstance().m_strGameID;
 	const std::string texture_directory = GetTextureDirectory(game_id);
 
@@ -166,13 +271,24 @@ void HiresTexture::Update()
 		Extensions.push_back(".dds");
 	}
 
-	std::vector<std::string> filenames = DoFileSearch(Extensions, { texture_directory }, /*recursive*/ true);
+	// A texture pack replaces the directory, so only the index has to be read
+	std::vector<TexturePack::Entry> files;
+	if (s_texture_pack.Open(GetTexturePackPath(game_id)))
+	{
+		files = s_texture_pack.GetEntries();
+	}
+	else
+	{
+		for (std::string& filename : DoFileSearch(Extensions, { texture_directory }, /*recursive*/ true))
+			files.push_back({ std::move(filename), nullptr, 0 });
+	}
 
 	const std::string code = game_id + "_";
 	const std::string miptag = "mip";
 
-	for (const std::string& fileitem : filenames)
+	for (const TexturePack::Entry& file : files)
 	{
+		const std::string& fileitem = file.name;
 		std::string FileName;
 		std::string Extension;
 		SplitPath(fileitem, nullptr, &FileName, &Extension);
@@ -210,7 +326,13 @@ void HiresTexture::Update()
 			}
 		}
 		const bool is_compressed = Extension.compare(ddscode) == 0 || Extension.compare(cddscode) == 0;
-		hires_mip_level mip_level_detail(fileitem, Extension, is_compressed);
+		if (BuildMaterialMaps && is_compressed)
+		{
+			// Packs can contain dds files
+			continue;
+		}
+		hires_mip_level mip_level_detail(fileitem, Extension, is_compressed, file.data,
+			static_cast<size_t>(file.size));
 		u32 level = 0;
 		size_t idx = FileName.find_last_of('_');
 		std::string miplevel = FileName.substr(idx + 1, std::string::npos);
@@ -254,63 +376,62 @@ void HiresTexture::Update()
 		auto iter = s_textureCache.begin();
 		while (iter != s_textureCache.end())
 		{
+			auto next = std::next(iter);
 			if (s_textureMap.find(iter->first) == s_textureMap.end())
 			{
-				size_sum.fetch_sub(iter->second->m_cached_data_size);
-				iter = s_textureCache.erase(iter);
-			}
-			else
-			{
-				iter++;
+				EraseCachedTexture(iter);
 			}
+			iter = next;
 		}
+		s_evictedTextures.clear();
 		s_textureCacheAbortLoading.Clear();
-		s_prefetcher = std::thread(Prefetch);
+		s_prefetch_start_time = Common::Timer::GetTimeMs();
+		s_prefetch_remaining.store(s_textureMap.size());
+		for (const auto& entry : s_textureMap)
+		{
+			const std::string base_filename = entry.first;
+			s_prefetch_group.Run([base_filename] { Prefetch(base_filename); },
+				Common::TaskPriority::Low);
+		}
 	}
 }
 
-void HiresTexture::Prefetch()
+void HiresTexture::Prefetch(const std::string& base_filename)
 {
-	Common::SetCurrentThreadName("Prefetcher");
-
-	u32 starttime = Common::Timer::GetTimeMs();
-	for (const auto& entry : s_textureMap)
+	if (s_textureCacheAbortLoading.IsSet())
 	{
-		const std::string& base_filename = entry.first;
-
-		std::unique_lock<std::mutex> lk(s_textureCacheMutex);
+		return;
+	}
 
-		auto iter = s_textureCache.find(base_filename);
-		if (iter == s_textureCache.end())
+	std::unique_lock<std::mutex> lk(s_textureCacheMutex);
+	if (s_textureCache.find(base_filename) == s_textureCache.end())
+	{
+		lk.unlock();
+		std::shared_ptr<HiresTexture> ptr(Load(base_filename, [](size_t requested_size)
 		{
-			lk.unlock();
-			HiresTexture* ptr = Load(base_filename, [](size_t requested_size)
-			{
-				return new u8[requested_size];
-			}, true);
-			lk.lock();
-			if (ptr != nullptr)
-			{
-				size_sum.fetch_add(ptr->m_cached_data_size);
-				iter = s_textureCache.insert(iter, std::make_pair(base_filename, std::shared_ptr<HiresTexture>(ptr)));
-			}
-		}
-
-		if (s_textureCacheAbortLoading.IsSet())
+			return new u8[requested_size];
+		}, true));
+		lk.lock();
+		// The rest is loaded on use, prefetching must not evict what is already cached
+		if (ptr && size_sum.load() + ptr->m_cached_data_size > max_mem)
 		{
+			// Only the first task over the budget reports it
+			if (s_textureCacheAbortLoading.TestAndSet())
+				OSD::AddMessage(StringFromFormat("Custom Textures prefetching stopped after %.1f MB, the memory budget is used up", size_sum / (1024.0 * 1024.0)), 10000);
 			return;
 		}
-
-		if (size_sum.load() > max_mem)
+		if (ptr)
 		{
-			g_Config.bCacheHiresTextures = false;
-
-			OSD::AddMessage(StringFromFormat("Custom Textures prefetching after %.1f MB aborted, not enough RAM available", size_sum / (1024.0 * 1024.0)), 10000);
-			return;
+			InsertCachedTexture(base_filename, std::move(ptr));
 		}
 	}
-	u32 stoptime = Common::Timer::GetTimeMs();
-	OSD::AddMessage(StringFromFormat("Custom Textures loaded, %.1f MB in %.1f s", size_sum / (1024.0 * 1024.0), (stoptime - starttime) / 1000.0), 10000);
+	lk.unlock();
+
+	if (s_prefetch_remaining.fetch_sub(1) == 1 && !s_textureCacheAbortLoading.IsSet())
+	{
+		u32 stoptime = Common::Timer::GetTimeMs();
+		OSD::AddMessage(StringFromFormat("Custom Textures loaded, %.1f MB in %.1f s", size_sum / (1024.0 * 1024.0), (stoptime - s_prefetch_start_time) / 1000.0), 10000);
+	}
 }
 
 std::string HiresTexture::GenBaseName(
@@ -381,16 +502,21 @@ std::string HiresTexture::GenBaseName(
 	return "";
 }
 
-inline u8* LoadPNG(const char* path, int& width, int& height)
+inline u8* LoadPNG(const char* path, const u8* data, size_t size, int& width, int& height)
 {
+	int image_channels;
+	if (data != nullptr)
+	{
+		return SOIL_load_image_from_memory(data, (int)size, &width, &height, &image_channels, SOIL_LOAD_RGBA);
+	}
 	File::IOFile file(path, "rb");
-	std::vector<u8> buffer(file.GetSize());
-	if (!file.IsOpen() || !file.ReadBytes(buffer.data(), file.GetSize()))
+	const size_t file_size = static_cast<size_t>(file.GetSize());
+	ScratchMemory::Buffer buffer = ScratchMemory::Acquire(file_size);
+	if (!file.IsOpen() || !file.ReadBytes(buffer.data(), file_size))
 	{
 		return nullptr;
 	}
-	int image_channels;
-	return SOIL_load_image_from_memory(buffer.data(), (int)buffer.size(), &width, &height, &image_channels, SOIL_LOAD_RGBA);
+	return SOIL_load_image_from_memory(buffer.data(), (int)file_size, &width, &height, &image_channels, SOIL_LOAD_RGBA);
 }
 
 inline void ReadPNG(ImageLoaderParams &ImgInfo)
@@ -404,7 +530,7 @@ inline void ReadPNG(ImageLoaderParams &ImgInfo)
 	int image_width;
 	int image_height;
 	ImgInfo.resultTex = PC_TEX_FMT_NONE;
-	u8* decoded = LoadPNG(ImgInfo.Path, image_width, image_height);
+	u8* decoded = LoadPNG(ImgInfo.Path, ImgInfo.src_data, ImgInfo.src_size, image_width, image_height);
 	if (decoded == nullptr)
 	{
 		return;
@@ -439,9 +565,21 @@ inline void ReadDDS(ImageLoaderParams &ImgInfo)
 		case DDSC_DXT5:
 			ImgInfo.resultTex = PC_TEX_FMT_DXT5;
 			break;
+		case DDSC_BC5:
+			ImgInfo.resultTex = PC_TEX_FMT_BC5;
+			break;
+		case DDSC_BC7:
+			ImgInfo.resultTex = PC_TEX_FMT_BC7;
+			break;
 		default:
 			break;
 		}
+		// The data is uploaded as it is, there is no decoder to fall back to
+		if (!g_ActiveConfig.backend_info.bSupportedFormats[ImgInfo.resultTex])
+		{
+			ERROR_LOG(VIDEO, "Custom texture %s uses a compressed format the backend doesn't support", ImgInfo.Path);
+			ImgInfo.resultTex = PC_TEX_FMT_NONE;
+		}
 	}
 }
 
@@ -458,7 +596,7 @@ inline bool BuildColor(const HiresTextureCacheItem& item, ImageLoaderParams &Img
 	if (ImgInfo.dst != nullptr &&  leveldata.path.size() > 0)
 	{
 		int image_width, image_height;
-		u8* lumadata = LoadPNG(leveldata.path.c_str(), image_width, image_height);
+		u8* lumadata = LoadPNG(leveldata.path.c_str(), leveldata.data, leveldata.size, image_width, image_height);
 		if (lumadata != nullptr)
 		{
 			if (static_cast<u32>(image_width) == ImgInfo.Width
@@ -509,7 +647,7 @@ inline void BuildMaterial(const HiresTextureCacheItem& item, ImageLoaderParams &
 		auto& leveldata = item.maps[MapType::bump][level];
 		int image_width;
 		int image_height;
-		bumpdata = LoadPNG(leveldata.path.c_str(), image_width, image_height);
+		bumpdata = LoadPNG(leveldata.path.c_str(), leveldata.data, leveldata.size, image_width, image_height);
 		if (bumpdata != nullptr 
 			&& static_cast<u32>(image_width) == ImgInfo.Width 
 			&& static_cast<u32>(image_height) == ImgInfo.Height)
@@ -524,7 +662,7 @@ inline void BuildMaterial(const HiresTextureCacheItem& item, ImageLoaderParams &
 		auto& leveldata = item.maps[MapType::specular][level];
 		int image_width;
 		int image_height;
-		speculardata = LoadPNG(leveldata.path.c_str(), image_width, image_height);
+		speculardata = LoadPNG(leveldata.path.c_str(), leveldata.data, leveldata.size, image_width, image_height);
 		if (speculardata != nullptr
 			&& static_cast<u32>(image_width) == ImgInfo.Width
 			&& static_cast<u32>(image_height) == ImgInfo.Height)
@@ -565,31 +703,178 @@ std::shared_ptr<HiresTexture> HiresTexture::Search(
 		auto iter = s_textureCache.find(basename);
 		if (iter != s_textureCache.end())
 		{
-			HiresTexture* current = iter->second.get();
+			TouchCachedTexture(iter);
+			HiresTexture* current = iter->second.texture.get();
 			u8* dst = request_buffer_delegate(current->m_cached_data_size);
 			memcpy(dst, current->m_cached_data.get(), current->m_cached_data_size);
-			return iter->second;
+			return iter->second.texture;
 		}
+		// Evicted textures were in use before, don't stall on loading them again
+		const bool evicted = s_evictedTextures.count(basename) != 0;
 		lk.unlock();
-		if (size_sum.load() < max_mem)
+		if (g_ActiveConfig.bStreamHiresTextures || evicted)
 		{
-			std::shared_ptr<HiresTexture> ptr(Load(basename, [](size_t requested_size)
-			{
-				return new u8[requested_size];
-			}, true));
-			lk.lock();
-			if (ptr)
+			return SearchStreamed(basename, request_buffer_delegate);
+		}
+		std::shared_ptr<HiresTexture> ptr(Load(basename, [](size_t requested_size)
+		{
+			return new u8[requested_size];
+		}, true));
+		lk.lock();
+		if (ptr)
+		{
+			InsertCachedTexture(basename, ptr);
+			HiresTexture* current = ptr.get();
+			u8* dst = request_buffer_delegate(current->m_cached_data_size);
+			memcpy(dst, current->m_cached_data.get(), current->m_cached_data_size);
+		}
+		return ptr;
+	}
+	if (g_ActiveConfig.bStreamHiresTextures)
+	{
+		return SearchStreamed(basename, request_buffer_delegate);
+	}
+	return std::shared_ptr<HiresTexture>(Load(basename, request_buffer_delegate, false));
+}
+
+std::shared_ptr<HiresTexture> HiresTexture::SearchStreamed(
+	const std::string& basename,
+	std::function<u8*(size_t)> request_buffer_delegate)
+{
+	std::unique_lock<std::mutex> lk(s_textureCacheMutex);
+	auto iter = s_streamed_textures.find(basename);
+	if (iter != s_streamed_textures.end())
+	{
+		std::shared_ptr<HiresTexture> ptr = std::move(iter->second);
+		s_streamed_textures.erase(iter);
+		s_stream_requested.erase(basename);
+		u8* dst = request_buffer_delegate(ptr->m_cached_data_size);
+		memcpy(dst, ptr->m_cached_data.get(), ptr->m_cached_data_size);
+		size_sum.fetch_sub(ptr->m_cached_data_size);
+		if (g_ActiveConfig.bCacheHiresTextures)
+		{
+			InsertCachedTexture(basename, ptr);
+		}
+		else
+		{
+			ptr->m_cached_data.reset();
+			ptr->m_cached_data_size = 0;
+		}
+		return ptr;
+	}
+	if (s_textureMap.find(basename) == s_textureMap.end())
+	{
+		return nullptr;
+	}
+	if (g_ActiveConfig.bCacheHiresTextures)
+	{
+		EvictCachedTextures(0);
+	}
+	if (size_sum.load() >= max_mem)
+	{
+		// No room to keep streamed textures around, load it right away
+		lk.unlock();
+		return std::shared_ptr<HiresTexture>(Load(basename, request_buffer_delegate, false));
+	}
+	if (s_stream_requested.insert(basename).second)
+	{
+		s_stream_queue.push_back(basename);
+		if (!s_streamer.joinable())
+		{
+			s_stream_exit = false;
+			s_streamer = std::thread(Stream);
+		}
+		s_stream_cv.notify_one();
+	}
+	// Use the native texture until it's loaded
+	return nullptr;
+}
+
+void HiresTexture::Stream()
+{
+	Common::SetCurrentThreadName("Hires texture streamer");
+
+	std::unique_lock<std::mutex> lk(s_textureCacheMutex);
+	while (true)
+	{
+		s_stream_cv.wait(lk, [] { return s_stream_exit || !s_stream_queue.empty(); });
+		if (s_stream_exit)
+		{
+			return;
+		}
+		std::string basename = std::move(s_stream_queue.front());
+		s_stream_queue.pop_front();
+		lk.unlock();
+		HiresTexture* ptr = Load(basename, [](size_t requested_size)
+		{
+			return new u8[requested_size];
+		}, true);
+		lk.lock();
+		// Failed loads stay requested, so they aren't retried on every use
+		if (ptr != nullptr)
+		{
+			size_sum.fetch_add(ptr->m_cached_data_size);
+			s_streamed_textures[basename] = std::shared_ptr<HiresTexture>(ptr);
+			s_stream_ready.push_back(basename);
+		}
+	}
+}
+
+void HiresTexture::StopStreaming()
+{
+	if (s_streamer.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lk(s_textureCacheMutex);
+			s_stream_exit = true;
+		}
+		s_stream_cv.notify_one();
+		s_streamer.join();
+	}
+	for (const auto& entry : s_streamed_textures)
+	{
+		size_sum.fetch_sub(entry.second->m_cached_data_size);
+	}
+	s_streamed_textures.clear();
+	s_stream_queue.clear();
+	s_stream_requested.clear();
+	s_stream_ready.clear();
+}
+
+void HiresTexture::MarkUsed(const std::vector<std::string>& basenames)
+{
+	std::lock_guard<std::mutex> lk(s_textureCacheMutex);
+	for (const std::string& basename : basenames)
+	{
+		auto iter = s_textureCache.find(basename);
+		if (iter != s_textureCache.end())
+		{
+			TouchCachedTexture(iter);
+		}
+	}
+}
+
+std::vector<std::string> HiresTexture::GetStreamedTextures(size_t budget)
+{
+	std::vector<std::string> result;
+	size_t total_size = 0;
+	std::lock_guard<std::mutex> lk(s_textureCacheMutex);
+	while (!s_stream_ready.empty())
+	{
+		auto iter = s_streamed_textures.find(s_stream_ready.front());
+		if (iter != s_streamed_textures.end())
+		{
+			// Always return at least one texture, however large
+			if (!result.empty() && total_size + iter->second->m_cached_data_size > budget)
 			{
-				s_textureCache[basename] = ptr;
-				HiresTexture* current = ptr.get();
-				size_sum.fetch_add(current->m_cached_data_size);
-				u8* dst = request_buffer_delegate(current->m_cached_data_size);
-				memcpy(dst, current->m_cached_data.get(), current->m_cached_data_size);
+				break;
 			}
-			return ptr;
+			total_size += iter->second->m_cached_data_size;
+			result.push_back(iter->first);
 		}
+		s_stream_ready.pop_front();
 	}
-	return std::shared_ptr<HiresTexture>(Load(basename, request_buffer_delegate, false));
+	return result;
 }
 
 HiresTexture* HiresTexture::Load(const std::string& basename,
@@ -657,6 +942,8 @@ HiresTexture* HiresTexture::Load(const std::string& basename,
 		bool emissive_present = current.emissive_in_color;
 		imgInfo.dst = nullptr;
 		imgInfo.Path = item.path.c_str();
+		imgInfo.src_data = item.data;
+		imgInfo.src_size = item.size;
 		nrm_posible = nrm_posible			
 			&& current.maps[material_mat_index][level].path.size() > 0;
 		if (level == 0)
@@ -785,6 +1072,8 @@ HiresTexture* HiresTexture::Load(const std::string& basename,
 			hires_mip_level &item = current.maps[material_mat_index][level];
 			imgInfo.dst = nullptr;
 			imgInfo.Path = item.path.c_str();
+			imgInfo.src_data = item.data;
+			imgInfo.src_size = item.size;
 			imgInfo.request_buffer_delegate = allocation_function;
 			bool ddsfile = false;
 			if (item.is_compressed)
@@ -22,6 +22,15 @@ public:
 		std::function<u8*(size_t)> request_buffer_delegate
 	);
 
+	// Returns the basenames of the textures streamed in since the last call, the entries
+	// using the native texture in their place should be reloaded. Stops once the data
+	// exceeds budget bytes, so the uploads can be spread over several frames.
+	static std::vector<std::string> GetStreamedTextures(size_t budget);
+
+	// Marks the textures the texture cache used this frame as recently used, so the ones
+	// resident on the GPU aren't the first evicted from the cache.
+	static void MarkUsed(const std::vector<std::string>& basenames);
+
 	static std::string GenBaseName(
 		const u8* texture, size_t texture_size,
 		const u8* tlut, size_t tlut_size,
@@ -40,7 +49,12 @@ public:
 private:
 	static HiresTexture* Load(const std::string& base_filename,
 		std::function<u8*(size_t)> request_buffer_delegate, bool cacheresult);
-	static void Prefetch();
+	static void Prefetch(const std::string& base_filename);
+	static void Stream();
+	static std::shared_ptr<HiresTexture> SearchStreamed(const std::string& basename,
+		std::function<u8*(size_t)> request_buffer_delegate);
+	static void StopStreaming();
 	HiresTexture();
 	static std::string GetTextureDirectory(const std::string& game_id);
+	static std::string GetTexturePackPath(const std::string& game_id);
 };
\ No newline at end of file
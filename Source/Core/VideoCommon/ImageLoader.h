@@ -40,13 +40,18 @@ enum DDSCompression
 	DDSC_NONE,
 	DDSC_DXT1,
 	DDSC_DXT3,
-	DDSC_DXT5
+	DDSC_DXT5,
+	DDSC_BC5,
+	DDSC_BC7
 };
 struct ImageLoaderParams
 {
 	std::function<u8*(size_t, bool)> request_buffer_delegate;
 	u8* dst;
 	const char* Path;
+	// When set, the image is read from this buffer instead of the file at Path
+	const u8* src_data;
+	size_t src_size;
 	u32 Width;
 	u32 Height;
 	u32 data_size;
@@ -58,6 +63,8 @@ struct ImageLoaderParams
 	ImageLoaderParams()
 	{
 		Path = nullptr;
+		src_data = nullptr;
+		src_size = 0;
 		Width = 0;
 		Height = 0;
 		data_size = 0;
@@ -2,13 +2,21 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <condition_variable>
+#include <cstring>
+#include <deque>
 #include <list>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
+#include <zlib.h>
 
 #include "png.h"
 #include "Common/CommonTypes.h"
 #include "Common/FileUtil.h"
 #include "Common/MsgHandler.h"
+#include "Common/Thread.h"
 #include "VideoCommon/ImageWrite.h"
 
 bool SaveData(const std::string& filename, const std::string& data)
@@ -29,7 +37,7 @@ data      : This is an array of RGBA with 8 bits per channel. 4 bytes for each p
 row_stride: Determines the amount of bytes per row of pixels.
 */
 bool TextureToPng(const u8* data, int row_stride, const std::string& filename, int width,
-	int height, bool saveAlpha, bool frombgra)
+	int height, bool saveAlpha, bool frombgra, bool fast_compression)
 {
 	bool success = false;
 
@@ -79,6 +87,12 @@ bool TextureToPng(const u8* data, int row_stride, const std::string& filename, i
 
 	png_init_io(png_ptr, fp.GetHandle());
 
+	if (fast_compression)
+	{
+		png_set_compression_level(png_ptr, Z_BEST_SPEED);
+		png_set_filter(png_ptr, PNG_FILTER_TYPE_BASE, PNG_FILTER_SUB);
+	}
+
 	// Write header (8 bit color depth)
 	png_set_IHDR(png_ptr, info_ptr, width, height, 8, PNG_COLOR_TYPE_RGB_ALPHA, PNG_INTERLACE_NONE,
 		PNG_COMPRESSION_TYPE_BASE, PNG_FILTER_TYPE_BASE);
@@ -126,3 +140,92 @@ finalise:
 
 	return success;
 }
+
+struct PendingImage
+{
+	std::vector<u8> data;
+	std::string filename;
+	int width;
+	int height;
+	bool save_alpha;
+};
+
+static constexpr size_t IMAGE_WRITE_QUEUE_SIZE = 16;
+
+static std::thread s_image_write_thread;
+// Guards everything below
+static std::mutex s_image_write_mutex;
+static std::condition_variable s_image_write_cv;
+static std::deque<PendingImage> s_image_write_queue;
+static size_t s_images_encoding = 0;
+static bool s_image_write_running = false;
+
+static void RunImageWrites()
+{
+	Common::SetCurrentThreadName("ImageWrite");
+
+	std::unique_lock<std::mutex> lk(s_image_write_mutex);
+	while (true)
+	{
+		// The queued images are written before the thread stops
+		s_image_write_cv.wait(lk, [] { return !s_image_write_queue.empty() || !s_image_write_running; });
+		if (s_image_write_queue.empty())
+			break;
+
+		PendingImage image = std::move(s_image_write_queue.front());
+		s_image_write_queue.pop_front();
+		s_images_encoding++;
+		lk.unlock();
+
+		TextureToPng(image.data.data(), image.width * 4, image.filename, image.width, image.height,
+			image.save_alpha, false, true);
+
+		lk.lock();
+		s_images_encoding--;
+		s_image_write_cv.notify_all();
+	}
+}
+
+void TextureToPngAsync(const u8* data, int row_stride, const std::string& filename, int width,
+	int height, bool saveAlpha)
+{
+	PendingImage image;
+	const size_t row_size = static_cast<size_t>(width) * 4;
+	image.data.resize(row_size * height);
+	for (int y = 0; y < height; y++)
+		memcpy(image.data.data() + row_size * y, data + static_cast<ptrdiff_t>(y) * row_stride, row_size);
+	image.filename = filename;
+	image.width = width;
+	image.height = height;
+	image.save_alpha = saveAlpha;
+
+	std::unique_lock<std::mutex> lk(s_image_write_mutex);
+	if (!s_image_write_thread.joinable())
+	{
+		s_image_write_running = true;
+		s_image_write_thread = std::thread(RunImageWrites);
+	}
+	s_image_write_cv.wait(lk, [] { return s_image_write_queue.size() < IMAGE_WRITE_QUEUE_SIZE; });
+	s_image_write_queue.push_back(std::move(image));
+	lk.unlock();
+	s_image_write_cv.notify_all();
+}
+
+void FlushImageWrites()
+{
+	std::unique_lock<std::mutex> lk(s_image_write_mutex);
+	s_image_write_cv.wait(lk, [] { return s_image_write_queue.empty() && s_images_encoding == 0; });
+}
+
+void ShutdownImageWrites()
+{
+	if (!s_image_write_thread.joinable())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lk(s_image_write_mutex);
+		s_image_write_running = false;
+	}
+	s_image_write_cv.notify_all();
+	s_image_write_thread.join();
+}
@@ -9,6 +9,15 @@
 #include "VideoCommon/ImageLoader.h"
 
 bool SaveData(const std::string& filename, const std::string& data);
+// fast_compression uses the fastest zlib level and a single filter, for bulk dumps
 bool TextureToPng(const u8* data, int row_stride, const std::string& filename, int width,
-	int height, bool saveAlpha = false, bool frombgra = false);
+	int height, bool saveAlpha = false, bool frombgra = false, bool fast_compression = false);
+// Copies the image and encodes it on the image writing thread with fast compression,
+// data can be released when this returns. Only waits while the queue is full.
+void TextureToPngAsync(const u8* data, int row_stride, const std::string& filename, int width,
+	int height, bool saveAlpha = false);
+// Waits until all queued images have been written
+void FlushImageWrites();
+// Writes the queued images and stops the image writing thread
+void ShutdownImageWrites();
 bool TextureToDDS(const u8* data, int row_stride, const std::string& filename, int width, int height, DDSCompression format = DDSCompression::DDSC_DXT3);
@@ -3,40 +3,237 @@
 // Refer to the license.txt file included.
 
 #include <cstddef>
+#include <cstring>
 
 #include "Common/CommonTypes.h"
+#include "Common/Intrinsics.h"
 #include "Common/Logging/Log.h"
 #include "VideoCommon/IndexGenerator.h"
 #include "VideoCommon/OpcodeDecoding.h"
 #include "VideoCommon/VideoConfig.h"
 
 //Init
-u16 *IndexGenerator::index_buffer_current;
-u16 *IndexGenerator::BASEIptr;
+u8 *IndexGenerator::index_buffer_current;
+u8 *IndexGenerator::BASEIptr;
 u32 IndexGenerator::base_index;
+u32 IndexGenerator::index_shift;
+bool IndexGenerator::use_primitive_restart;
 
 static void(*primitive_table[8])(u32);
 
-void IndexGenerator::Init()
+/*
+ * Index patterns
+ *
+ * Most primitives repeat a fixed pattern of indices every few vertices, so whole groups of
+ * primitives are written with 16 byte stores: each lane is an offset from the first index of
+ * the group, or the fan center, or a primitive restart. The scalar code handles the remainder.
+ * With 32 bit indices each lane is widened, a primitive restart becomes 0xFFFFFFFF.
+ */
+static const u16 PATTERN_CENTER = 0xFFFE;
+static const u16 PATTERN_RESTART = IndexGenerator::PRIMITIVE_RESTART_INDEX;
+
+template <u32 vectors>
+struct IndexPattern
+{
+	u16 lanes[vectors * 8];
+	// Vertices consumed by one group
+	u32 step;
+};
+
+// 24 indices: 8 triangles
+static const IndexPattern<3> s_list_pattern = { {
+		0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23,
+	}, 24 };
+// 24 indices: 6 triangles
+static const IndexPattern<3> s_list_pattern_pr = { {
+		0, 1, 2, PATTERN_RESTART, 3, 4, 5, PATTERN_RESTART,
+		6, 7, 8, PATTERN_RESTART, 9, 10, 11, PATTERN_RESTART,
+		12, 13, 14, PATTERN_RESTART, 15, 16, 17, PATTERN_RESTART,
+	}, 18 };
+// 24 indices: 8 triangles with alternating winding
+static const IndexPattern<3> s_strip_pattern = { {
+		0, 1, 2, 1, 3, 2, 2, 3, 4, 3, 5, 4, 4, 5, 6, 5, 7, 6, 6, 7, 8, 7, 9, 8,
+	}, 8 };
+// 24 indices: 8 triangles around the center
+static const IndexPattern<3> s_fan_pattern = { {
+		PATTERN_CENTER, 0, 1, PATTERN_CENTER, 1, 2, PATTERN_CENTER, 2, 3, PATTERN_CENTER, 3, 4,
+		PATTERN_CENTER, 4, 5, PATTERN_CENTER, 5, 6, PATTERN_CENTER, 6, 7, PATTERN_CENTER, 7, 8,
+	}, 8 };
+// 24 indices: 12 triangles as 4 strips of 3, see AddFan
+static const IndexPattern<3> s_fan_pattern_pr = { {
+		0, 1, PATTERN_CENTER, 2, 3, PATTERN_RESTART, 3, 4, PATTERN_CENTER, 5, 6, PATTERN_RESTART,
+		6, 7, PATTERN_CENTER, 8, 9, PATTERN_RESTART, 9, 10, PATTERN_CENTER, 11, 12, PATTERN_RESTART,
+	}, 12 };
+// 24 indices: 4 quads
+static const IndexPattern<3> s_quad_pattern = { {
+		0, 1, 2, 0, 2, 3, 4, 5, 6, 4, 6, 7, 8, 9, 10, 8, 10, 11, 12, 13, 14, 12, 14, 15,
+	}, 16 };
+// 40 indices: 8 quads as strips, see AddQuads
+static const IndexPattern<5> s_quad_pattern_pr = { {
+		1, 2, 0, 3, PATTERN_RESTART, 5, 6, 4, 7, PATTERN_RESTART,
+		9, 10, 8, 11, PATTERN_RESTART, 13, 14, 12, 15, PATTERN_RESTART,
+		17, 18, 16, 19, PATTERN_RESTART, 21, 22, 20, 23, PATTERN_RESTART,
+		25, 26, 24, 27, PATTERN_RESTART, 29, 30, 28, 31, PATTERN_RESTART,
+	}, 32 };
+// 24 indices: 24 points
+static const IndexPattern<3>& s_point_pattern = s_list_pattern;
+// 24 indices: 12 lines
+static const IndexPattern<3>& s_line_pattern = s_list_pattern;
+// 24 indices: 12 lines
+static const IndexPattern<3> s_line_strip_pattern = { {
+		0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12,
+	}, 12 };
+
+template <typename T, u32 vectors>
+static inline T* WritePatternScalar(T* ptr, const IndexPattern<vectors>& pattern, u32 first, u32 center, u32 groups)
+{
+	for (u32 g = 0; g < groups; g++)
+	{
+		for (u16 lane : pattern.lanes)
+		{
+			if (lane == PATTERN_CENTER)
+				*ptr++ = center;
+			else if (lane == PATTERN_RESTART)
+				*ptr++ = static_cast<T>(-1);
+			else
+				*ptr++ = first + lane;
+		}
+		first += pattern.step;
+	}
+	return ptr;
+}
+
+// Writes groups of the pattern starting at index first, returns the new write pointer.
+// Only full groups are written, first and the group count are the caller's to advance.
+template <u32 vectors>
+static __forceinline u16* WritePattern(u16* ptr, const IndexPattern<vectors>& pattern, u32 first, u32 center, u32 groups)
+{
+#ifdef _M_X86
+	if (groups == 0)
+		return ptr;
+	__m128i offsets[vectors];
+	__m128i centers[vectors];
+	__m128i restarts[vectors];
+	const __m128i center_lane = _mm_set1_epi16((s16)PATTERN_CENTER);
+	const __m128i restart_lane = _mm_set1_epi16((s16)PATTERN_RESTART);
+	for (u32 i = 0; i < vectors; i++)
+	{
+		__m128i lanes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pattern.lanes + i * 8));
+		centers[i] = _mm_cmpeq_epi16(lanes, center_lane);
+		restarts[i] = _mm_cmpeq_epi16(lanes, restart_lane);
+		offsets[i] = _mm_andnot_si128(_mm_or_si128(centers[i], restarts[i]), lanes);
+	}
+	const __m128i center_index = _mm_set1_epi16((s16)center);
+	const __m128i step = _mm_set1_epi16((s16)pattern.step);
+	__m128i base = _mm_set1_epi16((s16)first);
+	for (u32 g = 0; g < groups; g++)
+	{
+		for (u32 i = 0; i < vectors; i++)
+		{
+			__m128i v = _mm_add_epi16(base, offsets[i]);
+			v = _mm_or_si128(_mm_andnot_si128(centers[i], v), _mm_and_si128(centers[i], center_index));
+			v = _mm_or_si128(v, restarts[i]);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(ptr), v);
+			ptr += 8;
+		}
+		base = _mm_add_epi16(base, step);
+	}
+#else
+	ptr = WritePatternScalar(ptr, pattern, first, center, groups);
+#endif
+	return ptr;
+}
+
+template <u32 vectors>
+static __forceinline u32* WritePattern(u32* ptr, const IndexPattern<vectors>& pattern, u32 first, u32 center, u32 groups)
 {
-	primitive_table[GX_DRAW_QUADS] = IndexGenerator::AddQuads;
-#if defined(_DEBUG) || defined(DEBUGFAST)
-	primitive_table[GX_DRAW_QUADS_2] = IndexGenerator::AddQuads_nonstandard;
+#ifdef _M_X86
+	if (groups == 0)
+		return ptr;
+	__m128i offsets[vectors * 2];
+	__m128i centers[vectors * 2];
+	__m128i restarts[vectors * 2];
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i center_lane = _mm_set1_epi32(PATTERN_CENTER);
+	const __m128i restart_lane = _mm_set1_epi32(PATTERN_RESTART);
+	for (u32 i = 0; i < vectors; i++)
+	{
+		__m128i lanes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pattern.lanes + i * 8));
+		__m128i halves[2] = { _mm_unpacklo_epi16(lanes, zero), _mm_unpackhi_epi16(lanes, zero) };
+		for (u32 j = 0; j < 2; j++)
+		{
+			centers[i * 2 + j] = _mm_cmpeq_epi32(halves[j], center_lane);
+			restarts[i * 2 + j] = _mm_cmpeq_epi32(halves[j], restart_lane);
+			offsets[i * 2 + j] = _mm_andnot_si128(_mm_or_si128(centers[i * 2 + j], restarts[i * 2 + j]), halves[j]);
+		}
+	}
+	const __m128i center_index = _mm_set1_epi32((s32)center);
+	const __m128i step = _mm_set1_epi32((s32)pattern.step);
+	__m128i base = _mm_set1_epi32((s32)first);
+	for (u32 g = 0; g < groups; g++)
+	{
+		for (u32 i = 0; i < vectors * 2; i++)
+		{
+			__m128i v = _mm_add_epi32(base, offsets[i]);
+			v = _mm_or_si128(_mm_andnot_si128(centers[i], v), _mm_and_si128(centers[i], center_index));
+			v = _mm_or_si128(v, restarts[i]);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(ptr), v);
+			ptr += 4;
+		}
+		base = _mm_add_epi32(base, step);
+	}
 #else
-	primitive_table[GX_DRAW_QUADS_2] = IndexGenerator::AddQuads;
+	ptr = WritePatternScalar(ptr, pattern, first, center, groups);
 #endif
-	primitive_table[GX_DRAW_TRIANGLES] = IndexGenerator::AddList;
-	primitive_table[GX_DRAW_TRIANGLE_STRIP] = IndexGenerator::AddStrip;
-	primitive_table[GX_DRAW_TRIANGLE_FAN] = IndexGenerator::AddFan;
-	primitive_table[GX_DRAW_LINES] = &IndexGenerator::AddLineList;
-	primitive_table[GX_DRAW_LINE_STRIP] = &IndexGenerator::AddLineStrip;
-	primitive_table[GX_DRAW_POINTS] = &IndexGenerator::AddPoints;
+	return ptr;
 }
 
-void IndexGenerator::Start(u16* Indexptr)
+template <typename T>
+void IndexGenerator::SetPrimitiveTable()
 {
-	index_buffer_current = Indexptr;
-	BASEIptr = Indexptr;
+	if (use_primitive_restart)
+	{
+		primitive_table[GX_DRAW_QUADS] = IndexGenerator::AddQuads<T, true>;
+		primitive_table[GX_DRAW_QUADS_2] = IndexGenerator::AddQuads_nonstandard<T, true>;
+		primitive_table[GX_DRAW_TRIANGLES] = IndexGenerator::AddList<T, true>;
+		primitive_table[GX_DRAW_TRIANGLE_STRIP] = IndexGenerator::AddStrip<T, true>;
+		primitive_table[GX_DRAW_TRIANGLE_FAN] = IndexGenerator::AddFan<T, true>;
+	}
+	else
+	{
+		primitive_table[GX_DRAW_QUADS] = IndexGenerator::AddQuads<T, false>;
+		primitive_table[GX_DRAW_QUADS_2] = IndexGenerator::AddQuads_nonstandard<T, false>;
+		primitive_table[GX_DRAW_TRIANGLES] = IndexGenerator::AddList<T, false>;
+		primitive_table[GX_DRAW_TRIANGLE_STRIP] = IndexGenerator::AddStrip<T, false>;
+		primitive_table[GX_DRAW_TRIANGLE_FAN] = IndexGenerator::AddFan<T, false>;
+	}
+#if !defined(_DEBUG) && !defined(DEBUGFAST)
+	primitive_table[GX_DRAW_QUADS_2] = primitive_table[GX_DRAW_QUADS];
+#endif
+	primitive_table[GX_DRAW_LINES] = &IndexGenerator::AddLineList<T>;
+	primitive_table[GX_DRAW_LINE_STRIP] = &IndexGenerator::AddLineStrip<T>;
+	primitive_table[GX_DRAW_POINTS] = &IndexGenerator::AddPoints<T>;
+}
+
+void IndexGenerator::Init()
+{
+	use_primitive_restart = g_ActiveConfig.backend_info.bSupportsPrimitiveRestart;
+	if (g_ActiveConfig.backend_info.bSupports32BitIndices)
+	{
+		index_shift = 1;
+		SetPrimitiveTable<u32>();
+	}
+	else
+	{
+		index_shift = 0;
+		SetPrimitiveTable<u16>();
+	}
+}
+
+void IndexGenerator::Start(void* Indexptr)
+{
+	index_buffer_current = static_cast<u8*>(Indexptr);
+	BASEIptr = static_cast<u8*>(Indexptr);
 	base_index = 0;
 }
 
@@ -47,32 +244,100 @@ void IndexGenerator::AddIndices(int primitive, u32 numVerts)
 }
 
 // Triangles
-__forceinline u16* IndexGenerator::WriteTriangle(u16* ptr, u32 index1, u32 index2, u32 index3)
+template <typename T, bool pr>
+__forceinline T* IndexGenerator::WriteTriangle(T* ptr, u32 index1, u32 index2, u32 index3)
 {
 	*ptr++ = index1;
 	*ptr++ = index2;
 	*ptr++ = index3;
+	if (pr)
+		*ptr++ = static_cast<T>(-1);
 	return ptr;
 }
 
+template <typename T, bool pr>
 void IndexGenerator::AddList(u32 const numVerts)
 {
-	u32 i = base_index + 2;
+	const IndexPattern<3>& pattern = pr ? s_list_pattern_pr : s_list_pattern;
+	u32 groups = numVerts / pattern.step;
+	T* ptr = WritePattern(reinterpret_cast<T*>(index_buffer_current), pattern, base_index, 0, groups);
+	u32 i = base_index + groups * pattern.step + 2;
 	u32 top = (base_index + numVerts);
-	u16* ptr = index_buffer_current;
 	while (i < top)
 	{
-		ptr = WriteTriangle(ptr, i - 2, i - 1, i);
+		ptr = WriteTriangle<T, pr>(ptr, i - 2, i - 1, i);
 		i += 3;
 	}
-	index_buffer_current = ptr;
+	index_buffer_current = reinterpret_cast<u8*>(ptr);
+}
+
+// Native positions are three floats. Comparing the bits misses the collinear triangles and
+// treats 0 and -0 as different, which only lets a few degenerate triangles through.
+static __forceinline bool IsDegenerate(const u8* v0, const u8* v1, const u8* v2)
+{
+	const size_t size = 3 * sizeof(float);
+	return std::memcmp(v0, v1, size) == 0 || std::memcmp(v1, v2, size) == 0
+		|| std::memcmp(v0, v2, size) == 0;
+}
+
+template <typename T, bool pr>
+u32 IndexGenerator::AddListCulled(const u8* positions, u32 stride, u32 const numVerts)
+{
+	T* ptr = reinterpret_cast<T*>(index_buffer_current);
+	u32 culled = 0;
+	for (u32 i = 2; i < numVerts; i += 3)
+	{
+		const u8* v0 = positions + (i - 2) * stride;
+		if (IsDegenerate(v0, v0 + stride, v0 + 2 * stride))
+		{
+			culled++;
+			continue;
+		}
+		ptr = WriteTriangle<T, pr>(ptr, base_index + i - 2, base_index + i - 1, base_index + i);
+	}
+	index_buffer_current = reinterpret_cast<u8*>(ptr);
+	return culled;
 }
 
+u32 IndexGenerator::AddTrianglesCulled(const u8* positions, u32 stride, u32 numVerts)
+{
+	u32 culled;
+	if (index_shift)
+	{
+		culled = use_primitive_restart ? AddListCulled<u32, true>(positions, stride, numVerts)
+			: AddListCulled<u32, false>(positions, stride, numVerts);
+	}
+	else
+	{
+		culled = use_primitive_restart ? AddListCulled<u16, true>(positions, stride, numVerts)
+			: AddListCulled<u16, false>(positions, stride, numVerts);
+	}
+	base_index += numVerts;
+	return culled;
+}
+
+template <typename T, bool pr>
 void IndexGenerator::AddStrip(u32 const numVerts)
 {
-	u16* ptr = index_buffer_current;
+	T* ptr = reinterpret_cast<T*>(index_buffer_current);
 	u32 top = (base_index + numVerts);
-	u32 a = base_index;
+	if (pr)
+	{
+		// The strip is drawn as it is.
+		if (numVerts < 3)
+			return;
+		u32 groups = numVerts / s_point_pattern.step;
+		ptr = WritePattern(ptr, s_point_pattern, base_index, 0, groups);
+		for (u32 i = base_index + groups * s_point_pattern.step; i < top; ++i)
+			*ptr++ = i;
+		*ptr++ = static_cast<T>(-1);
+		index_buffer_current = reinterpret_cast<u8*>(ptr);
+		return;
+	}
+	u32 groups = numVerts > 2 ? (numVerts - 2) / s_strip_pattern.step : 0;
+	ptr = WritePattern(ptr, s_strip_pattern, base_index, 0, groups);
+	// Groups hold an even number of triangles, so the winding starts over.
+	u32 a = base_index + groups * s_strip_pattern.step;
 	u32 i = a + 2;
 	u32 wind = 1;
 	while (i < top)
@@ -80,7 +345,7 @@ void IndexGenerator::AddStrip(u32 const numVerts)
 		u32 b = i - wind;
 		wind ^= 1;
 		u32 c = i - wind;
-		ptr = WriteTriangle(
+		ptr = WriteTriangle<T, false>(
 			ptr,
 			a,
 			b,
@@ -88,7 +353,7 @@ void IndexGenerator::AddStrip(u32 const numVerts)
 		++i;
 		++a;
 	}
-	index_buffer_current = ptr;
+	index_buffer_current = reinterpret_cast<u8*>(ptr);
 }
 
 /**
@@ -110,18 +375,46 @@ void IndexGenerator::AddStrip(u32 const numVerts)
  * so we use 6 indices for 3 triangles
  */
 
+template <typename T, bool pr>
 void IndexGenerator::AddFan(u32 numVerts)
 {
 	u32 i = base_index + 2;
 	u32 top = (base_index + numVerts);
-	u16* ptr = index_buffer_current;
+	T* ptr = reinterpret_cast<T*>(index_buffer_current);
+	const IndexPattern<3>& pattern = pr ? s_fan_pattern_pr : s_fan_pattern;
+	u32 groups = numVerts > 2 ? (numVerts - 2) / pattern.step : 0;
+	ptr = WritePattern(ptr, pattern, i - 1, base_index, groups);
+	i += groups * pattern.step;
+
+	if (pr)
+	{
+		while (i + 2 < top)
+		{
+			*ptr++ = i - 1;
+			*ptr++ = i;
+			*ptr++ = base_index;
+			*ptr++ = i + 1;
+			*ptr++ = i + 2;
+			*ptr++ = static_cast<T>(-1);
+			i += 3;
+		}
+		if (i + 1 < top)
+		{
+			*ptr++ = i - 1;
+			*ptr++ = i;
+			*ptr++ = base_index;
+			*ptr++ = i + 1;
+			*ptr++ = static_cast<T>(-1);
+			i += 2;
+		}
+	}
 
 	while (i < top)
 	{
-		ptr = WriteTriangle(ptr, base_index, i - 1, i);
+		ptr = WriteTriangle<T, pr>(ptr, base_index, i - 1, i);
 		++i;
 	}
-	index_buffer_current = ptr;
+	index_buffer_current = reinterpret_cast<u8*>(ptr);
 }
 
 /*
@@ -141,73 +434,105 @@ void IndexGenerator::AddFan(u32 numVerts)
  * A simple triangle has to be rendered for three vertices.
  * ZWW do this for sun rays
  */
+template <typename T, bool pr>
 void IndexGenerator::AddQuads(u32 numVerts)
 {
-	u32 i = base_index + 3;
+	u32 groups;
+	T* ptr;
+	if (pr)
+	{
+		groups = numVerts / s_quad_pattern_pr.step;
+		ptr = WritePattern(reinterpret_cast<T*>(index_buffer_current), s_quad_pattern_pr, base_index, 0, groups);
+		groups *= s_quad_pattern_pr.step;
+	}
+	else
+	{
+		groups = numVerts / s_quad_pattern.step;
+		ptr = WritePattern(reinterpret_cast<T*>(index_buffer_current), s_quad_pattern, base_index, 0, groups);
+		groups *= s_quad_pattern.step;
+	}
+	u32 i = base_index + groups + 3;
 	u32 top = (base_index + numVerts);
-	u16* ptr = index_buffer_current;
 	while (i < top)
 	{
-		ptr = WriteTriangle(ptr, i - 3, i - 2, i - 1);
-		ptr = WriteTriangle(ptr, i - 3, i - 1, i - 0);
+		if (pr)
+		{
+			*ptr++ = i - 2;
+			*ptr++ = i - 1;
+			*ptr++ = i - 3;
+			*ptr++ = i - 0;
+			*ptr++ = static_cast<T>(-1);
+		}
+		else
+		{
+			ptr = WriteTriangle<T, false>(ptr, i - 3, i - 2, i - 1);
+			ptr = WriteTriangle<T, false>(ptr, i - 3, i - 1, i - 0);
+		}
 		i += 4;
 	}
 
 	// three vertices remaining, so render a triangle
 	if (i == top)
 	{
-		ptr = WriteTriangle(ptr, top - 3, top - 2, top - 1);
+		ptr = WriteTriangle<T, pr>(ptr, top - 3, top - 2, top - 1);
 	}
-	index_buffer_current = ptr;
+	index_buffer_current = reinterpret_cast<u8*>(ptr);
 }
 
+template <typename T, bool pr>
 void IndexGenerator::AddQuads_nonstandard(u32 numVerts)
 {
 	WARN_LOG(VIDEO, "Non-standard primitive drawing command GL_DRAW_QUADS_2");
-	AddQuads(numVerts);
+	AddQuads<T, pr>(numVerts);
 }
 
 // Lines
+template <typename T>
 void IndexGenerator::AddLineList(u32 numVerts)
 {
-	u32 i = base_index + 1;
+	u32 groups = numVerts / s_line_pattern.step;
+	T* ptr = WritePattern(reinterpret_cast<T*>(index_buffer_current), s_line_pattern, base_index, 0, groups);
+	u32 i = base_index + groups * s_line_pattern.step + 1;
 	u32 top = (base_index + numVerts);
-	u16* ptr = index_buffer_current;
 	while (i < top)
 	{
 		*ptr++ = i - 1;
 		*ptr++ = i;
 		i += 2;
 	}
-	index_buffer_current = ptr;
+	index_buffer_current = reinterpret_cast<u8*>(ptr);
 }
 
 // shouldn't be used as strips as LineLists are much more common
 // so converting them to lists
+template <typename T>
 void IndexGenerator::AddLineStrip(u32 numVerts)
 {
-	u32 i = base_index + 1;
+	u32 groups = numVerts > 1 ? (numVerts - 1) / s_line_strip_pattern.step : 0;
+	T* ptr = WritePattern(reinterpret_cast<T*>(index_buffer_current), s_line_strip_pattern, base_index, 0, groups);
+	u32 i = base_index + groups * s_line_strip_pattern.step + 1;
 	u32 top = (base_index + numVerts);
-	u16* ptr = index_buffer_current;
 	while (i < top)
 	{
 		*ptr++ = i - 1;
 		*ptr++ = i;
 		++i;
 	}
-	index_buffer_current = ptr;
+	index_buffer_current = reinterpret_cast<u8*>(ptr);
 }
 
 // Points
+template <typename T>
 void IndexGenerator::AddPoints(u32 numVerts)
 {
-	u32 i = base_index;
+	u32 groups = numVerts / s_point_pattern.step;
+	T* ptr = WritePattern(reinterpret_cast<T*>(index_buffer_current), s_point_pattern, base_index, 0, groups);
+	u32 i = base_index + groups * s_point_pattern.step;
 	u32 top = (base_index + numVerts);
-	u16 *ptr = index_buffer_current;
 	while (i < top)
 	{
 		*ptr++ = i;
 		++i;
 	}
-	index_buffer_current = ptr;
+	index_buffer_current = reinterpret_cast<u8*>(ptr);
 }
@@ -9,10 +9,17 @@ class IndexGenerator
 {
 public:
 	// Init
+	// Uses strips separated by primitive restart indices when the backend supports them, and 32 bit
+	// indices with bSupports32BitIndices. Call again when the backend info changes.
 	static void Init();
-	static void Start(u16 *Indexptr);
+	// The buffer holds u16 or u32 indices, see Uses32BitIndices
+	static void Start(void* Indexptr);
 
 	static void AddIndices(int primitive, u32 numVertices);
+	// Like AddIndices with GX_DRAW_TRIANGLES, but leaves out the triangles with two vertices at the
+	// same position. positions points to the position of the first vertex. Returns the triangles
+	// left out.
+	static u32 AddTrianglesCulled(const u8* positions, u32 stride, u32 numVertices);
 
 	// returns numprimitives
 	static inline u32 GetNumVerts()
@@ -22,37 +29,68 @@ public:
 
 	static inline u32 GetIndexLen()
 	{
-		return (u32)(index_buffer_current - BASEIptr);
+		return (u32)(index_buffer_current - BASEIptr) >> (index_shift + 1);
 	}
 
 	static inline u32 GetRemainingIndices()
 	{
-		const u32 max_index = 65534; // -1 is reserved for primitive restart (ogl + dx11)
-		return max_index - base_index;
+		// The largest index is reserved for primitive restart (ogl + dx11)
+		return GetPrimitiveRestartIndex() - 1 - base_index;
 	}
 
-	static inline u16* GetBasePointer()
+	static inline u32 GetIndex(u32 i)
 	{
-		return BASEIptr;
+		if (index_shift)
+			return reinterpret_cast<const u32*>(BASEIptr)[i];
+		return reinterpret_cast<const u16*>(BASEIptr)[i];
 	}
+
+	// Triangles are drawn as strips cut by GetPrimitiveRestartIndex instead of lists.
+	static inline bool UsesPrimitiveRestart()
+	{
+		return use_primitive_restart;
+	}
+
+	// A batch holds more than 65535 vertices, so it doesn't have to be flushed that early
+	static inline bool Uses32BitIndices()
+	{
+		return index_shift != 0;
+	}
+
+	static inline u32 GetIndexSize()
+	{
+		return 2u << index_shift;
+	}
+
+	static inline u32 GetPrimitiveRestartIndex()
+	{
+		return index_shift ? 0xFFFFFFFF : PRIMITIVE_RESTART_INDEX;
+	}
+
+	static const u16 PRIMITIVE_RESTART_INDEX = 65535;
 private:
 	// Triangles
-	static void AddList(u32 numVerts);
-	static void AddStrip(u32 numVerts);
-	static void AddFan(u32 numVerts);
-	static void AddQuads(u32 numVerts);
-	static void AddQuads_nonstandard(u32 numVerts);
+	template <typename T, bool pr> static void AddList(u32 numVerts);
+	template <typename T, bool pr> static void AddStrip(u32 numVerts);
+	template <typename T, bool pr> static void AddFan(u32 numVerts);
+	template <typename T, bool pr> static void AddQuads(u32 numVerts);
+	template <typename T, bool pr> static void AddQuads_nonstandard(u32 numVerts);
+	template <typename T, bool pr> static u32 AddListCulled(const u8* positions, u32 stride, u32 numVerts);
 
 	// Lines
-	static void AddLineList(u32 numVerts);
-	static void AddLineStrip(u32 numVerts);
+	template <typename T> static void AddLineList(u32 numVerts);
+	template <typename T> static void AddLineStrip(u32 numVerts);
 
 	// Points
-	static void AddPoints(u32 numVerts);
+	template <typename T> static void AddPoints(u32 numVerts);
+
+	template <typename T, bool pr> static T* WriteTriangle(T *ptr, u32 index1, u32 index2, u32 index3);
 
-	static u16* WriteTriangle(u16 *ptr, u32 index1, u32 index2, u32 index3);
+	template <typename T> static void SetPrimitiveTable();
 
-	static u16 *index_buffer_current;
-	static u16 *BASEIptr;
+	static u8 *index_buffer_current;
+	static u8 *BASEIptr;
 	static u32 base_index;
+	static u32 index_shift;
+	static bool use_primitive_restart;
 };
@@ -16,15 +16,16 @@
 #include "VideoCommon/BoundingBox.h"
 #include "VideoCommon/CPMemory.h"
 #include "VideoCommon/CommandProcessor.h"
+#include "VideoCommon/DLCache.h"
 #include "VideoCommon/Fifo.h"
 #include "VideoCommon/GeometryShaderManager.h"
 #include "VideoCommon/TessellationShaderManager.h"
-#include "VideoCommon/IndexGenerator.h"
 #include "VideoCommon/OnScreenDisplay.h"
 #include "VideoCommon/OpcodeDecoding.h"
 #include "VideoCommon/PixelEngine.h"
 #include "VideoCommon/PixelShaderManager.h"
 #include "VideoCommon/RenderBase.h"
+#include "VideoCommon/ScratchMemory.h"
 #include "VideoCommon/TextureCacheBase.h"
 #include "VideoCommon/VertexLoaderManager.h"
 #include "VideoCommon/VertexShaderManager.h"
@@ -161,6 +162,10 @@ u32 VideoBackendBase::Video_GetQueryResult(PerfQueryType type)
 		return 0;
 	}
 
+	// The counters of the completed queries are returned, the pending ones are still in flight
+	if (g_ActiveConfig.bPerfQueriesAsync)
+		return g_perf_query->GetQueryResult(type);
+
 	Fifo::SyncGPU(Fifo::SyncGPUReason::PerfQuery);
 
 	AsyncRequests::Event e;
@@ -177,6 +182,10 @@ u16 VideoBackendBase::Video_GetBoundingBox(int index)
 	if (g_ActiveConfig.iBBoxMode == BBoxNone)
 		return BoundingBox::coords[index];
 
+	// Games needing the exact values turn this off in their game INI
+	if (g_ActiveConfig.bBBoxAsyncReadback)
+		return BoundingBox::readback_coords[index];
+
 	Fifo::SyncGPU(Fifo::SyncGPUReason::BBox);
 
 	AsyncRequests::Event e;
@@ -216,11 +225,12 @@ void VideoBackendBase::InitializeShared()
 	PixelEngine::Init();
 	BPInit();
 	VertexLoaderManager::Init();
-	IndexGenerator::Init();
+	DLCache::Init();
 	VertexShaderManager::Init();
 	GeometryShaderManager::Init();
 	PixelShaderManager::Init(!(g_ActiveConfig.backend_info.APIType & API_D3D9));
-	if (!(g_ActiveConfig.backend_info.APIType & API_D3D9))
+	// OpenGL and Vulkan compare the dirty regions against the last upload.
+	if (!(g_ActiveConfig.backend_info.APIType & (API_D3D9 | API_OPENGL | API_VULKAN)))
 	{
 		PixelShaderManager::DisableDirtyRegions();
 		VertexShaderManager::DisableDirtyRegions();
@@ -245,7 +255,9 @@ void VideoBackendBase::ShutdownShared()
 
 void VideoBackendBase::CleanupShared()
 {
+	DLCache::Shutdown();
 	VertexLoaderManager::Shutdown();
+	ScratchMemory::Trim();
 }
 
 // Run from the CPU thread
@@ -283,6 +295,7 @@ void VideoBackendBase::CheckInvalidState()
 		m_invalid = false;
 
 		BPReload();
-		TextureCacheBase::Invalidate();
+		TextureCacheBase::Revalidate();
+		DLCache::Clear();
 	}
 }
\ No newline at end of file
@@ -31,6 +31,7 @@
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #pragma once
 #include <algorithm>
+#include <climits>
 #include <fstream>
 #include <functional>
 #include <map>
@@ -43,6 +44,13 @@
 
 typedef uint64_t pKey_t;
 
+// Usage files are shared by every backend that keys its cache on the same uid type,
+// so a profile recorded with one backend (or on another machine) can be used to
+// precompile the most likely shaders first with any of them.
+// Layout: format, uid version, categories, objects sorted by priority
+// (category count, usage count, first use).
+constexpr pKey_t OBJECT_USAGE_PROFILE_FORMAT = 0x3200454741535550ULL; // "PUSAGE", format 2
+
 template <typename Tobj, typename TCaterogry, typename TInfo, typename TobjHasher> class ObjectUsageProfiler
 {
 public:
@@ -76,6 +84,10 @@ public:
 	{
 		ObjectMetadata& item = m_objects[obj];
 
+		if (item.usage_count == 0)
+		{
+			item.first_seen = m_next_sequence++;
+		}
 		if (item.usage_count < LLONG_MAX)
 		{
 			item.usage_count++;
@@ -123,6 +135,7 @@ public:
 		m_max_category_index = 0;
 		m_category_mask = 0;
 		m_version = 0;
+		m_next_sequence = 0;
 	}
 
 	void Clear(const std::function<void(const Tobj&, TInfo&)>& eachfunc = {})
@@ -141,6 +154,7 @@ public:
 		m_max_category_index = 0;
 		m_category_mask = 0;
 		m_version = 0;
+		m_next_sequence = 0;
 	}
 
 	const TInfo* GetInfoIfexists(const Tobj& obj) const
@@ -219,59 +233,69 @@ public:
 
 	void PersistToFile(const std::string& path, bool allcategories = false)
 	{
-		std::ofstream out(path, std::ofstream::binary);
-		if (!out.is_open())
-		{
-			return;
-		}
-		bwrite(out, m_version);
-		size_t category_count = allcategories ? m_categories.size() : 1;
-		bwrite(out, category_count);
-		for (auto& item : m_categories)
+		// Write to a temporary file first so a crash never leaves a truncated profile behind
+		std::string temp_path = path + ".tmp";
 		{
-			if (allcategories || item.second.Id == m_category_id)
+			std::ofstream out;
+			OpenFStream(out, temp_path, std::ofstream::binary);
+			if (!out.is_open())
 			{
-				bwrite(out, item.first);
-				bwrite(out, item.second);
+				return;
 			}
-		}
-		size_t object_count = 0;
-		if (allcategories || m_categories.size() == 1)
-		{
-			object_count = m_objects.size();
-		}
-		else
-		{
+			bwrite(out, OBJECT_USAGE_PROFILE_FORMAT);
+			bwrite(out, m_version);
+			pKey_t category_count = allcategories ? m_categories.size() : 1;
+			bwrite(out, category_count);
+			for (auto& item : m_categories)
+			{
+				if (allcategories || item.second.Id == m_category_id)
+				{
+					bwrite(out, item.first);
+					bwrite(out, item.second);
+				}
+			}
+			std::vector<std::pair<const Tobj, ObjectMetadata>*> elements;
 			for (auto& item : m_objects)
 			{
-				if ((item.second.category_mask[m_category_index] & m_category_mask) != 0)
+				if (allcategories || m_categories.size() == 1
+					|| (item.second.category_mask.size() > m_category_index
+						&& (item.second.category_mask[m_category_index] & m_category_mask) != 0))
 				{
-					object_count++;
+					elements.push_back(&item);
 				}
 			}
-		}
-		bwrite(out, object_count);
-		for (auto& item : m_objects)
-		{
-			if (allcategories || m_categories.size() == 1 || (item.second.category_mask[m_category_index] & m_category_mask) != 0)
+			// Store the objects in priority order so the file itself is the precompilation list
+			greater comparer;
+			std::sort(elements.begin(), elements.end(), comparer);
+			pKey_t object_count = elements.size();
+			bwrite(out, object_count);
+			for (auto item : elements)
 			{
-				bwrite(out, item.first);
+				bwrite(out, item->first);
 				if (allcategories)
 				{
-					bwrite(out, item.second.category_count);
+					bwrite(out, item->second.category_count);
 				}
-				bwrite(out, item.second.usage_count);
+				bwrite(out, item->second.usage_count);
+				bwrite(out, item->second.first_seen);
 				if (allcategories)
 				{
-					size_t mask_size = item.second.category_mask.size();
+					pKey_t mask_size = item->second.category_mask.size();
 					bwrite(out, mask_size);
 					if (mask_size > 0)
 					{
-						out.write(reinterpret_cast<char*>(item.second.category_mask.data()), sizeof(size_t) * mask_size);
+						out.write(reinterpret_cast<char*>(item->second.category_mask.data()), sizeof(pKey_t) * mask_size);
 					}
 				}
 			}
+			if (out.fail())
+			{
+				out.close();
+				File::Delete(temp_path);
+				return;
+			}
 		}
+		File::Rename(temp_path, path);
 	}
 
 	void Persist()
@@ -284,14 +308,17 @@ public:
 
 	void ReadFromFile(const std::string& path, bool multicategory = false)
 	{
-		std::ifstream input(path, std::ifstream::binary);
+		std::ifstream input;
+		OpenFStream(input, path, std::ifstream::binary);
 		if (!input.is_open())
 		{
 			return;
 		}
+		pKey_t format = 0;
+		bread(input, format);
 		pKey_t version = 0;
 		bread(input, version);
-		if (version != m_version)
+		if (input.fail() || format != OBJECT_USAGE_PROFILE_FORMAT || version != m_version)
 		{
 			return;
 		}
@@ -301,7 +328,7 @@ public:
 		{
 			category_count = m_categories.size() + 1;
 		}
-		pKey_t category_index = (category_count + 1) / (sizeof(pKey_t) * 8);
+		pKey_t category_index = category_count / (sizeof(pKey_t) * 8);
 		pKey_t category_mask = pKey_t(1) << (category_count % (sizeof(pKey_t) * 8));
 		if (m_max_category_index < category_index + 1)
 		{
@@ -317,6 +344,10 @@ public:
 			bread(input, key);
 			CategoryMetadata data;
 			bread(input, data);
+			if (input.fail())
+			{
+				return;
+			}
 			if (!multicategory)
 			{
 				data.Id = category_count;
@@ -325,39 +356,46 @@ public:
 		}
 		pKey_t object_count = 0;
 		bread(input, object_count);
-		for (size_t i = 0; i < object_count; i++)
+		for (size_t i = 0; i < object_count && !input.fail(); i++)
 		{
 			Tobj key;
 			bread(input, key);
-			ObjectMetadata& data = m_objects[key];
+			ObjectMetadata data;
 			if (multicategory)
 			{
 				bread(input, data.category_count);
 			}
-			else
-			{
-				data.category_count = 0;
-			}
 			bread(input, data.usage_count);
+			bread(input, data.first_seen);
+			data.category_mask.resize(m_max_category_index);
 			if (multicategory)
 			{
-				data.category_mask.resize(m_max_category_index);
 				pKey_t mask_size = 0;
 				bread(input, mask_size);
+				if (input.fail() || mask_size > m_max_category_index)
+				{
+					return;
+				}
 				if (mask_size)
 				{
 					input.read(reinterpret_cast<char*>(data.category_mask.data()), sizeof(pKey_t) * mask_size);
 				}
 			}
-			if (!multicategory)
+			else if ((data.category_mask[category_index] & category_mask) == 0)
 			{
-				data.category_mask.resize(m_max_category_index);
-				if ((data.category_mask[category_index] & category_mask) == 0)
-				{
-					data.category_count++;
-					data.category_mask[category_index] |= category_mask;
-				}
+				data.category_count++;
+				data.category_mask[category_index] |= category_mask;
 			}
+			if (input.fail())
+			{
+				return;
+			}
+			m_next_sequence = std::max(m_next_sequence, data.first_seen + 1);
+			ObjectMetadata& item = m_objects[key];
+			item.category_count = data.category_count;
+			item.usage_count = data.usage_count;
+			item.first_seen = data.first_seen;
+			item.category_mask = std::move(data.category_mask);
 		}
 	}
 
@@ -395,9 +433,11 @@ private:
 	{
 		pKey_t category_count;
 		pKey_t usage_count;
+		// Order in which the objects were first used, persisted across sessions
+		pKey_t first_seen;
 		std::vector<pKey_t> category_mask;
 		TInfo info;
-		ObjectMetadata() : category_count(0), usage_count(0)
+		ObjectMetadata() : category_count(0), usage_count(0), first_seen(0)
 		{}
 	};
 	struct greater
@@ -410,7 +450,11 @@ private:
 			}
 			if (first->second.category_count == second->second.category_count)
 			{
-				return  first->second.usage_count > second->second.usage_count;
+				if (first->second.usage_count == second->second.usage_count)
+				{
+					return first->second.first_seen < second->second.first_seen;
+				}
+				return first->second.usage_count > second->second.usage_count;
 			}
 			return false;
 		}
@@ -427,6 +471,7 @@ private:
 	pKey_t m_max_category_index = {};
 	pKey_t m_category_mask = {};
 	pKey_t m_version = {};
+	pKey_t m_next_sequence = {};
 	std::string m_storage;
 	template<typename T>
 	inline void bwrite(std::ofstream& out, const T& t)
@@ -21,12 +21,14 @@
 #include "VideoCommon/CommandProcessor.h"
 #include "VideoCommon/CPMemory.h"
 #include "VideoCommon/DataReader.h"
+#include "VideoCommon/DLCache.h"
 #include "VideoCommon/Fifo.h"
 #include "VideoCommon/OpcodeDecoding.h"
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/VertexLoaderManager.h"
 #include "VideoCommon/VertexManagerBase.h"
 #include "VideoCommon/VideoCommon.h"
+#include "VideoCommon/VideoConfig.h"
 #include "VideoCommon/XFMemory.h"
 
 bool g_bRecordFifoData = false;
@@ -58,11 +60,15 @@ __forceinline u32 InterpretDisplayList(u32 address, u32 size)
 		u8* old_pVideoData = g_VideoData.GetReadPosition();
 		u8* old_pVideoDataEnd = g_VideoData.GetEnd();
 
-		g_VideoData.SetReadPosition(startAddress, startAddress + size);
-
 		// temporarily swap dl and non-dl (small "hack" for the stats)
 		Statistics::SwapDL();
-		OpcodeDecoder::Run<false, false>(g_VideoData, &cycles);
+		// The fifo recorder needs to see every command, so bypass the cache while recording.
+		if (g_bRecordFifoData || !g_ActiveConfig.bDisplayListCache
+			|| !DLCache::HandleDisplayList(address, startAddress, size, &cycles))
+		{
+			g_VideoData.SetReadPosition(startAddress, startAddress + size);
+			OpcodeDecoder::Run<false, false>(g_VideoData, &cycles);
+		}
 		INCSTAT(stats.thisFrame.numDListsCalled);
 		// un-swap
 		Statistics::SwapDL();
@@ -2,29 +2,70 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
+
 #include "Common/Common.h"
-#include "Core/Core.h"
-#include "Core/Host.h"
+#include "Common/Event.h"
+#include "Common/Flag.h"
+#include "Common/Thread.h"
 #include "Core/HW/Memmap.h"
 #include "VideoCommon/BPMemory.h"
-#include "VideoCommon/CommandProcessor.h"
 #include "VideoCommon/CPMemory.h"
 #include "VideoCommon/DataReader.h"
-#include "VideoCommon/Fifo.h"
-#include "Common/CPUDetect.h"
 #include "VideoCommon/OpcodeDecoding.h"
 #include "VideoCommon/OpcodeDecodingSC.h"
 #include "VideoCommon/VertexLoaderManager.h"
+#include "VideoCommon/VertexManagerBase.h"
 #include "VideoCommon/VideoCommon.h"
 #include "VideoCommon/XFMemory.h"
-#include "VideoCommon/VertexLoader_Normal.h"
-#include "VideoCommon/VertexLoader_TextCoord.h"
-#include "VideoCommon/VertexLoader_Position.h"
-#include "VideoCommon/VertexManagerBase.h"
-
 
 DataReader g_VideoDataSC;
-bool shaderGenDirty = false;
+
+// Data pushed by the CPU thread, indexed by an ever increasing position.
+// Must be a power of two.
+static constexpr u32 RING_SIZE = 4 * 1024 * 1024;
+// Largest amount of data decoded in one go, plus enough room for the partial command left over.
+static constexpr u32 DECODE_CHUNK_SIZE = 64 * 1024;
+static constexpr u32 DECODE_BUFFER_SIZE = DECODE_CHUNK_SIZE + 256;
+
+static std::vector<u8> s_ring;
+static std::atomic<u64> s_ring_write;  // owned by the CPU thread
+static std::atomic<u64> s_ring_read;   // owned by the worker
+// Fifo stream position of ring position 0, only changes while the ring is empty.
+static std::atomic<u64> s_ring_stream_base;
+static u64 s_push_offset;              // owned by the CPU thread
+
+// Set when the ring was full and data had to be dropped. The CPU thread stops pushing
+// until the worker has drained the ring and asks for a restart.
+static bool s_cpu_dropping;
+static std::atomic<bool> s_overflowed;
+static std::atomic<bool> s_restart_requested;
+
+// Resynchronization with the GPU thread.
+static std::atomic<bool> s_resync_requested;
+static std::atomic<bool> s_resync_ready;
+static u64 s_resync_offset;
+static BPMemory s_bpmem_snapshot;
+static XFMemory s_xfmem_snapshot;
+static TVtxDesc s_vtx_desc_snapshot;
+static VAT s_vtx_attr_snapshot[8];
+static u32 s_array_bases_snapshot[16];
+static u32 s_array_strides_snapshot[16];
+
+static std::thread s_worker;
+static Common::Flag s_worker_running;
+static std::atomic<bool> s_worker_sleeping;
+static Common::Event s_worker_event;
+
+// Worker state
+static bool s_lost;
+static u32 s_pending_skip;
+static std::vector<u8> s_decode_buffer;
+static u32 s_decode_size;
+static bool s_shader_gen_dirty;
 
 template <int count>
 void ReadU32xnSC(u32 *bufx16)
@@ -32,7 +73,7 @@ void ReadU32xnSC(u32 *bufx16)
 	g_VideoDataSC.ReadU32xN<count>(bufx16);
 }
 
-DataReadU32xNfunc DataReadU32xFuncsSC[16] = {
+static const OpcodeDecoder::DataReadU32xNfunc DataReadU32xFuncsSC[16] = {
 	ReadU32xnSC<1>,
 	ReadU32xnSC<2>,
 	ReadU32xnSC<3>,
@@ -51,31 +92,25 @@ DataReadU32xNfunc DataReadU32xFuncsSC[16] = {
 	ReadU32xnSC<16>
 };
 
-
-extern u8* GetVideoBufferStartPtrSC();
-extern u8* GetVideoBufferEndPtrSC();
-
-static void DecodeSemiNopSC();
-
 // Bp Register
-BPMemory bpmemSC;
+static BPMemory bpmemSC;
 
 // XF Register
-XFMemory xfmemSC;
+static XFMemory xfmemSC;
 
 // CP Register
-TVtxDesc g_VtxDescSC;
-VAT g_VtxAttrSC[8];
-int s_vtxattr_dirty;
-u32 arraybasesSC[16];
-u32 arraystridesSC[16];
+static TVtxDesc g_VtxDescSC;
+static VAT g_VtxAttrSC[8];
+static int s_vtxattr_dirty;
+static u32 arraybasesSC[16];
+static u32 arraystridesSC[16];
 
-void LoadBPRegSC(u32 value0)
+static void LoadBPRegSC(u32 value0)
 {
 	//handle the mask register
 	int opcode = value0 >> 24;
 	int oldval = ((u32*)&bpmemSC)[opcode];
-	int newval = (oldval & ~bpmemSC.bpMask) | (value0 & bpmemSC.bpMask);	
+	int newval = (oldval & ~bpmemSC.bpMask) | (value0 & bpmemSC.bpMask);
 	//reset the mask register
 	if (opcode != 0xFE)
 		bpmemSC.bpMask = 0xFFFFFF;
@@ -83,7 +118,7 @@ void LoadBPRegSC(u32 value0)
 	((u32*)&bpmemSC)[opcode] = newval;
 }
 
-void LoadXFRegSC(u32 transferSize, u32 baseAddress)
+static void LoadXFRegSC(u32 transferSize, u32 baseAddress)
 {
 	// do not allow writes past registers
 	if (baseAddress + transferSize > 0x1058)
@@ -124,7 +159,7 @@ void LoadXFRegSC(u32 transferSize, u32 baseAddress)
 	}
 }
 
-void LoadIndexedXFSC(u32 val, int refarray)
+static void LoadIndexedXFSC(u32 val, int refarray)
 {
 	int index = val >> 16;
 	int address = val & 0xFFF; // check mask
@@ -133,11 +168,13 @@ void LoadIndexedXFSC(u32 val, int refarray)
 
 	u32* currData = ((u32*)&xfmemSC) + address;
 	u32* newData = (u32*)Memory::GetPointer(arraybasesSC[refarray] + arraystridesSC[refarray] * index);
+	if (newData == nullptr || address + size > 0x1058)
+		return;
 	for (int i = 0; i < size; ++i)
 		currData[i] = Common::swap32(newData[i]);
 }
 
-void LoadCPRegSC(u32 sub_cmd, u32 value)
+static void LoadCPRegSC(u32 sub_cmd, u32 value)
 {
 	switch (sub_cmd & 0xF0)
 	{
@@ -157,19 +194,16 @@ void LoadCPRegSC(u32 sub_cmd, u32 value)
 		break;
 
 	case 0x70:
-		_assert_((sub_cmd & 0x0F) < 8);
 		g_VtxAttrSC[sub_cmd & 7].g0.Hex = value;
 		s_vtxattr_dirty |= 1 << (sub_cmd & 7);
 		break;
 
 	case 0x80:
-		_assert_((sub_cmd & 0x0F) < 8);
 		g_VtxAttrSC[sub_cmd & 7].g1.Hex = value;
 		s_vtxattr_dirty |= 1 << (sub_cmd & 7);
 		break;
 
 	case 0x90:
-		_assert_((sub_cmd & 0x0F) < 8);
 		g_VtxAttrSC[sub_cmd & 7].g2.Hex = value;
 		s_vtxattr_dirty |= 1 << (sub_cmd & 7);
 		break;
@@ -177,7 +211,6 @@ void LoadCPRegSC(u32 sub_cmd, u32 value)
 		// Pointers to vertex arrays in GC RAM
 	case 0xA0:
 		arraybasesSC[sub_cmd & 0xF] = value;
-		//cached_arraybasesSC[sub_cmd & 0xF] = Memory::GetPointer(value);
 		break;
 
 	case 0xB0:
@@ -188,8 +221,9 @@ void LoadCPRegSC(u32 sub_cmd, u32 value)
 
 static void InterpretDisplayList(u32 address, u32 size);
 
+// Returns false if more data is required or the stream can't be decoded.
 template<bool sizeCheck>
-inline bool DecodeSC(const u8* end)
+static bool DecodeSC(const u8* end)
 {
 	const u8 *opcodeStart = g_VideoDataSC.GetReadPosition();
 	if (opcodeStart == end)
@@ -201,8 +235,9 @@ inline bool DecodeSC(const u8* end)
 	switch (cmd_byte)
 	{
 	case GX_NOP:
+	case GX_UNKNOWN_RESET:
 	case GX_CMD_UNKNOWN_METRICS: // zelda 4 swords calls it and checks the metrics registers after that
-	case GX_CMD_INVL_VC: // Invalidate Vertex Cache	
+	case GX_CMD_INVL_VC: // Invalidate Vertex Cache
 		break;
 	case GX_LOAD_CP_REG: //0x08
 	{
@@ -210,10 +245,10 @@ inline bool DecodeSC(const u8* end)
 			return false;
 		u8 sub_cmd = g_VideoDataSC.Read<u8>();
 		u32 value = g_VideoDataSC.Read<u32>();
-		LoadCPRegSC(sub_cmd, value); 
-		shaderGenDirty = true;
+		LoadCPRegSC(sub_cmd, value);
+		s_shader_gen_dirty = true;
 	}
-		break;
+	break;
 	case GX_LOAD_XF_REG:
 	{
 		if (sizeCheck && distance < GX_LOAD_XF_REG_SIZE)
@@ -225,41 +260,20 @@ inline bool DecodeSC(const u8* end)
 			return false;
 		u32 xf_address = Cmd2 & 0xFFFF;
 		LoadXFRegSC(transfer_size, xf_address);
-		shaderGenDirty = true;
+		s_shader_gen_dirty = true;
 	}
-		break;
+	break;
 	case GX_LOAD_INDX_A: //used for position matrices
-	{	
-		if (sizeCheck && distance < GX_LOAD_INDX_A_SIZE)
-			return false;
-		LoadIndexedXFSC(g_VideoDataSC.Read<u32>(), 0xC);
-		shaderGenDirty = true;
-	}
-		break;
 	case GX_LOAD_INDX_B: //used for normal matrices
-	{
-		if (sizeCheck && distance < GX_LOAD_INDX_B_SIZE)
-			return false;
-		LoadIndexedXFSC(g_VideoDataSC.Read<u32>(), 0xD);
-		shaderGenDirty = true;
-	}
-		break;
 	case GX_LOAD_INDX_C: //used for postmatrices
-	{
-		if (sizeCheck && distance < GX_LOAD_INDX_C_SIZE)
-			return false;
-		LoadIndexedXFSC(g_VideoDataSC.Read<u32>(), 0xE);
-		shaderGenDirty = true;
-	}
-		break;
 	case GX_LOAD_INDX_D: //used for lights
 	{
-		if (sizeCheck && distance < GX_LOAD_INDX_D_SIZE)
+		if (sizeCheck && distance < GX_LOAD_INDX_SIZE)
 			return false;
-		LoadIndexedXFSC(g_VideoDataSC.Read<u32>(), 0xF);
-		shaderGenDirty = true;
+		LoadIndexedXFSC(g_VideoDataSC.Read<u32>(), (cmd_byte >> 3) + 8);
+		s_shader_gen_dirty = true;
 	}
-		break;
+	break;
 	case GX_CMD_CALL_DL:
 	{
 		if (sizeCheck && distance < GX_CMD_CALL_DL_SIZE)
@@ -268,17 +282,17 @@ inline bool DecodeSC(const u8* end)
 		u32 count = g_VideoDataSC.Read<u32>();
 		InterpretDisplayList(address, count);
 	}
-		break;	
+	break;
 	case GX_LOAD_BP_REG: //0x61
 	{
 		if (sizeCheck && distance < GX_LOAD_BP_REG_SIZE)
 			return false;
 		u32 bp_cmd = g_VideoDataSC.Read<u32>();
 		LoadBPRegSC(bp_cmd);
-		shaderGenDirty = true;
+		s_shader_gen_dirty = true;
 	}
-		break;
-		// draw primitives 
+	break;
+	// draw primitives
 	default:
 		if ((cmd_byte & GX_DRAW_PRIMITIVES) == 0x80)
 		{
@@ -293,92 +307,301 @@ inline bool DecodeSC(const u8* end)
 			parameters.needloaderrefresh = (s_vtxattr_dirty & (1 << parameters.vtx_attr_group)) != 0;
 			parameters.VtxDesc = &g_VtxDescSC;
 			parameters.VtxAttr = &g_VtxAttrSC[parameters.vtx_attr_group];
+			// This creates the vertex loader if it hasn't been seen yet.
 			VertexLoaderManager::GetVertexSizeAndComponents(parameters, vertexSize, components);
 			s_vtxattr_dirty &= ~(1 << parameters.vtx_attr_group);
 			vertexSize *= numVertices;
-			if (shaderGenDirty)
+			if (s_shader_gen_dirty && numVertices)
 			{
 				g_vertex_manager->PrepareShaders(VertexManagerBase::GetPrimitiveType((cmd_byte & GX_PRIMITIVE_MASK) >> GX_PRIMITIVE_SHIFT),
-					components, 
-					xfmemSC, 
-					bpmemSC, 
+					components,
+					xfmemSC,
+					bpmemSC,
 					false);
-				shaderGenDirty = false;
+				s_shader_gen_dirty = false;
+			}
+			if (distance < vertexSize)
+			{
+				// The vertex data itself isn't needed, so there is no reason to wait for all of it.
+				s_pending_skip = sizeCheck ? u32(vertexSize - distance) : 0;
+				g_VideoDataSC.ReadSkip(u32(distance));
+			}
+			else
+			{
+				g_VideoDataSC.ReadSkip(vertexSize);
 			}
-			if (sizeCheck &&  distance < vertexSize)
-				return false;
-			g_VideoDataSC.ReadSkip(vertexSize);
 		}
 		else
 		{
-			g_VideoDataSC.SetReadPosition(end);
-			PanicAlert("Unknown Opcode on predictive fifo.");			
+			// Most likely we are decoding a different stream than the GPU thread.
+			s_lost = true;
+			g_VideoDataSC.SetReadPosition((u8*)end);
+			return false;
 		}
 		break;
 	}
 	return true;
 }
 
-
 static void InterpretDisplayList(u32 address, u32 size)
 {
-	const u8* old_pVideoData = g_VideoDataSC.GetReadPosition();
-	const u8* startAddress = Memory::GetPointer(address);
+	u8* old_pVideoData = g_VideoDataSC.GetReadPosition();
+	u8* old_pVideoDataEnd = g_VideoDataSC.GetEnd();
+	u8* startAddress = Memory::GetPointer(address);
 
 	// Avoid the crash if Memory::GetPointer failed ..
 	if (startAddress != nullptr)
 	{
-		g_VideoDataSC.SetReadPosition(startAddress);
 		const u8 *end = startAddress + size;
-		while (g_VideoDataSC.GetReadPosition() < end)
+		g_VideoDataSC.SetReadPosition(startAddress, (u8*)end);
+		while (g_VideoDataSC.GetReadPosition() < end && !s_lost)
 		{
 			DecodeSC<false>(end);
 		}
+		s_lost = false;
 	}
 	// reset to the old pointer
-	g_VideoDataSC.SetReadPosition(old_pVideoData);
+	g_VideoDataSC.SetReadPosition(old_pVideoData, old_pVideoDataEnd);
+}
+
+static void ApplySnapshot()
+{
+	memcpy(&bpmemSC, &s_bpmem_snapshot, sizeof(bpmemSC));
+	memcpy(&xfmemSC, &s_xfmem_snapshot, sizeof(xfmemSC));
+	g_VtxDescSC = s_vtx_desc_snapshot;
+	memcpy(g_VtxAttrSC, s_vtx_attr_snapshot, sizeof(g_VtxAttrSC));
+	memcpy(arraybasesSC, s_array_bases_snapshot, sizeof(arraybasesSC));
+	memcpy(arraystridesSC, s_array_strides_snapshot, sizeof(arraystridesSC));
+	s_vtxattr_dirty = 0xFF;
+	s_shader_gen_dirty = true;
+}
+
+// Returns true once the worker is in sync with the stream again.
+static bool TryResync()
+{
+	if (s_overflowed.load())
+	{
+		// The CPU thread doesn't push anymore, throw everything away and let it restart.
+		s_ring_read.store(s_ring_write.load());
+		s_overflowed.store(false);
+		s_restart_requested.store(true);
+	}
+	if (s_restart_requested.load())
+		return false;
+	if (!s_resync_ready.load())
+	{
+		s_resync_requested.store(true);
+		return false;
+	}
+	s_resync_ready.store(false);
+	u64 offset = s_resync_offset;
+	u64 base = s_ring_stream_base.load();
+	u64 first = s_ring_read.load() + base;
+	u64 last = s_ring_write.load() + base;
+	if (offset < first || offset > last)
+	{
+		// The GPU thread is either behind the data we have or ahead of it, try again later.
+		s_resync_requested.store(true);
+		return false;
+	}
+	s_ring_read.store(offset - base);
+	ApplySnapshot();
+	s_decode_size = 0;
+	s_pending_skip = 0;
+	s_lost = false;
+	return true;
+}
+
+static void DecodeAvailableData()
+{
+	u64 read = s_ring_read.load();
+	u64 write = s_ring_write.load();
+	u32 available = u32(write - read);
+	if (s_pending_skip)
+	{
+		u32 skip = std::min(s_pending_skip, available);
+		s_pending_skip -= skip;
+		read += skip;
+		available -= skip;
+	}
+	u32 size = std::min(available, DECODE_BUFFER_SIZE - s_decode_size);
+	size = std::min(size, DECODE_CHUNK_SIZE);
+	u32 ring_pos = u32(read & (RING_SIZE - 1));
+	u32 first_part = std::min(size, RING_SIZE - ring_pos);
+	memcpy(&s_decode_buffer[s_decode_size], &s_ring[ring_pos], first_part);
+	memcpy(&s_decode_buffer[s_decode_size + first_part], &s_ring[0], size - first_part);
+	s_decode_size += size;
+	s_ring_read.store(read + size);
+
+	u8* start = s_decode_buffer.data();
+	u8* end = start + s_decode_size;
+	g_VideoDataSC.SetReadPosition(start, end);
+	while (true)
+	{
+		u8* old = g_VideoDataSC.GetReadPosition();
+		if (!DecodeSC<true>(end))
+		{
+			g_VideoDataSC.SetReadPosition(old, end);
+			break;
+		}
+	}
+	if (s_lost)
+	{
+		s_decode_size = 0;
+		s_pending_skip = 0;
+		return;
+	}
+	// Keep the partial command for the next round.
+	u32 leftover = u32(end - g_VideoDataSC.GetReadPosition());
+	memmove(start, g_VideoDataSC.GetReadPosition(), leftover);
+	s_decode_size = leftover;
+}
+
+static bool HasWork()
+{
+	if (s_lost)
+		return s_resync_ready.load() || s_overflowed.load();
+	return s_ring_write.load() != s_ring_read.load() || s_overflowed.load();
+}
+
+static void WorkerThread()
+{
+	Common::SetCurrentThreadName("Predictive Fifo");
+	while (s_worker_running.IsSet())
+	{
+		s_worker_sleeping.store(true);
+		if (!HasWork())
+		{
+			s_worker_event.WaitFor(std::chrono::milliseconds(10));
+			s_worker_sleeping.store(false);
+			continue;
+		}
+		s_worker_sleeping.store(false);
+		if (s_overflowed.load())
+		{
+			s_lost = true;
+		}
+		if (s_lost && !TryResync())
+		{
+			continue;
+		}
+		DecodeAvailableData();
+	}
 }
 
 void OpcodeDecoderSC_Init()
 {
-	g_VideoDataSC.SetReadPosition(GetVideoBufferStartPtrSC());
+	s_ring.assign(RING_SIZE, 0);
+	s_decode_buffer.assign(DECODE_BUFFER_SIZE, 0);
+	s_ring_write.store(0);
+	s_ring_read.store(0);
+	s_ring_stream_base.store(0);
+	s_push_offset = 0;
+	s_cpu_dropping = false;
+	s_overflowed.store(false);
+	s_restart_requested.store(false);
+	s_resync_requested.store(false);
+	s_resync_ready.store(false);
+	s_decode_size = 0;
+	s_pending_skip = 0;
+	// We don't know anything about the state yet, start with a copy from the GPU thread.
+	s_lost = true;
 
-	//bpmem Init
 	memset(&bpmemSC, 0, sizeof(bpmemSC));
 	bpmemSC.bpMask = 0xFFFFFF;
-
-	memset(arraybasesSC, 0, sizeof(g_main_cp_state.array_bases));
-	memset(arraystridesSC, 0, sizeof(g_main_cp_state.array_strides));
-	//memset(&g_main_cp_state.matrix_index_a, 0, sizeof(g_main_cp_state.matrix_index_a));
-	//memset(&g_main_cp_state.matrix_index_b, 0, sizeof(g_main_cp_state.matrix_index_b));
+	memset(&xfmemSC, 0, sizeof(xfmemSC));
+	memset(arraybasesSC, 0, sizeof(arraybasesSC));
+	memset(arraystridesSC, 0, sizeof(arraystridesSC));
 	memset(&g_VtxDescSC, 0, sizeof(g_VtxDescSC));
 	memset(g_VtxAttrSC, 0, sizeof(g_VtxAttrSC));
 	s_vtxattr_dirty = 0xFF;
-	shaderGenDirty = true;
-
-	VertexLoader_Normal::Init();
-	VertexLoader_Position::Init();
-	VertexLoader_TextCoord::Init();
+	s_shader_gen_dirty = true;
 }
 
-
 void OpcodeDecoderSC_Shutdown()
 {
+	OpcodeDecoderSC_Stop();
+	s_ring.clear();
+	s_ring.shrink_to_fit();
+	s_decode_buffer.clear();
+	s_decode_buffer.shrink_to_fit();
+}
 
+void OpcodeDecoderSC_Start()
+{
+	if (s_worker_running.TestAndSet())
+		s_worker = std::thread(WorkerThread);
 }
 
+void OpcodeDecoderSC_Stop()
+{
+	if (s_worker_running.TestAndClear())
+	{
+		s_worker_event.Set();
+		s_worker.join();
+	}
+}
 
-void OpcodeDecoderSC_Run(const u8* end)
+void OpcodeDecoderSC_PushData(const u8* data, u32 size)
 {
-	while (true)
+	u64 offset = s_push_offset;
+	s_push_offset += size;
+	if (s_cpu_dropping)
 	{
-		const u8* old = g_VideoDataSC.GetReadPosition();
-		if (!DecodeSC<true>(end))
-		{
-			g_VideoDataSC.SetReadPosition(old);
-			break;
-		}
+		// Wait until the worker has thrown away everything that was queued.
+		if (!s_restart_requested.load())
+			return;
+		s_ring_stream_base.store(offset - s_ring_write.load());
+		s_cpu_dropping = false;
+		s_restart_requested.store(false);
+	}
+	else if (s_restart_requested.load())
+	{
+		// A restart raced with a reset, the data in the ring is still consistent.
+		s_restart_requested.store(false);
 	}
+	u64 write = s_ring_write.load();
+	if (write - s_ring_read.load() + size > RING_SIZE)
+	{
+		s_cpu_dropping = true;
+		s_overflowed.store(true);
+		s_worker_event.Set();
+		return;
+	}
+	u32 ring_pos = u32(write & (RING_SIZE - 1));
+	u32 first_part = std::min(size, RING_SIZE - ring_pos);
+	memcpy(&s_ring[ring_pos], data, first_part);
+	memcpy(&s_ring[0], data + first_part, size - first_part);
+	s_ring_write.store(write + size);
+	if (s_worker_sleeping.load())
+		s_worker_event.Set();
+}
+
+void OpcodeDecoderSC_SyncPoint(u64 fifo_offset)
+{
+	if (!s_resync_requested.load())
+		return;
+	memcpy(&s_bpmem_snapshot, &bpmem, sizeof(bpmem));
+	memcpy(&s_xfmem_snapshot, &xfmem, sizeof(xfmem));
+	s_vtx_desc_snapshot = g_main_cp_state.vtx_desc;
+	memcpy(s_vtx_attr_snapshot, g_main_cp_state.vtx_attr, sizeof(s_vtx_attr_snapshot));
+	memcpy(s_array_bases_snapshot, g_main_cp_state.array_bases, sizeof(s_array_bases_snapshot));
+	memcpy(s_array_strides_snapshot, g_main_cp_state.array_strides, sizeof(s_array_strides_snapshot));
+	s_resync_offset = fifo_offset;
+	s_resync_requested.store(false);
+	s_resync_ready.store(true);
+	s_worker_event.Set();
 }
 
+void OpcodeDecoderSC_Reset()
+{
+	// Handled exactly like an overflow, the worker drops what it has and resynchronizes.
+	s_cpu_dropping = true;
+	s_overflowed.store(true);
+	s_worker_event.Set();
+}
 
+u64 OpcodeDecoderSC_GetPushOffset()
+{
+	return s_push_offset;
+}
@@ -1,13 +1,37 @@
 // Copyright 2013 Dolphin Emulator Project
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
-#pragma once 
+#pragma once
 #include "Common/CommonTypes.h"
 #include "VideoCommon/DataReader.h"
 
+// Predictive fifo.
+// In dual core mode every gather pipe burst is also handed to a worker thread that decodes the
+// command stream ahead of the GPU thread with its own shadow copy of the BP/CP/XF state.
+// The draws it finds are used to create vertex loaders and to queue the compilation of
+// their shaders, so they are usually ready by the time the GPU thread reaches them.
+// The worker only produces hints: whenever it loses track of the stream it asks the GPU
+// thread for a copy of the real state at a command boundary and continues from there.
+
 void OpcodeDecoderSC_Init();
 void OpcodeDecoderSC_Shutdown();
-void OpcodeDecoderSC_Run(const u8* end);
-void ExecuteDisplayListSC(u32 address, u32 size);
 
-extern DataReader g_VideoDataSC;
\ No newline at end of file
+// Start and stop the worker thread, called by the GPU thread while the video backend is active.
+void OpcodeDecoderSC_Start();
+void OpcodeDecoderSC_Stop();
+
+// CPU thread: queues data written to the fifo by the gather pipe.
+void OpcodeDecoderSC_PushData(const u8* data, u32 size);
+
+// GPU thread: fifo_offset is the position in the fifo stream of the next command
+// the GPU thread will decode. Used to resynchronize the worker if required.
+void OpcodeDecoderSC_SyncPoint(u64 fifo_offset);
+
+// CPU thread, while the GPU thread is paused: the stream seen by both threads changed
+// (savestate load or fifo reset), so the worker has to resynchronize.
+void OpcodeDecoderSC_Reset();
+
+// Current position of the CPU thread in the fifo stream.
+u64 OpcodeDecoderSC_GetPushOffset();
+
+extern DataReader g_VideoDataSC;
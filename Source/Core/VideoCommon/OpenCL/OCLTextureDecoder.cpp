@@ -7,6 +7,7 @@
 #include "../OpenCL.h"
 #include "Common/CommonPaths.h"
 #include "Common/FileUtil.h"
+#include "Common/MathUtil.h"
 #include "Common/Logging/Log.h"
 #include "Common/MsgHandler.h"
 
@@ -16,9 +17,9 @@
 #include <string.h>
 #include <math.h>
 #include <sys/types.h>
+#include <algorithm>
 #include <string>
-
-//#define DEBUG_OPENCL
+#include <vector>
 
 cl_program g_program;
 
@@ -71,6 +72,24 @@ sDecoderParameter g_DecodeParametersRGBA[] = {
 
 bool g_Inited = false;
 cl_mem g_clsrc, g_cldst;                    // texture buffer memory objects
+cl_mem g_pinned_src, g_pinned_dst;          // host staging memory the transfers are made from
+u8 *g_pinned_src_ptr, *g_pinned_dst_ptr;
+size_t g_buffer_alignment = 1;
+
+// Staging memory is shared by all decodes of a batch, so several textures can be queued
+// before the results are collected. The largest Wii texture takes 4 MB once decoded.
+#define BATCH_BUFFER_SIZE (16 * 1024 * 1024)
+
+struct sPendingDecode
+{
+	u32 fence;
+	size_t dst_offset;
+	cl_event event;
+};
+
+std::vector<sPendingDecode> g_pending_decodes;
+size_t g_batch_src_used, g_batch_dst_used;
+u32 g_next_fence = 1;
 
 #define HEADER_SIZE	32
 
@@ -232,11 +251,35 @@ void TexDecoder_OpenCL_Initialize()
 					g_DecodeParametersRGBA[i].name);
 		}
 
-		// Allocating maximal Wii texture size in advance, so that we don't have to allocate/deallocate per texture
-#ifndef DEBUG_OPENCL
-		g_clsrc = clCreateBuffer(OpenCL::GetContext(), CL_MEM_READ_ONLY, 1024 * 1024 * sizeof(u32), NULL, NULL);
-		g_cldst = clCreateBuffer(OpenCL::GetContext(), CL_MEM_WRITE_ONLY, 1024 * 1024 * sizeof(u32), NULL, NULL);
-#endif
+		// Device buffers the kernels work on, and pinned host buffers that are mapped once so the
+		// transfers can be done with DMA without blocking the calling thread.
+		cl_context context = OpenCL::GetContext();
+		g_clsrc = clCreateBuffer(context, CL_MEM_READ_ONLY, BATCH_BUFFER_SIZE, NULL, NULL);
+		g_cldst = clCreateBuffer(context, CL_MEM_WRITE_ONLY, BATCH_BUFFER_SIZE, NULL, NULL);
+		g_pinned_src = clCreateBuffer(context, CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, BATCH_BUFFER_SIZE, NULL, NULL);
+		g_pinned_dst = clCreateBuffer(context, CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, BATCH_BUFFER_SIZE, NULL, NULL);
+		if (!g_clsrc || !g_cldst || !g_pinned_src || !g_pinned_dst)
+		{
+			ERROR_LOG(VIDEO, "Failed to allocate OpenCL texture decoding buffers");
+			TexDecoder_OpenCL_Shutdown();
+			return;
+		}
+		g_pinned_src_ptr = (u8*)clEnqueueMapBuffer(OpenCL::GetCommandQueue(), g_pinned_src, CL_TRUE, CL_MAP_WRITE, 0, BATCH_BUFFER_SIZE, 0, NULL, NULL, &err);
+		if (err == CL_SUCCESS)
+			g_pinned_dst_ptr = (u8*)clEnqueueMapBuffer(OpenCL::GetCommandQueue(), g_pinned_dst, CL_TRUE, CL_MAP_READ, 0, BATCH_BUFFER_SIZE, 0, NULL, NULL, &err);
+		if (err != CL_SUCCESS)
+		{
+			OpenCL::HandleCLError(err, "clEnqueueMapBuffer");
+			TexDecoder_OpenCL_Shutdown();
+			return;
+		}
+
+		// Each decode works on a sub-buffer, which has to start at an aligned offset.
+		cl_uint align_bits = 0;
+		clGetDeviceInfo(OpenCL::device_id, CL_DEVICE_MEM_BASE_ADDR_ALIGN, sizeof(align_bits), &align_bits, NULL);
+		g_buffer_alignment = std::max<size_t>(align_bits / 8, 1);
+		g_batch_src_used = 0;
+		g_batch_dst_used = 0;
 
 		g_Inited = true;
 	}
@@ -244,67 +287,185 @@ void TexDecoder_OpenCL_Initialize()
 
 void TexDecoder_OpenCL_Shutdown()
 {
+	TexDecoder_OpenCL_ReleaseResults();
+
 	if (g_program)
 		clReleaseProgram(g_program);
+	g_program = NULL;
 
-	for (int i = 0; i < GX_TF_CMPR; ++i)
+	for (int i = 0; i <= GX_TF_CMPR; ++i)
 	{
 		if (g_DecodeParametersNative[i].kernel)
 			clReleaseKernel(g_DecodeParametersNative[i].kernel);
+		g_DecodeParametersNative[i].kernel = NULL;
 
 		if (g_DecodeParametersRGBA[i].kernel)
 			clReleaseKernel(g_DecodeParametersRGBA[i].kernel);
+		g_DecodeParametersRGBA[i].kernel = NULL;
 	}
 
-	if (g_clsrc)
-		clReleaseMemObject(g_clsrc);
+	if (g_pinned_src_ptr)
+		clEnqueueUnmapMemObject(OpenCL::GetCommandQueue(), g_pinned_src, g_pinned_src_ptr, 0, NULL, NULL);
+	if (g_pinned_dst_ptr)
+		clEnqueueUnmapMemObject(OpenCL::GetCommandQueue(), g_pinned_dst, g_pinned_dst_ptr, 0, NULL, NULL);
+	g_pinned_src_ptr = NULL;
+	g_pinned_dst_ptr = NULL;
+	if (OpenCL::GetCommandQueue())
+		clFinish(OpenCL::GetCommandQueue());
 
-	if (g_cldst)
-		clReleaseMemObject(g_cldst);
+	for (cl_mem* mem : { &g_clsrc, &g_cldst, &g_pinned_src, &g_pinned_dst })
+	{
+		if (*mem)
+			clReleaseMemObject(*mem);
+		*mem = NULL;
+	}
 
 	g_Inited = false;
 }
 
-PC_TexFormat TexDecoder_Decode_OpenCL(u8 *dst, const u8 *src, int width, int height, int texformat, int tlutaddr, TlutFormat tlutfmt, bool rgba)
+bool TexDecoder_OpenCL_IsInitialized()
 {
-	cl_int err;
+	return g_Inited;
+}
+
+static sDecoderParameter* GetDecoder(u32 texformat, bool rgba)
+{
+	if (texformat > GX_TF_CMPR)
+		return nullptr;
 	sDecoderParameter& decoder = rgba ? g_DecodeParametersRGBA[texformat] : g_DecodeParametersNative[texformat];
-	if (!g_Inited || !decoder.name || !decoder.kernel || decoder.format == PC_TEX_FMT_NONE)
-		return PC_TEX_FMT_NONE;
+	if (!decoder.name || !decoder.kernel || decoder.format == PC_TEX_FMT_NONE)
+		return nullptr;
+	return &decoder;
+}
+
+PC_TexFormat TexDecoder_OpenCL_GetFormat(u32 texformat, bool rgba)
+{
+	sDecoderParameter* decoder = g_Inited ? GetDecoder(texformat, rgba) : nullptr;
+	return decoder ? decoder->format : PC_TEX_FMT_NONE;
+}
+
+u32 TexDecoder_OpenCL_QueueDecode(const u8 *src, u32 width, u32 height, u32 texformat, bool rgba)
+{
+	sDecoderParameter* decoder = g_Inited ? GetDecoder(texformat, rgba) : nullptr;
+	if (!decoder)
+		return 0;
+
+	const size_t src_size = (size_t)(width * height * decoder->sizeOfSrc);
+	const size_t dst_size = (size_t)(width * height * decoder->sizeOfDst);
+	const size_t src_offset = ROUND_UP(g_batch_src_used, g_buffer_alignment);
+	const size_t dst_offset = ROUND_UP(g_batch_dst_used, g_buffer_alignment);
+	// Never wait for the device here, the caller decodes on the CPU instead.
+	if (src_offset + src_size > BATCH_BUFFER_SIZE || dst_offset + dst_size > BATCH_BUFFER_SIZE)
+		return 0;
 
-#ifdef DEBUG_OPENCL
-	g_clsrc = clCreateBuffer(OpenCL::GetContext(), CL_MEM_READ_ONLY, 1024 * 1024 * sizeof(u32), NULL, NULL);
-	g_cldst = clCreateBuffer(OpenCL::GetContext(), CL_MEM_WRITE_ONLY, 1024 * 1024 * sizeof(u32), NULL, NULL);
-#endif
+	cl_int err;
+	cl_buffer_region src_region = { src_offset, src_size };
+	cl_buffer_region dst_region = { dst_offset, dst_size };
+	cl_mem src_mem = clCreateSubBuffer(g_clsrc, CL_MEM_READ_ONLY, CL_BUFFER_CREATE_TYPE_REGION, &src_region, &err);
+	if (err != CL_SUCCESS)
+	{
+		OpenCL::HandleCLError(err, "clCreateSubBuffer");
+		return 0;
+	}
+	cl_mem dst_mem = clCreateSubBuffer(g_cldst, CL_MEM_WRITE_ONLY, CL_BUFFER_CREATE_TYPE_REGION, &dst_region, &err);
+	if (err != CL_SUCCESS)
+	{
+		OpenCL::HandleCLError(err, "clCreateSubBuffer");
+		clReleaseMemObject(src_mem);
+		return 0;
+	}
 
-	clEnqueueWriteBuffer(OpenCL::GetCommandQueue(), g_clsrc, CL_TRUE, 0, (size_t)(width * height * decoder.sizeOfSrc), src, 0, NULL, NULL);
+	memcpy(g_pinned_src_ptr + src_offset, src, src_size);
 
-	clSetKernelArg(decoder.kernel, 0, sizeof(cl_mem), &g_cldst);
-	clSetKernelArg(decoder.kernel, 1, sizeof(cl_mem), &g_clsrc);
-	clSetKernelArg(decoder.kernel, 2, sizeof(cl_int), &width);
+	// The queue is in order, so the kernel and the readback run after the upload.
+	cl_command_queue queue = OpenCL::GetCommandQueue();
+	cl_event event = NULL;
+	err = clEnqueueWriteBuffer(queue, g_clsrc, CL_FALSE, src_offset, src_size, g_pinned_src_ptr + src_offset, 0, NULL, NULL);
+	if (err == CL_SUCCESS)
+	{
+		// Kernel arguments are captured when the kernel is enqueued.
+		cl_int kernel_width = width;
+		clSetKernelArg(decoder->kernel, 0, sizeof(cl_mem), &dst_mem);
+		clSetKernelArg(decoder->kernel, 1, sizeof(cl_mem), &src_mem);
+		clSetKernelArg(decoder->kernel, 2, sizeof(cl_int), &kernel_width);
+
+		size_t global[] = { (size_t)(width / decoder->xSkip), (size_t)(height / decoder->ySkip) };
+		err = clEnqueueNDRangeKernel(queue, decoder->kernel, 2, NULL, global, NULL, 0, NULL, NULL);
+		if (err != CL_SUCCESS)
+			OpenCL::HandleCLError(err, "Failed to enqueue kernel");
+	}
+	if (err == CL_SUCCESS)
+		err = clEnqueueReadBuffer(queue, g_cldst, CL_FALSE, dst_offset, dst_size, g_pinned_dst_ptr + dst_offset, 0, NULL, &event);
 
-	size_t global[] = { (size_t)(width / decoder.xSkip), (size_t)(height / decoder.ySkip) };
+	// The sub-buffers are only freed once the commands using them have completed.
+	clReleaseMemObject(src_mem);
+	clReleaseMemObject(dst_mem);
+	if (err != CL_SUCCESS)
+	{
+		// Make sure nothing of this decode is still in flight before its memory gets reused.
+		clFinish(queue);
+		return 0;
+	}
 
-	// No work-groups for now
-	/*
-	size_t local;
-	err = clGetKernelWorkGroupInfo(kernelToRun, OpenCL::device_id, CL_KERNEL_WORK_GROUP_SIZE, sizeof(local), &local, NULL);
-	if(err)
-		PanicAlert("Error obtaining work-group information");
-	*/
+	g_batch_src_used = src_offset + src_size;
+	g_batch_dst_used = dst_offset + dst_size;
+	const u32 fence = g_next_fence++;
+	if (g_next_fence == 0)
+		g_next_fence = 1;
+	g_pending_decodes.push_back({ fence, dst_offset, event });
+	return fence;
+}
 
-	err = clEnqueueNDRangeKernel(OpenCL::GetCommandQueue(), decoder.kernel, 2, NULL, global, NULL, 0, NULL, NULL);
-	if (err)
-		OpenCL::HandleCLError(err, "Failed to enqueue kernel");
+void TexDecoder_OpenCL_Flush()
+{
+	if (g_Inited && !g_pending_decodes.empty())
+		clFlush(OpenCL::GetCommandQueue());
+}
 
-	clFinish(OpenCL::GetCommandQueue());
+static sPendingDecode* FindPendingDecode(u32 fence)
+{
+	auto iter = std::find_if(g_pending_decodes.begin(), g_pending_decodes.end(),
+		[fence](const sPendingDecode& decode) { return decode.fence == fence; });
+	return iter != g_pending_decodes.end() ? &*iter : nullptr;
+}
 
-	clEnqueueReadBuffer(OpenCL::GetCommandQueue(), g_cldst, CL_TRUE, 0, (size_t)(width * height * decoder.sizeOfDst), dst, 0, NULL, NULL);
+bool TexDecoder_OpenCL_FencePassed(u32 fence)
+{
+	sPendingDecode* decode = FindPendingDecode(fence);
+	if (!decode)
+		return true;
 
-#ifdef DEBUG_OPENCL
-	clReleaseMemObject(g_clsrc);
-	clReleaseMemObject(g_cldst);
-#endif
+	cl_int status = CL_QUEUED;
+	clGetEventInfo(decode->event, CL_EVENT_COMMAND_EXECUTION_STATUS, sizeof(status), &status, NULL);
+	return status == CL_COMPLETE;
+}
 
-	return decoder.format;
+const u8* TexDecoder_OpenCL_GetResult(u32 fence)
+{
+	sPendingDecode* decode = FindPendingDecode(fence);
+	if (!decode)
+		return nullptr;
+
+	// clWaitForEvents implicitly flushes the queue.
+	cl_int err = clWaitForEvents(1, &decode->event);
+	if (err != CL_SUCCESS)
+	{
+		OpenCL::HandleCLError(err, "clWaitForEvents");
+		return nullptr;
+	}
+	return g_pinned_dst_ptr + decode->dst_offset;
+}
+
+void TexDecoder_OpenCL_ReleaseResults()
+{
+	if (g_pending_decodes.empty())
+		return;
+
+	// Nobody asked for the remaining results, but their transfers may still be running.
+	clFinish(OpenCL::GetCommandQueue());
+	for (sPendingDecode& decode : g_pending_decodes)
+		clReleaseEvent(decode.event);
+	g_pending_decodes.clear();
+	g_batch_src_used = 0;
+	g_batch_dst_used = 0;
 }
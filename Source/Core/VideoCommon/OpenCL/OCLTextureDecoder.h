@@ -8,4 +8,16 @@
 
 void TexDecoder_OpenCL_Initialize();
 void TexDecoder_OpenCL_Shutdown();
-PC_TexFormat TexDecoder_Decode_OpenCL(u8 *dst, const u8 *src, int width, int height, int texformat, int tlutaddr, TlutFormat tlutfmt, bool rgba);
+bool TexDecoder_OpenCL_IsInitialized();
+
+// Decoding is asynchronous: QueueDecode stages the texture in pinned memory and records the
+// upload, kernel and readback without waiting, Flush submits everything queued so far.
+// The returned fence is nonzero on success, use GetResult to fetch the decoded texels.
+// Results stay valid until ReleaseResults is called, which also recycles the staging memory.
+PC_TexFormat TexDecoder_OpenCL_GetFormat(u32 texformat, bool rgba);
+u32 TexDecoder_OpenCL_QueueDecode(const u8 *src, u32 width, u32 height, u32 texformat, bool rgba);
+void TexDecoder_OpenCL_Flush();
+bool TexDecoder_OpenCL_FencePassed(u32 fence);
+// Waits for the fence if it has not passed yet.
+const u8* TexDecoder_OpenCL_GetResult(u32 fence);
+void TexDecoder_OpenCL_ReleaseResults();
@@ -12,3 +12,17 @@ bool PerfQueryBase::ShouldEmulate()
 {
 	return g_ActiveConfig.bPerfQueriesEnable;
 }
+
+bool PerfQueryBase::ShouldCollectResults(u32 buffer_size) const
+{
+	// Asynchronous reads only see the collected results, so don't let them pile up
+	if (g_ActiveConfig.bPerfQueriesAsync)
+		return m_query_count > 0;
+	return m_query_count > GetMaxQueriesInFlight(buffer_size) / 2;
+}
+
+u32 PerfQueryBase::GetMaxQueriesInFlight(u32 buffer_size)
+{
+	const u32 limit = static_cast<u32>(g_ActiveConfig.iPerfQueriesInFlight);
+	return (limit > 0 && limit < buffer_size) ? limit : buffer_size;
+}
@@ -72,6 +72,12 @@ public:
 	}
 
 protected:
+	// True if the finished queries should be collected before starting a new one
+	bool ShouldCollectResults(u32 buffer_size) const;
+
+	// Number of queries allowed in flight before the oldest one is waited for
+	static u32 GetMaxQueriesInFlight(u32 buffer_size);
+
 	// TODO: sloppy
 	volatile u32 m_query_count;
 	volatile u32 m_results[PQG_NUM_MEMBERS];
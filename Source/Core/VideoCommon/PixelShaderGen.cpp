@@ -19,6 +19,7 @@
 #include "VideoCommon/BoundingBox.h"
 #include "VideoCommon/DriverDetails.h"
 #include "VideoCommon/PixelShaderGen.h"
+#include "VideoCommon/Statistics.h"
 #include "VideoCommon/VertexShaderGen.h"
 #include "VideoCommon/XFMemory.h"  // for texture projection mode
 #include "VideoCommon/VideoConfig.h"
@@ -458,6 +459,39 @@ float snoise(float2 v)
 }
 )hlsl";
 
+static UidCollapseCounter s_uid_collapse_counter(stats.numPixelShaderUidsCollapsed);
+
+void pixel_shader_uid_data::ClearUnused()
+{
+	texMtxInfo_n_projection = 0;
+	// Dithering only applies to the 6 bit formats
+	if (!rgba6_format)
+		dither = 0;
+	for (u32 n = 0; n <= genMode_numtevstages; ++n)
+	{
+		auto& stage = stagehash[n];
+		// The coordinate only feeds the texture lookup and the indirect op
+		if (!stage.tevorders_enable && !stage.hasindstage)
+			stage.tevorders_texcoord = 0;
+		if (!stage.hasindstage)
+			continue;
+		TevStageIndirect tevind;
+		tevind.hex = stage.tevind;
+		tevind.lb_utclod = 0;
+		// The bias and format only apply to the matrix offset and the bump alpha
+		if (tevind.mid == 0)
+		{
+			tevind.bias = 0;
+			if (tevind.bs == ITBA_OFF)
+			{
+				tevind.fmt = 0;
+				tevind.bt = 0;
+			}
+		}
+		stage.tevind = tevind.hex;
+	}
+}
+
 // FIXME: Some of the video card's capabilities (BBox support, EarlyZ support, dstAlpha support) leak
 //        into this UID; This is really unhelpful if these UIDs ever move from one machine to another.
 void GetPixelShaderUID(PixelShaderUid& out, PIXEL_SHADER_RENDER_MODE render_mode, u32 components, const XFMemory &xfr, const BPMemory &bpm)
@@ -487,7 +521,7 @@ void GetPixelShaderUID(PixelShaderUid& out, PIXEL_SHADER_RENDER_MODE render_mode
 	uid_data.zfreeze = bpm.genMode.zfreeze;
 	if (render_mode == PSRM_DEPTH_ONLY)
 	{
-		out.CalculateUIDHash();
+		s_uid_collapse_counter.CalculateUIDHash(out);
 		return;
 	}
 	uid_data.stereo = g_ActiveConfig.iStereoMode > 0;
@@ -645,7 +679,7 @@ void GetPixelShaderUID(PixelShaderUid& out, PIXEL_SHADER_RENDER_MODE render_mode
 		uid_data.fog_RangeBaseEnabled = bpm.fogRange.Base.Enabled;
 	}
 
-	out.CalculateUIDHash();
+	s_uid_collapse_counter.CalculateUIDHash(out);
 }
 
 static char text[PIXELSHADERGEN_BUFFERSIZE];
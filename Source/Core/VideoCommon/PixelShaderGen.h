@@ -98,10 +98,7 @@ struct pixel_shader_uid_data
 		return pixel_lighting ? 0 : sizeof(LightingUidData);
 	}
 
-	void ClearUnused()
-	{
-		texMtxInfo_n_projection = 0;
-	}
+	void ClearUnused();
 
 	// TODO: Optimize field order for easy access!
 	LightingUidData lighting;
@@ -84,6 +84,11 @@ const regionvector &PixelShaderManager::GetDirtyRegions()
 	return m_buffer.GetRegions();
 }
 
+bool PixelShaderManager::UpdateUploadedConstants(float* uploaded)
+{
+	return m_buffer.UpdateCopy(uploaded);
+}
+
 void PixelShaderManager::EnableDirtyRegions()
 {
 	m_buffer.EnableDirtyRegions();
@@ -550,7 +555,7 @@ void PixelShaderManager::InvalidateXFRange(u32 start, u32 end)
 {
 	if (start < XFMEM_LIGHTS_END && end > XFMEM_LIGHTS)
 	{
-		int _start = start < XFMEM_LIGHTS ? XFMEM_LIGHTS : start - XFMEM_LIGHTS;
+		int _start = start < XFMEM_LIGHTS ? 0 : start - XFMEM_LIGHTS;
 		int _end = end < XFMEM_LIGHTS_END ? end - XFMEM_LIGHTS : XFMEM_LIGHTS_END - XFMEM_LIGHTS;
 
 		if (nLightsChanged[0] == -1)
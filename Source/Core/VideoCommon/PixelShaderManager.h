@@ -29,6 +29,9 @@ public:
 	static void EnableDirtyRegions();
 	static void DisableDirtyRegions();
 	static const regionvector &GetDirtyRegions();
+	// Copies the dirty constants to uploaded, which holds the values of the last upload.
+	// Returns false if they were already there, so the last upload can be used again.
+	static bool UpdateUploadedConstants(float* uploaded);
 	static void SetConstants(); // sets pixel shader constants
 
 	// constant management, should be called after memory is committed
@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 
+#include <algorithm>
 #include <cmath>
 #include <string>
 
@@ -12,7 +13,9 @@
 #include "Common/CommonPaths.h"
 #include "Common/FileSearch.h"
 #include "Common/FileUtil.h"
+#include "Common/Hash.h"
 #include "Common/IniFile.h"
+#include "Common/LinearDiskCache.h"
 #include "Common/StringUtil.h"
 
 #include "Core/ConfigManager.h"
@@ -531,6 +534,18 @@ bool PostProcessingShaderConfiguration::ParsePassBlock(const std::string& dirnam
 		{
 			pass.entry_point = value;
 		}
+		else if (key == "ComputeEntryPoint")
+		{
+			pass.compute_entry_point = value;
+		}
+		else if (key == "ComputeGroupSize")
+		{
+			std::vector<u32> sizes;
+			if (!TryParseVector(value, &sizes) || sizes.size() != 2 || sizes[0] == 0 || sizes[1] == 0)
+				return false;
+			pass.compute_group_size[0] = sizes[0];
+			pass.compute_group_size[1] = sizes[1];
+		}
 		else if (key == "OutputScale")
 		{
 			TryParse(value, &pass.output_scale);
@@ -963,10 +978,6 @@ PostProcessingShader::~PostProcessingShader()
 				delete input.texture;
 			}
 		}
-		if (pass.output_texture)
-		{
-			delete pass.output_texture;
-		}
 	}
 }
 
@@ -992,11 +1003,59 @@ bool PostProcessingShader::Initialize(PostProcessingShaderConfiguration* config,
 	// Set size to zero, that way it'll always be reconfigured on first use
 	m_internal_size.Set(0, 0);
 	m_ready = RecompileShaders();
+
+	// Binaries found in the cache need no compile
+	if (m_ready)
+		IsCompiling();
 	return m_ready;
 }
 
+bool PostProcessingShader::IsCompiling()
+{
+	if (!m_pass_compilation)
+		return false;
+
+	PollPassCompilation();
+	if (m_pass_compilation->remaining != 0)
+		return true;
+
+	std::shared_ptr<PassCompilation> compilation = std::move(m_pass_compilation);
+	if (compilation->failed)
+	{
+		ERROR_LOG(VIDEO, "Failed to compile post-processing shader %s", m_config->GetShaderName().c_str());
+		m_ready = false;
+		return false;
+	}
+
+	for (size_t i = 0; i < m_passes.size(); i++)
+	{
+		RenderPassData& pass = m_passes[i];
+		ReleasePassNativeResources(pass);
+		if (!CreatePassShader(pass, compilation->binaries[i]))
+		{
+			ReleasePassNativeResources(pass);
+			ERROR_LOG(VIDEO, "Failed to create post-processing shader %s (pass %s)", m_config->GetShaderName().c_str(), m_config->GetPass(i).entry_point.c_str());
+			m_ready = false;
+			return false;
+		}
+	}
+
+	return false;
+}
+
+std::shared_ptr<PostProcessingShader::PassCompilation> PostProcessingShader::BeginPassCompilation()
+{
+	m_pass_compilation = std::make_shared<PassCompilation>();
+	m_pass_compilation->binaries.resize(m_passes.size());
+	return m_pass_compilation;
+}
+
 bool PostProcessingShader::Reconfigure(const TargetSize& new_size)
 {
+	// Take the shaders of a finished recompile
+	if (!IsCompiling() && !m_ready)
+		return false;
+
 	m_ready = true;
 
 	const bool size_changed = (m_internal_size != new_size);
@@ -1007,9 +1066,14 @@ bool PostProcessingShader::Reconfigure(const TargetSize& new_size)
 	if (m_ready && (m_config->IsDirty() || size_changed))
 		LinkPassOutputs();
 
-	// Recompile shaders if compile-time constants have changed
+	// Recompile shaders if compile-time constants have changed, the current ones are used until
+	// the recompile is done
 	if (m_ready && m_config->IsCompileTimeConstantsDirty())
+	{
 		m_ready = RecompileShaders();
+		if (m_ready)
+			IsCompiling();
+	}
 
 	return m_ready;
 }
@@ -1023,6 +1087,13 @@ bool PostProcessingShader::CreatePasses()
 		pass.output_texture = nullptr;
 		pass.output_scale = pass_config.output_scale;
 		pass.enabled = true;
+		pass.compute = !pass_config.compute_entry_point.empty() &&
+			g_ActiveConfig.backend_info.bSupportsPostProcessingCompute;
+		if (!pass.compute && !pass_config.compute_entry_point.empty() && pass_config.entry_point.empty())
+		{
+			ERROR_LOG(VIDEO, "Post-processing shader %s (pass %s) needs compute shaders, which the backend does not support", m_config->GetShaderName().c_str(), pass_config.compute_entry_point.c_str());
+			return false;
+		}
 		pass.inputs.reserve(pass_config.inputs.size());
 
 		for (const PostProcessingShaderConfiguration::RenderPass::Input& input_config : pass_config.inputs)
@@ -1070,6 +1141,11 @@ void PostProcessingShader::LinkPassOutputs()
 	m_last_pass_index = 0;
 	m_last_pass_uses_color_buffer = false;
 
+	// Index of the last pass reading each pass output, and the bindings to point at the outputs
+	// once the textures are assigned.
+	std::vector<size_t> last_reader(m_passes.size(), 0);
+	std::vector<std::pair<InputBinding*, size_t>> output_bindings;
+
 	// Update dependant options (enable/disable passes)
 	for (size_t pass_index = 0; pass_index < m_passes.size(); pass_index++)
 	{
@@ -1110,8 +1186,10 @@ void PostProcessingShader::LinkPassOutputs()
 				}
 				else
 				{
-					input_binding.prev_texture = m_passes[pass_output_index].output_texture;
+					input_binding.prev_texture = nullptr;
 					input_binding.size = m_passes[pass_output_index].output_size;
+					last_reader[pass_output_index] = pass_index;
+					output_bindings.emplace_back(&input_binding, static_cast<size_t>(pass_output_index));
 				}
 			}
 			break;
@@ -1124,6 +1202,79 @@ void PostProcessingShader::LinkPassOutputs()
 			}
 		}
 	}
+
+	AssignOutputTextures(last_reader);
+	for (const auto& binding : output_bindings)
+		binding.first->prev_texture = m_passes[binding.second].output_texture;
+}
+
+void PostProcessingShader::AssignOutputTextures(const std::vector<size_t>& last_reader)
+{
+	// Walk the passes in draw order, an output is dead once every pass reading it has been drawn,
+	// so its texture can be rendered to by a later pass of the same size. The last pass output
+	// is read after the chain and is never shared.
+	std::vector<std::unique_ptr<TextureCacheBase::TCacheEntryBase>> old_textures =
+		std::move(m_output_textures);
+	m_output_textures.clear();
+	std::vector<TextureCacheBase::TCacheEntryBase*> free_textures;
+	std::vector<size_t> live_passes;
+
+	auto size_matches = [](const TextureCacheBase::TCacheEntryBase* texture, const TargetSize& size) {
+		return texture->config.width == static_cast<u32>(size.width) &&
+			texture->config.height == static_cast<u32>(size.height);
+	};
+
+	TextureCacheBase::TCacheEntryConfig config;
+	config.rendertarget = true;
+	config.layers = m_internal_layers;
+	config.pcformat = PC_TexFormat::PC_TEX_FMT_RGBA32;
+	for (size_t pass_index = 0; pass_index < m_passes.size(); pass_index++)
+	{
+		RenderPassData& pass = m_passes[pass_index];
+		pass.output_texture = nullptr;
+		if (!pass.enabled && pass_index != m_last_pass_index)
+			continue;
+
+		for (auto it = live_passes.begin(); it != live_passes.end();)
+		{
+			if (*it != m_last_pass_index && last_reader[*it] < pass_index)
+			{
+				free_textures.push_back(m_passes[*it].output_texture);
+				it = live_passes.erase(it);
+			}
+			else
+			{
+				++it;
+			}
+		}
+		live_passes.push_back(pass_index);
+
+		auto free_it = std::find_if(free_textures.begin(), free_textures.end(),
+			[&](const TextureCacheBase::TCacheEntryBase* texture) { return size_matches(texture, pass.output_size); });
+		if (free_it != free_textures.end())
+		{
+			pass.output_texture = *free_it;
+			free_textures.erase(free_it);
+			continue;
+		}
+
+		// Keep the textures of the previous link where possible, relinking happens on option changes.
+		auto old_it = std::find_if(old_textures.begin(), old_textures.end(),
+			[&](const std::unique_ptr<TextureCacheBase::TCacheEntryBase>& texture) {
+			return texture && size_matches(texture.get(), pass.output_size);
+		});
+		if (old_it != old_textures.end())
+		{
+			m_output_textures.push_back(std::move(*old_it));
+		}
+		else
+		{
+			config.width = pass.output_size.width;
+			config.height = pass.output_size.height;
+			m_output_textures.emplace_back(g_texture_cache->CreateTexture(config));
+		}
+		pass.output_texture = m_output_textures.back().get();
+	}
 }
 
 bool PostProcessingShader::ResizeOutputTextures(const TargetSize& new_size)
@@ -1155,22 +1306,15 @@ bool PostProcessingShader::ResizeOutputTextures(const TargetSize& new_size)
 		if (i < static_cast<size_t>(frameoutput.depth_count))
 			m_prev_frame_texture[i].depth_frame.reset(g_texture_cache->CreateTexture(config));
 	}
-	config.pcformat = PC_TexFormat::PC_TEX_FMT_RGBA32;
+
+	// The pass outputs are created by LinkPassOutputs, which knows which passes are enabled.
+	m_output_textures.clear();
 	for (size_t pass_index = 0; pass_index < m_passes.size(); pass_index++)
 	{
 		RenderPassData& pass = m_passes[pass_index];
 		const PostProcessingShaderConfiguration::RenderPass& pass_config = m_config->GetPass(pass_index);
 		pass.output_size = PostProcessor::ScaleTargetSize(new_size, pass_config.output_scale);
-
-		if (pass.output_texture != nullptr)
-		{
-			delete pass.output_texture;
-			pass.output_texture = nullptr;
-		}
-
-		config.width = pass.output_size.width;
-		config.height = pass.output_size.height;
-		pass.output_texture = g_texture_cache->CreateTexture(config);
+		pass.output_texture = nullptr;
 	}
 	m_internal_size = new_size;
 	return true;
@@ -1201,6 +1345,34 @@ PostProcessor::~PostProcessor()
 	}
 }
 
+void PostProcessor::SwapShaderChain(ShaderChain& chain)
+{
+	std::swap(m_shader_names, chain.shader_names);
+	std::swap(m_shader_configs, chain.shader_configs);
+	std::swap(m_scaling_config, chain.scaling_config);
+	std::swap(m_stereo_config, chain.stereo_config);
+	std::swap(m_post_processing_shaders, chain.post_processing_shaders);
+	std::swap(m_scaling_shader, chain.scaling_shader);
+	std::swap(m_stereo_shader, chain.stereo_shader);
+	std::swap(m_active, chain.active);
+	std::swap(m_requires_depth_buffer, chain.requires_depth_buffer);
+}
+
+void PostProcessor::RemoveFailedShaders()
+{
+	// The scaling and stereo shaders fall back when they are reconfigured
+	size_t count = m_post_processing_shaders.size();
+	m_post_processing_shaders.erase(std::remove_if(m_post_processing_shaders.begin(), m_post_processing_shaders.end(),
+		[](const std::unique_ptr<PostProcessingShader>& shader) { return !shader->IsReady(); }),
+		m_post_processing_shaders.end());
+	if (m_post_processing_shaders.size() == count)
+		return;
+
+	OSD::AddMessage(StringFromFormat("Failed to compile %u postprocessing shaders. These shaders will be ignored.",
+		static_cast<u32>(count - m_post_processing_shaders.size())));
+	m_active = !m_post_processing_shaders.empty();
+}
+
 void PostProcessor::DisablePostProcessor()
 {
 	m_post_processing_shaders.clear();
@@ -1210,10 +1382,11 @@ void PostProcessor::DisablePostProcessor()
 void PostProcessor::ReloadShaders()
 {
 	m_reload_flag.Clear();
-	m_post_processing_shaders.clear();
-	m_scaling_shader.reset();
-	m_stereo_shader.reset();
-	m_active = false;
+
+	// Create the new shaders in place of the current ones, then put them aside while they compile
+	std::unique_ptr<ShaderChain> current = std::make_unique<ShaderChain>();
+	SwapShaderChain(*current);
+	m_pending_shader_chain.reset();
 
 	ReloadShaderConfigs();
 
@@ -1225,6 +1398,37 @@ void PostProcessor::ReloadShaders()
 	if (m_stereo_config)
 		CreateStereoShader();
 
+	m_pending_shader_chain = std::make_unique<ShaderChain>();
+	SwapShaderChain(*m_pending_shader_chain);
+	SwapShaderChain(*current);
+	if (PendingShadersReady())
+		ActivatePendingShaders();
+}
+
+bool PostProcessor::PendingShadersReady()
+{
+	if (!m_pending_shader_chain)
+		return false;
+
+	ShaderChain& chain = *m_pending_shader_chain;
+	bool compiling = false;
+	for (const auto& shader : chain.post_processing_shaders)
+		compiling |= shader->IsCompiling();
+	if (chain.scaling_shader)
+		compiling |= chain.scaling_shader->IsCompiling();
+	if (chain.stereo_shader)
+		compiling |= chain.stereo_shader->IsCompiling();
+
+	return !compiling;
+}
+
+void PostProcessor::ActivatePendingShaders()
+{
+	// Takes the current shaders, which are released on return
+	std::unique_ptr<ShaderChain> previous = std::move(m_pending_shader_chain);
+	SwapShaderChain(*previous);
+	RemoveFailedShaders();
+
 	// Set initial sizes to 0,0 to force texture creation on next draw
 	m_copy_size.Set(0, 0);
 	m_stereo_buffer_size.Set(0, 0);
@@ -1257,6 +1461,7 @@ bool PostProcessor::XFBDepthDataRequired() const
 
 void  PostProcessor::DoEFB(const TargetRectangle* src_rect)
 {
+	FramebufferManagerBase::MarkEFBChanged();
 	TargetSize target_size(g_renderer->GetTargetWidth(), g_renderer->GetTargetHeight());
 	TargetRectangle target_rect;
 	if (src_rect)
@@ -1441,6 +1646,59 @@ void PostProcessor::ReloadStereoShaderConfig()
 	}
 }
 
+static LinearDiskCache<u64, u8> s_shader_binary_cache;
+static std::unordered_map<u64, std::vector<u8>> s_shader_binaries;
+
+class ShaderBinaryCacheInserter : public LinearDiskCacheReader<u64, u8>
+{
+public:
+	void Read(const u64& key, const u8* value, u32 value_size) override
+	{
+		s_shader_binaries[key].assign(value, value + value_size);
+	}
+};
+
+void PostProcessor::OpenShaderBinaryCache(const std::string& filename)
+{
+	File::CreateFullPath(filename);
+	s_shader_binaries.clear();
+	ShaderBinaryCacheInserter inserter;
+	s_shader_binary_cache.OpenAndRead(filename, inserter);
+}
+
+void PostProcessor::CloseShaderBinaryCache()
+{
+	s_shader_binary_cache.Sync();
+	s_shader_binary_cache.Close();
+	s_shader_binaries.clear();
+}
+
+u64 PostProcessor::GetShaderBinaryKey(const std::string& source, const char* target, u32 flags)
+{
+	std::string keyed_source = StringFromFormat("%s:%08x:", target, flags) + source;
+	return GetXXHash64(reinterpret_cast<const u8*>(keyed_source.data()), static_cast<u32>(keyed_source.size()), 0);
+}
+
+bool PostProcessor::FindShaderBinary(u64 key, std::vector<u8>* binary)
+{
+	const auto& it = s_shader_binaries.find(key);
+	if (it == s_shader_binaries.end())
+		return false;
+
+	*binary = it->second;
+	return true;
+}
+
+void PostProcessor::StoreShaderBinary(u64 key, const u8* binary, u32 size)
+{
+	std::vector<u8>& stored = s_shader_binaries[key];
+	if (!stored.empty())
+		return;
+
+	stored.assign(binary, binary + size);
+	s_shader_binary_cache.Append(key, binary, size);
+}
+
 TargetSize PostProcessor::ScaleTargetSize(const TargetSize& orig_size, float scale)
 {
 	TargetSize size;
@@ -1883,12 +2141,28 @@ in float2 v_source_uv;
 in float2 v_target_uv;
 flat in float v_layer;
 out float4 ocol0;
+#define GetFragmentCoord() (gl_FragCoord.xy)
+)";
+
+const std::string PostProcessor::s_post_compute_header_ogl = R"(
+// Depth value is not inverted for GL
+#define DEPTH_VALUE(val) (val)
+// Shader inputs/outputs
+SAMPLER_BINDING(9) uniform sampler2DArray pp_inputs[4];
+layout(rgba8) uniform writeonly image2DArray pp_output;
+// Shadows of the fragment shader interface, set for each invocation in main
+float2 v_source_uv, v_target_uv, v_fragcoord;
+float v_layer;
+float4 ocol0;
+#define GetFragmentCoord() (v_fragcoord)
+)";
+
+const std::string PostProcessor::s_post_sampling_header_ogl = R"(
 // Input sampling wrappers. Has to be a macro because the array index must be a constant expression.
 #define SampleInput(index) (texture(pp_inputs[index], float3(v_source_uv, v_layer)))
 #define SampleInputLocation(index, location) (texture(pp_inputs[index], float3(location, v_layer)))
 #define SampleInputLayer(index, layer) (texture(pp_inputs[index], float3(v_source_uv, float(layer))))
 #define SampleInputLayerLocation(index, layer, location) (texture(pp_inputs[index], float3(location, float(layer))))
-#define GetFragmentCoord() (gl_FragCoord.xy)
 #define GetTargetCoordinates() (v_target_uv)
 #define GetCoordinates() (v_source_uv)
 #define GetLayer() (v_layer)
@@ -2335,12 +2609,30 @@ std::string PostProcessor::GetCommonFragmentShaderSource(API_TYPE api, const Pos
 	if (api == API_OPENGL)
 	{
 		shader_source += s_post_fragment_header_ogl;
+		shader_source += s_post_sampling_header_ogl;
 	}
 	else if (api == API_D3D11)
 	{
 		shader_source += StringFromFormat(s_post_fragment_header_d3d.c_str(), texture_register_start, texture_register_start);
 	}
+	AppendCommonShaderSource(api, config, shader_source);
+	return shader_source;
+}
+
+std::string PostProcessor::GetCommonComputeShaderSource(API_TYPE api, const PostProcessingShaderConfiguration* config)
+{
+	std::string shader_source;
+	if (api == API_OPENGL)
+	{
+		shader_source += s_post_compute_header_ogl;
+		shader_source += s_post_sampling_header_ogl;
+	}
+	AppendCommonShaderSource(api, config, shader_source);
+	return shader_source;
+}
 
+void PostProcessor::AppendCommonShaderSource(API_TYPE api, const PostProcessingShaderConfiguration* config, std::string& shader_source)
+{
 	// Add uniform buffer
 	GetUniformBufferShaderSource(api, config, shader_source);
 
@@ -2376,7 +2668,6 @@ std::string PostProcessor::GetCommonFragmentShaderSource(API_TYPE api, const Pos
 
 	// Remaining wrapper/interfacing functions
 	shader_source += s_post_fragment_header_common;
-	return shader_source;
 }
 
 std::string PostProcessor::GetPassFragmentShaderSource(
@@ -2428,6 +2719,40 @@ std::string PostProcessor::GetPassFragmentShaderSource(
 	return shader_source;
 }
 
+std::string PostProcessor::GetPassComputeShaderSource(
+	API_TYPE api,
+	const PostProcessingShaderConfiguration* config,
+	const PostProcessingShaderConfiguration::RenderPass* pass)
+{
+	std::string shader_source;
+	if (api != API_OPENGL)
+		return shader_source;
+
+	shader_source += config->GetShaderSource();
+	shader_source += '\n';
+
+	// One invocation per output pixel of the viewport, z selects the layer when all layers are
+	// drawn at once. Invocations outside the viewport still run the entry point, so it can use
+	// barriers around shared memory, but their output is discarded.
+	shader_source += StringFromFormat("layout(local_size_x = %u, local_size_y = %u) in;\n",
+		pass->compute_group_size[0], pass->compute_group_size[1]);
+	shader_source += "void main()\n"
+		"{\n"
+		"\tfloat2 origin = min(u_viewport_rect.xy, u_viewport_rect.zw);\n"
+		"\tfloat2 size = abs(u_viewport_rect.zw - u_viewport_rect.xy);\n"
+		"\tfloat2 pixel = float2(gl_GlobalInvocationID.xy) + 0.5;\n"
+		"\tv_fragcoord = origin + pixel;\n"
+		"\tv_target_uv = pixel / size;\n"
+		"\tv_source_uv = v_target_uv * u_source_rect.zw + u_source_rect.xy;\n"
+		"\tv_layer = u_src_layer + float(gl_GlobalInvocationID.z);\n"
+		"\tocol0 = float4(0.0, 0.0, 0.0, 0.0);\n";
+	shader_source += StringFromFormat("\t%s();\n", pass->compute_entry_point.c_str());
+	shader_source += "\tif (all(lessThan(pixel, size)))\n"
+		"\t\timageStore(pp_output, int3(int2(v_fragcoord), int(v_layer)), ocol0);\n"
+		"}\n";
+	return shader_source;
+}
+
 bool  PostProcessor::UpdateConstantUniformBuffer(
 	const InputTextureSizeArray& input_sizes,
 	const TargetRectangle& dst_rect, const TargetSize& dst_size,
@@ -119,6 +119,9 @@ public:
 		};
 		std::vector<Input> inputs;
 		std::string entry_point;
+		// Run as a compute dispatch when the backend supports it, entry_point is the fallback.
+		std::string compute_entry_point;
+		u32 compute_group_size[2] = { 8, 8 };
 		float output_scale;
 		std::vector<const ConfigurationOption*> dependent_options;
 
@@ -322,6 +325,10 @@ public:
 		return m_ready;
 	}
 
+	// Whether the pass shaders are still compiling in the background. The passes keep their previous
+	// shaders until then, the first call after the compile finished replaces them.
+	bool IsCompiling();
+
 	bool Initialize(PostProcessingShaderConfiguration* config, int target_layers);
 	bool Reconfigure(const TargetSize& new_size);
 	virtual void MapAndUpdateConfigurationBuffer() = 0;
@@ -351,20 +358,40 @@ protected:
 
 		std::vector<InputBinding> inputs;
 
+		// Owned by m_output_textures, passes whose outputs are not alive at the same time share one
 		TextureCacheBase::TCacheEntryBase* output_texture{};
 		TargetSize output_size{};
 		float output_scale{};
 
 		bool enabled{};
+		bool compute{};
 	};
 
 	virtual void ReleasePassNativeResources(RenderPassData& pass) = 0;
 
+	// Binaries of the pass shaders compiling in the background, filled by the compiler callbacks on
+	// the video thread. A newer compile replaces it, the callbacks of the older one keep it alive.
+	struct PassCompilation final
+	{
+		std::vector<std::vector<u8>> binaries;
+		size_t remaining = 0;
+		bool failed = false;
+	};
+
+	// Started by RecompileShaders of the backends compiling in the background
+	std::shared_ptr<PassCompilation> BeginPassCompilation();
+	// Runs the callbacks of the finished compiles
+	virtual void PollPassCompilation() {}
+	virtual bool CreatePassShader(RenderPassData& pass, const std::vector<u8>& binary)
+	{
+		return false;
+	}
 
 	bool CreatePasses();
 	virtual bool RecompileShaders() = 0;
 	bool ResizeOutputTextures(const TargetSize& new_size);
 	void LinkPassOutputs();
+	void AssignOutputTextures(const std::vector<size_t>& last_reader);
 
 	PostProcessingShaderConfiguration* m_config;
 	uintptr_t m_uniform_buffer;
@@ -373,9 +400,11 @@ protected:
 	int m_internal_layers = 0;
 
 	std::vector<RenderPassData> m_passes;
+	std::vector<std::unique_ptr<TextureCacheBase::TCacheEntryBase>> m_output_textures;
 	size_t m_last_pass_index = 0;
 	bool m_last_pass_uses_color_buffer = false;
 	bool m_ready = false;
+	std::shared_ptr<PassCompilation> m_pass_compilation;
 	bool m_prev_frame_enabled = false;
 	bool m_prev_depth_enabled = false;
 	struct past_frame_data
@@ -473,7 +502,11 @@ public:
 
 	// Should be implemented by the backends for backend specific code
 	virtual bool Initialize() = 0;
+	// The current shaders keep drawing until the reloaded ones are compiled
 	void ReloadShaders();
+	bool PendingShadersReady();
+	// Replaces the current shaders with the reloaded ones, the GPU must be done with the current ones
+	void ActivatePendingShaders();
 
 	void DoEFB(const TargetRectangle* src_rect);
 	// Used when post-processing on perspective->ortho switch.
@@ -503,6 +536,18 @@ public:
 	// Construct a complete fragment shader (HLSL/GLSL) for the specified pass.
 	static std::string GetPassFragmentShaderSource(API_TYPE api, const PostProcessingShaderConfiguration* config, const PostProcessingShaderConfiguration::RenderPass* pass);
 
+	// Compute pass counterparts of the above, only GLSL is supported.
+	// The pass output is bound as image unit 0.
+	static std::string GetCommonComputeShaderSource(API_TYPE api, const PostProcessingShaderConfiguration* config);
+	static std::string GetPassComputeShaderSource(API_TYPE api, const PostProcessingShaderConfiguration* config, const PostProcessingShaderConfiguration::RenderPass* pass);
+
+	// Compiled pass shaders, kept on disk by the hash of their source and compile options
+	static void OpenShaderBinaryCache(const std::string& filename);
+	static void CloseShaderBinaryCache();
+	static u64 GetShaderBinaryKey(const std::string& source, const char* target, u32 flags);
+	static bool FindShaderBinary(u64 key, std::vector<u8>* binary);
+	static void StoreShaderBinary(u64 key, const u8* binary, u32 size);
+
 	// Scale a target resolution to an output's scale
 	static TargetSize ScaleTargetSize(const TargetSize& orig_size, float scale);
 
@@ -510,6 +555,8 @@ public:
 	static TargetRectangle ScaleTargetRectangle(API_TYPE api, const TargetRectangle& src, float scale);
 
 protected:
+	static void AppendCommonShaderSource(API_TYPE api, const PostProcessingShaderConfiguration* config, std::string& shader_source);
+
 	virtual std::unique_ptr<PostProcessingShader> CreateShader(PostProcessingShaderConfiguration* config) = 0;
 	// NOTE: Can change current render target and viewport.
 	// If src_layer <0, copy all layers, otherwise, copy src_layer to layer 0.
@@ -552,6 +599,22 @@ protected:
 	void ReloadStereoShaderConfig();
 	void DisablePostProcessor();
 
+	// The shaders and configs ReloadShaders creates
+	struct ShaderChain
+	{
+		std::vector<std::string> shader_names;
+		std::unordered_map<std::string, std::unique_ptr<PostProcessingShaderConfiguration>> shader_configs;
+		std::unique_ptr<PostProcessingShaderConfiguration> scaling_config;
+		std::unique_ptr<PostProcessingShaderConfiguration> stereo_config;
+		std::vector<std::unique_ptr<PostProcessingShader>> post_processing_shaders;
+		std::unique_ptr<PostProcessingShader> scaling_shader;
+		std::unique_ptr<PostProcessingShader> stereo_shader;
+		bool active = false;
+		bool requires_depth_buffer = false;
+	};
+	void SwapShaderChain(ShaderChain& chain);
+	void RemoveFailedShaders();
+
 	// Timer for determining our time value
 	Common::Timer m_timer;
 
@@ -575,6 +638,9 @@ protected:
 	std::unique_ptr<PostProcessingShader> m_scaling_shader;
 	std::unique_ptr<PostProcessingShader> m_stereo_shader;
 
+	// Reloaded shaders still compiling
+	std::unique_ptr<ShaderChain> m_pending_shader_chain;
+
 	// buffers
 	TargetSize m_copy_size;
 	int m_copy_layers = 0;
@@ -597,6 +663,8 @@ protected:
 
 	// common shader code between backends
 	static const std::string s_post_fragment_header_ogl;
+	static const std::string s_post_compute_header_ogl;
+	static const std::string s_post_sampling_header_ogl;
 	static const std::string s_post_fragment_header_d3d;
 	static const std::string s_post_fragment_header_common;
 };
\ No newline at end of file
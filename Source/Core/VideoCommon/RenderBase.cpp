@@ -14,6 +14,7 @@
 
 #include <cinttypes>
 #include <cmath>
+#include <cstring>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -36,18 +37,26 @@
 #include "Core/HW/VideoInterface.h"
 
 #include "VideoCommon/AVIDump.h"
+#include "VideoCommon/BoundingBox.h"
 #include "VideoCommon/BPMemory.h"
 #include "VideoCommon/CommandProcessor.h"
 #include "VideoCommon/CPMemory.h"
 #include "VideoCommon/Debugger.h"
+#include "VideoCommon/DLCache.h"
+#include "VideoCommon/DynamicResolution.h"
+#include "VideoCommon/Fifo.h"
 #include "VideoCommon/FPSCounter.h"
 #include "VideoCommon/FramebufferManagerBase.h"
+#include "VideoCommon/FrameTelemetry.h"
 #include "VideoCommon/GeometryShaderManager.h"
+#include "VideoCommon/GPUProfilerBase.h"
 #include "VideoCommon/ImageWrite.h"
 #include "VideoCommon/OnScreenDisplay.h"
 #include "VideoCommon/PixelShaderManager.h"
 #include "VideoCommon/PostProcessing.h"
 #include "VideoCommon/RenderBase.h"
+#include "VideoCommon/ScratchMemory.h"
+#include "VideoCommon/ShaderPrecompiler.h"
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/TextureCacheBase.h"
 #include "VideoCommon/VideoConfig.h"
@@ -59,6 +68,9 @@ int frameCount;
 int OSDChoice;
 static int OSDTime;
 
+// Turbo movie playback presents one frame out of this many
+static const int TURBO_PRESENT_INTERVAL = 60;
+
 std::unique_ptr<Renderer> g_renderer;
 
 std::mutex Renderer::s_criticalScreenshot;
@@ -114,6 +126,7 @@ Renderer::Renderer()
 	TextureCacheBase::OnConfigChanged(g_ActiveConfig);
 	OSDChoice = 0;
 	OSDTime = 0;
+	FrameTelemetry::Reset();
 }
 
 Renderer::~Renderer()
@@ -124,8 +137,6 @@ Renderer::~Renderer()
 	efb_scale_numeratorX = efb_scale_numeratorY = efb_scale_denominatorX = efb_scale_denominatorY = 1;
 	
 	ShutdownFrameDumping();
-	if (m_frame_dump_thread.joinable())
-		m_frame_dump_thread.join();
 }
 
 void Renderer::RenderToXFB(u32 xfbAddr, const EFBRectangle& sourceRc, u32 fbStride, u32 fbHeight, float Gamma)
@@ -139,6 +150,7 @@ void Renderer::RenderToXFB(u32 xfbAddr, const EFBRectangle& sourceRc, u32 fbStri
 
 	if (g_ActiveConfig.bUseXFB)
 	{
+		SetGPUPass(GPU_PASS_XFB);
 		FramebufferManagerBase::CopyToXFB(xfbAddr, fbStride, fbHeight, sourceRc, Gamma);
 	}
 	else
@@ -336,6 +348,12 @@ void Renderer::DrawDebugText()
 		final_yellow += "\n";
 	}
 
+	if (g_ActiveConfig.bGPUProfiling && g_gpu_profiler)
+	{
+		final_cyan += g_gpu_profiler->ToString() + "\n";
+		final_yellow += "\n";
+	}
+
 	if (SConfig::GetInstance().m_ShowLag)
 	{
 		final_cyan += StringFromFormat("Lag: %" PRIu64 "\n", Movie::GetCurrentLagCount());
@@ -646,19 +664,43 @@ void Renderer::RecordVideoMemory()
 
 void Renderer::Swap(u32 xfbAddr, u32 fbWidth, u32 fbStride, u32 fbHeight, const EFBRectangle& rc, u64 ticks, float Gamma)
 {
-	// TODO: merge more generic parts into VideoCommon
-	g_renderer->SwapImpl(xfbAddr, fbWidth, fbStride, fbHeight, rc, ticks, Gamma);
+	Fifo::UpdateGpuThreadStats();
+
+	// Skipped frames still do their EFB copies, only the presentation is left out
+	if (!Movie::IsTurboPlayback() || frameCount % TURBO_PRESENT_INTERVAL == 0)
+	{
+		// TODO: merge more generic parts into VideoCommon
+		g_renderer->SwapImpl(xfbAddr, fbWidth, fbStride, fbHeight, rc, ticks, Gamma);
+	}
+
+	ShaderPrecompiler::OnFrame();
+
+	// One readback per frame, after the frame was submitted, instead of one GPU sync per read
+	if (g_ActiveConfig.bBBoxAsyncReadback && g_ActiveConfig.iBBoxMode != BBoxNone)
+	{
+		const bool gpu_bbox = g_ActiveConfig.backend_info.bSupportsBBox &&
+			g_ActiveConfig.iBBoxMode == BBoxGPU;
+		for (int i = 0; i < 4; i++)
+			BoundingBox::readback_coords[i] = gpu_bbox ? g_renderer->BBoxRead(i) : BoundingBox::coords[i];
+	}
 
 	if (XFBWrited)
+	{
 		g_renderer->m_fps_counter.Update();
+		FrameTelemetry::OnPresent();
+		DynamicResolution::OnPresent();
+	}
 
 	frameCount++;
 	GFX_DEBUGGER_PAUSE_AT(NEXT_FRAME, true);
 
+	DLCache::ProgressiveCleanup();
+
 	// Begin new frame
 	// Set default viewport and scissor, for the clear to work correctly
 	// New frame
 	stats.ResetFrame();
+	ScratchMemory::EndFrame();
 
 	Core::Callback_VideoCopiedToXFB(XFBWrited || (g_ActiveConfig.bUseXFB && g_ActiveConfig.bUseRealXFB));
 	XFBWrited = false;
@@ -680,39 +722,56 @@ bool Renderer::IsFrameDumping()
 
 void Renderer::ShutdownFrameDumping()
 {
-	if (!m_frame_dump_thread_running.IsSet())
+	if (!m_frame_dump_thread.joinable())
 		return;
 
-	FinishFrameData();
-	m_frame_dump_thread_running.Clear();
-	m_frame_dump_start.Set();
+	// The thread writes the remaining frames before it exits
+	{
+		std::lock_guard<std::mutex> lk(m_frame_dump_mutex);
+		m_frame_dump_thread_running = false;
+	}
+	m_frame_dump_cv.notify_all();
+	m_frame_dump_thread.join();
 }
 
 void Renderer::DumpFrameData(const u8* data, int w, int h, int stride, const AVIDump::Frame& state, bool swap_upside_down, bool bgra)
 {
-	FinishFrameData();
-
-	m_frame_dump_config = FrameDumpConfig{ data, w, h, stride, swap_upside_down, bgra, state };
-
-	if (!m_frame_dump_thread_running.IsSet())
+	if (!m_frame_dump_thread.joinable())
 	{
-		if (m_frame_dump_thread.joinable())
-			m_frame_dump_thread.join();
-		m_frame_dump_thread_running.Set();
+		m_frame_dump_thread_running = true;
 		m_frame_dump_thread = std::thread(&Renderer::RunFrameDumps, this);
 	}
 
-	m_frame_dump_start.Set();
-	m_frame_dump_frame_running = true;
+	std::unique_lock<std::mutex> lk(m_frame_dump_mutex);
+	m_frame_dump_cv.wait(lk, [this] { return m_frame_dump_count < FRAME_DUMP_QUEUE_SIZE; });
+	FrameDumpData& frame = m_frame_dump_queue[(m_frame_dump_read_pos + m_frame_dump_count) % FRAME_DUMP_QUEUE_SIZE];
+	lk.unlock();
+
+	// The slot isn't touched by the frame dumping thread until it is queued
+	const size_t row_size = static_cast<size_t>(w) * 4;
+	frame.data.resize(row_size * h);
+	for (int y = 0; y < h; y++)
+	{
+		const u8* src = data + static_cast<ptrdiff_t>(swap_upside_down ? h - 1 - y : y) * stride;
+		memcpy(frame.data.data() + row_size * y, src, row_size);
+	}
+	frame.width = w;
+	frame.height = h;
+	frame.stride = static_cast<int>(row_size);
+	frame.bgra = bgra;
+	frame.screenshot = s_screenshot.TestAndClear();
+	frame.state = state;
+
+	lk.lock();
+	m_frame_dump_count++;
+	lk.unlock();
+	m_frame_dump_cv.notify_all();
 }
 
 void Renderer::FinishFrameData()
 {
-	if (!m_frame_dump_frame_running)
-		return;
-
-	m_frame_dump_done.Wait();
-	m_frame_dump_frame_running = false;
+	std::unique_lock<std::mutex> lk(m_frame_dump_mutex);
+	m_frame_dump_cv.wait(lk, [this] { return m_frame_dump_count == 0; });
 }
 
 void Renderer::RunFrameDumps()
@@ -722,24 +781,20 @@ void Renderer::RunFrameDumps()
 
 	while (true)
 	{
-		m_frame_dump_start.Wait();
-		if (!m_frame_dump_thread_running.IsSet())
+		std::unique_lock<std::mutex> lk(m_frame_dump_mutex);
+		m_frame_dump_cv.wait(lk, [this] { return m_frame_dump_count > 0 || !m_frame_dump_thread_running; });
+		if (m_frame_dump_count == 0)
 			break;
-
-		auto config = m_frame_dump_config;
-		if (config.upside_down)
-		{
-			config.data = config.data + (config.height - 1) * config.stride;
-			config.stride = -config.stride;
-		}
+		const FrameDumpData& frame = m_frame_dump_queue[m_frame_dump_read_pos];
+		lk.unlock();
 
 		// Save screenshot
-		if (s_screenshot.TestAndClear())
+		if (frame.screenshot)
 		{
-			std::lock_guard<std::mutex> lk(s_criticalScreenshot);
+			std::lock_guard<std::mutex> screenshot_lk(s_criticalScreenshot);
 
-			if (TextureToPng(config.data, config.stride, s_sScreenshotName, config.width, config.height,
-				false, config.bgra))
+			if (TextureToPng(frame.data.data(), frame.stride, s_sScreenshotName, frame.width, frame.height,
+				false, frame.bgra))
 				OSD::AddMessage("Screenshot saved to " + s_sScreenshotName);
 
 			// Reset settings
@@ -752,7 +807,7 @@ void Renderer::RunFrameDumps()
 		{
 			if (!avi_dump_started)
 			{
-				if (AVIDump::Start(config.width, config.height, config.bgra))
+				if (AVIDump::Start(frame.width, frame.height, frame.bgra))
 				{
 					avi_dump_started = true;
 				}
@@ -762,11 +817,16 @@ void Renderer::RunFrameDumps()
 				}
 			}
 
-			AVIDump::AddFrame(config.data, config.width, config.height, config.stride, config.state);
+			if (avi_dump_started)
+				AVIDump::AddFrame(frame.data.data(), frame.width, frame.height, frame.stride, frame.state);
 		}
 #endif
 
-		m_frame_dump_done.Set();
+		lk.lock();
+		m_frame_dump_read_pos = (m_frame_dump_read_pos + 1) % FRAME_DUMP_QUEUE_SIZE;
+		m_frame_dump_count--;
+		lk.unlock();
+		m_frame_dump_cv.notify_all();
 	}
 
 #if defined(HAVE_LIBAV) || defined(_WIN32)
@@ -13,6 +13,7 @@
 // ---------------------------------------------------------------------------------------------
 
 #pragma once
+#include <array>
 #include <condition_variable>
 #include <memory>
 #include <mutex>
@@ -201,7 +202,10 @@ protected:
 	static void RecordVideoMemory();
 
 	bool IsFrameDumping();
+	// Copies the frame into the frame dump queue, data can be released when this returns.
+	// Only waits when the frame dumping thread is FRAME_DUMP_QUEUE_SIZE frames behind.
 	void DumpFrameData(const u8* data, int w, int h, int stride, const AVIDump::Frame& state, bool swap_upside_down = false, bool bgra = false);
+	// Waits until all queued frames have been written
 	void FinishFrameData();
 
 	static Common::Flag s_screenshot;
@@ -243,21 +247,25 @@ private:
 	static unsigned int ssaa_multiplier;
 
 	// frame dumping
-	std::thread m_frame_dump_thread;
-	Common::Event m_frame_dump_start;
-	Common::Event m_frame_dump_done;
-	Common::Flag m_frame_dump_thread_running;
-	bool m_frame_dump_frame_running = false;
-	struct FrameDumpConfig
+	static constexpr size_t FRAME_DUMP_QUEUE_SIZE = 3;
+	struct FrameDumpData
 	{
-		const u8* data;
+		std::vector<u8> data;
 		int width;
 		int height;
 		int stride;
-		bool upside_down;
 		bool bgra;
+		bool screenshot;
 		AVIDump::Frame state;
-	} m_frame_dump_config;
+	};
+	std::thread m_frame_dump_thread;
+	// Guards the queue and m_frame_dump_thread_running
+	std::mutex m_frame_dump_mutex;
+	std::condition_variable m_frame_dump_cv;
+	bool m_frame_dump_thread_running = false;
+	std::array<FrameDumpData, FRAME_DUMP_QUEUE_SIZE> m_frame_dump_queue;
+	size_t m_frame_dump_read_pos = 0;
+	size_t m_frame_dump_count = 0;
 };
 
 extern std::unique_ptr<Renderer> g_renderer;
\ No newline at end of file
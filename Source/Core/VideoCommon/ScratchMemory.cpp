@@ -0,0 +1,235 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <mutex>
+#include <vector>
+
+#include "Common/Assert.h"
+#include "Common/MemoryUtil.h"
+#include "Common/StringUtil.h"
+#include "VideoCommon/ScratchMemory.h"
+
+namespace ScratchMemory
+{
+// Arena chunks start at this size, the merged chunk is rounded up to it
+static constexpr size_t ARENA_CHUNK_SIZE = 1024 * 1024;
+// Pool size classes are powers of two from 4 KB to 64 MB, larger buffers aren't pooled
+static constexpr u32 MIN_CLASS_SHIFT = 12;
+static constexpr u32 MAX_CLASS_SHIFT = 26;
+static constexpr size_t CLASS_COUNT = MAX_CLASS_SHIFT - MIN_CLASS_SHIFT + 1;
+static constexpr size_t BUFFER_ALIGNMENT = 64;
+
+struct Chunk
+{
+	u8* base;
+	size_t size;
+	size_t used;
+};
+
+// The arena is only used by the video thread
+static std::vector<Chunk> s_chunks;
+static size_t s_current_chunk = 0;
+static size_t s_frame_peak = 0;
+static size_t s_max_frame_peak = 0;
+
+static std::mutex s_pool_lock;
+static std::array<std::vector<u8*>, CLASS_COUNT> s_free_buffers;
+static size_t s_pool_in_use = 0;
+static size_t s_pool_peak = 0;
+static size_t s_pool_capacity = 0;
+static u32 s_system_allocations = 0;
+
+static u8* AllocateSystem(size_t size)
+{
+	std::lock_guard<std::mutex> lk(s_pool_lock);
+	s_system_allocations++;
+	return static_cast<u8*>(Common::AllocateAlignedMemory(size, BUFFER_ALIGNMENT));
+}
+
+static void AddChunk(size_t size)
+{
+	s_chunks.push_back({ AllocateSystem(size), size, 0 });
+}
+
+static size_t ArenaUsed()
+{
+	size_t used = 0;
+	for (const Chunk& chunk : s_chunks)
+		used += chunk.used;
+	return used;
+}
+
+void* AllocateFrame(size_t size, size_t alignment)
+{
+	_assert_(alignment <= BUFFER_ALIGNMENT && (alignment & (alignment - 1)) == 0);
+	size = std::max<size_t>(size, 1);
+	while (s_current_chunk < s_chunks.size())
+	{
+		Chunk& chunk = s_chunks[s_current_chunk];
+		const size_t offset = (chunk.used + alignment - 1) & ~(alignment - 1);
+		if (offset + size <= chunk.size)
+		{
+			chunk.used = offset + size;
+			return chunk.base + offset;
+		}
+		s_current_chunk++;
+	}
+	// Out of space, the chunks are merged at the end of the frame
+	const size_t last_size = s_chunks.empty() ? 0 : s_chunks.back().size;
+	AddChunk(std::max({ ARENA_CHUNK_SIZE, last_size * 2, size }));
+	s_current_chunk = s_chunks.size() - 1;
+	Chunk& chunk = s_chunks.back();
+	chunk.used = size;
+	return chunk.base;
+}
+
+void EndFrame()
+{
+	s_frame_peak = ArenaUsed();
+	s_max_frame_peak = std::max(s_max_frame_peak, s_frame_peak);
+	if (s_chunks.size() > 1)
+	{
+		size_t total = 0;
+		for (const Chunk& chunk : s_chunks)
+		{
+			total += chunk.size;
+			Common::FreeAlignedMemory(chunk.base);
+		}
+		s_chunks.clear();
+		AddChunk((total + ARENA_CHUNK_SIZE - 1) & ~(ARENA_CHUNK_SIZE - 1));
+	}
+	for (Chunk& chunk : s_chunks)
+		chunk.used = 0;
+	s_current_chunk = 0;
+}
+
+static int SizeClass(size_t size)
+{
+	u32 shift = MIN_CLASS_SHIFT;
+	while ((static_cast<size_t>(1) << shift) < size)
+	{
+		if (++shift > MAX_CLASS_SHIFT)
+			return -1;
+	}
+	return static_cast<int>(shift - MIN_CLASS_SHIFT);
+}
+
+Buffer Acquire(size_t size)
+{
+	const int size_class = SizeClass(size);
+	const size_t capacity = size_class < 0 ? size : static_cast<size_t>(1) << (size_class + MIN_CLASS_SHIFT);
+	{
+		std::lock_guard<std::mutex> lk(s_pool_lock);
+		s_pool_in_use += capacity;
+		s_pool_peak = std::max(s_pool_peak, s_pool_in_use);
+		if (size_class >= 0 && !s_free_buffers[size_class].empty())
+		{
+			u8* data = s_free_buffers[size_class].back();
+			s_free_buffers[size_class].pop_back();
+			return Buffer(data, capacity);
+		}
+		s_pool_capacity += capacity;
+	}
+	return Buffer(AllocateSystem(capacity), capacity);
+}
+
+Buffer::Buffer(Buffer&& other) : m_data(other.m_data), m_size(other.m_size)
+{
+	other.m_data = nullptr;
+	other.m_size = 0;
+}
+
+Buffer& Buffer::operator=(Buffer&& other)
+{
+	if (this != &other)
+	{
+		Release();
+		m_data = other.m_data;
+		m_size = other.m_size;
+		other.m_data = nullptr;
+		other.m_size = 0;
+	}
+	return *this;
+}
+
+Buffer::~Buffer()
+{
+	Release();
+}
+
+void Buffer::Release()
+{
+	if (!m_data)
+		return;
+	const int size_class = SizeClass(m_size);
+	{
+		std::lock_guard<std::mutex> lk(s_pool_lock);
+		s_pool_in_use -= m_size;
+		if (size_class >= 0)
+		{
+			s_free_buffers[size_class].push_back(m_data);
+			m_data = nullptr;
+		}
+		else
+		{
+			s_pool_capacity -= m_size;
+		}
+	}
+	if (m_data)
+		Common::FreeAlignedMemory(m_data);
+	m_data = nullptr;
+	m_size = 0;
+}
+
+void Trim()
+{
+	for (const Chunk& chunk : s_chunks)
+		Common::FreeAlignedMemory(chunk.base);
+	s_chunks.clear();
+	s_current_chunk = 0;
+
+	std::lock_guard<std::mutex> lk(s_pool_lock);
+	for (size_t i = 0; i < CLASS_COUNT; i++)
+	{
+		for (u8* data : s_free_buffers[i])
+		{
+			Common::FreeAlignedMemory(data);
+			s_pool_capacity -= static_cast<size_t>(1) << (i + MIN_CLASS_SHIFT);
+		}
+		s_free_buffers[i].clear();
+	}
+}
+
+Stats GetStats()
+{
+	Stats stats;
+	stats.arena_capacity = 0;
+	for (const Chunk& chunk : s_chunks)
+		stats.arena_capacity += chunk.size;
+	stats.frame_peak = s_frame_peak;
+	stats.max_frame_peak = s_max_frame_peak;
+	std::lock_guard<std::mutex> lk(s_pool_lock);
+	stats.pool_in_use = s_pool_in_use;
+	stats.pool_peak = s_pool_peak;
+	stats.pool_capacity = s_pool_capacity;
+	stats.system_allocations = s_system_allocations;
+	return stats;
+}
+
+std::string StatsToString()
+{
+	const Stats stats = GetStats();
+	std::string str;
+	str += StringFromFormat("Scratch arena: %i kB, frame peak %i kB, max %i kB\n",
+		static_cast<int>(stats.arena_capacity / 1024), static_cast<int>(stats.frame_peak / 1024),
+		static_cast<int>(stats.max_frame_peak / 1024));
+	str += StringFromFormat("Scratch pools: %i kB in use, peak %i kB, held %i kB\n",
+		static_cast<int>(stats.pool_in_use / 1024), static_cast<int>(stats.pool_peak / 1024),
+		static_cast<int>(stats.pool_capacity / 1024));
+	str += StringFromFormat("Scratch system allocations: %u\n", stats.system_allocations);
+	return str;
+}
+}
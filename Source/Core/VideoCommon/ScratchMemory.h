@@ -0,0 +1,123 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "Common/CommonTypes.h"
+
+// Scratch memory for the video paths, so decoding, scaling and loading textures don't call the
+// system allocator, and touch fresh pages, for every texture or draw.
+//
+// The frame arena is a linear allocator for the video thread, everything allocated from it is
+// released at once by EndFrame in Renderer::Swap. Once a frame needed more than one chunk the
+// chunks are merged, so after the first frames the arena is a single block that is reused.
+//
+// The pools hand out buffers of power of two size classes to any thread, a buffer goes back to
+// its pool when destroyed and is reused by the next request of its class.
+namespace ScratchMemory
+{
+// Video thread. The memory is valid until the next EndFrame.
+void* AllocateFrame(size_t size, size_t alignment = 16);
+
+template <typename T>
+T* AllocateFrameArray(size_t count)
+{
+	return static_cast<T*>(AllocateFrame(count * sizeof(T), alignof(T)));
+}
+
+// Allocator for containers living at most until the end of the frame, deallocate does nothing
+template <typename T>
+class FrameAllocator
+{
+public:
+	typedef T value_type;
+
+	FrameAllocator()
+	{}
+	template <typename U>
+	FrameAllocator(const FrameAllocator<U>&)
+	{}
+
+	T* allocate(size_t n)
+	{
+		return AllocateFrameArray<T>(n);
+	}
+	void deallocate(T*, size_t)
+	{}
+
+	template <typename U>
+	bool operator==(const FrameAllocator<U>&) const
+	{
+		return true;
+	}
+	template <typename U>
+	bool operator!=(const FrameAllocator<U>&) const
+	{
+		return false;
+	}
+};
+
+// A pooled buffer, move-only. The memory is 64 byte aligned and at least as large as requested.
+class Buffer final
+{
+public:
+	Buffer() : m_data(nullptr), m_size(0)
+	{}
+	Buffer(Buffer&& other);
+	Buffer& operator=(Buffer&& other);
+	Buffer(const Buffer&) = delete;
+	Buffer& operator=(const Buffer&) = delete;
+	~Buffer();
+
+	u8* data() const
+	{
+		return m_data;
+	}
+	// The capacity of the size class, which may be more than requested
+	size_t size() const
+	{
+		return m_size;
+	}
+	explicit operator bool() const
+	{
+		return m_data != nullptr;
+	}
+	void Release();
+
+private:
+	friend Buffer Acquire(size_t size);
+	Buffer(u8* data, size_t size) : m_data(data), m_size(size)
+	{}
+	u8* m_data;
+	size_t m_size;
+};
+
+// Any thread
+Buffer Acquire(size_t size);
+
+// Video thread, once per frame
+void EndFrame();
+// Frees the memory of the arena and of the pooled buffers nobody holds
+void Trim();
+
+struct Stats
+{
+	size_t arena_capacity;
+	// Arena bytes used by the last finished frame, and the most any frame used
+	size_t frame_peak;
+	size_t max_frame_peak;
+	// Pooled bytes handed out now and at most, and held in total including the free buffers
+	size_t pool_in_use;
+	size_t pool_peak;
+	size_t pool_capacity;
+	// Calls to the system allocator, after warming up this should stop growing
+	u32 system_allocations;
+};
+
+Stats GetStats();
+std::string StatsToString();
+}
@@ -9,7 +9,9 @@
 #include <fstream>
 #include <iomanip>
 #include <map>
+#include <mutex>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 #include "Common/CommonTypes.h"
@@ -44,6 +46,8 @@ public:
 		HASH = 0;
 	}
 
+	// ClearUnused resets the fields the generator ignores in this state, so uids that only differ
+	// there share one shader
 	inline void CalculateUIDHash()
 	{
 		if (HASH == 0)
@@ -53,6 +57,17 @@ public:
 		}
 	}
 
+	// The hash the uid would have without ClearUnused
+	u64 CalculateRawHash() const
+	{
+		return GetHash64(reinterpret_cast<const u8*>(&data) + data.StartValue(), data.NumValues(), 0);
+	}
+
+	std::size_t GetHash() const
+	{
+		return HASH;
+	}
+
 	bool operator == (const ShaderUid& obj) const
 	{
 		return data.StartValue() == obj.data.StartValue()
@@ -99,6 +114,38 @@ private:
 	std::size_t HASH;
 };
 
+// Counts the distinct uids that ClearUnused merged into another one, into a Statistics field.
+// Only does the extra hashing while the statistics are shown.
+class UidCollapseCounter
+{
+public:
+	explicit UidCollapseCounter(int& stat) : m_stat(stat)
+	{}
+
+	template<class uid_data>
+	void CalculateUIDHash(ShaderUid<uid_data>& uid)
+	{
+		if (!g_ActiveConfig.bOverlayStats)
+		{
+			uid.CalculateUIDHash();
+			return;
+		}
+		const u64 raw_hash = uid.CalculateRawHash();
+		uid.CalculateUIDHash();
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_raw_hashes.insert(raw_hash);
+		m_hashes.insert(uid.GetHash());
+		m_stat = static_cast<int>(m_raw_hashes.size() - m_hashes.size());
+	}
+
+private:
+	std::mutex m_mutex;
+	std::unordered_set<u64> m_raw_hashes;
+	std::unordered_set<u64> m_hashes;
+	int& m_stat;
+};
+
 class ShaderCode
 {
 public:
@@ -0,0 +1,170 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <deque>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/StringUtil.h"
+#include "Common/ThreadPool.h"
+#include "Common/Timer.h"
+#include "Common/Logging/Log.h"
+
+#include "Core/Host.h"
+
+#include "VideoCommon/OnScreenDisplay.h"
+#include "VideoCommon/ShaderPrecompiler.h"
+#include "VideoCommon/VideoConfig.h"
+
+namespace ShaderPrecompiler
+{
+// Time the video thread spends on background jobs per frame
+static constexpr u64 FRAME_BUDGET_US = 4000;
+// Shaders each thread compiles per round of a thread safe job
+static constexpr size_t SHADERS_PER_THREAD = 4;
+
+// Only touched by the video thread
+static std::deque<Job> s_jobs;
+// Next index of the front job
+static size_t s_next = 0;
+// Over every job since the queue was last empty
+static size_t s_issued = 0;
+static size_t s_total = 0;
+static size_t s_last_percent = 101;
+static u64 s_start_us = 0;
+
+static void ReportProgress(const Job& job)
+{
+	const size_t percent = s_total ? s_issued * 100 / s_total : 100;
+	if (percent == s_last_percent)
+		return;
+	s_last_percent = percent;
+
+	const std::string message = StringFromFormat("Compiling %s %zu %% (%zu/%zu)", job.name.c_str(),
+		percent, s_issued, s_total);
+	Host_UpdateTitle(message);
+	OSD::AddTypedMessage(OSD::MessageType::ShaderPrecompile, message, OSD::Duration::SHORT,
+		OSD::Color::CYAN);
+}
+
+// Issues the shaders of the front job until it is done or the deadline passed. In the background
+// it returns false instead of waiting when the compiler of the job has no room, the frame goes on.
+static bool Advance(Job& job, u64 deadline_us, bool background)
+{
+	if (job.thread_safe)
+	{
+		const size_t batch = (Common::ThreadPool::GetWorkerCount() + 1) * SHADERS_PER_THREAD;
+		while (s_next < job.count)
+		{
+			const size_t end = std::min(job.count, s_next + batch);
+			Common::ParallelLoop(Common::TaskPriority::High).Loop([&job](int lower, int upper)
+			{
+				for (int i = lower; i < upper; i++)
+					job.compile(static_cast<size_t>(i));
+			}, static_cast<int>(s_next), static_cast<int>(end), 1);
+			s_issued += end - s_next;
+			s_next = end;
+			ReportProgress(job);
+			if (Common::Timer::GetTimeUs() >= deadline_us)
+				break;
+		}
+		return true;
+	}
+
+	size_t waits = 0;
+	while (s_next < job.count)
+	{
+		if (job.ready && !job.ready())
+		{
+			if (background)
+				return false;
+			Common::cYield(waits++);
+			continue;
+		}
+		waits = 0;
+		job.compile(s_next++);
+		s_issued++;
+		ReportProgress(job);
+		if (Common::Timer::GetTimeUs() >= deadline_us)
+			break;
+	}
+	return true;
+}
+
+static void Process(u64 deadline_us, bool background)
+{
+	while (!s_jobs.empty())
+	{
+		Job& job = s_jobs.front();
+		if (!Advance(job, deadline_us, background))
+			return;
+		if (s_next < job.count)
+			return;
+
+		if (job.finish)
+			job.finish();
+		s_jobs.pop_front();
+		s_next = 0;
+		if (Common::Timer::GetTimeUs() >= deadline_us)
+			break;
+	}
+
+	if (s_jobs.empty() && s_total != 0)
+	{
+		const double seconds = (Common::Timer::GetTimeUs() - s_start_us) / 1000000.0;
+		NOTICE_LOG(VIDEO, "Precompiled %zu shaders in %.2f s", s_total, seconds);
+		if (background)
+		{
+			OSD::AddTypedMessage(OSD::MessageType::ShaderPrecompile,
+				StringFromFormat("Compiled %zu shaders in %.1f s", s_total, seconds),
+				OSD::Duration::NORMAL, OSD::Color::CYAN);
+		}
+		s_total = 0;
+		s_issued = 0;
+	}
+}
+
+void Run(std::vector<Job> jobs)
+{
+	if (s_jobs.empty())
+	{
+		s_start_us = Common::Timer::GetTimeUs();
+		s_last_percent = 101;
+	}
+	for (Job& job : jobs)
+	{
+		if (job.count == 0)
+			continue;
+		s_total += job.count;
+		s_jobs.push_back(std::move(job));
+	}
+
+	if (!g_ActiveConfig.bBackgroundShaderPrecompile)
+		Process(std::numeric_limits<u64>::max(), false);
+}
+
+void OnFrame()
+{
+	if (!s_jobs.empty())
+		Process(Common::Timer::GetTimeUs() + FRAME_BUDGET_US, true);
+}
+
+void Cancel()
+{
+	// The compiles already queued belong to the caches, which wait for them when they shut down
+	s_jobs.clear();
+	s_next = 0;
+	s_issued = 0;
+	s_total = 0;
+}
+
+bool IsRunning()
+{
+	return !s_jobs.empty();
+}
+}
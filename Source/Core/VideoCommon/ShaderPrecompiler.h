@@ -0,0 +1,66 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "VideoCommon/ObjectUsageProfiler.h"
+
+// Startup shader precompilation shared by the backends, used with bCompileShaderOnStartup.
+//
+// The shader caches list the uids of the game's usage profile, most used first, and hand them over
+// as jobs with the entry point that compiles one of them. The jobs run on the video thread in Run,
+// or with bBackgroundShaderPrecompile a few milliseconds of them per frame in OnFrame, so the game
+// is playable while they compile. Either way the compiles never overlap with drawing: a job that
+// is thread safe is spread over the thread pool while the video thread waits, the others compile
+// or queue their shaders on the video thread. Progress is shown on the OSD and in the title.
+namespace ShaderPrecompiler
+{
+struct Job
+{
+	// Shown in the progress, like "Pixel Shaders"
+	std::string name;
+	size_t count = 0;
+	// Compiles, or queues for compilation, the shader at index if it isn't yet. It must leave the
+	// current shaders of the cache alone, so the backends compile as if off the gpu thread even
+	// though the jobs run on it: a precompiled shader isn't the one the next draw uses.
+	std::function<void(size_t)> compile;
+	// compile may be called from several pool workers at once
+	bool thread_safe = false;
+	// Optional, returns false while a backend that queues its compiles has no room for more. It may
+	// handle finished compiles meanwhile.
+	std::function<bool()> ready;
+	// Optional, called once every shader of the job was issued, waits for the queued compiles
+	std::function<void()> finish;
+};
+
+// Recomputes the hash of each uid, which isn't part of the stored profile
+template <typename Uid, typename Profiler, typename Filter>
+std::vector<Uid> CollectUids(Profiler& profiler, pKey_t game_id, Filter needs_compile)
+{
+	std::vector<Uid> uids;
+	profiler.ForEachMostUsedByCategory(game_id,
+		[&](const Uid& uid, size_t total)
+	{
+		if (uids.empty())
+			uids.reserve(total);
+		uids.push_back(uid);
+		uids.back().ClearHASH();
+		uids.back().CalculateUIDHash();
+	}, needs_compile, true);
+	return uids;
+}
+
+// Video thread
+void Run(std::vector<Job> jobs);
+// Video thread, once per frame. Continues the background jobs.
+void OnFrame();
+// Video thread, before the caches the jobs refer to are destroyed
+void Cancel();
+bool IsRunning();
+}
@@ -7,6 +7,7 @@
 #include <utility>
 
 #include "Common/StringUtil.h"
+#include "VideoCommon/ScratchMemory.h"
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/VertexLoaderManager.h"
 #include "VideoCommon/VideoConfig.h"
@@ -48,6 +49,8 @@ std::string Statistics::ToString()
 	str += StringFromFormat("pshaders alive: %i\n", stats.numPixelShadersAlive);
 	str += StringFromFormat("vshaders created: %i\n", stats.numVertexShadersCreated);
 	str += StringFromFormat("vshaders alive: %i\n", stats.numVertexShadersAlive);
+	str += StringFromFormat("pshader uids collapsed: %i\n", stats.numPixelShaderUidsCollapsed);
+	str += StringFromFormat("vshader uids collapsed: %i\n", stats.numVertexShaderUidsCollapsed);
 	str += StringFromFormat("gshaders created: %i\n", stats.numGeometryShadersCreated);
 	str += StringFromFormat("gshaders alive: %i\n", stats.numGeometryShadersAlive);
 	str += StringFromFormat("hshaders created: %i\n", stats.numHullShadersCreated);
@@ -56,10 +59,19 @@ std::string Statistics::ToString()
 	str += StringFromFormat("dshaders alive: %i\n", stats.numDomainShadersAlive);
 	str += StringFromFormat("shaders changes: %i\n", stats.thisFrame.numShaderChanges);
 	str += StringFromFormat("dlists called: %i\n", stats.thisFrame.numDListsCalled);
+	str += StringFromFormat("dlists cached: %i\n", stats.thisFrame.numDListsCached);
+	str += StringFromFormat("dlists alive: %i\n", stats.numDListsAlive);
 	str += StringFromFormat("Primitive joins: %i\n", stats.thisFrame.numPrimitiveJoins);
 	str += StringFromFormat("Draw calls: %i\n", stats.thisFrame.numDrawCalls);
+	str += StringFromFormat("Flushes: %i\n", stats.thisFrame.numFlushes);
+	str += StringFromFormat("Texture uploads: %i\n", stats.thisFrame.numTextureUploads);
+	str += StringFromFormat("EFB copies reused: %i\n", stats.thisFrame.numEFBCopiesReused);
+	str += StringFromFormat("GPU thread wakeups: %i\n", stats.thisFrame.numGpuThreadWakeups);
+	str += StringFromFormat("GPU thread spin: %.2f ms\n", stats.thisFrame.gpuThreadSpinUs / 1000.0f);
+	str += StringFromFormat("Deterministic GPU syncs: %i\n", stats.thisFrame.numDeterministicGpuSyncs);
 	str += StringFromFormat("Primitives: %i\n", stats.thisFrame.numPrims);
 	str += StringFromFormat("Primitives (DL): %i\n", stats.thisFrame.numDLPrims);
+	str += StringFromFormat("Primitives culled on CPU: %i\n", stats.thisFrame.numPrimsCulled);
 	str += StringFromFormat("XF loads: %i\n", stats.thisFrame.numXFLoads);
 	str += StringFromFormat("XF loads (DL): %i\n", stats.thisFrame.numXFLoadsInDL);
 	str += StringFromFormat("CP loads: %i\n", stats.thisFrame.numCPLoads);
@@ -69,7 +81,11 @@ std::string Statistics::ToString()
 	str += StringFromFormat("Vertex streamed: %i kB\n", stats.thisFrame.bytesVertexStreamed / 1024);
 	str += StringFromFormat("Index streamed: %i kB\n", stats.thisFrame.bytesIndexStreamed / 1024);
 	str += StringFromFormat("Uniform streamed: %i kB\n", stats.thisFrame.bytesUniformStreamed / 1024);
+	str += StringFromFormat("Descriptor sets allocated: %i\n", stats.thisFrame.numDescriptorSetsAllocated);
+	str += StringFromFormat("Descriptor sets reused: %i\n", stats.thisFrame.numDescriptorSetsReused);
+	str += StringFromFormat("Redundant binds skipped: %i\n", stats.thisFrame.numRedundantBindsSkipped);
 	str += StringFromFormat("Vertex Loaders: %i\n", stats.numVertexLoaders);
+	str += ScratchMemory::StatsToString();
 
 	std::string vertex_list;
 	VertexLoaderManager::AppendListToString(&vertex_list);
@@ -18,11 +18,15 @@ struct Statistics
 	int numPixelShadersAlive;
 	int numVertexShadersCreated;
 	int numVertexShadersAlive;
+	// Distinct uids that only differed in state the shader ignores, see UidCollapseCounter
+	int numPixelShaderUidsCollapsed;
+	int numVertexShaderUidsCollapsed;
 
 	int numTexturesCreated;
 	int numTexturesAlive;
 
 	int numVertexLoaders;
+	int numDListsAlive;
 
 	float proj_0, proj_1, proj_2, proj_3, proj_4, proj_5;
 	float gproj_0, gproj_1, gproj_2, gproj_3, gproj_4, gproj_5;
@@ -43,17 +47,31 @@ struct Statistics
 
 		int numPrims;
 		int numDLPrims;
+		// Vertices of culled draws and of degenerate triangles dropped before the GPU, see bCPUCull
+		int numPrimsCulled;
 		int numShaderChanges;
 
 		int numPrimitiveJoins;
 		int numDrawCalls;
+		int numFlushes;
+		int numTextureUploads;
+		int numEFBCopiesReused;
+
+		int numGpuThreadWakeups;
+		int gpuThreadSpinUs;
+		int numDeterministicGpuSyncs;
 
 		int numDListsCalled;
+		int numDListsCached;
 
 		int bytesVertexStreamed;
 		int bytesIndexStreamed;
 		int bytesUniformStreamed;
 
+		int numDescriptorSetsAllocated;
+		int numDescriptorSetsReused;
+		int numRedundantBindsSkipped;
+
 		int numTrianglesClipped;
 		int numTrianglesIn;
 		int numTrianglesRejected;
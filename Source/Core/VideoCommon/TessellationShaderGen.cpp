@@ -71,17 +71,22 @@ HSOutput result = (HSOutput)0;
 )hlsl";
 static const char* s_hlsl_constant_header_str = R"hlsl(
 
-float GetScreenSize(float3 Origin, float Diameter)
+float2 ProjectToScreen(float3 Origin)
 {
-    float w = dot()hlsl" I_PROJECTION R"hlsl([3], float4( Origin, 1.0 ));
-    return abs(Diameter * )hlsl" I_PROJECTION R"hlsl([1].y / w);
+	float4 pos = float4(Origin, 1.0);
+	float2 clip = float2(dot()hlsl" I_PROJECTION R"hlsl([0], pos), dot()hlsl" I_PROJECTION R"hlsl([1], pos));
+	float w = max(abs(dot()hlsl" I_PROJECTION R"hlsl([3], pos)), 0.0001);
+	return clip / w * )hlsl" I_TESSSCREEN R"hlsl(.xy;
 }
 
-float CalcTessFactor(float3 Origin, float Diameter)
+// One segment per configured number of pixels of the edge on screen, faded out with distance.
+// Only depends on the edge end points, so patches sharing an edge agree on its factor.
+float CalcTessFactor(float3 P0, float3 P1)
 {
-	float distance = 1.0 - saturate(length(Origin) * )hlsl" I_TESSPARAMS R"hlsl(.x);
+	float distance = 1.0 - saturate(length((P0 + P1) * 0.5) * )hlsl" I_TESSPARAMS R"hlsl(.x);
 	distance = distance * distance;
-	return round(max(4.0,)hlsl" I_TESSPARAMS R"hlsl(.y * GetScreenSize(Origin,Diameter) * distance));
+	float pixels = length(ProjectToScreen(P0) - ProjectToScreen(P1));
+	return clamp(round(pixels * )hlsl" I_TESSSCREEN R"hlsl(.z * distance), 1.0, )hlsl" I_TESSPARAMS R"hlsl(.y);
 }
 ConstantOutput TConstFunc(InputPatch<VS_OUTPUT, 3> patch)
 {
@@ -418,6 +423,7 @@ inline void GenerateTessellationShader(ShaderCode& out, const Tessellation_shade
 	out.Write(
 		"\tfloat4 " I_TESSPARAMS";\n"
 		"\tint4 " I_CULLPARAMS";\n"
+		"\tfloat4 " I_TESSSCREEN";\n"
 		"};\n");
 
 	if (ApiType == API_OPENGL)
@@ -561,9 +567,9 @@ inline void GenerateTessellationShader(ShaderCode& out, const Tessellation_shade
 			"float l1 = distance(pos[2].xyz,pos[0].xyz);\n"
 			"float l2 = distance(pos[0].xyz,pos[1].xyz);\n"
 			"result.edgesize = float4(l0, l1, l2, 1.0);\n"
-			"result.EFactor[0] = CalcTessFactor((pos[1].xyz+pos[2].xyz) * 0.5, l0);\n"
-			"result.EFactor[1] = CalcTessFactor((pos[2].xyz+pos[0].xyz) * 0.5, l1);\n"
-			"result.EFactor[2] = CalcTessFactor((pos[0].xyz+pos[1].xyz) * 0.5, l2);\n"
+			"result.EFactor[0] = CalcTessFactor(pos[1].xyz, pos[2].xyz);\n"
+			"result.EFactor[1] = CalcTessFactor(pos[2].xyz, pos[0].xyz);\n"
+			"result.EFactor[2] = CalcTessFactor(pos[0].xyz, pos[1].xyz);\n"
 			"result.InsideFactor = (result.EFactor[0] + result.EFactor[1] + result.EFactor[2]) / 3;\n"
 			"return result;\n};\n"
 		);
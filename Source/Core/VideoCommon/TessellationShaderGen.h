@@ -135,6 +135,7 @@ struct Tessellation_shader_uid_data
 
 #define I_TESSPARAMS  "ctess"
 #define I_CULLPARAMS  "ccullp"
+#define I_TESSSCREEN  "ctessscreen"
 
 #define TESSELLATIONSHADERGEN_BUFFERSIZE 32768
 #define TESSELLATIONSHADERGEN_UID_VERSION 1
@@ -53,6 +53,19 @@ void TessellationShaderManager::SetConstants()
 			constants.tessparams[3] = displacement;
 			dirty = true;
 		}
+		// Half the viewport in target pixels, to map clip space edges to pixels.
+		float screen_x = std::abs(Renderer::EFBToScaledXf(xfmem.viewport.wd));
+		float screen_y = std::abs(Renderer::EFBToScaledYf(xfmem.viewport.ht));
+		float inv_edge_size = 1.0f / float(g_ActiveConfig.iTessellationEdgeSize);
+		if (constants.tessscreen[0] != screen_x
+			|| constants.tessscreen[1] != screen_y
+			|| constants.tessscreen[2] != inv_edge_size)
+		{
+			constants.tessscreen[0] = screen_x;
+			constants.tessscreen[1] = screen_y;
+			constants.tessscreen[2] = inv_edge_size;
+			dirty = true;
+		}
 		int cull = bpmem.genMode.cullmode > 0 ? (bpmem.genMode.cullmode == 2 ? 1 : -1) : 0;
 		int earlycull = g_ActiveConfig.bTessellationEarlyCulling ? 1 : 0;
 		if (constants.cullparams[0] != cull || constants.cullparams[1] != earlycull)
@@ -5,11 +5,14 @@
 #include <cstring>
 #include <memory>
 #include <string>
+#include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include "Common/FileUtil.h"
 #include "Common/MemoryUtil.h"
 #include "Common/StringUtil.h"
+#include "Common/Trace.h"
 
 #include "Core/ConfigManager.h"
 #include "Core/FifoPlayer/FifoPlayer.h"
@@ -18,8 +21,11 @@
 
 #include "VideoCommon/Debugger.h"
 #include "VideoCommon/FramebufferManagerBase.h"
+#include "VideoCommon/GPUProfilerBase.h"
 #include "VideoCommon/HiresTextures.h"
+#include "VideoCommon/ImageWrite.h"
 #include "VideoCommon/RenderBase.h"
+#include "VideoCommon/ScratchMemory.h"
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/SamplerCommon.h"
 #include "VideoCommon/TextureCacheBase.h"
@@ -27,24 +33,36 @@
 #include "VideoCommon/TextureUtil.h"
 #include "VideoCommon/VideoCommon.h"
 #include "VideoCommon/VideoConfig.h"
+#ifdef _WIN32
+#include "VideoCommon/OpenCL/OCLTextureDecoder.h"
+#endif
 
 
-static const u64 MAX_TEXTURE_BINARY_SIZE = 1024 * 1024 * 4; // 1024 x 1024 texel times 8 nibbles per texel
 std::unique_ptr<TextureCacheBase> g_texture_cache;
 
 alignas(16) u8 *TextureCacheBase::temp = nullptr;
 size_t TextureCacheBase::temp_size;
+// Backs temp, the buffers it outgrows go back to the scratch pools
+static ScratchMemory::Buffer s_temp_buffer;
 TextureCacheBase::TexCache TextureCacheBase::textures_by_address;
 TextureCacheBase::TexCache TextureCacheBase::textures_by_hash;
 TextureCacheBase::TexPool  TextureCacheBase::texture_pool;
 // Pool to save hires textures to avoid unnesessary reloads
 TextureCacheBase::TCacheEntryBase* TextureCacheBase::bound_textures[8];
 u32 TextureCacheBase::s_last_texture;
+std::vector<TextureCacheBase::PendingDecode> TextureCacheBase::s_pending_decodes;
+std::vector<TextureCacheBase::DeferredEFBCopy> TextureCacheBase::s_deferred_efb_copies;
+TextureCacheBase::LastEFBCopy TextureCacheBase::s_last_efb_copy = {};
+std::unordered_map<std::string, u32> TextureCacheBase::s_custom_texture_skipped_levels;
+std::unordered_set<std::string> TextureCacheBase::s_dumped_textures;
 
 
 TextureCacheBase::BackupConfig TextureCacheBase::backup_config;
 // Small counter to track the amount of memory currently used on the gpu
 size_t TextureCacheBase::texture_pool_memory_usage = 0;
+size_t TextureCacheBase::s_custom_texture_memory_usage = 0;
+std::vector<TextureCacheBase::TCacheEntryBase*> TextureCacheBase::s_used_entries;
+u64 TextureCacheBase::s_cleanup_address = 0;
 
 TextureCacheBase::TCacheEntryBase::~TCacheEntryBase()
 {}
@@ -54,16 +72,14 @@ void TextureCacheBase::CheckTempSize(size_t required_size)
 	if (required_size <= temp_size)
 		return;
 
-	temp_size = required_size;
-	Common::FreeAlignedMemory(temp);
-	temp = static_cast<u8*>(Common::AllocateAlignedMemory(temp_size, 16));
+	s_temp_buffer = ScratchMemory::Acquire(required_size);
+	temp = s_temp_buffer.data();
+	temp_size = s_temp_buffer.size();
 }
 
 TextureCacheBase::TextureCacheBase()
 {
-	temp_size = 2048 * 2048 * 4;
-	if (!TextureCacheBase::temp)
-		TextureCacheBase::temp = static_cast<u8*>(Common::AllocateAlignedMemory(temp_size, 16));
+	CheckTempSize(2048 * 2048 * 4);
 
 	TexDecoder_SetTexFmtOverlayOptions(g_ActiveConfig.bTexFmtOverlayEnable, g_ActiveConfig.bTexFmtOverlayCenter);
 
@@ -72,6 +88,10 @@ TextureCacheBase::TextureCacheBase()
 	SetHash64Function();
 	texture_pool_memory_usage = 0;
 	UnbindTextures();
+#ifdef _WIN32
+	if (g_ActiveConfig.bEnableOpenCL)
+		TexDecoder_OpenCL_Initialize();
+#endif
 }
 
 void TextureCacheBase::Invalidate()
@@ -85,10 +105,31 @@ void TextureCacheBase::Invalidate()
 	}
 	textures_by_address.clear();
 	textures_by_hash.clear();
+	s_custom_texture_skipped_levels.clear();
+}
+
+void TextureCacheBase::Revalidate()
+{
+	UnbindTextures();
+	TexCache::iterator iter = textures_by_address.begin();
+	while (iter != textures_by_address.end())
+	{
+		if (iter->second->IsEfbCopy())
+		{
+			iter = InvalidateTexture(iter);
+			continue;
+		}
+
+		// The state load wrote the memory behind the watches' back
+		iter->second->watch_epoch = 0;
+		++iter;
+	}
 }
 
 TextureCacheBase::~TextureCacheBase()
 {
+	ShutdownImageWrites();
+	s_dumped_textures.clear();
 	HiresTexture::Shutdown();
 	UnbindTextures();
 	Invalidate();
@@ -98,11 +139,13 @@ TextureCacheBase::~TextureCacheBase()
 	}
 	texture_pool.clear();
 	texture_pool_memory_usage = 0;
-	if (TextureCacheBase::temp)
-	{
-		Common::FreeAlignedMemory(TextureCacheBase::temp);
-		TextureCacheBase::temp = nullptr;
-	}
+	s_used_entries.clear();
+#ifdef _WIN32
+	TexDecoder_OpenCL_Shutdown();
+#endif
+	s_temp_buffer.Release();
+	TextureCacheBase::temp = nullptr;
+	TextureCacheBase::temp_size = 0;
 }
 
 void TextureCacheBase::OnConfigChanged(VideoConfig& config)
@@ -151,56 +194,100 @@ void TextureCacheBase::OnConfigChanged(VideoConfig& config)
 
 void TextureCacheBase::Cleanup(s32 _frameCount)
 {
+	// Deferred EFB copies reach RAM within a frame
+	FlushEFBCopies();
+	// Evicted custom textures are also loaded again in the background
+	if (g_ActiveConfig.bHiresTextures)
+	{
+		ReloadStreamedTextures();
+	}
+	// Only the entries used since the last cleanup get the frame number, in the cache or the pool
+	std::vector<TCacheEntryBase*> used_custom_entries;
+	for (TCacheEntryBase* entry : s_used_entries)
+	{
+		if (entry->frameCount != FRAMECOUNT_INVALID)
+			continue;
+		entry->frameCount = _frameCount;
+		if (entry->is_custom_tex)
+			used_custom_entries.push_back(entry);
+	}
+	s_used_entries.clear();
+	if (!used_custom_entries.empty())
+	{
+		std::vector<std::string> used_custom_textures;
+		used_custom_textures.reserve(used_custom_entries.size());
+		for (const TCacheEntryBase* entry : used_custom_entries)
+			used_custom_textures.push_back(entry->basename);
+		HiresTexture::MarkUsed(used_custom_textures);
+	}
+
 	s32 texture_kill_threshold = TEXTURE_KILL_THRESHOLD;
 	if (texture_pool_memory_usage < (TEXTURE_POOL_MEMORY_LIMIT / 2))
 	{
 		// if we are using less than the memory limit increase kill threshold
 		texture_kill_threshold *= TEXTURE_KILL_MULTIPLIER;
 	}
-	TexCache::iterator iter = textures_by_address.begin();
+	// Unused entries are aged a slice at a time, resuming where the last frame stopped. A slice
+	// ends between two addresses so the entries sharing one are all visited by the same frame.
+	size_t slice_left = std::max<size_t>(TEXTURE_CLEANUP_MIN_ENTRIES,
+		textures_by_address.size() / TEXTURE_CLEANUP_SWEEP_FRAMES);
+	TexCache::iterator iter = textures_by_address.lower_bound(s_cleanup_address);
 	TexCache::iterator tcend = textures_by_address.end();
-	while (iter != tcend)
+	u64 slice_address = s_cleanup_address;
+	while (iter != tcend && (slice_left != 0 || iter->first == slice_address))
 	{
-		if (iter->second->frameCount == FRAMECOUNT_INVALID)
+		slice_address = iter->first;
+		if (slice_left != 0)
+			slice_left--;
+		TCacheEntryBase* entry = iter->second;
+		if (_frameCount <= texture_kill_threshold + entry->frameCount)
 		{
-			iter->second->frameCount = _frameCount;
+			++iter;
 		}
-		if (_frameCount > texture_kill_threshold + iter->second->frameCount)
+		else if (!entry->IsEfbCopy())
 		{
-			if (iter->second->IsEfbCopy())
-			{
-				// Only remove EFB copies when they wouldn't be used anymore(changed hash), because EFB copies living on the
-				// host GPU are unrecoverable. Perform this check only every TEXTURE_KILL_THRESHOLD for performance reasons
-				if ((_frameCount - iter->second->frameCount) % TEXTURE_KILL_THRESHOLD == 1 &&
-					iter->second->hash != iter->second->CalculateHash())
-				{
-					iter = InvalidateTexture(iter);
-				}
-				else
-				{
-					++iter;
-				}
-			}
-			else
-			{
+			iter = InvalidateTexture(iter);
+		}
+		else if (_frameCount - entry->hash_check_frame >= TEXTURE_KILL_THRESHOLD)
+		{
+			// Only remove EFB copies when they wouldn't be used anymore(changed hash), because EFB copies living on the
+			// host GPU are unrecoverable. Perform this check only every TEXTURE_KILL_THRESHOLD for performance reasons
+			entry->hash_check_frame = _frameCount;
+			if (entry->hash != entry->CalculateHash())
 				iter = InvalidateTexture(iter);
-			}
+			else
+				++iter;
 		}
 		else
 		{
 			++iter;
 		}
 	}
+	// The next sweep starts over at the lowest address
+	s_cleanup_address = iter != tcend ? iter->first : 0;
+
+	if (g_ActiveConfig.iHiresTextureVRAMBudget > 0)
+		EnforceCustomTextureBudget(_frameCount);
+	if (g_ActiveConfig.bHiresTextures && g_ActiveConfig.bStreamHiresTextures && g_ActiveConfig.bCacheHiresTextures)
+		StreamCustomTextureLevels(_frameCount, used_custom_entries);
+
+	s32 pool_kill_threshold = TEXTURE_POOL_KILL_THRESHOLD;
+	u32 pool_frees_left = UINT32_MAX;
+	if (texture_pool_memory_usage < TEXTURE_POOL_MEMORY_LIMIT)
+	{
+		// Keep unused textures around for a while longer and free them gradually,
+		// creating them again costs more than the memory they take while the limit isn't reached
+		if (texture_pool_memory_usage < (TEXTURE_POOL_MEMORY_LIMIT / 2))
+			pool_kill_threshold *= TEXTURE_KILL_MULTIPLIER;
+		pool_frees_left = TEXTURE_POOL_MAX_FREES_PER_FRAME;
+	}
 	TexPool::iterator iter2 = texture_pool.begin();
 	TexPool::iterator tcend2 = texture_pool.end();
 	while (iter2 != tcend2)
 	{
-		if (iter2->second->frameCount == FRAMECOUNT_INVALID)
-		{
-			iter2->second->frameCount = _frameCount;
-		}
-		if (_frameCount > TEXTURE_POOL_KILL_THRESHOLD + iter2->second->frameCount)
+		if (_frameCount > pool_kill_threshold + iter2->second->frameCount && pool_frees_left != 0)
 		{
+			pool_frees_left--;
 			texture_pool_memory_usage -= iter2->second->native_size_in_bytes;
 			delete iter2->second;
 			iter2 = texture_pool.erase(iter2);
@@ -225,6 +312,32 @@ bool TextureCacheBase::TCacheEntryBase::OverlapsMemoryRange(u32 range_address, u
 
 TextureCacheBase::TCacheEntryBase* TextureCacheBase::TCacheEntryBase::ApplyPalette(u32 tlutaddr, u32 tlutfmt, u32 palette_size)
 {
+	// The conversions stay next to the copy, keyed by the palette they were made with, so a palette
+	// that is used again doesn't cost another conversion pass. A new copy to the address invalidates
+	// them together with the old copy.
+	const u64 tlut_hash = GetHash64(&texMem[tlutaddr], palette_size, g_ActiveConfig.iSafeTextureCache_ColorSamples);
+	const u64 palette_hash = hash ^ tlut_hash;
+	TexCache::iterator unused_conversion = textures_by_address.end();
+	auto iter_range = textures_by_address.equal_range(addr);
+	for (TexCache::iterator iter = iter_range.first; iter != iter_range.second; ++iter)
+	{
+		TCacheEntryBase* entry = iter->second;
+		if (entry->IsEfbCopy() || entry->base_hash != hash || entry->native_width != native_width ||
+			entry->native_height != native_height)
+			continue;
+
+		if (entry->hash == palette_hash)
+		{
+			MarkUsedThisFrame(entry);
+			return entry;
+		}
+		// Games animating the palette leave a conversion behind every frame, recycle those
+		if (entry->frameCount != FRAMECOUNT_INVALID)
+			unused_conversion = iter;
+	}
+	if (unused_conversion != textures_by_address.end())
+		InvalidateTexture(unused_conversion);
+
 	TCacheEntryConfig newconfig;
 	newconfig.rendertarget = true;
 	newconfig.pcformat = PC_TEX_FMT_RGBA32;
@@ -237,8 +350,8 @@ TextureCacheBase::TCacheEntryBase* TextureCacheBase::TCacheEntryBase::ApplyPalet
 	{
 		decoded_entry->SetGeneralParameters(addr, size_in_bytes, format);
 		decoded_entry->SetDimensions(native_width, native_height, 1);
-		decoded_entry->SetHashes(base_hash, hash);
-		decoded_entry->frameCount = FRAMECOUNT_INVALID;
+		decoded_entry->SetHashes(palette_hash, hash);
+		MarkUsedThisFrame(decoded_entry);
 		decoded_entry->is_efb_copy = false;
 		g_texture_cache->LoadLut(tlutfmt, &texMem[tlutaddr], palette_size);
 		auto iter = textures_by_address.emplace(addr, decoded_entry);
@@ -276,9 +389,10 @@ void TextureCacheBase::ScaleTextureCacheEntryTo(TextureCacheBase::TCacheEntryBas
 	{
 		newentry->SetGeneralParameters((*entry)->addr, (*entry)->size_in_bytes, (*entry)->format);
 		newentry->SetDimensions((*entry)->native_width, (*entry)->native_height, 1);
-		newentry->SetHashes((*entry)->base_hash, (*entry)->hash);
+		newentry->SetHashes((*entry)->hash, (*entry)->base_hash);
 		newentry->frameCount = frameCount;
 		newentry->is_efb_copy = (*entry)->is_efb_copy;
+		newentry->memory_stride = (*entry)->memory_stride;
 		MathUtil::Rectangle<int> srcrect, dstrect;
 		srcrect.left = 0;
 		srcrect.top = 0;
@@ -326,8 +440,16 @@ TextureCacheBase::TCacheEntryBase* TextureCacheBase::DoPartialTextureUpdates(Tex
 
 	u32 numBlocksX = (entry_to_update->native_width + block_width - 1) / block_width;
 
-	TexCache::iterator iter = textures_by_address.lower_bound(entry_to_update->addr > MAX_TEXTURE_BINARY_SIZE ? entry_to_update->addr - MAX_TEXTURE_BINARY_SIZE : 0);
+	// A copy with a matching stride covers at most one row of blocks per 4 EFB lines, so there's
+	// no need to look further back for copies reaching into this texture.
+	const u32 row_size = numBlocksX * block_size;
+	const u32 max_copy_size = row_size * ((EFB_HEIGHT + 3) / 4);
+	TexCache::iterator iter = textures_by_address.lower_bound(entry_to_update->addr > max_copy_size ? entry_to_update->addr - max_copy_size : 0);
 	TexCache::iterator iterend = textures_by_address.upper_bound(entry_to_update->addr + entry_to_update->size_in_bytes);
+
+	// Collect the copies first, scaling and palette conversions below modify textures_by_address
+	static std::vector<TCacheEntryBase*> s_partial_copies;
+	s_partial_copies.clear();
 	while (iter != iterend)
 	{
 		TCacheEntryBase* entry = iter->second;
@@ -335,95 +457,11 @@ TextureCacheBase::TCacheEntryBase* TextureCacheBase::DoPartialTextureUpdates(Tex
 			&& entry->IsEfbCopy()
 			&& entry->references.count(entry_to_update) == 0
 			&& entry->OverlapsMemoryRange(entry_to_update->addr, entry_to_update->size_in_bytes)
-			&& entry->memory_stride == numBlocksX * block_size)
+			&& entry->memory_stride == row_size)
 		{
 			if (entry->hash == entry->CalculateHash())
 			{
-				if (isPaletteTexture)
-				{
-					TCacheEntryBase *decoded_entry = entry->ApplyPalette(tlutaddr, tlutfmt, palette_size);
-					if (decoded_entry)
-					{
-						// Link the efb copy with the partially updated texture, so we won't apply this partial update again
-						entry->CreateReference(entry_to_update);
-						// Mark the texture update as used, as if it was loaded directly
-						entry->frameCount = FRAMECOUNT_INVALID;
-						entry = decoded_entry;
-					}
-					else
-					{
-						++iter;
-						continue;
-					}
-				}
-
-				u32 src_x, src_y, dst_x, dst_y;
-				// Note for understanding the math:
-				// Normal textures can't be strided, so the 2 missing cases with src_x > 0 don't exist
-				if (entry->addr >= entry_to_update->addr)
-				{
-					u32 block_offset = (entry->addr - entry_to_update->addr) / block_size;
-					u32 block_x = block_offset % numBlocksX;
-					u32 block_y = block_offset / numBlocksX;
-					src_x = 0;
-					src_y = 0;
-					dst_x = block_x * block_width;
-					dst_y = block_y * block_height;
-				}
-				else
-				{
-					u32 block_offset = (entry_to_update->addr - entry->addr) / block_size;
-					u32 block_x = (~block_offset + 1) % numBlocksX;
-					u32 block_y = (block_offset + block_x) / numBlocksX;
-					src_x = 0;
-					src_y = block_y * block_height;
-					dst_x = block_x * block_width;
-					dst_y = 0;
-				}
-
-				u32 copy_width = std::min(entry->native_width - src_x, entry_to_update->native_width - dst_x);
-				u32 copy_height = std::min(entry->native_height - src_y, entry_to_update->native_height - dst_y);
-
-				// If one of the textures is scaled, scale both with the current efb scaling factor
-				if (entry_to_update->native_width != entry_to_update->config.width
-					|| entry_to_update->native_height != entry_to_update->config.height
-					|| entry->native_width != entry->config.width || entry->native_height != entry->config.height)
-				{
-					ScaleTextureCacheEntryTo(&entry_to_update, Renderer::EFBToScaledX(entry_to_update->native_width), Renderer::EFBToScaledY(entry_to_update->native_height));
-					ScaleTextureCacheEntryTo(&entry, Renderer::EFBToScaledX(entry->native_width), Renderer::EFBToScaledY(entry->native_height));
-
-					src_x = Renderer::EFBToScaledX(src_x);
-					src_y = Renderer::EFBToScaledY(src_y);
-					dst_x = Renderer::EFBToScaledX(dst_x);
-					dst_y = Renderer::EFBToScaledY(dst_y);
-					copy_width = Renderer::EFBToScaledX(copy_width);
-					copy_height = Renderer::EFBToScaledY(copy_height);
-				}
-
-				MathUtil::Rectangle<int> srcrect, dstrect;
-				srcrect.left = src_x;
-				srcrect.top = src_y;
-				srcrect.right = (src_x + copy_width);
-				srcrect.bottom = (src_y + copy_height);
-				dstrect.left = dst_x;
-				dstrect.top = dst_y;
-				dstrect.right = (dst_x + copy_width);
-				dstrect.bottom = (dst_y + copy_height);
-				entry_to_update->CopyRectangleFromTexture(entry, srcrect, dstrect);
-
-				if (isPaletteTexture)
-				{
-					// Remove the temporary converted texture, it won't be used anywhere else
-					// TODO: It would be nice to convert and copy in one step, but this code path isn't common
-					InvalidateTexture(GetTexCacheIter(entry));
-				}
-				else
-				{
-					// Link the two textures together, so we won't apply this partial update again
-					entry->CreateReference(entry_to_update);
-					// Mark the texture update as used, as if it was loaded directly
-					entry->frameCount = FRAMECOUNT_INVALID;
-				}
+				s_partial_copies.push_back(entry);
 			}
 			else
 			{
@@ -434,6 +472,92 @@ TextureCacheBase::TCacheEntryBase* TextureCacheBase::DoPartialTextureUpdates(Tex
 		}
 		++iter;
 	}
+	if (s_partial_copies.empty())
+		return entry_to_update;
+
+	// The copies have to land on top of the decoded texture, the other pending decodes can wait
+	if (std::any_of(s_pending_decodes.begin(), s_pending_decodes.end(),
+		[entry_to_update](const PendingDecode& decode) { return decode.entry == entry_to_update; }))
+		UploadPendingDecodes();
+
+	// If one of the textures is scaled, scale the target once with the current efb scaling factor
+	// before any copy lands in it
+	bool scaled = entry_to_update->native_width != entry_to_update->config.width
+		|| entry_to_update->native_height != entry_to_update->config.height;
+	for (const TCacheEntryBase* entry : s_partial_copies)
+		scaled |= entry->native_width != entry->config.width || entry->native_height != entry->config.height;
+	if (scaled)
+		ScaleTextureCacheEntryTo(&entry_to_update, Renderer::EFBToScaledX(entry_to_update->native_width), Renderer::EFBToScaledY(entry_to_update->native_height));
+
+	for (TCacheEntryBase* entry : s_partial_copies)
+	{
+		u32 src_x, src_y, dst_x, dst_y;
+		// Note for understanding the math:
+		// Normal textures can't be strided, so the 2 missing cases with src_x > 0 don't exist
+		if (entry->addr >= entry_to_update->addr)
+		{
+			u32 block_offset = (entry->addr - entry_to_update->addr) / block_size;
+			u32 block_x = block_offset % numBlocksX;
+			u32 block_y = block_offset / numBlocksX;
+			src_x = 0;
+			src_y = 0;
+			dst_x = block_x * block_width;
+			dst_y = block_y * block_height;
+		}
+		else
+		{
+			u32 block_offset = (entry_to_update->addr - entry->addr) / block_size;
+			u32 block_x = (~block_offset + 1) % numBlocksX;
+			u32 block_y = (block_offset + block_x) / numBlocksX;
+			src_x = 0;
+			src_y = block_y * block_height;
+			dst_x = block_x * block_width;
+			dst_y = 0;
+		}
+
+		u32 copy_width = std::min(entry->native_width - src_x, entry_to_update->native_width - dst_x);
+		u32 copy_height = std::min(entry->native_height - src_y, entry_to_update->native_height - dst_y);
+
+		TCacheEntryBase* source = entry;
+		if (isPaletteTexture)
+		{
+			// The conversion stays cached with the copy for other textures using the same palette
+			source = entry->ApplyPalette(tlutaddr, tlutfmt, palette_size);
+			if (!source)
+				continue;
+		}
+
+		if (scaled)
+		{
+			ScaleTextureCacheEntryTo(&source, Renderer::EFBToScaledX(source->native_width), Renderer::EFBToScaledY(source->native_height));
+			// Scaling replaces the copy itself, unless a conversion of it was scaled
+			if (!isPaletteTexture)
+				entry = source;
+
+			src_x = Renderer::EFBToScaledX(src_x);
+			src_y = Renderer::EFBToScaledY(src_y);
+			dst_x = Renderer::EFBToScaledX(dst_x);
+			dst_y = Renderer::EFBToScaledY(dst_y);
+			copy_width = Renderer::EFBToScaledX(copy_width);
+			copy_height = Renderer::EFBToScaledY(copy_height);
+		}
+
+		MathUtil::Rectangle<int> srcrect, dstrect;
+		srcrect.left = src_x;
+		srcrect.top = src_y;
+		srcrect.right = (src_x + copy_width);
+		srcrect.bottom = (src_y + copy_height);
+		dstrect.left = dst_x;
+		dstrect.top = dst_y;
+		dstrect.right = (dst_x + copy_width);
+		dstrect.bottom = (dst_y + copy_height);
+		entry_to_update->CopyRectangleFromTexture(source, srcrect, dstrect);
+
+		// Link the efb copy with the partially updated texture, so we won't apply this partial update again
+		entry->CreateReference(entry_to_update);
+		// Mark the texture update as used, as if it was loaded directly
+		MarkUsedThisFrame(entry);
+	}
 	return entry_to_update;
 }
 
@@ -452,6 +576,11 @@ void TextureCacheBase::DumpTexture(TCacheEntryBase* entry, std::string basename,
 	}
 	std::string filename = szDir + "/" + basename + ((entry->config.pcformat >= PC_TEX_FMT_DXT1) ? ".dds" : ".png");
 
+	// The name contains the hash, a texture that was dumped this session is skipped without
+	// touching the file system. The dump may still be queued for writing.
+	if (!s_dumped_textures.insert(filename).second)
+		return;
+
 	if (!File::Exists(filename))
 		entry->Save(filename, level);
 }
@@ -459,12 +588,21 @@ void TextureCacheBase::DumpTexture(TCacheEntryBase* entry, std::string basename,
 // Used by TextureCacheBase::Load
 TextureCacheBase::TCacheEntryBase* TextureCacheBase::ReturnEntry(u32 stage, TCacheEntryBase* entry)
 {
-	entry->frameCount = FRAMECOUNT_INVALID;
+	MarkUsedThisFrame(entry);
 	bound_textures[stage] = entry;
 	s_last_texture = std::max(s_last_texture, stage);
 	GFX_DEBUGGER_PAUSE_AT(NEXT_TEXTURE_CHANGE, true);
 	return entry;
 }
+void TextureCacheBase::MarkUsedThisFrame(TCacheEntryBase* entry)
+{
+	// Every entry with FRAMECOUNT_INVALID is in s_used_entries, so it only needs adding once
+	if (entry->frameCount == FRAMECOUNT_INVALID)
+		return;
+	entry->frameCount = FRAMECOUNT_INVALID;
+	s_used_entries.push_back(entry);
+}
+
 void TextureCacheBase::BindTextures()
 {
 	for (u32 i = 0; i <= s_last_texture; ++i)
@@ -481,6 +619,7 @@ void TextureCacheBase::UnbindTextures()
 
 TextureCacheBase::TCacheEntryBase* TextureCacheBase::Load(const u32 stage)
 {
+	TRACE_ZONE("TextureCacheBase::Load");
 	const FourTexUnits &tex = bpmem.tex[stage >> 2];
 	const u32 id = stage & 3;
 	const u32 address = (tex.texImage3[id].image_base/* & 0x1FFFFF*/) << 5;
@@ -555,8 +694,39 @@ TextureCacheBase::TCacheEntryBase* TextureCacheBase::Load(const u32 stage)
 	if (g_bRecordFifoData && !from_tmem)
 		FifoRecorder::GetInstance().UseMemory(address, texture_size + additional_mips_size, MemoryUpdate::TEXTURE_MAP);
 
+	if (!from_tmem)
+	{
+		FlushEFBCopies(address, texture_size + additional_mips_size);
+		FramebufferManagerBase::WriteBackVirtualXFB(address, texture_size + additional_mips_size);
+	}
+
+	// With write watches the hash of an entry stays valid as long as its pages weren't written,
+	// the range is only watched again and rehashed after a write.
+	const u32 watch_size = texture_size + additional_mips_size;
+	u64 watch_epoch = 0;
+	if (g_ActiveConfig.bTexCacheWriteWatch && !from_tmem)
+	{
+		auto watched_range = textures_by_address.equal_range((u64)address);
+		for (auto it = watched_range.first; it != watched_range.second; ++it)
+		{
+			const TCacheEntryBase* entry = it->second;
+			if (!entry->IsEfbCopy() && entry->watch_epoch != 0 && entry->watch_size == watch_size &&
+				(entry->format & 0xf) == texformat && entry->native_width == nativeW &&
+				entry->native_height == nativeH &&
+				!Memory::IsRangeModified(address, watch_size, entry->watch_epoch))
+			{
+				watch_epoch = entry->watch_epoch;
+				tex_hash = entry->base_hash;
+				break;
+			}
+		}
+		if (watch_epoch == 0)
+			watch_epoch = Memory::WatchRange(address, watch_size);
+	}
+
 	// TODO: This doesn't hash GB tiles for preloaded RGBA8 textures (instead, it's hashing more data from the low tmem bank than it should)	
-	tex_hash = GetHash64(src_data, texture_size, g_ActiveConfig.iSafeTextureCache_ColorSamples);
+	if (tex_hash == TEXHASH_INVALID)
+		tex_hash = GetHash64(src_data, texture_size, g_ActiveConfig.iSafeTextureCache_ColorSamples);
 	u32 palette_size = std::min(TexDecoder_GetPaletteSize(texformat), TMEM_SIZE - tlutaddr);
 	if (isPaletteTexture)
 	{
@@ -639,6 +809,11 @@ TextureCacheBase::TCacheEntryBase* TextureCacheBase::Load(const u32 stage)
 			if (entry->hash == (full_hash) && entry->format == full_format && entry->native_levels >= tex_levels &&
 				entry->native_width == nativeW && entry->native_height == nativeH)
 			{
+				if (watch_epoch != 0)
+				{
+					entry->watch_epoch = watch_epoch;
+					entry->watch_size = watch_size;
+				}
 				entry = DoPartialTextureUpdates(iter, tlutaddr, tlutfmt, palette_size);
 				return ReturnEntry(stage, entry);
 			}
@@ -659,8 +834,7 @@ TextureCacheBase::TCacheEntryBase* TextureCacheBase::Load(const u32 stage)
 	std::string basename;
 	if (unconverted_copy != textures_by_address.end())
 	{
-		g_texture_cache->LoadLut(tlutfmt, &texMem[tlutaddr], palette_size);
-		// Perform palette decoding.
+		// Perform palette decoding, the palette is only uploaded if there's no conversion with it yet.
 		TCacheEntryBase* decoded_entry = unconverted_copy->second->ApplyPalette(tlutaddr, tlutfmt, palette_size);
 
 		if (decoded_entry)
@@ -742,11 +916,33 @@ TextureCacheBase::TCacheEntryBase* TextureCacheBase::Load(const u32 stage)
 	// how many levels the allocated texture shall have
 	const u32 texLevels = hires_tex ? hires_tex->m_levels : tex_levels;
 
+	// Streamed custom textures start with the coarse levels, the finer ones follow over the
+	// next frames. The cached data is needed for the reloads.
+	u32 skipped_levels = 0;
+	if (hires_tex && texLevels > 1 && g_ActiveConfig.bStreamHiresTextures && g_ActiveConfig.bCacheHiresTextures)
+	{
+		auto skipped_iter = s_custom_texture_skipped_levels.find(basename);
+		if (skipped_iter != s_custom_texture_skipped_levels.end())
+		{
+			skipped_levels = std::min(skipped_iter->second, texLevels - 1);
+			s_custom_texture_skipped_levels.erase(skipped_iter);
+		}
+		else
+		{
+			while (skipped_levels + 1 < texLevels &&
+				std::max(TextureUtil::CalculateLevelSize(width, skipped_levels),
+					TextureUtil::CalculateLevelSize(height, skipped_levels)) > CUSTOM_TEXTURE_STREAMING_SIZE)
+			{
+				skipped_levels++;
+			}
+		}
+	}
+
 	// create the entry/texture
 	TCacheEntryConfig config;
-	config.width = width;
-	config.height = height;
-	config.levels = texLevels;
+	config.width = TextureUtil::CalculateLevelSize(width, skipped_levels);
+	config.height = TextureUtil::CalculateLevelSize(height, skipped_levels);
+	config.levels = texLevels - skipped_levels;
 	config.pcformat = pcfmt;
 	config.materialmap = hires_tex && hires_tex->m_nrm_levels && g_ActiveConfig.HiresMaterialMapsEnabled();
 	const bool use_scaling = (g_ActiveConfig.iTexScalingType > 0) && !hires_tex && (width < 384) && (height < 384);
@@ -769,31 +965,35 @@ TextureCacheBase::TCacheEntryBase* TextureCacheBase::Load(const u32 stage)
 	entry->SetGeneralParameters(address, texture_size, full_format);
 	entry->SetDimensions(nativeW, nativeH, tex_levels);
 	entry->SetHiresParams(!!hires_tex, basename, use_scaling, !!hires_tex && hires_tex->emissive_in_color);
+	if (entry->is_custom_tex)
+		s_custom_texture_memory_usage += entry->native_size_in_bytes;
 	entry->SetHashes(full_hash, tex_hash);
 	entry->is_efb_copy = false;
+	entry->skipped_levels = skipped_levels;
+	entry->watch_epoch = watch_epoch;
+	entry->watch_size = watch_size;
 
 	// load texture
 	if (hires_tex)
 	{
-		entry->Load(TextureCacheBase::temp, width, height, expandedWidth, 0);
+		// The levels are packed finest first, the skipped ones are stepped over
 		u8 *Bufferptr = TextureCacheBase::temp;
-		Bufferptr += TextureUtil::GetTextureSizeInBytes(width, height, pcfmt);
-		for (u32 level = 1; level != texLevels; ++level)
+		for (u32 level = 0; level != texLevels; ++level)
 		{
 			u32 mip_width = TextureUtil::CalculateLevelSize(width, level);
 			u32 mip_height = TextureUtil::CalculateLevelSize(height, level);
-			entry->Load(Bufferptr, mip_width, mip_height, mip_width, level);
+			if (level >= skipped_levels)
+				entry->Load(Bufferptr, mip_width, mip_height, mip_width, level - skipped_levels);
 			Bufferptr += TextureUtil::GetTextureSizeInBytes(mip_width, mip_height, pcfmt);
 		}
 		if (config.materialmap)
 		{
-			entry->LoadMaterialMap(Bufferptr, width, height, 0);
-			Bufferptr += TextureUtil::GetTextureSizeInBytes(width, height, pcfmt);
-			for (u32 level = 1; level != texLevels; ++level)
+			for (u32 level = 0; level != texLevels; ++level)
 			{
 				u32 mip_width = TextureUtil::CalculateLevelSize(width, level);
 				u32 mip_height = TextureUtil::CalculateLevelSize(height, level);
-				entry->LoadMaterialMap(Bufferptr, mip_width, mip_height, level);
+				if (level >= skipped_levels)
+					entry->LoadMaterialMap(Bufferptr, mip_width, mip_height, level - skipped_levels);
 				Bufferptr += TextureUtil::GetTextureSizeInBytes(mip_width, mip_height, pcfmt);
 			}
 		}
@@ -802,8 +1002,9 @@ TextureCacheBase::TCacheEntryBase* TextureCacheBase::Load(const u32 stage)
 	{
 		if (!(texformat == GX_TF_RGBA8 && from_tmem))
 		{
-			entry->Load(src_data, width, height, expandedWidth,
-				expandedHeight, texformat, tlutaddr, (TlutFormat)tlutfmt, 0);
+			if (!QueueAsyncDecode(entry, src_data, width, height, expandedWidth, expandedHeight, texformat, 0))
+				entry->Load(src_data, width, height, expandedWidth,
+					expandedHeight, texformat, tlutaddr, (TlutFormat)tlutfmt, 0);
 		}
 		else
 		{
@@ -835,8 +1036,12 @@ TextureCacheBase::TCacheEntryBase* TextureCacheBase::Load(const u32 stage)
 			const u8*& mip_src_data = from_tmem
 				? ((level % 2) ? ptr_odd : ptr_even)
 				: src_data;
-			entry->Load(mip_src_data, mip_width, mip_height, expanded_mip_width,
-				expanded_mip_height, texformat, tlutaddr, (TlutFormat)tlutfmt, level);
+			if (!QueueAsyncDecode(entry, mip_src_data, mip_width, mip_height, expanded_mip_width,
+				expanded_mip_height, texformat, level))
+			{
+				entry->Load(mip_src_data, mip_width, mip_height, expanded_mip_width,
+					expanded_mip_height, texformat, tlutaddr, (TlutFormat)tlutfmt, level);
+			}
 			mip_src_data += TexDecoder_GetTextureSizeInBytes(expanded_mip_width, expanded_mip_height, texformat);
 
 			if (g_ActiveConfig.bDumpTextures)
@@ -845,14 +1050,134 @@ TextureCacheBase::TCacheEntryBase* TextureCacheBase::Load(const u32 stage)
 	}
 
 	INCSTAT(stats.numTexturesCreated);
+	INCSTAT(stats.thisFrame.numTextureUploads);
 	SETSTAT(stats.numTexturesAlive, textures_by_address.size());
 	entry = DoPartialTextureUpdates(iter, tlutaddr, tlutfmt, palette_size);
 	return ReturnEntry(stage, entry);
 }
 
+void TextureCacheBase::ReloadStreamedTextures()
+{
+	std::vector<std::string> streamed = HiresTexture::GetStreamedTextures(
+		static_cast<size_t>(g_ActiveConfig.iHiresTextureUploadBudget) * 1024 * 1024);
+	if (streamed.empty())
+		return;
+
+	// Drop the entries using the native texture, the next use of each one finds the custom
+	// texture waiting in HiresTexture and uploads it.
+	std::unordered_set<std::string> names(streamed.begin(), streamed.end());
+	TexCache::iterator iter = textures_by_address.begin();
+	while (iter != textures_by_address.end())
+	{
+		TCacheEntryBase* entry = iter->second;
+		if (!entry->is_custom_tex && !entry->IsEfbCopy() && names.count(entry->basename))
+			iter = InvalidateTexture(iter);
+		else
+			++iter;
+	}
+}
+
+void TextureCacheBase::EnforceCustomTextureBudget(s32 frame_count)
+{
+	const size_t budget = static_cast<size_t>(g_ActiveConfig.iHiresTextureVRAMBudget) * 1024 * 1024;
+	if (s_custom_texture_memory_usage <= budget)
+		return;
+
+	// Drop the least recently used custom textures, the ones used this frame always stay. Among
+	// the ones last used within the same TEXTURE_CLEANUP_SWEEP_FRAMES frames the largest go first,
+	// they get the cache within the budget with the fewest reloads.
+	// The next use of a dropped texture uploads it again from HiresTexture.
+	std::vector<TCacheEntryBase*, ScratchMemory::FrameAllocator<TCacheEntryBase*>> candidates;
+	for (const auto& entry : textures_by_address)
+	{
+		if (entry.second->is_custom_tex && entry.second->frameCount < frame_count)
+			candidates.push_back(entry.second);
+	}
+	std::sort(candidates.begin(), candidates.end(), [](const TCacheEntryBase* a, const TCacheEntryBase* b) {
+		const s32 a_age = a->frameCount / TEXTURE_CLEANUP_SWEEP_FRAMES;
+		const s32 b_age = b->frameCount / TEXTURE_CLEANUP_SWEEP_FRAMES;
+		if (a_age != b_age)
+			return a_age < b_age;
+		return a->native_size_in_bytes > b->native_size_in_bytes;
+	});
+	for (TCacheEntryBase* entry : candidates)
+	{
+		if (s_custom_texture_memory_usage <= budget)
+			break;
+		InvalidateTexture(GetTexCacheIter(entry));
+	}
+}
+
+void TextureCacheBase::StreamCustomTextureLevels(s32 frame_count, const std::vector<TCacheEntryBase*>& used_entries)
+{
+	const size_t budget = static_cast<size_t>(g_ActiveConfig.iHiresTextureUploadBudget) * 1024 * 1024;
+	size_t upload_size = 0;
+	for (TCacheEntryBase* entry : used_entries)
+	{
+		// Only the textures in use are refined, one level per frame. The budget may have dropped some.
+		if (entry->skipped_levels == 0 || entry->frameCount != frame_count)
+			continue;
+		TexCache::iterator iter = GetTexCacheIter(entry);
+		if (iter == textures_by_address.end())
+			continue;
+		// Each level is four times larger than the next one
+		const size_t next_size = size_t(entry->native_size_in_bytes) * 4;
+		if (upload_size != 0 && upload_size + next_size > budget)
+			break;
+		upload_size += next_size;
+		s_custom_texture_skipped_levels[entry->basename] = entry->skipped_levels - 1;
+		InvalidateTexture(iter);
+	}
+}
+
+bool TextureCacheBase::QueueAsyncDecode(TCacheEntryBase* entry, const u8* src, u32 width, u32 height,
+	u32 expanded_width, u32 expanded_height, u32 texformat, u32 level)
+{
+#ifdef _WIN32
+	// The compute shader decoders don't need the round trip through host memory.
+	if (!g_ActiveConfig.bEnableOpenCL || entry->is_scaled || g_ActiveConfig.bDumpTextures ||
+		(g_ActiveConfig.bEnableComputeTextureDecoding && g_ActiveConfig.backend_info.bSupportsComputeTextureDecoding))
+		return false;
+
+	// The decoded data is uploaded as is, so it has to be in the format the texture was created with.
+	const bool rgba = entry->config.pcformat == PC_TEX_FMT_RGBA32;
+	if (TexDecoder_OpenCL_GetFormat(texformat, rgba) != entry->config.pcformat)
+		return false;
+
+	const u32 fence = TexDecoder_OpenCL_QueueDecode(src, expanded_width, expanded_height, texformat, rgba);
+	if (!fence)
+		return false;
+
+	s_pending_decodes.push_back({ entry, fence, width, height, expanded_width, level });
+	return true;
+#else
+	return false;
+#endif
+}
+
+void TextureCacheBase::UploadPendingDecodes()
+{
+#ifdef _WIN32
+	// Everything loaded for this draw was queued by now, submit it as one batch.
+	TexDecoder_OpenCL_Flush();
+	for (const PendingDecode& decode : s_pending_decodes)
+	{
+		const u8* data = TexDecoder_OpenCL_GetResult(decode.fence);
+		if (data)
+		{
+			decode.entry->Load(data, decode.width, decode.height, decode.expanded_width, decode.level);
+		}
+	}
+	s_pending_decodes.clear();
+	TexDecoder_OpenCL_ReleaseResults();
+#endif
+}
+
 void TextureCacheBase::CopyRenderTargetToTexture(u32 dstAddr, u32 dstFormat, u32 dstStride, PEControl::PixelFormat srcFormat,
 	const EFBRectangle& srcRect, bool isIntensity, bool scaleByHalf)
 {
+	SetGPUPass(GPU_PASS_EFB_COPY);
+
 	// Emulation methods:
 	// 
 	// - EFB to RAM:
@@ -1182,6 +1507,35 @@ void TextureCacheBase::CopyRenderTargetToTexture(u32 dstAddr, u32 dstFormat, u32
 		c_tex_h = Renderer::EFBToScaledY(c_tex_h);
 	}
 
+	// Only apply triggered post-processing on specific formats, to avoid false positives.
+	// Skip depth copies, single-channel textures (basically RGB565/RGB5A3/RGBA8 only)
+	if (g_ActiveConfig.backend_info.bSupportsPostProcessing && g_renderer->GetPostProcessor())
+	{
+		if (srcFormat != PEControl::Z24 && !isIntensity && dstFormat >= 4 && dstFormat <= 6)
+		{
+			const TargetRectangle targetSource = g_renderer->ConvertEFBRectangle(clampedRect);
+			g_renderer->GetPostProcessor()->OnEFBCopy(&targetSource);
+		}
+	}
+
+	// Some games repeat the same copy with nothing drawn in between, the texture of the last one
+	// still holds the result. Its RAM copy is still valid too unless the game wrote there since,
+	// a pending deferred copy will write it anyway.
+	const EFBCopyParams copy_params = { dstAddr, dstFormat, dstStride, srcFormat, srcRect, isIntensity,
+		scaleByHalf, bpmem.zcontrol.pixel_format, scaled_tex_w, scaled_tex_h };
+	const u64 efb_generation = FramebufferManagerBase::GetEFBGeneration();
+	if (s_last_efb_copy.entry && s_last_efb_copy.efb_generation == efb_generation &&
+		s_last_efb_copy.params == copy_params && !g_bRecordFifoData)
+	{
+		TCacheEntryBase* entry = s_last_efb_copy.entry;
+		if (entry->hash == TEXHASH_INVALID || entry->CalculateHash() == entry->hash)
+		{
+			INCSTAT(stats.thisFrame.numEFBCopiesReused);
+			return;
+		}
+	}
+	s_last_efb_copy.entry = nullptr;
+
 	// remove all texture cache entries at dstAddr
 	{
 		std::pair<TexCache::iterator, TexCache::iterator> iter_range = textures_by_address.equal_range((u64)dstAddr);
@@ -1218,15 +1572,14 @@ void TextureCacheBase::CopyRenderTargetToTexture(u32 dstAddr, u32 dstFormat, u32
 	}
 
 	bool copy_to_vram = true;
-	// Only apply triggered post-processing on specific formats, to avoid false positives.
-	// Skip depth copies, single-channel textures (basically RGB565/RGB5A3/RGBA8 only)
-	if (g_ActiveConfig.backend_info.bSupportsPostProcessing && g_renderer->GetPostProcessor())
+	const u32 copy_size = num_blocks_y * dstStride;
+	const bool defer_copy = copy_to_ram && g_ActiveConfig.bDeferEFBCopies &&
+		g_ActiveConfig.backend_info.bSupportsDeferredEFBCopies;
+	if (!s_deferred_efb_copies.empty() &&
+		(!defer_copy || s_deferred_efb_copies.size() >= MAX_DEFERRED_EFB_COPIES))
 	{
-		if (srcFormat != PEControl::Z24 && !isIntensity && dstFormat >= 4 && dstFormat <= 6)
-		{
-			const TargetRectangle targetSource = g_renderer->ConvertEFBRectangle(clampedRect);
-			g_renderer->GetPostProcessor()->OnEFBCopy(&targetSource);
-		}
+		// Keep the copies in order, a deferred one would overwrite this one otherwise
+		FlushEFBCopies();
 	}
 	if (copy_to_ram)
 	{
@@ -1241,6 +1594,8 @@ void TextureCacheBase::CopyRenderTargetToTexture(u32 dstAddr, u32 dstFormat, u32
 			srcRect,
 			isIntensity,
 			scaleByHalf);
+		if (defer_copy)
+			s_deferred_efb_copies.push_back({ dstAddr, copy_size, nullptr });
 	}
 	else
 	{
@@ -1313,14 +1668,24 @@ void TextureCacheBase::CopyRenderTargetToTexture(u32 dstAddr, u32 dstFormat, u32
 			entry->SetGeneralParameters(dstAddr, 0, baseFormat);
 			entry->SetDimensions(tex_w, tex_h, 1);
 
-			entry->frameCount = FRAMECOUNT_INVALID;
+			MarkUsedThisFrame(entry);
 			entry->SetEfbCopy(dstStride);
 			entry->is_custom_tex = false;
+			entry->watch_epoch = 0;
+			entry->hash_check_frame = 0;
 
 			entry->FromRenderTarget(dst, srcFormat, clampedRect, scaleByHalf, cbufid, colmat, c_tex_w, c_tex_h);
 
-			u64 hash = entry->CalculateHash();
-			entry->SetHashes(hash, hash);
+			if (defer_copy)
+			{
+				s_deferred_efb_copies.back().entry = entry;
+				entry->SetHashes(TEXHASH_INVALID, TEXHASH_INVALID);
+			}
+			else
+			{
+				u64 hash = entry->CalculateHash();
+				entry->SetHashes(hash, hash);
+			}
 
 			if (g_ActiveConfig.bDumpEFBTarget)
 			{
@@ -1330,6 +1695,36 @@ void TextureCacheBase::CopyRenderTargetToTexture(u32 dstAddr, u32 dstFormat, u32
 			}
 
 			textures_by_address.emplace((u64)dstAddr, entry);
+			s_last_efb_copy = { copy_params, efb_generation, entry };
+		}
+	}
+}
+
+void TextureCacheBase::FlushEFBCopies()
+{
+	if (s_deferred_efb_copies.empty())
+		return;
+
+	g_texture_cache->ReadbackDeferredEFBCopies();
+	for (const DeferredEFBCopy& copy : s_deferred_efb_copies)
+	{
+		if (copy.entry)
+		{
+			u64 hash = copy.entry->CalculateHash();
+			copy.entry->SetHashes(hash, hash);
+		}
+	}
+	s_deferred_efb_copies.clear();
+}
+
+void TextureCacheBase::FlushEFBCopies(u32 address, u32 size)
+{
+	for (const DeferredEFBCopy& copy : s_deferred_efb_copies)
+	{
+		if (copy.address < address + size && address < copy.address + copy.size)
+		{
+			FlushEFBCopies();
+			return;
 		}
 	}
 }
@@ -1348,6 +1743,8 @@ TextureCacheBase::TCacheEntryBase* TextureCacheBase::AllocateTexture(const TCach
 		texture_pool_memory_usage += config.GetSizeInBytes();
 		entry = g_texture_cache->CreateTexture(config);
 		INCSTAT(stats.numTexturesCreated);
+		// Created with FRAMECOUNT_INVALID
+		s_used_entries.push_back(entry);
 	}
 	entry->textures_by_hash_iter = textures_by_hash.end();
 	return entry;
@@ -1388,6 +1785,17 @@ TextureCacheBase::TexCache::iterator TextureCacheBase::InvalidateTexture(TexCach
 
 	TCacheEntryBase* entry = iter->second;
 
+	// Drop the levels still being decoded, the entry could be reused before they arrive.
+	s_pending_decodes.erase(std::remove_if(s_pending_decodes.begin(), s_pending_decodes.end(),
+		[entry](const PendingDecode& decode) { return decode.entry == entry; }), s_pending_decodes.end());
+	for (DeferredEFBCopy& copy : s_deferred_efb_copies)
+	{
+		if (copy.entry == entry)
+			copy.entry = nullptr;
+	}
+	if (s_last_efb_copy.entry == entry)
+		s_last_efb_copy.entry = nullptr;
+
 	if (entry->textures_by_hash_iter != textures_by_hash.end())
 	{
 		textures_by_hash.erase(entry->textures_by_hash_iter);
@@ -1396,7 +1804,13 @@ TextureCacheBase::TexCache::iterator TextureCacheBase::InvalidateTexture(TexCach
 
 	entry->DestroyAllReferences();
 
-	entry->frameCount = FRAMECOUNT_INVALID;
+	if (entry->is_custom_tex)
+	{
+		s_custom_texture_memory_usage -= entry->native_size_in_bytes;
+		entry->is_custom_tex = false;
+	}
+
+	MarkUsedThisFrame(entry);
 
 	texture_pool.emplace(entry->config, entry);
 	return textures_by_address.erase(iter);
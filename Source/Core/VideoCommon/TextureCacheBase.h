@@ -8,6 +8,7 @@
 #include <tuple>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "Common/CommonTypes.h"
 #include "Common/Thread.h"
@@ -26,7 +27,18 @@ enum TextureCacheParams
 	TEXTURE_KILL_MULTIPLIER = 2,
 	TEXTURE_KILL_THRESHOLD = 120,
 	TEXTURE_POOL_KILL_THRESHOLD = 3,
-	TEXTURE_POOL_MEMORY_LIMIT = 64 * 1024 * 1024
+	TEXTURE_POOL_MEMORY_LIMIT = 64 * 1024 * 1024,
+	// Unused textures freed per frame while the pool is within its memory limit, so scenes with a
+	// lot of texture churn don't recreate the same textures every few frames
+	TEXTURE_POOL_MAX_FREES_PER_FRAME = 8,
+	// Cleanup ages a slice of the cache per frame, at least this many entries and enough to sweep
+	// the whole cache every TEXTURE_CLEANUP_SWEEP_FRAMES frames
+	TEXTURE_CLEANUP_MIN_ENTRIES = 256,
+	TEXTURE_CLEANUP_SWEEP_FRAMES = 16,
+	// Deferred EFB copies in flight before they are all read back
+	MAX_DEFERRED_EFB_COPIES = 8,
+	// Streamed custom textures are first uploaded with the levels up to this size
+	CUSTOM_TEXTURE_STREAMING_SIZE = 128
 };
 
 class TextureCacheBase
@@ -55,6 +67,8 @@ public:
 				break;
 			case PC_TEX_FMT_DXT3:
 			case PC_TEX_FMT_DXT5:
+			case PC_TEX_FMT_BC5:
+			case PC_TEX_FMT_BC7:
 				result = ((width + 3) >> 2)*((height + 3) >> 2) * 16;
 				break;
 			default:
@@ -114,8 +128,15 @@ public:
 		u32 memory_stride = {};
 		u32 native_width = {}, native_height = {}; // Texture dimensions from the GameCube's point of view
 		u32 native_levels = {};
+		// Finest levels of the custom texture not uploaded yet, they are streamed in later
+		u32 skipped_levels = {};
+		// Write watch of the source range, 0 if the hash has to be checked on every load
+		u64 watch_epoch = {};
+		u32 watch_size = {};
 		// used to delete textures which haven't been used for TEXTURE_KILL_THRESHOLD frames
 		s32 frameCount = {};
+		// Frame the hash of the EFB copy was last checked on while it was unused
+		s32 hash_check_frame = {};
 		u64 hash = {};
 		u64 base_hash = {};
 
@@ -223,6 +244,9 @@ public:
 	// frameCount is the current frame number.
 	static void Cleanup(int frameCount);
 	static void Invalidate();
+	// Keeps the decoded textures for after a state load. EFB copies are dropped because their
+	// contents come from the GPU, every other entry hashes its source again on the next use.
+	static void Revalidate();
 
 	virtual PC_TexFormat GetNativeTextureFormat(const s32 texformat,
 		const TlutFormat tlutfmt, u32 width, u32 height) = 0;
@@ -232,16 +256,25 @@ public:
 		PEControl::PixelFormat srcFormat, const EFBRectangle& srcRect,
 		bool isIntensity, bool scaleByHalf) = 0;
 
+	// Completes the copies CopyEFB deferred with bDeferEFBCopies, in the order they were made.
+	// Called with at most MAX_DEFERRED_EFB_COPIES of them pending.
+	virtual void ReadbackDeferredEFBCopies() {}
+
 	virtual bool CompileShaders() = 0; // currently only implemented by OGL
 	virtual void DeleteShaders() = 0; // currently only implemented by OGL
 
 	virtual void LoadLut(u32 lutFmt, void* addr, u32 size) = 0;
 
 	static TCacheEntryBase* Load(const u32 stage);
+	// Uploads the levels decoded asynchronously by OpenCL, called before the textures are used.
+	static void UploadPendingDecodes();
 	static void UnbindTextures();
 	virtual void BindTextures();
 	static void CopyRenderTargetToTexture(u32 dstAddr, u32 dstFormat, u32 dstStride,
 		PEControl::PixelFormat srcFormat, const EFBRectangle& srcRect, bool isIntensity, bool scaleByHalf);
+	// Writes the deferred EFB copies to RAM, all of them or only if one overlaps the range.
+	static void FlushEFBCopies();
+	static void FlushEFBCopies(u32 address, u32 size);
 
 protected:
 	alignas(16) static u8 *temp;
@@ -261,13 +294,82 @@ private:
 	static TexCache::iterator GetTexCacheIter(TCacheEntryBase* entry);
 	static TexCache::iterator InvalidateTexture(TexCache::iterator t_iter);
 	static TCacheEntryBase* ReturnEntry(u32 stage, TCacheEntryBase* entry);
-
+	// Sets frameCount to FRAMECOUNT_INVALID, the next Cleanup stamps it with the frame number
+	static void MarkUsedThisFrame(TCacheEntryBase* entry);
+	static bool QueueAsyncDecode(TCacheEntryBase* entry, const u8* src, u32 width, u32 height,
+		u32 expanded_width, u32 expanded_height, u32 texformat, u32 level);
+	// Swaps in the custom textures streamed in by HiresTexture, within the upload budget.
+	static void ReloadStreamedTextures();
+	// Keeps the custom textures in the cache within iHiresTextureVRAMBudget.
+	static void EnforceCustomTextureBudget(s32 frame_count);
+	// Reloads the custom textures used this frame that were uploaded without their finest levels
+	// with one more level.
+	static void StreamCustomTextureLevels(s32 frame_count, const std::vector<TCacheEntryBase*>& used_entries);
+
+	struct PendingDecode
+	{
+		TCacheEntryBase* entry;
+		u32 fence;
+		u32 width;
+		u32 height;
+		u32 expanded_width;
+		u32 level;
+	};
+	static std::vector<PendingDecode> s_pending_decodes;
+	struct DeferredEFBCopy
+	{
+		u32 address;
+		u32 size;
+		// EFB copy entry hashed once the copy is in RAM
+		TCacheEntryBase* entry;
+	};
+	static std::vector<DeferredEFBCopy> s_deferred_efb_copies;
+	// What an EFB copy depends on besides the EFB contents
+	struct EFBCopyParams
+	{
+		u32 dst_address;
+		u32 dst_format;
+		u32 dst_stride;
+		PEControl::PixelFormat src_format;
+		EFBRectangle src_rect;
+		bool is_intensity;
+		bool scale_by_half;
+		PEControl::PixelFormat efb_format;
+		u32 scaled_width;
+		u32 scaled_height;
+
+		bool operator==(const EFBCopyParams& o) const
+		{
+			return std::tie(dst_address, dst_format, dst_stride, src_format, src_rect, is_intensity,
+				scale_by_half, efb_format, scaled_width, scaled_height) ==
+				std::tie(o.dst_address, o.dst_format, o.dst_stride, o.src_format, o.src_rect, o.is_intensity,
+					o.scale_by_half, o.efb_format, o.scaled_width, o.scaled_height);
+		}
+	};
+	// The last EFB copy to VRAM, reused by an identical copy while the EFB is unchanged
+	struct LastEFBCopy
+	{
+		EFBCopyParams params;
+		u64 efb_generation;
+		TCacheEntryBase* entry;
+	};
+	static LastEFBCopy s_last_efb_copy;
+	// Levels to skip on the next load of the custom textures being streamed in
+	static std::unordered_map<std::string, u32> s_custom_texture_skipped_levels;
+	// Names of the textures dumped since the texture cache was created
+	static std::unordered_set<std::string> s_dumped_textures;
 
 
 	static TexCache textures_by_address;
 	static TexCache textures_by_hash;
 	static TexPool texture_pool;
 	static size_t texture_pool_memory_usage;
+	// Size of the custom textures in textures_by_address
+	static size_t s_custom_texture_memory_usage;
+	// Entries marked with FRAMECOUNT_INVALID since the last Cleanup, which only stamps these
+	static std::vector<TCacheEntryBase*> s_used_entries;
+	// Address Cleanup resumes aging the cache at
+	static u64 s_cleanup_address;
 	
 	static u32 s_last_texture;
 
@@ -3,6 +3,8 @@
 // Refer to the license.txt file included.
 
 #pragma once
+#include <string>
+
 #include "Common/CommonTypes.h"
 #include "VideoCommon/TextureDecoder.h"
 #include "VideoCommon/VideoCommon.h"
@@ -52,4 +54,20 @@ void SetShaderParameters(float width, float height, float offsetX, float offsetY
 namespace TextureConversionShader
 {
 const char *GenerateEncodingShader(u32 format, API_TYPE ApiType = API_OPENGL);
+
+// Compute shaders decode one texel per invocation, dispatched in square groups of this size.
+const u32 DECODING_SHADER_GROUP_SIZE = 8;
+
+bool IsDecodingShaderSupported(u32 format);
+
+// Generates a GLSL compute shader which decodes the raw texture data in a R8UI texel buffer
+// straight into a RGBA8 image. Paletted formats read their TLUT from a R16UI texel buffer.
+std::string GenerateDecodingShader(u32 format, TlutFormat palette_format, API_TYPE ApiType);
+
+// Scaling shaders run one invocation per source texel, in groups of the same size.
+bool IsScalingShaderSupported(int scaling_type, int factor);
+
+// Generates a GLSL compute shader which upscales RGBA8 texels read from a texel buffer with one
+// of the TextureScaler filters, storing the result into a RGBA8 image factor times larger.
+std::string GenerateScalingShader(int scaling_type, int factor, API_TYPE ApiType);
 }
\ No newline at end of file
@@ -2,15 +2,19 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <cmath>
 #include <cstdio>
+#include <string>
 
 #include "Common/CommonTypes.h"
 #include "Common/MathUtil.h"
 #include "Common/MsgHandler.h"
+#include "Common/StringUtil.h"
 #include "VideoCommon/RenderBase.h"
 #include "VideoCommon/TextureConversionShader.h"
 #include "VideoCommon/TextureDecoder.h"
+#include "VideoCommon/TextureScalerCommon.h"
 #include "VideoCommon/VideoCommon.h"
 
 #define WRITE p += sprintf
@@ -666,4 +670,875 @@ const char* GenerateEncodingShader(u32 format, API_TYPE ApiType)
 	return text;
 }
 
+bool IsDecodingShaderSupported(u32 format)
+{
+	switch (format)
+	{
+	case GX_TF_I4:
+	case GX_TF_I8:
+	case GX_TF_IA4:
+	case GX_TF_IA8:
+	case GX_TF_RGB565:
+	case GX_TF_RGB5A3:
+	case GX_TF_RGBA8:
+	case GX_TF_C4:
+	case GX_TF_C8:
+	case GX_TF_C14X2:
+	case GX_TF_CMPR:
+		return true;
+	default:
+		return false;
+	}
+}
+
+static const char DECODING_SHADER_COMMON[] = R"(
+uint ReadByte(int offset)
+{
+  return texelFetch(s_raw_data, params.x + offset).r;
+}
+uint ReadShort(int offset)
+{
+  return (ReadByte(offset) << 8) | ReadByte(offset + 1);
+}
+uint Convert3To8(uint v)
+{
+  return (v << 5) | (v << 2) | (v >> 1);
+}
+uint Convert4To8(uint v)
+{
+  return (v << 4) | v;
+}
+uint Convert5To8(uint v)
+{
+  return (v << 3) | (v >> 2);
+}
+uint Convert6To8(uint v)
+{
+  return (v << 2) | (v >> 4);
+}
+uint4 DecodeIA8(uint val)
+{
+  uint i = val & 0xFFu;
+  return uint4(i, i, i, val >> 8);
+}
+uint4 DecodeRGB565(uint val)
+{
+  return uint4(Convert5To8((val >> 11) & 0x1Fu), Convert6To8((val >> 5) & 0x3Fu),
+               Convert5To8(val & 0x1Fu), 0xFFu);
+}
+uint4 DecodeRGB5A3(uint val)
+{
+  if ((val & 0x8000u) != 0u)
+  {
+    return uint4(Convert5To8((val >> 10) & 0x1Fu), Convert5To8((val >> 5) & 0x1Fu),
+                 Convert5To8(val & 0x1Fu), 0xFFu);
+  }
+  return uint4(Convert4To8((val >> 8) & 0xFu), Convert4To8((val >> 4) & 0xFu),
+               Convert4To8(val & 0xFu), Convert3To8((val >> 12) & 0x7u));
+}
+uint4 ReadPalette(uint index)
+{
+  uint val = texelFetch(s_palette, params.z + int(index)).r;
+  return DECODE_PALETTE(((val & 0xFFu) << 8) | (val >> 8));
+}
+)";
+
+// Each function decodes the texel at the given position within the block starting at offset.
+static const char* GetDecodingFunction(u32 format)
+{
+	switch (format)
+	{
+	case GX_TF_I4:
+	case GX_TF_C4:
+		return R"(
+uint ReadNibble(int offset, int2 texel)
+{
+  uint val = ReadByte(offset + texel.y * 4 + texel.x / 2);
+  return (texel.x & 1) != 0 ? (val & 0xFu) : (val >> 4);
+}
+uint4 DecodeTexel(int offset, int2 texel)
+{
+#if IS_PALETTED
+  return ReadPalette(ReadNibble(offset, texel));
+#else
+  uint i = Convert4To8(ReadNibble(offset, texel));
+  return uint4(i, i, i, i);
+#endif
+}
+)";
+	case GX_TF_I8:
+	case GX_TF_C8:
+		return R"(
+uint4 DecodeTexel(int offset, int2 texel)
+{
+  uint val = ReadByte(offset + texel.y * 8 + texel.x);
+#if IS_PALETTED
+  return ReadPalette(val);
+#else
+  return uint4(val, val, val, val);
+#endif
+}
+)";
+	case GX_TF_IA4:
+		return R"(
+uint4 DecodeTexel(int offset, int2 texel)
+{
+  uint val = ReadByte(offset + texel.y * 8 + texel.x);
+  uint i = Convert4To8(val & 0xFu);
+  return uint4(i, i, i, Convert4To8(val >> 4));
+}
+)";
+	case GX_TF_IA8:
+		return R"(
+uint4 DecodeTexel(int offset, int2 texel)
+{
+  return DecodeIA8(ReadShort(offset + (texel.y * 4 + texel.x) * 2));
+}
+)";
+	case GX_TF_RGB565:
+		return R"(
+uint4 DecodeTexel(int offset, int2 texel)
+{
+  return DecodeRGB565(ReadShort(offset + (texel.y * 4 + texel.x) * 2));
+}
+)";
+	case GX_TF_RGB5A3:
+		return R"(
+uint4 DecodeTexel(int offset, int2 texel)
+{
+  return DecodeRGB5A3(ReadShort(offset + (texel.y * 4 + texel.x) * 2));
+}
+)";
+	case GX_TF_C14X2:
+		return R"(
+uint4 DecodeTexel(int offset, int2 texel)
+{
+  return ReadPalette(ReadShort(offset + (texel.y * 4 + texel.x) * 2) & 0x3FFFu);
+}
+)";
+	case GX_TF_RGBA8:
+		// The AR pairs are stored in the first 32 bytes of the block, the GB pairs in the second.
+		return R"(
+uint4 DecodeTexel(int offset, int2 texel)
+{
+  int ar = offset + (texel.y * 4 + texel.x) * 2;
+  return uint4(ReadByte(ar + 1), ReadByte(ar + 32), ReadByte(ar + 33), ReadByte(ar));
+}
+)";
+	case GX_TF_CMPR:
+		// Four DXT1 sub-blocks, blended the same way as decodeDXTBlock.
+		return R"(
+int3 ExpandRGB565(uint val)
+{
+  return int3(DecodeRGB565(val).rgb);
+}
+uint4 DecodeTexel(int offset, int2 texel)
+{
+  offset += ((texel.y >> 2) * 2 + (texel.x >> 2)) * 8;
+  uint c1 = ReadShort(offset);
+  uint c2 = ReadShort(offset + 2);
+  uint line = ReadByte(offset + 4 + (texel.y & 3));
+  uint index = (line >> (6 - (texel.x & 3) * 2)) & 3u;
+
+  int3 color1 = ExpandRGB565(c1);
+  int3 color2 = ExpandRGB565(c2);
+  if (index == 0u)
+    return uint4(color1, 0xFF);
+  if (c1 > c2)
+  {
+    int3 delta = color2 - color1;
+    int3 third = (delta >> 1) - (delta >> 3);
+    return uint4(index == 1u ? color2 : (index == 2u ? color1 + third : color2 - third), 0xFF);
+  }
+  if (index == 2u)
+    return uint4((color1 + color2 + 1) / 2, 0xFF);
+  return uint4(color2, index == 1u ? 0xFF : 0);
+}
+)";
+	default:
+		return nullptr;
+	}
+}
+
+std::string GenerateDecodingShader(u32 format, TlutFormat palette_format, API_TYPE ApiType)
+{
+	const char* decode_func = GetDecodingFunction(format);
+	if (!decode_func)
+		return "";
+
+	static const char* const palette_functions[] = { "DecodeIA8", "DecodeRGB565", "DecodeRGB5A3" };
+	const bool paletted = format == GX_TF_C4 || format == GX_TF_C8 || format == GX_TF_C14X2;
+	const u32 block_size = format == GX_TF_RGBA8 ? 64 : 32;
+
+	// params: source offset in bytes, blocks per row, palette offset in entries
+	// dimensions: size of the decoded level in texels
+	std::string source;
+	if (ApiType == API_VULKAN)
+	{
+		source +=
+			"layout(std140, push_constant) uniform PCBlock { int4 params; int4 dimensions; } PC;\n"
+			"#define params PC.params\n"
+			"#define dimensions PC.dimensions\n"
+			"layout(set = 0, binding = 0) uniform usamplerBuffer s_raw_data;\n"
+			"layout(set = 0, binding = 1) uniform usamplerBuffer s_palette;\n"
+			"layout(set = 0, binding = 2, rgba8) uniform writeonly image2D s_output;\n";
+	}
+	else
+	{
+		source +=
+			"uniform int4 params;\n"
+			"uniform int4 dimensions;\n"
+			"#define s_raw_data samp9\n"
+			"#define s_palette samp10\n"
+			"SAMPLER_BINDING(9) uniform usamplerBuffer samp9;\n"
+			"SAMPLER_BINDING(10) uniform usamplerBuffer samp10;\n"
+			"layout(rgba8) uniform writeonly image2D s_output;\n";
+	}
+
+	source += StringFromFormat(
+		"layout(local_size_x = %u, local_size_y = %u) in;\n"
+		"#define BLOCK_WIDTH %u\n"
+		"#define BLOCK_HEIGHT %u\n"
+		"#define BLOCK_SIZE %u\n"
+		"#define IS_PALETTED %d\n"
+		"#define DECODE_PALETTE %s\n",
+		DECODING_SHADER_GROUP_SIZE, DECODING_SHADER_GROUP_SIZE,
+		TexDecoder_GetBlockWidthInTexels(format), TexDecoder_GetBlockHeightInTexels(format),
+		block_size, paletted ? 1 : 0,
+		palette_functions[std::min<u32>(palette_format, GX_TL_RGB5A3)]);
+	source += DECODING_SHADER_COMMON;
+	source += decode_func;
+	source += R"(
+void main()
+{
+  int2 coords = int2(gl_GlobalInvocationID.xy);
+  if (coords.x >= dimensions.x || coords.y >= dimensions.y)
+    return;
+
+  int2 block = coords / int2(BLOCK_WIDTH, BLOCK_HEIGHT);
+  int2 texel = coords - block * int2(BLOCK_WIDTH, BLOCK_HEIGHT);
+  int offset = (block.y * params.y + block.x) * BLOCK_SIZE;
+  imageStore(s_output, coords, float4(DecodeTexel(offset, texel)) / 255.0);
+}
+)";
+	return source;
+}
+
+bool IsScalingShaderSupported(int scaling_type, int factor)
+{
+	if (factor < 2 || factor > 5)
+		return false;
+
+	switch (scaling_type)
+	{
+	case TextureScaler::XBRZ:
+	case TextureScaler::HYBRID:
+	case TextureScaler::DDT:
+		return true;
+	default:
+		return false;
+	}
+}
+
+static const char SCALING_SHADER_COMMON[] = R"(
+float4 Fetch(int2 coords)
+{
+  coords = clamp(coords, int2(0, 0), dimensions.xy - 1);
+  return round(texelFetch(s_input, params.x + coords.y * params.y + coords.x) * 255.0);
+}
+void Store(int2 coords, float4 color)
+{
+  imageStore(s_output, coords, color / 255.0);
+}
+)";
+
+// Port of Externals/xbrz with its default configuration, the blend types of the four corners
+// are worked out from the 5x5 neighbourhood instead of a buffer carried along each row.
+static const char SCALING_SHADER_XBRZ[] = R"(
+#define EQUAL_COLOR_TOLERANCE 30.0
+#define DOMINANT_DIRECTION_THRESHOLD 3.6
+#define STEEP_DIRECTION_THRESHOLD 2.2
+
+float4 neighbourhood[25];
+float4 scaled[SCALE * SCALE];
+
+float4 Src(int x, int y)
+{
+  return neighbourhood[(y + 2) * 5 + x + 2];
+}
+float DistYCbCr(float4 pix1, float4 pix2)
+{
+  // The CPU version looks the distance up in a table, which halves the precision of the deltas.
+  float3 diff = floor((pix1.rgb - pix2.rgb + 255.0) / 2.0) * 2.0 - 255.0;
+  float y = dot(diff, float3(0.2627, 0.6780, 0.0593));
+  float c_b = (diff.b - y) * (0.5 / (1.0 - 0.0593));
+  float c_r = (diff.r - y) * (0.5 / (1.0 - 0.2627));
+  return sqrt(y * y + c_b * c_b + c_r * c_r);
+}
+float ColorDist(float4 pix1, float4 pix2)
+{
+  float a1 = pix1.a / 255.0;
+  float a2 = pix2.a / 255.0;
+  float d = DistYCbCr(pix1, pix2);
+  return a1 > a2 ? a2 * d + 255.0 * (a1 - a2) : a1 * d + 255.0 * (a2 - a1);
+}
+bool ColorEq(float4 pix1, float4 pix2)
+{
+  return ColorDist(pix1, pix2) < EQUAL_COLOR_TOLERANCE;
+}
+
+// Blend types (0 none, 1 normal, 2 dominant) of the F, G, J and K corners of the 4x4 kernel
+// A-P, with F at the given offset.
+uint4 PreProcessCorners(int x, int y)
+{
+  float4 b = Src(x, y - 1), c = Src(x + 1, y - 1);
+  float4 e = Src(x - 1, y), f = Src(x, y), g = Src(x + 1, y), h = Src(x + 2, y);
+  float4 i = Src(x - 1, y + 1), j = Src(x, y + 1), k = Src(x + 1, y + 1), l = Src(x + 2, y + 1);
+  float4 n = Src(x, y + 2), o = Src(x + 1, y + 2);
+
+  uint4 result = uint4(0u, 0u, 0u, 0u);
+  if ((f == g && j == k) || (f == j && g == k))
+    return result;
+
+  float jg = ColorDist(i, f) + ColorDist(f, c) + ColorDist(n, k) + ColorDist(k, h) + 4.0 * ColorDist(j, g);
+  float fk = ColorDist(e, j) + ColorDist(j, o) + ColorDist(b, g) + ColorDist(g, l) + 4.0 * ColorDist(f, k);
+  if (jg < fk)
+  {
+    uint type = DOMINANT_DIRECTION_THRESHOLD * jg < fk ? 2u : 1u;
+    if (f != g && f != j)
+      result.x = type;
+    if (k != j && k != g)
+      result.w = type;
+  }
+  else if (fk < jg)
+  {
+    uint type = DOMINANT_DIRECTION_THRESHOLD * fk < jg ? 2u : 1u;
+    if (j != f && j != k)
+      result.z = type;
+    if (g != f && g != k)
+      result.y = type;
+  }
+  return result;
+}
+
+// The 3x3 kernel and the output block, rotated clockwise by rot * 90 degrees.
+float4 Kernel(int x, int y, int rot)
+{
+  for (int r = 0; r < rot; r++)
+  {
+    int t = x;
+    x = y;
+    y = -t;
+  }
+  return Src(x, y);
+}
+int BlockIndex(int i, int j, int rot)
+{
+  for (int r = 0; r < rot; r++)
+  {
+    int t = i;
+    i = SCALE - 1 - j;
+    j = t;
+  }
+  return i * SCALE + j;
+}
+void Blend(int rot, int i, int j, int n, int m, float4 col)
+{
+  int index = BlockIndex(i, j, rot);
+  scaled[index] = floor((col * float(n) + scaled[index] * float(m - n) + 0.5) / float(m));
+}
+void Set(int rot, int i, int j, float4 col)
+{
+  scaled[BlockIndex(i, j, rot)] = col;
+}
+
+#if SCALE == 2
+void BlendLineShallow(int rot, float4 col)
+{
+  Blend(rot, 1, 0, 1, 4, col);
+  Blend(rot, 1, 1, 3, 4, col);
+}
+void BlendLineSteep(int rot, float4 col)
+{
+  Blend(rot, 0, 1, 1, 4, col);
+  Blend(rot, 1, 1, 3, 4, col);
+}
+void BlendLineSteepAndShallow(int rot, float4 col)
+{
+  Blend(rot, 1, 0, 1, 4, col);
+  Blend(rot, 0, 1, 1, 4, col);
+  Blend(rot, 1, 1, 5, 6, col);
+}
+void BlendLineDiagonal(int rot, float4 col)
+{
+  Blend(rot, 1, 1, 1, 2, col);
+}
+void BlendCorner(int rot, float4 col)
+{
+  Blend(rot, 1, 1, 21, 100, col);
+}
+#elif SCALE == 3
+void BlendLineShallow(int rot, float4 col)
+{
+  Blend(rot, 2, 0, 1, 4, col);
+  Blend(rot, 1, 2, 1, 4, col);
+  Blend(rot, 2, 1, 3, 4, col);
+  Set(rot, 2, 2, col);
+}
+void BlendLineSteep(int rot, float4 col)
+{
+  Blend(rot, 0, 2, 1, 4, col);
+  Blend(rot, 2, 1, 1, 4, col);
+  Blend(rot, 1, 2, 3, 4, col);
+  Set(rot, 2, 2, col);
+}
+void BlendLineSteepAndShallow(int rot, float4 col)
+{
+  Blend(rot, 2, 0, 1, 4, col);
+  Blend(rot, 0, 2, 1, 4, col);
+  Blend(rot, 2, 1, 3, 4, col);
+  Blend(rot, 1, 2, 3, 4, col);
+  Set(rot, 2, 2, col);
+}
+void BlendLineDiagonal(int rot, float4 col)
+{
+  Blend(rot, 1, 2, 1, 8, col);
+  Blend(rot, 2, 1, 1, 8, col);
+  Blend(rot, 2, 2, 7, 8, col);
+}
+void BlendCorner(int rot, float4 col)
+{
+  Blend(rot, 2, 2, 45, 100, col);
+}
+#elif SCALE == 4
+void BlendLineShallow(int rot, float4 col)
+{
+  Blend(rot, 3, 0, 1, 4, col);
+  Blend(rot, 2, 2, 1, 4, col);
+  Blend(rot, 3, 1, 3, 4, col);
+  Blend(rot, 2, 3, 3, 4, col);
+  Set(rot, 3, 2, col);
+  Set(rot, 3, 3, col);
+}
+void BlendLineSteep(int rot, float4 col)
+{
+  Blend(rot, 0, 3, 1, 4, col);
+  Blend(rot, 2, 2, 1, 4, col);
+  Blend(rot, 1, 3, 3, 4, col);
+  Blend(rot, 3, 2, 3, 4, col);
+  Set(rot, 2, 3, col);
+  Set(rot, 3, 3, col);
+}
+void BlendLineSteepAndShallow(int rot, float4 col)
+{
+  Blend(rot, 3, 1, 3, 4, col);
+  Blend(rot, 1, 3, 3, 4, col);
+  Blend(rot, 3, 0, 1, 4, col);
+  Blend(rot, 0, 3, 1, 4, col);
+  Blend(rot, 2, 2, 1, 3, col);
+  Set(rot, 3, 3, col);
+  Set(rot, 3, 2, col);
+  Set(rot, 2, 3, col);
+}
+void BlendLineDiagonal(int rot, float4 col)
+{
+  Blend(rot, 3, 2, 1, 2, col);
+  Blend(rot, 2, 3, 1, 2, col);
+  Set(rot, 3, 3, col);
+}
+void BlendCorner(int rot, float4 col)
+{
+  Blend(rot, 3, 3, 68, 100, col);
+  Blend(rot, 3, 2, 9, 100, col);
+  Blend(rot, 2, 3, 9, 100, col);
+}
+#else
+void BlendLineShallow(int rot, float4 col)
+{
+  Blend(rot, 4, 0, 1, 4, col);
+  Blend(rot, 3, 2, 1, 4, col);
+  Blend(rot, 2, 4, 1, 4, col);
+  Blend(rot, 4, 1, 3, 4, col);
+  Blend(rot, 3, 3, 3, 4, col);
+  Set(rot, 4, 2, col);
+  Set(rot, 4, 3, col);
+  Set(rot, 4, 4, col);
+  Set(rot, 3, 4, col);
+}
+void BlendLineSteep(int rot, float4 col)
+{
+  Blend(rot, 0, 4, 1, 4, col);
+  Blend(rot, 2, 3, 1, 4, col);
+  Blend(rot, 4, 2, 1, 4, col);
+  Blend(rot, 1, 4, 3, 4, col);
+  Blend(rot, 3, 3, 3, 4, col);
+  Set(rot, 2, 4, col);
+  Set(rot, 3, 4, col);
+  Set(rot, 4, 4, col);
+  Set(rot, 4, 3, col);
+}
+void BlendLineSteepAndShallow(int rot, float4 col)
+{
+  Blend(rot, 0, 4, 1, 4, col);
+  Blend(rot, 2, 3, 1, 4, col);
+  Blend(rot, 1, 4, 3, 4, col);
+  Blend(rot, 4, 0, 1, 4, col);
+  Blend(rot, 3, 2, 1, 4, col);
+  Blend(rot, 4, 1, 3, 4, col);
+  Set(rot, 2, 4, col);
+  Set(rot, 3, 4, col);
+  Set(rot, 4, 2, col);
+  Set(rot, 4, 3, col);
+  Set(rot, 4, 4, col);
+  Blend(rot, 3, 3, 2, 3, col);
+}
+void BlendLineDiagonal(int rot, float4 col)
+{
+  Blend(rot, 4, 2, 1, 8, col);
+  Blend(rot, 3, 3, 1, 8, col);
+  Blend(rot, 2, 4, 1, 8, col);
+  Blend(rot, 4, 3, 7, 8, col);
+  Blend(rot, 3, 4, 7, 8, col);
+  Set(rot, 4, 4, col);
+}
+void BlendCorner(int rot, float4 col)
+{
+  Blend(rot, 4, 4, 86, 100, col);
+  Blend(rot, 4, 3, 23, 100, col);
+  Blend(rot, 3, 4, 23, 100, col);
+}
+#endif
+
+// corners holds the top left, top right, bottom right and bottom left blend types.
+void ScalePixel(int rot, uint4 corners)
+{
+  uint top_right = corners[(1 - rot) & 3];
+  uint bottom_right = corners[(2 - rot) & 3];
+  uint bottom_left = corners[(3 - rot) & 3];
+  if (bottom_right == 0u)
+    return;
+
+  float4 b = Kernel(0, -1, rot), c = Kernel(1, -1, rot);
+  float4 d = Kernel(-1, 0, rot), e = Kernel(0, 0, rot), f = Kernel(1, 0, rot);
+  float4 g = Kernel(-1, 1, rot), h = Kernel(0, 1, rot), i = Kernel(1, 1, rot);
+
+  bool line_blend = true;
+  if (bottom_right < 2u)
+  {
+    // No second blending in an adjacent rotation, except for 90 degree corners.
+    if (top_right != 0u && !ColorEq(e, g))
+      line_blend = false;
+    else if (bottom_left != 0u && !ColorEq(e, c))
+      line_blend = false;
+    // No full blending for L-shapes, blend the corner only.
+    else if (!ColorEq(e, i) && ColorEq(g, h) && ColorEq(h, i) && ColorEq(i, f) && ColorEq(f, c))
+      line_blend = false;
+  }
+
+  float4 px = ColorDist(e, f) <= ColorDist(e, h) ? f : h;
+  if (!line_blend)
+  {
+    BlendCorner(rot, px);
+    return;
+  }
+
+  float fg = ColorDist(f, g);
+  float hc = ColorDist(h, c);
+  bool shallow_line = STEEP_DIRECTION_THRESHOLD * fg <= hc && e != g && d != g;
+  bool steep_line = STEEP_DIRECTION_THRESHOLD * hc <= fg && e != c && b != c;
+  if (shallow_line && steep_line)
+    BlendLineSteepAndShallow(rot, px);
+  else if (shallow_line)
+    BlendLineShallow(rot, px);
+  else if (steep_line)
+    BlendLineSteep(rot, px);
+  else
+    BlendLineDiagonal(rot, px);
+}
+
+void ScaleXBRZ(int2 pos)
+{
+  for (int y = -2; y <= 2; y++)
+  {
+    for (int x = -2; x <= 2; x++)
+      neighbourhood[(y + 2) * 5 + x + 2] = Fetch(pos + int2(x, y));
+  }
+
+  // Corners past the top or left edge are never blended.
+  uint4 corners = uint4(0u, 0u, PreProcessCorners(0, 0).x, 0u);
+  if (pos.y > 0)
+    corners.y = PreProcessCorners(0, -1).z;
+  if (pos.x > 0)
+    corners.w = PreProcessCorners(-1, 0).y;
+  if (pos.x > 0 && pos.y > 0)
+    corners.x = PreProcessCorners(-1, -1).w;
+
+  for (int k = 0; k < SCALE * SCALE; k++)
+    scaled[k] = Src(0, 0);
+  for (int rot = 0; rot < 4; rot++)
+    ScalePixel(rot, corners);
+}
+)";
+
+static const char SCALING_SHADER_XBRZ_MAIN[] = R"(
+void main()
+{
+  int2 pos = int2(gl_GlobalInvocationID.xy);
+  if (pos.x >= dimensions.x || pos.y >= dimensions.y)
+    return;
+
+  ScaleXBRZ(pos);
+  for (int i = 0; i < SCALE; i++)
+  {
+    for (int j = 0; j < SCALE; j++)
+      Store(pos * SCALE + int2(j, i), scaled[i * SCALE + j]);
+  }
+}
+)";
+
+// Mixes bilinear and xBRZ scaling with the splatted distance mask, like TextureScaler::ScaleHybrid.
+static const char SCALING_SHADER_HYBRID_MAIN[] = R"(
+float distance_masks[25];
+
+float DistanceMask(int2 coords)
+{
+  float4 center = Fetch(coords);
+  float dist = 0.0;
+  for (int y = -1; y <= 1; y++)
+  {
+    if (coords.y + y < 0 || coords.y + y >= dimensions.y)
+    {
+      dist += 1200.0;
+      continue;
+    }
+    for (int x = -1; x <= 1; x++)
+    {
+      if (x == 0 && y == 0)
+        continue;
+      if (coords.x + x < 0 || coords.x + x >= dimensions.x)
+      {
+        dist += 400.0;
+        continue;
+      }
+      float4 diff = abs(Fetch(coords + int2(x, y)) - center);
+      dist += diff.r + diff.g + diff.b + diff.a;
+    }
+  }
+  return dist;
+}
+float SplatMask(int2 pos, int2 coords)
+{
+  float mask = 0.0;
+  for (int y = -1; y <= 1; y++)
+  {
+    for (int x = -1; x <= 1; x++)
+    {
+      int2 offset = clamp(coords + int2(x, y), int2(0, 0), dimensions.xy - 1) - pos;
+      mask += distance_masks[(offset.y + 2) * 5 + offset.x + 2];
+    }
+  }
+  return mask;
+}
+
+// Neighbour and center weights of the bilinear filter, for the first half of the sub texels.
+float2 BilinearWeights(int i)
+{
+#if SCALE == 2
+  return float2(44.0, 211.0);
+#elif SCALE == 3
+  return i == 0 ? float2(64.0, 191.0) : float2(0.0, 255.0);
+#elif SCALE == 4
+  return i == 0 ? float2(77.0, 178.0) : float2(26.0, 229.0);
+#else
+  return i == 0 ? float2(102.0, 153.0) : (i == 1 ? float2(51.0, 204.0) : float2(0.0, 255.0));
+#endif
+}
+float4 BilinearMix(float4 lower, float4 center, float4 upper, int i)
+{
+  bool first_half = i < (SCALE + 1) / 2;
+  float2 weights = BilinearWeights(first_half ? i : SCALE - 1 - i);
+  return floor(((first_half ? lower : upper) * weights.x + center * weights.y + 0.5) / 255.0);
+}
+float4 Bilinear(float4 values[9], int i, int j)
+{
+  float4 rows[3];
+  for (int r = 0; r < 3; r++)
+    rows[r] = BilinearMix(values[r * 3], values[r * 3 + 1], values[r * 3 + 2], j);
+  return BilinearMix(rows[0], rows[1], rows[2], i);
+}
+
+void main()
+{
+  int2 pos = int2(gl_GlobalInvocationID.xy);
+  if (pos.x >= dimensions.x || pos.y >= dimensions.y)
+    return;
+
+  ScaleXBRZ(pos);
+
+  for (int y = -2; y <= 2; y++)
+  {
+    for (int x = -2; x <= 2; x++)
+    {
+      int2 coords = clamp(pos + int2(x, y), int2(0, 0), dimensions.xy - 1);
+      distance_masks[(y + 2) * 5 + x + 2] = DistanceMask(coords);
+    }
+  }
+
+  float4 colors[9];
+  float4 masks[9];
+  for (int y = -1; y <= 1; y++)
+  {
+    for (int x = -1; x <= 1; x++)
+    {
+      colors[(y + 1) * 3 + x + 1] = Src(x, y);
+      int2 coords = clamp(pos + int2(x, y), int2(0, 0), dimensions.xy - 1);
+      masks[(y + 1) * 3 + x + 1] = float4(SplatMask(pos, coords));
+    }
+  }
+
+  for (int i = 0; i < SCALE; i++)
+  {
+    for (int j = 0; j < SCALE; j++)
+    {
+      // The factor 8192 was found through practical testing on a variety of textures.
+      float factor = floor(min(Bilinear(masks, i, j).x, 8192.0) * 255.0 / 8192.0);
+      float4 xbrz = scaled[i * SCALE + j];
+      float4 color = floor((Bilinear(colors, i, j) * (255.0 - factor) + xbrz * factor + 0.5) / 255.0);
+      // xBRZ always does a better job with hard alpha.
+      if (xbrz.a == 0.0)
+        color.a = 0.0;
+      Store(pos * SCALE + int2(j, i), color);
+    }
+  }
+}
+)";
+
+static const char SCALING_SHADER_DDT_MAIN[] = R"(
+int4 Linear3p(int p, int q, int4 a, int4 b, int4 c)
+{
+  p = (((p << 1) + 1) << 7) / SCALE;
+  q = (((q << 1) + 1) << 7) / SCALE;
+  return (a << 8) + p * (b - a) + q * (c - a);
+}
+int4 Linear4p(int p, int q, int4 a, int4 b, int4 c, int4 d)
+{
+  p = (((p << 1) + 1) << 7) / SCALE;
+  q = (((q << 1) + 1) << 7) / SCALE;
+  return (a << 8) + p * (b - a) + q * (c - a) + ((p * q) >> 8) * (a - b - c + d);
+}
+
+// The CPU filter works on cells between four source texels, starting half a cell early.
+int4 ScaleDDT(int2 coords)
+{
+  int2 cell = (coords + SCALE / 2) / SCALE;
+  int2 sub = coords + SCALE / 2 - cell * SCALE;
+  // The cells past the right and bottom edges are clamped onto the last column and row.
+  if (coords.x == dimensions.x * SCALE - 1)
+  {
+    cell.x = dimensions.x;
+    sub.x = SCALE - 1;
+  }
+  if (coords.y == dimensions.y * SCALE - 1)
+  {
+    cell.y = dimensions.y;
+    sub.y = SCALE - 1;
+  }
+
+  int4 c00 = int4(Fetch(cell + int2(-1, -1)));
+  int4 c10 = int4(Fetch(cell + int2(0, -1)));
+  int4 c01 = int4(Fetch(cell + int2(-1, 0)));
+  int4 c11 = int4(Fetch(cell));
+  int wd1 = abs(c00.g - c11.g);
+  int wd2 = abs(c10.g - c01.g);
+  int x = sub.x;
+  int y = sub.y;
+
+  int4 result;
+  if (wd1 < wd2)
+  {
+    if (x > y)
+      result = Linear3p(SCALE - x - 1, y, c10, c00, c11);
+    else
+      result = Linear3p(x, SCALE - y - 1, c01, c11, c00);
+  }
+  else if (wd1 > wd2)
+  {
+    if (x + y < SCALE)
+      result = Linear3p(x, y, c00, c10, c01);
+    else
+      result = Linear3p(SCALE - x - 1, SCALE - y - 1, c11, c01, c10);
+  }
+  else
+  {
+    result = Linear4p(x, y, c00, c10, c01, c11);
+  }
+  return clamp(result >> 8, 0, 255);
+}
+
+void main()
+{
+  int2 pos = int2(gl_GlobalInvocationID.xy);
+  if (pos.x >= dimensions.x || pos.y >= dimensions.y)
+    return;
+
+  for (int i = 0; i < SCALE; i++)
+  {
+    for (int j = 0; j < SCALE; j++)
+    {
+      int2 coords = pos * SCALE + int2(j, i);
+      Store(coords, float4(ScaleDDT(coords)));
+    }
+  }
+}
+)";
+
+std::string GenerateScalingShader(int scaling_type, int factor, API_TYPE ApiType)
+{
+	if (!IsScalingShaderSupported(scaling_type, factor))
+		return "";
+
+	// params: source offset in texels, source row stride in texels
+	// dimensions: size of the source in texels
+	std::string source;
+	if (ApiType == API_VULKAN)
+	{
+		source +=
+			"layout(std140, push_constant) uniform PCBlock { int4 params; int4 dimensions; } PC;\n"
+			"#define params PC.params\n"
+			"#define dimensions PC.dimensions\n"
+			"layout(set = 0, binding = 0) uniform samplerBuffer s_input;\n"
+			"layout(set = 0, binding = 2, rgba8) uniform writeonly image2D s_output;\n";
+	}
+	else
+	{
+		source +=
+			"uniform int4 params;\n"
+			"uniform int4 dimensions;\n"
+			"#define s_input samp9\n"
+			"SAMPLER_BINDING(9) uniform samplerBuffer samp9;\n"
+			"layout(rgba8) uniform writeonly image2D s_output;\n";
+	}
+
+	source += StringFromFormat(
+		"layout(local_size_x = %u, local_size_y = %u) in;\n"
+		"#define SCALE %d\n",
+		DECODING_SHADER_GROUP_SIZE, DECODING_SHADER_GROUP_SIZE, factor);
+	source += SCALING_SHADER_COMMON;
+	switch (scaling_type)
+	{
+	case TextureScaler::XBRZ:
+		source += SCALING_SHADER_XBRZ;
+		source += SCALING_SHADER_XBRZ_MAIN;
+		break;
+	case TextureScaler::HYBRID:
+		source += SCALING_SHADER_XBRZ;
+		source += SCALING_SHADER_HYBRID_MAIN;
+		break;
+	case TextureScaler::DDT:
+		source += SCALING_SHADER_DDT_MAIN;
+		break;
+	}
+	return source;
+}
+
 }  // namespace
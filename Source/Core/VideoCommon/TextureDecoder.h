@@ -86,6 +86,9 @@ enum PC_TexFormat
 	PC_TEX_FMT_DXT3,
 	PC_TEX_FMT_DXT5,
 	PC_TEX_FMT_R32,
+	// Only used by custom textures
+	PC_TEX_FMT_BC5,
+	PC_TEX_FMT_BC7,
 };
 PC_TexFormat TexDecoder_Decode(u8 *dst, const u8 *src, u32 width, u32 height, u32 texformat, u32 tlutaddr, TlutFormat tlutfmt, bool rgbaOnly = false, bool compressed_supported = false);
 PC_TexFormat GetPC_TexFormat(u32 texformat, TlutFormat tlutfmt, bool compressed_supported = false);
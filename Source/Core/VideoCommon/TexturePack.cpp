@@ -0,0 +1,159 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "Common/FileSearch.h"
+#include "Common/FileUtil.h"
+#include "Common/MathUtil.h"
+#include "Common/StringUtil.h"
+#include "Common/Logging/Log.h"
+
+#include "VideoCommon/TexturePack.h"
+
+namespace
+{
+const u32 PACK_MAGIC = 0x4b505449;  // "ITPK"
+const u32 PACK_VERSION = 1;
+// The files are aligned, so the dds data can be used in place
+const u64 FILE_ALIGNMENT = 16;
+
+struct PackHeader
+{
+	u32 magic;
+	u32 version;
+	u32 entry_count;
+	u32 names_size;
+	u64 index_offset;
+};
+
+// Followed by entry_count of these and then names_size bytes of names
+struct PackIndexEntry
+{
+	u64 offset;
+	u64 size;
+	u32 name_offset;
+	u32 name_length;
+};
+}
+
+bool TexturePack::Open(const std::string& filename)
+{
+	Close();
+	if (!m_file.Open(filename))
+		return false;
+
+	const u8* data = m_file.GetData();
+	const u64 file_size = m_file.GetSize();
+	PackHeader header;
+	if (file_size < sizeof(header))
+	{
+		Close();
+		return false;
+	}
+	std::memcpy(&header, data, sizeof(header));
+
+	const u64 index_size = u64(header.entry_count) * sizeof(PackIndexEntry);
+	if (header.magic != PACK_MAGIC || header.version != PACK_VERSION ||
+		header.index_offset < sizeof(header) || header.index_offset > file_size ||
+		index_size + header.names_size > file_size - header.index_offset)
+	{
+		ERROR_LOG(VIDEO, "Invalid texture pack %s", filename.c_str());
+		Close();
+		return false;
+	}
+
+	const u8* names = data + header.index_offset + index_size;
+	m_entries.reserve(header.entry_count);
+	for (u32 i = 0; i < header.entry_count; i++)
+	{
+		PackIndexEntry entry;
+		std::memcpy(&entry, data + header.index_offset + i * sizeof(entry), sizeof(entry));
+		if (entry.offset > header.index_offset || entry.size > header.index_offset - entry.offset ||
+			entry.name_offset > header.names_size ||
+			entry.name_length > header.names_size - entry.name_offset)
+		{
+			ERROR_LOG(VIDEO, "Invalid texture pack %s", filename.c_str());
+			Close();
+			return false;
+		}
+		m_entries.push_back({ std::string(reinterpret_cast<const char*>(names + entry.name_offset),
+			entry.name_length), data + entry.offset, entry.size });
+	}
+	return true;
+}
+
+void TexturePack::Close()
+{
+	m_entries.clear();
+	m_file.Close();
+}
+
+bool TexturePack::Build(const std::string& directory, const std::string& filename)
+{
+	std::vector<std::string> files = DoFileSearch({ ".png", ".dds" }, { directory }, /*recursive*/ true);
+
+	File::IOFile out(filename, "wb");
+	if (!out.IsOpen())
+	{
+		ERROR_LOG(VIDEO, "Failed to create texture pack %s", filename.c_str());
+		return false;
+	}
+
+	PackHeader header = {};
+	header.magic = PACK_MAGIC;
+	header.version = PACK_VERSION;
+	out.WriteBytes(&header, sizeof(header));
+
+	std::vector<PackIndexEntry> index;
+	std::string names;
+	std::vector<u8> buffer;
+	u64 offset = sizeof(header);
+	for (const std::string& path : files)
+	{
+		std::string name, extension;
+		SplitPath(path, nullptr, &name, &extension);
+
+		File::IOFile in(path, "rb");
+		buffer.resize(in.GetSize());
+		if (!in.IsOpen() || !in.ReadBytes(buffer.data(), buffer.size()))
+		{
+			ERROR_LOG(VIDEO, "Failed to read %s, it is not packed", path.c_str());
+			continue;
+		}
+
+		const u64 aligned_offset = ROUND_UP(offset, FILE_ALIGNMENT);
+		static const u8 padding[FILE_ALIGNMENT] = {};
+		out.WriteBytes(padding, aligned_offset - offset);
+		out.WriteBytes(buffer.data(), buffer.size());
+		offset = aligned_offset + buffer.size();
+
+		name += extension;
+		index.push_back({ aligned_offset, buffer.size(), static_cast<u32>(names.size()),
+			static_cast<u32>(name.size()) });
+		names += name;
+	}
+
+	header.entry_count = static_cast<u32>(index.size());
+	header.names_size = static_cast<u32>(names.size());
+	header.index_offset = offset;
+	out.WriteBytes(index.data(), index.size() * sizeof(PackIndexEntry));
+	out.WriteBytes(names.data(), names.size());
+	out.Seek(0, SEEK_SET);
+	out.WriteBytes(&header, sizeof(header));
+	if (!out.IsGood())
+	{
+		ERROR_LOG(VIDEO, "Failed to write texture pack %s", filename.c_str());
+		out.Close();
+		File::Delete(filename);
+		return false;
+	}
+
+	NOTICE_LOG(VIDEO, "Packed %zu textures from %s into %s", index.size(), directory.c_str(),
+		filename.c_str());
+	return true;
+}
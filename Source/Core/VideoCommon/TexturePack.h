@@ -0,0 +1,42 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/MappedFile.h"
+
+// Single file container for custom textures, so a pack is opened with one file open and an
+// index read instead of a walk of the texture directory.
+//
+// The files are stored as they are (png or dds) behind the header, the index at the end
+// holds their names without the directory. The whole file is memory mapped, the entries
+// point straight into the mapping.
+class TexturePack
+{
+public:
+	struct Entry
+	{
+		std::string name;
+		const u8* data;
+		u64 size;
+	};
+
+	bool Open(const std::string& filename);
+	void Close();
+	bool IsOpen() const { return m_file.IsOpen(); }
+
+	// Valid until Close
+	const std::vector<Entry>& GetEntries() const { return m_entries; }
+
+	// Packs the png and dds files found in directory and its subdirectories.
+	static bool Build(const std::string& directory, const std::string& filename);
+
+private:
+	File::MappedFile m_file;
+	std::vector<Entry> m_entries;
+};
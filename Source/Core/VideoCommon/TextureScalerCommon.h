@@ -18,8 +18,13 @@
 #pragma once
 
 #include "Common/CommonTypes.h"
+#include "Common/LinearDiskCache.h"
 #include "Common/MemoryUtil.h"
+#include "Common/ThreadPool.h"
 
+#include <cstring>
+#include <set>
+#include <string>
 #include <vector>
 
 class TextureScaler
@@ -53,8 +58,37 @@ private:
 
 	bool IsEmptyOrFlat(u32* data, int pixels);
 
+	// Scaled textures are stored per game, keyed by the hash of the decoded input texels
+	// and the scaling settings, so the same texture is never scaled twice.
+	struct ScaledTextureKey
+	{
+		u64 hash;
+		u32 width;
+		u32 height;
+		u8 type;
+		u8 factor;
+		u8 deposterize;
+		u8 pad;
+
+		bool operator<(const ScaledTextureKey& other) const
+		{
+			return std::memcmp(this, &other, sizeof(*this)) < 0;
+		}
+	};
+	bool LoadCachedTexture(const ScaledTextureKey& key, u32* dest);
+	void UpdateDiskCache();
+
+	LinearDiskCache<ScaledTextureKey, u32> m_disk_cache;
+	std::string m_disk_cache_game_id;
+	bool m_disk_cache_open = false;
+	// Entries appended since the cache was opened can't be found until it's reopened
+	std::set<ScaledTextureKey> m_appended_keys;
+
 	// depending on the factor and texture sizes, these can get pretty large 
 	// maximum is (100 MB total for a 512 by 512 texture with scaling factor 5 and hybrid scaling)
 	// of course, scaling factor 5 is totally silly anyway
 	Common::SimpleBuf<u32> bufInput, bufDeposter, bufOutput, bufTmp1, bufTmp2, bufTmp3;
+
+	// splits the filters into row bands
+	Common::ParallelLoop m_loop;
 };
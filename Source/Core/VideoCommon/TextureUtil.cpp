@@ -240,9 +240,15 @@ void CopyCompressedTextureData(u8 *pDst, const u8 *pSrc, const s32 width, const
 	}
 }
 
+bool IsBlockCompressed(PC_TexFormat fmt)
+{
+	return fmt == PC_TEX_FMT_DXT1 || fmt == PC_TEX_FMT_DXT3 || fmt == PC_TEX_FMT_DXT5 ||
+		fmt == PC_TEX_FMT_BC5 || fmt == PC_TEX_FMT_BC7;
+}
+
 s32 GetTextureSizeInBytes(u32 width, u32 height, PC_TexFormat fmt)
 {
-	static const s32 formatSize[11]
+	static const s32 formatSize[14]
 	{
 		0,//PC_TEX_FMT_NONE
 		4,//PC_TEX_FMT_BGRA32
@@ -255,8 +261,11 @@ s32 GetTextureSizeInBytes(u32 width, u32 height, PC_TexFormat fmt)
 		8,//PC_TEX_FMT_DXT1
 		16,//PC_TEX_FMT_DXT3
 		16,//PC_TEX_FMT_DXT5
+		4,//PC_TEX_FMT_R32
+		16,//PC_TEX_FMT_BC5
+		16,//PC_TEX_FMT_BC7
 	};
-	if (fmt == PC_TEX_FMT_DXT1 || fmt == PC_TEX_FMT_DXT3 || fmt == PC_TEX_FMT_DXT5)
+	if (IsBlockCompressed(fmt))
 	{
 		width = (width + 3) >> 2;
 		height = (height + 3) >> 2;
@@ -0,0 +1,612 @@
+// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "VideoCommon/UberShaderPixel.h"
+
+#include "Common/CommonTypes.h"
+#include "Common/MsgHandler.h"
+#include "VideoCommon/BPMemory.h"
+#include "VideoCommon/VideoConfig.h"
+
+// Layout of UberPixelShaderConstants
+// stages[n].x: color combiner
+// stages[n].y: alpha combiner
+// stages[n].z: indirect stage (21 bits) | has indirect stage << 21 | kcsel << 22 | kasel << 27
+// stages[n].w: texcoord | texmap << 3 | texture enable << 6 | colorchan << 7 | ras swap << 10 | tex swap << 18
+// config.x: num tev stages - 1 | num texgens << 4 | num ind stages << 8 | used ind stages << 11
+//           | alpha pretest << 15 | alpha comp0 << 17 | alpha comp1 << 20 | alpha logic << 23 | zcomploc hack << 25
+// config.y: ind stage n texcoord << (6 * n) | ind stage n texmap << (6 * n + 3)
+// config.z: fog fsel | fog proj << 3 | fog range base << 4 | ztex op << 5 | early ztest << 7
+//           | late ztest << 8 | rgba6 format << 9 | dither << 10 | zfreeze << 11 | fast depth calc << 12
+
+bool GetUberPixelShaderUID(UberPixelShaderUid& out, const pixel_shader_uid_data& uid_data)
+{
+	out.ClearUID();
+	if (uid_data.pixel_lighting != 0)
+		return false;
+	if (uid_data.render_mode != PSRM_DEFAULT && uid_data.render_mode != PSRM_DUAL_SOURCE_BLEND)
+		return false;
+	uber_pixel_shader_uid_data& data = out.GetUidData<uber_pixel_shader_uid_data>();
+	data.numTexgens = uid_data.genMode_numtexgens;
+	data.render_mode = uid_data.render_mode;
+	data.per_pixel_depth = uid_data.per_pixel_depth;
+	data.forced_early_z = uid_data.forced_early_z;
+	data.stereo = uid_data.stereo;
+	data.msaa = uid_data.msaa;
+	data.ssaa = uid_data.ssaa;
+	data.bounding_box = uid_data.bounding_box;
+	out.CalculateUIDHash();
+	return true;
+}
+
+void GetUberPixelShaderConstants(UberPixelShaderConstants& out, const pixel_shader_uid_data& uid_data)
+{
+	memset(&out, 0, sizeof(out));
+	for (u32 n = 0; n <= uid_data.genMode_numtevstages; ++n)
+	{
+		const auto& stage = uid_data.stagehash[n];
+		out.stages[n][0] = stage.cc;
+		out.stages[n][1] = stage.ac;
+		out.stages[n][2] = stage.tevind
+			| (stage.hasindstage << 21)
+			| ((stage.tevksel_kc & 0x1F) << 22)
+			| ((stage.tevksel_ka & 0x1F) << 27);
+		out.stages[n][3] = stage.tevorders_texcoord
+			| (stage.tevorders_texmap << 3)
+			| (stage.tevorders_enable << 6)
+			| (stage.tevorders_colorchan << 7)
+			| (stage.tevksel_swap1a << 10) | (stage.tevksel_swap2a << 12)
+			| (stage.tevksel_swap1b << 14) | (stage.tevksel_swap2b << 16)
+			| (stage.tevksel_swap1c << 18) | (stage.tevksel_swap2c << 20)
+			| (stage.tevksel_swap1d << 22) | (stage.tevksel_swap2d << 24);
+	}
+	out.config[0] = uid_data.genMode_numtevstages
+		| (uid_data.genMode_numtexgens << 4)
+		| (uid_data.genMode_numindstages << 8)
+		| (uid_data.nIndirectStagesUsed << 11)
+		| (uid_data.Pretest << 15)
+		| (uid_data.alpha_test_comp0 << 17)
+		| (uid_data.alpha_test_comp1 << 20)
+		| (uid_data.alpha_test_logic << 23)
+		| (uid_data.alpha_test_use_zcomploc_hack << 25);
+	for (int i = 0; i < 4; ++i)
+	{
+		out.config[1] |= (uid_data.GetTevindirefCoord(i) | (uid_data.GetTevindirefMap(i) << 3)) << (6 * i);
+	}
+	out.config[2] = uid_data.fog_fsel
+		| (uid_data.fog_proj << 3)
+		| (uid_data.fog_RangeBaseEnabled << 4)
+		| (uid_data.ztex_op << 5)
+		| (uid_data.early_ztest << 7)
+		| (uid_data.late_ztest << 8)
+		| (uid_data.rgba6_format << 9)
+		| (uid_data.dither << 10)
+		| (uid_data.zfreeze << 11)
+		| (uid_data.fast_depth_calc << 12);
+}
+
+static const char* s_uber_header = R"hlsl(
+#define ddx ddx_fine
+#define ddy ddy_fine
+uint bitfield(uint x, uint offset, uint size)
+{
+	return (x >> offset) & ((1u << size) - 1u);
+}
+int idot(int3 x, int3 y)
+{
+	int3 tmp = x * y;
+	return tmp.x + tmp.y + tmp.z;
+}
+int idot(int4 x, int4 y)
+{
+	int4 tmp = x * y;
+	return tmp.x + tmp.y + tmp.z + tmp.w;
+}
+int2 BSH(int2 x, int n)
+{
+	if(n >= 0)
+	{
+		return x >> n;
+	}
+	else
+	{
+		return x << (-n);
+	}
+}
+int4 Swizzle(int4 c, uint swap)
+{
+	return int4(c[swap & 3u], c[(swap >> 2) & 3u], c[(swap >> 4) & 3u], c[(swap >> 6) & 3u]);
+}
+int KonstValue(uint sel)
+{
+	// 1, 7/8, 3/4, 5/8, 1/2, 3/8, 1/4, 1/8
+	return int(8u - sel) * 32 - (sel < 4u ? 1 : 0);
+}
+int3 KonstC(uint kc)
+{
+	if (kc < 8u)
+		return int3(KonstValue(kc), KonstValue(kc), KonstValue(kc));
+	if (kc < 12u)
+		return int3(0, 0, 0);
+	if (kc < 16u)
+		return k[kc - 12u].rgb;
+	int comp = k[kc & 3u][(kc - 16u) >> 2];
+	return int3(comp, comp, comp);
+}
+int KonstA(uint ka)
+{
+	if (ka < 8u)
+		return KonstValue(ka);
+	if (ka < 16u)
+		return 0;
+	return k[ka & 3u][(ka - 16u) >> 2];
+}
+int3 ColorInput(uint sel, int4 regs[4], int4 tex, int4 ras, int4 konst)
+{
+	if (sel < 8u)
+		return (sel & 1u) != 0u ? regs[sel >> 1].aaa : regs[sel >> 1].rgb;
+	switch (sel)
+	{
+	case 8u: return tex.rgb;
+	case 9u: return tex.aaa;
+	case 10u: return ras.rgb;
+	case 11u: return ras.aaa;
+	case 12u: return int3(255, 255, 255);
+	case 13u: return int3(128, 128, 128);
+	case 14u: return konst.rgb;
+	default: return int3(0, 0, 0);
+	}
+}
+int AlphaInput(uint sel, int4 regs[4], int4 tex, int4 ras, int4 konst)
+{
+	if (sel < 4u)
+		return regs[sel].a;
+	switch (sel)
+	{
+	case 4u: return tex.a;
+	case 5u: return ras.a;
+	case 6u: return konst.a;
+	default: return 0;
+	}
+}
+// Regular TEV stage: (d + bias + lerp(a,b,c)) * scale, see WriteTevRegularI
+int3 TevRegular(int3 a, int3 b, int3 c, int3 d, uint bias, uint op, uint shift)
+{
+	int bias_value = bias == 1u ? 128 : (bias == 2u ? -128 : 0);
+	int shift_left = shift == 1u ? 1 : (shift == 2u ? 2 : 0);
+	int shift_right = shift == 3u ? 1 : 0;
+	int lerp_bias = shift != 3u ? (op == 0u ? 128 : 127) : 0;
+	int3 lerp = ((((a << 8) + (b - a) * c) << shift_left) + lerp_bias) >> 8;
+	int3 dd = (d + bias_value) << shift_left;
+	return (op == 0u ? (dd + lerp) : (dd - lerp)) >> shift_right;
+}
+int TevRegular(int a, int b, int c, int d, uint bias, uint op, uint shift)
+{
+	return TevRegular(int3(a, 0, 0), int3(b, 0, 0), int3(c, 0, 0), int3(d, 0, 0), bias, op, shift).x;
+}
+bool TevCompare(uint cmp, int4 a, int4 b)
+{
+	switch (cmp)
+	{
+	case 0u: return a.r > b.r;
+	case 1u: return a.r == b.r;
+	case 2u: return idot(a.rgb, int3(1, 256, 0)) > idot(b.rgb, int3(1, 256, 0));
+	case 3u: return idot(a.rgb, int3(1, 256, 0)) == idot(b.rgb, int3(1, 256, 0));
+	case 4u: return idot(a.rgb, int3(1, 256, 65536)) > idot(b.rgb, int3(1, 256, 65536));
+	default: return idot(a.rgb, int3(1, 256, 65536)) == idot(b.rgb, int3(1, 256, 65536));
+	}
+}
+bool AlphaCompare(uint comp, int a, int ref)
+{
+	switch (comp)
+	{
+	case 0u: return false;
+	case 1u: return a < ref;
+	case 2u: return a == ref;
+	case 3u: return a <= ref;
+	case 4u: return a > ref;
+	case 5u: return a != ref;
+	case 6u: return a >= ref;
+	default: return true;
+	}
+}
+static const int bayer[16] = {-7,1,-5,3,5,-3,7,-1,-4,4,-6,2,8,0,6,-2};
+)hlsl";
+
+static const char* s_uber_indirect = R"hlsl(
+		if (bitfield(ind, 21u, 1u) != 0u)
+		{
+			uint bt = bitfield(ind, 0u, 2u);
+			uint fmt = bitfield(ind, 2u, 2u);
+			uint bias = bitfield(ind, 4u, 3u);
+			uint bs = bitfield(ind, 7u, 2u);
+			uint mid = bitfield(ind, 9u, 4u);
+			uint sw = bitfield(ind, 13u, 3u);
+			uint tw = bitfield(ind, 16u, 3u);
+			int3 indcoord = indtex[bt];
+			if (bs != 0u)
+			{
+				int alpha_mask = fmt == 1u ? 224 : (fmt == 2u ? 240 : 248);
+				a_bump = indcoord[bs - 1u] & alpha_mask;
+			}
+			int2 indtevtrans = int2(0, 0);
+			if (mid != 0u)
+			{
+				int fmt_mask = fmt == 0u ? 255 : (fmt == 1u ? 31 : (fmt == 2u ? 15 : 7));
+				int3 indtevcrd = indcoord & fmt_mask;
+				int bias_add = fmt == 0u ? -128 : 1;
+				if ((bias & 1u) != 0u)
+					indtevcrd.x += bias_add;
+				if ((bias & 2u) != 0u)
+					indtevcrd.y += bias_add;
+				if ((bias & 4u) != 0u)
+					indtevcrd.z += bias_add;
+				if (mid <= 3u)
+				{
+					uint mtxidx = 2u * (mid - 1u);
+					indtevtrans = int2(idot(cindmtx[mtxidx].xyz, indtevcrd), idot(cindmtx[mtxidx + 1u].xyz, indtevcrd));
+					indtevtrans = indtevtrans >> 3;
+					indtevtrans = BSH(indtevtrans, cindmtx[mtxidx].w);
+				}
+				else if (mid >= 5u && mid <= 7u && has_texcoord)
+				{
+					uint mtxidx = 2u * (mid - 5u);
+					indtevtrans = int2(uv[texcoord].xy * indtevcrd.xx);
+					indtevtrans = indtevtrans >> 8;
+					indtevtrans = BSH(indtevtrans, cindmtx[mtxidx].w);
+				}
+				else if (mid >= 9u && mid <= 11u && has_texcoord)
+				{
+					uint mtxidx = 2u * (mid - 9u);
+					indtevtrans = int2(uv[texcoord].xy * indtevcrd.yy);
+					indtevtrans = indtevtrans >> 8;
+					indtevtrans = BSH(indtevtrans, cindmtx[mtxidx].w);
+				}
+			}
+			// Wrapping
+			int2 wrappedcoord = int2(uv[texcoord].xy);
+			if (sw >= 6u)
+				wrappedcoord.x = 0;
+			else if (sw != 0u)
+				wrappedcoord.x = wrappedcoord.x & ((32768 >> (sw - 1u)) - 1);
+			if (tw >= 6u)
+				wrappedcoord.y = 0;
+			else if (tw != 0u)
+				wrappedcoord.y = wrappedcoord.y & ((32768 >> (tw - 1u)) - 1);
+			if (bitfield(ind, 20u, 1u) != 0u)
+				tevcoord.xy += wrappedcoord + indtevtrans;
+			else
+				tevcoord.xy = wrappedcoord + indtevtrans;
+			// Emulate s24 overflows
+			tevcoord.xy = (tevcoord.xy << 8) >> 8;
+		}
+		else if (bitfield(order, 6u, 1u) != 0u)
+		{
+			tevcoord.xy = has_texcoord ? int2(uv[texcoord].xy) : int2(0, 0);
+		}
+)hlsl";
+
+static const char* s_uber_stage = R"hlsl(
+		int4 tex_t = int4(255, 255, 255, 255);
+		if (bitfield(order, 6u, 1u) != 0u)
+		{
+			tex_t = SampleTex(bitfield(order, 3u, 3u), float2(tevcoord.xy), uvdx[texcoord], uvdy[texcoord]);
+		}
+		tex_t = Swizzle(tex_t, bitfield(order, 18u, 8u));
+		uint colorchan = bitfield(order, 7u, 3u);
+		int4 ras_t = int4(0, 0, 0, 0);
+		if (colorchan == 0u)
+			ras_t = col0;
+		else if (colorchan == 1u)
+			ras_t = col1;
+		else if (colorchan == 5u)
+			ras_t = int4(a_bump, a_bump, a_bump, a_bump);
+		else if (colorchan == 6u)
+			ras_t = int4(1, 1, 1, 1) * (a_bump | (a_bump >> 5));
+		ras_t = Swizzle(ras_t, bitfield(order, 10u, 8u));
+		int4 konst_t = int4(KonstC(bitfield(ind, 22u, 5u)), KonstA(bitfield(ind, 27u, 5u)));
+
+		uint cc = ustage[n].x;
+		uint ac = ustage[n].y;
+		int4 tin_a = int4(ColorInput(bitfield(cc, 12u, 4u), regs, tex_t, ras_t, konst_t), AlphaInput(bitfield(ac, 13u, 3u), regs, tex_t, ras_t, konst_t)) & 255;
+		int4 tin_b = int4(ColorInput(bitfield(cc, 8u, 4u), regs, tex_t, ras_t, konst_t), AlphaInput(bitfield(ac, 10u, 3u), regs, tex_t, ras_t, konst_t)) & 255;
+		int4 tin_c = int4(ColorInput(bitfield(cc, 4u, 4u), regs, tex_t, ras_t, konst_t), AlphaInput(bitfield(ac, 7u, 3u), regs, tex_t, ras_t, konst_t)) & 255;
+		int4 tin_d = int4(ColorInput(bitfield(cc, 0u, 4u), regs, tex_t, ras_t, konst_t), AlphaInput(bitfield(ac, 4u, 3u), regs, tex_t, ras_t, konst_t));
+		last_tex_t = tex_t;
+
+		// color combine
+		uint cbias = bitfield(cc, 16u, 2u);
+		uint cop = bitfield(cc, 18u, 1u);
+		uint cshift = bitfield(cc, 20u, 2u);
+		int3 color;
+		if (cbias != 3u)
+		{
+			color = TevRegular(tin_a.rgb, tin_b.rgb, tin_c.rgb + (tin_c.rgb >> 7), tin_d.rgb, cbias, cop, cshift);
+		}
+		else
+		{
+			uint cmp = (cshift << 1) | cop;
+			if (cmp == 6u)
+				color = tin_d.rgb + int3(tin_a.rgb > tin_b.rgb) * tin_c.rgb;
+			else if (cmp == 7u)
+				color = tin_d.rgb + int3(tin_a.rgb == tin_b.rgb) * tin_c.rgb;
+			else
+				color = tin_d.rgb + (TevCompare(cmp, tin_a, tin_b) ? tin_c.rgb : int3(0, 0, 0));
+		}
+		if (bitfield(cc, 19u, 1u) != 0u)
+			color = clamp(color, 0, 255);
+		else
+			color = clamp(color, -1024, 1023);
+		regs[bitfield(cc, 22u, 2u)].rgb = color;
+
+		// alpha combine
+		uint abias = bitfield(ac, 16u, 2u);
+		uint aop = bitfield(ac, 18u, 1u);
+		uint ashift = bitfield(ac, 20u, 2u);
+		int alpha;
+		if (abias != 3u)
+		{
+			alpha = TevRegular(tin_a.a, tin_b.a, tin_c.a + (tin_c.a >> 7), tin_d.a, abias, aop, ashift);
+		}
+		else
+		{
+			uint cmp = (ashift << 1) | aop;
+			if (cmp == 6u)
+				alpha = tin_d.a + (tin_a.a > tin_b.a ? tin_c.a : 0);
+			else if (cmp == 7u)
+				alpha = tin_d.a + (tin_a.a == tin_b.a ? tin_c.a : 0);
+			else
+				alpha = tin_d.a + (TevCompare(cmp, tin_a, tin_b) ? tin_c.a : 0);
+		}
+		if (bitfield(ac, 19u, 1u) != 0u)
+			alpha = clamp(alpha, 0, 255);
+		else
+			alpha = clamp(alpha, -1024, 1023);
+		regs[bitfield(ac, 22u, 2u)].a = alpha;
+		last_cdest = bitfield(cc, 22u, 2u);
+		last_adest = bitfield(ac, 22u, 2u);
+)hlsl";
+
+static const char* s_uber_fog = R"hlsl(
+	uint fog_fsel = bitfield(uconfig.z, 0u, 3u);
+	if (fog_fsel != 0u)
+	{
+		float ze;
+		if (bitfield(uconfig.z, 3u, 1u) == 0u)
+			ze = (cfogf[1].x * 16777216.0) / float(cfogi.y - (zCoord >> cfogi.w));
+		else
+			ze = cfogf[1].x * (float(zCoord) / 16777216.0);
+		if (bitfield(uconfig.z, 4u, 1u) != 0u)
+		{
+			float x_adjust = (2.0 * (clipPos.x / cfogf[0].y)) - 1.0 - cfogf[0].x;
+			x_adjust = sqrt(x_adjust * x_adjust + cfogf[0].z * cfogf[0].z) / cfogf[0].z;
+			ze *= x_adjust;
+		}
+		float fog = clamp(ze - cfogf[1].z, 0.0, 1.0);
+		if (fog_fsel == 4u)
+			fog = 1.0 - exp2(-8.0 * fog);
+		else if (fog_fsel == 5u)
+			fog = 1.0 - exp2(-8.0 * fog * fog);
+		else if (fog_fsel == 6u)
+			fog = exp2(-8.0 * (1.0 - fog));
+		else if (fog_fsel == 7u)
+		{
+			fog = 1.0 - fog;
+			fog = exp2(-8.0 * fog * fog);
+		}
+		int ifog = int(round(fog * 256.0));
+		prev.rgb = (prev.rgb * (256 - ifog) + cfogcolor.rgb * ifog) >> 8;
+	}
+)hlsl";
+
+void GenerateUberPixelShaderCodeD3D11(ShaderCode& out, const uber_pixel_shader_uid_data& uid_data)
+{
+	static char text[UBERPIXELSHADERGEN_BUFFERSIZE];
+	char* codebuffer = out.GetBuffer();
+	if (codebuffer == nullptr)
+	{
+		codebuffer = text;
+		out.SetBuffer(codebuffer);
+	}
+	codebuffer[UBERPIXELSHADERGEN_BUFFERSIZE - 1] = 0x7C;  // canary
+	const u32 numTexgen = uid_data.numTexgens;
+	const bool dual_source = uid_data.render_mode == PSRM_DUAL_SOURCE_BLEND;
+	const bool per_pixel_depth = uid_data.per_pixel_depth;
+
+	out.Write("//Pixel UberShader for %d texgens\n", numTexgen);
+	out.Write("SamplerState samp[8] : register(s0);\n");
+	out.Write("Texture2DArray Tex[8] : register(t0);\n");
+	out.Write("cbuffer PSBlock : register(b0) {\n");
+	DeclareUniform<API_D3D11>(out, C_COLORS, "int4", I_COLORS "[4]");
+	DeclareUniform<API_D3D11>(out, C_KCOLORS, "int4", I_KCOLORS "[4]");
+	DeclareUniform<API_D3D11>(out, C_ALPHA, "int4", I_ALPHA);
+	DeclareUniform<API_D3D11>(out, C_TEXDIMS, "float4", I_TEXDIMS "[8]");
+	DeclareUniform<API_D3D11>(out, C_ZBIAS, "int4", I_ZBIAS "[2]");
+	DeclareUniform<API_D3D11>(out, C_INDTEXSCALE, "int4", I_INDTEXSCALE "[2]");
+	DeclareUniform<API_D3D11>(out, C_INDTEXMTX, "int4", I_INDTEXMTX "[6]");
+	DeclareUniform<API_D3D11>(out, C_FOGCOLOR, "int4", I_FOGCOLOR);
+	DeclareUniform<API_D3D11>(out, C_FOGI, "int4", I_FOGI);
+	DeclareUniform<API_D3D11>(out, C_FOGF, "float4", I_FOGF "[2]");
+	DeclareUniform<API_D3D11>(out, C_ZSLOPE, "float4", I_ZSLOPE);
+	DeclareUniform<API_D3D11>(out, C_FLAGS, "int4", I_FLAGS);
+	DeclareUniform<API_D3D11>(out, C_EFBSCALE, "float4", I_EFBSCALE);
+	out.Write("};\n");
+	// Takes the place of VSBlock, which is only used with per pixel lighting
+	out.Write("cbuffer UberBlock : register(b1) {\n"
+		"uint4 ustage[16];\n"
+		"uint4 uconfig;\n"
+		"};\n");
+	if (uid_data.bounding_box)
+		out.Write("globallycoherent RWBuffer<int> bbox_data : register(u2);\n");
+	out.Write("%s", s_uber_header);
+
+	// Texture arrays can't be indexed dynamically in SM5.0, explicit gradients keep
+	// the sampling valid inside the dynamic stage loop.
+	out.Write("int4 SampleTex(uint texmap, float2 coord, float2 dx, float2 dy%s)\n{\n", uid_data.stereo ? ", float layer" : "");
+	out.Write("\tfloat4 c = float4(0.0, 0.0, 0.0, 0.0);\n"
+		"\tfloat3 uvw = float3(coord * " I_TEXDIMS "[texmap].xy, %s);\n"
+		"\tfloat2 gx = dx * " I_TEXDIMS "[texmap].xy;\n"
+		"\tfloat2 gy = dy * " I_TEXDIMS "[texmap].xy;\n"
+		"\tswitch (texmap)\n\t{\n", uid_data.stereo ? "layer" : "0.0");
+	for (int i = 0; i < 8; ++i)
+		out.Write("\tcase %du: c = Tex[%d].SampleGrad(samp[%d], uvw, gx, gy); break;\n", i, i, i);
+	out.Write("\t}\n\treturn int4(round(c * 255.0));\n}\n");
+	if (uid_data.stereo)
+	{
+		// Keep the call sites identical for both variants
+		out.Write("#define SampleTex(texmap, coord, dx, dy) SampleTex(texmap, coord, dx, dy, float(layer))\n");
+	}
+
+	if (uid_data.forced_early_z)
+		out.Write("[earlydepthstencil]\n");
+	out.Write("void main(\n");
+	out.Write("  out float4 ocol0 : SV_Target0,%s%s\n  in float4 rawpos : SV_Position,\n",
+		dual_source ? "\n  out float4 ocol1 : SV_Target1," : "",
+		per_pixel_depth ? "\n  out float depth : SV_Depth," : "");
+	const char* optCentroid = GetInterpolationQualifier(API_D3D11, uid_data.msaa, uid_data.ssaa);
+	out.Write("  in %s float4 colors_0 : COLOR0,\n", optCentroid);
+	out.Write("  in %s float4 colors_1 : COLOR1", optCentroid);
+	if (numTexgen < 7)
+	{
+		for (u32 i = 0; i < numTexgen; ++i)
+			out.Write(",\n  in %s float3 uv%d : TEXCOORD%d", optCentroid, i, i);
+		out.Write(",\n  in %s float4 clipPos : TEXCOORD%d", optCentroid, numTexgen);
+	}
+	else
+	{
+		for (u32 i = 0; i < numTexgen; ++i)
+			out.Write(",\n  in %s float%d uv%d : TEXCOORD%d", optCentroid, i < 4 ? 4 : 3, i, i);
+	}
+	if (uid_data.stereo)
+		out.Write(",\n  in uint layer : SV_RenderTargetArrayIndex\n");
+	out.Write("        ) {\n");
+	if (numTexgen >= 7)
+		out.Write("\tfloat4 clipPos = float4(rawpos.x, rawpos.y, uv2.w, uv3.w);\n");
+	else
+		out.Write("\tclipPos = float4(rawpos.x, rawpos.y, clipPos.z, clipPos.w);\n");
+
+	out.Write("\tuint num_stages = bitfield(uconfig.x, 0u, 4u);\n"
+		"\tuint num_indstages = bitfield(uconfig.x, 8u, 3u);\n"
+		"\tuint used_indstages = bitfield(uconfig.x, 11u, 4u);\n");
+
+	// Texture coordinates and their derivatives, computed outside of any dynamic flow control
+	out.Write("\tfloat3 uv[8];\n\tfloat2 uvdx[8], uvdy[8];\n");
+	for (u32 i = 0; i < 8; ++i)
+	{
+		if (i < numTexgen)
+		{
+			out.Write("\t{\n\t\tfloat2 t = uv%d.xy / ((uv%d.z == 0.0) ? 2.0 : uv%d.z) * " I_TEXDIMS "[%d].zw;\n", i, i, i, i);
+			out.Write("\t\tuv[%d] = float3(trunc(t), uv%d.z);\n\t\tuvdx[%d] = ddx(t);\n\t\tuvdy[%d] = ddy(t);\n\t}\n", i, i, i, i);
+		}
+		else
+		{
+			out.Write("\tuv[%d] = float3(0.0, 0.0, 0.0);\n\tuvdx[%d] = float2(0.0, 0.0);\n\tuvdy[%d] = float2(0.0, 0.0);\n", i, i, i);
+		}
+	}
+
+	// indirect texture map lookup
+	out.Write("\tint3 indtex[4];\n");
+	for (int i = 0; i < 4; ++i)
+	{
+		out.Write("\tindtex[%d] = int3(0, 0, 0);\n", i);
+		out.Write("\tif (%d < num_indstages && (used_indstages & %du) != 0u)\n\t{\n", i, 1 << i);
+		out.Write("\t\tuint coord = bitfield(uconfig.y, %du, 3u);\n", 6 * i);
+		out.Write("\t\tuint map = bitfield(uconfig.y, %du, 3u);\n", 6 * i + 3);
+		out.Write("\t\tint2 scale = " I_INDTEXSCALE "[%d].%s;\n", i / 2, (i & 1) ? "zw" : "xy");
+		out.Write("\t\tint2 t_coord = coord < %du ? (int2(uv[coord].xy) >> scale) : int2(0, 0);\n", numTexgen);
+		out.Write("\t\tfloat2 gscale = exp2(-float2(scale));\n");
+		out.Write("\t\tindtex[%d] = SampleTex(map, float2(t_coord), uvdx[coord] * gscale, uvdy[coord] * gscale).abg;\n\t}\n", i);
+	}
+
+	out.Write("\tint4 col0 = int4(round(colors_0 * 255.0));\n"
+		"\tint4 col1 = int4(round(colors_1 * 255.0));\n"
+		"\tint4 regs[4] = { " I_COLORS "[0], " I_COLORS "[1], " I_COLORS "[2], " I_COLORS "[3] };\n"
+		"\tint a_bump = 0;\n"
+		"\tint3 tevcoord = int3(0, 0, 0);\n"
+		"\tint4 last_tex_t = int4(0, 0, 0, 0);\n"
+		"\tuint last_cdest = 0u, last_adest = 0u;\n");
+
+	out.Write("\t[loop]\n\tfor (uint n = 0u; n <= num_stages; n++)\n\t{\n");
+	out.Write("\t\tuint ind = ustage[n].z;\n"
+		"\t\tuint order = ustage[n].w;\n"
+		"\t\tuint texcoord = bitfield(order, 0u, 3u);\n");
+	out.Write("\t\tbool has_texcoord = texcoord < %du;\n", numTexgen);
+	out.Write("%s", s_uber_indirect);
+	out.Write("%s", s_uber_stage);
+	out.Write("\t}\n");
+
+	// The results of the last texenv stage are put onto the screen,
+	// regardless of the used destination register
+	out.Write("\tint4 prev = int4(regs[last_cdest].rgb, regs[last_adest].a) & 255;\n");
+
+	// Alpha test
+	out.Write("\tif (bitfield(uconfig.x, 15u, 2u) != %du)\n\t{\n", AlphaTest::PASS);
+	out.Write("\t\tbool comp0 = AlphaCompare(bitfield(uconfig.x, 17u, 3u), prev.a, " I_ALPHA ".r);\n"
+		"\t\tbool comp1 = AlphaCompare(bitfield(uconfig.x, 20u, 3u), prev.a, " I_ALPHA ".g);\n"
+		"\t\tuint logic = bitfield(uconfig.x, 23u, 2u);\n"
+		"\t\tbool pass = logic == 0u ? (comp0 && comp1) : (logic == 1u ? (comp0 || comp1) : (logic == 2u ? (comp0 != comp1) : (comp0 == comp1)));\n"
+		"\t\tif (!pass)\n\t\t{\n"
+		"\t\t\tocol0 = float4(0.0, 0.0, 0.0, 0.0);\n");
+	if (dual_source)
+		out.Write("\t\t\tocol1 = float4(0.0, 0.0, 0.0, 0.0);\n");
+	if (per_pixel_depth)
+		out.Write("\t\t\tdepth = 0.0;\n");
+	out.Write("\t\t\tif (bitfield(uconfig.x, 25u, 1u) == 0u)\n\t\t\t\tdiscard;\n\t\t}\n\t}\n");
+
+	// Depth
+	out.Write("\tint zCoord;\n"
+		"\tif (bitfield(uconfig.z, 11u, 1u) != 0u)\n\t{\n"
+		"\t\tfloat2 screenpos = rawpos.xy * " I_EFBSCALE ".xy;\n"
+		"\t\tzCoord = int(" I_ZSLOPE ".z + " I_ZSLOPE ".x * screenpos.x + " I_ZSLOPE ".y * screenpos.y);\n"
+		"\t}\n"
+		"\telse if (bitfield(uconfig.z, 12u, 1u) != 0u)\n\t{\n"
+		"\t\tzCoord = int(round((1.0 - rawpos.z) * 16777216.0));\n"
+		"\t}\n"
+		"\telse\n\t{\n"
+		"\t\tzCoord = " I_ZBIAS "[1].x + int(round((clipPos.z / clipPos.w) * float(" I_ZBIAS "[1].y)));\n"
+		"\t}\n"
+		"\tzCoord = clamp(zCoord, 0, 0xFFFFFF);\n");
+	if (per_pixel_depth)
+		out.Write("\tif (bitfield(uconfig.z, 7u, 1u) != 0u)\n\t\tdepth = 1.0 - float(zCoord) / 16777216.0;\n");
+	// depth texture can safely be ignored if the result won't be written to the depth buffer and isn't used for fog either
+	out.Write("\tuint ztex_op = bitfield(uconfig.z, 5u, 2u);\n");
+	out.Write("\tif (ztex_op != 0u && %s)\n\t{\n", per_pixel_depth ? "true" : "bitfield(uconfig.z, 0u, 3u) != 0u");
+	out.Write("\t\tzCoord = idot(" I_ZBIAS "[0].xyzw, last_tex_t.xyzw) + " I_ZBIAS "[1].w + (ztex_op == 1u ? zCoord : 0);\n"
+		"\t\tzCoord = zCoord & 0xFFFFFF;\n\t}\n");
+	if (per_pixel_depth)
+		out.Write("\tif (bitfield(uconfig.z, 8u, 1u) != 0u)\n\t\tdepth = 1.0 - float(zCoord) / 16777216.0;\n");
+
+	out.Write("%s", s_uber_fog);
+
+	out.Write("\tbool rgba6_format = bitfield(uconfig.z, 9u, 1u) != 0u;\n"
+		"\tif (rgba6_format && bitfield(uconfig.z, 10u, 1u) != 0u)\n\t{\n"
+		"\t\tint2 ditherindex = int2(rawpos.xy) & 3;\n"
+		"\t\tprev.rgb = prev.rgb + bayer[ditherindex.y * 4 + ditherindex.x];\n"
+		"\t}\n"
+		"\tif (rgba6_format)\n"
+		"\t\tprev = clamp(prev, 0, 255) & 252;\n");
+
+	if (dual_source)
+	{
+		// Colors will be blended against the alpha from ocol1 and
+		// the alpha from ocol0 will be written to the framebuffer.
+		out.Write("\tocol1 = float4(prev) * (1.0/255.0);\n"
+			"\tprev.a = " I_ALPHA ".a;\n"
+			"\tif (rgba6_format)\n"
+			"\t\tprev.a = prev.a & 252;\n");
+	}
+	out.Write("\tocol0 = float4(prev) * (1.0/255.0);\n");
+
+	if (uid_data.bounding_box)
+	{
+		out.Write(
+			"\tif(bbox_data[0] > int(rawpos.x)) InterlockedMin(bbox_data[0], int(rawpos.x));\n"
+			"\tif(bbox_data[1] < int(rawpos.x)) InterlockedMax(bbox_data[1], int(rawpos.x));\n"
+			"\tif(bbox_data[2] > int(rawpos.y)) InterlockedMin(bbox_data[2], int(rawpos.y));\n"
+			"\tif(bbox_data[3] < int(rawpos.y)) InterlockedMax(bbox_data[3], int(rawpos.y));\n");
+	}
+	out.Write("}\n");
+	if (codebuffer[UBERPIXELSHADERGEN_BUFFERSIZE - 1] != 0x7C)
+		PanicAlert("UberShader generator - buffer too small, canary has been eaten!");
+}
@@ -0,0 +1,53 @@
+// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "VideoCommon/ConstantManager.h"
+#include "VideoCommon/PixelShaderGen.h"
+#include "VideoCommon/ShaderGenCommon.h"
+
+// Pixel ubershader.
+// Interprets the TEV configuration of a pixel_shader_uid_data from a constant buffer instead of
+// baking it into the code, so a handful of shaders can render any draw while the specialized
+// shader is still being compiled in the background. Only the parts of the uid that change the
+// shader interface select a variant.
+
+#pragma pack(1)
+struct uber_pixel_shader_uid_data
+{
+	u32 NumValues() const
+	{
+		return sizeof(uber_pixel_shader_uid_data);
+	}
+	u32 StartValue() const
+	{
+		return 0;
+	}
+	void ClearUnused()
+	{
+	}
+
+	u32 numTexgens : 4;
+	u32 render_mode : 2;
+	u32 per_pixel_depth : 1;
+	u32 forced_early_z : 1;
+	u32 stereo : 1;
+	u32 msaa : 1;
+	u32 ssaa : 1;
+	u32 bounding_box : 1;
+	u32 pad : 20;
+};
+#pragma pack()
+
+#define UBERPIXELSHADERGEN_BUFFERSIZE 65536
+typedef ShaderUid<uber_pixel_shader_uid_data> UberPixelShaderUid;
+
+// Returns false if the ubershader can't render this configuration (pixel lighting, alpha pass, ...).
+bool GetUberPixelShaderUID(UberPixelShaderUid& out, const pixel_shader_uid_data& uid_data);
+
+// Packs the TEV configuration of uid_data in the layout expected by the ubershader.
+void GetUberPixelShaderConstants(UberPixelShaderConstants& out, const pixel_shader_uid_data& uid_data);
+
+void GenerateUberPixelShaderCodeD3D11(ShaderCode& object, const uber_pixel_shader_uid_data& uid_data);
@@ -2,6 +2,7 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <cinttypes>
 #include <memory>
 #include <vector>
@@ -57,6 +58,17 @@ VertexLoaderUID::VertexLoaderUID(const TVtxDesc& VtxDesc, const VAT& vat)
 	mask &= VtxDesc.Tex6Coord || VtxDesc.Tex6MatIdx ? fullmask : ~VAT_2_TEX6BITS;
 	mask &= VtxDesc.Tex7Coord || VtxDesc.Tex7MatIdx ? fullmask : ~VAT_2_TEX7BITS;
 	vid[3] = vat.g2.Hex & mask;
+	UpdateHash();
+}
+
+VertexLoaderUID::VertexLoaderUID(const u32* elements)
+{
+	std::copy(elements, elements + 4, vid);
+	UpdateHash();
+}
+
+void VertexLoaderUID::UpdateHash()
+{
 	hash = CalculateHash();
 	if (sizeof(size_t) >= sizeof(u64))
 	{
@@ -111,6 +123,15 @@ u32 VertexLoaderUID::GetElement(u32 idx) const
 	return vid[idx];
 }
 
+void VertexLoaderUID::GetDescriptor(TVtxDesc& VtxDesc, VAT& vat) const
+{
+	// posmtxidx is stored in the free bit of VAT group 1, see the constructor
+	VtxDesc.Hex = ((u64)vid[0] << 1) | (vid[2] >> 31);
+	vat.g0.Hex = vid[1];
+	vat.g1.Hex = vid[2] & 0x7FFFFFFFu;
+	vat.g2.Hex = vid[3];
+}
+
 u64 VertexLoaderUID::CalculateHash()
 {
 	u64 h = -1;
@@ -30,13 +30,18 @@ class VertexLoaderUID
 	size_t platformhash;
 public:
 	VertexLoaderUID(const TVtxDesc& VtxDesc, const VAT& vat);
+	// Builds the uid from the 4 elements returned by GetElement.
+	explicit VertexLoaderUID(const u32* elements);
 	bool operator < (const VertexLoaderUID &other) const;
 	bool operator == (const VertexLoaderUID& rh) const;
 	u64 GetHash() const;
 	size_t GetplatformHash() const;
 	u32 GetElement(u32 idx) const;
+	// Rebuilds a descriptor that selects this loader, the fields masked out by the uid are zero.
+	void GetDescriptor(TVtxDesc& VtxDesc, VAT& vat) const;
 private:
 	u64 CalculateHash();
+	void UpdateHash();
 };
 
 namespace std
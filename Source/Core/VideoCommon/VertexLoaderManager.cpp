@@ -5,15 +5,20 @@
 
 #include <map>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
 
 
 #include "Core/ConfigManager.h"
 #include "Core/HW/Memmap.h"
 
+#include "Common/FileUtil.h"
+#include "Common/LinearDiskCache.h"
+#include "Common/StringUtil.h"
 #include "Common/ThreadPool.h"
 
 #include "VideoCommon/IndexGenerator.h"
+#include "VideoCommon/OpcodeDecoding.h"
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/VertexLoaderManager.h"
 #include "VideoCommon/VertexManagerBase.h"
@@ -30,8 +35,20 @@ namespace VertexLoaderManager
 {
 static VertexLoaderMap s_vertex_loader_map;
 static NativeVertexFormatMap s_native_vertex_map;
+// Loaders are also created by the predictive fifo worker.
+static std::mutex s_loader_map_lock;
 static NativeVertexFormat* s_current_vtx_fmt;
 u32 g_current_components;
+
+// Every loader uid seen by a game is persisted, so the next boot builds the loaders up front
+// instead of generating them in the middle of the first frames that use them.
+struct VertexLoaderCacheKey
+{
+	u32 vid[4];
+};
+// The value is the vertex size, used to reject entries that no longer match the loader.
+static LinearDiskCache<VertexLoaderCacheKey, u32> s_loader_disk_cache;
+
 // TODO - change into array of pointers. Keep a map of all seen so far.
 // Used in D3D12 backend, to populate input layouts used by cached-to-disk PSOs.
 NativeVertexFormatMap* GetNativeVertexFormatMap()
@@ -44,6 +61,14 @@ NativeVertexFormat* GetCurrentVertexFormat()
 	return s_current_vtx_fmt;
 }
 
+static VertexLoaderCacheKey GetCacheKey(const VertexLoaderUID& uid)
+{
+	VertexLoaderCacheKey key;
+	for (u32 i = 0; i < 4; i++)
+		key.vid[i] = uid.GetElement(i);
+	return key;
+}
+
 namespace
 {
 struct entry
@@ -167,6 +192,7 @@ void AppendListToString(std::string *dest)
 	std::vector<entry> entries;
 
 	size_t total_size = 0;
+	std::lock_guard<std::mutex> lk(s_loader_map_lock);
 	for (VertexLoaderMap::const_iterator iter = s_vertex_loader_map.begin(); iter != s_vertex_loader_map.end(); ++iter)
 	{
 		entry e;
@@ -183,18 +209,57 @@ void AppendListToString(std::string *dest)
 	}
 }
 
+class VertexLoaderCacheInserter : public LinearDiskCacheReader<VertexLoaderCacheKey, u32>
+{
+public:
+	void Read(const VertexLoaderCacheKey& key, const u32* value, u32 value_size) override
+	{
+		TVtxDesc VtxDesc;
+		VAT vat;
+		VertexLoaderUID stored(key.vid);
+		stored.GetDescriptor(VtxDesc, vat);
+		VertexLoaderUID uid(VtxDesc, vat);
+		if (value_size != 1 || !(uid == stored) ||
+			s_vertex_loader_map.find(uid) != s_vertex_loader_map.end())
+			return;
+		std::unique_ptr<VertexLoaderBase> loader = VertexLoaderBase::CreateVertexLoader(VtxDesc, vat);
+		if (static_cast<u32>(loader->m_VertexSize) != *value)
+			return;
+		// The native formats are bound on first use, the backend is not ready yet
+		s_vertex_loader_map[uid] = std::move(loader);
+		INCSTAT(stats.numVertexLoaders);
+	}
+};
+
+static void LoadLoaderCache()
+{
+	if (last_game_code.empty())
+		return;
+	if (!File::Exists(File::GetUserPath(D_SHADERCACHE_IDX)))
+		File::CreateDir(File::GetUserPath(D_SHADERCACHE_IDX));
+	std::string cache_filename = StringFromFormat("%sIVL-%s.cache",
+		File::GetUserPath(D_SHADERCACHE_IDX).c_str(), last_game_code.c_str());
+	VertexLoaderCacheInserter inserter;
+	std::lock_guard<std::mutex> lk(s_loader_map_lock);
+	s_loader_disk_cache.OpenAndRead(cache_filename, inserter);
+}
+
 void Init()
 {
 	MarkAllDirty();
 	for (VertexLoaderBase*& vertexLoader : g_main_cp_state.vertex_loaders)
 		vertexLoader = nullptr;
 	last_game_code = SConfig::GetInstance().m_strGameID;
+	LoadLoaderCache();
 }
 
 void Shutdown()
 {
+	std::lock_guard<std::mutex> lk(s_loader_map_lock);
 	if (s_vertex_loader_map.size() > 0 && g_ActiveConfig.bDumpVertexLoaders)
 		DumpLoadersCode();
+	s_loader_disk_cache.Sync();
+	s_loader_disk_cache.Close();
 	s_vertex_loader_map.clear();
 	s_native_vertex_map.clear();
 }
@@ -242,21 +307,34 @@ void MarkAllDirty()
 inline VertexLoaderBase *GetOrAddLoader(const TVtxDesc &VtxDesc, const VAT &VtxAttr)
 {
 	VertexLoaderUID uid(VtxDesc, VtxAttr);
+	std::lock_guard<std::mutex> lk(s_loader_map_lock);
 	VertexLoaderMap::iterator iter = s_vertex_loader_map.find(uid);
+	VertexLoaderBase* loader;
 	if (iter == s_vertex_loader_map.end())
 	{
 		s_vertex_loader_map[uid] = VertexLoaderBase::CreateVertexLoader(VtxDesc, VtxAttr);
-		VertexLoaderBase* loader = s_vertex_loader_map[uid].get();
-		loader->m_native_vertex_format = GetNativeVertexFormat(loader->m_native_vtx_decl);
-		VertexLoaderBase * fallback = loader->GetFallback();
-		if (fallback)
+		loader = s_vertex_loader_map[uid].get();
+		if (!last_game_code.empty())
 		{
-			fallback->m_native_vertex_format = GetNativeVertexFormat(fallback->m_native_vtx_decl);
+			u32 vertex_size = loader->m_VertexSize;
+			s_loader_disk_cache.Append(GetCacheKey(uid), &vertex_size, 1);
 		}
 		INCSTAT(stats.numVertexLoaders);
-		return loader;
 	}
-	return iter->second.get();
+	else
+	{
+		loader = iter->second.get();
+		// Loaders preloaded from the disk cache get their native format here
+		if (loader->m_native_vertex_format)
+			return loader;
+	}
+	loader->m_native_vertex_format = GetNativeVertexFormat(loader->m_native_vtx_decl);
+	VertexLoaderBase * fallback = loader->GetFallback();
+	if (fallback)
+	{
+		fallback->m_native_vertex_format = GetNativeVertexFormat(fallback->m_native_vtx_decl);
+	}
+	return loader;
 }
 
 void GetVertexSizeAndComponents(const VertexLoaderParameters &parameters, u32 &vertexsize, u32 &components)
@@ -275,7 +353,7 @@ inline void UpdateLoader(const VertexLoaderParameters &parameters)
 	g_main_cp_state.last_id = parameters.vtx_attr_group;
 }
 
-bool ConvertVertices(VertexLoaderParameters &parameters, u32 &readsize, u32 &writesize)
+VertexLoaderBase* GetLoader(const VertexLoaderParameters &parameters)
 {
 	if (parameters.needloaderrefresh)
 	{
@@ -286,6 +364,49 @@ bool ConvertVertices(VertexLoaderParameters &parameters, u32 &readsize, u32 &wri
 	{
 		loader = loader->GetFallback();
 	}
+	return loader;
+}
+
+inline void PrepareNativeFormat(VertexLoaderBase* loader, int primitive, u32 count)
+{
+	NativeVertexFormat *nativefmt = loader->m_native_vertex_format;
+	// Flush if our vertex format is different from the currently set.
+	if (s_current_vtx_fmt != nullptr && s_current_vtx_fmt != nativefmt)
+	{
+		VertexManagerBase::Flush();
+	}
+	s_current_vtx_fmt = nativefmt;
+	g_current_components = loader->m_native_components;
+	VertexManagerBase::PrepareForAdditionalData(primitive, count, loader->m_native_stride);
+}
+
+// Adds the indices of the vertices just written to vertices
+static inline void AddIndices(VertexLoaderBase* loader, int primitive, const u8* vertices, u32 count)
+{
+	if (g_ActiveConfig.bCPUCull && primitive == GX_DRAW_TRIANGLES)
+	{
+		const u32 culled = IndexGenerator::AddTrianglesCulled(
+			vertices + loader->m_native_vtx_decl.position.offset, loader->m_native_stride, count);
+		ADDSTAT(stats.thisFrame.numPrimsCulled, culled * 3);
+	}
+	else
+	{
+		IndexGenerator::AddIndices(primitive, count);
+	}
+	ADDSTAT(stats.thisFrame.numPrims, count);
+}
+
+static inline bool CullDraw(int primitive, u32 count)
+{
+	if (!g_ActiveConfig.bCPUCull || !VertexManagerBase::CanCullDraw(primitive))
+		return false;
+	ADDSTAT(stats.thisFrame.numPrimsCulled, count);
+	return true;
+}
+
+bool ConvertVertices(VertexLoaderParameters &parameters, u32 &readsize, u32 &writesize)
+{
+	auto loader = GetLoader(parameters);
 	readsize = parameters.count * loader->m_VertexSize;
 	if (parameters.buf_size < readsize)
 		return false;
@@ -293,26 +414,35 @@ bool ConvertVertices(VertexLoaderParameters &parameters, u32 &readsize, u32 &wri
 	{
 		return true;
 	}
-	// Lookup pointers for any vertex arrays.
-	UpdateVertexArrayPointers();
-	NativeVertexFormat *nativefmt = loader->m_native_vertex_format;
-	// Flush if our vertex format is different from the currently set.
-	if (s_current_vtx_fmt != nullptr && s_current_vtx_fmt != nativefmt)
+	if (CullDraw(parameters.primitive, parameters.count))
 	{
-		VertexManagerBase::Flush();
+		writesize = 0;
+		return true;
 	}
-	s_current_vtx_fmt = nativefmt;
-	g_current_components = loader->m_native_components;
-	VertexManagerBase::PrepareForAdditionalData(parameters.primitive, parameters.count, loader->m_native_stride);
+	// Lookup pointers for any vertex arrays.
+	UpdateVertexArrayPointers();
+	PrepareNativeFormat(loader, parameters.primitive, parameters.count);
 	parameters.destination = VertexManagerBase::s_pCurBufferPointer;
 	s32 finalcount = loader->RunVertices(parameters);
 	writesize = loader->m_native_stride * finalcount;
-	IndexGenerator::AddIndices(parameters.primitive, finalcount);
-	ADDSTAT(stats.thisFrame.numPrims, finalcount);
+	AddIndices(loader, parameters.primitive, parameters.destination, finalcount);
 	INCSTAT(stats.thisFrame.numPrimitiveJoins);
 	return true;
 }
 
+u32 AppendConvertedVertices(VertexLoaderBase* loader, int primitive, const u8* data, u32 count)
+{
+	if (CullDraw(primitive, count))
+		return 0;
+	PrepareNativeFormat(loader, primitive, count);
+	u32 writesize = loader->m_native_stride * count;
+	memcpy(VertexManagerBase::s_pCurBufferPointer, data, writesize);
+	loader->m_numLoadedVertices += count;
+	AddIndices(loader, primitive, VertexManagerBase::s_pCurBufferPointer, count);
+	INCSTAT(stats.thisFrame.numPrimitiveJoins);
+	return writesize;
+}
+
 int GetVertexSize(const VertexLoaderParameters &parameters)
 {
 	if (parameters.needloaderrefresh)
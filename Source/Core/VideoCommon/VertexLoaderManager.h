@@ -23,6 +23,13 @@ int GetVertexSize(const VertexLoaderParameters &parameters);
 
 bool ConvertVertices(VertexLoaderParameters &parameters, u32 &readsize, u32 &writesize);
 
+// Returns the loader ConvertVertices would use for these parameters.
+VertexLoaderBase* GetLoader(const VertexLoaderParameters &parameters);
+
+// Appends vertices that were already converted to the native format of loader,
+// returns the number of bytes written to the vertex buffer.
+u32 AppendConvertedVertices(VertexLoaderBase* loader, int primitive, const u8* data, u32 count);
+
 void GetVertexSizeAndComponents(const VertexLoaderParameters &parameters, u32 &vertexsize, u32 &components);
 
 // For debugging
@@ -25,6 +25,13 @@ static const X64Reg count_reg = R10;
 static const X64Reg skipped_reg = R11;
 static const u32 MASKINDEXED = INDEX8 & INDEX16;
 static const X64Reg base_reg = RBX;
+// Texture coordinate scales are kept in registers for the whole loader.
+static const X64Reg s_texcoord_scale_regs[8] = {
+	XMM4, XMM5, XMM6, XMM7,
+	XMM8, XMM9, XMM10, XMM11,
+};
+// Vertices converted per iteration by the grouped loop.
+static const u32 VERTEX_GROUP_SIZE = 4;
 
 static const u8* memory_base_ptr = (u8*)&g_main_cp_state.array_strides;
 
@@ -54,7 +61,7 @@ VertexLoaderX64::VertexLoaderX64(const TVtxDesc& vtx_desc, const VAT& vtx_att) :
 	if (!IsInitialized())
 		return;
 
-	AllocCodeSpace(1024, false);
+	AllocCodeSpace(4096, false);
 	ClearCodeSpace();
 	GenerateVertexLoader();
 	WriteProtect();
@@ -367,54 +374,13 @@ void VertexLoaderX64::ReadColor(OpArg data, u64 attribute, int format)
 		m_src_ofs += load_bytes;
 }
 
-void VertexLoaderX64::GenerateVertexLoader()
+void VertexLoaderX64::GenerateVertex()
 {
-	BitSet32 regs = { src_reg, dst_reg, scratch1, scratch2, scratch3, count_reg, skipped_reg, base_reg };
-	regs &= ABI_ALL_CALLEE_SAVED;
-	ABI_PushRegistersAndAdjustStack(regs, 0);
-
-	// Backup count since we're going to count it down.
-	PUSH(32, R(ABI_PARAM3));
-
-	// ABI_PARAM3 is one of the lower registers, so free it for scratch2.
-	MOV(32, R(count_reg), R(ABI_PARAM3));
-
-	MOV(64, R(base_reg), R(ABI_PARAM4));
-	// Load Contants into registers outside the main loop to reduce memory overhead
-	if (m_VtxAttr.PosFormat != FORMAT_FLOAT && m_VtxAttr.ByteDequant)
-	{
-		MOVAPD(XMM2, MPIC(&scale_factors[0]));
-	}
-	if (m_VtxDesc.Normal)
-	{
-		MOVAPD(XMM3, MPIC(&scale_factors[m_VtxAttr.NormalFormat + 1]));
-	}
-
 	const u64 tc[8] = {
 		m_VtxDesc.Tex0Coord, m_VtxDesc.Tex1Coord, m_VtxDesc.Tex2Coord, m_VtxDesc.Tex3Coord,
 		m_VtxDesc.Tex4Coord, m_VtxDesc.Tex5Coord, m_VtxDesc.Tex6Coord, m_VtxDesc.Tex7Coord,
 	};
-	const X64Reg treg[8] = {
-		XMM4, XMM5, XMM6, XMM7,
-		XMM8, XMM9, XMM10, XMM11,
-	};
-
-	if (m_VtxAttr.ByteDequant)
-	{
-		for (int i = 0; i < 8; i++)
-		{
-			if (tc[i] && m_VtxAttr.texCoord[i].Format != FORMAT_FLOAT)
-			{
-				MOVAPD(treg[i], MPIC(&scale_factors[5 + i]));
-			}
-		}
-	}
-
-	if (m_VtxDesc.Position & MASKINDEXED)
-		XOR(32, R(skipped_reg), R(skipped_reg));
-
-	const u8* loop_start = GetCodePtr();
-
+	const u32 vertex_src_ofs = m_src_ofs;
 	if (m_VtxDesc.PosMatIdx)
 	{
 		m_src_ofs++;
@@ -477,7 +443,7 @@ void VertexLoaderX64::GenerateVertexLoader()
 		{
 			data = GetVertexAddr(ARRAY_TEXCOORD0 + i, tc[i]);
 			ReadVertex(data, tc[i], m_VtxAttr.texCoord[i].Format, elements, tm[i] ? 2 : elements,
-				m_VtxAttr.ByteDequant, &m_native_vtx_decl.texcoords[i], treg[i]);
+				m_VtxAttr.ByteDequant, &m_native_vtx_decl.texcoords[i], s_texcoord_scale_regs[i]);
 			m_native_components |= VB_HAS_UV0 << i;
 		}
 		if (tm[i])
@@ -506,7 +472,7 @@ void VertexLoaderX64::GenerateVertexLoader()
 	}
 	if (m_VtxDesc.PosMatIdx)
 	{
-		MOVZX(32, 8, scratch1, MDisp(src_reg, 0));
+		MOVZX(32, 8, scratch1, MDisp(src_reg, vertex_src_ofs));
 	}
 	else
 	{
@@ -519,16 +485,73 @@ void VertexLoaderX64::GenerateVertexLoader()
 	m_native_vtx_decl.posmtx.offset = m_dst_ofs;
 	m_native_vtx_decl.posmtx.type = FORMAT_UBYTE;
 	m_dst_ofs += sizeof(u32);
+}
+
+void VertexLoaderX64::GenerateVertexLoader()
+{
+	BitSet32 regs = { src_reg, dst_reg, scratch1, scratch2, scratch3, count_reg, skipped_reg, base_reg };
+	regs &= ABI_ALL_CALLEE_SAVED;
+	ABI_PushRegistersAndAdjustStack(regs, 0);
+
+	// Backup count since we're going to count it down.
+	PUSH(32, R(ABI_PARAM3));
+
+	// ABI_PARAM3 is one of the lower registers, so free it for scratch2.
+	MOV(32, R(count_reg), R(ABI_PARAM3));
+
+	MOV(64, R(base_reg), R(ABI_PARAM4));
+	// Load Contants into registers outside the main loop to reduce memory overhead
+	if (m_VtxAttr.PosFormat != FORMAT_FLOAT && m_VtxAttr.ByteDequant)
+	{
+		MOVAPD(XMM2, MPIC(&scale_factors[0]));
+	}
+	if (m_VtxDesc.Normal)
+	{
+		MOVAPD(XMM3, MPIC(&scale_factors[m_VtxAttr.NormalFormat + 1]));
+	}
+
+	const u64 tc[8] = {
+		m_VtxDesc.Tex0Coord, m_VtxDesc.Tex1Coord, m_VtxDesc.Tex2Coord, m_VtxDesc.Tex3Coord,
+		m_VtxDesc.Tex4Coord, m_VtxDesc.Tex5Coord, m_VtxDesc.Tex6Coord, m_VtxDesc.Tex7Coord,
+	};
+
+	if (m_VtxAttr.ByteDequant)
+	{
+		for (int i = 0; i < 8; i++)
+		{
+			if (tc[i] && m_VtxAttr.texCoord[i].Format != FORMAT_FLOAT)
+			{
+				MOVAPD(s_texcoord_scale_regs[i], MPIC(&scale_factors[5 + i]));
+			}
+		}
+	}
+
+	if (m_VtxDesc.Position & MASKINDEXED)
+		XOR(32, R(skipped_reg), R(skipped_reg));
+
+	// Vertices are grouped when there are no skipped vertices to account for.
+	const bool group_vertices = cpu_info.bSSSE3 && !(m_VtxDesc.Position & MASKINDEXED);
+	FixupBranch to_group;
+	if (group_vertices)
+		to_group = J(true);
+
+	// One vertex per iteration, also handles the vertices left over by the groups.
+	const u8* loop_start = GetCodePtr();
+	GenerateVertex();
+	const PortableVertexDeclaration vtx_decl = m_native_vtx_decl;
+	const u32 native_stride = m_dst_ofs;
+	const u32 vertex_size = m_src_ofs;
 
 	// Prepare for the next vertex.
 
-	ADD(64, R(dst_reg), Imm32(m_dst_ofs));
+	ADD(64, R(dst_reg), Imm32(native_stride));
 	const u8* cont = GetCodePtr();
-	ADD(64, R(src_reg), Imm32(m_src_ofs));
+	ADD(64, R(src_reg), Imm32(vertex_size));
 
 	SUB(32, R(count_reg), Imm8(1));
 	J_CC(CC_NZ, loop_start);
 
+	const u8* loop_exit = GetCodePtr();
 	// Get the original count.
 	POP(32, R(ABI_RETURN));
 
@@ -547,6 +570,44 @@ void VertexLoaderX64::GenerateVertexLoader()
 	{
 		RET();
 	}
+
+	if (group_vertices)
+	{
+		SetJumpTarget(to_group);
+		// The unrolled body only fits when the vertex code is short, otherwise keep the single loop.
+		const size_t vertex_code_size = cont - loop_start;
+		if (GetSpaceLeft() > vertex_code_size * VERTEX_GROUP_SIZE + 64)
+		{
+			// VERTEX_GROUP_SIZE vertices per iteration at constant offsets from the group base,
+			// so the loads and conversions of neighbouring vertices are independent.
+			const u8* group_start = GetCodePtr();
+			CMP(32, R(count_reg), Imm8(VERTEX_GROUP_SIZE));
+			FixupBranch to_tail = J_CC(CC_B, true);
+			for (u32 i = 0; i < VERTEX_GROUP_SIZE; i++)
+			{
+				m_src_ofs = i * vertex_size;
+				m_dst_ofs = i * native_stride;
+				GenerateVertex();
+			}
+			ADD(64, R(dst_reg), Imm32(native_stride * VERTEX_GROUP_SIZE));
+			ADD(64, R(src_reg), Imm32(vertex_size * VERTEX_GROUP_SIZE));
+			SUB(32, R(count_reg), Imm8(VERTEX_GROUP_SIZE));
+			JMP(group_start, true);
+
+			SetJumpTarget(to_tail);
+			TEST(32, R(count_reg), R(count_reg));
+			J_CC(CC_NZ, loop_start);
+			JMP(loop_exit, true);
+		}
+		else
+		{
+			JMP(loop_start, true);
+		}
+		// The group bodies rewrote the offsets of the declaration with the ones of the last vertex.
+		m_native_vtx_decl = vtx_decl;
+	}
+	m_src_ofs = vertex_size;
+	m_dst_ofs = native_stride;
 	m_native_stride = m_dst_ofs;
 	m_VertexSize = m_src_ofs;
 	m_native_vtx_decl.stride = m_native_stride;
@@ -20,5 +20,6 @@ private:
 	Gen::OpArg GetVertexAddr(int array, u64 attribute);
 	int ReadVertex(Gen::OpArg data, u64 attribute, int format, int count_in, int count_out, bool dequantize, AttributeFormat* native_format, Gen::X64Reg scaling_register);
 	void ReadColor(Gen::OpArg data, u64 attribute, int format);
+	void GenerateVertex();
 	void GenerateVertexLoader();
 };
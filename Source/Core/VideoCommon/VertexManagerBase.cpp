@@ -5,10 +5,15 @@
 #include <memory>
 
 #include "Common/CommonTypes.h"
+#include "Common/Trace.h"
 
+#include "VideoCommon/BoundingBox.h"
+#include "VideoCommon/BPFunctions.h"
 #include "VideoCommon/BPStructs.h"
 #include "VideoCommon/Debugger.h"
+#include "VideoCommon/FramebufferManagerBase.h"
 #include "VideoCommon/GeometryShaderManager.h"
+#include "VideoCommon/GPUProfilerBase.h"
 #include "VideoCommon/TessellationShaderManager.h"
 #include "VideoCommon/IndexGenerator.h"
 #include "VideoCommon/NativeVertexFormat.h"
@@ -38,6 +43,7 @@ PrimitiveType VertexManagerBase::current_primitive_type;
 
 bool VertexManagerBase::IsFlushed;
 bool VertexManagerBase::s_cull_all;
+bool VertexManagerBase::s_zfreeze_used = false;
 
 static const PrimitiveType primitive_from_gx[8] = {
 	PRIMITIVE_TRIANGLES, // GX_DRAW_QUADS
@@ -59,6 +65,8 @@ VertexManagerBase::VertexManagerBase()
 {
 	IsFlushed = true;
 	s_cull_all = false;
+	// The backend info is complete once the backend creates its vertex manager.
+	IndexGenerator::Init();
 }
 
 VertexManagerBase::~VertexManagerBase()
@@ -73,6 +81,15 @@ inline u32 GetRemainingIndices(int prim)
 {
 	GxDrawMode primitive = static_cast<GxDrawMode>(prim);
 	u32 index_len = VertexManagerBase::MAXIBUFFERSIZE - IndexGenerator::GetIndexLen();
+	if (IndexGenerator::UsesPrimitiveRestart() && primitive <= GX_DRAW_TRIANGLE_FAN)
+	{
+		// Every triangle written separately takes a restart index as well.
+		if (primitive == GX_DRAW_TRIANGLE_STRIP || primitive == GX_DRAW_TRIANGLE_FAN)
+			return index_len / 4 + 2;
+		if (primitive < GX_DRAW_TRIANGLES)
+			return index_len / 5 * 4;
+		return index_len / 4 * 3;
+	}
 	if (primitive == GX_DRAW_TRIANGLE_STRIP || primitive == GX_DRAW_TRIANGLE_FAN)
 	{
 		return index_len / 3 + 2;
@@ -92,6 +109,16 @@ inline u32 GetRemainingIndices(int prim)
 	return 0;
 }
 
+bool VertexManagerBase::CanCullDraw(int primitive)
+{
+	// Nothing is rasterized, so neither the GPU bounding box nor the PE counters see the draw. The
+	// CPU bounding box works on the vertices though.
+	return primitive <= GX_DRAW_TRIANGLE_FAN
+		&& bpmem.genMode.cullmode == GenMode::CULL_ALL
+		&& !s_zfreeze_used
+		&& !(g_ActiveConfig.iBBoxMode == BBoxCPU && BoundingBox::active);
+}
+
 void VertexManagerBase::PrepareForAdditionalData(int primitive, u32 count, u32 stride)
 {
 	// The SSE vertex loader can write up to 4 bytes past the end
@@ -106,7 +133,7 @@ void VertexManagerBase::PrepareForAdditionalData(int primitive, u32 count, u32 s
 	{		
 #if defined(_DEBUG) || defined(DEBUGFAST)
 		if (count > IndexGenerator::GetRemainingIndices())
-			ERROR_LOG(VIDEO, "Too little remaining index values. Use 32-bit or reset them on flush.");
+			ERROR_LOG(VIDEO, "Too little remaining index values. The backend has no 32 bit indices.");
 		if (count > GetRemainingIndices(primitive))
 			ERROR_LOG(VIDEO, "VertexManagerBase: Buffer not large enough for all indices! "
 				"Increase MAXIBUFFERSIZE or we need primitive breaking after all.");
@@ -128,6 +155,10 @@ void VertexManagerBase::PrepareForAdditionalData(int primitive, u32 count, u32 s
 
 void VertexManagerBase::DoFlush()
 {
+	TRACE_ZONE("VertexManagerBase::DoFlush");
+	INCSTAT(stats.thisFrame.numFlushes);
+	SetGPUPass(GPU_PASS_EFB_DRAW);
+
 	// loading a state will invalidate BP, so check for it
 	NativeVertexFormat* current_vertex_format = VertexLoaderManager::GetCurrentVertexFormat();
 	g_video_backend->CheckInvalidState();
@@ -161,15 +192,9 @@ void VertexManagerBase::DoFlush()
 #endif
 	if (!s_cull_all)
 	{
-		u32 usedtextures = 0;
-		for (u32 i = 0; i < bpmem.genMode.numtevstages + 1u; ++i)
-			if (bpmem.tevorders[i / 2].getEnable(i & 1))
-				usedtextures |= 1 << bpmem.tevorders[i / 2].getTexMap(i & 1);
+		BPFunctions::ResolvePixelFormatChange();
 
-		if (bpmem.genMode.numindstages.Value() > 0)
-			for (u32 i = 0; i < bpmem.genMode.numtevstages + 1u; ++i)
-				if (bpmem.tevind[i].IsActive() && bpmem.tevind[i].bt < bpmem.genMode.numindstages.Value())
-					usedtextures |= 1 << bpmem.tevindref.getTexMap(bpmem.tevind[i].bt);
+		u32 usedtextures = bpmem.GetUsedTextures();
 
 		TextureCacheBase::UnbindTextures();
 		s32 material_mask = 0;
@@ -198,6 +223,7 @@ void VertexManagerBase::DoFlush()
 			PixelShaderManager::SetFlags(0, ~0, material_mask);
 			PixelShaderManager::SetFlags(1, ~0, emissive_mask);
 		}
+		TextureCacheBase::UploadPendingDecodes();
 		g_texture_cache->BindTextures();
 	}
 	// set global constants
@@ -207,15 +233,25 @@ void VertexManagerBase::DoFlush()
 		const PortableVertexDeclaration &vtx_dcl = current_vertex_format->GetVertexDeclaration();
 		if (bpmem.genMode.zfreeze)
 		{
+			s_zfreeze_used = true;
 			if (s_zslope_refresh_required)
 			{
 				PixelShaderManager::SetZSlope(s_zslope.dfdx, s_zslope.dfdy, s_zslope.f0);
 				s_zslope_refresh_required = false;
 			}
 		}
-		else if (IndexGenerator::GetIndexLen() >= 3)
+		else
 		{
-			CalculateZSlope(vtx_dcl, g_vertex_manager->GetIndexBuffer() + IndexGenerator::GetIndexLen() - 3);
+			// Skip the restart index that ends every strip.
+			u32 index_len = IndexGenerator::GetIndexLen();
+			if (IndexGenerator::UsesPrimitiveRestart() && index_len > 0)
+				index_len--;
+			if (index_len >= 3)
+			{
+				const u32 indices[3] = { IndexGenerator::GetIndex(index_len - 3),
+					IndexGenerator::GetIndex(index_len - 2), IndexGenerator::GetIndex(index_len - 1) };
+				CalculateZSlope(vtx_dcl, indices);
+			}
 		}
 
 		// if cull mode is CULL_ALL, ignore triangles and quads
@@ -235,6 +271,7 @@ void VertexManagerBase::DoFlush()
 
 	if (PerfQueryBase::ShouldEmulate())
 		g_perf_query->EnableQuery(bpmem.zcontrol.early_ztest ? PQG_ZCOMP_ZCOMPLOC : PQG_ZCOMP);
+	FramebufferManagerBase::MarkEFBChanged();
 	g_vertex_manager->vFlush(useDstAlpha);
 	if (PerfQueryBase::ShouldEmulate())
 		g_perf_query->DisableQuery(bpmem.zcontrol.early_ztest ? PQG_ZCOMP_ZCOMPLOC : PQG_ZCOMP);
@@ -253,7 +290,7 @@ void VertexManagerBase::DoState(PointerWrap& p)
 	g_vertex_manager->vDoState(p);
 }
 
-void VertexManagerBase::CalculateZSlope(const PortableVertexDeclaration &vert_decl, const u16* indices)
+void VertexManagerBase::CalculateZSlope(const PortableVertexDeclaration &vert_decl, const u32* indices)
 {
 	float out[12];
 	float viewOffset[2] = {
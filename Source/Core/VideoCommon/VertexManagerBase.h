@@ -54,6 +54,8 @@ public:
 
 	static PrimitiveType GetPrimitiveType(int primitive);
 	static void PrepareForAdditionalData(int primitive, u32 count, u32 stride);
+	// With bCPUCull, a draw GX culls entirely isn't loaded at all
+	static bool CanCullDraw(int primitive);
 
 	virtual void PrepareShaders(PrimitiveType primitive, u32 components, const XFMemory &xfr, const BPMemory &bpm, bool ongputhread) = 0;
 	static inline void Flush()
@@ -76,8 +78,10 @@ protected:
 	static bool s_zslope_refresh_required;
 	static Slope s_zslope;
 
-	static void CalculateZSlope(const PortableVertexDeclaration &vert_decl, const u16* indices);
+	static void CalculateZSlope(const PortableVertexDeclaration &vert_decl, const u32* indices);
 	static bool s_cull_all;
+	// The culled draws set the z slope too, keep them once the game uses zfreeze
+	static bool s_zfreeze_used;
 	virtual void vDoState(PointerWrap& p)
 	{}
 
@@ -89,7 +93,6 @@ private:
 	static bool IsFlushed;
 	static void DoFlush();
 	virtual void vFlush(bool useDstAlpha) = 0;
-	virtual u16* GetIndexBuffer() = 0;
 };
 
 extern std::unique_ptr<VertexManagerBase> g_vertex_manager;
\ No newline at end of file
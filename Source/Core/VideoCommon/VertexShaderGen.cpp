@@ -13,13 +13,170 @@
 #include "VideoCommon/BPMemory.h"
 #include "VideoCommon/CPMemory.h"
 #include "VideoCommon/DriverDetails.h"
+#include "VideoCommon/GeometryShaderGen.h"
 #include "VideoCommon/LightingShaderGen.h"
+#include "VideoCommon/Statistics.h"
 #include "VideoCommon/VertexShaderGen.h"
 #include "VideoCommon/VideoConfig.h"
 
 static char text[VERTEXSHADERGEN_BUFFERSIZE];
 static const char *texOffsetMemberSelector[] = { "x", "y", "z", "w" };
 
+// The line/point expansion draws six vertices per primitive without attributes and reads the
+// indices and the native vertices from storage buffers, in the layout the backend passes in
+// I_VTXEXPAND: [0] = stride, first vertex byte, first index, 2 bits of components per texcoord,
+// [1] = normal offsets and the posmtx offset, [2] = color offsets, [3] and [4] = texcoord offsets.
+static void WriteVertexExpandHelpers(ShaderCode& out)
+{
+	out.Write("uniform int4 " I_VTXEXPAND"[5];\n");
+	out.Write("SSBO_BINDING(1) readonly buffer ExpandIndices {\n"
+		"\tuint expand_indices[];\n"
+		"};\n"
+		"SSBO_BINDING(2) readonly buffer ExpandVertices {\n"
+		"\tuint expand_vertices[];\n"
+		"};\n");
+	if (g_ActiveConfig.backend_info.bSupports32BitIndices)
+	{
+		out.Write("uint LoadIndex(int i)\n{\n"
+			"\treturn expand_indices[i];\n"
+			"}\n");
+	}
+	else
+	{
+		out.Write("uint LoadIndex(int i)\n{\n"
+			"\tuint word = expand_indices[i >> 1];\n"
+			"\treturn ((i & 1) != 0) ? (word >> 16) : (word & 0xffffu);\n"
+			"}\n");
+	}
+	out.Write("float LoadFloat(int address)\n{\n"
+		"\treturn uintBitsToFloat(expand_vertices[address >> 2]);\n"
+		"}\n");
+	out.Write("uint4 LoadBytes(int address)\n{\n"
+		"\treturn (uint4(expand_vertices[address >> 2]) >> uint4(0u, 8u, 16u, 24u)) & 0xffu;\n"
+		"}\n");
+}
+
+// Loads the attributes of vertex_index into locals named like the vertex shader inputs
+static void WriteVertexExpandLoads(ShaderCode& out, u32 components)
+{
+	out.Write("int vaddr = " I_VTXEXPAND"[0].y + int(vertex_index) * " I_VTXEXPAND"[0].x;\n");
+	out.Write("float4 rawpos = float4(LoadFloat(vaddr), LoadFloat(vaddr + 4), LoadFloat(vaddr + 8), 1.0);\n");
+	out.Write("uint4 vposmtx = LoadBytes(vaddr + " I_VTXEXPAND"[1].w);\n");
+	for (int i = 0; i < 3; ++i)
+	{
+		if (components & (VB_HAS_NRM0 << i))
+		{
+			out.Write("int naddr%d = vaddr + " I_VTXEXPAND"[1].%s;\n", i, texOffsetMemberSelector[i]);
+			out.Write("float3 rawnorm%d = float3(LoadFloat(naddr%d), LoadFloat(naddr%d + 4), LoadFloat(naddr%d + 8));\n", i, i, i, i);
+		}
+	}
+	for (int i = 0; i < 2; ++i)
+	{
+		if (components & (VB_HAS_COL0 << i))
+			out.Write("float4 color%d = float4(LoadBytes(vaddr + " I_VTXEXPAND"[2].%s)) / 255.0;\n", i, texOffsetMemberSelector[i]);
+	}
+	for (int i = 0; i < 8; ++i)
+	{
+		u32 hastexmtx = (components & (VB_HAS_TEXMTXIDX0 << i));
+		if (!(components & (VB_HAS_UV0 << i)) && !hastexmtx)
+			continue;
+		// A single component texcoord reads as float2(s, 0) from an attribute
+		out.Write("int taddr%d = vaddr + " I_VTXEXPAND"[%d].%s;\n", i, 3 + i / 4, texOffsetMemberSelector[i % 4]);
+		out.Write("int tcount%d = (" I_VTXEXPAND"[0].w >> %d) & 3;\n", i, i * 2);
+		out.Write("float3 tex%d_3 = float3(LoadFloat(taddr%d), tcount%d > 1 ? LoadFloat(taddr%d + 4) : 0.0, tcount%d > 2 ? LoadFloat(taddr%d + 8) : 0.0);\n",
+			i, i, i, i, i, i);
+		out.Write("float%d tex%d = tex%d_3%s;\n", hastexmtx ? 3 : 2, i, i, hastexmtx ? "" : ".xy");
+	}
+}
+
+// Ends ProcessVertex and moves the corners of the quad the way the geometry shader does
+static void WriteVertexExpandMain(ShaderCode& out, const vertex_shader_uid_data& uid_data)
+{
+	out.Write("return o;\n}\n\n");
+	out.Write("void main()\n{\n");
+	out.Write("int primitive = gl_VertexID / 6;\n");
+	// The two triangles of the strip the geometry shader emits
+	out.Write("const int corners[6] = int[6](0, 1, 2, 2, 1, 3);\n");
+	out.Write("int corner = corners[gl_VertexID %% 6];\n");
+	out.Write("VS_OUTPUT o;\n");
+
+	if (uid_data.vertex_expand == VSEXPAND_LINES)
+	{
+		out.Write("int first = " I_VTXEXPAND"[0].z + primitive * 2;\n");
+		out.Write("VS_OUTPUT start = ProcessVertex(LoadIndex(first));\n");
+		out.Write("VS_OUTPUT end = ProcessVertex(LoadIndex(first + 1));\n");
+		// Same caps as the geometry shader, vertical or horizontal depending on the slope
+		out.Write(
+			"float2 offset;\n"
+			"float2 to = abs(end.pos.xy / end.pos.w - start.pos.xy / start.pos.w);\n"
+			"if (" I_LINEPTPARAMS".y * to.y > " I_LINEPTPARAMS".x * to.x)\n"
+			"\toffset = float2(" I_LINEPTPARAMS".z / " I_LINEPTPARAMS".x, 0);\n"
+			"else\n"
+			"\toffset = float2(0, -" I_LINEPTPARAMS".z / " I_LINEPTPARAMS".y);\n");
+		out.Write("if (corner < 2)\n\to = start;\nelse\n\to = end;\n");
+		out.Write("if ((corner & 1) == 0) {\n"
+			"\to.pos.xy -= offset * o.pos.w;\n"
+			"} else {\n"
+			"\to.pos.xy += offset * o.pos.w;\n");
+		out.Write("\tif (" I_TEXOFFSET"[2] != 0) {\n");
+		out.Write("\tfloat texOffset = 1.0 / float(" I_TEXOFFSET"[2]);\n");
+		for (unsigned int i = 0; i < uid_data.numTexGens; ++i)
+		{
+			out.Write("\tif (((" I_TEXOFFSET"[0] >> %d) & 0x1) != 0)\n", i);
+			out.Write("\t\to.tex%d.x += texOffset;\n", i);
+		}
+		out.Write("\t}\n}\n");
+	}
+	else
+	{
+		out.Write("o = ProcessVertex(LoadIndex(" I_VTXEXPAND"[0].z + primitive));\n");
+		out.Write("float2 offset = float2(" I_LINEPTPARAMS".w / " I_LINEPTPARAMS".x, -" I_LINEPTPARAMS".w / " I_LINEPTPARAMS".y) * o.pos.w;\n");
+		// Corners 0 to 3 are lower left, lower right, upper left and upper right
+		out.Write("o.pos.xy += float2((corner & 1) != 0 ? 1.0 : -1.0, (corner & 2) != 0 ? 1.0 : -1.0) * offset;\n");
+		out.Write("if (" I_TEXOFFSET"[3] != 0) {\n");
+		out.Write("\tfloat2 texOffset = float2((corner & 1) != 0 ? 1.0 : 0.0, (corner & 2) != 0 ? 0.0 : 1.0) / float(" I_TEXOFFSET"[3]);\n");
+		for (unsigned int i = 0; i < uid_data.numTexGens; ++i)
+		{
+			out.Write("\tif (((" I_TEXOFFSET"[1] >> %d) & 0x1) != 0)\n", i);
+			out.Write("\t\to.tex%d.xy += texOffset;\n", i);
+		}
+		out.Write("}\n");
+	}
+}
+
+static UidCollapseCounter s_uid_collapse_counter(stats.numVertexShaderUidsCollapsed);
+
+void vertex_shader_uid_data::ClearUnused()
+{
+	bool has_regular_texgen = false;
+	for (u32 i = 0; i < numTexGens; ++i)
+	{
+		auto& texinfo = texMtxInfo[i];
+		switch (texinfo.texgentype)
+		{
+		case XF_TEXGEN_EMBOSS_MAP:
+			// Emboss only reads the xy of the source row, and with the binormals not even that
+			texinfo.inputform = 0;
+			if (components & (VB_HAS_NRM1 | VB_HAS_NRM2))
+				texinfo.sourcerow = XF_SRCGEOM_INROW;
+			break;
+		case XF_TEXGEN_COLOR_STRGBC0:
+		case XF_TEXGEN_COLOR_STRGBC1:
+			texinfo.inputform = 0;
+			texinfo.sourcerow = XF_SRCCOLORS_INROW;
+			break;
+		case XF_TEXGEN_REGULAR:
+			has_regular_texgen = true;
+			break;
+		default:
+			break;
+		}
+	}
+	// The post transform only applies to the regular texgens
+	if (!has_regular_texgen)
+		dualTexTrans_enabled = 0;
+}
+
 void GetVertexShaderUID(VertexShaderUid& out, u32 components, const XFMemory &xfr, const BPMemory &bpm)
 {
 	out.ClearUID();
@@ -82,7 +239,7 @@ void GetVertexShaderUID(VertexShaderUid& out, u32 components, const XFMemory &xf
 			postInfo.normalize = xfr.postMtxInfo[i].normalize;
 		}
 	}
-	out.CalculateUIDHash();
+	s_uid_collapse_counter.CalculateUIDHash(out);
 }
 
 template<API_TYPE api_type>
@@ -124,37 +281,56 @@ inline void GenerateVertexShader(ShaderCode& out, const vertex_shader_uid_data&
 	if (!(api_type == API_D3D9))
 		out.Write("};\n");
 
+	if (uid_data.stereo || uid_data.vertex_expand != VSEXPAND_NONE)
+	{
+		// The stereo and line/point parameters of the geometry shader
+		out.Write("UBO_BINDING(std140, 3) uniform GSBlock {\n"
+			"\tfloat4 " I_STEREOPARAMS";\n"
+			"\tfloat4 " I_LINEPTPARAMS";\n"
+			"\tint4 " I_TEXOFFSET";\n"
+			"};\n");
+	}
+
 	out.Write("struct VS_OUTPUT {\n");
 	GenerateVSOutputMembers<api_type>(out, uid_data.pixel_lighting, uid_data.numTexGens);
 	out.Write("};\n");
 
 	if (api_type == API_OPENGL || api_type == API_VULKAN)
 	{
-		out.Write("ATTRIBUTE_LOCATION(%d) in float4 rawpos;\n", SHADER_POSITION_ATTRIB);
-		out.Write("ATTRIBUTE_LOCATION(%d) in uint4 vposmtx;\n", SHADER_POSMTX_ATTRIB);
-		if (components & VB_HAS_NRM0)
-			out.Write("ATTRIBUTE_LOCATION(%d) in float3 rawnorm0;\n", SHADER_NORM0_ATTRIB);
-		if (components & VB_HAS_NRM1)
-			out.Write("ATTRIBUTE_LOCATION(%d) in float3 rawnorm1;\n", SHADER_NORM1_ATTRIB);
-		if (components & VB_HAS_NRM2)
-			out.Write("ATTRIBUTE_LOCATION(%d) in float3 rawnorm2;\n", SHADER_NORM2_ATTRIB);
+		if (uid_data.vertex_expand != VSEXPAND_NONE)
+		{
+			WriteVertexExpandHelpers(out);
+		}
+		else
+		{
+			out.Write("ATTRIBUTE_LOCATION(%d) in float4 rawpos;\n", SHADER_POSITION_ATTRIB);
+			out.Write("ATTRIBUTE_LOCATION(%d) in uint4 vposmtx;\n", SHADER_POSMTX_ATTRIB);
+			if (components & VB_HAS_NRM0)
+				out.Write("ATTRIBUTE_LOCATION(%d) in float3 rawnorm0;\n", SHADER_NORM0_ATTRIB);
+			if (components & VB_HAS_NRM1)
+				out.Write("ATTRIBUTE_LOCATION(%d) in float3 rawnorm1;\n", SHADER_NORM1_ATTRIB);
+			if (components & VB_HAS_NRM2)
+				out.Write("ATTRIBUTE_LOCATION(%d) in float3 rawnorm2;\n", SHADER_NORM2_ATTRIB);
 
-		if (components & VB_HAS_COL0)
-			out.Write("ATTRIBUTE_LOCATION(%d) in float4 color0;\n", SHADER_COLOR0_ATTRIB);
-		if (components & VB_HAS_COL1)
-			out.Write("ATTRIBUTE_LOCATION(%d) in float4 color1;\n", SHADER_COLOR1_ATTRIB);
+			if (components & VB_HAS_COL0)
+				out.Write("ATTRIBUTE_LOCATION(%d) in float4 color0;\n", SHADER_COLOR0_ATTRIB);
+			if (components & VB_HAS_COL1)
+				out.Write("ATTRIBUTE_LOCATION(%d) in float4 color1;\n", SHADER_COLOR1_ATTRIB);
 
-		for (int i = 0; i < 8; ++i)
-		{
-			u32 hastexmtx = (components & (VB_HAS_TEXMTXIDX0 << i));
-			if ((components & (VB_HAS_UV0 << i)) || hastexmtx)
-				out.Write("ATTRIBUTE_LOCATION(%d) in float%d tex%d;\n", SHADER_TEXTURE0_ATTRIB + i, hastexmtx ? 3 : 2, i);
+			for (int i = 0; i < 8; ++i)
+			{
+				u32 hastexmtx = (components & (VB_HAS_TEXMTXIDX0 << i));
+				if ((components & (VB_HAS_UV0 << i)) || hastexmtx)
+					out.Write("ATTRIBUTE_LOCATION(%d) in float%d tex%d;\n", SHADER_TEXTURE0_ATTRIB + i, hastexmtx ? 3 : 2, i);
+			}
 		}
 
 		if (g_ActiveConfig.backend_info.bSupportsGeometryShaders || api_type == API_VULKAN)
 		{
 			out.Write("VARYING_LOCATION(0) out VertexData {\n");
 			GenerateVSOutputMembers<api_type>(out, uid_data.pixel_lighting, uid_data.numTexGens, GetInterpolationQualifier(api_type, uid_data.msaa, uid_data.ssaa, false, true));
+			if (uid_data.stereo)
+				out.Write("\tflat int layer;\n");
 			out.Write("} vs;\n");
 		}
 		else
@@ -188,7 +364,16 @@ inline void GenerateVertexShader(ShaderCode& out, const vertex_shader_uid_data&
 			out.Write("%s out float4 colors_1;\n", optCentroid);
 		}
 
-		out.Write("void main()\n{\n");
+		if (uid_data.vertex_expand != VSEXPAND_NONE)
+		{
+			// The vertex processing runs once per endpoint of the line, or for the point
+			out.Write("VS_OUTPUT ProcessVertex(uint vertex_index)\n{\n");
+			WriteVertexExpandLoads(out, components);
+		}
+		else
+		{
+			out.Write("void main()\n{\n");
+		}
 	}
 	else
 	{
@@ -515,6 +700,19 @@ inline void GenerateVertexShader(ShaderCode& out, const vertex_shader_uid_data&
 		}
 	}
 
+	if (uid_data.vertex_expand != VSEXPAND_NONE)
+		WriteVertexExpandMain(out, uid_data);
+
+	if (uid_data.stereo)
+	{
+		// Each instance renders one eye, offset the same way as in the geometry shader
+		out.Write("int eye = gl_InstanceID;\n");
+		out.Write("float hoffset = (eye == 0) ? " I_STEREOPARAMS ".x : " I_STEREOPARAMS ".y;\n");
+		out.Write("o.pos.x += hoffset * (o.pos.w - " I_STEREOPARAMS ".z);\n");
+		out.Write("vs.layer = eye;\n");
+		out.Write("gl_Layer = eye;\n");
+	}
+
 	if (api_type == API_OPENGL || api_type == API_VULKAN)
 	{
 		if (g_ActiveConfig.backend_info.bSupportsGeometryShaders || api_type == API_VULKAN)
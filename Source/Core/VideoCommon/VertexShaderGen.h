@@ -42,6 +42,7 @@
 #define I_POSTTRANSFORMMATRICES "cpostmtx"
 #define I_PLOFFSETPARAMS        "cPLOffset" // line/point offset for correct emulation 
 #define I_PHONG                 "cphong"
+#define I_VTXEXPAND             "cvtxexpand" // vertex pulling layout of the line/point expansion
 
 #define C_PROJECTION            0
 #define C_DEPTHPARAMS           (C_PROJECTION + 4)
@@ -55,6 +56,14 @@
 #define C_PLOFFSETPARAMS        (C_POSTTRANSFORMMATRICES + 64)
 #define C_VENVCONST_END         (C_PLOFFSETPARAMS + 13)
 
+// Lines and points the vertex shader turns into quads, two triangles per line or point
+enum VertexExpand : u32
+{
+	VSEXPAND_NONE = 0,
+	VSEXPAND_LINES = 1,
+	VSEXPAND_POINTS = 2,
+};
+
 #pragma pack(1)
 struct vertex_shader_uid_data
 {
@@ -67,7 +76,7 @@ struct vertex_shader_uid_data
 		return 0;
 	}
 
-	void ClearUnused(){}
+	void ClearUnused();
 
 	u32 components : 22;
 	u32 numTexGens : 4;
@@ -78,7 +87,9 @@ struct vertex_shader_uid_data
 	u32 ssaa : 1;
 
 	u32 texMtxInfo_n_projection : 16; // Stored separately to guarantee that the texMtxInfo struct is 8 bits wide
-	u32 pad0 : 16;
+	u32 stereo : 1; // Draws both eyes with instancing, see IsVertexShaderStereo
+	u32 vertex_expand : 2; // VertexExpand, see IsVertexShaderExpand
+	u32 pad0 : 13;
 
 	struct
 	{
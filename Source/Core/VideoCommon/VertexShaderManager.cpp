@@ -228,6 +228,11 @@ const regionvector &VertexShaderManager::GetDirtyRegions()
 	return m_buffer.GetRegions();
 }
 
+bool VertexShaderManager::UpdateUploadedConstants(float* uploaded)
+{
+	return m_buffer.UpdateCopy(uploaded);
+}
+
 void VertexShaderManager::EnableDirtyRegions()
 {
 	m_buffer.EnableDirtyRegions();
@@ -624,23 +629,25 @@ void VertexShaderManager::SetConstants()
 	}
 }
 
+// Whether [start, end) writes any of the 3x4 texture matrix at index
+static bool OverlapsTexMatrix(u32 start, u32 end, u32 index)
+{
+	return start < index * 4u + 12u && end > index * 4u;
+}
+
 void VertexShaderManager::InvalidateXFRange(u32 start, u32 end)
 {
 	const TMatrixIndexA& ma = g_main_cp_state.matrix_index_a;
 	const TMatrixIndexB& mb = g_main_cp_state.matrix_index_b;
 
-	if ((start >= ma.Tex0MtxIdx * 4u && start < ma.Tex0MtxIdx * 4u + 12u) ||
-		(start >= ma.Tex1MtxIdx * 4u && start < ma.Tex1MtxIdx * 4u + 12u) ||
-		(start >= ma.Tex2MtxIdx * 4u && start < ma.Tex2MtxIdx * 4u + 12u) ||
-		(start >= ma.Tex3MtxIdx * 4u && start < ma.Tex3MtxIdx * 4u + 12u))
+	if (OverlapsTexMatrix(start, end, ma.Tex0MtxIdx) || OverlapsTexMatrix(start, end, ma.Tex1MtxIdx) ||
+		OverlapsTexMatrix(start, end, ma.Tex2MtxIdx) || OverlapsTexMatrix(start, end, ma.Tex3MtxIdx))
 	{
 		s_tex_matrices_changed[0] = true;
 	}
 
-	if ((start >= mb.Tex4MtxIdx * 4u && start < mb.Tex4MtxIdx * 4u + 12u) ||
-		(start >= mb.Tex5MtxIdx * 4u && start < mb.Tex5MtxIdx * 4u + 12u) ||
-		(start >= mb.Tex6MtxIdx * 4u && start < mb.Tex6MtxIdx * 4u + 12u) ||
-		(start >= mb.Tex7MtxIdx * 4u && start < mb.Tex7MtxIdx * 4u + 12u))
+	if (OverlapsTexMatrix(start, end, mb.Tex4MtxIdx) || OverlapsTexMatrix(start, end, mb.Tex5MtxIdx) ||
+		OverlapsTexMatrix(start, end, mb.Tex6MtxIdx) || OverlapsTexMatrix(start, end, mb.Tex7MtxIdx))
 	{
 		s_tex_matrices_changed[1] = true;
 	}
@@ -678,7 +685,7 @@ void VertexShaderManager::InvalidateXFRange(u32 start, u32 end)
 
 	if (start < XFMEM_POSTMATRICES_END && end > XFMEM_POSTMATRICES)
 	{
-		int _start = start < XFMEM_POSTMATRICES ? XFMEM_POSTMATRICES : start - XFMEM_POSTMATRICES;
+		int _start = start < XFMEM_POSTMATRICES ? 0 : start - XFMEM_POSTMATRICES;
 		int _end = end < XFMEM_POSTMATRICES_END ? end - XFMEM_POSTMATRICES : XFMEM_POSTMATRICES_END - XFMEM_POSTMATRICES;
 
 		if (nPostTransformMatricesChanged[0] == -1)
@@ -695,7 +702,7 @@ void VertexShaderManager::InvalidateXFRange(u32 start, u32 end)
 
 	if (start < XFMEM_LIGHTS_END && end > XFMEM_LIGHTS)
 	{
-		int _start = start < XFMEM_LIGHTS ? XFMEM_LIGHTS : start - XFMEM_LIGHTS;
+		int _start = start < XFMEM_LIGHTS ? 0 : start - XFMEM_LIGHTS;
 		int _end = end < XFMEM_LIGHTS_END ? end - XFMEM_LIGHTS : XFMEM_LIGHTS_END - XFMEM_LIGHTS;
 
 		if (s_lights_changed[0] == -1)
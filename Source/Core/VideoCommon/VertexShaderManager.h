@@ -31,6 +31,9 @@ public:
 	static void EnableDirtyRegions();
 	static void DisableDirtyRegions();
 	static const regionvector &GetDirtyRegions();
+	// Copies the dirty constants to uploaded, which holds the values of the last upload.
+	// Returns false if they were already there, so the last upload can be used again.
+	static bool UpdateUploadedConstants(float* uploaded);
 	// constant management
 	static void SetConstants();
 
@@ -12,6 +12,7 @@
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
 #include "Core/Movie.h"
+#include "VideoCommon/DynamicResolution.h"
 #include "VideoCommon/OnScreenDisplay.h"
 #include "VideoCommon/NativeVertexFormat.h"
 #include "VideoCommon/VideoCommon.h"
@@ -25,6 +26,7 @@ void UpdateActiveConfig()
 	if (Movie::IsPlayingInput() && Movie::IsConfigSaved())
 		Movie::SetGraphicsConfig();
 	g_ActiveConfig = g_Config;
+	g_ActiveConfig.iEFBScale = DynamicResolution::GetEFBScale(g_Config.iEFBScale);
 }
 
 VideoConfig::VideoConfig()
@@ -42,6 +44,8 @@ VideoConfig::VideoConfig()
 		backend_info.bSupportedFormats[i] = false;
 	}
 	backend_info.bSupportsExclusiveFullscreen = false;
+	backend_info.bSupportsPrimitiveRestart = false;
+	backend_info.bSupports32BitIndices = false;
 
 	// Game-specific stereoscopy settings
 	bStereoEFBMonoDepth = false;
@@ -51,6 +55,7 @@ VideoConfig::VideoConfig()
 	bTexDeposterize = false;
 	iTexScalingType = 0;
 	iTexScalingFactor = 2;
+	bCacheScaledTextures = false;
 	backend_info.bSupportsMultithreading = false;
 
 	bEnableValidationLayer = false;
@@ -64,6 +69,7 @@ void VideoConfig::Load(const std::string& ini_file)
 
 	IniFile::Section* hardware = iniFile.GetOrCreateSection("Hardware");
 	hardware->Get("VSync", &bVSync, 0);
+	hardware->Get("LowLatencyPresent", &bLowLatencyPresent, false);
 	hardware->Get("Adapter", &iAdapter, 0);
 
 	IniFile::Section* settings = iniFile.GetOrCreateSection("Settings");
@@ -72,11 +78,14 @@ void VideoConfig::Load(const std::string& ini_file)
 	settings->Get("Crop", &bCrop, false);
 	settings->Get("UseXFB", &bUseXFB, 0);
 	settings->Get("UseRealXFB", &bUseRealXFB, 0);
+	settings->Get("VirtualXFBWriteBack", &bVirtualXFBWriteBack, false);
 	settings->Get("SafeTextureCacheColorSamples", &iSafeTextureCache_ColorSamples, 128);
 	settings->Get("ShowFPS", &bShowFPS, false);
 	settings->Get("ShowNetPlayPing", &bShowNetPlayPing, false);
 	settings->Get("ShowNetPlayMessages", &bShowNetPlayMessages, false);
 	settings->Get("LogRenderTimeToFile", &bLogRenderTimeToFile, false);
+	settings->Get("FrameTelemetry", &bFrameTelemetry, false);
+	settings->Get("GPUProfiling", &bGPUProfiling, false);
 	settings->Get("ShowInputDisplay", &bShowInputDisplay, false);
 	settings->Get("OverlayStats", &bOverlayStats, false);
 	settings->Get("OverlayProjStats", &bOverlayProjStats, false);
@@ -86,9 +95,14 @@ void VideoConfig::Load(const std::string& ini_file)
 	settings->Get("HiresMaterialMaps", &bHiresMaterialMaps, 0);
 	settings->Get("HiresMaterialMapsBuild", &bHiresMaterialMapsBuild, false);
 	settings->Get("CacheHiresTextures", &bCacheHiresTextures, 0);
+	settings->Get("StreamHiresTextures", &bStreamHiresTextures, false);
+	settings->Get("HiresTextureUploadBudget", &iHiresTextureUploadBudget, 16);
+	settings->Get("HiresTextureMemoryBudget", &iHiresTextureMemoryBudget, 0);
+	settings->Get("HiresTextureVRAMBudget", &iHiresTextureVRAMBudget, 0);
 	settings->Get("DumpEFBTarget", &bDumpEFBTarget, 0);
 	settings->Get("FreeLook", &bFreeLook, 0);
 	settings->Get("CompileShaderOnStartup", &bCompileShaderOnStartup, 1);
+	settings->Get("BackgroundShaderPrecompile", &bBackgroundShaderPrecompile, false);
 
 	settings->Get("UseFFV1", &bUseFFV1, 0);
 	settings->Get("EnablePixelLighting", &bEnablePixelLighting, 0);
@@ -109,9 +123,12 @@ void VideoConfig::Load(const std::string& ini_file)
 	settings->Get("FastDepthCalc", &bFastDepthCalc, true);
 	settings->Get("MSAA", &iMultisamples, 1);
 	settings->Get("EFBScale", &iEFBScale, (int)SCALE_2X); // native	
+	settings->Get("DynamicResolution", &bDynamicResolution, false);
+	settings->Get("DynamicResolutionFrameTime", &fDynamicResolutionFrameTime, 14.0f);
 	settings->Get("TexFmtOverlayEnable", &bTexFmtOverlayEnable, 0);
 	settings->Get("TexFmtOverlayCenter", &bTexFmtOverlayCenter, 0);
 	settings->Get("WireFrame", &bWireFrame, 0);
+	settings->Get("PreferVSForLinePointExpansion", &bPreferVSForLinePointExpansion, false);
 	settings->Get("DisableFog", &bDisableFog, 0);
 	settings->Get("SSAA", &bSSAA, false);
 	settings->Get("EnableOpenCL", &bEnableOpenCL, false);
@@ -122,12 +139,14 @@ void VideoConfig::Load(const std::string& ini_file)
 	settings->Get("SWDumpObjects", &bDumpObjects, false);
 	settings->Get("SWDumpTevStages", &bDumpTevStages, false);
 	settings->Get("SWDumpTevTexFetches", &bDumpTevTextureFetches, false);
+	settings->Get("SWRasterizerThreads", &iSWRasterizerThreads, 0);
 	settings->Get("SWDrawStart", &drawStart, 0);
 	settings->Get("SWDrawEnd", &drawEnd, 100000);
 
 	settings->Get("EnableValidationLayer", &bEnableValidationLayer, false);
 	settings->Get("BackendMultithreading", &bBackendMultithreading, true);
 	settings->Get("CommandBufferExecuteInterval", &iCommandBufferExecuteInterval, 100);
+	settings->Get("FramesInFlight", &iFramesInFlight, 2);
 
 	IniFile::Section* enhancements = iniFile.GetOrCreateSection("Enhancements");
 	enhancements->Get("ForceFiltering", &bForceFiltering, 0);
@@ -141,10 +160,12 @@ void VideoConfig::Load(const std::string& ini_file)
 	enhancements->Get("TextureScalingType", &iTexScalingType, 0);
 	enhancements->Get("TextureScalingFactor", &iTexScalingFactor, 2);
 	enhancements->Get("UseDePosterize", &bTexDeposterize, true);
+	enhancements->Get("CacheScaledTextures", &bCacheScaledTextures, false);
 	enhancements->Get("Tessellation", &bTessellation, 0);
 	enhancements->Get("TessellationEarlyCulling", &bTessellationEarlyCulling, 0);
 	enhancements->Get("TessellationDistance", &iTessellationDistance, 0);
 	enhancements->Get("TessellationMax", &iTessellationMax, 6);
+	enhancements->Get("TessellationEdgeSize", &iTessellationEdgeSize, 16);
 	enhancements->Get("TessellationRoundingIntensity", &iTessellationRoundingIntensity, 0);
 	enhancements->Get("TessellationDisplacementIntensity", &iTessellationDisplacementIntensity, 0);
 	enhancements->Get("ForceTrueColor", &bForceTrueColor, true);
@@ -161,17 +182,25 @@ void VideoConfig::Load(const std::string& ini_file)
 	hacks->Get("EFBFastAccess", &bEFBFastAccess, false);
 	hacks->Get("ForceProgressive", &bForceProgressive, true);
 	hacks->Get("EFBToTextureEnable", &bSkipEFBCopyToRam, true);
+	hacks->Get("DeferEFBCopies", &bDeferEFBCopies, false);
 	hacks->Get("EFBScaledCopy", &bCopyEFBScaled, true);
 	hacks->Get("EFBEmulateFormatChanges", &bEFBEmulateFormatChanges, false);
 	hacks->Get("ForceDualSourceBlend", &bForceDualSourceBlend, false);
 	hacks->Get("FullAsyncShaderCompilation", &bFullAsyncShaderCompilation, true);
+	hacks->Get("UberShaderFallback", &bUberShaderFallback, false);
 	hacks->Get("WaitForShaderCompilation", &bWaitForShaderCompilation, false);
 	hacks->Get("EnableComputeTextureDecoding", &bEnableComputeTextureDecoding, false);
 	hacks->Get("EnableComputeTextureEncoding", &bEnableComputeTextureEncoding, false);
 	hacks->Get("PredictiveFifo", &bPredictiveFifo, false);
+	hacks->Get("DisplayListCache", &bDisplayListCache, false);
 	hacks->Get("BoundingBoxMode", &iBBoxMode, (int)BBoxMode::BBoxNone);
+	hacks->Get("BBoxAsyncReadback", &bBBoxAsyncReadback, false);
+	hacks->Get("PerfQueriesAsync", &bPerfQueriesAsync, false);
+	hacks->Get("PerfQueriesInFlight", &iPerfQueriesInFlight, 0);
 	hacks->Get("LastStoryEFBToRam", &bLastStoryEFBToRam, false);
 	hacks->Get("ForceLogicOpBlend", &bForceLogicOpBlend, false);
+	hacks->Get("TextureCacheWriteWatch", &bTexCacheWriteWatch, false);
+	hacks->Get("CPUCull", &bCPUCull, false);
 	
 
 	// hacks which are disabled by default
@@ -215,17 +244,23 @@ void VideoConfig::GameIniLoad()
 	IniFile iniFile = SConfig::GetInstance().LoadGameIni();
 
 	CHECK_SETTING("Video_Hardware", "VSync", bVSync);
+	CHECK_SETTING("Video_Hardware", "LowLatencyPresent", bLowLatencyPresent);
 
 	CHECK_SETTING("Video_Settings", "wideScreenHack", bWidescreenHack);
 	CHECK_SETTING("Video_Settings", "AspectRatio", iAspectRatio);
 	CHECK_SETTING("Video_Settings", "Crop", bCrop);
 	CHECK_SETTING("Video_Settings", "UseXFB", bUseXFB);
 	CHECK_SETTING("Video_Settings", "UseRealXFB", bUseRealXFB);
+	CHECK_SETTING("Video_Settings", "VirtualXFBWriteBack", bVirtualXFBWriteBack);
 	CHECK_SETTING("Video_Settings", "SafeTextureCacheColorSamples", iSafeTextureCache_ColorSamples);
 	CHECK_SETTING("Video_Settings", "HiresTextures", bHiresTextures);
 	CHECK_SETTING("Video_Settings", "HiresMaterialMaps", bHiresMaterialMaps);
 
 	CHECK_SETTING("Video_Settings", "CacheHiresTextures", bCacheHiresTextures);
+	CHECK_SETTING("Video_Settings", "StreamHiresTextures", bStreamHiresTextures);
+	CHECK_SETTING("Video_Settings", "HiresTextureUploadBudget", iHiresTextureUploadBudget);
+	CHECK_SETTING("Video_Settings", "HiresTextureMemoryBudget", iHiresTextureMemoryBudget);
+	CHECK_SETTING("Video_Settings", "HiresTextureVRAMBudget", iHiresTextureVRAMBudget);
 	CHECK_SETTING("Video_Settings", "EnablePixelLighting", bEnablePixelLighting);
 	CHECK_SETTING("Video_Settings", "ForcedLighting", bForcedLighting);
 
@@ -274,6 +309,7 @@ void VideoConfig::GameIniLoad()
 	CHECK_SETTING("Video_Settings", "EnableOpenCL", bEnableOpenCL);
 	CHECK_SETTING("Video_Settings", "BackendMultithreading", bBackendMultithreading);
 	CHECK_SETTING("Video_Settings", "CommandBufferExecuteInterval", iCommandBufferExecuteInterval);
+	CHECK_SETTING("Video_Settings", "FramesInFlight", iFramesInFlight);
 
 	// These are not overrides, they are per-game stereoscopy parameters, hence no warning
 	iniFile.GetIfExists("Video_Stereoscopy", "StereoConvergence", &iStereoConvergence, 20);
@@ -287,10 +323,12 @@ void VideoConfig::GameIniLoad()
 	CHECK_SETTING("Video_Enhancements", "TextureScalingType", iTexScalingType);
 	CHECK_SETTING("Video_Enhancements", "TextureScalingFactor", iTexScalingFactor);
 	CHECK_SETTING("Video_Enhancements", "UseDePosterize", bTexDeposterize);
+	CHECK_SETTING("Video_Enhancements", "CacheScaledTextures", bCacheScaledTextures);
 	CHECK_SETTING("Video_Enhancements", "Tessellation", bTessellation);
 	CHECK_SETTING("Video_Enhancements", "TessellationEarlyCulling", bTessellationEarlyCulling);
 	CHECK_SETTING("Video_Enhancements", "TessellationDistance", iTessellationDistance);
 	CHECK_SETTING("Video_Enhancements", "TessellationMax", iTessellationMax);
+	CHECK_SETTING("Video_Enhancements", "TessellationEdgeSize", iTessellationEdgeSize);
 	CHECK_SETTING("Video_Enhancements", "TessellationRoundingIntensity", iTessellationRoundingIntensity);
 	CHECK_SETTING("Video_Enhancements", "TessellationDisplacementIntensity", iTessellationDisplacementIntensity);
 	CHECK_SETTING("Video_Enhancements", "PostProcessingEnable", bPostProcessingEnable);
@@ -308,10 +346,16 @@ void VideoConfig::GameIniLoad()
 	CHECK_SETTING("Video_Hacks", "EFBFastAccess", bEFBFastAccess);
 	CHECK_SETTING("Video_Hacks", "ForceProgressive", bForceProgressive);
 	CHECK_SETTING("Video_Hacks", "EFBToTextureEnable", bSkipEFBCopyToRam);
+	CHECK_SETTING("Video_Hacks", "DeferEFBCopies", bDeferEFBCopies);
 	CHECK_SETTING("Video_Hacks", "EFBScaledCopy", bCopyEFBScaled);
 	CHECK_SETTING("Video_Hacks", "EFBEmulateFormatChanges", bEFBEmulateFormatChanges);
 	CHECK_SETTING("Video_Hacks", "BoundingBoxMode", iBBoxMode);
+	CHECK_SETTING("Video_Hacks", "BBoxAsyncReadback", bBBoxAsyncReadback);
+	CHECK_SETTING("Video_Hacks", "PerfQueriesAsync", bPerfQueriesAsync);
+	CHECK_SETTING("Video_Hacks", "PerfQueriesInFlight", iPerfQueriesInFlight);
 	CHECK_SETTING("Video_Hacks", "LastStoryEFBToRam", bLastStoryEFBToRam);
+	CHECK_SETTING("Video_Hacks", "TextureCacheWriteWatch", bTexCacheWriteWatch);
+	CHECK_SETTING("Video_Hacks", "CPUCull", bCPUCull);
 
 
 	CHECK_SETTING("Video", "ProjectionHack", iPhackvalue[0]);
@@ -322,10 +366,12 @@ void VideoConfig::GameIniLoad()
 	CHECK_SETTING("Video", "PH_ZFar", sPhackvalue[1]);
 	CHECK_SETTING("Video", "PerfQueriesEnable", bPerfQueriesEnable);
 	CHECK_SETTING("Video", "FullAsyncShaderCompilation", bFullAsyncShaderCompilation);
+	CHECK_SETTING("Video", "UberShaderFallback", bUberShaderFallback);
 	CHECK_SETTING("Video", "WaitForShaderCompilation", bWaitForShaderCompilation);
 	CHECK_SETTING("Video", "EnableComputeTextureDecoding", bEnableComputeTextureDecoding);
 	CHECK_SETTING("Video", "EnableComputeTextureEncoding", bEnableComputeTextureEncoding);
 	CHECK_SETTING("Video", "PredictiveFifo", bPredictiveFifo);
+	CHECK_SETTING("Video", "DisplayListCache", bDisplayListCache);
 	if (gfx_override_exists)
 		OSD::AddMessage("Warning: Opening the graphics configuration will reset settings and might cause issues!", 10000);
 }
@@ -343,6 +389,7 @@ void VideoConfig::VerifyValidity()
 	bForcePhongShading = bForcePhongShading && bEnablePixelLighting;
 	bForcedLighting = bForcedLighting && bEnablePixelLighting;
 	iRimPower = std::min(std::max(iRimPower, 0), 255);
+	iSWRasterizerThreads = std::min(std::max(iSWRasterizerThreads, 0), 64);
 	iRimIntesity = std::min(std::max(iRimIntesity, 0), 255);
 	iRimBase = std::min(std::max(iRimBase, 0), 127);
 	iSpecularMultiplier = std::min(std::max(iSpecularMultiplier, 0), 510);
@@ -350,7 +397,10 @@ void VideoConfig::VerifyValidity()
 	iSimBumpDetailBlend = std::min(std::max(iSimBumpDetailBlend, 0), 255);
 	iSimBumpDetailFrequency = std::min(std::max(iSimBumpDetailFrequency, 4), 255);
 	iSimBumpThreshold = std::min(std::max(iSimBumpThreshold, 0), 255);
+	iPerfQueriesInFlight = std::min(std::max(iPerfQueriesInFlight, 0), 512);
+	iFramesInFlight = std::min(std::max(iFramesInFlight, 1), 3);
 	iTessellationMax = iTessellationMax < 2 ? 2 : (iTessellationMax > 63 ? 63 : iTessellationMax);
+	iTessellationEdgeSize = iTessellationEdgeSize < 2 ? 2 : (iTessellationEdgeSize > 64 ? 64 : iTessellationEdgeSize);
 	iTessellationRoundingIntensity = iTessellationRoundingIntensity > 100 ? 100 : (iTessellationRoundingIntensity < 0 ? 0 : iTessellationRoundingIntensity);
 	iTessellationDisplacementIntensity = iTessellationDisplacementIntensity > 300 ? 300 : (iTessellationDisplacementIntensity < 0 ? 0 : iTessellationDisplacementIntensity);
 	if (iStereoMode > 0)
@@ -366,8 +416,7 @@ void VideoConfig::VerifyValidity()
 			iStereoMode = 0;
 		}
 	}
-	// Disable while reimplementing predictive fifo
-	bPredictiveFifo = false;
+	// The predictive fifo only queues shader compilation, the GPU thread never waits for it
 	bWaitForShaderCompilation = false;
 	if (iBBoxMode > BBoxGPU || iBBoxMode < BBoxNone)
 	{
@@ -393,6 +442,12 @@ void VideoConfig::VerifyValidity()
 	{
 		iTexScalingType = 10;
 	}
+	if (iHiresTextureUploadBudget < 1)
+	{
+		iHiresTextureUploadBudget = 1;
+	}
+	iHiresTextureMemoryBudget = std::max(iHiresTextureMemoryBudget, 0);
+	iHiresTextureVRAMBudget = std::max(iHiresTextureVRAMBudget, 0);
 	bHiresMaterialMaps = bHiresMaterialMaps && bHiresTextures && bEnablePixelLighting;
 	bLastStoryEFBToRam = bLastStoryEFBToRam && StartsWith(SConfig::GetInstance().GetGameID(), "SLS");
 }
@@ -404,6 +459,7 @@ void VideoConfig::Save(const std::string& ini_file)
 
 	IniFile::Section* hardware = iniFile.GetOrCreateSection("Hardware");
 	hardware->Set("VSync", bVSync);
+	hardware->Set("LowLatencyPresent", bLowLatencyPresent);
 	hardware->Set("Adapter", iAdapter);
 
 	IniFile::Section* settings = iniFile.GetOrCreateSection("Settings");
@@ -412,11 +468,14 @@ void VideoConfig::Save(const std::string& ini_file)
 	settings->Set("wideScreenHack", bWidescreenHack);
 	settings->Set("UseXFB", bUseXFB);
 	settings->Set("UseRealXFB", bUseRealXFB);
+	settings->Set("VirtualXFBWriteBack", bVirtualXFBWriteBack);
 	settings->Set("SafeTextureCacheColorSamples", iSafeTextureCache_ColorSamples);
 	settings->Set("ShowFPS", bShowFPS);
 	settings->Set("ShowNetPlayPing", bShowNetPlayPing);
 	settings->Set("ShowNetPlayMessages", bShowNetPlayMessages);
 	settings->Set("LogRenderTimeToFile", bLogRenderTimeToFile);
+	settings->Set("FrameTelemetry", bFrameTelemetry);
+	settings->Set("GPUProfiling", bGPUProfiling);
 	settings->Set("ShowInputDisplay", bShowInputDisplay);
 	settings->Set("OverlayStats", bOverlayStats);
 	settings->Set("OverlayProjStats", bOverlayProjStats);
@@ -427,9 +486,14 @@ void VideoConfig::Save(const std::string& ini_file)
 	settings->Set("HiresMaterialMapsBuild", bHiresMaterialMapsBuild);
 	
 	settings->Set("CacheHiresTextures", bCacheHiresTextures);
+	settings->Set("StreamHiresTextures", bStreamHiresTextures);
+	settings->Set("HiresTextureUploadBudget", iHiresTextureUploadBudget);
+	settings->Set("HiresTextureMemoryBudget", iHiresTextureMemoryBudget);
+	settings->Set("HiresTextureVRAMBudget", iHiresTextureVRAMBudget);
 	settings->Set("DumpEFBTarget", bDumpEFBTarget);
 	settings->Set("FreeLook", bFreeLook);
 	settings->Set("CompileShaderOnStartup", bCompileShaderOnStartup);
+	settings->Set("BackgroundShaderPrecompile", bBackgroundShaderPrecompile);
 
 	settings->Set("UseFFV1", bUseFFV1);
 	settings->Set("EnablePixelLighting", bEnablePixelLighting);
@@ -450,9 +514,12 @@ void VideoConfig::Save(const std::string& ini_file)
 	settings->Set("MSAA", iMultisamples);
 	settings->Set("SSAA", bSSAA);
 	settings->Set("EFBScale", iEFBScale);
+	settings->Set("DynamicResolution", bDynamicResolution);
+	settings->Set("DynamicResolutionFrameTime", fDynamicResolutionFrameTime);
 	settings->Set("TexFmtOverlayEnable", bTexFmtOverlayEnable);
 	settings->Set("TexFmtOverlayCenter", bTexFmtOverlayCenter);
 	settings->Set("Wireframe", bWireFrame);
+	settings->Set("PreferVSForLinePointExpansion", bPreferVSForLinePointExpansion);
 	settings->Set("DisableFog", bDisableFog);
 
 	settings->Set("EnableOpenCL", bEnableOpenCL);
@@ -463,12 +530,14 @@ void VideoConfig::Save(const std::string& ini_file)
 	settings->Set("SWDumpObjects", bDumpObjects);
 	settings->Set("SWDumpTevStages", bDumpTevStages);
 	settings->Set("SWDumpTevTexFetches", bDumpTevTextureFetches);
+	settings->Set("SWRasterizerThreads", iSWRasterizerThreads);
 	settings->Set("SWDrawStart", drawStart);
 	settings->Set("SWDrawEnd", drawEnd);
 
 	settings->Set("EnableValidationLayer", bEnableValidationLayer);
 	settings->Set("BackendMultithreading", bBackendMultithreading);
 	settings->Set("CommandBufferExecuteInterval", iCommandBufferExecuteInterval);
+	settings->Set("FramesInFlight", iFramesInFlight);
 
 	IniFile::Section* enhancements = iniFile.GetOrCreateSection("Enhancements");
 	enhancements->Set("ForceFiltering", bForceFiltering);
@@ -482,10 +551,12 @@ void VideoConfig::Save(const std::string& ini_file)
 	enhancements->Set("TextureScalingType", iTexScalingType);
 	enhancements->Set("TextureScalingFactor", iTexScalingFactor);
 	enhancements->Set("UseDePosterize", bTexDeposterize);
+	enhancements->Set("CacheScaledTextures", bCacheScaledTextures);
 	enhancements->Set("Tessellation", bTessellation);
 	enhancements->Set("TessellationEarlyCulling", bTessellationEarlyCulling);
 	enhancements->Set("TessellationDistance", iTessellationDistance);
 	enhancements->Set("TessellationMax", iTessellationMax);
+	enhancements->Set("TessellationEdgeSize", iTessellationEdgeSize);
 	enhancements->Set("TessellationRoundingIntensity", iTessellationRoundingIntensity);
 	enhancements->Set("TessellationDisplacementIntensity", iTessellationDisplacementIntensity);
 	enhancements->Set("ForceTrueColor", bForceTrueColor);
@@ -502,17 +573,25 @@ void VideoConfig::Save(const std::string& ini_file)
 	hacks->Set("EFBFastAccess", bEFBFastAccess);
 	hacks->Set("ForceProgressive", bForceProgressive);
 	hacks->Set("EFBToTextureEnable", bSkipEFBCopyToRam);
+	hacks->Set("DeferEFBCopies", bDeferEFBCopies);
 	hacks->Set("EFBScaledCopy", bCopyEFBScaled);
 	hacks->Set("EFBEmulateFormatChanges", bEFBEmulateFormatChanges);
 	hacks->Set("ForceDualSourceBlend", bForceDualSourceBlend);
 	hacks->Set("FullAsyncShaderCompilation", bFullAsyncShaderCompilation);
+	hacks->Set("UberShaderFallback", bUberShaderFallback);
 	hacks->Set("WaitForShaderCompilation", bWaitForShaderCompilation);
 	hacks->Set("EnableComputeTextureDecoding", bEnableComputeTextureDecoding);
 	hacks->Set("EnableComputeTextureEncoding", bEnableComputeTextureEncoding);
 	hacks->Set("PredictiveFifo", bPredictiveFifo);
+	hacks->Set("DisplayListCache", bDisplayListCache);
 	hacks->Set("BoundingBoxMode", iBBoxMode);
+	hacks->Set("BBoxAsyncReadback", bBBoxAsyncReadback);
+	hacks->Set("PerfQueriesAsync", bPerfQueriesAsync);
+	hacks->Set("PerfQueriesInFlight", iPerfQueriesInFlight);
 	hacks->Set("LastStoryEFBToRam", bLastStoryEFBToRam);
 	hacks->Set("ForceLogicOpBlend", bForceLogicOpBlend);
+	hacks->Set("TextureCacheWriteWatch", bTexCacheWriteWatch);
+	hacks->Set("CPUCull", bCPUCull);
 
 
 	iniFile.Save(ini_file);
@@ -520,7 +599,7 @@ void VideoConfig::Save(const std::string& ini_file)
 
 bool VideoConfig::IsVSync() const
 {
-	return bVSync && !Core::GetIsThrottlerTempDisabled();
+	return bVSync && !Core::GetIsThrottlerTempDisabled() && !Movie::IsTurboPlayback();
 }
 
 bool VideoConfig::PixelLightingEnabled(const XFMemory& xfr, const u32 components) const
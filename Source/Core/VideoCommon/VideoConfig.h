@@ -86,12 +86,16 @@ struct VideoConfig final
 
 	// General
 	bool bVSync;
+	// Keeps at most one frame queued for presentation, at the cost of less CPU/GPU overlap
+	bool bLowLatencyPresent;
 	bool bRunning;
 	bool bWidescreenHack;
 	int iAspectRatio;
 	bool bCrop;   // Aspect ratio controls.
 	bool bUseXFB;
 	bool bUseRealXFB;
+	// Virtual XFB copies are encoded into RAM when that memory is read as a texture
+	bool bVirtualXFBWriteBack;
 
 	// OpenCL/OpenMP
 	bool bEnableOpenCL;
@@ -113,10 +117,12 @@ struct VideoConfig final
 	bool bTexDeposterize;
 	int iTexScalingType;
 	int iTexScalingFactor;
+	bool bCacheScaledTextures;
 	bool bTessellation;
 	bool bTessellationEarlyCulling;
 	int iTessellationDistance;
 	int iTessellationMax;
+	int iTessellationEdgeSize;
 	int iTessellationRoundingIntensity;
 	int iTessellationDisplacementIntensity;
 	bool bForceTrueColor;
@@ -131,10 +137,20 @@ struct VideoConfig final
 	bool bTexFmtOverlayEnable;
 	bool bTexFmtOverlayCenter;
 	bool bLogRenderTimeToFile;
+	// Keeps per frame timings for FrameTelemetry::Export
+	bool bFrameTelemetry;
+	// Times the host GPU passes with timestamp queries and shows them on screen
+	bool bGPUProfiling;
+	// Lowers the internal resolution below iEFBScale while the host GPU frame time is above
+	// fDynamicResolutionFrameTime milliseconds, see DynamicResolution
+	bool bDynamicResolution;
+	float fDynamicResolutionFrameTime;
 
 
 	// Render
 	bool bWireFrame;
+	// Expands lines and points in the vertex shader even when geometry shaders are available
+	bool bPreferVSForLinePointExpansion;
 	bool bDisableFog;
 
 	// Utility
@@ -144,26 +160,43 @@ struct VideoConfig final
 	bool bHiresMaterialMaps;
 	bool bHiresMaterialMapsBuild;
 	bool bCacheHiresTextures;
+	bool bStreamHiresTextures;
+	int iHiresTextureUploadBudget; // in MB per frame
+	int iHiresTextureMemoryBudget; // in MB, 0 picks one from the system memory
+	int iHiresTextureVRAMBudget; // in MB, 0 is unlimited
 	bool bDumpEFBTarget;
 	bool bUseFFV1;
 	bool bFreeLook;
 	bool bBorderlessFullscreen;
 	bool bCompileShaderOnStartup;
+	// Precompiles during the first frames instead of before the game starts
+	bool bBackgroundShaderPrecompile;
 
 	// Hacks
 	bool bEFBAccessEnable;
 	bool bEFBFastAccess;
 	bool bForceProgressive;
 	bool bPerfQueriesEnable;
+	// PE counter reads return the completed queries instead of waiting for the pending ones
+	bool bPerfQueriesAsync;
+	// Queries kept in flight before the oldest one is waited for, 0 uses the whole query buffer
+	int iPerfQueriesInFlight;
 	bool bFullAsyncShaderCompilation;
+	bool bUberShaderFallback;
 	bool bPredictiveFifo;
+	bool bDisplayListCache;
 	bool bWaitForShaderCompilation;
 	bool bEnableComputeTextureDecoding;
 	bool bEnableComputeTextureEncoding;
 	bool bEFBEmulateFormatChanges;
 	bool bSkipEFBCopyToRam;
+	// EFB copies to RAM are read back at the next flush point instead of right away
+	bool bDeferEFBCopies;
 	bool bCopyEFBScaled;
 	int iSafeTextureCache_ColorSamples;
+	bool bTexCacheWriteWatch;
+	// Drops the draws GX culls entirely and degenerate triangles before they reach the GPU
+	bool bCPUCull;
 	int iPhackvalue[4];
 	std::string sPhackvalue[2];
 	float fAspectRatioHackW, fAspectRatioHackH;
@@ -185,6 +218,8 @@ struct VideoConfig final
 
 	bool bFastDepthCalc;
 	int iBBoxMode;
+	// Bounding box reads return the values of the last frame instead of syncing the GPU
+	bool bBBoxAsyncReadback;
 	//for dx9-backend
 	bool bForceDualSourceBlend;
 	int iLog; // CONF_ bits
@@ -210,6 +245,7 @@ struct VideoConfig final
 	bool bDumpObjects;
 	bool bDumpTevStages;
 	bool bDumpTevTextureFetches;
+	int iSWRasterizerThreads; // 0 for one per core, 1 draws on the video thread only
 
 	bool bEnableValidationLayer;
 
@@ -220,6 +256,10 @@ struct VideoConfig final
 	// Currently only supported with Vulkan.
 	int iCommandBufferExecuteInterval;
 
+	// Number of command buffers recorded ahead of the GPU, 1 waits for each one to finish.
+	// Currently only supported with Vulkan.
+	int iFramesInFlight;
+
 	// Static config per API
 	// TODO: Move this out of VideoConfig
 	struct
@@ -242,11 +282,14 @@ struct VideoConfig final
 		bool bNeedBlendIndices; // needed by PixelShaderGen, so must stay in VideoCommon
 		bool bSupportsOversizedViewports;
 		bool bSupportsPostProcessing;
+		bool bSupportsPostProcessingCompute;
 		bool bSupportsGeometryShaders;
 		bool bSupports3DVision;
 		bool bSupportsExclusiveFullscreen;
 		bool bSupportsBBox;
 		bool bSupportsGSInstancing; // Needed by GeometryShaderGen, so must stay in VideoCommon
+		bool bSupportsVSLayerOutput; // The vertex shader can write the layer, used for stereo
+		bool bSupportsVSLinePointExpand; // The vertex shader can pull vertices from storage buffers
 		bool bSupportsPaletteConversion;
 		bool bSupportsClipControl; // Needed by VertexShaderGen, so must stay in VideoCommon		
 		bool bSupportsSSAA;
@@ -257,6 +300,10 @@ struct VideoConfig final
 		bool bSupportsComputeTextureEncoding;
 		bool bSupportsMultithreading;
 		bool bSupportsReversedDepthRange;
+		bool bSupportsPrimitiveRestart; // Triangles are drawn as strips with the largest index as restart index
+		bool bSupports32BitIndices; // Batches aren't flushed at 65535 vertices, see IndexGenerator
+		bool bSupportsDeferredEFBCopies; // EFB copies to RAM can be read back later
+		bool bSupportsVirtualXFBWriteBack; // Virtual XFB textures can be encoded into RAM
 	} backend_info;
 
 	// Utility
@@ -41,6 +41,8 @@ void VideoCommon_DoState(PointerWrap &p)
 
 	CommandProcessor::DoState(p);
 	p.DoMarker("CommandProcessor");
+	if (p.GetMode() == PointerWrap::MODE_READ)
+		Fifo::ResetPredictiveFifo();
 
 	PixelEngine::DoState(p);
 	p.DoMarker("PixelEngine");
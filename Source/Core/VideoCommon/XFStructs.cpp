@@ -2,6 +2,8 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <algorithm>
+
 #include "Common/Common.h"
 #include "Core/HW/Memmap.h"
 #include "VideoCommon/CPMemory.h"
@@ -21,6 +23,38 @@ inline void XFMemWritten(u32 transferSize, u32 baseAddress)
 	PixelShaderManager::InvalidateXFRange(baseAddress, baseAddress + transferSize);
 }
 
+// Narrows [*baseAddress, *baseAddress + *transferSize) to the words of the big endian data that
+// differ from xfmem. Games upload whole matrix and light blocks every draw, mostly unchanged, and
+// only the words that change need to flush and mark constants dirty. Returns false if none do.
+static bool TrimUnchangedXFMem(const u8* data, u32* baseAddress, u32* transferSize)
+{
+	const u32* current = (u32*)&xfmem + *baseAddress;
+	u32 first = 0;
+	u32 last = *transferSize;
+	while (first < last && current[first] == Common::swap32(data + first * sizeof(u32)))
+		first++;
+	if (first == last)
+		return false;
+	while (current[last - 1] == Common::swap32(data + (last - 1) * sizeof(u32)))
+		last--;
+
+	*baseAddress += first;
+	*transferSize = last - first;
+	return true;
+}
+
+// Whether the part of the register block [address, blockEnd) this transfer writes changes it
+static bool XFRegBlockChanged(u32 address, u32 blockEnd, int transferSize, u32 dataIndex)
+{
+	const u32 count = std::min<u32>(blockEnd - address, transferSize);
+	for (u32 i = 0; i < count; ++i)
+	{
+		if (((u32*)&xfmem)[address + i] != g_VideoData.Peek<u32>((dataIndex + i) * sizeof(u32)))
+			return true;
+	}
+	return false;
+}
+
 inline void XFRegWritten(int transferSize, u32 baseAddress)
 {
 	u32 address = baseAddress;
@@ -86,7 +120,7 @@ inline void XFRegWritten(int transferSize, u32 baseAddress)
 		case XFMEM_SETCHAN1_COLOR:
 		case XFMEM_SETCHAN0_ALPHA: // Channel Alpha
 		case XFMEM_SETCHAN1_ALPHA:
-			if (((u32*)&xfmem)[address - 0x1000] != (newValue & 0x7fff))
+			if (((u32*)&xfmem)[address] != (newValue & 0x7fff))
 				VertexManagerBase::Flush();
 			break;
 
@@ -111,10 +145,13 @@ inline void XFRegWritten(int transferSize, u32 baseAddress)
 		case XFMEM_SETVIEWPORT + 3:
 		case XFMEM_SETVIEWPORT + 4:
 		case XFMEM_SETVIEWPORT + 5:
-			VertexManagerBase::Flush();
-			VertexShaderManager::SetViewportChanged();
-			GeometryShaderManager::SetViewportChanged();
-			PixelShaderManager::SetViewportChanged();
+			if (XFRegBlockChanged(address, XFMEM_SETVIEWPORT + 6, transferSize, dataIndex))
+			{
+				VertexManagerBase::Flush();
+				VertexShaderManager::SetViewportChanged();
+				GeometryShaderManager::SetViewportChanged();
+				PixelShaderManager::SetViewportChanged();
+			}
 			nextAddress = XFMEM_SETVIEWPORT + 6;
 			break;
 
@@ -125,9 +162,12 @@ inline void XFRegWritten(int transferSize, u32 baseAddress)
 		case XFMEM_SETPROJECTION + 4:
 		case XFMEM_SETPROJECTION + 5:
 		case XFMEM_SETPROJECTION + 6:
-			VertexManagerBase::Flush();
-			VertexShaderManager::SetProjectionChanged();
-			GeometryShaderManager::SetProjectionChanged();
+			if (XFRegBlockChanged(address, XFMEM_SETPROJECTION + 7, transferSize, dataIndex))
+			{
+				VertexManagerBase::Flush();
+				VertexShaderManager::SetProjectionChanged();
+				GeometryShaderManager::SetProjectionChanged();
+			}
 			nextAddress = XFMEM_SETPROJECTION + 7;
 			break;
 
@@ -144,7 +184,8 @@ inline void XFRegWritten(int transferSize, u32 baseAddress)
 		case XFMEM_SETTEXMTXINFO + 5:
 		case XFMEM_SETTEXMTXINFO + 6:
 		case XFMEM_SETTEXMTXINFO + 7:
-			VertexManagerBase::Flush();
+			if (XFRegBlockChanged(address, XFMEM_SETTEXMTXINFO + 8, transferSize, dataIndex))
+				VertexManagerBase::Flush();
 
 			nextAddress = XFMEM_SETTEXMTXINFO + 8;
 			break;
@@ -157,7 +198,8 @@ inline void XFRegWritten(int transferSize, u32 baseAddress)
 		case XFMEM_SETPOSMTXINFO + 5:
 		case XFMEM_SETPOSMTXINFO + 6:
 		case XFMEM_SETPOSMTXINFO + 7:
-			VertexManagerBase::Flush();
+			if (XFRegBlockChanged(address, XFMEM_SETPOSMTXINFO + 8, transferSize, dataIndex))
+				VertexManagerBase::Flush();
 
 			nextAddress = XFMEM_SETPOSMTXINFO + 8;
 			break;
@@ -231,7 +273,10 @@ void LoadXFReg(u32 transferSize, u32 baseAddress)
 			transferSize = 0;
 		}
 
-		XFMemWritten(xfMemTransferSize, xfMemBase);
+		u32 changedBase = xfMemBase;
+		u32 changedSize = xfMemTransferSize;
+		if (TrimUnchangedXFMem(g_VideoData.GetPointer(), &changedBase, &changedSize))
+			XFMemWritten(changedSize, changedBase);
 		OpcodeDecoder::DataReadU32xFuncs[xfMemTransferSize - 1](&((u32*)&xfmem)[xfMemBase]);
 	}
 
@@ -261,19 +306,12 @@ void LoadIndexedXF(u32 val, int refarray)
 	{
 		newData = (u32*)Memory::GetPointer(g_main_cp_state.array_bases[refarray] + g_main_cp_state.array_strides[refarray] * index);
 	}
-	bool changed = false;
-	for (int i = 0; i < size; ++i)
-	{
-		if (currData[i] != Common::swap32(newData[i]))
-		{
-			changed = true;
-			break;
-		}
-	}
-	if (changed)
+	u32 changedBase = address;
+	u32 changedSize = size;
+	if (TrimUnchangedXFMem((const u8*)newData, &changedBase, &changedSize))
 	{
-		XFMemWritten(size, address);
-		for (int i = 0; i < size; ++i)
+		XFMemWritten(changedSize, changedBase);
+		for (u32 i = changedBase - address; i < changedBase - address + changedSize; ++i)
 			currData[i] = Common::swap32(newData[i]);
 	}
 }
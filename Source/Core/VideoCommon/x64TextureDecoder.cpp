@@ -11,10 +11,6 @@
 #include "Common/Intrinsics.h"
 
 #include "VideoCommon/TextureDecoder.h"
-#ifdef _WIN32
-#include "OpenCL.h"
-#include "OpenCL/OCLTextureDecoder.h"
-#endif
 #include "VideoCommon/VideoConfig.h"
 
 #include "VideoCommon/LookUpTables.h"
@@ -799,12 +795,353 @@ PC_TexFormat GetPC_TexFormat(u32 texformat, TlutFormat tlutfmt, bool compressed_
 	return fmt;
 }
 
+// AVX2 decoders, only called when cpu_info.bAVX2 is set.
+// Every store writes 8 texels: one block row for the 8 texel wide formats,
+// two block rows for the 4 texel wide ones.
+// The bgra variants back TexDecoder_Decode_real, the others TexDecoder_Decode_RGBA.
+
+template <bool bgra>
+ATTRIBUTE_TARGET("avx2")
+static inline __m256i PackRGBA_AVX2(__m256i r, __m256i g, __m256i b, __m256i a)
+{
+	return _mm256_or_si256(
+		_mm256_or_si256(bgra ? _mm256_slli_epi32(r, 16) : r, _mm256_slli_epi32(g, 8)),
+		_mm256_or_si256(bgra ? b : _mm256_slli_epi32(b, 16), _mm256_slli_epi32(a, 24)));
+}
+
+// Loads 8 big-endian 16-bit texels into the low half of each 32-bit lane.
+ATTRIBUTE_TARGET("avx2")
+static inline __m256i LoadBE16x8_AVX2(const u8* src)
+{
+	const __m256i kMaskSwap16 = _mm256_setr_epi8(
+		1, 0, -128, -128, 3, 2, -128, -128, 5, 4, -128, -128, 7, 6, -128, -128,
+		9, 8, -128, -128, 11, 10, -128, -128, 13, 12, -128, -128, 15, 14, -128, -128);
+	return _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)src)), kMaskSwap16);
+}
+
+// Writes texels 0-3 to dst and texels 4-7 to the next row.
+ATTRIBUTE_TARGET("avx2")
+static inline void Store2Rows_AVX2(u32* dst, u32 width, __m256i v)
+{
+	_mm_storeu_si128((__m128i*)dst, _mm256_castsi256_si128(v));
+	_mm_storeu_si128((__m128i*)(dst + width), _mm256_extracti128_si256(v, 1));
+}
+
+template <bool bgra>
+ATTRIBUTE_TARGET("avx2")
+static inline __m256i DecodeRGB565x8_AVX2(__m256i val)
+{
+	const __m256i kMask_x1f = _mm256_set1_epi32(0x1f);
+	const __m256i kMask_x3f = _mm256_set1_epi32(0x3f);
+	const __m256i r = _mm256_and_si256(_mm256_srli_epi32(val, 11), kMask_x1f);
+	const __m256i g = _mm256_and_si256(_mm256_srli_epi32(val, 5), kMask_x3f);
+	const __m256i b = _mm256_and_si256(val, kMask_x1f);
+	return PackRGBA_AVX2<bgra>(
+		_mm256_or_si256(_mm256_slli_epi32(r, 3), _mm256_srli_epi32(r, 2)),
+		_mm256_or_si256(_mm256_slli_epi32(g, 2), _mm256_srli_epi32(g, 4)),
+		_mm256_or_si256(_mm256_slli_epi32(b, 3), _mm256_srli_epi32(b, 2)),
+		_mm256_set1_epi32(0xFF));
+}
+
+// Decodes both RGB5A3 encodings and picks one per texel, so mixed blocks need no scalar fallback.
+template <bool bgra>
+ATTRIBUTE_TARGET("avx2")
+static inline __m256i DecodeRGB5A3x8_AVX2(__m256i val)
+{
+	const __m256i kMask_x1f = _mm256_set1_epi32(0x1f);
+	const __m256i kMask_x0f = _mm256_set1_epi32(0x0f);
+	const __m256i kMask_x07 = _mm256_set1_epi32(0x07);
+
+	// RGB555, alpha = 0xFF
+	const __m256i r5 = _mm256_and_si256(_mm256_srli_epi32(val, 10), kMask_x1f);
+	const __m256i g5 = _mm256_and_si256(_mm256_srli_epi32(val, 5), kMask_x1f);
+	const __m256i b5 = _mm256_and_si256(val, kMask_x1f);
+	const __m256i rgb555 = PackRGBA_AVX2<bgra>(
+		_mm256_or_si256(_mm256_slli_epi32(r5, 3), _mm256_srli_epi32(r5, 2)),
+		_mm256_or_si256(_mm256_slli_epi32(g5, 3), _mm256_srli_epi32(g5, 2)),
+		_mm256_or_si256(_mm256_slli_epi32(b5, 3), _mm256_srli_epi32(b5, 2)),
+		_mm256_set1_epi32(0xFF));
+
+	// RGB4A3
+	const __m256i r4 = _mm256_and_si256(_mm256_srli_epi32(val, 8), kMask_x0f);
+	const __m256i g4 = _mm256_and_si256(_mm256_srli_epi32(val, 4), kMask_x0f);
+	const __m256i b4 = _mm256_and_si256(val, kMask_x0f);
+	const __m256i a3 = _mm256_and_si256(_mm256_srli_epi32(val, 12), kMask_x07);
+	const __m256i rgb4a3 = PackRGBA_AVX2<bgra>(
+		_mm256_or_si256(_mm256_slli_epi32(r4, 4), r4),
+		_mm256_or_si256(_mm256_slli_epi32(g4, 4), g4),
+		_mm256_or_si256(_mm256_slli_epi32(b4, 4), b4),
+		_mm256_or_si256(_mm256_slli_epi32(a3, 5), _mm256_or_si256(_mm256_slli_epi32(a3, 2), _mm256_srli_epi32(a3, 1))));
+
+	// Bit 15 selects the encoding.
+	const __m256i is555 = _mm256_srai_epi32(_mm256_slli_epi32(val, 16), 31);
+	return _mm256_blendv_epi8(rgb4a3, rgb555, is555);
+}
+
+template <bool bgra>
+static inline u32 MakeColor(u32 r, u32 g, u32 b, u32 a)
+{
+	return bgra ? makecol(r & 0xFF, g & 0xFF, b & 0xFF, a) : makeRGBA(r & 0xFF, g & 0xFF, b & 0xFF, a);
+}
+
+// Matches the SSE2 CMPR decoder, which uses signed deltas for the interpolated colors.
+template <bool bgra>
+static inline void DecodeDXTPalette(u32* colors, const DXT1Block* src)
+{
+	const u16 c1 = Common::swap16(src->color1);
+	const u16 c2 = Common::swap16(src->color2);
+	const int blue1 = Convert5To8(c1 & 0x1F);
+	const int blue2 = Convert5To8(c2 & 0x1F);
+	const int green1 = Convert6To8((c1 >> 5) & 0x3F);
+	const int green2 = Convert6To8((c2 >> 5) & 0x3F);
+	const int red1 = Convert5To8((c1 >> 11) & 0x1F);
+	const int red2 = Convert5To8((c2 >> 11) & 0x1F);
+	colors[0] = MakeColor<bgra>(red1, green1, blue1, 255);
+	colors[1] = MakeColor<bgra>(red2, green2, blue2, 255);
+	if (c1 > c2)
+	{
+		const int blue3 = ((blue2 - blue1) >> 1) - ((blue2 - blue1) >> 3);
+		const int green3 = ((green2 - green1) >> 1) - ((green2 - green1) >> 3);
+		const int red3 = ((red2 - red1) >> 1) - ((red2 - red1) >> 3);
+		colors[2] = MakeColor<bgra>(red1 + red3, green1 + green3, blue1 + blue3, 255);
+		colors[3] = MakeColor<bgra>(red2 - red3, green2 - green3, blue2 - blue3, 255);
+	}
+	else
+	{
+		colors[2] = MakeColor<bgra>((red1 + red2 + 1) / 2, // Average
+			(green1 + green2 + 1) / 2,
+			(blue1 + blue2 + 1) / 2, 255);
+		colors[3] = MakeColor<bgra>(red2, green2, blue2, 0);  // Color2 but transparent
+	}
+}
+
+template <bool bgra>
+static void DecodeTLUTToPalette(u32* palette, u32 count, u32 tlutaddr, TlutFormat tlutfmt)
+{
+	const u16* tlut = (const u16*)(texMem + tlutaddr);
+	for (u32 i = 0; i < count; i++)
+	{
+		switch (tlutfmt)
+		{
+		case GX_TL_IA8:
+			palette[i] = decodeIA8Swapped(tlut[i]);
+			break;
+		case GX_TL_RGB565:
+		{
+			const u32 rgba = decode565RGBA(Common::swap16(tlut[i]));
+			palette[i] = bgra ? (rgba & 0xFF00FF00) | ((rgba & 0xFF) << 16) | ((rgba >> 16) & 0xFF) : rgba;
+			break;
+		}
+		default:
+			palette[i] = bgra ? decode5A3(Common::swap16(tlut[i])) : decode5A3RGBA(Common::swap16(tlut[i]));
+			break;
+		}
+	}
+}
+
+template <bool bgra>
+ATTRIBUTE_TARGET("avx2")
+static PC_TexFormat TexDecoder_Decode_AVX2(u32* dst, const u8* src, u32 width, u32 height, u32 texformat, u32 tlutaddr, TlutFormat tlutfmt)
+{
+	const u32 Wsteps4 = (width + 3) / 4;
+	const u32 Wsteps8 = (width + 7) / 8;
+
+	switch (texformat)
+	{
+	case GX_TF_C4:
+	{
+		alignas(32) u32 palette[16];
+		DecodeTLUTToPalette<bgra>(palette, 16, tlutaddr, tlutfmt);
+		const __m256i kExpand = _mm256_setr_epi8(
+			0, -128, -128, -128, 0, -128, -128, -128, 1, -128, -128, -128, 1, -128, -128, -128,
+			2, -128, -128, -128, 2, -128, -128, -128, 3, -128, -128, -128, 3, -128, -128, -128);
+		const __m256i kShift = _mm256_setr_epi32(4, 0, 4, 0, 4, 0, 4, 0);
+		const __m256i kMask_x0f = _mm256_set1_epi32(0x0f);
+		for (u32 y = 0; y < height; y += 8)
+			for (u32 x = 0, yStep = (y / 8) * Wsteps8; x < width; x += 8, yStep++)
+				for (u32 iy = 0, xStep = 8 * yStep; iy < 8; iy++, xStep++)
+				{
+					const __m256i row = _mm256_set1_epi32(*(const s32*)(src + 4 * xStep));
+					const __m256i idx = _mm256_and_si256(_mm256_srlv_epi32(_mm256_shuffle_epi8(row, kExpand), kShift), kMask_x0f);
+					_mm256_storeu_si256((__m256i*)(dst + (y + iy) * width + x), _mm256_i32gather_epi32((const int*)palette, idx, 4));
+				}
+	}
+	break;
+	case GX_TF_C8:
+	{
+		alignas(32) u32 palette[256];
+		DecodeTLUTToPalette<bgra>(palette, 256, tlutaddr, tlutfmt);
+		for (u32 y = 0; y < height; y += 4)
+			for (u32 x = 0, yStep = (y / 4) * Wsteps8; x < width; x += 8, yStep++)
+				for (u32 iy = 0, xStep = 4 * yStep; iy < 4; iy++, xStep++)
+				{
+					const __m256i idx = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(src + 8 * xStep)));
+					_mm256_storeu_si256((__m256i*)(dst + (y + iy) * width + x), _mm256_i32gather_epi32((const int*)palette, idx, 4));
+				}
+	}
+	break;
+	case GX_TF_I4:
+	{
+		// Each byte holds two texels, high nibble first. Replicate every byte into the
+		// lanes of both its texels, then shift the wanted nibble down.
+		const __m256i kExpand = _mm256_setr_epi8(
+			0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1,
+			2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3);
+		const __m256i kShift = _mm256_setr_epi32(4, 0, 4, 0, 4, 0, 4, 0);
+		const __m256i kMask_x0f = _mm256_set1_epi8(0x0f);
+		for (u32 y = 0; y < height; y += 8)
+			for (u32 x = 0, yStep = (y / 8) * Wsteps8; x < width; x += 8, yStep++)
+				for (u32 iy = 0, xStep = 8 * yStep; iy < 8; iy++, xStep++)
+				{
+					const __m256i row = _mm256_set1_epi32(*(const s32*)(src + 4 * xStep));
+					const __m256i i4 = _mm256_and_si256(_mm256_srlv_epi32(_mm256_shuffle_epi8(row, kExpand), kShift), kMask_x0f);
+					_mm256_storeu_si256((__m256i*)(dst + (y + iy) * width + x), _mm256_or_si256(i4, _mm256_slli_epi32(i4, 4)));
+				}
+	}
+	break;
+	case GX_TF_I8:
+	{
+		const __m256i kExpand = _mm256_setr_epi8(
+			0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3,
+			4, 4, 4, 4, 5, 5, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7);
+		for (u32 y = 0; y < height; y += 4)
+			for (u32 x = 0, yStep = (y / 4) * Wsteps8; x < width; x += 8, yStep++)
+				for (u32 iy = 0, xStep = 4 * yStep; iy < 4; iy++, xStep++)
+				{
+					const __m256i row = _mm256_broadcastq_epi64(_mm_loadl_epi64((const __m128i*)(src + 8 * xStep)));
+					_mm256_storeu_si256((__m256i*)(dst + (y + iy) * width + x), _mm256_shuffle_epi8(row, kExpand));
+				}
+	}
+	break;
+	case GX_TF_IA4:
+	{
+		// (AAAAIIII) -> (IIIIIIII, AAAAAAAA) in the low two bytes of each lane, then spread to I, I, I, A.
+		const __m256i kMask_x0f = _mm256_set1_epi32(0x0f);
+		const __m256i kMask_xf0 = _mm256_set1_epi32(0xf0);
+		const __m256i kSpread = _mm256_setr_epi8(
+			0, 0, 0, 1, 4, 4, 4, 5, 8, 8, 8, 9, 12, 12, 12, 13,
+			0, 0, 0, 1, 4, 4, 4, 5, 8, 8, 8, 9, 12, 12, 12, 13);
+		for (u32 y = 0; y < height; y += 4)
+			for (u32 x = 0, yStep = (y / 4) * Wsteps8; x < width; x += 8, yStep++)
+				for (u32 iy = 0, xStep = 4 * yStep; iy < 4; iy++, xStep++)
+				{
+					const __m256i val = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(src + 8 * xStep)));
+					const __m256i i = _mm256_and_si256(val, kMask_x0f);
+					const __m256i a = _mm256_and_si256(val, kMask_xf0);
+					const __m256i ia = _mm256_or_si256(
+						_mm256_or_si256(i, _mm256_slli_epi32(i, 4)),
+						_mm256_or_si256(_mm256_slli_epi32(a, 8), _mm256_slli_epi32(a, 4)));
+					_mm256_storeu_si256((__m256i*)(dst + (y + iy) * width + x), _mm256_shuffle_epi8(ia, kSpread));
+				}
+	}
+	break;
+	case GX_TF_IA8:
+	{
+		// (A, I) byte pairs -> I, I, I, A
+		const __m256i kSpread = _mm256_setr_epi8(
+			1, 1, 1, 0, 3, 3, 3, 2, 5, 5, 5, 4, 7, 7, 7, 6,
+			9, 9, 9, 8, 11, 11, 11, 10, 13, 13, 13, 12, 15, 15, 15, 14);
+		for (u32 y = 0; y < height; y += 4)
+			for (u32 x = 0, yStep = (y / 4) * Wsteps4; x < width; x += 4, yStep++)
+				for (u32 iy = 0, xStep = 4 * yStep; iy < 4; iy += 2, xStep += 2)
+				{
+					const __m256i val = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)(src + 8 * xStep)));
+					Store2Rows_AVX2(dst + (y + iy) * width + x, width, _mm256_shuffle_epi8(val, kSpread));
+				}
+	}
+	break;
+	case GX_TF_RGB565:
+	{
+		for (u32 y = 0; y < height; y += 4)
+			for (u32 x = 0, yStep = (y / 4) * Wsteps4; x < width; x += 4, yStep++)
+				for (u32 iy = 0, xStep = 4 * yStep; iy < 4; iy += 2, xStep += 2)
+					Store2Rows_AVX2(dst + (y + iy) * width + x, width, DecodeRGB565x8_AVX2<bgra>(LoadBE16x8_AVX2(src + 8 * xStep)));
+	}
+	break;
+	case GX_TF_RGB5A3:
+	{
+		for (u32 y = 0; y < height; y += 4)
+			for (u32 x = 0, yStep = (y / 4) * Wsteps4; x < width; x += 4, yStep++)
+				for (u32 iy = 0, xStep = 4 * yStep; iy < 4; iy += 2, xStep += 2)
+					Store2Rows_AVX2(dst + (y + iy) * width + x, width, DecodeRGB5A3x8_AVX2<bgra>(LoadBE16x8_AVX2(src + 8 * xStep)));
+	}
+	break;
+	case GX_TF_RGBA8:
+	{
+		// A block is 16 AR pairs followed by 16 GB pairs. Each 128-bit lane covers two rows,
+		// so interleaving the lanes yields rows 0 and 2 in the low unpack and rows 1 and 3 in the high one.
+		const __m256i kMaskARGB = bgra ?
+			_mm256_setr_epi8(3, 1, 2, 0, 7, 5, 6, 4, 11, 9, 10, 8, 15, 13, 14, 12,
+				3, 1, 2, 0, 7, 5, 6, 4, 11, 9, 10, 8, 15, 13, 14, 12) :
+			_mm256_setr_epi8(2, 1, 3, 0, 6, 5, 7, 4, 10, 9, 11, 8, 14, 13, 15, 12,
+				2, 1, 3, 0, 6, 5, 7, 4, 10, 9, 11, 8, 14, 13, 15, 12);
+		for (u32 y = 0; y < height; y += 4)
+			for (u32 x = 0, yStep = (y / 4) * Wsteps4; x < width; x += 4, yStep++)
+			{
+				const u8* src2 = src + 64 * yStep;
+				const __m256i ar = _mm256_loadu_si256((const __m256i*)src2);
+				const __m256i gb = _mm256_loadu_si256((const __m256i*)src2 + 1);
+				const __m256i rows02 = _mm256_shuffle_epi8(_mm256_unpacklo_epi8(ar, gb), kMaskARGB);
+				const __m256i rows13 = _mm256_shuffle_epi8(_mm256_unpackhi_epi8(ar, gb), kMaskARGB);
+				u32* dst32 = dst + y * width + x;
+				_mm_storeu_si128((__m128i*)dst32, _mm256_castsi256_si128(rows02));
+				_mm_storeu_si128((__m128i*)(dst32 + width), _mm256_castsi256_si128(rows13));
+				_mm_storeu_si128((__m128i*)(dst32 + width * 2), _mm256_extracti128_si256(rows02, 1));
+				_mm_storeu_si128((__m128i*)(dst32 + width * 3), _mm256_extracti128_si256(rows13, 1));
+			}
+	}
+	break;
+	case GX_TF_CMPR:
+	{
+		// Two horizontally adjacent blocks are decoded together: their palettes fill an 8 entry
+		// table and the 2-bit indices of the right block are offset by 4 to select the upper half.
+		const __m256i kShift = _mm256_setr_epi32(6, 4, 2, 0, 6, 4, 2, 0);
+		const __m256i kHalf = _mm256_setr_epi32(0, 0, 0, 0, 4, 4, 4, 4);
+		const __m256i kMask_x03 = _mm256_set1_epi32(3);
+		for (u32 y = 0; y < height; y += 8)
+			for (u32 x = 0, yStep = (y / 8) * Wsteps8; x < width; x += 8, yStep++)
+				for (u32 z = 0, xStep = 2 * yStep; z < 2; ++z, xStep++)
+				{
+					const DXT1Block* blocks = (const DXT1Block*)src + 2 * xStep;
+					alignas(32) u32 colors[8];
+					DecodeDXTPalette<bgra>(colors, blocks);
+					DecodeDXTPalette<bgra>(colors + 4, blocks + 1);
+					const __m256i palette = _mm256_load_si256((const __m256i*)colors);
+					__m256i lines = _mm256_setr_epi32(
+						blocks[0].indices, blocks[0].indices, blocks[0].indices, blocks[0].indices,
+						blocks[1].indices, blocks[1].indices, blocks[1].indices, blocks[1].indices);
+					u32* dst32 = dst + (y + z * 4) * width + x;
+					for (u32 iy = 0; iy < 4; iy++)
+					{
+						const __m256i idx = _mm256_or_si256(_mm256_and_si256(_mm256_srlv_epi32(lines, kShift), kMask_x03), kHalf);
+						_mm256_storeu_si256((__m256i*)(dst32 + iy * width), _mm256_permutevar8x32_epi32(palette, idx));
+						lines = _mm256_srli_epi32(lines, 8);
+					}
+				}
+	}
+	break;
+	default:
+		return PC_TEX_FMT_NONE;
+	}
+	return bgra ? PC_TEX_FMT_BGRA32 : PC_TEX_FMT_RGBA32;
+}
+
 //switch endianness, unswizzle
 static PC_TexFormat TexDecoder_Decode_real(u8 *dst, const u8 *src, u32 width, u32 height, u32 texformat, u32 tlutaddr, TlutFormat tlutfmt, bool compressed_supported)
 {
 	const u32 Wsteps4 = (width + 3) / 4;
 	const u32 Wsteps8 = (width + 7) / 8;
 
+	if (cpu_info.bAVX2)
+	{
+		// Only the formats that decode to BGRA32 here, the others are plain copies.
+		const bool bgra_output = texformat == GX_TF_RGB5A3 || texformat == GX_TF_RGBA8
+			|| (texformat == GX_TF_CMPR && !compressed_supported)
+			|| ((texformat == GX_TF_C4 || texformat == GX_TF_C8) && tlutfmt == GX_TL_RGB5A3);
+		if (bgra_output)
+			return TexDecoder_Decode_AVX2<true>((u32*)dst, src, width, height, texformat, tlutaddr, tlutfmt);
+	}
+
 	switch (texformat)
 	{
 	case GX_TF_C4:
@@ -1070,6 +1407,13 @@ static PC_TexFormat TexDecoder_Decode_RGBA(u32 * dst, const u8 * src, u32 width,
 	const u32 Wsteps4 = (width + 3) / 4;
 	const u32 Wsteps8 = (width + 7) / 8;
 
+	if (cpu_info.bAVX2)
+	{
+		const PC_TexFormat fmt = TexDecoder_Decode_AVX2<false>(dst, src, width, height, texformat, tlutaddr, tlutfmt);
+		if (fmt != PC_TEX_FMT_NONE)
+			return fmt;
+	}
+
 	switch (texformat)
 	{
 	case GX_TF_C4:
@@ -2122,24 +2466,15 @@ void TexDecoder_SetTexFmtOverlayOptions(bool enable, bool center)
 PC_TexFormat TexDecoder_Decode(u8 *dst, const u8 *src, u32 width, u32 height, u32 texformat, u32 tlutaddr, TlutFormat tlutfmt, bool rgbaOnly, bool compressed_supported)
 {
 	PC_TexFormat retval = PC_TEX_FMT_NONE;
-#ifdef _WIN32
-	retval = TexDecoder_Decode_OpenCL(dst, src,
-		width, height, texformat, tlutaddr, tlutfmt, rgbaOnly);
-
-	if (retval == PC_TEX_FMT_NONE)
+	// OpenCL decoding is asynchronous, it is driven by the texture cache instead.
+	if (rgbaOnly)
 	{
-#endif
-		if (rgbaOnly)
-		{
-			retval = TexDecoder_Decode_RGBA((u32*)dst, src, width, height, texformat, tlutaddr, tlutfmt);
-		}
-		else
-		{
-			retval = TexDecoder_Decode_real(dst, src, width, height, texformat, tlutaddr, tlutfmt, compressed_supported);
-		}
-#ifdef _WIN32
+		retval = TexDecoder_Decode_RGBA((u32*)dst, src, width, height, texformat, tlutaddr, tlutfmt);
+	}
+	else
+	{
+		retval = TexDecoder_Decode_real(dst, src, width, height, texformat, tlutaddr, tlutfmt, compressed_supported);
 	}
-#endif
 	if ((!TexFmt_Overlay_Enable) || (retval == PC_TEX_FMT_NONE))
 		return retval;
 
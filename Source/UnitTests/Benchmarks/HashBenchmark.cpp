@@ -0,0 +1,60 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CPUDetect.h"
+#include "Common/CommonFuncs.h"
+#include "Common/CommonTypes.h"
+#include "Common/Hash.h"
+#include "Common/StringUtil.h"
+#include "TestUtils/Benchmark.h"
+
+namespace
+{
+struct HashCase
+{
+  const char* name;
+  u64 (*func)(const u8* src, u32 len, u32 samples);
+};
+
+// Texture sizes, from a palette to a 1024x1024 RGBA8 texture
+const u32 s_sizes[] = {512, 8 * 1024, 128 * 1024, 4 * 1024 * 1024};
+// 0 hashes everything, the others are the safe texture cache sample counts
+const u32 s_samples[] = {0, 512, 128};
+}
+
+TEST(HashBenchmark, TextureHashes)
+{
+  // GetHash64 is whichever of the others the CPU runs fastest
+  SetHash64Function();
+  std::vector<HashCase> cases = {{"GetHash64", GetHash64},
+                                 {"GetMurmurHash3", GetMurmurHash3},
+                                 {"GetXXHash64", GetXXHash64}};
+  if (cpu_info.bSSE4_2)
+    cases.push_back({"GetCRC32", GetCRC32});
+
+  std::mt19937 rng(1234);
+  std::vector<u8> data(s_sizes[ArraySize(s_sizes) - 1]);
+  for (u8& b : data)
+    b = static_cast<u8>(rng());
+
+  volatile u64 result = 0;
+  Benchmark::PrintHeader();
+  for (const HashCase& c : cases)
+  {
+    for (u32 samples : s_samples)
+    {
+      for (u32 size : s_sizes)
+      {
+        const std::string name = StringFromFormat("%s %u bytes samples %u", c.name, size, samples);
+        Benchmark::Run(name, size, "B",
+                       [&] { result = result + c.func(data.data(), size, samples); });
+      }
+    }
+  }
+}
@@ -0,0 +1,68 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <vector>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CommonTypes.h"
+#include "Common/StringUtil.h"
+#include "TestUtils/Benchmark.h"
+#include "VideoCommon/IndexGenerator.h"
+#include "VideoCommon/OpcodeDecoding.h"
+#include "VideoCommon/VideoConfig.h"
+
+namespace
+{
+struct PrimitiveCase
+{
+  const char* name;
+  int primitive;
+};
+
+const PrimitiveCase s_primitives[] = {
+    {"quads", GX_DRAW_QUADS},
+    {"triangles", GX_DRAW_TRIANGLES},
+    {"triangle strip", GX_DRAW_TRIANGLE_STRIP},
+    {"triangle fan", GX_DRAW_TRIANGLE_FAN},
+    {"lines", GX_DRAW_LINES},
+    {"line strip", GX_DRAW_LINE_STRIP},
+    {"points", GX_DRAW_POINTS},
+};
+
+// Vertices per call, from single sprites to whole meshes
+const u32 s_draw_sizes[] = {4, 24, 300, 3000};
+// Vertices generated per run, all within one index buffer
+const u32 VERTICES_PER_RUN = 30000;
+}
+
+TEST(IndexGeneratorBenchmark, AddIndices)
+{
+  const bool restart = g_ActiveConfig.backend_info.bSupportsPrimitiveRestart;
+  // A fan makes the most indices, three per vertex
+  std::vector<u16> buffer(VERTICES_PER_RUN * 3 + 64);
+
+  Benchmark::PrintHeader();
+  for (bool primitive_restart : {false, true})
+  {
+    g_ActiveConfig.backend_info.bSupportsPrimitiveRestart = primitive_restart;
+    IndexGenerator::Init();
+    for (const PrimitiveCase& c : s_primitives)
+    {
+      for (u32 size : s_draw_sizes)
+      {
+        const u32 draws = VERTICES_PER_RUN / size;
+        const std::string name = StringFromFormat("%s %u%s", c.name, size,
+                                                  primitive_restart ? " restart" : "");
+        Benchmark::Run(name, draws * size, "vtx", [&] {
+          IndexGenerator::Start(buffer.data());
+          for (u32 i = 0; i < draws; i++)
+            IndexGenerator::AddIndices(c.primitive, size);
+        });
+      }
+    }
+  }
+  g_ActiveConfig.backend_info.bSupportsPrimitiveRestart = restart;
+  IndexGenerator::Init();
+}
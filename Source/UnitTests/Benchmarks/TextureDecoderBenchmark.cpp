@@ -0,0 +1,79 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CPUDetect.h"
+#include "Common/CommonTypes.h"
+#include "Common/StringUtil.h"
+#include "TestUtils/Benchmark.h"
+#include "VideoCommon/TextureDecoder.h"
+
+namespace
+{
+struct DecoderCase
+{
+  const char* name;
+  u32 format;
+  TlutFormat tlutfmt;
+};
+
+const DecoderCase s_cases[] = {
+    {"I4", GX_TF_I4, GX_TL_IA8},
+    {"I8", GX_TF_I8, GX_TL_IA8},
+    {"IA4", GX_TF_IA4, GX_TL_IA8},
+    {"IA8", GX_TF_IA8, GX_TL_IA8},
+    {"RGB565", GX_TF_RGB565, GX_TL_IA8},
+    {"RGB5A3", GX_TF_RGB5A3, GX_TL_IA8},
+    {"RGBA8", GX_TF_RGBA8, GX_TL_IA8},
+    {"CMPR", GX_TF_CMPR, GX_TL_IA8},
+    {"C4 IA8", GX_TF_C4, GX_TL_IA8},
+    {"C4 RGB565", GX_TF_C4, GX_TL_RGB565},
+    {"C4 RGB5A3", GX_TF_C4, GX_TL_RGB5A3},
+    {"C8 IA8", GX_TF_C8, GX_TL_IA8},
+    {"C8 RGB565", GX_TF_C8, GX_TL_RGB565},
+    {"C8 RGB5A3", GX_TF_C8, GX_TL_RGB5A3},
+    {"C14X2 RGB5A3", GX_TF_C14X2, GX_TL_RGB5A3},
+};
+
+// From small UI textures to the largest the hardware supports
+const u32 s_sizes[] = {16, 64, 256, 1024};
+
+const u32 TLUT_ADDRESS = TMEM_SIZE / 2;
+}
+
+TEST(TextureDecoderBenchmark, Decode)
+{
+  const bool has_avx2 = cpu_info.bAVX2;
+  std::mt19937 rng(1234);
+  std::vector<u8> src(TexDecoder_GetTextureSizeInBytes(1024, 1024, GX_TF_RGBA8));
+  for (u8& b : src)
+    b = static_cast<u8>(rng());
+  for (u32 i = 0; i < 512; i++)
+    texMem[TLUT_ADDRESS + i] = static_cast<u8>(rng());
+  std::vector<u32> dst(1024 * 1024);
+
+  Benchmark::PrintHeader();
+  for (int avx2 = 0; avx2 < (has_avx2 ? 2 : 1); avx2++)
+  {
+    cpu_info.bAVX2 = avx2 != 0;
+    for (const DecoderCase& c : s_cases)
+    {
+      for (u32 size : s_sizes)
+      {
+        // Throughput in decoded RGBA8 bytes, the same for every format
+        const std::string name =
+            StringFromFormat("%s %ux%u%s", c.name, size, size, avx2 ? " avx2" : "");
+        Benchmark::Run(name, size * size * 4.0, "B", [&] {
+          TexDecoder_Decode(reinterpret_cast<u8*>(dst.data()), src.data(), size, size, c.format,
+                            TLUT_ADDRESS, c.tlutfmt, true, false);
+        });
+      }
+    }
+  }
+  cpu_info.bAVX2 = has_avx2;
+}
@@ -0,0 +1,191 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>  // NOLINT
+
+// The TEST macro of gtest conflicts with the TEST method of the x64Emitter, GTEST_TEST is the
+// same thing under another name.
+#undef TEST
+
+#include "Common/CommonTypes.h"
+#include "Common/StringUtil.h"
+#include "TestUtils/Benchmark.h"
+#include "VideoCommon/CPMemory.h"
+#include "VideoCommon/OpcodeDecoding.h"
+#include "VideoCommon/VertexLoader.h"
+#include "VideoCommon/VertexLoaderBase.h"
+#ifdef _M_X86_64
+#include "VideoCommon/VertexLoaderX64.h"
+#elif defined(_M_ARM_64)
+#include "VideoCommon/VertexLoaderARM64.h"
+#endif
+
+namespace
+{
+struct VertexCase
+{
+  const char* name;
+  void (*setup)(TVtxDesc& desc, VAT& vat);
+};
+
+// Formats games commonly draw with, from plain positions to every attribute indexed
+const VertexCase s_cases[] = {
+    {"pos float",
+     [](TVtxDesc& desc, VAT& vat) {
+       desc.Position = DIRECT;
+       vat.g0.PosElements = 1;
+       vat.g0.PosFormat = FORMAT_FLOAT;
+     }},
+    {"pos s16",
+     [](TVtxDesc& desc, VAT& vat) {
+       desc.Position = DIRECT;
+       vat.g0.PosElements = 1;
+       vat.g0.PosFormat = FORMAT_SHORT;
+       vat.g0.PosFrac = 8;
+     }},
+    {"pos s16 nrm s8 col rgba8 tex s16",
+     [](TVtxDesc& desc, VAT& vat) {
+       desc.Position = DIRECT;
+       desc.Normal = DIRECT;
+       desc.Color0 = DIRECT;
+       desc.Tex0Coord = DIRECT;
+       vat.g0.PosElements = 1;
+       vat.g0.PosFormat = FORMAT_SHORT;
+       vat.g0.PosFrac = 8;
+       vat.g0.NormalFormat = FORMAT_BYTE;
+       vat.g0.Color0Elements = 1;
+       vat.g0.Color0Comp = FORMAT_32B_8888;
+       vat.g0.Tex0CoordElements = 1;
+       vat.g0.Tex0CoordFormat = FORMAT_SHORT;
+       vat.g0.Tex0Frac = 10;
+     }},
+    {"mtx pos/nrm/tex idx16 float col idx8",
+     [](TVtxDesc& desc, VAT& vat) {
+       desc.PosMatIdx = 1;
+       desc.Position = INDEX16;
+       desc.Normal = INDEX16;
+       desc.Color0 = INDEX8;
+       desc.Tex0Coord = INDEX16;
+       vat.g0.PosElements = 1;
+       vat.g0.PosFormat = FORMAT_FLOAT;
+       vat.g0.NormalFormat = FORMAT_FLOAT;
+       vat.g0.Color0Elements = 1;
+       vat.g0.Color0Comp = FORMAT_32B_8888;
+       vat.g0.Tex0CoordElements = 1;
+       vat.g0.Tex0CoordFormat = FORMAT_FLOAT;
+     }},
+    {"all attributes idx16 float",
+     [](TVtxDesc& desc, VAT& vat) {
+       desc.Hex = 0;
+       desc.PosMatIdx = 1;
+       desc.Tex0MatIdx = 1;
+       desc.Tex1MatIdx = 1;
+       desc.Tex2MatIdx = 1;
+       desc.Tex3MatIdx = 1;
+       desc.Tex4MatIdx = 1;
+       desc.Tex5MatIdx = 1;
+       desc.Tex6MatIdx = 1;
+       desc.Tex7MatIdx = 1;
+       // Position..Tex7Coord
+       for (int i = 0; i < 12; i++)
+         desc.Hex |= static_cast<u64>(INDEX16) << (9 + i * 2);
+       vat.g0.PosElements = 1;
+       vat.g0.PosFormat = FORMAT_FLOAT;
+       vat.g0.NormalElements = 1;
+       vat.g0.NormalFormat = FORMAT_FLOAT;
+       vat.g0.Color0Elements = 1;
+       vat.g0.Color0Comp = FORMAT_32B_8888;
+       vat.g0.Color1Elements = 1;
+       vat.g0.Color1Comp = FORMAT_32B_8888;
+       vat.g0.Tex0CoordElements = 1;
+       vat.g0.Tex0CoordFormat = FORMAT_FLOAT;
+       vat.g1.Tex1CoordElements = 1;
+       vat.g1.Tex1CoordFormat = FORMAT_FLOAT;
+       vat.g1.Tex2CoordElements = 1;
+       vat.g1.Tex2CoordFormat = FORMAT_FLOAT;
+       vat.g1.Tex3CoordElements = 1;
+       vat.g1.Tex3CoordFormat = FORMAT_FLOAT;
+       vat.g1.Tex4CoordElements = 1;
+       vat.g1.Tex4CoordFormat = FORMAT_FLOAT;
+       vat.g2.Tex5CoordElements = 1;
+       vat.g2.Tex5CoordFormat = FORMAT_FLOAT;
+       vat.g2.Tex6CoordElements = 1;
+       vat.g2.Tex6CoordFormat = FORMAT_FLOAT;
+       vat.g2.Tex7CoordElements = 1;
+       vat.g2.Tex7CoordFormat = FORMAT_FLOAT;
+     }},
+};
+
+const int VERTEX_COUNT = 4096;
+// Every array element is this far apart, enough for the largest attribute
+const u32 ARRAY_STRIDE = 64;
+
+// The JIT loader of the host and the interpreter it falls back to
+std::vector<std::pair<const char*, std::unique_ptr<VertexLoaderBase>>>
+CreateLoaders(const TVtxDesc& desc, const VAT& vat)
+{
+  std::vector<std::pair<const char*, std::unique_ptr<VertexLoaderBase>>> loaders;
+#ifdef _M_X86_64
+  loaders.emplace_back("x64", std::make_unique<VertexLoaderX64>(desc, vat));
+#elif defined(_M_ARM_64)
+  loaders.emplace_back("arm64", std::make_unique<VertexLoaderARM64>(desc, vat));
+#endif
+  loaders.emplace_back("interpreter", std::make_unique<VertexLoader>(desc, vat));
+  return loaders;
+}
+}
+
+GTEST_TEST(VertexLoaderBenchmark, RunVertices)
+{
+  std::mt19937 rng(1234);
+  std::vector<u8> arrays(0x10000 * ARRAY_STRIDE);
+  for (u8& b : arrays)
+    b = static_cast<u8>(rng());
+  for (int i = 0; i < 12; i++)
+  {
+    cached_arraybases[i] = arrays.data();
+    g_main_cp_state.array_strides[i] = ARRAY_STRIDE;
+  }
+
+  Benchmark::PrintHeader();
+  for (const VertexCase& c : s_cases)
+  {
+    TVtxDesc desc;
+    VAT vat;
+    std::memset(&desc, 0, sizeof(desc));
+    std::memset(&vat, 0, sizeof(vat));
+    c.setup(desc, vat);
+
+    for (auto& named_loader : CreateLoaders(desc, vat))
+    {
+      VertexLoaderBase* loader = named_loader.second.get();
+      if (!loader->IsInitialized())
+        continue;
+
+      std::vector<u8> src(VERTEX_COUNT * loader->m_VertexSize);
+      for (u8& b : src)
+        b = static_cast<u8>(rng());
+      // The loaders may write a little past the last vertex
+      std::vector<u8> dst(VERTEX_COUNT * loader->m_native_stride + 64);
+
+      VertexLoaderParameters parameters = {};
+      parameters.source = src.data();
+      parameters.destination = dst.data();
+      parameters.VtxDesc = &desc;
+      parameters.VtxAttr = &vat;
+      parameters.buf_size = src.size();
+      parameters.primitive = GX_DRAW_TRIANGLES;
+      parameters.count = VERTEX_COUNT;
+
+      const std::string name = StringFromFormat("%s %s", c.name, named_loader.first);
+      Benchmark::Run(name, VERTEX_COUNT, "vtx", [&] { loader->RunVertices(parameters); });
+    }
+  }
+}
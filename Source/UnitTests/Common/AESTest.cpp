@@ -0,0 +1,90 @@
+// Copyright 2016 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <mbedtls/aes.h>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CPUDetect.h"
+#include "Common/CommonTypes.h"
+#include "Common/Crypto/AES.h"
+
+namespace
+{
+// NIST SP 800-38A, F.2.2 CBC-AES128.Decrypt
+const u8 s_key[16] = {0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6,
+                      0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c};
+const u8 s_iv[16] = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+                     0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f};
+const u8 s_ciphertext[32] = {0x76, 0x49, 0xab, 0xac, 0x81, 0x19, 0xb2, 0x46, 0xce, 0xe9, 0x8e,
+                             0x9b, 0x12, 0xe9, 0x19, 0x7d, 0x50, 0x86, 0xcb, 0x9b, 0x50, 0x72,
+                             0x19, 0xee, 0x95, 0xdb, 0x11, 0x3a, 0x91, 0x76, 0x78, 0xb2};
+const u8 s_plaintext[32] = {0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96, 0xe9, 0x3d, 0x7e,
+                            0x11, 0x73, 0x93, 0x17, 0x2a, 0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03,
+                            0xac, 0x9c, 0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51};
+
+std::vector<u8> DecryptWithMbedtls(const u8* key, const u8* iv, const std::vector<u8>& in)
+{
+  mbedtls_aes_context ctx;
+  mbedtls_aes_init(&ctx);
+  mbedtls_aes_setkey_dec(&ctx, key, 128);
+  u8 iv_copy[16];
+  std::memcpy(iv_copy, iv, sizeof(iv_copy));
+  std::vector<u8> out(in.size());
+  mbedtls_aes_crypt_cbc(&ctx, MBEDTLS_AES_DECRYPT, in.size(), iv_copy, in.data(), out.data());
+  mbedtls_aes_free(&ctx);
+  return out;
+}
+}
+
+TEST(AES, KnownAnswer)
+{
+  Common::AES::CBCDecryptor decryptor(s_key);
+  u8 out[32];
+  decryptor.DecryptCBC(s_iv, s_ciphertext, out, sizeof(out));
+  EXPECT_EQ(0, std::memcmp(out, s_plaintext, sizeof(out)));
+}
+
+TEST(AES, MatchesMbedtls)
+{
+  std::mt19937 rng(0x5EED);
+  u8 key[16];
+  u8 iv[16];
+  for (u8& b : key)
+    b = static_cast<u8>(rng());
+  for (u8& b : iv)
+    b = static_cast<u8>(rng());
+
+  // Sizes around the eight block batches, and a Wii disc cluster.
+  for (size_t blocks : {1, 7, 8, 9, 17, 0x7C0})
+  {
+    SCOPED_TRACE(blocks);
+    std::vector<u8> in(blocks * 16);
+    for (u8& b : in)
+      b = static_cast<u8>(rng());
+    const std::vector<u8> expected = DecryptWithMbedtls(key, iv, in);
+
+    Common::AES::CBCDecryptor decryptor(key);
+    std::vector<u8> out(in.size());
+    decryptor.DecryptCBC(iv, in.data(), out.data(), in.size());
+    EXPECT_EQ(expected, out);
+
+    // In place
+    decryptor.DecryptCBC(iv, in.data(), in.data(), in.size());
+    EXPECT_EQ(expected, in);
+  }
+}
+
+TEST(AES, SetKeyReplacesKey)
+{
+  u8 other_key[16] = {};
+  Common::AES::CBCDecryptor decryptor(other_key);
+  decryptor.SetKey(s_key);
+  u8 out[32];
+  decryptor.DecryptCBC(s_iv, s_ciphertext, out, sizeof(out));
+  EXPECT_EQ(0, std::memcmp(out, s_plaintext, sizeof(out)));
+}
@@ -78,3 +78,27 @@ TEST(BlockingLoop, MultiThreaded)
     loop_thread.join();
   }
 }
+
+TEST(BlockingLoop, CountsWakeups)
+{
+  Common::BlockingLoop loop;
+  std::atomic<int> signaled(0);
+  std::atomic<int> received(0);
+
+  std::thread loop_thread([&]() { loop.Run([&]() { received.store(signaled.load()); }); });
+  loop.Prepare();
+  loop.Wait();
+
+  // Wait() allows the worker to sleep, so it gets there without any further Wakeup.
+  while (!loop.IsSleeping())
+    std::this_thread::yield();
+  const u64 wakeups = loop.GetWakeupCount();
+  signaled++;
+  loop.Wakeup();
+  loop.Wait();
+  EXPECT_EQ(signaled.load(), received.load());
+  EXPECT_EQ(wakeups + 1, loop.GetWakeupCount());
+
+  loop.Stop();
+  loop_thread.join();
+}
@@ -0,0 +1,91 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <gtest/gtest.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Common/ChunkFile.h"
+#include "Common/CommonTypes.h"
+
+namespace
+{
+struct State
+{
+  std::vector<u32> words;
+  std::vector<std::pair<u8, bool>> pairs;
+  std::string name;
+
+  void DoState(PointerWrap& p)
+  {
+    p.Do(words);
+    p.Do(pairs);
+    p.Do(name);
+  }
+};
+
+std::vector<u8> Save(State& state)
+{
+  u8* ptr = nullptr;
+  PointerWrap p(&ptr, PointerWrap::MODE_MEASURE);
+  state.DoState(p);
+  std::vector<u8> buffer(reinterpret_cast<size_t>(ptr));
+  ptr = buffer.data();
+  p.SetMode(PointerWrap::MODE_WRITE);
+  state.DoState(p);
+  return buffer;
+}
+}
+
+TEST(ChunkFile, ContainersKeepTheirFormat)
+{
+  State state;
+  state.words = {1, 2, 3};
+  state.pairs = {{4, true}, {5, false}};
+  state.name = "abc";
+  const std::vector<u8> buffer = Save(state);
+
+  // Each container is its u32 size and then every element as Do stores it, bools in a byte
+  const std::vector<u8> expected = {3, 0, 0, 0, 1, 0, 0, 0, 2, 0, 0, 0, 3, 0,   0,   0,
+                                    2, 0, 0, 0, 4, 1, 5, 0, 3, 0, 0, 0, 'a', 'b', 'c'};
+  EXPECT_EQ(expected, buffer);
+
+  State loaded;
+  u8* ptr = const_cast<u8*>(buffer.data());
+  PointerWrap p(&ptr, PointerWrap::MODE_READ);
+  loaded.DoState(p);
+  EXPECT_EQ(state.words, loaded.words);
+  EXPECT_EQ(state.pairs, loaded.pairs);
+  EXPECT_EQ(state.name, loaded.name);
+}
+
+TEST(ChunkFile, WriteLimitMeasuresTheRest)
+{
+  State state;
+  state.words.assign(100, 0x12345678);
+  state.name = "state";
+  const std::vector<u8> expected = Save(state);
+
+  std::vector<u8> buffer(16, 0xFF);
+  u8* ptr = buffer.data();
+  PointerWrap p(&ptr, PointerWrap::MODE_WRITE);
+  p.SetWriteLimit(buffer.data() + buffer.size());
+  state.DoState(p);
+  EXPECT_TRUE(p.IsWriteLimitReached());
+  EXPECT_EQ(PointerWrap::MODE_MEASURE, p.GetMode());
+  EXPECT_EQ(expected.size(), static_cast<size_t>(ptr - buffer.data()));
+  // Only what fit was written
+  EXPECT_TRUE(std::equal(buffer.begin(), buffer.begin() + 4, expected.begin()));
+  EXPECT_EQ(0xFF, buffer[4]);
+
+  buffer.resize(expected.size());
+  ptr = buffer.data();
+  PointerWrap retry(&ptr, PointerWrap::MODE_WRITE);
+  retry.SetWriteLimit(buffer.data() + buffer.size());
+  state.DoState(retry);
+  EXPECT_FALSE(retry.IsWriteLimitReached());
+  EXPECT_EQ(PointerWrap::MODE_WRITE, retry.GetMode());
+  EXPECT_EQ(expected, buffer);
+}
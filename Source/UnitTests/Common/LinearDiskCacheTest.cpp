@@ -0,0 +1,205 @@
+// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <fstream>
+#include <map>
+#include <string>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CommonPaths.h"
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Common/LinearDiskCache.h"
+
+namespace
+{
+typedef LinearDiskCache<u32, u8> Cache;
+
+class Collector : public LinearDiskCacheReader<u32, u8>
+{
+public:
+  void Read(const u32& key, const u8* value, u32 value_size) override
+  {
+    entries[key] = std::string(reinterpret_cast<const char*>(value), value_size);
+  }
+  std::map<u32, std::string> entries;
+};
+
+void Append(Cache& cache, u32 key, const std::string& value)
+{
+  cache.Append(key, reinterpret_cast<const u8*>(value.data()), static_cast<u32>(value.size()));
+}
+
+std::string FindValue(const Cache& cache, u32 key)
+{
+  u32 size = 0;
+  const u8* value = cache.Find(key, &size);
+  return value ? std::string(reinterpret_cast<const char*>(value), size) : "<missing>";
+}
+}
+
+TEST(LinearDiskCache, RoundTripWithIndex)
+{
+  std::string dir = File::CreateTempDir();
+  ASSERT_FALSE(dir.empty());
+  std::string path = dir + DIR_SEP "test.cache";
+  {
+    Cache cache;
+    EXPECT_EQ(0u, cache.Open(path));
+    Append(cache, 1, "one");
+    Append(cache, 2, "");
+    Append(cache, 3, "three");
+    cache.Close();
+  }
+  {
+    Cache cache;
+    EXPECT_EQ(3u, cache.Open(path));
+    EXPECT_EQ("one", FindValue(cache, 1));
+    EXPECT_EQ("", FindValue(cache, 2));
+    EXPECT_EQ("three", FindValue(cache, 3));
+    EXPECT_EQ("<missing>", FindValue(cache, 4));
+    Append(cache, 4, "four");
+    cache.Close();
+  }
+  {
+    Cache cache;
+    Collector collector;
+    EXPECT_EQ(4u, cache.OpenAndRead(path, collector));
+    EXPECT_EQ(4u, collector.entries.size());
+    EXPECT_EQ("four", collector.entries[4]);
+    cache.Close();
+  }
+  File::DeleteDirRecursively(dir);
+}
+
+TEST(LinearDiskCache, RecoversWithoutIndex)
+{
+  std::string dir = File::CreateTempDir();
+  ASSERT_FALSE(dir.empty());
+  std::string path = dir + DIR_SEP "test.cache";
+  {
+    Cache cache;
+    cache.Open(path);
+    Append(cache, 1, "one");
+    cache.Close();
+  }
+  {
+    // Destroyed without Close, like after a crash: the index isn't written.
+    Cache cache;
+    cache.Open(path);
+    Append(cache, 2, "two");
+    cache.Sync();
+  }
+  {
+    Cache cache;
+    EXPECT_EQ(2u, cache.Open(path));
+    EXPECT_EQ("one", FindValue(cache, 1));
+    EXPECT_EQ("two", FindValue(cache, 2));
+    cache.Close();
+  }
+  File::DeleteDirRecursively(dir);
+}
+
+TEST(LinearDiskCache, CompactsOverwrittenKeys)
+{
+  std::string dir = File::CreateTempDir();
+  ASSERT_FALSE(dir.empty());
+  std::string path = dir + DIR_SEP "test.cache";
+  {
+    Cache cache;
+    cache.Open(path);
+    for (u32 i = 0; i < 8; i++)
+      Append(cache, i % 2, std::string(1000, static_cast<char>('a' + i)));
+    cache.Close();
+  }
+  u64 size_before = File::GetSize(path);
+  {
+    Cache cache;
+    Collector collector;
+    EXPECT_EQ(2u, cache.OpenAndRead(path, collector));
+    EXPECT_EQ(std::string(1000, 'g'), collector.entries[0]);
+    EXPECT_EQ(std::string(1000, 'h'), collector.entries[1]);
+    cache.Close();
+  }
+  EXPECT_GT(size_before, File::GetSize(path) + 5000);
+  {
+    Cache cache;
+    EXPECT_EQ(2u, cache.Open(path));
+    EXPECT_EQ(std::string(1000, 'h'), FindValue(cache, 1));
+    cache.Close();
+  }
+  File::DeleteDirRecursively(dir);
+}
+
+TEST(LinearDiskCache, AppendsAfterAnotherInstanceCompacted)
+{
+  std::string dir = File::CreateTempDir();
+  ASSERT_FALSE(dir.empty());
+  std::string path = dir + DIR_SEP "test.cache";
+  {
+    Cache first;
+    Cache second;
+    first.Open(path);
+    second.Open(path);
+    for (u32 i = 0; i < 8; i++)
+      Append(first, i % 2, std::string(1000, static_cast<char>('a' + i)));
+    {
+      // Compacts the file on open while the others still have it open.
+      Cache compacting;
+      EXPECT_EQ(2u, compacting.Open(path));
+      compacting.Close();
+    }
+    Append(first, 2, "two");
+    Append(second, 3, "three");
+    first.Close();
+    second.Close();
+  }
+  {
+    Cache cache;
+    EXPECT_EQ(4u, cache.Open(path));
+    EXPECT_EQ(std::string(1000, 'g'), FindValue(cache, 0));
+    EXPECT_EQ(std::string(1000, 'h'), FindValue(cache, 1));
+    EXPECT_EQ("two", FindValue(cache, 2));
+    EXPECT_EQ("three", FindValue(cache, 3));
+    cache.Close();
+  }
+  File::DeleteDirRecursively(dir);
+}
+
+TEST(LinearDiskCache, ReplacesRejectedFile)
+{
+  std::string dir = File::CreateTempDir();
+  ASSERT_FALSE(dir.empty());
+  std::string path = dir + DIR_SEP "test.cache";
+  {
+    Cache mapping;
+    mapping.Open(path);
+    Append(mapping, 1, "one");
+    mapping.Close();
+    EXPECT_EQ(1u, mapping.Open(path));
+
+    // Rejected for its broken identity while the other instance still maps it
+    {
+      std::fstream file;
+      OpenFStream(file, path, std::ios_base::in | std::ios_base::out | std::ios_base::binary);
+      ASSERT_TRUE(file.is_open());
+      file.put('X');
+    }
+
+    Cache cache;
+    EXPECT_EQ(0u, cache.Open(path));
+    EXPECT_EQ("one", FindValue(mapping, 1));
+    Append(cache, 2, "two");
+    cache.Close();
+    mapping.Close();
+  }
+  {
+    Cache cache;
+    EXPECT_EQ(1u, cache.Open(path));
+    EXPECT_EQ("two", FindValue(cache, 2));
+    cache.Close();
+  }
+  File::DeleteDirRecursively(dir);
+}
@@ -0,0 +1,76 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <array>
+#include <gtest/gtest.h>
+#include <thread>
+
+#include "Common/CommonTypes.h"
+#include "Common/MPSCQueue.h"
+
+TEST(MPSCQueue, Simple)
+{
+  Common::MPSCQueue<u32> q;
+
+  u32 v;
+  EXPECT_TRUE(q.Empty());
+  EXPECT_FALSE(q.Pop(v));
+
+  q.Push(1);
+  EXPECT_FALSE(q.Empty());
+  EXPECT_TRUE(q.Pop(v));
+  EXPECT_EQ(1u, v);
+  EXPECT_TRUE(q.Empty());
+  EXPECT_FALSE(q.Pop(v));
+
+  // Test the FIFO order.
+  for (u32 i = 0; i < 1000; ++i)
+    q.Push(i);
+  for (u32 i = 0; i < 1000; ++i)
+  {
+    EXPECT_TRUE(q.Pop(v));
+    EXPECT_EQ(i, v);
+  }
+  EXPECT_TRUE(q.Empty());
+
+  for (u32 i = 0; i < 1000; ++i)
+    q.Push(i);
+  EXPECT_FALSE(q.Empty());
+  q.Clear();
+  EXPECT_TRUE(q.Empty());
+}
+
+TEST(MPSCQueue, MultiThreaded)
+{
+  static constexpr u32 THREADS = 4;
+  static constexpr u32 COUNT = 100000;
+  Common::MPSCQueue<u32> q;
+
+  auto inserter = [&q](u32 thread) {
+    for (u32 i = 0; i < COUNT; ++i)
+      q.Push(thread * COUNT + i);
+  };
+
+  std::array<std::thread, THREADS> inserter_threads;
+  for (u32 i = 0; i < THREADS; ++i)
+    inserter_threads[i] = std::thread(inserter, i);
+
+  // The elements of each writer must come out in the order they were pushed
+  std::array<u32, THREADS> next{};
+  for (u32 popped = 0; popped < THREADS * COUNT;)
+  {
+    u32 v;
+    if (!q.Pop(v))
+      continue;
+    const u32 thread = v / COUNT;
+    ASSERT_LT(thread, THREADS);
+    EXPECT_EQ(next[thread], v % COUNT);
+    next[thread] = v % COUNT + 1;
+    popped++;
+  }
+  EXPECT_TRUE(q.Empty());
+
+  for (std::thread& thread : inserter_threads)
+    thread.join();
+}
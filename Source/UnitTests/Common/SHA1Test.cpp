@@ -0,0 +1,74 @@
+// Copyright 2016 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <mbedtls/sha1.h>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CPUDetect.h"
+#include "Common/CommonTypes.h"
+#include "Common/Crypto/SHA1.h"
+
+namespace
+{
+class SHA1Test : public testing::TestWithParam<bool>
+{
+protected:
+  void SetUp() override
+  {
+    m_has_sha = cpu_info.bSHA;
+    cpu_info.bSHA = m_has_sha && GetParam();
+  }
+
+  void TearDown() override { cpu_info.bSHA = m_has_sha; }
+
+  bool m_has_sha;
+};
+
+Common::SHA1::Digest MbedtlsDigest(const std::vector<u8>& data)
+{
+  Common::SHA1::Digest digest;
+  mbedtls_sha1(data.data(), data.size(), digest.data());
+  return digest;
+}
+}
+
+INSTANTIATE_TEST_CASE_P(SHAExtensions, SHA1Test, testing::Bool());
+
+TEST_P(SHA1Test, KnownAnswer)
+{
+  const u8 abc[] = {'a', 'b', 'c'};
+  const Common::SHA1::Digest expected = {{0xa9, 0x99, 0x3e, 0x36, 0x47, 0x06, 0x81, 0x6a, 0xba, 0x3e,
+                                          0x25, 0x71, 0x78, 0x50, 0xc2, 0x6c, 0x9c, 0xd0, 0xd8, 0x9d}};
+  EXPECT_EQ(expected, Common::SHA1::CalculateDigest(abc, sizeof(abc)));
+}
+
+TEST_P(SHA1Test, MatchesMbedtls)
+{
+  std::mt19937 rng(0x5A1);
+  // Sizes around the block size and the padding boundary, and a Wii disc hash block.
+  for (size_t size : {0, 1, 55, 56, 63, 64, 65, 119, 120, 128, 0x400, 0x7C00})
+  {
+    SCOPED_TRACE(size);
+    std::vector<u8> data(size);
+    for (u8& b : data)
+      b = static_cast<u8>(rng());
+    const Common::SHA1::Digest expected = MbedtlsDigest(data);
+
+    EXPECT_EQ(expected, Common::SHA1::CalculateDigest(data.data(), data.size()));
+
+    // Uneven updates have to give the same result.
+    Common::SHA1::Context context;
+    size_t offset = 0;
+    while (offset < size)
+    {
+      const size_t chunk = std::min<size_t>(rng() % 100 + 1, size - offset);
+      context.Update(data.data() + offset, chunk);
+      offset += chunk;
+    }
+    EXPECT_EQ(expected, context.Finish());
+  }
+}
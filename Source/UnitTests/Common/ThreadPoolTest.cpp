@@ -0,0 +1,123 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/ThreadPool.h"
+
+TEST(ThreadPoolTest, ParallelLoopCoversRangeOnce)
+{
+  Common::ParallelLoop loop;
+  for (int size : {0, 1, 15, 16, 100, 1000, 4097})
+  {
+    std::vector<std::atomic<int>> hits(size);
+    for (auto& hit : hits)
+      hit = 0;
+
+    loop.Loop([&](int l, int u) {
+      for (int i = l; i < u; i++)
+        hits[i]++;
+    }, 0, size);
+
+    for (int i = 0; i < size; i++)
+      EXPECT_EQ(1, hits[i].load()) << "size " << size << " index " << i;
+  }
+}
+
+TEST(ThreadPoolTest, ParallelLoopHonoursBounds)
+{
+  Common::ParallelLoop loop;
+  std::atomic<int> sum(0);
+  std::atomic<bool> out_of_range(false);
+  loop.Loop([&](int l, int u) {
+    if (l < 10 || u > 500 || l >= u)
+      out_of_range = true;
+    for (int i = l; i < u; i++)
+      sum += i;
+  }, 10, 500, 4);
+
+  EXPECT_FALSE(out_of_range.load());
+  EXPECT_EQ((10 + 499) * 490 / 2, sum.load());
+}
+
+TEST(ThreadPoolTest, TaskGroupWaitsForAllTasks)
+{
+  std::atomic<int> count(0);
+  Common::TaskGroup group;
+  for (int i = 0; i < 1000; i++)
+    group.Run([&] { count++; }, static_cast<Common::TaskPriority>(i % 3));
+  group.Wait();
+  EXPECT_TRUE(group.IsDone());
+  EXPECT_EQ(1000, count.load());
+}
+
+TEST(ThreadPoolTest, NestedTaskGroupsDontDeadlock)
+{
+  // More waiting tasks than workers, they only finish if the waiting workers run the inner tasks
+  std::atomic<int> count(0);
+  Common::TaskGroup outer;
+  for (int i = 0; i < Common::ThreadPool::GetWorkerCount() * 2 + 1; i++)
+  {
+    outer.Run([&] {
+      Common::TaskGroup inner;
+      for (int j = 0; j < 16; j++)
+        inner.Run([&] { count++; });
+      inner.Wait();
+    });
+  }
+  outer.Wait();
+  EXPECT_EQ((Common::ThreadPool::GetWorkerCount() * 2 + 1) * 16, count.load());
+}
+
+TEST(ThreadPoolTest, ParallelLoopInsideTasks)
+{
+  std::atomic<int> sum(0);
+  Common::TaskGroup group;
+  for (int i = 0; i < 8; i++)
+  {
+    group.Run([&] {
+      Common::ParallelLoop loop;
+      loop.Loop([&](int l, int u) {
+        for (int k = l; k < u; k++)
+          sum += k;
+      }, 0, 1000);
+    });
+  }
+  group.Wait();
+  EXPECT_EQ(8 * (999 * 1000 / 2), sum.load());
+}
+
+TEST(ThreadPoolTest, TaskStoresSmallCallablesInline)
+{
+  std::shared_ptr<int> value = std::make_shared<int>(1);
+  auto small = [value] { (*value)++; };
+  EXPECT_TRUE(Common::Task::IsInline<decltype(small)>());
+  std::array<char, 256> large_data{};
+  auto large = [value, large_data] { (*value) += large_data[0] + 1; };
+  EXPECT_FALSE(Common::Task::IsInline<decltype(large)>());
+
+  Common::Task a(std::move(small));
+  Common::Task b(std::move(large));
+  EXPECT_EQ(3, value.use_count());
+
+  // Moving keeps the captures alive exactly once
+  Common::Task c(std::move(a));
+  Common::Task d;
+  d = std::move(b);
+  EXPECT_FALSE(static_cast<bool>(a));
+  EXPECT_FALSE(static_cast<bool>(b));
+  EXPECT_EQ(3, value.use_count());
+  c();
+  d();
+  EXPECT_EQ(3, *value);
+
+  c.Reset();
+  d.Reset();
+  EXPECT_EQ(1, value.use_count());
+}
@@ -0,0 +1,53 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/Trace.h"
+
+TEST(Trace, WritesChromeTrace)
+{
+  Trace::ThreadEvents thread;
+  thread.thread_id = 2;
+  thread.thread_name = "Video \"GPU\" thread";
+  thread.events.push_back({"VertexManagerBase::DoFlush", 1000, 25});
+  thread.events.push_back({"Fifo::RunGpuLoop", 990, 40});
+
+  const std::string json = Trace::ToJSON({thread});
+  EXPECT_NE(std::string::npos, json.find("\"traceEvents\": ["));
+  EXPECT_NE(std::string::npos,
+            json.find("{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 2, "
+                      "\"args\": {\"name\": \"Video \\\"GPU\\\" thread\"}}"));
+  EXPECT_NE(std::string::npos,
+            json.find("{\"name\": \"VertexManagerBase::DoFlush\", \"ph\": \"X\", \"pid\": 1, "
+                      "\"tid\": 2, \"ts\": 1000, \"dur\": 25}"));
+  EXPECT_NE(std::string::npos,
+            json.find("{\"name\": \"Fifo::RunGpuLoop\", \"ph\": \"X\", \"pid\": 1, \"tid\": 2, "
+                      "\"ts\": 990, \"dur\": 40}"));
+}
+
+TEST(Trace, WritesEmptyTrace)
+{
+  EXPECT_EQ("{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n]}\n", Trace::ToJSON({}));
+}
+
+#ifdef USE_TRACING
+TEST(Trace, RecordsZonesOfThisThread)
+{
+  {
+    TRACE_ZONE("TraceTest");
+  }
+
+  bool found = false;
+  for (const Trace::ThreadEvents& thread : Trace::GetEvents())
+  {
+    for (const Trace::Event& event : thread.events)
+      found |= std::string(event.name) == "TraceTest";
+  }
+  EXPECT_TRUE(found);
+}
+#endif
@@ -0,0 +1,95 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <array>
+#include <random>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Core/HW/DSPHLE/UCodes/AXMixer.h"
+
+namespace
+{
+// 96 samples per frame in AX Wii, plus a tail the SIMD loops don't cover
+constexpr u32 MAX_COUNT = 101;
+
+// Volumes and deltas around the edges of the 16 bit range
+constexpr std::array<u16, 6> VOLUMES{{0, 1, 0x7fff, 0x8000, 0xfffe, 0xffff}};
+constexpr std::array<u16, 5> DELTAS{{0, 1, 0x8000, 0xff00, 0xffff}};
+
+std::array<s16, MAX_COUNT> RandomSamples(std::mt19937& rng)
+{
+  std::array<s16, MAX_COUNT> samples;
+  for (s16& sample : samples)
+    sample = static_cast<s16>(rng());
+  // Include the extremes
+  samples[0] = -32768;
+  samples[1] = 32767;
+  return samples;
+}
+}
+
+TEST(AXMixer, ApplyVolumeMatchesGeneric)
+{
+  std::mt19937 rng(1234);
+  for (u16 volume : VOLUMES)
+  {
+    for (u16 delta : DELTAS)
+    {
+      for (u32 count : {0u, 7u, 8u, 32u, 96u, MAX_COUNT})
+      {
+        const std::array<s16, MAX_COUNT> input = RandomSamples(rng);
+        std::array<s16, MAX_COUNT> expected{}, actual{};
+
+        const u16 expected_volume =
+            AXMixer::ApplyVolumeGeneric(expected.data(), input.data(), count, volume, delta);
+        const u16 actual_volume =
+            AXMixer::ApplyVolume(actual.data(), input.data(), count, volume, delta);
+
+        EXPECT_EQ(expected_volume, actual_volume);
+        EXPECT_EQ(expected, actual) << "volume " << volume << " delta " << delta;
+      }
+    }
+  }
+}
+
+TEST(AXMixer, ApplyVolumeInPlace)
+{
+  std::mt19937 rng(42);
+  std::array<s16, MAX_COUNT> samples = RandomSamples(rng);
+  std::array<s16, MAX_COUNT> expected{};
+
+  AXMixer::ApplyVolumeGeneric(expected.data(), samples.data(), MAX_COUNT, 0x9000, 0x0100);
+  AXMixer::ApplyVolume(samples.data(), samples.data(), MAX_COUNT, 0x9000, 0x0100);
+  EXPECT_EQ(expected, samples);
+}
+
+TEST(AXMixer, MixAddMatchesGeneric)
+{
+  std::mt19937 rng(5678);
+  for (u16 volume : VOLUMES)
+  {
+    for (u16 delta : DELTAS)
+    {
+      for (u32 count : {0u, 7u, 8u, 32u, 96u, MAX_COUNT})
+      {
+        const std::array<s16, MAX_COUNT> input = RandomSamples(rng);
+        std::array<int, MAX_COUNT> expected, actual;
+        for (u32 i = 0; i < MAX_COUNT; ++i)
+          expected[i] = actual[i] = static_cast<int>(rng() % 0x100000) - 0x80000;
+        s16 expected_last = 123, actual_last = 123;
+
+        const u16 expected_volume = AXMixer::MixAddGeneric(expected.data(), input.data(), count,
+                                                           volume, delta, &expected_last);
+        const u16 actual_volume =
+            AXMixer::MixAdd(actual.data(), input.data(), count, volume, delta, &actual_last);
+
+        EXPECT_EQ(expected_volume, actual_volume);
+        EXPECT_EQ(expected_last, actual_last);
+        EXPECT_EQ(expected, actual) << "volume " << volume << " delta " << delta;
+      }
+    }
+  }
+}
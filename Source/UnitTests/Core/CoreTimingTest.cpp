@@ -124,6 +124,28 @@ TEST(CoreTiming, SharedSlot)
   EXPECT_EQ(0x1FULL, s_callbacks_ran_flags.to_ullong());
 }
 
+// Events further ahead than the timing wheel covers are queued separately
+TEST(CoreTiming, FarFuture)
+{
+  ScopeInit guard;
+
+  CoreTiming::EventType* cb_a = CoreTiming::RegisterEvent("callbackA", CallbackTemplate<0>);
+  CoreTiming::EventType* cb_b = CoreTiming::RegisterEvent("callbackB", CallbackTemplate<1>);
+  CoreTiming::EventType* cb_c = CoreTiming::RegisterEvent("callbackC", CallbackTemplate<2>);
+
+  // Enter slice 0
+  CoreTiming::Advance();
+
+  CoreTiming::ScheduleEvent(1000000, cb_a, CB_IDS[0]);
+  CoreTiming::ScheduleEvent(300000, cb_b, CB_IDS[1]);
+  CoreTiming::ScheduleEvent(100, cb_c, CB_IDS[2]);
+  EXPECT_EQ(100, PowerPC::ppcState.downcount);
+
+  AdvanceAndCheck(2, MAX_SLICE_LENGTH);
+  AdvanceAndCheck(1, MAX_SLICE_LENGTH, 0, -(300000 - 100 - MAX_SLICE_LENGTH));
+  AdvanceAndCheck(0, MAX_SLICE_LENGTH, 10, -(700000 + 10 - MAX_SLICE_LENGTH));
+}
+
 TEST(CoreTiming, PredictableLateness)
 {
   ScopeInit guard;
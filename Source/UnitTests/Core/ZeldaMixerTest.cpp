@@ -0,0 +1,145 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <array>
+#include <cstdint>
+#include <random>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Core/HW/DSPHLE/UCodes/ZeldaMixer.h"
+
+namespace
+{
+// 0x50 samples per frame, plus the 8 filter history samples and a tail the SIMD loops don't
+// cover
+constexpr size_t MAX_COUNT = 0x5b;
+constexpr size_t COUNTS[] = {0, 7, 8, 0x28, 0x50, MAX_COUNT - 8};
+
+using Samples = std::array<s16, MAX_COUNT>;
+
+Samples RandomSamples(std::mt19937& rng)
+{
+  Samples samples;
+  for (s16& sample : samples)
+    sample = static_cast<s16>(rng());
+  // Include the extremes
+  samples[0] = -32768;
+  samples[1] = 32767;
+  samples[2] = -32768;
+  return samples;
+}
+}
+
+TEST(ZeldaMixer, ApplyVolumeInPlaceMatchesGeneric)
+{
+  std::mt19937 rng(1234);
+  for (int int_bits : {1, 4})
+  {
+    for (u16 vol : {0x0000, 0x0001, 0x6784, 0x7fff, 0x8000, 0xffff})
+    {
+      for (size_t count : COUNTS)
+      {
+        Samples expected = RandomSamples(rng);
+        Samples actual = expected;
+
+        ZeldaMixer::ApplyVolumeInPlaceGeneric(expected.data(), count, vol, int_bits);
+        ZeldaMixer::ApplyVolumeInPlace(actual.data(), count, vol, int_bits);
+        EXPECT_EQ(expected, actual) << "vol " << vol << " bits " << int_bits;
+      }
+    }
+  }
+}
+
+TEST(ZeldaMixer, AddBuffersWithVolumeRampMatchesGeneric)
+{
+  std::mt19937 rng(5678);
+  for (s32 vol : {0, 0x10000, 0x7fff0000, INT32_MIN, -0x10000})
+  {
+    for (s32 step : {0, 1, -1, 0x00666666, -0x01000000})
+    {
+      for (size_t count : COUNTS)
+      {
+        const Samples src = RandomSamples(rng);
+        Samples expected = RandomSamples(rng);
+        Samples actual = expected;
+
+        const s32 expected_vol = ZeldaMixer::AddBuffersWithVolumeRampGeneric(
+            expected.data(), src.data(), count, vol, step);
+        const s32 actual_vol =
+            ZeldaMixer::AddBuffersWithVolumeRamp(actual.data(), src.data(), count, vol, step);
+        EXPECT_EQ(expected_vol, actual_vol);
+        EXPECT_EQ(expected, actual) << "vol " << vol << " step " << step;
+      }
+    }
+  }
+}
+
+TEST(ZeldaMixer, AddBuffersWithVolumeMatchesGeneric)
+{
+  std::mt19937 rng(42);
+  for (u16 vol : {0x0000, 0x0001, 0x4000, 0x7fff, 0x8000, 0xffff})
+  {
+    for (size_t count : COUNTS)
+    {
+      const Samples src = RandomSamples(rng);
+      Samples expected = RandomSamples(rng);
+      Samples actual = expected;
+
+      ZeldaMixer::AddBuffersWithVolumeGeneric(expected.data(), src.data(), count, vol);
+      ZeldaMixer::AddBuffersWithVolume(actual.data(), src.data(), count, vol);
+      EXPECT_EQ(expected, actual) << "vol " << vol;
+    }
+  }
+}
+
+TEST(ZeldaMixer, ApplyFilterMatchesGeneric)
+{
+  std::mt19937 rng(9012);
+  for (int round = 0; round < 16; ++round)
+  {
+    std::array<s16, 8> coeffs;
+    for (s16& coeff : coeffs)
+      coeff = static_cast<s16>(rng());
+    // Full scale taps on full scale input push the sums past 32 bits
+    if (round == 0)
+      coeffs.fill(-32768);
+
+    for (size_t count : COUNTS)
+    {
+      Samples expected = RandomSamples(rng);
+      if (round == 0)
+        expected.fill(-32768);
+      Samples actual = expected;
+
+      ZeldaMixer::ApplyFilterGeneric(expected.data(), count, coeffs.data());
+      ZeldaMixer::ApplyFilter(actual.data(), count, coeffs.data());
+      EXPECT_EQ(expected, actual) << "round " << round;
+    }
+  }
+}
+
+// Golden output of one frame through the whole chain, so that both versions stay pinned to
+// what the renderer produced before they were vectorized.
+TEST(ZeldaMixer, GoldenFrame)
+{
+  std::array<s16, 0x58> input;
+  for (size_t i = 0; i < input.size(); ++i)
+    input[i] = static_cast<s16>((i * 0x1357 + 0x2468) ^ (i << 11));
+  const s16 coeffs[8] = {0x0800, -0x0400, 0x1000, 0x2000, -0x3000, 0x0100, 0x7fff, -0x8000};
+
+  std::array<s16, 0x50> mix{};
+  ZeldaMixer::ApplyFilter(input.data(), 0x50, coeffs);
+  ZeldaMixer::AddBuffersWithVolume(mix.data(), input.data(), 0x50, 0x5a82);
+  const s32 vol = ZeldaMixer::AddBuffersWithVolumeRamp(mix.data(), input.data() + 4, 0x50,
+                                                       0x40000000, -0x00cccccc);
+  ZeldaMixer::ApplyVolumeInPlace(mix.data(), 0x50, 0x1800, 4);
+
+  u32 hash = 0;
+  for (s16 sample : mix)
+    hash = hash * 31 + static_cast<u16>(sample);
+  EXPECT_EQ(0x40, vol);
+  EXPECT_EQ(0x5bb9d44cu, hash);
+}
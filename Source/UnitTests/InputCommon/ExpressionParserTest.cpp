@@ -0,0 +1,147 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+
+#include "Core/ConfigManager.h"
+#include "InputCommon/ControllerInterface/Device.h"
+#include "InputCommon/ControllerInterface/ExpressionParser.h"
+
+using namespace ciface::Core;
+using namespace ciface::ExpressionParser;
+
+namespace
+{
+class TestInput final : public Device::Input
+{
+public:
+  explicit TestInput(const std::string& name) : m_name(name) {}
+  std::string GetName() const override { return m_name; }
+  ControlState GetState() const override { return state; }
+  ControlState state = 0.0;
+
+private:
+  std::string m_name;
+};
+
+class TestDevice final : public Device
+{
+public:
+  TestDevice()
+  {
+    for (TestInput*& input : inputs)
+    {
+      input = new TestInput(std::string(1, static_cast<char>('A' + (&input - inputs))));
+      AddInput(input);
+    }
+  }
+  std::string GetName() const override { return "Test"; }
+  std::string GetSource() const override { return "Test"; }
+  TestInput* inputs[3];
+};
+
+class TestContainer final : public DeviceContainer
+{
+public:
+  void Add(std::shared_ptr<Device> device) { m_devices.emplace_back(std::move(device)); }
+};
+
+class ExpressionParserTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    SConfig::Init();
+    // Reading the inputs otherwise depends on the focus of the windows
+    SConfig::GetInstance().m_BackgroundInput = true;
+
+    m_device = std::make_shared<TestDevice>();
+    m_device->SetId(0);
+    m_container.Add(m_device);
+    m_qualifier.FromDevice(m_device.get());
+  }
+  void TearDown() override { SConfig::Shutdown(); }
+  std::unique_ptr<Expression> Parse(const std::string& text)
+  {
+    ControlFinder finder(m_container, m_qualifier, true);
+    Expression* expression = nullptr;
+    ParseExpression(text, finder, &expression);
+    return std::unique_ptr<Expression>(expression);
+  }
+
+  void SetStates(ControlState a, ControlState b, ControlState c)
+  {
+    m_device->inputs[0]->state = a;
+    m_device->inputs[1]->state = b;
+    m_device->inputs[2]->state = c;
+  }
+
+  std::shared_ptr<TestDevice> m_device;
+  TestContainer m_container;
+  DeviceQualifier m_qualifier;
+};
+}
+
+TEST_F(ExpressionParserTest, SingleInput)
+{
+  auto expression = Parse("B");
+  ASSERT_NE(nullptr, expression);
+  EXPECT_EQ(1u, expression->ops.size());
+
+  SetStates(0.0, 0.25, 0.0);
+  EXPECT_EQ(0.25, expression->GetValue());
+}
+
+TEST_F(ExpressionParserTest, Operators)
+{
+  // Binary operators have no precedence, they apply from left to right
+  auto expression = Parse("(A & !B) | (C + A) & !(A | B)");
+  ASSERT_NE(nullptr, expression);
+
+  const ControlState values[] = {0.0, 0.3, 0.5, 1.0};
+  for (ControlState a : values)
+  {
+    for (ControlState b : values)
+    {
+      for (ControlState c : values)
+      {
+        SetStates(a, b, c);
+        const ControlState expected =
+            std::min(std::max(std::min(a, 1.0 - b), std::min(c + a, 1.0)), 1.0 - std::max(a, b));
+        EXPECT_EQ(expected, expression->GetValue());
+      }
+    }
+  }
+}
+
+TEST_F(ExpressionParserTest, FoldsMissingControls)
+{
+  // `Missing` reads as 0, so !`Missing` is the constant 1
+  auto expression = Parse("!`Missing` & A");
+  ASSERT_NE(nullptr, expression);
+  ASSERT_EQ(3u, expression->ops.size());
+  EXPECT_EQ(ExpressionOp::OP_CONSTANT, expression->ops[0].type);
+  EXPECT_EQ(1.0, expression->ops[0].value);
+
+  SetStates(0.5, 0.0, 0.0);
+  EXPECT_EQ(0.5, expression->GetValue());
+}
+
+TEST_F(ExpressionParserTest, DeepNesting)
+{
+  // Deeper than the stack of the compiled form, which leaves it to the tree
+  std::string text = "A";
+  for (int i = 0; i < 20; i++)
+    text = "B & (" + text + ")";
+  text = "C | " + text;
+  auto expression = Parse(text);
+  ASSERT_NE(nullptr, expression);
+
+  SetStates(0.75, 0.5, 0.25);
+  EXPECT_EQ(0.5, expression->GetValue());
+}
@@ -0,0 +1,65 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace Benchmark
+{
+// Every sample repeats the call for at least this long, so the timer resolution doesn't matter.
+const double MIN_SAMPLE_MS = 20.0;
+// The median of the samples is reported, which ignores the ones the OS got in the way of.
+const int NUM_SAMPLES = 11;
+
+inline void PrintHeader()
+{
+  printf("%-48s %12s %12s %16s\n", "benchmark", "median us", "min us", "throughput");
+}
+
+// Times func and prints one line: the median and fastest time per call, and how much of the
+// work (bytes, vertices...) was done per second. unit names the work, e.g. "B" prints MB/s.
+template <typename Func>
+void Run(const std::string& name, double work, const char* unit, Func&& func)
+{
+  using Clock = std::chrono::steady_clock;
+  auto elapsed_ms = [](Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+  };
+
+  // Warm up the caches and find how many calls fill a sample
+  int iterations = 1;
+  while (true)
+  {
+    const Clock::time_point start = Clock::now();
+    for (int i = 0; i < iterations; i++)
+      func();
+    const double ms = elapsed_ms(start);
+    if (ms >= MIN_SAMPLE_MS)
+      break;
+    iterations = ms > 0.0 ? std::max(iterations + 1, static_cast<int>(
+                                                         iterations * MIN_SAMPLE_MS * 1.2 / ms)) :
+                            iterations * 10;
+  }
+
+  std::vector<double> samples(NUM_SAMPLES);
+  for (double& sample : samples)
+  {
+    const Clock::time_point start = Clock::now();
+    for (int i = 0; i < iterations; i++)
+      func();
+    sample = elapsed_ms(start) * 1000.0 / iterations;
+  }
+  std::sort(samples.begin(), samples.end());
+  const double median_us = samples[NUM_SAMPLES / 2];
+
+  printf("%-48s %12.3f %12.3f %12.1f M%s/s\n", name.c_str(), median_us, samples[0],
+         work / median_us, unit);
+  fflush(stdout);
+}
+}
@@ -0,0 +1,134 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <vector>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CommonTypes.h"
+#include "VideoBackends/Software/EfbInterface.h"
+#include "VideoBackends/Software/NativeVertexFormat.h"
+#include "VideoBackends/Software/Rasterizer.h"
+#include "VideoCommon/BPMemory.h"
+#include "VideoCommon/VideoCommon.h"
+#include "VideoCommon/VideoConfig.h"
+
+namespace
+{
+// A single tev stage passing the rasterized color through, written to an RGB8 EFB
+void SetUpPassThrough()
+{
+  std::memset(&bpmem, 0, sizeof(bpmem));
+  bpmem.genMode.numcolchans = 1;
+  bpmem.combiners[0].colorC.a = TEVCOLORARG_ZERO;
+  bpmem.combiners[0].colorC.b = TEVCOLORARG_ZERO;
+  bpmem.combiners[0].colorC.c = TEVCOLORARG_ZERO;
+  bpmem.combiners[0].colorC.d = TEVCOLORARG_RASC;
+  bpmem.combiners[0].colorC.clamp = 1;
+  bpmem.combiners[0].alphaC.a = TEVALPHAARG_ZERO;
+  bpmem.combiners[0].alphaC.b = TEVALPHAARG_ZERO;
+  bpmem.combiners[0].alphaC.c = TEVALPHAARG_ZERO;
+  bpmem.combiners[0].alphaC.d = TEVALPHAARG_RASA;
+  bpmem.combiners[0].alphaC.clamp = 1;
+  bpmem.alpha_test.comp0 = AlphaTest::ALWAYS;
+  bpmem.alpha_test.comp1 = AlphaTest::ALWAYS;
+  bpmem.zcontrol.pixel_format = PEControl::RGB8_Z24;
+  bpmem.blendmode.colorupdate = 1;
+
+  // Scissor covering the whole EFB, the offset is stored halved and biased by 342 like the corners
+  bpmem.scissorOffset.x = 171;
+  bpmem.scissorOffset.y = 171;
+  bpmem.scissorTL.x = 342;
+  bpmem.scissorTL.y = 342;
+  bpmem.scissorBR.x = 341 + EFB_WIDTH;
+  bpmem.scissorBR.y = 341 + EFB_HEIGHT;
+
+  g_ActiveConfig.bZComploc = true;
+  g_ActiveConfig.bZFreeze = true;
+  g_ActiveConfig.bDumpTevStages = false;
+  g_ActiveConfig.bDumpTevTextureFetches = false;
+}
+
+OutputVertexData MakeVertex(float x, float y, u8 shade)
+{
+  OutputVertexData vertex;
+  vertex.projectedPosition.w = 1.0f;
+  vertex.screenPosition.x = x;
+  vertex.screenPosition.y = y;
+  for (u8& component : vertex.color[0])
+    component = shade;
+  vertex.color[0][0] = static_cast<u8>(255 - shade);
+  return vertex;
+}
+
+std::vector<u32> ReadColors()
+{
+  std::vector<u32> colors(EFB_WIDTH * EFB_HEIGHT);
+  for (u16 y = 0; y < EFB_HEIGHT; y++)
+  {
+    for (u16 x = 0; x < EFB_WIDTH; x++)
+      EfbInterface::GetColor(x, y, reinterpret_cast<u8*>(&colors[x + y * EFB_WIDTH]));
+  }
+  return colors;
+}
+
+// Draws layers of triangles whose gradients change on every pixel across the EFB, over a cleared
+// EFB with a different pattern, and returns the colors of all pixels.
+std::vector<u32> Render(int threads, int round)
+{
+  g_ActiveConfig.iSWRasterizerThreads = threads;
+  Rasterizer::Init();
+  Rasterizer::SetTevStages();
+  Rasterizer::SetScissor();
+
+  for (u16 y = 0; y < EFB_HEIGHT; y++)
+  {
+    for (u16 x = 0; x < EFB_WIDTH; x++)
+    {
+      u32 clear = 0xff000000 | (x * 7 + y * 13 + round) * 0x010101;
+      EfbInterface::SetColor(x, y, reinterpret_cast<u8*>(&clear));
+    }
+  }
+  const std::vector<u32> cleared = ReadColors();
+
+  // Every layer overwrites the previous one, so each seam pixel is written many times while the
+  // neighbouring tiles are being drawn.
+  const float right = static_cast<float>(EFB_WIDTH);
+  const float bottom = static_cast<float>(EFB_HEIGHT);
+  for (int layer = 0; layer < 8; layer++)
+  {
+    const u8 shade = static_cast<u8>(round * 37 + layer * 11);
+    OutputVertexData top_left = MakeVertex(0.0f, 0.0f, shade);
+    OutputVertexData top_right = MakeVertex(right, 0.0f, static_cast<u8>(shade + 255));
+    OutputVertexData bottom_left = MakeVertex(0.0f, bottom, static_cast<u8>(shade + 128));
+    OutputVertexData bottom_right = MakeVertex(right, bottom, static_cast<u8>(shade + 64));
+    Rasterizer::DrawTriangleFrontFace(&top_left, &bottom_left, &top_right);
+    Rasterizer::DrawTriangleFrontFace(&top_right, &bottom_left, &bottom_right);
+  }
+  Rasterizer::Flush();
+
+  const std::vector<u32> colors = ReadColors();
+  EXPECT_NE(cleared, colors) << "nothing was drawn";
+
+  Rasterizer::Shutdown();
+  return colors;
+}
+}
+
+// The tiles next to each other are drawn by different threads, including the pixels at their
+// shared edges, which must come out as if one thread drew them all.
+TEST(SWRasterizer, TilesMatchSingleThread)
+{
+  SetUpPassThrough();
+  for (int round = 0; round < 4; round++)
+  {
+    const std::vector<u32> expected = Render(1, round);
+    const std::vector<u32> colors = Render(8, round);
+    for (u32 i = 0; i < colors.size(); i++)
+    {
+      ASSERT_EQ(expected[i], colors[i]) << "at " << i % EFB_WIDTH << ", " << i / EFB_WIDTH;
+    }
+  }
+}
@@ -0,0 +1,95 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <vector>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CommonTypes.h"
+#include "VideoCommon/ImageLoader.h"
+
+namespace
+{
+const u32 DDS_HEADER_SIZE = 128;
+const u32 DX10_HEADER_SIZE = 20;
+
+void Write32(std::vector<u8>* file, size_t offset, u32 value)
+{
+  std::memcpy(file->data() + offset, &value, sizeof(value));
+}
+
+// A 16x16 texture with two mip levels of 16 byte blocks
+std::vector<u8> MakeDDS(const char* fourcc, u32 dxgi_format)
+{
+  const bool dx10 = dxgi_format != 0;
+  const u32 data_offset = DDS_HEADER_SIZE + (dx10 ? DX10_HEADER_SIZE : 0);
+  std::vector<u8> file(data_offset + (16 + 4 + 1) * 16);
+  std::memcpy(file.data(), "DDS ", 4);
+  Write32(&file, 4, 124);
+  // DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT
+  Write32(&file, 8, 0x00021007);
+  Write32(&file, 12, 16);
+  Write32(&file, 16, 16);
+  Write32(&file, 28, 3);
+  Write32(&file, 76, 32);
+  // DDPF_FOURCC
+  Write32(&file, 80, 4);
+  std::memcpy(file.data() + 84, fourcc, 4);
+  if (dx10)
+  {
+    Write32(&file, DDS_HEADER_SIZE, dxgi_format);
+    // D3D10_RESOURCE_DIMENSION_TEXTURE2D
+    Write32(&file, DDS_HEADER_SIZE + 4, 3);
+    Write32(&file, DDS_HEADER_SIZE + 12, 1);
+  }
+  for (size_t i = data_offset; i < file.size(); i++)
+    file[i] = static_cast<u8>(i);
+  return file;
+}
+
+DDSCompression Read(const std::vector<u8>& file, ImageLoaderParams* params,
+                    std::vector<u8>* buffer)
+{
+  params->src_data = file.data();
+  params->src_size = file.size();
+  params->request_buffer_delegate = [buffer](size_t size, bool) {
+    buffer->resize(size);
+    return buffer->data();
+  };
+  return ImageLoader::ReadDDS(*params);
+}
+}
+
+TEST(DDSLoader, ReadsBC7FromDX10Header)
+{
+  std::vector<u8> file = MakeDDS("DX10", 98);
+  ImageLoaderParams params;
+  std::vector<u8> buffer;
+  ASSERT_EQ(DDSC_BC7, Read(file, &params, &buffer));
+  EXPECT_EQ(16u, params.Width);
+  EXPECT_EQ(16u, params.Height);
+  EXPECT_EQ(2u, params.nummipmaps);
+  const size_t data_offset = DDS_HEADER_SIZE + DX10_HEADER_SIZE;
+  ASSERT_GE(buffer.size(), file.size() - data_offset);
+  EXPECT_EQ(0, std::memcmp(buffer.data(), file.data() + data_offset, file.size() - data_offset));
+}
+
+TEST(DDSLoader, ReadsBC5FromFourCC)
+{
+  std::vector<u8> file = MakeDDS("ATI2", 0);
+  ImageLoaderParams params;
+  std::vector<u8> buffer;
+  ASSERT_EQ(DDSC_BC5, Read(file, &params, &buffer));
+  EXPECT_EQ(0, std::memcmp(buffer.data(), file.data() + DDS_HEADER_SIZE, 16));
+}
+
+TEST(DDSLoader, RejectsUnknownDX10Format)
+{
+  // DXGI_FORMAT_BC6H_UF16
+  std::vector<u8> file = MakeDDS("DX10", 95);
+  ImageLoaderParams params;
+  std::vector<u8> buffer;
+  EXPECT_EQ(DDSC_NONE, Read(file, &params, &buffer));
+}
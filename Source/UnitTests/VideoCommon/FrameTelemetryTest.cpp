@@ -0,0 +1,82 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "VideoCommon/FrameTelemetry.h"
+
+static std::vector<FrameTelemetry::Sample> MakeSamples(size_t count, u64 interval_us)
+{
+  std::vector<FrameTelemetry::Sample> samples(count);
+  for (FrameTelemetry::Sample& sample : samples)
+  {
+    sample = {};
+    sample.present_interval_us = interval_us;
+    sample.cpu_time_us = interval_us / 2;
+  }
+  return samples;
+}
+
+TEST(FrameTelemetry, SummarizesLows)
+{
+  // 988 frames at 60 fps, 10 at 30 fps and two at 10 fps
+  std::vector<FrameTelemetry::Sample> samples = MakeSamples(1000, 16667);
+  for (size_t i = 0; i < 10; i++)
+    samples[i * 100].present_interval_us = 33333;
+  samples[50].present_interval_us = 100000;
+  samples[550].present_interval_us = 100000;
+
+  FrameTelemetry::Summary summary = FrameTelemetry::Summarize(samples);
+  EXPECT_EQ(1000u, summary.frames);
+  EXPECT_DOUBLE_EQ(16.667, summary.present_interval.median_ms);
+  EXPECT_DOUBLE_EQ(33.333, summary.present_interval.p99_ms);
+  EXPECT_DOUBLE_EQ(100.0, summary.present_interval.p999_ms);
+  EXPECT_DOUBLE_EQ(100.0, summary.present_interval.max_ms);
+  EXPECT_NEAR(30.0, summary.low_1_fps, 0.01);
+  EXPECT_NEAR(10.0, summary.low_01_fps, 0.01);
+  EXPECT_NEAR(17.0, summary.present_interval.average_ms, 0.001);
+  EXPECT_DOUBLE_EQ(8.333, summary.cpu_time.median_ms);
+}
+
+TEST(FrameTelemetry, EmptySummary)
+{
+  FrameTelemetry::Summary summary = FrameTelemetry::Summarize({});
+  EXPECT_EQ(0u, summary.frames);
+  EXPECT_EQ(0.0, summary.average_fps);
+  EXPECT_EQ(0.0, summary.low_1_fps);
+}
+
+TEST(FrameTelemetry, ExportsOneRowPerFrame)
+{
+  std::vector<FrameTelemetry::Sample> samples = MakeSamples(3, 20000);
+  samples[1].draw_calls = 42;
+  std::string csv = FrameTelemetry::ToCSV(samples);
+  EXPECT_EQ(0u, csv.find("frame,present_interval_us,"));
+  EXPECT_NE(std::string::npos, csv.find("\n1,20000,10000,0,42,0,0,0,0,0,0,0,0\n"));
+  EXPECT_EQ(4, std::count(csv.begin(), csv.end(), '\n'));
+
+  std::string json = FrameTelemetry::ToJSON(samples, FrameTelemetry::Summarize(samples));
+  EXPECT_NE(std::string::npos, json.find("\"frames\": 3,"));
+  EXPECT_NE(std::string::npos, json.find("\"average_fps\": 50.000,"));
+  EXPECT_NE(std::string::npos, json.find("[20000, 10000, 0, 42, 0, 0, 0, 0, 0, 0, 0, 0]"));
+}
+
+TEST(FrameTelemetry, ExportsBootSteps)
+{
+  std::vector<FrameTelemetry::Sample> samples = MakeSamples(1, 16000);
+  std::vector<FrameTelemetry::BootStep> steps = {{"video_backend", 1000, 250000},
+                                                 {"controllers", 1000, 40500}};
+  std::string json = FrameTelemetry::ToJSON(samples, FrameTelemetry::Summarize(samples), steps);
+  EXPECT_NE(std::string::npos,
+            json.find("\"video_backend\": {\"start\": 1.000, \"duration\": 250.000},"));
+  EXPECT_NE(std::string::npos,
+            json.find("\"controllers\": {\"start\": 1.000, \"duration\": 40.500}\n  },"));
+
+  json = FrameTelemetry::ToJSON(samples, FrameTelemetry::Summarize(samples));
+  EXPECT_EQ(std::string::npos, json.find("boot_ms"));
+}
@@ -0,0 +1,223 @@
+// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <tuple>
+#include <vector>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CommonTypes.h"
+#include "VideoCommon/IndexGenerator.h"
+#include "VideoCommon/OpcodeDecoding.h"
+#include "VideoCommon/VideoConfig.h"
+
+using Triangle = std::array<u32, 3>;
+
+// Rotates the triangle so the smallest index comes first, keeping the winding.
+static Triangle Normalize(Triangle t)
+{
+  std::rotate(t.begin(), std::min_element(t.begin(), t.end()), t.end());
+  return t;
+}
+
+// The triangles GX draws for the primitive, in order.
+static std::vector<Triangle> ExpectedTriangles(int primitive, u32 base, u32 count)
+{
+  std::vector<Triangle> out;
+  switch (primitive)
+  {
+  case GX_DRAW_QUADS:
+    for (u32 i = 3; i < count; i += 4)
+    {
+      out.push_back({{(base + i - 3), (base + i - 2), (base + i - 1)}});
+      out.push_back({{(base + i - 3), (base + i - 1), (base + i)}});
+    }
+    if (count % 4 == 3)
+      out.push_back({{(base + count - 3), (base + count - 2), (base + count - 1)}});
+    break;
+  case GX_DRAW_TRIANGLES:
+    for (u32 i = 2; i < count; i += 3)
+      out.push_back({{(base + i - 2), (base + i - 1), (base + i)}});
+    break;
+  case GX_DRAW_TRIANGLE_STRIP:
+    for (u32 i = 2; i < count; i++)
+    {
+      if (i & 1)
+        out.push_back({{(base + i - 2), (base + i), (base + i - 1)}});
+      else
+        out.push_back({{(base + i - 2), (base + i - 1), (base + i)}});
+    }
+    break;
+  case GX_DRAW_TRIANGLE_FAN:
+    for (u32 i = 2; i < count; i++)
+      out.push_back({{base, (base + i - 1), (base + i)}});
+    break;
+  }
+  return out;
+}
+
+// Decodes triangle lists or strips cut by restart indices.
+template <typename T>
+static std::vector<Triangle> DecodeTriangles(const T* indices, u32 len, bool strips)
+{
+  std::vector<Triangle> out;
+  if (!strips)
+  {
+    for (u32 i = 0; i + 2 < len; i += 3)
+      out.push_back({{indices[i], indices[i + 1], indices[i + 2]}});
+    return out;
+  }
+  u32 start = 0;
+  for (u32 i = 0; i <= len; i++)
+  {
+    if (i < len && indices[i] != IndexGenerator::GetPrimitiveRestartIndex())
+      continue;
+    for (u32 j = start; j + 2 < i; j++)
+    {
+      if ((j - start) & 1)
+        out.push_back({{indices[j + 1], indices[j], indices[j + 2]}});
+      else
+        out.push_back({{indices[j], indices[j + 1], indices[j + 2]}});
+    }
+    start = i + 1;
+  }
+  return out;
+}
+
+// Parameters: primitive restart, 32 bit indices
+class IndexGeneratorTest : public testing::TestWithParam<std::tuple<bool, bool>>
+{
+protected:
+  void SetUp() override
+  {
+    m_restart = g_ActiveConfig.backend_info.bSupportsPrimitiveRestart;
+    m_32bit = g_ActiveConfig.backend_info.bSupports32BitIndices;
+    g_ActiveConfig.backend_info.bSupportsPrimitiveRestart = UsesRestart();
+    g_ActiveConfig.backend_info.bSupports32BitIndices = Uses32Bit();
+    IndexGenerator::Init();
+    m_buffer.assign(4096, 0);
+  }
+
+  void TearDown() override
+  {
+    g_ActiveConfig.backend_info.bSupportsPrimitiveRestart = m_restart;
+    g_ActiveConfig.backend_info.bSupports32BitIndices = m_32bit;
+    IndexGenerator::Init();
+  }
+
+  bool UsesRestart() const { return std::get<0>(GetParam()); }
+  bool Uses32Bit() const { return std::get<1>(GetParam()); }
+
+  std::vector<Triangle> Decode() const
+  {
+    const u32 len = IndexGenerator::GetIndexLen();
+    if (Uses32Bit())
+      return DecodeTriangles(m_buffer.data(), len, UsesRestart());
+    return DecodeTriangles(reinterpret_cast<const u16*>(m_buffer.data()), len, UsesRestart());
+  }
+
+  bool m_restart;
+  bool m_32bit;
+  // Big enough for either index size
+  std::vector<u32> m_buffer;
+};
+
+INSTANTIATE_TEST_CASE_P(PrimitiveRestart, IndexGeneratorTest,
+                        testing::Combine(testing::Bool(), testing::Bool()));
+
+TEST_P(IndexGeneratorTest, Triangles)
+{
+  EXPECT_EQ(UsesRestart(), IndexGenerator::UsesPrimitiveRestart());
+  EXPECT_EQ(Uses32Bit(), IndexGenerator::Uses32BitIndices());
+  for (int primitive : {GX_DRAW_QUADS, GX_DRAW_TRIANGLES, GX_DRAW_TRIANGLE_STRIP,
+                        GX_DRAW_TRIANGLE_FAN})
+  {
+    for (u32 count = 0; count < 100; count++)
+    {
+      // A leading draw checks that the indices follow the base index.
+      IndexGenerator::Start(m_buffer.data());
+      IndexGenerator::AddIndices(GX_DRAW_TRIANGLES, 3);
+      IndexGenerator::AddIndices(primitive, count);
+
+      std::vector<Triangle> expected = ExpectedTriangles(GX_DRAW_TRIANGLES, 0, 3);
+      for (const Triangle& t : ExpectedTriangles(primitive, 3, count))
+        expected.push_back(t);
+      std::vector<Triangle> actual = Decode();
+      ASSERT_EQ(expected.size(), actual.size()) << primitive << " " << count;
+      for (size_t i = 0; i < expected.size(); i++)
+        EXPECT_EQ(Normalize(expected[i]), Normalize(actual[i])) << primitive << " " << count;
+      EXPECT_EQ(3 + count, IndexGenerator::GetNumVerts());
+    }
+  }
+}
+
+TEST_P(IndexGeneratorTest, LinesAndPoints)
+{
+  for (u32 count = 0; count < 100; count++)
+  {
+    IndexGenerator::Start(m_buffer.data());
+    IndexGenerator::AddIndices(GX_DRAW_LINES, count);
+    ASSERT_EQ(count / 2 * 2, IndexGenerator::GetIndexLen());
+    for (u32 i = 0; i < count / 2 * 2; i++)
+      EXPECT_EQ(i, IndexGenerator::GetIndex(i));
+
+    IndexGenerator::Start(m_buffer.data());
+    IndexGenerator::AddIndices(GX_DRAW_LINE_STRIP, count);
+    ASSERT_EQ(count > 0 ? (count - 1) * 2 : 0, IndexGenerator::GetIndexLen());
+    for (u32 i = 0; i + 1 < count; i++)
+    {
+      EXPECT_EQ(i, IndexGenerator::GetIndex(i * 2));
+      EXPECT_EQ(i + 1, IndexGenerator::GetIndex(i * 2 + 1));
+    }
+
+    IndexGenerator::Start(m_buffer.data());
+    IndexGenerator::AddIndices(GX_DRAW_POINTS, count);
+    ASSERT_EQ(count, IndexGenerator::GetIndexLen());
+    for (u32 i = 0; i < count; i++)
+      EXPECT_EQ(i, IndexGenerator::GetIndex(i));
+  }
+}
+
+TEST_P(IndexGeneratorTest, PastSixteenBits)
+{
+  if (!Uses32Bit())
+  {
+    IndexGenerator::Start(m_buffer.data());
+    EXPECT_EQ(65534u, IndexGenerator::GetRemainingIndices());
+    return;
+  }
+  // 21845 triangles fill the 16 bit range, the next one goes past it
+  std::vector<u32> buffer(90000);
+  IndexGenerator::Start(buffer.data());
+  IndexGenerator::AddIndices(GX_DRAW_TRIANGLES, 65535);
+  EXPECT_LT(65536u, IndexGenerator::GetRemainingIndices());
+  IndexGenerator::AddIndices(GX_DRAW_TRIANGLES, 3);
+  std::vector<Triangle> actual =
+      DecodeTriangles(buffer.data(), IndexGenerator::GetIndexLen(), UsesRestart());
+  ASSERT_EQ(21846u, actual.size());
+  EXPECT_EQ((Triangle{{65535, 65536, 65537}}), actual.back());
+}
+
+TEST_P(IndexGeneratorTest, DegenerateTrianglesCulled)
+{
+  // Three triangles, the middle one has two vertices at the same position
+  const std::array<float, 27> positions = {{
+      0, 0, 0, 1, 0, 0, 0, 1, 0,
+      0, 0, 0, 1, 0, 0, 1, 0, 0,
+      0, 0, 1, 1, 0, 1, 0, 1, 1,
+  }};
+  IndexGenerator::Start(m_buffer.data());
+  IndexGenerator::AddIndices(GX_DRAW_TRIANGLES, 3);
+  EXPECT_EQ(1u, IndexGenerator::AddTrianglesCulled(reinterpret_cast<const u8*>(positions.data()),
+                                                   3 * sizeof(float), 9));
+  EXPECT_EQ(12u, IndexGenerator::GetNumVerts());
+
+  std::vector<Triangle> actual = Decode();
+  ASSERT_EQ(3u, actual.size());
+  EXPECT_EQ((Triangle{{0, 1, 2}}), actual[0]);
+  EXPECT_EQ((Triangle{{3, 4, 5}}), actual[1]);
+  EXPECT_EQ((Triangle{{9, 10, 11}}), actual[2]);
+}
@@ -0,0 +1,83 @@
+// Copyright 2013 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CommonPaths.h"
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "VideoCommon/ObjectUsageProfiler.h"
+
+namespace
+{
+struct Info
+{
+};
+typedef ObjectUsageProfiler<u32, pKey_t, Info, std::hash<u32>> Profiler;
+
+std::vector<u32> MostUsed(Profiler& profiler)
+{
+  std::vector<u32> result;
+  profiler.ForEachMostUsed([&](const u32& obj) { result.push_back(obj); });
+  return result;
+}
+
+std::vector<u32> MostUsedByCategory(Profiler& profiler, pKey_t category)
+{
+  std::vector<u32> result;
+  profiler.ForEachMostUsedByCategory(category,
+                                     [&](const u32& obj, size_t) { result.push_back(obj); });
+  return result;
+}
+}
+
+TEST(ObjectUsageProfiler, OrdersByUsageThenFirstUse)
+{
+  Profiler profiler(1);
+  profiler.SetCategory(7);
+  profiler.GetOrAdd(30);
+  profiler.GetOrAdd(10);
+  profiler.GetOrAdd(20);
+  profiler.GetOrAdd(20);
+
+  EXPECT_EQ((std::vector<u32>{20, 30, 10}), MostUsed(profiler));
+}
+
+TEST(ObjectUsageProfiler, PersistRoundTrip)
+{
+  std::string dir = File::CreateTempDir();
+  ASSERT_FALSE(dir.empty());
+  std::string path = dir + DIR_SEP "test.usage";
+  {
+    Profiler profiler(1);
+    profiler.SetCategory(7);
+    profiler.GetOrAdd(30);
+    profiler.GetOrAdd(10);
+    profiler.GetOrAdd(20);
+    profiler.GetOrAdd(20);
+    profiler.PersistToFile(path);
+  }
+  {
+    Profiler profiler(1);
+    profiler.ReadFromFile(path);
+    profiler.SetCategory(7);
+    EXPECT_EQ(3u, profiler.size());
+    EXPECT_EQ((std::vector<u32>{20, 30, 10}), MostUsedByCategory(profiler, 7));
+
+    // Objects first seen in a later session go after the persisted ones
+    profiler.GetOrAdd(40);
+    EXPECT_EQ((std::vector<u32>{20, 30, 10, 40}), MostUsed(profiler));
+  }
+  {
+    // A profile recorded for another uid version is ignored
+    Profiler profiler(2);
+    profiler.ReadFromFile(path);
+    EXPECT_EQ(0u, profiler.size());
+  }
+  File::DeleteDirRecursively(dir);
+}
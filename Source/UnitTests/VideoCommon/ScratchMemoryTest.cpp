@@ -0,0 +1,94 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "VideoCommon/ScratchMemory.h"
+
+TEST(ScratchMemoryTest, FrameArenaMergesChunks)
+{
+  ScratchMemory::Trim();
+  ScratchMemory::EndFrame();
+
+  // More than the first chunk holds, so the frame needs several
+  std::vector<u8*> blocks;
+  for (int i = 0; i < 64; i++)
+  {
+    u8* block = static_cast<u8*>(ScratchMemory::AllocateFrame(100 * 1024, 16));
+    ASSERT_NE(nullptr, block);
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(block) % 16);
+    std::memset(block, i, 100 * 1024);
+    blocks.push_back(block);
+  }
+  for (int i = 0; i < 64; i++)
+    EXPECT_EQ(i, blocks[i][100 * 1024 - 1]);
+  ScratchMemory::EndFrame();
+
+  const ScratchMemory::Stats first = ScratchMemory::GetStats();
+  EXPECT_GE(first.frame_peak, 64u * 100 * 1024);
+  EXPECT_GE(first.arena_capacity, first.frame_peak);
+
+  // The merged chunk fits the same frame again without asking the system
+  for (int i = 0; i < 64; i++)
+    ScratchMemory::AllocateFrame(100 * 1024, 16);
+  ScratchMemory::EndFrame();
+  const ScratchMemory::Stats second = ScratchMemory::GetStats();
+  EXPECT_EQ(first.system_allocations, second.system_allocations);
+  EXPECT_EQ(first.arena_capacity, second.arena_capacity);
+}
+
+TEST(ScratchMemoryTest, FrameAllocatorBacksContainers)
+{
+  std::vector<int, ScratchMemory::FrameAllocator<int>> values;
+  for (int i = 0; i < 10000; i++)
+    values.push_back(i);
+  for (int i = 0; i < 10000; i++)
+    EXPECT_EQ(i, values[i]);
+  values = {};
+  ScratchMemory::EndFrame();
+}
+
+TEST(ScratchMemoryTest, PoolReusesBuffers)
+{
+  ScratchMemory::Trim();
+  u8* first_data;
+  {
+    ScratchMemory::Buffer buffer = ScratchMemory::Acquire(5000);
+    ASSERT_TRUE(static_cast<bool>(buffer));
+    EXPECT_EQ(8192u, buffer.size());
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(buffer.data()) % 64);
+    first_data = buffer.data();
+  }
+  const u32 allocations = ScratchMemory::GetStats().system_allocations;
+
+  // Same size class, so the returned buffer is handed out again
+  ScratchMemory::Buffer again = ScratchMemory::Acquire(8000);
+  EXPECT_EQ(first_data, again.data());
+  EXPECT_EQ(allocations, ScratchMemory::GetStats().system_allocations);
+  EXPECT_EQ(8192u, ScratchMemory::GetStats().pool_in_use);
+
+  // Moving hands over the ownership
+  ScratchMemory::Buffer moved = std::move(again);
+  EXPECT_FALSE(static_cast<bool>(again));
+  EXPECT_EQ(first_data, moved.data());
+  moved.Release();
+  EXPECT_EQ(0u, ScratchMemory::GetStats().pool_in_use);
+  EXPECT_GE(ScratchMemory::GetStats().pool_peak, 8192u);
+}
+
+TEST(ScratchMemoryTest, OversizedBuffersAreNotPooled)
+{
+  ScratchMemory::Trim();
+  const size_t held = ScratchMemory::GetStats().pool_capacity;
+  {
+    ScratchMemory::Buffer buffer = ScratchMemory::Acquire(100 * 1024 * 1024);
+    ASSERT_TRUE(static_cast<bool>(buffer));
+    EXPECT_EQ(100u * 1024 * 1024, buffer.size());
+  }
+  EXPECT_EQ(held, ScratchMemory::GetStats().pool_capacity);
+}
@@ -0,0 +1,59 @@
+// Copyright 2017 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <map>
+#include <string>
+
+#include <gtest/gtest.h>  // NOLINT
+
+#include "Common/CommonPaths.h"
+#include "Common/FileUtil.h"
+#include "VideoCommon/TexturePack.h"
+
+TEST(TexturePack, PacksDirectoryTree)
+{
+  std::string dir = File::CreateTempDir();
+  ASSERT_FALSE(dir.empty());
+  std::string textures = dir + DIR_SEP "GALE01";
+  ASSERT_TRUE(File::CreateFullPath(textures + DIR_SEP "sub" DIR_SEP));
+  ASSERT_TRUE(File::WriteStringToFile("png data", textures + DIR_SEP "tex1_8x8_0123_5.png"));
+  ASSERT_TRUE(File::WriteStringToFile(std::string("dds\0data", 8),
+                                      textures + DIR_SEP "sub" DIR_SEP "tex1_8x8_4567_14.dds"));
+  ASSERT_TRUE(File::WriteStringToFile("", textures + DIR_SEP "sub" DIR_SEP "tex1_4x4_89ab_3.png"));
+  ASSERT_TRUE(File::WriteStringToFile("not a texture", textures + DIR_SEP "readme.txt"));
+
+  std::string pack_path = textures + ".itp";
+  ASSERT_TRUE(TexturePack::Build(textures, pack_path));
+
+  TexturePack pack;
+  ASSERT_TRUE(pack.Open(pack_path));
+  std::map<std::string, std::string> entries;
+  for (const TexturePack::Entry& entry : pack.GetEntries())
+  {
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(entry.data) % 16) << entry.name;
+    entries[entry.name] =
+        std::string(reinterpret_cast<const char*>(entry.data), static_cast<size_t>(entry.size));
+  }
+  pack.Close();
+
+  EXPECT_EQ(3u, entries.size());
+  EXPECT_EQ("png data", entries["tex1_8x8_0123_5.png"]);
+  EXPECT_EQ(std::string("dds\0data", 8), entries["tex1_8x8_4567_14.dds"]);
+  EXPECT_EQ("", entries["tex1_4x4_89ab_3.png"]);
+  File::DeleteDirRecursively(dir);
+}
+
+TEST(TexturePack, RejectsInvalidFiles)
+{
+  std::string dir = File::CreateTempDir();
+  ASSERT_FALSE(dir.empty());
+  std::string path = dir + DIR_SEP "broken.itp";
+  TexturePack pack;
+  EXPECT_FALSE(pack.Open(path));
+
+  ASSERT_TRUE(File::WriteStringToFile("ITPK but far too short", path));
+  EXPECT_FALSE(pack.Open(path));
+  EXPECT_FALSE(pack.IsOpen());
+  File::DeleteDirRecursively(dir);
+}
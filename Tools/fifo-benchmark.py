@@ -0,0 +1,78 @@
+#!/usr/bin/env python
+
+# Plays a FIFO log a number of times on each video backend with dolphin-emu-nogui
+# and prints the frame telemetry of the runs side by side.
+#
+# $ python Tools/fifo-benchmark.py --dolphin build/Binaries/dolphin-emu-nogui \
+#     --loops 20 --backends OGL,Vulkan capture.dff
+
+from __future__ import print_function
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+import tempfile
+
+
+def run_backend(dolphin, fifo_log, backend, loops):
+    report = os.path.join(tempfile.gettempdir(), "fifo-benchmark-%s.json" % backend)
+    if os.path.exists(report):
+        os.remove(report)
+    status = subprocess.call([dolphin, "--video-backend", backend, "--fifo-loops", str(loops),
+                              "--report", report, fifo_log])
+    if status != 0 or not os.path.exists(report):
+        print("%s: failed with status %d" % (backend, status), file=sys.stderr)
+        return None
+    with open(report) as f:
+        return json.load(f)
+
+
+def host_gpu_ms(report):
+    # The host GPU pass times are the last five fields of every sample
+    samples = report["telemetry"]["samples"]
+    if not samples:
+        return 0.0
+    return sum(sum(sample[7:12]) for sample in samples) / 1000.0 / len(samples)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare video backends on a FIFO log")
+    parser.add_argument("--dolphin", default="dolphin-emu-nogui")
+    parser.add_argument("--loops", type=int, default=10)
+    parser.add_argument("--backends", default="OGL,Vulkan,D3D,D3D12")
+    parser.add_argument("fifo_log")
+    args = parser.parse_args()
+
+    results = []
+    for backend in args.backends.split(","):
+        report = run_backend(args.dolphin, args.fifo_log, backend, args.loops)
+        if report:
+            results.append((backend, report))
+    if not results:
+        return 1
+
+    rows = [
+        ("frames", lambda r: "%d" % r["frames"]),
+        ("fps", lambda r: "%.1f" % r["telemetry"]["average_fps"]),
+        ("1% low fps", lambda r: "%.1f" % r["telemetry"]["low_1_fps"]),
+        ("0.1% low fps", lambda r: "%.1f" % r["telemetry"]["low_01_fps"]),
+        ("frame ms p50", lambda r: "%.2f" % r["telemetry"]["present_interval_ms"]["median"]),
+        ("frame ms p99", lambda r: "%.2f" % r["telemetry"]["present_interval_ms"]["p99"]),
+        ("GPU thread ms avg", lambda r: "%.2f" % r["telemetry"]["gpu_time_ms"]["average"]),
+        ("GPU thread ms p99", lambda r: "%.2f" % r["telemetry"]["gpu_time_ms"]["p99"]),
+        ("host GPU ms avg", lambda r: "%.2f" % host_gpu_ms(r)),
+        ("CPU thread ms avg", lambda r: "%.2f" % r["telemetry"]["cpu_time_ms"]["average"]),
+        ("shader compiles", lambda r: "%d" % r["shader_compiles"]),
+    ]
+
+    name_width = max(len(name) for name, _ in rows)
+    print("%-*s" % (name_width, "") + "".join("%12s" % backend for backend, _ in results))
+    for name, value in rows:
+        print("%-*s" % (name_width, name) + "".join("%12s" % value(r) for _, r in results))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())